@@ -193,4 +193,218 @@ namespace ngbla
   template class FlatBandCholeskyFactors<Mat<8,8,double> >;
   template class FlatBandCholeskyFactors<Mat<8,8,Complex> >;
 #endif
+
+
+
+  // the LDL^T factorization of FlatBandCholeskyFactors, one matrix per lane
+  void BatchedBandCholeskyFactors :: Factor ()
+  {
+    static Timer t("BatchedBandCholesky::Factor"); RegionTimer reg(t);
+    constexpr size_t S = SIMD<double>::Size();
+
+    ParallelFor (ngroups, [&] (size_t g)
+      {
+        SIMD<double> * gm = &mem[g*GroupMem()];
+        ArrayMem<SIMD<double>, 100> help(n);
+
+        for (int i = 0; i < n; i++)
+          {
+            int mink = max2(0, i-bw+1);
+            for (int k = mink; k < i; k++)
+              help[k] = gm[k] * Entry (gm, i, k);
+
+            int maxj = min2(n, i+bw);
+            for (int j = i; j < maxj; j++)
+              {
+                SIMD<double> x = Entry (gm, j, i);
+                for (int k = max2(0, j-bw+1); k < i; k++)
+                  x -= Entry (gm, j, k) * help[k];
+
+                if (i == j)
+                  {
+                    for (size_t l = 0; l < S; l++)
+                      if (x[l] <= 0)
+                        throw Exception ("BatchedBandCholeskyFactors: diag of matrix "
+                                         + ToString(g*S+l) + " in row " + ToString(i) + " is <= 0");
+                    gm[i] = x;
+                  }
+                else
+                  Entry (gm, j, i) = x / gm[i];
+              }
+          }
+
+        for (int i = 0; i < n; i++)
+          gm[i] = SIMD<double>(1.0) / gm[i];
+      });
+  }
+
+
+  void BatchedBandCholeskyFactors :: Solve (SliceMatrix<double> x) const
+  {
+    static Timer t("BatchedBandCholesky::Solve"); RegionTimer reg(t);
+    constexpr size_t S = SIMD<double>::Size();
+    if (x.Height() != size_t(n) || x.Width() != nmats)
+      throw Exception ("BatchedBandCholeskyFactors::Solve: rhs is " + ToString(x.Height())
+                       + " x " + ToString(x.Width()) + ", expected "
+                       + ToString(n) + " x " + ToString(nmats));
+
+    ParallelFor (ngroups, [&] (size_t g)
+      {
+        SIMD<double> * gm = const_cast<SIMD<double>*> (&mem[g*GroupMem()]);
+        ArrayMem<SIMD<double>, 100> y(n);
+
+        for (int i = 0; i < n; i++)
+          {
+            double vals[S];
+            for (size_t l = 0; l < S; l++)
+              vals[l] = (g*S+l < nmats) ? x(i, g*S+l) : 0.0;
+            SIMD<double> sum(&vals[0]);
+            for (int j = max2(0, i-bw+1); j < i; j++)
+              sum -= Entry (gm, i, j) * y[j];
+            y[i] = sum;
+          }
+
+        for (int i = 0; i < n; i++)
+          y[i] *= gm[i];
+
+        for (int i = n-1; i >= 0; i--)
+          for (int j = max2(0, i-bw+1); j < i; j++)
+            y[j] -= Entry (gm, i, j) * y[i];
+
+        for (int i = 0; i < n; i++)
+          for (size_t l = 0; l < S && g*S+l < nmats; l++)
+            x(i, g*S+l) = y[i][l];
+      });
+  }
+
+
+
+  void BandCyclicReduction :: Factor ()
+  {
+    static Timer t("BandCyclicReduction::Factor"); RegionTimer reg(t);
+    size_t bs2 = size_t(bs)*bs;
+
+    while (true)
+      {
+        Level & lev = levels.Last();
+        int nb = lev.nb;
+        auto block = [&] (Array<double> & a, size_t i)
+          { return FlatMatrix<> (bs, bs, &a[i*bs2]); };
+
+        if (nb == 1)
+          {
+            lev.inv = lev.d;
+            CalcInverse (block (lev.inv, 0));
+            break;
+          }
+
+        // inverses of the odd blocks
+        lev.inv.SetSize (nb*bs2);
+        ParallelFor (nb/2, [&] (size_t k)
+          {
+            size_t i = 2*k+1;
+            block (lev.inv, i) = block (lev.d, i);
+            CalcInverse (block (lev.inv, i));
+          });
+
+        // eliminate them from the equations of the even blocks
+        Level coarse;
+        coarse.nb = (nb+1)/2;
+        coarse.d.SetSize (coarse.nb*bs2);
+        coarse.l.SetSize (coarse.nb*bs2);
+        coarse.u.SetSize (coarse.nb*bs2);
+        lev.alpha.SetSize (nb*bs2);
+        lev.gamma.SetSize (nb*bs2);
+
+        ParallelFor (coarse.nb, [&] (size_t ic)
+          {
+            size_t i = 2*ic;
+            auto dc = block (coarse.d, ic);
+            auto lc = block (coarse.l, ic);
+            auto uc = block (coarse.u, ic);
+            auto alpha = block (lev.alpha, i);
+            auto gamma = block (lev.gamma, i);
+            dc = block (lev.d, i);
+            lc = 0.0;
+            uc = 0.0;
+            alpha = 0.0;
+            gamma = 0.0;
+            if (i > 0)
+              {
+                alpha = block (lev.l, i) * block (lev.inv, i-1);
+                dc -= alpha * block (lev.u, i-1);
+                lc -= alpha * block (lev.l, i-1);
+              }
+            if (i+1 < size_t(nb))
+              {
+                gamma = block (lev.u, i) * block (lev.inv, i+1);
+                dc -= gamma * block (lev.l, i+1);
+                uc -= gamma * block (lev.u, i+1);
+              }
+          });
+
+        levels.Append (std::move(coarse));
+      }
+  }
+
+
+  void BandCyclicReduction :: Solve (FlatVector<double> x) const
+  {
+    static Timer t("BandCyclicReduction::Solve"); RegionTimer reg(t);
+    if (x.Size() != size_t(n))
+      throw Exception ("BandCyclicReduction::Solve: vector has size " + ToString(x.Size())
+                       + ", expected " + ToString(n));
+    size_t bs2 = size_t(bs)*bs;
+    auto block = [&] (const Array<double> & a, size_t i)
+      { return FlatMatrix<> (bs, bs, const_cast<double*> (&a[i*bs2])); };
+
+    // right hand sides of the levels, overwritten by the solutions
+    Array<Vector<double>> f(levels.Size());
+    f[0].SetSize (levels[0].nb*bs);
+    f[0] = 0.0;
+    f[0].Range(0, n) = x;
+    for (size_t k = 0; k+1 < levels.Size(); k++)
+      {
+        auto & lev = levels[k];
+        f[k+1].SetSize (levels[k+1].nb*bs);
+        ParallelFor (levels[k+1].nb, [&] (size_t ic)
+          {
+            size_t i = 2*ic;
+            auto fc = f[k+1].Range(ic*bs, (ic+1)*bs);
+            fc = f[k].Range(i*bs, (i+1)*bs);
+            if (i > 0)
+              fc -= block (lev.alpha, i) * f[k].Range((i-1)*bs, i*bs);
+            if (i+1 < size_t(lev.nb))
+              fc -= block (lev.gamma, i) * f[k].Range((i+1)*bs, (i+2)*bs);
+          });
+      }
+
+    {
+      Vector<double> hf = f.Last();
+      f.Last() = block (levels.Last().inv, 0) * hf;
+    }
+
+    for (int k = int(levels.Size())-2; k >= 0; k--)
+      {
+        auto & lev = levels[k];
+        FlatVector<double> xc = f[k+1];
+        ParallelFor (lev.nb, [&] (size_t i)
+          {
+            auto fi = f[k].Range(i*bs, (i+1)*bs);
+            if (i % 2 == 0)
+              {
+                fi = xc.Range(i/2*bs, (i/2+1)*bs);
+                return;
+              }
+            VectorMem<20,double> hf(bs);
+            hf = fi;
+            hf -= block (lev.l, i) * xc.Range((i-1)/2*bs, ((i-1)/2+1)*bs);
+            if (i+1 < size_t(lev.nb))
+              hf -= block (lev.u, i) * xc.Range((i+1)/2*bs, ((i+1)/2+1)*bs);
+            fi = block (lev.inv, i) * hf;
+          });
+      }
+
+    x = f[0].Range(0, n);
+  }
 }
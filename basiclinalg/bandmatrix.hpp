@@ -329,6 +329,149 @@ namespace ngbla
     }
   };
 
+
+
+  /**
+     LDL^T factors of many symmetric band matrices of equal size and
+     band-width, e.g. the lines of an anisotropic preconditioner.
+     The matrices are interleaved in the lanes of SIMD<double>, one
+     group of SIMD<double>::Size() matrices is factored and solved at
+     once, the groups run in parallel. Unused lanes of the last group
+     hold the identity.
+  */
+  class NGS_DLL_HEADER BatchedBandCholeskyFactors
+  {
+    size_t nmats, ngroups;
+    int n, bw;
+    /// per group: n diagonal entries, then the rows of L with bw-1 entries each
+    Array<SIMD<double>> mem;
+
+  public:
+    /**
+       getmat(m, i, j) is the entry (i,j) of matrix m, with
+       i-bw < j <= i, the matrices are factored in the constructor.
+    */
+    template <typename FUNC>
+    BatchedBandCholeskyFactors (size_t anmats, int an, int abw, FUNC getmat)
+      : nmats(anmats), ngroups((anmats+SIMD<double>::Size()-1) / SIMD<double>::Size()),
+        n(an), bw(abw), mem(ngroups*GroupMem())
+    {
+      constexpr size_t S = SIMD<double>::Size();
+      ParallelFor (ngroups, [&] (size_t g)
+        {
+          SIMD<double> * gm = &mem[g*GroupMem()];
+          for (size_t k = 0; k < GroupMem(); k++)
+            gm[k] = SIMD<double>(0.0);
+          for (int i = 0; i < n; i++)
+            for (int j = max2(0, i-bw+1); j <= i; j++)
+              {
+                double vals[S];
+                for (size_t l = 0; l < S; l++)
+                  {
+                    size_t m = g*S+l;
+                    vals[l] = (m < nmats) ? getmat(m, i, j) : (i == j ? 1.0 : 0.0);
+                  }
+                Entry (gm, i, j) = SIMD<double> (&vals[0]);
+              }
+        });
+      Factor ();
+    }
+
+    size_t NumMatrices () const { return nmats; }
+    int Size () const { return n; }
+    int BandWidth () const { return bw; }
+
+    /// x(i,m) is the right hand side of matrix m, overwritten by the solution
+    void Solve (SliceMatrix<double> x) const;
+
+  private:
+    size_t GroupMem () const { return size_t(n)*bw; }
+    SIMD<double> & Entry (SIMD<double> * gm, int i, int j) const
+    {
+      if (i == j) return gm[i];
+      return gm[n + size_t(i)*(bw-1) + j-(i-bw+1)];
+    }
+    void Factor ();
+  };
+
+
+
+  /**
+     Direct solver for one long symmetric positive definite band matrix
+     by block cyclic reduction. With blocks of size bw-1 the band matrix
+     is block-tridiagonal. Every level eliminates the odd blocks, in
+     parallel, and leaves a block-tridiagonal system for the even blocks
+     of half size. The solve runs the levels down and up, every level in
+     parallel. The work is about bw times the work of the band Cholesky,
+     it pays off for long bands on many cores.
+  */
+  class NGS_DLL_HEADER BandCyclicReduction
+  {
+    int n, bw, bs;
+    struct Level
+    {
+      int nb;
+      /// diagonal, lower and upper blocks of the level system
+      Array<double> d, l, u;
+      /// inverses of the odd diagonal blocks (of the single block on the coarsest level)
+      Array<double> inv;
+      /// alpha_i = L_i D_{i-1}^{-1},  gamma_i = U_i D_{i+1}^{-1} of the even blocks
+      Array<double> alpha, gamma;
+    };
+    Array<Level> levels;
+
+  public:
+    /// getmat(i, j) is the entry (i,j) of the matrix, with i-bw < j <= i
+    template <typename FUNC>
+    BandCyclicReduction (int an, int abw, FUNC getmat)
+      : n(an), bw(abw), bs(max2(abw-1, 1))
+    {
+      int nb = (n+bs-1) / bs;
+      levels.Append (Level());
+      Level & lev = levels.Last();
+      lev.nb = nb;
+      size_t bs2 = size_t(bs)*bs;
+      lev.d.SetSize (nb*bs2);
+      lev.l.SetSize (nb*bs2);
+      lev.u.SetSize (nb*bs2);
+      lev.d = 0.0; lev.l = 0.0; lev.u = 0.0;
+      auto entry = [&] (int i, int j) -> double
+        {
+          if (i < j) swap (i, j);
+          if (j < 0 || i >= n || i-j >= bw) return 0.0;
+          return getmat (i, j);
+        };
+      ParallelFor (nb, [&] (size_t b)
+        {
+          FlatMatrix<> d(bs, bs, &lev.d[b*bs2]);
+          FlatMatrix<> l(bs, bs, &lev.l[b*bs2]);
+          FlatMatrix<> u(bs, bs, &lev.u[b*bs2]);
+          int first = b*bs;
+          for (int r = 0; r < bs; r++)
+            for (int c = 0; c < bs; c++)
+              {
+                d(r,c) = entry (first+r, first+c);
+                l(r,c) = entry (first+r, first-bs+c);
+                u(r,c) = entry (first+r, first+bs+c);
+              }
+          // padding of the last block
+          for (int r = 0; r < bs; r++)
+            if (first+r >= n) d(r,r) = 1;
+        });
+      Factor ();
+    }
+
+    int Size () const { return n; }
+    int BandWidth () const { return bw; }
+    int NumLevels () const { return levels.Size(); }
+
+    /// x is the right hand side, overwritten by the solution
+    void Solve (FlatVector<double> x) const;
+
+  private:
+    void Factor ();
+  };
+
 }
 
 #endif
@@ -200,9 +200,249 @@ namespace ngbla
       LapackInverse(inv);        
     else
 #endif
-      T_CalcInverse (inv);
+      if (inv.Height() >= 50)
+        {
+          // blocked LU with the SIMD kernels of ngblas
+          ArrayMem<int,100> p(inv.Height());
+          CalcLU (inv, p);
+          InverseFromLU (inv, p);
+        }
+      else
+        T_CalcInverse (inv);
+  }
+
+
+
+
+
+  /* ******************** batched small matrices ******************* */
+
+
+  // calls func for groups of up to SW matrices of equal size,
+  // matrices larger than maxsize form groups of one
+  template <typename FUNC>
+  static void ForEachSizeBatch (FlatArray<SliceMatrix<double>> mats, size_t maxsize, FUNC func)
+  {
+    constexpr size_t SW = SIMD<double>::Size();
+    Array<int> index(mats.Size());
+    for (size_t i = 0; i < index.Size(); i++)
+      {
+        if (mats[i].Height() != mats[i].Width())
+          throw Exception ("Batched inverse/factorization: matrix not square");
+        index[i] = i;
+      }
+    QuickSort (index, [&] (int i, int j) { return mats[i].Height() < mats[j].Height(); });
+
+    size_t first = 0;
+    while (first < index.Size())
+      {
+        size_t n = mats[index[first]].Height();
+        size_t next = first+1;
+        if (n <= maxsize)
+          while (next < index.Size() && next-first < SW && mats[index[next]].Height() == n)
+            next++;
+        if (n > 0)
+          func (index.Range(first, next), n);
+        first = next;
+      }
+  }
+
+  
+  // a(i,j) of the matrix in lane l, unused lanes hold the identity
+  static void LoadLanes (FlatArray<int> nrs, FlatArray<SliceMatrix<double>> mats,
+                         size_t n, SIMD<double> * a)
+  {
+    size_t nb = nrs.Size();
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        a[i*n+j] = SIMD<double> ([&] (int l) -> double
+                                 {
+                                   if (l < int(nb)) return mats[nrs[l]](i,j);
+                                   return (i == j) ? 1.0 : 0.0;
+                                 });
+  }
+
+  static void StoreLanes (FlatArray<int> nrs, FlatArray<SliceMatrix<double>> mats,
+                          size_t n, SIMD<double> * a, bool lower = false)
+  {
+    for (size_t l = 0; l < nrs.Size(); l++)
+      {
+        SliceMatrix<double> mat = mats[nrs[l]];
+        for (size_t i = 0; i < n; i++)
+          for (size_t j = 0; j < (lower ? i+1 : n); j++)
+            mat(i,j) = ((double*)(a+i*n+j))[l];
+      }
   }
 
+  
+  /*
+    Gauss-Jordan on the matrices in the lanes, the pivot search and row
+    exchanges are done lane by lane, the elimination is vectorized.
+  */
+  static void CalcInverseLanes (size_t nb, size_t n, SIMD<double> * a)
+  {
+    constexpr size_t SW = SIMD<double>::Size();
+    auto lane = [&] (size_t i, size_t j, size_t l) -> double &
+      { return ((double*)(a+i*n+j))[l]; };
+
+    ArrayMem<int,32*SW> piv(n*SW);
+    for (size_t k = 0; k < n; k++)
+      {
+        for (size_t l = 0; l < nb; l++)
+          {
+            size_t r = k;
+            double maxval = fabs (lane(k,k,l));
+            for (size_t i = k+1; i < n; i++)
+              if (fabs (lane(i,k,l)) > maxval)
+                {
+                  r = i;
+                  maxval = fabs (lane(i,k,l));
+                }
+            double rest = 0.0;
+            for (size_t j = k+1; j < n; j++)
+              rest += fabs (lane(r,j,l));
+            if (maxval == 0 || maxval < 1e-20*rest)
+              throw Exception ("BatchedCalcInverse: Matrix singular");
+            
+            piv[k*SW+l] = r;
+            if (r != k)
+              for (size_t j = 0; j < n; j++)
+                swap (lane(k,j,l), lane(r,j,l));
+          }
+        
+        SIMD<double> invpiv = 1.0 / a[k*n+k];
+        a[k*n+k] = SIMD<double>(1.0);
+        for (size_t j = 0; j < n; j++)
+          a[k*n+j] *= invpiv;
+
+        for (size_t i = 0; i < n; i++)
+          {
+            if (i == k) continue;
+            SIMD<double> f = a[i*n+k];
+            a[i*n+k] = SIMD<double>(0.0);
+            for (size_t j = 0; j < n; j++)
+              a[i*n+j] -= f * a[k*n+j];
+          }
+      }
+
+    // undo the row exchanges by column exchanges in reverse order
+    for (size_t k = n; k-- > 0; )
+      for (size_t l = 0; l < nb; l++)
+        {
+          size_t r = piv[k*SW+l];
+          if (r != k)
+            for (size_t i = 0; i < n; i++)
+              swap (lane(i,k,l), lane(i,r,l));
+        }
+  }
+
+  void BatchedCalcInverse (FlatArray<SliceMatrix<double>> mats)
+  {
+    static Timer t("BatchedCalcInverse"); RegionTimer reg(t);
+    constexpr size_t maxsize = 32;
+    Array<SIMD<double>> mem(maxsize*maxsize);
+
+    ForEachSizeBatch (mats, maxsize, [&] (FlatArray<int> nrs, size_t n)
+      {
+        if (n > maxsize)
+          {
+            FlatMatrix<double> inv(n, n, &mats[nrs[0]](0,0));
+            if (mats[nrs[0]].Dist() == n)
+              CalcInverse (inv);
+            else
+              {
+                Matrix<double> hinv = mats[nrs[0]];
+                CalcInverse (hinv);
+                mats[nrs[0]] = hinv;
+              }
+            return;
+          }
+        LoadLanes (nrs, mats, n, mem.Data());
+        CalcInverseLanes (nrs.Size(), n, mem.Data());
+        StoreLanes (nrs, mats, n, mem.Data());
+      });
+  }
+
+
+  
+  static void CholeskyLanes (size_t nb, size_t n, SIMD<double> * a)
+  {
+    for (size_t k = 0; k < n; k++)
+      {
+        SIMD<double> d = a[k*n+k];
+        for (size_t q = 0; q < k; q++)
+          d -= a[k*n+q] * a[k*n+q];
+        for (size_t l = 0; l < nb; l++)
+          if (! (((double*)&d)[l] > 0))
+            throw Exception ("BatchedCholeskyFactor: Matrix not positive definite");
+        SIMD<double> lkk = sqrt(d);
+        a[k*n+k] = lkk;
+        SIMD<double> invlkk = 1.0 / lkk;
+        
+        for (size_t i = k+1; i < n; i++)
+          {
+            SIMD<double> sum = a[i*n+k];
+            for (size_t q = 0; q < k; q++)
+              sum -= a[i*n+q] * a[k*n+q];
+            a[i*n+k] = sum * invlkk;
+          }
+      }
+  }
+
+  void BatchedCholeskyFactor (FlatArray<SliceMatrix<double>> mats)
+  {
+    static Timer t("BatchedCholeskyFactor"); RegionTimer reg(t);
+    constexpr size_t maxsize = 32;
+    Array<SIMD<double>> mem(maxsize*maxsize);
+
+    ForEachSizeBatch (mats, maxsize, [&] (FlatArray<int> nrs, size_t n)
+      {
+        if (n > maxsize)
+          {
+            SliceMatrix<double> mat = mats[nrs[0]];
+#ifdef LAPACK
+            // column major upper = row major lower
+            integer ni = n, lda = mat.Dist(), info;
+            char uplo = 'U';
+            dpotrf_ (&uplo, &ni, &mat(0,0), &lda, &info);
+            if (info != 0)
+              throw Exception ("BatchedCholeskyFactor: Matrix not positive definite");
+#else
+            CholeskyFactor (mat);
+#endif
+            return;
+          }
+        LoadLanes (nrs, mats, n, mem.Data());
+        CholeskyLanes (nrs.Size(), n, mem.Data());
+        StoreLanes (nrs, mats, n, mem.Data(), true);
+      });
+  }
+
+  void BatchedCholeskySolve (FlatArray<SliceMatrix<double>> factors,
+                             FlatArray<SliceMatrix<double>> rhs)
+  {
+    static Timer t("BatchedCholeskySolve"); RegionTimer reg(t);
+    for (size_t nr = 0; nr < factors.Size(); nr++)
+      {
+        SliceMatrix<double> l = factors[nr];
+        SliceMatrix<double> b = rhs[nr];
+        size_t n = l.Height();
+        // L y = b, row-wise for all right hand sides
+        for (size_t i = 0; i < n; i++)
+          {
+            for (size_t q = 0; q < i; q++)
+              b.Row(i) -= l(i,q) * b.Row(q);
+            b.Row(i) *= 1.0/l(i,i);
+          }
+        // L^T x = y
+        for (size_t i = n; i-- > 0; )
+          {
+            b.Row(i) *= 1.0/l(i,i);
+            for (size_t q = 0; q < i; q++)
+              b.Row(q) -= l(i,q) * b.Row(i);
+          }
+      }
+  }
 
 #ifdef USE_GMP
   template void CalcInverse (FlatMatrix<mpq_class> inv);
@@ -278,7 +278,7 @@ namespace ngbla
     size_t n = L.Height();
     if (n == 1) return;
 
-    if (n >= 2)
+    if (n > 16)
       {
         IntRange r1(0,n/2), r2(n/2,n);
         auto L1 = L.Rows(r1).Cols(r1);
@@ -292,36 +292,23 @@ namespace ngbla
         CalcLDL_SolveL(L2, B2);
         return;
       }
-    
-    static Timer t("LDL - Solve L work", 2);
-    t.Start();
-    /*
-      for (int i = 0; i < L.Height(); i++)
-      for (int j = i+1; j < L.Height(); j++)
-      for (int k = 0; k < B.Height(); k++)
-      B(k,j) -= L(j,i) * B(k,i);
-      // B.Col(j) -= L(j,i) * B.Col(i);
-      */
-    /*
-      for (int k = 0; k < B.Height(); k++)
-      for (int i = 0; i < L.Height(); i++)
-      for (int j = i+1; j < L.Height(); j++)
-      B(k,j) -= L(j,i) * B(k,i);
-    */
+
+    // small block: rows of B are independent, L(i,i) is the inverse diagonal
     auto solve_row = [&] (size_t k)
       {
         auto Brow = B.Row(k);
-        for (size_t i = 0; i < L.Height(); i++)
-          for (size_t j = i+1; j < L.Height(); j++)
-            Brow(j) -= L(j,i) * Brow(i);
+        for (size_t i = 0; i < n; i++)
+          {
+            T hi = Brow(i) * L(i,i);
+            for (size_t j = i+1; j < n; j++)
+              Brow(j) -= L(j,i) * hi;
+          }
       };
     if (B.Height() < 1000)
       for (size_t k = 0; k < B.Height(); k++)
         solve_row(k);
     else
       ParallelFor (B.Height(), solve_row);
-    
-    t.Stop();
   }
   
   // calc new A22-block
@@ -339,7 +326,7 @@ namespace ngbla
   {
     size_t n = mat.Height();
     
-    if (n >= 2)
+    if (n > 16)
       {
         size_t n1 = n/2;
         auto L1 = mat.Rows(0,n1).Cols(0,n1);
@@ -352,30 +339,19 @@ namespace ngbla
         return;
       }
 
-    if (n == 1)
-      {
-        auto hm = mat(0,0);
-        CalcInverse (hm, mat(0,0));
-        return;
-      }
-
-    /*
-      not working anymore
+    // small block: right-looking, the off-diagonal entries stay L*D
     for (size_t i = 0; i < n; i++)
       {
-        T dii = mat(i,i);
         T inv_dii;
-        CalcInverse (dii, inv_dii);
+        CalcInverse (mat(i,i), inv_dii);
+        mat(i,i) = inv_dii;
         for (size_t j = i+1; j < n; j++)
           {
-            T hji = mat(j,i);
-            T hjiD = hji * inv_dii;
-            mat(j,i) = hjiD;
+            T hjiD = mat(j,i) * inv_dii;
             for (size_t k = i+1; k <= j; k++)
-              mat(j,k) -= hji * Trans(mat(k,i));
+              mat(j,k) -= hjiD * mat(k,i);
           }
       }
-    */
   }
 
   
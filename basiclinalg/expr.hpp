@@ -42,9 +42,24 @@ namespace ngbla
   template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
   void NgGEMM (SliceMatrix<double,orda> a, SliceMatrix<double, ordb> b, SliceMatrix<double,ColMajor> c);
   
+  template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
+  void NgGEMM (SliceMatrix<Complex,orda> a, SliceMatrix<Complex, ordb> b, SliceMatrix<Complex> c);
+
+  template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
+  void NgGEMM (SliceMatrix<Complex,orda> a, SliceMatrix<Complex, ordb> b, SliceMatrix<Complex,ColMajor> c);
+  
+  template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
+  void NgGEMM (SliceMatrix<float,orda> a, SliceMatrix<float, ordb> b, SliceMatrix<float> c);
+
+  template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
+  void NgGEMM (SliceMatrix<float,orda> a, SliceMatrix<float, ordb> b, SliceMatrix<float,ColMajor> c);
+  
   template <bool ADD, bool POS, ORDERING ord>
   void NgGEMV (SliceMatrix<double,ord> a, FlatVector<double> x, FlatVector<double> y);
 
+  template <bool ADD, bool POS, ORDERING ord>
+  void NgGEMV (SliceMatrix<float,ord> a, FlatVector<float> x, FlatVector<float> y);
+
   /*
     Matrix expression templates
   */
@@ -631,6 +646,51 @@ namespace ngbla
     }
 
 
+    template <typename OP, typename TA, typename TB,
+              typename enable_if<IsConvertibleToSliceMatrix<TA,Complex>(),int>::type = 0,
+              typename enable_if<IsConvertibleToSliceMatrix<TB,Complex>(),int>::type = 0,
+              typename enable_if<IsConvertibleToSliceMatrix<typename pair<T,TB>::first_type,Complex>(),int>::type = 0>
+    INLINE T & Assign (const Expr<MultExpr<TA, TB>> & prod) 
+    {
+      constexpr bool ADD = std::is_same<OP,AsAdd>::value || std::is_same<OP,AsSub>::value;
+      constexpr bool POS = std::is_same<OP,As>::value || std::is_same<OP,AsAdd>::value;
+      
+      NgGEMM<ADD,POS> (make_SliceMatrix(prod.Spec().A()),
+                       make_SliceMatrix(prod.Spec().B()),
+                       make_SliceMatrix(Spec()));
+      return Spec();
+    }
+
+
+    template <typename OP, typename TA, typename TB,
+              typename enable_if<IsConvertibleToSliceMatrix<TA,float>(),int>::type = 0,
+              typename enable_if<IsConvertibleToSliceMatrix<TB,float>(),int>::type = 0,
+              typename enable_if<IsConvertibleToSliceMatrix<typename pair<T,TB>::first_type,float>(),int>::type = 0>
+    INLINE T & Assign (const Expr<MultExpr<TA, TB>> & prod) 
+    {
+      constexpr bool ADD = std::is_same<OP,AsAdd>::value || std::is_same<OP,AsSub>::value;
+      constexpr bool POS = std::is_same<OP,As>::value || std::is_same<OP,AsAdd>::value;
+      
+      NgGEMM<ADD,POS> (make_SliceMatrix(prod.Spec().A()),
+                       make_SliceMatrix(prod.Spec().B()),
+                       make_SliceMatrix(Spec()));
+      return Spec();
+    }
+
+    template <typename OP, typename TA, typename TB,
+              typename enable_if<IsConvertibleToSliceMatrix<TA,float>(),int>::type = 0,
+              typename enable_if<is_convertible<TB,FlatVector<float>>::value,int>::type = 0,
+              typename enable_if<is_convertible<typename pair<T,TB>::first_type,FlatVector<float>>::value,int>::type = 0>
+    INLINE T & Assign (const Expr<MultExpr<TA, TB>> & prod)
+    {
+      constexpr bool ADD = std::is_same<OP,AsAdd>::value || std::is_same<OP,AsSub>::value;
+      constexpr bool POS = std::is_same<OP,As>::value || std::is_same<OP,AsAdd>::value;
+      NgGEMV<ADD,POS> (make_SliceMatrix(prod.Spec().A()),
+                       prod.Spec().B(),
+                       Spec());
+      return Spec();
+    }
+
     template <typename OP, typename TA, typename TB,
               typename enable_if<IsConvertibleToSliceMatrix<TA,double>(),int>::type = 0,
               typename enable_if<is_convertible<TB,FlatVector<double>>::value,int>::type = 0,
@@ -1663,6 +1723,25 @@ namespace ngbla
 
   extern NGS_DLL_HEADER void CalcInverse (FlatMatrix<double> inv, INVERSE_LIB il = INVERSE_LIB::INV_CHOOSE);
 
+  /**
+     Inverts many small matrices in place. Matrices of equal size up to 32
+     are processed SIMD-width many at once, one matrix per lane
+     (Gauss-Jordan with partial pivoting per lane), larger ones by CalcInverse.
+     Throws for singular matrices.
+  */
+  extern NGS_DLL_HEADER void BatchedCalcInverse (FlatArray<SliceMatrix<double>> mats);
+
+  /**
+     In place Cholesky factorization A = L L^T of many small s.p.d. matrices.
+     L is stored in the lower triangle, the upper triangle is not touched.
+     Same batching as BatchedCalcInverse, LAPACK for the larger ones.
+  */
+  extern NGS_DLL_HEADER void BatchedCholeskyFactor (FlatArray<SliceMatrix<double>> mats);
+
+  /// rhs[i] = (L L^T)^{-1} rhs[i] with the factors of BatchedCholeskyFactor
+  extern NGS_DLL_HEADER void BatchedCholeskySolve (FlatArray<SliceMatrix<double>> factors,
+                                                   FlatArray<SliceMatrix<double>> rhs);
+
   template <class T, class T2>
   inline void CalcInverse (const FlatMatrix<T> m, FlatMatrix<T2> inv)
   {
@@ -10,6 +10,9 @@ using namespace ngstd;
 
 enum OP { ADD, SUB, SET, SETNEG };
 
+// generate optimal code for my host, or for the kernel set given on the command line
+int simd_width = SIMD<double>::Size();
+
 string ToString (OP op)
 {
   switch (op)
@@ -861,7 +864,7 @@ void  GenerateMatVec (ostream & out, int wa, OP op)
   out << "template <> INLINE void KernelMatVec<" << wa << ", " << ToString(op) << ">" << endl
       << "(size_t ha, double * pa, size_t da, double * x, double * y) {" << endl;
 
-  int SW = SIMD<double>::Size();  // generate optimal code for my host
+  int SW = simd_width;
   // out << "constexpr int SW = SIMD<double>::Size();" << endl;
   int i = 0;
   for ( ; SW*(i+1) <= wa; i++)
@@ -991,7 +994,7 @@ void GenerateAddMatVec (ostream & out, int wa)
   out << "template <> INLINE void KernelAddMatVec<" << wa << ">" << endl
       << "(double s, size_t ha, double * pa, size_t da, double * x, double * y) {" << endl;
 
-  int SW = SIMD<double>::Size();  // generate optimal code for my host
+  int SW = simd_width;
   int i = 0;
   for ( ; SW*(i+1) <= wa; i++)
     out << "SIMD<double," << SW << "> x" << i << "(x+" << i*SW << ");" << endl;
@@ -1126,7 +1129,7 @@ void GenerateAddMatTransVecI (ostream & out, int wa)
       << "inline void KernelAddMatTransVecI<" << wa << ">" << endl
       << "(double s, size_t ha, double * pa, size_t da, double * x, double * y, int * ind) {" << endl;
 
-  int SW = SIMD<double>::Size();  // generate optimal code for my host
+  int SW = simd_width;
 
   int nfull = wa / SW;
   int rest = wa % SW;
@@ -1247,9 +1250,17 @@ void GenerateAddMatTransVecI (ostream & out, int wa)
 
 
 
-int main ()
+/*
+  kernel_generator [filename [simdwidth]]
+  writes matkernel.hpp for the host, or a kernel set for another
+  simd width used by the runtime dispatch (ngblas_arch.cpp)
+*/
+int main (int argc, char ** argv)
 {
-  ofstream out("matkernel.hpp");
+  string filename = (argc > 1) ? argv[1] : "matkernel.hpp";
+  if (argc > 2)
+    simd_width = atoi (argv[2]);
+  ofstream out(filename);
 
   out << "enum OPERATION { ADD, SUB, SET, SETNEG };" << endl;
 
@@ -1,5 +1,14 @@
 #include <bla.hpp>
 
+#ifndef WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef NGS_KERNEL_DISPATCH
+#include "ngblas_arch.hpp"
+#endif
+
 
 namespace ngbla
 {
@@ -727,36 +736,37 @@ namespace ngbla
 #endif
     
     // blockwise B, fits into L2 cache
-    // constexpr size_t BBH = 128;
-    constexpr size_t BBW = 96;
+    // BBH * 96 is the capacity, the block is wa x bbw
     constexpr size_t SW = SIMD<double>::Size();
-    alignas(64) SIMD<double> bb[BBH*BBW/SW];
+    alignas(64) SIMD<double> bb[BBH*96/SW];
+    size_t bbw = blas_blocking.mm_w;
+    size_t dbb = bbw/SW;
 
-    for (size_t j = 0; j < wb; j += BBW)
+    for (size_t j = 0; j < wb; j += bbw)
       {
         size_t hbi = wa;
-        size_t wbi = min2(BBW, wb-j);
-        CopyMatrixIn (hbi, wbi, pb+j, distb, &bb[0], BBW/SW);
+        size_t wbi = min2(bbw, wb-j);
+        CopyMatrixIn (hbi, wbi, pb+j, distb, &bb[0], dbb);
 
         double * pa = pa0;
         double * pc = &c(0)+j;
         
         size_t k = 0;
         for ( ; k+HA <= ha; k += HA, pa += HA*dista, pc += HA * c.Dist())
-          MatKernel2AddAB<HA,OP> (hbi, wbi, pa, dista,  &bb[0], BBW/SW, pc, c.Dist());
+          MatKernel2AddAB<HA,OP> (hbi, wbi, pa, dista,  &bb[0], dbb, pc, c.Dist());
         switch (ha-k)
           {
           case 0: break;
-          case 1: MatKernel2AddAB<1,OP> (hbi, wbi, pa, dista, &bb[0], BBW/SW, pc, c.Dist()); break;
-          case 2: MatKernel2AddAB<2,OP> (hbi, wbi, pa, dista, &bb[0], BBW/SW, pc, c.Dist()); break;
-          case 3: MatKernel2AddAB<3,OP> (hbi, wbi, pa, dista, &bb[0], BBW/SW, pc, c.Dist()); break;
+          case 1: MatKernel2AddAB<1,OP> (hbi, wbi, pa, dista, &bb[0], dbb, pc, c.Dist()); break;
+          case 2: MatKernel2AddAB<2,OP> (hbi, wbi, pa, dista, &bb[0], dbb, pc, c.Dist()); break;
+          case 3: MatKernel2AddAB<3,OP> (hbi, wbi, pa, dista, &bb[0], dbb, pc, c.Dist()); break;
           case 4:
             if (HA > 4)
-              MatKernel2AddAB<4,OP> (hbi, wbi, pa, dista, &bb[0], BBW/SW, pc, c.Dist());
+              MatKernel2AddAB<4,OP> (hbi, wbi, pa, dista, &bb[0], dbb, pc, c.Dist());
             break;
           case 5:
             if (HA > 5)
-              MatKernel2AddAB<5,OP> (hbi, wbi, pa, dista, &bb[0], BBW/SW, pc, c.Dist());
+              MatKernel2AddAB<5,OP> (hbi, wbi, pa, dista, &bb[0], dbb, pc, c.Dist());
             break;
           default: ; 
           }
@@ -831,7 +841,8 @@ namespace ngbla
                           BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
   {
     constexpr size_t BBH = 128;
-    if (wa <= BBH)
+    size_t bbh = blas_blocking.mm_k;
+    if (wa <= bbh)
       {
         if (wb < 3*SIMD<double>::Size())
           MultMatMat_intern2_SlimB<BBH,SET> (ha, wa, wb, a, b, c);
@@ -840,13 +851,13 @@ namespace ngbla
       }
     else
       {
-        MultMatMat_intern2<BBH,SET> (ha, BBH, wb, a, b, c);    
+        MultMatMat_intern2<BBH,SET> (ha, bbh, wb, a, b, c);    
 
-        for (size_t i = BBH; i < wa; i += BBH)
+        for (size_t i = bbh; i < wa; i += bbh)
           {
-            a.IncPtr(BBH);
-            b.IncPtr(BBH*b.Dist());
-            size_t hbi = min2(BBH, wa-i);        
+            a.IncPtr(bbh);
+            b.IncPtr(bbh*b.Dist());
+            size_t hbi = min2(bbh, wa-i);        
             MultMatMat_intern2<BBH,ADD> (ha, hbi, wb, a, b, c);
           }
       }
@@ -856,7 +867,8 @@ namespace ngbla
                            BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
   {
     constexpr size_t BBH = 128;
-    if (wa <= BBH)
+    size_t bbh = blas_blocking.mm_k;
+    if (wa <= bbh)
       {
         if (wb < 3*SIMD<double>::Size())
           MultMatMat_intern2_SlimB<BBH,SETNEG> (ha, wa, wb, a, b, c);
@@ -865,13 +877,13 @@ namespace ngbla
       }
     else
       {
-        MultMatMat_intern2<BBH,SETNEG> (ha, BBH, wb, a, b, c);    
+        MultMatMat_intern2<BBH,SETNEG> (ha, bbh, wb, a, b, c);    
 
-        for (size_t i = BBH; i < wa; i += BBH)
+        for (size_t i = bbh; i < wa; i += bbh)
           {
-            a.IncPtr(BBH);
-            b.IncPtr(BBH*b.Dist());
-            size_t hbi = min2(BBH, wa-i);        
+            a.IncPtr(bbh);
+            b.IncPtr(bbh*b.Dist());
+            size_t hbi = min2(bbh, wa-i);        
             MultMatMat_intern2<BBH,SUB> (ha, hbi, wb, a, b, c);
           }
       }
@@ -916,12 +928,13 @@ namespace ngbla
       }
     
     constexpr size_t BBH = 128;
-    if (wa <= BBH && wb < 3*SIMD<double>::Size())
+    size_t bbh = blas_blocking.mm_k;
+    if (wa <= bbh && wb < 3*SIMD<double>::Size())
       MultMatMat_intern2_SlimB<BBH,ADD> (ha, wa, wb, a, b, c);
     else
-      for (size_t i = 0; i < wa; i += BBH, a.IncPtr(BBH), b.IncPtr(BBH*b.Dist()))
+      for (size_t i = 0; i < wa; i += bbh, a.IncPtr(bbh), b.IncPtr(bbh*b.Dist()))
         {
-          size_t hbi = min2(BBH, wa-i);        
+          size_t hbi = min2(bbh, wa-i);        
           MultMatMat_intern2<BBH,ADD> (ha, hbi, wb, a, b, c);
         }
   }
@@ -930,12 +943,13 @@ namespace ngbla
                      BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
   {
     constexpr size_t BBH = 128;
-    if (wa <= BBH && wb < 3*SIMD<double>::Size())
+    size_t bbh = blas_blocking.mm_k;
+    if (wa <= bbh && wb < 3*SIMD<double>::Size())
       MultMatMat_intern2_SlimB<BBH,SUB> (ha, wa, wb, a, b, c);
     else
-      for (size_t i = 0; i < wa; i += BBH, a.IncPtr(BBH), b.IncPtr(BBH*b.Dist()))
+      for (size_t i = 0; i < wa; i += bbh, a.IncPtr(bbh), b.IncPtr(bbh*b.Dist()))
         {
-          size_t hbi = min2(BBH, wa-i);        
+          size_t hbi = min2(bbh, wa-i);        
           MultMatMat_intern2<BBH,SUB> (ha, hbi, wb, a, b, c);
         }
   }
@@ -1198,6 +1212,86 @@ namespace ngbla
       &MultABtSmallWA<24>
     };
 
+
+#ifdef NGS_KERNEL_DISPATCH
+
+  /* ********************* runtime cpu dispatch ************************ */
+
+  // kernel set of the widest instruction set supported by the cpu,
+  // one more indirect call than the baseline kernels
+  static ArchKernels arch_kernels;
+
+  template <size_t WA, OPERATION OP>
+  REGCALL void MultMatMat_Arch_ShortSum (size_t ha, size_t wb,
+                                         BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
+  {
+    auto kernel = (OP == SET) ? arch_kernels.setab[WA] :
+      ((OP == ADD) ? arch_kernels.addab[WA] : arch_kernels.subab[WA]);
+    (*kernel) (ha, wb, &a(0), a.Dist(), &b(0), b.Dist(), &c(0), c.Dist());
+  }
+
+  template <int SX>
+  void MultMatVecArch (BareSliceMatrix<> a, FlatVector<> x, FlatVector<> y)
+  {
+    (*arch_kernels.matvec[SX]) (y.Size(), &a(0), a.Dist(), &x(0), &y(0));
+  }
+
+  template <int SX>
+  void MultAddMatVecArch (double s, BareSliceMatrix<> a, FlatVector<> x, FlatVector<> y)
+  {
+    (*arch_kernels.addmatvec[SX]) (s, y.Size(), &a(0), a.Dist(), &x(0), &y(0));
+  }
+
+  template <int SX>
+  void REGCALL MultABtArch (size_t ah, size_t bh, BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
+  {
+    auto kernel = arch_kernels.matvec[SX];
+    double * pa = &a(0);
+    double * pc = &c(0);
+    for (size_t i = 0; i < ah; i++, pa += a.Dist(), pc += c.Dist())
+      (*kernel) (bh, &b(0), b.Dist(), pa, pc);
+  }
+
+  // returns the simd width of the selected kernels, 0 if none
+  static int SelectArchKernels ()
+  {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+#ifdef NGS_KERNEL_AVX512
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512vl"))
+      return GetArchKernels_avx512 (arch_kernels);
+#endif
+#ifdef NGS_KERNEL_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return GetArchKernels_avx2 (arch_kernels);
+#endif
+#endif
+    return 0;
+  }
+
+  auto init_arch_kernels = [] ()
+  {
+    if (SelectArchKernels() <= SIMD<double>::Size())
+      return 0;
+
+    Iterate<13> ([&] (auto i)
+      {
+        dispatch_multAB[i] = &MultMatMat_Arch_ShortSum<i,SET>;
+        dispatch_addAB[i] = &MultMatMat_Arch_ShortSum<i,ADD>;
+        dispatch_subAB[i] = &MultMatMat_Arch_ShortSum<i,SUB>;
+      });
+    Iterate<25> ([&] (auto i)
+      {
+        dispatch_matvec[i] = &MultMatVecArch<i>;
+        dispatch_addmatvec[i] = &MultAddMatVecArch<i>;
+        dispatch_abt[i] = &MultABtArch<i>;
+      });
+    return 1;
+  }();
+
+#endif
+
   
   template <typename TAB, typename FUNC>
   INLINE void TAddABt4 (size_t wa, size_t hc, size_t wc,
@@ -1270,8 +1364,8 @@ namespace ngbla
                  TAB * pa, size_t da, TAB * pb, size_t db, double * pc, size_t dc,
                  FUNC func)
   {
-    constexpr size_t bsa = 96; // height a
-    constexpr size_t bsb = 32; // height b    
+    size_t bsa = blas_blocking.abt_ha; // height a
+    size_t bsb = blas_blocking.abt_hb; // height b    
     for (size_t i = 0; i < ha; i += bsa, pa += bsa*da, pc += bsa*dc)
       {
         size_t hha = min2(bsa, ha-i);
@@ -1288,7 +1382,7 @@ namespace ngbla
   void TAddABt1 (SliceMatrix<double> a, SliceMatrix<double> b, BareSliceMatrix<double> c,
                 FUNC func)
   {
-    constexpr size_t bs = 256; // inner-product loop
+    size_t bs = blas_blocking.abt_k; // inner-product loop
     size_t wa = a.Width();
     double *pa = a.Data();
     double *pb = b.Data();
@@ -1302,7 +1396,7 @@ namespace ngbla
   {
     // c = a * Trans(b);
 
-    constexpr size_t bs = 256;
+    size_t bs = blas_blocking.abt_k;
     size_t wa = a.Width();
 
     TAddABt2 (min2(bs, wa), a.Height(), b.Height(),
@@ -1317,7 +1411,7 @@ namespace ngbla
   {
     // c = -a * Trans(b);
     
-    constexpr size_t bs = 256;
+    size_t bs = blas_blocking.abt_k;
     size_t wa = a.Width();
 
     TAddABt2 (min2(bs, wa), a.Height(), b.Height(),
@@ -1353,7 +1447,7 @@ namespace ngbla
   void TAddABt1 (SliceMatrix<SIMD<double>> a, SliceMatrix<SIMD<double>> b, BareSliceMatrix<double> c,
                  FUNC func)
   {
-    constexpr size_t bs = 256; // inner-product loop
+    size_t bs = blas_blocking.abt_k; // inner-product loop
     size_t wa = a.Width();
     SIMD<double> *pa = &a(0);
     SIMD<double> *pb = &b(0);
@@ -1469,18 +1563,109 @@ namespace ngbla
 
   
 
+  // 2x2 blocks of c, the sums over the integration points are split re/im
+  template <typename TA, typename TB>
+  INLINE void AddABt2x2 (size_t ha, size_t hb, size_t wa,
+                         TA * pa0, size_t da, TB * pb0, size_t db,
+                         SliceMatrix<Complex> c)
+  {
+    if (wa == 0) return;
+    size_t i = 0;
+    for ( ; i+1 < ha; i+=2)
+      {
+        auto pa1 = pa0 + i*da;
+        auto pa2 = pa1 + da;
+        auto pb1 = pb0;
+        size_t j = 0;
+        for ( ; j+1 < hb; j+=2, pb1 += 2*db)
+          {
+            auto pb2 = pb1 + db;
+            SIMD<Complex> sum11(0.0);
+            SIMD<Complex> sum21(0.0);
+            SIMD<Complex> sum12(0.0);
+            SIMD<Complex> sum22(0.0);
+            __assume (wa > 0);
+            for (size_t k = 0; k < wa; k++)
+              {
+                sum11 += pa1[k] * pb1[k];
+                sum21 += pa2[k] * pb1[k];
+                sum12 += pa1[k] * pb2[k];
+                sum22 += pa2[k] * pb2[k];
+              }
+            Complex s11, s21, s12, s22;
+            std::tie(s11,s21) = HSum(sum11, sum21);
+            std::tie(s12,s22) = HSum(sum12, sum22);
+            c(i,j) += s11;
+            c(i,j+1) += s12;
+            c(i+1,j) += s21;
+            c(i+1,j+1) += s22;
+          }
+        if (j < hb)
+          {
+            SIMD<Complex> sum1(0.0);
+            SIMD<Complex> sum2(0.0);
+            __assume (wa > 0);
+            for (size_t k = 0; k < wa; k++)
+              {
+                sum1 += pa1[k] * pb1[k];
+                sum2 += pa2[k] * pb1[k];
+              }
+            Complex s1, s2;
+            std::tie(s1,s2) = HSum(sum1, sum2);
+            c(i,j) += s1;
+            c(i+1,j) += s2;
+          }
+      }
+    
+    if (i < ha)
+      {
+        auto pa1 = pa0 + i*da;
+        auto pb1 = pb0;
+        size_t j = 0;
+        for ( ; j+1 < hb; j+=2, pb1 += 2*db)
+          {
+            auto pb2 = pb1 + db;
+            SIMD<Complex> sum1(0.0);
+            SIMD<Complex> sum2(0.0);
+            for (size_t k = 0; k < wa; k++)
+              {
+                sum1 += pa1[k] * pb1[k];
+                sum2 += pa1[k] * pb2[k];
+              }
+            Complex s1, s2;
+            std::tie(s1,s2) = HSum(sum1, sum2);
+            c(i,j) += s1;
+            c(i,j+1) += s2;
+          }
+        if (j < hb)
+          {
+            SIMD<Complex> sum(0.0);
+            for (size_t k = 0; k < wa; k++)
+              sum += pa1[k] * pb1[k];
+            c(i,j) += HSum(sum);
+          }
+      }
+  }
+  
+  Timer timer_addabtcc ("AddABt-complex-complex");
+  
   void AddABt (FlatMatrix<SIMD<Complex>> a,
                FlatMatrix<SIMD<Complex>> b,
                SliceMatrix<Complex> c)
   {
-    for (size_t i = 0; i < c.Height(); i++)
-      for (size_t j = 0; j < c.Width(); j++)
-        {
-          SIMD<Complex> sum(0.0);
-          for (size_t k = 0; k < a.Width(); k++)
-            sum += a(i,k) * b(j,k);
-          c(i,j) += HSum(sum);
-        }
+    ThreadRegionTimer reg(timer_addabtcc, TaskManager::GetThreadId());
+    NgProfiler::AddThreadFlops(timer_addabtcc, TaskManager::GetThreadId(),
+                               a.Height()*b.Height()*a.Width()*4*SIMD<double>::Size());
+    
+    // blocks of B stay in cache
+    constexpr size_t bs = 32;
+    size_t wa = a.Width();
+    if (wa == 0) return;
+    for (size_t j = 0; j < b.Height(); j += bs)
+      {
+        size_t j2 = min2(j+bs, b.Height());
+        AddABt2x2 (a.Height(), j2-j, wa, &a(0,0), wa, &b(j,0), wa, c.Cols(j,j2));
+      }
   }
   
   void AddABtSym (FlatMatrix<SIMD<Complex>> a,
@@ -1637,16 +1822,8 @@ namespace ngbla
     NgProfiler::AddThreadFlops(timer_addabtcd, TaskManager::GetThreadId(),
                                a.Height()*b.Height()*a.Width()*2*SIMD<double>::Size());
 
-    for (size_t i = 0; i < c.Height(); i++)
-      for (size_t j = 0; j < c.Width(); j++)
-        {
-          SIMD<Complex> sum = 0.0;
-          auto rowa = a.Row(i);
-          auto rowb = b.Row(j);
-          for (size_t k = 0; k < a.Width(); k++)
-            sum += rowa(k)*rowb(k);
-          c(i,j) += HSum(sum);
-        }
+    if (a.Width() == 0) return;
+    AddABt2x2 (a.Height(), b.Height(), a.Width(), &a(0,0), a.Dist(), &b(0,0), b.Dist(), c);
   }
 
   
@@ -1844,6 +2021,412 @@ namespace ngbla
   }
 
 
+  /* ************************** Complex AB, ABt ***************************** */
+
+  /*
+    B is packed into panels of 2*SW columns, stored as SIMD<Complex>, i.e.
+    split into real and imaginary parts. The micro-kernel computes H rows
+    times 2*SW columns of C, a(i,k) is broadcast.
+    OP = 0: C = AB, OP = 1: C += AB, OP = -1: C -= AB
+  */
+  template <size_t H, int OP>
+  INLINE void ComplexMicroKernel (size_t wa, Complex * pa, size_t da,
+                                  SIMD<Complex> * pb, Complex * pc, size_t dc, int nc)
+  {
+    constexpr int SW = SIMD<double>::Size();
+    SIMD<Complex> sum[H][2];
+    for (size_t i = 0; i < H; i++)
+      sum[i][0] = sum[i][1] = SIMD<Complex>(0.0);
+    
+    for (size_t k = 0; k < wa; k++, pb += 2)
+      {
+        SIMD<Complex> b0 = pb[0];
+        SIMD<Complex> b1 = pb[1];
+        for (size_t i = 0; i < H; i++)
+          {
+            SIMD<Complex> ai(pa[i*da+k]);
+            sum[i][0] += ai * b0;
+            sum[i][1] += ai * b1;
+          }
+      }
+
+    for (size_t i = 0; i < H; i++, pc += dc)
+      for (int l = 0; l < 2; l++)
+        {
+          int nr = nc - l*SW;
+          if (nr <= 0) break;
+          if (OP != 0)
+            {
+              SIMD<Complex> ci;
+              if (nr >= SW) ci.LoadFast (pc+l*SW);
+              else ci.LoadFast (pc+l*SW, nr);
+              if (OP > 0) sum[i][l] = ci + sum[i][l];
+              else sum[i][l] = ci - sum[i][l];
+            }
+          if (nr >= SW) sum[i][l].StoreFast (pc+l*SW);
+          else sum[i][l].StoreFast (pc+l*SW, nr);
+        }
+  }
+
+  template <int OP>
+  static void ComplexPanel (size_t ha, size_t wa, Complex * pa, size_t da,
+                            SIMD<Complex> * pb, Complex * pc, size_t dc, int nc)
+  {
+    size_t i = 0;
+    for ( ; i+2 <= ha; i += 2)
+      ComplexMicroKernel<2,OP> (wa, pa+i*da, da, pb, pc+i*dc, dc, nc);
+    if (i < ha)
+      ComplexMicroKernel<1,OP> (wa, pa+i*da, da, pb, pc+i*dc, dc, nc);
+  }
+
+  // b is wa x wb (TRANSB = false), or wb x wa (TRANSB = true)
+  template <bool TRANSB>
+  static void ComplexGEMM (int op, SliceMatrix<Complex> a, SliceMatrix<Complex> b,
+                           BareSliceMatrix<Complex> c)
+  {
+    constexpr int SW = SIMD<double>::Size();
+    constexpr size_t bk = 128;
+    size_t ha = a.Height(), wa = a.Width();
+    size_t wb = TRANSB ? b.Height() : b.Width();
+    size_t dc = c.Dist();
+    if (ha == 0 || wb == 0) return;
+    if (wa == 0)
+      {
+        if (op == 0) c.AddSize(ha, wb) = Complex(0.0);
+        return;
+      }
+    
+    SIMD<Complex> memb[2*bk];
+    Complex tmp[2*SW];
+    for (size_t k = 0; k < wa; k += bk)
+      {
+        size_t k2 = min2(k+bk, wa);
+        // the first block sets C, the next ones add to it
+        int opk = (k == 0 || op != 0) ? op : 1;
+        for (size_t j = 0; j < wb; j += 2*SW)
+          {
+            int nc = min2(size_t(2*SW), wb-j);
+            for (size_t kk = k; kk < k2; kk++)
+              {
+                SIMD<Complex> * pb = memb+2*(kk-k);
+                if (!TRANSB)
+                  {
+                    Complex * prow = &b(kk,j);
+                    if (nc >= SW) pb[0].LoadFast (prow);
+                    else pb[0].LoadFast (prow, nc);
+                    if (nc == 2*SW) pb[1].LoadFast (prow+SW);
+                    else if (nc > SW) pb[1].LoadFast (prow+SW, nc-SW);
+                    else pb[1] = SIMD<Complex>(0.0);
+                  }
+                else
+                  {
+                    for (int jj = 0; jj < 2*SW; jj++)
+                      tmp[jj] = (jj < nc) ? b(j+jj,kk) : Complex(0.0);
+                    pb[0].LoadFast (tmp);
+                    pb[1].LoadFast (tmp+SW);
+                  }
+              }
+            
+            Complex * pa = &a(0,k);
+            Complex * pc = &c(0,j);
+            switch (opk)
+              {
+              case 0: ComplexPanel<0> (ha, k2-k, pa, a.Dist(), memb, pc, dc, nc); break;
+              case 1: ComplexPanel<1> (ha, k2-k, pa, a.Dist(), memb, pc, dc, nc); break;
+              default: ComplexPanel<-1> (ha, k2-k, pa, a.Dist(), memb, pc, dc, nc); break;
+              }
+          }
+      }
+  }
+
+  void MultMatMat (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c)
+  { ComplexGEMM<false> (0, a, b, c); }
+  void AddAB (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c)
+  { ComplexGEMM<false> (1, a, b, c); }
+  void SubAB (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c)
+  { ComplexGEMM<false> (-1, a, b, c); }
+  
+  void MultABt (SliceMatrix<Complex> a, SliceMatrix<Complex> b, BareSliceMatrix<Complex> c)
+  { ComplexGEMM<true> (0, a, b, c); }
+  void AddABt (SliceMatrix<Complex> a, SliceMatrix<Complex> b, BareSliceMatrix<Complex> c)
+  { ComplexGEMM<true> (1, a, b, c); }
+  void SubABt (SliceMatrix<Complex> a, SliceMatrix<Complex> b, BareSliceMatrix<Complex> c)
+  { ComplexGEMM<true> (-1, a, b, c); }
+
+
+
+  /* ************************** float kernels ***************************** */
+
+  /*
+    Single precision versions of the GEMM kernels, SIMD<float> has twice
+    the lanes of SIMD<double>. B is packed into panels of 2*FSW columns,
+    the micro-kernel computes H rows times 2*FSW columns of C.
+    OP = 0: C = AB, OP = 1: C += AB, OP = -1: C -= AB
+  */
+  constexpr int FSW = GetDefaultFloatSIMDSize();
+  typedef SIMD<float,FSW> SIMDFloat;
+
+  template <size_t H, int OP>
+  INLINE void FloatMicroKernel (size_t wa, float * pa, size_t da,
+                                SIMDFloat * pb, float * pc, size_t dc, int nc)
+  {
+    SIMDFloat sum[H][2];
+    for (size_t i = 0; i < H; i++)
+      sum[i][0] = sum[i][1] = SIMDFloat(0.0f);
+
+    for (size_t k = 0; k < wa; k++, pb += 2)
+      {
+        SIMDFloat b0 = pb[0];
+        SIMDFloat b1 = pb[1];
+        for (size_t i = 0; i < H; i++)
+          {
+            SIMDFloat ai(pa[i*da+k]);
+            sum[i][0] = FMA(ai, b0, sum[i][0]);
+            sum[i][1] = FMA(ai, b1, sum[i][1]);
+          }
+      }
+
+    for (size_t i = 0; i < H; i++, pc += dc)
+      for (int l = 0; l < 2; l++)
+        {
+          int nr = nc - l*FSW;
+          if (nr <= 0) break;
+          if (nr >= FSW)
+            {
+              if (OP > 0) sum[i][l] = SIMDFloat(pc+l*FSW) + sum[i][l];
+              if (OP < 0) sum[i][l] = SIMDFloat(pc+l*FSW) - sum[i][l];
+              sum[i][l].Store (pc+l*FSW);
+            }
+          else
+            {
+              if (OP > 0) sum[i][l] = SIMDFloat(pc+l*FSW, nr) + sum[i][l];
+              if (OP < 0) sum[i][l] = SIMDFloat(pc+l*FSW, nr) - sum[i][l];
+              sum[i][l].Store (pc+l*FSW, nr);
+            }
+        }
+  }
+
+  template <int OP>
+  static void FloatPanel (size_t ha, size_t wa, float * pa, size_t da,
+                          SIMDFloat * pb, float * pc, size_t dc, int nc)
+  {
+    size_t i = 0;
+    for ( ; i+4 <= ha; i += 4)
+      FloatMicroKernel<4,OP> (wa, pa+i*da, da, pb, pc+i*dc, dc, nc);
+    for ( ; i < ha; i++)
+      FloatMicroKernel<1,OP> (wa, pa+i*da, da, pb, pc+i*dc, dc, nc);
+  }
+
+  // b is wa x wb (TRANSB = false), or wb x wa (TRANSB = true)
+  template <bool TRANSB>
+  static void FloatGEMM (int op, SliceMatrix<float> a, SliceMatrix<float> b,
+                         BareSliceMatrix<float> c)
+  {
+    constexpr size_t bk = 256;
+    size_t ha = a.Height(), wa = a.Width();
+    size_t wb = TRANSB ? b.Height() : b.Width();
+    size_t dc = c.Dist();
+    if (ha == 0 || wb == 0) return;
+    if (wa == 0)
+      {
+        if (op == 0) c.AddSize(ha, wb) = 0.0f;
+        return;
+      }
+    
+    SIMDFloat memb[2*bk];
+    float tmp[2*FSW];
+    for (size_t k = 0; k < wa; k += bk)
+      {
+        size_t k2 = min2(k+bk, wa);
+        // the first block sets C, the next ones add to it
+        int opk = (k == 0 || op != 0) ? op : 1;
+        for (size_t j = 0; j < wb; j += 2*FSW)
+          {
+            int nc = min2(size_t(2*FSW), wb-j);
+            for (size_t kk = k; kk < k2; kk++)
+              {
+                SIMDFloat * pb = memb+2*(kk-k);
+                if (!TRANSB)
+                  {
+                    float * prow = &b(kk,j);
+                    if (nc == 2*FSW)
+                      {
+                        pb[0] = SIMDFloat(prow);
+                        pb[1] = SIMDFloat(prow+FSW);
+                      }
+                    else
+                      {
+                        pb[0] = SIMDFloat(prow, nc);
+                        pb[1] = (nc > FSW) ? SIMDFloat(prow+FSW, nc-FSW) : SIMDFloat(0.0f);
+                      }
+                  }
+                else
+                  {
+                    for (int jj = 0; jj < 2*FSW; jj++)
+                      tmp[jj] = (jj < nc) ? b(j+jj,kk) : 0.0f;
+                    pb[0] = SIMDFloat(tmp);
+                    pb[1] = SIMDFloat(tmp+FSW);
+                  }
+              }
+            
+            float * pa = &a(0,k);
+            float * pc = &c(0,j);
+            switch (opk)
+              {
+              case 0: FloatPanel<0> (ha, k2-k, pa, a.Dist(), memb, pc, dc, nc); break;
+              case 1: FloatPanel<1> (ha, k2-k, pa, a.Dist(), memb, pc, dc, nc); break;
+              default: FloatPanel<-1> (ha, k2-k, pa, a.Dist(), memb, pc, dc, nc); break;
+              }
+          }
+      }
+  }
+
+  void MultMatMat (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c)
+  { FloatGEMM<false> (0, a, b, c); }
+  void AddAB (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c)
+  { FloatGEMM<false> (1, a, b, c); }
+  void SubAB (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c)
+  { FloatGEMM<false> (-1, a, b, c); }
+  
+  void MultABt (SliceMatrix<float> a, SliceMatrix<float> b, BareSliceMatrix<float> c)
+  { FloatGEMM<true> (0, a, b, c); }
+  void AddABt (SliceMatrix<float> a, SliceMatrix<float> b, BareSliceMatrix<float> c)
+  { FloatGEMM<true> (1, a, b, c); }
+  void SubABt (SliceMatrix<float> a, SliceMatrix<float> b, BareSliceMatrix<float> c)
+  { FloatGEMM<true> (-1, a, b, c); }
+
+
+  // y = s * A x  (ADD = false),  y += s * A x  (ADD = true)
+  template <bool ADD>
+  static void FloatMatVec (float s, BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y)
+  {
+    size_t h = y.Size(), w = x.Size();
+    size_t da = a.Dist();
+    float * px = x.Data();
+    size_t i = 0;
+    for ( ; i+4 <= h; i += 4)
+      {
+        float * pa = &a(i,0);
+        SIMDFloat sum0(0.0f), sum1(0.0f), sum2(0.0f), sum3(0.0f);
+        size_t k = 0;
+        for ( ; k+FSW <= w; k += FSW)
+          {
+            SIMDFloat xk(px+k);
+            sum0 = FMA(SIMDFloat(pa+k), xk, sum0);
+            sum1 = FMA(SIMDFloat(pa+da+k), xk, sum1);
+            sum2 = FMA(SIMDFloat(pa+2*da+k), xk, sum2);
+            sum3 = FMA(SIMDFloat(pa+3*da+k), xk, sum3);
+          }
+        if (k < w)
+          {
+            int nr = w-k;
+            SIMDFloat xk(px+k, nr);
+            sum0 = FMA(SIMDFloat(pa+k, nr), xk, sum0);
+            sum1 = FMA(SIMDFloat(pa+da+k, nr), xk, sum1);
+            sum2 = FMA(SIMDFloat(pa+2*da+k, nr), xk, sum2);
+            sum3 = FMA(SIMDFloat(pa+3*da+k, nr), xk, sum3);
+          }
+        float hsum[4] = { HSum(sum0), HSum(sum1), HSum(sum2), HSum(sum3) };
+        for (size_t l = 0; l < 4; l++)
+          if (ADD)
+            y(i+l) += s * hsum[l];
+          else
+            y(i+l) = s * hsum[l];
+      }
+    for ( ; i < h; i++)
+      {
+        float * pa = &a(i,0);
+        SIMDFloat sum(0.0f);
+        size_t k = 0;
+        for ( ; k+FSW <= w; k += FSW)
+          sum = FMA(SIMDFloat(pa+k), SIMDFloat(px+k), sum);
+        if (k < w)
+          sum = FMA(SIMDFloat(pa+k, w-k), SIMDFloat(px+k, w-k), sum);
+        if (ADD)
+          y(i) += s * HSum(sum);
+        else
+          y(i) = s * HSum(sum);
+      }
+  }
+
+  void MultMatVec (BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y)
+  { FloatMatVec<false> (1.0f, a, x, y); }
+  void MultAddMatVec (float s, BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y)
+  { FloatMatVec<true> (s, a, x, y); }
+
+  // y += s * A^T x, rows of A are added to y
+  static void FloatAddMatTransVec (float s, BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y)
+  {
+    size_t h = x.Size(), w = y.Size();
+    float * py = y.Data();
+    for (size_t i = 0; i < h; i++)
+      {
+        float * pa = &a(i,0);
+        SIMDFloat xi(s*x(i));
+        size_t k = 0;
+        for ( ; k+FSW <= w; k += FSW)
+          FMA(xi, SIMDFloat(pa+k), SIMDFloat(py+k)).Store(py+k);
+        if (k < w)
+          FMA(xi, SIMDFloat(pa+k, w-k), SIMDFloat(py+k, w-k)).Store(py+k, w-k);
+      }
+  }
+  
+  void MultMatTransVec (BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y)
+  {
+    y = 0.0f;
+    FloatAddMatTransVec (1.0f, a, x, y);
+  }
+  void MultAddMatTransVec (float s, BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y)
+  { FloatAddMatTransVec (s, a, x, y); }
+
+
+  void ConvertMatrix (SliceMatrix<double> a, SliceMatrix<float> b)
+  {
+    // double vectors with half the lanes of the float vector
+    constexpr int SW = FSW/2;
+    typedef SIMD<double,SW> SIMDD;
+    size_t w = a.Width();
+    for (size_t i = 0; i < a.Height(); i++)
+      {
+        double * pa = &a(i,0);
+        float * pb = &b(i,0);
+        size_t j = 0;
+#if defined(__SSE__) || defined(__ARM_NEON)
+        for ( ; j+FSW <= w; j += FSW)
+          ConvertToFloat (SIMDD(pa+j), SIMDD(pa+j+SW)).Store(pb+j);
+#endif
+        for ( ; j < w; j++)
+          pb[j] = pa[j];
+      }
+  }
+
+  void ConvertMatrix (SliceMatrix<float> a, SliceMatrix<double> b)
+  {
+    // double vectors with half the lanes of the float vector
+    constexpr int SW = FSW/2;
+    typedef SIMD<double,SW> SIMDD;
+    size_t w = a.Width();
+    for (size_t i = 0; i < a.Height(); i++)
+      {
+        float * pa = &a(i,0);
+        double * pb = &b(i,0);
+        size_t j = 0;
+#if defined(__SSE__) || defined(__ARM_NEON)
+        for ( ; j+FSW <= w; j += FSW)
+          {
+            SIMDD lo, hi;
+            tie(lo,hi) = ConvertToDouble (SIMDFloat(pa+j));
+            lo.Store(pb+j);
+            hi.Store(pb+j+SW);
+          }
+#endif
+        for ( ; j < w; j++)
+          pb[j] = pa[j];
+      }
+  }
+
+  
+
   /* ************************** SubAtDB ***************************** */
 
   static constexpr size_t NA = 128;
@@ -2076,6 +2659,7 @@ namespace ngbla
   {
     static Timer t("SubADBt"); RegionTimer r(t);
     t.AddFlops(diag.Size()*c.Height()*c.Width());
+    Roofline::AddBytes (t, sizeof(double) * ((a.Height()+b.Height())*diag.Size() + 2*c.Height()*c.Width()));
     constexpr size_t N = 128;
     constexpr size_t M = 128;
     double memb[N*M];
@@ -2390,6 +2974,525 @@ namespace ngbla
 
   
 
+  /**************** triangular solve, Cholesky, LU *********************** */
+
+  /*
+    Recursive blocking: the triangular matrix is split in halves, the
+    off-diagonal block is a SubAB or SubABt with the blocked SIMD kernels,
+    below 32 rows the leaves are solved directly.
+    Large updates are split into tasks.
+  */
+  
+  constexpr size_t trig_leaf = 32;
+
+  // c -= a*b, blocks of c are tasks
+  static void ParallelSubAB (SliceMatrix<double> a, SliceMatrix<double> b, SliceMatrix<double> c)
+  {
+    constexpr size_t BH = 96, BW = 128;
+    size_t nr = (c.Height()+BH-1) / BH;
+    size_t nc = (c.Width()+BW-1) / BW;
+    if (nr*nc < 4 || double(c.Height())*c.Width()*a.Width() < 1e6)
+      {
+        SubAB (a, b, c);
+        return;
+      }
+    ParallelFor (nr*nc, [&] (size_t task)
+                 {
+                   size_t br = task % nr, bc = task / nr;
+                   IntRange rr(BH*br, min2(BH*(br+1), c.Height()));
+                   IntRange rc(BW*bc, min2(BW*(bc+1), c.Width()));
+                   SubAB (a.Rows(rr), b.Cols(rc), c.Rows(rr).Cols(rc));
+                 });
+  }
+
+  // lower triangle of c -= a*a^T
+  static void ParallelSubAAtLower (SliceMatrix<double> a, SliceMatrix<double> c)
+  {
+    constexpr size_t BS = 96;
+    size_t nb = (c.Height()+BS-1) / BS;
+    auto block = [&] (size_t bi, size_t bj)
+      {
+        IntRange ri(BS*bi, min2(BS*(bi+1), c.Height()));
+        IntRange rj(BS*bj, min2(BS*(bj+1), c.Height()));
+        if (bi > bj)
+          SubABt (a.Rows(ri), a.Rows(rj), c.Rows(ri).Cols(rj));
+        else
+          {
+            // diagonal block, the upper part of c is not touched
+            Matrix<> tmp(ri.Size());
+            tmp = 0.0;
+            AddABt (a.Rows(ri), a.Rows(ri), tmp);
+            for (size_t i = 0; i < ri.Size(); i++)
+              for (size_t j = 0; j <= i; j++)
+                c(ri.First()+i, ri.First()+j) -= tmp(i,j);
+          }
+      };
+    if (nb < 3 || double(c.Height())*c.Height()*a.Width() < 2e6)
+      {
+        for (size_t bi = 0; bi < nb; bi++)
+          for (size_t bj = 0; bj <= bi; bj++)
+            block (bi, bj);
+        return;
+      }
+    ParallelFor (nb*(nb+1)/2, [&] (size_t task)
+                 {
+                   size_t bi = size_t((sqrt(8.0*task+1)-1)/2);
+                   while (bi*(bi+1)/2 > task) bi--;
+                   while ((bi+1)*(bi+2)/2 <= task) bi++;
+                   block (bi, task - bi*(bi+1)/2);
+                 });
+  }
+
+  // columns of x are independent
+  template <typename FUNC>
+  static void ParallelCols (size_t n, SliceMatrix<double> x, FUNC func)
+  {
+    constexpr size_t BW = 128;
+    size_t nb = x.Width() / BW;
+    if (nb < 2 || double(n)*n*x.Width() < 2e6)
+      func (x);
+    else
+      ParallelFor (nb, [&] (size_t b)
+                   {
+                     func (x.Cols (Range(x.Width()).Split(b, nb)));
+                   });
+  }
+
+  // rows of x are independent
+  template <typename FUNC>
+  static void ParallelRows (size_t n, SliceMatrix<double> x, FUNC func)
+  {
+    constexpr size_t BH = 96;
+    size_t nb = x.Height() / BH;
+    if (nb < 2 || double(n)*n*x.Height() < 2e6)
+      func (x);
+    else
+      ParallelFor (nb, [&] (size_t b)
+                   {
+                     func (x.Rows (Range(x.Height()).Split(b, nb)));
+                   });
+  }
+    
+  template <TRIG_NORMAL NORM>
+  static void TriangularSolveLL (SliceMatrix<double> l, SliceMatrix<double> x)
+  {
+    size_t n = l.Height();
+    if (n <= trig_leaf)
+      {
+        for (size_t i = 0; i < n; i++)
+          {
+            auto xi = x.Row(i);
+            for (size_t k = 0; k < i; k++)
+              xi -= l(i,k) * x.Row(k);
+            if (NORM == NonNormalized)
+              xi *= 1.0/l(i,i);
+          }
+        return;
+      }
+    size_t n1 = n/2;
+    TriangularSolveLL<NORM> (l.Rows(0,n1).Cols(0,n1), x.Rows(0,n1));
+    SubAB (l.Rows(n1,n).Cols(0,n1), x.Rows(0,n1), x.Rows(n1,n));
+    TriangularSolveLL<NORM> (l.Rows(n1,n).Cols(n1,n), x.Rows(n1,n));
+  }
+
+  template <TRIG_NORMAL NORM>
+  static void TriangularSolveUR (SliceMatrix<double> u, SliceMatrix<double> x)
+  {
+    size_t n = u.Height();
+    if (n <= trig_leaf)
+      {
+        for (size_t i = n; i-- > 0; )
+          {
+            auto xi = x.Row(i);
+            for (size_t k = i+1; k < n; k++)
+              xi -= u(i,k) * x.Row(k);
+            if (NORM == NonNormalized)
+              xi *= 1.0/u(i,i);
+          }
+        return;
+      }
+    size_t n1 = n/2;
+    TriangularSolveUR<NORM> (u.Rows(n1,n).Cols(n1,n), x.Rows(n1,n));
+    SubAB (u.Rows(0,n1).Cols(n1,n), x.Rows(n1,n), x.Rows(0,n1));
+    TriangularSolveUR<NORM> (u.Rows(0,n1).Cols(0,n1), x.Rows(0,n1));
+  }
+
+  template <TRIG_SIDE SIDE, TRIG_NORMAL NORM>
+  void TriangularSolve (SliceMatrix<double> t, SliceMatrix<double> x)
+  {
+    ParallelCols (t.Height(), x, [t] (SliceMatrix<double> hx)
+                  {
+                    if (SIDE == LowerLeft)
+                      TriangularSolveLL<NORM> (t, hx);
+                    else
+                      TriangularSolveUR<NORM> (t, hx);
+                  });
+  }
+
+  template NGS_DLL_HEADER void TriangularSolve<LowerLeft,Normalized> (SliceMatrix<double> t, SliceMatrix<double> x);
+  template NGS_DLL_HEADER void TriangularSolve<LowerLeft,NonNormalized> (SliceMatrix<double> t, SliceMatrix<double> x);
+  template NGS_DLL_HEADER void TriangularSolve<UpperRight,Normalized> (SliceMatrix<double> t, SliceMatrix<double> x);
+  template NGS_DLL_HEADER void TriangularSolve<UpperRight,NonNormalized> (SliceMatrix<double> t, SliceMatrix<double> x);
+
+  // x <- x l^{-T}
+  static void TriangularSolveRightLT (SliceMatrix<double> l, SliceMatrix<double> x)
+  {
+    size_t n = l.Height();
+    if (n <= trig_leaf)
+      {
+        for (size_t k = 0; k < x.Height(); k++)
+          {
+            auto xk = x.Row(k);
+            for (size_t j = 0; j < n; j++)
+              {
+                auto lj = l.Row(j);
+                double sum = xk(j);
+                for (size_t q = 0; q < j; q++)
+                  sum -= lj(q) * xk(q);
+                xk(j) = sum / lj(j);
+              }
+          }
+        return;
+      }
+    size_t n1 = n/2;
+    TriangularSolveRightLT (l.Rows(0,n1).Cols(0,n1), x.Cols(0,n1));
+    SubABt (x.Cols(0,n1), l.Rows(n1,n).Cols(0,n1), x.Cols(n1,n));
+    TriangularSolveRightLT (l.Rows(n1,n).Cols(n1,n), x.Cols(n1,n));
+  }
+  
+  static void CholeskyFactorRec (SliceMatrix<double> a)
+  {
+    size_t n = a.Height();
+    if (n <= trig_leaf)
+      {
+        for (size_t k = 0; k < n; k++)
+          {
+            auto ak = a.Row(k);
+            for (size_t i = k; i < n; i++)
+              {
+                auto ai = a.Row(i);
+                double sum = ai(k);
+                for (size_t q = 0; q < k; q++)
+                  sum -= ai(q) * ak(q);
+                if (i == k)
+                  {
+                    if (! (sum > 0))
+                      throw Exception ("CholeskyFactor: Matrix not positive definite");
+                    ak(k) = sqrt(sum);
+                  }
+                else
+                  ai(k) = sum / ak(k);
+              }
+          }
+        return;
+      }
+
+    size_t n1 = n/2;
+    auto a11 = a.Rows(0,n1).Cols(0,n1);
+    auto a21 = a.Rows(n1,n).Cols(0,n1);
+    auto a22 = a.Rows(n1,n).Cols(n1,n);
+    CholeskyFactorRec (a11);
+    ParallelRows (n1, a21, [a11] (SliceMatrix<double> x) { TriangularSolveRightLT (a11, x); });
+    ParallelSubAAtLower (a21, a22);
+    CholeskyFactorRec (a22);
+  }
+
+  void CholeskyFactor (SliceMatrix<double> a)
+  {
+    size_t n = a.Height();
+    if (n <= trig_leaf)
+      {
+        CholeskyFactorRec (a);
+        return;
+      }
+    static Timer t("CholeskyFactor"); RegionTimer reg(t);
+    t.AddFlops (double(n)*n*n/3);
+    CholeskyFactorRec (a);
+  }
+
+  
+  static void SwapRows (SliceMatrix<double> a, size_t i, size_t j)
+  {
+    if (i == j) return;
+    auto ai = a.Row(i);
+    auto aj = a.Row(j);
+    for (size_t k = 0; k < a.Width(); k++)
+      swap (ai(k), aj(k));
+  }
+  
+  // panel m x n, m >= n
+  static void CalcLUPanel (SliceMatrix<double> a, FlatArray<int> p)
+  {
+    size_t m = a.Height(), n = a.Width();
+    if (n <= 16)
+      {
+        for (size_t j = 0; j < n; j++)
+          {
+            size_t r = j;
+            double maxval = fabs(a(j,j));
+            for (size_t i = j+1; i < m; i++)
+              if (fabs(a(i,j)) > maxval)
+                {
+                  r = i;
+                  maxval = fabs(a(i,j));
+                }
+            if (maxval == 0)
+              throw Exception ("CalcLU: Matrix singular");
+            p[j] = r;
+            SwapRows (a, j, r);
+            
+            double inv = 1.0 / a(j,j);
+            auto aj = a.Row(j).Range(j+1,n);
+            for (size_t i = j+1; i < m; i++)
+              {
+                a(i,j) *= inv;
+                a.Row(i).Range(j+1,n) -= a(i,j) * aj;
+              }
+          }
+        return;
+      }
+
+    size_t n1 = n/2;
+    auto left = a.Cols(0,n1);
+    auto right = a.Cols(n1,n);
+    CalcLUPanel (left, p.Range(0,n1));
+    for (size_t j = 0; j < n1; j++)
+      SwapRows (right, j, p[j]);
+    
+    TriangularSolve<LowerLeft,Normalized> (left.Rows(0,n1), right.Rows(0,n1));
+    ParallelSubAB (left.Rows(n1,m), right.Rows(0,n1), right.Rows(n1,m));
+    
+    CalcLUPanel (right.Rows(n1,m), p.Range(n1,n));
+    for (size_t j = n1; j < n; j++)
+      {
+        p[j] += n1;
+        SwapRows (left, j, p[j]);
+      }
+  }
+  
+  void CalcLU (SliceMatrix<double> a, FlatArray<int> p)
+  {
+    static Timer t("CalcLU"); RegionTimer reg(t);
+    size_t n = a.Height();
+    t.AddFlops (2.0*n*n*n/3);
+    if (a.Width() != n || p.Size() != n)
+      throw Exception ("CalcLU: matrix not square or wrong pivot array size");
+    CalcLUPanel (a, p);
+  }
+
+  void InverseFromLU (SliceMatrix<double> a, FlatArray<int> p)
+  {
+    static Timer t("InverseFromLU"); RegionTimer reg(t);
+    size_t n = a.Height();
+    Matrix<> x(n, n);
+    x = Identity(n);
+    for (size_t j = 0; j < n; j++)
+      SwapRows (x, j, p[j]);
+    TriangularSolve<LowerLeft,Normalized> (a, x);
+    TriangularSolve<UpperRight,NonNormalized> (a, x);
+    a = x;
+  }
+
+  
+
+  /**************** tuning of block sizes *********************** */
+
+  BlasBlocking blas_blocking;
+
+  string BlasTuningKey ()
+  {
+    string model = "unknown";
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line))
+      if (line.compare(0, 10, "model name") == 0)
+        {
+          auto pos = line.find(':');
+          if (pos != string::npos)
+            model = line.substr(pos+2);
+          break;
+        }
+    for (auto & c : model)
+      if (isspace(c)) c = '_';
+
+    long l1 = 0, l2 = 0;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return model + "-SW" + ToString(SIMD<double>::Size())
+      + "-L1_" + ToString(l1/1024) + "k-L2_" + ToString(l2/1024) + "k";
+  }
+
+  string BlasTuningCacheFile ()
+  {
+    if (const char * file = getenv ("NGS_BLAS_TUNING_FILE")) return file;
+    if (const char * dir = getenv ("XDG_CACHE_HOME")) return string(dir) + "/ngsolve/blas_blocking.txt";
+    if (const char * dir = getenv ("HOME")) return string(dir) + "/.cache/ngsolve/blas_blocking.txt";
+    return "";
+  }
+
+  static bool ValidBlocking (const BlasBlocking & bb)
+  {
+    size_t SW = SIMD<double>::Size();
+    return bb.mm_k > 0 && bb.mm_k <= 128 && bb.mm_w >= SW && bb.mm_w % SW == 0 &&
+      bb.mm_k*bb.mm_w <= 128*96 && bb.abt_k > 0 && bb.abt_ha > 0 && bb.abt_hb > 0;
+  }
+  
+  // one line per cpu:  key mm_k mm_w abt_k abt_ha abt_hb
+  bool LoadBlasBlocking (const string & filename)
+  {
+    if (filename.empty()) return false;
+    ifstream ifs(filename);
+    string key = BlasTuningKey();
+    string line;
+    while (getline(ifs, line))
+      {
+        istringstream ist(line);
+        string lkey;
+        BlasBlocking bb;
+        if (ist >> lkey >> bb.mm_k >> bb.mm_w >> bb.abt_k >> bb.abt_ha >> bb.abt_hb)
+          if (lkey == key && ValidBlocking(bb))
+            {
+              blas_blocking = bb;
+              return true;
+            }
+      }
+    return false;
+  }
+
+  void SaveBlasBlocking (const string & filename)
+  {
+    if (filename.empty()) return;
+    string key = BlasTuningKey();
+    // keep the entries of the other cpus
+    Array<string> lines;
+    {
+      ifstream ifs(filename);
+      string line;
+      while (getline(ifs, line))
+        if (line.compare(0, key.size()+1, key+" ") != 0)
+          lines.Append (line);
+    }
+#ifndef WIN32
+    for (size_t pos = filename.find('/', 1); pos != string::npos; pos = filename.find('/', pos+1))
+      mkdir (filename.substr(0,pos).c_str(), 0755);
+#endif
+    ofstream ofs(filename);
+    if (!ofs)
+      throw Exception ("SaveBlasBlocking: cannot write " + filename);
+    for (auto & line : lines)
+      ofs << line << endl;
+    auto & bb = blas_blocking;
+    ofs << key << " " << bb.mm_k << " " << bb.mm_w << " " << bb.abt_k
+        << " " << bb.abt_ha << " " << bb.abt_hb << endl;
+  }
+
+  static bool load_blas_blocking = [] ()
+  {
+    try
+      {
+        return LoadBlasBlocking (BlasTuningCacheFile());
+      }
+    catch (...) { return false; }
+  } ();
+
+  // GFlops of func, best of 3 runs
+  template <typename FUNC>
+  static double MeasureGFlops (double flops, FUNC func)
+  {
+    func();  // warm up
+    int its = int(max(1.0, 2e8 / flops));
+    double best = 0;
+    for (int r = 0; r < 3; r++)
+      {
+        double start = WallTime();
+        for (int j = 0; j < its; j++)
+          func();
+        double time = WallTime()-start;
+        best = max(best, flops*its / time * 1e-9);
+      }
+    return best;
+  }
+  
+  BlasBlocking TuneBlasBlocking (size_t n, bool save, bool verbose)
+  {
+    static Timer t("TuneBlasBlocking"); RegionTimer reg(t);
+    size_t SW = SIMD<double>::Size();
+    size_t l2 = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    l2 = max(0l, sysconf(_SC_LEVEL2_CACHE_SIZE));
+#endif
+    if (l2 == 0) l2 = 256*1024;
+    
+    Matrix<> a(n,n), b(n,n), c(n,n);
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        {
+          a(i,j) = sin(i+1) * cos(j);
+          b(i,j) = cos(i+3) * cos(j);
+        }
+    c = 0.0;
+    double flops = 2.0*n*n*n;
+
+    BlasBlocking best = blas_blocking;
+    if (verbose)
+      cout << "tuning blocking for " << BlasTuningKey() << ", L2 = " << l2/1024 << "k" << endl;
+
+    // packed B block of MultMatMat
+    double bestmm = 0;
+    for (size_t mm_k : { 64, 96, 128 })
+      for (size_t mm_w : { 32, 48, 64, 96, 128, 192 })
+        {
+          BlasBlocking bb = best;
+          bb.mm_k = mm_k;
+          bb.mm_w = mm_w;
+          if (!ValidBlocking(bb) || mm_k*mm_w*sizeof(double) > l2) continue;
+          blas_blocking = bb;
+          double gf = MeasureGFlops (flops, [&] () { c = a * b; });
+          if (verbose)
+            cout << "MultMatMat  k = " << mm_k << ", w = " << mm_w << ": " << gf << " GFlops" << endl;
+          if (gf > bestmm)
+            {
+              bestmm = gf;
+              best.mm_k = mm_k;
+              best.mm_w = mm_w;
+            }
+        }
+
+    // blocks of AddABt, A and B blocks should stay in L2
+    double bestabt = 0;
+    for (size_t abt_k : { 128, 256, 512 })
+      for (size_t abt_ha : { 48, 96, 192 })
+        for (size_t abt_hb : { 16, 32, 64 })
+          {
+            BlasBlocking bb = best;
+            bb.abt_k = abt_k;
+            bb.abt_ha = abt_ha;
+            bb.abt_hb = abt_hb;
+            if ((abt_ha+abt_hb)*abt_k*sizeof(double) > l2) continue;
+            blas_blocking = bb;
+            double gf = MeasureGFlops (flops, [&] () { c += a * Trans(b); });
+            if (verbose)
+              cout << "AddABt  k = " << abt_k << ", ha = " << abt_ha << ", hb = " << abt_hb
+                   << ": " << gf << " GFlops" << endl;
+            if (gf > bestabt)
+              {
+                bestabt = gf;
+                best.abt_k = abt_k;
+                best.abt_ha = abt_ha;
+                best.abt_hb = abt_hb;
+              }
+          }
+
+    blas_blocking = best;
+    if (save)
+      SaveBlasBlocking (BlasTuningCacheFile());
+    return best;
+  }
+
+  
+
   /**************** timings *********************** */
 
   
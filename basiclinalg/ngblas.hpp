@@ -162,6 +162,11 @@ namespace ngbla
       SubAB_intern (a.Height(), a.Width(), b.Width(), a, b, c);
   }
 
+  // SIMD<Complex> kernels, B is packed in split real/imag layout
+  extern NGS_DLL_HEADER void MultMatMat (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c);
+  extern NGS_DLL_HEADER void AddAB (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c);
+  extern NGS_DLL_HEADER void SubAB (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c);
+
 
 
   
@@ -204,6 +209,27 @@ namespace ngbla
   extern NGS_DLL_HEADER void AddABt (SliceMatrix<double> a, SliceMatrix<double> b, BareSliceMatrix<double> c);  
   extern NGS_DLL_HEADER void SubABt (SliceMatrix<double> a, SliceMatrix<double> b, BareSliceMatrix<double> c);
 
+  extern NGS_DLL_HEADER void MultABt (SliceMatrix<Complex> a, SliceMatrix<Complex> b, BareSliceMatrix<Complex> c);
+  extern NGS_DLL_HEADER void AddABt (SliceMatrix<Complex> a, SliceMatrix<Complex> b, BareSliceMatrix<Complex> c);
+  extern NGS_DLL_HEADER void SubABt (SliceMatrix<Complex> a, SliceMatrix<Complex> b, BareSliceMatrix<Complex> c);
+
+  // single precision SIMD kernels
+  extern NGS_DLL_HEADER void MultMatMat (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c);
+  extern NGS_DLL_HEADER void AddAB (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c);
+  extern NGS_DLL_HEADER void SubAB (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c);
+  extern NGS_DLL_HEADER void MultABt (SliceMatrix<float> a, SliceMatrix<float> b, BareSliceMatrix<float> c);
+  extern NGS_DLL_HEADER void AddABt (SliceMatrix<float> a, SliceMatrix<float> b, BareSliceMatrix<float> c);
+  extern NGS_DLL_HEADER void SubABt (SliceMatrix<float> a, SliceMatrix<float> b, BareSliceMatrix<float> c);
+
+  extern NGS_DLL_HEADER void MultMatVec (BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y);
+  extern NGS_DLL_HEADER void MultAddMatVec (float s, BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y);
+  extern NGS_DLL_HEADER void MultMatTransVec (BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y);
+  extern NGS_DLL_HEADER void MultAddMatTransVec (float s, BareSliceMatrix<float> a, FlatVector<float> x, FlatVector<float> y);
+
+  /// b = a, conversion between single and double precision
+  extern NGS_DLL_HEADER void ConvertMatrix (SliceMatrix<double> a, SliceMatrix<float> b);
+  extern NGS_DLL_HEADER void ConvertMatrix (SliceMatrix<float> a, SliceMatrix<double> b);
+
   extern NGS_DLL_HEADER void AddABt (SliceMatrix<SIMD<double>> a, SliceMatrix<SIMD<double>> b, BareSliceMatrix<double> c);  
   extern NGS_DLL_HEADER void SubABt (SliceMatrix<SIMD<double>> a, SliceMatrix<SIMD<double>> b, BareSliceMatrix<double> c);
 
@@ -416,6 +442,141 @@ namespace ngbla
   }
 
 
+
+  template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
+  INLINE void NgGEMM (SliceMatrix<Complex,orda> a, SliceMatrix<Complex, ordb> b, SliceMatrix<Complex> c)
+  {
+    if (!ADD)
+      {
+        if (!POS)
+          c = -1*a*b;
+        else
+          c = 1*a*b;
+      }
+    else
+      {
+        if (!POS)
+          c -= 1*a*b;
+        else
+          c += 1*a*b;
+      }
+  }
+
+  template <> INLINE void NgGEMM<false,true> (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c)
+  {
+    MultMatMat (a,b,c);
+  }
+
+  template <> INLINE void NgGEMM<true,true> (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c)
+  {
+    AddAB (a,b,c);
+  }
+
+  template <> INLINE void NgGEMM<true,false> (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c)
+  {
+    SubAB (a,b,c);
+  }
+
+  template <> INLINE void NgGEMM<false,false> (SliceMatrix<Complex> a, SliceMatrix<Complex> b, SliceMatrix<Complex> c)
+  {
+    c = Complex(0.0);
+    SubAB (a,b,c);
+  }
+
+  template <> INLINE void NgGEMM<false,true> (SliceMatrix<Complex> a, SliceMatrix<Complex,ColMajor> b, SliceMatrix<Complex> c)
+  {
+    MultABt (a, Trans(b), c);
+  }
+
+  template <> INLINE void NgGEMM<true,true> (SliceMatrix<Complex> a, SliceMatrix<Complex,ColMajor> b, SliceMatrix<Complex> c)
+  {
+    AddABt (a, Trans(b), c);
+  }
+
+  template <> INLINE void NgGEMM<true,false> (SliceMatrix<Complex> a, SliceMatrix<Complex,ColMajor> b, SliceMatrix<Complex> c)
+  {
+    SubABt (a, Trans(b), c);
+  }
+
+  template <> INLINE void NgGEMM<false,false> (SliceMatrix<Complex> a, SliceMatrix<Complex,ColMajor> b, SliceMatrix<Complex> c)
+  {
+    c = Complex(0.0);
+    SubABt (a, Trans(b), c);
+  }
+
+  template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
+  INLINE void NgGEMM (SliceMatrix<Complex,orda> a, SliceMatrix<Complex, ordb> b, SliceMatrix<Complex,ColMajor> c)
+  {
+    NgGEMM<ADD,POS> (Trans(b), Trans(a), Trans(c));
+  }
+
+  template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
+  INLINE void NgGEMM (SliceMatrix<float,orda> a, SliceMatrix<float, ordb> b, SliceMatrix<float> c)
+  {
+    if (!ADD)
+      {
+        if (!POS)
+          c = -1*a*b;
+        else
+          c = 1*a*b;
+      }
+    else
+      {
+        if (!POS)
+          c -= 1*a*b;
+        else
+          c += 1*a*b;
+      }
+  }
+
+  template <> INLINE void NgGEMM<false,true> (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c)
+  {
+    MultMatMat (a,b,c);
+  }
+
+  template <> INLINE void NgGEMM<true,true> (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c)
+  {
+    AddAB (a,b,c);
+  }
+
+  template <> INLINE void NgGEMM<true,false> (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c)
+  {
+    SubAB (a,b,c);
+  }
+
+  template <> INLINE void NgGEMM<false,false> (SliceMatrix<float> a, SliceMatrix<float> b, SliceMatrix<float> c)
+  {
+    c = 0.0f;
+    SubAB (a,b,c);
+  }
+
+  template <> INLINE void NgGEMM<false,true> (SliceMatrix<float> a, SliceMatrix<float,ColMajor> b, SliceMatrix<float> c)
+  {
+    MultABt (a, Trans(b), c);
+  }
+
+  template <> INLINE void NgGEMM<true,true> (SliceMatrix<float> a, SliceMatrix<float,ColMajor> b, SliceMatrix<float> c)
+  {
+    AddABt (a, Trans(b), c);
+  }
+
+  template <> INLINE void NgGEMM<true,false> (SliceMatrix<float> a, SliceMatrix<float,ColMajor> b, SliceMatrix<float> c)
+  {
+    SubABt (a, Trans(b), c);
+  }
+
+  template <> INLINE void NgGEMM<false,false> (SliceMatrix<float> a, SliceMatrix<float,ColMajor> b, SliceMatrix<float> c)
+  {
+    c = 0.0f;
+    SubABt (a, Trans(b), c);
+  }
+
+  template <bool ADD, bool POS, ORDERING orda, ORDERING ordb>
+  INLINE void NgGEMM (SliceMatrix<float,orda> a, SliceMatrix<float, ordb> b, SliceMatrix<float,ColMajor> c)
+  {
+    NgGEMM<ADD,POS> (Trans(b), Trans(a), Trans(c));
+  }
+
   template <bool A, bool P, ORDERING oa>
   class vtrait__
   {
@@ -482,6 +643,70 @@ namespace ngbla
     MultAddMatTransVec (-1,Trans(a),x,y);
   }
 
+  template <bool ADD, bool POS, ORDERING ord>
+  INLINE void NgGEMV (SliceMatrix<float,ord> a, FlatVector<float> x, FlatVector<float> y)
+  {
+    if constexpr (ord == RowMajor)
+      {
+        if (!ADD && POS)
+          MultMatVec (a, x, y);
+        else
+          {
+            if (!ADD) y = 0.0f;
+            MultAddMatVec (POS ? 1.0f : -1.0f, a, x, y);
+          }
+      }
+    else
+      {
+        if (!ADD) y = 0.0f;
+        MultAddMatTransVec (POS ? 1.0f : -1.0f, Trans(a), x, y);
+      }
+  }
+
+  
+  enum TRIG_SIDE { LowerLeft, UpperRight };
+  enum TRIG_NORMAL { Normalized, NonNormalized };
+
+  /// x <- t^{-1} x, t triangular, the diagonal is not accessed for Normalized
+  template <TRIG_SIDE SIDE, TRIG_NORMAL NORM=NonNormalized>
+  extern NGS_DLL_HEADER void TriangularSolve (SliceMatrix<double> t, SliceMatrix<double> x);
+
+  /// a = L L^T, L is stored in the lower triangle, the upper one is not touched
+  extern NGS_DLL_HEADER void CholeskyFactor (SliceMatrix<double> a);
+
+  /// P a = L U with row pivoting, L normalized, row i was exchanged with row p[i] in step i
+  extern NGS_DLL_HEADER void CalcLU (SliceMatrix<double> a, FlatArray<int> p);
+  /// a = inverse, from the factors of CalcLU
+  extern NGS_DLL_HEADER void InverseFromLU (SliceMatrix<double> a, FlatArray<int> p);
+
+  
+  /*
+    Block sizes of MultMatMat_intern and the AddABt kernels.
+    At startup, the entry for the current CPU is read from the tuning
+    cache (see BlasTuningCacheFile), TuneBlasBlocking benchmarks candidates
+    and writes the entry.
+   */
+  struct BlasBlocking
+  {
+    size_t mm_k = 128;   // height of the packed B block, at most 128
+    size_t mm_w = 96;    // width of the packed B block, multiple of SW, mm_k*mm_w <= 128*96
+    size_t abt_k = 256;  // inner product length of AddABt
+    size_t abt_ha = 96;  // block height of A in AddABt
+    size_t abt_hb = 32;  // block height of B in AddABt
+  };
+  
+  extern NGS_DLL_HEADER BlasBlocking blas_blocking;
+  
+  /// cpu model, SIMD width and cache sizes, key of the tuning cache
+  extern NGS_DLL_HEADER string BlasTuningKey ();
+  /// $NGS_BLAS_TUNING_FILE, or $XDG_CACHE_HOME/ngsolve/blas_blocking.txt, or ~/.cache/ngsolve/...
+  extern NGS_DLL_HEADER string BlasTuningCacheFile ();
+  /// sets blas_blocking from the entry of this cpu, returns false if there is none
+  extern NGS_DLL_HEADER bool LoadBlasBlocking (const string & filename);
+  /// replaces the entry of this cpu by blas_blocking
+  extern NGS_DLL_HEADER void SaveBlasBlocking (const string & filename);
+  /// benchmarks C=A*B and C+=A*B^t for n x n matrices, sets blas_blocking to the fastest candidates
+  extern NGS_DLL_HEADER BlasBlocking TuneBlasBlocking (size_t n = 400, bool save = true, bool verbose = false);
   
   extern list<tuple<string,double>> Timing (int what, size_t n, size_t m, size_t k, bool lapack);
 
@@ -0,0 +1,83 @@
+/**************************************************************************/
+/* File:   ngblas_arch.cpp                                                */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+  One kernel set of the runtime dispatch, compiled once per instruction
+  set with NGS_KERNEL_ARCH = avx2, avx512 and the matching compiler flags.
+  matkernel.hpp is generated for the simd width of the instruction set.
+
+  Only the simd header is included and its functions are force-inlined.
+  All kernels live in the namespace of the instruction set, so no code
+  for the wider instruction set can replace inline functions of the
+  baseline build.
+*/
+
+#include "../include/ngs_stdcpp_include.hpp"
+#include <utility>
+#define NGS_DLL_HEADER
+
+using namespace std;
+
+#include "../ngstd/simd.hpp"
+#include "ngblas_arch.hpp"
+
+#define NGS_CONCAT_(a,b) a##b
+#define NGS_CONCAT(a,b) NGS_CONCAT_(a,b)
+
+namespace ngbla
+{
+  namespace NGS_KERNEL_ARCH
+  {
+    using namespace ngstd;
+
+#include "matkernel.hpp"
+
+    template <size_t WA, OPERATION OP>
+    void ShortSum (size_t ha, size_t wb, double * pa, size_t da,
+                   double * pb, size_t db, double * pc, size_t dc)
+    {
+      if constexpr (WA <= 6 && OP==SET)
+        MatKernelShortSum2<WA,OP> (ha, wb, pa, da, pb, db, pc, dc);
+      else
+        MatKernelShortSum<WA,OP> (ha, wb, pa, da, pb, db, pc, dc);
+    }
+
+    template <size_t WA>
+    void MatVec (size_t ha, double * pa, size_t da, double * x, double * y)
+    {
+      KernelMatVec<WA,SET> (ha, pa, da, x, y);
+    }
+
+    template <size_t WA>
+    void AddMatVec (double s, size_t ha, double * pa, size_t da, double * x, double * y)
+    {
+      KernelAddMatVec<WA> (s, ha, pa, da, x, y);
+    }
+
+    template <size_t ... I>
+    void FillShortSum (ArchKernels & kernels, std::index_sequence<I...>)
+    {
+      ((kernels.setab[I] = &ShortSum<I,SET>), ...);
+      ((kernels.addab[I] = &ShortSum<I,ADD>), ...);
+      ((kernels.subab[I] = &ShortSum<I,SUB>), ...);
+    }
+
+    template <size_t ... I>
+    void FillMatVec (ArchKernels & kernels, std::index_sequence<I...>)
+    {
+      ((kernels.matvec[I] = &MatVec<I>), ...);
+      ((kernels.addmatvec[I] = &AddMatVec<I>), ...);
+    }
+  }
+
+  int NGS_CONCAT(GetArchKernels_, NGS_KERNEL_ARCH) (ArchKernels & kernels)
+  {
+    using namespace NGS_KERNEL_ARCH;
+    FillShortSum (kernels, std::make_index_sequence<13>());
+    FillMatVec (kernels, std::make_index_sequence<25>());
+    return SIMD<double>::Size();
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef FILE_NGBLAS_ARCH
+#define FILE_NGBLAS_ARCH
+
+/**************************************************************************/
+/* File:   ngblas_arch.hpp                                                */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+  Kernel sets for wider instruction sets than the baseline build,
+  selected at runtime by ngblas.cpp (cmake option NGS_KERNEL_DISPATCH).
+  The interface uses raw pointers only, the kernel translation units
+  don't see the bla headers.
+*/
+
+namespace ngbla
+{
+  struct ArchKernels
+  {
+    typedef void (*pshortsum) (size_t ha, size_t wb, double * pa, size_t da,
+                               double * pb, size_t db, double * pc, size_t dc);
+    typedef void (*pmatvec) (size_t ha, double * pa, size_t da, double * x, double * y);
+    typedef void (*paddmatvec) (double s, size_t ha, double * pa, size_t da, double * x, double * y);
+
+    /// C = A B, C += A B, C -= A B for width of A up to 12
+    pshortsum setab[13], addab[13], subab[13];
+    /// y = A x for width of A up to 24
+    pmatvec matvec[25];
+    /// y += s A x for width of A up to 24
+    paddmatvec addmatvec[25];
+  };
+
+  /// fill the table, returns the simd width of the kernels
+  int GetArchKernels_avx2 (ArchKernels & kernels);
+  ///
+  int GetArchKernels_avx512 (ArchKernels & kernels);
+}
+
+#endif
@@ -588,6 +588,46 @@ complex : bool
           { return py::object(x.attr("Norm")) (); }, py::arg("x"),"Compute Norm");
 
     m.def("__timing__", &ngbla::Timing, py::arg("what"), py::arg("n"), py::arg("m"), py::arg("k"), py::arg("lapack")=false);
+    m.def("TuneBlasBlocking", [] (size_t n, bool save, bool verbose)
+          {
+            auto bb = TuneBlasBlocking (n, save, verbose);
+            py::dict res;
+            res["mm_k"] = bb.mm_k;
+            res["mm_w"] = bb.mm_w;
+            res["abt_k"] = bb.abt_k;
+            res["abt_ha"] = bb.abt_ha;
+            res["abt_hb"] = bb.abt_hb;
+            res["cpu"] = BlasTuningKey();
+            res["cachefile"] = BlasTuningCacheFile();
+            return res;
+          }, py::arg("n")=400, py::arg("save")=true, py::arg("verbose")=false,
+          "Benchmarks block sizes of the matrix-matrix kernels for this cpu,\n"
+          "uses the fastest ones and stores them in the tuning cache read at startup");
+    m.def("BatchedBandSolve", [] (FlatMatrix<double> bands, FlatMatrix<double> rhs)
+          {
+            int n = rhs.Height(), bw = bands.Width();
+            size_t nmats = rhs.Width();
+            if (bands.Height() != nmats*n)
+              throw Exception ("BatchedBandSolve: bands needs height n*nmats");
+            BatchedBandCholeskyFactors fac(nmats, n, bw, [&] (size_t m, int i, int j)
+                                           { return bands(m*n+i, j-i+bw-1); });
+            Matrix<double> x = rhs;
+            fac.Solve (x);
+            return x;
+          }, py::arg("bands"), py::arg("rhs"),
+          "Solves with many symmetric positive definite band matrices, SIMD over the matrices.\n"
+          "Row m*n+i of bands holds the lower band of row i of matrix m, entry (i,j) is in\n"
+          "column j-i+bw-1. Column m of rhs is the right hand side of matrix m.");
+    m.def("CyclicReductionBandSolve", [] (FlatMatrix<double> band, FlatVector<double> rhs)
+          {
+            int n = band.Height(), bw = band.Width();
+            BandCyclicReduction cr(n, bw, [&] (int i, int j) { return band(i, j-i+bw-1); });
+            Vector<double> x = rhs;
+            cr.Solve (x);
+            return x;
+          }, py::arg("band"), py::arg("rhs"),
+          "Solves with a symmetric positive definite band matrix by parallel cyclic reduction.\n"
+          "Row i of band holds the lower band of row i, entry (i,j) is in column j-i+bw-1.");
     m.def("CheckPerformance",
              [] (size_t n, size_t m, size_t k)
                               {
@@ -323,6 +323,301 @@ public:
 
 
 
+/* ********************* contractions and permutations ******************** */
+
+/*
+  The routines work on dense tensors (the layout of Tensor, or of a
+  FlatTensor allocated from sizes). Index contractions are mapped onto
+  the ngblas matrix-matrix products, other indices are moved out of the
+  way by permutations.
+*/
+
+template <int DIM, typename T, int LINDIM>
+INLINE void GetTensorShape (FlatTensor<DIM,T,LINDIM> tensor, size_t * sizes, size_t * dists)
+{
+  if constexpr (DIM > 0)
+    {
+      sizes[0] = tensor.GetSize();
+      dists[0] = tensor.GetDist();
+      GetTensorShape (tensor.GetSubTensor(), sizes+1, dists+1);
+    }
+}
+
+template <int DIM, typename T, int LINDIM>
+INLINE bool IsDense (FlatTensor<DIM,T,LINDIM> tensor)
+{
+  size_t sizes[DIM+1], dists[DIM+1];
+  GetTensorShape (tensor, sizes, dists);
+  size_t prod = 1;
+  for (int k = DIM-1; k >= 0; k--)
+    {
+      if (sizes[k] > 1 && dists[k] != prod) return false;
+      prod *= sizes[k];
+    }
+  return true;
+}
+
+template <int DIM, typename T, size_t ... I>
+INLINE FlatTensor<DIM,T> MakeFlatTensor (T * data, const size_t * sizes, std::index_sequence<I...>)
+{
+  FlatTensor<DIM,T> tensor(sizes[I]...);
+  tensor.Data() = data;
+  return tensor;
+}
+
+/// dense tensor with given sizes on the memory data
+template <int DIM, typename T>
+INLINE FlatTensor<DIM,T> MakeFlatTensor (T * data, const size_t * sizes)
+{
+  return MakeFlatTensor<DIM,T> (data, sizes, std::make_index_sequence<DIM>());
+}
+
+
+// c(i*rc+j*cc) = a(i*ra+j*ca), in tiles to keep both sides in cache
+template <typename T>
+INLINE void CopyStrided (size_t h, size_t w, T * pa, size_t ra, size_t ca, T * pc, size_t rc, size_t cc)
+{
+  constexpr size_t BS = 16;
+  for (size_t i0 = 0; i0 < h; i0 += BS)
+    for (size_t j0 = 0; j0 < w; j0 += BS)
+      {
+        size_t i1 = min2(i0+BS, h), j1 = min2(j0+BS, w);
+        for (size_t i = i0; i < i1; i++)
+          for (size_t j = j0; j < j1; j++)
+            pc[i*rc+j*cc] = pa[i*ra+j*ca];
+      }
+}
+
+
+/**
+   Index k of c is index perm[k] of a, i.e.
+   c(j_0,...,j_{DIM-1}) = a(i_0,...,i_{DIM-1}) with i_{perm[k]} = j_k.
+ */
+template <int DIM, typename T, int LA, int LC>
+void Permute (FlatTensor<DIM,T,LA> a, FlatArray<int> perm, FlatTensor<DIM,T,LC> c)
+{
+  static_assert (DIM >= 1, "Permute needs a tensor of dimension >= 1");
+  size_t sa[DIM], da[DIM], sc[DIM], dc[DIM], stra[DIM];
+  GetTensorShape (a, sa, da);
+  GetTensorShape (c, sc, dc);
+  for (int k = 0; k < DIM; k++)
+    {
+      if (sc[k] != sa[perm[k]])
+        throw Exception ("Permute: tensor sizes don't match");
+      stra[k] = da[perm[k]];
+    }
+
+  if constexpr (DIM == 1)
+    CopyStrided (size_t(1), sc[0], a.Data(), size_t(0), stra[0], c.Data(), size_t(0), dc[0]);
+  else
+    {
+      // loop over the leading indices of c, copy the last two as tiles
+      size_t outer = 1;
+      for (int k = 0; k < DIM-2; k++)
+        outer *= sc[k];
+      size_t ind[DIM];
+      for (int k = 0; k < DIM; k++) ind[k] = 0;
+      for (size_t l = 0; l < outer; l++)
+        {
+          size_t offa = 0, offc = 0;
+          for (int k = 0; k < DIM-2; k++)
+            {
+              offa += ind[k]*stra[k];
+              offc += ind[k]*dc[k];
+            }
+          CopyStrided (sc[DIM-2], sc[DIM-1],
+                       a.Data()+offa, stra[DIM-2], stra[DIM-1],
+                       c.Data()+offc, dc[DIM-2], dc[DIM-1]);
+          for (int k = DIM-3; k >= 0; k--)
+            {
+              if (++ind[k] < sc[k]) break;
+              ind[k] = 0;
+            }
+        }
+    }
+}
+
+
+/**
+   Permutes a dense tensor in its own memory by following the cycles of
+   the permutation, the returned tensor is the permuted view onto the data.
+   Index k of the result is index perm[k] of the input.
+ */
+template <int DIM, typename T, int LINDIM>
+FlatTensor<DIM,T> PermuteInPlace (FlatTensor<DIM,T,LINDIM> tensor, FlatArray<int> perm)
+{
+  static_assert (DIM >= 1, "PermuteInPlace needs a tensor of dimension >= 1");
+  if (!IsDense(tensor))
+    throw Exception ("PermuteInPlace: tensor must be dense");
+
+  size_t sa[DIM], da[DIM], sc[DIM], stra[DIM];
+  GetTensorShape (tensor, sa, da);
+  for (int k = 0; k < DIM; k++)
+    {
+      sc[k] = sa[perm[k]];
+      stra[k] = da[perm[k]];
+    }
+
+  // position in the input of linear position q in the result
+  auto source = [&] (size_t q)
+    {
+      size_t pos = 0;
+      for (int k = DIM-1; k >= 0; k--)
+        {
+          pos += (q % sc[k]) * stra[k];
+          q /= sc[k];
+        }
+      return pos;
+    };
+
+  T * data = tensor.Data();
+  size_t n = tensor.GetTotalSize();
+  BitArray done(n);
+  done.Clear();
+  for (size_t start = 0; start < n; start++)
+    {
+      if (done.Test(start)) continue;
+      T first = data[start];
+      size_t cur = start;
+      while (true)
+        {
+          done.SetBit(cur);
+          size_t src = source(cur);
+          if (src == start)
+            {
+              data[cur] = first;
+              break;
+            }
+          data[cur] = data[src];
+          cur = src;
+        }
+    }
+  return MakeFlatTensor<DIM,T> (data, sc);
+}
+
+
+/**
+   Mode product c = a x_mode m:
+   c(..,i,..) = sum_j m(i,j) a(..,j,..), where i and j are at position mode.
+   One matrix-matrix product per leading index, a single one if mode is the last index.
+ */
+template <int DIM, typename T, int LA, int LC, typename TM>
+void ModeProduct (FlatTensor<DIM,T,LA> a, const TM & mat, int mode, FlatTensor<DIM,T,LC> c)
+{
+  SliceMatrix<T> m(mat);
+  if (!IsDense(a) || !IsDense(c))
+    throw Exception ("ModeProduct: tensors must be dense");
+  size_t sa[DIM], da[DIM], sc[DIM], dc[DIM];
+  GetTensorShape (a, sa, da);
+  GetTensorShape (c, sc, dc);
+
+  size_t before = 1, after = 1;
+  for (int k = 0; k < DIM; k++)
+    {
+      if (k != mode && sa[k] != sc[k])
+        throw Exception ("ModeProduct: tensor sizes don't match");
+      if (k < mode) before *= sa[k];
+      if (k > mode) after *= sa[k];
+    }
+  size_t na = sa[mode], nc = sc[mode];
+  if (m.Height() != nc || m.Width() != na)
+    throw Exception ("ModeProduct: matrix size doesn't match");
+
+  if (after == 1)
+    SliceMatrix<T> (before, nc, nc, c.Data()) = SliceMatrix<T> (before, na, na, a.Data()) * Trans(m);
+  else
+    for (size_t i = 0; i < before; i++)
+      SliceMatrix<T> (nc, after, after, c.Data()+i*nc*after) =
+        m * SliceMatrix<T> (na, after, after, a.Data()+i*na*after);
+}
+
+
+/**
+   Contraction over index ia of a and index ib of b:
+   c(I,J) = sum_k a(I,k,..) b(J,k,..),
+   the indices of c are the remaining indices of a followed by the remaining
+   indices of b. The contracted index is moved to the inner position by a
+   permutation into lh, unless it is already the first or last index.
+   Then one matrix-matrix product is performed.
+ */
+template <int DA, int DB, int DC, typename T, int LA, int LB, int LC>
+void Contract (FlatTensor<DA,T,LA> a, int ia, FlatTensor<DB,T,LB> b, int ib,
+               FlatTensor<DC,T,LC> c, LocalHeap & lh)
+{
+  static_assert (DC == DA+DB-2, "Contract: dimension of result must be DA+DB-2");
+  if (!IsDense(a) || !IsDense(b) || !IsDense(c))
+    throw Exception ("Contract: tensors must be dense");
+  HeapReset hr(lh);
+
+  size_t sa[DA], da[DA], sb[DB], db[DB], sc[DC+1], dc[DC+1];
+  GetTensorShape (a, sa, da);
+  GetTensorShape (b, sb, db);
+  GetTensorShape (c, sc, dc);
+
+  size_t n = sa[ia];
+  if (sb[ib] != n)
+    throw Exception ("Contract: contracted indices have different sizes");
+  size_t ra = 1, rb = 1;
+  int l = 0;
+  for (int k = 0; k < DA; k++)
+    if (k != ia)
+      {
+        if (sc[l++] != sa[k]) throw Exception ("Contract: tensor sizes don't match");
+        ra *= sa[k];
+      }
+  for (int k = 0; k < DB; k++)
+    if (k != ib)
+      {
+        if (sc[l++] != sb[k]) throw Exception ("Contract: tensor sizes don't match");
+        rb *= sb[k];
+      }
+
+  // a as ra x n matrix (or its transpose), b as n x rb matrix
+  T * pa = a.Data();
+  bool transa = false;
+  if (ia == 0 && DA > 1)
+    transa = true;
+  else if (ia != DA-1)
+    {
+      int perm[DA];
+      size_t sp[DA];
+      for (int k = 0, j = 0; k < DA; k++)
+        if (k != ia) perm[j++] = k;
+      perm[DA-1] = ia;
+      for (int k = 0; k < DA; k++) sp[k] = sa[perm[k]];
+      pa = new (lh) T[ra*n];
+      Permute (a, FlatArray<int>(DA, perm), MakeFlatTensor<DA,T>(pa, sp));
+    }
+
+  T * pb = b.Data();
+  bool transb = false;
+  if (ib == DB-1 && DB > 1)
+    transb = true;
+  else if (ib != 0)
+    {
+      int perm[DB];
+      size_t sp[DB];
+      perm[0] = ib;
+      for (int k = 0, j = 1; k < DB; k++)
+        if (k != ib) perm[j++] = k;
+      for (int k = 0; k < DB; k++) sp[k] = sb[perm[k]];
+      pb = new (lh) T[rb*n];
+      Permute (b, FlatArray<int>(DB, perm), MakeFlatTensor<DB,T>(pb, sp));
+    }
+
+  SliceMatrix<T> matc(ra, rb, rb, c.Data());
+  SliceMatrix<T> mata = transa ? SliceMatrix<T>(n, ra, ra, pa) : SliceMatrix<T>(ra, n, n, pa);
+  SliceMatrix<T> matb = transb ? SliceMatrix<T>(rb, n, n, pb) : SliceMatrix<T>(n, rb, rb, pb);
+  if (!transa && !transb) matc = mata * matb;
+  if (!transa && transb) matc = mata * Trans(matb);
+  if (transa && !transb) matc = Trans(mata) * matb;
+  if (transa && transb) matc = Trans(mata) * Trans(matb);
+}
+
+
+
+
+
 template <int DIM, typename T>
 INLINE ostream & operator<< (ostream & ost, const FlatTensor<DIM,T> & tensor)
 {
@@ -232,11 +232,13 @@ set_vars( NGSOLVE_CMAKE_ARGS
   USE_VTUNE
   USE_CCACHE
   USE_NATIVE_ARCH
+  NGS_KERNEL_DISPATCH
   NETGEN_DIR
   Netgen_DIR
   INSTALL_DEPENDENCIES 
   INTEL_MIC
   ENABLE_UNIT_TESTS
+  ENABLE_BENCHMARKS
   BUILD_STUB_FILES
   )
 
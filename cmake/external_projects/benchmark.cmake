@@ -0,0 +1,27 @@
+include (ExternalProject)
+find_program(GIT_EXECUTABLE git)
+set(BENCHMARK_INSTALL_DIR ${CMAKE_BINARY_DIR}/benchmark/install)
+set(BENCHMARK_LIBRARY ${BENCHMARK_INSTALL_DIR}/lib/${CMAKE_STATIC_LIBRARY_PREFIX}benchmark${CMAKE_STATIC_LIBRARY_SUFFIX})
+ExternalProject_Add(
+    project_benchmark
+    PREFIX ${CMAKE_BINARY_DIR}/benchmark
+    GIT_REPOSITORY https://github.com/google/benchmark.git
+    GIT_TAG v1.5.0
+    TIMEOUT 10
+    UPDATE_COMMAND "" # ${GIT_EXECUTABLE} pull
+    CMAKE_ARGS
+      -DCMAKE_BUILD_TYPE=Release
+      -DCMAKE_INSTALL_PREFIX=${BENCHMARK_INSTALL_DIR}
+      -DCMAKE_INSTALL_LIBDIR=lib
+      -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}
+      -DCMAKE_POSITION_INDEPENDENT_CODE=ON
+      -DBENCHMARK_ENABLE_TESTING=OFF
+      -DBENCHMARK_ENABLE_GTEST_TESTS=OFF
+    BUILD_BYPRODUCTS ${BENCHMARK_LIBRARY}
+    LOG_DOWNLOAD ON
+   )
+
+# Expose required variables (BENCHMARK_INCLUDE_DIR, BENCHMARK_LIBRARIES) to parent scope
+find_package(Threads REQUIRED)
+set(BENCHMARK_INCLUDE_DIR ${BENCHMARK_INSTALL_DIR}/include CACHE INTERNAL "Path to include folder for Google Benchmark")
+set(BENCHMARK_LIBRARIES ${BENCHMARK_LIBRARY} Threads::Threads CACHE INTERNAL "Google Benchmark libraries")
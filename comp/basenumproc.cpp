@@ -79,6 +79,8 @@ namespace ngcomp
       if ( (name == info->name) && ( (dim == info->dim) || (info->dim==-1) ))
         return info;
 
+    if (LazyLibraries::Load (name))
+      return GetNumProc (name, dim);
     return nullptr;
   }
 
@@ -22,6 +22,10 @@ namespace ngcomp
     shared_ptr<SparseMatrix<SCAL,TV,TV>> sparse_innersolve, 
       sparse_harmonicext, sparse_harmonicexttrans;
 
+    // raw pointers for AddMatrix, avoids shared_ptr copies in the parallel assembly loop
+    SparseMatrix<SCAL,TV,TV> * add_pwbmat = nullptr;
+    Preconditioner * add_coarse = nullptr;
+
 
     Array<double> weight;
     
@@ -139,22 +143,21 @@ namespace ngcomp
       wb_free_dofs->Clear();
 
       // *wb_free_dofs = wbdof;
-      for (auto i : Range(ndof))
-	if (fes->GetDofCouplingType(i) == WIREBASKET_DOF)
-	  wb_free_dofs -> SetBit(i);
+      ParallelFor (ndof, [&] (size_t i)
+                   {
+                     if (fes->GetDofCouplingType(i) == WIREBASKET_DOF)
+                       wb_free_dofs -> SetBitAtomic(i);
+                   });
 
 
       if (fes->GetFreeDofs())
 	wb_free_dofs -> And (*fes->GetFreeDofs());
       
-      if (!bfa->SymmetricStorage()) 
-	{
-	  harmonicexttrans = sparse_harmonicexttrans =
-	    make_shared<SparseMatrix<SCAL,TV,TV>>(ndof, ndof, el2wbdofs, el2ifdofs, false);
-	  harmonicexttrans -> AsVector() = 0.0;
-	}
-      else
-	harmonicexttrans = sparse_harmonicexttrans = nullptr;
+      // also stored for symmetric storage: the row-parallel product replaces
+      // the sequential transpose product of harmonicext in Mult
+      harmonicexttrans = sparse_harmonicexttrans =
+        make_shared<SparseMatrix<SCAL,TV,TV>>(ndof, ndof, el2wbdofs, el2ifdofs, false);
+      harmonicexttrans -> AsVector() = 0.0;
 
 
       innersolve = sparse_innersolve = bfa->SymmetricStorage() 
@@ -173,6 +176,7 @@ namespace ngcomp
       pwbmat -> SetInverseType (inversetype);
       sparse_pwbmat = dynamic_pointer_cast<BaseSparseMatrix>(pwbmat);
       sparse_pwbmat-> SetSPD ( bfa->IsSPD() );
+      add_pwbmat = dynamic_cast<SparseMatrix<SCAL,TV,TV>*> (pwbmat.get());
       
       weight.SetSize (fes->GetNDof());
       weight = 0;
@@ -184,7 +188,8 @@ namespace ngcomp
 	if(creator == nullptr)
 	  throw Exception("Nothing known about preconditioner " + coarsetype);
         inv = creator->creatorbf (bfa, flags, "wirebasket"+coarsetype);
-        dynamic_pointer_cast<Preconditioner>(inv) -> InitLevel(wb_free_dofs);
+        add_coarse = dynamic_cast<Preconditioner*> (inv.get());
+        add_coarse -> InitLevel(wb_free_dofs);
       }
     }
 
@@ -273,6 +278,8 @@ namespace ngcomp
 		  for (size_t l = 0; l < sizei; l++)
 		    het.Col(l) *= el2ifweight[l];
 		}
+              else
+                het = Trans(he);
 	    }
 	  //R * A_ii^(-1) * R^T
 	  for (size_t k = 0; k < sizei; k++) d.Row(k) *= el2ifweight[k]; 
@@ -292,15 +299,13 @@ namespace ngcomp
       
       sparse_harmonicext->AddElementMatrix(intdofs,wbdofs,he);
       
-      if (!bfa->SymmetricStorage())
-        sparse_harmonicexttrans->AddElementMatrix(wbdofs,intdofs,het);
+      sparse_harmonicexttrans->AddElementMatrix(wbdofs,intdofs,het);
       
       sparse_innersolve -> AddElementMatrix(intdofs,intdofs,d);
 
-      dynamic_pointer_cast<SparseMatrix<SCAL,TV,TV>>(pwbmat)
-        ->AddElementMatrix(wbdofs,wbdofs,a);
-      if (coarse)
-        dynamic_pointer_cast<Preconditioner>(inv)->AddElementMatrix(wbdofs,a,id,lh);
+      add_pwbmat -> AddElementMatrix(wbdofs,wbdofs,a);
+      if (add_coarse)
+        add_coarse -> AddElementMatrix(wbdofs,a,id,lh);
     }
 
 
@@ -338,18 +343,15 @@ namespace ngcomp
                      sparse_harmonicext->GetRowValues(i) *= weight[i];                     
                    }, TasksPerThread(5));
       
-      if (!bfa->SymmetricStorage())
-        {
-          ParallelFor (// sparse_harmonicexttrans->Height(),
-                       sparse_harmonicexttrans->GetBalancing(),
-                       [&] (size_t i)
-                       {
-                         FlatArray<int> rowind = sparse_harmonicexttrans->GetRowIndices(i);
-                         FlatVector<SCAL> values = sparse_harmonicexttrans->GetRowValues(i);
-                         for (int j = 0; j < rowind.Size(); j++)
-                           values[j] *= weight[rowind[j]];
-                       }, TasksPerThread(5));
-        }
+      ParallelFor (// sparse_harmonicexttrans->Height(),
+                   sparse_harmonicexttrans->GetBalancing(),
+                   [&] (size_t i)
+                   {
+                     FlatArray<int> rowind = sparse_harmonicexttrans->GetRowIndices(i);
+                     FlatVector<SCAL> values = sparse_harmonicexttrans->GetRowValues(i);
+                     for (int j = 0; j < rowind.Size(); j++)
+                       values[j] *= weight[rowind[j]];
+                   }, TasksPerThread(5));
       
       // now generate wire-basked solver
 
@@ -411,15 +413,12 @@ namespace ngcomp
 	      tmp = new ParallelVVector<TV>(ndof, pardofs);
 	      innersolve = make_shared<ParallelMatrix> (innersolve, pardofs);
 	      harmonicext = make_shared<ParallelMatrix> (harmonicext, pardofs);
-	      if (harmonicexttrans)
-		harmonicexttrans = make_shared<ParallelMatrix> (harmonicexttrans, pardofs);
+	      harmonicexttrans = make_shared<ParallelMatrix> (harmonicexttrans, pardofs);
 	    }
 	  else
 	    {
 
-              int cntfreedofs = 0;
-              for (int i = 0; i < wb_free_dofs->Size(); i++)
-                if (wb_free_dofs->Test(i)) cntfreedofs++;
+              size_t cntfreedofs = wb_free_dofs->NumSet();
 
               if (coarse)
               {
@@ -460,6 +459,23 @@ namespace ngcomp
     int VHeight() const override { return bfa->GetMatrix().VHeight(); }
     int VWidth() const override { return bfa->GetMatrix().VHeight(); }
 
+    Array<MemoryUsage> GetMemoryUsage () const override
+    {
+      Array<MemoryUsage> mu;
+      auto add = [&] (const string & name, const shared_ptr<BaseMatrix> & mat)
+        {
+          if (mat) mu += MemoryUsageChildren (name, mat->GetMemoryUsage());
+        };
+      add ("harmonic extension", harmonicext);
+      if (harmonicexttrans != harmonicext)
+        add ("harmonic extension trans", harmonicexttrans);
+      add ("inner solve", innersolve);
+      add ("wirebasket matrix", pwbmat);
+      add ("wirebasket inverse", inv);
+      add ("coarse inverse", inv_coarse);
+      mu += { "weights", MemoryBytes (weight), 1 };
+      return MemoryUsageChildren ("BDDC", move(mu));
+    }
     
     void Mult (const BaseVector & x, BaseVector & y) const override
     {
@@ -477,10 +493,7 @@ namespace ngcomp
 
       timerharmonicexttrans.Start();
 
-      if (bfa->SymmetricStorage())
-	y += Transpose(*harmonicext) * x; 
-      else
-	y += *harmonicexttrans * x;
+      y += *harmonicexttrans * x;
 
       timerharmonicexttrans.Stop();
 
@@ -550,7 +563,7 @@ namespace ngcomp
     {
       bfa = dynamic_pointer_cast<S_BilinearForm<SCAL>> (abfa);
       // bfa -> SetPreconditioner (this);
-      inversetype = flags.GetStringFlag("inverse", "sparsecholesky");
+      inversetype = flags.GetStringFlag("inverse", "auto");
       coarsetype = flags.GetStringFlag("coarsetype", "none");
       if(coarsetype=="myamg_hcurl")
 	(dynamic_pointer_cast<HCurlHighOrderFESpace>(bfa->GetFESpace()))->DoCouplingDofUpgrade(false);
@@ -624,6 +637,12 @@ namespace ngcomp
       return *pre;
     }
 
+    virtual Array<MemoryUsage> GetMemoryUsage () const
+    {
+      if (!pre) return Array<MemoryUsage>();
+      return MemoryUsageChildren ("pre " + GetName(), pre->GetMemoryUsage());
+    }
+
     virtual void CleanUpLevel ()
     {
       /*
@@ -96,10 +96,22 @@ namespace ngcomp
                      !flags.GetDefineFlagX ("keep_internal").IsFalse() &&
                      !flags.GetDefineFlag ("nokeep_internal"));
     SetStoreInner (flags.GetDefineFlag ("store_inner"));
+    condense_float = flags.GetDefineFlag ("condense_float");
+    condense_share = flags.GetDefineFlag ("condense_share");
     precompute = flags.GetDefineFlag ("precompute");
     checksum = flags.GetDefineFlag ("checksum");
     spd = flags.GetDefineFlag ("spd");
     geom_free = flags.GetDefineFlag("geom_free");    
+    store_elmats = flags.GetDefineFlag("store_elmats");
+    atomic_assembly = flags.GetDefineFlag("atomic_assembly");
+    reuse_graph = flags.GetDefineFlag("reuse_graph");
+    setupcache = flags.GetStringFlag("setupcache", SetupCacheDirectory());
+    batch_assembly = flags.GetDefineFlag("batch_assembly");
+    assembly_buffer = size_t(flags.GetNumFlag("assembly_buffer", 0));
+    sort_scatter = flags.GetDefineFlag("sort_scatter");
+    variable_blocks = flags.GetDefineFlag("variable_blocks");
+    parameter_splitting = flags.GetDefineFlag("parameter_splitting");
+    fuse_integrals = !flags.GetDefineFlagX("fuse_integrals").IsFalse();
     if (spd) symmetric = true;
     SetCheckUnused (!flags.GetDefineFlagX("check_unused").IsFalse());
   }
@@ -153,7 +165,19 @@ namespace ngcomp
     SetKeepInternal (eliminate_internal && 
                      !flags.GetDefineFlag ("nokeep_internal"));
     if (flags.GetDefineFlag ("store_inner")) SetStoreInner (1);
+    condense_float = flags.GetDefineFlag ("condense_float");
+    condense_share = flags.GetDefineFlag ("condense_share");
     geom_free = flags.GetDefineFlag("geom_free");
+    store_elmats = flags.GetDefineFlag("store_elmats");
+    atomic_assembly = flags.GetDefineFlag("atomic_assembly");
+    reuse_graph = flags.GetDefineFlag("reuse_graph");
+    setupcache = flags.GetStringFlag("setupcache", SetupCacheDirectory());
+    batch_assembly = flags.GetDefineFlag("batch_assembly");
+    assembly_buffer = size_t(flags.GetNumFlag("assembly_buffer", 0));
+    sort_scatter = flags.GetDefineFlag("sort_scatter");
+    variable_blocks = flags.GetDefineFlag("variable_blocks");
+    parameter_splitting = flags.GetDefineFlag("parameter_splitting");
+    fuse_integrals = !flags.GetDefineFlagX("fuse_integrals").IsFalse();
     
     precompute = flags.GetDefineFlag ("precompute");
     checksum = flags.GetDefineFlag ("checksum");
@@ -203,6 +227,7 @@ namespace ngcomp
                        string ("bfi is ")+bfi->Name());
 
     parts.Append (bfi);
+    parameter_components.SetSize0();
 
     if ((bfi->geom_free && nonassemble) || geom_free)
       {
@@ -341,12 +366,163 @@ namespace ngcomp
   }
 
 
+  /*
+    the boundary elements grouped by the color of their facet. The element
+    matrices of facet-wise boundary integrators couple the dofs of the volume
+    element at the facet, elements of one group do not share these dofs.
+    Several boundary elements at one facet go into different groups.
+  */
+  static Table<int> SurfaceElementColoring (const FESpace & fes)
+  {
+    auto ma = fes.GetMeshAccess();
+    const Table<int> & facet_coloring = fes.FacetColoring();
+    size_t ncolors = facet_coloring.Size();
+    Array<int> facetcol(ma->GetNFacets());
+    facetcol = 0;
+    for (auto c : Range(ncolors))
+      for (auto f : facet_coloring[c])
+        facetcol[f] = c;
+
+    size_t nse = ma->GetNE(BND);
+    Array<int> selfacet(nse), round(nse), cnt(ma->GetNFacets());
+    cnt = 0;
+    int maxround = 0;
+    for (size_t i = 0; i < nse; i++)
+      {
+        selfacet[i] = ma->GetElFacets(ElementId(BND,i))[0];
+        round[i] = cnt[selfacet[i]]++;
+        maxround = max2(maxround, round[i]);
+      }
+
+    TableCreator<int> creator((maxround+1)*ncolors);
+    for ( ; !creator.Done(); creator++)
+      for (size_t i = 0; i < nse; i++)
+        creator.Add (round[i]*ncolors + facetcol[selfacet[i]], i);
+    return creator.MoveTable();
+  }
+
+
+  // sparsity patterns shared by all bilinear-forms with flag 'reuse_graph'
+  struct GraphCacheEntry
+  {
+    weak_ptr<FESpace> fes1, fes2;
+    size_t timestamp1, timestamp2;
+    bool symmetric, eliminate_internal, eliminate_hidden;
+    shared_ptr<MatrixGraph> graph;
+  };
+  static mutex graph_cache_mutex;
+  static Array<GraphCacheEntry> graph_cache;
+
+  // the graph in the setup cache files: height, width, nze, firsti, colnr
+  static void ArchiveGraph (Archive & ar, MatrixGraph * graph, size_t width)
+  {
+    size_t height = graph->Size(), nze = graph->NZE();
+    ar & height & width & nze;
+    ar.Do (&graph->GetFirstArray()[0], height+1);
+    if (nze) ar.Do (&graph->GetRowIndices(0)[0], nze);
+  }
+
+  static MatrixGraph * LoadGraph (Archive & ar, size_t expected_height, size_t expected_width)
+  {
+    size_t height, width, nze;
+    ar & height & width & nze;
+    if (height != expected_height || width != expected_width)
+      throw Exception ("graph of wrong size");
+    Array<size_t> firsti(height+1);
+    ar.Do (firsti.Data(), height+1);
+    if (firsti[0] != 0 || firsti[height] != nze)
+      throw Exception ("inconsistent graph");
+    Array<int> elsperrow(height);
+    for (size_t i = 0; i < height; i++)
+      elsperrow[i] = firsti[i+1]-firsti[i];
+    Array<int> colnr(nze);
+    if (nze) ar.Do (colnr.Data(), nze);
+    auto graph = new MatrixGraph (elsperrow, width);
+    ParallelFor (height, [&] (size_t i)
+                 { graph->GetRowIndices(i) = colnr.Range(firsti[i], firsti[i+1]); });
+    return graph;
+  }
+  
   MatrixGraph * BilinearForm :: GetGraph (int level, bool symmetric)
   {
     static Timer timer ("BilinearForm::GetGraph");
+    static Timer timercache ("BilinearForm::GetGraph - copy cached");
     RegionTimer reg (timer);
 
+    bool use_cache = reuse_graph && !specialelements.Size();
+    size_t ts1 = fespace->GetUpdateTimeStamp();
+    size_t ts2 = fespace2 ? fespace2->GetUpdateTimeStamp() : 0;
+    auto matches = [&] (const GraphCacheEntry & entry)
+      {
+        return entry.fes1.lock() == fespace && entry.fes2.lock() == fespace2 &&
+          entry.timestamp1 == ts1 && entry.timestamp2 == ts2 &&
+          entry.symmetric == symmetric &&
+          entry.eliminate_internal == eliminate_internal &&
+          entry.eliminate_hidden == eliminate_hidden;
+      };
+    
+    if (use_cache)
+      {
+        lock_guard<mutex> guard(graph_cache_mutex);
+        // remove graphs of deleted or updated spaces
+        for (size_t i = graph_cache.Size(); i-- > 0; )
+          {
+            auto & entry = graph_cache[i];
+            auto fes1 = entry.fes1.lock();
+            auto fes2 = entry.fes2.lock();
+            bool valid = fes1 && fes1->GetUpdateTimeStamp() == entry.timestamp1;
+            if (entry.timestamp2)   // has a test-space
+              valid = valid && fes2 && fes2->GetUpdateTimeStamp() == entry.timestamp2;
+            if (!valid)
+              graph_cache.DeleteElement(i);
+          }
+        
+        for (auto & entry : graph_cache)
+          if (matches(entry))
+            {
+              RegionTimer regc (timercache);
+              return new MatrixGraph (*entry.graph, false);
+            }
+      }
+
+    auto finish = [&] (MatrixGraph * graph)
+      {
+        graph -> FindSameNZE();
+        if (use_cache)
+          {
+            lock_guard<mutex> guard(graph_cache_mutex);
+            bool found = false;
+            for (auto & entry : graph_cache)
+              if (matches(entry)) found = true;
+            if (!found)
+              graph_cache.Append (GraphCacheEntry { fespace, fespace2, ts1, ts2, symmetric,
+                                                    eliminate_internal, eliminate_hidden,
+                                                    make_shared<MatrixGraph> (*graph, false) });
+          }
+        return graph;
+      };
+
     size_t ndof = fespace->GetNDof();
+    size_t height = fespace2 ? fespace2->GetNDof() : ndof;
+
+    // warm start from the setup cache file
+    string cachefile, cachekey;
+    if (setupcache.length() && !specialelements.Size())
+      {
+        cachekey = "graph " + fespace->SetupCacheKey() +
+          (fespace2 ? " | " + fespace2->SetupCacheKey() : string("")) +
+          " symmetric=" + ToString(symmetric) + " eliminate_internal=" + ToString(eliminate_internal) +
+          " eliminate_hidden=" + ToString(eliminate_hidden) +
+          " dg=" + ToString(fespace->UsesDGCoupling()) +
+          " dg2=" + ToString(fespace2 && fespace2->UsesDGCoupling());
+        cachefile = SetupCacheFile (setupcache, "graph", cachekey);
+        MatrixGraph * graph = nullptr;
+        if (LoadSetupCache (cachefile, cachekey, [&] (Archive & ar)
+                            { graph = LoadGraph (ar, height, ndof); }))
+          return finish (graph);
+        delete graph;
+      }
+
     size_t nf = ma->GetNFacets();
     size_t neV = ma->GetNE(VOL);
     size_t neB = ma->GetNE(BND);
@@ -440,6 +616,7 @@ namespace ngcomp
           //add dofs of neighbour elements as well
           Array<DofId> dnums_dg;
           Array<int> elnums_per;
+          ma->GetFacetElementTable();
 
           for (int i = 0; i < nf; i++)
             {
@@ -529,6 +706,8 @@ namespace ngcomp
                   creator2.Add (offset+i, dnums[j]);
             }
             offset += specialelements.Size();	
+            if (fespace2->UsesDGCoupling())
+              ma->GetFacetElementTable();
             if (fespace2->UsesDGCoupling())
               //add dofs of neighbour elements as well
               for (int i = 0; i < nf; i++)
@@ -560,8 +739,9 @@ namespace ngcomp
                                  table2, table, symmetric);
       }
     
-    graph -> FindSameNZE();
-    return graph;
+    if (cachefile.length())
+      StoreSetupCache (cachefile, cachekey, [&] (Archive & ar) { ArchiveGraph (ar, graph, ndof); });
+    return finish (graph);
   }
 
 
@@ -668,7 +848,7 @@ namespace ngcomp
       {
         e.Append (string ("\nthrown by Do loworder ") +
                   string (GetName()));
-        throw e;
+        throw;
       }
 
     
@@ -691,7 +871,12 @@ namespace ngcomp
       }
 
 
-    DoAssemble(lh);
+    if (parameter_splitting)
+      AssembleParameterComponents(lh);
+    else
+      DoAssemble(lh);
+    CompressInternalMatrices();
+    CreateVariableBlockMatrix();
 
 
     if (timing)
@@ -815,6 +1000,28 @@ namespace ngcomp
 
   
 
+  size_t BilinearForm :: EstimateHeapSize () const
+  {
+    size_t size = 0;
+    auto estimate = [&] (VorB vb, const BilinearFormIntegrator & bfi, size_t factor)
+      {
+        for (auto space : { fespace, fespace2 })
+          if (space)
+            size = max2 (size, factor * space->EstimateHeapSize (vb, bfi.GetBonusIntegrationOrder(),
+                                                                 bfi.ProxyDimension()));
+      };
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      for (auto & bfi : VB_parts[vb])
+        estimate (vb, *bfi, 1);
+    // the element matrices of the two elements of a facet
+    for (auto vb : { VOL, BND })
+      for (auto & bfi : facetwise_skeleton_parts[vb])
+        estimate (VOL, *bfi, 4);
+    for (auto & bfi : elementwise_skeleton_parts)
+      estimate (VOL, *bfi, 2);
+    return size;
+  }
+
   void BilinearForm :: ReAssemble (LocalHeap & lh, bool reallocate)
   {
     if (nonassemble)
@@ -847,13 +1054,30 @@ namespace ngcomp
         return;
       }
 
+    if (parameter_components.Size())
+      {
+        CombineParameterComponents();
+        CreateVariableBlockMatrix();
+        return;
+      }
+
     GetMatrix() = 0.0;
+    // compressed matrices of condensation take no more element matrices
+    if (eliminate_internal && keep_internal && (condense_float || condense_share))
+      AllocateInternalMatrices();
     DoAssemble(lh);
+    CompressInternalMatrices();
+    CreateVariableBlockMatrix();
 
     if (galerkin)
       GalerkinProjection();
   }
 
+  void BilinearForm :: ReAssembleElements (VorB vb, const BitArray & elements, LocalHeap & lh)
+  {
+    throw Exception (string("ReAssembleElements not available for ") + GetClassName());
+  }
+  
   shared_ptr<BaseMatrix> BilinearForm :: GetMatrixPtr () const
   {
     if (!mats.Size())
@@ -885,16 +1109,13 @@ namespace ngcomp
   {
     Array<MemoryUsage> mu;
     if (low_order_bilinear_form)
-      mu = low_order_bilinear_form -> GetMemoryUsage ();
-  
-    int olds = mu.Size();
+      mu = MemoryUsageChildren ("low order", low_order_bilinear_form -> GetMemoryUsage ());
 
     for (int i = 0; i < mats.Size(); i++)
-      if (mats[i]) mu += mats[i]->GetMemoryUsage ();
-
-    for (int i = olds; i < mu.Size(); i++)
-      mu[i].AddName (string(" bf ")+GetName());
-    return mu;
+      if (mats[i])
+        mu += MemoryUsageChildren (mats.Size() > 1 ? "matrix level " + ToString(i) : string("matrix"),
+                                   mats[i]->GetMemoryUsage ());
+    return MemoryUsageChildren ("bf " + GetName(), move(mu));
   }
 
 
@@ -969,6 +1190,368 @@ namespace ngcomp
 
 
 
+  template <class SCAL>
+  void S_BilinearForm<SCAL> :: AssembleBatched (VorB vb, FlatArray<bool> useddof, LocalHeap & clh,
+                                                bool condense)
+  {
+    static Timer t("Matrix assembling batched");
+    static Timer tcalc("Matrix assembling batched - calc elmats", 2);
+    static Timer tcondense("Matrix assembling batched - condense", 2);
+    static Timer tadd("Matrix assembling batched - add elmats", 2);
+    RegionTimer reg(t);
+
+    // with batch_assembly one SIMD lane per element is computed in lockstep
+    size_t batchsize = batch_assembly ? SIMD<double>::Size() : 1;
+    // element matrices are computed into this per-thread buffer, and then scattered
+    size_t buffersize = max2(batchsize, assembly_buffer);
+
+    static auto stats = ParallelStats::GetSite ("Matrix assembling batched");
+    ParallelStatsRegion preg(stats);
+    for (FlatArray<int> els_of_col : fespace->ElementColoring(vb))
+      ParallelForRange
+        (els_of_col.Size(), [&] (IntRange r)
+         {
+           ParallelStatsTask ptask(stats);
+           LocalHeap lh = clh.Split();
+           Array<DofId> dnums, dnums_buffer;
+           Array<size_t> first_dof;
+           Array<ElementId> ids;
+           Array<const FiniteElement*> fels, bfi_fels;
+           Array<const ElementTransformation*> trafos, bfi_trafos;
+           Array<bool> has_integrator;
+           Array<DofId> sortkeys;
+           Array<int> order;
+           Array<int> idofs_all, odofs_all, idnums_all, ednums_all;
+           Array<size_t> first_i, first_o;
+           Array<SliceMatrix<double>> invmats;
+           
+           auto calc_batch = [&] (IntRange batch, FlatArray<FlatMatrix<SCAL>> elmats,
+                                  FlatArray<FlatMatrix<SCAL>> bfi_elmats)
+             {
+               bool done = false;
+               while (!done)
+                 {
+                   done = true;
+                   for (auto i : batch)
+                     elmats[i] = 0.0;
+                   for (auto & bfip : VB_parts[vb])
+                     {
+                       const BilinearFormIntegrator & bfi = *bfip;
+                       bfi_fels.SetSize0();
+                       bfi_trafos.SetSize0();
+                       for (auto i : batch)
+                         {
+                           if (!bfi.DefinedOn (trafos[i]->GetElementIndex())) continue;
+                           if (!bfi.DefinedOnElement (ids[i].Nr())) continue;
+                           has_integrator[i] = true;
+                           bfi_elmats[bfi_fels.Size()].AssignMemory (elmats[i].Height(), elmats[i].Width(),
+                                                                     elmats[i].Data());
+                           bfi_fels.Append (fels[i]);
+                           bfi_trafos.Append (&trafos[i]->AddDeformation(bfi.GetDeformation().get(), lh));
+                         }
+                       if (!bfi_fels.Size()) continue;
+                       try
+                         {
+                           bfi.CalcElementMatrixAddBatch (bfi_fels, bfi_trafos,
+                                                          bfi_elmats.Range(0, bfi_fels.Size()), lh);
+                         }
+                       catch (ExceptionNOSIMD & e)
+                         {
+                           done = false;
+                         }
+                     }
+                 }
+             };
+           
+           auto flush = [&] ()
+             {
+               size_t nb = ids.Size();
+               if (!nb) return;
+               size_t dim = fespace->GetDimension();
+               
+               FlatArray<FlatMatrix<SCAL>> elmats(nb, lh), bfi_elmats(nb, lh);
+               for (size_t i = 0; i < nb; i++)
+                 {
+                   size_t size = dim * (first_dof[i+1]-first_dof[i]);
+                   elmats[i].AssignMemory (size, size, lh);
+                 }
+               has_integrator.SetSize(nb);
+               has_integrator = false;
+
+               // stage 1: compute all element matrices of the buffer,
+               // runs of elements with same type and size are batched
+               {
+                 ThreadRegionTimer regc(tcalc, TaskManager::GetThreadId());
+                 for (size_t i0 = 0; i0 < nb; )
+                   {
+                     size_t i1 = i0+1;
+                     while (i1 < nb && i1-i0 < batchsize &&
+                            fels[i1]->ElementType() == fels[i0]->ElementType() &&
+                            first_dof[i1+1]-first_dof[i1] == first_dof[i0+1]-first_dof[i0])
+                       i1++;
+                     calc_batch (IntRange(i0, i1), elmats, bfi_elmats);
+                     i0 = i1;
+                   }
+               }
+
+               // stage 1b: static condensation, interior blocks of equal size are inverted together
+               if (condense)
+                 {
+                   ThreadRegionTimer regs(tcondense, TaskManager::GetThreadId());
+                   idofs_all.SetSize0(); odofs_all.SetSize0();
+                   idnums_all.SetSize0(); ednums_all.SetSize0();
+                   first_i.SetSize(nb+1); first_o.SetSize(nb+1);
+                   first_i[0] = first_o[0] = 0;
+                   for (size_t i = 0; i < nb; i++)
+                     {
+                       if (has_integrator[i])
+                         {
+                           fespace->TransformMat (ids[i], elmats[i], TRANSFORM_MAT_LEFT_RIGHT);
+                           FlatArray<DofId> eldnums = dnums_buffer.Range(first_dof[i], first_dof[i+1]);
+                           for (auto j : Range(eldnums))
+                             {
+                               auto ct = fespace->GetDofCouplingType(eldnums[j]);
+                               for (size_t k = 0; k < dim; k++)
+                                 if (ct & CONDENSABLE_DOF)
+                                   {
+                                     idofs_all.Append (dim*j+k);
+                                     idnums_all.Append (dim*eldnums[j]+k);
+                                   }
+                                 else if (ct != UNUSED_DOF)
+                                   {
+                                     odofs_all.Append (dim*j+k);
+                                     ednums_all.Append (dim*eldnums[j]+k);
+                                   }
+                             }
+                         }
+                       first_i[i+1] = idofs_all.Size();
+                       first_o[i+1] = odofs_all.Size();
+                     }
+
+                   FlatArray<FlatMatrix<SCAL>> dmats(nb, lh);
+                   for (size_t i = 0; i < nb; i++)
+                     {
+                       auto idofs = idofs_all.Range(first_i[i], first_i[i+1]);
+                       dmats[i].AssignMemory (idofs.Size(), idofs.Size(), lh);
+                       dmats[i] = elmats[i].Rows(idofs).Cols(idofs);
+                       if (store_inner && idofs.Size())
+                         {
+                           auto idnums = idnums_all.Range(first_i[i], first_i[i+1]);
+                           innermatrix->AddElementMatrix(ids[i].Nr(), idnums, idnums, dmats[i]);
+                         }
+                     }
+                   
+                   if constexpr (is_same<SCAL,double>::value)
+                     {
+                       invmats.SetSize0();
+                       for (auto & d : dmats)
+                         if (d.Height()) invmats.Append (d);
+                       BatchedCalcInverse (invmats);
+                     }
+                   else
+                     for (auto & d : dmats)
+                       if (d.Height()) CalcInverse (d);
+
+                   for (size_t i = 0; i < nb; i++)
+                     {
+                       HeapReset hr(lh);
+                       auto idofs = idofs_all.Range(first_i[i], first_i[i+1]);
+                       auto odofs = odofs_all.Range(first_o[i], first_o[i+1]);
+                       if (!idofs.Size()) continue;
+                       auto idnums = idnums_all.Range(first_i[i], first_i[i+1]);
+                       auto ednums = ednums_all.Range(first_o[i], first_o[i+1]);
+                       FlatMatrix<SCAL> elmat = elmats[i];
+                       FlatMatrix<SCAL> d = dmats[i];
+
+                       FlatMatrix<SCAL> 
+                         a = elmat.Rows(odofs).Cols(odofs) | lh,
+                         b = elmat.Rows(odofs).Cols(idofs) | lh,
+                         c = Trans(elmat.Rows(idofs).Cols(odofs)) | lh;
+
+                       FlatMatrix<SCAL> he (idofs.Size(), odofs.Size(), lh);
+                       he = -d * Trans(c);
+                       harmonicext ->AddElementMatrix(ids[i].Nr(),idnums,ednums,he);
+                       if (!symmetric)
+                         {
+                           FlatMatrix<SCAL> het (odofs.Size(), idofs.Size(), lh);
+                           het = -b * d;
+                           static_cast<ElementByElementMatrix<SCAL>*>(harmonicexttrans.get())
+                             ->AddElementMatrix(ids[i].Nr(),ednums,idnums,het);
+                         }
+                       innersolve ->AddElementMatrix(ids[i].Nr(),idnums,idnums,d);
+                       a += b * he;
+                       elmat.Rows(odofs).Cols(odofs) = a;
+
+                       FlatArray<DofId> eldnums = dnums_buffer.Range(first_dof[i], first_dof[i+1]);
+                       for (auto & dnum : eldnums)
+                         if (fespace->GetDofCouplingType(dnum) & CONDENSABLE_DOF)
+                           dnum = NO_DOF_NR;
+                     }
+                 }
+
+               // stage 2: scatter, optionally ordered by first dof for locality
+               ThreadRegionTimer rega(tadd, TaskManager::GetThreadId());
+               order.SetSize(nb);
+               for (size_t i = 0; i < nb; i++)
+                 order[i] = i;
+               if (sort_scatter)
+                 {
+                   sortkeys.SetSize(nb);
+                   for (size_t i = 0; i < nb; i++)
+                     {
+                       sortkeys[i] = numeric_limits<DofId>::max();
+                       for (auto d : dnums_buffer.Range(first_dof[i], first_dof[i+1]))
+                         if (IsRegularDof(d)) sortkeys[i] = min2(sortkeys[i], d);
+                     }
+                   QuickSortI (sortkeys, order);
+                 }
+               
+               for (size_t i : order)
+                 {
+                   if (!has_integrator[i]) continue;
+                   FlatArray<DofId> eldnums = dnums_buffer.Range(first_dof[i], first_dof[i+1]);
+                   FlatMatrix<SCAL> elmat = elmats[i];
+                   if (!condense)
+                     fespace->TransformMat (ids[i], elmat, TRANSFORM_MAT_LEFT_RIGHT);
+                   AddElementMatrix (eldnums, eldnums, elmat, ids[i], lh);
+                   
+                   if (store_elmats)
+                     {
+                       auto & stored = stored_elmats[vb][ids[i].Nr()];
+                       stored.SetSize(elmat.Height(), elmat.Width());
+                       stored = elmat;
+                     }
+                   for (auto pre : preconditioners)
+                     pre -> AddElementMatrix (eldnums, elmat, ids[i], lh);
+                   if (check_unused)
+                     for (auto d : eldnums)
+                       if (IsRegularDof(d)) useddof[d] = true;
+                 }
+             };
+
+           void * heapp = lh.GetPointer();
+           auto reset = [&] ()
+             {
+               ids.SetSize0();
+               fels.SetSize0();
+               trafos.SetSize0();
+               dnums_buffer.SetSize0();
+               first_dof.SetSize(1);
+               first_dof[0] = 0;
+               lh.CleanUp(heapp);
+             };
+           reset();
+           
+           for (auto i : r)
+             {
+               if (ids.Size() == buffersize)
+                 {
+                   flush();
+                   reset();
+                 }
+               
+               ElementId ei(vb, els_of_col[i]);
+               fespace->GetDofNrs (ei, dnums);
+               ids.Append (ei);
+               fels.Append (&fespace->GetFE (ei, lh));
+               trafos.Append (&ma->GetTrafo (ei, lh));
+               dnums_buffer.Append (dnums);
+               first_dof.Append (dnums_buffer.Size());
+             }
+           flush();
+           reset();
+         });
+  }
+
+
+  template <class SCAL>
+  void S_BilinearForm<SCAL> :: ReAssembleElements (VorB vb, const BitArray & elements, LocalHeap & clh)
+  {
+    static Timer t("BilinearForm::ReAssembleElements");
+    static Timer tcalc("BilinearForm::ReAssembleElements - calc elmats", 2);
+    RegionTimer reg(t);
+
+    if (!store_elmats)
+      throw Exception ("ReAssembleElements needs flag 'store_elmats'");
+    if (MixedSpaces() || eliminate_internal || eliminate_hidden || diagonal)
+      throw Exception ("ReAssembleElements not supported for mixed spaces, static condensation or diagonal storage");
+
+    if (mats.Size() < ma->GetNLevels() || stored_elmats[vb].Size() != ma->GetNE(vb))
+      {
+        ReAssemble(clh);
+        return;
+      }
+
+    timestamp = ++global_timestamp;
+    
+    // only the marked elements of each color, so we still need no locks
+    for (FlatArray<int> els_of_col : fespace->ElementColoring(vb))
+      {
+        Array<int> dirty;
+        for (auto nr : els_of_col)
+          if (elements.Test(nr))
+            dirty.Append(nr);
+        
+        ParallelForRange
+          (dirty.Size(), [&] (IntRange r)
+           {
+             LocalHeap lh = clh.Split();
+             Array<int> temp_dnums;
+             for (auto i : r)
+               {
+                 HeapReset hr(lh);
+                 FESpace::Element el(*fespace, ElementId(vb, dirty[i]), temp_dnums, lh);
+                 const FiniteElement & fel = el.GetFE();
+                 const ElementTransformation & eltrans = el.GetTrafo();
+                 FlatArray<int> dnums = el.GetDofs();
+                 int elmat_size = dnums.Size()*fespace->GetDimension();
+                 
+                 FlatMatrix<SCAL> sum_elmat(elmat_size, lh);
+                 bool elem_has_integrator = false;
+                 {
+                   ThreadRegionTimer reg (tcalc, TaskManager::GetThreadId());
+                   bool done = false;
+                   while (!done)
+                     {
+                       done = true;
+                       sum_elmat = 0;
+                       for (auto & bfi : VB_parts[vb])
+                         {
+                           if (!bfi->DefinedOn (el.GetIndex())) continue;
+                           if (!bfi->DefinedOnElement (el.Nr())) continue;
+                           elem_has_integrator = true;
+                           try
+                             {
+                               auto & mapped_trafo = eltrans.AddDeformation(bfi->GetDeformation().get(), lh);
+                               bfi->CalcElementMatrixAdd (fel, mapped_trafo, sum_elmat, lh);
+                             }
+                           catch (ExceptionNOSIMD & e)
+                             {
+                               done = false;
+                             }
+                         }
+                     }
+                 }
+                 if (!elem_has_integrator) continue;
+                 
+                 fespace->TransformMat (el, sum_elmat, TRANSFORM_MAT_LEFT_RIGHT);
+                 
+                 // the global matrix still holds the old element contribution, add the difference
+                 auto & stored = stored_elmats[vb][el.Nr()];
+                 FlatMatrix<SCAL> diff(elmat_size, lh);
+                 diff = sum_elmat;
+                 if (stored.Height() == elmat_size)
+                   diff -= stored;
+                 AddElementMatrix (dnums, dnums, diff, el, lh);
+                 
+                 stored.SetSize(elmat_size, elmat_size);
+                 stored = sum_elmat;
+               }
+           });
+      }
+  }
+
+
   template <class SCAL>
   void S_BilinearForm<SCAL> :: DoAssemble (LocalHeap & clh)
   {
@@ -980,6 +1563,12 @@ namespace ngcomp
     static Timer mattimer_VB[] = { Timer("Matrix assembling vol"),
                                    Timer("Matrix assembling bound"),
                                    Timer("Matrix assembling co dim 2") };
+    static Timer mattimer_colored_VB[] = { Timer("Matrix assembling vol, colored"),
+                                           Timer("Matrix assembling bound, colored"),
+                                           Timer("Matrix assembling co dim 2, colored") };
+    static Timer mattimer_atomic_VB[] = { Timer("Matrix assembling vol, atomic"),
+                                          Timer("Matrix assembling bound, atomic"),
+                                          Timer("Matrix assembling co dim 2, atomic") };
     
     static mutex addelemfacbnd_mutex;
     static mutex addelemfacin_mutex;
@@ -1145,6 +1734,31 @@ namespace ngcomp
                 else // not diagonal
                   {
                     ProgressOutput progress(ma,string("assemble ") + ToString(vb) + string(" element"), ma->GetNE(vb));
+                    if (store_elmats)
+                      {
+                        stored_elmats[vb].SetSize(ne);
+                        for (auto & m : stored_elmats[vb])
+                          m.SetSize(0,0);
+                      }
+
+                    // the batched condensation keeps all interior blocks,
+                    // and does not handle hidden dofs or the spd-Schur complement
+                    bool batched_condense = false;
+                    if (eliminate_internal && keep_internal && vb == VOL && !spd)
+                      {
+                        batched_condense = true;
+                        for (DofId d : Range(fespace->GetNDof()))
+                          if (fespace->GetDofCouplingType(d) & HIDDEN_DOF)
+                            batched_condense = false;
+                      }
+                    
+                    if ((batch_assembly || assembly_buffer) && (!eliminate_internal || batched_condense) &&
+                        !eliminate_hidden && !printelmat && !elmat_ev)
+                      {
+                        AssembleBatched (vb, useddof, clh, batched_condense);
+                        gcnt += ne;
+                        continue;
+                      }
                     /*
                     if ( (vb == VOL || (!VB_parts[VOL].Size() && vb==BND) ) && eliminate_internal && keep_internal)
                       {
@@ -1158,8 +1772,12 @@ namespace ngcomp
                           innermatrix = make_shared<ElementByElementMatrix<SCAL>>(ndof, ne);
                       }
                     */
-                    IterateElements
-                      (*fespace, vb, clh,  [&] (FESpace::Element el, LocalHeap & lh)
+                    // preconditioners and the condensed right hand side are
+                    // not updated thread-safe, they need the colored loop
+                    bool use_atomic = atomic_assembly && !preconditioners.Size()
+                      && !(linearform && eliminate_internal && !keep_internal);
+                    
+                    auto assemble_element = [&] (FESpace::Element el, LocalHeap & lh)
                        {
                          if (elmat_ev && vb == VOL) 
                            *testout << " Assemble Element " << el.Nr() << endl;  
@@ -1605,6 +2223,13 @@ namespace ngcomp
                            }
                          
                          AddElementMatrix (dnums, dnums, sum_elmat, el, lh);
+
+                         if (store_elmats)
+                           {
+                             auto & stored = stored_elmats[vb][el.Nr()];
+                             stored.SetSize(sum_elmat.Height(), sum_elmat.Width());
+                             stored = sum_elmat;
+                           }
 			 
                          for (auto pre : preconditioners)
                            pre -> AddElementMatrix (dnums, sum_elmat, el, lh);
@@ -1617,7 +2242,18 @@ namespace ngcomp
                                if (IsRegularDof(d)) useddof[d] = true;
                            }
                          // timer3_VB[vb].Stop();
-                       });
+                       };
+                    
+                    if (use_atomic)
+                      {
+                        RegionTimer rega(mattimer_atomic_VB[vb]);
+                        IterateElementsUncolored (*fespace, vb, clh, assemble_element);
+                      }
+                    else
+                      {
+                        RegionTimer regc(mattimer_colored_VB[vb]);
+                        IterateElements (*fespace, vb, clh, assemble_element);
+                      }
                     progress.Done();
                     
                     /*
@@ -2181,25 +2817,20 @@ namespace ngcomp
             if (facetwise_skeleton_parts[BND].Size())
               {
                 // cout << "check bnd" << endl;
-                int cnt = 0;
-                int ne = ma->GetNE(BND);
+                for (FlatArray<int> colsels : SurfaceElementColoring(*fespace))
                 ParallelForRange
-                  ( IntRange(ne), [&] ( IntRange r )
+                  ( colsels.Size(), [&] ( IntRange r )
                     {
                       LocalHeap lh = clh.Split();
                       Array<int> fnums, elnums, vnums, svnums, dnums;
+                      {
+                        lock_guard<mutex> guard(printmatasstatus2_mutex);
+                        gcnt += r.Size();
+                        ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
+                      }
                       
-                      for (int i : r)
+                      for (int i : colsels.Range(r))
                         {
-                          {
-                            lock_guard<mutex> guard(printmatasstatus2_mutex);
-                            cnt++;
-                            gcnt++;
-                            // if (cnt % 10 == 0)
-                              // cout << "\rassemble facet surface element " << cnt << "/" << ne << flush;
-                            ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
-                          }
-                          
                           HeapReset hr(lh);
                           ElementId sei(BND, i);
                               
@@ -2289,10 +2920,7 @@ namespace ngcomp
                               //                    for(int k=0; k<elmat.Height(); k++)
                               //                      if(fabs(elmat(k,k)) < 1e-7 && dnums[k] != -1)
                               //                        cout << "dnums " << dnums << " elmat " << elmat << endl; 
-                              {
-                                lock_guard<mutex> guard(addelemfacbnd_mutex);
-                                AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
-                              }
+                              AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
                             }//end for (numintegrators)
                         }//end for nse                  
                     });//end of parallel
@@ -2831,16 +3459,20 @@ namespace ngcomp
               {
                 cout << IM(1) << "compute internal element ... ";
                 
-                //Set u_inner to zero
-                for (int i = 0; i < ne; i++)
-                  {
-                    HeapReset hr(clh);
-                    Array<int> dnums;
-                    fespace->GetDofNrs (ElementId(VOL,i), dnums, LOCAL_DOF);            
-                    FlatVector<SCAL> elu (dnums.Size(), clh);
-                    elu = 0.0;
-                    u.SetIndirect (dnums, elu);
-                  }
+                //Set u_inner to zero, elements have disjoint local dofs
+                ParallelForRange
+                  (ne, [&] (IntRange r)
+                   {
+                     Array<DofId> dnums;
+                     Vector<SCAL> elu;
+                     for (auto i : r)
+                       {
+                         fespace->GetDofNrs (ElementId(VOL,i), dnums, LOCAL_DOF);
+                         elu.SetSize (dnums.Size()*fespace->GetDimension());
+                         elu = 0.0;
+                         u.SetIndirect (dnums, elu);
+                       }
+                   });
                 
                 if (linearform)
                   u += *GetInnerSolve() * linearform->GetVector();
@@ -3405,13 +4037,14 @@ namespace ngcomp
             
             ProgressOutput progress (ma, "assemble skeleton element", ne);
             
+            for (FlatArray<int> colsels : SurfaceElementColoring(*fespace))
             ParallelForRange
-              ( IntRange(ne), [&] ( IntRange r )
+              ( colsels.Size(), [&] ( IntRange r )
                 {
                   LocalHeap lh = clh.Split();
                   Array<int> fnums, elnums, vnums, svnums, dnums;
                   
-                  for (int i : r)
+                  for (int i : colsels.Range(r))
                     {
                       progress.Update();                      
                       HeapReset hr(lh);
@@ -3505,10 +4138,7 @@ namespace ngcomp
                           //                    for(int k=0; k<elmat.Height(); k++)
                           //                      if(fabs(elmat(k,k)) < 1e-7 && dnums[k] != -1)
                           //                        cout << "dnums " << dnums << " elmat " << elmat << endl; 
-                          {
-                            lock_guard<mutex> guard(addelmatboundary1_mutex);                            
-                            AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
-                          }
+                          AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
                         }//end for (numintegrators)
                     }//end for nse                  
                 });//end of parallel
@@ -4233,6 +4863,8 @@ namespace ngcomp
           
                     
 
+          if (elementwise_skeleton_parts.Size())
+            ma->GetFacetElementTable();  // cached facet-element table for the loop below
           if (elementwise_skeleton_parts.Size())
             IterateElements 
               (*fespace, VOL, clh, 
@@ -5380,7 +6012,8 @@ namespace ngcomp
                     ElementId id,
                     LocalHeap & lh) 
   {
-    mymatrix -> TMATRIX::AddElementMatrix (dnums1, dnums2, elmat, this->fespace->HasAtomicDofs());
+    mymatrix -> TMATRIX::AddElementMatrix (dnums1, dnums2, elmat,
+                                           this->fespace->HasAtomicDofs() || this->atomic_assembly);
   }
 
 
@@ -5504,7 +6137,8 @@ namespace ngcomp
                     ElementId id, 
                     LocalHeap & lh) 
   {
-    mymatrix -> TMATRIX::AddElementMatrixSymmetric (dnums1, elmat, this->fespace->HasAtomicDofs());
+    mymatrix -> TMATRIX::AddElementMatrixSymmetric (dnums1, elmat,
+                                                    this->fespace->HasAtomicDofs() || this->atomic_assembly);
   }
 
 
@@ -6063,21 +6697,191 @@ namespace ngcomp
  
 
 
-  void BilinearForm :: GalerkinProjection ()
+  void BilinearForm :: CompressInternalMatrices ()
   {
-    auto prol = fespace->GetProlongation();
-    SparseMatrix<double>* prolMat = NULL;
+    if (!eliminate_internal || !keep_internal || !(condense_float || condense_share))
+      return;
+    for (auto mat : { GetHarmonicExtension(), GetHarmonicExtensionTrans(), GetInnerSolve() })
+      if (auto ebe = dynamic_pointer_cast<ElementByElementMatrix<double>> (mat))
+        ebe->Compress (condense_float, condense_share);
+  }
+
+  void BilinearForm :: CreateVariableBlockMatrix ()
+  {
+    variable_block_matrix = nullptr;
+    if (!variable_blocks) return;
+    
+    auto mat = mats.Last();
+    auto parmat = dynamic_pointer_cast<ParallelMatrix> (mat);
+    if (parmat) mat = parmat->GetMatrix();
+    auto spmat = dynamic_pointer_cast<SparseMatrixTM<double>> (mat);
+    if (!spmat)
+      throw Exception ("variable_blocks needs a real sparse matrix with scalar entries");
+
+    variable_block_matrix = make_shared<SparseMatrixVariableBlocks<double>> (*spmat);
+    if (parmat)
+      variable_block_matrix = make_shared<ParallelMatrix> (variable_block_matrix,
+                                                           parmat->GetRowParallelDofs(),
+                                                           parmat->GetColParallelDofs(),
+                                                           parmat->GetOpType());
+  }
+
+  /*
+    The integrands are affine in their Parameters p_k if the derivatives
+    d cf / d p_k contain no Parameter. Then A(p) = A_0 + sum_k p_k A_k,
+    the components are assembled once on the graph of the matrix, A_0
+    with all p = 0, A_k with p = e_k minus A_0.
+  */
+  bool BilinearForm :: FindParameterSplitting ()
+  {
+    split_parameters.SetSize0();
+    if (eliminate_internal || eliminate_hidden || store_elmats || galerkin || diagonal ||
+        preconditioners.Size())
+      return false;
+
+    Array<shared_ptr<CoefficientFunction>> cfs;
+    for (auto & bfi : parts)
+      {
+        if (auto sbfi = dynamic_pointer_cast<SymbolicBilinearFormIntegrator> (bfi))
+          cfs.Append (sbfi->GetCoefficientFunction());
+        else if (auto sfbfi = dynamic_pointer_cast<SymbolicFacetBilinearFormIntegrator> (bfi))
+          cfs.Append (sfbfi->GetCoefficientFunction());
+        else
+          return false;   // cannot look inside
+      }
+
+    auto has_parameter = [] (shared_ptr<CoefficientFunction> cf)
+      {
+        bool found = false;
+        cf->TraverseTree ([&] (CoefficientFunction & node)
+                          {
+                            if (dynamic_cast<ParameterCoefficientFunction*> (&node))
+                              found = true;
+                          });
+        return found;
+      };
+    
+    for (auto & cf : cfs)
+      cf->TraverseTree ([&] (CoefficientFunction & node)
+                        {
+                          if (!dynamic_cast<ParameterCoefficientFunction*> (&node)) return;
+                          auto param = dynamic_pointer_cast<ParameterCoefficientFunction> (node.shared_from_this());
+                          if (!split_parameters.Contains (param))
+                            split_parameters.Append (param);
+                        });
+    if (!split_parameters.Size())
+      return false;
 
-    if ( !low_order_bilinear_form )
-      for (int finelevel = ma->GetNLevels()-1; finelevel>0; finelevel--)
+    auto one = make_shared<ConstantCoefficientFunction> (1);
+    for (auto & cf : cfs)
+      for (auto & param : split_parameters)
         {
-          prolMat = prol->CreateProlongationMatrix (finelevel);
-          
-          mats[finelevel-1] = dynamic_cast< const BaseSparseMatrix& >(GetMatrix(finelevel)).
-            Restrict(*prolMat,dynamic_pointer_cast<BaseSparseMatrix>(GetMatrixPtr(finelevel-1)));
-          
-          delete prolMat;
+          try
+            {
+              if (has_parameter (cf->Diff (param.get(), one)))
+                return false;
+            }
+          catch (Exception & e)
+            {
+              return false;   // no symbolic derivative, e.g. compiled
+            }
         }
+    return true;
+  }
+
+  void BilinearForm :: AssembleParameterComponents (LocalHeap & lh)
+  {
+    static Timer t("BilinearForm::AssembleParameterComponents"); RegionTimer reg(t);
+    parameter_components.SetSize0();
+    if (!FindParameterSplitting())
+      {
+        cout << IM(3) << "parameter_splitting: form is not affine in Parameters, assemble as usual" << endl;
+        DoAssemble (lh);
+        return;
+      }
+    
+    BaseVector & values = GetMatrix().AsVector();
+    size_t np = split_parameters.Size();
+    Array<double> pvals(np);
+    for (size_t k = 0; k < np; k++)
+      {
+        pvals[k] = split_parameters[k]->GetValue();
+        split_parameters[k]->SetValue (0);
+      }
+
+    for (size_t k = 0; k <= np; k++)
+      {
+        if (k > 0) split_parameters[k-1]->SetValue (1);
+        GetMatrix() = 0.0;
+        DoAssemble (lh);
+        shared_ptr<BaseVector> comp = values.CreateVector();
+        comp->Set (1, values);
+        if (k > 0)
+          {
+            comp->Add (-1, *parameter_components[0]);
+            split_parameters[k-1]->SetValue (0);
+          }
+        parameter_components.Append (comp);
+      }
+
+    for (size_t k = 0; k < np; k++)
+      split_parameters[k]->SetValue (pvals[k]);
+    CombineParameterComponents();
+    cout << IM(3) << "parameter_splitting: " << np << " Parameters, "
+         << np+1 << " components assembled" << endl;
+  }
+
+  void BilinearForm :: CombineParameterComponents ()
+  {
+    static Timer t("BilinearForm::CombineParameterComponents"); RegionTimer reg(t);
+    BaseVector & values = GetMatrix().AsVector();
+    values.Set (1, *parameter_components[0]);
+    for (size_t k = 0; k < split_parameters.Size(); k++)
+      values.Add (split_parameters[k]->GetValue(), *parameter_components[k+1]);
+  }
+
+  void BilinearForm :: GalerkinProjection ()
+  {
+    static Timer t("BilinearForm::GalerkinProjection"); RegionTimer reg(t);
+    if (low_order_bilinear_form) return;
+
+    auto prol = fespace->GetProlongation();
+    int nlevels = ma->GetNLevels();
+    galerkin_prols.SetSize (nlevels);
+    galerkin_prolTs.SetSize (nlevels);
+    galerkin_raps.SetSize (nlevels);
+
+    for (int finelevel = nlevels-1; finelevel > 0; finelevel--)
+      {
+        size_t nf = fespace->GetNDofLevel (finelevel);
+        size_t nc = fespace->GetNDofLevel (finelevel-1);
+
+        auto & prolmat = galerkin_prols[finelevel];
+        if (!prolmat || size_t(prolmat->Height()) != nf || size_t(prolmat->Width()) != nc)
+          {
+            prolmat = shared_ptr<SparseMatrixTM<double>> (prol->CreateProlongationMatrix (finelevel));
+            if (!prolmat)
+              throw Exception ("GalerkinProjection: prolongation does not provide a matrix");
+            galerkin_prolTs[finelevel] = TransposeMatrix (*prolmat);
+            galerkin_raps[finelevel] = nullptr;
+          }
+
+        auto & finemat = GetMatrix (finelevel);
+        auto spmat = dynamic_cast<const SparseMatrix<double>*> (&finemat);
+        if (spmat && !dynamic_cast<const SparseMatrixSymmetricTM<double>*> (&finemat))
+          {
+            // parallel SpGEMM, only the numeric pass if the graph is unchanged
+            auto & rap = galerkin_raps[finelevel];
+            if (rap && rap->SameGraph (*spmat))
+              rap->Update (*spmat);
+            else
+              rap = make_shared<SparseRAP> (galerkin_prolTs[finelevel], *spmat, prolmat);
+            mats[finelevel-1] = rap->GetMatrix();
+          }
+        else
+          mats[finelevel-1] = dynamic_cast< const BaseSparseMatrix& >(finemat).
+            Restrict(*prolmat, dynamic_pointer_cast<BaseSparseMatrix>(GetMatrixPtr(finelevel-1)));
+      }
   }
 
   
@@ -6256,6 +7060,226 @@ namespace ngcomp
   }
   
   
+  DGBilinearFormApplication :: 
+  DGBilinearFormApplication (shared_ptr<BilinearForm> abf,
+                             LocalHeap & alh)
+    : BilinearFormApplication (abf, alh)
+  {
+    static Timer t("DGBilinearFormApplication - setup"); RegionTimer reg(t);
+    auto fes = bf->GetFESpace();
+    auto ma = bf->GetMeshAccess();
+
+    if (fes->IsComplex() || bf->GetFESpace2())
+      throw Exception ("DGBilinearFormApplication: only real, non-mixed bilinear-forms supported");
+    if (dynamic_pointer_cast<TPHighOrderFESpace>(fes))
+      throw Exception ("DGBilinearFormApplication: tensor-product spaces not supported");
+    if (bf->VB_Integrators(BND).Size() || bf->VB_Integrators(BBND).Size() ||
+        bf->VB_Integrators(BBBND).Size() || bf->HasSpecialIntegrators())
+      throw Exception ("DGBilinearFormApplication: only volume and facet-wise skeleton integrators supported");
+
+    Array<bool> attached(ma->GetNE(VOL));
+    attached = false;
+    Array<int> elnums, elnums_per, selnums;
+
+    const Table<int> & coloring = fes->FacetColoring();
+    colors.SetSize (coloring.Size());
+    for (size_t c = 0; c < coloring.Size(); c++)
+      for (int facet : coloring[c])
+        {
+          ma->GetFacetElements (facet, elnums);
+          if (elnums.Size() == 0) continue; // coarse facets
+
+          int facet2 = facet;
+          if (elnums.Size() < 2)
+            {
+              if (ma->GetCommunicator().Size() > 1)
+                if (ma->GetDistantProcs (NodeId(NT_FACET, facet)).Size() > 0)
+                  continue;
+
+              facet2 = ma->GetPeriodicFacet(facet);
+              if (facet2 > facet)
+                {
+                  ma->GetFacetElements (facet2, elnums_per);
+                  if (elnums_per.Size() > 1)
+                    throw Exception("DG-Apply failed due to invalid periodicity.");
+                  elnums.Append(elnums_per[0]);
+                }
+              else if (facet2 < facet)
+                continue;
+            }
+
+          Facet f;
+          f.facet = facet;
+          f.el1 = elnums[0];
+          f.facnr1 = ma->GetElFacets(ElementId(VOL, f.el1)).Pos(facet);
+          f.el2 = f.facnr2 = f.sel = -1;
+          if (elnums.Size() == 2)
+            {
+              f.el2 = elnums[1];
+              f.facnr2 = ma->GetElFacets(ElementId(VOL, f.el2)).Pos(facet2);
+            }
+          else
+            {
+              ma->GetFacetSurfaceElements (facet, selnums);
+              if (selnums.Size()) f.sel = selnums[0];
+            }
+
+          // facets of one color share no dofs, so the element terms
+          // can be added together with the first facet of the element
+          int els[2] = { f.el1, f.el2 };
+          for (int j : Range(2))
+            {
+              f.volume_els[j] = -1;
+              if (els[j] >= 0 && !attached[els[j]])
+                {
+                  attached[els[j]] = true;
+                  f.volume_els[j] = els[j];
+                }
+            }
+          colors[c].Append (f);
+        }
+
+    for (int i : Range(attached))
+      if (!attached[i])
+        remaining_elements.Append (i);
+  }
+
+  void DGBilinearFormApplication :: 
+  Mult (const BaseVector & v, BaseVector & prod) const
+  {
+    prod = 0;
+    MultAdd (1, v, prod);
+    prod.SetParallelStatus (DISTRIBUTED);
+  }
+
+  void DGBilinearFormApplication :: 
+  MultAdd (double val, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("DGBilinearFormApplication"); RegionTimer reg(t);
+    x.Cumulate();
+    y.Distribute();
+
+    auto fes = bf->GetFESpace();
+    auto ma = bf->GetMeshAccess();
+    auto & volume_parts = bf->VB_Integrators(VOL);
+    auto & inner_parts = bf->FacetwiseSkeletonIntegrators(VOL);
+    auto & boundary_parts = bf->FacetwiseSkeletonIntegrators(BND);
+    int dim = fes->GetDimension();
+    bool atomic = fes->HasAtomicDofs();
+
+    auto apply_element = [&] (int elnr, LocalHeap & lh)
+      {
+        HeapReset hr(lh);
+        ElementId ei(VOL, elnr);
+        if (!fes->DefinedOn (ei)) return;
+
+        const FiniteElement & fel = fes->GetFE (ei, lh);
+        ElementTransformation & trafo = ma->GetTrafo (ei, lh);
+        Array<DofId> dnums(fel.GetNDof(), lh);
+        fes->GetDofNrs (ei, dnums);
+
+        FlatVector<> elx(dnums.Size()*dim, lh), ely(dnums.Size()*dim, lh);
+        x.GetIndirect (dnums, elx);
+        fes->TransformVec (ei, elx, TRANSFORM_SOL);
+
+        for (auto & bfi : volume_parts)
+          {
+            if (!bfi->DefinedOn (trafo.GetElementIndex())) continue;
+            if (!bfi->DefinedOnElement (elnr)) continue;
+
+            auto & mapped_trafo = trafo.AddDeformation(bfi->GetDeformation().get(), lh);
+            bfi->ApplyElementMatrix (fel, mapped_trafo, elx, ely, 0, lh);
+            fes->TransformVec (ei, ely, TRANSFORM_RHS);
+            ely *= val;
+            y.AddIndirect (dnums, ely, atomic);
+          }
+      };
+
+    auto apply_facet = [&] (const Facet & f, LocalHeap & lh)
+      {
+        HeapReset hr(lh);
+        Array<int> vnums1(8, lh), vnums2(8, lh);
+        ElementId ei1(VOL, f.el1);
+
+        if (f.el2 < 0)
+          {
+            if (f.sel < 0 || boundary_parts.Size() == 0) return;
+            ElementId sei(BND, f.sel);
+
+            const FiniteElement & fel = fes->GetFE (ei1, lh);
+            Array<DofId> dnums(fel.GetNDof(), lh);
+            fes->GetDofNrs (ei1, dnums);
+            vnums1 = ma->GetElVertices (ei1);
+            vnums2 = ma->GetElVertices (sei);
+            ElementTransformation & eltrans = ma->GetTrafo (ei1, lh);
+            ElementTransformation & seltrans = ma->GetTrafo (sei, lh);
+
+            FlatVector<> elx(dnums.Size()*dim, lh), ely(dnums.Size()*dim, lh);
+            x.GetIndirect (dnums, elx);
+            for (auto & bfi : boundary_parts)
+              {
+                if (!bfi->DefinedOn (seltrans.GetElementIndex())) continue;
+                if (!bfi->DefinedOnElement (f.facet)) continue;
+
+                bfi->ApplyFacetMatrix (fel, f.facnr1, eltrans, vnums1, seltrans, vnums2, elx, ely, lh);
+                ely *= val;
+                y.AddIndirect (dnums, ely, atomic);
+              }
+            return;
+          }
+
+        if (inner_parts.Size() == 0) return;
+        ElementId ei2(VOL, f.el2);
+
+        ElementTransformation & eltrans1 = ma->GetTrafo (ei1, lh);
+        ElementTransformation & eltrans2 = ma->GetTrafo (ei2, lh);
+        const FiniteElement & fel1 = fes->GetFE (ei1, lh);
+        const FiniteElement & fel2 = fes->GetFE (ei2, lh);
+        vnums1 = ma->GetElVertices (ei1);
+        vnums2 = ma->GetElVertices (ei2);
+
+        Array<DofId> dnums1(fel1.GetNDof(), lh), dnums2(fel2.GetNDof(), lh);
+        fes->GetDofNrs (ei1, dnums1);
+        fes->GetDofNrs (ei2, dnums2);
+        Array<DofId> dnums(dnums1.Size()+dnums2.Size(), lh);
+        dnums.Range(0, dnums1.Size()) = dnums1;
+        dnums.Range(dnums1.Size(), dnums.Size()) = dnums2;
+
+        FlatVector<> elx(dnums.Size()*dim, lh), ely(dnums.Size()*dim, lh);
+        x.GetIndirect (dnums, elx);
+        for (auto & bfi : inner_parts)
+          {
+            if (!bfi->DefinedOn (eltrans1.GetElementIndex())) continue; 
+            if (!bfi->DefinedOn (eltrans2.GetElementIndex())) continue; 
+            if (!bfi->DefinedOnElement (f.facet)) continue;
+
+            bfi->ApplyFacetMatrix (fel1, f.facnr1, eltrans1, vnums1,
+                                   fel2, f.facnr2, eltrans2, vnums2, elx, ely, lh);
+            ely *= val;
+            y.AddIndirect (dnums, ely, atomic);
+          }
+      };
+
+    for (auto & facets : colors)
+      ParallelForRange
+        (facets.Size(), [&] (IntRange r)
+         {
+           LocalHeap slh = lh.Split();
+           for (auto i : r)
+             {
+               const Facet & f = facets[i];
+               for (int el : f.volume_els)
+                 if (el >= 0)
+                   apply_element (el, slh);
+               apply_facet (f, slh);
+             }
+         });
+
+    for (int el : remaining_elements)
+      apply_element (el, lh);
+  }
+
+  
   LinearizedBilinearFormApplication ::
   LinearizedBilinearFormApplication (shared_ptr<BilinearForm> abf,
                                      const BaseVector * aveclin,
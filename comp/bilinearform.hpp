@@ -34,6 +34,30 @@ namespace ngcomp
     bool diagonal;
     /// element-matrix for ref-elements
     bool geom_free;
+    /// keep element matrices for partial re-assembly
+    bool store_elmats;
+    /// scatter element matrices with atomic adds, no element coloring
+    bool atomic_assembly;
+    /// share the matrix graph with other forms on the same spaces
+    bool reuse_graph;
+    /// directory of the setup cache files for the matrix graph, empty for none
+    string setupcache;
+    /// merge integrals with the same domain and integration rule into one integrator
+    bool fuse_integrals;
+    /// compute element matrices of batches of equal elements together
+    bool batch_assembly;
+    /// number of element matrices computed per thread before they are scattered
+    size_t assembly_buffer;
+    /// scatter buffered element matrices ordered by their first dof
+    bool sort_scatter;
+    /// copy of the assembled matrix in variable-block format
+    bool variable_blocks;
+    shared_ptr<BaseMatrix> variable_block_matrix;
+    /// assemble the Parameter-free components of affine forms once, and combine them on re-assembly
+    bool parameter_splitting;
+    Array<shared_ptr<ParameterCoefficientFunction>> split_parameters;
+    /// matrix values of A_0 and A_k, A(p) = A_0 + sum_k p_k A_k
+    Array<shared_ptr<BaseVector>> parameter_components;
     /// store matrices on mesh hierarchy
     bool multilevel;
     /// galerkin projection of coarse grid matrices
@@ -62,6 +86,10 @@ namespace ngcomp
     /// matrices (sparse, application, diagonal, ...)
     Array<shared_ptr<BaseMatrix>> mats;
     size_t graph_timestamp = 0;
+    /// Galerkin projection: prolongation matrices, transposes and products
+    /// per fine level, the products are reused while the graphs do not change
+    Array<shared_ptr<SparseMatrixTM<double>>> galerkin_prols, galerkin_prolTs;
+    Array<shared_ptr<SparseRAP>> galerkin_raps;
     
     /// bilinearform-integrators
     Array<shared_ptr<BilinearFormIntegrator>> parts;
@@ -107,6 +135,10 @@ namespace ngcomp
     bool keep_internal;
     /// should A_ii itself be stored?!
     bool store_inner; 
+    /// store the matrices of condensation in float
+    bool condense_float;
+    /// store equal matrices of condensation once
+    bool condense_share;
     
     /// precomputes some data for each element
     bool precompute;
@@ -151,6 +183,23 @@ namespace ngcomp
       return parts;
     }
 
+    /// integrators on elements of type vb
+    const Array<shared_ptr<BilinearFormIntegrator>> & VB_Integrators (VorB vb) const
+    {
+      return VB_parts[vb];
+    }
+
+    /// facet-wise skeleton integrators, VOL .. inner facets, BND .. boundary facets
+    const Array<shared_ptr<FacetBilinearFormIntegrator>> & FacetwiseSkeletonIntegrators (VorB vb) const
+    {
+      return facetwise_skeleton_parts[vb];
+    }
+
+    /// element-wise skeleton and geometry-free integrators
+    bool HasSpecialIntegrators () const
+    {
+      return elementwise_skeleton_parts.Size() || geom_free_parts.Size() || specialelements.Size();
+    }
     ///
     int NumIntegrators () const 
     {
@@ -208,6 +257,14 @@ namespace ngcomp
     /// if reallocate is false, the existing matrix is reused
     void ReAssemble (LocalHeap & lh, bool reallocate = 0);
 
+    /// estimated LocalHeap per thread for the assembling
+    size_t EstimateHeapSize () const;
+
+    /// re-computes the element matrices of marked elements only, 
+    /// and updates the assembled matrix by the difference to the stored element matrices.
+    /// needs flag 'store_elmats'
+    virtual void ReAssembleElements (VorB vb, const BitArray & elements, LocalHeap & lh);
+
     /// assembles matrix at linearization point given by lin
     /// needed for Newton's method
     virtual void AssembleLinearization (const BaseVector & lin,
@@ -329,6 +386,7 @@ namespace ngcomp
 
     /// is the form symmetric ?
     bool IsSymmetric() const { return symmetric; }
+    bool FuseIntegrals() const { return fuse_integrals; }
 
     /// is the form symmetric and positive definite ?
     bool IsSPD() const { return spd; }
@@ -378,6 +436,19 @@ namespace ngcomp
     /// computes low-order matrices from fines matrix
     void GalerkinProjection ();
 
+    /// harmonic extensions and inner solve in float or shared, see ElementByElementMatrix::Compress
+    void CompressInternalMatrices ();
+
+    /// the variable-block copy of the matrix, see SparseMatrixVariableBlocks
+    void CreateVariableBlockMatrix ();
+    /// the Parameters if all integrands are affine in them, false otherwise
+    bool FindParameterSplitting ();
+    void AssembleParameterComponents (LocalHeap & lh);
+    void CombineParameterComponents ();
+    FlatArray<shared_ptr<ParameterCoefficientFunction>> GetSplitParameters () const
+    { return parameter_components.Size() ? split_parameters : FlatArray<shared_ptr<ParameterCoefficientFunction>>(); }
+    shared_ptr<BaseMatrix> GetVariableBlockMatrix () const { return variable_block_matrix; }
+
     /// reconstruct internal dofs
     virtual void ComputeInternal (BaseVector & u, const BaseVector & f, LocalHeap & lh) const = 0;
 
@@ -442,6 +513,9 @@ namespace ngcomp
     shared_ptr<ElementByElementMatrix<SCAL>> innersolve; //  = NULL;
     shared_ptr<ElementByElementMatrix<SCAL>> innermatrix; //  = NULL;
 
+    /// element matrices as added to the global matrix (flag 'store_elmats')
+    Array<Matrix<SCAL>> stored_elmats[4];
+
 #ifdef PARALLEL
     //data for mpi-facets; only has data if there are relevant integrators in the BLF!
     mutable bool have_mpi_facet_data = false;
@@ -557,6 +631,11 @@ namespace ngcomp
 
     ///
     virtual void DoAssemble (LocalHeap & lh);
+    /// element loop of DoAssemble, computes buffers of element matrices, then scatters them
+    /// condense: static condensation with stored harmonic extension, without hidden dofs
+    void AssembleBatched (VorB vb, FlatArray<bool> useddof, LocalHeap & lh, bool condense = false);
+    ///
+    virtual void ReAssembleElements (VorB vb, const BitArray & elements, LocalHeap & lh);
     ///
     // virtual void DoAssembleIndependent (BitArray & useddof, LocalHeap & lh);
     ///
@@ -962,6 +1041,31 @@ namespace ngcomp
     }
   };
 
+  /**
+     Matrix-free application of DG forms with volume and facet-wise skeleton integrators.
+     The facet topology is computed once. The volume terms of an element are applied
+     together with one of its facets, within the facet-coloring loop.
+   */
+  class NGS_DLL_HEADER DGBilinearFormApplication : public BilinearFormApplication
+  {
+    struct Facet
+    {
+      int facet;
+      int el1, el2;        // el2 = -1 for boundary facets
+      int facnr1, facnr2;
+      int sel;             // surface element of boundary facets, or -1
+      int volume_els[2];   // volume terms applied with this facet, or -1
+    };
+    Array<Array<Facet>> colors;
+    Array<int> remaining_elements;    // volume terms not attached to a facet
+  public:
+    DGBilinearFormApplication (shared_ptr<BilinearForm> abf, LocalHeap & alh);
+
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const override;
+    virtual void MultAdd (double val, const BaseVector & v, BaseVector & prod) const override;
+    using BilinearFormApplication::MultAdd;
+  };
+
   /**
      Applies the matrix-vector product of linearized matrix.
      Linearization point is given in the constructor
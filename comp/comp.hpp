@@ -78,6 +78,8 @@ namespace ngcomp
 
 #include "facetsurffespace.hpp"
 #include "fesconvert.hpp"
+#include "parametersweep.hpp"
+#include "devassembly.hpp"
 
 // #include "bddc.hpp"
 #include "vtkoutput.hpp"
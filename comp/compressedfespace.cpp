@@ -15,6 +15,9 @@ namespace ngcomp
       integrator[vb] = space->GetIntegrator(vb);
     }
     iscomplex = space->IsComplex();
+    // the remapped element dofs are stored in FinalizeUpdate
+    if (!flags.GetDefineFlagX("cache_dofnrs").IsFalse())
+      cache_dofnrs = true;
   }
 
   void CompressedFESpace::Update()
@@ -48,6 +51,14 @@ namespace ngcomp
     }
     comp2all.SetSize(ndof);
 
+    // entries of the vectors as doubles
+    size_t es = space->GetDimension() * (iscomplex ? 2 : 1);
+    Array<size_t> ind(ndof*es);
+    for (size_t i : Range(ndof))
+      for (size_t k : Range(es))
+        ind[i*es+k] = comp2all[i]*es+k;
+    restriction = make_shared<PermutationMatrix> (ndofall*es, std::move(ind));
+
     ctofdof.SetSize(ndof);
     for (int i : Range(ndof))
       ctofdof[i] = space->GetDofCouplingType(comp2all[i]);
@@ -68,6 +79,12 @@ namespace ngcomp
 
   void CompressedFESpace::GetDofNrs (ElementId ei, Array<DofId> & dnums) const
   {
+    auto & tab = dof_table[ei.VB()];
+    if (tab.Size())
+      {
+        dnums = tab[ei.Nr()];
+        return;
+      }
     space->GetDofNrs(ei,dnums);
     WrapDofs(dnums);
   }
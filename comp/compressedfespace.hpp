@@ -15,6 +15,8 @@ namespace ngcomp
     Array<DofId> comp2all;
     Array<DofId> all2comp;
     shared_ptr<BitArray> active_dofs = nullptr;
+    /// the restriction from the base space, built in Update
+    shared_ptr<PermutationMatrix> restriction;
 
     //TODO: flag to hide HIDDEN_DOFs
 
@@ -23,6 +25,9 @@ namespace ngcomp
     virtual ~CompressedFESpace () {};
     void Update() override;
     shared_ptr<FESpace> GetBaseSpace() const { return space; }
+    /// the compressed dofs of a vector of the base space, as index view,
+    /// the transpose is the extension by zero
+    shared_ptr<PermutationMatrix> GetRestriction() const { return restriction; }
 
     void WrapDofs(Array<DofId> & dnums) const
     {
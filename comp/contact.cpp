@@ -156,6 +156,108 @@ namespace ngcomp
     return L2Norm(pmaster-p);
   }
 
+  template<int DIM>
+  void BoundaryBVH<DIM> :: FitNode (Node & node)
+  {
+    if (node.child < 0)
+      {
+        node.pmin = 1e99;
+        node.pmax = -1e99;
+        for (int i = node.first; i < node.next; i++)
+          for (int k = 0; k < DIM; k++)
+            {
+              node.pmin(k) = min(node.pmin(k), elmin[i](k));
+              node.pmax(k) = max(node.pmax(k), elmax[i](k));
+            }
+        return;
+      }
+    const Node & c1 = nodes[node.child];
+    const Node & c2 = nodes[node.child+1];
+    for (int k = 0; k < DIM; k++)
+      {
+        node.pmin(k) = min(c1.pmin(k), c2.pmin(k));
+        node.pmax(k) = max(c1.pmax(k), c2.pmax(k));
+      }
+  }
+
+  template<int DIM>
+  void BoundaryBVH<DIM> :: BuildNode (int nr, int first, int next, FlatArray<Vec<DIM>> centers)
+  {
+    constexpr int leafsize = 4;
+    nodes[nr].child = -1;
+    nodes[nr].first = first;
+    nodes[nr].next = next;
+    if (next-first <= leafsize) return;
+
+    // split at the median of the centers along the longest extent
+    Vec<DIM> cmin = 1e99, cmax = -1e99;
+    for (int i = first; i < next; i++)
+      for (int k = 0; k < DIM; k++)
+        {
+          cmin(k) = min(cmin(k), centers[elnrs[i]](k));
+          cmax(k) = max(cmax(k), centers[elnrs[i]](k));
+        }
+    int dir = 0;
+    for (int k = 1; k < DIM; k++)
+      if (cmax(k)-cmin(k) > cmax(dir)-cmin(dir)) dir = k;
+
+    int mid = (first+next)/2;
+    std::nth_element (elnrs.Data()+first, elnrs.Data()+mid, elnrs.Data()+next,
+                      [&] (int a, int b) { return centers[a](dir) < centers[b](dir); });
+
+    int child = nodes.Size();
+    nodes.Append (Node());
+    nodes.Append (Node());
+    nodes[nr].child = child;
+    BuildNode (child, first, mid, centers);
+    BuildNode (child+1, mid, next, centers);
+  }
+
+  template<int DIM>
+  void BoundaryBVH<DIM> :: Build (FlatArray<int> aelnrs,
+                                  FlatArray<Vec<DIM>> bmin, FlatArray<Vec<DIM>> bmax)
+  {
+    size_t n = aelnrs.Size();
+    // while building, elnrs holds positions into the input arrays
+    elnrs.SetSize(n);
+    Array<Vec<DIM>> centers(n);
+    for (size_t i = 0; i < n; i++)
+      {
+        elnrs[i] = i;
+        centers[i] = 0.5 * (bmin[i]+bmax[i]);
+      }
+
+    nodes.SetSize0();
+    if (n > 0)
+      {
+        nodes.Append (Node());
+        BuildNode (0, 0, n, centers);
+      }
+
+    elmin.SetSize(n);
+    elmax.SetSize(n);
+    for (size_t i = 0; i < n; i++)
+      {
+        elmin[i] = bmin[elnrs[i]];
+        elmax[i] = bmax[elnrs[i]];
+        elnrs[i] = aelnrs[elnrs[i]];
+      }
+    for (int i = nodes.Size()-1; i >= 0; i--)
+      FitNode (nodes[i]);
+  }
+
+  template<int DIM>
+  void BoundaryBVH<DIM> :: Refit (FlatArray<Vec<DIM>> bmin, FlatArray<Vec<DIM>> bmax)
+  {
+    elmin = bmin;
+    elmax = bmax;
+    for (int i = nodes.Size()-1; i >= 0; i--)
+      FitNode (nodes[i]);
+  }
+
+  template class BoundaryBVH<2>;
+  template class BoundaryBVH<3>;
+
   template<int DIM>
   optional<ContactPair<DIM>> T_GapFunction<DIM> :: CreateContactPair(const MappedIntegrationPoint<DIM-1, DIM>& mip1, LocalHeap& lh) const
   {
@@ -177,16 +279,11 @@ namespace ngcomp
     int el2_min(-1);
 
 
-    // find all bound-2 elements closer to p1 then h
-
-    netgen::Point<DIM> ngp1;
-    for (int j = 0; j < DIM; j++) ngp1(j) = p1(j);
-    netgen::Box<DIM> box(ngp1, ngp1);
-    box.Increase(h);
+    // find all bound-2 elements closer to p1 than mindist
 
     Vec<DIM> p2_min;
-    searchtree->GetFirstIntersecting
-      (box.PMin(), box.PMax(),
+    searchtree.Search
+      (p1, mindist,
        [&] (int elnr2)
        {
          auto el2 = ma->GetElement(ElementId(BND, elnr2));
@@ -213,7 +310,6 @@ namespace ngcomp
            p2_min = p2;
            intersect = true;
          }
-         return false;
        });
 
     if(intersect)
@@ -227,103 +323,86 @@ namespace ngcomp
   template<int DIM>
   void T_GapFunction<DIM> :: Update(shared_ptr<GridFunction> displacement_, int intorder2, double h_)
   {
+    static Timer t("T_GapFunction::Update"); RegionTimer reg(t);
     h = h_;
 
     displacement = displacement_;
     auto fes = displacement->GetFESpace();
     intorder2 = 10*fes->GetOrder();
 
-    LocalHeap lh(1000000, "T_GapFunction::Update");
-    netgen::Box<DIM> bbox{netgen::Box<DIM>::EMPTY_BOX};
-    double maxh = 0;
-    for (Ngs_Element el2 : ma->Elements(BND))
+    // the tree topology is kept as long as the mesh does not change,
+    // a new displacement only refits the boxes
+    bool refit = searchtree_timestamp == ma->GetTimeStamp();
+    Array<int> elnrs;
+    if (refit)
+      elnrs = searchtree.Elements();
+    else
       {
-        HeapReset hr(lh);
         auto & mask = slave.Mask();
-        if (!mask.Test(el2.GetIndex())) continue;
-
-        auto & trafo2 = ma->GetTrafo (el2, lh);
-        auto & trafo2_def = trafo2.AddDeformation(displacement.get(), lh);
-
-        IntegrationRule ir2(trafo2.GetElementType(), intorder2);
-        MappedIntegrationRule<DIM-1, DIM> mir2(ir2, trafo2, lh);
-        MappedIntegrationRule<DIM-1, DIM> mir2_def(ir2, trafo2_def, lh);
-
-        netgen::Box<DIM> el_box{netgen::Box<DIM>::EMPTY_BOX};
-        for (auto & mip : mir2_def)
-          {
-            netgen::Point<DIM> p;
-            for (int j = 0; j < DIM; j++)
-              p(j) = mip.GetPoint()(j);
-            bbox.Add(p);
-            if(h==0.0)
-              el_box.Add(p);
-          }
-        maxh = max(maxh, el_box.Diam());
+        for (Ngs_Element el2 : ma->Elements(BND))
+          if (mask.Test(el2.GetIndex()))
+            elnrs.Append (el2.Nr());
       }
 
+    // boxes of the deformed elements, sampled at integration points
+    Array<Vec<DIM>> bmin(elnrs.Size()), bmax(elnrs.Size());
+    Array<double> diam(elnrs.Size());
+    LocalHeap clh(1000000*TaskManager::GetNumThreads(), "T_GapFunction::Update");
+    ParallelForRange
+      (elnrs.Size(), [&] (IntRange r)
+       {
+         LocalHeap lh = clh.Split();
+         for (auto i : r)
+           {
+             HeapReset hr(lh);
+             ElementId ei2(BND, elnrs[i]);
+             auto & trafo2 = ma->GetTrafo (ei2, lh);
+             auto & trafo2_def = trafo2.AddDeformation(displacement.get(), lh);
+
+             IntegrationRule ir2(trafo2.GetElementType(), intorder2);
+             MappedIntegrationRule<DIM-1, DIM> mir2_def(ir2, trafo2_def, lh);
+
+             Vec<DIM> pmin = 1e99, pmax = -1e99;
+             for (auto & mip : mir2_def)
+               for (int j = 0; j < DIM; j++)
+                 {
+                   pmin(j) = min(pmin(j), mip.GetPoint()(j));
+                   pmax(j) = max(pmax(j), mip.GetPoint()(j));
+                 }
+             bmin[i] = pmin;
+             bmax[i] = pmax;
+             diam[i] = L2Norm(pmax-pmin);
+           }
+       });
+
     // Default-value for h is 2 * maximum_element_diameter
     if(h==0.0)
-      h = 2*maxh;
-
-    searchtree = make_unique<netgen::BoxTree<DIM, int>>(bbox);
-    for (Ngs_Element el2 : ma->Elements(BND))
       {
-        HeapReset hr(lh);
-        auto & mask = slave.Mask();
-        if (!mask.Test(el2.GetIndex())) continue;
-
-        auto & trafo2 = ma->GetTrafo (el2, lh);
-        auto & trafo2_def = trafo2.AddDeformation(displacement.get(), lh);
-
-        IntegrationRule ir2(trafo2.GetElementType(), intorder2);
-        MappedIntegrationRule<DIM-1, DIM> mir2(ir2, trafo2, lh);
-        MappedIntegrationRule<DIM-1, DIM> mir2_def(ir2, trafo2_def, lh);
-
-        for (auto & mip : mir2_def)
-          {
-            netgen::Point<DIM> p;
-            for (int j = 0; j < DIM; j++)
-              p(j) = mip.GetPoint()(j);
-            bbox.Add(p);
-          }
+        double maxh = 0;
+        for (double d : diam)
+          maxh = max(maxh, d);
+        h = 2*maxh;
+      }
 
-        searchtree->Insert(bbox, el2.Nr());
+    if (refit)
+      searchtree.Refit (bmin, bmax);
+    else
+      {
+        searchtree.Build (elnrs, bmin, bmax);
+        searchtree_timestamp = ma->GetTimeStamp();
       }
   }
 
   template<int DIM>
-  void T_GapFunction<DIM> :: Evaluate(const BaseMappedIntegrationPoint & ip,
-                                      FlatVector<> result) const
+  void T_GapFunction<DIM> :: FindGap (const Ngs_Element & el1, Vec<DIM> p1, Vec<DIM> nv,
+                                      FlatVector<> result, LocalHeap & lh) const
   {
-    LocalHeapMem<100000> lh("gapfunction");
-    auto & trafo1 = ip.GetTransformation();
-    const auto & el1 = ma->GetElement(trafo1.GetElementId());
-    result = 0;
-    if (!master.Mask().Test(el1.GetIndex())) return;
-
-    int intorder2 = 2*displacement->GetFESpace()->GetOrder();
-
-    auto & trafo1_def = trafo1.AddDeformation(displacement.get(), lh);
-
-    auto & ip1 = ip.IP();
-    Vec<DIM> p1;
-    trafo1_def.CalcPoint(ip1, p1);
-
-    double mindist = 1e99;
+    double mindist = h;
     result = std::numeric_limits<double>::infinity();
 
-    // find all bound-2 elements closer to p1 than h
-    netgen::Point<DIM> ngp1;
-    for (int j = 0; j < DIM; j++)
-      ngp1(j) = p1(j);
-    netgen::Box<DIM> box(ngp1, ngp1);
-    box.Increase(h);
-
-    auto & mip = static_cast<const DimMappedIntegrationPoint<DIM>&>(ip);
-
-    searchtree->GetFirstIntersecting
-      (box.PMin(), box.PMax(),
+    // find all bound-2 elements closer to p1 than mindist
+    searchtree.Search
+      (p1, mindist,
        [&] (int elnr2)
        {
          auto el2 = ma->GetElement( ElementId (BND, elnr2) );
@@ -334,29 +413,59 @@ namespace ngcomp
            for (auto v : el2.Vertices() )
              if(s_v==v)
                common_vertex = true;
-         if (common_vertex) return false;
+         if (common_vertex) return;
          auto & trafo2 = ma->GetTrafo (el2, lh);
          auto & trafo2_def = trafo2.AddDeformation(displacement.get(), lh);
 
          Vec<DIM> p2;
          IntegrationPoint ip2;
-         double dist = FindClosestPoint<DIM-1,DIM>(p1, mip.GetNV(), mindist, trafo2_def, ip2, p2 );
+         double dist = FindClosestPoint<DIM-1,DIM>(p1, nv, mindist, trafo2_def, ip2, p2 );
          if(dist<mindist && dist < h)
          {
            mindist = dist;
            result = p2-p1;
          }
-         return false;
        });
   }
 
+  template<int DIM>
+  void T_GapFunction<DIM> :: Evaluate(const BaseMappedIntegrationPoint & ip,
+                                      FlatVector<> result) const
+  {
+    LocalHeapMem<100000> lh("gapfunction");
+    auto & trafo1 = ip.GetTransformation();
+    const auto & el1 = ma->GetElement(trafo1.GetElementId());
+    result = 0;
+    if (!master.Mask().Test(el1.GetIndex())) return;
+
+    auto & trafo1_def = trafo1.AddDeformation(displacement.get(), lh);
+    Vec<DIM> p1;
+    trafo1_def.CalcPoint(ip.IP(), p1);
+
+    auto & mip = static_cast<const DimMappedIntegrationPoint<DIM>&>(ip);
+    FindGap (el1, p1, mip.GetNV(), result, lh);
+  }
+
   template<int DIM>
   void T_GapFunction<DIM> :: Evaluate(const BaseMappedIntegrationRule & mir,
                                       BareSliceMatrix<> hresult) const
   {
     auto result = hresult.AddSize(mir.Size(), Dimension());
+    LocalHeapMem<100000> lh("gapfunction");
+    auto & trafo1 = mir.GetTransformation();
+    const auto & el1 = ma->GetElement(trafo1.GetElementId());
+    result = 0;
+    if (!master.Mask().Test(el1.GetIndex())) return;
+
+    // deformed points of the whole rule at once
+    auto & trafo1_def = trafo1.AddDeformation(displacement.get(), lh);
+    auto & mir_def = trafo1_def(mir.IR(), lh);
     for (auto i : Range(mir))
-      Evaluate(mir[i], result.Row(i));
+      {
+        Vec<DIM> p1 = mir_def[i].GetPoint();
+        auto & mip = static_cast<const DimMappedIntegrationPoint<DIM>&>(mir[i]);
+        FindGap (el1, p1, mip.GetNV(), result.Row(i), lh);
+      }
   }
 
   template class T_GapFunction<2>;
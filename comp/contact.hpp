@@ -31,10 +31,76 @@ namespace ngcomp
     void Draw();
   };
 
+  /*
+    Bounding volume hierarchy over boundary elements.
+    The tree topology is built once from the element boxes, 
+    moved elements only refit the boxes of the nodes.
+   */
+  template <int DIM>
+  class BoundaryBVH
+  {
+    struct Node
+    {
+      Vec<DIM> pmin, pmax;
+      int child;         // children are child and child+1, -1 for a leaf
+      int first, next;   // leaf: range in elnrs
+    };
+    Array<Node> nodes;             // children are stored after their parent
+    Array<int> elnrs;              // element numbers in leaf order
+    Array<Vec<DIM>> elmin, elmax;  // element boxes in leaf order
+
+    void BuildNode (int nr, int first, int next, FlatArray<Vec<DIM>> centers);
+    void FitNode (Node & node);
+  public:
+    /// boxes are given in the order of aelnrs
+    void Build (FlatArray<int> aelnrs, FlatArray<Vec<DIM>> bmin, FlatArray<Vec<DIM>> bmax);
+    /// new boxes in leaf order, same elements
+    void Refit (FlatArray<Vec<DIM>> bmin, FlatArray<Vec<DIM>> bmax);
+    /// elements in leaf order
+    FlatArray<int> Elements () const { return elnrs; }
+    size_t Size () const { return elnrs.Size(); }
+
+    /// calls func(elnr) for all elements whose box intersects the cube p +/- radius.
+    /// func may decrease radius to prune the remaining search
+    template <typename FUNC>
+    void Search (const Vec<DIM> & p, double & radius, FUNC func) const
+    {
+      if (nodes.Size() == 0) return;
+      auto intersects = [&] (const Vec<DIM> & bmin, const Vec<DIM> & bmax)
+        {
+          for (int k = 0; k < DIM; k++)
+            if (p(k)+radius < bmin(k) || p(k)-radius > bmax(k))
+              return false;
+          return true;
+        };
+      ArrayMem<int,64> stack;
+      stack.Append(0);
+      while (stack.Size())
+        {
+          const Node & node = nodes[stack.Last()];
+          stack.DeleteLast();
+          if (!intersects (node.pmin, node.pmax)) continue;
+          if (node.child >= 0)
+            {
+              stack.Append (node.child+1);
+              stack.Append (node.child);
+              continue;
+            }
+          for (int i = node.first; i < node.next; i++)
+            if (intersects (elmin[i], elmax[i]))
+              func (elnrs[i]);
+        }
+    }
+  };
+
   template <int DIM>
   class T_GapFunction : public GapFunction
   {
-    unique_ptr<netgen::BoxTree<DIM, int>> searchtree;
+    BoundaryBVH<DIM> searchtree;
+    size_t searchtree_timestamp = 0;
+
+    void FindGap (const Ngs_Element & el1, Vec<DIM> p1, Vec<DIM> nv,
+                  FlatVector<> result, LocalHeap & lh) const;
   public:
     T_GapFunction( shared_ptr<MeshAccess> mesh_, Region master_, Region slave_)
       : GapFunction(mesh_, master_, slave_)
@@ -42,7 +108,7 @@ namespace ngcomp
 
     void Update(shared_ptr<GridFunction> gf, int intorder_, double h) override;
 
-    const netgen::BoxTree<DIM, int>& GetSearchTree() { return *searchtree; }
+    const BoundaryBVH<DIM> & GetSearchTree() const { return searchtree; }
 
     double Evaluate (const BaseMappedIntegrationPoint & ip) const override
     {
@@ -0,0 +1,243 @@
+#ifdef CUDA
+
+/*********************************************************************/
+/* File:   devassembly.cpp                                           */
+/* Author: Joachim Schoeberl                                         */
+/* Date:   Oct. 2026                                                 */
+/*********************************************************************/
+
+/*
+   assembly of the matrix on the device, see fem/fem_kernels.cu
+*/
+
+#include <comp.hpp>
+#include <cuda_runtime.h>
+#include <map>
+#include <mutex>
+
+extern void DevReferenceCoefs (int nel, int D, int nterms, const int * types,
+                               int nin, const double * in, int ncoef, double * coefs);
+extern void DevAssembleElementMatrices (int nel, int ndof, int ncoef, const double * refmats,
+                                        const double * coefs, const int * dofs,
+                                        const int * firstrow, const int * cols, double * vals);
+
+namespace ngcomp
+{
+
+  // the element matrix, its coefficients and dofs are held in shared memory
+  static constexpr size_t DEV_SHARED_MEMORY = 48*1024;
+
+  // elements with the same reference element matrices
+  struct DeviceElementGroup
+  {
+    int D = 0, ndof = 0, nin = 0, ncoef = 0;
+    Array<int> types;                       // type1, type2 per term
+    Array<const Matrix<double>*> mats;      // reference element matrices per term
+    Array<double> in;                       // Jacobian and coefficient matrices, nin per element
+    Array<int> dofs;                        // ndof per element
+    size_t nel = 0;
+  };
+
+  template <typename T>
+  static T * CopyToDevice (FlatArray<T> a)
+  {
+    T * dev;
+    cudaMalloc ((void**)&dev, max2(a.Size(), size_t(1)) * sizeof(T));
+    cudaMemcpy (dev, a.Data(), a.Size()*sizeof(T), cudaMemcpyHostToDevice);
+    return dev;
+  }
+
+  shared_ptr<BaseMatrix> AssembleOnDevice (BilinearForm & bf, LocalHeap & clh)
+  {
+    static Timer t("AssembleOnDevice"); RegionTimer reg(t);
+    static Timer thost("AssembleOnDevice host");
+    static Timer tdev("AssembleOnDevice device");
+
+    auto fes = bf.GetFESpace();
+    auto ma = fes->GetMeshAccess();
+    if (bf.GetFESpace2() || fes->IsComplex() || fes->GetDimension() != 1)
+      throw Exception ("AssembleOnDevice: needs a real, scalar bilinear-form on one space");
+    if (bf.HasSpecialIntegrators() ||
+        bf.FacetwiseSkeletonIntegrators(VOL).Size() || bf.FacetwiseSkeletonIntegrators(BND).Size())
+      throw Exception ("AssembleOnDevice: skeleton and special integrators are not supported");
+    // shape functions without transformation of the element matrices
+    bool device_space = dynamic_pointer_cast<H1HighOrderFESpace> (fes) != nullptr;
+
+    MatrixGraph * graph = bf.GetGraph (ma->GetNLevels()-1, false);
+    SparseMatrix<double> hostmat(*graph, 1);
+    delete graph;
+    hostmat.AsVector() = 0.0;
+
+    std::map<std::vector<size_t>, DeviceElementGroup> groups;
+    std::mutex groups_mutex;
+    size_t nhost = 0, ndevice = 0;
+
+    {
+      RegionTimer regh(thost);
+      for (VorB vb : { VOL, BND, BBND, BBBND })
+        for (auto & bfi : bf.VB_Integrators(vb))
+          {
+            auto sbfi = dynamic_pointer_cast<SymbolicBilinearFormIntegrator> (bfi);
+            bool try_device = device_space && sbfi && !bfi->GetDeformation();
+            std::atomic<size_t> cnt_host(0), cnt_device(0);
+
+            ParallelForRange
+              (ma->GetNE(vb), [&] (IntRange r)
+               {
+                 LocalHeap lh = clh.Split();
+                 Array<DofId> temp_dnums;
+                 Array<SymbolicBilinearFormIntegrator::ReferenceTerm> terms;
+                 std::map<std::vector<size_t>, DeviceElementGroup> mygroups;
+                 for (auto i : r)
+                   {
+                     HeapReset hr(lh);
+                     ElementId ei(vb, i);
+                     if (!fes->DefinedOn(ei)) continue;
+                     FESpace::Element el(*fes, ei, temp_dnums, lh);
+                     if (!bfi->DefinedOn (el.GetIndex())) continue;
+                     if (!bfi->DefinedOnElement (el.Nr())) continue;
+                     const FiniteElement & fel = el.GetFE();
+                     FlatArray<DofId> dnums = el.GetDofs();
+                     int D = fel.Dim();
+                     FlatMatrix<> jac(D, D, lh);
+
+                     size_t ndof = dnums.Size();
+                     bool on_device = false;
+                     try
+                       {
+                         on_device = try_device &&
+                           sbfi->GetReferenceTerms (fel, el.GetTrafo(), jac, terms, lh);
+                       }
+                     catch (ExceptionNOSIMD & e)
+                       {
+                         terms.SetSize0();
+                       }
+                     size_t ncoef = 0;
+                     for (auto & term : terms)
+                       ncoef += term.dmat.Height()*term.dmat.Width();
+                     if ((ncoef+ndof*ndof)*sizeof(double)+ndof*sizeof(int) > DEV_SHARED_MEMORY)
+                       on_device = false;
+
+                     if (!on_device)
+                       {
+                         FlatMatrix<> elmat(ndof, lh);
+                         bool done = false;
+                         while (!done)
+                           {
+                             done = true;
+                             elmat = 0.0;
+                             try
+                               {
+                                 auto & mapped_trafo = el.GetTrafo().AddDeformation(bfi->GetDeformation().get(), lh);
+                                 bfi->CalcElementMatrixAdd (fel, mapped_trafo, elmat, lh);
+                               }
+                             catch (ExceptionNOSIMD & e)
+                               {
+                                 done = false;
+                               }
+                           }
+                         fes->TransformMat (el, elmat, TRANSFORM_MAT_LEFT_RIGHT);
+                         hostmat.AddElementMatrix (dnums, dnums, elmat, true);
+                         cnt_host++;
+                         continue;
+                       }
+
+                     std::vector<size_t> key { ndof };
+                     for (auto & term : terms)
+                       {
+                         key.push_back (size_t(term.mats));
+                         key.push_back (term.type1);
+                         key.push_back (term.type2);
+                       }
+                     auto & group = mygroups[key];
+                     if (group.nel == 0)
+                       {
+                         group.D = D;
+                         group.ndof = ndof;
+                         group.nin = D*D;
+                         for (auto & term : terms)
+                           {
+                             group.types.Append (term.type1);
+                             group.types.Append (term.type2);
+                             group.mats.Append (term.mats);
+                             group.nin += term.dmat.Height()*term.dmat.Width();
+                           }
+                         group.ncoef = group.nin-D*D;
+                       }
+                     group.in += FlatArray<double> (D*D, jac.Data());
+                     for (auto & term : terms)
+                       group.in += FlatArray<double> (term.dmat.Height()*term.dmat.Width(), term.dmat.Data());
+                     group.dofs += dnums;
+                     group.nel++;
+                     cnt_device++;
+                   }
+
+                 lock_guard<mutex> guard(groups_mutex);
+                 for (auto & [key, mygroup] : mygroups)
+                   {
+                     auto & group = groups[key];
+                     if (group.nel == 0)
+                       {
+                         group = std::move(mygroup);
+                         continue;
+                       }
+                     group.in += mygroup.in;
+                     group.dofs += mygroup.dofs;
+                     group.nel += mygroup.nel;
+                   }
+               });
+            nhost += cnt_host;
+            ndevice += cnt_device;
+          }
+    }
+
+    auto devmat = make_shared<DevSparseMatrix> (hostmat);
+
+    {
+      RegionTimer regd(tdev);
+      for (auto & [key, group] : groups)
+        {
+          size_t nn = size_t(group.ndof)*group.ndof;
+          Vector<> refmats(group.ncoef*nn);
+          size_t pos = 0;
+          for (auto mats : group.mats)
+            {
+              FlatVector<> fv = mats->AsVector();
+              refmats.Range(pos, pos+fv.Size()) = fv;
+              pos += fv.Size();
+            }
+
+          int * dev_types = CopyToDevice (FlatArray<int> (group.types));
+          double * dev_in = CopyToDevice (FlatArray<double> (group.in));
+          double * dev_refmats = CopyToDevice (FlatArray<double> (refmats.Size(), refmats.Data()));
+          int * dev_dofs = CopyToDevice (FlatArray<int> (group.dofs));
+          double * dev_coefs;
+          cudaMalloc ((void**)&dev_coefs, group.nel*group.ncoef*sizeof(double));
+
+          DevReferenceCoefs (group.nel, group.D, group.mats.Size(), dev_types,
+                             group.nin, dev_in, group.ncoef, dev_coefs);
+          DevAssembleElementMatrices (group.nel, group.ndof, group.ncoef, dev_refmats,
+                                      dev_coefs, dev_dofs,
+                                      devmat->DevRowStart(), devmat->DevCol(), devmat->DevVal());
+
+          cudaFree (dev_coefs);
+          cudaFree (dev_dofs);
+          cudaFree (dev_refmats);
+          cudaFree (dev_in);
+          cudaFree (dev_types);
+        }
+      cudaDeviceSynchronize();
+    }
+
+    cout << IM(3) << "AssembleOnDevice: " << ndevice << " element matrices in "
+         << groups.size() << " groups on the device, " << nhost << " on the host" << endl;
+
+    shared_ptr<BaseMatrix> mat = devmat;
+    if (fes->IsParallel())
+      mat = make_shared<ParallelMatrix> (mat, fes->GetParallelDofs(), fes->GetParallelDofs());
+    return mat;
+  }
+
+}
+
+#endif
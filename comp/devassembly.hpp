@@ -0,0 +1,35 @@
+#ifndef FILE_DEVASSEMBLY
+#define FILE_DEVASSEMBLY
+
+/*********************************************************************/
+/* File:   devassembly.hpp                                           */
+/* Author: Joachim Schoeberl                                         */
+/* Date:   Oct. 2026                                                 */
+/*********************************************************************/
+
+#ifdef CUDA
+
+namespace ngcomp
+{
+
+  /**
+     Assembles the matrix of the bilinear-form into a DevSparseMatrix.
+
+     Symbolic integrators with element-wise constant coefficients in
+     values and gradients of real H1 spaces on affine elements are
+     assembled on the device: the elements are grouped by their
+     reference element matrices (shape functions at the SIMD rule on
+     the reference element, shared by all elements of equal shape class
+     and order), the geometry is uploaded as one Jacobian per element,
+     and one cuda-block per element builds the element matrix in shared
+     memory and scatters it atomically into the CSR values. The other
+     elements and integrators are assembled on the host into the
+     initial values of the matrix.
+  */
+  NGS_DLL_HEADER shared_ptr<BaseMatrix> AssembleOnDevice (BilinearForm & bf, LocalHeap & clh);
+
+}
+
+#endif
+
+#endif
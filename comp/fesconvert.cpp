@@ -1,8 +1,22 @@
 #include <comp.hpp>
+#include <map>
 
 namespace ngcomp
 {
 
+  /** the element matrices can be reused if the element fe does not depend on per-node orders **/
+  static bool UniformOrder (const FESpace & fes)
+  {
+    if (auto comp = dynamic_cast<const CompoundFESpace*> (&fes))
+      {
+        for (int i = 0; i < comp->GetNSpaces(); i++)
+          if (!UniformOrder (*(*comp)[i]))
+            return false;
+        return true;
+      }
+    return fes.GetOrderPolicy() == CONSTANT_ORDER || fes.GetOrderPolicy() == OLDSTYLE_ORDER;
+  }
+
   template<int BSA, int BSB, typename SCAL> struct TM_TRAIT { typedef Mat<BSA, BSB, SCAL> type; };
   template<> struct TM_TRAIT<1, 1, double> { typedef double type; };
   template<> struct TM_TRAIT<1, 1, Complex> { typedef Complex type; };
@@ -113,14 +127,14 @@ namespace ngcomp
 	 {
 	   Array<DofId> dnums_a(100), dnums_b(100);
 	   int tid = (task_manager == nullptr) ? 0 : task_manager->GetThreadId();
-	   int& maxdsa = tmdsa[tid], maxdsb = tmdsb[tid];
+	   int & maxdsa = tmdsa[tid], & maxdsb = tmdsb[tid];
 	   for (auto i : r) {
 	     ElementId eid(vb, i);
 	     Ngs_Element el = ma->GetElement(eid);
 	     if ( (!space_a->DefinedOn(vb, el.GetIndex())) || (!space_b->DefinedOn(vb, el.GetIndex())) )
-	       { return; }
+	       { continue; }
 	     if ( reg && !reg->Mask().Test(el.GetIndex()) )
-	       { return; }
+	       { continue; }
 	     space_a->GetDofNrs(eid, dnums_a, ANY_DOF); // get rid of UNUSED DOFs
 	     maxdsa = max2(maxdsa, int(dnums_a.Size()));
 	     for (auto da : dnums_a)
@@ -171,6 +185,12 @@ namespace ngcomp
     spmat->AsVector() = 0;
     bspmat = spmat;
 
+    /** local conversion matrices of affine simplex elements, per thread, keyed by
+	element type, ordering of the vertices (orientation of the shapes), ndofs and Jacobian **/
+    bool reuse_local = UniformOrder(*space_a) && UniformOrder(*space_b);
+    Array<std::map<std::vector<double>, Matrix<SCAL>>> local_mats(TaskManager::GetMaxThreads());
+    atomic<size_t> nreused(0);
+
     auto fill_lam = [&](FESpace::Element & fei, LocalHeap & lh) {
       /** Get Finite Elements / Element Transformation **/
       const ElementTransformation & eltrans = fei.GetTrafo();
@@ -186,24 +206,52 @@ namespace ngcomp
       if (dnums_b.Size() == 0) // (compressed space)
 	{ return; }
 
-      /** Calc mass/dual and mixed mass/dual matrices **/
-      FlatMatrix<SCAL> bamat(felb.GetNDof() * dimb, fela.GetNDof() * dima, lh); bamat = 0.0;
-      FlatMatrix<SCAL> bbmat(felb.GetNDof() * dimb, felb.GetNDof() * dimb, lh); bbmat = 0.0;
-      for (auto bfi : ab_bfis)
-	{ bfi->CalcElementMatrixAdd(felab, eltrans, bamat, lh); }
-      for (auto bfi : bb_bfis)
-	{ bfi->CalcElementMatrixAdd(felb, eltrans, bbmat, lh); }
-
-      /** Calc Elmat **/
-      // cout << " bamat " << endl << bamat << endl;
-      // cout << " bbmat " << endl << bbmat << endl;
-
-      CalcInverse(bbmat); // NOT symmetric!!
+      FlatMatrix<SCAL> elmat(felb.GetNDof() * dimb, fela.GetNDof() * dima, lh);
 
-      // cout << " bbmat inv " << endl << bbmat << endl;
+      std::vector<double> key;
+      ELEMENT_TYPE et = felb.ElementType();
+      if (reuse_local && !eltrans.IsCurvedElement() && (et == ET_SEGM || et == ET_TRIG || et == ET_TET))
+	{
+	  auto verts = ma->GetElement(ei).Vertices();
+	  key.push_back (et);
+	  key.push_back (fela.GetNDof());
+	  key.push_back (felb.GetNDof());
+	  for (auto v : verts)
+	    {
+	      int rank = 0;
+	      for (auto w : verts)
+		if (w < v) rank++;
+	      key.push_back (rank);
+	    }
+	  FlatMatrix<> jac(eltrans.SpaceDim(), ElementTopology::GetSpaceDim(et), lh);
+	  eltrans.CalcJacobian (IntegrationPoint(0.0, 0.0, 0.0), jac);
+	  for (auto val : jac.AsVector())
+	    key.push_back (val);
+	}
 
-      FlatMatrix<SCAL> elmat(felb.GetNDof() * dimb, fela.GetNDof() * dima, lh);
-      elmat = bbmat * bamat;
+      auto & mycache = local_mats[TaskManager::GetThreadId()];
+      auto pos = key.size() ? mycache.find(key) : mycache.end();
+      if (pos != mycache.end())
+	{
+	  elmat = pos->second;
+	  nreused++;
+	}
+      else
+	{
+	  /** Calc mass/dual and mixed mass/dual matrices **/
+	  FlatMatrix<SCAL> bamat(felb.GetNDof() * dimb, fela.GetNDof() * dima, lh); bamat = 0.0;
+	  FlatMatrix<SCAL> bbmat(felb.GetNDof() * dimb, felb.GetNDof() * dimb, lh); bbmat = 0.0;
+	  for (auto bfi : ab_bfis)
+	    { bfi->CalcElementMatrixAdd(felab, eltrans, bamat, lh); }
+	  for (auto bfi : bb_bfis)
+	    { bfi->CalcElementMatrixAdd(felb, eltrans, bbmat, lh); }
+
+	  /** Calc Elmat **/
+	  CalcInverse(bbmat); // NOT symmetric!!
+	  elmat = bbmat * bamat;
+	  if (key.size())
+	    mycache.emplace (std::move(key), Matrix<SCAL>(elmat));
+	}
 
       // cout << " elmat " << endl << elmat << endl;
 
@@ -238,6 +286,7 @@ namespace ngcomp
     }
     else // use_simd
       { it_els(fill_lam); }
+    cout << IM(5) << "ConvertOperator: " << nreused << " local matrices reused" << endl;
 	      
 #ifdef PARALLEL
     if (space_b->IsParallel() && !localop)
@@ -267,14 +316,83 @@ namespace ngcomp
   } // ConvertOperator
 
 
+  /** cached conversion operators, valid as long as the spaces and the mesh are not updated **/
+  struct ConvertOperatorCacheEntry
+  {
+    weak_ptr<FESpace> space_a, space_b;
+    size_t timestamp_a, timestamp_b, timestamp_mesh;
+    VorB vb;
+    DifferentialOperator * diffop;
+    BitArray region, range;
+    bool has_region, has_range;
+    bool localop, parmat, use_simd;
+    int bonus_intorder_ab, bonus_intorder_bb;
+    shared_ptr<BaseMatrix> op;
+  };
+
+  static bool SameBits (const BitArray & a, const BitArray & b)
+  {
+    if (a.Size() != b.Size()) return false;
+    for (size_t i = 0; i < a.Size(); i++)
+      if (a.Test(i) != b.Test(i)) return false;
+    return true;
+  }
+
+  static Array<ConvertOperatorCacheEntry> convert_cache;
+  static mutex convert_cache_mutex;
+
+
   shared_ptr<BaseMatrix> ConvertOperator (shared_ptr<FESpace> space_a, shared_ptr<FESpace> space_b, VorB vb, LocalHeap & lh,
 					  shared_ptr<DifferentialOperator> diffop, const Region * reg,
 					  shared_ptr<BitArray> range_dofs, bool localop, bool parmat, bool use_simd,
-					  int bonus_intorder_ab, int bonus_intorder_bb)
+					  int bonus_intorder_ab, int bonus_intorder_bb, bool cache)
   {
     if ( space_a->IsComplex() != space_b->IsComplex() ) // b complex and a real could work in principle (?)
       { throw Exception("Cannot convert between complex and non-complex space!"); }
 
+    ConvertOperatorCacheEntry entry;
+    if (cache)
+      {
+	entry.space_a = space_a;
+	entry.space_b = space_b;
+	entry.timestamp_a = space_a->GetUpdateTimeStamp();
+	entry.timestamp_b = space_b->GetUpdateTimeStamp();
+	entry.timestamp_mesh = space_b->GetMeshAccess()->GetTimeStamp();
+	entry.vb = vb;
+	entry.diffop = diffop.get();
+	entry.has_region = reg != nullptr;
+	if (reg) entry.region = reg->Mask();
+	entry.has_range = range_dofs != nullptr;
+	if (range_dofs) entry.range = *range_dofs;
+	entry.localop = localop;
+	entry.parmat = parmat;
+	entry.use_simd = use_simd;
+	entry.bonus_intorder_ab = bonus_intorder_ab;
+	entry.bonus_intorder_bb = bonus_intorder_bb;
+
+	lock_guard<mutex> guard(convert_cache_mutex);
+	for (size_t i = 0; i < convert_cache.Size(); )
+	  {
+	    // drop entries of deleted or updated spaces
+	    auto & e = convert_cache[i];
+	    auto ea = e.space_a.lock(), eb = e.space_b.lock();
+	    if (!ea || !eb || ea->GetUpdateTimeStamp() != e.timestamp_a ||
+		eb->GetUpdateTimeStamp() != e.timestamp_b ||
+		eb->GetMeshAccess()->GetTimeStamp() != e.timestamp_mesh)
+	      {
+		convert_cache.DeleteElement(i);
+		continue;
+	      }
+	    if (ea == space_a && eb == space_b && e.vb == vb && e.diffop == entry.diffop &&
+		e.has_region == entry.has_region && (!reg || SameBits(e.region, entry.region)) &&
+		e.has_range == entry.has_range && (!range_dofs || SameBits(e.range, entry.range)) &&
+		e.localop == localop && e.parmat == parmat && e.use_simd == use_simd &&
+		e.bonus_intorder_ab == bonus_intorder_ab && e.bonus_intorder_bb == bonus_intorder_bb)
+	      return e.op;
+	    i++;
+	  }
+      }
+
     shared_ptr<BaseMatrix> op;
 
     /** This is a workaround because nested Switch does not work with gcc 7 **/
@@ -300,7 +418,183 @@ namespace ngcomp
 	}
       });
 
+    if (cache)
+      {
+	entry.op = op;
+	lock_guard<mutex> guard(convert_cache_mutex);
+	convert_cache.Append (std::move(entry));
+      }
     return op;
   } // ConvertOperator
 
+
+
+  shared_ptr<BaseMatrix> MeshTransferOperator (shared_ptr<FESpace> space_a, shared_ptr<FESpace> space_b,
+					       LocalHeap & clh, int bonus_intorder)
+  {
+    static Timer t("MeshTransferOperator"); RegionTimer reg(t);
+    static Timer tloc("MeshTransferOperator - locate");
+    static Timer tfill("MeshTransferOperator - fill");
+
+    auto ma_a = space_a->GetMeshAccess();
+    auto ma_b = space_b->GetMeshAccess();
+    if (ma_a->GetDimension() != ma_b->GetDimension())
+      { throw Exception("MeshTransferOperator: meshes of different dimension!"); }
+    if (space_a->IsComplex() || space_b->IsComplex())
+      { throw Exception("MeshTransferOperator: only real spaces!"); }
+    if (space_a->GetDimension() != 1 || space_b->GetDimension() != 1)
+      { throw Exception("MeshTransferOperator: spaces with block dofs (dim > 1) not supported, use a compound space!"); }
+
+    auto eval_a = space_a->GetEvaluator(VOL);
+    auto eval_b = space_b->GetEvaluator(VOL);
+    if (eval_a->Dim() != eval_b->Dim())
+      { throw Exception(string("Cannot transfer from ") + space_a->GetClassName() + string(" to ") + space_b->GetClassName() +
+			string(" - dimensions mismatch: ") + to_string(eval_a->Dim()) +
+			string(" != ") + to_string(eval_b->Dim()) + string("!")); }
+    int dim = eval_b->Dim();
+    size_t ne = ma_b->GetNE(VOL);
+
+    auto intorder = [&] (const FiniteElement & felb)
+      { return felb.Order() + space_a->GetOrder() + bonus_intorder; };
+
+    /** integration points of the target elements, located once in the source mesh **/
+    Array<int> npoints(ne);
+    ParallelForRange (ne, [&] (IntRange r)
+      {
+	LocalHeap lh = clh.Split();
+	for (auto i : r)
+	  {
+	    HeapReset hr(lh);
+	    ElementId ei(VOL, i);
+	    npoints[i] = 0;
+	    if (!space_b->DefinedOn(ei)) continue;
+	    const FiniteElement & felb = space_b->GetFE(ei, lh);
+	    npoints[i] = IntegrationRule(felb.ElementType(), intorder(felb)).Size();
+	  }
+      });
+    Table<int> src_el(npoints);
+    Table<IntegrationPoint> src_ip(npoints);
+
+    atomic<size_t> outside(0);
+    {
+      RegionTimer regloc(tloc);
+      ParallelForRange (ne, [&] (IntRange r)
+	{
+	  LocalHeap lh = clh.Split();
+	  int hint = -1;
+	  for (auto i : r)
+	    {
+	      if (npoints[i] == 0) continue;
+	      HeapReset hr(lh);
+	      ElementId ei(VOL, i);
+	      const FiniteElement & felb = space_b->GetFE(ei, lh);
+	      IntegrationRule ir(felb.ElementType(), intorder(felb));
+	      auto & mir = ma_b->GetTrafo(ei, lh)(ir, lh);
+	      for (size_t q = 0; q < ir.Size(); q++)
+		{
+		  // neighbouring points are in neighbouring elements
+		  hint = ma_a->FindElementOfPoint (mir[q].GetPoint(), src_ip[i][q], hint, lh);
+		  src_el[i][q] = hint;
+		  if (hint < 0) outside++;
+		}
+	    }
+	});
+    }
+    if (outside)
+      cout << IM(3) << "MeshTransferOperator: " << outside << " integration points outside of the source mesh" << endl;
+
+    /** Create Matrix Graph: rows the target dofs, columns the dofs of the source elements **/
+    TableCreator<int> crnrs(ne), ccnrs(ne);
+    for (; !crnrs.Done(); crnrs++, ccnrs++ )
+      ParallelForRange (ne, [&](IntRange r)
+	{
+	  Array<DofId> dnums, cols;
+	  for (auto i : r)
+	    {
+	      if (npoints[i] == 0) continue;
+	      space_b->GetDofNrs(ElementId(VOL, i), dnums);
+	      for (auto d : dnums)
+		if (IsRegularDof(d))
+		  { crnrs.Add(i, d); }
+	      cols.SetSize0();
+	      for (auto elnr : src_el[i])
+		if (elnr >= 0)
+		  {
+		    space_a->GetDofNrs(ElementId(VOL, elnr), dnums);
+		    for (auto d : dnums)
+		      if (IsRegularDof(d) && !cols.Contains(d))
+			cols.Append(d);
+		  }
+	      for (auto d : cols)
+		{ ccnrs.Add(i, d); }
+	    }
+	});
+    Table<int> rnrs = crnrs.MoveTable(), cnrs = ccnrs.MoveTable();
+    MatrixGraph graph (space_b->GetNDof(), space_a->GetNDof(), rnrs, cnrs, false);
+    auto spmat = make_shared<SparseMatrix<double>>(graph, true);
+    spmat->AsVector() = 0;
+
+    /** local L2-projection onto the target element, averaged between elements **/
+    Array<int> cnt_b(space_b->GetNDof()); cnt_b = 0;
+    {
+      RegionTimer regfill(tfill);
+      IterateElements(*space_b, VOL, clh, // coloring of space_b, the rows are written
+		      [&](FESpace::Element fei, LocalHeap & lh)
+      {
+	size_t i = fei.Nr();
+	if (npoints[i] == 0) return;
+	const FiniteElement & felb = fei.GetFE();
+	IntegrationRule ir(felb.ElementType(), intorder(felb));
+	auto & mir = fei.GetTrafo()(ir, lh);
+	auto cols = cnrs[i];
+	size_t nb = felb.GetNDof();
+
+	FlatMatrix<> mass(nb, nb, lh), mixed(nb, cols.Size(), lh);
+	FlatMatrix<double,ColMajor> bmat(dim, nb, lh);
+	mass = 0.0;
+	mixed = 0.0;
+	Array<DofId> dnums_a;
+	for (size_t q = 0; q < ir.Size(); q++)
+	  {
+	    eval_b->CalcMatrix(felb, mir[q], bmat, lh);
+	    double w = mir[q].GetWeight();
+	    mass += w * Trans(bmat) * bmat;
+
+	    int elnr = src_el[i][q];
+	    if (elnr < 0) continue;
+	    HeapReset hr(lh);
+	    ElementId eia(VOL, elnr);
+	    const FiniteElement & fela = space_a->GetFE(eia, lh);
+	    auto & mipa = ma_a->GetTrafo(eia, lh)(src_ip[i][q], lh);
+	    FlatMatrix<double,ColMajor> amat(dim, fela.GetNDof(), lh);
+	    eval_a->CalcMatrix(fela, mipa, amat, lh);
+	    FlatMatrix<> bta(nb, fela.GetNDof(), lh);
+	    bta = w * Trans(bmat) * amat;
+	    space_a->GetDofNrs(eia, dnums_a);
+	    for (size_t k = 0; k < dnums_a.Size(); k++)
+	      if (IsRegularDof(dnums_a[k]))
+		mixed.Col(cols.Pos(dnums_a[k])) += bta.Col(k);
+	  }
+	CalcInverse(mass);
+	FlatMatrix<> elmat(nb, cols.Size(), lh);
+	elmat = mass * mixed;
+
+	auto dnums_b = fei.GetDofs();
+	spmat->AddElementMatrix(dnums_b, cols, elmat, false);
+	for (auto d : dnums_b)
+	  if (IsRegularDof(d))
+	    { cnt_b[d]++; }
+      });
+    }
+
+    for (auto dofnr : Range(spmat->Height()))
+      if (cnt_b[dofnr] > 1)
+	{
+	  double fac = 1.0 / double(cnt_b[dofnr]);
+	  for (auto & v : spmat->GetRowValues(dofnr))
+	    { v *= fac; }
+	}
+    return spmat;
+  } // MeshTransferOperator
+
 } // namespace ngcomp
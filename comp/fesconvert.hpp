@@ -4,10 +4,27 @@
 namespace ngcomp
 {
 
+  /**
+     The conversion operator gfb = diffop(gfa), from dual shapes of spaceb
+     and averaging between elements. Affine simplex elements with equal
+     Jacobian and vertex ordering share their local conversion matrix.
+     With cache, the operator is kept and returned again for the same
+     arguments as long as the spaces and the mesh are not updated.
+  */
   shared_ptr<BaseMatrix> ConvertOperator (shared_ptr<FESpace> spacea, shared_ptr<FESpace> spaceb, VorB vb, LocalHeap & lh,
 					  shared_ptr<DifferentialOperator> diffop = nullptr, const Region * reg = NULL,
 					  shared_ptr<BitArray> range_dofs = nullptr, bool localop = false, bool parmat = true, bool use_simd = true,
-					  int bonus_intorder_ab = 0, int bonus_intorder_bb = 0);
+					  int bonus_intorder_ab = 0, int bonus_intorder_bb = 0, bool cache = false);
+
+
+  /**
+     Transfer of functions from spacea to spaceb on a different (non-matching) mesh,
+     by local L2-projection onto the elements of spaceb and averaging between elements.
+     The integration points of the target elements are located once in the mesh of spacea,
+     the operator is a sparse matrix for repeated application.
+  */
+  shared_ptr<BaseMatrix> MeshTransferOperator (shared_ptr<FESpace> spacea, shared_ptr<FESpace> spaceb,
+                                               LocalHeap & lh, int bonus_intorder = 0);
 
 } // namespace ngcomp
 
@@ -79,6 +79,9 @@ namespace ngcomp
     dgjumps = flags.GetDefineFlag("dgjumps");
     no_low_order_space = flags.GetDefineFlagX("low_order_space").IsFalse() ||
       flags.GetDefineFlag("no_low_order_space");
+    cost_balancing = flags.GetDefineFlag("cost_balancing");
+    cache_dofnrs = flags.GetDefineFlag("cache_dofnrs");
+    setupcache = flags.GetStringFlag("setupcache", SetupCacheDirectory());
     if (dgjumps) 
       *testout << "ATTENTION: flag dgjumps is used!\n This leads to a \
 lot of new non-zero entries in the matrix!\n" << endl;
@@ -354,6 +357,16 @@ lot of new non-zero entries in the matrix!\n" << endl;
       "  NODAL ..... use the same order for nodes of same shape,\n"
       "  VARIBLE ... use an individual order for each edge, face and cell,\n"
       "  OLDSTYLE .. as it used to be for the last decade";
+    docu.Arg("cost_balancing") = "bool = False\n"
+      "  Partition element colors by estimated element cost (from ndof and\n"
+      "  curvature), refined by measured timings of previous element loops.";
+    docu.Arg("cache_dofnrs") = "bool = False\n"
+      "  Store the element-to-dof tables after the update. Element loops then\n"
+      "  read dof numbers from the table instead of recomputing them.";
+    docu.Arg("setupcache") = "str = $NGS_SETUP_CACHE\n"
+      "  Directory for warm-start files of the element colorings. They are\n"
+      "  loaded if mesh, space and dofs are unchanged, otherwise computed and\n"
+      "  written.";
     return docu;
   }
 
@@ -382,6 +395,9 @@ lot of new non-zero entries in the matrix!\n" << endl;
     
     ma->UpdateBuffers();  // is free if netgen-mesh did not change
     int dim = ma->GetDimension();
+
+    for (auto & tab : dof_table)
+      tab = Table<DofId>();
     
     dirichlet_vertex.SetSize (ma->GetNV());
     dirichlet_edge.SetSize (ma->GetNEdges());
@@ -446,6 +462,210 @@ lot of new non-zero entries in the matrix!\n" << endl;
   }
 
 
+  /*
+    Element colorings are shared between spaces on the same mesh.
+    A cached coloring is used if the space has the same coloring key
+    (e.g. the class name), and if it passes the conflict check for the
+    dofs of the new space. Entries are dropped when the mesh changes.
+   */
+  struct ColoringCacheEntry
+  {
+    weak_ptr<MeshAccess> ma;
+    size_t timestamp;
+    VorB vb;
+    string key;
+    shared_ptr<Table<int>> coloring;
+  };
+  static mutex coloring_cache_mutex;
+  static Array<ColoringCacheEntry> coloring_cache;
+
+  // dofs which must not be shared by elements of the same color 
+  static void GetColoringDofs (const FESpace & fes, ElementId el, Array<DofId> & dofs)
+  {
+    fes.GetDofNrs(el, dofs);
+    if (fes.HasAtomicDofs())
+      {
+        for (int i = dofs.Size()-1; i >= 0; i--)
+          if (!IsRegularDof(dofs[i]) || fes.IsAtomicDof(dofs[i])) dofs.DeleteElement(i);
+      }
+    else
+      for (int i = dofs.Size()-1; i >= 0; i--)
+        if (!IsRegularDof(dofs[i])) dofs.DeleteElement(i);
+  }
+
+  // is the coloring conflict-free and does it contain exactly the cnt DefinedOn elements ?
+  static bool CheckColoring (const FESpace & fes, VorB vb, const Table<int> & coloring, size_t cnt)
+  {
+    if (coloring.AsArray().Size() != cnt) return false;
+    Array<int> mark(fes.GetNDof());
+    ParallelForRange (mark.Size(), [&] (IntRange r) { mark[r] = -1; });
+    atomic<bool> ok(true);
+    for (auto c : Range(coloring))
+      {
+        ParallelForRange
+          (coloring[c].Size(), [&] (IntRange r)
+           {
+             Array<DofId> dofs;
+             for (auto i : r)
+               {
+                 ElementId el(vb, coloring[c][i]);
+                 if (!fes.DefinedOn(el)) { ok = false; return; }
+                 GetColoringDofs (fes, el, dofs);
+                 for (auto d : dofs)
+                   if (AsAtomic(mark[d]).exchange(int(c)) == int(c))
+                     { ok = false; return; }
+               }
+           });
+        if (!ok) return false;
+      }
+    return true;
+  }
+
+  static size_t CountDefinedOn (const FESpace & fes, VorB vb)
+  {
+    return ParallelReduce (fes.GetMeshAccess()->GetNE(vb),
+                           [&] (size_t nr) { return size_t(fes.DefinedOn(ElementId(vb,nr))); },
+                           [] (size_t a, size_t b) { return a+b; }, size_t(0));
+  }
+
+  string FESpace :: SetupCacheKey () const
+  {
+    size_t h = ma->GetHash();
+    HashCombine (h, ParallelReduce (ctofdof.Size(), [&] (size_t i)
+                                    {
+                                      size_t hi = 0;
+                                      HashCombine (hi, i);
+                                      HashCombine (hi, ctofdof[i]);
+                                      return hi;
+                                    },
+                                    [] (size_t a, size_t b) { return a+b; }, size_t(0)));
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      for (auto i : Range(ma->GetNRegions(vb)))
+        HashCombine (h, DefinedOn(vb, i));
+    return GetClassName() + " " + ColoringKey() + " order=" + ToString(order) +
+      " dim=" + ToString(dimension) + " ndof=" + ToString(GetNDof()) +
+      " atomic=" + ToString(HasAtomicDofs()) + " hash=" + ToString(h);
+  }
+
+  /// the colorings from the setup cache file, if they are valid for the space
+  static bool LoadCachedColorings (const FESpace & fes, const string & filename, const string & key,
+                                   Table<int> (&colorings)[4])
+  {
+    Table<int> loaded[4];
+    if (!LoadSetupCache (filename, key, [&] (Archive & ar)
+                         {
+                           for (auto vb : { VOL, BND, BBND, BBBND })
+                             ar & loaded[vb];
+                         }))
+      return false;
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      if (!CheckColoring (fes, vb, loaded[vb], CountDefinedOn (fes, vb)))
+        {
+          cout << IM(3) << "setup cache " << filename << ": coloring does not fit the space" << endl;
+          return false;
+        }
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      colorings[vb] = move(loaded[vb]);
+    return true;
+  }
+
+  static shared_ptr<Table<int>> LookupColoring (const FESpace & fes, VorB vb, const string & key, size_t cnt)
+  {
+    static Timer t("FESpace - lookup coloring"); RegionTimer reg(t);
+    shared_ptr<Table<int>> cand;
+    {
+      lock_guard<mutex> guard(coloring_cache_mutex);
+      for (int i = coloring_cache.Size()-1; i >= 0; i--)
+        {
+          auto & entry = coloring_cache[i];
+          auto ema = entry.ma.lock();
+          if (!ema || ema->GetTimeStamp() != entry.timestamp)
+            {
+              coloring_cache.DeleteElement(i);
+              continue;
+            }
+          if (!cand && ema == fes.GetMeshAccess() && entry.vb == vb && entry.key == key)
+            cand = entry.coloring;
+        }
+    }
+    if (cand && CheckColoring (fes, vb, *cand, cnt))
+      return cand;
+    return nullptr;
+  }
+
+  static void StoreColoring (const FESpace & fes, VorB vb, const string & key, const Table<int> & coloring)
+  {
+    lock_guard<mutex> guard(coloring_cache_mutex);
+    auto ma = fes.GetMeshAccess();
+    for (auto & entry : coloring_cache)
+      if (entry.ma.lock() == ma && entry.vb == vb && entry.key == key)
+        {
+          entry.timestamp = ma->GetTimeStamp();
+          entry.coloring = make_shared<Table<int>> (coloring);
+          return;
+        }
+    coloring_cache.Append (ColoringCacheEntry { ma, ma->GetTimeStamp(), vb, key,
+          make_shared<Table<int>> (coloring) });
+  }
+
+  /*
+    The greedy coloring fills the first colors and leaves few elements in
+    the last ones. Elements of over-full colors are moved to colors below
+    the average size, if none of the dofs is used by that color.
+   */
+  static void BalanceColoring (const FESpace & fes, VorB vb, FlatArray<int> col, int ncol, size_t cnt)
+  {
+    if (ncol < 2 || ncol > 64) return;
+    static Timer t("FESpace - balance coloring"); RegionTimer reg(t);
+
+    Array<size_t> cntcol(ncol);
+    cntcol = 0;
+    for (auto c : col)
+      if (c >= 0) cntcol[c]++;
+
+    size_t target = (cnt+ncol-1) / ncol;
+    
+    // colors of elements containing the dof
+    Array<uint64_t> dofcols(fes.GetNDof());
+    ParallelForRange (dofcols.Size(), [&] (IntRange r) { dofcols[r] = 0; });
+    ParallelForRange
+      (col.Size(), [&] (IntRange r)
+       {
+         Array<DofId> dofs;
+         for (auto nr : r)
+           if (col[nr] >= 0)
+             {
+               GetColoringDofs (fes, ElementId(vb, nr), dofs);
+               for (auto d : dofs)
+                 AsAtomic(dofcols[d]) |= uint64_t(1) << col[nr];
+             }
+       });
+
+    Array<DofId> dofs;
+    for (auto nr : Range(col))
+      {
+        int c = col[nr];
+        if (c < 0 || cntcol[c] <= target) continue;
+        GetColoringDofs (fes, ElementId(vb, nr), dofs);
+        uint64_t used = 0;
+        for (auto d : dofs)
+          used |= dofcols[d];
+
+        int best = -1;
+        for (int c2 = 0; c2 < ncol; c2++)
+          if (cntcol[c2] < target && !(used & (uint64_t(1) << c2)))
+            if (best == -1 || cntcol[c2] < cntcol[best])
+              best = c2;
+        if (best == -1) continue;
+
+        for (auto d : dofs)
+          dofcols[d] = (dofcols[d] & ~(uint64_t(1) << c)) | (uint64_t(1) << best);
+        col[nr] = best;
+        cntcol[c]--;
+        cntcol[best]++;
+      }
+  }
+
   void FESpace :: FinalizeUpdate()
   {
     static Timer timer ("FESpace::FinalizeUpdate");
@@ -457,9 +677,16 @@ lot of new non-zero entries in the matrix!\n" << endl;
     static Timer tcolbits ("FESpace::FinalizeUpdate - bitarrays");
     static Timer tcolmutex ("FESpace::FinalizeUpdate - coloring, init mutex");
     */
+    if (low_order_space && low_order_space->setupcache.empty())
+      low_order_space->setupcache = setupcache;   // the colorings are taken from there
     if (low_order_space) low_order_space -> FinalizeUpdate();
 
     RegionTimer reg (timer);
+    if (cache_dofnrs)
+      BuildDofTables();
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      max_element_ndof[vb] = -1;
+    
     // timer1.Start();
     dirichlet_dofs.SetSize (GetNDof());
     dirichlet_dofs.Clear();
@@ -564,12 +791,22 @@ lot of new non-zero entries in the matrix!\n" << endl;
     if (print)
       *testout << "coloring ... " << flush;
 
+    // warm start from the setup cache file
+    string cachefile, cachekey;
+    bool cached_colorings = false;
+    if (setupcache.length() && !low_order_space)
+      {
+        cachekey = SetupCacheKey();
+        cachefile = SetupCacheFile (setupcache, "fespace", cachekey);
+        cached_colorings = LoadCachedColorings (*this, cachefile, cachekey, element_coloring);
+      }
+
     if (low_order_space)
       {
 	for(auto vb : {VOL, BND, BBND, BBBND})
 	  element_coloring[vb] = Table<int>(low_order_space->element_coloring[vb]);
       }
-    else
+    else if (!cached_colorings)
       {
         // tcolmutex.Start();
       Array<MyMutex> locks(GetNDof());
@@ -655,18 +892,28 @@ lot of new non-zero entries in the matrix!\n" << endl;
 
 
 
+        size_t cnt =
+          ParallelReduce (ma->GetNE(vb),
+                          [&] (size_t nr) { return size_t(DefinedOn(ElementId(vb,nr))); },
+                          [] (size_t a, size_t b) { return a+b; }, size_t(0));
+
+        string key = ColoringKey();
+        if (auto cached = LookupColoring (*this, vb, key, cnt))
+          {
+            element_coloring[vb] = Table<int> (*cached);
+            continue;
+          }
+        
         // tcol.Start();
         Array<int> col(ma->GetNE(vb));
-        col = -1;
+        ParallelForRange (col.Size(), [&] (IntRange r) { col[r] = -1; });
 
-        int maxcolor = 0;
+        atomic<int> maxcolor(0);
         
         int basecol = 0;
         Array<unsigned int> mask(GetNDof());
 
         atomic<int> found(0);
-        size_t cnt = 0;
-        for (ElementId el : Elements(vb)) { cnt++; (void)el; } // no warning 
 
         while (found < cnt)
           {
@@ -683,6 +930,7 @@ lot of new non-zero entries in the matrix!\n" << endl;
                {
                  Array<DofId> dofs;
                  size_t myfound = 0;
+                 int mymaxcolor = 0;
                  
                  for (size_t nr : myrange)
                    {
@@ -691,16 +939,7 @@ lot of new non-zero entries in the matrix!\n" << endl;
                      if (col[el.Nr()] >= 0) continue;
                      
                      unsigned check = 0;
-                     GetDofNrs(el, dofs);
-                     
-                     if (HasAtomicDofs())
-                       {
-                         for (int i = dofs.Size()-1; i >= 0; i--)
-                           if (!IsRegularDof(dofs[i]) || IsAtomicDof(dofs[i])) dofs.DeleteElement(i);
-                       }
-                     else
-                       for (int i = dofs.Size()-1; i >= 0; i--)
-                         if (!IsRegularDof(dofs[i])) dofs.DeleteElement(i);
+                     GetColoringDofs (*this, el, dofs);
                      QuickSort (dofs);   // sort to avoid dead-locks
                      
                      for (auto d : dofs) 
@@ -721,7 +960,7 @@ lot of new non-zero entries in the matrix!\n" << endl;
                            }
                          
                          col[el.Nr()] = color;
-                         if (color > maxcolor) maxcolor = color;
+                         mymaxcolor = max2(mymaxcolor, color);
                          
                          for (auto d : dofs) // el.GetDofs())
                            mask[d] |= checkbit;
@@ -731,6 +970,9 @@ lot of new non-zero entries in the matrix!\n" << endl;
                        locks[d].unlock();
                    }
                  found += myfound;
+                 int prev = maxcolor;
+                 while (prev < mymaxcolor &&
+                        !maxcolor.compare_exchange_weak(prev, mymaxcolor)) ;
                });
                  
             basecol += 8*sizeof(unsigned int); // 32;
@@ -738,6 +980,8 @@ lot of new non-zero entries in the matrix!\n" << endl;
 
         // tcol.Stop();
 
+        BalanceColoring (*this, vb, col, maxcolor+1, cnt);
+        
         Array<int> cntcol(maxcolor+1);
         cntcol = 0;
 
@@ -750,26 +994,142 @@ lot of new non-zero entries in the matrix!\n" << endl;
 	cntcol = 0;
         for (ElementId el : Elements(vb))
           coloring[col[el.Nr()]][cntcol[col[el.Nr()]]++] = el.Nr();
+
+        StoreColoring (*this, vb, key, coloring);
         
         if (print)
           *testout << "needed " << maxcolor+1 << " colors" 
                    << " for " << ((vb == VOL) ? "vol" : "bnd") << endl;
       }
+      if (cachefile.length())
+        StoreSetupCache (cachefile, cachekey, [&] (Archive & ar)
+                         {
+                           for (auto vb : { VOL, BND, BBND, BBBND })
+                             ar & element_coloring[vb];
+                         });
       }
     
     // invalidate facet_coloring
     facet_coloring = Table<int>();
+
+    if (cost_balancing)
+      {
+        // cost of element matrix ~ ndof^2 * nip, and nip grows like ndof
+        LocalHeap lh(100000, "FESpace - element cost");
+        Array<DofId> dnums;
+        for (auto vb : { VOL, BND, BBND, BBBND })
+          {
+            element_cost[vb].SetSize (ma->GetNE(vb));
+            for (ElementId ei : ma->Elements(vb))
+              {
+                HeapReset hr(lh);
+                GetDofNrs (ei, dnums);
+                double nd = dnums.Size();
+                double cost = 10 + nd*nd*nd;
+                if (ma->GetTrafo(ei, lh).IsCurvedElement())
+                  cost *= 2;
+                element_cost[vb][ei.Nr()] = cost;
+              }
+            CalcColorBalance (vb);
+          }
+      }
        
     level_updated = ma->GetNLevels();
+    update_timestamp = NGS_Object::GetNextTimeStamp();
     if (timing) Timing();
     updateSignal.Emit();
     // CheckCouplingTypes();
   }
 
+  void FESpace :: BuildDofTables ()
+  {
+    static Timer t("FESpace::BuildDofTables"); RegionTimer reg(t);
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      {
+        // GetDofNrs must not read from the old table
+        dof_table[vb] = Table<DofId>();
+        size_t ne = ma->GetNE(vb);
+        Array<int> cnt(ne);
+        ParallelForRange
+          (ne, [&] (IntRange r)
+           {
+             Array<DofId> dnums;
+             for (auto i : r)
+               {
+                 GetDofNrs (ElementId(vb, i), dnums);
+                 cnt[i] = dnums.Size();
+               }
+           });
+
+        Table<DofId> table(cnt);
+        ParallelForRange
+          (ne, [&] (IntRange r)
+           {
+             Array<DofId> dnums;
+             for (auto i : r)
+               {
+                 GetDofNrs (ElementId(vb, i), dnums);
+                 table[i] = dnums;
+               }
+           });
+        dof_table[vb] = move(table);
+      }
+  }
+
+  size_t FESpace :: MaxElementNDof (VorB vb) const
+  {
+    if (max_element_ndof[vb] >= 0)
+      return max_element_ndof[vb];
+    // ndof in the upper, element number in the lower 32 bits
+    size_t maxel = ParallelReduce (ma->GetNE(vb), [&] (size_t i)
+                                   {
+                                     ArrayMem<DofId,100> dnums;
+                                     auto dofs = GetDofNrsView (ElementId(vb, i), dnums);
+                                     return (size_t(dofs.Size()) << 32) + i;
+                                   },
+                                   [] (size_t a, size_t b) { return max2(a,b); }, size_t(0));
+    max_element_nr[vb] = maxel & 0xffffffff;
+    max_element_ndof[vb] = maxel >> 32;
+    return max_element_ndof[vb];
+  }
+
+  size_t FESpace :: EstimateHeapSize (VorB vb, int bonus_intorder, int proxydim) const
+  {
+    int D = ma->GetDimension() - int(vb);
+    size_t ndof = MaxElementNDof (vb) * GetDimension();
+    if (ndof == 0) return 0;
+    if (proxydim < 0) proxydim = max2 (1, D) * GetDimension();
+    // the rule of the element with the most dofs
+    ElementId ei(vb, max_element_nr[vb]);
+    LocalHeap lh(1000000, "FESpace - heap estimate");
+    int p = max2 (GetFE(ei, lh).Order(), order);
+    size_t nip = SIMD_IntegrationRule (ma->GetElType(ei), 2*p+bonus_intorder).GetNIP()
+      + SIMD<double>::Size();
+    size_t scal = IsComplex() ? sizeof(Complex) : sizeof(double);
+
+    size_t bytes = 64*1024;
+    bytes += 4 * ndof * ndof * scal;            // element matrices, transformation
+    bytes += 3 * nip * ndof * proxydim * scal;  // shapes and the products with proxy values
+    bytes += 2 * nip * proxydim * proxydim * scal;   // proxy values
+    bytes += nip * 512;                         // mapped integration points
+    return 2 * bytes;
+  }
+
+  void FESpace :: CalcColorBalance (VorB vb) const
+  {
+    const Table<int> & coloring = element_coloring[vb];
+    FlatArray<double> cost = element_cost[vb];
+    color_balance[vb].SetSize (coloring.Size());
+    for (auto c : Range(coloring))
+      color_balance[vb][c].Calc (coloring[c].Size(),
+                                 [&] (size_t i) { return size_t(cost[coloring[c][i]]) + 1; });
+  }
+
   const Table<int> & FESpace :: FacetColoring() const
   {
     if (facet_coloring.Size()) return facet_coloring;
 
+    ma->GetFacetElementTable();  // cached, also used by the DG facet loops
     size_t nf = ma->GetNFacets();
     Array<int> col(nf);
     col = -1;
@@ -1291,7 +1651,21 @@ lot of new non-zero entries in the matrix!\n" << endl;
   {
     Array<MemoryUsage> mu;
     mu += { "coupling types", ctofdof.Size()*sizeof(COUPLING_TYPE), 1 };
-    return mu;
+    if (free_dofs)
+      mu += { "free dofs", free_dofs->Size()/8, 1 };
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      {
+        string suffix = vb == VOL ? "" : vb == BND ? " (bnd)" : vb == BBND ? " (bbnd)" : " (bbbnd)";
+        if (element_coloring[vb].Size())
+          mu += { "element coloring" + suffix, MemoryBytes (element_coloring[vb]), 1 };
+        if (element_cost[vb].Size())
+          mu += { "element costs" + suffix, MemoryBytes (element_cost[vb]), 1 };
+        if (dof_table[vb].Size())
+          mu += { "dof table" + suffix, MemoryBytes (dof_table[vb]), 1 };
+      }
+    if (facet_coloring.Size())
+      mu += { "facet coloring", MemoryBytes (facet_coloring), 1 };
+    return MemoryUsageChildren ("space " + GetName(), mu);
   }
 
   
@@ -1596,9 +1970,52 @@ lot of new non-zero entries in the matrix!\n" << endl;
   {
     static mutex copyex_mutex;
     const Table<int> & element_coloring = fes.ElementColoring(vb);
+
+    if (task_manager && fes.UseCostBalancing() &&
+        fes.ColorBalance(vb).Size() == element_coloring.Size())
+      {
+        static Timer t("IterateElements - cost balanced");
+        RegionTimer reg(t);
+        static auto stats = ParallelStats::GetSite ("IterateElements cost balanced");
+        ParallelStatsRegion preg(stats);
+        
+        // measure element times (in ns) for the next call
+        FlatArray<double> cost = fes.ElementCosts(vb);
+        for (auto c : Range(element_coloring))
+          {
+            FlatArray<int> els_of_col = element_coloring[c];
+            ParallelForRange
+              (fes.ColorBalance(vb)[c], [&] (IntRange r)
+               {
+                 static int trace_id = ChromeTrace::GetNameId ("IterateElements task");
+                 ChromeTraceRegion treg(trace_id, ChromeTrace::CAT_TASK);
+                 ParallelStatsTask ptask(stats);
+                 LocalHeap lh = clh.Split();
+                 ArrayMem<int,100> temp_dnums;
+                 
+                 for (int mynr : r)
+                   {
+                     HeapReset hr(lh);
+                     double starttime = WallTime();
+                     FESpace::Element el(fes, 
+                                         ElementId (vb, els_of_col[mynr]), 
+                                         temp_dnums, lh);
+                     func (move(el), lh);
+                     cost[els_of_col[mynr]] = 1e9 * (WallTime()-starttime);
+                   }
+                 
+                 ProgressOutput::SumUpLocal();
+               });
+          }
+        fes.CalcColorBalance(vb);
+        return;
+      }
     
     if (task_manager)
       {
+        // one region for all colors, the waiting between the colors is idle time
+        static auto stats = ParallelStats::GetSite ("IterateElements colored");
+        ParallelStatsRegion preg(stats);
         for (FlatArray<int> els_of_col : element_coloring)
           {
             SharedLoop2 sl(els_of_col.Range());
@@ -1606,6 +2023,9 @@ lot of new non-zero entries in the matrix!\n" << endl;
             task_manager -> CreateJob
               ( [&] (const TaskInfo & ti) 
                 {
+                  static int trace_id = ChromeTrace::GetNameId ("IterateElements task");
+                  ChromeTraceRegion treg(trace_id, ChromeTrace::CAT_TASK);
+                  ParallelStatsTask ptask(stats);
                   LocalHeap lh = clh.Split(ti.thread_nr, ti.nthreads);
                   ArrayMem<int,100> temp_dnums;
 
@@ -1666,6 +2086,51 @@ lot of new non-zero entries in the matrix!\n" << endl;
       }
   }
   
+  void IterateElementsUncolored (const FESpace & fes, 
+                                 VorB vb, 
+                                 LocalHeap & clh, 
+                                 const function<void(FESpace::Element,LocalHeap&)> & func)
+  {
+    auto ma = fes.GetMeshAccess();
+    
+    if (task_manager)
+      {
+        static auto stats = ParallelStats::GetSite ("IterateElements uncolored");
+        ParallelStatsRegion preg(stats);
+        SharedLoop2 sl(ma->GetNE(vb));
+        
+        task_manager -> CreateJob
+          ( [&] (const TaskInfo & ti) 
+            {
+              ParallelStatsTask ptask(stats);
+              LocalHeap lh = clh.Split(ti.thread_nr, ti.nthreads);
+              ArrayMem<int,100> temp_dnums;
+              
+              for (size_t mynr : sl)
+                {
+                  ElementId ei(vb, mynr);
+                  if (!fes.DefinedOn(ei)) continue;
+                  HeapReset hr(lh);
+                  FESpace::Element el(fes, ei, temp_dnums, lh);
+                  func (move(el), lh);
+                }
+              
+              ProgressOutput::SumUpLocal();
+            } );
+        return;
+      }
+
+    Array<int> temp_dnums;
+    for (size_t nr : Range(ma->GetNE(vb)))
+      {
+        ElementId ei(vb, nr);
+        if (!fes.DefinedOn(ei)) continue;
+        HeapReset hr(clh);
+        FESpace::Element el(fes, ei, temp_dnums, clh);
+        func (move(el), clh);
+      }
+  }
+  
   /*
   // Aendern, Bremse!!!
   template < int S, class T >
@@ -2896,6 +3361,21 @@ lot of new non-zero entries in the matrix!\n" << endl;
       }
   }
 
+  string CompoundFESpace :: ColoringKey () const
+  {
+    if (spaces.Size() == 0) return GetClassName();
+    string key = spaces[0]->ColoringKey();
+    bool same = true;
+    for (auto & space : spaces)
+      if (space->ColoringKey() != key) same = false;
+    if (same) return key;
+
+    key = GetClassName() + "(";
+    for (auto & space : spaces)
+      key += space->ColoringKey() + ",";
+    return key + ")";
+  }
+
   void CompoundFESpace :: FinalizeUpdate()
   {
     for (int i = 0; i < spaces.Size(); i++)
@@ -2956,6 +3436,74 @@ lot of new non-zero entries in the matrix!\n" << endl;
 
 
 
+  shared_ptr<Table<int>> CompoundFESpace :: CreateSmoothingBlocks (const Flags & flags) const
+  {
+    string vanka = flags.GetStringFlag ("vanka", "");
+    if (vanka == "")
+      return FESpace::CreateSmoothingBlocks (flags);
+
+    static Timer t("CompoundFESpace::CreateSmoothingBlocks - Vanka"); RegionTimer reg(t);
+    bool eliminate_internal = flags.GetDefineFlag("eliminate_internal");
+    if (vanka != "vertex" && vanka != "element")
+      throw Exception ("CompoundFESpace: unknown vanka patch '" + vanka + "', use vertex or element");
+
+    FilteredTableCreator creator(GetFreeDofs(eliminate_internal).get());
+    Array<DofId> dofs;
+    int dim = ma->GetDimension();
+    for ( ; !creator.Done(); creator++)
+      {
+        if (vanka == "element")
+          {
+            for (size_t i : Range(ma->GetNE(VOL)))
+              {
+                GetDofNrs (ElementId(VOL, i), dofs);
+                for (auto d : dofs)
+                  if (IsRegularDof(d))
+                    creator.Add (i, d);
+              }
+            continue;
+          }
+
+        // the star of the vertex: vertex, edges, faces and elements containing it
+        for (size_t i : Range(ma->GetNV()))
+          {
+            GetDofNrs (NodeId(NT_VERTEX, i), dofs);
+            for (auto d : dofs)
+              if (IsRegularDof(d))
+                creator.Add (i, d);
+          }
+        if (dim >= 2)
+          for (size_t i : Range(ma->GetNEdges()))
+            {
+              auto edge = ma->GetNode<1> (i);
+              GetDofNrs (NodeId(NT_EDGE, i), dofs);
+              for (auto d : dofs)
+                if (IsRegularDof(d))
+                  for (int k = 0; k < 2; k++)
+                    creator.Add (edge.vertices[k], d);
+            }
+        if (dim == 3)
+          for (size_t i : Range(ma->GetNFaces()))
+            {
+              auto face = ma->GetNode<2> (i);
+              GetDofNrs (NodeId(NT_FACE, i), dofs);
+              for (auto d : dofs)
+                if (IsRegularDof(d))
+                  for (int k = 0; k < face.vertices.Size(); k++)
+                    creator.Add (face.vertices[k], d);
+            }
+        for (size_t i : Range(ma->GetNE(VOL)))
+          {
+            GetInnerDofNrs (i, dofs);
+            for (auto d : dofs)
+              if (IsRegularDof(d))
+                for (auto v : ma->GetElement(ElementId(VOL, i)).Vertices())
+                  creator.Add (v, d);
+          }
+      }
+    return make_shared<Table<int>> (creator.MoveTable());
+  }
+
   void CompoundFESpace :: UpdateCouplingDofArray()
   {
     ctofdof.SetSize(this->GetNDof());
@@ -2963,8 +3511,8 @@ lot of new non-zero entries in the matrix!\n" << endl;
     for (int i = 0; i < spaces.Size(); i++)
       {
         if (spaces[i] -> CouplingTypeArrayAvailable())
-          for (int j=0; j< spaces[i]->GetNDof();j++)
-            ctofdof[cummulative_nd[i]+j] = spaces[i]->GetDofCouplingType(j);
+          ParallelFor (spaces[i]->GetNDof(), [&] (size_t j)
+                       { ctofdof[cummulative_nd[i]+j] = spaces[i]->GetDofCouplingType(j); });
         else
           ctofdof.Range(cummulative_nd[i], cummulative_nd[i+1]) = WIREBASKET_DOF;
       }
@@ -3306,6 +3854,171 @@ lot of new non-zero entries in the matrix!\n" << endl;
   }
 
 
+  CachedInverseMass :: CachedInverseMass (shared_ptr<FESpace> afes,
+                                          shared_ptr<CoefficientFunction> rho,
+                                          shared_ptr<Region> definedon,
+                                          bool asingle_precision,
+                                          LocalHeap & clh)
+    : fes(afes), single_precision(asingle_precision)
+  {
+    static Timer t("CachedInverseMass - setup"); RegionTimer reg(t);
+    if (fes->IsComplex())
+      throw Exception("CachedInverseMass: only real spaces supported");
+    if (rho && rho->Dimension() != 1)
+      throw Exception("CachedInverseMass needs a scalar density");
+
+    auto evaluator = fes->GetEvaluator(VOL);
+    if (!evaluator)
+      throw Exception("CachedInverseMass: space has no evaluator");
+    if (auto block = dynamic_pointer_cast<BlockDifferentialOperator> (evaluator))
+      {
+        blockdim = fes->GetDimension();
+        evaluator = block->BaseDiffOp();
+      }
+    auto ma = fes->GetMeshAccess();
+    size_t ne = ma->GetNE(VOL);
+
+    firstdof.SetSize(ne+1);
+    firstvalue.SetSize(ne+1);
+    firstdof[0] = firstvalue[0] = 0;
+    Array<DofId> eldnums;
+    for (size_t i = 0; i < ne; i++)
+      {
+        ElementId ei(VOL, i);
+        eldnums.SetSize0();
+        if (fes->DefinedOn(ei))
+          fes->GetDofNrs (ei, eldnums);
+        for (auto d : eldnums)
+          if (IsRegularDof(d))
+            dnums.Append (d);
+          else
+            throw Exception("CachedInverseMass: irregular dofs not supported");
+        size_t nd = eldnums.Size();
+        firstdof[i+1] = firstdof[i] + nd;
+        firstvalue[i+1] = firstvalue[i] + nd*nd;
+      }
+
+    // element blocks must not couple
+    BitArray used(fes->GetNDof());
+    used.Clear();
+    for (auto d : dnums)
+      {
+        if (used.Test(d))
+          throw Exception("CachedInverseMass: dofs shared by elements, space is not discontinuous");
+        used.SetBit(d);
+      }
+
+    values.SetSize (firstvalue[ne]);
+    ParallelForRange
+      (ne, [&] (IntRange r)
+       {
+         LocalHeap lh = clh.Split();
+         for (auto i : r)
+           {
+             HeapReset hr(lh);
+             size_t nd = firstdof[i+1]-firstdof[i];
+             if (nd == 0) continue;
+             ElementId ei(VOL, i);
+             FlatMatrix<> inv(nd, nd, &values[firstvalue[i]]);
+             if (definedon && !definedon->Mask()[ma->GetElIndex(ei)])
+               {
+                 inv = 0.0;
+                 continue;
+               }
+
+             const FiniteElement & fel = fes->GetFE (ei, lh);
+             if (size_t(fel.GetNDof()) != nd)
+               throw Exception("CachedInverseMass: evaluator does not match element dofs");
+             ElementTransformation & trafo = ma->GetTrafo (ei, lh);
+             int intorder = 2*fel.Order() + (trafo.IsCurvedElement() ? 2 : 0);
+             IntegrationRule ir(fel.ElementType(), intorder);
+             BaseMappedIntegrationRule & mir = trafo(ir, lh);
+
+             int dimd = evaluator->Dim();
+             FlatMatrix<double,ColMajor> bmat(dimd*ir.Size(), nd, lh);
+             evaluator->CalcMatrix (fel, mir, bmat, lh);
+             FlatMatrix<> b(dimd*ir.Size(), nd, lh), db(dimd*ir.Size(), nd, lh);
+             b = bmat;
+             for (size_t j = 0; j < ir.Size(); j++)
+               {
+                 double fac = mir[j].GetWeight();
+                 if (rho) fac *= rho->Evaluate(mir[j]);
+                 db.Rows(j*dimd, (j+1)*dimd) = fac * b.Rows(j*dimd, (j+1)*dimd);
+               }
+             inv = Trans(b) * db;
+             CalcInverse (inv);
+           }
+       });
+
+    if (single_precision)
+      {
+        fvalues.SetSize (values.Size());
+        for (size_t i = 0; i < values.Size(); i++)
+          fvalues[i] = values[i];
+        values = Array<double>();
+      }
+  }
+
+  template <typename TM>
+  void CachedInverseMass :: T_MultAdd (double val, FlatArray<TM> mats,
+                                       const BaseVector & x, BaseVector & y) const
+  {
+    auto fx = x.FV<double>();
+    auto fy = y.FV<double>();
+    size_t bs = blockdim;
+    ParallelForRange
+      (firstdof.Size()-1, [&] (IntRange r)
+       {
+         Array<double> elx;
+         for (auto i : r)
+           {
+             size_t nd = firstdof[i+1]-firstdof[i];
+             elx.SetSize(nd);
+             auto eldnums = dnums.Range(firstdof[i], firstdof[i+1]);
+             const TM * mat = &mats[firstvalue[i]];
+             for (size_t comp = 0; comp < bs; comp++)
+               {
+                 for (size_t j = 0; j < nd; j++)
+                   elx[j] = fx(bs*eldnums[j]+comp);
+                 for (size_t k = 0; k < nd; k++)
+                   {
+                     const TM * row = mat + k*nd;
+                     double sum = 0;
+                     for (size_t j = 0; j < nd; j++)
+                       sum += row[j] * elx[j];
+                     fy(bs*eldnums[k]+comp) += val * sum;
+                   }
+               }
+           }
+       });
+  }
+
+  void CachedInverseMass :: Mult (const BaseVector & v, BaseVector & prod) const
+  {
+    prod = 0.0;
+    MultAdd (1, v, prod);
+  }
+
+  void CachedInverseMass :: MultAdd (double val, const BaseVector & v, BaseVector & prod) const
+  {
+    static Timer t("CachedInverseMass"); RegionTimer reg(t);
+    if (single_precision)
+      T_MultAdd (val, fvalues, v, prod);
+    else
+      T_MultAdd (val, values, v, prod);
+  }
+
+  AutoVector CachedInverseMass :: CreateRowVector () const
+  {
+    return CreateBaseVector(fes->GetNDof(), false, fes->GetDimension());
+  }
+
+  AutoVector CachedInverseMass :: CreateColVector () const
+  {
+    return CreateBaseVector(fes->GetNDof(), false, fes->GetDimension());
+  }
+
+
 
   
   ApplyTrace :: ApplyTrace (shared_ptr<FESpace> afes,
@@ -3425,6 +4138,8 @@ lot of new non-zero entries in the matrix!\n" << endl;
   {
     for (auto & fes : fesa)
       if (name == fes->name) return fes;
+    if (LazyLibraries::Load (name))
+      return GetFESpace (name);
     return NULL;
   }
 
@@ -3449,6 +4164,7 @@ lot of new non-zero entries in the matrix!\n" << endl;
                                                            const Flags & flags)
   {
     shared_ptr<FESpace> space;
+    LazyLibraries::Load (type);
     for (int i = 0; i < GetFESpaceClasses().GetFESpaces().Size(); i++)
       if (type == GetFESpaceClasses().GetFESpaces()[i]->name ||
 	  flags.GetDefineFlag (GetFESpaceClasses().GetFESpaces()[i]->name) )
@@ -109,6 +109,8 @@ ANY                  1 1 1 1 | 15
     shared_ptr<Prolongation> prol;// = NULL;
     /// highest multigrid-level for which Update was called (memory allocation)
     int level_updated;
+    /// new timestamp for every FinalizeUpdate (dofs or couplings may have changed)
+    size_t update_timestamp = 0;
 
     /// on which subdomains is the space defined ?
     Array<bool> definedon[4];
@@ -186,6 +188,18 @@ ANY                  1 1 1 1 | 15
     
     Table<int> element_coloring[4]; 
     Table<int> facet_coloring;  // elements on facet in own colors (DG)
+    // cost-weighted partitioning of element colors
+    bool cost_balancing = false;
+    mutable Array<double> element_cost[4];
+    mutable Array<Partitioning> color_balance[4];
+    // directory of the setup cache files (flag setupcache), empty for none
+    string setupcache;
+    // precomputed element-to-dof tables (flag cache_dofnrs)
+    bool cache_dofnrs = false;
+    Table<DofId> dof_table[4];
+    // maximal element ndof and an element having it, -1 until computed
+    mutable int max_element_ndof[4] = { -1, -1, -1, -1 };
+    mutable size_t max_element_nr[4] = { 0, 0, 0, 0 };
     Array<COUPLING_TYPE> ctofdof;
 
     shared_ptr<ParallelDofs> paralleldofs;
@@ -241,11 +255,40 @@ ANY                  1 1 1 1 | 15
 
     /// highest level where update/finalize was called
     int GetLevelUpdated() const { return level_updated; }
+    size_t GetUpdateTimeStamp() const { return update_timestamp; }
 
     const Table<int> & ElementColoring(VorB vb = VOL) const 
     { return element_coloring[vb]; }
 
     const Table<int> & FacetColoring() const;
+
+    /// spaces with the same key try to share element colorings
+    virtual string ColoringKey () const { return GetClassName(); }
+    /// what the setup structures depend on: mesh, type, order, dofs and couplings
+    string SetupCacheKey () const;
+
+    /// weighted partitioning of element colors enabled ?
+    bool UseCostBalancing() const { return cost_balancing; }
+    /// per-element cost, estimated in FinalizeUpdate, measured by IterateElements
+    FlatArray<double> ElementCosts (VorB vb = VOL) const { return element_cost[vb]; }
+    /// cost-weighted partitioning of the colors
+    const Array<Partitioning> & ColorBalance (VorB vb = VOL) const { return color_balance[vb]; }
+    /// recompute color partitioning from element costs
+    void CalcColorBalance (VorB vb) const;
+
+    /// maximal number of dofs of an element, computed on first use
+    size_t MaxElementNDof (VorB vb = VOL) const;
+    /**
+       Estimated LocalHeap per thread for element matrices and vectors:
+       integration rules of order 2 order + bonus_intorder, shapes of
+       proxies of total dimension proxydim (-1 .. dimension of the space
+       times dimension of the mesh).
+    */
+    size_t EstimateHeapSize (VorB vb, int bonus_intorder = 0, int proxydim = -1) const;
+  protected:
+    /// build the element-to-dof tables, called by FinalizeUpdate
+    void BuildDofTables ();
+  public:
     
     /// print report to stream
     virtual void PrintReport (ostream & ost) const override;
@@ -257,6 +300,8 @@ ANY                  1 1 1 1 | 15
     
     /// order of finite elements
     int GetOrder () const { return order; }
+    /// same order on all nodes of a type, e.g. no orders set per node
+    ORDER_POLICY GetOrderPolicy () const { return order_policy; }
 
     /*
     void SetBonusOrder (ELEMENT_TYPE et, int bonus) 
@@ -300,6 +345,7 @@ ANY                  1 1 1 1 | 15
       Array<DofId> & temp_dnums;
       LocalHeap & lh;
       mutable bool dofs_set = false;
+      mutable FlatArray<DofId> dofs;
     public:     
       INLINE Element (const FESpace & afes, ElementId id, Array<DofId> & atemp_dnums,
                       LocalHeap & alh)
@@ -313,9 +359,9 @@ ANY                  1 1 1 1 | 15
       INLINE FlatArray<DofId> GetDofs() const
       {
         if (!dofs_set)
-          fes.GetDofNrs (*this, temp_dnums);
+          dofs = fes.GetDofNrsView (*this, temp_dnums);
         dofs_set = true;
-        return temp_dnums;
+        return dofs;
       }
 
       INLINE const ElementTransformation & GetTrafo() const
@@ -428,6 +474,19 @@ ANY                  1 1 1 1 | 15
 
     /// get dof-nrs of domain or boundary element elnr
     virtual void GetDofNrs (ElementId ei, Array<DofId> & dnums) const = 0;
+
+    /// dof-nrs of the element without copying if the element-to-dof table
+    /// is cached (flag cache_dofnrs), otherwise computed into dnums
+    INLINE FlatArray<DofId> GetDofNrsView (ElementId ei, Array<DofId> & dnums) const
+    {
+      auto & tab = dof_table[ei.VB()];
+      if (tab.Size())
+        return tab[ei.Nr()];
+      GetDofNrs (ei, dnums);
+      return dnums;
+    }
+    /// is the element-to-dof table of this element type cached ?
+    bool HasDofTable (VorB vb = VOL) const { return dof_table[vb].Size() > 0; }
     
     virtual void GetDofNrs (NodeId ni, Array<DofId> & dnums) const;
     BitArray GetDofs (Region reg) const;
@@ -852,6 +911,13 @@ ANY                  1 1 1 1 | 15
 			       VorB vb, 
 			       LocalHeap & clh, 
 			       const function<void(FESpace::Element,LocalHeap&)> & func);
+
+  /// all elements in one parallel loop, no coloring. 
+  /// func must scatter its results thread-safe (e.g. atomic add)
+  extern NGS_DLL_HEADER void IterateElementsUncolored (const FESpace & fes,
+                                                       VorB vb, 
+                                                       LocalHeap & clh, 
+                                                       const function<void(FESpace::Element,LocalHeap&)> & func);
   /*
   template <typename TFUNC>
   inline void IterateElements (const FESpace & fes, 
@@ -1148,8 +1214,19 @@ ANY                  1 1 1 1 | 15
     /// updates also components
     void FinalizeUpdate() override;
 
+    /// the key of the components if they agree
+    string ColoringKey () const override;
+
     /// copies dofcoupling from components
     void UpdateCouplingDofArray() override;
+
+    /**
+       flag vanka = "vertex": star patches of the vertices, all dofs of
+       all components on the nodes touching the vertex (e.g. velocity
+       and pressure of Taylor-Hood), vanka = "element": all dofs of an
+       element. Without the flag the blocks of FESpace.
+    */
+    shared_ptr<Table<int>> CreateSmoothingBlocks (const Flags & flags) const override;
     
     void SetDefinedOn (VorB vb, const BitArray& defon) override;
     /// 
@@ -1253,6 +1330,45 @@ ANY                  1 1 1 1 | 15
 
 
 
+  /**
+     Inverse mass matrix of a discontinuous space. The inverse element
+     mass matrices are computed once and stored, in single precision
+     if requested. Vector-valued spaces store one block for all components.
+   */
+  class NGS_DLL_HEADER CachedInverseMass : public BaseMatrix
+  {
+    shared_ptr<FESpace> fes;
+    int blockdim = 1;          // components sharing one scalar block
+    bool single_precision;
+    Array<size_t> firstdof, firstvalue;
+    Array<DofId> dnums;
+    Array<double> values;
+    Array<float> fvalues;
+  public:
+    CachedInverseMass (shared_ptr<FESpace> afes,
+                       shared_ptr<CoefficientFunction> rho,
+                       shared_ptr<Region> definedon,
+                       bool asingle_precision,
+                       LocalHeap & lh);
+
+    virtual bool IsComplex() const override { return false; }
+
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const override;
+    virtual void MultAdd (double val, const BaseVector & v, BaseVector & prod) const override;
+    virtual void MultTransAdd (double val, const BaseVector & v, BaseVector & prod) const override
+    { MultAdd (val, v, prod); }
+
+    virtual AutoVector CreateRowVector () const override;
+    virtual AutoVector CreateColVector () const override;
+
+    virtual int VHeight() const override { return fes->GetNDof(); }
+    virtual int VWidth() const override { return fes->GetNDof(); }
+  private:
+    template <typename TM>
+    void T_MultAdd (double val, FlatArray<TM> mats, const BaseVector & x, BaseVector & y) const;
+  };
+
+
   class NGS_DLL_HEADER ApplyTrace : public BaseMatrix
   {
   protected:
@@ -7,6 +7,13 @@
 #include <parallelngs.hpp>
 #include <stdlib.h>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace ngcomp; 
 
 
@@ -208,7 +215,7 @@ namespace ngcomp
 	//const_cast<GridFunction&> (*this).GetVector().MemoryUsage (mu);
 	auto mu = this->GetVector().GetMemoryUsage ();
 	for (int i = 0; i < mu.Size(); i++)
-	  mu[i].AddName (string(" gf ")+GetName());
+	  mu[i].AddParent ("gf " + GetName());
         return mu;
       }
     return Array<MemoryUsage>();
@@ -216,14 +223,262 @@ namespace ngcomp
 
 
 
+  /**
+     multidim component of a real, not distributed GridFunction: a view
+     into the contiguous storage of all components, which it keeps alive
+  */
+  class MultiDimComponentVector : public S_BaseVectorPtr<double>
+  {
+    shared_ptr<Array<double>> storage;
+  public:
+    MultiDimComponentVector (size_t as, int aes, shared_ptr<Array<double>> astorage, size_t offset)
+      : S_BaseVectorPtr<double> (as, aes, astorage->Data()+offset), storage(astorage) { ; }
+
+    /// moves the component to a new storage, the vector object stays the same
+    void Rebind (shared_ptr<Array<double>> astorage, size_t offset)
+    {
+      storage = astorage;
+      pdata = storage->Data()+offset;
+    }
+    shared_ptr<Array<double>> GetStorage () const { return storage; }
+  };
+
+
   void GridFunction :: AddMultiDimComponent (BaseVector & v)
   {
-    vec.SetSize (vec.Size()+1);
-    vec[multidim] = v.CreateVector();
+    auto first = multidim ? dynamic_pointer_cast<MultiDimComponentVector> (vec[0]) : nullptr;
+    if (first && first->Size() == v.Size() && first->EntrySize() == v.EntrySize())
+      {
+        // the storage grows by doubling, the components are moved to the new block
+        size_t n = first->FVDouble().Size();
+        auto storage = first->GetStorage();
+        if (storage->Size() < (multidim+1)*n)
+          {
+            auto newstorage = make_shared<Array<double>> (2*multidim*n);
+            FlatArray<double> old = *storage;
+            ParallelForRange (multidim*n, [&] (IntRange r)
+                              { (*newstorage).Range(r) = old.Range(r); });
+            for (int i = 0; i < multidim; i++)
+              dynamic_pointer_cast<MultiDimComponentVector> (vec[i]) -> Rebind (newstorage, i*n);
+            storage = newstorage;
+          }
+        vec.SetSize (multidim+1);
+        vec[multidim] = make_shared<MultiDimComponentVector> (first->Size(), first->EntrySize(),
+                                                              storage, multidim*n);
+      }
+    else
+      {
+        vec.SetSize (vec.Size()+1);
+        vec[multidim] = v.CreateVector();
+      }
     *vec[multidim] = v;
     multidim++;
   }
 
+  shared_ptr<MultiVector> GridFunction :: GetMultiVector () const
+  {
+    auto first = multidim ? dynamic_pointer_cast<MultiDimComponentVector> (vec[0]) : nullptr;
+    if (!first)
+      throw Exception ("GridFunction::GetMultiVector: only for real, not distributed GridFunctions");
+    FlatVector<double> fv = first->FVDouble();
+    return make_shared<MultiVector> (fv.Size(), multidim, fv.Data(), first->GetStorage());
+  }
+
+
+  /*
+    Checkpoint files: a fixed size header, followed by the raw local
+    vectors (all multidim components) at offset CheckpointHeader::data_offset.
+    Each rank writes and reads its own file filename.<rank> independently.
+   */
+  struct CheckpointHeader
+  {
+    char magic[8];
+    uint64_t version;
+    uint64_t rank, nranks;
+    uint64_t multidim;
+    uint64_t ndouble;        // doubles per component
+    uint64_t ndof, dim, iscomplex, order;
+    uint64_t layout_hash;
+    uint64_t data_offset;
+    char fesname[64];
+  };
+
+  static const char checkpoint_magic[8] = "NGSCKPT";
+  
+  // hash of element dof numbers and coupling types, independent of the thread count
+  static uint64_t CheckpointLayoutHash (const FESpace & fes)
+  {
+    auto fnv = [] (uint64_t h, uint64_t v)
+      {
+        for (int i = 0; i < 8; i++, v >>= 8)
+          h = (h ^ (v & 0xff)) * 1099511628211ull;
+        return h;
+      };
+    auto ma = fes.GetMeshAccess();
+    uint64_t h = ParallelReduce
+      (ma->GetNE(VOL),
+       [&] (size_t nr)
+       {
+         ArrayMem<DofId,100> dnums;
+         fes.GetDofNrs (ElementId(VOL, nr), dnums);
+         uint64_t eh = fnv (14695981039346656037ull, nr);
+         for (auto d : dnums)
+           eh = fnv (eh, uint64_t(int64_t(d)));
+         return eh;
+       },
+       [] (uint64_t a, uint64_t b) { return a+b; }, uint64_t(0));
+    h = fnv (h, fes.GetNDof());
+    for (size_t i = 0; i < fes.GetNDof(); i++)
+      h = fnv (h, fes.GetDofCouplingType(i));
+    return h;
+  }
+
+  static string CheckpointFileName (const string & filename, NgsMPI_Comm comm)
+  {
+    if (comm.Size() == 1) return filename;
+    return filename + "." + ToString(comm.Rank());
+  }
+  
+  void GridFunction :: SaveCheckpoint (const string & filename) const
+  {
+    static Timer t("GridFunction::SaveCheckpoint"); RegionTimer reg(t);
+    auto comm = ma->GetCommunicator();
+    string name = CheckpointFileName (filename, comm);
+
+    CheckpointHeader header;
+    memset (&header, 0, sizeof(header));
+    memcpy (header.magic, checkpoint_magic, 8);
+    header.version = 1;
+    header.rank = comm.Rank();
+    header.nranks = comm.Size();
+    header.multidim = multidim;
+    header.ndouble = vec[0]->FVDouble().Size();
+    header.ndof = fespace->GetNDof();
+    header.dim = fespace->GetDimension();
+    header.iscomplex = fespace->IsComplex();
+    header.order = fespace->GetOrder();
+    header.layout_hash = CheckpointLayoutHash (*fespace);
+    header.data_offset = 4096;
+    strncpy (header.fesname, fespace->GetClassName().c_str(), sizeof(header.fesname)-1);
+
+    for (auto & v : vec)
+      v->Cumulate();
+
+    size_t nbytes = header.ndouble * sizeof(double);
+#ifndef WIN32
+    int fd = open (name.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0)
+      throw Exception ("SaveCheckpoint: cannot open file " + name);
+    bool ok = ftruncate (fd, header.data_offset + multidim*nbytes) == 0;
+    ok = ok && pwrite (fd, &header, sizeof(header), 0) == sizeof(header);
+
+    // blocks are written concurrently by the threads
+    atomic<bool> blocks_ok(true);
+    size_t blocksize = 1 << 24;
+    for (int i = 0; i < multidim; i++)
+      {
+        const char * data = reinterpret_cast<const char*> (vec[i]->FVDouble().Data());
+        size_t offset = header.data_offset + i*nbytes;
+        ParallelFor ((nbytes+blocksize-1)/blocksize, [&] (size_t b)
+                     {
+                       size_t first = b*blocksize;
+                       size_t n = min2 (blocksize, nbytes-first);
+                       if (pwrite (fd, data+first, n, offset+first) != ssize_t(n))
+                         blocks_ok = false;
+                     });
+      }
+    ok = ok && blocks_ok;
+    ok = (close (fd) == 0) && ok;
+#else
+    ofstream out (name, ios::binary);
+    out.write (reinterpret_cast<const char*>(&header), sizeof(header));
+    out.seekp (header.data_offset);
+    for (int i = 0; i < multidim; i++)
+      out.write (reinterpret_cast<const char*> (vec[i]->FVDouble().Data()), nbytes);
+    bool ok = out.good();
+#endif
+    if (!ok)
+      throw Exception ("SaveCheckpoint: writing file " + name + " failed");
+  }
+
+  void GridFunction :: LoadCheckpoint (const string & filename)
+  {
+    static Timer t("GridFunction::LoadCheckpoint"); RegionTimer reg(t);
+    auto comm = ma->GetCommunicator();
+    string name = CheckpointFileName (filename, comm);
+
+#ifndef WIN32
+    int fd = open (name.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw Exception ("LoadCheckpoint: cannot open file " + name);
+    struct stat st;
+    fstat (fd, &st);
+    size_t filesize = st.st_size;
+    if (filesize < sizeof(CheckpointHeader))
+      {
+        close (fd);
+        throw Exception ("LoadCheckpoint: " + name + " is not a checkpoint file");
+      }
+    void * map = mmap (nullptr, filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED)
+      throw Exception ("LoadCheckpoint: cannot map file " + name);
+    const char * file = static_cast<const char*> (map);
+    CheckpointHeader header;
+    memcpy (&header, file, sizeof(header));
+#else
+    ifstream in (name, ios::binary);
+    CheckpointHeader header;
+    in.read (reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in.good())
+      throw Exception ("LoadCheckpoint: " + name + " is not a checkpoint file");
+    in.seekg (0, ios::end);
+    size_t filesize = in.tellg();
+#endif
+
+    string err;
+    if (memcmp (header.magic, checkpoint_magic, 8) != 0 || header.version != 1)
+      err = "not a checkpoint file";
+    else if (header.nranks != size_t(comm.Size()) || header.rank != size_t(comm.Rank()))
+      err = "written with " + ToString(header.nranks) + " ranks";
+    else if (string(header.fesname, strnlen(header.fesname, sizeof(header.fesname))) != fespace->GetClassName())
+      err = string("written for space ") + header.fesname;
+    else if (header.ndof != fespace->GetNDof() || header.dim != size_t(fespace->GetDimension()) ||
+             header.iscomplex != size_t(fespace->IsComplex()) || header.order != size_t(fespace->GetOrder()) ||
+             header.ndouble != vec[0]->FVDouble().Size() || header.layout_hash != CheckpointLayoutHash (*fespace))
+      err = "dof layout does not match";
+    else if (header.multidim != size_t(multidim))
+      err = "multidim = " + ToString(header.multidim);
+    else if (filesize < header.data_offset + multidim * header.ndouble * sizeof(double))
+      err = "file is truncated";
+
+    if (err.length())
+      {
+#ifndef WIN32
+        munmap (map, filesize);
+#endif
+        throw Exception ("LoadCheckpoint: " + name + ": " + err);
+      }
+
+    size_t nbytes = header.ndouble * sizeof(double);
+    for (int i = 0; i < multidim; i++)
+      {
+        char * data = reinterpret_cast<char*> (vec[i]->FVDouble().Data());
+#ifndef WIN32
+        const char * src = file + header.data_offset + i*nbytes;
+        ParallelForRange (nbytes, [&] (IntRange r)
+                          { memcpy (data+r.First(), src+r.First(), r.Size()); });
+#else
+        in.seekg (header.data_offset + i*nbytes);
+        in.read (data, nbytes);
+#endif
+        vec[i]->SetParallelStatus (CUMULATED);
+      }
+#ifndef WIN32
+    munmap (map, filesize);
+#endif
+  }
+
 
   // void GridFunction :: Visualize(const string & given_name)
   void Visualize(shared_ptr<GridFunction> gf, const string & given_name)
@@ -945,6 +1200,20 @@ namespace ngcomp
 
 
 	int ndof = this->GetFESpace()->GetNDof();
+        int es = this->GetFESpace()->GetDimension()*this->cacheblocksize;
+
+        // real, not distributed components share one contiguous block
+        shared_ptr<Array<double>> storage;
+        if (is_same<TSCAL,double>::value && !this->GetFESpace()->GetParallelDofs() &&
+            this->multidim > 0 && !(vec[0] && ndof == vec[0]->Size()))
+          storage = make_shared<Array<double>> (size_t(ndof)*es*this->multidim);
+
+        // the prolongation adds the new level once, for all components
+        auto prol = this->GetFESpace()->GetProlongation();
+        bool prolongate = this->nested && prol && this->multidim > 0 &&
+          vec[0] && ndof != vec[0]->Size();
+        if (prolongate)
+          const_cast<ngmg::Prolongation&> (*prol).Update(*this->GetFESpace());
 
 	for (int i = 0; i < this->multidim; i++)
 	  {
@@ -953,26 +1222,30 @@ namespace ngcomp
 	    
 	    shared_ptr<BaseVector> ovec = vec[i];
 	
+            if (storage)
+              vec[i] = make_shared<MultiDimComponentVector> (ndof, es, storage, i*size_t(ndof)*es);
+            else
 #ifdef PARALLEL
 	    if ( this->GetFESpace()->GetParallelDofs() )
-	      vec[i] = make_shared<S_ParallelBaseVectorPtr<TSCAL>> (ndof, this->GetFESpace()->GetDimension()*this->cacheblocksize,
+	      vec[i] = make_shared<S_ParallelBaseVectorPtr<TSCAL>> (ndof, es,
 								    this->GetFESpace()->GetParallelDofs(), CUMULATED);
 	    else
 #endif
  	      // vec[i] = make_shared<VVector<TV>> (ndof);
-              vec[i] = make_shared<S_BaseVectorPtr<TSCAL>> (ndof, this->GetFESpace()->GetDimension()*this->cacheblocksize);
+              vec[i] = make_shared<S_BaseVectorPtr<TSCAL>> (ndof, es);
             
-	    *vec[i] = TSCAL(0);
-
-	    if (this->nested && ovec && this->GetFESpace()->GetProlongation())
+	    if (prolongate && ovec && ovec->Size() <= size_t(ndof))
 	      {
-		*vec[i]->Range (0, ovec->Size()) += *ovec;
+                // old dofs are copied, only the new ones are set
+                size_t osize = ovec->Size();
+		*vec[i]->Range (0, osize) = *ovec;
+                if (osize < size_t(ndof))
+                  *vec[i]->Range (osize, ndof) = TSCAL(0);
 
-		const_cast<ngmg::Prolongation&> (*this->GetFESpace()->GetProlongation()).Update(*this->GetFESpace());
-		
-		this->GetFESpace()->GetProlongation()->ProlongateInline
-		  (this->GetMeshAccess()->GetNLevels()-1, *vec[i]);
+		prol->ProlongateInline (this->GetMeshAccess()->GetNLevels()-1, *vec[i]);
 	      }
+            else
+              *vec[i] = TSCAL(0);
 
 	    //	    if (i == 0)
             // cout << "visualize" << endl;
@@ -1039,6 +1312,79 @@ namespace ngcomp
 
 
 
+  /*
+    The gathered and transformed element vectors of the last evaluations of
+    a thread. Several GridFunctionCoefficientFunctions of the same GridFunction
+    (u, grad(u), ...) in one integrator gather the element vector once.
+    An entry is valid during the evaluation of one element, identified by the
+    ProxyUserData and its generation.
+  */
+  template <typename SCAL>
+  class ElementVectorCache
+  {
+    struct Entry
+    {
+      const ProxyUserData * ud = nullptr;
+      size_t generation = 0;
+      const BaseVector * vec = nullptr;
+      const FESpace * fes = nullptr;
+      VorB vb = VOL;
+      size_t elnr = 0;
+      Array<SCAL> values;
+    };
+    static constexpr int N = 8;
+    Entry entries[N];
+    int next = 0;
+  public:
+    FlatVector<SCAL> Gather (const GridFunction & gf, int comp, const FESpace & fes,
+                             ElementId ei, const ProxyUserData * ud, LocalHeap & lh)
+    {
+      const BaseVector * vec = &gf.GetVector(comp);
+      if (ud)
+        for (auto & entry : entries)
+          if (entry.ud == ud && entry.generation == ud->generation &&
+              entry.vec == vec && entry.fes == &fes &&
+              entry.vb == ei.VB() && entry.elnr == ei.Nr())
+            {
+              // a copy, the entry may be replaced during the evaluation
+              FlatVector<SCAL> elu(entry.values.Size(), lh);
+              elu = FlatVector<SCAL> (entry.values.Size(), entry.values.Data());
+              return elu;
+            }
+
+      ArrayMem<int,50> dnumsmem;
+      FlatArray<DofId> dnums = fes.GetDofNrsView (ei, dnumsmem);
+      FlatVector<SCAL> elu(dnums.Size()*fes.GetDimension(), lh);
+      gf.GetElementVector (comp, dnums, elu);
+      fes.TransformVec (ei, elu, TRANSFORM_SOL);
+
+      if (ud)
+        {
+          auto & entry = entries[next];
+          next = (next+1) % N;
+          entry.ud = ud;
+          entry.generation = ud->generation;
+          entry.vec = vec;
+          entry.fes = &fes;
+          entry.vb = ei.VB();
+          entry.elnr = ei.Nr();
+          entry.values.SetSize (elu.Size());
+          FlatVector<SCAL> (entry.values.Size(), entry.values.Data()) = elu;
+        }
+      return elu;
+    }
+  };
+
+  template <typename SCAL>
+  static FlatVector<SCAL> GatherElementVector (const GridFunction & gf, int comp, const FESpace & fes,
+                                               const ElementTransformation & trafo, LocalHeap & lh)
+  {
+    static thread_local ElementVectorCache<SCAL> cache;
+    ElementId ei(trafo.VB(), trafo.GetElementNr());
+    return cache.Gather (gf, comp, fes, ei, (const ProxyUserData*)trafo.userdata, lh);
+  }
+
+
   GridFunctionCoefficientFunction :: 
   GridFunctionCoefficientFunction (shared_ptr<GridFunction> agf, int acomp)
     : CoefficientFunctionNoDerivative(1, agf->GetFESpace()->IsComplex()),
@@ -1236,8 +1582,8 @@ namespace ngcomp
     const FiniteElement & fel = fes->GetFE (ei, lh2);
     int dim = fes->GetDimension();
     
-    ArrayMem<int, 50> dnums;
-    fes->GetDofNrs (ei, dnums);
+    ArrayMem<int,50> dnumsmem;
+    FlatArray<DofId> dnums = fes->GetDofNrsView (ei, dnumsmem);
     
     VectorMem<50> elu(dnums.Size()*dim);
 
@@ -1301,8 +1647,8 @@ namespace ngcomp
     const FiniteElement & fel = fes->GetFE (ei, lh2);
     int dim = fes->GetDimension();
     
-    ArrayMem<int, 50> dnums;
-    fes->GetDofNrs (ei, dnums);
+    ArrayMem<int,50> dnumsmem;
+    FlatArray<DofId> dnums = fes->GetDofNrsView (ei, dnumsmem);
     
     VectorMem<50, Complex> elu(dnums.Size()*dim);
 
@@ -1359,15 +1705,7 @@ namespace ngcomp
       }
 
     const FiniteElement & fel = fes->GetFE (ei, lh2);
-    int dim = fes->GetDimension();
-
-    ArrayMem<int, 50> dnums;
-    fes->GetDofNrs (ei, dnums);
-    
-    VectorMem<50> elu(dnums.Size()*dim);
-
-    gf->GetElementVector (comp, dnums, elu);
-    fes->TransformVec (ElementId(vb, elnr), elu, TRANSFORM_SOL);
+    auto elu = GatherElementVector<double> (*gf, comp, *fes, trafo, lh2);
 
     if (diffop[vb])
       diffop[vb]->Apply (fel, ir, elu, values, lh2);
@@ -1422,15 +1760,7 @@ namespace ngcomp
       }
     
     const FiniteElement & fel = fes->GetFE (ei, lh2);
-    int dim = fes->GetDimension();
-
-    ArrayMem<int, 50> dnums;
-    fes->GetDofNrs (ei, dnums);
-    
-    VectorMem<50,Complex> elu(dnums.Size()*dim);
-
-    gf->GetElementVector (comp, dnums, elu);
-    fes->TransformVec (ei, elu, TRANSFORM_SOL);
+    auto elu = GatherElementVector<Complex> (*gf, comp, *fes, trafo, lh2);
 
     /*
     if (diffop && vb==VOL)
@@ -1497,15 +1827,7 @@ namespace ngcomp
       }
     
     const FiniteElement & fel = fes->GetFE (ei, lh2);
-    int dim = fes->GetDimension();
-
-    ArrayMem<int, 50> dnums;
-    fes->GetDofNrs (ei, dnums);
-    
-    VectorMem<50> elu(dnums.Size()*dim);
-
-    gf->GetElementVector (comp, dnums, elu);
-    fes->TransformVec (ei, elu, TRANSFORM_SOL);
+    auto elu = GatherElementVector<double> (*gf, comp, *fes, trafo, lh2);
     /*
     if (diffop && vb==VOL)
       diffop->Apply (fel, ir, elu, values); // , lh2);
@@ -1574,15 +1896,7 @@ namespace ngcomp
       }
     
     const FiniteElement & fel = fes.GetFE (ei, lh2);
-    int dim = fes.GetDimension();
-
-    ArrayMem<int, 50> dnums;
-    fes.GetDofNrs (ei, dnums);
-    
-    VectorMem<50, Complex> elu(dnums.Size()*dim);
-
-    gf->GetElementVector (comp, dnums, elu);
-    fes.TransformVec (ei, elu, TRANSFORM_SOL);
+    auto elu = GatherElementVector<Complex> (*gf, comp, fes, trafo, lh2);
     /*
     if (diffop && vb==VOL)
       diffop->Apply (fel, ir, elu, values); // , lh2);
@@ -157,6 +157,11 @@ namespace ngcomp
 
     /// increase multidim and copy vec to new component
     void AddMultiDimComponent (BaseVector & vec);
+
+    /** all multidim components as one MultiVector, no copy.
+        Real, not distributed GridFunctions store the components in one
+        contiguous block, component i is vector i of the MultiVector */
+    shared_ptr<MultiVector> GetMultiVector () const;
   
     int GetLevelUpdated() const { return level_updated; }
     ///
@@ -272,6 +277,12 @@ namespace ngcomp
 
     virtual void Load (istream & ist) = 0;
     virtual void Save (ostream & ost) const = 0;
+
+    /// binary checkpoint of the local vectors, one file per rank.
+    /// restart requires the same space, order and distribution
+    void SaveCheckpoint (const string & filename) const;
+    /// load a checkpoint written by SaveCheckpoint, checks the dof layout
+    void LoadCheckpoint (const string & filename);
     using NGS_Object::shared_from_this;
   };
 
@@ -122,12 +122,13 @@ namespace ngcomp
 
   template <typename SCAL>
   H1AMG_Matrix<SCAL>::H1AMG_Matrix(shared_ptr<SparseMatrixTM<SCAL>> amat,
-                                   shared_ptr<BitArray> freedofs,
+                                   shared_ptr<BitArray> afreedofs,
                                    FlatArray<INT<2>> e2v,
                                    FlatArray<double> edge_weights,
                                    FlatArray<double> vertex_weights,
-                                   size_t level)
-  : mat(amat)
+                                   size_t level, H1AMG_SMOOTHER asmoother,
+                                   size_t acoarse_size)
+  : mat(amat), freedofs(afreedofs), smoother_type(asmoother), coarse_size(acoarse_size)
   {
       static Timer t("H1AMG"); RegionTimer reg(t);
 
@@ -233,37 +234,45 @@ namespace ngcomp
       edge_dag = Table<int>();
 
       // collapse the larger vertex
-      vertex_collapse = false;
-      for (int e = 0; e < num_edges; e++)
-        if (edge_collapse[e])
-          {
-            auto v0 = e2v[e][0];
-            auto v1 = e2v[e][1];
-            vertex_collapse[max2(v0,v1)] = true;
-          }
+      // (collapsed edges are a matching, every vertex is written at most once)
+      ParallelFor (num_vertices, [&] (size_t v) { vertex_collapse[v] = false; });
+      ParallelFor (num_edges, [&] (size_t e)
+                   {
+                     if (edge_collapse[e])
+                       vertex_collapse[max2(e2v[e][0], e2v[e][1])] = true;
+                   });
 
       BitArray isolated_verts(num_vertices);
       isolated_verts.Clear();
-      for (size_t i = 0; i < num_vertices; i++)
-        if (sum_vertex_weights[i] == vertex_weights[i] ||
-            (*freedofs)[i] == false)
-          isolated_verts.SetBit(i);
+      ParallelFor (num_vertices, [&] (size_t i)
+                   {
+                     if (sum_vertex_weights[i] == vertex_weights[i] ||
+                         (*freedofs)[i] == false)
+                       isolated_verts.SetBitAtomic(i);
+                   });
 
-      // vertex 2 coarse vertex
+      // vertex 2 coarse vertex, numbered by a parallel scan
       Array<size_t> v2cv(num_vertices);
-      size_t num_coarse_vertices = 0;
-      v2cv = -1;
-      for (size_t i = 0; i < num_vertices; i++)
-        if (!vertex_collapse[i] && !isolated_verts.Test(i))
-          v2cv[i] = num_coarse_vertices++;
-      for (size_t e = 0; e < num_edges; e++)
-        if (edge_collapse[e])
-          {
-            auto v0 = e2v[e][0];
-            auto v1 = e2v[e][1];
-            if (v0 > v1) Swap (v0,v1);
-            v2cv[v1] = v2cv[v0];
-          }
+      ParallelFor (num_vertices, [&] (size_t i)
+                   {
+                     v2cv[i] = (!vertex_collapse[i] && !isolated_verts.Test(i)) ? 1 : 0;
+                   });
+      Array<size_t> cvnr(v2cv);
+      size_t num_coarse_vertices = ParallelExclusiveScan<size_t> (cvnr);
+      ParallelFor (num_vertices, [&] (size_t i)
+                   {
+                     v2cv[i] = v2cv[i] ? cvnr[i] : size_t(-1);
+                   });
+      ParallelFor (num_edges, [&] (size_t e)
+                   {
+                     if (edge_collapse[e])
+                       {
+                         auto v0 = e2v[e][0];
+                         auto v1 = e2v[e][1];
+                         if (v0 > v1) Swap (v0,v1);
+                         v2cv[v1] = v2cv[v0];
+                       }
+                   });
 
       // edge to coarse edge
 
@@ -363,8 +372,8 @@ namespace ngcomp
                          smoothing_blocks_creator.Add (v2cv[v], v);
                      });
 
-      auto blocks = make_shared<Table<int>> (smoothing_blocks_creator.MoveTable());
-      smoother = mat->CreateBlockJacobiPrecond(blocks);
+      blocks = make_shared<Table<int>> (smoothing_blocks_creator.MoveTable());
+      CreateSmoother();
 
       // build prolongation
       Array<int> nne(num_vertices);
@@ -408,10 +417,10 @@ namespace ngcomp
           prolongation = MatMult (*smoothprol, *prolongation);
         }
 
-      auto coarsemat = mat -> Restrict (*prolongation);
+      coarsemat = dynamic_pointer_cast<SparseMatrixTM<SCAL>> (mat -> Restrict (*prolongation));
 
       // coarse freedofs
-      auto coarse_freedofs = make_shared<BitArray> (num_coarse_vertices);
+      coarse_freedofs = make_shared<BitArray> (num_coarse_vertices);
       coarse_freedofs->Clear();
       ParallelFor(v2cv.Size(), [&] (int v)
                   {
@@ -419,26 +428,158 @@ namespace ngcomp
                       coarse_freedofs->SetBitAtomic(v2cv[v]);
                   });
 
-      if (num_coarse_vertices < 10)
+      if (num_coarse_vertices < coarse_size)
 	{
 	  coarsemat->SetInverseType(SPARSECHOLESKY);
 	  coarse_precond = coarsemat->InverseMatrix(coarse_freedofs);
 	}
       else
-        coarse_precond = make_shared<H1AMG_Matrix> (dynamic_pointer_cast<SparseMatrixTM<SCAL>> (coarsemat), coarse_freedofs,
-                                                    coarse_e2v, coarse_edge_weights, coarse_vertex_weights, level+1);
+        coarse_precond = make_shared<H1AMG_Matrix> (coarsemat, coarse_freedofs,
+                                                    coarse_e2v, coarse_edge_weights, coarse_vertex_weights, level+1,
+                                                    smoother_type, coarse_size);
 
 
       restriction = TransposeMatrix (*prolongation);
     }
 
+
+  /// c = P^T a P, into the existing pattern of c.
+  /// works on the stored parts of a and c, either may be symmetric (lower triangle)
+  template <typename SCAL>
+  static void RestrictValues (const SparseMatrixTM<SCAL> & a,
+                              const SparseMatrixTM<double> & prol,
+                              SparseMatrixTM<SCAL> & c)
+  {
+    static Timer t("H1AMG - restrict values"); RegionTimer reg(t);
+
+    bool a_symmetric = dynamic_cast<const SparseMatrixSymmetricTM<SCAL>*> (&a) != nullptr;
+    bool c_symmetric = dynamic_cast<const SparseMatrixSymmetricTM<SCAL>*> (&c) != nullptr;
+
+    c.SetZero();
+
+    auto add = [&] (FlatArray<int> ci, FlatVector<double> pi,
+                    FlatArray<int> cj, FlatVector<double> pj, SCAL val)
+      {
+        for (size_t k = 0; k < ci.Size(); k++)
+          for (size_t l = 0; l < cj.Size(); l++)
+            {
+              int I = ci[k], J = cj[l];
+              if (c_symmetric && J > I) continue;
+              size_t pos = c.GetPositionTest (I, J);
+              if (pos == numeric_limits<size_t>::max())
+                throw Exception ("H1AMG::UpdateValues: coarse matrix pattern changed");
+              AtomicAdd (c[pos], pi(k) * val * pj(l));
+            }
+      };
+
+    ParallelFor (a.Height(), [&] (size_t i)
+                 {
+                   auto cols = a.GetRowIndices(i);
+                   auto vals = a.GetRowValues(i);
+                   auto ci = prol.GetRowIndices(i);
+                   auto pi = prol.GetRowValues(i);
+                   for (size_t k = 0; k < cols.Size(); k++)
+                     {
+                       int j = cols[k];
+                       auto cj = prol.GetRowIndices(j);
+                       auto pj = prol.GetRowValues(j);
+                       add (ci, pi, cj, pj, vals(k));
+                       if (a_symmetric && j != i)
+                         add (cj, pj, ci, pi, vals(k));
+                     }
+                 }, TasksPerThread(4));
+  }
+
+
+  template <typename SCAL>
+  void H1AMG_Matrix<SCAL>::UpdateValues (shared_ptr<SparseMatrixTM<SCAL>> amat)
+  {
+    static Timer t("H1AMG - update values"); RegionTimer reg(t);
+
+    if (amat->Height() != size)
+      throw Exception ("H1AMG::UpdateValues: matrix size changed");
+    mat = amat;
+    CreateSmoother();
+
+    RestrictValues (*mat, *prolongation, *coarsemat);
+
+    if (auto coarse_amg = dynamic_pointer_cast<H1AMG_Matrix<SCAL>> (coarse_precond))
+      coarse_amg->UpdateValues (coarsemat);
+    else
+      coarse_precond = coarsemat->InverseMatrix(coarse_freedofs);
+  }
+
+  template <typename SCAL>
+  void H1AMG_Matrix<SCAL>::CreateSmoother ()
+  {
+    switch (smoother_type)
+      {
+      case H1AMG_CHEBYSHEV:
+        {
+          shared_ptr<BaseMatrix> jac = mat->CreateJacobiPrecond(freedofs);
+          cheb_smoother = make_shared<ChebyshevSmoother> (mat, jac);
+          break;
+        }
+      case H1AMG_L1JACOBI:
+        {
+          static Timer t("H1AMG - l1 diagonal"); RegionTimer reg(t);
+          // row sums of |a_ij|, for symmetric storage also the upper part
+          bool symmetric = dynamic_cast<const SparseMatrixSymmetricTM<SCAL>*> (mat.get()) != nullptr;
+          Array<double> l1(size);
+          l1 = 0.0;
+          ParallelFor (size, [&] (size_t i)
+                       {
+                         auto cols = mat->GetRowIndices(i);
+                         auto vals = mat->GetRowValues(i);
+                         double sum = 0;
+                         for (size_t k = 0; k < cols.Size(); k++)
+                           {
+                             sum += fabs(vals(k));
+                             if (symmetric && cols[k] != i)
+                               AtomicAdd (l1[cols[k]], fabs(vals(k)));
+                           }
+                         AtomicAdd (l1[i], sum);
+                       });
+          l1_inv = make_shared<DiagonalMatrix<SCAL>> (size);
+          ParallelFor (size, [&] (size_t i)
+                       {
+                         (*l1_inv)(i) = ((*freedofs)[i] && l1[i] != 0) ? SCAL(1.0/l1[i]) : SCAL(0.0);
+                       });
+          break;
+        }
+      default:
+        smoother = mat->CreateBlockJacobiPrecond(blocks);
+      }
+  }
+
+  template <typename SCAL>
+  void H1AMG_Matrix<SCAL>::Smooth (BaseVector & x, const BaseVector & b, bool back) const
+  {
+    if (cheb_smoother)
+      for (int i = 0; i < smoothing_steps; i++)
+        cheb_smoother->Smooth (x, b);
+    else if (l1_inv)
+      {
+        auto r = b.CreateVector();
+        for (int i = 0; i < smoothing_steps; i++)
+          {
+            r = b - (*mat) * x;
+            x += (*l1_inv) * r;
+          }
+      }
+    else if (back)
+      smoother->GSSmoothBack (x, b, smoothing_steps);
+    else
+      smoother->GSSmooth (x, b, smoothing_steps);
+  }
+
   template <typename SCAL>
   void H1AMG_Matrix<SCAL>::Mult (const BaseVector & b, BaseVector & x) const
   {
       static Timer t("H1AMG::Mult"); RegionTimer reg(t);
       x = 0;
 
-      smoother->GSSmooth(x, b, smoothing_steps);
+      Smooth (x, b, false);
       auto residuum = b.CreateVector();
       residuum = b - (*mat) * x;
 
@@ -449,9 +590,73 @@ namespace ngcomp
       coarse_precond->Mult(coarse_residuum, coarse_x);
 
       x += *prolongation * coarse_x;
-      smoother->GSSmoothBack (x, b, smoothing_steps);
+      Smooth (x, b, true);
+  }
+
+  shared_ptr<H1AMG_Matrix<double>>
+  CreateH1AMGMatrix (shared_ptr<SparseMatrixTM<double>> mat, shared_ptr<BitArray> freedofs,
+                     H1AMG_SMOOTHER smoother, size_t coarse_size)
+  {
+    static Timer t("H1AMG - weights from matrix"); RegionTimer reg(t);
+    size_t n = mat->Height();
+    if (!freedofs)
+      {
+        freedofs = make_shared<BitArray> (n);
+        freedofs->Set();
+      }
+    // the lower triangle of a symmetric matrix is stored once
+    bool lower = dynamic_pointer_cast<SparseMatrixSymmetric<double>> (mat) != nullptr;
+
+    Array<double> rowsum(n);
+    rowsum = 0.0;
+    Array<int> cnt(n);
+    ParallelFor (n, [&] (size_t i)
+                 {
+                   int c = 0;
+                   for (int j : mat->GetRowIndices(i))
+                     if (size_t(j) < i) c++;
+                   cnt[i] = c;
+                 });
+    Array<size_t> first(n+1);
+    first[0] = 0;
+    for (size_t i = 0; i < n; i++)
+      first[i+1] = first[i] + cnt[i];
+
+    Array<INT<2>> e2v(first[n]);
+    Array<double> edge_weights(first[n]);
+    ParallelFor (n, [&] (size_t i)
+                 {
+                   auto cols = mat->GetRowIndices(i);
+                   auto vals = mat->GetRowValues(i);
+                   size_t k = first[i];
+                   for (size_t j = 0; j < cols.Size(); j++)
+                     {
+                       size_t col = cols[j];
+                       if (lower)
+                         {
+                           AtomicAdd (rowsum[i], vals[j]);
+                           if (col != i) AtomicAdd (rowsum[col], vals[j]);
+                         }
+                       else
+                         AtomicAdd (rowsum[i], vals[j]);
+                       if (col < i)
+                         {
+                           e2v[k] = INT<2> (col, i);
+                           edge_weights[k] = fabs(vals[j]);
+                           k++;
+                         }
+                     }
+                 });
+
+    Array<double> vertex_weights(n);
+    for (size_t i = 0; i < n; i++)
+      vertex_weights[i] = max2 (rowsum[i], 0.0);
+
+    return make_shared<H1AMG_Matrix<double>> (mat, freedofs, e2v, edge_weights, vertex_weights, 0,
+                                              smoother, coarse_size);
   }
 
+
   template <class SCAL>
   class H1AMG_Preconditioner : public Preconditioner
   {
@@ -481,10 +686,22 @@ namespace ngcomp
       freedofs = _freedofs;
     }
 
+    /// keep the hierarchy of the previous setup, only refresh values
+    bool ReuseHierarchy () const
+    {
+      return flags.GetDefineFlag ("reuse") && mat && freedofs && mat->VHeight() == freedofs->Size();
+    }
+
     virtual void FinalizeLevel (const BaseMatrix * matrix) override
     {
       auto smat = dynamic_pointer_cast<SparseMatrixTM<SCAL>> (const_cast<BaseMatrix*>(matrix)->shared_from_this());
 
+      if (ReuseHierarchy())
+        {
+          mat->UpdateValues (smat);
+          return;
+        }
+
       size_t num_vertices = matrix->Height();
       size_t num_edges = edge_weights_ht.Used();
 
@@ -508,7 +725,17 @@ namespace ngcomp
          });
       vertex_weights_ht = ParallelHashTable<INT<1>,double>();
 
-      mat = make_shared<H1AMG_Matrix<double>> (smat, freedofs, e2v, edge_weights, vertex_weights, 0);
+      string smoother = flags.GetStringFlag ("smoother", "block");
+      H1AMG_SMOOTHER smoother_type = H1AMG_BLOCK_GS;
+      if (smoother == "chebyshev")
+        smoother_type = H1AMG_CHEBYSHEV;
+      else if (smoother == "l1jacobi")
+        smoother_type = H1AMG_L1JACOBI;
+      else if (smoother != "block")
+        throw Exception ("H1AMG: unknown smoother '" + smoother + "', use block, chebyshev or l1jacobi");
+      size_t coarse_size = size_t(flags.GetNumFlag ("coarsesize", 10));
+      mat = make_shared<H1AMG_Matrix<double>> (smat, freedofs, e2v, edge_weights, vertex_weights, 0,
+                                               smoother_type, coarse_size);
     }
 
 
@@ -525,6 +752,9 @@ namespace ngcomp
 
       ThreadRegionTimer reg (t, TaskManager::GetThreadId());
 
+      // weights only determine the hierarchy
+      if (ReuseHierarchy()) return;
+
       size_t ndof = dnums.Size();
       BitArray used(ndof, lh);
 
@@ -5,23 +5,42 @@
 
 namespace ngcomp
 {
+  /// smoother on the AMG levels
+  enum H1AMG_SMOOTHER { H1AMG_BLOCK_GS, H1AMG_CHEBYSHEV, H1AMG_L1JACOBI };
+
   template <class SCAL>
   class NGS_DLL_HEADER H1AMG_Matrix : public ngla::BaseMatrix
   {
     size_t size;
     std::shared_ptr<ngla::SparseMatrixTM<SCAL>> mat;
     std::shared_ptr<ngla::BaseBlockJacobiPrecond> smoother;
+    /// Jacobi-Chebyshev smoother instead of block Gauss-Seidel
+    std::shared_ptr<ngla::ChebyshevSmoother> cheb_smoother;
+    /// inverse of the l1-diagonal, sum_j |a_ij|, zero for non-free dofs
+    std::shared_ptr<ngla::DiagonalMatrix<SCAL>> l1_inv;
     std::shared_ptr<ngla::SparseMatrixTM<double>> prolongation, restriction;
     std::shared_ptr<ngla::BaseMatrix> coarse_precond;
     int smoothing_steps = 1;
 
+    /// kept for UpdateValues: the hierarchy is reused, only values are recomputed
+    std::shared_ptr<ngcore::BitArray> freedofs, coarse_freedofs;
+    std::shared_ptr<ngcore::Table<int>> blocks;
+    std::shared_ptr<ngla::SparseMatrixTM<SCAL>> coarsemat;
+    H1AMG_SMOOTHER smoother_type;
+    /// direct solve if there are fewer coarse vertices
+    size_t coarse_size;
+
+    void CreateSmoother ();
+    void Smooth (ngla::BaseVector & x, const ngla::BaseVector & b, bool back) const;
+
   public:
     H1AMG_Matrix (std::shared_ptr<ngla::SparseMatrixTM<SCAL>> amat,
                   std::shared_ptr<ngcore::BitArray> freedofs,
                   ngcore::FlatArray<ngcore::INT<2>> e2v,
                   ngcore::FlatArray<double> edge_weights,
                   ngcore::FlatArray<double> vertex_weights,
-                  size_t level);
+                  size_t level, H1AMG_SMOOTHER asmoother = H1AMG_BLOCK_GS,
+                  size_t acoarse_size = 10);
 
     virtual int VHeight() const override { return size; }
     virtual int VWidth() const override { return size; }
@@ -30,7 +49,24 @@ namespace ngcomp
     virtual AutoVector CreateColVector () const override { return mat->CreateRowVector(); }
 
     virtual void Mult (const ngla::BaseVector & b, ngla::BaseVector & x) const override;
+
+    /**
+       New matrix values, same sparsity pattern.
+       Keeps aggregates, prolongation and the coarse matrix patterns,
+       recomputes smoothers and the Galerkin coarse matrices.
+    */
+    void UpdateValues (std::shared_ptr<ngla::SparseMatrixTM<SCAL>> amat);
   };
+
+  /**
+     H1AMG for an assembled matrix, without element matrices: the edges
+     are the off-diagonal entries with weight |a_ij|, the vertex weights
+     the positive row sums. For Galerkin products in auxiliary spaces.
+  */
+  NGS_DLL_HEADER std::shared_ptr<H1AMG_Matrix<double>>
+  CreateH1AMGMatrix (std::shared_ptr<ngla::SparseMatrixTM<double>> mat,
+                     std::shared_ptr<ngcore::BitArray> freedofs,
+                     H1AMG_SMOOTHER smoother = H1AMG_BLOCK_GS, size_t coarse_size = 10);
 }
 
 #endif // H1AMG_HPP_
@@ -596,14 +596,14 @@ into the wirebasket.
 	if(uniform_order_edge > -1)   
 	  order_edge = uniform_order_edge; 
 
-	for (auto i : Range(used_edge))
-	  if (!used_edge[i]) order_edge[i] = 1; 
+	ParallelFor (used_edge.Size(), [&] (size_t i)
+                     { if (!used_edge[i]) order_edge[i] = 1; });
 
-	for (auto i : used_face.Range())
-	  if (!used_face[i]) order_face[i] = 1; 
+	ParallelFor (used_face.Size(), [&] (size_t i)
+                     { if (!used_face[i]) order_face[i] = 1; });
 
-	for (ElementId ei : ma->Elements<VOL>())
-	  if (!DefinedOn(ei)) order_inner[ei.Nr()] = 1;
+	ParallelFor (ma->GetNE(VOL), [&] (size_t i)
+                     { if (!DefinedOn(ElementId(VOL,i))) order_inner[i] = 1; });
 
 	if(print) 
 	  {
@@ -653,13 +653,14 @@ into the wirebasket.
     int hndof = nv;
 
     first_edge_dof.SetSize (ned+1);
-    for (auto i : Range (ned))
-      {
-	first_edge_dof[i] = hndof;
-        int oe = order_edge[i];
-        if (highest_order_dc) oe--;
-	if (oe > 1) hndof += oe - 1;
-      }
+    ParallelFor
+      (ned, [&] (size_t i)
+       {
+         int oe = order_edge[i];
+         if (highest_order_dc) oe--;
+         first_edge_dof[i] = (oe > 1) ? oe-1 : 0;
+       });
+    hndof = ParallelExclusiveScan (first_edge_dof.Range(0, ned), hndof);
     first_edge_dof[ned] = hndof;
 
     first_face_dof.SetSize (nfa+1);
@@ -687,12 +688,7 @@ into the wirebasket.
          });
 
     // accumulate
-    for (auto i : Range(nfa))
-      {
-        auto neldof = first_face_dof[i];
-        first_face_dof[i] = hndof;
-        hndof += neldof;
-      }
+    hndof = ParallelExclusiveScan (first_face_dof.Range(0, nfa), hndof);
     first_face_dof[nfa] = hndof;
     
 
@@ -744,12 +740,7 @@ into the wirebasket.
        });
 
     // accumulate
-    for (auto i : Range(ne))
-      {
-        auto neldof = first_element_dof[i];
-        first_element_dof[i] = hndof;
-        hndof += neldof;
-      }
+    hndof = ParallelExclusiveScan (first_element_dof.Range(0, ne), hndof);
     first_element_dof[ne] = hndof;
     // ndof = hndof;
     SetNDof(hndof);
@@ -856,9 +847,11 @@ into the wirebasket.
   Array<MemoryUsage> H1HighOrderFESpace :: GetMemoryUsage () const
   {
     auto mu = FESpace::GetMemoryUsage();
-    mu += { "H1HighOrder::order_inner", order_inner.Size()*sizeof(INT<3,TORDER>), 1 };
-    mu += { "H1HighOrder::order_face", order_face.Size()*sizeof(INT<2,TORDER>), 1 };
-    mu += { "H1HighOrder::order_edge", order_edge.Size()*sizeof(TORDER), 1 };
+    Array<MemoryUsage> orders;
+    orders += { "H1HighOrder::order_inner", order_inner.Size()*sizeof(INT<3,TORDER>), 1 };
+    orders += { "H1HighOrder::order_face", order_face.Size()*sizeof(INT<2,TORDER>), 1 };
+    orders += { "H1HighOrder::order_edge", order_edge.Size()*sizeof(TORDER), 1 };
+    mu += MemoryUsageChildren ("space " + GetName(), move(orders));
     return mu;
   }
 
@@ -708,24 +708,28 @@ namespace ngcomp
     ndof = ned; // Nedelec (order = 0) !!   
        
     first_edge_dof.SetSize (ned+1); 
-    for (int i = 0; i < ned; i++)
-      {
-	first_edge_dof[i] = ndof;
-        if (usegrad_edge[i])
-          {
-            int oe = order_edge[i];
-            if (highest_order_dc) oe--;
-            if (oe > 0) ndof += oe;
-          }
-      }
+    ParallelFor
+      (ned, [&] (size_t i)
+       {
+         int nd = 0;
+         if (usegrad_edge[i])
+           {
+             int oe = order_edge[i];
+             if (highest_order_dc) oe--;
+             if (oe > 0) nd += oe;
+           }
+         first_edge_dof[i] = nd;
+       });
+    ndof = ParallelExclusiveScan (first_edge_dof.Range(0, ned), DofId(ndof));
     first_edge_dof[ned] = ndof;
     
     first_face_dof.SetSize (nfa+1);
     face_ngrad.SetSize (nfa); 
     face_ngrad = 0; 
-    for (int i = 0; i < nfa; i++) 
+    ParallelFor
+      (nfa, [&] (size_t i)
       { 
-	first_face_dof[i] = ndof; 
+        int nd = 0;
 	auto pnums = ma->GetFacePNums (i);  
 	INT<2> p = order_face[i]; 
 	switch(pnums.Size())
@@ -739,27 +743,30 @@ namespace ngcomp
                 */
                 int pg = p[0] - (type1 ? 1 : 0);
 		face_ngrad[i] = usegrad_face[i]*pg*(pg-1)/2;
-                ndof += face_ngrad[i] + (p[0] + 2)*(p[0]-1)/2;
+                nd += face_ngrad[i] + (p[0] + 2)*(p[0]-1)/2;
 	      }
 	    break; 
 	  case 4: //Quad 
 	    //if(p[0]>0 && p[1]>0)
 	    {
-	      ndof += (usegrad_face[i]+1)*p[0]*p[1] + p[0] + p[1]; 
+	      nd += (usegrad_face[i]+1)*p[0]*p[1] + p[0] + p[1]; 
 	      face_ngrad[i] = usegrad_face[i]*p[0]*p[1];; 
 	      break; 
 	    }
 	  }
-      } 
+        first_face_dof[i] = nd;
+      });
+    ndof = ParallelExclusiveScan (first_face_dof.Range(0, nfa), DofId(ndof));
     first_face_dof[nfa] = ndof;   
     
     cell_ngrad.SetSize(ne); 
     cell_ngrad = 0; 
     first_inner_dof.SetSize(ne+1);
-    for (int i = 0; i < ne; i++)
+    ParallelFor
+      (ne, [&] (size_t i)
       {
         ElementId ei(VOL, i);
-	first_inner_dof[i] = ndof;
+        int nd = 0;
 	INT<3> p = order_inner[i];
 	switch(ma->GetElType(ei)) 
 	  {
@@ -768,7 +775,7 @@ namespace ngcomp
 	      {
                 int pg = p[0] - (type1 ? 1 : 0);
 		cell_ngrad[i] = usegrad_cell[i]*pg*(pg-1)/2;
-                ndof += cell_ngrad[i] + (p[0] + 2)*(p[0]-1)/2;
+                nd += cell_ngrad[i] + (p[0] + 2)*(p[0]-1)/2;
                 /*
 		ndof += ((usegrad_cell[i]+1)*p[0] + 2) * (p[0]-1) /2;
 		cell_ngrad[i] = ((usegrad_cell[i])*p[0]) * (p[0]-1) /2;
@@ -778,7 +785,7 @@ namespace ngcomp
 	  case ET_QUAD: 
 	    if(p[0]>=0 && p[1]>=0) 
 	      {
-		ndof += (usegrad_cell[i]+1) * p[0] * p[1] + p[0] + p[1]; 
+		nd += (usegrad_cell[i]+1) * p[0] * p[1] + p[0] + p[1]; 
 		cell_ngrad[i] = (usegrad_cell[i]) * p[0] * p[1];
 	      }
 	    break; 
@@ -787,11 +794,11 @@ namespace ngcomp
 	      {
 		if (type1) {
 		  cell_ngrad[i] = usegrad_cell[i] * (p[0]-3)*(p[0]-2)*(p[0]-1)/6;
-		  ndof += (p[0]-2)*(p[0]-1)*(2*p[0]+3)/6 + cell_ngrad[i];
+		  nd += (p[0]-2)*(p[0]-1)*(2*p[0]+3)/6 + cell_ngrad[i];
 				  
 		}
 		else {
-		  ndof += ((usegrad_cell[i] + 2) *  p[0] + 3) * (p[0]-2) * (p[0]-1) / 6; 
+		  nd += ((usegrad_cell[i] + 2) *  p[0] + 3) * (p[0]-2) * (p[0]-1) / 6; 
 		  cell_ngrad[i] = ((usegrad_cell[i] ) *  p[0]) * (p[0]-2) * (p[0]-1) / 6;
 		}
 	      }
@@ -799,7 +806,7 @@ namespace ngcomp
 	  case ET_PRISM:
 	    if(p[0]>1 && p[2]>=0) 
 	      {
-		ndof += (usegrad_cell[i]+2)*p[2] * p[0]*(p[0]-1)/2
+		nd += (usegrad_cell[i]+2)*p[2] * p[0]*(p[0]-1)/2
 		  + (p[0]-1)*p[2] + p[0]*(p[0]-1)/2; 
 		cell_ngrad[i] = (usegrad_cell[i])*p[2] * p[0]*(p[0]-1)/2;
 	      } 
@@ -807,7 +814,7 @@ namespace ngcomp
 	  case ET_HEX:
 	    if(p[0]>=0 && p[1]>=0 && p[2] >=0)
 	      {
-		ndof += (usegrad_cell[i] + 2)* p[0]*p[1]*p[2] +  p[0]*p[1] 
+		nd += (usegrad_cell[i] + 2)* p[0]*p[1]*p[2] +  p[0]*p[1] 
 		  + p[0]*p[2] + p[1]*p[2];
 		cell_ngrad[i] = (usegrad_cell[i])* p[0]*p[1]*p[2]; 
 	      }
@@ -815,7 +822,7 @@ namespace ngcomp
 	  case ET_PYRAMID:
 	    if (p[0] > 1)
 	      {
-		ndof += usegrad_cell[i]*(p[0]-1)*p[0]*(2*p[0]-1)/6 + p[0]*(2*p[0]*p[0]+3*p[0]-2)/3; 
+		nd += usegrad_cell[i]*(p[0]-1)*p[0]*(2*p[0]-1)/6 + p[0]*(2*p[0]*p[0]+3*p[0]-2)/3; 
 		cell_ngrad[i] = usegrad_cell[i]*(p[0]-1)*p[0]*(2*p[0]-1)/6; 
 	      }
 	    break; 
@@ -823,8 +830,10 @@ namespace ngcomp
             break; 
 	  }
         if (highest_order_dc)
-          ndof += ElementTopology::GetNEdges(ma->GetElType(ei));
-      }
+          nd += ElementTopology::GetNEdges(ma->GetElType(ei));
+        first_inner_dof[i] = nd;
+      });
+    ndof = ParallelExclusiveScan (first_inner_dof.Range(0, ne), DofId(ndof));
     first_inner_dof[ne] = ndof;    
 
     if (discontinuous)
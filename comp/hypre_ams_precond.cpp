@@ -47,39 +47,43 @@ namespace ngcomp
       return;
     }
     
-    size_t maxperow = 0;
-    for(auto k:Range(nr))
-      maxperow = max2(maxperow, ngsmat.GetRowIndices(k).Size());
-    
-    Array<int> cg(maxperow);
-    Array<double> vg(maxperow);
-    int s = 0;
+    // collect all rows, then hand them to hypre in one batch
+    Array<int> rows, ncols, cg;
+    Array<double> vg;
+    rows.SetAllocSize(nr);
+    ncols.SetAllocSize(nr);
+    cg.SetAllocSize(ngsmat.NZE());
+    vg.SetAllocSize(ngsmat.NZE());
     for(auto k:Range(nr)) {
       auto cols = ngsmat.GetRowIndices(k);
       auto vals = ngsmat.GetRowValues(k);
       int row = row_gnums[k];
-      s = 0;
+      int s = 0;
       if( (!row_freedofs) || row_freedofs->Test(k) ) {
 	for(auto j:Range(cols.Size())) {
 	  if( (row_pardofs) && (matrix_cumulated) && (!row_pardofs->IsMasterDof(k)) && (!col_pardofs->IsMasterDof(cols[j])) )
 	    continue; //if someone else is master of both dofs, they have to have the fill val!
 	  if( (col_freedofs) && (!col_freedofs->Test(cols[j])) )
 	    continue;
-	  cg[s] = col_gnums[cols[j]];
-	  vg[s++] = vals[j];
+	  cg.Append (col_gnums[cols[j]]);
+	  vg.Append (vals[j]);
+	  s++;
 	}
       }
       else { //dirichlet DOF - only a 1 @ diag
 	if( (row_pardofs) && (!row_pardofs->IsMasterDof(k)) )
 	  continue;
 	s = 1;
-	cg[0] = row;
-	vg[0] = 1.0;
+	cg.Append (row);
+	vg.Append (1.0);
       }
     
       if(!s) continue; //no entries to add to matrix!
-      HYPRE_IJMatrixAddToValues(*ijmat, 1, &s, &row, &cg[0], &vg[0]);
-    }    
+      rows.Append (row);
+      ncols.Append (s);
+    }
+    if (rows.Size())
+      HYPRE_IJMatrixAddToValues(*ijmat, rows.Size(), &ncols[0], &rows[0], &cg[0], &vg[0]);
     HYPRE_IJMatrixAssemble(*ijmat);
     HYPRE_IJMatrixGetObject(*ijmat, (void**) pijmat);
 
@@ -391,31 +395,25 @@ namespace ngcomp
       u.SetParallelStatus(DISTRIBUTED);
     }
     
-    /** re-initialize vectors **/
-    HYPRE_IJVectorInitialize(this->b);
-    HYPRE_IJVectorInitialize(this->x);
-    if(this->hc_ndof) {
-      HYPRE_IJVectorSetValues(this->x, this->hc_intrange.Size(), &this->hc_intrange[0], &this->buf_z[0]);
-      for(auto k:Range(this->buf_hc.Size()))
-	if(this->hc_freedofs->Test(this->hc_masterdofs[k]))
-	  buf_hc[k] = f.FVDouble()[this->hc_masterdofs[k]];
-	else
-	  buf_hc[k] = 0.0;
-      HYPRE_IJVectorSetValues(this->b, this->hc_intrange.Size(), &this->hc_intrange[0], &this->buf_hc[0]);
-    }
-    HYPRE_IJVectorAssemble(this->b);    
-    HYPRE_IJVectorGetObject(this->b, (void **) &this->par_b);
-    HYPRE_IJVectorAssemble(this->x);
-    HYPRE_IJVectorGetObject(this->x, (void **) &this->par_x);
+    /** write directly into the local parts of the hypre vectors **/
+    double * bdata = hypre_VectorData(hypre_ParVectorLocalVector((hypre_ParVector*) this->par_b));
+    double * xdata = hypre_VectorData(hypre_ParVectorLocalVector((hypre_ParVector*) this->par_x));
+    FlatVector<double> fvf = f.FVDouble();
+    ParallelFor (this->hc_masterdofs.Size(), [&] (size_t k)
+                 {
+                   auto dof = this->hc_masterdofs[k];
+                   bdata[k] = this->hc_freedofs->Test(dof) ? fvf[dof] : 0.0;
+                 });
+    HYPRE_ParVectorSetConstantValues(this->par_x, 0.0);
 
     /** call AMS-solver **/
     HYPRE_AMSSolve(this->precond, this->parcsr_A, this->par_b, this->par_x);
     
     /** get sol **/
-    HYPRE_IJVectorGetValues(x, this->hc_intrange.Size(), &this->hc_intrange[0], &this->buf_hc[0]);    
-    if(this->hc_ndof) u.FVDouble() = 0.0;    
-    for(auto k:Range(this->buf_hc.Size()))
-      u.FVDouble()[this->hc_masterdofs[k]] = this->buf_hc[k];
+    FlatVector<double> fu = u.FVDouble();
+    fu = 0.0;
+    ParallelFor (this->hc_masterdofs.Size(), [&] (size_t k)
+                 { fu[this->hc_masterdofs[k]] = xdata[k]; });
 
     /*
     // check for positiveness of PC
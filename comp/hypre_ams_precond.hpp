@@ -15,6 +15,7 @@
 
 #include "HYPRE.h"
 #include "HYPRE_parcsr_ls.h"
+#include "_hypre_parcsr_mv.h"
 
 
 namespace ngcomp
@@ -39,11 +39,63 @@ namespace ngcomp
 
   HyprePreconditioner :: ~HyprePreconditioner ()
   {
-    ;
+    if (precond) HYPRE_BoomerAMGDestroy (precond);
+    if (A) HYPRE_IJMatrixDestroy (A);
+    if (b) HYPRE_IJVectorDestroy (b);
+    if (x) HYPRE_IJVectorDestroy (x);
   }
-  
-  
-  
+
+
+  /// all local rows in one batch, entries to non-free dofs dropped
+  static void AddToIJMatrix (HYPRE_IJMatrix A, const SparseMatrix<double> & mat,
+                             FlatArray<int> global_nums)
+  {
+    static Timer t("hypre - copy matrix"); RegionTimer reg(t);
+    
+    Array<int> rownr(mat.Height());
+    Array<int> ncols(mat.Height());
+    ParallelFor (mat.Height(), [&] (size_t i)
+                 {
+                   int cnt = 0;
+                   if (global_nums[i] != -1)
+                     for (int c : mat.GetRowIndices(i))
+                       if (global_nums[c] != -1) cnt++;
+                   ncols[i] = cnt;
+                   rownr[i] = global_nums[i];
+                 });
+    Array<int> first(ncols);
+    int nze = ParallelExclusiveScan<int> (first);
+    
+    Array<int> cols(nze);
+    Array<double> values(nze);
+    ParallelFor (mat.Height(), [&] (size_t i)
+                 {
+                   if (global_nums[i] == -1) return;
+                   auto rcols = mat.GetRowIndices(i);
+                   auto rvals = mat.GetRowValues(i);
+                   int pos = first[i];
+                   for (size_t j = 0; j < rcols.Size(); j++)
+                     if (global_nums[rcols[j]] != -1)
+                       {
+                         cols[pos] = global_nums[rcols[j]];
+                         values[pos++] = rvals(j);
+                       }
+                 });
+
+    // skip rows of dirichlet dofs
+    size_t nrows = 0;
+    for (size_t i = 0; i < rownr.Size(); i++)
+      if (rownr[i] != -1)
+        {
+          rownr[nrows] = rownr[i];
+          ncols[nrows++] = ncols[i];
+        }
+
+    if (nrows)
+      HYPRE_IJMatrixAddToValues(A, nrows, &ncols[0], &rownr[0], &cols[0], &values[0]);
+  }
+
+
   void HyprePreconditioner :: Update()
   {
     freedofs = bfa->GetFESpace()->GetFreeDofs(bfa->UsesEliminateInternal());
@@ -78,6 +130,7 @@ namespace ngcomp
     
 
     // find global dof enumeration 
+    Array<int> old_global_nums = std::move(global_nums);
     global_nums.SetSize(ndof);
     if(ndof)
       global_nums = -1;
@@ -108,44 +161,60 @@ namespace ngcomp
     cout << IM(3) << "num glob dofs = " << num_glob_dofs << endl;
 	
     // range of my master dofs ...
+    int old_ilower = ilower, old_iupper = iupper;
     ilower = first_master_dof[id];
     iupper = first_master_dof[id+1]-1;
-   
-    HYPRE_IJMatrixCreate(comm, ilower, iupper, ilower, iupper, &A);
-    HYPRE_IJMatrixSetObjectType(A, HYPRE_PARCSR);
-    HYPRE_IJMatrixInitialize(A);
-   
 
-    for( int i = 0; i < mat.Height(); i++)
+    masterdofs.SetSize(iupper-ilower+1);
+    for (int i = 0; i < ndof; i++)
+      if (pardofs->IsMasterDof(i) && global_nums[i] != -1)
+        masterdofs[global_nums[i]-ilower] = i;
+
+    // the IJ matrix keeps its sparsity, only values are updated
+    bool same_pattern = A && old_ilower == ilower && old_iupper == iupper &&
+      &mat == matrix_A && mat.NZE() == nze_A && old_global_nums.Size() == global_nums.Size();
+    for (size_t i = 0; same_pattern && i < global_nums.Size(); i++)
+      if (old_global_nums[i] != global_nums[i]) same_pattern = false;
+    int same_everywhere = 0;
+    int my_same = same_pattern ? 1 : 0;
+    MPI_Allreduce (&my_same, &same_everywhere, 1, MPI_INT, MPI_MIN, comm);
+
+    if (same_everywhere)
       {
-	int row = global_nums[i];
-	if (row == -1) continue;
-
-	FlatArray<int> cols = mat.GetRowIndices(i);
-	FlatVector<double> values = mat.GetRowValues(i);
-      
-	Array<int> cols_global;
-	Array<double> values_global;
-
-	for( int j = 0; j < cols.Size(); j++)
-	  if (global_nums[cols[j]] != -1)
-	    {
-	      cols_global.Append (global_nums[cols[j]]);
-	      values_global.Append (values[j]);
-	    }
-
-	int size = cols_global.Size();
-	HYPRE_IJMatrixAddToValues(A, 1, &size, &row, &cols_global[0], &values_global[0]);
+        HYPRE_IJMatrixInitialize(A);
+        HYPRE_IJMatrixSetConstantValues(A, 0.0);
       }
+    else
+      {
+        if (A) HYPRE_IJMatrixDestroy(A);
+        if (b) HYPRE_IJVectorDestroy(b);
+        if (x) HYPRE_IJVectorDestroy(x);
+        
+        HYPRE_IJMatrixCreate(comm, ilower, iupper, ilower, iupper, &A);
+        HYPRE_IJMatrixSetObjectType(A, HYPRE_PARCSR);
+        HYPRE_IJMatrixInitialize(A);
+
+        for (HYPRE_IJVector * v : { &b, &x })
+          {
+            HYPRE_IJVectorCreate(comm, ilower, iupper, v);
+            HYPRE_IJVectorSetObjectType(*v, HYPRE_PARCSR);
+            HYPRE_IJVectorInitialize(*v);
+            HYPRE_IJVectorAssemble(*v);
+          }
+        HYPRE_IJVectorGetObject(b, (void **) &par_b);
+        HYPRE_IJVectorGetObject(x, (void **) &par_x);
+      }
+    nze_A = mat.NZE();
+    matrix_A = &mat;
+
+    AddToIJMatrix (A, mat, global_nums);
 
     HYPRE_IJMatrixAssemble(A);
     HYPRE_IJMatrixGetObject(A, (void**) &parcsr_A);
     // HYPRE_IJMatrixPrint(A, "IJ.out.A");
 
+    if (precond) HYPRE_BoomerAMGDestroy(precond);
     HYPRE_BoomerAMGCreate(&precond);
- 
-    HYPRE_ParVector par_b = NULL;
-    HYPRE_ParVector par_x = NULL;
 
     HYPRE_BoomerAMGSetPrintLevel(precond, 1);  /* print solve info + parameters */
     HYPRE_BoomerAMGSetCoarsenType(precond, 10); /* Falgout coarsening */
@@ -170,88 +239,27 @@ namespace ngcomp
   {
     static Timer t("hypre mult");
     RegionTimer reg(t);
-    NgsMPI_Comm comm = pardofs->GetCommunicator();
 
-    f.Distribute();
+    // master values are complete after cumulation,
+    // they are written directly into the local part of the hypre vector
+    f.Cumulate();
     u.SetParallelStatus(DISTRIBUTED);
-    
-    HYPRE_IJVector b;
-    HYPRE_ParVector par_b;
-    HYPRE_IJVector x;
-    HYPRE_ParVector par_x;
-
-    HYPRE_IJVectorCreate(comm, ilower, iupper,&b);
-    HYPRE_IJVectorSetObjectType(b, HYPRE_PARCSR);
-    HYPRE_IJVectorInitialize(b);
-
-    HYPRE_IJVectorCreate(comm, ilower, iupper,&x);
-    HYPRE_IJVectorSetObjectType(x, HYPRE_PARCSR);
-    HYPRE_IJVectorInitialize(x);
-  
-    const FlatVector<double> fvf =f.FVDouble();
-    FlatVector<double> fu =u.FVDouble();
-	
-    Array<int> nzglobal;
-    Array<double> free_f;
-    for(auto i : Range(global_nums.Size()))
-      if (global_nums[i] != -1)
-	{
-	  nzglobal.Append (global_nums[i]);
-	  free_f.Append (fvf(i));
-	}
-        
-    Array<int> setzi;
-    Array<double> zeros;
-    if(iupper>=ilower)
-      for(auto k : Range(ilower,iupper+1))
-	{
-	  setzi.Append(k);
-	  zeros.Append(0.0);
-	}
-
-    int local_size = nzglobal.Size();
-
-    //HYPRE_IJVectorAddToValues(b, setzi.Size(), &setzi[0], &zeros[0]);
-    //set vector to 0
-    if(setzi.Size())
-      HYPRE_IJVectorSetValues(b, setzi.Size(), &setzi[0], &zeros[0]);
-    //add values
-    if(local_size)
-      HYPRE_IJVectorAddToValues(b, local_size, &nzglobal[0], &free_f[0]);
-    HYPRE_IJVectorAssemble(b);
-
-	
-    HYPRE_IJVectorGetObject(b, (void **) &par_b);
 
-    if(setzi.Size())
-      HYPRE_IJVectorSetValues(x, setzi.Size(), &setzi[0], &zeros[0]);
-    HYPRE_IJVectorAssemble(x);
-    HYPRE_IJVectorGetObject(x, (void **) &par_x);
-   
-    // HYPRE_IJVectorPrint(b, "IJ.out.b");
+    FlatVector<double> fvf = f.FVDouble();
+    FlatVector<double> fu = u.FVDouble();
 
-    HYPRE_BoomerAMGSolve(precond, parcsr_A, par_b, par_x);
-
-    // HYPRE_IJVectorPrint(x, "IJ.out.x");
+    double * bdata = hypre_VectorData(hypre_ParVectorLocalVector((hypre_ParVector*) par_b));
+    double * xdata = hypre_VectorData(hypre_ParVectorLocalVector((hypre_ParVector*) par_x));
     
+    ParallelFor (masterdofs.Size(), [&] (size_t k)
+                 { bdata[k] = fvf(masterdofs[k]); });
+    HYPRE_ParVectorSetConstantValues(par_x, 0.0);
 
-    int ndof = pardofs->GetNDofLocal();
-    
-    Vector<> hu(iupper-ilower+1);
-    Array<int> locind(iupper-ilower+1);
+    HYPRE_BoomerAMGSolve(precond, parcsr_A, par_b, par_x);
 
-    for (int i = 0, cnt = 0; i < ndof; i++)
-      if (pardofs->IsMasterDof(i) && global_nums[i] != -1)
-	locind[cnt++] = global_nums[i];
-    int lsize = locind.Size();
-    
-    HYPRE_IJVectorGetValues (x, lsize, &locind[0], &hu(0));
-    
-    for (int i = 0, cnt = 0; i < ndof; i++)
-      if (pardofs->IsMasterDof(i) && global_nums[i] != -1)
-	fu(i) = hu(cnt++);
-      else
-	fu(i) = 0.0;
+    fu = 0.0;
+    ParallelFor (masterdofs.Size(), [&] (size_t k)
+                 { fu(masterdofs[k]) = xdata[k]; });
 
     u.Cumulate();
   }
@@ -16,6 +16,7 @@
 
 #include "HYPRE.h"
 #include "HYPRE_parcsr_ls.h"
+#include "_hypre_parcsr_mv.h"
 
 
 namespace ngcomp
@@ -26,12 +27,21 @@ class HyprePreconditioner : public Preconditioner
 {
   shared_ptr<BilinearForm> bfa;
 
-  HYPRE_Solver precond;
-  HYPRE_IJMatrix A;
+  HYPRE_Solver precond = nullptr;
+  HYPRE_IJMatrix A = nullptr;
   HYPRE_ParCSRMatrix parcsr_A;
 
+  // working vectors, created once per setup
+  HYPRE_IJVector b = nullptr, x = nullptr;
+  HYPRE_ParVector par_b, par_x;
+
   Array<int> global_nums;
-  int ilower, iupper;
+  int ilower = 0, iupper = -1;
+  /// local dof of hypre row ilower+k
+  Array<int> masterdofs;
+  /// matrix of the last setup, to detect value-only updates
+  const BaseMatrix * matrix_A = nullptr;
+  size_t nze_A = 0;
   shared_ptr<BitArray> freedofs;
   shared_ptr<ParallelDofs> pardofs;
 
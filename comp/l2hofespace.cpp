@@ -213,6 +213,11 @@ global system.
 
     docu.Arg("hide_all_dofs") = "bool = False\n"
       "  Set all used dofs to HIDDEN_DOFs";
+    docu.Arg("tp") = "bool = False\n"
+      "  Use tensor-product elements on quads, tets and hexes.\n"
+      "  Evaluation at tensor-product integration rules is done by\n"
+      "  sum factorization, which makes operator application with\n"
+      "  BilinearForm(..., nonassemble=True) cost O(p^(d+1)) per element.";
     return docu;
   }
 
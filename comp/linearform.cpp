@@ -32,6 +32,18 @@ namespace ngcomp
     return *this;
   }
   
+  size_t LinearForm :: EstimateHeapSize () const
+  {
+    size_t size = 0;
+    for (auto & lfi : parts)
+      {
+        VorB vb = lfi->SkeletonForm() ? VOL : lfi->VB();
+        size = max2 (size, fespace->EstimateHeapSize (vb, lfi->GetBonusIntegrationOrder(),
+                                                      lfi->ProxyDimension()));
+      }
+    return size;
+  }
+
   void LinearForm :: PrintReport (ostream & ost) const
   {
     ost << "on space " << GetFESpace()->GetName() << endl
@@ -46,7 +58,7 @@ namespace ngcomp
       {
 	auto mu = GetVectorPtr()->GetMemoryUsage ();
 	for (int i = 0; i < mu.Size(); i++)
-	  mu[i].AddName (string(" lf ")+GetName());
+	  mu[i].AddParent ("lf " + GetName());
         return mu;
       }
     return Array<MemoryUsage>();
@@ -59,7 +71,6 @@ namespace ngcomp
     static Timer timer1("Vector assembling 1", 2);
     static Timer timer2("Vector assembling 2", 2);
     static Timer timer3("Vector assembling 3", 2);
-    static mutex linformsurfneighprint_mutex;
     static mutex addelvec3_mutex;
     RegionTimer reg (timer);
 
@@ -256,6 +267,9 @@ namespace ngcomp
 	if(hasskeletonparts[BND])
 	{
           int nse = ma->GetNE(BND);
+          ProgressOutput progress (ma, "assemble facet surface element", nse);
+          // scalar entries are added atomically, no lock per element
+          bool atomic_add = this->GetVector().EntrySize() == (is_same<TSCAL,double>() ? 1 : 2);
 	  ParallelForRange( IntRange(nse), [&] ( IntRange r )
 	  {
 	    LocalHeap lh = clh.Split();
@@ -264,13 +278,7 @@ namespace ngcomp
 	    // loop for facet integrators: 
             for (int i : r)
 		{
-		  {
-                    lock_guard<mutex> guard(linformsurfneighprint_mutex);
-		    gcnt++;
-		    if (i % 10 == 0)
-		      cout << IM(3) << "\rassemble facet surface element " << i << "/" << nse << flush;
-		    ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
-		  }
+                  progress.Update();
 
 		  HeapReset hr(lh);
 		  
@@ -318,16 +326,18 @@ namespace ngcomp
 			}
 
 		      fespace->TransformVec (ei, elvec, TRANSFORM_RHS);
-		    
-		      {
-                        lock_guard<mutex> guard(addelvec3_mutex);
-			AddElementVector (dnums, elvec, parts[j]->CacheComp()-1);
-		      }
+
+                      if (atomic_add && parts[j]->CacheComp() == 0)
+                        this->GetVector().AddIndirect (dnums, elvec, true);
+                      else
+                        {
+                          lock_guard<mutex> guard(addelvec3_mutex);
+                          AddElementVector (dnums, elvec, parts[j]->CacheComp()-1);
+                        }
 		    }
 		}
 		
 	  });//end of parallel
-	  cout << IM(3) << "\rassemble facet surface element  " << nse << "/" << nse << endl;	  
 	}//endof hasskeletonbound
 
 
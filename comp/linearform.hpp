@@ -73,6 +73,9 @@ namespace ngcomp
       return parts.Size(); 
     }
 
+    /// estimated LocalHeap per thread for the assembling
+    size_t EstimateHeapSize () const;
+
     void SetIndependent (bool aindependent = true)
     { 
       independent = aindependent; 
@@ -23,6 +23,351 @@ namespace ngcomp
 
 
   template <int DIMS, int DIMR, typename BASE> class ALE_ElementTransformation;
+
+
+  /*
+    Points and Jacobians at a SIMD integration rule, one rule per element.
+    An entry is written once by the first thread computing it, 
+    other integration rules on the same element are not cached.
+   */
+  class MeshAccess::GeometryCache
+  {
+    struct Entry
+    {
+      size_t hash;
+      Array<SIMD<double>> values;   // point and Jacobian for every integration point
+    };
+    Array<atomic<Entry*>> entries[4];
+
+    static size_t Hash (const SIMD_IntegrationRule & ir, int dims)
+    {
+      size_t hash = 14695981039346656037ull;
+      for (size_t i = 0; i < ir.Size(); i++)
+        for (int j = 0; j < dims; j++)
+          for (int k = 0; k < SIMD<double>::Size(); k++)
+            {
+              double val = ir[i](j)[k];
+              uint64_t bits;
+              memcpy (&bits, &val, sizeof(bits));
+              hash = (hash ^ bits) * 1099511628211ull;
+            }
+      return hash ^ ir.Size();
+    }
+    
+  public:
+    GeometryCache (const MeshAccess & ma)
+    {
+      for (int vb = VOL; vb <= BBBND; vb++)
+        {
+          entries[vb] = Array<atomic<Entry*>> (ma.GetNE(VorB(vb)));
+          for (auto & e : entries[vb])
+            e.store (nullptr, memory_order_relaxed);
+        }
+    }
+
+    ~GeometryCache ()
+    {
+      for (auto & ents : entries)
+        for (auto & e : ents)
+          delete e.load();
+    }
+
+    template <int DIMS, int DIMR>
+    bool Get (ElementId ei, const SIMD_IntegrationRule & ir,
+              SIMD_MappedIntegrationRule<DIMS,DIMR> & mir) const
+    {
+      Entry * entry = entries[ei.VB()][ei.Nr()].load (memory_order_acquire);
+      if (!entry || entry->values.Size() != ir.Size()*DIMR*(DIMS+1) ||
+          entry->hash != Hash(ir, DIMS))
+        return false;
+
+      const SIMD<double> * vals = entry->values.Data();
+      for (size_t i = 0; i < ir.Size(); i++)
+        {
+          for (int k = 0; k < DIMR; k++)
+            mir[i].Point()(k) = *vals++;
+          for (int k = 0; k < DIMR; k++)
+            for (int j = 0; j < DIMS; j++)
+              mir[i].Jacobian()(k,j) = *vals++;
+          mir[i].Compute();
+        }
+      return true;
+    }
+
+    template <int DIMS, int DIMR>
+    void Put (ElementId ei, const SIMD_IntegrationRule & ir,
+              SIMD_MappedIntegrationRule<DIMS,DIMR> & mir)
+    {
+      auto & slot = entries[ei.VB()][ei.Nr()];
+      if (slot.load (memory_order_relaxed)) return;
+      
+      Entry * entry = new Entry;
+      entry->hash = Hash(ir, DIMS);
+      entry->values.SetSize (ir.Size()*DIMR*(DIMS+1));
+      SIMD<double> * vals = entry->values.Data();
+      for (size_t i = 0; i < ir.Size(); i++)
+        {
+          for (int k = 0; k < DIMR; k++)
+            *vals++ = mir[i].Point()(k);
+          for (int k = 0; k < DIMR; k++)
+            for (int j = 0; j < DIMS; j++)
+              *vals++ = mir[i].Jacobian()(k,j);
+        }
+
+      Entry * expected = nullptr;
+      if (!slot.compare_exchange_strong (expected, entry, memory_order_release))
+        delete entry;
+    }
+  };
+
+
+  /*
+    Uniform grid over the bounding boxes of the volume elements, about one
+    cell per element. A cell lists all elements whose box overlaps the cell.
+    Boxes of curved elements are taken from sample points and enlarged.
+   */
+  class MeshAccess::PointLocator
+  {
+    int dim;
+    Vec<3> pmin, pmax, hinv;
+    int n[3] = { 1, 1, 1 };
+    Array<Vec<3>> boxmin, boxmax;
+    Table<int> cells;
+
+    int CellIndex (int k, double x) const
+    {
+      int i = int ( (x-pmin(k)) * hinv(k) );
+      return max(0, min(n[k]-1, i));
+    }
+
+  public:
+    PointLocator (const MeshAccess & ma)
+    {
+      static Timer t("MeshAccess::PointLocator"); RegionTimer reg(t);
+      dim = ma.GetDimension();
+      size_t ne = ma.GetNE(VOL);
+      boxmin.SetSize(ne);
+      boxmax.SetSize(ne);
+
+      ParallelForRange
+        (ne, [&] (IntRange r)
+         {
+           LocalHeap lh(100000, "PointLocator");
+           for (size_t i : r)
+             {
+               HeapReset hr(lh);
+               ElementId ei(VOL, i);
+               Vec<3> bmin(1e99, 1e99, 1e99), bmax(-1e99, -1e99, -1e99);
+               auto add = [&] (Vec<3> p)
+                 {
+                   for (int k = 0; k < 3; k++)
+                     {
+                       bmin(k) = min(bmin(k), p(k));
+                       bmax(k) = max(bmax(k), p(k));
+                     }
+                 };
+               
+               Ngs_Element el = ma.GetElement(ei);
+               for (auto v : el.Vertices())
+                 add (ma.GetPoint<3>(v));
+
+               double enlarge = 1e-8;
+               if (el.is_curved || ma.GetDeformation())
+                 {
+                   auto & trafo = ma.GetTrafo (ei, lh);
+                   IntegrationRule ir(el.GetType(), 4);
+                   for (auto & ip : ir)
+                     {
+                       Vec<3> p = 0.0;
+                       trafo.CalcPoint (ip, FlatVector<> (dim, &p(0)));
+                       add (p);
+                     }
+                   enlarge = 0.1;
+                 }
+
+               double diam = L2Norm (bmax-bmin);
+               for (int k = 0; k < 3; k++)
+                 {
+                   bmin(k) -= enlarge*diam;
+                   bmax(k) += enlarge*diam;
+                 }
+               if (dim < 3) { bmin(2) = -1; bmax(2) = 1; }
+               if (dim < 2) { bmin(1) = -1; bmax(1) = 1; }
+               boxmin[i] = bmin;
+               boxmax[i] = bmax;
+             }
+         });
+
+      pmin = 1e99;
+      pmax = -1e99;
+      for (size_t i = 0; i < ne; i++)
+        for (int k = 0; k < 3; k++)
+          {
+            pmin(k) = min(pmin(k), boxmin[i](k));
+            pmax(k) = max(pmax(k), boxmax[i](k));
+          }
+      if (ne == 0) { pmin = 0.0; pmax = 1.0; }
+
+      double vol = 1;
+      for (int k = 0; k < dim; k++)
+        vol *= pmax(k)-pmin(k);
+      double h = pow (vol / max(ne, size_t(1)), 1.0/dim);
+      for (int k = 0; k < 3; k++)
+        {
+          n[k] = (k < dim) ? max(1, min(1000, int((pmax(k)-pmin(k))/h))) : 1;
+          hinv(k) = n[k] / (pmax(k)-pmin(k));
+        }
+
+      TableCreator<int> creator(n[0]*n[1]*n[2]);
+      for ( ; !creator.Done(); creator++)
+        for (size_t i = 0; i < ne; i++)
+          {
+            int first[3], last[3];
+            for (int k = 0; k < 3; k++)
+              {
+                first[k] = CellIndex (k, boxmin[i](k));
+                last[k] = CellIndex (k, boxmax[i](k));
+              }
+            for (int iz = first[2]; iz <= last[2]; iz++)
+              for (int iy = first[1]; iy <= last[1]; iy++)
+                for (int ix = first[0]; ix <= last[0]; ix++)
+                  creator.Add ((iz*n[1]+iy)*n[0]+ix, i);
+          }
+      cells = creator.MoveTable();
+    }
+
+    bool InBox (size_t elnr, Vec<3> p) const
+    {
+      for (int k = 0; k < dim; k++)
+        if (p(k) < boxmin[elnr](k) || p(k) > boxmax[elnr](k))
+          return false;
+      return true;
+    }
+
+    /// elements whose bounding box may contain the point
+    FlatArray<int> Candidates (Vec<3> p) const
+    {
+      for (int k = 0; k < dim; k++)
+        if (p(k) < pmin(k) || p(k) > pmax(k))
+          return FlatArray<int>();
+      return cells[(CellIndex(2, p(2))*n[1]+CellIndex(1, p(1)))*n[0]+CellIndex(0, p(0))];
+    }
+  };
+
+
+  /*
+    Adjacency tables of one mesh topology. A table is built once by the
+    first caller, readers never lock.
+   */
+  class MeshAccess::TopologyCache
+  {
+    mutex build_mutex;
+    atomic<Table<int>*> tables[6];   // vertex-elements VOL..BBBND, facet-elements, neighbours
+  public:
+    enum { FACET_ELEMENTS = 4, ELEMENT_NEIGHBOURS = 5 };
+
+    TopologyCache ()
+    {
+      for (auto & t : tables) t = nullptr;
+    }
+    ~TopologyCache ()
+    {
+      for (auto & t : tables) delete t.load();
+    }
+
+    FlatTable<int> * Get (int nr) const
+    { return tables[nr].load(memory_order_acquire); }
+
+    template <typename TBUILD>
+    FlatTable<int> & Get (int nr, TBUILD build)
+    {
+      if (auto tab = tables[nr].load(memory_order_acquire))
+        return *tab;
+      lock_guard<mutex> guard(build_mutex);
+      if (auto tab = tables[nr].load(memory_order_acquire))
+        return *tab;
+      auto tab = new Table<int> (build());
+      tables[nr].store (tab, memory_order_release);
+      return *tab;
+    }
+
+    /// row i collects all j with i in keys(j), rows are sorted
+    template <typename TKEYS>
+    static Table<int> Invert (size_t nrows, size_t n, TKEYS keys)
+    {
+      Array<int> cnt(nrows);
+      ParallelFor (nrows, [&] (size_t i) { cnt[i] = 0; });
+      ParallelFor (n, [&] (size_t j)
+                   {
+                     for (auto i : keys(j))
+                       AsAtomic(cnt[i])++;
+                   });
+      Table<int> tab(cnt);
+      ParallelFor (nrows, [&] (size_t i) { cnt[i] = 0; });
+      ParallelFor (n, [&] (size_t j)
+                   {
+                     for (auto i : keys(j))
+                       tab[i][AsAtomic(cnt[i])++] = j;
+                   });
+      ParallelFor (nrows, [&] (size_t i) { QuickSort (tab[i]); });
+      return tab;
+    }
+  };
+
+
+  template <int D>
+  static bool T_LocalCoordinates (const ElementTransformation & trafo, Vec<D> p,
+                                  IntegrationPoint & ip)
+  {
+    ELEMENT_TYPE et = trafo.GetElementType();
+    int nv = ElementTopology::GetNVertices(et);
+    const POINT3D * verts = ElementTopology::GetVertices(et);
+    Vec<D> xi = 0.0;
+    for (int i = 0; i < nv; i++)
+      for (int j = 0; j < D; j++)
+        xi(j) += verts[i][j] / nv;
+
+    // Newton's method, converges in one step for affine elements
+    Vec<D> x;
+    Mat<D,D> jac;
+    bool converged = false;
+    for (int it = 0; it < 20; it++)
+      {
+        trafo.CalcPointJacobian (IntegrationPoint(xi), x, jac);
+        Vec<D> dxi = Inv(jac) * (p-x);
+        xi += dxi;
+        if (L2Norm(dxi) < 1e-12) { converged = true; break; }
+        if (L2Norm(xi) > 10) return false;
+      }
+    if (!converged) return false;
+
+    constexpr double eps = 1e-10;
+    Vec<3> l = 0.0;
+    for (int j = 0; j < D; j++) l(j) = xi(j);
+    bool inside = false;
+    switch (et)
+      {
+      case ET_SEGM:
+        inside = l(0) > -eps && l(0) < 1+eps; break;
+      case ET_TRIG:
+        inside = l(0) > -eps && l(1) > -eps && l(0)+l(1) < 1+eps; break;
+      case ET_QUAD:
+        inside = l(0) > -eps && l(1) > -eps && l(0) < 1+eps && l(1) < 1+eps; break;
+      case ET_TET:
+        inside = l(0) > -eps && l(1) > -eps && l(2) > -eps && l(0)+l(1)+l(2) < 1+eps; break;
+      case ET_PRISM:
+        inside = l(0) > -eps && l(1) > -eps && l(0)+l(1) < 1+eps && l(2) > -eps && l(2) < 1+eps; break;
+      case ET_PYRAMID:
+        inside = l(2) > -eps && l(2) < 1+eps && l(0) > -eps && l(1) > -eps &&
+          l(0) < 1-l(2)+eps && l(1) < 1-l(2)+eps; break;
+      case ET_HEX:
+        inside = l(0) > -eps && l(1) > -eps && l(2) > -eps && l(0) < 1+eps && l(1) < 1+eps && l(2) < 1+eps; break;
+      default:
+        break;
+      }
+    ip = IntegrationPoint (l(0), l(1), l(2), 0);
+    return inside;
+  }
   
   
   string Ngs_Element::defaultstring = "default";
@@ -207,6 +552,11 @@ namespace ngcomp
       // static Timer t("eltrans::multipointjacobian"); RegionTimer reg(t);
       SIMD_MappedIntegrationRule<DIMS,DIMR> & mir = 
 	static_cast<SIMD_MappedIntegrationRule<DIMS,DIMR> &> (bmir);
+
+      // with a mesh deformation the cache holds the deformed geometry (ALE_ElementTransformation)
+      auto cache = mesh->GetDeformation() ? nullptr : mesh->GetGeometryCache();
+      if (cache && cache->Get (GetElementId(), ir, mir))
+        return;
       
       mesh->mesh.MultiElementTransformation <DIMS,DIMR>
         (elnr, ir.Size(),
@@ -216,6 +566,9 @@ namespace ngcomp
       
       for (int i = 0; i < ir.Size(); i++)
         mir[i].Compute();
+
+      if (cache)
+        cache->Put (GetElementId(), ir, mir);
     }
 
     virtual const ElementTransformation & VAddDeformation (const GridFunction * gf, LocalHeap & lh) const override
@@ -233,6 +586,7 @@ namespace ngcomp
   template <int DIMS, int DIMR, typename BASE>
   class ALE_ElementTransformation : public BASE
   {
+    const MeshAccess * ma;
     const GridFunction * deform;
     const ScalarFiniteElement<DIMS> * fel;
     FlatVector<> elvec;
@@ -243,7 +597,7 @@ namespace ngcomp
                                const GridFunction * adeform,
                                LocalHeap & lh)
       : BASE(amesh, aet, ei, elindex), 
-        deform(adeform) 
+        ma(amesh), deform(adeform) 
     {
       this->iscurved = true;
 
@@ -335,42 +689,41 @@ namespace ngcomp
     virtual void CalcPointJacobian (const IntegrationPoint & ip,
 				    FlatVector<> point, FlatMatrix<> dxdxi) const override
     {
-      CalcJacobian (ip, dxdxi);
-      CalcPoint (ip, point);
-      // this->mesh->mesh.ElementTransformation <DIMS,DIMR> (elnr, &ip(0), &point(0), &dxdxi(0));
+      BASE::CalcPointJacobian (ip, point, dxdxi);
+
+      // shapes and derivatives once for all components
+      size_t nds = fel->GetNDof();
+      STACK_ARRAY(double, mem, (DIMS+1)*nds);
+      FlatVector<> shape(nds, &mem[0]);
+      FlatMatrix<> dshape(nds, DIMS, &mem[nds]);
+      fel->CalcShape (ip, shape);
+      fel->CalcDShape (ip, dshape);
+      FlatMatrixFixWidth<DIMR> coefs(nds, elvec.Data());
+      point += Trans(coefs) * shape;
+      dxdxi += Trans(coefs) * dshape;
     }
 
     virtual void CalcMultiPointJacobian (const IntegrationRule & ir,
 					 BaseMappedIntegrationRule & bmir) const override
     {
-      if (sizeof(IntegrationPoint) % 8 != 0)
-        {
-          cerr << "Integration must should have 8-byte alignment" << endl;
-          exit(1);
-        }
-
       MappedIntegrationRule<DIMS,DIMR> & mir = 
 	static_cast<MappedIntegrationRule<DIMS,DIMR> &> (bmir);
 
-      for (int i = 0; i < ir.Size(); i++)
+      BASE::CalcMultiPointJacobian (ir, bmir);
+
+      size_t nds = fel->GetNDof();
+      STACK_ARRAY(double, mem, (DIMS+1)*nds);
+      FlatVector<> shape(nds, &mem[0]);
+      FlatMatrix<> dshape(nds, DIMS, &mem[nds]);
+      FlatMatrixFixWidth<DIMR> coefs(nds, elvec.Data());
+      for (size_t i = 0; i < ir.Size(); i++)
         {
-          CalcPointJacobian (ir[i], mir[i].Point(), mir[i].Jacobian());
+          fel->CalcShape (ir[i], shape);
+          fel->CalcDShape (ir[i], dshape);
+          mir[i].Point() += Trans(coefs) * shape;
+          mir[i].Jacobian() += Trans(coefs) * dshape;
           mir[i].Compute();
         }
-
-      /*
-      MappedIntegrationRule<DIMS,DIMR> & mir = 
-	static_cast<MappedIntegrationRule<DIMS,DIMR> &> (bmir);
-      mesh->mesh.MultiElementTransformation <DIMS,DIMR> (elnr, ir.Size(),
-                                                         &ir[0](0), &ir[1](0)-&ir[0](0),
-                                                         &mir[0].Point()(0), 
-                                                         &mir[1].Point()(0)-&mir[0].Point()(0), 
-                                                         &mir[0].Jacobian()(0,0), 
-                                                         &mir[1].Jacobian()(0,0)-&mir[0].Jacobian()(0,0));
-    
-      for (int i = 0; i < ir.Size(); i++)
-        mir[i].Compute();
-      */
     }
     
     virtual void CalcMultiPointJacobian (const SIMD_IntegrationRule & ir,
@@ -378,29 +731,36 @@ namespace ngcomp
     {
       SIMD_MappedIntegrationRule<DIMS,DIMR> & mir = 
 	static_cast<SIMD_MappedIntegrationRule<DIMS,DIMR> &> (bmir);
+
+      // deformed geometry is cached only for the mesh deformation, see SetGeometryCache
+      auto cache = (deform == ma->GetDeformation().get()) ? ma->GetGeometryCache() : nullptr;
+      if (cache && cache->Get (this->GetElementId(), ir, mir))
+        return;
       
       BASE::CalcMultiPointJacobian (ir, bmir);
 
-      STACK_ARRAY(SIMD<double>, mem0, ir.Size());
-      FlatVector<SIMD<double>> def(ir.Size(), &mem0[0]);
-      STACK_ARRAY(SIMD<double>, mem1, (DIMS*ir.Size()));
-      FlatMatrix<SIMD<double>> grad(DIMS, ir.Size(), &mem1[0]);
+      STACK_ARRAY(SIMD<double>, mem0, DIMR*ir.Size());
+      FlatMatrix<SIMD<double>> def(DIMR, ir.Size(), &mem0[0]);
+      STACK_ARRAY(SIMD<double>, mem1, DIMR*DIMS*ir.Size());
+      FlatMatrix<SIMD<double>> grad(DIMR*DIMS, ir.Size(), &mem1[0]);
 
-      for (int i = 0; i < DIMR; i++)
-        {
-          fel->Evaluate (ir, elvec.Slice(i,DIMR), def);
-          fel->EvaluateGrad (ir, elvec.Slice(i,DIMR), grad);
+      // all components with one pass over the shapes
+      size_t nds = fel->GetNDof();
+      fel->EvaluateValueGrad (ir, SliceMatrix<> (nds, DIMR, DIMR, elvec.Data()), def, grad);
           
-          for (size_t k = 0; k < ir.Size(); k++)
-            {
-              mir[k].Point()(i) += def(k);
-              for (int j = 0; j < DIMS; j++)
-                mir[k].Jacobian()(i,j) += grad(j,k);
-            }
-        }
+      for (size_t k = 0; k < ir.Size(); k++)
+        for (int i = 0; i < DIMR; i++)
+          {
+            mir[k].Point()(i) += def(i,k);
+            for (int j = 0; j < DIMS; j++)
+              mir[k].Jacobian()(i,j) += grad(i*DIMS+j,k);
+          }
       
       for (int i = 0; i < ir.Size(); i++)
         mir[i].Compute();
+
+      if (cache)
+        cache->Put (this->GetElementId(), ir, mir);
     }
 
 
@@ -770,11 +1130,17 @@ namespace ngcomp
       Vec<DIMR,SIMD<double>> simd_p0(p0);
       Mat<DIMR,DIMS,SIMD<double>> simd_mat(mat);
 
+      // the Jacobian is constant, compute derived quantites once
       for (size_t i = 0; i < hir.Size(); i++)
         {
           hmir[i].Point() = simd_p0 + simd_mat * FlatVec<DIMS, const SIMD<double>> (&hir[i](0));
-          hmir[i].Jacobian() = simd_mat;
-          hmir[i].Compute();
+          if (i == 0)
+            {
+              hmir[0].Jacobian() = simd_mat;
+              hmir[0].Compute();
+            }
+          else
+            hmir[i].CopyJacobian (hmir[0]);
         }
     }
     virtual const ElementTransformation & VAddDeformation (const GridFunction * gf, LocalHeap & lh) const override
@@ -852,6 +1218,39 @@ namespace ngcomp
     mesh.SaveMesh (str);
   }
 
+  size_t MeshAccess :: GetHash () const
+  {
+    static Timer t("MeshAccess::GetHash"); RegionTimer reg(t);
+    size_t h = GetDimension();
+    HashCombine (h, GetNV());
+    // sums of the hashes of points and elements, independent of the partitioning
+    auto add = [] (size_t a, size_t b) { return a+b; };
+    HashCombine (h, ParallelReduce (GetNV(), [&] (size_t i)
+                                    {
+                                      size_t hi = 0;
+                                      HashCombine (hi, i);
+                                      auto p = GetPoint<3> (i);
+                                      for (int j = 0; j < 3; j++)
+                                        HashCombine (hi, std::hash<double>() (p(j)));
+                                      return hi;
+                                    }, add, size_t(0)));
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      {
+        HashCombine (h, GetNE(vb));
+        HashCombine (h, ParallelReduce (GetNE(vb), [&] (size_t i)
+                                        {
+                                          ElementId ei(vb, i);
+                                          size_t hi = 0;
+                                          HashCombine (hi, i);
+                                          HashCombine (hi, GetElIndex(ei));
+                                          for (auto v : GetElVertices(ei))
+                                            HashCombine (hi, v);
+                                          return hi;
+                                        }, add, size_t(0)));
+      }
+    return h;
+  }
+
   void MeshAccess :: DoArchive(Archive& ar)
   {
     auto mshptr = mesh.GetMesh();
@@ -919,6 +1318,7 @@ namespace ngcomp
     mesh_timestamp = netgen_mesh_timestamp;
     
     timestamp = NGS_Object::GetNextTimeStamp();
+    topology = make_shared<TopologyCache>();
     
 
     dim = mesh.GetDimension();
@@ -1139,6 +1539,10 @@ namespace ngcomp
       }
     
     CalcIdentifiedFacets();
+
+    if (geometry_cache)
+      geometry_cache = make_shared<GeometryCache> (*this);
+    atomic_store (&point_locator, shared_ptr<PointLocator>());
   }
 
   void MeshAccess :: 
@@ -1443,6 +1847,77 @@ namespace ngcomp
     */
   }
 
+  void MeshAccess :: GetFacetElements (int fnr, Array<int> & elnums) const
+  {
+    if (topology)
+      if (auto tab = topology->Get(TopologyCache::FACET_ELEMENTS))
+        {
+          elnums = (*tab)[fnr];
+          return;
+        }
+    switch (dim)
+      {
+      case 1: elnums = GetVertexElements (fnr); break;
+      case 2: GetEdgeElements (fnr, elnums); break;
+      case 3: GetFaceElements (fnr, elnums); break;
+      }
+  }
+
+  FlatTable<int> MeshAccess :: GetVertexElementTable (VorB vb) const
+  {
+    if (!topology) return FlatTable<int> (0, nullptr, nullptr);
+    return topology->Get
+      (vb, [&] ()
+       {
+         static Timer t("MeshAccess::GetVertexElementTable"); RegionTimer reg(t);
+         return TopologyCache::Invert (GetNV(), GetNE(vb), [&] (size_t i)
+                                       { return GetElement(ElementId(vb, i)).Vertices(); });
+       });
+  }
+
+  FlatTable<int> MeshAccess :: GetFacetElementTable () const
+  {
+    if (!topology) return FlatTable<int> (0, nullptr, nullptr);
+    return topology->Get
+      (TopologyCache::FACET_ELEMENTS, [&] ()
+       {
+         static Timer t("MeshAccess::GetFacetElementTable"); RegionTimer reg(t);
+         return TopologyCache::Invert (GetNFacets(), GetNE(VOL), [&] (size_t i)
+                                       { return GetElement(ElementId(VOL, i)).Facets(); });
+       });
+  }
+
+  FlatTable<int> MeshAccess :: GetElementNeighbourTable () const
+  {
+    if (!topology) return FlatTable<int> (0, nullptr, nullptr);
+    auto f2el = GetFacetElementTable();
+    return topology->Get
+      (TopologyCache::ELEMENT_NEIGHBOURS, [&] ()
+       {
+         static Timer t("MeshAccess::GetElementNeighbourTable"); RegionTimer reg(t);
+         size_t ne = GetNE(VOL);
+         // each row is written by its own element, no atomics needed
+         Array<int> cnt(ne);
+         ParallelFor (ne, [&] (size_t i)
+                      {
+                        int c = 0;
+                        for (auto f : GetElement(ElementId(VOL, i)).Facets())
+                          c += f2el[f].Size()-1;
+                        cnt[i] = c;
+                      });
+         Table<int> tab(cnt);
+         ParallelFor (ne, [&] (size_t i)
+                      {
+                        int c = 0;
+                        for (auto f : GetElement(ElementId(VOL, i)).Facets())
+                          for (auto el : f2el[f])
+                            if (el != int(i)) tab[i][c++] = el;
+                        QuickSort (tab[i]);
+                      });
+         return tab;
+       });
+  }
+
     void MeshAccess :: SetDeformation (shared_ptr<GridFunction> def)
     {
       if (def)
@@ -1453,6 +1928,17 @@ namespace ngcomp
             throw Exception ("Mesh::SetDeformation needs a GridFunction with dim="+ToString(dim));
         }
       deformation = def;
+      if (geometry_cache)   // cached points and Jacobians belong to the old deformation
+        geometry_cache = make_shared<GeometryCache> (*this);
+      atomic_store (&point_locator, shared_ptr<PointLocator>());
+    }
+  
+    void MeshAccess :: SetGeometryCache (bool enable)
+    {
+      if (enable)
+        geometry_cache = make_shared<GeometryCache> (*this);
+      else
+        geometry_cache = nullptr;
     }
   
     void MeshAccess :: SetPML (const shared_ptr<PML_Transformation> & pml_trafo, int _domnr)
@@ -1855,6 +2341,68 @@ namespace ngcomp
   }
 
 
+  int MeshAccess :: FindElementOfPoint (FlatVector<double> point, IntegrationPoint & ip,
+                                        int hint, LocalHeap & lh) const
+  {
+    auto locator = GetPointLocator();
+    Vec<3> p = 0.0;
+    for (int k = 0; k < dim; k++)
+      p(k) = point(k);
+
+    auto contains = [&] (int elnr)
+      {
+        HeapReset hr(lh);
+        auto & trafo = GetTrafo (ElementId(VOL, elnr), lh);
+        switch (dim)
+          {
+          case 1: return T_LocalCoordinates<1> (trafo, Vec<1>(p(0)), ip);
+          case 2: return T_LocalCoordinates<2> (trafo, Vec<2>(p(0), p(1)), ip);
+          default: return T_LocalCoordinates<3> (trafo, p, ip);
+          }
+      };
+
+    if (hint >= 0 && size_t(hint) < GetNE(VOL) && locator->InBox(hint, p) && contains(hint))
+      return hint;
+    for (int elnr : locator->Candidates(p))
+      if (elnr != hint && locator->InBox(elnr, p) && contains(elnr))
+        return elnr;
+    return -1;
+  }
+
+  void MeshAccess :: FindElementsOfPoints (SliceMatrix<double> points, FlatArray<int> elnrs,
+                                           FlatArray<IntegrationPoint> ips) const
+  {
+    static Timer t("MeshAccess::FindElementsOfPoints"); RegionTimer reg(t);
+    GetPointLocator();
+    ParallelForRange
+      (points.Height(), [&] (IntRange r)
+       {
+         LocalHeap lh(100000, "FindElementsOfPoints");
+         int hint = -1;
+         for (size_t i : r)
+           {
+             elnrs[i] = FindElementOfPoint (points.Row(i), ips[i], hint, lh);
+             if (elnrs[i] >= 0) hint = elnrs[i];
+           }
+       });
+  }
+
+  shared_ptr<MeshAccess::PointLocator> MeshAccess :: GetPointLocator () const
+  {
+    auto locator = atomic_load (&point_locator);
+    if (locator) return locator;
+
+    static mutex build_mutex;
+    lock_guard<mutex> guard(build_mutex);
+    locator = atomic_load (&point_locator);
+    if (!locator)
+      {
+        locator = make_shared<PointLocator> (*this);
+        atomic_store (&point_locator, locator);
+      }
+    return locator;
+  }
+
   int MeshAccess :: FindSurfaceElementOfPoint (FlatVector<double> point,
 					       IntegrationPoint & ip, 
 					       bool build_searchtree,
@@ -1955,7 +2503,16 @@ namespace ngcomp
 
   void MeshAccess :: Curve (int order)
   {
-    mesh.Curve(order);
+    static Timer t("MeshAccess::Curve"); RegionTimer reg(t);
+    // netgen curves the edges and faces in parallel loops of the ngcore
+    // task-manager, start it for the call if it is not running
+    if (!task_manager)
+      RunWithTaskManager ([&] () { mesh.Curve(order); });
+    else
+      mesh.Curve(order);
+    if (geometry_cache)
+      geometry_cache = make_shared<GeometryCache> (*this);
+    atomic_store (&point_locator, shared_ptr<PointLocator>());
   } 
   
   int MeshAccess :: GetCurveOrder ()
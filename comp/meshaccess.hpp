@@ -234,6 +234,18 @@ namespace ngcomp
 
     /// pml trafos per sub-domain
     Array<shared_ptr <PML_Transformation>> pml_trafos;
+
+  public:
+    class GeometryCache;
+    class PointLocator;
+    class TopologyCache;
+  private:
+    /// points and Jacobians of curved elements, shared ptr because copy constructible
+    shared_ptr<GeometryCache> geometry_cache;
+    /// search grid for FindElementsOfPoints, built at first use
+    mutable shared_ptr<PointLocator> point_locator;
+    /// adjacency tables, built at first use, replaced when the topology changes
+    shared_ptr<TopologyCache> topology;
     
     Array<std::tuple<int,int>> identified_facets;
 
@@ -676,6 +688,15 @@ namespace ngcomp
       return deformation;
     }
 
+    /**
+       Keeps points and Jacobians of curved elements at the first 
+       SIMD integration rule evaluated on each element, for repeated 
+       assembly and matrix-free operator application. 
+       The cache is cleared when the mesh is changed.
+     */
+    void SetGeometryCache (bool enable);
+    GeometryCache * GetGeometryCache () const { return geometry_cache.get(); }
+
     void SetPML (const shared_ptr<PML_Transformation> & pml_trafo, int _domnr);
     void UnSetPML (int _domnr);
 
@@ -871,16 +892,8 @@ namespace ngcomp
     ELEMENT_TYPE GetFaceType (int fnr) const
     { return (mesh.GetNode<2>(fnr).vertices.Size() == 3) ? ET_TRIG : ET_QUAD; }
     ELEMENT_TYPE GetFacetType (int fnr) const;    
-    /// elements connected to facet
-    void GetFacetElements (int fnr, Array<int> & elnums) const
-    {
-      switch (dim)
-        {
-        case 1: elnums = GetVertexElements (fnr); break;
-        case 2: GetEdgeElements (fnr, elnums); break;
-        case 3: GetFaceElements (fnr, elnums); break;
-        }
-    }
+    /// elements connected to facet, taken from the facet-element table if it is built
+    void GetFacetElements (int fnr, Array<int> & elnums) const;
     void GetFacetSurfaceElements (int fnr, Array<int> & elnums) const
     {
       switch (dim)
@@ -891,6 +904,19 @@ namespace ngcomp
         }
     }
 
+    /**
+       Cached adjacency tables, built in parallel at first use and
+       valid until the next topology change (see GetTimeStamp).
+       Rows are sorted. Building is thread safe, but better call
+       them once outside of parallel loops.
+    */
+    /// elements of type vb containing vertex v
+    FlatTable<int> GetVertexElementTable (VorB vb = VOL) const;
+    /// volume elements containing facet f
+    FlatTable<int> GetFacetElementTable () const;
+    /// volume elements sharing a facet with volume element el
+    FlatTable<int> GetElementNeighbourTable () const;
+
     void CalcIdentifiedFacets();
     int GetPeriodicFacet(int fnr) const
     {
@@ -1041,6 +1067,18 @@ namespace ngcomp
 			    IntegrationPoint & ip, 
 			    bool build_searchtree,
 			    int index) const;
+    /// volume element containing the point, the hint element is tried first. Thread safe
+    int FindElementOfPoint (FlatVector<double> point, IntegrationPoint & ip,
+                            int hint, LocalHeap & lh) const;
+    /**
+       Volume elements containing the points (rows of the matrix), -1 if outside.
+       Points are located in parallel, using the element of the previous point as hint.
+       The search grid is kept until the mesh is changed.
+     */
+    void FindElementsOfPoints (SliceMatrix<double> points, FlatArray<int> elnrs,
+                               FlatArray<IntegrationPoint> ips) const;
+    shared_ptr<PointLocator> GetPointLocator () const;
+    
     int FindSurfaceElementOfPoint (FlatVector<double> point,
 				   IntegrationPoint & ip, 
 				   bool build_searchtree,
@@ -1107,6 +1145,8 @@ namespace ngcomp
     // void LoadMesh (istream & str);
     void SaveMesh (ostream & str) const;
     void DoArchive(Archive& ar);
+    /// hash of points, element vertices and indices, validates setup cache files
+    size_t GetHash () const;
     // void LoadMeshFromString(const string & str);
 
     // void PrecomputeGeometryData(int intorder);
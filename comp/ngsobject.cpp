@@ -135,6 +135,14 @@ void NGS_Object :: PrintReport (ostream & ost) const
     cout << "MemoryUsage not overloaded for class " << GetClassName() << endl;
     return Array<MemoryUsage>();
   }
+
+  size_t NGS_Object :: GetMemoryBytes () const
+  {
+    size_t sum = 0;
+    for (auto & mu : GetMemoryUsage())
+      sum += mu.NBytes();
+    return sum;
+  }
   
  
 } // namespace
@@ -54,6 +54,9 @@ namespace ngcomp
     /// timestamp of ngs-objects
     static size_t global_timestamp;
     size_t timestamp = 0;
+
+    /// maximal accounted memory seen by UpdateMemoryPeak
+    mutable size_t memory_peak = 0;
   public:
 
     /// 
@@ -93,6 +96,11 @@ namespace ngcomp
     virtual string GetClassName () const;
     virtual void PrintReport (ostream & ost) const;
     virtual Array<MemoryUsage> GetMemoryUsage () const;
+    /// sum of GetMemoryUsage
+    size_t GetMemoryBytes () const;
+    /// maximum of the accounted memory at the calls of UpdateMemoryPeak
+    size_t GetMemoryPeak () const { return memory_peak; }
+    void UpdateMemoryPeak () const { memory_peak = max2 (memory_peak, GetMemoryBytes()); }
     
     Timer & GetTimer () { return timer; }
     const Timer & GetTimer () const { return timer; }
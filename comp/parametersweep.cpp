@@ -0,0 +1,143 @@
+/*********************************************************************/
+/* File:   parametersweep.cpp                                        */
+/* Author: Joachim Schoeberl                                         */
+/* Date:   Oct. 2026                                                 */
+/*********************************************************************/
+
+/*
+   independent solves for many parameter values, one worker per thread
+*/
+
+#include <comp.hpp>
+#include "parametersweep.hpp"
+
+namespace ngcomp
+{
+
+  ParameterSweep :: ParameterSweep (shared_ptr<BilinearForm> abfa, shared_ptr<LinearForm> alff,
+                                    Array<shared_ptr<ParameterCoefficientFunction>> aparams,
+                                    shared_ptr<BitArray> afreedofs, string ainverse,
+                                    size_t aheapsize)
+    : bfa(abfa), lff(alff), params(aparams), freedofs(afreedofs),
+      inverse(ainverse), heapsize(aheapsize)
+  {
+    if (bfa->IsComplex() || bfa->GetFESpace()->IsComplex())
+      throw Exception ("ParameterSweep: only real forms");
+    if (bfa->GetFESpace2())
+      throw Exception ("ParameterSweep: no mixed bilinear-forms");
+    if (bfa->GetFESpace() != lff->GetFESpace())
+      throw Exception ("ParameterSweep: bilinear-form and linear-form on different spaces");
+    if (bfa->UsesEliminateInternal())
+      throw Exception ("ParameterSweep: static condensation is not supported");
+    if (bfa->HasSpecialIntegrators())
+      throw Exception ("ParameterSweep: only integrators, no special elements");
+    // the workers take samples in arbitrary order, no collective operations
+    if (bfa->GetFESpace()->IsParallel())
+      throw Exception ("ParameterSweep: not for MPI-distributed spaces");
+    if (!freedofs)
+      freedofs = bfa->GetFESpace()->GetFreeDofs();
+  }
+
+
+  namespace
+  {
+    // own forms and factorization of a worker
+    struct SweepWorker
+    {
+      shared_ptr<BilinearForm> bfa;
+      shared_ptr<LinearForm> lff;
+      shared_ptr<BaseMatrix> inv;
+    };
+
+    // thread values of the parameters while the sweep runs, also if it throws
+    class ThreadValuesGuard
+    {
+      FlatArray<shared_ptr<ParameterCoefficientFunction>> params;
+    public:
+      ThreadValuesGuard (FlatArray<shared_ptr<ParameterCoefficientFunction>> aparams)
+        : params(aparams)
+      {
+        for (auto p : params) p->SetThreadValues (true);
+      }
+      ~ThreadValuesGuard ()
+      {
+        for (auto p : params) p->SetThreadValues (false);
+      }
+    };
+  }
+
+
+  Matrix<double> ParameterSweep :: Run (FlatMatrix<double> values, MultiVector * solutions) const
+  {
+    static Timer t("ParameterSweep::Run"); RegionTimer reg(t);
+
+    auto fes = bfa->GetFESpace();
+    size_t nsamples = values.Height();
+    if (values.Width() != params.Size())
+      throw Exception ("ParameterSweep: values have " + ToString(values.Width()) +
+                       " columns, but there are " + ToString(params.Size()) + " parameters");
+    if (solutions && solutions->NumVectors() < nsamples)
+      throw Exception ("ParameterSweep: solutions have less vectors than samples");
+
+    Flags bflags = bfa->GetFlags();
+    bflags.SetFlag ("reuse_graph");
+
+    int nworkers = TaskManager::GetNumThreads();
+    Array<SweepWorker> workers(nworkers);
+    for (auto & w : workers)
+      {
+        w.bfa = CreateBilinearForm (fes, bfa->GetName()+"_sweep", bflags);
+        for (auto bfi : bfa->Integrators())
+          w.bfa->AddIntegrator (bfi);
+        w.lff = CreateLinearForm (fes, lff->GetName()+"_sweep", lff->GetFlags());
+        for (auto lfi : lff->Integrators())
+          w.lff->AddIntegrator (lfi);
+        w.lff->AllocateVector();
+      }
+    // the graph is computed once and cached, the workers copy it
+    delete workers[0].bfa->GetGraph (fes->GetMeshAccess()->GetNLevels()-1, bfa->IsSymmetric());
+
+    Matrix<double> results(nsamples, outputs.Size());
+    ThreadValuesGuard guard(params);
+    atomic<size_t> next(0);
+
+    // nested parallel loops of assembly and factorization run sequentially in the worker
+    ParallelJob ([&] (const TaskInfo & ti)
+      {
+        auto & w = workers[ti.task_nr];
+        LocalHeap lh(heapsize, "ParameterSweep - worker", true);
+        auto u = w.lff->GetVector().CreateVector();
+
+        for (size_t i = next++; i < nsamples; i = next++)
+          {
+            for (size_t j : Range(params))
+              params[j]->SetThreadValue (values(i,j));
+
+            w.bfa->Assemble (lh);
+            w.lff->Assemble (lh);
+
+            // same graph as the previous sample, the symbolic factorization is kept
+            auto fact = dynamic_pointer_cast<SparseFactorization> (w.inv);
+            if (fact && fact->SupportsUpdate())
+              fact->Update();
+            else
+              {
+                auto & mat = w.bfa->GetMatrix();
+                if (inverse.length())
+                  mat.SetInverseType (inverse);
+                w.inv = mat.InverseMatrix (freedofs);
+              }
+
+            u = (*w.inv) * w.lff->GetVector();
+            for (size_t k : Range(outputs))
+              results(i,k) = outputs[k]->InnerProductD (u);
+            if (solutions)
+              (*solutions)[i] = u.FVDouble();
+          }
+      }, nworkers);
+
+    cout << IM(3) << "ParameterSweep: " << nsamples << " samples on " << nworkers << " workers" << endl;
+    return results;
+  }
+
+}
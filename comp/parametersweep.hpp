@@ -0,0 +1,54 @@
+#ifndef FILE_PARAMETERSWEEP
+#define FILE_PARAMETERSWEEP
+
+/*********************************************************************/
+/* File:   parametersweep.hpp                                        */
+/* Author: Joachim Schoeberl                                         */
+/* Date:   Oct. 2026                                                 */
+/*********************************************************************/
+
+namespace ngcomp
+{
+
+  /**
+     Many independent solves of one problem for different values of
+     its Parameters, e.g. material parameter sweeps.
+
+     Every thread of the task manager is a worker. A worker takes the
+     next sample, sets its thread values of the Parameters, assembles
+     its own copy of the bilinear-form and linear-form and solves;
+     inside a worker, assembly and solving run sequentially. The copies
+     share the FESpace and the matrix graph (flag reuse_graph), and the
+     factorization of a worker is only numerically updated, so the
+     symbolic factorization is computed once per worker.
+  */
+  class NGS_DLL_HEADER ParameterSweep
+  {
+    shared_ptr<BilinearForm> bfa;
+    shared_ptr<LinearForm> lff;
+    Array<shared_ptr<ParameterCoefficientFunction>> params;
+    Array<shared_ptr<BaseVector>> outputs;
+    shared_ptr<BitArray> freedofs;
+    string inverse;
+    size_t heapsize;
+  public:
+    ParameterSweep (shared_ptr<BilinearForm> abfa, shared_ptr<LinearForm> alff,
+                    Array<shared_ptr<ParameterCoefficientFunction>> aparams,
+                    shared_ptr<BitArray> afreedofs = nullptr, string ainverse = "",
+                    size_t aheapsize = 10000000);
+
+    /// output functional out * u, evaluated for every sample
+    void AddOutput (shared_ptr<BaseVector> out) { outputs.Append (out); }
+    size_t NumOutputs () const { return outputs.Size(); }
+
+    /**
+       Solves for every row of values (one column per Parameter).
+       Returns the outputs, one row per sample. If solutions is given,
+       solution i is stored as its vector i.
+    */
+    Matrix<double> Run (FlatMatrix<double> values, MultiVector * solutions = nullptr) const;
+  };
+
+}
+
+#endif
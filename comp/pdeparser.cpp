@@ -5,13 +5,6 @@
 #include <parallelngs.hpp>
 
 
-#ifdef HAVE_DLFCN_H 
-#include <dlfcn.h>
-#else
-#include <windows.h>
-#endif
-
-
 #ifdef NGS_PYTHON
 #include "../ngstd/python_ngstd.hpp"
 extern PythonEnvironment pyenv;
@@ -86,6 +79,8 @@ namespace ngcomp
     SymbolTable<TOKEN_TYPE> keywords;
     SymbolTable<int> integrators;
     SymbolTable<int> numprocs;
+    /// registered classes when the tables were set up, libraries may add more
+    size_t nregistered = 0;
 
     int linenum;
 
@@ -96,6 +91,8 @@ namespace ngcomp
     void HandleStringConstants(void);
 
   public:
+    /// integrator and numproc names, updated after shared libraries are loaded
+    void UpdateRegistered();
     istream * scanin;
 
     PDEScanner (istream * ascanin);
@@ -140,17 +137,7 @@ namespace ngcomp
 	kwp++;
       }
 
-    // initialize integrator and numproc keywords:
-
-    Integrators & itgs = GetIntegrators();
-    for (auto bfi_register : itgs.GetBFIs())
-      integrators.Set (bfi_register->name, 1);
-    for (auto lfi_register : itgs.GetLFIs())
-      integrators.Set (lfi_register->name, 1);
-
-    NumProcs & nps = GetNumProcs();
-    for (auto np_register : nps.GetNumProcs())
-      numprocs.Set (np_register->name, 1);
+    UpdateRegistered();
 
     HandleStringConstants();
     scanin = new stringstream(copy_of_stream);
@@ -161,6 +148,22 @@ namespace ngcomp
     delete scanin;
   }
 
+  void PDEScanner :: UpdateRegistered()
+  {
+    Integrators & itgs = GetIntegrators();
+    NumProcs & nps = GetNumProcs();
+    size_t nreg = itgs.GetBFIs().Size() + itgs.GetLFIs().Size() + nps.GetNumProcs().Size();
+    if (nreg == nregistered) return;
+
+    for (auto bfi_register : itgs.GetBFIs())
+      integrators.Set (bfi_register->name, 1);
+    for (auto lfi_register : itgs.GetLFIs())
+      integrators.Set (lfi_register->name, 1);
+    for (auto np_register : nps.GetNumProcs())
+      numprocs.Set (np_register->name, 1);
+    nregistered = nreg;
+  }
+
   // replace $(variable)
   void PDEScanner :: HandleStringConstants(void)
   {
@@ -398,30 +401,14 @@ namespace ngcomp
 
           
           
-          Integrators & itgs = GetIntegrators();
-          for (int i = 0; i < itgs.GetBFIs().Size(); i++)
-            if (itgs.GetBFIs()[i]->name == string_value)
-              {
-                token = KW_INTEGRATOR;
-                return;
-              }
-          for (int i = 0; i < itgs.GetLFIs().Size(); i++)
-            if (itgs.GetLFIs()[i]->name == string_value)
-              {
-                token = KW_INTEGRATOR;
-                return;
-              }
-
-          // for (int i = 0; i < itgs.GetLFIs().Size(); i++)
-          // integrators.Set (itgs.GetLFIs()[i]->name, 1);
-
-          /*
-	  if (integrators.Used (string_value))
-	    {
-	      token = KW_INTEGRATOR;
-	      return;
-	    }
-          */
+          // a name of a lazy plugin loads it
+          if (LazyLibraries::Load (string_value))
+            UpdateRegistered();
+          if (integrators.Used (string_value))
+            {
+              token = KW_INTEGRATOR;
+              return;
+            }
 
 	  if (numprocs.Used (string_value))
 	    {
@@ -601,34 +588,15 @@ namespace ngcomp
               string shared = scan->GetStringValue();
 	      scan->ReadNext();
 
-              
-#ifdef HAVE_DLFCN_H
-#ifdef __APPLE__
-	      shared += ".dylib";
-#else
-	      shared += ".so";
-#endif
-              cout << IM(1) << "load shared library '" << shared << "'" << endl;
-
-              void * handle = dlopen (shared.c_str(), RTLD_LAZY | RTLD_GLOBAL);
-              if (!handle)
-                {
-                  stringstream err;
-                  err << "Cannot load shared library '" << shared << "' \nerrmsg: "  << dlerror();
-                  throw Exception (err.str());
-                }
-#else
-	      shared += ".dll";
-              cout << IM(1) << "load shared library '" << shared << "'" << endl;
-	      
-	      HINSTANCE handle = LoadLibrary (shared.c_str());
-	      if (!handle)
-		{
-		  stringstream err;
-                  err << "Cannot load shared library '" << shared << "' \nerrmsg: "; //   << dlerror();
-                  throw Exception (err.str());
-		}
-#endif
+              // shared = libname -provides=[name1,name2] defers loading to the first lookup
+              Flags flags;
+              CheckFlags (flags);
+              if (flags.StringListFlagDefined ("provides"))
+                for (auto & name : flags.GetStringListFlag ("provides"))
+                  LazyLibraries::Add (name, shared);
+              else
+                LoadSharedLibrary (shared);
+              scan->UpdateRegistered();
               break;
             }
 
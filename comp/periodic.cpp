@@ -21,6 +21,9 @@ namespace ngcomp {
           integrator[vb] = space->GetIntegrator(vb);
         }
       iscomplex = space->IsComplex();
+      // the remapped element dofs are stored in FinalizeUpdate
+      if (!flags.GetDefineFlagX("cache_dofnrs").IsFalse())
+        cache_dofnrs = true;
       // not yet working...
       if (space->LowOrderFESpacePtr() && false)
         {
@@ -132,6 +135,12 @@ namespace ngcomp {
   
   void PeriodicFESpace :: GetDofNrs(ElementId ei, Array<DofId> & dnums) const
     {
+      auto & tab = dof_table[ei.VB()];
+      if (tab.Size())
+        {
+          dnums = tab[ei.Nr()];
+          return;
+        }
       space->GetDofNrs(ei,dnums);
       for (auto & d : dnums)
         if (IsRegularDof(d)) d = dofmap[d];
@@ -182,6 +191,48 @@ namespace ngcomp {
     for(auto& md : master_dofs)
       md = {};
     PeriodicFESpace::Update();
+    BuildElementPhases();
+  }
+
+  template<typename TSCAL>
+  void QuasiPeriodicFESpace<TSCAL> :: BuildElementPhases()
+  {
+    static Timer t("QuasiPeriodicFESpace::BuildElementPhases"); RegionTimer reg(t);
+    for (auto vb : { VOL, BND, BBND, BBBND })
+      {
+        size_t ne = ma->GetNE(vb);
+        Array<int> cnt(ne);
+        auto iterate = [&] (auto func)
+          {
+            ParallelForRange
+              (ne, [&] (IntRange r)
+               {
+                 Array<DofId> dnums;
+                 for (auto i : r)
+                   {
+                     space->GetDofNrs (ElementId(vb, i), dnums);
+                     func (i, dnums);
+                   }
+               });
+          };
+        auto is_slave = [&] (DofId d) { return IsRegularDof(d) && dofmap[d] != d; };
+
+        iterate ([&] (size_t i, FlatArray<DofId> dnums)
+                 {
+                   cnt[i] = 0;
+                   for (auto d : dnums)
+                     if (is_slave(d)) cnt[i]++;
+                 });
+        Table<LocalPhase> table(cnt);
+        iterate ([&] (size_t i, FlatArray<DofId> dnums)
+                 {
+                   int k = 0;
+                   for (auto j : Range(dnums))
+                     if (is_slave(dnums[j]))
+                       table[i][k++] = LocalPhase { int(j), dof_factors[dnums[j]] };
+                 });
+        element_phases[vb] = move(table);
+      }
   }
 
   template<typename TSCAL>
@@ -192,17 +243,12 @@ namespace ngcomp {
     else
       {
         PeriodicFESpace::VTransformMR(ei, mat, tt);
-        Array<int> dofnrs;
-        space->GetDofNrs(ei, dofnrs);
-        for (int i : Range(dofnrs.Size()))
+        for (auto [i, factor] : element_phases[ei.VB()][ei.Nr()])
           {
-            if (dofnrs[i] != dofmap[dofnrs[i]])
-              {
-                if (tt & TRANSFORM_MAT_LEFT)
-                  mat.Row(i) *= dof_factors[dofnrs[i]];
-                if (tt & TRANSFORM_MAT_RIGHT)
-                  mat.Col(i) *= dof_factors[dofnrs[i]];
-              }
+            if (tt & TRANSFORM_MAT_LEFT)
+              mat.Row(i) *= factor;
+            if (tt & TRANSFORM_MAT_RIGHT)
+              mat.Col(i) *= factor;
           }
       }
   }
@@ -211,17 +257,12 @@ namespace ngcomp {
   void QuasiPeriodicFESpace<TSCAL> :: VTransformMC (ElementId ei, SliceMatrix<Complex> mat, TRANSFORM_TYPE tt) const
   {
     PeriodicFESpace::VTransformMC(ei, mat, tt);
-    Array<int> dofnrs;
-    space->GetDofNrs(ei, dofnrs);
-    for (int i : Range(dofnrs.Size()))
+    for (auto [i, factor] : element_phases[ei.VB()][ei.Nr()])
       {
-	if (dofnrs[i] != dofmap[dofnrs[i]])
-	  {
-	    if (tt & TRANSFORM_MAT_LEFT)
-	      mat.Row(i) *= conj(dof_factors[dofnrs[i]]);
-	    if (tt & TRANSFORM_MAT_RIGHT)
-	      mat.Col(i) *= dof_factors[dofnrs[i]];
-	  }
+        if (tt & TRANSFORM_MAT_LEFT)
+          mat.Row(i) *= conj(factor);
+        if (tt & TRANSFORM_MAT_RIGHT)
+          mat.Col(i) *= factor;
       }
   }
 
@@ -233,19 +274,14 @@ namespace ngcomp {
     else
       {
         PeriodicFESpace::VTransformVR(ei, vec, tt);
-        Array<int> dofnrs;
-        space->GetDofNrs(ei, dofnrs);
-        for (auto i : Range(dofnrs))
+        for (auto [i, factor] : element_phases[ei.VB()][ei.Nr()])
           {
-            if (dofnrs[i] != dofmap[dofnrs[i]])
-              {
-                if (tt == TRANSFORM_RHS)
-                  vec[i] *= dof_factors[dofnrs[i]];
-                else if (tt == TRANSFORM_SOL)
-                  vec[i] *= dof_factors[dofnrs[i]];
-                else // TRANSFORM_SOL_INVERSE
-                  vec[i] /= dof_factors[dofnrs[i]];
-              }
+            if (tt == TRANSFORM_RHS)
+              vec[i] *= factor;
+            else if (tt == TRANSFORM_SOL)
+              vec[i] *= factor;
+            else // TRANSFORM_SOL_INVERSE
+              vec[i] /= factor;
           }
       }
   }
@@ -254,19 +290,14 @@ namespace ngcomp {
   void QuasiPeriodicFESpace<TSCAL> :: VTransformVC (ElementId ei, SliceVector<Complex> vec, TRANSFORM_TYPE tt) const 
   {
     PeriodicFESpace::VTransformVC(ei, vec, tt);
-    Array<int> dofnrs;
-    space->GetDofNrs(ei, dofnrs);
-    for (auto i : Range(dofnrs))
+    for (auto [i, factor] : element_phases[ei.VB()][ei.Nr()])
       {
-	if (dofnrs[i] != dofmap[dofnrs[i]])
-	  {
-	    if (tt == TRANSFORM_RHS)
-	      vec[i] *= conj(dof_factors[dofnrs[i]]);
-	    else if (tt == TRANSFORM_SOL)
-	      vec[i] *= dof_factors[dofnrs[i]];
-            else // TRANSFORM_SOL_INVERSE
-              vec[i] /= dof_factors[dofnrs[i]];
-	  }
+        if (tt == TRANSFORM_RHS)
+          vec[i] *= conj(factor);
+        else if (tt == TRANSFORM_SOL)
+          vec[i] *= factor;
+        else // TRANSFORM_SOL_INVERSE
+          vec[i] /= factor;
       }
   }
 
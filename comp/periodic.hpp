@@ -84,6 +84,10 @@ namespace ngcomp
     shared_ptr<Array<TSCAL>> factors;
     Array<TSCAL> dof_factors;
     Array<set<size_t>> master_dofs;
+    /// a slave dof of an element: its local number and phase factor
+    struct LocalPhase { int pos; TSCAL factor; };
+    /// the slave dofs of the elements, set up in Update
+    Table<LocalPhase> element_phases[4];
 
   public:
     QuasiPeriodicFESpace (shared_ptr<FESpace> fespace, const Flags & flag, shared_ptr<Array<int>> aused_idnrs, shared_ptr<Array<TSCAL>> afactors);
@@ -101,6 +105,7 @@ namespace ngcomp
     
   protected:
     virtual void DofMapped(size_t from, size_t to, size_t idnr) override;
+    void BuildElementPhases();
   };
   
 
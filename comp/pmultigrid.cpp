@@ -0,0 +1,308 @@
+/*********************************************************************/
+/* File:   pmultigrid.cpp                                            */
+/* Author: Joachim Schoeberl                                         */
+/* Date:   Oct. 2026                                                 */
+/*********************************************************************/
+
+/*
+   p-version multigrid for H1 high order spaces:
+   orders p, p/2, ..., 1, no mesh hierarchy needed
+*/
+
+#include <comp.hpp>
+
+namespace ngcomp
+{
+
+  enum PMG_SMOOTHER { PMG_CHEBYSHEV, PMG_BLOCK_GS };
+
+  /**
+     V-cycle on the spaces of orders p = p_0 > p_1 > ... > p_L.
+     The prolongations are the embeddings of the lower order spaces,
+     level 0 may be a matrix-free operator.
+  */
+  class PMultigridMatrix : public BaseMatrix
+  {
+    /// level 0 is the finest
+    Array<shared_ptr<BaseMatrix>> mats;
+    /// prols[l] maps level l+1 to level l
+    Array<shared_ptr<SparseMatrixTM<double>>> prols;
+    Array<shared_ptr<ChebyshevSmoother>> cheb_smoothers;
+    Array<shared_ptr<BaseBlockJacobiPrecond>> block_smoothers;
+    shared_ptr<BaseMatrix> coarseinv;
+    PMG_SMOOTHER smoother_type;
+    int smoothing_steps;
+  public:
+    PMultigridMatrix (Array<shared_ptr<BaseMatrix>> amats,
+                      Array<shared_ptr<SparseMatrixTM<double>>> aprols,
+                      Array<shared_ptr<ChebyshevSmoother>> acheb,
+                      Array<shared_ptr<BaseBlockJacobiPrecond>> ablock,
+                      shared_ptr<BaseMatrix> acoarseinv,
+                      PMG_SMOOTHER asmoother, int asteps)
+      : mats(move(amats)), prols(move(aprols)),
+        cheb_smoothers(move(acheb)), block_smoothers(move(ablock)),
+        coarseinv(acoarseinv), smoother_type(asmoother), smoothing_steps(asteps)
+    { ; }
+
+    bool IsComplex() const override { return false; }
+    int VHeight() const override { return mats[0]->VHeight(); }
+    int VWidth() const override { return mats[0]->VWidth(); }
+    AutoVector CreateRowVector () const override { return mats[0]->CreateColVector(); }
+    AutoVector CreateColVector () const override { return mats[0]->CreateRowVector(); }
+
+    size_t GetNLevels () const { return mats.Size(); }
+
+    void Smooth (size_t level, BaseVector & x, const BaseVector & b, bool back) const
+    {
+      if (smoother_type == PMG_CHEBYSHEV)
+        for (int i = 0; i < smoothing_steps; i++)
+          cheb_smoothers[level]->Smooth (x, b);
+      else if (back)
+        block_smoothers[level]->GSSmoothBack (x, b, smoothing_steps);
+      else
+        block_smoothers[level]->GSSmooth (x, b, smoothing_steps);
+    }
+
+    void Cycle (size_t level, BaseVector & x, const BaseVector & b) const
+    {
+      if (level+1 == mats.Size())
+        {
+          coarseinv->Mult (b, x);
+          return;
+        }
+
+      x = 0;
+      Smooth (level, x, b, false);
+
+      auto res = b.CreateVector();
+      res = b - (*mats[level]) * x;
+
+      auto cres = mats[level+1]->CreateColVector();
+      auto cx = mats[level+1]->CreateColVector();
+      prols[level]->MultTrans (res, cres);
+      Cycle (level+1, cx, cres);
+      prols[level]->MultAdd (1, cx, x);
+
+      Smooth (level, x, b, true);
+    }
+
+    void Mult (const BaseVector & b, BaseVector & x) const override
+    {
+      static Timer t("PMultigrid::Mult"); RegionTimer reg(t);
+      Cycle (0, x, b);
+    }
+  };
+
+
+
+  /**
+     p-multigrid preconditioner for H1HighOrderFESpace.
+     Flags:
+       smoother = chebyshev | block
+       smoothingsteps, chebyshevorder
+       coarsetype = direct | h1amg   (solver on the order 1 level)
+     Coarse level matrices are Galerkin products of the assembled fine
+     matrix, or rediscretized if the bilinear-form is non-assembled
+     (then call Update after Assemble).
+  */
+  class PMultigridPreconditioner : public Preconditioner
+  {
+    shared_ptr<BilinearForm> bfa;
+    shared_ptr<PMultigridMatrix> mat;
+    /// coarse spaces and forms have to stay alive with the hierarchy
+    Array<shared_ptr<FESpace>> spaces;
+    Array<shared_ptr<BilinearForm>> coarse_forms;
+    shared_ptr<Preconditioner> coarse_pre;
+  public:
+    PMultigridPreconditioner (shared_ptr<BilinearForm> abfa, const Flags & aflags,
+                              const string aname = "pmultigrid")
+      : Preconditioner (abfa, aflags, aname), bfa(abfa)
+    { ; }
+
+    PMultigridPreconditioner (const PDE & pde, const Flags & aflags, const string & aname)
+      : PMultigridPreconditioner (pde.GetBilinearForm (aflags.GetStringFlag ("bilinearform")),
+                                  aflags, aname)
+    { ; }
+
+    virtual void FinalizeLevel (const BaseMatrix * matrix) override
+    {
+      Setup();
+    }
+
+    virtual void Update () override
+    {
+      if (bfa->NonAssemble() || !mat)
+        Setup();
+    }
+
+    /// bilinear-form on a coarse space with the integrators of bfa
+    shared_ptr<BilinearForm> Rediscretize (shared_ptr<FESpace> space, Flags cflags, LocalHeap & lh)
+    {
+      if (bfa->IsSymmetric() && !cflags.GetDefineFlag ("diagonal"))
+        cflags.SetFlag ("symmetric");
+      auto cbf = CreateBilinearForm (space, "pmultigrid_coarse", cflags);
+      for (auto bfi : bfa->Integrators())
+        cbf->AddIntegrator (bfi);
+      return cbf;
+    }
+
+    void Setup ()
+    {
+      static Timer t("PMultigrid::Setup"); RegionTimer reg(t);
+      static Timer tprol("PMultigrid::Setup - prolongation");
+      static Timer trap("PMultigrid::Setup - coarse matrices");
+      static Timer tsmooth("PMultigrid::Setup - smoothers");
+
+      auto fes = bfa->GetFESpace();
+      if (!dynamic_pointer_cast<H1HighOrderFESpace> (fes))
+        throw Exception ("pmultigrid: needs an H1 (h1ho) space");
+      if (fes->IsComplex() || fes->GetDimension() != 1)
+        throw Exception ("pmultigrid: only for real scalar H1 spaces");
+      if (bfa->UsesEliminateInternal())
+        throw Exception ("pmultigrid: eliminate_internal is not supported");
+
+      string smoother = flags.GetStringFlag ("smoother", "chebyshev");
+      PMG_SMOOTHER smoother_type = PMG_CHEBYSHEV;
+      if (smoother == "block")
+        smoother_type = PMG_BLOCK_GS;
+      else if (smoother != "chebyshev")
+        throw Exception ("pmultigrid: unknown smoother '" + smoother + "', use chebyshev or block");
+      int steps = int (flags.GetNumFlag ("smoothingsteps", 1));
+      int chebyshev_order = int (flags.GetNumFlag ("chebyshevorder", 3));
+      string coarsetype = flags.GetStringFlag ("coarsetype", "direct");
+      if (coarsetype != "direct" && coarsetype != "h1amg")
+        throw Exception ("pmultigrid: unknown coarsetype '" + coarsetype + "', use direct or h1amg");
+
+      LocalHeap lh(10000000, "pmultigrid setup", true);
+
+      Array<int> orders;
+      for (int p = max2 (fes->GetOrder(), 1); ; p /= 2)
+        {
+          orders.Append (p);
+          if (p == 1) break;
+        }
+      size_t nlevels = orders.Size();
+
+      spaces.SetSize (nlevels);
+      coarse_forms.SetSize0 ();
+      coarse_pre = nullptr;
+      spaces[0] = fes;
+      Array<shared_ptr<BaseMatrix>> mats(nlevels);
+      Array<shared_ptr<BitArray>> freedofs(nlevels);
+      Array<shared_ptr<SparseMatrixTM<double>>> prols(nlevels-1);
+      mats[0] = bfa->GetMatrixPtr();
+      freedofs[0] = fes->GetFreeDofs();
+
+      for (size_t l = 1; l < nlevels; l++)
+        {
+          Flags cflags = fes->GetFlags();
+          cflags.SetFlag ("order", double(orders[l]));
+          auto cfes = CreateFESpace ("h1ho", ma, cflags);
+          cfes->Update();
+          cfes->FinalizeUpdate();
+          spaces[l] = cfes;
+          freedofs[l] = cfes->GetFreeDofs();
+
+          {
+            RegionTimer regp(tprol);
+            // exact, since the order q space is a subspace of the order p space
+            auto prol = ConvertOperator (cfes, spaces[l-1], VOL, lh, nullptr, nullptr, nullptr,
+                                         false, false);
+            prols[l-1] = dynamic_pointer_cast<SparseMatrixTM<double>> (prol);
+            if (!prols[l-1])
+              throw Exception ("pmultigrid: prolongation is not a sparse matrix");
+          }
+
+          RegionTimer regr(trap);
+          bool last = (l+1 == nlevels);
+          if (last && coarsetype == "h1amg")
+            {
+              auto cbf = Rediscretize (cfes, Flags(), lh);
+              coarse_pre = GetPreconditionerClasses().GetPreconditioner("h1amg")
+                -> creatorbf (cbf, Flags(), "pmultigrid_coarse_h1amg");
+              cbf->Assemble (lh);
+              coarse_forms.Append (cbf);
+              mats[l] = cbf->GetMatrixPtr();
+            }
+          else if (auto spmat = dynamic_pointer_cast<BaseSparseMatrix> (mats[l-1]))
+            mats[l] = spmat->Restrict (*prols[l-1]);
+          else
+            {
+              // non-assembled fine form: rediscretize the coarse levels
+              auto cbf = Rediscretize (cfes, Flags(), lh);
+              cbf->Assemble (lh);
+              coarse_forms.Append (cbf);
+              mats[l] = cbf->GetMatrixPtr();
+            }
+        }
+
+      tsmooth.Start();
+      Array<shared_ptr<ChebyshevSmoother>> cheb(nlevels-1);
+      Array<shared_ptr<BaseBlockJacobiPrecond>> block(nlevels-1);
+      for (size_t l = 0; l+1 < nlevels; l++)
+        {
+          auto spmat = dynamic_pointer_cast<BaseSparseMatrix> (mats[l]);
+          if (smoother_type == PMG_BLOCK_GS)
+            {
+              if (!spmat)
+                throw Exception ("pmultigrid: block smoother needs an assembled matrix, use smoother=chebyshev");
+              auto blocks = spaces[l]->CreateSmoothingBlocks (flags);
+              block[l] = spmat->CreateBlockJacobiPrecond (blocks, nullptr, true, freedofs[l]);
+            }
+          else
+            {
+              shared_ptr<BaseMatrix> jac;
+              if (spmat)
+                jac = spmat->CreateJacobiPrecond (freedofs[l]);
+              else
+                {
+                  // only the diagonal of the non-assembled operator is assembled
+                  Flags dflags;
+                  dflags.SetFlag ("diagonal");
+                  auto dbf = Rediscretize (spaces[l], dflags, lh);
+                  dbf->Assemble (lh);
+                  jac = dbf->GetMatrix().InverseMatrix (freedofs[l]);
+                }
+              cheb[l] = make_shared<ChebyshevSmoother> (mats[l], jac, chebyshev_order);
+            }
+        }
+      tsmooth.Stop();
+
+      shared_ptr<BaseMatrix> coarseinv;
+      if (coarse_pre)
+        coarseinv = coarse_pre;
+      else
+        coarseinv = mats.Last()->InverseMatrix (freedofs.Last());
+
+      mat = make_shared<PMultigridMatrix> (move(mats), move(prols), move(cheb), move(block),
+                                           coarseinv, smoother_type, steps);
+      timestamp = bfa->GetTimeStamp();
+      if (test) Test();
+    }
+
+    virtual const BaseMatrix & GetMatrix() const override
+    {
+      if (!mat)
+        ThrowPreconditionerNotReady();
+      return *mat;
+    }
+
+    virtual shared_ptr<BaseMatrix> GetMatrixPtr() override
+    {
+      if (!mat)
+        ThrowPreconditionerNotReady();
+      return mat;
+    }
+
+    virtual const BaseMatrix & GetAMatrix() const override
+    {
+      return bfa->GetMatrix();
+    }
+
+    virtual const char * ClassName() const override
+    { return "p-Multigrid Preconditioner"; }
+  };
+
+
+  static RegisterPreconditioner<PMultigridPreconditioner> initpmg ("pmultigrid");
+}
@@ -190,16 +190,20 @@ namespace ngcomp
     flux.GetVector().Cumulate(); 	 
 #endif
 
-    FlatVector<SCAL> fluxi(dimflux, clh);
-    ArrayMem<int,1> dnumsflux(1);
-    for (int i = 0; i < cnti.Size(); i++)
-      if (cnti[i])
-	{
-	  dnumsflux[0] = i;
-	  flux.GetElementVector (dnumsflux, fluxi);
-	  fluxi /= double (cnti[i]);
-	  flux.SetElementVector (dnumsflux, fluxi);
-	}
+    ParallelForRange
+      (cnti.Size(), [&] (IntRange r)
+       {
+         VectorMem<10,SCAL> fluxi(dimflux);
+         ArrayMem<int,1> dnumsflux(1);
+         for (auto i : r)
+           if (cnti[i] > 1)
+             {
+               dnumsflux[0] = i;
+               flux.GetElementVector (dnumsflux, fluxi);
+               fluxi /= double (cnti[i]);
+               flux.SetElementVector (dnumsflux, fluxi);
+             }
+       });
     
     ma->PopStatus ();
   }
@@ -380,6 +384,128 @@ namespace ngcomp
 
 
 
+  /*
+    Inverse mass matrices of scalar elements on the reference element.
+    For affine elements, with shape values as evaluator, the element mass
+    matrix is the measure times the reference mass matrix.
+    Lookup is lock-free, entries are only added and never removed.
+  */
+  class ReferenceInverseMass
+  {
+  public:
+    size_t fetype;
+    int classnr, order, ndof;
+    Matrix<> inv;
+    ReferenceInverseMass * next = nullptr;
+  };
+
+  class ReferenceInverseMassContainer
+  {
+    static constexpr size_t NBUCKETS = 256;
+    atomic<ReferenceInverseMass*> buckets[NBUCKETS];
+    atomic<size_t> memory{0};
+  public:
+    /// don't cache more than that (in bytes)
+    static constexpr size_t max_memory = size_t(1) << 28;
+    
+    ReferenceInverseMassContainer ()
+    {
+      for (auto & b : buckets) b.store (nullptr);
+    }
+    
+    ~ReferenceInverseMassContainer ()
+    {
+      for (auto & b : buckets)
+        for (auto p = b.load(); p; )
+          {
+            auto next = p->next;
+            delete p;
+            p = next;
+          }
+    }
+
+    ReferenceInverseMass * Get (size_t fetype, int classnr, int order, int ndof) const
+    {
+      for (auto p = buckets[Bucket(classnr, order, ndof)].load(memory_order_acquire); p; p = p->next)
+        if (p->fetype == fetype && p->classnr == classnr && p->order == order && p->ndof == ndof)
+          return p;
+      return nullptr;
+    }
+
+    bool HasSpace (size_t bytes) const { return memory + bytes <= max_memory; }
+
+    /// takes ownership, another thread may have added the same matrix
+    ReferenceInverseMass * Add (ReferenceInverseMass * ref)
+    {
+      memory += ref->inv.Height() * ref->inv.Width() * sizeof(double);
+      auto & bucket = buckets[Bucket(ref->classnr, ref->order, ref->ndof)];
+      ref->next = bucket.load (memory_order_relaxed);
+      while (!bucket.compare_exchange_weak (ref->next, ref, memory_order_release, memory_order_relaxed))
+        ;
+      return ref;
+    }
+
+  private:
+    static size_t Bucket (int classnr, int order, int ndof)
+    {
+      return (97 * classnr + 32 * order + ndof) % NBUCKETS;
+    }
+  };
+
+  /// nullptr if the element has no shape class, or if the cache is full
+  static const Matrix<> * GetReferenceInverseMass (const FiniteElement & fel, LocalHeap & lh)
+  {
+    static ReferenceInverseMassContainer container;
+    auto sfel = dynamic_cast<const BaseScalarFiniteElement*> (&fel);
+    if (!sfel) return nullptr;
+    int classnr = sfel->GetShapeClassNr();
+    if (classnr < 0) return nullptr;
+    
+    size_t fetype = typeid(fel).hash_code();
+    int ndof = fel.GetNDof();
+    if (auto ref = container.Get (fetype, classnr, fel.Order(), ndof))
+      return &ref->inv;
+    if (!container.HasSpace (ndof*ndof*sizeof(double)))
+      return nullptr;
+
+    static Timer t("SetValues - reference mass"); RegionTimer reg(t);
+    HeapReset hr(lh);
+    IntegrationRule ir(fel.ElementType(), 2*fel.Order());
+    FlatMatrix<> shapes(ndof, ir.Size(), lh);
+    FlatMatrix<> wshapes(ndof, ir.Size(), lh);
+    sfel->CalcShape (ir, shapes);
+    for (size_t i = 0; i < ir.Size(); i++)
+      wshapes.Col(i) = ir[i].Weight() * shapes.Col(i);
+
+    auto ref = new ReferenceInverseMass;
+    ref->fetype = fetype;
+    ref->classnr = classnr;
+    ref->order = fel.Order();
+    ref->ndof = ndof;
+    ref->inv.SetSize (ndof, ndof);
+    ref->inv = wshapes * Trans(shapes);
+    CalcInverse (ref->inv);
+    return &container.Add (ref)->inv;
+  }
+
+  /// evaluates shape values, the mass matrix scales with the measure of affine elements
+  static bool IsScalarIdentity (const DifferentialOperator & diffop)
+  {
+    auto & type = typeid(diffop);
+    return
+      type == typeid(T_DifferentialOperator<DiffOpId<1>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpId<2>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpId<3>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpIdBoundary<1>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpIdBoundary<2>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpIdBoundary<3>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpIdH1<2,2>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpIdH1<2,1>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpIdH1<3,3>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpIdH1<3,2>>) ||
+      type == typeid(T_DifferentialOperator<DiffOpIdH1<3,1>>);
+  }
+
   template <class SCAL>
   void SetValues (shared_ptr<CoefficientFunction> coef,
 		  GridFunction & u,
@@ -644,6 +770,7 @@ namespace ngcomp
         shared_ptr<BilinearFormIntegrator> single_bli = bli;
         if (dynamic_pointer_cast<BlockBilinearFormIntegrator> (single_bli))
           single_bli = dynamic_pointer_cast<BlockBilinearFormIntegrator> (single_bli)->BlockPtr();
+        bool unit_mass = false;
     
         if (!bli)
           {
@@ -661,8 +788,19 @@ namespace ngcomp
             bli = make_shared<SymbolicBilinearFormIntegrator> (InnerProduct(trial,test), vb, VOL);
           
             single_bli = bli;
+            unit_mass = true;
             // throw Exception ("no integrator available");
           }
+
+        // affine simplices use the factored mass matrix of the reference element
+        bool reference_mass = false;
+        if (is_same<SCAL,double>::value && unit_mass && diffop == fes->GetEvaluator(vb).get())
+          {
+            auto basediffop = diffop;
+            if (auto block = dynamic_cast<BlockDifferentialOperator*> (diffop))
+              basediffop = block->BaseDiffOp().get();
+            reference_mass = IsScalarIdentity (*basediffop);
+          }
             
 	/** So we can restore this afterwards **/
 	bool bli_uses_simd = bli->SimdEvaluate(), sbli_uses_simd = single_bli->SimdEvaluate();
@@ -707,6 +845,11 @@ namespace ngcomp
              FlatVector<SCAL> elflux(fel.GetNDof() * dim, lh);
              FlatVector<SCAL> elfluxi(fel.GetNDof() * dim, lh);
              FlatVector<SCAL> fluxi(dimflux, lh);
+
+             const Matrix<> * minv = nullptr;
+             if (reference_mass && !eltrans.IsCurvedElement() &&
+                 ElementTopology::GetNVertices(fel.ElementType()) == ElementTopology::GetSpaceDim(fel.ElementType())+1)
+               minv = GetReferenceInverseMass (fel, lh);
              
              if (use_simd)
                {
@@ -728,7 +871,13 @@ namespace ngcomp
                      else
                        throw ExceptionNOSIMD("need diffop");
                      
-                     if (dim > 1) //  && typeid(*bli)==typeid(BlockBilinearFormIntegrator))
+                     if (minv)
+                       {
+                         double scale = 1.0 / mir[0].GetMeasure()[0];
+                         for (int j = 0; j < dim; j++)
+                           elfluxi.Slice (j,dim) = scale * (*minv * elflux.Slice (j,dim));
+                       }
+                     else if (dim > 1) //  && typeid(*bli)==typeid(BlockBilinearFormIntegrator))
                        {
                          FlatMatrix<SCAL> elmat(fel.GetNDof(), lh);
                          single_bli->CalcElementMatrix (fel, eltrans, elmat, lh);                      
@@ -795,7 +944,13 @@ namespace ngcomp
              else
                bli->ApplyBTrans (fel, mir, mfluxi, elflux, lh);
              
-             if (dim > 1)
+             if (minv)
+               {
+                 double scale = 1.0 / mir[0].GetMeasure();
+                 for (int j = 0; j < dim; j++)
+                   elfluxi.Slice (j,dim) = scale * (*minv * elflux.Slice (j,dim));
+               }
+             else if (dim > 1)
                {
                  FlatMatrix<SCAL> elmat(fel.GetNDof(), lh);
                  // const BlockBilinearFormIntegrator & bbli = 
@@ -902,6 +1057,190 @@ namespace ngcomp
 
 
 
+  RegionInterpolator :: RegionInterpolator (shared_ptr<FESpace> afes, const Region & aregion, LocalHeap & clh)
+    : fes(afes), region(aregion)
+  {
+    static Timer t("RegionInterpolator ctor"); RegionTimer reg(t);
+    static Timer tproj("RegionInterpolator projections");
+    
+    if (fes->IsComplex())
+      throw Exception ("RegionInterpolator: complex spaces are not supported");
+    if (fes->IsParallel())
+      throw Exception ("RegionInterpolator: distributed spaces are not supported");
+
+    auto ma = fes->GetMeshAccess();
+    VorB vb = region.VB();
+    auto diffop = fes->GetEvaluator(vb);
+    if (!diffop)
+      throw Exception(fes->GetClassName()+string(" does not have an evaluator for ")+ToString(vb)+string("!"));
+    dim = fes->GetDimension();
+    dimflux = diffop->Dim();
+
+    // the elements of the region, their dofs and sizes of the projections
+    Array<int> cnt;
+    Array<DofId> dnums;
+    for (size_t nr : Range(ma->GetNE(vb)))
+      {
+        HeapReset hr(clh);
+        ElementId ei(vb, nr);
+        if (!region.Mask().Test(ma->GetElIndex(ei))) continue;
+        if (!fes->DefinedOn(ei)) continue;
+        const FiniteElement & fel = fes->GetFE (ei, clh);
+        fes->GetDofNrs (ei, dnums);
+        IntegrationRule ir(fel.ElementType(), 2*fel.Order());
+        elnrs.Append (nr);
+        eltypes.Append (fel.ElementType());
+        intorders.Append (2*fel.Order());
+        cnt.Append (dnums.Size());
+        heights.Append (fel.GetNDof()*dim);
+        widths.Append (ir.Size()*dimflux);
+      }
+
+    size_t nel = elnrs.Size();
+    eldofs = Table<DofId> (cnt);
+    firstmat.SetSize (nel+1);
+    firstmat[0] = 0;
+    for (size_t i = 0; i < nel; i++)
+      firstmat[i+1] = firstmat[i] + heights[i]*widths[i];
+    projmats.SetSize (firstmat[nel]);
+
+    // multiplicity of the region dofs, sized for the space once
+    Array<int> multiplicity(fes->GetNDof());
+    multiplicity = 0;
+    for (size_t i = 0; i < nel; i++)
+      {
+        fes->GetDofNrs (ElementId(vb, elnrs[i]), dnums);
+        eldofs[i] = dnums;
+        for (auto d : dnums)
+          if (IsRegularDof(d))
+            {
+              if (multiplicity[d] == 0) dofs.Append (d);
+              multiplicity[d]++;
+            }
+      }
+
+    RegionTimer regp(tproj);
+    ParallelForRange
+      (nel, [&] (IntRange r)
+       {
+         LocalHeap lh = clh.Split();
+         for (auto i : r)
+           {
+             HeapReset hr(lh);
+             ElementId ei(vb, elnrs[i]);
+             const FiniteElement & fel = fes->GetFE (ei, lh);
+             const ElementTransformation & trafo = ma->GetTrafo (ei, lh);
+             IntegrationRule ir(eltypes[i], intorders[i]);
+             auto & mir = trafo(ir, lh);
+
+             size_t nd = heights[i], nc = widths[i];
+             FlatMatrix<double,ColMajor> bmat(nc, nd, lh);
+             diffop->CalcMatrix (fel, mir, bmat, lh);
+             FlatMatrix<> wbt(nd, nc, lh);
+             for (size_t j = 0; j < ir.Size(); j++)
+               for (int c = 0; c < dimflux; c++)
+                 wbt.Col(j*dimflux+c) = mir[j].GetWeight() * bmat.Row(j*dimflux+c);
+             FlatMatrix<> mass(nd, nd, lh);
+             mass = wbt * bmat;
+             CalcInverse (mass);
+
+             FlatMatrix<> proj = Projection(i);
+             proj = mass * wbt;
+             for (size_t c = 0; c < nc; c++)
+               fes->TransformVec (ei, proj.Col(c), TRANSFORM_SOL_INVERSE);
+
+             auto dnums = eldofs[i];
+             for (size_t k = 0; k < dnums.Size(); k++)
+               for (int j = 0; j < dim; j++)
+                 {
+                   if (IsRegularDof(dnums[k]))
+                     proj.Row(k*dim+j) *= 1.0 / multiplicity[dnums[k]];
+                   else
+                     proj.Row(k*dim+j) = 0.0;
+                 }
+           }
+       });
+
+    cout << IM(3) << "RegionInterpolator: " << nel << " elements, " << dofs.Size() << " dofs" << endl;
+  }
+
+
+  void RegionInterpolator :: Set (shared_ptr<CoefficientFunction> cf, GridFunction & gf, LocalHeap & clh) const
+  {
+    static Timer t("RegionInterpolator::Set"); RegionTimer reg(t);
+    if (gf.GetFESpace() != fes)
+      throw Exception ("RegionInterpolator::Set: GridFunction is not on the space of the interpolator");
+    if (cf->Dimension() != dimflux)
+      throw Exception(string("Error in RegionInterpolator::Set: gridfunction-dim = ") + ToString(dimflux) +
+                      ", but coefficient-dim = " + ToString(cf->Dimension()));
+
+    auto ma = fes->GetMeshAccess();
+    VorB vb = region.VB();
+    auto fv = gf.GetVector().FV<double>();
+    ParallelFor (dofs.Size(), [&] (size_t i)
+                 {
+                   for (int j = 0; j < dim; j++)
+                     fv(dofs[i]*dim+j) = 0.0;
+                 });
+
+    std::atomic<bool> use_simd(true);
+    ParallelForRange
+      (elnrs.Size(), [&] (IntRange r)
+       {
+         LocalHeap lh = clh.Split();
+         for (auto i : r)
+           {
+             HeapReset hr(lh);
+             ElementId ei(vb, elnrs[i]);
+             const ElementTransformation & trafo = ma->GetTrafo (ei, lh);
+             FlatMatrix<> proj = Projection(i);
+             // values at the points, point by point
+             FlatVector<> values(proj.Width(), lh);
+
+             bool done = false;
+             if (use_simd)
+               {
+                 try
+                   {
+                     SIMD_IntegrationRule ir(eltypes[i], intorders[i]);
+                     auto & mir = trafo(ir, lh);
+                     FlatMatrix<SIMD<double>> simd_values(dimflux, ir.Size(), lh);
+                     cf->Evaluate (mir, simd_values);
+                     for (int c = 0; c < dimflux; c++)
+                       {
+                         double * pc = &simd_values(c,0)[0];
+                         for (size_t j = 0; j < ir.GetNIP(); j++)
+                           values(j*dimflux+c) = pc[j];
+                       }
+                     done = true;
+                   }
+                 catch (ExceptionNOSIMD & e)
+                   {
+                     use_simd = false;
+                     cout << IM(4) << "Warning: switching to std evalution in RegionInterpolator since: " << e.What() << endl;
+                   }
+               }
+             if (!done)
+               {
+                 IntegrationRule ir(eltypes[i], intorders[i]);
+                 auto & mir = trafo(ir, lh);
+                 FlatMatrix<> hvalues(ir.Size(), dimflux, values.Data());
+                 cf->Evaluate (mir, hvalues);
+               }
+
+             FlatVector<> elvec(proj.Height(), lh);
+             elvec = proj * values;
+             auto dnums = eldofs[i];
+             for (size_t k = 0; k < dnums.Size(); k++)
+               if (IsRegularDof(dnums[k]))
+                 for (int j = 0; j < dim; j++)
+                   AtomicAdd (fv(dnums[k]*dim+j), elvec(k*dim+j));
+           }
+       });
+  }
+
+
+
 
   template <class SCAL>
   void CalcError (const S_GridFunction<SCAL> & u,
@@ -933,65 +1272,62 @@ namespace ngcomp
     // shared_ptr<BilinearFormIntegrator> fluxbli = fesflux.GetIntegrator(vb);
     shared_ptr<DifferentialOperator> flux_diffop = fesflux.GetEvaluator(vb);
 
-    Array<int> dnums;
-    Array<int> dnumsflux;
+    ProgressOutput progress (ma, "error estimator element", ne);
 
-    double sum = 0;
-    for (int i = 0; i < ne; i++)
-      {
-        ElementId ei(vb,i);
-
-	HeapReset hr(lh);
-	ma->SetThreadPercentage ( 100.0*i / ne );
+    // every element writes only its own entry of err
+    ParallelForRange
+      (ne, [&] (IntRange r)
+       {
+         LocalHeap slh = lh.Split();
+         Array<int> dnums;
+         Array<int> dnumsflux;
 
-	int eldom = ma->GetElIndex(ei);
-        // bound ? ma->GetSElIndex(i) : ma->GetElIndex(i);
-	
-	if (!domains[eldom]) continue;
+         for (int i : r)
+           {
+             ElementId ei(vb,i);
+             HeapReset hr(slh);
+             progress.Update();
 
-	const FiniteElement & fel = fes.GetFE(ei, lh);
-	const FiniteElement & felflux = fesflux.GetFE(ei, lh);
+             int eldom = ma->GetElIndex(ei);
+             if (!domains[eldom]) continue;
 
-	ElementTransformation & eltrans = ma->GetTrafo (ei, lh);
-	fes.GetDofNrs(ei,dnums);
-	fesflux.GetDofNrs(ei,dnumsflux);
+             const FiniteElement & fel = fes.GetFE(ei, slh);
+             const FiniteElement & felflux = fesflux.GetFE(ei, slh);
 
-	FlatVector<SCAL> elu(dnums.Size() * dim, lh);
-	FlatVector<SCAL> elflux(dnumsflux.Size() * dimflux, lh);
-	FlatVector<SCAL> fluxi(dimfluxvec, lh);
-	FlatVector<SCAL> fluxi2(dimfluxvec, lh);
+             ElementTransformation & eltrans = ma->GetTrafo (ei, slh);
+             fes.GetDofNrs(ei,dnums);
+             fesflux.GetDofNrs(ei,dnumsflux);
 
+             FlatVector<SCAL> elu(dnums.Size() * dim, slh);
+             FlatVector<SCAL> elflux(dnumsflux.Size() * dimflux, slh);
 
-	u.GetElementVector (dnums, elu);
-	fes.TransformVec (ei, elu, TRANSFORM_SOL);
-	flux.GetElementVector (dnumsflux, elflux);
-	fesflux.TransformVec (ei, elflux, TRANSFORM_SOL);
+             u.GetElementVector (dnums, elu);
+             fes.TransformVec (ei, elu, TRANSFORM_SOL);
+             flux.GetElementVector (dnumsflux, elflux);
+             fesflux.TransformVec (ei, elflux, TRANSFORM_SOL);
 
-	IntegrationRule ir(felflux.ElementType(), 2*felflux.Order());
+             const IntegrationRule & ir = SelectIntegrationRule(felflux.ElementType(), 2*felflux.Order());
 
-	FlatMatrix<SCAL> mfluxi(ir.GetNIP(), dimfluxvec, lh);
-	FlatMatrix<SCAL> mfluxi2(ir.GetNIP(), dimfluxvec, lh);
+             FlatMatrix<SCAL> mfluxi(ir.GetNIP(), dimfluxvec, slh);
+             FlatMatrix<SCAL> mfluxi2(ir.GetNIP(), dimfluxvec, slh);
 	
-	BaseMappedIntegrationRule & mir = eltrans(ir, lh);
-	bli->CalcFlux (fel, mir, elu, mfluxi, 1, lh);
-        // fluxbli->CalcFlux (felflux, mir, elflux, mfluxi2, 0, lh);
-        // cout << "mfluxi2 - bli = " << mfluxi2 << endl;
-        // mfluxi2 = 0;
-        flux_diffop->Apply (felflux, mir, elflux, mfluxi2, lh);
-        // cout << "mfluxi2 - diffop = " << mfluxi2 << endl;
+             BaseMappedIntegrationRule & mir = eltrans(ir, slh);
+             bli->CalcFlux (fel, mir, elu, mfluxi, 1, slh);
+             flux_diffop->Apply (felflux, mir, elflux, mfluxi2, slh);
         
-	mfluxi -= mfluxi2;
+             mfluxi -= mfluxi2;
 	
-	bli->ApplyDMatInv (fel, mir, mfluxi, mfluxi2, lh);
+             bli->ApplyDMatInv (fel, mir, mfluxi, mfluxi2, slh);
 	
-	double elerr = 0;
-	for (int j = 0; j < ir.GetNIP(); j++)
-	  elerr += ir[j].Weight() * mir[j].GetMeasure() *
-	    fabs (InnerProduct (mfluxi.Row(j), mfluxi2.Row(j)));
+             double elerr = 0;
+             for (int j = 0; j < ir.GetNIP(); j++)
+               elerr += ir[j].Weight() * mir[j].GetMeasure() *
+                 fabs (InnerProduct (mfluxi.Row(j), mfluxi2.Row(j)));
 
-	err(i) += elerr;
-	sum += elerr;
-      }
+             err(i) += elerr;
+           }
+       });
+    progress.Done();
     ma->PopStatus ();
   }
   
@@ -52,6 +52,49 @@ namespace ngcomp
                   bool dualdiffop = false, bool use_simd = true);
   
 
+  /**
+     Cached interpolation into the dofs of a region, such as the
+     boundary data of a moving-boundary problem set every time step.
+
+     The constructor computes the local L2 projections (B^T W B)^{-1} B^T W
+     of the elements of the region, B the evaluator of the space on the
+     rule of order 2p as in SetValues, and the geometry at construction.
+     The rows of shared dofs are scaled by their multiplicity.
+
+     Set evaluates the coefficient function on the elements (SIMD if
+     possible) and adds the projections in parallel. Only the dofs of
+     the region are written, the other entries of the vector are kept.
+  */
+  class NGS_DLL_HEADER RegionInterpolator
+  {
+    shared_ptr<FESpace> fes;
+    Region region;
+    int dim;       // of the space
+    int dimflux;   // of the evaluator
+    Array<int> elnrs;
+    Array<ELEMENT_TYPE> eltypes;
+    Array<int> intorders;
+    Table<DofId> eldofs;
+    /// projection of element i is height x width at projmats[firstmat[i]]
+    Array<size_t> firstmat;
+    Array<size_t> heights, widths;
+    Array<double> projmats;
+    /// the regular dofs of the region
+    Array<DofId> dofs;
+    
+  public:
+    RegionInterpolator (shared_ptr<FESpace> afes, const Region & aregion, LocalHeap & lh);
+
+    /// sets the region dofs of gf to the interpolant of cf
+    void Set (shared_ptr<CoefficientFunction> cf, GridFunction & gf, LocalHeap & lh) const;
+
+    size_t NElements () const { return elnrs.Size(); }
+    FlatArray<DofId> GetDofs () const { return dofs; }
+    FlatMatrix<> Projection (size_t i) const
+    { return FlatMatrix<> (heights[i], widths[i], const_cast<double*>(projmats.Data()+firstmat[i])); }
+  };
+  
+
 
   template <class SCAL>
   extern NGS_DLL_HEADER
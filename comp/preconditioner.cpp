@@ -263,6 +263,10 @@ namespace ngcomp
       {
 	sm = make_shared<AnisotropicSmoother> (*ma, *lo_bfa);
       }
+    else if (smoothertype == "chebyshev")
+      {
+	sm = make_shared<PolynomialSmoother> (*ma, *lo_bfa, flags);
+      }
     else if (smoothertype == "block") 
       {
 	if (!lfconstraint)
@@ -284,12 +288,17 @@ namespace ngcomp
 
     auto prol = lo_fes->GetProlongation();
 
+    // coarse matrices are P^T A P of the finest matrix instead of assembled ones
+    if (flags.GetDefineFlag ("galerkin"))
+      lo_bfa->SetGalerkin();
+
     mgp = make_shared<MultigridPreconditioner> (*ma, *lo_fes, *lo_bfa, sm, prol);
     mgp->SetSmoothingSteps (int(flags.GetNumFlag ("smoothingsteps", 1)));
     mgp->SetCycle (int(flags.GetNumFlag ("cycle", 1)));
     mgp->SetIncreaseSmoothingSteps (int(flags.GetNumFlag ("increasesmoothingsteps", 1)));
     mgp->SetCoarseSmoothingSteps (int(flags.GetNumFlag ("coarsesmoothingsteps", 1)));
-    mgp->SetUpdateAll( flags.GetDefineFlag( "updateall" ) );
+    mgp->SetUpdateAll( flags.GetDefineFlag( "updateall" ) || lo_bfa->UseGalerkin() );
+    mgp->SetStatistics (flags.GetDefineFlag ("statistics"));
 
     MultigridPreconditioner::COARSETYPE ct = MultigridPreconditioner::EXACT_COARSE;
     const string & coarse = flags.GetStringFlag ("coarsetype", "direct");
@@ -360,6 +369,10 @@ namespace ngcomp
       {
 	sm = make_shared<AnisotropicSmoother> (*ma, *lo_bfa);
       }
+    else if (smoothertype == "chebyshev")
+      {
+	sm = make_shared<PolynomialSmoother> (*ma, *lo_bfa, flags);
+      }
     else if (smoothertype == "block") 
       {
 	// if (!lfconstraint)
@@ -383,12 +396,17 @@ namespace ngcomp
 
     auto prol = lo_fes->GetProlongation();
 
+    // coarse matrices are P^T A P of the finest matrix instead of assembled ones
+    if (flags.GetDefineFlag ("galerkin"))
+      lo_bfa->SetGalerkin();
+
     mgp = make_shared<MultigridPreconditioner> (*ma, *lo_fes, *lo_bfa, sm, prol);
     mgp->SetSmoothingSteps (int(flags.GetNumFlag ("smoothingsteps", 1)));
     mgp->SetCycle (int(flags.GetNumFlag ("cycle", 1)));
     mgp->SetIncreaseSmoothingSteps (int(flags.GetNumFlag ("increasesmoothingsteps", 1)));
     mgp->SetCoarseSmoothingSteps (int(flags.GetNumFlag ("coarsesmoothingsteps", 1)));
-    mgp->SetUpdateAll( flags.GetDefineFlag( "updateall" ) );
+    mgp->SetUpdateAll( flags.GetDefineFlag( "updateall" ) || lo_bfa->UseGalerkin() );
+    mgp->SetStatistics (flags.GetDefineFlag ("statistics"));
     mgp->SetUpdateAlways(flags.GetDefineFlag("updatealways"));
 
     MultigridPreconditioner::COARSETYPE ct = MultigridPreconditioner::EXACT_COARSE;
@@ -485,7 +503,7 @@ namespace ngcomp
     auto mu = GetMatrix().GetMemoryUsage ();;
 
     for (int i = 0; i < mu.Size(); i++)
-      mu[i].AddName (string(" mgpre ")); // +GetName());
+      mu[i].AddParent ("mgpre " + GetName());
     return mu;
   }
     
@@ -301,6 +301,8 @@ namespace ngcomp
     virtual Array<MemoryUsage> GetMemoryUsage () const override;
 
     void MgTest () const;
+
+    shared_ptr<ngmg::MultigridPreconditioner> GetMultigrid () const { return mgp; }
   };
 
   class CommutingAMGPreconditioner : public Preconditioner
@@ -6,6 +6,7 @@
 #include "python_comp.hpp"
 #include <comp.hpp>
 #include <multigrid.hpp> 
+#include "h1amg.hpp"
 
 #include "hdivdivfespace.hpp"
 #include "hcurldivfespace.hpp"
@@ -221,6 +222,133 @@ public:
 static GlobalDummyVariables globvar;
 
 
+/*
+  Integrals of all components of cf over every element, rows of masked
+  elements are zero. Elements are computed independently, so the values
+  do not depend on the number of threads. If some element can't be
+  evaluated with SIMD, all elements are evaluated without SIMD.
+*/
+template <typename SCAL>
+static Matrix<SCAL> ElementIntegrals (shared_ptr<CoefficientFunction> cf, shared_ptr<MeshAccess> ma,
+                                      VorB vb, int order, const BitArray & mask)
+{
+  static Timer t("Integrate CF - element integrals"); RegionTimer reg(t);
+  size_t dim = cf->Dimension();
+  Matrix<SCAL> elvals(ma->GetNE(vb), dim);
+  for (bool use_simd : { true, false })
+    {
+      atomic<bool> nosimd(false);
+      ParallelForRange
+        (ma->GetNE(vb), [&] (IntRange r)
+         {
+           LocalHeap lh = glh.Split();
+           for (auto nr : r)
+             {
+               HeapReset hr(lh);
+               ElementId ei(vb, nr);
+               auto row = elvals.Row(nr);
+               row = SCAL(0.0);
+               if (!mask.Test(ma->GetElIndex(ei))) continue;
+               auto & trafo = ma->GetTrafo (ei, lh);
+               if (use_simd)
+                 {
+                   try
+                     {
+                       SIMD_IntegrationRule ir(trafo.GetElementType(), order);
+                       auto & mir = trafo(ir, lh);
+                       FlatMatrix<SIMD<SCAL>> values(dim, ir.Size(), lh);
+                       cf -> Evaluate (mir, values);
+                       for (size_t j = 0; j < dim; j++)
+                         {
+                           SIMD<SCAL> vsum = SCAL(0.0);
+                           for (size_t i = 0; i < values.Width(); i++)
+                             vsum += mir[i].GetWeight() * values(j,i);
+                           row(j) = HSum(vsum);
+                         }
+                     }
+                   catch (ExceptionNOSIMD e)
+                     {
+                       nosimd = true;
+                       return;
+                     }
+                 }
+               else
+                 {
+                   IntegrationRule ir(trafo.GetElementType(), order);
+                   BaseMappedIntegrationRule & mir = trafo(ir, lh);
+                   FlatMatrix<SCAL> values(ir.Size(), dim, lh);
+                   cf -> Evaluate (mir, values);
+                   for (size_t i = 0; i < values.Height(); i++)
+                     row += mir[i].GetWeight() * values.Row(i);
+                 }
+             }
+         });
+      if (!nosimd) break;
+    }
+  return elvals;
+}
+
+/// sum of the rows, fixed blocks are added pairwise independent of the number of threads
+template <typename SCAL>
+static Vector<SCAL> PairwiseRowSum (FlatMatrix<SCAL> vals)
+{
+  constexpr size_t blocksize = 256;
+  size_t n = vals.Height();
+  size_t nblocks = (n+blocksize-1) / blocksize;
+  Matrix<SCAL> partial(max(nblocks, size_t(1)), vals.Width());
+  partial = SCAL(0.0);
+  ParallelFor (nblocks, [&] (size_t b)
+               {
+                 for (size_t i = b*blocksize; i < min(n, (b+1)*blocksize); i++)
+                   partial.Row(b) += vals.Row(i);
+               });
+  for (size_t stride = 1; stride < nblocks; stride *= 2)
+    for (size_t b = 0; b+stride < nblocks; b += 2*stride)
+      partial.Row(b) += partial.Row(b+stride);
+  Vector<SCAL> sum = partial.Row(0);
+  return sum;
+}
+
+/// sums of element values per region, in element order
+template <typename SCAL>
+static Matrix<SCAL> RegionSums (FlatMatrix<SCAL> vals, const MeshAccess & ma, VorB vb)
+{
+  Matrix<SCAL> sums(ma.GetNRegions(vb), vals.Width());
+  sums = SCAL(0.0);
+  for (size_t nr = 0; nr < vals.Height(); nr++)
+    sums.Row(ma.GetElIndex(ElementId(vb, nr))) += vals.Row(nr);
+  return sums;
+}
+
+template <typename SCAL>
+static void AllReduceSum (NgsMPI_Comm comm, FlatVector<SCAL> vals)
+{
+#ifdef PARALLEL
+  if (comm.Size() > 1 && vals.Size())
+    MPI_Allreduce(MPI_IN_PLACE, vals.Data(), vals.Size(), MPI_typetrait<SCAL>::MPIType(), MPI_SUM, comm);
+#endif
+}
+
+/// a space of the same type and flags on another mesh, product spaces are rebuilt from their components
+static shared_ptr<FESpace> CopyFESpaceOnMesh (shared_ptr<FESpace> fes, shared_ptr<MeshAccess> ma)
+{
+  shared_ptr<FESpace> copy;
+  auto compspace = dynamic_pointer_cast<CompoundFESpace> (fes);
+  if (compspace && typeid(*compspace) == typeid(CompoundFESpace))
+    {
+      Array<shared_ptr<FESpace>> spaces(compspace->GetNSpaces());
+      for (int i = 0; i < compspace->GetNSpaces(); i++)
+        spaces[i] = CopyFESpaceOnMesh ((*compspace)[i], ma);
+      copy = make_shared<CompoundFESpace> (ma, spaces, compspace->GetFlags());
+    }
+  else
+    copy = CreateFESpace (fes->type, ma, fes->GetFlags());
+  copy->Update();
+  copy->FinalizeUpdate();
+  return copy;
+}
+
+
 void ExportNgcompMesh (py::module &m);
 
 void NGS_DLL_HEADER ExportNgcomp(py::module &m)
@@ -232,6 +360,64 @@ void NGS_DLL_HEADER ExportNgcomp(py::module &m)
   static size_t global_heapsize = 10000000;
   static LocalHeap glh(global_heapsize, "python-comp lh", true);
 
+  // the global heap only grows, the size is per thread
+  static void SetGlobalHeapSize (size_t heapsize)
+  {
+    if (heapsize > global_heapsize)
+      {
+        global_heapsize = heapsize;
+        glh = LocalHeap (heapsize, "python-comp lh", true);
+      }
+  }
+
+  static void ReserveGlobalHeap (size_t size_per_thread)
+  {
+    if (size_per_thread > global_heapsize)
+      cout << IM(3) << "estimated LocalHeap " << size_per_thread << " bytes per thread" << endl;
+    SetGlobalHeapSize (size_per_thread);
+  }
+
+  // mapped integration points and values of blocks of 64 elements in Integrate
+  static size_t IntegrateHeapSize (const MeshAccess & ma, int order, int dim)
+  {
+    size_t nip = 1;
+    for (int i = 0; i < ma.GetDimension(); i++)
+      nip *= order/2+1;
+    nip += SIMD<double>::Size();
+    return 64*1024 + 64 * nip * (512 + 2 * dim * sizeof(Complex));
+  }
+
+  // the task manager passes exceptions of the threads as Exception
+  static bool IsLocalHeapOverflow (const Exception & e)
+  {
+    return dynamic_cast<const LocalHeapOverflow*> (&e) ||
+      string(e.What()).find ("Local Heap overflow") != string::npos;
+  }
+
+  /*
+    Runs func with the global heap, reserved for the estimate per thread.
+    On a LocalHeap overflow the heap is doubled and func is repeated,
+    func must give the same result when repeated.
+  */
+  static constexpr int max_heap_doublings = 8;
+  template <typename TFUNC>
+  static void RunWithGlobalHeap (size_t size_per_thread, TFUNC func)
+  {
+    ReserveGlobalHeap (size_per_thread);
+    for (int attempt = 0; ; attempt++)
+      try
+        {
+          func ();
+          return;
+        }
+      catch (Exception & e)
+        {
+          if (!IsLocalHeapOverflow (e) || attempt == max_heap_doublings) throw;
+          cout << IM(2) << "LocalHeap overflow, repeat with heapsize " << 2*global_heapsize << endl;
+          SetGlobalHeapSize (2*global_heapsize);
+        }
+  }
+
   
 
   //////////////////////////////////////////////////////////////////////////////////////////
@@ -391,6 +577,38 @@ ANY_DOF: Any used dof (LOCAL_DOF or INTERFACE_DOF or WIREBASKET_DOF)
                                ret.push_back ( make_tuple(mui.Name(), mui.NBytes(), mui.NBlocks()));
                              return ret;
                            })
+    .def("MemoryUsage", [] (const NGS_Object & self)
+         {
+           MemoryUsageTree tree(self.GetMemoryUsage(), self.GetName());
+           self.UpdateMemoryPeak();
+           std::function<py::dict(const MemoryUsageTree&)> todict = [&] (const MemoryUsageTree & node)
+             {
+               py::dict d;
+               d["name"] = node.name;
+               d["bytes"] = node.nbytes;
+               d["blocks"] = node.nblocks;
+               py::list children;
+               for (auto & c : node.children)
+                 children.append (todict(c));
+               d["children"] = children;
+               return d;
+             };
+           py::dict res;
+           res["current"] = tree.nbytes;
+           res["peak"] = self.GetMemoryPeak();
+           res["tree"] = todict(tree);
+           return res;
+         }, docu_string(R"raw_string(
+Memory accounted for the object: current and peak bytes (the peak is
+updated by Assemble, Update and by this call), and the tree of its
+parts, e.g. form -> matrix -> graph/values.
+)raw_string"))
+    .def("PrintMemoryUsage", [] (const NGS_Object & self)
+         {
+           ostringstream ost;
+           ost << MemoryUsageTree(self.GetMemoryUsage(), self.GetName());
+           return ost.str();
+         }, "memory usage as tree, largest parts first")
     ;
 
   //////////////////////////////////////////////////////////////////////////////////////////
@@ -459,13 +677,11 @@ when building the system matrices.
   m.def("SetHeapSize",
         [](size_t heapsize)
         {
-          if (heapsize > global_heapsize)
-            {
-              global_heapsize = heapsize;
-              glh = LocalHeap (heapsize, "python-comp lh", true);
-            }
+          SetGlobalHeapSize (heapsize);
         }, py::arg("size"), docu_string(R"raw_string(
-Set a new heapsize.
+Set a new heapsize. Assembling, Set, Integrate and VTK output enlarge the
+heap to their estimate, and on overflow assembling and Set are repeated
+with the doubled heap, so this is only needed for other functions.
 
 Parameters:
 
@@ -580,10 +796,18 @@ kwargs : kwargs
                     auto fes = CreateFESpace (type, ma, flags);
                     fes->Update();
                     fes->FinalizeUpdate();
+                    if (flags.StringFlagDefined("reorder"))
+                      {
+                        auto refes = make_shared<ReorderedFESpace>(fes, flags);
+                        refes->Update();
+                        refes->FinalizeUpdate();
+                        return shared_ptr<FESpace> (refes);
+                      }
                     return fes;
                   }),
                   py::arg("type"), py::arg("mesh"),
-                  "allowed types are: 'h1ho', 'l2ho', 'hcurlho', 'hdivho' etc."
+                  "allowed types are: 'h1ho', 'l2ho', 'hcurlho', 'hdivho' etc.\n"
+                  "reorder = 'nodes' | 'rcm' | 'hilbert' returns the space with renumbered dofs (see Reorder)"
                   )
 
 
@@ -672,7 +896,8 @@ kwargs : kwargs
          { 
            self->Update();
            self->FinalizeUpdate();
-         },
+           self->UpdateMemoryPeak();
+         }, py::call_guard<py::gil_scoped_release>(),
          "update space after mesh-refinement")
      .def("UpdateDofTables", [](shared_ptr<FESpace> self)
          {
@@ -739,6 +964,9 @@ kwargs : kwargs
 
     .def_property_readonly("is_complex", &FESpace::IsComplex)
 
+    .def("CopyOnMesh", &CopyFESpaceOnMesh, py::arg("mesh"),
+         "new space of the same type and flags on another mesh, e.g. after repartitioning")
+
     .def("SetDefinedOn", [] (FESpace& self, Region& reg)
          {
            self.SetDefinedOn(reg.VB(),reg.Mask());
@@ -835,6 +1063,26 @@ Parameters:
 ni : ngsolve.comp.NodeId
   input node id
 
+)raw_string"))
+
+    .def("CreateSmoothingBlocks", [](shared_ptr<FESpace> self, py::kwargs kwargs)
+         {
+           auto flags = CreateFlagsFromKwArgs(kwargs);
+           shared_ptr<Table<int>> blocks;
+           {
+             py::gil_scoped_release release;
+             blocks = self->CreateSmoothingBlocks(flags);
+           }
+           py::list pyblocks;
+           for (auto block : *blocks)
+             pyblocks.append (MakePyTuple(Array<int>(block)));
+           return pyblocks;
+         }, docu_string(R"raw_string(
+The blocks of the block smoothers (preconditioner 'local' with block=True,
+multigrid with smoother='block'), for CreateBlockSmoother of the matrix.
+
+Flags of the space, e.g. blocktype, for compound spaces also
+vanka='vertex' (star patches with all components) or vanka='element'.
 )raw_string"))
 
     .def ("GetDofs", [](shared_ptr<FESpace> self, Region reg)
@@ -1008,10 +1256,35 @@ component : int
 
     .def("InvM",
          [] (const shared_ptr<FESpace> self,
-             shared_ptr<CoefficientFunction> rho) -> shared_ptr<BaseMatrix>
+             shared_ptr<CoefficientFunction> rho,
+             optional<Region> definedon,
+             bool cached, bool single_precision) -> shared_ptr<BaseMatrix>
          {
-           return make_shared<ApplyMass> (self, rho, true, nullptr, glh); 
-         }, py::arg("rho") = nullptr)
+           shared_ptr<Region> spdefon;
+           if (definedon) spdefon = make_shared<Region> (*definedon);
+           if (cached)
+             return make_shared<CachedInverseMass> (self, rho, spdefon, single_precision, glh);
+           return make_shared<ApplyMass> (self, rho, true, spdefon, glh); 
+         }, py::arg("rho") = nullptr, py::arg("definedon") = nullptr,
+         py::arg("cached") = false, py::arg("single_precision") = false, docu_string(R"raw_string(
+Inverse mass matrix operator.
+
+Parameters:
+
+rho : ngsolve.fem.CoefficientFunction
+  scalar density
+
+definedon : ngsolve.comp.Region
+  elements outside the region are set to zero
+
+cached : bool
+  compute and store the inverse element mass matrices once. Available
+  for every discontinuous space, including Discontinuous(...) wrappers.
+
+single_precision : bool
+  store the cached inverse element matrices in single precision
+
+)raw_string"))
     .def("Mass",
          [] (const shared_ptr<FESpace> self,
              shared_ptr<CoefficientFunction> rho,
@@ -1341,16 +1614,38 @@ BND : boolean or None
 
   py::class_<ReorderedFESpace, shared_ptr<ReorderedFESpace>, FESpace>(m, "Reorder",
 	docu_string(R"delimiter(Reordered Finite Element Spaces.
+
+Wraps any space and renumbers its dofs, GridFunctions and output
+work as for the base space.
+
+Parameters:
+
+fespace : ngsolve.comp.FESpace
+  the space to reorder
+
+reorder : str
+  'nodes': dofs of vertices, edges, faces, cells
+  'rcm': reverse Cuthill-McKee ordering of the element dof graph
+  'hilbert': elements sorted along a Hilbert curve through their centroids,
+  dofs numbered at first appearance
 ...
 )delimiter"))
-    .def(py::init([] (shared_ptr<FESpace> & fes)
+    .def(py::init([] (shared_ptr<FESpace> & fes, string reorder)
                   {
                     Flags flags = fes->GetFlags();
+                    flags.SetFlag ("reorder", reorder);
                     auto refes = make_shared<ReorderedFESpace>(fes, flags);
                     refes->Update();
                     refes->FinalizeUpdate();
                     return refes;
-                  }), py::arg("fespace"))
+                  }), py::arg("fespace"), py::arg("reorder")="nodes")
+    .def_property_readonly("dofmap", [] (shared_ptr<ReorderedFESpace> self)
+                           {
+                             py::list l;
+                             for (auto d : self->GetDofMap())
+                               l.append (d);
+                             return l;
+                           }, "new dof number of every dof of the base space")
     /*
     .def(py::pickle([](const PeriodicFESpace* per_fes)
                     {
@@ -1433,6 +1728,12 @@ active_dofs : BitArray or None
          {
            return self.GetBaseSpace();
          })
+    .def("GetRestriction", [](CompressedFESpace & self) -> shared_ptr<BaseMatrix>
+         {
+           return self.GetRestriction();
+         },
+         "restriction of vectors of the base space to the compressed dofs,\n"
+         "an index view without copies of the dof maps, its transpose is the extension by zero")
     .def(py::pickle([](const CompressedFESpace* compr_fes)
                     {
                       return py::make_tuple(compr_fes->GetBaseSpace(),compr_fes->GetActiveDofs());
@@ -1571,19 +1872,45 @@ active_dofs : BitArray or None
     .def("__str__", [] (GF & self) { return ToString(self); } )
     .def_property_readonly("space", [](GF & self) { return self.GetFESpace(); },
                            "the finite element space")
-    .def("Update", [](GF& self) { self.Update(); },
+    .def("Update", [](GF& self) { self.Update(); }, py::call_guard<py::gil_scoped_release>(),
          "update vector size to finite element space dimension after mesh refinement")
     
-    .def("Save", [](GF& self, string filename, bool parallel)
+    .def("Save", [](GF& self, string filename, bool parallel, bool background)
          {
-           ofstream out(filename, ios::binary);
+           if (!background)
+             {
+               ofstream out(filename, ios::binary);
+               if (parallel)
+                 self.Save(out);
+               else
+                 for (auto d : self.GetVector().FVDouble())
+                   SaveBin(out, d);
+               return;
+             }
+           // the bytes are formatted now, written by the output thread
+           auto data = make_shared<string>();
            if (parallel)
-             self.Save(out);
+             {
+               ostringstream out(ios::binary);
+               self.Save(out);
+               *data = out.str();
+             }
            else
-             for (auto d : self.GetVector().FVDouble())
-               SaveBin(out, d);
+             {
+               FlatVector<double> fv = self.GetVector().FVDouble();
+               data->resize (fv.Size()*sizeof(double));
+               memcpy (&(*data)[0], fv.Data(), data->size());
+             }
+           OutputQueue::Global().Add ([filename, data] ()
+                                      {
+                                        ofstream out(filename, ios::binary);
+                                        out.write (data->data(), data->size());
+                                        if (!out)
+                                          throw Exception ("GridFunction.Save: writing " + filename + " failed");
+                                      }, data->size());
          },
-         py::arg("filename"), py::arg("parallel")=false, docu_string(R"raw_string(
+         py::arg("filename"), py::arg("parallel")=false, py::arg("background")=false,
+         py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
 Saves the gridfunction into a file.
 
 Parameters:
@@ -1594,6 +1921,10 @@ filename : string
 parallel : bool
   input parallel
 
+background : bool
+  copy the values, the file is written by a background thread,
+  WaitOutput() waits until it is written
+
 )raw_string"))
     .def("Load", [](GF& self, string filename, bool parallel)
          {
@@ -1615,6 +1946,36 @@ filename : string
 parallel : bool
   input parallel
 
+)raw_string"))
+    .def("SaveCheckpoint", [](GF& self, string filename)
+         {
+           self.SaveCheckpoint(filename);
+         },
+         py::arg("filename"), docu_string(R"raw_string(
+Writes the coefficient vectors into a binary checkpoint file.
+With MPI every rank writes its own file 'filename.<rank>'.
+The checkpoint stores space type, order and a hash of the dof layout,
+it can only be loaded into the same space on the same distributed mesh.
+
+Parameters:
+
+filename : string
+  output file name
+
+)raw_string"))
+    .def("LoadCheckpoint", [](GF& self, string filename)
+         {
+           self.LoadCheckpoint(filename);
+         },
+         py::arg("filename"), docu_string(R"raw_string(
+Loads the coefficient vectors from a checkpoint written by SaveCheckpoint.
+Throws if the space or dof layout do not match.
+
+Parameters:
+
+filename : string
+  input file name
+
 )raw_string"))
     .def("Set", 
          [](shared_ptr<GF> self, spCF cf,
@@ -1632,10 +1993,14 @@ parallel : bool
               Transfer2TPMesh(cf.get(),self.get(),glh);
               return;
             }            
-            if (reg)
-              SetValues (cf, *self, *reg, NULL, glh, dualdiffop, use_simd);
-            else
-              SetValues (cf, *self, vb, NULL, glh, dualdiffop, use_simd);
+            RunWithGlobalHeap (self->GetFESpace()->EstimateHeapSize (reg ? reg->VB() : vb, 0, cf->Dimension()),
+                               [&] ()
+                               {
+                                 if (reg)
+                                   SetValues (cf, *self, *reg, NULL, glh, dualdiffop, use_simd);
+                                 else
+                                   SetValues (cf, *self, vb, NULL, glh, dualdiffop, use_simd);
+                               });
          },
          py::arg("coefficient"),
          py::arg("VOL_or_BND")=VOL,
@@ -1690,6 +2055,14 @@ use_simd : bool
                    },
                   "list of coefficient vectors for multi-dim gridfunction")
 
+    .def_property_readonly("multivector",
+                           [](shared_ptr<GF> self) { return self->GetMultiVector(); },
+                           "all multi-dim coefficient vectors as one MultiVector, without copy (real, not distributed)")
+
+    .def("AddMultiDimComponent", [](shared_ptr<GF> self, BaseVector & vec)
+         { self->AddMultiDimComponent (vec); }, py::arg("vec"),
+         "increases multidim by one, the new component is a copy of vec")
+
     .def("Deriv",
          [](shared_ptr<GF> self) -> spCF
           {
@@ -1924,6 +2297,7 @@ diffop : ngsolve.fem.DifferentialOperator
     ;
      
   py::class_<SumOfIntegrals, shared_ptr<SumOfIntegrals>>(m, "SumOfIntegrals")
+    .def(py::init<shared_ptr<Integral>>(), py::arg("integral"))
     .def(py::self + py::self)
     .def(py::self - py::self)
     .def(float() * py::self)
@@ -2015,6 +2389,49 @@ space : ngsolve.FESpace
                      "  mesh refinements are updated as well using a Galerkin projection\n"
                      "  of the matrix on the finest grid. This is needed to use the multigrid\n"
                      "  preconditioner with a changing bilinearform.",
+                     py::arg("atomic_assembly") = "bool = False\n"
+                     "  Assemble all elements in one parallel loop and add element\n"
+                     "  matrices with atomic operations instead of iterating over\n"
+                     "  element colors. Compare timers 'Matrix assembling vol, colored'\n"
+                     "  and 'Matrix assembling vol, atomic'.",
+                     py::arg("reuse_graph") = "bool = False\n"
+                     "  Keep the sparsity pattern in a cache and share it with other\n"
+                     "  BilinearForms on the same (unchanged) spaces using this flag.\n"
+                     "  Saves the graph construction when many forms are assembled.",
+                     py::arg("setupcache") = "str = $NGS_SETUP_CACHE\n"
+                     "  Directory for a warm-start file of the matrix graph, loaded if mesh\n"
+                     "  and spaces are unchanged, otherwise computed and written.",
+                     py::arg("batch_assembly") = "bool = False\n"
+                     "  Compute element matrices of SIMD-width batches of elements with\n"
+                     "  the same type and order together (elements in SIMD lanes).\n"
+                     "  Pays off for low order elements with few integration points.",
+                     py::arg("assembly_buffer") = "int = 0\n"
+                     "  Every thread computes this number of element matrices into\n"
+                     "  a buffer before they are added to the matrix, separating the\n"
+                     "  compute-bound and memory-bound phases of assembling.\n"
+                     "  With condensation and keep_internal the interior blocks of the\n"
+                     "  buffer are inverted together, batched by block size.",
+                     py::arg("sort_scatter") = "bool = False\n"
+                     "  Add buffered element matrices ordered by their smallest dof.",
+                     py::arg("variable_blocks") = "bool = False\n"
+                     "  Keeps a copy of the assembled matrix as blocks of consecutive rows\n"
+                     "  with equal columns (the dofs of one node), available as vbmat.\n"
+                     "  It stores fewer column indices and provides a block smoother.",
+                     py::arg("parameter_splitting") = "bool = False\n"
+                     "  If the integrands are affine in Parameters, e.g. m + dt*k, the components\n"
+                     "  are assembled once and Assemble() combines their values for the current\n"
+                     "  Parameters. The form must depend on time only through the Parameters.",
+                     py::arg("condense_float") = "bool = False\n"
+                     "  With condense and keep_internal, the harmonic extensions and the\n"
+                     "  inner solve are stored in single precision, and computed in double.",
+                     py::arg("condense_share") = "bool = False\n"
+                     "  With condense and keep_internal, equal element matrices of the\n"
+                     "  harmonic extensions and the inner solve (e.g. on structured meshes)\n"
+                     "  are stored once and applied to all their elements together.",
+                     py::arg("fuse_integrals") = "bool = True\n"
+                     "  Integrals added together which have the same domain, element-boundary\n"
+                     "  and skeleton flags and integration rule become one integrator, so\n"
+                     "  geometry and shape functions are evaluated once per element.",
 		     py::arg("nonsym_storage") = "bool = False\n"
 		     "  The full matrix is stored, even if the symmetric flag is set.",
                      py::arg("diagonal") = "bool = False\n"
@@ -2023,7 +2440,10 @@ space : ngsolve.FESpace
                      "  when element matrices are independent of geometry, we store them \n"
                      "  only for the referecne elements",
                      py::arg("check_unused") = "bool = True\n"
-		     "  If set prints warnings if not UNUSED_DOFS are not used."
+		     "  If set prints warnings if not UNUSED_DOFS are not used.",
+                     py::arg("store_elmats") = "bool = False\n"
+                     "  Keep the element matrices after assembling. Then\n"
+                     "  AssembleElements can update the matrix for a subset of elements."
                      );
                 })
 
@@ -2044,6 +2464,8 @@ integrator : ngsolve.fem.BFI
     .def("__iadd__",[](BF& self, shared_ptr<BilinearFormIntegrator> other) -> BilinearForm& { self += other; return self; }, py::arg("other") )
     .def("__iadd__", [](BF & self, shared_ptr<SumOfIntegrals> sum) -> BilinearForm& 
          {
+           if (self.FuseIntegrals())
+             sum = sum->Fuse();
            for (auto icf : sum->icfs)
              {
                auto & dx = icf->dx;
@@ -2117,7 +2539,8 @@ integrator : ngsolve.fem.BFI
     
     .def("Assemble", [](BF & self, bool reallocate)
          {
-           self.ReAssemble(glh,reallocate);
+           RunWithGlobalHeap (self.EstimateHeapSize(), [&] () { self.ReAssemble(glh,reallocate); });
+           self.UpdateMemoryPeak();
          }, py::call_guard<py::gil_scoped_release>(),
          py::arg("reallocate")=false, docu_string(R"raw_string(
 Assemble the bilinear form.
@@ -2129,6 +2552,38 @@ reallocate : bool
 
 )raw_string"))
 
+    .def("AssembleElements", [](BF & self, shared_ptr<BitArray> elements, VorB vb)
+         {
+           self.ReAssembleElements(vb, *elements, glh);
+         }, py::call_guard<py::gil_scoped_release>(),
+         py::arg("elements"), py::arg("vb")=VOL, docu_string(R"raw_string(
+Re-compute the element matrices of the marked elements, and update the
+assembled matrix. Requires the flag 'store_elmats'.
+
+Parameters:
+
+elements : ngsolve.BitArray
+  elements to re-assemble
+
+vb : ngsolve.VorB
+  element type (VOL, BND, ...)
+
+)raw_string"))
+
+#ifdef CUDA
+    .def("AssembleDevice", [](shared_ptr<BF> self)
+         {
+           return AssembleOnDevice (*self, glh);
+         }, py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+Assemble the matrix on the device, returns a device sparse matrix.
+Integrators with element-wise constant coefficients in values and
+gradients of an H1 space on affine elements are assembled by cuda
+kernels, the other element matrices are computed on the host.
+The matrix of the bilinear-form is not changed.
+
+)raw_string"))
+#endif
+
     .def_property_readonly("mat", [](shared_ptr<BF> self) -> shared_ptr<BaseMatrix>
                                          {
                                            if (self->NonAssemble())
@@ -2139,6 +2594,22 @@ reallocate : bool
                                            return mat;
                                          }, "matrix of the assembled bilinear form")
 
+    .def_property_readonly("vbmat", [](shared_ptr<BF> self) -> shared_ptr<BaseMatrix>
+                                         {
+                                           auto mat = self->GetVariableBlockMatrix();
+                                           if (!mat)
+                                             throw py::type_error("no variable-block matrix - assemble with flag variable_blocks");
+                                           return mat;
+                                         }, "variable-block copy of the matrix, with flag variable_blocks")
+
+    .def_property_readonly("split_parameters", [](shared_ptr<BilinearForm> self)
+                           {
+                             py::list params;
+                             for (auto & p : self->GetSplitParameters())
+                               params.append (py::cast(p));
+                             return params;
+                           }, "the Parameters of the cached components, with flag parameter_splitting")
+
     .def_property_readonly("components", [](shared_ptr<BilinearForm> self)-> py::list
                    { 
                      py::list bfs;
@@ -2193,6 +2664,16 @@ x : ngsolve.BaseVector
 y : ngsolve.BaseVector
   output vector
 
+)raw_string"))
+
+    .def("DGOperator", [](shared_ptr<BF> self) -> shared_ptr<BaseMatrix>
+          {
+            return make_shared<DGBilinearFormApplication> (self, glh);
+          }, docu_string(R"raw_string(
+Matrix-free operator for DG forms consisting of volume and facet-wise
+skeleton integrators. The facet topology is computed once, element and
+facet terms are applied in one parallel pass over the facet coloring.
+
 )raw_string"))
 
     .def("ComputeInternal", [](BF & self, BaseVector & u, BaseVector & f)
@@ -2366,7 +2847,8 @@ integrator : ngsolve.fem.LFI
                            { return MakePyTuple (self->Integrators()); }, "returns tuple of integrators of the linear form")
 
     .def("Assemble", [](shared_ptr<LF> self)
-         { self->Assemble(glh); }, py::call_guard<py::gil_scoped_release>(), "Assemble linear form")
+         { RunWithGlobalHeap (self->EstimateHeapSize(), [&] () { self->Assemble(glh); }); },
+         py::call_guard<py::gil_scoped_release>(), "Assemble linear form")
     
     .def_property_readonly("components", [](shared_ptr<LF> self)
                    { 
@@ -2445,14 +2927,85 @@ integrator : ngsolve.fem.LFI
                     "  Smoother between multigrid levels, available options are:\n"
                     "    'point': Gauss-Seidel-Smoother\n"
                     "    'line':  Anisotropic smoother\n"
-                    "    'block': Block smoother";
+                    "    'block': Block smoother\n"
+                    "    'chebyshev': Jacobi-Chebyshev polynomial smoother";
+                  mg_flags["chebyshevorder"] = "int = 3\n"
+                    "  Polynomial degree of the Chebyshev smoother";
+                  mg_flags["chebyshevratio"] = "double = 30\n"
+                    "  Chebyshev smoother damps [lam_max/ratio, lam_max], lam_max is estimated";
                   mg_flags["coarsetype"] = "string = direct\n"
                     "  How to solve coarse problem.";
                   mg_flags["coarsesmoothingsteps"] = "int = 1\n"
                     "  If coarsetype is smoothing, then how many smoothingsteps will be done.";
                   mg_flags["updatealways"] = "bool = False\n";
+                  mg_flags["galerkin"] = "bool = False\n"
+                    "  Coarse level matrices are P^T A P of the finest matrix, computed by a parallel\n"
+                    "  sparse product which is reused while the matrix graphs do not change";
+                  mg_flags["statistics"] = "bool = False\n"
+                    "  Collect per level timings, work estimates and residuals, see GetStatistics";
                   return mg_flags;
                 })
+    .def("SetStatistics", [](MGPreconditioner & self, bool stat)
+         { self.GetMultigrid()->SetStatistics(stat); },
+         py::arg("enable")=true,
+         "Collect per level data of the multigrid cycles, costs one extra residual per level")
+    .def("ResetStatistics", [](MGPreconditioner & self)
+         { self.GetMultigrid()->ResetStatistics(); })
+    .def("GetStatistics", [](MGPreconditioner & self)
+         {
+           static const char * phase_names[ngmg::MG_NPHASES] =
+             { "smooth", "residual", "restrict", "prolongate", "coarse" };
+           py::list levels;
+           auto stats = self.GetMultigrid()->GetLevelStatistics();
+           for (auto l : Range(stats))
+             {
+               auto & st = stats[l];
+               py::dict d;
+               d["level"] = l;
+               d["ndof"] = st.ndof;
+               d["visits"] = st.visits;
+               double total = 0;
+               py::dict times;
+               for (int ph = 0; ph < ngmg::MG_NPHASES; ph++)
+                 {
+                   times[phase_names[ph]] = st.time[ph];
+                   total += st.time[ph];
+                 }
+               d["time"] = times;
+               d["totaltime"] = total;
+               d["flops"] = st.flops;
+               d["bytes"] = st.bytes;
+               d["res_in"] = st.res_in;
+               d["res_presmooth"] = st.res_presmooth;
+               d["res_out"] = st.res_out;
+               d["reduction"] = st.res_in > 0 ? st.res_out / st.res_in : 0.0;
+               levels.append (d);
+             }
+           return levels;
+         },
+         "Per level data since the last reset, level 0 is the coarsest. Times are summed over "
+         "all visits, residual norms and their reduction are from the last visit of the level.")
+    ;
+
+  py::class_<H1AMG_Matrix<double>, shared_ptr<H1AMG_Matrix<double>>, BaseMatrix>
+    (m, "H1AMGMatrix", "H1AMG for an assembled matrix, e.g. the Galerkin product in an auxiliary space.\n"
+     "Edges and their weights are taken from the off-diagonal entries")
+    .def(py::init([] (shared_ptr<SparseMatrix<double>> mat, shared_ptr<BitArray> freedofs,
+                      string smoother, size_t coarsesize)
+                  {
+                    H1AMG_SMOOTHER smoother_type = H1AMG_BLOCK_GS;
+                    if (smoother == "chebyshev")
+                      smoother_type = H1AMG_CHEBYSHEV;
+                    else if (smoother == "l1jacobi")
+                      smoother_type = H1AMG_L1JACOBI;
+                    else if (smoother != "block")
+                      throw Exception ("H1AMGMatrix: unknown smoother '" + smoother + "', use block, chebyshev or l1jacobi");
+                    return CreateH1AMGMatrix (mat, freedofs, smoother_type, coarsesize);
+                  }), py::arg("mat"), py::arg("freedofs") = nullptr, py::arg("smoother") = "block",
+         py::arg("coarsesize") = 10, py::call_guard<py::gil_scoped_release>())
+    .def("Update", [] (H1AMG_Matrix<double> & self, shared_ptr<SparseMatrix<double>> mat)
+         { self.UpdateValues (mat); }, py::arg("mat"), py::call_guard<py::gil_scoped_release>(),
+         "new values of a matrix with the same graph, the hierarchy is kept")
     ;
 
   //////////////////////////////////////////////////////////////////////////////////////////
@@ -2677,15 +3230,132 @@ integrator : ngsolve.fem.LFI
     .def_property_readonly ("numprocs", [](shared_ptr<PDE> self) { return py::cast(self->GetNumProcTable()); })
     ;
   
+  m.def("Integrate", 
+        [](py::list cfs_list, shared_ptr<MeshAccess> ma, VorB vb, int order,
+           Region * definedon, bool region_wise) -> py::list
+        {
+          static Timer t("Integrate CF list"); RegionTimer reg(t);
+          Array<spCF> cfs;
+          for (auto item : cfs_list)
+            cfs.Append (py::cast<spCF> (item));
+          if (!cfs.Size()) return py::list();
+          int totdim = 0;
+          for (auto & cf : cfs) totdim += cf->Dimension();
+          ReserveGlobalHeap (IntegrateHeapSize (*ma, order, totdim));
+
+          BitArray mask;
+          if (definedon)
+            {
+              vb = VorB(*definedon);
+              mask = BitArray((*definedon).Mask());
+            }
+          if(!mask.Size()){
+            mask = BitArray(ma->GetNRegions(vb));
+            mask.Set();
+          }
+          
+          bool iscomplex = false;
+          for (auto cf : cfs)
+            {
+              iscomplex |= cf->IsComplex();
+              cf -> TraverseTree
+                ([&] (CoefficientFunction & stepcf)
+                 {
+                   if (dynamic_cast<ProxyFunction*>(&stepcf))
+                     throw Exception("Cannot integrate ProxFunction!");
+                 });
+            }
+          // all functions are evaluated together in one pass over the elements
+          auto vcf = cfs.Size() == 1 ? cfs[0] : MakeVectorialCoefficientFunction (Array<spCF>(cfs));
+
+          auto integrate = [&] (auto scal) -> py::list
+            {
+              typedef decltype(scal) SCAL;
+              Matrix<SCAL> sums;
+              {
+                py::gil_scoped_release release;
+                auto elvals = ElementIntegrals<SCAL> (vcf, ma, vb, order, mask);
+                if (region_wise)
+                  {
+                    auto rsums = RegionSums<SCAL> (elvals, *ma, vb);
+                    sums.SetSize (rsums.Height(), rsums.Width());
+                    sums = rsums;
+                  }
+                else
+                  {
+                    sums.SetSize (1, elvals.Width());
+                    sums.Row(0) = PairwiseRowSum<SCAL> (elvals);
+                  }
+                AllReduceSum<SCAL> (ma->GetCommunicator(), sums.AsVector());
+              }
+              py::list result;
+              size_t first = 0;
+              for (auto cf : cfs)
+                {
+                  int dim = cf->Dimension();
+                  if (region_wise)
+                    {
+                      if (dim == 1)
+                        result.append (py::cast (Vector<SCAL> (sums.Col(first))));
+                      else
+                        result.append (py::cast (Matrix<SCAL> (sums.Cols(first, first+dim))));
+                    }
+                  else if (dim == 1)
+                    result.append (py::cast (sums(0, first)));
+                  else
+                    result.append (py::cast (Vector<SCAL> (sums.Row(0).Range(first, first+dim))));
+                  first += dim;
+                }
+              return result;
+            };
+          if (iscomplex)
+            return integrate (Complex(0));
+          return integrate (double(0));
+        },
+	py::arg("cfs"), py::arg("mesh"), py::arg("VOL_or_BND")=VOL, 
+	py::arg("order")=5,
+	py::arg("definedon") = nullptr,
+        py::arg("region_wise")=false,
+        R"raw(
+Integrates a list of CoefficientFunctions in one pass over the elements,
+returns a list with the integral of each function. Element integrals are
+summed in a fixed pairwise order, the results do not depend on the number
+of threads.
+
+Parameters
+----------
+
+cfs: list of ngsolve.CoefficientFunction
+  Functions to be integrated, can be vector valued.
+
+mesh: ngsolve.Mesh
+  The mesh to be integrated on.
+
+VOL_or_BND: ngsolve.VorB = VOL
+  Co-dimension to be integrated on.
+
+order: int = 5
+  Integration order, polynomials up to this order will be integrated exactly.
+
+definedon: ngsolve.Region
+  Region to be integrated on, overwrites VOL_or_BND.
+
+region_wise: bool = False
+  Integrates region wise, every entry of the result is an array over the regions
+  (a matrix regions x components for vector valued functions).
+)raw")
+    ;
+
   m.def("Integrate", 
         [](spCF cf,
            shared_ptr<MeshAccess> ma, 
            VorB vb, int order,
            // std::optional<Region> definedon,
            Region * definedon,
-	   bool region_wise, bool element_wise)
+	   bool region_wise, bool element_wise, bool deterministic)
         {
           static Timer t("Integrate CF"); RegionTimer reg(t);
+          ReserveGlobalHeap (IntegrateHeapSize (*ma, order, cf->Dimension()));
           // static mutex addcomplex_mutex;
           BitArray mask;
           if (definedon)
@@ -2718,7 +3388,75 @@ integrator : ngsolve.fem.LFI
               region_sum = 0;
               element_sum = 0;
               bool use_simd = true;
+              bool batched = false;
+
+              if (deterministic)
+                {
+                  auto elvals = ElementIntegrals<double> (cf, ma, vb, order, mask);
+                  sum = PairwiseRowSum<double> (elvals);
+                  if (region_wise)
+                    region_sum = RegionSums<double> (elvals, *ma, vb).Col(0);
+                  if (element_wise)
+                    element_sum = elvals.Col(0);
+                }
               
+              if (!deterministic && !region_wise && !element_wise && !cf->DependsOnElement())
+                {
+                  // function of the points only: evaluate blocks of elements in one call
+                  static Timer tb("Integrate CF - batched"); RegionTimer regb(tb);
+                  constexpr size_t blocksize = 64;
+                  atomic<bool> nosimd(false);
+                  ParallelForRange
+                    (ma->GetNE(vb), [&] (IntRange r)
+                     {
+                       LocalHeap lh = glh.Split();
+                       for (size_t first = r.First(); first < r.Next(); first += blocksize)
+                         {
+                           HeapReset hr(lh);
+                           ArrayMem<const SIMD_BaseMappedIntegrationRule*, blocksize> mirs;
+                           for (size_t nr = first; nr < min(first+blocksize, size_t(r.Next())); nr++)
+                             {
+                               ElementId ei(vb, nr);
+                               if (!mask.Test(ma->GetElIndex(ei))) continue;
+                               auto & trafo = ma->GetTrafo (ei, lh);
+                               SIMD_IntegrationRule ir(trafo.GetElementType(), order);
+                               mirs.Append (&trafo(ir, lh));
+                             }
+
+                           size_t npts = 0;
+                           for (auto mir : mirs) npts += mir->Size();
+                           FlatMatrix<SIMD<double>> values(dim, npts, lh);
+                           try
+                             {
+                               cf -> Evaluate (mirs, values, lh);
+                             }
+                           catch (ExceptionNOSIMD e)
+                             {
+                               nosimd = true;
+                               return;
+                             }
+
+                           FlatVector<SIMD<double>> vsum(dim, lh);
+                           vsum = 0;
+                           size_t ii = 0;
+                           for (auto mir : mirs)
+                             for (size_t i = 0; i < mir->Size(); i++, ii++)
+                               for (size_t j = 0; j < dim; j++)
+                                 vsum(j) += (*mir)[i].GetWeight() * values(j,ii);
+                           for (size_t j = 0; j < dim; j++)
+                             AtomicAdd(sum(j), HSum(vsum(j)));
+                         }
+                     });
+                  batched = !nosimd;
+                  if (nosimd)
+                    {
+                      // fall back to the element loop
+                      use_simd = false;
+                      sum = 0.0;
+                    }
+                }
+
+              if (!batched && !deterministic)
               ma->IterateElements
                 (vb, glh, [&] (Ngs_Element el, LocalHeap & lh)
                  {
@@ -2815,7 +3553,17 @@ integrator : ngsolve.fem.LFI
               element_sum = 0;
               
               bool use_simd = true;
-              
+
+              if (deterministic)
+                {
+                  auto elvals = ElementIntegrals<Complex> (cf, ma, vb, order, mask);
+                  sum = PairwiseRowSum<Complex> (elvals);
+                  if (region_wise)
+                    region_sum = RegionSums<Complex> (elvals, *ma, vb).Col(0);
+                  if (element_wise)
+                    element_sum = elvals.Col(0);
+                }
+              else
               ma->IterateElements
                 (vb, glh, [&] (Ngs_Element el, LocalHeap & lh)
                  {
@@ -2911,6 +3659,7 @@ integrator : ngsolve.fem.LFI
 	py::arg("definedon") = nullptr, // =DummyArgument(),
         py::arg("region_wise")=false,
 	py::arg("element_wise")=false,
+        py::arg("deterministic")=false,
         R"raw(
 Parameters
 ----------
@@ -2941,6 +3690,9 @@ region_wise: bool = False
 element_wise: bool = False
   Integrates element wise and returns result in a list. This is typically used for local error estimators.
   Does not support vector valued CoefficientFunctions
+
+deterministic: bool = False
+  Sum element integrals in a fixed pairwise order, the result does not depend on the number of threads.
 )raw",
         py::call_guard<py::gil_scoped_release>())
     ;
@@ -3353,6 +4105,39 @@ deformation : ngsolve.comp.GridFunction
             py::arg("flags")=Flags()
            );
 
+   m.def("TensorProductMatrix", [](shared_ptr<FESpace> fes, py::list terms) -> shared_ptr<BaseMatrix>
+           {
+             auto tpfes = dynamic_pointer_cast<TPHighOrderFESpace>(fes);
+             if (!tpfes)
+               throw Exception("TensorProductMatrix needs a TensorProductFESpace");
+             Array<shared_ptr<BaseMatrix>> xmats, ymats;
+             for (auto term : terms)
+               {
+                 auto pair = py::cast<py::tuple>(term);
+                 if (pair.size() != 2)
+                   throw Exception("TensorProductMatrix: terms must be pairs (matx, maty)");
+                 xmats.Append (py::cast<shared_ptr<BaseMatrix>>(pair[0]));
+                 ymats.Append (py::cast<shared_ptr<BaseMatrix>>(pair[1]));
+               }
+             return make_shared<TPKroneckerMatrix> (tpfes, xmats, ymats);
+           },
+         py::arg("fes"), py::arg("terms"),
+         docu_string(R"raw_string(
+Kronecker structured operator sum_k matx_k (x) maty_k on a TensorProductFESpace.
+The product is computed as matx_k * U * maty_k^T for the coefficient vector
+viewed as a (ndof_x x ndof_y) matrix U, in parallel over the rows.
+
+Parameters:
+
+fes : ngsolve.FESpace
+  scalar TensorProductFESpace of two spaces
+
+terms : list
+  list of pairs (matx, maty) of assembled sparse matrices on the x- and y-space,
+  e.g. [(ax.mat, my.mat), (mx.mat, ay.mat)]
+
+)raw_string"));
+
    m.def("TensorProductIntegrate", [](shared_ptr<GF> gf_tp, py::list ax0, spCF coef) -> double
            {
              static Timer tall("comp.TensorProductIntegrate - single point"); RegionTimer rall(tall);
@@ -3552,7 +4337,8 @@ deformation : ngsolve.comp.GridFunction
 
    py::class_<BaseVTKOutput, shared_ptr<BaseVTKOutput>>(m, "VTKOutput")
     .def(py::init([] (shared_ptr<MeshAccess> ma, py::list coefs_list,
-                      py::list names_list, string filename, int subdivision, int only_element)
+                      py::list names_list, string filename, int subdivision, int only_element,
+                      string format, bool background)
          -> shared_ptr<BaseVTKOutput>
          {
            Array<shared_ptr<CoefficientFunction> > coefs
@@ -3561,9 +4347,9 @@ deformation : ngsolve.comp.GridFunction
              = makeCArray<string> (names_list);
            shared_ptr<BaseVTKOutput> ret;
            if (ma->GetDimension() == 2)
-             ret = make_shared<VTKOutput<2>> (ma, coefs, names, filename, subdivision, only_element);
+             ret = make_shared<VTKOutput<2>> (ma, coefs, names, filename, subdivision, only_element, format, background);
            else
-             ret = make_shared<VTKOutput<3>> (ma, coefs, names, filename, subdivision, only_element);
+             ret = make_shared<VTKOutput<3>> (ma, coefs, names, filename, subdivision, only_element, format, background);
            return ret;
          }),
          py::arg("ma"),
@@ -3571,28 +4357,60 @@ deformation : ngsolve.comp.GridFunction
          py::arg("names") = py::list(),
          py::arg("filename") = "vtkout",
          py::arg("subdivision") = 0,
-         py::arg("only_element") = -1
+         py::arg("only_element") = -1,
+         py::arg("format") = "vtk",
+         py::arg("background") = false,
+         docu_string(R"raw_string(
+Output of coefficient functions on the (subdivided) mesh for Paraview.
+
+format : string
+  'vtk' for legacy ASCII files, 'vtu' for XML files with appended
+  binary data. With MPI and 'vtu' every rank writes a piece
+  filename_<rank>.vtu, rank 0 writes filename.pvtu.
+
+background : bool
+  Do evaluates the fields, formatting and writing the files is done
+  by a background thread. WaitOutput() waits until all files are written.
+)raw_string")
          )
      .def("Do", [](shared_ptr<BaseVTKOutput> self, VorB vb)
           { 
+            ReserveGlobalHeap (self->EstimateHeapSize());
             self->Do(glh,vb);
           },
           py::arg("vb")=VOL,
           py::call_guard<py::gil_scoped_release>())
      .def("Do", [](shared_ptr<BaseVTKOutput> self, VorB vb, const BitArray * drawelems)
           { 
+            ReserveGlobalHeap (self->EstimateHeapSize());
             self->Do(glh, vb, drawelems);
           },
           py::arg("vb")=VOL,
           py::arg("drawelems"),
           py::call_guard<py::gil_scoped_release>())
+     .def("Do", [](shared_ptr<BaseVTKOutput> self, double time, VorB vb)
+          { 
+            ReserveGlobalHeap (self->EstimateHeapSize());
+            self->Do(glh, time, vb);
+          },
+          py::arg("time"),
+          py::arg("vb")=VOL,
+          py::call_guard<py::gil_scoped_release>(),
+          docu_string(R"raw_string(
+Output of one step of a time series. The steps are collected in
+filename.pvd, points and cells are reused as long as the mesh
+does not change.
+)raw_string"))
+     .def("Wait", [](shared_ptr<BaseVTKOutput> self) { OutputQueue::Global().Wait(); },
+          py::call_guard<py::gil_scoped_release>(),
+          "waits until the background output is written")
      ;
 
    
    m.def("ConvertOperator", [&](shared_ptr<FESpace> spacea, shared_ptr<FESpace> spaceb,
 				shared_ptr<ProxyFunction> trial_proxy, optional<Region> definedon,
 				VorB vb, shared_ptr<BitArray> range_dofs, bool localop, bool parmat, bool use_simd,
-				int bonus_io_ab, int bonus_io_bb) -> shared_ptr<BaseMatrix> {
+				int bonus_io_ab, int bonus_io_bb, bool cache) -> shared_ptr<BaseMatrix> {
 
 	   const Region* reg = NULL;
 	   if( definedon.has_value() ) {
@@ -3603,7 +4421,7 @@ deformation : ngsolve.comp.GridFunction
 	   shared_ptr<BaseMatrix> op;
 
 	   if ( trial_proxy == nullptr )
-	     { op = ConvertOperator(spacea, spaceb, vb, glh, nullptr, reg, range_dofs, localop, parmat, use_simd, bonus_io_ab, bonus_io_bb); }
+	     { op = ConvertOperator(spacea, spaceb, vb, glh, nullptr, reg, range_dofs, localop, parmat, use_simd, bonus_io_ab, bonus_io_bb, cache); }
 	   else {
 	     if ( !trial_proxy->IsTrialFunction() )
 	       { throw Exception("Need a trial-proxy, but got a test-proxy!"); }
@@ -3618,7 +4436,7 @@ deformation : ngsolve.comp.GridFunction
 	       { throw Exception("ProxyFunction has no BBBND evaluator!"); }
 	     if ( eval == nullptr )
 	       { throw Exception(string("trial-proxy has no evaluator vor vb = ") + to_string(vb) + string("!")); }
-	     op = ConvertOperator(spacea, spaceb, vb, glh, eval, reg, range_dofs, localop, parmat, use_simd, bonus_io_ab, bonus_io_bb);
+	     op = ConvertOperator(spacea, spaceb, vb, glh, eval, reg, range_dofs, localop, parmat, use_simd, bonus_io_ab, bonus_io_bb, cache);
 	   }
 
 	   return op;
@@ -3633,6 +4451,7 @@ deformation : ngsolve.comp.GridFunction
 	 py::arg("use_simd") = true,
 	 py::arg("bonus_intorder_ab") = 0,
 	 py::arg("bonus_intorder_bb") = 0,
+	 py::arg("cache") = false,
      docu_string(R"raw_string(
 A conversion operator between FESpaces. Embedding if spacea is a subspace of spaceb, otherwise an interpolation operator defined by element-wise application of dual shapes (and averaging between elements).
 
@@ -3668,9 +4487,140 @@ use_simd:
 bonus_intorder_ab/bb: int
   Bonus integration order for spacea/spaceb and spaceb/spaceb integrals. Can be useful for curved elements. Should only be necessary for
 spacea/spaceb integrals.
+
+cache: bool
+  True -> keep the operator and return the same matrix again for the same arguments, until spacea, spaceb
+or the mesh are updated. The returned matrix must not be modified.
 )raw_string")
 	 );
 
+   m.def("MeshTransferOperator", [](shared_ptr<FESpace> spacea, shared_ptr<FESpace> spaceb, int bonus_intorder)
+         {
+           return MeshTransferOperator(spacea, spaceb, glh, bonus_intorder);
+         }, py::arg("spacea"), py::arg("spaceb"), py::arg("bonus_intorder") = 0,
+         py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+Transfer operator from spacea to spaceb on a different, non-matching mesh, e.g. after remeshing.
+Local L2-projection onto the elements of spaceb, averaged between elements, as GridFunction.Set.
+The integration points are located once in the mesh of spacea, the operator is a sparse
+matrix for repeated application: gfb.vec.data = op * gfa.vec
+
+bonus_intorder: int
+  added to the integration order order(spacea)+order(spaceb)
+)raw_string"));
+
+   py::class_<RegionInterpolator, shared_ptr<RegionInterpolator>> (m, "RegionInterpolator", docu_string(R"raw_string(
+Cached interpolation into the dofs of a region, e.g. boundary data set every time step.
+The local projections of GridFunction.Set are computed once on the geometry at construction.
+
+ip = RegionInterpolator(fes, mesh.Boundaries("inflow"))
+ip.Set(cf, gfu)     # in the time loop
+
+Only the dofs of the region are written, the other entries of gfu are kept.
+)raw_string"))
+     .def(py::init([](shared_ptr<FESpace> fes, Region region)
+                   {
+                     return make_shared<RegionInterpolator> (fes, region, glh);
+                   }), py::arg("space"), py::arg("region"),
+          py::call_guard<py::gil_scoped_release>())
+     .def("Set", [](RegionInterpolator & self, spCF cf, GF & gf)
+          {
+            self.Set (cf, gf, glh);
+          }, py::arg("cf"), py::arg("gf"),
+          py::call_guard<py::gil_scoped_release>(),
+          "sets the region dofs of gf to the interpolant of cf")
+     .def_property_readonly("nelements", &RegionInterpolator::NElements)
+     .def_property_readonly("dofs", [](RegionInterpolator & self)
+                            {
+                              py::list dofs;
+                              for (auto d : self.GetDofs())
+                                dofs.append (d);
+                              return dofs;
+                            }, "the dofs of the region")
+     ;
+
+   m.def("ParameterSweep", [](shared_ptr<BilinearForm> bfa, shared_ptr<LinearForm> lff,
+                               py::list parameters, py::object values, py::list outputs,
+                               shared_ptr<MultiVector> solutions, shared_ptr<BitArray> freedofs,
+                               string inverse)
+         {
+           Array<shared_ptr<ParameterCoefficientFunction>> params;
+           for (auto p : parameters)
+             params.Append (p.cast<shared_ptr<ParameterCoefficientFunction>>());
+           ParameterSweep sweep(bfa, lff, params, freedofs, inverse, global_heapsize);
+           for (auto out : outputs)
+             {
+               if (py::isinstance<LinearForm>(out))
+                 {
+                   auto lf = out.cast<shared_ptr<LinearForm>>();
+                   if (!lf->IsAssembled())
+                     lf->Assemble (glh);
+                   sweep.AddOutput (lf->GetVectorPtr());
+                 }
+               else
+                 sweep.AddOutput (out.cast<shared_ptr<BaseVector>>());
+             }
+
+           // one row per sample, a single parameter may be given as a 1D array
+           typedef py::array_t<double, py::array::c_style | py::array::forcecast> T_ARRAY;
+           T_ARRAY vals = T_ARRAY::ensure(values);
+           size_t nsamples = vals.ndim() == 1 && params.Size() == 1 ? vals.size() : (vals.ndim() ? vals.shape(0) : 0);
+           if (vals.ndim() != 1 && vals.ndim() != 2)
+             throw Exception ("ParameterSweep: values must be a 1D or 2D array");
+           FlatMatrix<double> fvals(nsamples, params.Size(), const_cast<double*>(vals.data()));
+           if (vals.ndim() == 2 && size_t(vals.shape(1)) != params.Size())
+             throw Exception ("ParameterSweep: values need one column per parameter");
+
+           Matrix<double> results;
+           {
+             py::gil_scoped_release release;
+             results = sweep.Run (fvals, solutions.get());
+           }
+           py::array_t<double> res(std::vector<size_t> { results.Height(), results.Width() });
+           auto r = res.mutable_unchecked<2>();
+           for (size_t i = 0; i < results.Height(); i++)
+             for (size_t k = 0; k < results.Width(); k++)
+               r(i,k) = results(i,k);
+           return res;
+         },
+         py::arg("bf"), py::arg("lf"), py::arg("parameters"), py::arg("values"),
+         py::arg("outputs") = py::list(), py::arg("solutions") = nullptr,
+         py::arg("freedofs") = nullptr, py::arg("inverse") = "",
+         docu_string(R"raw_string(
+Solves bf(u,v) = lf(v) for many values of the Parameters concurrently.
+Every thread of the TaskManager is a worker with its own copy of the
+forms and factorization, the matrix graph is shared. The workers take
+the samples one after the other, inside a worker assembly and solving
+run sequentially. Dirichlet values are zero.
+
+Parameters:
+
+bf : ngsolve.comp.BilinearForm
+  the form, real, without static condensation
+
+lf : ngsolve.comp.LinearForm
+  the right hand side
+
+parameters : list of ngsolve.fem.Parameter
+  the Parameters used by bf and lf
+
+values : numpy array
+  one row per sample, one column per parameter
+
+outputs : list
+  LinearForms or vectors l, the result contains l(u) for every sample
+
+solutions : ngsolve.la.MultiVector
+  (optional) stores solution i as vector i
+
+freedofs : ngsolve.ngstd.BitArray
+  (default: the freedofs of the space)
+
+inverse : string
+  the direct solver, the factorization of a worker is updated numerically
+
+Returns a numpy array of the outputs, one row per sample.
+)raw_string"));
+
    m.def("MPI_Init", [&]()
 	 {
 	   const char * progname = "ngslib";
@@ -422,6 +422,14 @@ mesh (netgen.Mesh): a mesh generated from Netgen
                                       MeshNode(NodeId(nt, mesh->GetNNodes(nt)), *mesh));
           }, "iterable of mesh facets")
 
+    .def("GetGlobalVertexNumbers", [] (shared_ptr<MeshAccess> mesh)
+         {
+           Array<int> globnums(mesh->GetNV());
+           for (auto i : Range(globnums))
+             globnums[i] = mesh->GetGlobalNodeNum (NodeId(NT_VERTEX, i));
+           return MakePyList (globnums);
+         }, "list of the global vertex numbers of the local vertices of a distributed mesh")
+
     .def("nodes", [] (shared_ptr<MeshAccess> mesh, NODE_TYPE type)
          {
            return T_Range<MeshNode> (MeshNode(NodeId(type, 0), *mesh),
@@ -459,6 +467,14 @@ mesh (netgen.Mesh): a mesh generated from Netgen
 
     .def("UnsetDeformation", [](MeshAccess & ma){ ma.SetDeformation(nullptr);}, "Unset the deformation")
 
+    .def("SetGeometryCache", &MeshAccess::SetGeometryCache, py::arg("enable")=true,
+         docu_string("Store points and Jacobians of curved elements at the integration points.\n"
+                     "Speeds up repeated assembly and matrix-free operator application,\n"
+                     "costs memory for every curved element.\n"
+                     "With a deformation (SetDeformation) all elements are cached with the\n"
+                     "deformed geometry. Call SetDeformation again after changing the\n"
+                     "values of the deformation GridFunction."))
+
     .def("SetPML", 
 	 [](MeshAccess & ma,  shared_ptr<PML> apml, py::object definedon)
           {
@@ -666,7 +682,8 @@ mesh (netgen.Mesh): a mesh generated from Netgen
     
     .def("Curve", &MeshAccess::Curve,
          py::arg("order"),
-         "Curve the mesh elements for geometry approximation of given order")
+         "Curve the mesh elements for geometry approximation of given order.\n"
+         "Edges and faces are curved in parallel, by a temporary task-manager if none is running")
 
     .def("GetCurveOrder", &MeshAccess::GetCurveOrder,
 	 "")
@@ -692,19 +709,59 @@ mesh (netgen.Mesh): a mesh generated from Netgen
                              })
 
     ;
-    PyDefVectorized(mesh_access, "__call__",
-         [](MeshAccess* ma, double x, double y, double z, VorB vb)
+    auto find_point = [](MeshAccess* ma, double x, double y, double z, VorB vb)
+      {
+        IntegrationPoint ip;
+        int elnr;
+        if (vb == VOL)
+          elnr = ma->FindElementOfPoint(Vec<3>(x, y, z), ip, true);
+        else
+          elnr = ma->FindSurfaceElementOfPoint(Vec<3>(x, y, z), ip, true);
+        return MeshPoint { ip(0), ip(1), ip(2), ma, vb, elnr };
+      };
+    if (have_numpy)
+      mesh_access.def("__call__",
+         [find_point](MeshAccess* ma, py::object x, py::object y, py::object z, VorB vb) -> py::object
           {
-            IntegrationPoint ip;
-            int elnr;
+            auto is_scalar = [] (py::object v)
+              { return py::isinstance<py::float_>(v) || py::isinstance<py::int_>(v); };
+            if (is_scalar(x) && is_scalar(y) && is_scalar(z))
+              return py::cast(find_point(ma, x.cast<double>(), y.cast<double>(), z.cast<double>(), vb));
+
+            // arrays are broadcast like in numpy, volume points are located in parallel
+            py::tuple b = py::module::import("numpy").attr("broadcast_arrays")(x, y, z);
+            typedef py::array_t<double, py::array::c_style | py::array::forcecast> T_ARRAY;
+            T_ARRAY coords[3] = { T_ARRAY::ensure(b[0]), T_ARRAY::ensure(b[1]), T_ARRAY::ensure(b[2]) };
+            size_t npts = coords[0].size();
+            Matrix<> pnts(npts, 3);
+            for (int k = 0; k < 3; k++)
+              for (size_t i = 0; i < npts; i++)
+                pnts(i,k) = coords[k].data()[i];
+
+            Array<MeshPoint> mps(npts);
             if (vb == VOL)
-              elnr = ma->FindElementOfPoint(Vec<3>(x, y, z), ip, true);
+              {
+                Array<int> elnrs(npts);
+                Array<IntegrationPoint> ips(npts);
+                ma->FindElementsOfPoints (pnts, elnrs, ips);
+                for (size_t i = 0; i < npts; i++)
+                  mps[i] = MeshPoint { ips[i](0), ips[i](1), ips[i](2), ma, vb, elnrs[i] };
+              }
             else
-              elnr = ma->FindSurfaceElementOfPoint(Vec<3>(x, y, z), ip, true);
-            return MeshPoint { ip(0), ip(1), ip(2), ma, vb, elnr };
+              for (size_t i = 0; i < npts; i++)
+                mps[i] = find_point(ma, pnts(i,0), pnts(i,1), pnts(i,2), vb);
+            if (coords[0].ndim() == 0)
+              return py::cast(mps[0]);
+            py::object shape = coords[0].attr("shape");
+            return MoveToNumpyArray(mps).attr("reshape")(shape);
           },
          py::arg("x") = 0.0, py::arg("y") = 0.0, py::arg("z") = 0.0,
          py::arg("VOL_or_BND") = VOL,
+	 docu_string("Get a MappedIntegrationPoint in the point (x,y,z) on the matching volume (VorB=VOL, default) or surface (VorB=BND) element. BBND elements aren't supported. For arrays of coordinates volume points are searched in parallel"));
+    else
+      mesh_access.def("__call__", find_point,
+         py::arg("x") = 0.0, py::arg("y") = 0.0, py::arg("z") = 0.0,
+         py::arg("VOL_or_BND") = VOL,
 	 docu_string("Get a MappedIntegrationPoint in the point (x,y,z) on the matching volume (VorB=VOL, default) or surface (VorB=BND) element. BBND elements aren't supported"));
 
   
@@ -18,6 +18,9 @@ namespace ngcomp {
     integrator[VOL] = space->GetIntegrator(VOL);
     
     iscomplex = space->IsComplex();
+    reorder = flags.GetStringFlag ("reorder", "nodes");
+    if (reorder != "nodes" && reorder != "rcm" && reorder != "hilbert")
+      throw Exception ("Reorder: unknown ordering '"+reorder+"', use 'nodes', 'rcm' or 'hilbert'");
     /*
       // not yet implemented ...
       if (space->LowOrderFESpacePtr() && false)
@@ -39,6 +42,21 @@ namespace ngcomp {
     dofmap.SetSize(ndof);
     dofmap = UNUSED_DOF;
 
+    if (reorder == "rcm")
+      CalcRCMOrdering();
+    else if (reorder == "hilbert")
+      CalcHilbertOrdering();
+    else
+      CalcNodeOrdering();
+    
+    ctofdof.SetSize(ndof);
+    for (auto i : Range(ndof))
+      ctofdof[dofmap[i]] = space->GetDofCouplingType(i);
+  }
+
+
+  void ReorderedFESpace :: CalcNodeOrdering ()
+  {
     Array<DofId> dofs;
     size_t cnt = 0;
     for (auto nt : { NT_VERTEX, NT_EDGE, NT_FACE, NT_CELL })
@@ -48,10 +66,225 @@ namespace ngcomp {
           for (auto d : dofs)
             dofmap[d] = cnt++;
         }
+  }
+
+  
+  void ReorderedFESpace :: CalcRCMOrdering ()
+  {
+    static Timer t("ReorderedFESpace - RCM"); RegionTimer reg(t);
+    size_t ndof = dofmap.Size();
+
+    // dof graph: dofs are connected if they share an element
+    TableCreator<int> creator(ndof);
+    Array<DofId> dnums;
+    for ( ; !creator.Done(); creator++)
+      for (auto vb : { VOL, BND })
+        for (size_t nr : Range(ma->GetNE(vb)))
+          {
+            space->GetDofNrs (ElementId(vb, nr), dnums);
+            for (auto d1 : dnums)
+              for (auto d2 : dnums)
+                if (IsRegularDof(d1) && IsRegularDof(d2) && d1 != d2)
+                  creator.Add (d1, d2);
+          }
+    Table<int> graph = creator.MoveTable();
+    ParallelFor (ndof, [&] (size_t i)
+                 {
+                   auto row = graph[i];
+                   QuickSort (row);
+                 });
+
+    // number of distinct neighbours
+    Array<int> degree(ndof);
+    for (size_t i = 0; i < ndof; i++)
+      {
+        auto row = graph[i];
+        int cnt = 0;
+        for (size_t j = 0; j < row.Size(); j++)
+          if (j == 0 || row[j] != row[j-1]) cnt++;
+        degree[i] = cnt;
+      }
+
+    // breadth first search from start, neighbours by increasing degree
+    Array<int> mark(ndof);
+    mark = -1;
+    Array<int> queue, dist, nbs;
+    int stamp = 0;
+    auto BFS = [&] (int start)
+      {
+        stamp++;
+        queue.SetSize0();
+        dist.SetSize0();
+        queue.Append (start);
+        dist.Append (0);
+        mark[start] = stamp;
+        for (size_t qi = 0; qi < queue.Size(); qi++)
+          {
+            nbs.SetSize0();
+            for (int nb : graph[queue[qi]])
+              if (mark[nb] != stamp)
+                {
+                  mark[nb] = stamp;
+                  nbs.Append (nb);
+                }
+            QuickSort (nbs, [&] (int a, int b) { return degree[a] < degree[b]; });
+            for (int nb : nbs)
+              {
+                queue.Append (nb);
+                dist.Append (dist[qi]+1);
+              }
+          }
+      };
     
-    ctofdof.SetSize(ndof);
-    for (auto i : Range(ndof))
-      ctofdof[dofmap[i]] = space->GetDofCouplingType(i);
+    Array<int> order;
+    order.SetAllocSize (ndof);
+    BitArray numbered(ndof);
+    numbered.Clear();
+    Array<int> bydegree(ndof);
+    for (size_t i = 0; i < ndof; i++) bydegree[i] = i;
+    {
+      // stable: ties keep the natural order
+      Array<int> sortdegree(degree);
+      ParallelRadixSort (sortdegree, bydegree);
+    }
+
+    for (int start : bydegree)
+      {
+        if (numbered.Test(start)) continue;
+        BFS (start);
+        
+        // pseudo-peripheral start node (George-Liu):
+        // restart from a node of minimal degree in the last level while the eccentricity grows
+        for (int iter = 0; iter < 5; iter++)
+          {
+            int ecc = dist.Last();
+            size_t firstlast = queue.Size()-1;
+            while (firstlast > 0 && dist[firstlast-1] == ecc) firstlast--;
+            int next = queue[firstlast];
+            for (size_t qi = firstlast; qi < queue.Size(); qi++)
+              if (degree[queue[qi]] < degree[next]) next = queue[qi];
+            if (next == start) break;
+            BFS (next);
+            start = next;
+            if (dist.Last() <= ecc) break;
+          }
+
+        for (int d : queue)
+          numbered.SetBit(d);
+        order += queue;
+      }
+
+    // reverse
+    for (size_t i = 0; i < ndof; i++)
+      dofmap[order[i]] = ndof-1-i;
+  }
+
+
+  // position along the Hilbert curve of a point with integer coordinates in [0, 2^bits)
+  // J. Skilling, Programming the Hilbert curve, AIP Conf. Proc. 707 (2004)
+  template <int D>
+  static uint64_t HilbertKey (std::array<uint32_t,D> x, int bits)
+  {
+    uint32_t m = 1u << (bits-1);
+    for (uint32_t q = m; q > 1; q >>= 1)
+      {
+        uint32_t p = q-1;
+        for (int i = 0; i < D; i++)
+          if (x[i] & q)
+            x[0] ^= p;
+          else
+            {
+              uint32_t t = (x[0]^x[i]) & p;
+              x[0] ^= t;
+              x[i] ^= t;
+            }
+      }
+    for (int i = 1; i < D; i++)
+      x[i] ^= x[i-1];
+    uint32_t t = 0;
+    for (uint32_t q = m; q > 1; q >>= 1)
+      if (x[D-1] & q) t ^= q-1;
+    for (int i = 0; i < D; i++)
+      x[i] ^= t;
+
+    uint64_t key = 0;
+    for (int b = bits-1; b >= 0; b--)
+      for (int i = 0; i < D; i++)
+        key = (key << 1) | ((x[i] >> b) & 1);
+    return key;
+  }
+  
+  void ReorderedFESpace :: CalcHilbertOrdering ()
+  {
+    static Timer t("ReorderedFESpace - Hilbert"); RegionTimer reg(t);
+    size_t ndof = dofmap.Size();
+    int dim = ma->GetDimension();
+    size_t cnt = 0;
+
+    for (auto vb : { VOL, BND })
+      {
+        size_t ne = ma->GetNE(vb);
+        Array<Vec<3>> centroids(ne);
+        Vec<3> pmin(1e99, 1e99, 1e99), pmax(-1e99, -1e99, -1e99);
+        for (size_t i = 0; i < ne; i++)
+          {
+            Vec<3> c = 0.0;
+            auto verts = ma->GetElement(ElementId(vb, i)).Vertices();
+            for (auto v : verts)
+              {
+                Vec<3> p = 0.0;
+                if (dim == 1) p(0) = ma->GetPoint<1>(v)(0);
+                else if (dim == 2) { auto p2 = ma->GetPoint<2>(v); p(0) = p2(0); p(1) = p2(1); }
+                else p = ma->GetPoint<3>(v);
+                c += p;
+              }
+            if (verts.Size()) c /= verts.Size();
+            centroids[i] = c;
+            for (int k = 0; k < 3; k++)
+              {
+                pmin(k) = min2(pmin(k), c(k));
+                pmax(k) = max2(pmax(k), c(k));
+              }
+          }
+
+        constexpr int bits = 16;
+        Array<uint64_t> keys(ne);
+        ParallelFor (ne, [&] (size_t i)
+                     {
+                       std::array<uint32_t,3> x = { 0, 0, 0 };
+                       for (int k = 0; k < dim; k++)
+                         {
+                           double len = pmax(k)-pmin(k);
+                           double rel = len > 0 ? (centroids[i](k)-pmin(k)) / len : 0;
+                           x[k] = min2 (uint32_t(rel * (1 << bits)), uint32_t((1 << bits) - 1));
+                         }
+                       if (dim == 3)
+                         keys[i] = HilbertKey<3> (x, bits);
+                       else if (dim == 2)
+                         keys[i] = HilbertKey<2> ({ x[0], x[1] }, bits);
+                       else
+                         keys[i] = x[0];
+                     });
+
+        Array<int> elorder(ne);
+        for (size_t i = 0; i < ne; i++) elorder[i] = i;
+        ParallelRadixSort (keys, elorder);
+
+        // dofs are numbered at their first appearance along the curve
+        Array<DofId> dnums;
+        for (int i : elorder)
+          {
+            space->GetDofNrs (ElementId(vb, i), dnums);
+            for (auto d : dnums)
+              if (IsRegularDof(d) && dofmap[d] == UNUSED_DOF)
+                dofmap[d] = cnt++;
+          }
+      }
+
+    // dofs in no element
+    for (size_t i = 0; i < ndof; i++)
+      if (dofmap[i] == UNUSED_DOF)
+        dofmap[i] = cnt++;
   }
            
 
@@ -11,12 +11,21 @@ namespace ngcomp
 {
 
  // A reordered wrapper class for fespaces 
+ // flag reorder = "nodes" (default) | "rcm" | "hilbert"
+ //   nodes ... dofs of vertices, edges, faces, cells
+ //   rcm ..... reverse Cuthill-McKee of the element dof graph
+ //   hilbert . elements sorted along a Hilbert curve through their centroids
 
   class ReorderedFESpace : public FESpace
   {
   protected:
     Array<DofId> dofmap;
     shared_ptr<FESpace> space;
+    string reorder;
+
+    void CalcNodeOrdering ();
+    void CalcRCMOrdering ();
+    void CalcHilbertOrdering ();
     
   public:
     ReorderedFESpace (shared_ptr<FESpace> space, const Flags & flags);
@@ -29,6 +38,8 @@ namespace ngcomp
 
     virtual string GetClassName() const override { return "Reordered" + space->GetClassName(); }
     shared_ptr<FESpace> GetBaseSpace() const { return space; }
+    /// new number of dof of the base space
+    FlatArray<DofId> GetDofMap() const { return dofmap; }
     
     virtual FiniteElement & GetFE (ElementId ei, Allocator & alloc) const override;
 
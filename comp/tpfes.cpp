@@ -355,44 +355,123 @@ namespace ngcomp
   void IterateElementsTP (const FESpace & fes, VorB vb, LocalHeap & clh, 
             const function<void(ElementId,ElementId,LocalHeap&)> & func)
   {
-    // static mutex copyex_mutex;
+    static Timer t("IterateElementsTP"); RegionTimer reg(t);
     const TPHighOrderFESpace & festp = dynamic_cast<const TPHighOrderFESpace &>(fes);
     shared_ptr<FESpace> space_x = festp.Space(-1);
     shared_ptr<FESpace> space_y = festp.Space(0);
-    auto & nels = festp.GetNels();
     const Table<int> & element_coloring0 = space_x->ElementColoring(vb);
-    if (task_manager)
-    {
-      for (FlatArray<int> els_of_col : element_coloring0)
-      {
-        SharedLoop2 sl(els_of_col.Range());
-        task_manager -> CreateJob
-        ( [&] (const TaskInfo & ti) 
+    const Table<int> & element_coloring1 = space_y->ElementColoring(vb);
+    // a pair of x- and y-colors gives disjoint TP dofs for all its element pairs
+    for (FlatArray<int> els_x : element_coloring0)
+      for (FlatArray<int> els_y : element_coloring1)
         {
-          LocalHeap lh = clh.Split(ti.thread_nr, ti.nthreads);
-          for (int mynr : sl)
-          {
-            for(int j=0;j<nels[1];j++)
-            {
-              HeapReset hr(lh);
-              func (ElementId(vb,els_of_col[mynr]),ElementId(vb,j), lh);
-            }
-          }
+          size_t ny = els_y.Size();
+          ParallelForRange
+            (els_x.Size()*ny, [&] (IntRange r)
+             {
+               LocalHeap lh = clh.Split();
+               for (size_t k : r)
+                 {
+                   HeapReset hr(lh);
+                   func (ElementId(vb, els_x[k/ny]), ElementId(vb, els_y[k%ny]), lh);
+                 }
+             });
         }
-        );
+  }
+
+  
+  TPKroneckerMatrix :: TPKroneckerMatrix (shared_ptr<TPHighOrderFESpace> afes,
+                                          FlatArray<shared_ptr<BaseMatrix>> axmats,
+                                          FlatArray<shared_ptr<BaseMatrix>> aymats)
+    : fes(afes)
+  {
+    if (axmats.Size() != aymats.Size())
+      throw Exception("TPKroneckerMatrix: need as many x-matrices as y-matrices");
+    if (fes->GetDimension() != 1)
+      throw Exception("TPKroneckerMatrix: only scalar tensor product spaces supported");
+    nx = fes->Space(-1)->GetNDof();
+    ny = fes->Space(0)->GetNDof();
+    if (nx*ny != fes->GetNDof())
+      throw Exception("TPKroneckerMatrix: only a single y-space supported");
+    for (auto i : Range(axmats))
+      {
+        auto spx = dynamic_pointer_cast<SparseMatrix<double>> (axmats[i]);
+        auto spy = dynamic_pointer_cast<SparseMatrix<double>> (aymats[i]);
+        if (!spx || !spy)
+          throw Exception("TPKroneckerMatrix: factors must be real sparse matrices");
+        if (spx->Height() != nx || spx->Width() != nx ||
+            spy->Height() != ny || spy->Width() != ny)
+          throw Exception("TPKroneckerMatrix: factor sizes do not fit the tensor product space");
+        xmats.Append (spx);
+        ymats.Append (spy);
       }
-      return;
-    }
-    if(vb == VOL)
-      for (int i = 0; i< nels[0];i++)
+  }
+
+  void TPKroneckerMatrix :: Mult (const BaseVector & x, BaseVector & y) const
+  {
+    y = 0.0;
+    MultAdd (1, x, y);
+  }
+
+  void TPKroneckerMatrix :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("TPKroneckerMatrix::MultAdd"); RegionTimer reg(t);
+    t.AddFlops (2*nx*ny*xmats.Size());
+    
+    FlatMatrix<> U(nx, ny, x.FVDouble().Data());
+    FlatMatrix<> Y(nx, ny, y.FVDouble().Data());
+    Matrix<> W(nx, ny);
+
+    for (auto k : Range(xmats))
       {
-        for(int j=0;j<nels[1];j++)
-        {
-          HeapReset hr(clh);
-          func (ElementId (vb, i),ElementId (vb, j), clh);
-        }
+        auto & matx = *xmats[k];
+        auto & maty = *ymats[k];
+        
+        // W = U * Trans(maty), one sparse mat-vec per x-row
+        ParallelForRange
+          (nx, [&] (IntRange r)
+           {
+             for (size_t i : r)
+               {
+                 auto urow = U.Row(i);
+                 auto wrow = W.Row(i);
+                 for (size_t j = 0; j < ny; j++)
+                   {
+                     auto cols = maty.GetRowIndices(j);
+                     auto vals = maty.GetRowValues(j);
+                     double sum = 0;
+                     for (size_t l = 0; l < cols.Size(); l++)
+                       sum += vals[l] * urow[cols[l]];
+                     wrow[j] = sum;
+                   }
+               }
+           });
+
+        // Y += s * matx * W, combining contiguous rows of W
+        ParallelForRange
+          (nx, [&] (IntRange r)
+           {
+             for (size_t i : r)
+               {
+                 auto cols = matx.GetRowIndices(i);
+                 auto vals = matx.GetRowValues(i);
+                 auto yrow = Y.Row(i);
+                 for (size_t l = 0; l < cols.Size(); l++)
+                   yrow += (s*vals[l]) * W.Row(cols[l]);
+               }
+           });
       }
   }
+
+  AutoVector TPKroneckerMatrix :: CreateRowVector () const
+  {
+    return CreateBaseVector(nx*ny, false, 1);
+  }
+
+  AutoVector TPKroneckerMatrix :: CreateColVector () const
+  {
+    return CreateBaseVector(nx*ny, false, 1);
+  }
   
   void TPHighOrderFESpace::SolveM (CoefficientFunction * rho, BaseVector & vec, Region * def,
                          LocalHeap & clh) const
@@ -115,7 +115,31 @@ namespace ngcomp
                          LocalHeap & lh) const override;
   };
 
-    extern void IterateElementsTP (const FESpace & fes, 
+  /// sum_k xmats[k] (x) ymats[k], applied as xmats[k] * U * Trans(ymats[k])
+  /// on the coefficient vector viewed as a (ndof_x x ndof_y) matrix U
+  class NGS_DLL_HEADER TPKroneckerMatrix : public BaseMatrix
+  {
+    shared_ptr<TPHighOrderFESpace> fes;
+    Array<shared_ptr<SparseMatrix<double>>> xmats, ymats;
+    size_t nx, ny;
+  public:
+    TPKroneckerMatrix (shared_ptr<TPHighOrderFESpace> afes,
+                       FlatArray<shared_ptr<BaseMatrix>> axmats,
+                       FlatArray<shared_ptr<BaseMatrix>> aymats);
+
+    virtual bool IsComplex() const override { return false; }
+
+    virtual void Mult (const BaseVector & x, BaseVector & y) const override;
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    virtual AutoVector CreateRowVector () const override;
+    virtual AutoVector CreateColVector () const override;
+
+    virtual int VHeight() const override { return nx*ny; }
+    virtual int VWidth() const override { return nx*ny; }
+  };
+
+    extern void IterateElementsTP (const FESpace & fes,
                 VorB vb, 
                 LocalHeap & clh, 
                 const function<void(ElementId,ElementId,LocalHeap&)> & func);
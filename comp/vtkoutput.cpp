@@ -19,7 +19,9 @@ namespace ngcomp
                 flags.GetStringListFlag ("fieldnames" ),
                 flags.GetStringFlag ("filename","output"),
                 (int) flags.GetNumFlag ( "subdivision", 0),
-                (int) flags.GetNumFlag ( "only_element", -1))
+                (int) flags.GetNumFlag ( "only_element", -1),
+                flags.GetStringFlag ("format","vtk"),
+                flags.GetDefineFlag ("background"))
   {;}
 
 
@@ -27,10 +29,14 @@ namespace ngcomp
   VTKOutput<D>::VTKOutput (shared_ptr<MeshAccess> ama,
                            const Array<shared_ptr<CoefficientFunction>> & a_coefs,
                            const Array<string> & a_field_names,
-                           string a_filename, int a_subdivision, int a_only_element)
+                           string a_filename, int a_subdivision, int a_only_element,
+                           string a_format, bool a_background)
     : ma(ama), coefs(a_coefs), fieldnames(a_field_names),
-      filename(a_filename), subdivision(a_subdivision), only_element(a_only_element)
+      filename(a_filename), subdivision(a_subdivision), only_element(a_only_element),
+      format(a_format), background(a_background)
   {
+    if (format != "vtk" && format != "vtu")
+      throw Exception ("VTKOutput: unknown format '" + format + "', use 'vtk' or 'vtu'");
     value_field.SetSize(a_coefs.Size());
     for (int i = 0; i < a_coefs.Size(); i++)
       if (fieldnames.Size() > i)
@@ -46,6 +52,7 @@ namespace ngcomp
   {
     points.SetSize(0);
     cells.SetSize(0);
+    celltypes.SetSize(0);
     for (auto field : value_field)
       field->SetSize(0);
   }
@@ -352,55 +359,23 @@ namespace ngcomp
   void VTKOutput<D>::PrintCellTypes(VorB vb, const BitArray * drawelems)
   {
     *fileout << "CELL_TYPES " << cells.Size() << endl;
-    int factor = (1<<subdivision)*(1<<subdivision);
-    if (D==3 && vb == VOL)
-      factor *= (1<<subdivision);
-    for (auto e : ma->Elements(vb))
-    {
-      if (drawelems && !(drawelems->Test(e.Nr())))
-          continue;
-
-      switch(ma->GetElType(e))
-      {
-      case ET_TET:
-        for(int i=0; i<factor; i++)
-          *fileout << "10 " << endl; //(void)c;
-        break;
-      case ET_QUAD:
-        for(int i=0; i<factor; i++)
-          *fileout << "9 " << endl;
-        break;
-      case ET_TRIG:
-        for(int i=0; i<factor; i++)
-          *fileout << "5 " << endl;
-        break;
-      case ET_PRISM:
-        for(int i=0; i<factor; i++)
-          *fileout << "13 " << endl;
-        break;
-      case ET_HEX:
-        for(int i=0; i<factor; i++)
-          *fileout << "12 " << endl;
-        break;        
-      default:
-        cout << "VTKOutput Element Type " << ma->GetElType(e) << " not supported!" << endl;
-      }
-    }
+    for (auto type : celltypes)
+      *fileout << int(type) << " " << endl;
     *fileout << "CELL_DATA " << cells.Size() << endl;
     *fileout << "POINT_DATA " << points.Size() << endl;
   }
 
   /// output of field data (coefficient values)
   template <int D> 
-  void VTKOutput<D>::PrintFieldData()
+  void VTKOutput<D>::PrintFieldData(FlatArray<Array<float>> fields)
   {
-    for (auto field : value_field)
+    for (auto i : Range(value_field))
     {
-      *fileout << "SCALARS " << field->Name()
-               << " float " << field->Dimension() << endl
+      *fileout << "SCALARS " << value_field[i]->Name()
+               << " float " << value_field[i]->Dimension() << endl
                << "LOOKUP_TABLE default" << endl;
 
-      for (auto v : *field)
+      for (auto v : fields[i])
         *fileout << v << " ";
       *fileout << endl;
     }
@@ -408,15 +383,165 @@ namespace ngcomp
   }
     
 
+  /// XML output, the data arrays are appended raw, each preceded by its size in bytes
+  template <int D> 
+  void VTKOutput<D>::PrepareVTU ()
+  {
+    size_t np = points.Size(), nc = cells.Size();
+    if (vtu_points.Size() != 3*np || vtu_offsets.Size() != nc)
+      {
+        Array<float> & pts = vtu_points;
+        pts.SetSize(3*np);
+        ParallelForRange (np, [&] (IntRange r)
+                          {
+                            for (auto i : r)
+                              for (int j = 0; j < 3; j++)
+                                pts[3*i+j] = (j < D) ? points[i](j) : 0.0;
+                          });
+
+        Array<int64_t> & offsets = vtu_offsets;
+        offsets.SetSize(nc);
+        ParallelForRange (nc, [&] (IntRange r)
+                          { for (auto i : r) offsets[i] = cells[i][0]; });
+        size_t nconn = ParallelExclusiveScan<int64_t> (offsets);
+        vtu_connectivity.SetSize(nconn);
+        ParallelForRange (nc, [&] (IntRange r)
+                          {
+                            for (auto i : r)
+                              for (int j = 0; j < cells[i][0]; j++)
+                                vtu_connectivity[offsets[i]+j] = cells[i][j+1];
+                          });
+        // vtk wants the end of each cell
+        ParallelForRange (nc, [&] (IntRange r)
+                          { for (auto i : r) offsets[i] += cells[i][0]; });
+      }
+  }
+
+  /// runs also in the output thread, without the task manager
+  template <int D> 
+  void VTKOutput<D>::WriteVTU (const string & name, FlatArray<Array<float>> fields)
+  {
+    size_t np = points.Size(), nc = cells.Size();
+    FlatArray<float> pts = vtu_points;
+    FlatArray<int64_t> connectivity = vtu_connectivity, offsets = vtu_offsets;
+
+    ofstream out(name, ios::binary);
+    size_t offset = 0;
+    auto dataarray = [&] (string type, string aname, int ncomp, size_t nbytes)
+      {
+        out << "<DataArray type=\"" << type << "\"";
+        if (aname.length()) out << " Name=\"" << aname << "\"";
+        out << " NumberOfComponents=\"" << ncomp << "\" format=\"appended\" offset=\""
+            << offset << "\"/>\n";
+        offset += sizeof(uint64_t) + nbytes;
+      };
+    
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+        << "<UnstructuredGrid>\n"
+        << "<Piece NumberOfPoints=\"" << np << "\" NumberOfCells=\"" << nc << "\">\n";
+    out << "<PointData>\n";
+    for (auto i : Range(value_field))
+      dataarray ("Float32", value_field[i]->Name(), value_field[i]->Dimension(), fields[i].Size()*sizeof(float));
+    out << "</PointData>\n";
+    out << "<Points>\n";
+    dataarray ("Float32", "", 3, pts.Size()*sizeof(float));
+    out << "</Points>\n";
+    out << "<Cells>\n";
+    dataarray ("Int64", "connectivity", 1, connectivity.Size()*sizeof(int64_t));
+    dataarray ("Int64", "offsets", 1, offsets.Size()*sizeof(int64_t));
+    dataarray ("UInt8", "types", 1, celltypes.Size());
+    out << "</Cells>\n"
+        << "</Piece>\n"
+        << "</UnstructuredGrid>\n"
+        << "<AppendedData encoding=\"raw\">\n_";
+
+    auto append = [&] (const void * data, uint64_t nbytes)
+      {
+        out.write (reinterpret_cast<const char*>(&nbytes), sizeof(nbytes));
+        out.write (static_cast<const char*>(data), nbytes);
+      };
+    for (auto & field : fields)
+      append (field.Data(), field.Size()*sizeof(float));
+    append (pts.Data(), pts.Size()*sizeof(float));
+    append (connectivity.Data(), connectivity.Size()*sizeof(int64_t));
+    append (offsets.Data(), offsets.Size()*sizeof(int64_t));
+    append (celltypes.Data(), celltypes.Size());
+    out << "\n</AppendedData>\n</VTKFile>\n";
+    if (!out.good())
+      throw Exception ("VTKOutput: writing " + name + " failed");
+  }
+
+  template <int D> 
+  void VTKOutput<D>::WritePVTU (const string & name, const string & piecebase, int npieces)
+  {
+    ofstream out(name);
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+        << "<PUnstructuredGrid GhostLevel=\"0\">\n"
+        << "<PPointData>\n";
+    for (auto field : value_field)
+      out << "<PDataArray type=\"Float32\" Name=\"" << field->Name()
+          << "\" NumberOfComponents=\"" << field->Dimension() << "\"/>\n";
+    out << "</PPointData>\n"
+        << "<PPoints>\n<PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n</PPoints>\n";
+    for (int i = 0; i < npieces; i++)
+      out << "<Piece Source=\"" << piecebase << "_" << i << ".vtu\"/>\n";
+    out << "</PUnstructuredGrid>\n</VTKFile>\n";
+  }
+  
+  template <int D> 
+  void VTKOutput<D>::WritePVD (const string & name, FlatArray<double> times, FlatArray<string> files)
+  {
+    ofstream out(name);
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"Collection\" version=\"0.1\">\n"
+        << "<Collection>\n";
+    for (auto i : Range(files))
+      {
+        auto pos = files[i].find_last_of("/\\");
+        out << "<DataSet timestep=\"" << times[i] << "\" file=\""
+            << ((pos == string::npos) ? files[i] : files[i].substr(pos+1)) << "\"/>\n";
+      }
+    out << "</Collection>\n</VTKFile>\n";
+  }
+  
   template <int D> 
   void VTKOutput<D>::Do (LocalHeap & lh, VorB vb, const BitArray * drawelems)
   {
+    WriteStep (lh, vb, drawelems);
+  }
+
+  template <int D> 
+  void VTKOutput<D>::Do (LocalHeap & lh, double time, VorB vb, const BitArray * drawelems)
+  {
+    string name = WriteStep (lh, vb, drawelems);
+    step_times.Append (time);
+    step_files.Append (name);
+    if (ma->GetCommunicator().Rank() != 0) return;
+    if (!background)
+      {
+        WritePVD (filename + ".pvd", step_times, step_files);
+        return;
+      }
+    auto times = make_shared<Array<double>> (step_times);
+    auto files = make_shared<Array<string>> (step_files);
+    OutputQueue::Global().Add ([name=filename+".pvd", times, files] ()
+                               { WritePVD (name, *times, *files); }, 0);
+  }
+  
+  template <int D> 
+  string VTKOutput<D>::WriteStep (LocalHeap & lh, VorB vb, const BitArray * drawelems)
+  {
+    static Timer t("VTKOutput::Do"); RegionTimer reg(t);
+    static Timer tfill("VTKOutput::Do - evaluate");
+    auto comm = ma->GetCommunicator();
+    
     ostringstream filenamefinal;
     filenamefinal << filename;
     if (output_cnt > 0)
       filenamefinal << "_" << output_cnt;
-    filenamefinal << ".vtk";
-    fileout = make_shared<ofstream>(filenamefinal.str());
+    string basename = filenamefinal.str();
     cout << IM(4) << " Writing VTK-Output";
     if (output_cnt > 0)
       cout << IM(4) << " ( " << output_cnt << " )";
@@ -424,12 +549,8 @@ namespace ngcomp
     
     output_cnt++;
 
-    ResetArrays();
-
     Array<IntegrationPoint> ref_vertices_tet(0), ref_vertices_prism(0), ref_vertices_trig(0), ref_vertices_quad(0), ref_vertices_hex(0);
     Array<INT<ELEMENT_MAXPOINTS+1>> ref_tets(0), ref_prisms(0), ref_trigs(0), ref_quads(0), ref_hexes(0);
-    FlatArray<IntegrationPoint> ref_vertices;
-    FlatArray<INT<ELEMENT_MAXPOINTS+1>> ref_elems;
     /*
     if (D==3)
       FillReferenceData3D(ref_vertices,ref_tets);
@@ -441,110 +562,183 @@ namespace ngcomp
     FillReferenceQuad(ref_vertices_quad,ref_quads);
     FillReferenceTrig(ref_vertices_trig,ref_trigs);
     FillReferenceHex(ref_vertices_hex,ref_hexes);
-      
-    // header:
-    *fileout << "# vtk DataFile Version 3.0" << endl;
-    *fileout << "vtk output" << endl;
-    *fileout << "ASCII" << endl;
-    *fileout << "DATASET UNSTRUCTURED_GRID" << endl;
 
+    // reference points, sub-cells and vtk cell type of the element type
+    auto reference = [&] (ELEMENT_TYPE eltype)
+      -> tuple<FlatArray<IntegrationPoint>, FlatArray<INT<ELEMENT_MAXPOINTS+1>>, unsigned char>
+      {
+        switch(eltype)
+          {
+          case ET_TRIG:  return { ref_vertices_trig, ref_trigs, 5 };
+          case ET_QUAD:  return { ref_vertices_quad, ref_quads, 9 };
+          case ET_TET:   return { ref_vertices_tet, ref_tets, 10 };
+          case ET_HEX:   return { ref_vertices_hex, ref_hexes, 12 };
+          case ET_PRISM: return { ref_vertices_prism, ref_prisms, 13 };
+          default:
+            throw Exception("VTK output for element-type"+ToString(eltype)+"not supported");
+          }
+      };
+      
     int ne = ma->GetNE(vb);
 
     IntRange range = only_element >= 0 ? IntRange(only_element,only_element+1) : IntRange(ne);
-    
+
+    Array<int> elnrs;
     for ( int elnr : range)
-    {
-      if (drawelems && !(drawelems->Test(elnr)))
-          continue;
-      
-      HeapReset hr(lh);
+      if (!drawelems || drawelems->Test(elnr))
+        elnrs.Append (elnr);
 
-      ElementId ei(vb, elnr);
-      ElementTransformation & eltrans = ma->GetTrafo (ei, lh);
-      ELEMENT_TYPE eltype = ma->GetElType(ei);
+    // points and cells are kept from the previous output, only fields are evaluated 
+    bool newgeometry = geometry_timestamp != ma->GetTimeStamp() || geometry_vb != vb ||
+      ma->GetDeformation() || elnrs.Size() != geometry_elnrs.Size();
+    if (!newgeometry)
+      for (auto i : Range(elnrs))
+        if (elnrs[i] != geometry_elnrs[i]) { newgeometry = true; break; }
 
-      switch(eltype)
+    if (newgeometry)
       {
-      case ET_TRIG:
-        ref_vertices.Assign(ref_vertices_trig);
-        ref_elems.Assign(ref_trigs);
-        break;
-      case ET_QUAD:
-        ref_vertices.Assign(ref_vertices_quad);
-        ref_elems.Assign(ref_quads);
-        break;
-      case ET_TET:
-        ref_vertices.Assign(ref_vertices_tet);
-        ref_elems.Assign(ref_tets);
-        break;
-      case ET_HEX:
-        ref_vertices.Assign(ref_vertices_hex);
-        ref_elems.Assign(ref_hexes);
-        break;        
-      case ET_PRISM:
-        ref_vertices.Assign(ref_vertices_prism);
-        ref_elems.Assign(ref_prisms);
-        break;
-      default:
-        throw Exception("VTK output for element-type"+ToString(eltype)+"not supported");
+        // queued outputs use points and cells
+        if (background)
+          OutputQueue::Global().Wait();
+        ResetArrays();
+        vtu_points.SetSize0();
+        vtu_offsets.SetSize0();
+        vtu_connectivity.SetSize0();
+        
+        // positions of the elements in the point and cell arrays
+        firstpoint.SetSize (elnrs.Size());
+        firstcell.SetSize (elnrs.Size());
+        size_t np = 0, nc = 0;
+        for (auto i : Range(elnrs))
+          {
+            auto [ref_vertices, ref_elems, vtktype] = reference (ma->GetElType(ElementId(vb, elnrs[i])));
+            (void)vtktype;
+            firstpoint[i] = np;
+            firstcell[i] = nc;
+            np += ref_vertices.Size();
+            nc += ref_elems.Size();
+          }
+        points.SetSize (np);
+        cells.SetSize (nc);
+        celltypes.SetSize (nc);
+        
+        geometry_elnrs = move(elnrs);
+        geometry_vb = vb;
+        geometry_timestamp = ma->GetTimeStamp();
       }
-
-      int offset = points.Size();
-      for ( auto ip : ref_vertices)
+    FlatArray<int> els = geometry_elnrs;
+    
+    for (auto i : Range(coefs))
+      value_field[i]->SetSize (points.Size()*coefs[i]->Dimension());
+
+    tfill.Start();
+    ParallelForRange
+      (els.Size(), [&] (IntRange r)
+       {
+         LocalHeap slh = lh.Split();
+         for (auto i : r)
+           {
+             HeapReset hr(slh);
+             ElementId ei(vb, els[i]);
+             ElementTransformation & eltrans = ma->GetTrafo (ei, slh);
+             auto [ref_vertices, ref_elems, vtktype] = reference (ma->GetElType(ei));
+
+             IntegrationRule ir(ref_vertices.Size(), ref_vertices.Data());
+             const BaseMappedIntegrationRule & mir = eltrans(ir, slh);
+             
+             size_t offset = firstpoint[i];
+             for (auto k : Range(coefs))
+               {
+                 const int dim = coefs[k]->Dimension();
+                 FlatMatrix<> vals(ir.Size(), dim, slh);
+                 coefs[k]->Evaluate (mir, vals);
+                 FlatArray<double> field = *value_field[k];
+                 for (auto j : Range(ir))
+                   for (int d = 0; d < dim; ++d)
+                     field[(offset+j)*dim+d] = vals(j,d);
+               }
+             
+             if (!newgeometry) continue;
+             
+             for (auto j : Range(ir))
+               points[offset+j] = mir[j].GetPoint();
+
+             for (auto j : Range(ref_elems))
+               {
+                 INT<ELEMENT_MAXPOINTS+1> new_elem = ref_elems[j];
+                 for (int l = 1; l <= new_elem[0]; ++l)
+                   new_elem[l] += offset;
+                 cells[firstcell[i]+j] = new_elem;
+                 celltypes[firstcell[i]+j] = vtktype;
+               }
+           }
+       });
+    tfill.Stop();
+
+    // the snapshot of the fields, in single precision as written
+    auto fields = make_shared<Array<Array<float>>> (value_field.Size());
+    size_t bytes = 0;
+    for (auto i : Range(value_field))
       {
-        if (vb==VOL)
-        {
-          MappedIntegrationPoint<D,D> mip(ip, eltrans);
-          points.Append(mip.GetPoint());
-        }
-        else
-        {
-          MappedIntegrationPoint<D-1,D> mip(ip, eltrans);
-          points.Append(mip.GetPoint());
-        }
+        FlatArray<double> vals = *value_field[i];
+        (*fields)[i].SetSize (vals.Size());
+        FlatArray<float> field = (*fields)[i];
+        ParallelForRange (vals.Size(), [&] (IntRange r)
+                          { for (auto j : r) field[j] = vals[j]; });
+        bytes += vals.Size()*sizeof(float);
       }
-      
-      for (int i = 0; i < coefs.Size(); i++)
+    if (format == "vtu")
+      PrepareVTU();
+
+    string written;
+    function<void()> write;
+    if (format == "vtu")
       {
-        for ( auto ip : ref_vertices)
-        {
-          if (vb==VOL)
+        if (comm.Size() > 1)
           {
-            MappedIntegrationPoint<D,D> mip(ip, eltrans);
-            const int dim = coefs[i]->Dimension();
-            FlatVector<> tmp(dim,lh);
-            coefs[i]->Evaluate(mip,tmp);
-            for (int d = 0; d < dim; ++d)
-              value_field[i]->Append(tmp(d));
+            auto pos = basename.find_last_of("/\\");
+            string piecebase = (pos == string::npos) ? basename : basename.substr(pos+1);
+            written = basename + ".pvtu";
+            write = [this, fields, basename, piecebase, rank=comm.Rank(), size=comm.Size()] ()
+              {
+                WriteVTU (basename + "_" + ToString(rank) + ".vtu", *fields);
+                if (rank == 0)
+                  WritePVTU (basename + ".pvtu", piecebase, size);
+              };
           }
-          else
+        else
           {
-            MappedIntegrationPoint<D-1,D> mip(ip, eltrans);
-            const int dim = coefs[i]->Dimension();
-            FlatVector<> tmp(dim,lh);
-            coefs[i]->Evaluate(mip,tmp);
-            for (int d = 0; d < dim; ++d)
-              value_field[i]->Append(tmp(d));
+            written = basename + ".vtu";
+            write = [this, fields, written] () { WriteVTU (written, *fields); };
           }
-        }
       }
-      
-      for ( auto elem : ref_elems)
+    else
       {
-        INT<ELEMENT_MAXPOINTS+1> new_elem = elem;
-        for (int i = 1; i <= new_elem[0]; ++i)
-          new_elem[i] += offset;
-        cells.Append(new_elem);
+        written = basename + ".vtk";
+        write = [this, fields, written, vb] ()
+          {
+            fileout = make_shared<ofstream>(written);
+            // header:
+            *fileout << "# vtk DataFile Version 3.0" << endl;
+            *fileout << "vtk output" << endl;
+            *fileout << "ASCII" << endl;
+            *fileout << "DATASET UNSTRUCTURED_GRID" << endl;
+            
+            PrintPoints();
+            PrintCells();
+            PrintCellTypes(vb);
+            PrintFieldData(*fields);
+            fileout = nullptr;
+          };
       }
 
-    }
-
-    PrintPoints();
-    PrintCells();
-    PrintCellTypes(vb,drawelems);
-    PrintFieldData();
+    if (background)
+      OutputQueue::Global().Add (write, bytes);
+    else
+      write ();
       
     cout << IM(4) << " Done." << endl;
+    return written;
   }    
 
   NumProcVTKOutput::NumProcVTKOutput (shared_ptr<PDE> apde, const Flags & flags)
@@ -31,6 +31,10 @@ namespace ngcomp
   public:
     virtual ~BaseVTKOutput() { ; }
     virtual void Do (LocalHeap & lh, VorB vb = VOL, const BitArray * drawelems = 0) = 0;
+    /// output of one step of a time series, listed with its time in the .pvd collection
+    virtual void Do (LocalHeap & lh, double time, VorB vb = VOL, const BitArray * drawelems = 0) = 0;
+    /// estimated LocalHeap per thread
+    virtual size_t EstimateHeapSize () const { return 0; }
   };
   
   template <int D> 
@@ -44,12 +48,30 @@ namespace ngcomp
     string filename;
     int subdivision;
     int only_element = -1;
+    /// "vtk" for legacy ASCII, "vtu" for XML with appended binary data
+    string format = "vtk";
+    /// fields are evaluated in Do, formatting and writing is done by the OutputQueue
+    bool background = false;
 
     Array<shared_ptr<ValueField>> value_field;
     Array<Vec<D>> points;
     Array<INT<ELEMENT_MAXPOINTS+1>> cells;
+    Array<unsigned char> celltypes;
 
     int output_cnt = 0;
+
+    /// geometry of the last output, reused while mesh and elements do not change
+    size_t geometry_timestamp = 0;
+    VorB geometry_vb = VOL;
+    Array<int> geometry_elnrs;
+    Array<size_t> firstpoint, firstcell;
+    /// binary vtu arrays of the geometry, converted once
+    Array<float> vtu_points;
+    Array<int64_t> vtu_connectivity, vtu_offsets;
+
+    /// time steps written so far, for the .pvd collection
+    Array<double> step_times;
+    Array<string> step_files;
     
     shared_ptr<ofstream> fileout;
     
@@ -59,8 +81,10 @@ namespace ngcomp
                const Flags &,shared_ptr<MeshAccess>);
 
     VTKOutput (shared_ptr<MeshAccess>, const Array<shared_ptr<CoefficientFunction>> &,
-               const Array<string> &, string, int, int);
-    virtual ~VTKOutput() { ; }
+               const Array<string> &, string, int, int, string aformat = "vtk",
+               bool abackground = false);
+    /// the queued output refers to points and cells
+    virtual ~VTKOutput() { if (background) OutputQueue::Global().Wait(false); }
     
     void ResetArrays();
     
@@ -73,9 +97,32 @@ namespace ngcomp
     void PrintPoints();
     void PrintCells();
     void PrintCellTypes(VorB vb, const BitArray * drawelems=nullptr);
-    void PrintFieldData();    
+    void PrintFieldData(FlatArray<Array<float>> fields);
+
+    /// the binary geometry arrays, if the geometry has changed
+    void PrepareVTU ();
+    /// write points, cells and fields as one VTU piece
+    void WriteVTU (const string & name, FlatArray<Array<float>> fields);
+    /// master file referencing the pieces of all ranks
+    void WritePVTU (const string & name, const string & piecebase, int npieces);
 
     virtual void Do (LocalHeap & lh, VorB vb = VOL, const BitArray * drawelems = 0);
+    virtual void Do (LocalHeap & lh, double time, VorB vb = VOL, const BitArray * drawelems = 0);
+    virtual size_t EstimateHeapSize () const
+    {
+      // the mapped reference points of the subdivided element and the values
+      size_t npts = 1;
+      for (int i = 0; i < D; i++) npts *= (1 << subdivision) + 1;
+      size_t dim = 0;
+      for (auto & cf : coefs) dim = max2 (dim, size_t(cf->Dimension()));
+      return 64*1024 + 2 * npts * (512 + dim * sizeof(double));
+    }
+    
+    /// collection file of the steps
+    static void WritePVD (const string & name, FlatArray<double> times, FlatArray<string> files);
+  protected:
+    /// evaluate and write one output file, returns the (master) file name
+    string WriteStep (LocalHeap & lh, VorB vb, const BitArray * drawelems);
   };
 
 
@@ -639,6 +639,20 @@ namespace ngfem
       HeapReset hr(lh);
       Cast(fel).CalcMappedDDShape(mip, Trans(mat));
     }
+
+    // finite differences of the SIMD gradients in reference coordinates
+    static constexpr double eps() { return 1e-4; }
+    static void GenerateMatrixSIMDIR (const FiniteElement & fel,
+                                      const SIMD_BaseMappedIntegrationRule & bmir,
+                                      BareSliceMatrix<SIMD<double>> mat);
+
+    using DiffOp<DiffOpHesse<D>>::ApplySIMDIR;
+    static void ApplySIMDIR (const FiniteElement & fel, const SIMD_BaseMappedIntegrationRule & bmir,
+                             BareSliceVector<double> x, BareSliceMatrix<SIMD<double>> y);
+
+    using DiffOp<DiffOpHesse<D>>::AddTransSIMDIR;
+    static void AddTransSIMDIR (const FiniteElement & fel, const SIMD_BaseMappedIntegrationRule & bmir,
+                                BareSliceMatrix<SIMD<double>> x, BareSliceVector<double> y);
   };
 
 
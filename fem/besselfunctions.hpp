@@ -0,0 +1,224 @@
+#ifndef FILE_BESSELFUNCTIONS
+#define FILE_BESSELFUNCTIONS
+
+/*********************************************************************/
+/* File:   besselfunctions.hpp                                       */
+/* Author: Joachim Schoeberl                                         */
+/* Date:   Oct. 2026                                                 */
+/*********************************************************************/
+
+/*
+  Bessel functions J0, J1, Y0, Y1 for double and SIMD<double>.
+
+  The rational approximations of the Cephes library (as in ngstd/bessel.hpp).
+  Both intervals, x < 5 and the Hankel asymptotics for x >= 5, are evaluated
+  and the result is selected without branches, such that all lanes of a
+  SIMD<double> are computed at once.
+
+  The Hankel functions are H^(1,2)_n = J_n +- i Y_n.
+*/
+
+namespace ngfem
+{
+
+  namespace bessel_detail
+  {
+    static constexpr double PP[7] = {
+      7.96936729297347051624E-4, 8.28352392107440799803E-2, 1.23953371646414299388E0,
+      5.44725003058768775090E0, 8.74716500199817011941E0, 5.30324038235394892183E0,
+      9.99999999999999997821E-1 };
+    static constexpr double PQ[7] = {
+      9.24408810558863637013E-4, 8.56288474354474431428E-2, 1.25352743901058953537E0,
+      5.47097740330417105182E0, 8.76190883237069594232E0, 5.30605288235394617618E0,
+      1.00000000000000000218E0 };
+    static constexpr double QP[8] = {
+      -1.13663838898469149931E-2, -1.28252718670509318512E0, -1.95539544257735972385E1,
+      -9.32060152123768231369E1, -1.77681167980488050595E2, -1.47077505154951170175E2,
+      -5.14105326766599330220E1, -6.05014350600728481186E0 };
+    static constexpr double QQ[7] = {
+      6.43178256118178023184E1, 8.56430025976980587198E2, 3.88240183605401609683E3,
+      7.24046774195652478189E3, 5.93072701187316984827E3, 2.06209331660327847417E3,
+      2.42005740240291393179E2 };
+    static constexpr double YP[8] = {
+      1.55924367855235737965E4, -1.46639295903971606143E7, 5.43526477051876500413E9,
+      -9.82136065717911466409E11, 8.75906394395366999549E13, -3.46628303384729719441E15,
+      4.42733268572569800351E16, -1.84950800436986690637E16 };
+    static constexpr double YQ[7] = {
+      1.04128353664259848412E3, 6.26107330137134956842E5, 2.68919633393814121987E8,
+      8.64002487103935000337E10, 2.02979612750105546709E13, 3.17157752842975028269E15,
+      2.50596256172653059228E17 };
+    static constexpr double RP[4] = {
+      -4.79443220978201773821E9, 1.95617491946556577543E12, -2.49248344360967716204E14,
+      9.70862251047306323952E15 };
+    static constexpr double RQ[8] = {
+      4.99563147152651017219E2, 1.73785401676374683123E5, 4.84409658339962045305E7,
+      1.11855537045356834862E10, 2.11277520115489217587E12, 3.10518229857422583814E14,
+      3.18121955943204943306E16, 1.71086294081043136091E18 };
+    static constexpr double DR1 = 5.78318596294678452118E0;
+    static constexpr double DR2 = 3.04712623436620863991E1;
+
+    static constexpr double RP1[4] = {
+      -8.99971225705559398224E8, 4.52228297998194034323E11, -7.27494245221818276015E13,
+      3.68295732863852883286E15 };
+    static constexpr double RQ1[8] = {
+      6.20836478118054335476E2, 2.56987256757748830383E5, 8.35146791431949253037E7,
+      2.21511595479792499675E10, 4.74914122079991414898E12, 7.84369607876235854894E14,
+      8.95222336184627338078E16, 5.32278620332680085395E18 };
+    static constexpr double PP1[7] = {
+      7.62125616208173112003E-4, 7.31397056940917570436E-2, 1.12719608129684925192E0,
+      5.11207951146807644818E0, 8.42404590141772420927E0, 5.21451598682361504063E0,
+      1.00000000000000000254E0 };
+    static constexpr double PQ1[7] = {
+      5.71323128072548699714E-4, 6.88455908754495404082E-2, 1.10514232634061696926E0,
+      5.07386386128601488557E0, 8.39985554327604159757E0, 5.20982848682361821619E0,
+      9.99999999999999997461E-1 };
+    static constexpr double QP1[8] = {
+      5.10862594750176621635E-2, 4.98213872951233449420E0, 7.58238284132545283818E1,
+      3.66779609360150777800E2, 7.10856304998926107277E2, 5.97489612400613639965E2,
+      2.11688757100572135698E2, 2.52070205858023719784E1 };
+    static constexpr double QQ1[7] = {
+      7.42373277035675149943E1, 1.05644886038262816351E3, 4.98641058337653607651E3,
+      9.56231892404756170795E3, 7.99704160447350683650E3, 2.82619278517639096600E3,
+      3.36093607810698293419E2 };
+    static constexpr double YP1[6] = {
+      1.26320474790178026440E9, -6.47355876379160291031E11, 1.14509511541823727583E14,
+      -8.12770255501325109621E15, 2.02439475713594898196E17, -7.78877196265950026825E17 };
+    static constexpr double YQ1[8] = {
+      5.94301592346128195359E2, 2.35564092943068577943E5, 7.34811944459721705660E7,
+      1.87601316108706159478E10, 3.88231277496238566008E12, 6.20557727146953693363E14,
+      6.87141087355300489866E16, 3.97270608116560655612E18 };
+    static constexpr double Z1 = 1.46819706421238932572E1;
+    static constexpr double Z2 = 4.92184563216946036703E1;
+
+    static constexpr double TWOOPI = 6.36619772367581343075535E-1;  // 2/pi
+    static constexpr double THPIO4 = 2.35619449019234492885;        // 3 pi/4
+    static constexpr double SQ2OPI = 7.9788456080286535587989E-1;   // sqrt(2/pi)
+    static constexpr double PIO4 = 7.85398163397448309616E-1;       // pi/4
+
+    /// polynomial of degree N, coefficients from the highest power
+    template <int N, typename T>
+    INLINE T PolEvl (T x, const double (&coef)[N+1])
+    {
+      T ans = coef[0];
+      for (int i = 1; i <= N; i++)
+        ans = ans * x + coef[i];
+      return ans;
+    }
+
+    /// polynomial of degree N with leading coefficient 1, which is not stored
+    template <int N, typename T>
+    INLINE T P1Evl (T x, const double (&coef)[N])
+    {
+      T ans = x + coef[0];
+      for (int i = 1; i < N; i++)
+        ans = ans * x + coef[i];
+      return ans;
+    }
+
+    template <typename T>
+    INLINE T Abs (T x) { return IfPos (x, x, -x); }
+
+    /// the Hankel asymptotics of order 0, x >= 5: P(x) cos(xn) - w Q(x) sin(xn), ...
+    template <typename T>
+    INLINE void Asymptotic0 (T x, T & j0, T & y0)
+    {
+      T w = 5.0/x;
+      T z = w*w;
+      T p = PolEvl<6> (z, PP) / PolEvl<6> (z, PQ);
+      T q = PolEvl<7> (z, QP) / P1Evl<7> (z, QQ);
+      T xn = x - PIO4;
+      T s = sin(xn), c = cos(xn);
+      T fac = SQ2OPI / sqrt(x);
+      j0 = (p*c - w*q*s) * fac;
+      y0 = (p*s + w*q*c) * fac;
+    }
+
+    template <typename T>
+    INLINE void Asymptotic1 (T x, T & j1, T & y1)
+    {
+      T w = 5.0/x;
+      T z = w*w;
+      T p = PolEvl<6> (z, PP1) / PolEvl<6> (z, PQ1);
+      T q = PolEvl<7> (z, QP1) / P1Evl<7> (z, QQ1);
+      T xn = x - THPIO4;
+      T s = sin(xn), c = cos(xn);
+      T fac = SQ2OPI / sqrt(x);
+      j1 = (p*c - w*q*s) * fac;
+      y1 = (p*s + w*q*c) * fac;
+    }
+
+    /// J0 for 0 <= x <= 5
+    template <typename T>
+    INLINE T SmallJ0 (T x)
+    {
+      T z = x*x;
+      return (z-DR1) * (z-DR2) * PolEvl<3> (z, RP) / P1Evl<8> (z, RQ);
+    }
+
+    /// J1 for |x| <= 5
+    template <typename T>
+    INLINE T SmallJ1 (T x)
+    {
+      T z = x*x;
+      return PolEvl<3> (z, RP1) / P1Evl<8> (z, RQ1) * x * (z-Z1) * (z-Z2);
+    }
+  }
+
+
+  /// Bessel function of the first kind, order 0
+  template <typename T>
+  INLINE T besselj0 (T x)
+  {
+    using namespace bessel_detail;
+    T ax = Abs(x);
+    T xl = IfPos (ax-5.0, ax, T(5.0));
+    T jl, yl;
+    Asymptotic0 (xl, jl, yl);
+    return IfPos (5.0-ax, SmallJ0 (IfPos (5.0-ax, ax, T(0.0))), jl);
+  }
+
+  /// Bessel function of the first kind, order 1
+  template <typename T>
+  INLINE T besselj1 (T x)
+  {
+    using namespace bessel_detail;
+    T ax = Abs(x);
+    T xl = IfPos (ax-5.0, ax, T(5.0));
+    T jl, yl;
+    Asymptotic1 (xl, jl, yl);
+    T j = IfPos (5.0-ax, SmallJ1 (IfPos (5.0-ax, ax, T(0.0))), jl);
+    return IfPos (x, j, -j);
+  }
+
+  /// Bessel function of the second kind, order 0, for x > 0
+  template <typename T>
+  INLINE T bessely0 (T x)
+  {
+    using namespace bessel_detail;
+    T xl = IfPos (x-5.0, x, T(5.0));
+    T xs = IfPos (5.0-x, x, T(5.0));
+    T jl, yl;
+    Asymptotic0 (xl, jl, yl);
+    T z = xs*xs;
+    T ys = PolEvl<7> (z, YP) / P1Evl<7> (z, YQ) + TWOOPI * log(xs) * SmallJ0(xs);
+    return IfPos (5.0-x, ys, yl);
+  }
+
+  /// Bessel function of the second kind, order 1, for x > 0
+  template <typename T>
+  INLINE T bessely1 (T x)
+  {
+    using namespace bessel_detail;
+    T xl = IfPos (x-5.0, x, T(5.0));
+    T xs = IfPos (5.0-x, x, T(5.0));
+    T jl, yl;
+    Asymptotic1 (xl, jl, yl);
+    T z = xs*xs;
+    T ys = xs * (PolEvl<5> (z, YP1) / P1Evl<8> (z, YQ1))
+      + TWOOPI * (SmallJ1(xs) * log(xs) - 1.0/xs);
+    return IfPos (5.0-x, ys, yl);
+  }
+
+}
+
+#endif
@@ -3,6 +3,13 @@
 #include<l2hofe_impl.hpp>
 #include<l2hofefo.hpp>
 #include<regex>
+#include <future>
+#include <queue>
+#include <condition_variable>
+#ifndef WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace ngfem
 {
@@ -27,55 +34,270 @@ namespace ngfem
         return name;
     }
 
+    static string & CompileCacheDirectory ()
+    {
+      static string dir = [] () -> string
+        {
+          if (const char * dir = getenv ("NGS_COMPILE_CACHE")) return dir;
+          return "";
+        } ();
+      return dir;
+    }
+
+    void SetCompileCacheDirectory (string dir) { CompileCacheDirectory() = dir; }
+    string GetCompileCacheDirectory () { return CompileCacheDirectory(); }
+
+    // the pointer table of Code::AddPointer contains addresses of this process
+    static bool HasAddresses (const string & code)
+    {
+      return code.find("reinterpret_cast<void*>(") != string::npos;
+    }
+
+    // two 64-bit FNV-1a hashes with different constants, as hex string
+    static string CodeHash (const string & s)
+    {
+      uint64_t h1 = 14695981039346656037ull, h2 = 0x9e3779b97f4a7c15ull;
+      for (unsigned char c : s)
+        {
+          h1 = (h1 ^ c) * 1099511628211ull;
+          h2 = (h2 ^ c) * 0xbf58476d1ce4e5b9ull;
+        }
+      stringstream str;
+      str << std::hex << std::setfill('0') << std::setw(16) << h1 << std::setw(16) << h2;
+      return str.str();
+    }
+
+#ifndef WIN32
+    static string GetCurrentDirectory ()
+    {
+      char *temp = getcwd(nullptr, 0);
+      string cwd(temp);
+      free(temp);
+      return cwd;
+    }
+
+    /*
+      Makes sure the file exists in the cache, create(tmpfile) produces it.
+      Many processes (e.g. MPI ranks) may ask for the same file: the one
+      which gets the lock directory file.lock creates it, the others wait.
+      The file is written under a temporary name and renamed, so it is never
+      seen incomplete. Returns false if the cache directory is not usable.
+    */
+    static bool CachedFile (const string & file, const function<void(const string&)> & create)
+    {
+      struct stat st;
+      if (stat (file.c_str(), &st) == 0) return true;
+
+      string dir = GetCompileCacheDirectory();
+      for (size_t pos = dir.find('/', 1); pos != string::npos; pos = dir.find('/', pos+1))
+        mkdir (dir.substr(0,pos).c_str(), 0755);
+      mkdir (dir.c_str(), 0755);
+
+      string lock = file + ".lock";
+      while (mkdir (lock.c_str(), 0755) != 0)
+        {
+          if (errno != EEXIST) return false;
+          if (stat (file.c_str(), &st) == 0) return true;
+          // lock of a crashed process
+          if (stat (lock.c_str(), &st) == 0 && time(nullptr) - st.st_mtime > 3600)
+            rmdir (lock.c_str());
+          this_thread::sleep_for (chrono::milliseconds(100));
+        }
+
+      if (stat (file.c_str(), &st) != 0)
+        {
+          string tmp = file + ".tmp" + ToString(getpid());
+          try
+            {
+              create (tmp);
+              if (rename (tmp.c_str(), file.c_str()) != 0)
+                throw Exception ("cannot write " + file);
+            }
+          catch (...)
+            {
+              unlink (tmp.c_str());
+              rmdir (lock.c_str());
+              throw;
+            }
+        }
+      rmdir (lock.c_str());
+      return true;
+    }
+#endif
+
+    /*
+      Queue of background compilations. The jobs are run by at most
+      NGS_COMPILE_JOBS (default: number of cores) threads, the threads
+      terminate when the queue is empty.
+    */
+    class CompileJobs
+    {
+      mutex mtx;
+      condition_variable finished;
+      std::queue<function<void()>> jobs;
+      int running = 0;      // worker threads
+      int pending = 0;      // queued or executing jobs
+      int maxjobs;
+
+      void Worker ()
+      {
+        BackgroundPriority::Lower ();
+        unique_lock<mutex> lock(mtx);
+        while (!jobs.empty())
+          {
+            auto job = std::move(jobs.front());
+            jobs.pop();
+            lock.unlock();
+            BackgroundPriority::WaitForCritical ();
+            try
+              {
+                job();
+              }
+            catch (const std::exception & e)
+              {
+                cerr << "Compilation of CoefficientFunction failed: " << e.what() << endl;
+              }
+            lock.lock();
+            pending--;
+            finished.notify_all();
+          }
+        running--;
+      }
+
+    public:
+      CompileJobs ()
+      {
+        if (const char * n = getenv ("NGS_COMPILE_JOBS"))
+          maxjobs = max(1, atoi(n));
+        else
+          maxjobs = max(1u, std::thread::hardware_concurrency());
+      }
+
+      void Add (function<void()> job)
+      {
+        lock_guard<mutex> guard(mtx);
+        jobs.push (std::move(job));
+        pending++;
+        if (running < maxjobs)
+          {
+            running++;
+            std::thread ([this] () { Worker(); }).detach();
+          }
+      }
+
+      void Wait ()
+      {
+        unique_lock<mutex> lock(mtx);
+        finished.wait (lock, [this] () { return pending == 0; });
+      }
+    };
+
+    static CompileJobs & GetCompileJobs ()
+    {
+      // never destroyed, detached workers may still use it at exit
+      static CompileJobs * jobs = new CompileJobs;
+      return *jobs;
+    }
+
+    void CompileInBackground (function<void()> job) { GetCompileJobs().Add (std::move(job)); }
+    void WaitForCompilation () { GetCompileJobs().Wait(); }
+
     unique_ptr<SharedLibrary> CompileCode(const std::vector<string> &codes, const std::vector<string> &link_flags )
     {
       static int counter = 0;
       static ngstd::Timer tcompile("CompiledCF::Compile");
       static ngstd::Timer tlink("CompiledCF::Link");
-      string object_files;
-      int i = 0;
+#ifdef WIN32
       string prefix = "code" + ToString(counter++);
-      for(string code : codes) {
-        string file_prefix = prefix+"_"+ToString(i++);
-        ofstream codefile(file_prefix+".cpp");
-        codefile << code;
-        codefile.close();
-        cout << IM(3) << "compiling..." << endl;
-        tcompile.Start();
+#else
+      // several processes may work in the same directory
+      string prefix = "code" + ToString(counter++) + "_" + ToString(getpid());
+      string cache_dir = GetCompileCacheDirectory();
+      // compiler and library are identified by the version
+      string compile_key = "ngscxx -c\n" + ngsolve_version + "\n";
+#endif
+
+      auto build = [&] (string libfile)
+        {
+          // the code parts are compiled concurrently
+          std::vector<std::future<string>> objects;
+          for (size_t i = 0; i < codes.size(); i++)
+            objects.push_back (std::async (std::launch::async, [&, i] () -> string
+            {
+              const string & code = codes[i];
+              string file_prefix = prefix+"_"+ToString(i);
+              auto compile = [&] (string objfile)
+                {
+                  ofstream codefile(file_prefix+".cpp");
+                  codefile << code;
+                  codefile.close();
+                  cout << IM(3) << "compiling..." << endl;
+                  RegionTimer reg(tcompile);
 #ifdef WIN32
-        string scompile = "cmd /C \"ngscxx.bat " + file_prefix + ".cpp\"";
-        object_files += file_prefix+".obj ";
+                  string scompile = "cmd /C \"ngscxx.bat " + file_prefix + ".cpp\"";
 #else
-        string scompile = "ngscxx -c " + file_prefix + ".cpp -o " + file_prefix + ".o";
-        object_files += file_prefix+".o ";
+                  string scompile = "ngscxx -c " + file_prefix + ".cpp -o " + objfile;
 #endif
-        int err = system(scompile.c_str());
-        if (err) throw Exception ("problem calling compiler");
-        tcompile.Stop();
-      }
+                  int err = system(scompile.c_str());
+                  if (err) throw Exception ("problem calling compiler");
+                };
+#ifdef WIN32
+              compile (file_prefix+".obj");
+              return file_prefix+".obj";
+#else
+              string objfile = file_prefix+".o";
+              if (!cache_dir.empty() && !HasAddresses(code))
+                {
+                  string cached = cache_dir + "/" + CodeHash(compile_key+code) + ".o";
+                  if (CachedFile (cached, compile))
+                    return cached;
+                }
+              compile (objfile);
+              return objfile;
+#endif
+            }));
+
+          string object_files;
+          for (auto & obj : objects)
+            object_files += obj.get() + " ";
 
-      cout << IM(3) << "linking..." << endl;
-      tlink.Start();
+          cout << IM(3) << "linking..." << endl;
+          RegionTimer reg(tlink);
 #ifdef WIN32
-        string slink = "cmd /C \"ngsld.bat /OUT:" + prefix+".dll " + object_files + "\"";
+          string slink = "cmd /C \"ngsld.bat /OUT:" + libfile + " " + object_files + "\"";
 #else
-        string slink = "ngsld -shared " + object_files + " -o " + prefix + ".so -lngstd -lngbla -lngfem -lngcore";
-        for (auto flag : link_flags)
+          string slink = "ngsld -shared " + object_files + " -o " + libfile + " -lngstd -lngbla -lngfem -lngcore";
+          for (auto flag : link_flags)
             slink += " "+flag;
 #endif
-      int err = system(slink.c_str());
-      if (err) throw Exception ("problem calling linker");      
-      tlink.Stop();
-      cout << IM(3) << "done" << endl;
+          int err = system(slink.c_str());
+          if (err) throw Exception ("problem calling linker");      
+        };
+
       auto library = make_unique<SharedLibrary>();
 #ifdef WIN32
+      build (prefix+".dll");
       library->Load(prefix+".dll");
 #else
-      char *temp = getcwd(nullptr, 0);
-      string cwd(temp);
-      free(temp);
-      library->Load(cwd+"/"+prefix+".so");
+      // complete library from the cache, if the code does not depend on this process
+      if (!cache_dir.empty() &&
+          std::none_of (codes.begin(), codes.end(), HasAddresses))
+        {
+          string key = compile_key;
+          for (auto & code : codes) key += code;
+          for (auto & flag : link_flags) key += flag + "\n";
+          string libfile = cache_dir + "/" + CodeHash(key) + ".so";
+          if (CachedFile (libfile, build))
+            {
+              cout << IM(3) << "using cached library " << libfile << endl;
+              library->Load(libfile[0] == '/' ? libfile : GetCurrentDirectory()+"/"+libfile);
+              return library;
+            }
+        }
+      build (prefix+".so");
+      library->Load(GetCurrentDirectory()+"/"+prefix+".so");
 #endif
+      cout << IM(3) << "done" << endl;
       return library;
     }
 
@@ -178,6 +178,18 @@ namespace ngfem
   }
 
   unique_ptr<SharedLibrary> CompileCode(const std::vector<string> &codes, const std::vector<string> &libraries );
+  /*
+    Cache of compiled code, objects and libraries are stored by a hash of
+    code, link flags and NGSolve version. The directory is initialized from
+    the environment variable NGS_COMPILE_CACHE, empty disables the cache.
+    Not available on Windows.
+  */
+  NGS_DLL_HEADER void SetCompileCacheDirectory (string dir);
+  NGS_DLL_HEADER string GetCompileCacheDirectory ();
+  /// runs job in a background thread, the number of concurrent jobs is limited
+  NGS_DLL_HEADER void CompileInBackground (function<void()> job);
+  /// waits until all background compilations are finished
+  NGS_DLL_HEADER void WaitForCompilation ();
   namespace detail {
       string GenerateL2ElementCode(int order);
   }
@@ -11,6 +11,7 @@
 #include <fem.hpp>
 #include <../ngstd/evalfunc.hpp>
 #include <algorithm>
+#include <unordered_map>
 #ifdef NGS_PYTHON
 #include <core/python_ngcore.hpp> // for shallow archive
 #endif // NGS_PYTHON
@@ -173,6 +174,39 @@ namespace ngfem
   }
   */
 
+  void CoefficientFunction ::
+  Evaluate (FlatArray<const SIMD_BaseMappedIntegrationRule*> mirs,
+            BareSliceMatrix<SIMD<double>> values, LocalHeap & lh) const
+  {
+    if (mirs.Size() == 0) return;
+    bool batch = mirs.Size() > 1 && !DependsOnElement();
+    for (auto mir : mirs)
+      if (mir->DimElement() != mirs[0]->DimElement() ||
+          mir->DimSpace() != mirs[0]->DimSpace())
+        batch = false;
+
+    if (batch)
+      {
+        HeapReset hr(lh);
+        Evaluate (ConcatenateMappedRules (mirs, lh), values);
+        return;
+      }
+
+    size_t first = 0;
+    for (auto mir : mirs)
+      {
+        Evaluate (*mir, values.Cols(first, first+mir->Size()));
+        first += mir->Size();
+      }
+  }
+
+  bool CoefficientFunction :: InputsDependOnElement () const
+  {
+    for (auto & in : InputCoefficientFunctions())
+      if (in->DependsOnElement()) return true;
+    return false;
+  }
+
   void CoefficientFunction ::   
   Evaluate (const SIMD_BaseMappedIntegrationRule & ir, BareSliceMatrix<SIMD<Complex>> values) const
   {
@@ -355,16 +389,28 @@ namespace ngfem
     ost << "ParameterCF, val = " << val << endl;
   }
 
+  void ParameterCoefficientFunction :: SetThreadValues (bool on)
+  {
+    if (on)
+      {
+        thread_values.SetSize (TaskManager::GetMaxThreads());
+        thread_values = val;
+      }
+    else
+      thread_values.SetSize0();
+  }
+
   void ParameterCoefficientFunction :: Evaluate (const BaseMappedIntegrationRule & ir,
                                                  BareSliceMatrix<double> values) const
   {
-    values.AddSize(ir.Size(), 1) = val;
+    values.AddSize(ir.Size(), 1) = Value();
   }
 
   void ParameterCoefficientFunction :: GenerateCode(Code &code, FlatArray<int> inputs, int index) const
   {
+    // the compiled function sees the value of the evaluating thread
     stringstream s;
-    s << "*reinterpret_cast<double*>(" << code.AddPointer(&val) << ")";
+    s << "reinterpret_cast<const ParameterCoefficientFunction*>(" << code.AddPointer(this) << ")->Value()";
     code.body += Var(index).Declare(code.res_type);
     code.body += Var(index).Assign(s.str(), false);
   }
@@ -685,7 +731,36 @@ Evaluate (const BaseMappedIntegrationRule & ir,
     }
 }
 
-  
+void DomainVariableCoefficientFunction ::
+Evaluate (const SIMD_BaseMappedIntegrationRule & ir,
+          BareSliceMatrix<SIMD<double>> values) const
+{
+  size_t nv = ir.Size();
+  if (nv == 0) return;
+  int elind = ir.GetTransformation().GetElementIndex();
+  if (fun.Size() == 1) elind = 0;
+  if (fun[elind] -> IsComplex ())
+    throw ExceptionNOSIMD ("DomainVariableCoefficientFunction: no SIMD for complex functions");
+
+  // argument j for all points in row j
+  STACK_ARRAY(SIMD<double>, mem, numarg*nv);
+  FlatMatrix<SIMD<double>> args(numarg, nv, &mem[0]);
+  args = SIMD<double>(0.0);
+  auto points = ir.GetPoints();
+  for (int j = 0; j < ir.DimSpace(); j++)
+    for (size_t i = 0; i < nv; i++)
+      args(j,i) = points(i,j);
+
+  for (int i = 0, an = 3; i < depends_on.Size(); i++)
+    {
+      int dim = depends_on[i]->Dimension();
+      depends_on[i] -> Evaluate (ir, args.Rows(an,an+dim));
+      an += dim;
+    }
+  fun[elind]->Eval (&args(0,0), nv, &values(0,0), values.Dist(), nv);
+}
+
+
 void DomainVariableCoefficientFunction :: PrintReport (ostream & ost) const
 {
   *testout << "DomainVariableCoefficientFunction, functions are: " << endl;
@@ -989,6 +1064,9 @@ class ZeroCoefficientFunction : public T_CoefficientFunction<ZeroCoefficientFunc
 {
   using BASE = T_CoefficientFunction<ZeroCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return false; }
   ZeroCoefficientFunction () : T_CoefficientFunction<ZeroCoefficientFunction>(1, false)
   {
     SetDimension(1);
@@ -1093,6 +1171,9 @@ class ScaleCoefficientFunction : public T_CoefficientFunction<ScaleCoefficientFu
   shared_ptr<CoefficientFunction> c1;
   typedef T_CoefficientFunction<ScaleCoefficientFunction> BASE;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return scal == static_cast<const ScaleCoefficientFunction&>(other).scal; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   ScaleCoefficientFunction() = default;
   ScaleCoefficientFunction (double ascal, 
                             shared_ptr<CoefficientFunction> ac1)
@@ -1332,6 +1413,9 @@ class MultScalVecCoefficientFunction : public T_CoefficientFunction<MultScalVecC
   shared_ptr<CoefficientFunction> c2;  // vector
   typedef T_CoefficientFunction<MultScalVecCoefficientFunction> BASE;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   MultScalVecCoefficientFunction() = default;
   MultScalVecCoefficientFunction (shared_ptr<CoefficientFunction> ac1,
                                   shared_ptr<CoefficientFunction> ac2)
@@ -1488,6 +1572,9 @@ class MultVecVecCoefficientFunction : public T_CoefficientFunction<MultVecVecCoe
   int dim1;
   using BASE = T_CoefficientFunction<MultVecVecCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   MultVecVecCoefficientFunction() = default;
   MultVecVecCoefficientFunction (shared_ptr<CoefficientFunction> ac1,
                                  shared_ptr<CoefficientFunction> ac2)
@@ -1655,6 +1742,9 @@ class T_MultVecVecCoefficientFunction : public T_CoefficientFunction<T_MultVecVe
   shared_ptr<CoefficientFunction> c2;
   using BASE = T_CoefficientFunction<T_MultVecVecCoefficientFunction<DIM>>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   T_MultVecVecCoefficientFunction() = default;
   T_MultVecVecCoefficientFunction (shared_ptr<CoefficientFunction> ac1,
                                    shared_ptr<CoefficientFunction> ac2)
@@ -1891,6 +1981,9 @@ class NormCoefficientFunction : public T_CoefficientFunction<NormCoefficientFunc
   typedef double TIN;
   using BASE = T_CoefficientFunction<NormCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   NormCoefficientFunction() = default;
   NormCoefficientFunction (shared_ptr<CoefficientFunction> ac1)
     : T_CoefficientFunction<NormCoefficientFunction> (1, false), c1(ac1)
@@ -2176,6 +2269,9 @@ class MultMatMatCoefficientFunction : public T_CoefficientFunction<MultMatMatCoe
   int inner_dim;
   using BASE = T_CoefficientFunction<MultMatMatCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   MultMatMatCoefficientFunction() = default;
   MultMatMatCoefficientFunction (shared_ptr<CoefficientFunction> ac1,
                                  shared_ptr<CoefficientFunction> ac2)
@@ -2413,6 +2509,9 @@ class MultMatVecCoefficientFunction : public T_CoefficientFunction<MultMatVecCoe
   int inner_dim;
   using BASE = T_CoefficientFunction<MultMatVecCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   MultMatVecCoefficientFunction() = default;
   MultMatVecCoefficientFunction (shared_ptr<CoefficientFunction> ac1,
                                  shared_ptr<CoefficientFunction> ac2)
@@ -2608,6 +2707,9 @@ class CrossProductCoefficientFunction : public T_CoefficientFunction<CrossProduc
   shared_ptr<CoefficientFunction> c2;
   using BASE = T_CoefficientFunction<CrossProductCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   CrossProductCoefficientFunction() = default;
   CrossProductCoefficientFunction (shared_ptr<CoefficientFunction> ac1,
                                    shared_ptr<CoefficientFunction> ac2)
@@ -2743,6 +2845,9 @@ class IdentityCoefficientFunction : public T_CoefficientFunction<IdentityCoeffic
 {
   using BASE = T_CoefficientFunction<IdentityCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return false; }
   IdentityCoefficientFunction (int dim)
     : T_CoefficientFunction<IdentityCoefficientFunction>(1, false)
   {
@@ -2839,6 +2944,9 @@ class TransposeCoefficientFunction : public T_CoefficientFunction<TransposeCoeff
   shared_ptr<CoefficientFunction> c1;
   using BASE = T_CoefficientFunction<TransposeCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   TransposeCoefficientFunction() = default;
   TransposeCoefficientFunction (shared_ptr<CoefficientFunction> ac1)
     : T_CoefficientFunction<TransposeCoefficientFunction>(1, ac1->IsComplex()), c1(ac1)
@@ -3012,6 +3120,9 @@ class InverseCoefficientFunction : public T_CoefficientFunction<InverseCoefficie
   shared_ptr<CoefficientFunction> c1;
   using BASE = T_CoefficientFunction<InverseCoefficientFunction<D>>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   InverseCoefficientFunction() = default;
   InverseCoefficientFunction (shared_ptr<CoefficientFunction> ac1)
     : T_CoefficientFunction<InverseCoefficientFunction>(D*D, ac1->IsComplex()), c1(ac1)
@@ -3158,6 +3269,9 @@ class DeterminantCoefficientFunction : public T_CoefficientFunction<DeterminantC
   shared_ptr<CoefficientFunction> c1;
   using BASE = T_CoefficientFunction<DeterminantCoefficientFunction<D>>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   DeterminantCoefficientFunction() = default;
   DeterminantCoefficientFunction (shared_ptr<CoefficientFunction> ac1)
     : T_CoefficientFunction<DeterminantCoefficientFunction>(1, ac1->IsComplex()), c1(ac1)
@@ -3316,6 +3430,9 @@ class CofactorCoefficientFunction : public T_CoefficientFunction<CofactorCoeffic
   shared_ptr<CoefficientFunction> c1;
   using BASE = T_CoefficientFunction<CofactorCoefficientFunction<D>>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   CofactorCoefficientFunction() = default;
   CofactorCoefficientFunction (shared_ptr<CoefficientFunction> ac1)
     : T_CoefficientFunction<CofactorCoefficientFunction>(D*D, ac1->IsComplex()), c1(ac1)
@@ -3476,6 +3593,9 @@ class SymmetricCoefficientFunction : public T_CoefficientFunction<SymmetricCoeff
   shared_ptr<CoefficientFunction> c1;
   using BASE = T_CoefficientFunction<SymmetricCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   SymmetricCoefficientFunction() = default;
   SymmetricCoefficientFunction (shared_ptr<CoefficientFunction> ac1)
     : T_CoefficientFunction<SymmetricCoefficientFunction>(1, ac1->IsComplex()), c1(ac1)
@@ -3617,6 +3737,9 @@ class SkewCoefficientFunction : public T_CoefficientFunction<SkewCoefficientFunc
   shared_ptr<CoefficientFunction> c1;
   using BASE = T_CoefficientFunction<SkewCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   SkewCoefficientFunction() = default;
   SkewCoefficientFunction (shared_ptr<CoefficientFunction> ac1)
     : T_CoefficientFunction<SkewCoefficientFunction>(1, ac1->IsComplex()), c1(ac1)
@@ -3758,6 +3881,9 @@ class TraceCoefficientFunction : public T_CoefficientFunction<TraceCoefficientFu
   shared_ptr<CoefficientFunction> c1;
   using BASE = T_CoefficientFunction<TraceCoefficientFunction>;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   TraceCoefficientFunction() = default;
   TraceCoefficientFunction (shared_ptr<CoefficientFunction> ac1)
     : T_CoefficientFunction<TraceCoefficientFunction>(1, ac1->IsComplex()), c1(ac1)
@@ -3930,8 +4056,25 @@ cl_BinaryOpCF<GenericPlus>::Diff(const CoefficientFunction * var,
   return c1->Diff(var,dir) + c2->Diff(var,dir);
 }
 
+// value of a (real, scalar) ConstantCoefficientFunction, for constant folding
+static bool IsConstantCF (const shared_ptr<CoefficientFunction> & cf, double & val)
+{
+  if (typeid(*cf) != typeid(ConstantCoefficientFunction)) return false;
+  val = cf->EvaluateConst();
+  return true;
+}
+
 shared_ptr<CoefficientFunction> operator+ (shared_ptr<CoefficientFunction> c1, shared_ptr<CoefficientFunction> c2)
 {
+  double v1, v2;
+  bool const1 = IsConstantCF(c1, v1), const2 = IsConstantCF(c2, v2);
+  if (const1 && const2)
+    return make_shared<ConstantCoefficientFunction> (v1+v2);
+  if (const1 && v1 == 0 && c2->Dimensions().Size() == 0)
+    return c2;
+  if (const2 && v2 == 0 && c1->Dimensions().Size() == 0)
+    return c1;
+
   if (c1->GetDescription() == "ZeroCF")
     {
       if (c2->GetDescription() == "ZeroCF")
@@ -3957,6 +4100,13 @@ cl_BinaryOpCF<GenericMinus>::Diff(const CoefficientFunction * var,
 
 shared_ptr<CoefficientFunction> operator- (shared_ptr<CoefficientFunction> c1, shared_ptr<CoefficientFunction> c2)
 {
+  double v1, v2;
+  bool const1 = IsConstantCF(c1, v1), const2 = IsConstantCF(c2, v2);
+  if (const1 && const2)
+    return make_shared<ConstantCoefficientFunction> (v1-v2);
+  if (const2 && v2 == 0 && c1->Dimensions().Size() == 0)
+    return c1;
+
   if (c1->GetDescription() == "ZeroCF")
     {
       if (c2->GetDescription() == "ZeroCF")
@@ -3991,6 +4141,15 @@ cl_BinaryOpCF<GenericDiv>::Diff(const CoefficientFunction * var,
 
 shared_ptr<CoefficientFunction> operator* (shared_ptr<CoefficientFunction> c1, shared_ptr<CoefficientFunction> c2)
   {
+    double v1, v2;
+    bool const1 = IsConstantCF(c1, v1), const2 = IsConstantCF(c2, v2);
+    if (const1 && const2)
+      return make_shared<ConstantCoefficientFunction> (v1*v2);
+    if (const1 && v1 == 1) return c2;
+    if (const2 && v2 == 1) return c1;
+    if (const1 && v1 == 0) return ZeroCF(c2->Dimensions());
+    if (const2 && v2 == 0) return ZeroCF(c1->Dimensions());
+    
     if (c1->GetDescription() == "ZeroCF" || c2->GetDescription() == "ZeroCF")
       {
         if (c1->Dimensions().Size() == 2 && c2->Dimensions().Size() == 2)
@@ -4035,10 +4194,15 @@ shared_ptr<CoefficientFunction> operator* (shared_ptr<CoefficientFunction> c1, s
 
   shared_ptr<CoefficientFunction> operator* (double v1, shared_ptr<CoefficientFunction> c2)
   {
+    double v2;
     if (c2->GetDescription() == "ZeroCF")
       return c2;
     else if (v1 == double(0))
       return ZeroCF(c2->Dimensions());
+    else if (v1 == 1)
+      return c2;
+    else if (IsConstantCF(c2, v2))
+      return make_shared<ConstantCoefficientFunction> (v1*v2);
 
     return make_shared<ScaleCoefficientFunction> (v1, c2); 
   }
@@ -4254,6 +4418,12 @@ shared_ptr<CoefficientFunction> operator* (shared_ptr<CoefficientFunction> c1, s
   {
     if (c1->GetDescription() == "ZeroCF")
       return c1;
+    double v1, v2;
+    bool const1 = IsConstantCF(c1, v1), const2 = IsConstantCF(c2, v2);
+    if (const1 && const2)
+      return make_shared<ConstantCoefficientFunction> (v1/v2);
+    if (const2 && v2 == 1)
+      return c1;
     if (c2->Dimensions().Size() == 0 && c1->Dimensions().Size() > 0)
       return (make_shared<ConstantCoefficientFunction>(1.0)/c2)*c1;
     return BinaryOpCF (c1, c2, gen_div, "/");
@@ -4267,6 +4437,9 @@ class ComponentCoefficientFunction : public T_CoefficientFunction<ComponentCoeff
   int comp;
   typedef T_CoefficientFunction<ComponentCoefficientFunction> BASE;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return comp == static_cast<const ComponentCoefficientFunction&>(other).comp; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   ComponentCoefficientFunction() = default;
   ComponentCoefficientFunction (shared_ptr<CoefficientFunction> ac1,
                                 int acomp)
@@ -4790,6 +4963,9 @@ class IfPosCoefficientFunction : public T_CoefficientFunction<IfPosCoefficientFu
     shared_ptr<CoefficientFunction> cf_else;
     typedef T_CoefficientFunction<IfPosCoefficientFunction> BASE;
   public:
+    bool IsSameOperation (const CoefficientFunction & other) const override
+    { return true; }
+    bool DependsOnElement () const override { return InputsDependOnElement(); }
     IfPosCoefficientFunction() = default;
     IfPosCoefficientFunction (shared_ptr<CoefficientFunction> acf_if,
                               shared_ptr<CoefficientFunction> acf_then,
@@ -5204,6 +5380,9 @@ class VectorialCoefficientFunction : public T_CoefficientFunction<VectorialCoeff
   Array<size_t> dimi;  // dimensions of components
   typedef T_CoefficientFunction<VectorialCoefficientFunction> BASE;
 public:
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  { return true; }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   VectorialCoefficientFunction() = default;
   VectorialCoefficientFunction (Array<shared_ptr<CoefficientFunction>> aci)
     : BASE(0, false), ci(aci), dimi(aci.Size())
@@ -5439,6 +5618,9 @@ public:
     int dir;
     typedef T_CoefficientFunction<CoordCoefficientFunction, CoefficientFunctionNoDerivative> BASE;
   public:
+    bool IsSameOperation (const CoefficientFunction & other) const override
+    { return dir == static_cast<const CoordCoefficientFunction&>(other).dir; }
+    bool DependsOnElement () const override { return false; }
     CoordCoefficientFunction() = default;
     CoordCoefficientFunction (int adir) : BASE(1, false), dir(adir) { ; }
 
@@ -5692,8 +5874,88 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
          });
       cout << IM(3) << "inputs = " << endl << inputs << endl;
 
+      MergeIdenticalSteps();
     }
 
+    // steps i and j evaluate the same function, inputs are already merged
+    bool SameStep (int i, int j, FlatArray<int> rep) const
+    {
+      auto & ci = *steps[i];
+      auto & cj = *steps[j];
+      if (typeid(ci) != typeid(cj)) return false;
+      if (ci.IsComplex() != cj.IsComplex()) return false;
+      if (!(ci.Dimensions() == cj.Dimensions())) return false;
+      if (inputs[i].Size() != inputs[j].Size()) return false;
+      for (int k : Range(inputs[i]))
+        if (rep[inputs[i][k]] != rep[inputs[j][k]]) return false;
+      return cj.IsSameOperation(ci);
+    }
+
+    /*
+      common subexpression elimination:
+      steps computing the same operation on the same inputs are evaluated only once.
+      steps are in topological order, so inputs are merged before their users.
+     */
+    void MergeIdenticalSteps ()
+    {
+      Array<int> rep(steps.Size());
+      std::unordered_multimap<size_t,int> table;
+      for (int i : Range(steps))
+        {
+          size_t hash = typeid(*steps[i]).hash_code();
+          for (int d : steps[i]->Dimensions())
+            hash = hash * 31 + d;
+          for (int in : inputs[i])
+            hash = hash * 1000003 + rep[in];
+
+          rep[i] = i;
+          auto range = table.equal_range(hash);
+          for (auto it = range.first; it != range.second; it++)
+            if (SameStep (it->second, i, rep))
+              {
+                rep[i] = it->second;
+                break;
+              }
+          if (rep[i] == i)
+            table.emplace (hash, i);
+        }
+
+      Array<int> newnr(steps.Size());
+      int cnt = 0;
+      for (int i : Range(steps))
+        newnr[i] = (rep[i] == i) ? cnt++ : -1;
+      if (cnt == steps.Size()) return;
+      cout << IM(3) << "merged " << steps.Size()-cnt << " identical steps" << endl;
+
+      Array<CoefficientFunction*> newsteps(cnt);
+      Array<int> newdim(cnt);
+      Array<bool> newcomplex(cnt);
+      DynamicTable<int> newinputs(cnt);
+      for (int i : Range(steps))
+        if (newnr[i] != -1)
+          {
+            int ni = newnr[i];
+            newsteps[ni] = steps[i];
+            newdim[ni] = dim[i];
+            newcomplex[ni] = is_complex[i];
+            for (int in : inputs[i])
+              newinputs.Add (ni, newnr[rep[in]]);
+          }
+      steps = std::move(newsteps);
+      dim = std::move(newdim);
+      is_complex = std::move(newcomplex);
+      inputs = std::move(newinputs);
+      
+      totdim = 0;
+      for (int d : dim) totdim += d;
+    }
+
+  bool DependsOnElement () const override
+  {
+    for (auto step : steps)
+      if (step->DependsOnElement()) return true;
+    return false;
+  }
 
   void PrintReport (ostream & ost) const override
   {
@@ -5773,6 +6035,7 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
                      inputs.Add (mypos, steps.Pos(incf.get()));
                  }
              });
+          MergeIdenticalSteps();
         }
     }
 
@@ -5937,13 +6200,8 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
         if(wait)
             compile_func();
         else
-        {
-          try {
-            std::thread( compile_func ).detach();
-          } catch (const std::exception &e) {
-              cerr << IM(3) << "Compilation of CoefficientFunction failed: " << e.what() << endl;
-          }
-        }
+          // the interpreted evaluation is used until the library is loaded
+          CompileInBackground (compile_func);
     }
 
     void TraverseTree (const function<void(CoefficientFunction&)> & func) override
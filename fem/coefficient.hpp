@@ -59,6 +59,12 @@ namespace ngfem
     void Evaluate (const BaseMappedIntegrationRule & ir, BareSliceMatrix<Complex,ColMajor> values) const
     { Evaluate (ir, Trans(values)); }
     virtual void Evaluate (const SIMD_BaseMappedIntegrationRule & ir, BareSliceMatrix<SIMD<Complex>> values) const;
+    /**
+       Points of several elements, the values of rule i follow the values of rule i-1.
+       Functions not depending on the element are evaluated in one sweep over all points.
+    */
+    void Evaluate (FlatArray<const SIMD_BaseMappedIntegrationRule*> mirs,
+                   BareSliceMatrix<SIMD<double>> values, LocalHeap & lh) const;
 
     virtual void Evaluate (const BaseMappedIntegrationRule & ir, BareSliceMatrix<Complex> values) const;
     
@@ -238,6 +244,19 @@ namespace ngfem
     virtual Array<shared_ptr<CoefficientFunction>> InputCoefficientFunctions() const
     { return Array<shared_ptr<CoefficientFunction>>(); }
     virtual bool StoreUserData() const { return false; }
+    /*
+      other is of the same type, has the same dimensions and the same inputs.
+      True if then the values are the same, used by Compile to evaluate
+      identical subtrees only once. Default: only the identical object.
+    */
+    virtual bool IsSameOperation (const CoefficientFunction & other) const { return false; }
+    /*
+      The values depend on more than the mapped point (and the inputs), e.g. on
+      the element number or material index. False only for functions of the
+      points, which can be evaluated for many elements at once.
+    */
+    virtual bool DependsOnElement () const { return true; }
+    bool InputsDependOnElement () const;
 
   };
 
@@ -557,6 +576,10 @@ namespace ngfem
     {
       return val;
     }
+
+    bool IsSameOperation (const CoefficientFunction & other) const override
+    { return val == static_cast<const ConstantCoefficientFunction&>(other).val; }
+    bool DependsOnElement () const override { return false; }
     
     virtual void Evaluate (const BaseMappedIntegrationRule & ir, BareSliceMatrix<double> values) const override;
     virtual void Evaluate (const BaseMappedIntegrationRule & ir, BareSliceMatrix<Complex> values) const override;
@@ -671,11 +694,13 @@ namespace ngfem
   };
 
 
-  /// The coefficient is constant everywhere
+  /// The coefficient is constant everywhere, the value can be modified
   class NGS_DLL_HEADER ParameterCoefficientFunction : public CoefficientFunctionNoDerivative
   {
     ///
     double val;
+    /// one value per thread of the task manager, if switched on (parameter sweeps)
+    Array<double> thread_values;
   public:
     ///
     ParameterCoefficientFunction() = default;
@@ -691,19 +716,28 @@ namespace ngfem
     using CoefficientFunction::Evaluate;
     virtual double Evaluate (const BaseMappedIntegrationPoint & ip) const override
     {
-      return val;
+      return Value();
     }
     
     virtual void Evaluate (const BaseMappedIntegrationRule & ir, BareSliceMatrix<double> values) const override;
     virtual void Evaluate (const SIMD_BaseMappedIntegrationRule & ir, BareSliceMatrix<SIMD<double>> values) const override
-    { values.AddSize(Dimension(), ir.Size()) = val; }
+    { values.AddSize(Dimension(), ir.Size()) = Value(); }
     /*
     virtual void Evaluate (const SIMD_BaseMappedIntegrationRule & ir, FlatArray<AFlatMatrix<double>*> input,
                            AFlatMatrix<double> values) const
     { values = val; }
     */
     virtual void SetValue (double in) { val = in; }
-    virtual double GetValue () { return val; }
+    virtual double GetValue () { return Value(); }
+    /// the value of the calling thread
+    double Value () const
+    { return thread_values.Size() ? thread_values[TaskManager::GetThreadId()] : val; }
+
+    /// switch values per thread on (initialized by the common value) or off
+    void SetThreadValues (bool on);
+    /// sets the value of the calling thread, thread values must be switched on
+    void SetThreadValue (double in) { thread_values[TaskManager::GetThreadId()] = in; }
+    virtual bool DependsOnElement () const override { return false; }
     virtual void PrintReport (ostream & ost) const override;
     virtual void GenerateCode(Code &code, FlatArray<int> inputs, int index) const override;
   };
@@ -817,9 +851,13 @@ namespace ngfem
     virtual void Evaluate(const BaseMappedIntegrationPoint & ip,
 			  FlatVector<Complex> result) const;
 
-    virtual void Evaluate (const BaseMappedIntegrationRule & ir, 
+    virtual void Evaluate (const BaseMappedIntegrationRule & ir,
 			   BareSliceMatrix<double> values) const;
 
+    /// runs the vectorized EvalFunction interpreter over all points
+    virtual void Evaluate (const SIMD_BaseMappedIntegrationRule & ir,
+			   BareSliceMatrix<SIMD<double>> values) const;
+
     virtual void PrintReport (ostream & ost) const;
 
     virtual void GenerateCode(Code &code, FlatArray<int> inputs, int index) const;
@@ -1109,6 +1147,13 @@ public:
     return string("unary operation '")+name+"'";
   }
 
+  // the name identifies the operation, if it has no data
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  {
+    return std::is_empty<OP>::value && name == static_cast<const cl_UnaryOpCF&>(other).name;
+  }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
+
   virtual bool DefinedOn (const ElementTransformation & trafo) override
   { return c1->DefinedOn(trafo); } 
 
@@ -1298,6 +1343,10 @@ shared_ptr<CoefficientFunction> UnaryOpCF(shared_ptr<CoefficientFunction> c1,
 {
   if (c1->GetDescription() == "ZeroCF")
     return c1;
+  // constant folding
+  if constexpr (std::is_same<decltype(lam(0.0)),double>::value)
+    if (typeid(*c1) == typeid(ConstantCoefficientFunction))
+      return make_shared<ConstantCoefficientFunction> (lam(c1->EvaluateConst()));
   return shared_ptr<CoefficientFunction> (new cl_UnaryOpCF<OP /* ,OPC */> (c1, lam/* , lamc */, name));
 }
 
@@ -1345,6 +1394,12 @@ public:
   {
     return string("binary operation '")+opname+"'";
   }
+
+  bool IsSameOperation (const CoefficientFunction & other) const override
+  {
+    return std::is_empty<OP>::value && opname == static_cast<const cl_BinaryOpCF&>(other).opname;
+  }
+  bool DependsOnElement () const override { return InputsDependOnElement(); }
   virtual void GenerateCode(Code &code, FlatArray<int> inputs, int index) const override
   {
     TraverseDimensions( c1->Dimensions(), [&](int ind, int i, int j) {
@@ -3,6 +3,140 @@
   
 namespace ngfem
 { 
+
+  // 4-point central differences, as for DiffOpHesseBoundary
+  static constexpr double hesse_shifts[4] = { -2, -1, 1, 2 };
+  static constexpr double hesse_weights[4] = { 1.0/12, -8.0/12, 8.0/12, -1.0/12 };
+
+  // the integration rule with reference coordinate j shifted by h
+  static const SIMD_BaseMappedIntegrationRule &
+  ShiftedRule (const SIMD_BaseMappedIntegrationRule & mir, int j, double h, LocalHeap & lh)
+  {
+    auto & ir = mir.IR();
+    auto & irs = *new (lh) SIMD_IntegrationRule (ir.GetNIP(), lh);
+    for (size_t k = 0; k < irs.Size(); k++)
+      {
+        irs[k] = ir[k];
+        irs[k](j) += h;
+      }
+    return mir.GetTransformation() (irs, lh);
+  }
+
+  
+  template <int D>
+  void DiffOpHesse<D> ::
+  GenerateMatrixSIMDIR (const FiniteElement & fel,
+                        const SIMD_BaseMappedIntegrationRule & bmir,
+                        BareSliceMatrix<SIMD<double>> mat)
+  {
+    auto & mir = static_cast<const SIMD_MappedIntegrationRule<D,D>&> (bmir);
+    auto & fel_u = Cast(fel);
+    size_t nd = fel_u.GetNDof();
+    size_t nip = mir.Size();
+
+    LocalHeap lh((nip+1) * (500*SIMD<double>::Size() + 2*D*nd*sizeof(SIMD<double>)),
+                 "diffophesse-simd");
+    FlatMatrix<SIMD<double>> dshape(nd*D, nip, lh);
+    FlatMatrix<SIMD<double>> ddshape(nd*D, nip, lh);
+    mat.AddSize(nd*D*D, nip) = SIMD<double>(0.0);
+
+    for (int j = 0; j < D; j++)   // d / dxi_j
+      {
+        ddshape = SIMD<double>(0.0);
+        for (int s = 0; s < 4; s++)
+          {
+            HeapReset hr(lh);
+            fel_u.CalcMappedDShape (ShiftedRule (mir, j, hesse_shifts[s]*eps(), lh), dshape);
+            ddshape += (hesse_weights[s]/eps()) * dshape;
+          }
+        // d/dx_m = sum_j jacinv(j,m) d/dxi_j
+        for (size_t k = 0; k < nip; k++)
+          {
+            auto jacinv = mir[k].GetJacobianInverse();
+            for (size_t n = 0; n < nd; n++)
+              for (int l = 0; l < D; l++)
+                for (int m = 0; m < D; m++)
+                  mat(n*D*D+m*D+l, k) += jacinv(j,m) * ddshape(n*D+l, k);
+          }
+      }
+  }
+
+  template <int D>
+  void DiffOpHesse<D> ::
+  ApplySIMDIR (const FiniteElement & fel, const SIMD_BaseMappedIntegrationRule & bmir,
+               BareSliceVector<double> x, BareSliceMatrix<SIMD<double>> y)
+  {
+    auto & mir = static_cast<const SIMD_MappedIntegrationRule<D,D>&> (bmir);
+    auto & fel_u = Cast(fel);
+    size_t nip = mir.Size();
+
+    size_t size = (nip+1)*500*SIMD<double>::Size();
+    STACK_ARRAY(char, data, size);
+    LocalHeap lh(data, size);
+    FlatMatrix<SIMD<double>> hx(D, nip, lh);
+    FlatMatrix<SIMD<double>> hxs(D, nip, lh);
+    y.AddSize(D*D, nip) = SIMD<double>(0.0);
+
+    for (int j = 0; j < D; j++)
+      {
+        hx = SIMD<double>(0.0);
+        for (int s = 0; s < 4; s++)
+          {
+            HeapReset hr(lh);
+            fel_u.EvaluateGrad (ShiftedRule (mir, j, hesse_shifts[s]*eps(), lh), x, hxs);
+            hx += (hesse_weights[s]/eps()) * hxs;
+          }
+        for (size_t k = 0; k < nip; k++)
+          {
+            auto jacinv = mir[k].GetJacobianInverse();
+            for (int l = 0; l < D; l++)
+              for (int m = 0; m < D; m++)
+                y(m*D+l, k) += jacinv(j,m) * hx(l, k);
+          }
+      }
+  }
+
+  template <int D>
+  void DiffOpHesse<D> ::
+  AddTransSIMDIR (const FiniteElement & fel, const SIMD_BaseMappedIntegrationRule & bmir,
+                  BareSliceMatrix<SIMD<double>> x, BareSliceVector<double> y)
+  {
+    auto & mir = static_cast<const SIMD_MappedIntegrationRule<D,D>&> (bmir);
+    auto & fel_u = Cast(fel);
+    size_t nip = mir.Size();
+
+    size_t size = (nip+1)*500*SIMD<double>::Size();
+    STACK_ARRAY(char, data, size);
+    LocalHeap lh(data, size);
+    FlatMatrix<SIMD<double>> hx(D, nip, lh);
+    FlatMatrix<SIMD<double>> hxs(D, nip, lh);
+
+    for (int j = 0; j < D; j++)
+      {
+        for (size_t k = 0; k < nip; k++)
+          {
+            auto jacinv = mir[k].GetJacobianInverse();
+            for (int l = 0; l < D; l++)
+              {
+                SIMD<double> sum = 0;
+                for (int m = 0; m < D; m++)
+                  sum += jacinv(j,m) * x(m*D+l, k);
+                hx(l, k) = sum;
+              }
+          }
+        for (int s = 0; s < 4; s++)
+          {
+            HeapReset hr(lh);
+            hxs = (hesse_weights[s]/eps()) * hx;
+            fel_u.AddGradTrans (ShiftedRule (mir, j, hesse_shifts[s]*eps(), lh), hxs, y);
+          }
+      }
+  }
+
+  template class DiffOpHesse<1>;
+  template class DiffOpHesse<2>;
+  template class DiffOpHesse<3>;
+
   template class NGS_DLL_HEADER T_DifferentialOperator<DiffOpHesse<1> >;
   template class NGS_DLL_HEADER T_DifferentialOperator<DiffOpHesse<2> >;
   template class NGS_DLL_HEADER T_DifferentialOperator<DiffOpHesse<3> >;
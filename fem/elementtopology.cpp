@@ -54,74 +54,16 @@ namespace ngfem
 
   const POINT3D * ElementTopology :: GetVertices (ELEMENT_TYPE et)
   { 
-    static double segm_points [][3] = 
-      { { 1 },
-	{ 0 } };
-    
-    static double trig_points [][3] = 
-      { { 1, 0 },
-	{ 0, 1 },
-	{ 0, 0 } };
-
-    static double quad_points [][3] = 
-      { { 0, 0 },
-	{ 1, 0 },
-	{ 1, 1 },
-	{ 0, 1 } };
-
-    static double tet_points [][3] = 
-      { { 1, 0, 0 },
-	{ 0, 1, 0 },
-	{ 0, 0, 1 },
-	{ 0, 0, 0 } };
-
-    static double pyramid_points [][3] =
-      {
-	{ 0, 0, 0 },
-	{ 1, 0, 0 },
-	{ 1, 1, 0 },
-	{ 0, 1, 0 },
-	{ 0, 0, 1-1e-12 },
-      };    
-  
-    static double prism_points[][3] = 
-      {
-	{ 1, 0, 0 },
-	{ 0, 1, 0 },
-	{ 0, 0, 0 },
-	{ 1, 0, 1 },
-	{ 0, 1, 1 },
-	{ 0, 0, 1 }
-      };
-
-    static double hex_points[][3] = 
-      { 
-	{ 0, 0, 0 },
-	{ 1, 0, 0 },
-	{ 1, 1, 0 },
-	{ 0, 1, 0 },
-	{ 0, 0, 1 },
-	{ 1, 0, 1 },
-	{ 1, 1, 1 },
-	{ 0, 1, 1 }
-      };
-
-    static double point_points[][3] = 
-      { 
-	{ 0, 0, 0 },
-      };
-
-    
     switch (et)
       {
-      case ET_POINT: return point_points;
-      case ET_SEGM: return segm_points;
-      case ET_TRIG: return trig_points;
-      case ET_QUAD: return quad_points;
-      case ET_TET:  return tet_points;
-      case ET_PYRAMID: return pyramid_points;
-      case ET_PRISM: return prism_points;
-      case ET_HEX: return hex_points;
+      case ET_POINT: return T_ElementTopology<ET_POINT>::vertices;
+      case ET_SEGM: return T_ElementTopology<ET_SEGM>::vertices;
+      case ET_TRIG: return T_ElementTopology<ET_TRIG>::vertices;
+      case ET_QUAD: return T_ElementTopology<ET_QUAD>::vertices;
+      case ET_TET:  return T_ElementTopology<ET_TET>::vertices;
+      case ET_PYRAMID: return T_ElementTopology<ET_PYRAMID>::vertices;
+      case ET_PRISM: return T_ElementTopology<ET_PRISM>::vertices;
+      case ET_HEX: return T_ElementTopology<ET_HEX>::vertices;
       default:
     break;
       }
@@ -143,6 +143,167 @@ namespace ngfem
     size_t Nr() const { return nr; } 
   };
 
+
+  /**
+     Topology of the reference elements as constexpr tables, the same
+     numbering as in ElementTopology. Vertex coordinates and normals
+     are padded to 3 components, the normals have the length of the
+     facet (see ElementTopology::GetNormals).
+  */
+  template <ELEMENT_TYPE ET> struct ElementTopologyTables;
+
+  template <> struct ElementTopologyTables<ET_POINT>
+  {
+    enum { N_VERTEX = 1, N_EDGE = 0, N_FACE = 0, N_FACET = 0 };
+    static constexpr double vertices[1][3] = { { 0, 0, 0 } };
+  };
+
+  template <> struct ElementTopologyTables<ET_SEGM>
+  {
+    enum { N_VERTEX = 2, N_EDGE = 1, N_FACE = 0, N_FACET = 2 };
+    static constexpr double vertices[2][3] = { { 1, 0, 0 }, { 0, 0, 0 } };
+    static constexpr int edges[1][2] = { { 0, 1 } };
+    static constexpr ELEMENT_TYPE facet_types[2] = { ET_POINT, ET_POINT };
+    static constexpr double normals[2][3] = { { 1, 0, 0 }, { -1, 0, 0 } };
+  };
+
+  template <> struct ElementTopologyTables<ET_TRIG>
+  {
+    enum { N_VERTEX = 3, N_EDGE = 3, N_FACE = 1, N_FACET = 3 };
+    static constexpr double vertices[3][3] =
+      { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 0 } };
+    static constexpr int edges[3][2] =
+      { { 2, 0 }, { 1, 2 }, { 0, 1 } };
+    static constexpr int faces[1][4] =
+      { { 0, 1, 2, -1 } };
+    static constexpr ELEMENT_TYPE facet_types[3] = { ET_SEGM, ET_SEGM, ET_SEGM };
+    static constexpr double normals[3][3] =
+      { { 0, -1, 0 }, { -1, 0, 0 }, { 1, 1, 0 } };
+  };
+
+  template <> struct ElementTopologyTables<ET_QUAD>
+  {
+    enum { N_VERTEX = 4, N_EDGE = 4, N_FACE = 1, N_FACET = 4 };
+    static constexpr double vertices[4][3] =
+      { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+    static constexpr int edges[4][2] =
+      { { 0, 1 }, { 2, 3 }, { 3, 0 }, { 1, 2 } };
+    static constexpr int faces[1][4] =
+      { { 0, 1, 2, 3 } };
+    static constexpr ELEMENT_TYPE facet_types[4] = { ET_SEGM, ET_SEGM, ET_SEGM, ET_SEGM };
+    static constexpr double normals[4][3] =
+      { { 0, -1, 0 }, { 0, 1, 0 }, { -1, 0, 0 }, { 1, 0, 0 } };
+  };
+
+  template <> struct ElementTopologyTables<ET_TET>
+  {
+    enum { N_VERTEX = 4, N_EDGE = 6, N_FACE = 4, N_FACET = 4 };
+    static constexpr double vertices[4][3] =
+      { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 0, 0, 0 } };
+    static constexpr int edges[6][2] =
+      { { 3, 0 }, { 3, 1 }, { 3, 2 }, { 0, 1 }, { 0, 2 }, { 1, 2 } };
+    // all faces point into interior!
+    static constexpr int faces[4][4] =
+      { { 3, 1, 2, -1 }, { 3, 2, 0, -1 }, { 3, 0, 1, -1 }, { 0, 2, 1, -1 } };
+    static constexpr ELEMENT_TYPE facet_types[4] = { ET_TRIG, ET_TRIG, ET_TRIG, ET_TRIG };
+    static constexpr double normals[4][3] =
+      { { -1, 0, 0 }, { 0, -1, 0 }, { 0, 0, -1 }, { 1, 1, 1 } };
+  };
+
+  template <> struct ElementTopologyTables<ET_PYRAMID>
+  {
+    enum { N_VERTEX = 5, N_EDGE = 8, N_FACE = 5, N_FACET = 5 };
+    static constexpr double vertices[5][3] =
+      { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1-1e-12 } };
+    static constexpr int edges[8][2] =
+      { { 0, 1 }, { 1, 2 }, { 0, 3 }, { 3, 2 }, { 0, 4 }, { 1, 4 }, { 2, 4 }, { 3, 4 } };
+    // the quad points into interior!
+    static constexpr int faces[5][4] =
+      { { 0, 1, 4, -1 }, { 1, 2, 4, -1 }, { 2, 3, 4, -1 }, { 3, 0, 4, -1 }, { 0, 1, 2, 3 } };
+    static constexpr ELEMENT_TYPE facet_types[5] = { ET_TRIG, ET_TRIG, ET_TRIG, ET_TRIG, ET_QUAD };
+    static constexpr double normals[5][3] =
+      { { 0, -1, 0 }, { 1, 0, 1 }, { 0, 1, 1 }, { -1, 0, 0 }, { 0, 0, -1 } };
+  };
+
+  template <> struct ElementTopologyTables<ET_PRISM>
+  {
+    enum { N_VERTEX = 6, N_EDGE = 9, N_FACE = 5, N_FACET = 5 };
+    static constexpr double vertices[6][3] =
+      { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 0 }, { 1, 0, 1 }, { 0, 1, 1 }, { 0, 0, 1 } };
+    static constexpr int edges[9][2] =
+      { { 2, 0 }, { 0, 1 }, { 2, 1 }, { 5, 3 }, { 3, 4 }, { 5, 4 }, { 2, 5 }, { 0, 3 }, { 1, 4 } };
+    static constexpr int faces[5][4] =
+      { { 0, 2, 1, -1 }, { 3, 4, 5, -1 }, { 2, 0, 3, 5 }, { 0, 1, 4, 3 }, { 1, 2, 5, 4 } };
+    static constexpr ELEMENT_TYPE facet_types[5] = { ET_TRIG, ET_TRIG, ET_QUAD, ET_QUAD, ET_QUAD };
+    static constexpr double normals[5][3] =
+      { { 0, 0, -1 }, { 0, 0, 1 }, { 0, -1, 0 }, { 1, 1, 0 }, { -1, 0, 0 } };
+  };
+
+  template <> struct ElementTopologyTables<ET_HEX>
+  {
+    enum { N_VERTEX = 8, N_EDGE = 12, N_FACE = 6, N_FACET = 6 };
+    static constexpr double vertices[8][3] =
+      { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+        { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } };
+    static constexpr int edges[12][2] =
+      { { 0, 1 }, { 2, 3 }, { 3, 0 }, { 1, 2 }, { 4, 5 }, { 6, 7 },
+        { 7, 4 }, { 5, 6 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+    static constexpr int faces[6][4] =
+      { { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 },
+        { 1, 2, 6, 5 }, { 2, 3, 7, 6 }, { 3, 0, 4, 7 } };
+    static constexpr ELEMENT_TYPE facet_types[6] = { ET_QUAD, ET_QUAD, ET_QUAD, ET_QUAD, ET_QUAD, ET_QUAD };
+    static constexpr double normals[6][3] =
+      { { 0, 0, -1 }, { 0, 0, 1 }, { 0, -1, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { -1, 0, 0 } };
+  };
+
+
+  /**
+     The topology of element type ET resolved at compile time, the
+     templated counterpart of ElementTopology for element-type
+     specialized code.
+  */
+  template <ELEMENT_TYPE ET>
+  class T_ElementTopology : public ElementTopologyTables<ET>
+  {
+    using TAB = ElementTopologyTables<ET>;
+  public:
+    enum { DIM = Dim(ET) };
+
+    static constexpr ELEMENT_TYPE ElementType () { return ET; }
+    static constexpr int GetNVertices () { return TAB::N_VERTEX; }
+    static constexpr int GetNEdges () { return TAB::N_EDGE; }
+    static constexpr int GetNFaces () { return TAB::N_FACE; }
+    static constexpr int GetNFacets () { return TAB::N_FACET; }
+
+    static constexpr ELEMENT_TYPE GetFacetType (int k) { return TAB::facet_types[k]; }
+    static constexpr ELEMENT_TYPE GetFaceType (int k)
+    {
+      if constexpr (DIM < 2) return ET_POINT;
+      else if constexpr (DIM == 2) return ET;
+      else return TAB::faces[k][3] == -1 ? ET_TRIG : ET_QUAD;
+    }
+
+    static INLINE INT<2> GetEdge (int i)
+    { return INT<2> (TAB::edges[i][0], TAB::edges[i][1]); }
+    static INLINE INT<4> GetFace (int i)
+    { return INT<4> (TAB::faces[i][0], TAB::faces[i][1], TAB::faces[i][2], TAB::faces[i][3]); }
+
+    static INLINE Vec<DIM> GetVertex (int i)
+    {
+      Vec<DIM> p;
+      for (int j = 0; j < DIM; j++) p(j) = TAB::vertices[i][j];
+      return p;
+    }
+
+    /// reference normal of facet k, length is the measure of the facet
+    static INLINE Vec<DIM> GetNormal (int k)
+    {
+      Vec<DIM> n;
+      for (int j = 0; j < DIM; j++) n(j) = TAB::normals[k][j];
+      return n;
+    }
+  };
+
   
   /// Topology and coordinate information of master element:
   class NGS_DLL_HEADER ElementTopology
@@ -336,76 +497,16 @@ namespace ngfem
     /// returns edges of elements. zero-based pairs of integers
     static const EDGE * GetEdges (ELEMENT_TYPE et)
     {
-      static const int segm_edges[1][2] =
-	{ { 0, 1 }};
-    
-
-      static const int trig_edges[3][2] =
-	{ { 2, 0 },
-	  { 1, 2 },
-	  { 0, 1 }};
-
-      static const int quad_edges[4][2] =
-	{ { 0, 1 },
-	  { 2, 3 },
-	  { 3, 0 },
-	  { 1, 2 }};
-    
-      static const int tet_edges[6][2] =
-	{ { 3, 0 },
-	  { 3, 1 },
-	  { 3, 2 }, 
-	  { 0, 1 }, 
-	  { 0, 2 },
-	  { 1, 2 }};
-    
-      static const int prism_edges[9][2] =
-	{ { 2, 0 },
-	  { 0, 1 },
-	  { 2, 1 },
-	  { 5, 3 },
-	  { 3, 4 },
-	  { 5, 4 },
-	  { 2, 5 },
-	  { 0, 3 },
-	  { 1, 4 }};
-
-      static const int pyramid_edges[8][2] =
-	{ { 0, 1 },
-	  { 1, 2 },
-	  { 0, 3 },
-	  { 3, 2 },
-	  { 0, 4 },
-	  { 1, 4 },
-	  { 2, 4 },
-	  { 3, 4 }};
-
-      static const int hex_edges[12][2] =
-	{
-	  { 0, 1 },
-	  { 2, 3 },
-	  { 3, 0 },
-	  { 1, 2 },
-	  { 4, 5 },
-	  { 6, 7 },
-	  { 7, 4 },
-	  { 5, 6 },
-	  { 0, 4 },
-	  { 1, 5 },
-	  { 2, 6 },
-	  { 3, 7 },
-	};
-    
       switch (et)
 	{
         case ET_POINT: return nullptr;
-	case ET_SEGM: return segm_edges;
-	case ET_TRIG: return trig_edges;
-	case ET_QUAD: return quad_edges;
-	case ET_TET:  return tet_edges;
-	case ET_PYRAMID: return pyramid_edges;
-	case ET_PRISM: return prism_edges;
-	case ET_HEX: return hex_edges;
+	case ET_SEGM: return T_ElementTopology<ET_SEGM>::edges;
+	case ET_TRIG: return T_ElementTopology<ET_TRIG>::edges;
+	case ET_QUAD: return T_ElementTopology<ET_QUAD>::edges;
+	case ET_TET:  return T_ElementTopology<ET_TET>::edges;
+	case ET_PYRAMID: return T_ElementTopology<ET_PYRAMID>::edges;
+	case ET_PRISM: return T_ElementTopology<ET_PRISM>::edges;
+	case ET_HEX: return T_ElementTopology<ET_HEX>::edges;
 	default:
 	  break;
 	}
@@ -416,59 +517,15 @@ namespace ngfem
     /// returns faces of elements. zero-based array of 4 integers, last one is -1 for triangles
     static const FACE * GetFaces (ELEMENT_TYPE et)
     {
-      static int tet_faces[4][4] =
-	{ { 3, 1, 2, -1 },
-	  { 3, 2, 0, -1 },
-	  { 3, 0, 1, -1 },
-	  { 0, 2, 1, -1 } }; // all faces point into interior!
-  
-      static int prism_faces[5][4] =
-	{
-	  { 0, 2, 1, -1 },
-	  { 3, 4, 5, -1 },
-	  { 2, 0, 3, 5 },
-	  { 0, 1, 4, 3 },
-	  { 1, 2, 5, 4 } 
-	};
-
-      static int pyramid_faces[5][4] =
-	{
-	  { 0, 1, 4, -1 },
-	  { 1, 2, 4, -1 },
-	  { 2, 3, 4, -1 },
-	  { 3, 0, 4, -1 },
-	  { 0, 1, 2, 3 } // points into interior!
-	};
-  
-      static int hex_faces[6][4] =
-	{
-	  { 0, 3, 2, 1 },
-	  { 4, 5, 6, 7 },
-	  { 0, 1, 5, 4 },
-	  { 1, 2, 6, 5 },
-	  { 2, 3, 7, 6 },
-	  { 3, 0, 4, 7 }
-	};
-    
-      static int trig_faces[1][4] = 
-	{
-	  { 0, 1, 2, -1 },
-	};
-      
-      static int quad_faces[1][4] = 
-	{
-	  { 0, 1, 2, 3 },
-	};
-    
       switch (et)
 	{
-	case ET_TET: return tet_faces;
-	case ET_PRISM: return prism_faces;
-	case ET_PYRAMID: return pyramid_faces;
-	case ET_HEX: return hex_faces;
+	case ET_TET: return T_ElementTopology<ET_TET>::faces;
+	case ET_PRISM: return T_ElementTopology<ET_PRISM>::faces;
+	case ET_PYRAMID: return T_ElementTopology<ET_PYRAMID>::faces;
+	case ET_HEX: return T_ElementTopology<ET_HEX>::faces;
 
-	case ET_TRIG: return trig_faces;
-	case ET_QUAD: return quad_faces;
+	case ET_TRIG: return T_ElementTopology<ET_TRIG>::faces;
+	case ET_QUAD: return T_ElementTopology<ET_QUAD>::faces;
         
 	case ET_SEGM: return nullptr;
         case ET_POINT: return nullptr;          
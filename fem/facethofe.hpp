@@ -54,7 +54,7 @@ namespace ngfem
 	{
 	  first_facet_dof[i] = ndof;
 	  int fo = facet_order[i];
-	  switch (ElementTopology::GetFacetType (ET, i))
+	  switch (T_ElementTopology<ET>::GetFacetType (i))
 	    {
 	    case ET_POINT: ndof += 1; break;
 	    case ET_SEGM: ndof += fo+1; break;
@@ -68,6 +68,7 @@ namespace ngfem
 
 
 #include "specialelement.hpp"
+#include "besselfunctions.hpp"
 #include "code_generation.hpp"
 #include "coefficient.hpp"
 
@@ -67,3 +67,147 @@ public:
 
 
 // InitFemKernels ifc;
+
+
+
+/*
+  Assembly of symbolic integrators with constant coefficients on affine
+  elements, see comp/devassembly.cpp. The element matrix is a
+  combination of reference element matrices R_c (ndof x ndof, test x trial),
+  the coefficients depend on the Jacobian of the element.
+*/
+
+#define DEV_GRID 512
+#define DEV_BLOCK 256
+
+// inverse and |det| of the D x D Jacobian, row-major
+__device__ double InvJacobian (int D, const double * jac, double * inv)
+{
+  double det;
+  switch (D)
+    {
+    case 1:
+      det = jac[0];
+      inv[0] = 1/det;
+      break;
+    case 2:
+      det = jac[0]*jac[3]-jac[1]*jac[2];
+      inv[0] = jac[3]/det; inv[1] = -jac[1]/det;
+      inv[2] = -jac[2]/det; inv[3] = jac[0]/det;
+      break;
+    default:
+      inv[0] = jac[4]*jac[8]-jac[5]*jac[7];
+      inv[1] = jac[2]*jac[7]-jac[1]*jac[8];
+      inv[2] = jac[1]*jac[5]-jac[2]*jac[4];
+      inv[3] = jac[5]*jac[6]-jac[3]*jac[8];
+      inv[4] = jac[0]*jac[8]-jac[2]*jac[6];
+      inv[5] = jac[2]*jac[3]-jac[0]*jac[5];
+      inv[6] = jac[3]*jac[7]-jac[4]*jac[6];
+      inv[7] = jac[1]*jac[6]-jac[0]*jac[7];
+      inv[8] = jac[0]*jac[4]-jac[1]*jac[3];
+      det = jac[0]*inv[0]+jac[1]*inv[3]+jac[2]*inv[6];
+      for (int i = 0; i < 9; i++) inv[i] /= det;
+    }
+  return fabs(det);
+}
+
+/*
+  batched geometry, one thread per element:
+  in = [ J (D*D) | dmat of term 0 | dmat of term 1 | ... ] per element,
+  coefs(b*n1+a) = |det J| sum_kl T1(k,a) dmat(k,l) T2(l,b),  T = 1 or J^{-T}
+*/
+__global__ void ReferenceCoefsKernel (int nel, int D, int nterms, const int * types,
+                                      int nin, const double * in, int ncoef, double * coefs)
+{
+  int tid = blockIdx.x*blockDim.x+threadIdx.x;
+  for (int e = tid; e < nel; e += blockDim.x*gridDim.x)
+    {
+      const double * pin = in + size_t(e)*nin;
+      double * pc = coefs + size_t(e)*ncoef;
+      double inv[9];
+      double measure = InvJacobian (D, pin, inv);
+      const double * dmat = pin + D*D;
+      for (int t = 0; t < nterms; t++)
+        {
+          int type1 = types[2*t], type2 = types[2*t+1];
+          int n1 = type1 ? D : 1, n2 = type2 ? D : 1;
+          for (int b = 0; b < n2; b++)
+            for (int a = 0; a < n1; a++)
+              {
+                double sum = 0;
+                for (int k = 0; k < n1; k++)
+                  for (int l = 0; l < n2; l++)
+                    sum += (type1 ? inv[a*D+k] : 1.0) * dmat[k*n2+l] * (type2 ? inv[b*D+l] : 1.0);
+                *pc++ = measure * sum;
+              }
+          dmat += n1*n2;
+        }
+    }
+}
+
+void DevReferenceCoefs (int nel, int D, int nterms, const int * types,
+                        int nin, const double * in, int ncoef, double * coefs)
+{
+  if (nel) ReferenceCoefsKernel<<<DEV_GRID,DEV_BLOCK>>> (nel, D, nterms, types, nin, in, ncoef, coefs);
+}
+
+
+/*
+  one cuda-block per element: the coefficients, dofs and the element
+  matrix sum_c coefs(c) R_c in shared memory, then atomic scatter into
+  the CSR values. Unused dofs are negative, the column indices of the
+  rows are sorted.
+*/
+__global__ void ElementMatrixKernel (int nel, int ndof, int ncoef, const double * refmats,
+                                     const double * coefs, const int * dofs,
+                                     const int * firstrow, const int * cols, double * vals)
+{
+  extern __shared__ double shared[];
+  double * elcoefs = shared;
+  double * elmat = shared + ncoef;
+  int * eldofs = (int*) (elmat + ndof*ndof);
+  int nn = ndof*ndof;
+
+  for (int e = blockIdx.x; e < nel; e += gridDim.x)
+    {
+      for (int c = threadIdx.x; c < ncoef; c += blockDim.x)
+        elcoefs[c] = coefs[size_t(e)*ncoef+c];
+      for (int i = threadIdx.x; i < ndof; i += blockDim.x)
+        eldofs[i] = dofs[size_t(e)*ndof+i];
+      __syncthreads();
+
+      for (int ij = threadIdx.x; ij < nn; ij += blockDim.x)
+        {
+          double sum = 0;
+          for (int c = 0; c < ncoef; c++)
+            sum += elcoefs[c] * refmats[size_t(c)*nn+ij];
+          elmat[ij] = sum;
+        }
+      __syncthreads();
+
+      for (int ij = threadIdx.x; ij < nn; ij += blockDim.x)
+        {
+          int row = eldofs[ij / ndof], col = eldofs[ij % ndof];
+          if (row < 0 || col < 0 || elmat[ij] == 0) continue;
+          int first = firstrow[row], last = firstrow[row+1];
+          while (first < last)
+            {
+              int mid = (first+last)/2;
+              if (cols[mid] < col) first = mid+1;
+              else last = mid;
+            }
+          if (first < firstrow[row+1] && cols[first] == col)
+            atomicAdd (&vals[first], elmat[ij]);
+        }
+      __syncthreads();
+    }
+}
+
+void DevAssembleElementMatrices (int nel, int ndof, int ncoef, const double * refmats,
+                                 const double * coefs, const int * dofs,
+                                 const int * firstrow, const int * cols, double * vals)
+{
+  size_t shared = (ncoef + ndof*ndof) * sizeof(double) + ndof * sizeof(int);
+  if (nel) ElementMatrixKernel<<<DEV_GRID,128,shared>>> (nel, ndof, ncoef, refmats, coefs, dofs,
+                                                        firstrow, cols, vals);
+}
@@ -131,6 +131,20 @@ namespace ngfem
       order = ho;
     }
 
+    /// uniform order simplices: shapes are determined by the vertex ordering
+    int ShapeClassNr () const
+    {
+      if (nodalp2 || (ET != ET_SEGM && ET != ET_TRIG && ET != ET_TET))
+        return -1;
+      for (int i = 0; i < N_EDGE; i++)
+        if (order_edge[i] != order) return -1;
+      for (int i = 0; i < N_FACE; i++)
+        if (order_face[i][0] != order || order_face[i][1] != order) return -1;
+      if (DIM == 3 && (order_cell[0][0] != order || order_cell[0][1] != order || order_cell[0][2] != order))
+        return -1;
+      return ET_trait<ET>::GetClassNr (this->vnums);
+    }
+
 
   };
 
@@ -37,6 +37,15 @@ namespace ngfem
     
     void CalcDualShape2 (const BaseMappedIntegrationPoint & mip, SliceVector<> shape) const
     { throw Exception ("dual shape not implemented, H1Ho"); }
+
+    /// prism shapes are products tfac[i](x,y) * zfac[zind[i]](z), for sum factorization
+    static constexpr bool PRISM_FACTORS = (ET == ET_PRISM);
+    template<typename Tx, typename TFA>  
+      INLINE void T_CalcTrigFactors (TIP<2,Tx> ip, TFA & tfac) const;
+    template<typename Tz, typename TFA>  
+      INLINE void T_CalcZFactors (Tz z, TFA & zfac) const;
+    /// zind of all shapes, returns the number of z-factors
+    int GetZFactorIndex (FlatArray<int> zind) const;
     
   };
 
@@ -476,6 +485,194 @@ namespace ngfem
 
  
 
+  /*
+    The prism shapes as products of a trig factor and a z-factor, in
+    the order of T_CalcShape. The z-factors are 1-z, z, then the
+    polynomials of the vertical edges, the vertical direction of the
+    quad faces and the cell.
+  */
+  
+  template<> template<typename Tx, typename TFA>  
+  void  H1HighOrderFE_Shape<ET_PRISM> :: T_CalcTrigFactors (TIP<2,Tx> ip, TFA & tfac) const
+  {
+    Tx x = ip.x, y = ip.y;
+    Tx lam[6] = { x, y, 1-x-y, x, y, 1-x-y };
+
+    for (int i = 0; i < 6; i++) tfac[i] = lam[i];
+    int ii = 6;
+
+    // horizontal edges
+    for (int i = 0; i < 6; i++)
+      if (order_edge[i] >= 2)
+	{
+          INT<2> e = GetVertexOrientedEdge (i);
+	  EdgeOrthoPol::
+	    EvalScaledMult (order_edge[i]-2, lam[e[1]]-lam[e[0]], lam[e[0]]+lam[e[1]],
+                            lam[e[0]]*lam[e[1]], tfac+ii);
+	  ii += order_edge[i]-1;
+	}
+    
+    // vertical edges
+    for (int i = 6; i < 9; i++)
+      if (order_edge[i] >= 2)
+	{
+          INT<2> e = GetVertexOrientedEdge (i);
+          for (int k = 0; k < order_edge[i]-1; k++)
+            tfac[ii++] = lam[e[1]];
+	}
+
+    ArrayMem<Tx,20> pol(order+1);
+    
+    // trig faces
+    for (int i = 0; i < 2; i++)
+      if (order_face[i][0] >= 3)
+	{
+          INT<4> f = GetVertexOrientedFace (i);
+	  int p = order_face[i][0];
+	  DubinerBasis::
+	    EvalMult (p-3, lam[f[0]], lam[f[1]], lam[0]*lam[1]*lam[2], tfac+ii);
+	  ii += (p-2)*(p-1)/2; 
+	}
+   
+    // quad faces
+    for (int i = 2; i < 5; i++)
+      if (order_face[i][0] >= 2 && order_face[i][1] >= 2)
+	{
+	  INT<2> p = order_face[i];
+          INT<4> f = GetVertexOrientedFace (i);          
+	  if (f[0] / 3 == f[1] / 3)
+            {
+              // xi is horizontal
+              Tx xi = lam[f[0]]-lam[f[1]];
+              Tx scalexi = lam[f[0]]+lam[f[1]];
+              QuadOrthoPol::EvalScaledMult (p[0]-2, xi, scalexi, 0.25*(scalexi*scalexi-xi*xi), pol);
+              for (int k = 0; k < p[0]-1; k++) 
+                for (int j = 0; j < p[1]-1; j++) 
+                  tfac[ii++] = pol[k];
+            }
+	  else
+            {
+              Tx eta = lam[f[0]]-lam[f[3]];
+              Tx scaleeta = lam[f[0]]+lam[f[3]];
+              QuadOrthoPol::EvalScaledMult (p[1]-2, eta, scaleeta, 0.25*(scaleeta*scaleeta-eta*eta), pol);
+              for (int k = 0; k < p[0]-1; k++) 
+                for (int j = 0; j < p[1]-1; j++) 
+                  tfac[ii++] = pol[j];
+            }
+	}
+    
+    // cell
+    INT<3> p = order_cell[0];
+    if (p[0] > 2 && p[2] > 1)
+      {
+	int nf = (p[0]-1)*(p[0]-2)/2;
+	ArrayMem<Tx,20> pol_trig(nf);
+	DubinerBasis::EvalMult (p[0]-3, x, y, x*y*(1-x-y), pol_trig);
+	for (int i = 0; i < nf; i++)
+	  for (int k = 0; k < p[2]-1; k++)
+	    tfac[ii++] = pol_trig[i];
+      }
+  }
+
+  template<> template<typename Tz, typename TFA>  
+  void  H1HighOrderFE_Shape<ET_PRISM> :: T_CalcZFactors (Tz z, TFA & zfac) const
+  {
+    Tz muz[6]  = { 1-z, 1-z, 1-z, z, z, z };
+    zfac[0] = 1-z;
+    zfac[1] = z;
+    int ii = 2;
+
+    // vertical edges
+    for (int i = 6; i < 9; i++)
+      if (order_edge[i] >= 2)
+	{
+          INT<2> e = GetVertexOrientedEdge (i);
+	  EdgeOrthoPol::
+	    EvalMult (order_edge[i]-2, muz[e[1]]-muz[e[0]], muz[e[0]]*muz[e[1]], zfac+ii);
+	  ii += order_edge[i]-1;
+	}
+
+    // quad faces
+    for (int i = 2; i < 5; i++)
+      if (order_face[i][0] >= 2 && order_face[i][1] >= 2)
+	{
+	  INT<2> p = order_face[i];
+          INT<4> f = GetVertexOrientedFace (i);          
+	  if (f[0] / 3 == f[1] / 3)
+            {
+              // eta is vertical
+              Tz eta = muz[f[0]]-muz[f[3]];
+              QuadOrthoPol::EvalScaledMult (p[1]-2, eta, Tz(1.0), 0.25*(1-eta*eta), zfac+ii);
+              ii += p[1]-1;
+            }
+          else
+            {
+              Tz xi = muz[f[0]]-muz[f[1]];
+              QuadOrthoPol::EvalScaledMult (p[0]-2, xi, Tz(1.0), 0.25*(1-xi*xi), zfac+ii);
+              ii += p[0]-1;
+            }
+        }
+
+    // cell
+    INT<3> p = order_cell[0];
+    if (p[0] > 2 && p[2] > 1)
+      LegendrePolynomial::EvalMult (p[2]-2, 2*z-1, z*(1-z), zfac+ii);
+  }
+
+  template<>
+  inline int H1HighOrderFE_Shape<ET_PRISM> :: GetZFactorIndex (FlatArray<int> zind) const
+  {
+    for (int i = 0; i < 6; i++) zind[i] = i/3;
+    int ii = 6, iz = 2;
+
+    for (int i = 0; i < 6; i++)
+      if (order_edge[i] >= 2)
+        {
+          INT<2> e = GetVertexOrientedEdge (i);
+          for (int k = 0; k < order_edge[i]-1; k++)
+            zind[ii++] = e[1]/3;
+        }
+    
+    for (int i = 6; i < 9; i++)
+      if (order_edge[i] >= 2)
+        for (int k = 0; k < order_edge[i]-1; k++)
+          zind[ii++] = iz++;
+
+    for (int i = 0; i < 2; i++)
+      if (order_face[i][0] >= 3)
+	{
+          INT<4> f = GetVertexOrientedFace (i);
+	  int p = order_face[i][0];
+          for (int k = 0; k < (p-2)*(p-1)/2; k++)
+            zind[ii++] = f[2]/3;
+        }
+
+    for (int i = 2; i < 5; i++)
+      if (order_face[i][0] >= 2 && order_face[i][1] >= 2)
+	{
+	  INT<2> p = order_face[i];
+          INT<4> f = GetVertexOrientedFace (i);
+          bool horizontal_xi = f[0] / 3 == f[1] / 3;
+          for (int k = 0; k < p[0]-1; k++) 
+            for (int j = 0; j < p[1]-1; j++) 
+              zind[ii++] = iz + (horizontal_xi ? j : k);
+          iz += horizontal_xi ? p[1]-1 : p[0]-1;
+	}
+
+    INT<3> p = order_cell[0];
+    if (p[0] > 2 && p[2] > 1)
+      {
+	int nf = (p[0]-1)*(p[0]-2)/2;
+	for (int i = 0; i < nf; i++)
+	  for (int k = 0; k < p[2]-1; k++)
+	    zind[ii++] = iz+k;
+        iz += p[2]-1;
+      }
+    return iz;
+  }
+
+ 
+
   /* *********************** Hex  **********************/
 
   template<> template<typename Tx, typename TFA>  
@@ -613,7 +810,7 @@ namespace ngfem
 
 
     ArrayMem<Tx,20> polx(order+1), poly(order+1), polz(order+1);
-    const FACE * faces = ElementTopology::GetFaces (ET_PYRAMID);
+    const FACE * faces = T_ElementTopology<ET_PYRAMID>::faces;
 
     // trig face dofs
     for (int i = 0; i < 4; i++)
@@ -1369,7 +1369,7 @@ virtual void AddDualTrans (const SIMD_BaseMappedIntegrationRule& bmir, BareSlice
       int ii = 0;
       
 
-      const FACE * faces = ElementTopology::GetFaces(ET_PRISM);
+      const FACE * faces = T_ElementTopology<ET_PRISM>::faces;
 
       ArrayMem<AutoDiff<3,T>,20> leg_u(order+2), leg_v(order+3);
       ArrayMem<AutoDiff<3,T>,20> leg_w(order+2);
@@ -1820,7 +1820,7 @@ virtual void AddDualTrans (const SIMD_BaseMappedIntegrationRule& bmir, BareSlice
       // int maxorder_facet =
       //     max2(order_facet[0][0],max2(order_facet[1][0],order_facet[2][0]));
 
-      const FACE * faces = ElementTopology::GetFaces(ET_HEX);
+      const FACE * faces = T_ElementTopology<ET_HEX>::faces;
 
       ArrayMem<AutoDiff<3,T>,20> leg_u(order+2), leg_v(order+3);
       ArrayMem<AutoDiff<3,T>,20> leg_w(order+2);
@@ -882,7 +882,7 @@ namespace ngfem
       int maxorder_facet =
         max2(order_facet[0],max2(order_facet[1],order_facet[2]));
 
-       const FACE * faces = ElementTopology::GetFaces(ET_TET);
+       const FACE * faces = T_ElementTopology<ET_TET>::faces;
        
        ArrayMem<AutoDiff<3,T>,20> ha((maxorder_facet+1)*(maxorder_facet+2)/2.0); 
        
@@ -1644,7 +1644,7 @@ namespace ngfem
     Tx x = hx[0], y = hx[1], z = hx[2];
     Tx lami[4] = { x, y, z, 1-x-y-z };
     
-    const EDGE * edges = ElementTopology::GetEdges (ET_TET);
+    const EDGE * edges = T_ElementTopology<ET_TET>::edges;
     for (int i = 0; i < 6; i++)
     {
     Tx lam1 = lami[edges[i][0]];
@@ -1654,7 +1654,7 @@ namespace ngfem
     shape[i+12] = Du<3> (lam1*lam2*(lam1-lam2));
     }
 
-    const FACE * faces = ElementTopology::GetFaces (ET_TET); 
+    const FACE * faces = T_ElementTopology<ET_TET>::faces; 
     for (int i = 0; i < 4; i++)
     for (int k = 0; k < 3; k++)
     {
@@ -607,7 +607,7 @@ namespace ngfem
       }
 
 
-    const FACE * faces = ElementTopology::GetFaces (ET_PRISM); 
+    const FACE * faces = T_ElementTopology<ET_PRISM>::faces; 
 
     // trig face shapes
     for (int i = 0; i < 2; i++)
@@ -846,7 +846,7 @@ namespace ngfem
       }
     
     //Faces 
-    const FACE * faces = ElementTopology::GetFaces (ET_HEX);
+    const FACE * faces = T_ElementTopology<ET_HEX>::faces;
     for (int i = 0; i<6; i++)
       {
 	INT<2> p = order_face[i];
@@ -1224,7 +1224,7 @@ namespace ngfem
 	  }
       }
 
-    const FACE * faces = ElementTopology::GetFaces (ET_PYRAMID); 
+    const FACE * faces = T_ElementTopology<ET_PYRAMID>::faces; 
 
     // trig face dofs
     for (int i = 0; i < 4; i++)
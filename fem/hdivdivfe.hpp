@@ -777,74 +777,81 @@ namespace ngfem
       }
       else
       {
-        // throw ExceptionNOSIMD(string("HDivDiv - CalcMappedDivShape SIMD only for noncurved elements"));
         for (size_t i = 0; i < mir.Size(); i++)
-          {
-            // static Timer t0("HDivDivFE - hesse", 2);
-            // static Timer t1("HDivDivFE - prepare div", 2);
-            // static Timer t2("HDivDivFE - calc div", 2);
-            
-            Mat<DIM,DIM,SIMD<double>> jac = mir[i].GetJacobian();
-            Mat<DIM,DIM,SIMD<double>> inv_jac = mir[i].GetJacobianInverse();
-            Mat<DIM,DIM,SIMD<double>> finvT_h_tilde_finv[DIM];
-
-            // RegionTracer reg0(TaskManager::GetThreadId(), t0);
-            
-            Vec<DIM, Mat<DIM,DIM,SIMD<double>>> hesse;
-            mir.GetTransformation().CalcHesse (mir.IR()[i], hesse);
-
-            // RegionTracer reg1(TaskManager::GetThreadId(), t1);    
+          CurvedMappedDivShape (mir, i, [divshapes,i] (int nr, Vec<DIM,SIMD<double>> div)
+                                {
+                                  divshapes.Rows(nr*DIM,(nr+1)*DIM).Col(i).Range(0,DIM) = div;
+                                });
+      }
+    }
 
-            Mat<DIM,DIM,AutoDiff<DIM,SIMD<double>> > f_tilde;
-            for(int i = 0; i < DIM; i++)
-              for(int j = 0; j < DIM; j++)
-                {
-                  f_tilde(i,j).Value() = jac(i,j);
-                  for(int k = 0; k < DIM; k++)
-                    f_tilde(i,j).DValue(k) = hesse[i](j,k);
-                }
-            
-            AutoDiff<DIM,SIMD<double>> ad_det = Det (f_tilde);
-            AutoDiff<DIM, SIMD<double>> iad_det = 1.0 / ad_det;
-            f_tilde *= iad_det;
-            
-            for(int i=0; i<DIM; i++)
-              {
-                finvT_h_tilde_finv[i] = 0;
-                for(int alpha=0; alpha<DIM; alpha++)
-                  for(int beta=0; beta<DIM; beta++)
-                    for(int gamma=0; gamma<DIM; gamma++)
-                      for(int delta=0; delta<DIM; delta++)
-                        finvT_h_tilde_finv[i](alpha,beta) += inv_jac(gamma,alpha)*f_tilde(i,gamma).DValue(delta)*inv_jac(delta,beta);
-              }
-            for (int j = 0; j < DIM; j++)
-              finvT_h_tilde_finv[j] *= mir[i].GetJacobiDet();
-            
-            // Vec<DIM,AutoDiff<DIM,SIMD<double>>> adp = mir[i];
-            // TIP<DIM,AutoDiffDiff<DIM,SIMD<double>>> addp(adp);
-            // TIP<DIM,AutoDiff<DIM,SIMD<double>>> addp(adp);
-            // RegionTracer reg2(TaskManager::GetThreadId(), t2);    
-            /* Cast() -> */ T_CalcShape
-              (GetTIP(mir[i]), // TIP<DIM,AutoDiff<DIM,SIMD<double>>>(adp),
-               SBLambda([&](int nr,auto val)
-                              {
-                                BareSliceVector<SIMD<double>> divshape = divshapes.Rows(nr*DIM,(nr+1)*DIM).Col(i);
-
-                                Vec<DIM,SIMD<double>> div1 = val.DivShape();
-                                Vec<DIM_STRESS,SIMD<double>> vecshape = val.Shape();
-                                Vec<DIM*DIM,SIMD<double>> matshape;
-                                VecToSymMat<DIM> (vecshape, matshape);
-                                
-                                for(size_t k = 0; k < DIM; k++)
-                                  {
-                                    SIMD<double> sum = div1(k);
-                                    for(size_t j = 0; j < DIM*DIM; j++)
-                                      sum += finvT_h_tilde_finv[k](j) * matshape(j);
-                                    divshape(k) = sum;
-                                  }
-                              }));
+    /*
+      the mapped divergence of all shape functions at point i of a curved element,
+      func (nr, div) is called for every shape function
+    */
+    template <typename FUNC>
+    void CurvedMappedDivShape (const SIMD_MappedIntegrationRule<DIM,DIM> & mir, size_t i, FUNC func) const
+    {
+      // static Timer t0("HDivDivFE - hesse", 2);
+      // static Timer t1("HDivDivFE - prepare div", 2);
+      // static Timer t2("HDivDivFE - calc div", 2);
+      
+      Mat<DIM,DIM,SIMD<double>> jac = mir[i].GetJacobian();
+      Mat<DIM,DIM,SIMD<double>> inv_jac = mir[i].GetJacobianInverse();
+      Mat<DIM,DIM,SIMD<double>> finvT_h_tilde_finv[DIM];
+      
+      // RegionTracer reg0(TaskManager::GetThreadId(), t0);
+      
+      Vec<DIM, Mat<DIM,DIM,SIMD<double>>> hesse;
+      mir.GetTransformation().CalcHesse (mir.IR()[i], hesse);
+      
+      // RegionTracer reg1(TaskManager::GetThreadId(), t1);    
+      
+      Mat<DIM,DIM,AutoDiff<DIM,SIMD<double>> > f_tilde;
+      for(int l = 0; l < DIM; l++)
+        for(int j = 0; j < DIM; j++)
+          {
+            f_tilde(l,j).Value() = jac(l,j);
+            for(int k = 0; k < DIM; k++)
+              f_tilde(l,j).DValue(k) = hesse[l](j,k);
           }
-      }
+      
+      AutoDiff<DIM,SIMD<double>> ad_det = Det (f_tilde);
+      AutoDiff<DIM, SIMD<double>> iad_det = 1.0 / ad_det;
+      f_tilde *= iad_det;
+      
+      for(int l=0; l<DIM; l++)
+        {
+          finvT_h_tilde_finv[l] = 0;
+          for(int alpha=0; alpha<DIM; alpha++)
+            for(int beta=0; beta<DIM; beta++)
+              for(int gamma=0; gamma<DIM; gamma++)
+                for(int delta=0; delta<DIM; delta++)
+                  finvT_h_tilde_finv[l](alpha,beta) += inv_jac(gamma,alpha)*f_tilde(l,gamma).DValue(delta)*inv_jac(delta,beta);
+        }
+      for (int j = 0; j < DIM; j++)
+        finvT_h_tilde_finv[j] *= mir[i].GetJacobiDet();
+      
+      // RegionTracer reg2(TaskManager::GetThreadId(), t2);    
+      /* Cast() -> */ T_CalcShape
+        (GetTIP(mir[i]), 
+         SBLambda([&](int nr,auto val)
+                  {
+                    Vec<DIM,SIMD<double>> div1 = val.DivShape();
+                    Vec<DIM_STRESS,SIMD<double>> vecshape = val.Shape();
+                    Vec<DIM*DIM,SIMD<double>> matshape;
+                    VecToSymMat<DIM> (vecshape, matshape);
+
+                    Vec<DIM,SIMD<double>> div;
+                    for(size_t k = 0; k < DIM; k++)
+                      {
+                        SIMD<double> sum = div1(k);
+                        for(size_t j = 0; j < DIM*DIM; j++)
+                          sum += finvT_h_tilde_finv[k](j) * matshape(j);
+                        div(k) = sum;
+                      }
+                    func (nr, div);
+                  }));
     }
 
     virtual void EvaluateDiv (const SIMD_BaseMappedIntegrationRule & bmir, BareSliceVector<> coefs,
@@ -887,7 +894,19 @@ namespace ngfem
       }
       else
       {
-        throw ExceptionNOSIMD(string("HDivDiv - EvaluateDiv SIMD only for noncurved elements"));
+        for (size_t i = 0; i < mir.Size(); i++)
+          {
+            double *pcoefs = &coefs(0);
+            const size_t dist = coefs.Dist();
+            Vec<DIM,SIMD<double>> sum(0.0);
+            CurvedMappedDivShape (mir, i, [&sum,&pcoefs,dist] (int nr, Vec<DIM,SIMD<double>> div)
+                                  {
+                                    sum += (*pcoefs)*div;
+                                    pcoefs += dist;
+                                  });
+            for (size_t k = 0; k < DIM; k++)
+              values(k,i) = sum(k);
+          }
       }
     }
 
@@ -934,8 +953,19 @@ namespace ngfem
       }
       else
       {
-        throw ExceptionNOSIMD(string("HDivDiv - AddTrans SIMD only for noncurved elements"));
-
+        for (size_t i = 0; i < mir.Size(); i++)
+          {
+            Vec<DIM,SIMD<double>> vec;
+            for (size_t k = 0; k < DIM; k++)
+              vec(k) = values(k,i);
+            double *pcoefs = &coefs(0);
+            const size_t dist = coefs.Dist();
+            CurvedMappedDivShape (mir, i, [vec,&pcoefs,dist] (int nr, Vec<DIM,SIMD<double>> div)
+                                  {
+                                    *pcoefs += HSum(InnerProduct(vec,div));
+                                    pcoefs += dist;
+                                  });
+          }
       }
     }
 
@@ -1203,7 +1233,7 @@ namespace ngfem
       int maxorder_facet =
         max2(order_facet[0][0],max2(order_facet[1][0],order_facet[2][0]));
 
-      const EDGE * edges = ElementTopology::GetEdges(ET_TRIG);
+      const EDGE * edges = T_ElementTopology<ET_TRIG>::edges;
 
       ArrayMem<Tx,20> ha(maxorder_facet+1);
       ArrayMem<Tx,20> u(order_inner[0]+2), v(order_inner[0]+2);
@@ -1282,7 +1312,7 @@ namespace ngfem
 
       int ii = 0;
 
-      const EDGE * edges = ElementTopology::GetEdges(ET_TRIG);
+      const EDGE * edges = T_ElementTopology<ET_TRIG>::edges;
 
       if (ip.VB() == BND)
         { // facet shapes
@@ -1379,7 +1409,7 @@ namespace ngfem
       
       int ii = 0;
 
-      const EDGE * edges = ElementTopology::GetEdges(ET_QUAD);
+      const EDGE * edges = T_ElementTopology<ET_QUAD>::edges;
 
       ArrayMem<Tx,20> u(order+2), v(order+2);
       
@@ -1523,7 +1553,7 @@ namespace ngfem
       
       int ii = 0;
 
-      const EDGE * edges = ElementTopology::GetEdges(ET_QUAD);
+      const EDGE * edges = T_ElementTopology<ET_QUAD>::edges;
 
       ArrayMem<Tx,20> u(order+2), v(order+2);
       
@@ -1949,7 +1979,7 @@ namespace ngfem
       int maxorder_facet =
         max2(order_facet[0][0],max2(order_facet[1][0],order_facet[2][0]));
 
-      const FACE * faces = ElementTopology::GetFaces(ET_PRISM);
+      const FACE * faces = T_ElementTopology<ET_PRISM>::faces;
 
       ArrayMem<AutoDiffDiff<2>,20> ha(maxorder_facet+2);
       ArrayMem<AutoDiffDiff<2>,20> u(order+2), v(order+3);
@@ -2120,7 +2150,7 @@ namespace ngfem
       // int maxorder_facet =
       // max2(order_facet[0][0],max2(order_facet[1][0],order_facet[2][0]));
 
-      const FACE * faces = ElementTopology::GetFaces(ET_PRISM);
+      const FACE * faces = T_ElementTopology<ET_PRISM>::faces;
 
       ArrayMem<AutoDiff<3,T>,20> leg_u(order+2), leg_v(order+3);
       ArrayMem<AutoDiff<3,T>,20> leg_w(order+2);
@@ -2287,7 +2317,7 @@ namespace ngfem
       AutoDiff<3,T> lam[4] = { ip.x, ip.y, ip.z, 1.0-ip.x-ip.y-ip.z };
       size_t ii = 0;
       
-      //const FACE * faces = ElementTopology::GetFaces(ET_TET);
+      //const FACE * faces = T_ElementTopology<ET_TET>::faces;
 
       /*
       ArrayMem<AutoDiff<3,T>,20> leg_u(order+2), leg_v(order+3);
@@ -2485,7 +2515,7 @@ namespace ngfem
       // int maxorder_facet =
       //     max2(order_facet[0][0],max2(order_facet[1][0],order_facet[2][0]));
 
-      const FACE * faces = ElementTopology::GetFaces(ET_HEX);
+      const FACE * faces = T_ElementTopology<ET_HEX>::faces;
 
       ArrayMem<AutoDiff<3,T>,20> leg_u(order+2), leg_v(order+3);
       ArrayMem<AutoDiff<3,T>,20> leg_w(order+2);
@@ -612,7 +612,7 @@ namespace ngfem
     for (int j = 0; j < ET_trait<ET>::N_FACET; j++)
       {
 	int nf = 0;
-	switch (ElementTopology::GetFacetType(ET,j))
+	switch (T_ElementTopology<ET>::GetFacetType (j))
 	  {
 	  case ET_SEGM: nf = order_facet[j][0]; break;
 	    // case ET_TRIG: nf = (sqr (order_face[0])+3*order_face[0])/2; break;
@@ -772,7 +772,7 @@ namespace ngfem
     int ii = 4; 
     if (!only_ho_div)
     {
-      const FACE * faces = ElementTopology::GetFaces (ET_TET);
+      const FACE * faces = T_ElementTopology<ET_TET>::faces;
       for (int i = 0; i < 4; i++)
         {
         int p = order_face[i][0];
@@ -903,8 +903,8 @@ namespace ngfem
     shape = 0.0;
 
 
-    const FACE * faces = ElementTopology::GetFaces (ET_PRISM);
-    // const EDGE * edges = ElementTopology::GetEdges (ET_PRISM);
+    const FACE * faces = T_ElementTopology<ET_PRISM>::faces;
+    // const EDGE * edges = T_ElementTopology<ET_PRISM>::edges;
 
 
     ArrayMem<AutoDiff<2>,20> adpolxy1(order+1), adpolxy2(order+1), adpolx(order+1), adpoly(order+1);
@@ -1252,7 +1252,7 @@ namespace ngfem
     AutoDiff<3> lami[6] = { x, y, 1-x-y, x, y, 1-x-y };
     AutoDiff<3> muz[6]  = { 1-z, 1-z, 1-z, z, z, z };
        
-    const FACE * faces = ElementTopology::GetFaces (ET_PRISM); 
+    const FACE * faces = T_ElementTopology<ET_PRISM>::faces; 
 
     ArrayMem<AutoDiff<3>,20> adpolxy1(order+4),adpolxy2(order+4); 
     ArrayMem<AutoDiff<3>,20> adpolz(order+4);   
@@ -1540,7 +1540,7 @@ namespace ngfem
     can(4,1) = 1.;
     can(5,0) = -1.;
 
-    const FACE * faces = ElementTopology::GetFaces (ET_HEX);
+    const FACE * faces = T_ElementTopology<ET_HEX>::faces;
 
 
     shape = 0.0;
@@ -1709,7 +1709,7 @@ namespace ngfem
     int ind[6] = {2, 2, 1, 0, 1, 0};
     int can[6] = {-1, 1, -1, 1, 1, -1};
 
-    const FACE * faces = ElementTopology::GetFaces (ET_HEX);
+    const FACE * faces = T_ElementTopology<ET_HEX>::faces;
 
     divshape = 0.0;
 
@@ -280,7 +280,7 @@ template <typename MIP, typename TFA>
     
     if (!only_ho_div){
       // edges
-      // const EDGE * edges = ElementTopology::GetEdges (ET_QUAD);
+      // const EDGE * edges = T_ElementTopology<ET_QUAD>::edges;
       for (int i = 0; i < 4; i++)
         {
           int p = order_facet[i][0]; 
@@ -383,7 +383,7 @@ template <typename MIP, typename TFA>
     size_t ii = 4; 
     if (!only_ho_div)
     {
-      const FACE * faces = ElementTopology::GetFaces (ET_TET);
+      const FACE * faces = T_ElementTopology<ET_TET>::faces;
       for (size_t i = 0; i < 4; i++)
         {
           int p = order_facet[i][0];
@@ -630,7 +630,7 @@ template <typename MIP, typename TFA>
     Tx lami[6] = { x, y, 1-x-y, x, y, 1-x-y };
     Tx muz[6]  = { 1-z, 1-z, 1-z, z, z, z };
        
-    const FACE * faces = ElementTopology::GetFaces (ET_PRISM); 
+    const FACE * faces = T_ElementTopology<ET_PRISM>::faces; 
 
     ArrayMem<Tx,20> adpolxy1(order+4),adpolxy2(order+4); 
     ArrayMem<Tx,20> adpolz(order+4);   
@@ -837,7 +837,7 @@ template <typename MIP, typename TFA>
     int ii = 6;
 
     //Faces
-    const FACE * faces = ElementTopology::GetFaces (ET_HEX);
+    const FACE * faces = T_ElementTopology<ET_HEX>::faces;
     for (int i = 0; i < 6; i++)
       {
 	INT<2> p = order_facet[i];
@@ -156,7 +156,7 @@ namespace ngfem
       int ii = 3; 
 
       if (!only_ho_div){
-        // const EDGE * edges = ElementTopology::GetEdges (ET_TRIG);
+        // const EDGE * edges = T_ElementTopology<ET_TRIG>::edges;
         for (int i = 0; i < 3; i++)
         {
           INT<2> e = this->GetEdgeSort (i, vnums);
@@ -209,6 +209,26 @@ namespace ngfem
     CalcElementMatrix(fel, eltrans, helmat, lh);
     elmat += helmat;
   }
+
+  void BilinearFormIntegrator ::
+  CalcElementMatrixAddBatch (FlatArray<const FiniteElement*> fels,
+                             FlatArray<const ElementTransformation*> trafos,
+                             FlatArray<FlatMatrix<double>> elmats,
+                             LocalHeap & lh) const
+  {
+    for (size_t i : Range(fels))
+      CalcElementMatrixAdd (*fels[i], *trafos[i], elmats[i], lh);
+  }
+
+  void BilinearFormIntegrator ::
+  CalcElementMatrixAddBatch (FlatArray<const FiniteElement*> fels,
+                             FlatArray<const ElementTransformation*> trafos,
+                             FlatArray<FlatMatrix<Complex>> elmats,
+                             LocalHeap & lh) const
+  {
+    for (size_t i : Range(fels))
+      CalcElementMatrixAdd (*fels[i], *trafos[i], elmats[i], lh);
+  }
   
 
 
@@ -2179,6 +2199,8 @@ namespace ngfem
       if (name == bfis[i]->name && spacedim == bfis[i]->spacedim)
 	return bfis[i];
 
+    if (LazyLibraries::Load (name))
+      return GetBFI (name, spacedim);
     throw Exception (string ("GetBFI: Unknown integrator ") + name + "\n");
   }
 
@@ -2188,6 +2210,7 @@ namespace ngfem
   {
     if (dim == -1)
       {
+        LazyLibraries::Load (name);
         shared_ptr<BilinearFormIntegrator> abfi[4];
         for (int i = 0; i < bfis.Size(); i++)
           if (name == bfis[i]->name)
@@ -2236,6 +2259,8 @@ namespace ngfem
       if (name == lfis[i]->name && spacedim == lfis[i]->spacedim)
 	return lfis[i];
 
+    if (LazyLibraries::Load (name))
+      return GetLFI (name, spacedim);
     throw Exception (string ("GetLFI: Unknown integrator ") + name + "\n");
   }
 
@@ -2249,6 +2274,7 @@ namespace ngfem
 
     if (dim == -1)
       {
+        LazyLibraries::Load (name);
         shared_ptr<LinearFormIntegrator> alfi[4];
         for (int i = 0; i < lfis.Size(); i++)
           if (name == lfis[i]->name)
@@ -133,6 +133,14 @@ namespace ngfem
     {
       return userdefined_simd_intrules[et] ? *userdefined_simd_intrules[et] : SIMD_SelectIntegrationRule(et,order);
     }
+    /// the facet rule mapped to the element, the cached one if not user-defined
+    inline const SIMD_IntegrationRule& GetSIMDFacetVolumeRule(Facet2ElementTrafo & transform, int fnr,
+                                                               int order, LocalHeap & lh) const
+    {
+      ELEMENT_TYPE etfacet = transform.FacetType (fnr);
+      return userdefined_simd_intrules[etfacet] ? transform(fnr, *userdefined_simd_intrules[etfacet], lh)
+        : transform.CachedFacetRule(fnr, order, lh);
+    }
 
     /// defined only on some elements/facets/boundary elements
     shared_ptr<BitArray> GetDefinedOnElements () const { return definedon_element; } 
@@ -188,6 +196,8 @@ namespace ngfem
 
     void SetBonusIntegrationOrder (int bo) { bonus_intorder = bo; }
     int GetBonusIntegrationOrder() const   { return bonus_intorder; }
+    /// total dimension of the proxies, for the estimate of the LocalHeap, -1 if unknown
+    virtual int ProxyDimension () const { return -1; }
     
     /// benefit from constant coefficient
     void SetConstantCoefficient (bool acc = 1)
@@ -329,6 +339,23 @@ namespace ngfem
                             FlatMatrix<Complex> elmat,
                             LocalHeap & lh) const;
     
+    /**
+       Computes and adds element matrices of a batch of elements.
+       The default loops over the elements,
+       symbolic integrators process elements of the same type in lockstep.
+    */
+    virtual void
+      CalcElementMatrixAddBatch (FlatArray<const FiniteElement*> fels,
+                                 FlatArray<const ElementTransformation*> trafos,
+                                 FlatArray<FlatMatrix<double>> elmats,
+                                 LocalHeap & lh) const;
+
+    virtual void
+      CalcElementMatrixAddBatch (FlatArray<const FiniteElement*> fels,
+                                 FlatArray<const ElementTransformation*> trafos,
+                                 FlatArray<FlatMatrix<Complex>> elmats,
+                                 LocalHeap & lh) const;
+    
 
     
     virtual void
@@ -96,10 +96,92 @@ namespace ngfem
     Compile (bool realcompile, bool wait) const
     {
       auto compiled = make_shared<SumOfIntegrals>();
+      // the integrands are compiled concurrently in the background
       for (auto & icf : icfs)
-        compiled->icfs += make_shared<Integral> (::ngfem::Compile (icf->cf, realcompile, 2, wait), icf->dx);
+        compiled->icfs += make_shared<Integral> (::ngfem::Compile (icf->cf, realcompile, 2, false), icf->dx);
+      if (realcompile && wait)
+        WaitForCompilation();
       return compiled;
     }
+
+    /*
+      Integrals with the same domain, element-boundary and skeleton
+      flags, integration order and deformation are merged into one
+      integral of the sum of their integrands, so that geometry and
+      shape functions are evaluated once per element. On simplices the
+      integration order depends on the derivative orders of the proxies,
+      so these have to agree as well. DG terms are not merged with
+      terms without neighbour values.
+    */
+    shared_ptr<SumOfIntegrals> Fuse () const
+    {
+      auto same_dx = [] (const DifferentialSymbol & a, const DifferentialSymbol & b)
+        {
+          if (a.vb != b.vb || a.element_vb != b.element_vb || a.skeleton != b.skeleton ||
+              a.bonus_intorder != b.bonus_intorder || a.deformation != b.deformation)
+            return false;
+          if (a.userdefined_intrules.size() || b.userdefined_intrules.size())
+            return false;
+          if (a.definedon.has_value() != b.definedon.has_value())
+            return false;
+          if (!a.definedon) return true;
+          if (a.definedon->index() != b.definedon->index())
+            return false;
+          if (auto name = get_if<string> (&*a.definedon))
+            return *name == get<string> (*b.definedon);
+          auto & ba = get<BitArray> (*a.definedon);
+          auto & bb = get<BitArray> (*b.definedon);
+          if (ba.Size() != bb.Size()) return false;
+          for (size_t i = 0; i < ba.Size(); i++)
+            if (ba.Test(i) != bb.Test(i)) return false;
+          return true;
+        };
+
+      // derivative orders of trial and test proxies as the SymbolicBFI computes them, DG term
+      auto signature = [] (const Integral & igl)
+        {
+          int trial_difforder = 99, test_difforder = 99;
+          bool has_trial = false, has_other = false;
+          igl.cf->TraverseTree ([&] (CoefficientFunction & nodecf)
+            {
+              if (auto proxy = dynamic_cast<ProxyFunction*> (&nodecf))
+                {
+                  int order = proxy->Evaluator()->DiffOrder();
+                  if (proxy->IsTrialFunction())
+                    {
+                      trial_difforder = min2 (trial_difforder, order);
+                      has_trial = true;
+                    }
+                  else
+                    test_difforder = min2 (test_difforder, order);
+                  has_other |= proxy->IsOther();
+                }
+            });
+          if (!has_trial) trial_difforder = 0;
+          return std::make_tuple (trial_difforder, test_difforder, has_other);
+        };
+
+      auto fused = make_shared<SumOfIntegrals>();
+      Array<std::tuple<int,int,bool>> signatures;
+      for (auto & icf : icfs)
+        {
+          auto sig = signature (*icf);
+          bool merged = false;
+          for (size_t i = 0; i < fused->icfs.Size(); i++)
+            if (signatures[i] == sig && same_dx (fused->icfs[i]->dx, icf->dx))
+              {
+                fused->icfs[i] = make_shared<Integral> (fused->icfs[i]->cf + icf->cf, fused->icfs[i]->dx);
+                merged = true;
+                break;
+              }
+          if (!merged)
+            {
+              fused->icfs += icf;
+              signatures += sig;
+            }
+        }
+      return fused;
+    }
   };
 
   inline auto operator+ (const SumOfIntegrals & c1, const SumOfIntegrals & c2)
@@ -1936,7 +1936,7 @@ namespace ngfem
               int isort[3];
               for (int i = 0; i < 3; i++) isort[sort[i]] = i;
 
-              const EDGE & edge = ElementTopology::GetEdges (ET_TRIG)[nodenr];
+              const EDGE & edge = T_ElementTopology<ET_TRIG>::edges[nodenr];
               EDGE sedge;
               sedge[0] = isort[edge[0]];
               sedge[1] = isort[edge[1]];
@@ -2080,7 +2080,7 @@ namespace ngfem
 
           if (nt == NT_FACE)
 	    {
-	      const FACE & face = ElementTopology::GetFaces (ET_TET)[nodenr];
+	      const FACE & face = T_ElementTopology<ET_TET>::faces[nodenr];
 	      FACE sface;
 	      sface[0] = isort[face[0]];
 	      sface[1] = isort[face[1]];
@@ -2121,7 +2121,7 @@ namespace ngfem
 
 	  else if (nt == NT_EDGE)
 	    {
-	      const EDGE & edge = ElementTopology::GetEdges (ET_TET)[nodenr];
+	      const EDGE & edge = T_ElementTopology<ET_TET>::edges[nodenr];
 	      EDGE sedge;
 	      sedge[0] = isort[edge[0]];
 	      sedge[1] = isort[edge[1]];
@@ -2301,6 +2301,10 @@ namespace ngfem
     Array<IntegrationRule*> jacobirules10;
     Array<IntegrationRule*> jacobirules20;
 
+    /// fully symmetric rules of higher order, used instead of collapsed tensor rules if enabled
+    Array<IntegrationRule*> symtrigrules, symtetrules;
+    Array<SIMD_IntegrationRule*> simd_symtrigrules, simd_symtetrules;
+
   public:
     static IntegrationRule intrule0, intrule1;
     static SIMD_IntegrationRule *simd_intrule0, *simd_intrule1;
@@ -2328,6 +2332,165 @@ namespace ngfem
   SIMD_IntegrationRule * IntegrationRules :: simd_intrule1;
 
 
+  /*
+    Fully symmetric rules for triangles and tetrahedra, with positive weights
+    and interior points. They need far fewer points than the collapsed
+    Gauss-Jacobi rules, but have no tensor product structure.
+    
+    Orbits in barycentric coordinates, weights are per point:
+      trig:  0: (1/3,1/3,1/3)        1: (a,a,1-2a)     2: (a,b,1-a-b)
+      tet:   0: (1/4,1/4,1/4,1/4)    1: (a,a,a,1-3a)   2: (a,a,1/2-a,1/2-a)
+             3: (a,a,b,1-2a-b)       4: (a,b,c,1-a-b-c)
+  */
+  struct SymmetricOrbit { int order, type; double a, b, c, w; };
+
+  static SymmetricOrbit symmetric_trig_orbits[] =
+  {
+    // order 7, 15 points
+    { 7, 1, 0.064930513159164871, 0, 0, 0.026538900895116201 },
+    { 7, 2, 0.51703993906932288, 0.19838447668150677, 0, 0.035426541846066764 },
+    { 7, 2, 0.043863471792372502, 0.31355918438493158, 0, 0.034637341039708447 },
+    // order 8, 16 points
+    { 8, 0, 0, 0, 0, 0.072157803838893586 },
+    { 8, 1, 0.45929258829272313, 0, 0, 0.047545817133642365 },
+    { 8, 1, 0.050547228317031005, 0, 0, 0.01622924881159906 },
+    { 8, 1, 0.17056930775176021, 0, 0, 0.051608685267359136 },
+    { 8, 2, 0.26311282963463817, 0.72849239295540424, 0, 0.013615157087217498 },
+    // order 9, 19 points
+    { 9, 0, 0, 0, 0, 0.048567898141399286 },
+    { 9, 1, 0.48968251919873756, 0, 0, 0.015667350113569598 },
+    { 9, 1, 0.43708959149293647, 0, 0, 0.038913770502387091 },
+    { 9, 1, 0.18820353561903272, 0, 0, 0.039823869463605104 },
+    { 9, 1, 0.044729513394452705, 0, 0, 0.012788837829348997 },
+    { 9, 2, 0.74119859878449801, 0.036838412054736286, 0, 0.021641769688644671 },
+    // order 10, 25 points
+    { 10, 0, 0, 0, 0, 0.040871664573143014 },
+    { 10, 1, 0.14216110105656432, 0, 0, 0.022978981802372372 },
+    { 10, 1, 0.032055373216943489, 0, 0, 0.0066764844065747867 },
+    { 10, 2, 0.32181299528883539, 0.53005411892734411, 0, 0.031952453198212057 },
+    { 10, 2, 0.80793060092287905, 0.16370173373718255, 0, 0.012648878853644192 },
+    { 10, 2, 0.36914678182781102, 0.60123332868345924, 0, 0.017092324081479725 },
+    // order 11, 28 points
+    { 11, 0, 0, 0, 0, 0.041849305867284914 },
+    { 11, 1, 0.029866863104116334, 0, 0, 0.0057344371960062861 },
+    { 11, 1, 0.21247763444893175, 0, 0, 0.034577547281650536 },
+    { 11, 1, 0.49718141701185664, 0, 0, 0.0072954684748666723 },
+    { 11, 1, 0.10844050983406613, 0, 0, 0.019665592911849841 },
+    { 11, 1, 0.43776557554680917, 0, 0, 0.032668235549675094 },
+    { 11, 2, 0.83369412555751699, 0.011444550928165514, 0, 0.0062823313439260885 },
+    { 11, 2, 0.046891338199760602, 0.65292704312168759, 0, 0.020105476971168944 },
+    // order 12, 33 points
+    { 12, 1, 0.48820375094554153, 0, 0, 0.012133419040726012 },
+    { 12, 1, 0.44011164865859309, 0, 0, 0.024959167464030461 },
+    { 12, 1, 0.024646363436335649, 0, 0, 0.003965821254986816 },
+    { 12, 1, 0.27146250701492608, 0, 0, 0.031270606597951382 },
+    { 12, 1, 0.10925782765935434, 0, 0, 0.014243026034438789 },
+    { 12, 2, 0.12727971723358933, 0.02138249025617062, 0, 0.0075418387882557189 },
+    { 12, 2, 0.68531016390639188, 0.29165567973834094, 0, 0.010891792519303778 },
+    { 12, 2, 0.62824975168355601, 0.25545422863851741, 0, 0.021613681829707104 },
+    // order 13, 37 points
+    { 13, 0, 0, 0, 0, 0.026193806944992092 },
+    { 13, 1, 0.41443738601138586, 0, 0, 0.02351317930092026 },
+    { 13, 1, 0.22949662071494223, 0, 0, 0.023633132910687374 },
+    { 13, 1, 0.024817913006911517, 0, 0, 0.0039899292986241017 },
+    { 13, 1, 0.46867698718980205, 0, 0, 0.015758005301504282 },
+    { 13, 1, 0.49506855764765301, 0, 0, 0.005631645842847764 },
+    { 13, 1, 0.11436167596506649, 0, 0, 0.015574638189718895 },
+    { 13, 2, 0.022213423183298026, 0.85139665655549635, 0, 0.0077561098948609785 },
+    { 13, 2, 0.63629151976690757, 0.26865365269559682, 0, 0.018434493763736782 },
+    { 13, 2, 0.69007790751160825, 0.29175645641409487, 0, 0.0087268297617521789 },
+    // order 14, 42 points
+    { 14, 1, 0.019390961248701096, 0, 0, 0.0024617018012000396 },
+    { 14, 1, 0.17720553241254347, 0, 0, 0.021081294368496484 },
+    { 14, 1, 0.061799883090872573, 0, 0, 0.0072168498348883373 },
+    { 14, 1, 0.48896391036217862, 0, 0, 0.01094179068471444 },
+    { 14, 1, 0.41764471934045394, 0, 0, 0.016394176772062674 },
+    { 14, 1, 0.27347752830883865, 0, 0, 0.025887052253645772 },
+    { 14, 2, 0.014646950055654456, 0.68698016780808779, 0, 0.0072181540567669176 },
+    { 14, 2, 0.77060855477499646, 0.1722666878213556, 0, 0.012332876606281832 },
+    { 14, 2, 0.33686145979634496, 0.092916249356971806, 0, 0.019285755393530335 },
+    { 14, 2, 0.0012683309328720314, 0.11897449769695684, 0, 0.0025051144192503325 },
+  };
+
+  static SymmetricOrbit symmetric_tet_orbits[] =
+  {
+    // order 6, 24 points
+    { 6, 1, 0.040673958534611324, 0, 0, 0.001679535175886773 },
+    { 6, 1, 0.21460287125915192, 0, 0, 0.0066537917096945827 },
+    { 6, 1, 0.32233789014227554, 0, 0, 0.0092261969239424303 },
+    { 6, 3, 0.063661001875017456, 0.60300566479164919, 0, 0.0080357142857142745 },
+    // order 7, 35 points
+    { 7, 0, 0, 0, 0, 0.015914214910688441 },
+    { 7, 1, 0.31570114977820279, 0, 0, 0.0070549302016611653 },
+    { 7, 2, 0.44951017740160359, 0, 0, 0.005316154638809592 },
+    { 7, 3, 0.021265472541483248, 0.81083024109854851, 0, 0.0013517951383172212 },
+    { 7, 3, 0.18883383102600099, 0.047160700360997884, 0, 0.0062011884547224262 },
+    // order 8, 46 points
+    { 8, 1, 0.11670737755651313, 0, 0, 0.0051946331298577796 },
+    { 8, 1, 0.1876457890282669, 0, 0, 0.0076687827874622775 },
+    { 8, 1, 0.045249663116627675, 0, 0, 0.0014981509319985668 },
+    { 8, 1, 0.31366346891312791, 0, 0, 0.0073612749483723894 },
+    { 8, 2, 0.065866829951618647, 0, 0, 0.0061842069032595646 },
+    { 8, 3, 0.021203926282837599, 0.71367229307879143, 0, 0.0011940600586740993 },
+    { 8, 3, 0.20383535366478694, 0.5882821049342416, 0, 0.0023617781126879984 },
+  };
+
+  static bool symmetric_simplex_rules = (getenv ("NGS_TENSOR_SIMPLEX_RULES") == nullptr);
+  
+  void SetSymmetricSimplexRules (bool enable) { symmetric_simplex_rules = enable; }
+  bool GetSymmetricSimplexRules () { return symmetric_simplex_rules; }
+
+  static IntegrationRule * MakeSymmetricRule (ELEMENT_TYPE eltype, int order)
+  {
+    int dim = (eltype == ET_TRIG) ? 2 : 3;
+    FlatArray<SymmetricOrbit> orbits = (eltype == ET_TRIG) ?
+      FlatArray<SymmetricOrbit> (std::size(symmetric_trig_orbits), symmetric_trig_orbits) :
+      FlatArray<SymmetricOrbit> (std::size(symmetric_tet_orbits), symmetric_tet_orbits);
+
+    auto ir = new IntegrationRule;
+    ir -> SetDim (dim);
+    for (auto & orb : orbits)
+      {
+        if (orb.order != order) continue;
+        double a = orb.a, b = orb.b, c = orb.c;
+        double lam[4];
+        if (dim == 2)
+          switch (orb.type)
+            {
+            case 0: lam[0] = lam[1] = lam[2] = 1.0/3; break;
+            case 1: lam[0] = lam[1] = a; lam[2] = 1-2*a; break;
+            default: lam[0] = a; lam[1] = b; lam[2] = 1-a-b;
+            }
+        else
+          switch (orb.type)
+            {
+            case 0: lam[0] = lam[1] = lam[2] = lam[3] = 0.25; break;
+            case 1: lam[0] = lam[1] = lam[2] = a; lam[3] = 1-3*a; break;
+            case 2: lam[0] = lam[1] = a; lam[2] = lam[3] = 0.5-a; break;
+            case 3: lam[0] = lam[1] = a; lam[2] = b; lam[3] = 1-2*a-b; break;
+            default: lam[0] = a; lam[1] = b; lam[2] = c; lam[3] = 1-a-b-c;
+            }
+
+        // all distinct permutations
+        sort (lam, lam+dim+1);
+        do
+          {
+            IntegrationPoint ip (lam[0], lam[1], (dim == 3) ? lam[2] : 0.0, orb.w);
+            ip.SetNr (ir->Size());
+            ir -> Append (ip);
+          }
+        while (next_permutation (lam, lam+dim+1));
+      }
+
+    if (ir->Size() == 0)
+      {
+        delete ir;
+        return nullptr;
+      }
+    return ir;
+  }
+
+
 
 
   IntegrationRules :: IntegrationRules ()
@@ -2539,6 +2702,21 @@ namespace ngfem
       SIMD_SelectIntegrationRule (ET_TET, p);
     
 
+    // ************************************
+    // ** Symmetric simplex rules
+    // ************************************
+
+    for (int p = 0; p <= 20; p++)
+      {
+        auto trig = MakeSymmetricRule (ET_TRIG, p);
+        symtrigrules.Append (trig);
+        simd_symtrigrules.Append (trig ? new SIMD_IntegrationRule (*trig) : nullptr);
+        auto tet = MakeSymmetricRule (ET_TET, p);
+        symtetrules.Append (tet);
+        simd_symtetrules.Append (tet ? new SIMD_IntegrationRule (*tet) : nullptr);
+      }
+    
+
     // ************************************
     // ** Prismatic integration rules
     // ************************************
@@ -2675,6 +2853,11 @@ namespace ngfem
 
     for (int i = 0; i < jacobirules20.Size(); i++)
       delete jacobirules20[i];
+
+    for (auto ir : symtrigrules) delete ir;
+    for (auto ir : symtetrules) delete ir;
+    for (auto ir : simd_symtrigrules) delete ir;
+    for (auto ir : simd_symtetrules) delete ir;
    
   }
 
@@ -2685,6 +2868,14 @@ namespace ngfem
   {
     const Array<IntegrationRule*> * ira;
 
+    if (symmetric_simplex_rules && order >= 0)
+      {
+        if (eltyp == ET_TRIG && order < symtrigrules.Size() && symtrigrules[order])
+          return *symtrigrules[order];
+        if (eltyp == ET_TET && order < symtetrules.Size() && symtetrules[order])
+          return *symtetrules[order];
+      }
+
     switch (eltyp)
       {
       case ET_POINT:
@@ -3152,6 +3343,14 @@ namespace ngfem
   {
     Array<SIMD_IntegrationRule*> * ira;
 
+    if (symmetric_simplex_rules && order >= 0)
+      {
+        if (eltype == ET_TRIG && order < simd_symtrigrules.Size() && simd_symtrigrules[order])
+          return *simd_symtrigrules[order];
+        if (eltype == ET_TET && order < simd_symtetrules.Size() && simd_symtetrules[order])
+          return *simd_symtetrules[order];
+      }
+
     switch (eltype)
       {
       case ET_POINT:
@@ -3243,6 +3442,23 @@ namespace ngfem
                     }
                   break;
                 }
+              case ET_PRISM:
+                {
+                  // trig points inner, segment points outer loop, see sum factorization in tscalarfe_impl.hpp
+                  const IntegrationRule & irtrig = SelectIntegrationRule (ET_TRIG, order);
+                  const IntegrationRule & irsegm = SelectIntegrationRule (ET_SEGM, order);
+                  size_t nt = irtrig.GetNIP();
+                  bool istp = ir.GetNIP() == nt*irsegm.GetNIP();
+                  for (size_t i = 0; istp && i < ir.GetNIP(); i++)
+                    istp = ir[i](0) == irtrig[i%nt](0) && ir[i](1) == irtrig[i%nt](1) &&
+                      ir[i](2) == irsegm[i/nt](0);
+                  if (istp)
+                    {
+                      tmp->SetIRX (new SIMD_IntegrationRule(irtrig));
+                      tmp->SetIRZ (&SIMD_SelectIntegrationRule (ET_SEGM, order));
+                    }
+                  break;
+                }
               case ET_HEX:
                 {
                   tmp->SetIRX (&SIMD_SelectIntegrationRule (ET_SEGM, order));
@@ -3296,6 +3512,23 @@ namespace ngfem
     nip = _nip;
   }
 
+  SIMD_IntegrationRule SIMD_IntegrationRule :: Copy () const
+  {
+    SIMD_IntegrationRule ir2;
+    ir2.size = Size();
+    ir2.mem_to_delete = (SIMD<IntegrationPoint>*)
+      _mm_malloc(max2(Size(), size_t(1))*sizeof(SIMD<IntegrationPoint>), SIMD<double>::Size()*sizeof(double));
+    ir2.data = ir2.mem_to_delete;
+    for (size_t i = 0; i < Size(); i++)
+      ir2[i] = (*this)[i];
+    ir2.dimension = dimension;
+    ir2.nip = nip;
+    ir2.irx = irx;
+    ir2.iry = iry;
+    ir2.irz = irz;
+    return ir2;
+  }
+
   /*
   SIMD_IntegrationRule::~SIMD_IntegrationRule()
   {
@@ -3465,6 +3698,51 @@ namespace ngfem
   template class SIMD_MappedIntegrationRule<0,2>;
   template class SIMD_MappedIntegrationRule<0,3>;
 
+  template <int DIMS, int DIMR>
+  static SIMD_BaseMappedIntegrationRule &
+  T_ConcatenateMappedRules (FlatArray<const SIMD_BaseMappedIntegrationRule*> mirs, LocalHeap & lh)
+  {
+    size_t nsimd = 0;
+    for (auto mir : mirs)
+      nsimd += mir->Size();
+
+    SIMD_IntegrationRule & ir = *new (lh) SIMD_IntegrationRule (nsimd*SIMD<IntegrationPoint>::Size(), lh);
+    auto & mir = *new (lh) SIMD_MappedIntegrationRule<DIMS,DIMR> (ir, mirs[0]->GetTransformation(), -1, lh);
+
+    // mapped points are copied, they keep the transformation of their element
+    size_t ii = 0;
+    for (auto hmir : mirs)
+      {
+        auto & tmir = static_cast<const SIMD_MappedIntegrationRule<DIMS,DIMR>&> (*hmir);
+        for (size_t i = 0; i < tmir.Size(); i++, ii++)
+          {
+            ir[ii] = tmir.IR()[i];
+            mir[ii] = tmir[i];
+          }
+      }
+    return mir;
+  }
+  
+  SIMD_BaseMappedIntegrationRule &
+  ConcatenateMappedRules (FlatArray<const SIMD_BaseMappedIntegrationRule*> mirs, LocalHeap & lh)
+  {
+    switch (10*mirs[0]->DimElement() + mirs[0]->DimSpace())
+      {
+      case  0: return T_ConcatenateMappedRules<0,0> (mirs, lh);
+      case  1: return T_ConcatenateMappedRules<0,1> (mirs, lh);
+      case  2: return T_ConcatenateMappedRules<0,2> (mirs, lh);
+      case  3: return T_ConcatenateMappedRules<0,3> (mirs, lh);
+      case 11: return T_ConcatenateMappedRules<1,1> (mirs, lh);
+      case 12: return T_ConcatenateMappedRules<1,2> (mirs, lh);
+      case 13: return T_ConcatenateMappedRules<1,3> (mirs, lh);
+      case 22: return T_ConcatenateMappedRules<2,2> (mirs, lh);
+      case 23: return T_ConcatenateMappedRules<2,3> (mirs, lh);
+      case 33: return T_ConcatenateMappedRules<3,3> (mirs, lh);
+      default:
+        throw Exception ("ConcatenateMappedRules: illegal dimensions");
+      }
+  }
+
 
 
 
@@ -3507,6 +3785,53 @@ namespace ngfem
 
 
 
+  // facet rules mapped to the reference elements, [element type][vb-1][facet][order]
+  static constexpr int FACETRULE_MAXORDER = 32;
+  static atomic<SIMD_IntegrationRule*> simd_facetrules[7][3][12][FACETRULE_MAXORDER];
+
+  static int FacetRuleTypeIndex (ELEMENT_TYPE eltype)
+  {
+    switch (eltype)
+      {
+      case ET_SEGM: return 0;
+      case ET_TRIG: return 1;
+      case ET_QUAD: return 2;
+      case ET_TET: return 3;
+      case ET_PYRAMID: return 4;
+      case ET_PRISM: return 5;
+      case ET_HEX: return 6;
+      default: return -1;
+      }
+  }
+
+  const SIMD_IntegrationRule & Facet2ElementTrafo :: CachedFacetRule (int fnr, int order, LocalHeap & lh)
+  {
+    if (vb == VOL) return SIMD_SelectIntegrationRule (eltype, order);
+    if (order < 0) order = 0;
+
+    int et = FacetRuleTypeIndex (eltype);
+    if (oriented || et == -1 || order >= FACETRULE_MAXORDER || fnr >= 12)
+      return (*this)(fnr, SIMD_SelectIntegrationRule (FacetType(fnr), order), lh);
+
+    auto & cached = simd_facetrules[et][int(vb)-1][fnr][order];
+    if (SIMD_IntegrationRule * ir = cached.load(memory_order_acquire))
+      return *ir;
+
+    // the tensor-product components refer to the global 1D rules
+    SIMD_IntegrationRule * ir;
+    {
+      HeapReset hr(lh);
+      ir = new SIMD_IntegrationRule ((*this)(fnr, SIMD_SelectIntegrationRule (FacetType(fnr), order), lh).Copy());
+    }
+    SIMD_IntegrationRule * expected = nullptr;
+    if (!cached.compare_exchange_strong (expected, ir, memory_order_acq_rel))
+      {
+        delete ir;     // generated by another thread
+        return *expected;
+      }
+    return *ir;
+  }
+
   const SIMD_IntegrationRule & Facet2ElementTrafo :: operator() (int fnr, const SIMD_IntegrationRule & irfacet, LocalHeap & lh)
   {
     if (vb == VOL) return irfacet;
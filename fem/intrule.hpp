@@ -853,6 +853,9 @@ namespace ngfem
   extern NGS_DLL_HEADER const IntegrationRule & SelectIntegrationRule (ELEMENT_TYPE eltype, int order);
   extern NGS_DLL_HEADER const IntegrationRule & SelectIntegrationRuleJacobi10 (int order);
   extern NGS_DLL_HEADER const IntegrationRule & SelectIntegrationRuleJacobi20 (int order);
+  /// fully symmetric rules for higher order trigs and tets (default), or collapsed Gauss-Jacobi rules
+  extern NGS_DLL_HEADER void SetSymmetricSimplexRules (bool enable);
+  extern NGS_DLL_HEADER bool GetSymmetricSimplexRules ();
 
   INLINE IntegrationRule :: IntegrationRule (ELEMENT_TYPE eltype, int order)
   { 
@@ -880,6 +883,7 @@ namespace ngfem
     FACE hfaces[6];
     bool swapped = false; // new orientation with 2 tet-classes
     VorB vb = BND;        // facet codimension
+    bool oriented = false; // facets oriented by global vertex numbers
   public:
     Facet2ElementTrafo(ELEMENT_TYPE aeltype, VorB _vb = BND) 
       : eltype(aeltype),
@@ -896,7 +900,8 @@ namespace ngfem
     template <typename T>
     Facet2ElementTrafo(ELEMENT_TYPE aeltype, const BaseArrayObject<T> & vnums) 
       : eltype(aeltype),
-	points(99,(double*)ElementTopology::GetVertices (aeltype))
+	points(99,(double*)ElementTopology::GetVertices (aeltype)),
+        oriented(true)
     {
       // points = ElementTopology::GetVertices (eltype);
       edges = ElementTopology::GetEdges (eltype);
@@ -1171,6 +1176,14 @@ namespace ngfem
 
     const class SIMD_IntegrationRule & operator() (int fnr, const class SIMD_IntegrationRule & irfacet, LocalHeap & lh);
 
+    /**
+       The SIMD rule of the given order on facet fnr, mapped to the element.
+       The mapped rules of the trafo without vertex orientation are cached
+       per element type, facet codimension, facet and order, then no
+       mapping and no allocation is done per element. Oriented trafos and
+       high orders map into lh.
+    */
+    NGS_DLL_HEADER const class SIMD_IntegrationRule & CachedFacetRule (int fnr, int order, LocalHeap & lh);
   };
 
 
@@ -1774,6 +1787,16 @@ namespace ngstd
     
     const Mat<DIMR,DIMS,SIMD<double>> & GetJacobian() const { return dxdxi; }
     Mat<DIMR,DIMS,SIMD<double>> & Jacobian() { return dxdxi; }
+
+    /// Jacobian and derived quantities from another point of an affine element
+    INLINE void CopyJacobian (const SIMD & other)
+    {
+      dxdxi = other.dxdxi;
+      det = other.det;
+      measure = other.measure;
+      normalvec = other.normalvec;
+      tangentialvec = other.tangentialvec;
+    }
     
     int Dim() const { return DIMR; }
 
@@ -2296,6 +2319,9 @@ namespace ngfem
     size_t GetNIP() const { return nip; } // Size()*SIMD<double>::Size(); }
     void SetNIP(size_t _nip) { nip = _nip; }
 
+    /// a deep copy, owning the integration points
+    SIMD_IntegrationRule Copy() const;
+
     SIMD_IntegrationRule Clone() const
     {
       SIMD_IntegrationRule ir2(Size(), &(*this)[0]);
@@ -2442,6 +2468,14 @@ namespace ngfem
     virtual void TransformGradient (BareSliceMatrix<SIMD<double>> grad) const override;
     virtual void TransformGradientTrans (BareSliceMatrix<SIMD<double>> grad) const override;
   };
+
+  /*
+    One rule with the points of all rules, which have the same dimensions.
+    For evaluating functions of the points only, GetTransformation() is the 
+    one of the first rule.
+  */
+  NGS_DLL_HEADER SIMD_BaseMappedIntegrationRule &
+  ConcatenateMappedRules (FlatArray<const SIMD_BaseMappedIntegrationRule*> mirs, LocalHeap & lh);
 }
 
 
@@ -105,6 +105,16 @@ namespace ngfem
         order = max2(order, order_inner[i]);
     }
 
+    /// uniform order simplices: shapes are determined by the vertex ordering
+    int ShapeClassNr () const
+    {
+      if (ET != ET_SEGM && ET != ET_TRIG && ET != ET_TET)
+        return -1;
+      for (int i = 0; i < DIM; i++)
+        if (order_inner[i] != order) return -1;
+      return ET_trait<ET>::GetClassNr (vnums);
+    }
+
     NGS_DLL_HEADER virtual void PrecomputeTrace ();
     NGS_DLL_HEADER virtual void PrecomputeGrad ();
     NGS_DLL_HEADER virtual void PrecomputeShapes (const IntegrationRule & ir);
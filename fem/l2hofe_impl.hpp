@@ -33,13 +33,13 @@ namespace ngfem
   PrecomputeTrace ()
   {
 #ifndef __CUDA_ARCH__
-    for (int f = 0; f < ElementTopology::GetNFacets(ET); f++)
+    for (int f = 0; f < T_ElementTopology<ET>::GetNFacets(); f++)
       {
         int classnr =  ET_trait<ET>::GetFacetClassNr (f, vnums);
         if (precomp_trace.Used (INT<2> (order, classnr)))
           continue;
         
-        ELEMENT_TYPE etfacet = ElementTopology::GetFacetType (ET, f);
+        ELEMENT_TYPE etfacet = T_ElementTopology<ET>::GetFacetType (f);
         int nf;
         switch (etfacet)
           {
@@ -538,6 +538,94 @@ namespace ngfem
   }
 
 
+  void L2HighOrderFETP<ET_HEX> ::  
+  EvaluateGrad (const SIMD_BaseMappedIntegrationRule & mir,
+                BareSliceVector<> bcoefs,
+                BareSliceMatrix<SIMD<double>> values) const
+  {
+    static Timer t("hex EvaluateGrad");
+    static Timer tmult("hex EvaluateGrad mult");
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+    auto & ir = mir.IR();
+    if (ir.IsTP())
+      {
+        auto & irx = ir.GetIRX();
+        auto & iry = ir.GetIRY();
+        auto & irz = ir.GetIRZ();
+        size_t nipx = irx.GetNIP();
+        size_t nipy = iry.GetNIP();
+        size_t nipz = irz.GetNIP();
+        size_t ndof = (order+1)*(order+1)*(order+1);
+
+        bool needs_copy = bcoefs.Dist() != 1;
+        STACK_ARRAY(double, mem_coefs, needs_copy ? ndof : 0);
+        if (needs_copy)
+          {
+            FlatVector<> coefs(ndof, mem_coefs);
+            coefs = bcoefs;
+          }
+        FlatMatrix<> mat_coefs(sqr(order+1), order+1, needs_copy ? mem_coefs : &bcoefs(0));
+
+        // 1D shapes and derivatives, the only O(p*nip_1d) part
+        STACK_ARRAY(double, memtshapex, nipx*(order+1));
+        FlatMatrix<> tshapex(nipx, order+1, memtshapex);
+        STACK_ARRAY(double, memtdshapex, nipx*(order+1));
+        FlatMatrix<> tdshapex(nipx, order+1, memtdshapex);
+        STACK_ARRAY(double, memtshapey, nipy*(order+1));
+        FlatMatrix<> tshapey(nipy, order+1, memtshapey);
+        STACK_ARRAY(double, memtdshapey, nipy*(order+1));
+        FlatMatrix<> tdshapey(nipy, order+1, memtdshapey);
+        STACK_ARRAY(double, memtshapez, nipz*(order+1));
+        FlatMatrix<> tshapez(nipz, order+1, memtshapez);
+        STACK_ARRAY(double, memtdshapez, nipz*(order+1));
+        FlatMatrix<> tdshapez(nipz, order+1, memtdshapez);
+
+        auto calc_shapes = [this] (const SIMD_IntegrationRule & ir1d, 
+                                   FlatMatrix<> tshape, FlatMatrix<> tdshape)
+          {
+            for (size_t i = 0; i < ir1d.GetNIP(); i++)
+              {
+                AutoDiff<1> adx(ir1d[i/SIMD<double>::Size()](0)[i%SIMD<double>::Size()], 0);
+                LegendrePolynomial (order, (2*adx-1),
+                                    SBLambda([&] (size_t nr, auto val)
+                                             {
+                                               tshape(i, nr) = val.Value();
+                                               tdshape(i, nr) = val.DValue(0);
+                                             }));
+              }
+          };
+        calc_shapes (irx, tshapex, tdshapex);
+        calc_shapes (iry, tshapey, tdshapey);
+        calc_shapes (irz, tshapez, tdshapez);
+
+        NgProfiler::AddThreadFlops (tmult, TaskManager::GetThreadId(),
+                                    3*(nipx*nipy*nipz*(order+1) + nipy*nipz*sqr(order+1) + nipz*ndof));
+        ThreadRegionTimer regmult(tmult, TaskManager::GetThreadId());
+        
+        STACK_ARRAY(double, mem1, nipz*sqr(order+1));
+        FlatMatrix<> temp1(nipz, sqr(order+1), mem1);
+        STACK_ARRAY(double, mem2, nipy*nipz*(order+1));
+        FlatMatrix<> temp2(nipy, nipz*(order+1), mem2);
+        FlatMatrix<> temp1reshape(nipz*(order+1), order+1, &temp1(0,0));
+        FlatMatrix<> temp2reshape(nipz*nipy, order+1, &temp2(0,0));
+        
+        for (size_t j = 0; j < 3; j++)
+          {
+            temp1 = ((j == 2) ? tdshapez : tshapez) * Trans(mat_coefs);
+            temp2 = ((j == 1) ? tdshapey : tshapey) * Trans(temp1reshape);
+            
+            values(j, ir.Size()-1) = 0.0; // clear overhead
+            FlatMatrix<> temp3(nipx, nipz*nipy, &values(j,0)[0]);
+            temp3 = ((j == 0) ? tdshapex : tshapex) * Trans(temp2reshape);
+          }
+
+        mir.TransformGradient (values);
+        return;
+      }
+    
+    TBASE::EvaluateGrad(mir, bcoefs, values);
+  }
+
   void L2HighOrderFETP<ET_HEX> ::  
   AddGradTrans (const SIMD_BaseMappedIntegrationRule & mir,
                 BareSliceMatrix<SIMD<double>> values,
@@ -1137,6 +1137,11 @@ namespace ngfem
                            BareVector<SIMD<double>> values,
                            BareSliceVector<> coefs) const override;
 
+    using TBASE::EvaluateGrad;
+    virtual void EvaluateGrad (const SIMD_BaseMappedIntegrationRule & mir,
+                               BareSliceVector<> bcoefs,
+                               BareSliceMatrix<SIMD<double>> values) const override;
+
     virtual void AddGradTrans (const SIMD_BaseMappedIntegrationRule & mir,
                                BareSliceMatrix<SIMD<double>> values,
                                BareSliceVector<> bcoefs) const override;
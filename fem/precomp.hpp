@@ -1,3 +1,6 @@
+#ifndef FILE_PRECOMP
+#define FILE_PRECOMP
+
 namespace ngfem
 {
 
@@ -32,6 +35,97 @@ inline bool operator== (const DefaultHash & hash1, const DefaultHash & hash2)
 
 
 
+/*
+  Shape functions and reference gradients at the points of a SIMD_IntegrationRule.
+  Shared by all elements of the same type, vertex-orientation class and order.
+ */
+class PrecomputedSIMDShapes
+{
+public:
+  int classnr, order, ndof;
+  size_t irhash;
+  Matrix<SIMD<double>> shapes;    // ndof x nip
+  Matrix<SIMD<double>> dshapes;   // (ndof*DIM) x nip
+  PrecomputedSIMDShapes * next = nullptr;
+};
+
+/*
+  Thread-safe container for PrecomputedSIMDShapes.
+  Lookup is lock-free, entries are only added and never removed.
+ */
+class SIMD_PrecomputedShapesContainer
+{
+  static constexpr size_t NBUCKETS = 256;
+  atomic<PrecomputedSIMDShapes*> buckets[NBUCKETS];
+  atomic<size_t> memory{0};
+public:
+  /// don't cache more than that (in bytes), per element type
+  static constexpr size_t max_memory = size_t(1) << 28;
+  
+  SIMD_PrecomputedShapesContainer ()
+  {
+    for (auto & b : buckets) b.store (nullptr);
+  }
+
+  ~SIMD_PrecomputedShapesContainer ()
+  {
+    for (auto & b : buckets)
+      for (auto p = b.load(); p; )
+        {
+          auto next = p->next;
+          delete p;
+          p = next;
+        }
+  }
+
+  /// hash of the integration points, and the facet
+  static size_t Hash (const SIMD_IntegrationRule & ir, int dim)
+  {
+    size_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < ir.Size(); i++)
+      for (int j = 0; j < dim; j++)
+        for (int k = 0; k < SIMD<double>::Size(); k++)
+          {
+            double val = ir[i](j)[k];
+            uint64_t bits;
+            memcpy (&bits, &val, sizeof(bits));
+            hash = (hash ^ bits) * 1099511628211ull;
+          }
+    if (ir.Size())
+      hash = (hash ^ size_t(ir[0].FacetNr()+1)) * 1099511628211ull;
+    return hash ^ ir.Size();
+  }
+
+  PrecomputedSIMDShapes * Get (int classnr, int order, int ndof, size_t irhash) const
+  {
+    for (auto p = buckets[Bucket(classnr, order, irhash)].load(memory_order_acquire); p; p = p->next)
+      if (p->classnr == classnr && p->order == order && p->ndof == ndof && p->irhash == irhash)
+        return p;
+    return nullptr;
+  }
+
+  bool HasSpace (size_t bytes) const { return memory + bytes <= max_memory; }
+
+  /// takes ownership, another thread may have added the same shapes
+  PrecomputedSIMDShapes * Add (PrecomputedSIMDShapes * pre)
+  {
+    memory += (pre->shapes.Height()+pre->dshapes.Height()) * pre->shapes.Width() * sizeof(SIMD<double>);
+    auto & bucket = buckets[Bucket(pre->classnr, pre->order, pre->irhash)];
+    pre->next = bucket.load (memory_order_relaxed);
+    while (!bucket.compare_exchange_weak (pre->next, pre, memory_order_release, memory_order_relaxed))
+      ;
+    return pre;
+  }
+
+private:
+  static size_t Bucket (int classnr, int order, size_t irhash)
+  {
+    return (irhash + 97 * classnr + 32 * order) % NBUCKETS;
+  }
+};
+
+
+
 template <typename T, typename T_HASH = DefaultHash>
 class PrecomputedShapesContainer
 {
@@ -58,3 +152,5 @@ public:
 
 
 }
+
+#endif
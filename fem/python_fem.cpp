@@ -132,12 +132,8 @@ struct GenericBSpline {
   GenericBSpline( shared_ptr<BSpline> asp ) : sp(asp) {;}
   template <typename T> T operator() (T x) const { return (*sp)(x); }
   Complex operator() (Complex x) const { return (*sp)(x.real()); }
-  SIMD<double> operator() (SIMD<double> x) const
-  { return SIMD<double>([&](int i)->double { return (*sp)(x[i]); } );}
   SIMD<Complex> operator() (SIMD<Complex> x) const
-  { return SIMD<double>([&](int i)->double { return (*sp)(x.real()[i]); } );}
-  AutoDiff<1,SIMD<double>> operator() (AutoDiff<1,SIMD<double>> x) const { throw ExceptionNOSIMD ("AutoDiff for bspline not supported"); }
-  AutoDiffDiff<1,SIMD<double>> operator() (AutoDiffDiff<1,SIMD<double>> x) const { throw ExceptionNOSIMD ("AutoDiffDiff for bspline not supported"); }
+  { return (*sp)(x.real()); }
   void DoArchive(Archive& ar) { ar & sp; }
 };
 
@@ -249,6 +245,36 @@ struct GenericCeil {
   void DoArchive(Archive& ar) {}
 };
 
+// Bessel functions of real arguments, SIMD evaluation from besselfunctions.hpp
+struct GenericBesselJ0 {
+  double operator() (double x) const { return besselj0(x); }
+  SIMD<double> operator() (SIMD<double> x) const { return besselj0(x); }
+  template <typename T> T operator() (T x) const { throw Exception("besselj0 is available for real arguments only"); }
+  static string Name() { return "besselj0"; }
+  void DoArchive(Archive& ar) {}
+};
+struct GenericBesselJ1 {
+  double operator() (double x) const { return besselj1(x); }
+  SIMD<double> operator() (SIMD<double> x) const { return besselj1(x); }
+  template <typename T> T operator() (T x) const { throw Exception("besselj1 is available for real arguments only"); }
+  static string Name() { return "besselj1"; }
+  void DoArchive(Archive& ar) {}
+};
+struct GenericBesselY0 {
+  double operator() (double x) const { return bessely0(x); }
+  SIMD<double> operator() (SIMD<double> x) const { return bessely0(x); }
+  template <typename T> T operator() (T x) const { throw Exception("bessely0 is available for real arguments only"); }
+  static string Name() { return "bessely0"; }
+  void DoArchive(Archive& ar) {}
+};
+struct GenericBesselY1 {
+  double operator() (double x) const { return bessely1(x); }
+  SIMD<double> operator() (SIMD<double> x) const { return bessely1(x); }
+  template <typename T> T operator() (T x) const { throw Exception("bessely1 is available for real arguments only"); }
+  static string Name() { return "bessely1"; }
+  void DoArchive(Archive& ar) {}
+};
+
 /*
 struct GenericConj {
   template <typename T> T operator() (T x) const { return Conj(x); } // from bla
@@ -324,6 +350,41 @@ cl_UnaryOpCF<GenericLog>::Diff(const CoefficientFunction * var,
   return c1->Diff(var, dir) / c1;
 }
 
+// J0' = -J1,  J1' = J0 - J1/x,  the same for Y
+template <> shared_ptr<CoefficientFunction>
+cl_UnaryOpCF<GenericBesselJ0>::Diff(const CoefficientFunction * var,
+                                    shared_ptr<CoefficientFunction> dir) const
+{
+  if (this == var) return dir;
+  return -1 * UnaryOpCF(c1, GenericBesselJ1(), "besselj1") * c1->Diff(var, dir);
+}
+
+template <> shared_ptr<CoefficientFunction>
+cl_UnaryOpCF<GenericBesselJ1>::Diff(const CoefficientFunction * var,
+                                    shared_ptr<CoefficientFunction> dir) const
+{
+  if (this == var) return dir;
+  return (UnaryOpCF(c1, GenericBesselJ0(), "besselj0")
+          - UnaryOpCF(c1, GenericBesselJ1(), "besselj1") / c1) * c1->Diff(var, dir);
+}
+
+template <> shared_ptr<CoefficientFunction>
+cl_UnaryOpCF<GenericBesselY0>::Diff(const CoefficientFunction * var,
+                                    shared_ptr<CoefficientFunction> dir) const
+{
+  if (this == var) return dir;
+  return -1 * UnaryOpCF(c1, GenericBesselY1(), "bessely1") * c1->Diff(var, dir);
+}
+
+template <> shared_ptr<CoefficientFunction>
+cl_UnaryOpCF<GenericBesselY1>::Diff(const CoefficientFunction * var,
+                                    shared_ptr<CoefficientFunction> dir) const
+{
+  if (this == var) return dir;
+  return (UnaryOpCF(c1, GenericBesselY0(), "bessely0")
+          - UnaryOpCF(c1, GenericBesselY1(), "bessely1") / c1) * c1->Diff(var, dir);
+}
+
 template <> shared_ptr<CoefficientFunction>
 cl_UnaryOpCF<GenericSqrt>::Diff(const CoefficientFunction * var,
                                  shared_ptr<CoefficientFunction> dir) const
@@ -627,6 +688,10 @@ direction : int
   ExportStdMathFunction<GenericCeil>(m, "ceil", "Round to next greater integer");
   // ExportStdMathFunction<GenericConj>(m, "Conj", "Conjugate imaginary part of complex number");
   ExportStdMathFunction<GenericIdentity>(m, " ", "Passes value through");
+  ExportStdMathFunction<GenericBesselJ0>(m, "besselj0", "Bessel function of the first kind, order 0, real argument");
+  ExportStdMathFunction<GenericBesselJ1>(m, "besselj1", "Bessel function of the first kind, order 1, real argument");
+  ExportStdMathFunction<GenericBesselY0>(m, "bessely0", "Bessel function of the second kind, order 0, argument > 0");
+  ExportStdMathFunction<GenericBesselY1>(m, "bessely1", "Bessel function of the second kind, order 1, argument > 0");
 
   ExportStdMathFunction2<GenericATan2>(m, "atan2", "Four quadrant inverse tangent in radians", "y", "x");
   ExportStdMathFunction2<GenericPow>(m, "pow", "Power function");
@@ -970,7 +1035,9 @@ maxderiv : int
   input maximal derivative
 
 wait : bool
-  True -> Waits until the previous Compile call is finished before start compiling
+  True -> compiles before returning
+  False -> compiles in the background, the interpreted version is used until the
+  library is ready, see WaitForCompilation
 
 )raw_string"))
 
@@ -992,6 +1059,12 @@ wait : bool
     .def (NGSPickle<CoefficientFunction>())
     ;
 
+  m.def("GetNoSIMDFallbacks", [] () { return GetNoSIMDFallbacks(); },
+        "messages of the SIMD evaluations which are not available, and how often integrators\n"
+        "or coefficient functions fell back to scalar evaluation because of them");
+  m.def("ResetNoSIMDFallbacks", [] () { ResetNoSIMDFallbacks(); },
+        "clears the counters of GetNoSIMDFallbacks");
+
   m.def("Cross", [] (shared_ptr<CF> cf1, shared_ptr<CF> cf2) { return CrossProduct(cf1, cf2); });
   m.def("Sym", [] (shared_ptr<CF> cf) { return SymmetricCF(cf); });
   m.def("Skew", [] (shared_ptr<CF> cf) { return SkewCF(cf); });
@@ -1021,31 +1094,72 @@ wait : bool
            py::array np_array;
            if (!self->IsComplex())
              {
-               Array<double> vals(npoints * self->Dimension());
-               ParallelForRange(Range(npoints), [&](IntRange r)
-                           {
-                             LocalHeapMem<10000> lh("CF evaluate");
-                             IntegrationRule ir;
+               size_t dim = self->Dimension();
+               Array<double> vals(npoints * dim);
+
+               // all points of an element are evaluated together
+               Array<size_t> perm(npoints);
+               for (size_t i = 0; i < npoints; i++)
+                 perm[i] = i;
+               auto elkey = [&] (size_t i)
+                 { return make_tuple (pts(i).mesh, int(pts(i).vb), pts(i).nr); };
+               QuickSort (perm, [&] (size_t a, size_t b)
+                          { return make_tuple(elkey(a), a) < make_tuple(elkey(b), b); });
+
+               // groups of at most 256 points in one element
+               Array<size_t> first;
+               for (size_t i = 0; i < npoints; i++)
+                 {
+                   if (pts(perm[i]).nr < 0)
+                     throw Exception ("CF evaluate: point is not in mesh");
+                   if (i == 0 || elkey(perm[i-1]) != elkey(perm[i]) || i-first.Last() == 256)
+                     first.Append (i);
+                 }
+               first.Append (npoints);
 
-                             for (auto i = r.begin(); i < r.end();  )
+               bool use_simd = true;
+               ParallelForRange(Range(first.Size()-1), [&](IntRange r)
+                           {
+                             LocalHeap lh(1000000, "CF evaluate");
+                             for (size_t g : r)
                                {
                                  HeapReset hr(lh);
-                                 auto& mp = pts(i);
-                                 auto ei = ElementId(mp.vb, mp.nr);
-                                 auto& trafo = mp.mesh->GetTrafo(ei, lh);
-                                 ir.SetSize(0);
-
-                                 auto first = i;
-                                 ir.Append (IntegrationPoint(mp.x, mp.y, mp.z));
-                                 i++;
-                                 while (i < r.end() && ElementId(pts(i).vb, pts(i).nr) == ei && i < first+16)
+                                 auto group = perm.Range(first[g], first[g+1]);
+                                 auto& mp = pts(group[0]);
+                                 auto& trafo = mp.mesh->GetTrafo(ElementId(mp.vb, mp.nr), lh);
+                                 IntegrationRule ir(group.Size(), lh);
+                                 for (size_t j = 0; j < group.Size(); j++)
+                                   ir[j] = IntegrationPoint(pts(group[j]).x, pts(group[j]).y, pts(group[j]).z);
+
+                                 FlatMatrix<double> hvals(ir.Size(), dim, lh);
+                                 bool this_simd = use_simd;
+                                 if (this_simd)
+                                   {
+                                     try
+                                       {
+                                         SIMD_IntegrationRule simdir(ir, lh);
+                                         auto & mir = trafo(simdir, lh);
+                                         FlatMatrix<SIMD<double>> simdvals(dim, simdir.Size(), lh);
+                                         self->Evaluate(mir, simdvals);
+                                         SliceMatrix<double> svals(dim, ir.Size(), simdir.Size()*SIMD<double>::Size(),
+                                                                   &simdvals(0,0)[0]);
+                                         hvals = Trans(svals);
+                                       }
+                                     catch (ExceptionNOSIMD e)
+                                       {
+                                         CountNoSIMDFallback (e);
+                                         this_simd = false;
+                                         use_simd = false;
+                                       }
+                                   }
+                                 if (!this_simd)
                                    {
-                                     ir.Append(IntegrationPoint(pts(i).x, pts(i).y, pts(i).z));
-                                     i++;
+                                     auto& mir = trafo(ir, lh);
+                                     self->Evaluate(mir, hvals);
                                    }
-                                 auto& mir = trafo(ir, lh);
-                                 FlatMatrix<double> fm(ir.Size(), self->Dimension(), &vals[first*self->Dimension()]);
-                                 self->Evaluate(mir, fm);
+                                 for (size_t j = 0; j < group.Size(); j++)
+                                   for (size_t k = 0; k < dim; k++)
+                                     vals[group[j]*dim+k] = hvals(j,k);
                                }
                            });
                np_array = MoveToNumpyArray(vals);
@@ -1132,6 +1246,17 @@ vals : list
     ;
 
   m.def ("LoggingCF", LoggingCF, py::arg("cf"), py::arg("logfile")="stdout");
+
+  m.def ("SetCompileCacheDirectory", &SetCompileCacheDirectory, py::arg("directory"),
+         docu_string(R"raw_string(
+Directory for the cache of compiled CoefficientFunctions (Compile with realcompile=True).
+Libraries are reused for identical generated code, the processes of a parallel run
+share one compilation. Empty string disables the cache, the default is given by
+the environment variable NGS_COMPILE_CACHE.
+)raw_string"));
+  m.def ("GetCompileCacheDirectory", &GetCompileCacheDirectory);
+  m.def ("WaitForCompilation", &WaitForCompilation, py::call_guard<py::gil_scoped_release>(),
+         "waits until all CoefficientFunctions compiled with wait=False are ready");
 }
 
 
@@ -1547,6 +1672,14 @@ weights : list
                            }, "Points of IntegrationRule as tuple")
     ;
 
+  m.def("SetSymmetricSimplexRules", &SetSymmetricSimplexRules, py::arg("enable"),
+        "use fully symmetric rules for high order trigs and tets (default), or collapsed Gauss-Jacobi rules");
+  m.def("GetSymmetricSimplexRules", &GetSymmetricSimplexRules);
+
+  m.def("SetReferenceElementMatrices", &SetReferenceElementMatrices, py::arg("enable"),
+        "assemble element matrices of constant coefficient forms on affine elements from reference element matrices (default)");
+  m.def("GetReferenceElementMatrices", &GetReferenceElementMatrices);
+
 
   py::class_<MeshPoint>(m, "MeshPoint")
     .def_property_readonly("pnt", [](MeshPoint& p) { return py::make_tuple(p.x,p.y,p.z); })
@@ -2147,17 +2280,72 @@ alpha : double
                            
   m.def("GenerateL2ElementCode", &GenerateL2ElementCode);
 
+  auto voxel_storage = [](const string & dtype)
+    {
+      if (dtype == "float64") return VOXEL_FLOAT64;
+      if (dtype == "float32") return VOXEL_FLOAT32;
+      if (dtype == "uint8") return VOXEL_UINT8;
+      throw Exception("Only float64, float32 and uint8 voxel storage allowed!");
+    };
+
   m.def("VoxelCoefficient",
-        [](py::tuple pystart, py::tuple pyend, py::array values,
-           bool linear, py::object trafocf)
+        [voxel_storage](py::tuple pystart, py::tuple pyend, string filename, py::tuple shape,
+                        string dtype, size_t headersize, double scale, double offset,
+                        bool linear, py::object trafocf)
         -> shared_ptr<CoefficientFunction>
         {
           shared_ptr<CoefficientFunction> trafo;
           try { trafo = MakeCoefficient(trafocf); }
           catch(...) { trafo=nullptr; }
-          Array<string> allowed_types = { "float64", "complex128" };
-          if(!allowed_types.Contains(py::cast<string>(values.dtype().attr("name"))))
-            throw Exception("Only float64 and complex128 dtype arrays allowed!");
+          Array<double> start, end;
+          Array<size_t> dim_vals;
+          for(auto val : pystart)
+            start.Append(py::cast<double>(val));
+          for(auto val : pyend)
+            end.Append(py::cast<double>(val));
+          for(auto val : shape)
+            dim_vals.Insert(0,py::cast<size_t>(val));
+          return make_shared<VoxelCoefficientFunction<double>>
+            (start, end, dim_vals, filename, headersize, voxel_storage(dtype),
+             scale, offset, linear, trafo);
+        }, py::arg("start"), py::arg("end"), py::arg("filename"), py::arg("shape"),
+        py::arg("dtype")="float64", py::arg("headersize")=0,
+        py::arg("scale")=1., py::arg("offset")=0.,
+        py::arg("linear")=true, py::arg("trafocf")=DummyArgument(), R"delimiter(CoefficientFunction defined on a grid, values read from a raw binary file.
+
+The file is memory mapped, only the voxels needed for evaluation are paged in. Values are stored in the file with x running fastest (as written by numpy.ndarray.tofile), 'shape' is the shape of the corresponding numpy array.
+
+Parameters:
+
+filename : string
+  raw voxel file
+
+shape : tuple
+  number of voxels per direction, slowest running index first
+
+dtype : string
+  storage type of the voxels, 'float64', 'float32' or 'uint8'
+
+headersize : int
+  number of bytes to skip at the beginning of the file
+
+scale, offset : double
+  voxel value is offset + scale * stored value
+
+)delimiter");
+
+  m.def("VoxelCoefficient",
+        [voxel_storage](py::tuple pystart, py::tuple pyend, py::array values,
+                        bool linear, py::object trafocf, double scale, double offset)
+        -> shared_ptr<CoefficientFunction>
+        {
+          shared_ptr<CoefficientFunction> trafo;
+          try { trafo = MakeCoefficient(trafocf); }
+          catch(...) { trafo=nullptr; }
+          Array<string> allowed_types = { "float64", "complex128", "float32", "uint8" };
+          string dtype = py::cast<string>(values.dtype().attr("name"));
+          if(!allowed_types.Contains(dtype))
+            throw Exception("Only float64, complex128, float32 and uint8 dtype arrays allowed!");
           Array<double> start, end;
           Array<size_t> dim_vals;
           for(auto val : pystart)
@@ -2176,6 +2364,15 @@ alpha : double
               return make_shared<VoxelCoefficientFunction<Complex>>
                 (start, end, dim_vals, move(vals), linear, trafo);
             }
+          if(dtype != "float64" || scale != 1 || offset != 0)
+            {
+              auto storage = voxel_storage(dtype);
+              auto raw = py::cast<py::array>(values.attr("ravel")().attr("astype")(dtype));
+              Array<char> rawvals(raw.nbytes());
+              memcpy(rawvals.Data(), raw.data(), raw.nbytes());
+              return make_shared<VoxelCoefficientFunction<double>>
+                (start, end, dim_vals, move(rawvals), storage, scale, offset, linear, trafo);
+            }
           auto d_array = py::cast<py::array_t<double>>(values.attr("ravel")());
           Array<double> vals(values.size());
           for(auto i : Range(vals))
@@ -2183,13 +2380,16 @@ alpha : double
           return make_shared<VoxelCoefficientFunction<double>>
               (start, end, dim_vals, move(vals), linear, trafo);
         }, py::arg("start"), py::arg("end"), py::arg("values"),
-        py::arg("linear")=true, py::arg("trafocf")=DummyArgument(), R"delimiter(CoefficientFunction defined on a grid.
+        py::arg("linear")=true, py::arg("trafocf")=DummyArgument(),
+        py::arg("scale")=1., py::arg("offset")=0., R"delimiter(CoefficientFunction defined on a grid.
 
 Start and end mark the cartesian boundary of domain. The function will be continued by a constant function outside of this box. Inside a cartesian grid will be created by the dimensions of the numpy input array 'values'. This array must have the dimensions of the mesh and the values stored as:
 x1y1z1, x2y1z1, ..., xNy1z1, x1y2z1, ...
 
 If linear is True the function will be interpolated linearly between the values. Otherwise the nearest voxel value is taken.
 
+Real arrays of dtype float32 or uint8 are kept in this reduced precision, the value of a voxel is then offset + scale * stored value.
+
 )delimiter");
 
 }
@@ -2662,9 +2662,56 @@ class IntegratedJacobiPolynomialAlpha : public RecursivePolynomialNonStatic<Inte
       EvalMult (n, x, y, z, 1, values);
     }
 
+    // max order for the fused evaluation, bounds the stack table
+    static constexpr int maxfused = 20;
+
     template <typename TI, class S, class Sc, class T>
     INLINE static void EvalMult (TI n, S x, S y, S z, Sc c, T && values)
     {
+    if (n < 0) return;
+    if (n > maxfused)
+      {
+        EvalMultRecursive (n, x, y, z, c, values);
+        return;
+      }
+
+    // the x-polynomials P_m^(2(k+j)+2,0)(2x-1) depend on k+j only:
+    // evaluate the n+1 families once, and scale them by the yz-factors
+    size_t offx[maxfused+2];
+    STACK_ARRAY(S, xpol, (n+1)*(n+2)/2);
+    JacobiPolynomialAlpha jacx(2);
+    offx[0] = 0;
+    for (int s = 0; s <= n; s++)
+      {
+        jacx.Eval1Assign (n-s, 2*x-1, xpol+offx[s]);
+        offx[s+1] = offx[s] + n-s+1;
+        jacx.IncAlpha2();
+      }
+
+    size_t ii = 0;
+    S lam4 = 1.0 - x-y-z;
+    LegendrePolynomial leg;
+    JacobiPolynomialAlpha jac1(1);    
+    leg.EvalScaledMult1Assign 
+      (n, z-lam4, z+lam4, c,
+       SBLambda ([&](size_t k, S polz) LAMBDA_INLINE
+                 {
+                   jac1.EvalScaledMult1Assign
+                     (n-k, y-z-lam4, 1-x, polz, 
+                      SBLambda ([&] (size_t j, S polsy) LAMBDA_INLINE
+                                {
+                                  S * px = xpol+offx[k+j];
+                                  for (size_t m = 0; m <= n-k-j; m++)
+                                    values[ii++] = polsy * px[m];
+                                }));
+                   jac1.IncAlpha2();
+                 }));
+    }
+
+    // one x-recursion per (k,j), used for high orders
+    template <typename TI, class S, class Sc, class T>
+    INLINE static void EvalMultRecursive (TI n, S x, S y, S z, Sc c, T && values)
+    {
     size_t ii = 0;
     S lam4 = 1.0 - x-y-z;
     LegendrePolynomial leg;
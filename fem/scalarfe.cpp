@@ -213,6 +213,18 @@ namespace ngfem
     throw ExceptionNOSIMD (string("EvaluateGrad (simd) not implemented for class ")+typeid(*this).name());
   }
 
+  void BaseScalarFiniteElement :: 
+  EvaluateValueGrad (const SIMD_IntegrationRule & ir, SliceMatrix<> coefs,
+                     BareSliceMatrix<SIMD<double>> values, BareSliceMatrix<SIMD<double>> grads) const
+  {
+    int dim = Dim();
+    for (size_t c = 0; c < coefs.Width(); c++)
+      {
+        Evaluate (ir, coefs.Col(c), values.Row(c));
+        EvaluateGrad (ir, coefs.Col(c), grads.Rows(c*dim, (c+1)*dim));
+      }
+  }
+
   
   void BaseScalarFiniteElement :: 
   EvaluateTrans (const IntegrationRule & ir, FlatVector<double> vals, BareSliceVector<double> coefs) const
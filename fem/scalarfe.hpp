@@ -23,6 +23,9 @@ namespace ngfem
     HD NGS_DLL_HEADER
     virtual string ClassName() const override;
 
+    /// shapes depend only on element type, order and this class number (-1 if not)
+    virtual int GetShapeClassNr () const { return -1; }
+
     /// compute shape
     HD NGS_DLL_HEADER 
     virtual void CalcShape (const IntegrationPoint & ip, 
@@ -106,6 +109,11 @@ namespace ngfem
     HD NGS_DLL_HEADER virtual void EvaluateGrad (const SIMD_BaseMappedIntegrationRule & ir, BareSliceVector<> coefs, BareSliceMatrix<SIMD<double>> values) const;
     // needed for ALE-trafo
     HD NGS_DLL_HEADER virtual void EvaluateGrad (const SIMD_IntegrationRule & ir, BareSliceVector<> coefs, BareSliceMatrix<SIMD<double>> values) const;
+    /// values and reference gradients of the columns of coefs in one pass over the shapes (ALE-trafo)
+    /// values: ncol x nip, grads: (ncol*dim) x nip, derivatives of column c in rows c*dim ...
+    HD NGS_DLL_HEADER virtual void EvaluateValueGrad (const SIMD_IntegrationRule & ir, SliceMatrix<> coefs,
+                                                      BareSliceMatrix<SIMD<double>> values,
+                                                      BareSliceMatrix<SIMD<double>> grads) const;
     HD NGS_DLL_HEADER virtual void AddGradTrans (const SIMD_BaseMappedIntegrationRule & ir, BareSliceMatrix<SIMD<double>> values,
                                                  BareSliceVector<> coefs) const;
     /// input du1/dx du1/dy du1/dz du2/dx ...
@@ -12,6 +12,29 @@
 namespace ngfem
 {
 
+  static mutex nosimd_mutex;
+  static std::map<string, size_t> nosimd_fallbacks;
+
+  void CountNoSIMDFallback (const ExceptionNOSIMD & e)
+  {
+    lock_guard<mutex> guard(nosimd_mutex);
+    if (nosimd_fallbacks[e.What()]++ == 0)
+      cout << IM(3) << "SIMD evaluation not available, scalar fall-back: " << e.What() << endl;
+  }
+
+  std::map<string, size_t> GetNoSIMDFallbacks ()
+  {
+    lock_guard<mutex> guard(nosimd_mutex);
+    return nosimd_fallbacks;
+  }
+
+  void ResetNoSIMDFallbacks ()
+  {
+    lock_guard<mutex> guard(nosimd_mutex);
+    nosimd_fallbacks.clear();
+  }
+
+
   
   ProxyFunction ::
   ProxyFunction (shared_ptr<ngcomp::FESpace> afes,
@@ -841,12 +864,56 @@ namespace ngfem
                        LocalHeap & lh) const
   {
     if (element_vb != VOL)
-      { // not yet simded
+      {
         elvec = 0;
     
         auto eltype = trafo.GetElementType();
         Facet2ElementTrafo transform(eltype, element_vb); 
         int nfacet = transform.GetNFacets();
+
+        if (simd_evaluate)
+          {
+            try
+              {
+                for (int k = 0; k < nfacet; k++)
+                  {
+                    HeapReset hr(lh);
+                    ngfem::ELEMENT_TYPE etfacet = transform.FacetType (k);
+                    const SIMD_IntegrationRule & ir_facet = GetSIMDIntegrationRule(etfacet, 2*fel.Order()+bonus_intorder);
+                    auto & ir_facet_vol = GetSIMDFacetVolumeRule(transform, k, 2*fel.Order()+bonus_intorder, lh);
+                    auto & mir = trafo(ir_facet_vol, lh);
+                    
+                    ProxyUserData ud;
+                    const_cast<ElementTransformation&>(trafo).userdata = &ud;
+                    
+                    mir.ComputeNormalsAndMeasure (eltype, k);
+                    
+                    for (auto proxy : proxies)
+                      {
+                        HeapReset hr(lh);
+                        FlatMatrix<SIMD<SCAL>> proxyvalues(proxy->Dimension(), ir_facet.Size(), lh);
+                        for (size_t l = 0; l < proxy->Dimension(); l++)
+                          {
+                            ud.testfunction = proxy;
+                            ud.test_comp = l;
+                            cf -> Evaluate (mir, proxyvalues.Rows(l,l+1));
+                            for (size_t i = 0; i < mir.Size(); i++)
+                              proxyvalues(l,i) *= mir[i].GetWeight();
+                          }
+                        proxy->Evaluator()->AddTrans(fel, mir, proxyvalues, elvec);
+                      }
+                  }
+                return;
+              }
+            catch (ExceptionNOSIMD e)
+              {
+                CountNoSIMDFallback (e);
+                cout << IM(6) << e.What() << endl
+                     << "switching back to standard evaluation" << endl;
+                simd_evaluate = false;
+                elvec = 0;
+              }
+          }
         
         for (int k = 0; k < nfacet; k++)
           {
@@ -930,6 +997,7 @@ namespace ngfem
           }
         catch (ExceptionNOSIMD e)
           {
+            CountNoSIMDFallback (e);
             cout << IM(6) << e.What() << endl
                  << "switching back to standard evaluation" << endl;
             simd_evaluate = false;
@@ -1263,6 +1331,478 @@ namespace ngfem
   Timer timer_SymbBFImultsym("SymbolicBFI multsym");
   */
 
+  static bool reference_element_matrices = true;
+  void SetReferenceElementMatrices (bool enable) { reference_element_matrices = enable; }
+  bool GetReferenceElementMatrices () { return reference_element_matrices; }
+
+  // shape values (0) or gradients (1) of scalar elements, -1 for all other operators
+  template <int D>
+  static int T_ReferenceDiffOpType (const DifferentialOperator & diffop)
+  {
+    auto & type = typeid(diffop);
+    if (type == typeid(T_DifferentialOperator<DiffOpId<D>>) ||
+        type == typeid(T_DifferentialOperator<DiffOpIdH1<D,D>>))
+      return 0;
+    if (type == typeid(T_DifferentialOperator<DiffOpGradient<D>>))
+      return 1;
+    return -1;
+  }
+
+  static int ReferenceDiffOpType (const DifferentialOperator & diffop, int dim)
+  {
+    switch (dim)
+      {
+      case 1: return T_ReferenceDiffOpType<1> (diffop);
+      case 2: return T_ReferenceDiffOpType<2> (diffop);
+      case 3: return T_ReferenceDiffOpType<3> (diffop);
+      default: return -1;
+      }
+  }
+
+  /*
+    Integrals over the reference element of products of shape values or
+    reference derivatives, R^{ab}_{ji} = sum_q w_q B2_{b,j}(q) B1_{a,i}(q).
+    Shared by all elements of the same type, shape class and order.
+  */
+  class ReferenceElementMatrices
+  {
+  public:
+    size_t fetype, irhash;
+    int classnr, order, ndof, type1, type2;
+    Matrix<> mats;       // block b*n1+a is R^{ab}, ndof x ndof
+    ReferenceElementMatrices * next = nullptr;
+  };
+
+  /*
+    Thread-safe container for ReferenceElementMatrices.
+    Lookup is lock-free, entries are only added and never removed.
+  */
+  class ReferenceElementMatricesContainer
+  {
+    static constexpr size_t NBUCKETS = 256;
+    atomic<ReferenceElementMatrices*> buckets[NBUCKETS];
+    atomic<size_t> memory{0};
+  public:
+    /// don't cache more than that (in bytes)
+    static constexpr size_t max_memory = size_t(1) << 28;
+
+    ReferenceElementMatricesContainer ()
+    {
+      for (auto & b : buckets) b.store (nullptr);
+    }
+
+    ~ReferenceElementMatricesContainer ()
+    {
+      for (auto & b : buckets)
+        for (auto p = b.load(); p; )
+          {
+            auto next = p->next;
+            delete p;
+            p = next;
+          }
+    }
+
+    ReferenceElementMatrices * Get (size_t fetype, int classnr, int order, int ndof,
+                                    size_t irhash, int type1, int type2) const
+    {
+      for (auto p = buckets[Bucket(classnr, order, irhash)].load(memory_order_acquire); p; p = p->next)
+        if (p->fetype == fetype && p->classnr == classnr && p->order == order && p->ndof == ndof &&
+            p->irhash == irhash && p->type1 == type1 && p->type2 == type2)
+          return p;
+      return nullptr;
+    }
+
+    bool HasSpace (size_t bytes) const { return memory + bytes <= max_memory; }
+
+    /// takes ownership, another thread may have added the same matrices
+    ReferenceElementMatrices * Add (ReferenceElementMatrices * ref)
+    {
+      memory += ref->mats.Height() * ref->mats.Width() * sizeof(double);
+      auto & bucket = buckets[Bucket(ref->classnr, ref->order, ref->irhash)];
+      ref->next = bucket.load (memory_order_relaxed);
+      while (!bucket.compare_exchange_weak (ref->next, ref, memory_order_release, memory_order_relaxed))
+        ;
+      return ref;
+    }
+
+  private:
+    static size_t Bucket (int classnr, int order, size_t irhash)
+    {
+      return (irhash + 97 * classnr + 32 * order) % NBUCKETS;
+    }
+  };
+
+  static const ReferenceElementMatrices *
+  GetReferenceElementMatrices (const BaseScalarFiniteElement & fel, int classnr,
+                               const SIMD_IntegrationRule & ir, int type1, int type2,
+                               LocalHeap & lh)
+  {
+    static ReferenceElementMatricesContainer container;
+    size_t fetype = typeid(fel).hash_code();
+    size_t irhash = SIMD_PrecomputedShapesContainer::Hash (ir, fel.Dim());
+    int ndof = fel.GetNDof();
+    if (auto ref = container.Get (fetype, classnr, fel.Order(), ndof, irhash, type1, type2))
+      return ref;
+
+    int D = fel.Dim();
+    int n1 = type1 ? D : 1, n2 = type2 ? D : 1;
+    if (!container.HasSpace (n1*n2*ndof*ndof*sizeof(double)))
+      return nullptr;
+
+    static Timer t("SymbolicBFI::ReferenceElementMatrices"); RegionTimer reg(t);
+    HeapReset hr(lh);
+    size_t nip = ir.Size()*SIMD<double>::Size();
+    FlatMatrix<> shapes(ndof, nip, lh);
+    FlatMatrix<> dshapes(D*ndof, nip, lh);   // rows a*ndof+i: derivative a of shape i
+    FlatMatrix<> dshape(ndof, D, lh);
+    FlatVector<> weights(nip, lh);
+    for (size_t i = 0, q = 0; i < ir.Size(); i++)
+      for (size_t l = 0; l < SIMD<double>::Size(); l++, q++)
+        {
+          IntegrationPoint ip(ir[i](0)[l], D > 1 ? ir[i](1)[l] : 0.0,
+                              D > 2 ? ir[i](2)[l] : 0.0, ir[i].Weight()[l]);
+          fel.CalcShape (ip, shapes.Col(q));
+          fel.CalcDShape (ip, dshape);
+          for (int a = 0; a < D; a++)
+            dshapes.Rows(a*ndof, (a+1)*ndof).Col(q) = dshape.Col(a);
+          weights(q) = ip.Weight();
+        }
+    auto bmat = [&] (int type, int a) { return type ? dshapes.Rows(a*ndof, (a+1)*ndof) : shapes; };
+
+    auto ref = new ReferenceElementMatrices;
+    ref->fetype = fetype;
+    ref->irhash = irhash;
+    ref->classnr = classnr;
+    ref->order = fel.Order();
+    ref->ndof = ndof;
+    ref->type1 = type1;
+    ref->type2 = type2;
+    ref->mats.SetSize (n1*n2*ndof, ndof);
+    FlatMatrix<> wb2(ndof, nip, lh);
+    for (int b = 0; b < n2; b++)
+      {
+        auto b2 = bmat(type2, b);
+        for (size_t q = 0; q < nip; q++)
+          wb2.Col(q) = weights(q) * b2.Col(q);
+        for (int a = 0; a < n1; a++)
+          ref->mats.Rows((b*n1+a)*ndof, (b*n1+a+1)*ndof) = wb2 * Trans(bmat(type1, a));
+      }
+    return container.Add (ref);
+  }
+
+  // affine element: the same Jacobian in all integration points
+  template <int D>
+  static bool AffineJacobian (const SIMD_MappedIntegrationRule<D,D> & mir, Mat<D,D> & jac)
+  {
+    double maxjac = 0;
+    for (int r = 0; r < D; r++)
+      for (int c = 0; c < D; c++)
+        {
+          jac(r,c) = mir[0].GetJacobian()(r,c)[0];
+          maxjac = max2(maxjac, fabs(jac(r,c)));
+        }
+    for (size_t i = 0; i < mir.Size(); i++)
+      for (int r = 0; r < D; r++)
+        for (int c = 0; c < D; c++)
+          for (size_t l = 0; l < SIMD<double>::Size(); l++)
+            if (fabs(mir[i].GetJacobian()(r,c)[l]-jac(r,c)) > 1e-12*maxjac)
+              return false;
+    return true;
+  }
+
+  bool SymbolicBilinearFormIntegrator ::
+  ConstantProxyCoefficient (const SIMD_BaseMappedIntegrationRule & mir,
+                            ProxyFunction * proxy1, ProxyFunction * proxy2,
+                            int k1, int l1, ProxyUserData & ud,
+                            FlatMatrix<double> dmat, LocalHeap & lh) const
+  {
+    HeapReset hr(lh);
+    FlatMatrix<SIMD<double>> val(1, mir.Size(), lh);
+    dmat = 0.0;
+    for (size_t k = 0; k < dmat.Height(); k++)
+      for (size_t l = 0; l < dmat.Width(); l++)
+        if (nonzeros(l1+l, k1+k))
+          {
+            ud.trialfunction = proxy1;
+            ud.trial_comp = k;
+            ud.testfunction = proxy2;
+            ud.test_comp = l;
+            cf -> Evaluate (mir, val);
+            double v0 = val(0,0)[0];
+            for (size_t i = 0; i < mir.Size(); i++)
+              for (size_t j = 0; j < SIMD<double>::Size(); j++)
+                if (val(0,i)[j] != v0)
+                  {
+                    reference_matrices = false;
+                    return false;
+                  }
+            dmat(k,l) = v0;
+          }
+    return true;
+  }
+
+  bool SymbolicBilinearFormIntegrator ::
+  GetReferenceTerms (const FiniteElement & fel, const ElementTransformation & trafo,
+                     FlatMatrix<double> jac, Array<ReferenceTerm> & terms,
+                     LocalHeap & lh) const
+  {
+    terms.SetSize0();
+    auto sfel = dynamic_cast<const BaseScalarFiniteElement*> (&fel);
+    int D = fel.Dim();
+    if (!sfel || sfel->GetShapeClassNr() < 0 || vb != VOL || element_vb != VOL ||
+        !reference_matrices || trafo.SpaceDim() != D ||
+        jac.Height() != size_t(D) || jac.Width() != size_t(D))
+      return false;
+    int classnr = sfel->GetShapeClassNr();
+
+    HeapReset hr(lh);
+    const SIMD_IntegrationRule & ir = Get_SIMD_IntegrationRule (fel, lh);
+    SIMD_BaseMappedIntegrationRule & mir = trafo(ir, lh);
+
+    bool affine = false;
+    Switch<3> (D-1, [&] (auto DM1)
+      {
+        constexpr int DIM = DM1.value+1;
+        Mat<DIM,DIM> hjac;
+        affine = AffineJacobian<DIM> (static_cast<const SIMD_MappedIntegrationRule<DIM,DIM>&> (mir), hjac);
+        jac = hjac;
+      });
+    if (!affine) return false;
+
+    ProxyUserData ud;
+    const_cast<ElementTransformation&>(trafo).userdata = &ud;
+    bool ok = true;
+    int k1 = 0, k1nr = 0;
+    for (auto proxy1 : trial_proxies)
+      {
+        int l1 = 0, l1nr = 0;
+        for (auto proxy2 : test_proxies)
+          {
+            if (ok && nonzeros_proxies(l1nr*trial_proxies.Size()+k1nr))
+              {
+                int type1 = ReferenceDiffOpType (*proxy1->Evaluator(), D);
+                int type2 = ReferenceDiffOpType (*proxy2->Evaluator(), D);
+                const ReferenceElementMatrices * ref = nullptr;
+                terms.Append (ReferenceTerm());
+                auto & term = terms.Last();
+                term.dmat.SetSize (proxy1->Dimension(), proxy2->Dimension());
+                ok = type1 >= 0 && type2 >= 0 &&
+                  ConstantProxyCoefficient (mir, proxy1, proxy2, k1, l1, ud, term.dmat, lh) &&
+                  (ref = GetReferenceElementMatrices (*sfel, classnr, ir, type1, type2, lh));
+                term.type1 = type1;
+                term.type2 = type2;
+                term.mats = ref ? &ref->mats : nullptr;
+              }
+            l1 += proxy2->Dimension();
+            l1nr++;
+          }
+        k1 += proxy1->Dimension();
+        k1nr++;
+      }
+    const_cast<ElementTransformation&>(trafo).userdata = nullptr;
+    return ok;
+  }
+
+  bool SymbolicBilinearFormIntegrator ::
+  AddReferenceElementMatrix (const FiniteElement & fel,
+                             const SIMD_BaseMappedIntegrationRule & mir,
+                             ProxyFunction * proxy1, ProxyFunction * proxy2,
+                             int k1, int l1, ProxyUserData & ud,
+                             FlatMatrix<double> elmat, LocalHeap & lh) const
+  {
+    auto sfel = dynamic_cast<const BaseScalarFiniteElement*> (&fel);
+    if (!sfel) return false;
+    int classnr = sfel->GetShapeClassNr();
+    int D = fel.Dim();
+    if (classnr < 0 || mir.DimElement() != D || mir.DimSpace() != D ||
+        elmat.Height() != fel.GetNDof() || elmat.Width() != fel.GetNDof())
+      return false;
+    int type1 = ReferenceDiffOpType (*proxy1->Evaluator(), D);
+    int type2 = ReferenceDiffOpType (*proxy2->Evaluator(), D);
+    if (type1 < 0 || type2 < 0) return false;
+
+    switch (D)
+      {
+      case 1: return T_AddReferenceElementMatrix<1> (*sfel, classnr, mir, proxy1, proxy2, type1, type2, k1, l1, ud, elmat, lh);
+      case 2: return T_AddReferenceElementMatrix<2> (*sfel, classnr, mir, proxy1, proxy2, type1, type2, k1, l1, ud, elmat, lh);
+      case 3: return T_AddReferenceElementMatrix<3> (*sfel, classnr, mir, proxy1, proxy2, type1, type2, k1, l1, ud, elmat, lh);
+      default: return false;
+      }
+  }
+
+  template <int D>
+  bool SymbolicBilinearFormIntegrator ::
+  T_AddReferenceElementMatrix (const BaseScalarFiniteElement & fel, int classnr,
+                               const SIMD_BaseMappedIntegrationRule & bmir,
+                               ProxyFunction * proxy1, ProxyFunction * proxy2,
+                               int type1, int type2,
+                               int k1, int l1, ProxyUserData & ud,
+                               FlatMatrix<double> elmat, LocalHeap & lh) const
+  {
+    auto & mir = static_cast<const SIMD_MappedIntegrationRule<D,D>&> (bmir);
+    HeapReset hr(lh);
+
+    Mat<D,D> jac;
+    if (!AffineJacobian<D> (mir, jac)) return false;
+
+    size_t dim1 = proxy1->Dimension(), dim2 = proxy2->Dimension();
+    FlatMatrix<> dmat(dim1, dim2, lh);
+    if (!ConstantProxyCoefficient (mir, proxy1, proxy2, k1, l1, ud, dmat, lh))
+      return false;
+
+    auto ref = GetReferenceElementMatrices (fel, classnr, mir.IR(), type1, type2, lh);
+    if (!ref) return false;
+
+    // physical operator is trafo * reference operator: 1 for values, J^{-T} for gradients
+    Mat<D,D> jacinv = Inv(jac);
+    auto trafo = [&] (int type, size_t k, int a) { return type ? jacinv(a,k) : 1.0; };
+    double measure = fabs (Det (jac));
+    size_t ndof = fel.GetNDof();
+    int n1 = type1 ? D : 1, n2 = type2 ? D : 1;
+    for (int b = 0; b < n2; b++)
+      for (int a = 0; a < n1; a++)
+        {
+          double coef = 0;
+          for (size_t k = 0; k < dim1; k++)
+            for (size_t l = 0; l < dim2; l++)
+              coef += trafo(type1,k,a) * dmat(k,l) * trafo(type2,l,b);
+          if (coef != 0)
+            elmat += (measure*coef) * ref->mats.Rows((b*n1+a)*ndof, (b*n1+a+1)*ndof);
+        }
+    return true;
+  }
+
+  /*
+    Contraction of the trial shapes with the proxy values, with
+    compile-time dimensions of the proxies:
+
+      bdbmat(i*D2+j, ip) = sum_k coefs(j*D1+k, ip) * bbmat(i*D1+k, ip),  i in r1
+
+    coefs contain the integration weights. The loops over the
+    components are unrolled, the loop over the integration points is
+    contiguous in all matrices.
+  */
+  template <int D1, int D2, typename SCAL, typename SCAL_SHAPES>
+  static void ContractProxies (FlatMatrix<SIMD<SCAL>> coefs,
+                               FlatMatrix<SIMD<SCAL_SHAPES>> bbmat,
+                               FlatMatrix<SIMD<SCAL>> bdbmat, IntRange r1)
+  {
+    size_t nip = bbmat.Width();
+    SIMD<SCAL> * pc = coefs.Data();
+    for (size_t i : r1)
+      {
+        SIMD<SCAL_SHAPES> * pb = bbmat.Data() + i*D1*nip;
+        SIMD<SCAL> * pbdb = bdbmat.Data() + i*D2*nip;
+        for (size_t ip = 0; ip < nip; ip++)
+          {
+            SIMD<SCAL_SHAPES> b[D1];
+            Iterate<D1> ([&] (auto k) { b[k.value] = pb[k.value*nip+ip]; });
+            Iterate<D2> ([&] (auto j)
+              {
+                SIMD<SCAL> sum = pc[j.value*D1*nip+ip] * b[0];
+                if constexpr (D1 > 1)
+                  Iterate<D1-1> ([&] (auto k)
+                    { sum += pc[(j.value*D1+k.value+1)*nip+ip] * b[k.value+1]; });
+                pbdb[j.value*nip+ip] = sum;
+              });
+          }
+      }
+  }
+
+  // diagonal proxy values: bdbmat(i*D+k, ip) = diag(k, ip) * bbmat(i*D+k, ip)
+  template <int D, typename SCAL, typename SCAL_SHAPES>
+  static void ContractProxiesDiagonal (FlatMatrix<SIMD<SCAL>> diag,
+                                       FlatMatrix<SIMD<SCAL_SHAPES>> bbmat,
+                                       FlatMatrix<SIMD<SCAL>> bdbmat, IntRange r1)
+  {
+    size_t nip = bbmat.Width();
+    SIMD<SCAL> * pd = diag.Data();
+    for (size_t i : r1)
+      {
+        SIMD<SCAL_SHAPES> * pb = bbmat.Data() + i*D*nip;
+        SIMD<SCAL> * pbdb = bdbmat.Data() + i*D*nip;
+        Iterate<D> ([&] (auto k)
+          {
+            for (size_t ip = 0; ip < nip; ip++)
+              pbdb[k.value*nip+ip] = pd[k.value*nip+ip] * pb[k.value*nip+ip];
+          });
+      }
+  }
+
+  // the dimensions of the specialized kernels: all pairs up to 3, and
+  // equal dimensions 4, 6, 9 (matrix-valued proxies)
+  template <typename FUNC>
+  static bool DispatchProxyDims (size_t d1, size_t d2, FUNC func)
+  {
+    bool done = false;
+    auto dispatch = [&] (auto D1, auto D2)
+      {
+        if (!done && d1 == decltype(D1)::value && d2 == decltype(D2)::value)
+          {
+            func (D1, D2);
+            done = true;
+          }
+      };
+    Iterate<3> ([&] (auto i)
+      {
+        Iterate<3> ([&] (auto j)
+          {
+            dispatch (std::integral_constant<int,decltype(i)::value+1>(),
+                      std::integral_constant<int,decltype(j)::value+1>());
+          });
+      });
+    dispatch (std::integral_constant<int,4>(), std::integral_constant<int,4>());
+    dispatch (std::integral_constant<int,6>(), std::integral_constant<int,6>());
+    dispatch (std::integral_constant<int,9>(), std::integral_constant<int,9>());
+    return done;
+  }
+
+  /*
+    bdbmat = D * bbmat with the specialized kernels, if available for
+    the dimensions. proxyvalues(k*d2+j) are the values for trial
+    component k and test component j, without weights. Returns false
+    if there is no kernel for the dimensions.
+  */
+  template <typename SCAL, typename SCAL_SHAPES, typename FNZ>
+  static bool ContractProxiesFixed (size_t d1, size_t d2,
+                                    FlatMatrix<SIMD<SCAL>> proxyvalues,
+                                    FlatVector<SIMD<double>> weights, FNZ nonzero,
+                                    FlatMatrix<SIMD<SCAL_SHAPES>> bbmat,
+                                    FlatMatrix<SIMD<SCAL>> bdbmat, IntRange r1,
+                                    LocalHeap & lh)
+  {
+    size_t nip = bbmat.Width();
+    return DispatchProxyDims (d1, d2, [&] (auto D1, auto D2)
+      {
+        constexpr int DIM1 = decltype(D1)::value, DIM2 = decltype(D2)::value;
+        FlatMatrix<SIMD<SCAL>> coefs(DIM1*DIM2, nip, lh);
+        for (int j = 0; j < DIM2; j++)
+          for (int k = 0; k < DIM1; k++)
+            {
+              auto row = coefs.Row(j*DIM1+k);
+              if (nonzero (j, k))
+                for (size_t ip = 0; ip < nip; ip++)
+                  row(ip) = proxyvalues(k*DIM2+j, ip) * weights(ip);
+              else
+                row = 0.0;
+            }
+        ContractProxies<DIM1,DIM2> (coefs, bbmat, bdbmat, r1);
+      });
+  }
+
+  // diag contains the weights already
+  template <typename SCAL, typename SCAL_SHAPES>
+  static bool ContractProxiesDiagonalFixed (size_t d, FlatMatrix<SIMD<SCAL>> diag,
+                                            FlatMatrix<SIMD<SCAL_SHAPES>> bbmat,
+                                            FlatMatrix<SIMD<SCAL>> bdbmat, IntRange r1)
+  {
+    return DispatchProxyDims (d, d, [&] (auto D1, auto D2)
+      {
+        ContractProxiesDiagonal<decltype(D1)::value> (diag, bbmat, bdbmat, r1);
+      });
+  }
+
+
   template <typename SCAL, typename SCAL_SHAPES, typename SCAL_RES>
   void SymbolicBilinearFormIntegrator ::
   T_CalcElementMatrixAdd (const FiniteElement & fel,
@@ -1322,6 +1862,14 @@ namespace ngfem
                   bool is_nonzero = nonzeros_proxies(tt_pair);
                   bool is_diagonal = diagonal_proxies(tt_pair);
 
+                  if constexpr (is_same<SCAL,double>::value && is_same<SCAL_RES,double>::value)
+                    if (is_nonzero && reference_matrices && reference_element_matrices && !is_mixedfe &&
+                        AddReferenceElementMatrix (fel, mir, proxy1, proxy2, k1, l1, ud, elmat, lh))
+                      {
+                        symmetric_so_far &= same_diffops(tt_pair) && is_diagonal;
+                        is_nonzero = false;
+                      }
+
                   if (is_nonzero)
                     {
                       HeapReset hr(lh);
@@ -1412,6 +1960,7 @@ namespace ngfem
                           */
                           
                           // size_t sr1 = r1.Size();
+                          if (!ContractProxiesDiagonalFixed (dim_proxy1, diagproxyvalues, bbmat1, bdbmat1, r1))
                           for (size_t j = 0; j < dim_proxy1; j++)
                             {
                               auto hbbmat1 = bbmat1.RowSlice(j,dim_proxy1).Rows(r1);
@@ -1421,7 +1970,9 @@ namespace ngfem
                                 hbdbmat1.Col(k).Range(0,r1.Size()) = diagproxyvalues(j,k) * hbbmat1.Col(k);
                             }
                         }
-                      else
+                      else if (!ContractProxiesFixed (dim_proxy1, dim_proxy2, proxyvalues, weights,
+                                                      [&] (int j, int k) { return bool(nonzeros(l1+j, k1+k)); },
+                                                      bbmat1, bdbmat1, r1, lh))
                         {
                           // static Timer t("DB", 2);
                           // RegionTracer reg(TaskManager::GetThreadId(), t);
@@ -1527,6 +2078,7 @@ namespace ngfem
         }
       catch (ExceptionNOSIMD e)
         {
+          CountNoSIMDFallback (e);
           cout << IM(6) << e.What() << endl
                << "switching to scalar evaluation" << endl;
           simd_evaluate = false;
@@ -1794,6 +2346,198 @@ namespace ngfem
         T_CalcElementMatrixAdd<double,double,Complex> (fel, trafo, elmat, lh);
   }
 
+  void 
+  SymbolicBilinearFormIntegrator ::
+  CalcElementMatrixAddBatch (FlatArray<const FiniteElement*> fels,
+                             FlatArray<const ElementTransformation*> trafos,
+                             FlatArray<FlatMatrix<double>> elmats,
+                             LocalHeap & lh) const
+  {
+    constexpr size_t SW = SIMD<double>::Size();
+    size_t nel = fels.Size();
+    
+    bool batchable = simd_evaluate && element_vb == VOL && nel > 1 && !cf->IsComplex();
+    for (size_t e = 0; e < nel && batchable; e++)
+      if (typeid(*fels[e]) == typeid(MixedFiniteElement) ||
+          trafos[e]->IsComplex() ||
+          fels[e]->ElementType() != fels[0]->ElementType() ||
+          fels[e]->GetNDof() != fels[0]->GetNDof() ||
+          fels[e]->Order() != fels[0]->Order())
+        batchable = false;
+
+    if (!batchable)
+      {
+        BilinearFormIntegrator::CalcElementMatrixAddBatch (fels, trafos, elmats, lh);
+        return;
+      }
+    
+    static Timer t("SymbolicBFI::CalcElementMatrixAddBatch", 2);
+    static Timer tmult("SymbolicBFI::CalcElementMatrixAddBatch mult", 2);
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    try
+      {
+        HeapReset hr(lh);
+        const FiniteElement & fel = *fels[0];
+        const SIMD_IntegrationRule& ir = Get_SIMD_IntegrationRule (fel, lh);
+        size_t nip = ir.Size();
+        
+        Array<SIMD_BaseMappedIntegrationRule*> mirs(nel, lh);
+        for (size_t e = 0; e < nel; e++)
+          mirs[e] = &(*trafos[e])(ir, lh);
+
+        ProxyUserData ud;
+        for (auto trafo : trafos)
+          const_cast<ElementTransformation*>(trafo)->userdata = &ud;
+        
+        int k1nr = 0;
+        for (auto proxy1 : trial_proxies)
+          {
+            int l1 = 0;
+            int l1nr = 0;
+            for (auto proxy2 : test_proxies)
+              {
+                size_t tt_pair = l1nr*trial_proxies.Size()+k1nr;
+                if (nonzeros_proxies(tt_pair))
+                  {
+                    HeapReset hr(lh);
+                    size_t dim_proxy1 = proxy1->Dimension();
+                    size_t dim_proxy2 = proxy2->Dimension();
+                    bool is_diagonal = diagonal_proxies(tt_pair);
+                    bool samediffop = same_diffops(tt_pair);
+                    int k1 = trial_cum[k1nr];
+                    
+                    IntRange r1 = proxy1->Evaluator()->UsedDofs(fel);
+                    IntRange r2 = proxy2->Evaluator()->UsedDofs(fel);
+                    size_t n1 = r1.Size(), n2 = r2.Size();
+                    size_t nq = dim_proxy2*nip*SW;   // scalar columns of B and DB
+
+                    // element e of the batch is lane e:
+                    // packed_b(k*n2+i, e) = B_e(i,k), packed_db(k*n1+j, e) = DB_e(j,k)
+                    FlatMatrix<double> packed_b(nq*n2, SW, lh);
+                    FlatMatrix<double> packed_db(nq*n1, SW, lh);
+                    FlatMatrix<SIMD<double>> sum(n2, n1, lh);
+
+                    for (size_t first = 0; first < nel; first += SW)
+                      {
+                        size_t nb = min(SW, nel-first);
+                        packed_b = 0.0;
+                        packed_db = 0.0;
+                        
+                        for (size_t le = 0; le < nb; le++)
+                          {
+                            HeapReset hre(lh);
+                            auto & mir = *mirs[first+le];
+                            FlatMatrix<double> elmat = elmats[first+le];
+                            
+                            FlatMatrix<SIMD<double>> proxyvalues(dim_proxy1*dim_proxy2, nip, lh);
+                            FlatMatrix<SIMD<double>> diagproxyvalues(dim_proxy1, nip, lh);
+                            ud.trialfunction = proxy1;
+                            ud.testfunction = proxy2;
+                            if (!is_diagonal)
+                              for (size_t k = 0, kk = 0; k < dim_proxy1; k++)
+                                for (size_t l = 0; l < dim_proxy2; l++, kk++)
+                                  if (nonzeros(l1+l, k1+k))
+                                    {
+                                      ud.trial_comp = k;
+                                      ud.test_comp = l;
+                                      cf -> Evaluate (mir, proxyvalues.Rows(kk,kk+1));
+                                    }
+                            else
+                              for (size_t k = 0; k < dim_proxy1; k++)
+                                {
+                                  ud.trial_comp = k;
+                                  ud.test_comp = k;
+                                  cf -> Evaluate (mir, diagproxyvalues.Rows(k,k+1));
+                                }
+                            
+                            FlatVector<SIMD<double>> weights(nip, lh);
+                            for (size_t i = 0; i < nip; i++)
+                              weights(i) = mir[i].GetWeight();
+                            
+                            FlatMatrix<SIMD<double>> bbmat1(elmat.Width()*dim_proxy1, nip, lh);
+                            FlatMatrix<SIMD<double>> bdbmat1(elmat.Width()*dim_proxy2, nip, lh);
+                            FlatMatrix<SIMD<double>> bbmat2 = samediffop ?
+                              bbmat1 : FlatMatrix<SIMD<double>>(elmat.Height()*dim_proxy2, nip, lh);
+                            FlatMatrix<SIMD<double>> hbdbmat1(elmat.Width(), dim_proxy2*nip, &bdbmat1(0,0));
+                            FlatMatrix<SIMD<double>> hbbmat2(elmat.Height(), dim_proxy2*nip, &bbmat2(0,0));
+
+                            proxy1->Evaluator()->CalcMatrix(fel, mir, bbmat1);
+                            if (!samediffop)
+                              proxy2->Evaluator()->CalcMatrix(fel, mir, bbmat2);
+
+                            bool fixed = !is_diagonal &&
+                              ContractProxiesFixed (dim_proxy1, dim_proxy2, proxyvalues, weights,
+                                                    [&] (int j, int k) { return bool(nonzeros(l1+j, k1+k)); },
+                                                    bbmat1, bdbmat1, r1, lh);
+                            if (!fixed)
+                              {
+                                hbdbmat1.Rows(r1) = 0.0;
+                                for (size_t j = 0; j < dim_proxy2; j++)
+                                  for (size_t k = 0; k < dim_proxy1; k++)
+                                    if (is_diagonal ? (j == k) : bool(nonzeros(l1+j, k1+k)))
+                                      {
+                                        auto proxyvalues_jk = is_diagonal ?
+                                          diagproxyvalues.Row(k) : proxyvalues.Row(k*dim_proxy2+j);
+                                        auto bbmat1_k = bbmat1.RowSlice(k, dim_proxy1).Rows(r1);
+                                        auto bdbmat1_j = bdbmat1.RowSlice(j, dim_proxy2).Rows(r1);
+                                        
+                                        for (size_t i = 0; i < nip; i++)
+                                          bdbmat1_j.Col(i).Range(0,n1) += proxyvalues_jk(i)*weights(i) * bbmat1_k.Col(i);
+                                      }
+                              }
+
+                            for (size_t k = 0; k < dim_proxy2*nip; k++)
+                              for (size_t l = 0; l < SW; l++)
+                                {
+                                  size_t kl = k*SW+l;
+                                  for (size_t i = 0; i < n2; i++)
+                                    packed_b(kl*n2+i, le) = hbbmat2(r2.First()+i, k)[l];
+                                  for (size_t j = 0; j < n1; j++)
+                                    packed_db(kl*n1+j, le) = hbdbmat1(r1.First()+j, k)[l];
+                                }
+                          }
+                        
+                        {
+                          ThreadRegionTimer regmult(tmult, TaskManager::GetThreadId());
+                          NgProfiler::AddThreadFlops (tmult, TaskManager::GetThreadId(), 2*SW*nq*n1*n2);
+                          Roofline::AddThreadBytes (tmult, TaskManager::GetThreadId(),
+                                                    sizeof(double) * SW * (nq*(n1+n2) + n1*n2));
+                          sum = 0.0;
+                          for (size_t k = 0; k < nq; k++)
+                            for (size_t i = 0; i < n2; i++)
+                              {
+                                SIMD<double> bi(&packed_b(k*n2+i, 0));
+                                for (size_t j = 0; j < n1; j++)
+                                  sum(i,j) += bi * SIMD<double>(&packed_db(k*n1+j, 0));
+                              }
+                        }
+                        
+                        for (size_t le = 0; le < nb; le++)
+                          {
+                            auto part_elmat = elmats[first+le].Rows(r2).Cols(r1);
+                            for (size_t i = 0; i < n2; i++)
+                              for (size_t j = 0; j < n1; j++)
+                                part_elmat(i,j) += sum(i,j)[le];
+                          }
+                      }
+                  }
+                l1 += proxy2->Dimension();
+                l1nr++;
+              }
+            k1nr++;
+          }
+      }
+    catch (ExceptionNOSIMD e)
+      {
+        CountNoSIMDFallback (e);
+        cout << IM(6) << e.What() << endl
+             << "switching to scalar evaluation" << endl;
+        simd_evaluate = false;
+        throw ExceptionNOSIMD("in CalcElementMatrixAddBatch");
+      }
+  }
+
 
   
 
@@ -1839,7 +2583,7 @@ namespace ngfem
                   SIMD_IntegrationRule & ir_facet(userdefined_simd_intrules[etfacet] ?
                                                   *userdefined_simd_intrules[etfacet]
                                                   : ir_facet1);
-                  auto & ir_facet_vol = transform(k, ir_facet, lh);
+                  auto & ir_facet_vol = GetSIMDFacetVolumeRule(transform, k, fel_trial.Order()+fel_test.Order()+bonus_intorder, lh);
                   
                   auto & mir = trafo(ir_facet_vol, lh);
           
@@ -1962,6 +2706,7 @@ namespace ngfem
           
           catch (ExceptionNOSIMD e)
             {
+              CountNoSIMDFallback (e);
               cout << IM(6) << e.What() << endl
                    << "switching to scalar evaluation, may be a problem with Add" << endl;
               simd_evaluate = false;
@@ -2221,6 +2966,7 @@ namespace ngfem
         }
       catch (ExceptionNOSIMD e)
         {
+          CountNoSIMDFallback (e);
           cout << IM(6) << e.What() << endl
                << "switching to scalar evaluation in CalcLinearized" << endl;
           simd_evaluate = false;
@@ -2342,7 +3088,7 @@ namespace ngfem
               ngfem::ELEMENT_TYPE etfacet = transform.FacetType (k);
               // NgProfiler::StartThreadTimer(tir, tid);
               const SIMD_IntegrationRule& ir_facet = GetSIMDIntegrationRule(etfacet, 2*fel.Order()+bonus_intorder);
-              const SIMD_IntegrationRule & ir_facet_vol = transform(k, ir_facet, lh);
+              const SIMD_IntegrationRule & ir_facet_vol = GetSIMDFacetVolumeRule(transform, k, 2*fel.Order()+bonus_intorder, lh);
               SIMD_BaseMappedIntegrationRule & mir = trafo(ir_facet_vol, lh);
               mir.ComputeNormalsAndMeasure(eltype, k);
               // NgProfiler::StopThreadTimer(tir, tid);
@@ -2425,6 +3171,7 @@ namespace ngfem
         }
       catch (ExceptionNOSIMD e)
         {
+          CountNoSIMDFallback (e);
           cout << IM(6) << e.What() << endl
                << "switching to scalar evaluation in CalcLinearizedEB" << endl;
           simd_evaluate = false;
@@ -2603,6 +3350,7 @@ namespace ngfem
     
       catch (ExceptionNOSIMD e)
         {
+          CountNoSIMDFallback (e);
           cout << IM(6) << e.What() << endl
                << "switching to scalar evaluation" << endl;
           simd_evaluate = false;
@@ -2699,7 +3447,7 @@ namespace ngfem
               ngfem::ELEMENT_TYPE etfacet = transform.FacetType (k);
               const SIMD_IntegrationRule & ir_facet =
                 GetSIMDIntegrationRule(etfacet,fel_trial.Order()+fel_test.Order()+bonus_intorder);
-              auto & ir_facet_vol = transform(k, ir_facet, lh);
+              auto & ir_facet_vol = GetSIMDFacetVolumeRule(transform, k, fel_trial.Order()+fel_test.Order()+bonus_intorder, lh);
               auto & mir = trafo(ir_facet_vol, lh);
               mir.ComputeNormalsAndMeasure (eltype, k);
               // NgProfiler::StopThreadTimer(tir, tid);
@@ -2747,6 +3495,7 @@ namespace ngfem
         }
       catch (ExceptionNOSIMD e)
         {
+          CountNoSIMDFallback (e);
           cout << IM(6) << e.What() << endl
                << "switching to scalar evaluation" << endl;
           simd_evaluate = false;
@@ -2835,13 +3584,61 @@ namespace ngfem
 
     elvec = 0;
     
-    FlatVector<> elvec1(elvec.Size(), lh);
-
     int maxorder = fel1.Order();
 
     auto eltype1 = trafo1.GetElementType();
     auto etfacet = ElementTopology::GetFacetType (eltype1, LocalFacetNr);
 
+    if (simd_evaluate)
+      {
+        try
+          {
+            RegionTimer reg(t);
+            const SIMD_IntegrationRule & simd_ir_facet = GetSIMDIntegrationRule(etfacet, 2*maxorder+bonus_intorder);
+            Facet2ElementTrafo transform1(eltype1, ElVertices); 
+            auto & simd_ir_facet_vol1 = transform1(LocalFacetNr, simd_ir_facet, lh);
+            auto & simd_mir1 = trafo1(simd_ir_facet_vol1, lh);
+            auto & simd_smir = strafo(simd_ir_facet, lh);
+            
+            simd_mir1.SetOtherMIR (&simd_smir);
+            simd_smir.SetOtherMIR (&simd_mir1);
+            
+            ProxyUserData ud;
+            const_cast<ElementTransformation&>(trafo1).userdata = &ud;
+            const_cast<ElementTransformation&>(strafo).userdata = &ud;
+            
+            simd_mir1.ComputeNormalsAndMeasure (eltype1, LocalFacetNr);
+            
+            for (auto proxy : proxies)
+              {
+                HeapReset hr(lh);
+                FlatMatrix<SIMD<double>> proxyvalues(proxy->Dimension(), simd_ir_facet.Size(), lh);
+                for (size_t k = 0; k < proxy->Dimension(); k++)
+                  {
+                    ud.testfunction = proxy;
+                    ud.test_comp = k;
+                    cf -> Evaluate (simd_mir1, proxyvalues.Rows(k,k+1));
+                  }
+                
+                for (size_t i = 0; i < simd_mir1.Size(); i++)
+                  proxyvalues.Col(i) *= simd_mir1[i].GetMeasure() * simd_ir_facet[i].Weight();
+                
+                proxy->Evaluator()->AddTrans(fel1, simd_mir1, proxyvalues, elvec);
+              }
+            return;
+          }
+        catch (ExceptionNOSIMD e)
+          {
+            CountNoSIMDFallback (e);
+            cout << IM(6) << e.What() << endl
+                 << "switching back to standard evaluation" << endl;
+            simd_evaluate = false;
+            elvec = 0;
+          }
+      }
+    
+    FlatVector<> elvec1(elvec.Size(), lh);
+
     const IntegrationRule & ir_facet = GetIntegrationRule(etfacet, 2*maxorder+bonus_intorder);
     Facet2ElementTrafo transform1(eltype1, ElVertices); 
     IntegrationRule & ir_facet_vol1 = transform1(LocalFacetNr, ir_facet, lh);
@@ -3356,6 +4153,7 @@ namespace ngfem
           }
         catch (ExceptionNOSIMD e)
           {
+            CountNoSIMDFallback (e);
             cout << IM(6) << "caught in SymbolicFacetInegtrator::Apply: " << endl
                  << e.What() << endl;
             simd_evaluate = false;
@@ -3532,6 +4330,7 @@ namespace ngfem
 	  }
         catch (ExceptionNOSIMD e)
           {
+            CountNoSIMDFallback (e);
             cout << IM(6) << "caught in SymbolicFacetInegtrator::CalcTraceValues: " << endl
                  << e.What() << endl;
             simd_evaluate = false;
@@ -3663,6 +4462,7 @@ namespace ngfem
 	  }
         catch (ExceptionNOSIMD e)
           {
+            CountNoSIMDFallback (e);
             cout << IM(6) << "caught in SymbolicFacetInegtrator::CalcTraceValues: " << endl
                  << e.What() << endl;
             simd_evaluate = false;
@@ -3822,6 +4622,7 @@ namespace ngfem
           }
         catch (ExceptionNOSIMD e)
           {
+            CountNoSIMDFallback (e);
             cout << IM(6) << "caught in SymbolicFacetInegtrator::ApplyBnd: " << endl
                  << e.What() << endl;
             simd_evaluate = false;
@@ -4074,7 +4875,7 @@ namespace ngfem
                     ngfem::ELEMENT_TYPE etfacet = transform.FacetType (k);
                     
                     auto & ir_facet = GetSIMDIntegrationRule(etfacet, 2*fel.Order()+bonus_intorder);
-                    auto & ir_facet_vol = transform(k, ir_facet, lh);
+                    auto & ir_facet_vol = GetSIMDFacetVolumeRule(transform, k, 2*fel.Order()+bonus_intorder, lh);
                     auto & mir = trafo(ir_facet_vol, lh);
                     mir.ComputeNormalsAndMeasure (eltype, k);
             
@@ -4094,6 +4895,7 @@ namespace ngfem
 
         catch (ExceptionNOSIMD e)
           {
+            CountNoSIMDFallback (e);
             cout << IM(6) << e.What() << endl
                  << "switching back to standard evaluation (in SymbolicEnergy::CalcLinearized)" << endl;
             simd_evaluate = false;
@@ -4318,6 +5120,21 @@ namespace ngfem
                   diags[k1] = 0.0;
               }
 
+            // B-matrices are computed once per proxy, and shared by all proxy pairs
+            FlatArray<FlatMatrix<SIMD<double>>> bmats(trial_proxies.Size(), lh);
+            {
+              ThreadRegionTimer reg(tbmat, tid);
+              for (int k1 : Range(trial_proxies))
+                {
+                  bool used = false;
+                  for (int l1 : Range(trial_proxies))
+                    used |= nonzeros_proxies(k1,l1) || nonzeros_proxies(l1,k1);
+                  if (!used) continue;
+                  new(&bmats[k1]) FlatMatrix<SIMD<double>>(elmat.Width()*trial_proxies[k1]->Dimension(), mir.Size(), lh);
+                  trial_proxies[k1]->Evaluator()->CalcMatrix(fel, mir, bmats[k1]);
+                }
+            }
+            
             for (int k1 : Range(trial_proxies))
               for (int l1 : Range(trial_proxies))
                 {
@@ -4331,9 +5148,12 @@ namespace ngfem
                   size_t dim_proxy2 = proxy2->Dimension();
 
                   FlatMatrix<SIMD<double>> proxyvalues2(dim_proxy1*dim_proxy2, mir.Size(), lh);
+                  FlatArray<bool> nzrow(dim_proxy1*dim_proxy2, lh);
 
                   {
                   ThreadRegionTimer reg(tdmat, tid);
+                  // the proxy values written by the coefficient function
+                  Roofline::AddThreadBytes (tdmat, tid, sizeof(SIMD<double>) * proxyvalues2.Height()*proxyvalues2.Width());
                   for (int k = 0; k < dim_proxy1; k++)
                     for (int l = 0; l < dim_proxy2; l++)
                       {
@@ -4342,6 +5162,7 @@ namespace ngfem
                         ud.testfunction = proxy2;
                         ud.test_comp = l;
                         auto proxyrow = proxyvalues2.Row(k*dim_proxy2+l);
+                        nzrow[k*dim_proxy2+l] = nonzeros(trial_cum[k1]+k, trial_cum[l1]+l);
 
                         if (nonzeros(trial_cum[k1]+k, trial_cum[l1]+l))
                           {
@@ -4379,24 +5200,20 @@ namespace ngfem
                   IntRange r2 = proxy2->Evaluator()->UsedDofs(fel);
                   SliceMatrix<> part_elmat = elmat.Rows(r2).Cols(r1);
 
-                  FlatMatrix<SIMD<double>> bmat1(elmat.Width()*dim_proxy1, mir.Size(), lh);
+                  FlatMatrix<SIMD<double>> bmat1 = bmats[k1];
+                  FlatMatrix<SIMD<double>> bmat2 = bmats[l1];
                   FlatMatrix<SIMD<double>> dbmat1(elmat.Width()*dim_proxy2, mir.Size(), lh);
-                  FlatMatrix<SIMD<double>> bmat2(elmat.Height()*dim_proxy2, mir.Size(), lh);
 
                   FlatMatrix<SIMD<double>> hdbmat1(elmat.Width(), dim_proxy2*mir.Size(), &dbmat1(0,0));
                   FlatMatrix<SIMD<double>> hbmat2(elmat.Height(), dim_proxy2*mir.Size(), &bmat2(0,0));
 
-                  {
-                    ThreadRegionTimer reg(tbmat, tid);
-                    proxy1->Evaluator()->CalcMatrix(fel, mir, bmat1);
-                    proxy2->Evaluator()->CalcMatrix(fel, mir, bmat2);
-                  }
-
+                  // structurally zero second derivatives are skipped
                   hdbmat1.Rows(r1) = 0.0; 
                   for (auto i : r1)
                     for (size_t j = 0; j < dim_proxy2; j++)
                       for (size_t k = 0; k < dim_proxy1; k++)
                         {
+                          if (!nzrow[k*dim_proxy2+j]) continue;
                           auto res = dbmat1.Row(i*dim_proxy2+j);
                           auto a = bmat1.Row(i*dim_proxy1+k);
                           auto b = proxyvalues2.Row(k*dim_proxy2+j);
@@ -4404,11 +5221,22 @@ namespace ngfem
                         }
 
                   {
-                  ThreadRegionTimer reg(tmult, tid);                  
-                  AddABt (hbmat2.Rows(r2), hdbmat1.Rows(r1), part_elmat);
-                  if (k1 > l1)
-                    AddABt (hdbmat1.Rows(r1), hbmat2.Rows(r2), elmat.Rows(r1).Cols(r2));
-                    // elmat.Rows(r1).Cols(r2) = Trans(part_elmat); // buggy if both evaluators act on same element
+                  ThreadRegionTimer reg(tmult, tid);
+                  if (k1 == l1)
+                    {
+                      // same proxy: the block is symmetric, compute the lower half only
+                      FlatMatrix<> symmat(r1.Size(), r1.Size(), lh);
+                      symmat = 0.0;
+                      AddABtSym (hbmat2.Rows(r2), hdbmat1.Rows(r1), symmat);
+                      ExtendSymmetric (SliceMatrix<>(symmat));
+                      part_elmat += symmat;
+                    }
+                  else
+                    {
+                      AddABt (hbmat2.Rows(r2), hdbmat1.Rows(r1), part_elmat);
+                      AddABt (hdbmat1.Rows(r1), hbmat2.Rows(r2), elmat.Rows(r1).Cols(r2));
+                      // elmat.Rows(r1).Cols(r2) = Trans(part_elmat); // buggy if both evaluators act on same element
+                    }
                   }
                 }
   }
@@ -4446,6 +5274,7 @@ namespace ngfem
           }
         catch (ExceptionNOSIMD e)
           {
+            CountNoSIMDFallback (e);
             cout << IM(6) << e.What() << endl
                  << "switching back to standard evaluation (in SymbolicEnergy::Energy)" << endl;
             simd_evaluate = false;
@@ -4579,7 +5408,7 @@ namespace ngfem
                     ngfem::ELEMENT_TYPE etfacet = transform.FacetType (k);
 
                     auto & ir_facet = GetSIMDIntegrationRule(etfacet, 2*fel.Order()+bonus_intorder);
-                    auto & ir_facet_vol = transform(k, ir_facet, lh);
+                    auto & ir_facet_vol = GetSIMDFacetVolumeRule(transform, k, 2*fel.Order()+bonus_intorder, lh);
                     auto & mir = trafo(ir_facet_vol, lh);
                     mir.ComputeNormalsAndMeasure (eltype, k);
 
@@ -4616,6 +5445,7 @@ namespace ngfem
           }
         catch (ExceptionNOSIMD e)
           {
+            CountNoSIMDFallback (e);
             cout << IM(6) << e.What() << endl
                  << "switching back to standard evaluation (in SymbolicEnergy::CalcLinearized)" << endl;              
             simd_evaluate = false;
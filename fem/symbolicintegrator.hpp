@@ -271,6 +271,14 @@ public:
   const FiniteElement * fel = nullptr;
   // const FlatVector<double> * elx;
   // LocalHeap * lh;
+  /// new for every ProxyUserData of a thread, identifies the evaluation of one element
+  size_t generation = NextGeneration();
+
+  static size_t NextGeneration ()
+  {
+    static thread_local size_t cnt = 0;
+    return ++cnt;
+  }
 
   ProxyUserData ()
     : remember_first(0,nullptr), remember_second(0,nullptr), remember_asecond(0,nullptr),
@@ -611,6 +619,12 @@ public:
     virtual VorB VB() const override { return vb; }
     virtual string Name () const override { return string ("Symbolic LFI"); }
     virtual int GetDimension() const override { return proxies[0]->Evaluator()->BlockDim(); }
+    virtual int ProxyDimension () const override
+    {
+      int dim = 0;
+      for (auto proxy : proxies) dim += proxy->Dimension();
+      return dim;
+    }
 
     virtual void 
     CalcElementVector (const FiniteElement & fel,
@@ -633,6 +647,10 @@ public:
 
 
 
+  /// contract reference element matrices for constant coefficients on affine elements (default)
+  NGS_DLL_HEADER void SetReferenceElementMatrices (bool enable);
+  NGS_DLL_HEADER bool GetReferenceElementMatrices ();
+
   class SymbolicBilinearFormIntegrator : public BilinearFormIntegrator
   {
   protected:
@@ -652,6 +670,7 @@ public:
 
     int trial_difforder, test_difforder;
     bool is_symmetric;
+    mutable bool reference_matrices = true;  // false once the coefficient was not element-wise constant
   public:
     NGS_DLL_HEADER SymbolicBilinearFormIntegrator (shared_ptr<CoefficientFunction> acf, VorB avb,
                                                    VorB aelement_boundary);
@@ -668,6 +687,7 @@ public:
     // virtual SIMD_IntegrationRule Get_SIMD_IntegrationRuleEB (const FiniteElement & fel, int facetnr, LocalHeap & lh) const;
     
     virtual int GetDimension() const override { return trial_proxies[0]->Evaluator()->BlockDim(); }
+    virtual int ProxyDimension () const override { return max2 (trial_cum.Last(), test_cum.Last()); }
 
     NGS_DLL_HEADER virtual void 
     CalcElementMatrix (const FiniteElement & fel,
@@ -693,6 +713,14 @@ public:
                           FlatMatrix<Complex> elmat,
                           LocalHeap & lh) const override;    
 
+    using BilinearFormIntegrator::CalcElementMatrixAddBatch;
+    /// elements in SIMD lanes
+    NGS_DLL_HEADER virtual void 
+    CalcElementMatrixAddBatch (FlatArray<const FiniteElement*> fels,
+                               FlatArray<const ElementTransformation*> trafos,
+                               FlatArray<FlatMatrix<double>> elmats,
+                               LocalHeap & lh) const override;
+
     
     template <typename SCAL, typename SCAL_SHAPES, typename SCAL_RES>
     void T_CalcElementMatrixAdd (const FiniteElement & fel,
@@ -705,6 +733,44 @@ public:
                                    const ElementTransformation & trafo, 
                                    FlatMatrix<SCAL_RES> elmat,
                                    LocalHeap & lh) const;
+
+    /// constant coefficients on affine elements: add contraction of reference element matrices
+    bool AddReferenceElementMatrix (const FiniteElement & fel,
+                                    const SIMD_BaseMappedIntegrationRule & mir,
+                                    ProxyFunction * proxy1, ProxyFunction * proxy2,
+                                    int k1, int l1, ProxyUserData & ud,
+                                    FlatMatrix<double> elmat, LocalHeap & lh) const;
+    /// the constant proxy coefficients of the element, dmat(k,l) for trial component k, test component l
+    bool ConstantProxyCoefficient (const SIMD_BaseMappedIntegrationRule & mir,
+                                   ProxyFunction * proxy1, ProxyFunction * proxy2,
+                                   int k1, int l1, ProxyUserData & ud,
+                                   FlatMatrix<double> dmat, LocalHeap & lh) const;
+
+    /// an interacting proxy pair with constant coefficient on an affine element
+    struct ReferenceTerm
+    {
+      int type1, type2;                       // 0 .. values, 1 .. gradients
+      const Matrix<double> * mats = nullptr;  // reference element matrices, block b*n1+a
+      Matrix<double> dmat;                    // trial component x test component
+    };
+    /**
+       The affine Jacobian and the reference terms of all proxy pairs, the
+       element matrix is
+         sum_terms |det J| sum_ab (T1^T dmat T2)_ab R^{ab}
+       with T = 1 for values and J^{-T} for gradients. Used by the assembly
+       on the device. False if the element, the differential operators or
+       the coefficient are not supported.
+    */
+    NGS_DLL_HEADER bool GetReferenceTerms (const FiniteElement & fel, const ElementTransformation & trafo,
+                                           FlatMatrix<double> jac, Array<ReferenceTerm> & terms,
+                                           LocalHeap & lh) const;
+    template <int D>
+    bool T_AddReferenceElementMatrix (const BaseScalarFiniteElement & fel, int classnr,
+                                      const SIMD_BaseMappedIntegrationRule & mir,
+                                      ProxyFunction * proxy1, ProxyFunction * proxy2,
+                                      int type1, int type2,
+                                      int k1, int l1, ProxyUserData & ud,
+                                      FlatMatrix<double> elmat, LocalHeap & lh) const;
     
     NGS_DLL_HEADER virtual void 
     CalcLinearizedElementMatrix (const FiniteElement & fel,
@@ -783,6 +849,7 @@ public:
     bool neighbor_testfunction;
   public:
     NGS_DLL_HEADER SymbolicFacetBilinearFormIntegrator (shared_ptr<CoefficientFunction> acf, VorB avb, bool aelement_boundary);
+    const auto & GetCoefficientFunction() { return cf; }
 
     virtual VorB VB() const { return vb; }
     virtual bool BoundaryForm() const { return vb == BND; }
@@ -911,7 +978,13 @@ public:
 			void * precomputed,
 			LocalHeap & lh) const;
   };
-  
+
+
+  /// counts a fall-back from SIMD to scalar evaluation, by the message of the exception
+  NGS_DLL_HEADER void CountNoSIMDFallback (const ExceptionNOSIMD & e);
+  /// the messages and how often they caused a fall-back
+  NGS_DLL_HEADER std::map<string, size_t> GetNoSIMDFallbacks ();
+  NGS_DLL_HEADER void ResetNoSIMDFallbacks ();
 
 }
 
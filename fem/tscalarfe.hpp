@@ -7,6 +7,8 @@
 /* Date:   25. Mar. 2000                                             */
 /*********************************************************************/
 
+#include "precomp.hpp"
+
 namespace ngfem
 {
 
@@ -33,6 +35,13 @@ namespace ngfem
     // virtual ~T_ScalarFiniteElement() { ; }
 
     HD virtual ELEMENT_TYPE ElementType() const final { return ET; }
+
+    /// shapes depend only on order and this class number (-1 if not), used to share precomputed shapes
+    INLINE int ShapeClassNr () const { return -1; }
+    /// shapes are products of trig and z factors on prisms, see H1HighOrderFE_Shape<ET_PRISM>
+    static constexpr bool PRISM_FACTORS = false;
+    virtual int GetShapeClassNr () const override
+    { return static_cast<const FEL*> (this) -> ShapeClassNr(); }
     // HD NGS_DLL_HEADER virtual int Dim () const override { return DIM; } 
 
     
@@ -95,6 +104,11 @@ namespace ngfem
                                                  BareSliceVector<> coefs,
                                                  BareSliceMatrix<SIMD<double>> values) const override;
 
+    HD NGS_DLL_HEADER virtual void EvaluateValueGrad (const SIMD_IntegrationRule & ir,
+                                                      SliceMatrix<> coefs,
+                                                      BareSliceMatrix<SIMD<double>> values,
+                                                      BareSliceMatrix<SIMD<double>> grads) const override;
+
     HD NGS_DLL_HEADER virtual void EvaluateGradTrans (const IntegrationRule & ir, 
                                                       FlatMatrixFixWidth<DIM> vals, 
                                                       BareSliceVector<double> coefs) const override;
@@ -155,6 +169,9 @@ namespace ngfem
       static_cast<const FEL*> (this) -> T_CalcShape (ip, shape);
     }
 
+    /// shapes and reference gradients at ir, shared by elements of the same class, or nullptr
+    const PrecomputedSIMDShapes * GetPrecomputedShapes (const SIMD_IntegrationRule & ir) const;
+
     void CalcDualShape2 (const BaseMappedIntegrationPoint & mip, SliceVector<> shape) const
     {
       throw Exception (string("dual shape not implemented for element ")+typeid(*this).name()); 
@@ -10,6 +10,51 @@
 namespace ngfem
 {
 
+  /*
+    Sum factorization on prisms. The tensor product rule has the trig
+    points ir.GetIRX() as inner and the z points ir.GetIRZ() as outer
+    loop. The shapes are products tfac_i(x,y) zfac_zind[i](z), the
+    coefficients of the same z-factor are summed on the trig points
+    first, which costs O(ndof nt + nzf nt nz) instead of O(ndof nt nz).
+  */
+  template <class FEL>
+  INLINE void CalcPrismFactors (const FEL & fel,
+                                const SIMD_IntegrationRule & irt, const SIMD_IntegrationRule & irz,
+                                FlatMatrix<SIMD<double>> tfac, FlatMatrix<SIMD<double>> zfac)
+  {
+    for (size_t k = 0; k < irt.Size(); k++)
+      fel.T_CalcTrigFactors (GetTIP<2>(irt[k]),
+                             SBLambda ([&] (size_t i, SIMD<double> val) { tfac(i,k) = val; }));
+    for (size_t k = 0; k < irz.Size(); k++)
+      fel.T_CalcZFactors (irz[k](0),
+                          SBLambda ([&] (size_t i, SIMD<double> val) { zfac(i,k) = val; }));
+  }
+
+  /// factors and their derivatives, tfac and zfac have 3 and 2 blocks of rows
+  template <class FEL>
+  INLINE void CalcPrismFactorsGrad (const FEL & fel,
+                                    const SIMD_IntegrationRule & irt, const SIMD_IntegrationRule & irz,
+                                    FlatMatrix<SIMD<double>> tfac, FlatMatrix<SIMD<double>> zfac)
+  {
+    size_t ndof = tfac.Height()/3, nzf = zfac.Height()/2;
+    for (size_t k = 0; k < irt.Size(); k++)
+      fel.T_CalcTrigFactors (GetTIPGrad<2>(irt[k]),
+                             SBLambda ([&] (size_t i, AutoDiff<2,SIMD<double>> val)
+                                       {
+                                         tfac(i,k) = val.Value();
+                                         tfac(ndof+i,k) = val.DValue(0);
+                                         tfac(2*ndof+i,k) = val.DValue(1);
+                                       }));
+    for (size_t k = 0; k < irz.Size(); k++)
+      fel.T_CalcZFactors (AutoDiff<1,SIMD<double>> (irz[k](0), 0),
+                          SBLambda ([&] (size_t i, AutoDiff<1,SIMD<double>> val)
+                                    {
+                                      zfac(i,k) = val.Value();
+                                      zfac(nzf+i,k) = val.DValue(0);
+                                    }));
+  }
+
+
   template <class FEL, ELEMENT_TYPE ET, class BASE>
   void T_ScalarFiniteElement<FEL,ET,BASE> :: 
   CalcShape (const IntegrationPoint & ip, BareSliceVector<> shape) const
@@ -29,6 +74,46 @@ namespace ngfem
 
 #ifndef FASTCOMPILE
 
+  template <class FEL, ELEMENT_TYPE ET, class BASE>
+  const PrecomputedSIMDShapes * T_ScalarFiniteElement<FEL,ET,BASE> :: 
+  GetPrecomputedShapes (const SIMD_IntegrationRule & ir) const
+  {
+    if constexpr (DIM == 0)
+      return nullptr;
+    else
+      {
+        int classnr = static_cast<const FEL*> (this) -> ShapeClassNr();
+        if (classnr < 0) return nullptr;
+    
+        static SIMD_PrecomputedShapesContainer precomp;
+        size_t irhash = SIMD_PrecomputedShapesContainer::Hash (ir, DIM);
+        if (auto pre = precomp.Get (classnr, order, ndof, irhash))
+          return pre;
+    
+        if (!precomp.HasSpace ((DIM+1)*ndof*ir.Size()*sizeof(SIMD<double>)))
+          return nullptr;
+    
+        static Timer t("PrecomputeSIMDShapes"); RegionTimer reg(t);
+        auto pre = new PrecomputedSIMDShapes;
+        pre->classnr = classnr;
+        pre->order = order;
+        pre->ndof = ndof;
+        pre->irhash = irhash;
+        pre->shapes.SetSize (ndof, ir.Size());
+        pre->dshapes.SetSize (DIM*ndof, ir.Size());
+        for (size_t i = 0; i < ir.Size(); i++)
+          T_CalcShape (GetTIPGrad<DIM> (ir[i]),
+                       SBLambda ([pre,i] (size_t j, auto shape)
+                                 {
+                                   pre->shapes(j,i) = shape.Value();
+                                   for (int k = 0; k < DIM; k++)
+                                     pre->dshapes(j*DIM+k,i) = shape.DValue(k);
+                                 }));
+        return precomp.Add (pre);
+      }
+  }
+
+  
   template <class FEL, ELEMENT_TYPE ET, class BASE>
   void T_ScalarFiniteElement<FEL,ET,BASE> :: 
   CalcShape (const IntegrationRule & ir, BareSliceMatrix<> shape) const
@@ -80,6 +165,54 @@ namespace ngfem
   void T_ScalarFiniteElement<FEL,ET,BASE> :: 
   Evaluate (const SIMD_IntegrationRule & ir, BareSliceVector<> coefs, BareVector<SIMD<double>> values) const
   {
+    if constexpr (FEL::PRISM_FACTORS)
+      if (ir.IsTP())
+        {
+          static Timer t("prism Evaluate - sum factorization");
+          ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+          constexpr size_t SW = SIMD<double>::Size();
+          auto & fel = static_cast<const FEL&> (*this);
+          auto & irt = ir.GetIRX();
+          auto & irz = ir.GetIRZ();
+          size_t nt = irt.GetNIP(), nz = irz.GetNIP();
+
+          STACK_ARRAY(int, memzind, ndof);
+          FlatArray<int> zind(ndof, memzind);
+          size_t nzf = fel.GetZFactorIndex (zind);
+          STACK_ARRAY(SIMD<double>, memt, ndof*irt.Size());
+          FlatMatrix<SIMD<double>> tfac(ndof, irt.Size(), memt);
+          STACK_ARRAY(SIMD<double>, memz, nzf*irz.Size());
+          FlatMatrix<SIMD<double>> zfac(nzf, irz.Size(), memz);
+          CalcPrismFactors (fel, irt, irz, tfac, zfac);
+          SliceMatrix<> ht(ndof, nt, irt.Size()*SW, &tfac(0,0)[0]);
+          SliceMatrix<> hz(nzf, nz, irz.Size()*SW, &zfac(0,0)[0]);
+
+          STACK_ARRAY(double, memsum, nzf*nt);
+          FlatMatrix<> sumt(nzf, nt, memsum);
+          sumt = 0.0;
+          for (size_t i = 0; i < ndof; i++)
+            sumt.Row(zind[i]) += coefs(i) * ht.Row(i);
+
+          values(ir.Size()-1) = 0.0;   // padding
+          FlatMatrix<> hvalues(nz, nt, &values(0)[0]);
+          hvalues = Trans(hz) * sumt;
+          return;
+        }
+
+    if (auto pre = GetPrecomputedShapes (ir))
+      {
+        for (size_t i = 0; i < ir.Size(); i++)
+          values(i) = SIMD<double>(0.0);
+        for (size_t j = 0; j < ndof; j++)
+          {
+            SIMD<double> cj = coefs(j);
+            auto shapej = pre->shapes.Row(j);
+            for (size_t i = 0; i < ir.Size(); i++)
+              values(i) = FMA(cj, shapej(i), values(i));
+          }
+        return;
+      }
+    
     FlatArray<SIMD<IntegrationPoint>> hir = ir;
     size_t i = 0;
     for ( ; i+2 <= hir.Size(); i+=2)
@@ -231,6 +364,50 @@ namespace ngfem
   AddTrans (const SIMD_IntegrationRule & ir, BareVector<SIMD<double>> values,
             BareSliceVector<> coefs) const
   {
+    if constexpr (FEL::PRISM_FACTORS)
+      if (ir.IsTP())
+        {
+          static Timer t("prism AddTrans - sum factorization");
+          ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+          constexpr size_t SW = SIMD<double>::Size();
+          auto & fel = static_cast<const FEL&> (*this);
+          auto & irt = ir.GetIRX();
+          auto & irz = ir.GetIRZ();
+          size_t nt = irt.GetNIP(), nz = irz.GetNIP();
+
+          STACK_ARRAY(int, memzind, ndof);
+          FlatArray<int> zind(ndof, memzind);
+          size_t nzf = fel.GetZFactorIndex (zind);
+          STACK_ARRAY(SIMD<double>, memt, ndof*irt.Size());
+          FlatMatrix<SIMD<double>> tfac(ndof, irt.Size(), memt);
+          STACK_ARRAY(SIMD<double>, memz, nzf*irz.Size());
+          FlatMatrix<SIMD<double>> zfac(nzf, irz.Size(), memz);
+          CalcPrismFactors (fel, irt, irz, tfac, zfac);
+          SliceMatrix<> ht(ndof, nt, irt.Size()*SW, &tfac(0,0)[0]);
+          SliceMatrix<> hz(nzf, nz, irz.Size()*SW, &zfac(0,0)[0]);
+
+          STACK_ARRAY(double, memsum, nzf*nt);
+          FlatMatrix<> sumt(nzf, nt, memsum);
+          FlatMatrix<> hvalues(nz, nt, &values(0)[0]);
+          sumt = hz * hvalues;
+          for (size_t i = 0; i < ndof; i++)
+            coefs(i) += InnerProduct (ht.Row(i), sumt.Row(zind[i]));
+          return;
+        }
+
+    if (auto pre = GetPrecomputedShapes (ir))
+      {
+        for (size_t j = 0; j < ndof; j++)
+          {
+            SIMD<double> sum = 0.0;
+            auto shapej = pre->shapes.Row(j);
+            for (size_t i = 0; i < ir.Size(); i++)
+              sum = FMA(shapej(i), values(i), sum);
+            coefs(j) += HSum(sum);
+          }
+        return;
+      }
+    
     FlatArray<SIMD<IntegrationPoint>> hir = ir;
     /*
     for (int i = 0; i < hir.Size(); i++)
@@ -484,11 +661,74 @@ namespace ngfem
                 BareSliceVector<> coefs,
                 BareSliceMatrix<SIMD<double>> values) const
   {
+    if constexpr (FEL::PRISM_FACTORS)
+      if (bmir.IR().IsTP() && bmir.DimSpace() == 3)
+        {
+          static Timer t("prism EvaluateGrad - sum factorization");
+          ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+          constexpr size_t SW = SIMD<double>::Size();
+          auto & fel = static_cast<const FEL&> (*this);
+          auto & ir = bmir.IR();
+          auto & irt = ir.GetIRX();
+          auto & irz = ir.GetIRZ();
+          size_t nt = irt.GetNIP(), nz = irz.GetNIP();
+
+          STACK_ARRAY(int, memzind, ndof);
+          FlatArray<int> zind(ndof, memzind);
+          size_t nzf = fel.GetZFactorIndex (zind);
+          STACK_ARRAY(SIMD<double>, memt, 3*ndof*irt.Size());
+          FlatMatrix<SIMD<double>> tfac(3*ndof, irt.Size(), memt);
+          STACK_ARRAY(SIMD<double>, memz, 2*nzf*irz.Size());
+          FlatMatrix<SIMD<double>> zfac(2*nzf, irz.Size(), memz);
+          CalcPrismFactorsGrad (fel, irt, irz, tfac, zfac);
+          SliceMatrix<> ht(3*ndof, nt, irt.Size()*SW, &tfac(0,0)[0]);
+          SliceMatrix<> hz(2*nzf, nz, irz.Size()*SW, &zfac(0,0)[0]);
+
+          // value, x- and y-derivative of the trig factors summed per z-factor
+          STACK_ARRAY(double, memsum, 3*nzf*nt);
+          FlatMatrix<> sumt(3*nzf, nt, memsum);
+          sumt = 0.0;
+          for (size_t i = 0; i < ndof; i++)
+            for (size_t k = 0; k < 3; k++)
+              sumt.Row(k*nzf+zind[i]) += coefs(i) * ht.Row(k*ndof+i);
+
+          for (size_t k = 0; k < 3; k++)
+            values(k, ir.Size()-1) = 0.0;   // padding
+          FlatMatrix<> gradx(nz, nt, &values(0,0)[0]);
+          FlatMatrix<> grady(nz, nt, &values(1,0)[0]);
+          FlatMatrix<> gradz(nz, nt, &values(2,0)[0]);
+          gradx = Trans(hz.Rows(0,nzf)) * sumt.Rows(nzf, 2*nzf);
+          grady = Trans(hz.Rows(0,nzf)) * sumt.Rows(2*nzf, 3*nzf);
+          gradz = Trans(hz.Rows(nzf,2*nzf)) * sumt.Rows(0, nzf);
+          bmir.TransformGradient (values);
+          return;
+        }
+    
     Switch<4-DIM>
       (bmir.DimSpace()-DIM, [this,&bmir,coefs,values] (auto CODIM)
        {
          constexpr int DIMSPACE = DIM+CODIM.value;         
          auto & mir = static_cast<const SIMD_MappedIntegrationRule<DIM,DIMSPACE>&> (bmir);
+
+         if constexpr (DIM > 0)
+         if (auto pre = this->GetPrecomputedShapes (mir.IR()))
+           {
+             // reference gradient, mapped with the inverse Jacobian
+             for (size_t i = 0; i < mir.Size(); i++)
+               {
+                 Vec<DIM,SIMD<double>> sum(0.0);
+                 auto dshapes = pre->dshapes.Col(i);
+                 for (size_t j = 0; j < this->ndof; j++)
+                   {
+                     SIMD<double> cj = coefs(j);
+                     for (int k = 0; k < DIM; k++)
+                       sum(k) = FMA(cj, dshapes(j*DIM+k), sum(k));
+                   }
+                 values.Col(i).Range(DIMSPACE) = Trans(mir[i].GetJacobianInverse()) * sum;
+               }
+             return;
+           }
+         
          for (size_t i = 0; i < mir.Size(); i++)
            {
              double *pcoefs = &coefs(0);
@@ -524,6 +764,66 @@ namespace ngfem
       }
   }
 
+  template <class FEL, ELEMENT_TYPE ET, class BASE>
+  void T_ScalarFiniteElement<FEL,ET,BASE> :: 
+  EvaluateValueGrad (const SIMD_IntegrationRule & ir,
+                     SliceMatrix<> coefs,
+                     BareSliceMatrix<SIMD<double>> values,
+                     BareSliceMatrix<SIMD<double>> grads) const
+  {
+    size_t nc = coefs.Width();
+    if (auto pre = GetPrecomputedShapes (ir))
+      {
+        for (size_t c = 0; c < nc; c++)
+          for (size_t i = 0; i < ir.Size(); i++)
+            {
+              values(c,i) = SIMD<double>(0.0);
+              for (int k = 0; k < DIM; k++)
+                grads(c*DIM+k,i) = SIMD<double>(0.0);
+            }
+        for (size_t j = 0; j < ndof; j++)
+          for (size_t c = 0; c < nc; c++)
+            {
+              SIMD<double> cj = coefs(j,c);
+              auto shapej = pre->shapes.Row(j);
+              for (size_t i = 0; i < ir.Size(); i++)
+                values(c,i) = FMA(cj, shapej(i), values(c,i));
+              for (int k = 0; k < DIM; k++)
+                {
+                  auto dshapej = pre->dshapes.Row(j*DIM+k);
+                  for (size_t i = 0; i < ir.Size(); i++)
+                    grads(c*DIM+k,i) = FMA(cj, dshapej(i), grads(c*DIM+k,i));
+                }
+            }
+        return;
+      }
+
+    // one shape evaluation per point for all columns
+    STACK_ARRAY(SIMD<double>, mem, nc*(DIM+1));
+    FlatMatrixFixWidth<DIM+1,SIMD<double>> sum(nc, &mem[0]);
+    for (size_t i = 0; i < ir.Size(); i++)
+      {
+        sum = SIMD<double>(0.0);
+        T_CalcShape (GetTIPGrad<DIM> (ir[i]),
+                     SBLambda ([&sum, coefs, nc] (size_t j, auto shape)
+                               {
+                                 for (size_t c = 0; c < nc; c++)
+                                   {
+                                     SIMD<double> cj = coefs(j,c);
+                                     sum(c,0) += cj * shape.Value();
+                                     for (int k = 0; k < DIM; k++)
+                                       sum(c,k+1) += cj * shape.DValue(k);
+                                   }
+                               }));
+        for (size_t c = 0; c < nc; c++)
+          {
+            values(c,i) = sum(c,0);
+            for (int k = 0; k < DIM; k++)
+              grads(c*DIM+k,i) = sum(c,k+1);
+          }
+      }
+  }
+
   
   template <class FEL, ELEMENT_TYPE ET, class BASE>
   void T_ScalarFiniteElement<FEL,ET,BASE> :: 
@@ -566,6 +866,51 @@ namespace ngfem
                 BareSliceVector<> coefs) const
   {
     if constexpr (DIM == 0) return;
+    if constexpr (FEL::PRISM_FACTORS)
+      if (bmir.IR().IsTP() && bmir.DimSpace() == 3)
+        {
+          static Timer t("prism AddGradTrans - sum factorization");
+          ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+          constexpr size_t SW = SIMD<double>::Size();
+          auto & fel = static_cast<const FEL&> (*this);
+          auto & ir = bmir.IR();
+          auto & irt = ir.GetIRX();
+          auto & irz = ir.GetIRZ();
+          size_t nt = irt.GetNIP(), nz = irz.GetNIP();
+
+          // the values mapped back to the reference element
+          STACK_ARRAY(SIMD<double>, memref, 3*ir.Size());
+          FlatMatrix<SIMD<double>> refvals(3, ir.Size(), memref);
+          for (size_t k = 0; k < 3; k++)
+            for (size_t i = 0; i < ir.Size(); i++)
+              refvals(k,i) = values(k,i);
+          bmir.TransformGradientTrans (refvals);
+          
+          STACK_ARRAY(int, memzind, ndof);
+          FlatArray<int> zind(ndof, memzind);
+          size_t nzf = fel.GetZFactorIndex (zind);
+          STACK_ARRAY(SIMD<double>, memt, 3*ndof*irt.Size());
+          FlatMatrix<SIMD<double>> tfac(3*ndof, irt.Size(), memt);
+          STACK_ARRAY(SIMD<double>, memz, 2*nzf*irz.Size());
+          FlatMatrix<SIMD<double>> zfac(2*nzf, irz.Size(), memz);
+          CalcPrismFactorsGrad (fel, irt, irz, tfac, zfac);
+          SliceMatrix<> ht(3*ndof, nt, irt.Size()*SW, &tfac(0,0)[0]);
+          SliceMatrix<> hz(2*nzf, nz, irz.Size()*SW, &zfac(0,0)[0]);
+
+          STACK_ARRAY(double, memsum, 3*nzf*nt);
+          FlatMatrix<> sumt(3*nzf, nt, memsum);
+          sumt.Rows(0, nzf) = hz.Rows(nzf, 2*nzf) * FlatMatrix<> (nz, nt, &refvals(2,0)[0]);
+          sumt.Rows(nzf, 2*nzf) = hz.Rows(0, nzf) * FlatMatrix<> (nz, nt, &refvals(0,0)[0]);
+          sumt.Rows(2*nzf, 3*nzf) = hz.Rows(0, nzf) * FlatMatrix<> (nz, nt, &refvals(1,0)[0]);
+          for (size_t i = 0; i < ndof; i++)
+            {
+              double sum = 0;
+              for (size_t k = 0; k < 3; k++)
+                sum += InnerProduct (ht.Row(k*ndof+i), sumt.Row(k*nzf+zind[i]));
+              coefs(i) += sum;
+            }
+          return;
+        }
     Iterate<4-DIM>
       ([&](auto CODIM)
        {
@@ -573,6 +918,31 @@ namespace ngfem
          if (bmir.DimSpace() == DIMSPACE)
            {
              auto & mir = static_cast<const SIMD_MappedIntegrationRule<DIM,DIMSPACE>&> (bmir);
+
+             if constexpr (DIM > 0)
+             if (auto pre = this->GetPrecomputedShapes (mir.IR()))
+               {
+                 // values mapped back to the reference element
+                 STACK_ARRAY(SIMD<double>, mem, DIM*mir.Size());
+                 FlatMatrixFixWidth<DIM,SIMD<double>> refvals(mir.Size(), &mem[0]);
+                 for (size_t i = 0; i < mir.Size(); i++)
+                   {
+                     Vec<DIM,SIMD<double>> jac_dir = mir[i].GetJacobianInverse() * values.Col(i);
+                     refvals.Row(i) = jac_dir;
+                   }
+
+                 for (size_t j = 0; j < this->ndof; j++)
+                   {
+                     SIMD<double> sum = 0.0;
+                     auto dshapes = pre->dshapes.Rows(j*DIM, (j+1)*DIM);
+                     for (size_t i = 0; i < mir.Size(); i++)
+                       for (int k = 0; k < DIM; k++)
+                         sum = FMA(dshapes(k,i), refvals(i,k), sum);
+                     coefs(j) += HSum(sum);
+                   }
+                 return;
+               }
+             
              for (size_t i = 0; i < mir.Size(); i++)
                {
                  // Directional derivative
@@ -200,7 +200,7 @@ namespace ngfem
               for (int i=0; i < ET_T::N_FACET; i++)
                 {
                   int pos = first_facet_dof[i]-2;
-                  int fac = 4 - ElementTopology::GetNVertices(ElementTopology::GetFaceType(ET,i));
+                  int fac = 4 - ElementTopology::GetNVertices(T_ElementTopology<ET>::GetFaceType(i));
                   for (int k = 0; k <= facet_order[i][0]; k++){
                     pos += 2*(facet_order[i][0]+1-fac*k);
                     idofs.Append(pos);
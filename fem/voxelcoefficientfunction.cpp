@@ -1,8 +1,128 @@
 
 #include "voxelcoefficientfunction.hpp"
 
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace ngfem
 {
+  size_t VoxelStorageSize (VOXEL_STORAGE storage)
+  {
+    switch (storage)
+      {
+      case VOXEL_FLOAT32: return sizeof(float);
+      case VOXEL_UINT8: return sizeof(uint8_t);
+      default: return sizeof(double);
+      }
+  }
+
+  class MappedVoxelFile
+  {
+    char * ptr = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    Array<char> buffer;
+  public:
+    MappedVoxelFile (const string & filename)
+    {
+#ifndef WIN32
+      int fd = open (filename.c_str(), O_RDONLY);
+      if (fd == -1)
+        throw Exception ("cannot open voxel file "+filename);
+      struct stat st;
+      if (fstat (fd, &st) != 0)
+        {
+          close (fd);
+          throw Exception ("cannot stat voxel file "+filename);
+        }
+      size = st.st_size;
+      if (size > 0)
+        {
+          // shared read-only mapping, the OS pages in only the voxels we touch
+          void * p = mmap (nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+          if (p == MAP_FAILED)
+            {
+              close (fd);
+              throw Exception ("mmap failed for voxel file "+filename);
+            }
+          ptr = static_cast<char*> (p);
+          mapped = true;
+          madvise (ptr, size, MADV_RANDOM);
+        }
+      close (fd);
+#else
+      ifstream in(filename, ios::binary | ios::ate);
+      if (!in)
+        throw Exception ("cannot open voxel file "+filename);
+      size = in.tellg();
+      in.seekg (0);
+      buffer.SetSize (size);
+      in.read (buffer.Data(), size);
+      ptr = buffer.Data();
+#endif
+    }
+
+    ~MappedVoxelFile ()
+    {
+#ifndef WIN32
+      if (mapped) munmap (ptr, size);
+#endif
+    }
+
+    size_t Size() const { return size; }
+    const char * Ptr (size_t offset) const { return ptr+offset; }
+  };
+
+  template<typename T>
+  VoxelCoefficientFunction<T> ::
+  VoxelCoefficientFunction(const Array<double>& _start,
+                           const Array<double>& _end,
+                           const Array<size_t>& _dim_vals,
+                           Array<char>&& _rawvalues,
+                           VOXEL_STORAGE _storage, double _scale, double _shift,
+                           bool _linear,
+                           shared_ptr<CoefficientFunction> trafo)
+    : CoefficientFunctionNoDerivative(1, is_same_v<T, Complex>),
+      start(_start), end(_end), dim_vals(_dim_vals), linear(_linear), trafocf(trafo),
+      storage(_storage), scale(_scale), shift(_shift), rawvalues(move(_rawvalues))
+  {
+    if constexpr (is_same_v<T, Complex>)
+      throw Exception("VoxelCoefficient: reduced precision storage only for real values");
+    size_t nvox = 1;
+    for (auto d : dim_vals) nvox *= d;
+    if (rawvalues.Size() < nvox * VoxelStorageSize(storage))
+      throw Exception("VoxelCoefficient: not enough values for grid of "+ToString(nvox)+" voxels");
+    data = rawvalues.Data();
+  }
+
+  template<typename T>
+  VoxelCoefficientFunction<T> ::
+  VoxelCoefficientFunction(const Array<double>& _start,
+                           const Array<double>& _end,
+                           const Array<size_t>& _dim_vals,
+                           const string & filename, size_t headersize,
+                           VOXEL_STORAGE _storage, double _scale, double _shift,
+                           bool _linear,
+                           shared_ptr<CoefficientFunction> trafo)
+    : CoefficientFunctionNoDerivative(1, is_same_v<T, Complex>),
+      start(_start), end(_end), dim_vals(_dim_vals), linear(_linear), trafocf(trafo),
+      storage(_storage), scale(_scale), shift(_shift)
+  {
+    if constexpr (is_same_v<T, Complex>)
+      throw Exception("VoxelCoefficient: voxel files only for real values");
+    file = make_shared<MappedVoxelFile> (filename);
+    size_t nvox = 1;
+    for (auto d : dim_vals) nvox *= d;
+    if (file->Size() < headersize + nvox * VoxelStorageSize(storage))
+      throw Exception("VoxelCoefficient: file "+filename+" too small for grid of "
+                      +ToString(nvox)+" voxels");
+    data = file->Ptr(headersize);
+  }
+
   template<typename T>
   T VoxelCoefficientFunction<T> :: T_Evaluate(const BaseMappedIntegrationPoint& ip) const
   {
@@ -34,7 +154,7 @@ namespace ngfem
             index += offset * ind[i];
             offset *= dim_vals[i];
           }
-        return values[index];
+        return Value(index);
       }
 
     Array<size_t> indices(pow(2, ind.Size()));
@@ -63,7 +183,7 @@ namespace ngfem
 
     T result = 0.;
     for(auto i : Range(indices))
-      result += tot_weight[i] * values[indices[i]];
+      result += tot_weight[i] * Value(indices[i]);
 
     return result;
   }
@@ -95,6 +215,104 @@ namespace ngfem
     throw Exception("Real evaluate for complex VoxelCoefficient called!");
   }
 
+  template<typename T> template<typename TRAW>
+  void VoxelCoefficientFunction<T> ::
+  T_EvaluateSIMD(const SIMD_BaseMappedIntegrationRule& mir, BareSliceMatrix<SIMD<double>> values) const
+  {
+    size_t D = start.Size();
+    auto raw = static_cast<const TRAW*>(data);
+
+    STACK_ARRAY(SIMD<double>, hmem, D*mir.Size());
+    FlatMatrix<SIMD<double>> tpoints(D, mir.Size(), &hmem[0]);
+    if (trafocf)
+      trafocf->Evaluate(mir, tpoints);
+    else
+      {
+        auto points = mir.GetPoints();
+        for (size_t k = 0; k < mir.Size(); k++)
+          for (size_t i = 0; i < D; i++)
+            tpoints(i,k) = points(k,i);
+      }
+
+    double invh[3], nmax[3];
+    for (size_t i = 0; i < D; i++)
+      {
+        nmax[i] = linear ? dim_vals[i] - 1 : dim_vals[i];
+        invh[i] = nmax[i] / (end[i] - start[i]);
+      }
+
+    for (size_t k = 0; k < mir.Size(); k++)
+      {
+        // lower voxel index and weight of the lower voxel, per direction
+        SIMD<double> ind[3], weight[3];
+        for (size_t i = 0; i < D; i++)
+          {
+            SIMD<double> pos = (tpoints(i,k) - start[i]) * invh[i];
+            pos = IfPos(pos, pos, SIMD<double>(0.0));
+            pos = IfPos(pos - nmax[i], SIMD<double>(nmax[i]), pos);
+            ind[i] = floor(pos);
+            weight[i] = 1.0 - (pos - ind[i]);
+          }
+
+        if (!linear)
+          {
+            values(0,k) = shift + scale * SIMD<double>([&](int j)
+              {
+                size_t index = 0, offset = 1;
+                for (size_t i = 0; i < D; i++)
+                  {
+                    index += offset * min2(size_t(ind[i][j]), dim_vals[i]-1);
+                    offset *= dim_vals[i];
+                  }
+                return double(raw[index]);
+              });
+            continue;
+          }
+
+        SIMD<double> sum = 0.0;
+        for (size_t c = 0; c < (size_t(1) << D); c++)
+          {
+            SIMD<double> w = 1.0;
+            for (size_t i = 0; i < D; i++)
+              w *= (c & (1 << i)) ? 1.0-weight[i] : weight[i];
+            sum += w * SIMD<double>([&](int j)
+              {
+                size_t index = 0, offset = 1;
+                for (size_t i = 0; i < D; i++)
+                  {
+                    size_t ii = ind[i][j];
+                    if (c & (1 << i))
+                      ii = min2(ii+1, dim_vals[i]-1);
+                    index += offset * ii;
+                    offset *= dim_vals[i];
+                  }
+                return double(raw[index]);
+              });
+          }
+        values(0,k) = shift + scale * sum;
+      }
+  }
+
+  template<typename T>
+  void VoxelCoefficientFunction<T> :: Evaluate(const SIMD_BaseMappedIntegrationRule& mir,
+                                               BareSliceMatrix<SIMD<double>> values) const
+  {
+    if constexpr(is_same_v<T, Complex>)
+      throw ExceptionNOSIMD("no real SIMD evaluate for complex VoxelCoefficient");
+    else
+      {
+        static Timer t("VoxelCF::Evaluate SIMD"); RegionTimer reg(t);
+        if (start.Size() > 3 || (!trafocf && start.Size() > size_t(mir.DimSpace())))
+          throw ExceptionNOSIMD("VoxelCoefficient: unsupported grid dimension for SIMD evaluate");
+        switch (storage)
+          {
+          case VOXEL_FLOAT32: T_EvaluateSIMD<float> (mir, values); break;
+          case VOXEL_UINT8: T_EvaluateSIMD<uint8_t> (mir, values); break;
+          default: T_EvaluateSIMD<double> (mir, values); break;
+          }
+      }
+  }
+
   template class VoxelCoefficientFunction<double>;
   template class VoxelCoefficientFunction<Complex>;
 } // namespace ngfem
@@ -5,6 +5,14 @@
 
 namespace ngfem
 {
+  /// storage type of voxel values, value = shift + scale * raw
+  enum VOXEL_STORAGE { VOXEL_FLOAT64, VOXEL_FLOAT32, VOXEL_UINT8 };
+
+  NGS_DLL_HEADER size_t VoxelStorageSize (VOXEL_STORAGE storage);
+
+  /// read-only memory map of a raw voxel file, pages are loaded on first access
+  class MappedVoxelFile;
+
   template<typename SCAL>
   class VoxelCoefficientFunction : public CoefficientFunctionNoDerivative
   {
@@ -13,6 +21,13 @@ namespace ngfem
     Array<SCAL> values;
     bool linear;
     shared_ptr<CoefficientFunction> trafocf;
+
+    // raw voxel data: values, a private buffer, or a mapped file
+    VOXEL_STORAGE storage = VOXEL_FLOAT64;
+    double scale = 1, shift = 0;
+    Array<char> rawvalues;
+    shared_ptr<MappedVoxelFile> file;
+    const void * data = nullptr;
   public:
     VoxelCoefficientFunction(const Array<double>& _start,
                              const Array<double>& _end,
@@ -23,16 +38,53 @@ namespace ngfem
       : CoefficientFunctionNoDerivative(1, is_same_v<SCAL, Complex>),
         start(_start), end(_end), dim_vals(_dim_vals),
         values(move(_values)), linear(_linear), trafocf(trafo)
-    { ; }
+    { data = values.Data(); }
+
+    /// real values in reduced precision storage, value = shift + scale * raw
+    VoxelCoefficientFunction(const Array<double>& _start,
+                             const Array<double>& _end,
+                             const Array<size_t>& _dim_vals,
+                             Array<char>&& _rawvalues,
+                             VOXEL_STORAGE _storage, double _scale, double _shift,
+                             bool _linear,
+                             shared_ptr<CoefficientFunction> trafo=nullptr);
+
+    /// real values read lazily from a raw binary file (x running fastest)
+    VoxelCoefficientFunction(const Array<double>& _start,
+                             const Array<double>& _end,
+                             const Array<size_t>& _dim_vals,
+                             const string & filename, size_t headersize,
+                             VOXEL_STORAGE _storage, double _scale, double _shift,
+                             bool _linear,
+                             shared_ptr<CoefficientFunction> trafo=nullptr);
 
     using CoefficientFunctionNoDerivative::Evaluate;
     double Evaluate(const BaseMappedIntegrationPoint& ip) const override;
     Complex EvaluateComplex(const BaseMappedIntegrationPoint& ip) const override;
 
     void Evaluate(const BaseMappedIntegrationPoint& mip, FlatVector<Complex> values) const override;
+    void Evaluate(const SIMD_BaseMappedIntegrationRule& mir, BareSliceMatrix<SIMD<double>> values) const override;
+
+    bool DependsOnElement () const override
+    { return trafocf ? trafocf->DependsOnElement() : false; }
 
   private:
     SCAL T_Evaluate(const BaseMappedIntegrationPoint& ip) const;
+    template <typename TRAW>
+    void T_EvaluateSIMD(const SIMD_BaseMappedIntegrationRule& mir, BareSliceMatrix<SIMD<double>> values) const;
+
+    SCAL Value (size_t i) const
+    {
+      if constexpr (is_same_v<SCAL, Complex>)
+        return static_cast<const Complex*>(data)[i];
+      else
+        switch (storage)
+          {
+          case VOXEL_FLOAT32: return shift + scale * static_cast<const float*>(data)[i];
+          case VOXEL_UINT8: return shift + scale * static_cast<const uint8_t*>(data)[i];
+          default: return shift + scale * static_cast<const double*>(data)[i];
+          }
+    }
   };
 } // namespace ngfem
 
@@ -137,7 +137,14 @@
 #endif
 
 
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#ifdef __ARM_FEATURE_SVE
+#include <arm_sve.h>
+#endif
+#else
 #include <immintrin.h>
+#endif
 
 
 #ifndef __assume
@@ -11,10 +11,47 @@ Arnoldi Eigenvalue Solver
 */ 
 
 #include <la.hpp>
+#include "../parallel/parallelvector.hpp"
 
 namespace ngla
 {
   
+  // coefficient of a Ritz vector, the real part for real problems
+  inline double RitzCoef (Complex c, double) { return c.real(); }
+  inline Complex RitzCoef (Complex c, Complex) { return c; }
+
+
+  template <typename SCAL>
+  void Arnoldi<SCAL>::Factor (shared_ptr<BaseMatrix> pre) const
+  {
+    if (inv && factored_shift == shift && factored_pre == pre) return;
+
+    static Timer t("arnoldi - factor"); RegionTimer reg(t);
+    if (!mat_shift)
+      mat_shift = a->CreateMatrix();
+    mat_shift->AsVector() = a->AsVector() - shift*b->AsVector();  
+
+    if (!pre)
+      {
+        auto fact = dynamic_pointer_cast<SparseFactorization> (inv);
+        if (fact && !factored_pre && fact->SupportsUpdate())
+          fact -> Update();   // same pattern, keeps the ordering
+        else
+          inv = mat_shift->InverseMatrix (freedofs);
+      }
+    else if (pre != factored_pre || !inv)
+      {
+        // the iterative solver refers to mat_shift, a new shift needs no new solver
+        auto itso = make_shared<GMRESSolver<double>> (mat_shift, pre);
+        itso->SetPrintRates(1);
+        itso->SetMaxSteps(2000);
+        inv = itso;
+      }
+    factored_shift = shift;
+    factored_pre = pre;
+  }
+
+
   template <typename SCAL>
   void Arnoldi<SCAL>::Calc (int numval, Array<Complex> & lam, int numev, 
                             Array<shared_ptr<BaseVector>> & hevecs, 
@@ -33,6 +70,7 @@ namespace ngla
    
     int n = hv.template FV<SCAL>().Size();    
     int m = min2 (numval, n);
+    int nwanted = max2 (min2 (numev, m), 0);
 
 
     Matrix<SCAL> matH(m);
@@ -40,18 +78,7 @@ namespace ngla
     for (int i = 0; i < m; i++)
       abv[i] = a->CreateColVector();
 
-    auto mat_shift = a->CreateMatrix();
-    mat_shift->AsVector() = a->AsVector() - shift*b->AsVector();  
-    shared_ptr<BaseMatrix> inv;
-    if (!pre)
-      inv = mat_shift->InverseMatrix (freedofs);
-    else
-      {
-        auto itso = make_shared<GMRESSolver<double>> (mat_shift, pre);
-        itso->SetPrintRates(1);
-        itso->SetMaxSteps(2000);
-        inv = itso;
-      }
+    Factor (pre);
 
     hv.SetRandom();
     hv.SetParallelStatus (CUMULATED);
@@ -60,105 +87,389 @@ namespace ngla
       for (int i = 0; i < hv.Size(); i++)
 	if (! (*freedofs)[i] ) fv(i) = 0;
 
-    t2.Start();
-    // matV = SCAL(0.0);   why ?
-    matH = SCAL(0.0);
+    Vector<Complex> lami(m);
+    Matrix<Complex> evecs(m);    
+    Matrix<Complex> matHt(m);
+    Array<int> order(m);
 
-    *hv2 = *hv;
-    SCAL len = sqrt (S_InnerProduct<SCAL> (*hv, *hv2)); // parallel
-    *hv /= len;
-    
-    for (int i = 0; i < m; i++)
+    for (int restart = 0; ; restart++)
       {
-	cout << IM(1) << "\ri = " << i << "/" << m << flush;
-	/*
-	for (int j = 0; j < n; j++)
-	  matV(i,j) = hv.FV<SCAL>()(j);
-	*/
-	*abv[i] = *hv;
+        t2.Start();
+        // matV = SCAL(0.0);   why ?
+        matH = SCAL(0.0);
+        double hlast = 0;
 
-	*hva = *b * *hv;
-	*hvm = *inv * *hva;
-
-	for (int j = 0; j <= i; j++)
-	  {
-            /*
-            SCAL sum = 0.0;
-	    for (int k = 0; k < n; k++)
-	      sum += hvm.FV<SCAL>()(k) * matV(j,k);
-	    matH(j,i) = sum;
-	    for (int k = 0; k < n; k++)
-	      hvm.FV<SCAL>()(k) -= sum * matV(j,k);
-            */
+        *hv2 = *hv;
+        SCAL len = sqrt (S_InnerProduct<SCAL> (*hv, *hv2)); // parallel
+        *hv /= len;
+    
+        for (int i = 0; i < m; i++)
+          {
+            cout << IM(1) << "\ri = " << i << "/" << m << flush;
             /*
-            SCAL sum = 0.0;
-            FlatVector<SCAL> abvj = abv[j] -> FV<SCAL>();
-            FlatVector<SCAL> fv_hvm = hvm.FV<SCAL>();
-	    for (int k = 0; k < n; k++)
-	      sum += fv_hvm(k) * abvj(k);
-	    matH(j,i) = sum;
-	    for (int k = 0; k < n; k++)
-	      fv_hvm(k) -= sum * abvj(k);
+              for (int j = 0; j < n; j++)
+              matV(i,j) = hv.FV<SCAL>()(j);
             */
+            *abv[i] = *hv;
 
-	    matH(j,i) = S_InnerProduct<SCAL> (*hvm, *abv[j]);
-	    *hvm -= matH(j,i) * *abv[j];
-	  }
+            *hva = *b * *hv;
+            *hvm = *inv * *hva;
+
+            // classical Gram-Schmidt applied twice:
+            // two reductions per step instead of i+1
+            for (int pass = 0; pass < 2; pass++)
+              {
+                InnerProductBatch<SCAL> ips;
+                for (int j = 0; j <= i; j++)
+                  ips.Add (*hvm, *abv[j]);
+                ips.Compute();
+                for (int j = 0; j <= i; j++)
+                  {
+                    matH(j,i) += ips[j];
+                    *hvm -= ips[j] * *abv[j];
+                  }
+              }
 		
-	*hv = *hvm;
-	*hv2 = *hv;
-	SCAL len = sqrt (S_InnerProduct<SCAL> (*hv, *hv2));
-	if (i<m-1) matH(i+1,i) = len; 
+            *hv = *hvm;
+            *hv2 = *hv;
+            SCAL len = sqrt (S_InnerProduct<SCAL> (*hv, *hv2));
+            if (i<m-1) matH(i+1,i) = len; 
+            else hlast = abs(len);
 	
-	*hv /= len;
-      }
+            *hv /= len;
+          }
       
-    t2.Stop();
-    t2.AddFlops (double(n)*m*m);
-    cout << "n = " << n << ", m = " << m << " n*m*m = " << n*m*m << endl;
-    cout << IM(1) << "\ri = " << m << "/" << m << endl;	    
-
-	    
-    Vector<Complex> lami(m);
-    Matrix<Complex> evecs(m);    
-    Matrix<Complex> matHt(m);
+        t2.Stop();
+        t2.AddFlops (double(n)*m*m);
+        cout << IM(3) << "n = " << n << ", m = " << m << " n*m*m = " << n*m*m << endl;
+        cout << IM(1) << "\ri = " << m << "/" << m << endl;	    
 
-    matHt = Trans (matH);
+        matHt = Trans (matH);
     
-    evecs = Complex (0.0);
-    lami = Complex (0.0);
+        evecs = Complex (0.0);
+        lami = Complex (0.0);
 
-    cout << "Solve Hessenberg evp with Lapack ... " << flush;
-    LapackHessenbergEP (matH.Height(), &matHt(0,0), &lami(0), &evecs(0,0));
-    cout << "done" << endl;
-	    
-    for (int i = 0; i < m; i++)
-      lami(i) =  1.0 / lami(i) + shift;
+        cout << IM(3) << "Solve Hessenberg evp with Lapack ... " << flush;
+        LapackHessenbergEP (matH.Height(), &matHt(0,0), &lami(0), &evecs(0,0));
+        cout << IM(3) << "done" << endl;
+
+        // largest eigenvalues of the inverse first, they are closest to the shift
+        for (int i = 0; i < m; i++)
+          order[i] = i;
+        QuickSort (order, [&] (int i, int j) { return abs(lami(i)) > abs(lami(j)); });
 
+        // residual of a Ritz pair (theta, V y) is h_{m+1,m} |y_m| / |y|
+        int nconv = 0;
+        for (int k = 0; k < nwanted; k++)
+          {
+            int i = order[k];
+            double resid = hlast * abs(evecs(i,m-1)) / L2Norm(evecs.Row(i));
+            if (resid <= tol * abs(lami(i))) nconv++;
+          }
+        cout << IM(3) << "arnoldi restart " << restart << ", converged "
+             << nconv << "/" << nwanted << endl;
+        if (restart >= maxrestarts || nconv == nwanted) break;
+
+        // new start vector from the wanted Ritz vectors
+        *hv = 0;
+        for (int k = 0; k < nwanted; k++)
+          {
+            int i = order[k];
+            double scale = 1.0 / L2Norm(evecs.Row(i));
+            for (int j = 0; j < m; j++)
+              *hv += (scale * RitzCoef (evecs(i,j), SCAL(0))) * *abv[j];
+          }
+      }
+	    
     lam.SetSize (m);
-    for (int i = 0; i < m; i++)
-      lam[i] = lami(i);
+    for (int k = 0; k < m; k++)
+      lam[k] = 1.0 / lami(order[k]) + shift;
 
     t3.Start();
     if (numev>0)
       {
 	int nout = min2 (numev, m); 
 	hevecs.SetSize(nout);
-	for (int i = 0; i< nout; i++)
+	for (int k = 0; k < nout; k++)
 	  {
+            int i = order[k];
             if (a->IsComplex())
-              hevecs[i] = a->CreateColVector();
+              hevecs[k] = a->CreateColVector();
             else // real biform and system-vecors not yet supported
-              hevecs[i] =  make_shared<VVector<Complex>> (a->Height());
+              hevecs[k] =  make_shared<VVector<Complex>> (a->Height());
             
-	    *hevecs[i] = 0;
+	    *hevecs[k] = 0;
 	    for (int j = 0; j < m; j++)
-	      *hevecs[i] += evecs(i,j) * *abv[j];
+	      *hevecs[k] += evecs(i,j) * *abv[j];
 	    // hevecs[i]->FVComplex() = Trans(matV)*evecs.Row(i);
 	  }
       }
     t3.Stop();
   } 
+
+
+#ifdef LAPACK
+  // Schur form S = Q T Q^T, reordered such that the eigenvalues |w| >= thresh
+  // lead T, returns their number (pairs of complex eigenvalues are kept together)
+  static int OrderedSchur (FlatMatrix<double,ColMajor> s, FlatMatrix<double,ColMajor> q, double thresh)
+  {
+    integer n = s.Height(), sdim = 0, info = 0;
+    integer lwork = max2 (integer(8*n), integer(n*n+1)), liwork = n*n+1;
+    Array<double> wr(n), wi(n), work(lwork);
+    Array<logical> bwork(n), select(n);
+    Array<integer> iwork(liwork);
+    char jobvs = 'V', sort = 'N';
+    dgees_ (&jobvs, &sort, 0, &n, &s(0,0), &n, &sdim, wr.Data(), wi.Data(),
+            &q(0,0), &n, work.Data(), &lwork, bwork.Data(), &info);
+    if (info)
+      throw Exception ("KrylovSchur: dgees failed, info = " + ToString(info));
+
+    for (int i = 0; i < n; i++)
+      select[i] = abs(Complex(wr[i], wi[i])) >= thresh;
+    integer m = 0;
+    double cond, sep;
+    char job = 'N', compq = 'V';
+    dtrsen_ (&job, &compq, select.Data(), &n, &s(0,0), &n, &q(0,0), &n,
+             wr.Data(), wi.Data(), &m, &cond, &sep, work.Data(), &lwork, iwork.Data(), &liwork, &info);
+    if (info)
+      throw Exception ("KrylovSchur: dtrsen failed, info = " + ToString(info));
+    return m;
+  }
+
+  static int OrderedSchur (FlatMatrix<Complex,ColMajor> s, FlatMatrix<Complex,ColMajor> q, double thresh)
+  {
+    integer n = s.Height(), sdim = 0, info = 0;
+    integer lwork = max2 (integer(8*n), integer(n*n+1));
+    Array<Complex> w(n), work(lwork);
+    Array<double> rwork(n);
+    Array<logical> bwork(n), select(n);
+    char jobvs = 'V', sort = 'N';
+    zgees_ (&jobvs, &sort, 0, &n, &s(0,0), &n, &sdim, w.Data(),
+            &q(0,0), &n, work.Data(), &lwork, rwork.Data(), bwork.Data(), &info);
+    if (info)
+      throw Exception ("KrylovSchur: zgees failed, info = " + ToString(info));
+
+    for (int i = 0; i < n; i++)
+      select[i] = abs(w[i]) >= thresh;
+    integer m = 0;
+    double cond, sep;
+    char job = 'N', compq = 'V';
+    ztrsen_ (&job, &compq, select.Data(), &n, &s(0,0), &n, &q(0,0), &n,
+             w.Data(), &m, &cond, &sep, work.Data(), &lwork, &info);
+    if (info)
+      throw Exception ("KrylovSchur: ztrsen failed, info = " + ToString(info));
+    return m;
+  }
+#endif
+
+
+  template <typename SCAL>
+  void Arnoldi<SCAL>::CalcKrylovSchur (int numval, Array<Complex> & lam, int numev, 
+                                       Array<shared_ptr<BaseVector>> & hevecs, 
+                                       shared_ptr<BaseMatrix> pre) const
+  {
+#ifdef LAPACK
+    static Timer t("arnoldi - Krylov-Schur");
+    static Timer tortho("arnoldi - Krylov-Schur orthogonalize");
+    static Timer tschur("arnoldi - Krylov-Schur dense");
+    static Timer trestart("arnoldi - Krylov-Schur restart");
+    RegionTimer reg(t);
+
+    // Hermitian products, the unitary restarts keep the basis orthonormal
+    typedef typename std::conditional<std::is_same<SCAL,Complex>::value,
+                                      ComplexConjugate, double>::type IPTYPE;
+
+    auto hv  = a->CreateColVector();
+    auto hva = a->CreateColVector();
+    int n = hv.template FV<SCAL>().Size();    
+    int m = min2 (numval, n);
+    int nwanted = max2 (min2 (numev, m), 1);
+    if (m < nwanted+3)
+      throw Exception ("KrylovSchur: dimension of the Krylov space " + ToString(m)
+                       + " has to be at least nev+3 = " + ToString(nwanted+3));
+    int keep = nwanted + (m-nwanted) / 2;
+
+    Factor (pre);
+
+    Array<shared_ptr<BaseVector>> basis(m+1), newbasis;
+    for (auto & v : basis)
+      v = a->CreateColVector();
+
+    hv.SetRandom();
+    hv.SetParallelStatus (CUMULATED);
+    FlatVector<SCAL> fv = hv.template FV<SCAL>();
+    if (freedofs)
+      for (int i = 0; i < hv.Size(); i++)
+	if (! (*freedofs)[i] ) fv(i) = 0;
+    *basis[0] = (1.0/hv.L2Norm()) * *hv;
+
+    // Krylov decomposition OP V_m = V_m S + v_m b^T, b^T is the last row of h
+    Matrix<SCAL> h(m+1, m);
+    Matrix<SCAL,ColMajor> s(m), q(m);
+    Vector<Complex> ritz(m);
+    Matrix<Complex> ritzvecs(m), sc(m);
+    Array<int> order(m);
+    h = SCAL(0.0);
+    int k = 0;
+
+    for (int restart = 0; ; restart++)
+      {
+        tortho.Start();
+        for (int j = k; j < m; j++)
+          {
+            cout << IM(1) << "\ri = " << j << "/" << m << flush;
+            *hva = *b * *basis[j];
+            *hv = *inv * *hva;
+
+            // block classical Gram-Schmidt applied twice
+            for (int pass = 0; pass < 2; pass++)
+              {
+                InnerProductBatch<IPTYPE> ips;
+                for (int i = 0; i <= j; i++)
+                  ips.Add (*hv, *basis[i]);
+                ips.Compute();
+                for (int i = 0; i <= j; i++)
+                  {
+                    h(i,j) += ips[i];
+                    *hv -= ips[i] * *basis[i];
+                  }
+              }
+            double beta = hv.L2Norm();
+            h(j+1,j) = beta;
+            *basis[j+1] = (1.0/beta) * *hv;
+          }
+        tortho.Stop();
+        tortho.AddFlops (4.0*n*(m*m-k*k));
+        cout << IM(1) << "\ri = " << m << "/" << m << endl;
+
+        // Ritz pairs of S, the largest eigenvalues of OP are closest to the shift
+        tschur.Start();
+        for (int i = 0; i < m; i++)
+          for (int j = 0; j < m; j++)
+            sc(i,j) = h(j,i);
+        LapackEigenValues (sc, ritz, ritzvecs);
+        for (int i = 0; i < m; i++)
+          order[i] = i;
+        QuickSort (order, [&] (int i, int j) { return abs(ritz(i)) > abs(ritz(j)); });
+
+        // residual of (theta, V y) is |b^T y| / |y|
+        int nconv = 0;
+        for (int l = 0; l < nwanted; l++)
+          {
+            int i = order[l];
+            Complex by = 0;
+            for (int j = 0; j < m; j++)
+              by += h(m,j) * ritzvecs(i,j);
+            if (abs(by) <= tol * abs(ritz(i)) * L2Norm(ritzvecs.Row(i)))
+              nconv++;
+          }
+        tschur.Stop();
+        cout << IM(3) << "Krylov-Schur restart " << restart << ", converged "
+             << nconv << "/" << nwanted << endl;
+        if (nconv == nwanted || restart >= maxrestarts) break;
+
+        // ordered Schur form S = Q T Q^*, the leading p Schur vectors are kept
+        tschur.Start();
+        for (int i = 0; i < m; i++)
+          for (int j = 0; j < m; j++)
+            s(i,j) = h(i,j);
+        double thresh = abs(ritz(order[keep-1])) * (1-1e-10);
+        int p = OrderedSchur (s, q, thresh);
+        tschur.Stop();
+        if (p <= 0 || p >= m)
+          throw Exception ("KrylovSchur: Schur reordering kept " + ToString(p) + " of " + ToString(m) + " vectors");
+
+        RegionTimer regr(trestart);
+        while (newbasis.Size() < p)
+          newbasis.Append (a->CreateColVector());
+        for (int i = 0; i < p; i++)
+          {
+            *newbasis[i] = 0;
+            for (int j = 0; j < m; j++)
+              *newbasis[i] += q(j,i) * *basis[j];
+          }
+        for (int i = 0; i < p; i++)
+          swap (basis[i], newbasis[i]);
+        swap (basis[p], basis[m]);
+
+        // new decomposition OP V_p = V_p T_11 + v_p (b^T Q_1)
+        Vector<SCAL> bq(p);
+        for (int j = 0; j < p; j++)
+          {
+            SCAL sum = 0;
+            for (int i = 0; i < m; i++)
+              sum += h(m,i) * q(i,j);
+            bq(j) = sum;
+          }
+        h = SCAL(0.0);
+        for (int i = 0; i < p; i++)
+          for (int j = 0; j < p; j++)
+            h(i,j) = s(i,j);
+        for (int j = 0; j < p; j++)
+          h(p,j) = bq(j);
+        k = p;
+      }
+
+    lam.SetSize (m);
+    for (int l = 0; l < m; l++)
+      lam[l] = 1.0 / ritz(order[l]) + shift;
+
+    if (numev>0)
+      {
+        static Timer t3("arnoldi - Krylov-Schur compute large vectors");
+        RegionTimer reg3(t3);
+	int nout = min2 (numev, m); 
+	hevecs.SetSize(nout);
+	for (int l = 0; l < nout; l++)
+	  {
+            int i = order[l];
+            if (a->IsComplex())
+              hevecs[l] = a->CreateColVector();
+            else // real biform and system-vecors not yet supported
+              hevecs[l] =  make_shared<VVector<Complex>> (a->Height());
+	    *hevecs[l] = 0;
+	    for (int j = 0; j < m; j++)
+	      *hevecs[l] += ritzvecs(i,j) * *basis[j];
+            *hevecs[l] /= hevecs[l]->L2Norm();
+	  }
+      }
+#else
+    throw Exception ("KrylovSchur needs Lapack");
+#endif
+  }
+
+
+  template <typename SCAL>
+  void Arnoldi<SCAL>::CalcShifts (FlatArray<SCAL> shifts, int numval, Array<Complex> & lam, int numev,
+                                  Array<shared_ptr<BaseVector>> & hevecs,
+                                  shared_ptr<BaseMatrix> pre)
+  {
+    static Timer t("arnoldi - shifts"); RegionTimer reg(t);
+    lam.SetSize0();
+    hevecs.SetSize0();
+    for (auto s : Range(shifts))
+      {
+        SetShift (shifts[s]);
+        Array<Complex> slam;
+        Array<shared_ptr<BaseVector>> svecs;
+        Calc (numval, slam, numev, svecs, pre);
+
+        // an eigenvalue belongs to the slice of the closest shift,
+        // so pairs found by neighbouring shifts are kept once
+        for (int i = 0; i < min2(numev, int(slam.Size())); i++)
+          {
+            bool mine = true;
+            for (auto s2 : Range(shifts))
+              if (abs(slam[i]-Complex(shifts[s2])) < abs(slam[i]-Complex(shifts[s])))
+                mine = false;
+            if (!mine) continue;
+            lam.Append (slam[i]);
+            if (i < svecs.Size())
+              hevecs.Append (svecs[i]);
+          }
+        cout << IM(3) << "shift " << shifts[s] << ": " << lam.Size() << " eigenvalues" << endl;
+      }
+  }
 	
 
   template class Arnoldi<double>;
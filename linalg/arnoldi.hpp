@@ -21,6 +21,20 @@ namespace ngla
      A can be non-symmetric
 
      It uses a shift-and-invert Arnoldi method 
+
+     The factorization of A - shift B is kept for the next call. For a
+     new shift of a factorization supporting Update (sparse Cholesky,
+     Pardiso, Umfpack) only the numerical factorization is repeated,
+     the ordering and symbolic analysis are reused. This makes
+     spectrum slicing by many shifts affordable (CalcShifts).
+
+     With restarts, the Krylov space is restarted by the wanted Ritz
+     vectors until their residuals |h_{m+1,m} y_m| are below tol |theta|.
+
+     CalcKrylovSchur keeps the basis at numval+1 vectors: the Krylov
+     decomposition OP V = V S + v b^T is restarted by an ordered Schur
+     form of S, the part of the wanted Ritz values is kept. The basis is
+     orthogonalized by block Gram-Schmidt (one reduction per pass).
    */
 
   template <typename SCAL>
@@ -30,7 +44,15 @@ namespace ngla
     shared_ptr<BaseMatrix> b;
     shared_ptr<BitArray> freedofs;
     SCAL shift;
+    int maxrestarts = 0;
+    double tol = 1e-8;
+
+    // A - shift B and its inverse, for the shift factored_shift
+    mutable shared_ptr<BaseMatrix> mat_shift, inv;
+    mutable SCAL factored_shift;
+    mutable shared_ptr<BaseMatrix> factored_pre;
 
+    void Factor (shared_ptr<BaseMatrix> pre) const;
   public:
     Arnoldi (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ab, shared_ptr<BitArray> afreedofs = nullptr)
       : a(aa), b(ab), freedofs(afreedofs)
@@ -41,9 +63,24 @@ namespace ngla
     void SetShift (SCAL ashift)
     { shift = ashift; }
 
+    /// restarts the Krylov space up to maxrestarts times, until the wanted numev pairs have converged
+    void SetRestarts (int amaxrestarts, double atol = 1e-8)
+    { maxrestarts = amaxrestarts; tol = atol; }
+
+    /// numev eigenpairs closest to the shift, sorted by the distance
     void Calc (int numval, Array<Complex> & lam, int nev, 
                Array<shared_ptr<BaseVector>> & evecs, 
                shared_ptr<BaseMatrix> pre = nullptr) const;
+
+    /// Krylov-Schur restarted Arnoldi, numval is the maximal dimension of the basis (at least numev+3)
+    void CalcKrylovSchur (int numval, Array<Complex> & lam, int nev,
+                          Array<shared_ptr<BaseVector>> & evecs,
+                          shared_ptr<BaseMatrix> pre = nullptr) const;
+
+    /// numev eigenpairs closest to every shift, an eigenpair is kept from the shift closest to it
+    void CalcShifts (FlatArray<SCAL> shifts, int numval, Array<Complex> & lam, int nev,
+                     Array<shared_ptr<BaseVector>> & evecs,
+                     shared_ptr<BaseMatrix> pre = nullptr);
   };
 }
 
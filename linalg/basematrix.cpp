@@ -106,11 +106,29 @@ namespace ngla
   void BaseMatrix :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
     //    cout << "Warning: BaseMatrix::MultAdd(double), this = " << typeid(*this).name() << endl;
-    auto temp = y.CreateVector();
+    auto temp = VectorPool::Get (y);
     Mult (x, *temp);
     y += s * *temp;
   }
 
+  void BaseMatrix :: Mult (const MultiVector & x, MultiVector & y) const
+  {
+    y = 0.0;
+    MultAdd (1, x, y);
+  }
+  
+  void BaseMatrix :: MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if (x.NumVectors() != y.NumVectors())
+      throw Exception ("MultAdd (MultiVector): different number of vectors");
+    for (size_t j = 0; j < x.NumVectors(); j++)
+      {
+        auto xj = x.GetVector(j);
+        auto yj = y.GetVector(j);
+        MultAdd (s, xj, yj);
+      }
+  }
+
   void BaseMatrix :: MultAdd (Complex s, const BaseVector & x, BaseVector & y) const 
   {
     /*
@@ -119,14 +137,14 @@ namespace ngla
 	<< typeid(*this).name();
     throw Exception (err.str());
     */
-    auto temp = y.CreateVector();
+    auto temp = VectorPool::Get (y);
     Mult (x, *temp);
     y += s * *temp;
   }
   
   void BaseMatrix :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
   {
-    auto temp = y.CreateVector();
+    auto temp = VectorPool::Get (y);
     MultTrans (x, *temp);
     y += s * *temp;
     /*
@@ -145,7 +163,7 @@ namespace ngla
 
   void BaseMatrix :: MultTransAdd (Complex s, const BaseVector & x, BaseVector & y) const
   {
-    auto temp = y.CreateVector();
+    auto temp = VectorPool::Get (y);
     MultTrans (x, *temp);
     y += s * *temp;
 
@@ -163,12 +181,12 @@ namespace ngla
 
   void BaseMatrix :: MultConjTransAdd (Complex s, const BaseVector & x, BaseVector & y) const
   {
-    auto tmpx = x.CreateVector();
-    auto tmpy = y.CreateVector();
-    tmpx.FV<Complex>() = Conj(x.FV<Complex>());
-    tmpy.FV<Complex>() = Conj(y.FV<Complex>());
-    MultTransAdd (Conj(s), tmpx, tmpy);
-    y.FV<Complex>() = Conj(tmpy.FV<Complex>());
+    auto tmpx = VectorPool::Get (x);
+    auto tmpy = VectorPool::Get (y);
+    tmpx->FV<Complex>() = Conj(x.FV<Complex>());
+    tmpy->FV<Complex>() = Conj(y.FV<Complex>());
+    MultTransAdd (Conj(s), *tmpx, *tmpy);
+    y.FV<Complex>() = Conj(tmpy->FV<Complex>());
     // throw Exception(string("MultHermitianAdd not overloaded for type ")+typeid(*this).name());
   }
   
@@ -273,6 +291,94 @@ namespace ngla
   }
 
 
+  Array<VectorPool::Entry> VectorPool :: entries;
+  mutex VectorPool :: pool_mutex;
+  size_t VectorPool :: max_entries = 32;
+
+  VectorPool::Handle VectorPool :: Get (const BaseVector & model)
+  {
+    const BaseVector * m = &model;
+    while (auto av = dynamic_cast<const AutoVector*> (m))
+      m = &**av;
+
+    Entry entry { &typeid(*m), m->Size(), m->EntrySize(), m->IsComplex(), AutoVector() };
+    if (m->GetParallelStatus() != NOT_PARALLEL)
+      {
+        entry.vec.AssignPointer (m->CreateVector());
+        return Handle (std::move(entry), false);
+      }
+
+    {
+      lock_guard<mutex> guard(pool_mutex);
+      for (size_t i = entries.Size(); i-- > 0; )
+        {
+          auto & e = entries[i];
+          if (*e.type == *entry.type && e.size == entry.size &&
+              e.entrysize == entry.entrysize && e.is_complex == entry.is_complex)
+            {
+              entry.vec.AssignPointer (e.vec);
+              entries.DeleteElement (i);
+              return Handle (std::move(entry), true);
+            }
+        }
+    }
+    entry.vec.AssignPointer (m->CreateVector());
+    return Handle (std::move(entry), true);
+  }
+
+  void VectorPool :: Release (Entry && entry)
+  {
+    lock_guard<mutex> guard(pool_mutex);
+    if (entries.Size() < max_entries)
+      entries.Append (std::move(entry));
+  }
+
+  void VectorPool :: Clear ()
+  {
+    lock_guard<mutex> guard(pool_mutex);
+    entries.SetSize0();
+  }
+
+  size_t VectorPool :: Size ()
+  {
+    lock_guard<mutex> guard(pool_mutex);
+    return entries.Size();
+  }
+
+
+
+  static void CollectSumTerms (const BaseMatrix & m, double c,
+                               Array<const BaseMatrix*> & mats, Array<double> & coefs)
+  {
+    if (auto sum = dynamic_cast<const SumMatrix*> (&m))
+      {
+        CollectSumTerms (sum->GetMatrixA(), c*sum->GetScaleA(), mats, coefs);
+        CollectSumTerms (sum->GetMatrixB(), c*sum->GetScaleB(), mats, coefs);
+      }
+    else if (auto scaled = dynamic_cast<const VScaleMatrix<double>*> (&m))
+      CollectSumTerms (scaled->GetMatrix(), c*scaled->GetScale(), mats, coefs);
+    else
+      {
+        mats.Append (&m);
+        coefs.Append (c);
+      }
+  }
+
+  void SumMatrix :: SetupFused ()
+  {
+    Array<const BaseMatrix*> mats;
+    Array<double> coefs;
+    CollectSumTerms (bma, a, mats, coefs);
+    CollectSumTerms (bmb, b, mats, coefs);
+    if (SameGraphSparseMatrices (mats))
+      {
+        fused_mats = std::move(mats);
+        fused_coefs = std::move(coefs);
+      }
+  }
+
+
+
   void VMatVecExpr :: CheckSize (BaseVector & dest_vec) const
   {
     if (m.Height() != dest_vec.Size() || m.Width() != x.Size())
@@ -298,6 +404,11 @@ namespace ngla
       case MUMPS:           return "mumps";
       case MASTERINVERSE:   return "masterinverse";
       case UMFPACK:         return "umfpack";
+      case SPARSECHOLESKY_ND: return "sparsecholesky_nd";
+      case SPARSECHOLESKY_OOC: return "sparsecholesky_ooc";
+      case SPARSECHOLESKY_MP: return "sparsecholesky_mp";
+      case REDUNDANTINVERSE: return "redundantinverse";
+      case AUTOINVERSE:     return "auto";
       }
     return "";
   }
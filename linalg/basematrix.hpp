@@ -13,7 +13,7 @@ namespace ngla
 
 
   // sets the solver which is used for InverseMatrix
-  enum INVERSETYPE { PARDISO, PARDISOSPD, SPARSECHOLESKY, SUPERLU, SUPERLU_DIST, MUMPS, MASTERINVERSE, UMFPACK };
+  enum INVERSETYPE { PARDISO, PARDISOSPD, SPARSECHOLESKY, SUPERLU, SUPERLU_DIST, MUMPS, MASTERINVERSE, UMFPACK, SPARSECHOLESKY_ND, SPARSECHOLESKY_OOC, SPARSECHOLESKY_MP, REDUNDANTINVERSE, AUTOINVERSE };
   extern string GetInverseName (INVERSETYPE type);
 
   /**
@@ -109,6 +109,11 @@ namespace ngla
    /// y += s Trans(matrix) * x
     virtual void MultConjTransAdd (Complex s, const BaseVector & x, BaseVector & y) const;
 
+    /// y = matrix * x for several vectors
+    virtual void Mult (const MultiVector & x, MultiVector & y) const;
+    /// y += s matrix * x for several vectors, default is vector by vector
+    virtual void MultAdd (double s, const MultiVector & x, MultiVector & y) const;
+
 
 
 
@@ -264,10 +269,70 @@ namespace ngla
     }
   public:
     DynamicMatVecExpression (shared_ptr<BaseMatrix> am, shared_ptr<BaseVector> av)
-      : m(am), v(av) { } 
+      : m(am), v(av) { }
+    AutoVector CreateVector () const override { return m->CreateColVector(); }
+    bool CollectTerms (double s, DynamicTerms & terms) const override
+    {
+      terms.mat_coefs.Append (s);
+      terms.mats.Append (m.get());
+      terms.mat_vecs.Append (v.get());
+      return true;
+    }
   };
 
-  
+
+
+  /* ************************** VectorPool ************************* */
+
+  /**
+     Pool of temporary vectors for matrix-vector products.
+
+     Get returns a vector of the same type, size and entrysize as the
+     model vector, it is given back to the pool when the handle goes out
+     of scope. The pool is thread-safe, distributed vectors are not
+     pooled but created for every request.
+  */
+  class NGS_DLL_HEADER VectorPool
+  {
+    struct Entry
+    {
+      const std::type_info * type;
+      size_t size;
+      int entrysize;
+      bool is_complex;
+      AutoVector vec;
+    };
+    static Array<Entry> entries;
+    static mutex pool_mutex;
+    static size_t max_entries;
+
+  public:
+    class Handle
+    {
+      Entry entry;
+      bool pooled;
+    public:
+      Handle (Entry && aentry, bool apooled)
+        : entry(std::move(aentry)), pooled(apooled) { ; }
+      Handle (const Handle &) = delete;
+      Handle (Handle && h2) : entry(std::move(h2.entry)), pooled(h2.pooled)
+      { h2.pooled = false; }
+      ~Handle () { if (pooled) VectorPool::Release (std::move(entry)); }
+      BaseVector & operator* () { return *entry.vec; }
+      BaseVector * operator-> () { return &*entry.vec; }
+    };
+
+    /// a temporary vector like model
+    static Handle Get (const BaseVector & model);
+    /// frees the vectors kept in the pool
+    static void Clear ();
+    /// number of vectors kept in the pool
+    static size_t Size ();
+  private:
+    static void Release (Entry && entry);
+  };
+
+
 
   /* ************************** Transpose ************************* */
 
@@ -396,6 +461,13 @@ namespace ngla
 
   
 
+  /// the matrices are real sparse matrices of the same type and the same graph
+  NGS_DLL_HEADER bool SameGraphSparseMatrices (FlatArray<const BaseMatrix*> mats);
+  /// y = s * sum_i coefs[i] * mats[i] * x, or y += ... if add, in one pass over the common graph
+  NGS_DLL_HEADER void SameGraphSparseMultAdd (FlatArray<const BaseMatrix*> mats, FlatArray<double> coefs,
+                                              double s, const BaseVector & x, BaseVector & y, bool add);
+
+
   /* ************************** Product ************************* */
 
   /// action of product of two matrices 
@@ -406,6 +478,31 @@ namespace ngla
     shared_ptr<BaseMatrix> spbma;
     shared_ptr<BaseMatrix> spbmb;
     mutable AutoVector tempvec;
+    mutable atomic<bool> tempvec_used{false};
+
+    // calls func with the own temporary vector, or with one from the
+    // pool if the own one is in use by a concurrent call
+    template <typename FUNC>
+    void WithTempVector (FUNC func) const
+    {
+      bool expected = false;
+      if (!tempvec_used.compare_exchange_strong (expected, true))
+        {
+          auto temp = VectorPool::Get (tempvec);
+          func (*temp);
+          return;
+        }
+      try
+        {
+          func (*tempvec);
+        }
+      catch (...)
+        {
+          tempvec_used = false;
+          throw;
+        }
+      tempvec_used = false;
+    }
   public:
     ///
     ProductMatrix (const BaseMatrix & abma, const BaseMatrix & abmb)
@@ -434,43 +531,61 @@ namespace ngla
     virtual void Mult (const BaseVector & x, BaseVector & y) const override
     {
       static Timer t("ProductMatrix::Mult"); RegionTimer reg(t);      
-      bmb.Mult (x, tempvec);
-      bma.Mult (tempvec, y);
+      WithTempVector ([&] (BaseVector & temp)
+                      {
+                        bmb.Mult (x, temp);
+                        bma.Mult (temp, y);
+                      });
     }
 
     virtual void MultTrans (const BaseVector & x, BaseVector & y) const override
     {
       static Timer t("ProductMatrix::Mult"); RegionTimer reg(t);      
-      bma.MultTrans (x, tempvec);
-      bmb.MultTrans (tempvec, y);
+      WithTempVector ([&] (BaseVector & temp)
+                      {
+                        bma.MultTrans (x, temp);
+                        bmb.MultTrans (temp, y);
+                      });
     }
 
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override
     {
       static Timer t("ProductMatrix::MultAdd"); RegionTimer reg(t);      
-      bmb.Mult (x, tempvec);
-      bma.MultAdd (s, tempvec, y);
+      WithTempVector ([&] (BaseVector & temp)
+                      {
+                        bmb.Mult (x, temp);
+                        bma.MultAdd (s, temp, y);
+                      });
     }
     ///
     virtual void MultAdd (Complex s, const BaseVector & x, BaseVector & y) const override
     {
       static Timer t("ProductMatrix::MultAdd complex"); RegionTimer reg(t);            
-      bmb.Mult (x, tempvec);
-      bma.MultAdd (s, tempvec, y);
+      WithTempVector ([&] (BaseVector & temp)
+                      {
+                        bmb.Mult (x, temp);
+                        bma.MultAdd (s, temp, y);
+                      });
     }
     ///
     virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override
     {
       static Timer t("ProductMatrix::MultTransAdd"); RegionTimer reg(t);            
-      bma.MultTrans (x, tempvec);
-      bmb.MultTransAdd (s, tempvec, y);
+      WithTempVector ([&] (BaseVector & temp)
+                      {
+                        bma.MultTrans (x, temp);
+                        bmb.MultTransAdd (s, temp, y);
+                      });
     }
     ///
     virtual void MultTransAdd (Complex s, const BaseVector & x, BaseVector & y) const override
     {
       static Timer t("ProductMatrix::MultTransAdd complex"); RegionTimer reg(t);
-      bma.MultTrans (x, tempvec);
-      bmb.MultTransAdd (s, tempvec, y);
+      WithTempVector ([&] (BaseVector & temp)
+                      {
+                        bma.MultTrans (x, temp);
+                        bmb.MultTransAdd (s, temp, y);
+                      });
     }  
 
     virtual int VHeight() const override { return bma.VHeight(); }
@@ -496,16 +611,27 @@ namespace ngla
     shared_ptr<BaseMatrix> spbma;
     shared_ptr<BaseMatrix> spbmb;
     double a, b;
+    /// terms of nested sums and scalings, if all are real sparse matrices of the same graph
+    Array<const BaseMatrix*> fused_mats;
+    Array<double> fused_coefs;
+    NGS_DLL_HEADER void SetupFused ();
   public:
     ///
     SumMatrix (const BaseMatrix & abma, const BaseMatrix & abmb,
                double aa = 1, double ab = 1)
       : bma(abma), bmb(abmb), a(aa), b(ab)
-    { ; }
+    { SetupFused(); }
     SumMatrix (shared_ptr<BaseMatrix> aspbma, shared_ptr<BaseMatrix> aspbmb,
                    double aa = 1, double ab = 1)
       : bma(*aspbma), bmb(*aspbmb), spbma(aspbma), spbmb(aspbmb), a(aa), b(ab)
-    { ; }
+    { SetupFused(); }
+
+    const BaseMatrix & GetMatrixA () const { return bma; }
+    const BaseMatrix & GetMatrixB () const { return bmb; }
+    double GetScaleA () const { return a; }
+    double GetScaleB () const { return b; }
+    /// the sum is evaluated in one pass over the common matrix graph
+    bool IsFused () const { return fused_mats.Size() > 0; }
     ///
     virtual bool IsComplex() const override { return bma.IsComplex() || bmb.IsComplex(); }
 
@@ -535,6 +661,11 @@ namespace ngla
     virtual void Mult (const BaseVector & x, BaseVector & y) const override
     {
       static Timer t("SumMatrix::Mult"); RegionTimer reg(t);
+      if (IsFused())
+        {
+          SameGraphSparseMultAdd (fused_mats, fused_coefs, 1, x, y, false);
+          return;
+        }
       if (a == 1)
         bma.Mult (x, y);
       else
@@ -562,6 +693,11 @@ namespace ngla
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override
     {
       static Timer t("SumMatrix::MultAdd"); RegionTimer reg(t);
+      if (IsFused())
+        {
+          SameGraphSparseMultAdd (fused_mats, fused_coefs, s, x, y, true);
+          return;
+        }
       bma.MultAdd (a*s, x, y);
       bmb.MultAdd (b*s, x, y);
     }
@@ -615,6 +751,8 @@ namespace ngla
     VScaleMatrix (const BaseMatrix & abm, TSCAL ascale) : bm(abm), scale(ascale) { ; }
     VScaleMatrix (shared_ptr<BaseMatrix> aspbm, TSCAL ascale)
       : bm(*aspbm), spbm(aspbm), scale(ascale) { ; }
+    const BaseMatrix & GetMatrix () const { return bm; }
+    TSCAL GetScale () const { return scale; }
     virtual bool IsComplex() const override
     { return bm.IsComplex() || typeid(TSCAL)==typeid(Complex); } 
     ///
@@ -170,6 +170,247 @@ namespace ngla
   }
 
 
+  double BaseVector :: AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+  {
+    Add (scal, v);
+    return InnerProductD (w);
+  }
+
+  BaseVector & BaseVector :: Add2 (double scal1, const BaseVector & v1,
+                                   double scal2, const BaseVector & v2)
+  {
+    Add (scal1, v1);
+    return Add (scal2, v2);
+  }
+
+  void BaseVector :: InnerProductsD (FlatArray<const BaseVector*> v, FlatVector<double> res) const
+  {
+    for (size_t i = 0; i < v.Size(); i++)
+      res(i) = InnerProductD (*v[i]);
+  }
+
+
+
+  double VecAddInnerProduct (FlatVector<double> x, double scal,
+                             FlatVector<double> v, FlatVector<double> w)
+  {
+    static Timer t("VecAddInnerProduct");
+    RegionTimer reg(t);
+    t.AddFlops (2*x.Size());
+    
+    if (x.Size() != v.Size() || x.Size() != w.Size())
+      throw Exception (string ("VecAddInnerProduct: sizes don't match, ") +
+                       ToString(x.Size()) + ", " + ToString(v.Size()) + ", " + ToString(w.Size()));
+
+    constexpr size_t SW = SIMD<double>::Size();
+    double parts[16];
+    ParallelJob ([x,v,w,scal,&parts] (TaskInfo ti)
+                 {
+                   auto r = ngstd::Range(x).Split (ti.task_nr, ti.ntasks);
+                   SIMD<double> sum = 0.0;
+                   size_t i = r.First();
+                   for ( ; i+SW <= r.Next(); i += SW)
+                     {
+                       SIMD<double> xi = SIMD<double>(&x(i)) + scal * SIMD<double>(&v(i));
+                       xi.Store (&x(i));
+                       // w may be the same vector as x, load it after the store
+                       sum += xi * SIMD<double>(&w(i));
+                     }
+                   double hsum = HSum(sum);
+                   for ( ; i < r.Next(); i++)
+                     {
+                       x(i) += scal * v(i);
+                       hsum += x(i) * w(i);
+                     }
+                   parts[ti.task_nr] = hsum;
+                 }, 16);
+    double sum = 0;
+    for (double part : parts) sum += part;
+    return sum;
+  }
+
+  void VecAdd2 (FlatVector<double> x, double scal1, FlatVector<double> v1,
+                double scal2, FlatVector<double> v2)
+  {
+    static Timer t("VecAdd2");
+    RegionTimer reg(t);
+    t.AddFlops (2*x.Size());
+
+    if (x.Size() != v1.Size() || x.Size() != v2.Size())
+      throw Exception (string ("VecAdd2: sizes don't match, ") +
+                       ToString(x.Size()) + ", " + ToString(v1.Size()) + ", " + ToString(v2.Size()));
+
+    constexpr size_t SW = SIMD<double>::Size();
+    ParallelForRange (x.Size(), [x,v1,v2,scal1,scal2] (IntRange r)
+                      {
+                        size_t i = r.First();
+                        for ( ; i+SW <= r.Next(); i += SW)
+                          {
+                            SIMD<double> xi = SIMD<double>(&x(i))
+                              + scal1 * SIMD<double>(&v1(i)) + scal2 * SIMD<double>(&v2(i));
+                            xi.Store (&x(i));
+                          }
+                        for ( ; i < r.Next(); i++)
+                          x(i) += scal1 * v1(i) + scal2 * v2(i);
+                      });
+  }
+
+  void VecInnerProducts (FlatVector<double> x, FlatArray<FlatVector<double>> v,
+                         FlatVector<double> res)
+  {
+    static Timer t("VecInnerProducts");
+    RegionTimer reg(t);
+    t.AddFlops (v.Size()*x.Size());
+
+    for (auto vi : v)
+      if (vi.Size() != x.Size())
+        throw Exception (string ("VecInnerProducts: sizes don't match, ") +
+                         ToString(x.Size()) + " != " + ToString(vi.Size()));
+
+    // blocks of x stay in cache while the vectors v[i] are streamed
+    constexpr size_t SW = SIMD<double>::Size();
+    constexpr size_t BS = 1024;
+    Matrix<double> parts(16, v.Size());
+    ParallelJob ([x,v,&parts] (TaskInfo ti)
+                 {
+                   auto r = ngstd::Range(x).Split (ti.task_nr, ti.ntasks);
+                   auto mypart = parts.Row(ti.task_nr);
+                   mypart = 0.0;
+                   for (size_t first = r.First(); first < r.Next(); first += BS)
+                     {
+                       size_t next = min2(first+BS, r.Next());
+                       for (size_t j = 0; j < v.Size(); j++)
+                         {
+                           auto vj = v[j];
+                           SIMD<double> sum = 0.0;
+                           size_t i = first;
+                           for ( ; i+SW <= next; i += SW)
+                             sum += SIMD<double>(&x(i)) * SIMD<double>(&vj(i));
+                           double hsum = HSum(sum);
+                           for ( ; i < next; i++)
+                             hsum += x(i) * vj(i);
+                           mypart(j) += hsum;
+                         }
+                     }
+                 }, 16);
+    res = 0.0;
+    for (size_t k = 0; k < parts.Height(); k++)
+      res += parts.Row(k);
+  }
+
+  // y = ycoef * y + sum_j coefs[j] * v[j], for ycoef = 0 y is not read
+  void VecLinearCombination (FlatVector<double> y, double ycoef,
+                             FlatArray<double> coefs, FlatArray<const double*> v)
+  {
+    static Timer t("VecLinearCombination");
+    RegionTimer reg(t);
+    t.AddFlops (2*v.Size()*y.Size());
+
+    // a block of y stays in cache while the vectors v[j] are streamed
+    constexpr size_t SW = SIMD<double>::Size();
+    constexpr size_t BS = 1024;
+    ParallelForRange (y.Size(), [y,ycoef,coefs,v] (IntRange r)
+                      {
+                        for (size_t first = r.First(); first < r.Next(); first += BS)
+                          {
+                            size_t next = min2(first+BS, r.Next());
+                            size_t j0 = 0;
+                            if (ycoef == 0)
+                              {
+                                double c = coefs.Size() ? coefs[0] : 0.0;
+                                const double * v0 = coefs.Size() ? v[0] : nullptr;
+                                for (size_t i = first; i < next; i++)
+                                  y(i) = v0 ? c * v0[i] : 0.0;
+                                j0 = 1;
+                              }
+                            else if (ycoef != 1)
+                              for (size_t i = first; i < next; i++)
+                                y(i) *= ycoef;
+
+                            for (size_t j = j0; j < v.Size(); j++)
+                              {
+                                double c = coefs[j];
+                                const double * vj = v[j];
+                                size_t i = first;
+                                for ( ; i+SW <= next; i += SW)
+                                  {
+                                    SIMD<double> yi = SIMD<double>(&y(i)) + c * SIMD<double>(vj+i);
+                                    yi.Store (&y(i));
+                                  }
+                                for ( ; i < next; i++)
+                                  y(i) += c * vj[i];
+                              }
+                          }
+                      });
+  }
+
+
+  // real, not distributed vectors with contiguous memory
+  static const BaseVector * FusableVector (const BaseVector * v)
+  {
+    while (auto av = dynamic_cast<const AutoVector*> (v))
+      v = &**av;
+    if (!dynamic_cast<const S_BaseVectorPtr<double>*> (v)) return nullptr;
+    if (v->GetParallelStatus() != NOT_PARALLEL) return nullptr;
+    return v;
+  }
+
+  static bool Overlap (FlatVector<double> a, FlatVector<double> b)
+  {
+    return a.Data() < b.Data()+b.Size() && b.Data() < a.Data()+a.Size();
+  }
+
+  bool EvaluateFused (const DynamicBaseExpression & expr, double s, BaseVector & y, bool add)
+  {
+    DynamicTerms terms;
+    if (!expr.CollectTerms (s, terms)) return false;
+    // nothing to save for a single term, or for products only
+    if (terms.vecs.Size() == 0 || terms.vecs.Size()+terms.mats.Size() < 2) return false;
+
+    auto py = FusableVector (&y);
+    if (!py) return false;
+    FlatVector<double> fy = py->FVDouble();
+
+    double ycoef = add ? 1 : 0;
+    ArrayMem<double,8> coefs;
+    ArrayMem<const double*,8> v;
+    for (size_t i = 0; i < terms.vecs.Size(); i++)
+      {
+        auto pv = FusableVector (terms.vecs[i]);
+        if (!pv) return false;
+        FlatVector<double> fv = pv->FVDouble();
+        if (fv.Size() != fy.Size()) return false;
+        double c = terms.vec_coefs[i];
+        if (fv.Data() == fy.Data())
+          {
+            ycoef += c;
+            continue;
+          }
+        // a shifted view of y would be overwritten in the blocked pass
+        if (Overlap (fv, fy)) return false;
+        auto pos = v.Pos (fv.Data());
+        if (pos == v.ILLEGAL_POSITION)
+          {
+            v.Append (fv.Data());
+            coefs.Append (c);
+          }
+        else
+          coefs[pos] += c;
+      }
+
+    // the products are added into y, they must not read y
+    for (auto x : terms.mat_vecs)
+      if (auto px = FusableVector (x))
+        if (Overlap (px->FVDouble(), fy))
+          return false;
+
+    VecLinearCombination (fy, ycoef, coefs, v);
+    for (size_t i = 0; i < terms.mats.Size(); i++)
+      terms.mats[i]->MultAdd (terms.mat_coefs[i], *terms.mat_vecs[i], y);
+    return true;
+  }
+
+
   double BaseVector :: InnerProductD (const BaseVector & v2) const
   {
     return dynamic_cast<const S_BaseVector<double>&> (*this) . 
@@ -847,6 +1088,21 @@ namespace ngla
     if (ownmem) delete [] pdata;
   }
 
+  template <typename TSCAL>
+  void S_BaseVectorPtr<TSCAL> :: FirstTouch ()
+  {
+    size_t n = this->size * es;
+    if (n < 16384) return;    // not worth a job
+    
+    TSCAL * data = pdata;
+    ParallelJob ([n, data] (TaskInfo ti)
+                 {
+                   auto r = ngstd::Range(n).Split (ti.task_nr, ti.ntasks);
+                   for (size_t i : r)
+                     data[i] = TSCAL(0.0);
+                 });
+  }
+
   template <typename TSCAL>
   AutoVector S_BaseVectorPtr<TSCAL> :: CreateVector () const
   {
@@ -893,6 +1149,81 @@ namespace ngla
     return make_shared<S_BaseVectorPtr<TSCAL>> (range.Size(), es, pdata+range.First()*es);
   }
 
+  template <typename TSCAL>
+  double S_BaseVectorPtr<TSCAL> ::
+  AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+  {
+    if constexpr (is_same<TSCAL,double>::value)
+      return VecAddInnerProduct (this->FVDouble(), scal, v.FVDouble(), w.FVDouble());
+    else
+      return BaseVector::AddInnerProductD (scal, v, w);
+  }
+
+  template <typename TSCAL>
+  BaseVector & S_BaseVectorPtr<TSCAL> ::
+  Add2 (double scal1, const BaseVector & v1, double scal2, const BaseVector & v2)
+  {
+    if constexpr (is_same<TSCAL,double>::value)
+      {
+        if (!v1.IsComplex() && !v2.IsComplex())
+          {
+            VecAdd2 (this->FVDouble(), scal1, v1.FVDouble(), scal2, v2.FVDouble());
+            return *this;
+          }
+      }
+    return BaseVector::Add2 (scal1, v1, scal2, v2);
+  }
+
+  template <typename TSCAL>
+  void S_BaseVectorPtr<TSCAL> ::
+  InnerProductsD (FlatArray<const BaseVector*> v, FlatVector<double> res) const
+  {
+    if constexpr (is_same<TSCAL,double>::value)
+      {
+        ArrayMem<FlatVector<double>,16> fv(v.Size());
+        for (size_t i = 0; i < v.Size(); i++)
+          fv[i].AssignMemory (v[i]->FVDouble().Size(), v[i]->FVDouble().Data());
+        VecInnerProducts (this->FVDouble(), fv, res);
+      }
+    else
+      BaseVector::InnerProductsD (v, res);
+  }
+
+  AutoVector MultiVector :: GetVector (size_t j) const
+  {
+    return make_shared<S_BaseVectorPtr<double>> (size, 1, (void*)&data[j*size]);
+  }
+
+  MultiVector & MultiVector :: operator= (const MultiVector & v2)
+  {
+    if (v2.size != size || v2.k != k)
+      throw Exception ("MultiVector assignment: sizes don't fit");
+    ParallelForRange (data.Size(), [&] (IntRange r)
+                      { data.Range(r) = v2.data.Range(r); });
+    return *this;
+  }
+
+  Matrix<double> MultiVector :: InnerProduct (const MultiVector & v2) const
+  {
+    static Timer t("MultiVector::InnerProduct"); RegionTimer reg(t);
+    if (v2.size != size)
+      throw Exception ("MultiVector::InnerProduct: sizes don't fit");
+    t.AddFlops (2*size*k*v2.k);
+    
+    Matrix<double> res(k, v2.k);
+    res = 0.0;
+    mutex m;
+    ParallelForRange (size, [&] (IntRange r)
+                      {
+                        Matrix<double> hres(k, v2.k);
+                        hres = FM().Cols(r) * Trans(v2.FM().Cols(r));
+                        lock_guard<mutex> guard(m);
+                        res += hres;
+                      });
+    return res;
+  }
+
+  
   template class S_BaseVector<double>;
   template class S_BaseVector<Complex>;
   
@@ -15,6 +15,7 @@ namespace ngla
 
   class BaseVector;
   class AutoVector;
+  class BaseMatrix;
 
   template <class SCAL> class S_BaseVector;
 
@@ -72,6 +73,21 @@ namespace ngla
   enum PARALLEL_STATUS { DISTRIBUTED, CUMULATED, NOT_PARALLEL };
 
 
+  /*
+    Fused kernels for Krylov-space updates of real vectors.
+    Every vector is streamed once, parallel + SIMD.
+  */
+  /// x += scal * v, returns (x,w)
+  NGS_DLL_HEADER double VecAddInnerProduct (FlatVector<double> x, double scal,
+                                            FlatVector<double> v, FlatVector<double> w);
+  /// x += scal1 * v1 + scal2 * v2
+  NGS_DLL_HEADER void VecAdd2 (FlatVector<double> x, double scal1, FlatVector<double> v1,
+                               double scal2, FlatVector<double> v2);
+  /// res(i) = (x, v[i])
+  NGS_DLL_HEADER void VecInnerProducts (FlatVector<double> x, FlatArray<FlatVector<double>> v,
+                                        FlatVector<double> res);
+
+
 
   /**
      Base vector for linalg
@@ -233,6 +249,14 @@ namespace ngla
     virtual BaseVector & Add (double scal, const BaseVector & v);
     virtual BaseVector & Add (Complex scal, const BaseVector & v);
 
+    /// this += scal * v, returns (this, w). Fused for real vectors
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w);
+    /// this += scal1 * v1 + scal2 * v2
+    virtual BaseVector & Add2 (double scal1, const BaseVector & v1,
+                               double scal2, const BaseVector & v2);
+    /// res(i) = (this, v[i]), a single global reduction
+    virtual void InnerProductsD (FlatArray<const BaseVector*> v, FlatVector<double> res) const;
+
     virtual ostream & Print (ostream & ost) const;
     virtual void Save(ostream & ost) const;
     virtual void Load(istream & ist);
@@ -490,6 +514,20 @@ namespace ngla
       return vec->Add (scal,v);
     }
 
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+    {
+      return vec->AddInnerProductD (scal, v, w);
+    }
+    virtual BaseVector & Add2 (double scal1, const BaseVector & v1,
+                               double scal2, const BaseVector & v2)
+    {
+      return vec->Add2 (scal1, v1, scal2, v2);
+    }
+    virtual void InnerProductsD (FlatArray<const BaseVector*> v, FlatVector<double> res) const
+    {
+      vec->InnerProductsD (v, res);
+    }
+
     virtual ostream & Print (ostream & ost) const
     {
       return vec->Print (ost);
@@ -1036,6 +1074,16 @@ namespace ngla
 
 
 
+  /// the terms of a real linear combination of vectors and matrix-vector products
+  struct DynamicTerms
+  {
+    Array<double> vec_coefs;
+    Array<const BaseVector*> vecs;
+    Array<double> mat_coefs;
+    Array<const BaseMatrix*> mats;
+    Array<const BaseVector*> mat_vecs;
+  };
+
   class DynamicBaseExpression 
   {
   protected:
@@ -1046,8 +1094,21 @@ namespace ngla
     virtual void AddTo (double s, BaseVector & v2) const = 0;
     virtual void AssignTo (Complex s, BaseVector & v2) const = 0;
     virtual void AddTo (Complex s, BaseVector & v2) const = 0;
+    /// appends the terms times s, false if the expression is no real linear combination
+    virtual bool CollectTerms (double s, DynamicTerms & terms) const { return false; }
+    /// a vector for the result
+    virtual AutoVector CreateVector () const = 0;
   };
 
+  /**
+     Evaluates y = s * expr, or y += s * expr, with all vector terms in one
+     cache-blocked pass, the matrix-vector products are added into y
+     directly. Returns false if the expression or the vectors do not allow
+     that, then the expression has to be evaluated term by term.
+  */
+  NGS_DLL_HEADER bool EvaluateFused (const DynamicBaseExpression & expr, double s,
+                                     BaseVector & y, bool add);
+
 
   class DynamicVecExpression : public DynamicBaseExpression
   {
@@ -1055,6 +1116,13 @@ namespace ngla
     shared_ptr<BaseVector> a;
   public:
     DynamicVecExpression (shared_ptr<BaseVector> aa) : a(aa) { ; }
+    AutoVector CreateVector () const override { return a->CreateVector(); }
+    bool CollectTerms (double s, DynamicTerms & terms) const override
+    {
+      terms.vec_coefs.Append (s);
+      terms.vecs.Append (a.get());
+      return true;
+    }
     void AssignTo (double s, BaseVector & v2) const override
     { v2.Set (s, *a); }
     void AddTo (double s, BaseVector & v2) const override
@@ -1092,6 +1160,9 @@ namespace ngla
     DynamicSumExpression (shared_ptr<DynamicBaseExpression> aa,
                           shared_ptr<DynamicBaseExpression> ab)
       : a(aa), b(ab) { ; } 
+    bool CollectTerms (double s, DynamicTerms & terms) const override
+    { return a->CollectTerms(s, terms) && b->CollectTerms(s, terms); }
+    AutoVector CreateVector () const override { return a->CreateVector(); }
   };
 
   class DynamicSubExpression : public DynamicBaseExpression
@@ -1121,6 +1192,9 @@ namespace ngla
     DynamicSubExpression (shared_ptr<DynamicBaseExpression> aa,
                           shared_ptr<DynamicBaseExpression> ab)
       : a(aa), b(ab) { ; } 
+    bool CollectTerms (double s, DynamicTerms & terms) const override
+    { return a->CollectTerms(s, terms) && b->CollectTerms(-s, terms); }
+    AutoVector CreateVector () const override { return a->CreateVector(); }
   };
 
   template <typename T>
@@ -1148,6 +1222,21 @@ namespace ngla
   public:
     DynamicScaleExpression (T ascale, shared_ptr<DynamicBaseExpression> aa)
       : scale(ascale), a(aa) { ; } 
+    bool CollectTerms (double s, DynamicTerms & terms) const override
+    {
+      if constexpr (is_same<T,double>::value)
+        return a->CollectTerms(s*scale, terms);
+      else
+        return false;
+    }
+    AutoVector CreateVector () const override
+    {
+      auto v = a->CreateVector();
+      if constexpr (is_same<T,Complex>::value)
+        if (!v.IsComplex())
+          return CreateBaseVector (v.Size(), true, v.EntrySize());
+      return v;
+    }
   };
 
 
@@ -1162,9 +1251,16 @@ namespace ngla
     DynamicVectorExpression (shared_ptr<BaseVector> v)
       : ve(make_shared<DynamicVecExpression>(v)) { } 
     void AssignTo (double s, BaseVector & v2) const
-    { ve->AssignTo(s,v2); }
+    { if (!EvaluateFused (*ve, s, v2, false)) ve->AssignTo(s,v2); }
     void AddTo (double s, BaseVector & v2) const
-    { ve->AddTo(s,v2); }
+    { if (!EvaluateFused (*ve, s, v2, true)) ve->AddTo(s,v2); }
+    /// the value in a new vector
+    AutoVector Evaluate () const
+    {
+      auto v = ve->CreateVector();
+      AssignTo (1, v);
+      return v;
+    }
     auto Ptr() const { return ve; }
   };
 
@@ -1186,6 +1282,47 @@ namespace ngla
 
 
 
+  /**
+     k real vectors of the same size in contiguous storage.
+     Vector j occupies entries [j*size, (j+1)*size), i.e. it is
+     row j of the k x size matrix FM(). Operators can stream through
+     their data once for all k vectors.
+   */
+  class NGS_DLL_HEADER MultiVector
+  {
+    size_t size;
+    size_t k;
+    Array<double> data;
+    /// keeps external memory alive
+    shared_ptr<void> owner;
+  public:
+    MultiVector (size_t asize, size_t ak)
+      : size(asize), k(ak), data(asize*ak) { data = 0.0; }
+    /// refers to external memory, e.g. the multidim components of a GridFunction
+    MultiVector (size_t asize, size_t ak, double * adata, shared_ptr<void> aowner)
+      : size(asize), k(ak), data(asize*ak, adata), owner(aowner) { ; }
+
+    /// size of every vector
+    size_t Size() const { return size; }
+    /// number of vectors
+    size_t NumVectors() const { return k; }
+    
+    /// k x size matrix, row j is vector j
+    FlatMatrix<double> FM() const { return FlatMatrix<double> (k, size, data.Data()); }
+    FlatVector<double> operator[] (size_t j) const { return FM().Row(j); }
+
+    /// a BaseVector referring to vector j
+    AutoVector GetVector (size_t j) const;
+    
+    MultiVector & operator= (double val) { data = val; return *this; }
+    MultiVector & operator= (const MultiVector & v2);
+
+    /// Gram matrix of inner products (*this)[i] * v2[j]
+    Matrix<double> InnerProduct (const MultiVector & v2) const;
+  };
+
+
+
 
 
   
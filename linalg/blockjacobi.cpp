@@ -308,6 +308,7 @@ namespace ngla
 
 
 
+  
   ///
   template <class TM, class TV_ROW, class TV_COL>
   BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
@@ -482,12 +483,69 @@ namespace ngla
     }
 
     /** Invert diagonal blocks **/
+    Array<bool> inverted(blocktable->Size());
+    inverted = false;
+    if constexpr (is_same<TM,double>::value)
+      {
+        // small blocks of equal size, SIMD-width many at once
+        static Timer tsimd("BlockJacobiPrecond ctor inv SIMD");
+        RegionTimer regsimd(tsimd);
+        constexpr size_t SW = SIMD<double>::Size();
+        constexpr size_t maxbs_simd = 32;
+
+        TableCreator<int> creator(maxbs_simd+1);
+        for ( ; !creator.Done(); creator++)
+          for (auto i : Range(*blocktable))
+            {
+              size_t bs = (*blocktable)[i].Size();
+              if (bs > 0 && bs <= maxbs_simd)
+                creator.Add (bs, i);
+            }
+        Table<int> blocks_by_size = creator.MoveTable();
+
+        // batch b consists of blocks sorted[first_in_batch[b]...first_in_batch[b+1]]
+        Array<int> sorted;
+        Array<int> first_in_batch;
+        for (auto bs : Range(blocks_by_size))
+          {
+            auto blocks = blocks_by_size[bs];
+            for (size_t j = 0; j < blocks.Size(); j++)
+              {
+                if (j % SW == 0)
+                  first_in_batch.Append (sorted.Size());
+                sorted.Append (blocks[j]);
+              }
+          }
+        first_in_batch.Append (sorted.Size());
+
+        ParallelForRange (first_in_batch.Size()-1, [&] (IntRange r)
+                          {
+                            Array<SliceMatrix<double>> mats;
+                            for (auto b : r)
+                              {
+                                auto batch = sorted.Range(first_in_batch[b], first_in_batch[b+1]);
+                                mats.SetSize0();
+                                for (auto nr : batch)
+                                  mats.Append (invdiag[nr]);
+                                // singular blocks are left unchanged, CalcInverse reports them
+                                try
+                                  {
+                                    BatchedCalcInverse (mats);
+                                    for (auto nr : batch)
+                                      inverted[nr] = true;
+                                  }
+                                catch (Exception &) { ; }
+                              }
+                          });
+      }
+    
     SharedLoop2 sl2(blocktable->Size());
     ParallelJob
       ([&] (const TaskInfo & ti)
        {
          NgProfiler::StartThreadTimer (tpar, TaskManager::GetThreadId());         
          for (auto i : sl2) {
+             if (inverted[i]) continue;
 	     NgProfiler::StartThreadTimer (tinv, TaskManager::GetThreadId());
 	     FlatMatrix<TM> & blockmat = invdiag[i];
 	     CalcInverse (blockmat);
@@ -586,6 +644,34 @@ namespace ngla
   }
 
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
+  ConvertInversesToFloat ()
+  {
+    if constexpr (is_same<TM,double>::value)
+      {
+        if (invdiag_float.Size()) return;
+        bigmem_float.SetSize (bigmem.Size());
+        ParallelForRange (bigmem.Size(), [&] (IntRange r)
+                          {
+                            for (auto i : r)
+                              bigmem_float[i] = bigmem[i];
+                          });
+
+        invdiag_float.SetSize (invdiag.Size());
+        size_t totmem = 0;
+        for (auto i : Range (*blocktable))
+          {
+            size_t bs = (*blocktable)[i].Size();
+            new ( & invdiag_float[i] ) FlatMatrix<float> (bs, bs, bigmem_float.Addr(totmem));
+            new ( & invdiag[i] ) FlatMatrix<TM> (0, 0, nullptr);
+            totmem += sqr (bs);
+          }
+        bigmem = Array<TM>();
+      }
+  }
+
+
   
   template <class TM, class TV_ROW, class TV_COL>
   void BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
@@ -620,7 +706,7 @@ namespace ngla
                  for (int j = 0; j < bs; j++)
                    hx(j) = fx((*blocktable)[i][j]);
                  
-                 hy = invdiag[i] * hx;
+                 MultBlockInverse (i, hx, hy);
                  
                  for (int j = 0; j < bs; j++)
                    fy((*blocktable)[i][j]) += s * hy(j);
@@ -630,6 +716,61 @@ namespace ngla
   }
 
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
+  MultAdd (double s, const MultiVector & x, MultiVector & y) const 
+  {
+    if constexpr (is_same<TM,double>::value && is_same<TV_ROW,double>::value)
+      {
+        static Timer timer("BlockJacobi::MultAdd MultiVector");
+        RegionTimer reg (timer);
+        size_t k = x.NumVectors();
+
+        FlatMatrix<double> fx = x.FM();
+        FlatMatrix<double> fy = y.FM();
+
+        for (int c : Range(block_coloring))        
+          {
+            ParallelForRange
+              (color_balance[c],  [&] (IntRange r) 
+               {
+                 Matrix<double> hxmax(maxbs, k);
+                 Matrix<double> hymax(maxbs, k);
+                 
+                 for (int i : block_coloring[c].Range(r))
+                   {
+                     FlatArray<int> block = (*blocktable)[i];
+                     int bs = block.Size();
+                     if (!bs) continue;
+                     
+                     FlatMatrix<double> hx = hxmax.Rows(0,bs); 
+                     FlatMatrix<double> hy = hymax.Rows(0,bs); 
+                     
+                     for (int j = 0; j < bs; j++)
+                       hx.Row(j) = fx.Col(block[j]);
+                     
+                     if (invdiag_float.Size())
+                       {
+                         FlatMatrix<float> inv = invdiag_float[i];
+                         hy = 0.0;
+                         for (int j = 0; j < bs; j++)
+                           for (int l = 0; l < bs; l++)
+                             hy.Row(j) += double(inv(j,l)) * hx.Row(l);
+                       }
+                     else
+                       hy = invdiag[i] * hx;
+                     
+                     for (int j = 0; j < bs; j++)
+                       fy.Col(block[j]) += s * hy.Row(j);
+                   }
+               });
+          }
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
+  }
+
+
   template <class TM, class TV_ROW, class TV_COL>
   void BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
   MultTransAdd (TSCAL s, const BaseVector & x, BaseVector & y) const 
@@ -665,7 +806,7 @@ namespace ngla
                  for (size_t j = 0; j < bs; j++)
                    hx(j) = fx(block[j]);
                  
-                 hy = Trans(invdiag[i]) * hx;
+                 MultTransBlockInverse (i, hx, hy);
                  
                  for (size_t j = 0; j < bs; j++)
                    fy(block[j]) += s * hy(j);
@@ -788,7 +929,7 @@ namespace ngla
                           hx(j) = fb(jj) - mat.RowTimesVector (jj, fx);
                         }
                       
-                      hy = (invdiag[i]) * hx;
+                      MultBlockInverse (i, hx, hy);
                       fx(block) += hy;
                     }
                 }
@@ -813,36 +954,66 @@ namespace ngla
 
     for (int k = 0; k < steps; k++)
       for (int c = block_coloring.Size()-1; c >=0; c--) 
-        {
-          ParallelForRange
-            (color_balance[c], [&] (IntRange r)
-             {
-               VectorMem<100,TVX> hxmax(maxbs);
-               VectorMem<100,TVX> hymax(maxbs);
-               
-               for (size_t i : block_coloring[c].Range(r))
-                 {
-                   FlatArray<int> block = (*blocktable)[i];
-                   size_t bs = block.Size();
-                   if (!bs) continue;
-                   
-                   FlatVector<TVX> hx = hxmax.Range(0,bs); 
-                   FlatVector<TVX> hy = hymax.Range(0,bs); 
-                   
-                   for (size_t j = 0; j < bs; j++)
-                     {
-                       auto jj = block[j];
-                       hx(j) = fb(jj) - mat.RowTimesVector (jj, fx);
-                     }
-                   
-                   hy = (invdiag[i]) * hx;
-                   fx(block) += hy;
-                 }
-             });
-        }
+        GSSmoothColor (c, fx, fb);
    }
 
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
+  GSSmoothSymmetric (BaseVector & x, const BaseVector & b,
+                     int steps) const 
+  {
+    static Timer timer ("BlockJacobiPrecond::GSSmoothSymmetric");
+    RegionTimer reg(timer);
+    timer.AddFlops (2*nze*steps);
+
+    const FlatVector<TVX> fb = b.FV<TVX> (); 
+    FlatVector<TVX> fx = x.FV<TVX> ();
+    int nc = block_coloring.Size();
+
+    for (int k = 0; k < steps; k++)
+      {
+        for (int c = 0; c < nc; c++)
+          GSSmoothColor (c, fx, fb);
+        // blocks of the last color are exact after the forward sweep
+        for (int c = nc-2; c >= 0; c--)
+          GSSmoothColor (c, fx, fb);
+      }
+  }
+
+
+  template <class TM, class TV_ROW, class TV_COL>
+  void BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
+  GSSmoothColor (int c, FlatVector<TVX> fx, FlatVector<TVX> fb) const
+  {
+    ParallelForRange
+      (color_balance[c], [&] (IntRange r)
+       {
+         VectorMem<100,TVX> hxmax(maxbs);
+         VectorMem<100,TVX> hymax(maxbs);
+         
+         for (size_t i : block_coloring[c].Range(r))
+           {
+             FlatArray<int> block = (*blocktable)[i];
+             size_t bs = block.Size();
+             if (!bs) continue;
+             
+             FlatVector<TVX> hx = hxmax.Range(0,bs); 
+             FlatVector<TVX> hy = hymax.Range(0,bs); 
+             
+             for (size_t j = 0; j < bs; j++)
+               {
+                 auto jj = block[j];
+                 hx(j) = fb(jj) - mat.RowTimesVector (jj, fx);
+               }
+             
+             MultBlockInverse (i, hx, hy);
+             fx(block) += hy;
+           }
+       });
+  }
+
+
 
 
 
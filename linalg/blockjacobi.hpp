@@ -61,6 +61,20 @@ namespace ngla
       GSSmoothBack (x, b, 1);
     }
 
+    /// symmetric block Gauss-Seidel: forward and backward sweep per step
+    virtual void GSSmoothSymmetric (BaseVector & x, const BaseVector & b,
+                                    int steps = 1) const
+    {
+      for (int k = 0; k < steps; k++)
+        {
+          GSSmooth (x, b, 1);
+          GSSmoothBack (x, b, 1);
+        }
+    }
+
+    /// store the block inverses in single precision (only real, non-symmetric storage)
+    virtual void ConvertInversesToFloat () { ; }
+
 
     /// reorders block entries for band-width minimization
     int Reorder (FlatArray<int> block, const MatrixGraph & graph,
@@ -119,6 +133,9 @@ namespace ngla
     Array<FlatMatrix<TM>> invdiag;
     /// the data for the inverses
     Array<TM> bigmem;
+    /// inverses in single precision, replace invdiag after ConvertInversesToFloat
+    Array<FlatMatrix<float>> invdiag_float;
+    Array<float> bigmem_float;
 
   public:
     // typedef typename mat_traits<TM>::TV_ROW TVX;
@@ -141,6 +158,8 @@ namespace ngla
     
     ///
     void MultAdd (TSCAL s, const BaseVector & x, BaseVector & y) const override;
+    /// applies every block inverse to all vectors at once
+    void MultAdd (double s, const MultiVector & x, MultiVector & y) const override;
 
     ///
     void MultTransAdd (TSCAL s, const BaseVector & x, BaseVector & y) const override;
@@ -152,6 +171,10 @@ namespace ngla
 
     void GSSmoothBack (BaseVector & x, const BaseVector & b,
                        int steps = 1) const override;
+
+    /// colors in parallel, one barrier per color
+    void GSSmoothSymmetric (BaseVector & x, const BaseVector & b,
+                            int steps = 1) const override;
   
     void GSSmoothResiduum (BaseVector & x, const BaseVector & b,
                            BaseVector & res, int steps = 1) const  override
@@ -176,9 +199,52 @@ namespace ngla
 	  int bs = (*blocktable)[i].Size();
 	  nels += bs*bs;
 	}
+      if (invdiag_float.Size())
+        return { MemoryUsage ("BlockJac (float)", nels*sizeof(float), blocktable->Size()) };
       return { MemoryUsage ("BlockJac", nels*sizeof(TM), blocktable->Size()) };
     }
 
+    void ConvertInversesToFloat () override;
+
+  protected:
+    /// block Gauss-Seidel for all blocks of color c, in parallel
+    void GSSmoothColor (int c, FlatVector<TVX> fx, FlatVector<TVX> fb) const;
+
+    /// hy = inverse of block i * hx
+    void MultBlockInverse (size_t i, FlatVector<TVX> hx, FlatVector<TVX> hy) const
+    {
+      if constexpr (is_same<TM,double>::value)
+        if (invdiag_float.Size())
+          {
+            FlatMatrix<float> inv = invdiag_float[i];
+            for (size_t j = 0; j < inv.Height(); j++)
+              {
+                TVX sum(0.0);
+                for (size_t k = 0; k < inv.Width(); k++)
+                  sum += double(inv(j,k)) * hx(k);
+                hy(j) = sum;
+              }
+            return;
+          }
+      hy = invdiag[i] * hx;
+    }
+
+    /// hy = transpose of inverse of block i * hx
+    void MultTransBlockInverse (size_t i, FlatVector<TVX> hx, FlatVector<TVX> hy) const
+    {
+      if constexpr (is_same<TM,double>::value)
+        if (invdiag_float.Size())
+          {
+            FlatMatrix<float> inv = invdiag_float[i];
+            hy = TVX(0.0);
+            for (size_t k = 0; k < inv.Height(); k++)
+              for (size_t j = 0; j < inv.Width(); j++)
+                hy(j) += double(inv(k,j)) * hx(k);
+            return;
+          }
+      hy = Trans(invdiag[i]) * hx;
+    }
+
 
   };
 
@@ -11,6 +11,7 @@
 */ 
 
 #include <la.hpp>
+#include "../parallel/parallelvector.hpp"
 
 namespace ngla
 {
@@ -506,12 +507,127 @@ namespace ngla
   }
 
 
+  template <class IPTYPE>
+  void CGSolver<IPTYPE> :: MultPipelined (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer timer ("CG solver, pipelined");
+    RegionTimer reg (timer);
+
+    try
+      {
+	if(sh)
+	  sh->SetThreadPercentage(0);
+
+        // r .. residual, u = C r, w = A u, m = C w, nv = A m
+        auto r = f.CreateVector();
+        auto u = f.CreateVector();
+        auto w = f.CreateVector();
+        auto m = f.CreateVector();
+        auto nv = f.CreateVector();
+        auto z = f.CreateVector();
+        auto q = f.CreateVector();
+        auto s = f.CreateVector();
+        auto p = f.CreateVector();
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+          r = f - (*a) * x;
+
+        if (c)
+          u = (*c) * r;
+        else
+          u = r;
+        w = (*a) * u;
+
+        InnerProductBatch<IPTYPE> ips;
+        SCAL gamma, delta, alpha, beta;
+        SCAL gamma_old = 0.0, alpha_old = 0.0;
+        double err = 0, lwstart = 0, lerr = 0;
+        int n = 0;
+
+        while (n < maxsteps && !(sh && sh->ShouldTerminate()))
+          {
+            ips.Start ( { { &u, &r }, { &u, &w } } );
+            if (c)
+              m = (*c) * w;
+            else
+              m = w;
+            nv = (*a) * m;
+            auto sums = ips.Wait();
+            gamma = sums[0];
+            delta = sums[1];
+
+            if (n == 0)
+              {
+                err = stop_absolute ? prec*prec : prec*prec*Abs(gamma);
+                lwstart = log(Abs(gamma));
+                lerr = log(err);
+              }
+            if (printrates) cout << IM(1) << n << " " << sqrt(Abs(gamma)) << endl;
+	    if (sh && n > 0)
+	      sh->SetThreadPercentage(100.*max2(double(n)/double(maxsteps),
+						(lwstart-log(Abs(gamma)))/(lwstart-lerr)));
+            if (Abs(gamma) <= err) break;
+
+            if (n == 0)
+              {
+                beta = 0.0;
+                if (delta == 0.0) break;
+                alpha = gamma / delta;
+                z = nv;
+                q = m;
+                s = w;
+                p = u;
+              }
+            else
+              {
+                beta = gamma / gamma_old;
+                SCAL denom = delta - beta * gamma / alpha_old;
+                if (denom == 0.0) break;
+                alpha = gamma / denom;
+                z *= beta;  z += nv;
+                q *= beta;  q += m;
+                s *= beta;  s += w;
+                p *= beta;  p += u;
+              }
+
+            x += alpha * p;
+            r -= alpha * s;
+            u -= alpha * q;
+            w -= alpha * z;
+
+            gamma_old = gamma;
+            alpha_old = alpha;
+            n++;
+          }
+	
+	const_cast<int&> (steps) = n;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in CGSolver::MultPipelined\n");
+	throw;
+      }
+  }
+
+  
   template <class IPTYPE>
   void CGSolver<IPTYPE> :: Mult (const BaseVector & f, BaseVector & u) const
   {
     static Timer timer ("CG solver");
     RegionTimer reg (timer);
 
+    if (pipelined)
+      {
+        MultPipelined (f, u);
+        return;
+      }
+
     int dim = 1;
 
     if(dynamic_cast<VVector< Vec<2, SCAL> >* >(&u))
@@ -605,18 +721,34 @@ namespace ngla
 	    
 	    al = wd / kss;
 	    u += al * s;
-	    d -= al * w;
-
-	    if (c)
-	      w = (*c) * d;
-	    else
-	      w = d;
-	    wdn = S_InnerProduct<IPTYPE> (d, w);
 
-	    be = wdn / wd;
-	    
-	    s *= be;
-	    s += w;
+            bool fused = false;
+            if constexpr (is_same<IPTYPE,double>::value)
+              if (!c)
+                {
+                  // update residual and compute its norm in one sweep
+                  wdn = d.AddInnerProductD (-al, w, d);
+                  be = wdn / wd;
+                  s *= be;
+                  s += d;
+                  fused = true;
+                }
+
+            if (!fused)
+              {
+                d -= al * w;
+                
+                if (c)
+                  w = (*c) * d;
+                else
+                  w = d;
+                wdn = S_InnerProduct<IPTYPE> (d, w);
+                
+                be = wdn / wd;
+                
+                s *= be;
+                s += w;
+              }
 
 	    if (printrates ) cout << IM(1) << n << " " << sqrt (Abs (wdn)) << endl;
 	    if ( sh )
@@ -665,6 +797,8 @@ namespace ngla
 	int n = 0;
 	SCAL rho_old, rho_new, beta, alpha, omega;
 	double err, err_i;
+        // (t,s) and (t,t) for omega, |r| and the next (r_tilde,r) are reduced together
+        InnerProductBatch<IPTYPE> ips;
 
 	if (initialize)
 	  {
@@ -697,12 +831,20 @@ namespace ngla
 
 	t = (*a) * s_tilde;
 
-	omega = S_InnerProduct<IPTYPE> (t, s) / S_InnerProduct<IPTYPE> (t, t);
+        ips.Reset();
+        ips.Add (t, s);
+        ips.Add (t, t);
+        ips.Compute();
+	omega = ips[0] / ips[1];
 	u += alpha * p_tilde + omega * s_tilde;
 	r = s;
 	r -= omega * t;
 
-	err_i = L2Norm(r);
+        ips.Reset();
+        ips.AddNorm2 (r);
+        ips.Add (r_tilde, r);
+        ips.Compute();
+	err_i = sqrt (Abs (ips[0]));
 	if (printrates) cout << IM(1) << "0 " << err_i << endl;
 
 
@@ -718,7 +860,7 @@ namespace ngla
 	while (n++ < maxsteps && err_i > err && !(sh && sh->ShouldTerminate()))
 	  {
 	    rho_old = rho_new;
-	    rho_new = S_InnerProduct<IPTYPE>(r_tilde, r);
+	    rho_new = ips[1];
 	    beta = (rho_new / rho_old ) * ( alpha / omega );
 	    p = r;
 	    p += beta * p;
@@ -749,12 +891,20 @@ namespace ngla
 
 	    t = (*a) * s_tilde;
 	    
-	    omega = S_InnerProduct<IPTYPE> (t, s) / S_InnerProduct<IPTYPE> (t, t);
+            ips.Reset();
+            ips.Add (t, s);
+            ips.Add (t, t);
+            ips.Compute();
+	    omega = ips[0] / ips[1];
 	    u +=  omega * s_tilde;
 	    r = s;
 	    r -= omega * t;
 
-	    err_i = L2Norm(r);
+            ips.Reset();
+            ips.AddNorm2 (r);
+            ips.Add (r_tilde, r);
+            ips.Compute();
+	    err_i = sqrt (Abs (ips[0]));
 
 	    if (printrates ) cout << IM(1) << n << " " << err_i << endl;
 	    if(sh)
@@ -928,15 +1078,47 @@ namespace ngla
                 av = hv;
               }
 
-            for (int i = 0; i <= j; i++)
-              h2(i,j) = h(i,j) = S_InnerProduct<IPTYPE> (*vi[i], av);
-
-            w = av;
-            for (int i = 0; i <= j; i++)
-              w -= h(i,j) * (*vi[i]);
+            if constexpr (is_same<IPTYPE,double>::value)
+              {
+                // all projections with one sweep and one reduction,
+                // subtract two basis vectors per sweep
+                ArrayMem<const BaseVector*,100> pvi(j+1);
+                for (int i = 0; i <= j; i++)
+                  pvi[i] = &*vi[i];
+                Vector<double> hj(j+1);
+                av.InnerProductsD (pvi, hj);
+                for (int i = 0; i <= j; i++)
+                  h2(i,j) = h(i,j) = hj(i);
+
+                w = av;
+                int i = 0;
+                for ( ; i+1 <= j; i += 2)
+                  w.Add2 (-hj(i), *vi[i], -hj(i+1), *vi[i+1]);
+                if (i <= j)
+                  w -= hj(i) * (*vi[i]);
+              }
+            else
+              {
+                InnerProductBatch<IPTYPE> ips;
+                for (int i = 0; i <= j; i++)
+                  ips.Add (*vi[i], av);
+                ips.Compute();
+                for (int i = 0; i <= j; i++)
+                  h2(i,j) = h(i,j) = ips[i];
+                
+                w = av;
+                for (int i = 0; i <= j; i++)
+                  w -= h(i,j) * (*vi[i]);
+              }
 
-            v = (1.0 / sqrt (S_InnerProduct<IPTYPE> (w, w))) * w;
-            h2(j+1,j) = h(j+1,j) = S_InnerProduct<IPTYPE> (v, av);
+            // (w,w) and (w,av) in one reduction, (v,av) = (w,av) / |w|
+            InnerProductBatch<IPTYPE> ipw;
+            ipw.Add (w, w);
+            ipw.Add (w, av);
+            ipw.Compute();
+            SCAL wnorm = sqrt (ipw[0]);
+            v = (1.0 / wnorm) * w;
+            h2(j+1,j) = h(j+1,j) = ipw[1] / wnorm;
 
             for (int i = 0; i < j; i++)
               {
@@ -1025,6 +1207,890 @@ namespace ngla
 
 
 
+  // block vectors have no contiguous memory
+  static bool IsBlockVector (const BaseVector & v)
+  {
+    if (auto av = dynamic_cast<const AutoVector*> (&v))
+      return dynamic_cast<const BlockVector*> (&**av) != nullptr;
+    return dynamic_cast<const BlockVector*> (&v) != nullptr;
+  }
+
+  template <class IPTYPE>
+  void FGMRESSolver<IPTYPE> :: Mult (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer t("FGMRESSolver::Mult"); RegionTimer reg(t);
+    static Timer tortho("FGMRESSolver::Mult - orthogonalize");
+
+    try
+      {
+        int m = (restart > 0) ? min2(restart, maxsteps) : maxsteps;
+        if (m < 1) m = 1;
+
+        auto r = f.CreateVector();
+        auto w = f.CreateVector();
+
+        // real, sequential vectors: the basis lives in one contiguous block,
+        // the multi-dot and the update stream through it once
+        bool contiguous = is_same<IPTYPE,double>::value && !f.IsComplex() &&
+          f.GetParallelStatus() == NOT_PARALLEL && f.EntrySize() == 1 && !IsBlockVector(f);
+        size_t n = contiguous ? f.FVDouble().Size() : 0;
+        unique_ptr<MultiVector> basis;
+        if (contiguous)
+          basis = make_unique<MultiVector> (n, m+1);
+        
+        Array<AutoVector> vi(m+1), zi(m);
+        for (int i = 0; i <= m; i++)
+          if (contiguous)
+            vi[i].AssignPointer (basis->GetVector(i));
+          else
+            vi[i].AssignPointer (f.CreateVector());
+        for (int i = 0; i < m; i++)
+          zi[i].AssignPointer (c ? f.CreateVector() : AutoVector(vi[i]));
+
+        // res(0..j) = (v_i, w), res(j+1) = (w,w) in one reduction
+        auto MultiDot = [&] (int j, FlatVector<SCAL> res)
+          {
+            if constexpr (is_same<IPTYPE,double>::value)
+              {
+                if (contiguous)
+                  {
+                    FlatVector<double> fw = w.FVDouble();
+                    FlatMatrix<double> fv = basis->FM().Rows(0, j+1);
+                    res = 0.0;
+                    mutex mtx;
+                    ParallelForRange (n, [&] (IntRange ri)
+                                      {
+                                        Vector<double> hres(j+2);
+                                        hres.Range(0,j+1) = fv.Cols(ri) * fw.Range(ri);
+                                        hres(j+1) = InnerProduct (fw.Range(ri), fw.Range(ri));
+                                        lock_guard<mutex> guard(mtx);
+                                        res += hres;
+                                      });
+                  }
+                else
+                  {
+                    ArrayMem<const BaseVector*,100> pvi(j+2);
+                    for (int i = 0; i <= j; i++)
+                      pvi[i] = &*vi[i];
+                    pvi[j+1] = &*w;
+                    w.InnerProductsD (pvi, res);
+                  }
+              }
+            else
+              {
+                for (int i = 0; i <= j; i++)
+                  res(i) = S_InnerProduct<IPTYPE> (*vi[i], w);
+                res(j+1) = S_InnerProduct<IPTYPE> (w, w);
+              }
+          };
+
+        // w -= sum_i h_i v_i
+        auto MultiSub = [&] (int j, FlatVector<SCAL> h)
+          {
+            if constexpr (is_same<IPTYPE,double>::value)
+              if (contiguous)
+                {
+                  FlatVector<double> fw = w.FVDouble();
+                  FlatMatrix<double> fv = basis->FM().Rows(0, j+1);
+                  ParallelForRange (n, [&] (IntRange ri)
+                                    {
+                                      fw.Range(ri) -= Trans(fv.Cols(ri)) * h.Range(0,j+1);
+                                    });
+                  return;
+                }
+            int i = 0;
+            if constexpr (is_same<SCAL,double>::value)
+              for ( ; i+1 <= j; i += 2)
+                w.Add2 (-h(i), *vi[i], -h(i+1), *vi[i+1]);
+            for ( ; i <= j; i++)
+              w -= h(i) * (*vi[i]);
+          };
+
+        Matrix<SCAL> h(m+1, m);
+        Vector<SCAL> hj(m+2), hj2(m+2), gammai(m+1), ci(m), si(m), y(m);
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+          r = f - (*a) * x;
+
+        double norm = sqrt (Abs (S_InnerProduct<IPTYPE> (r, r)));
+	if (printrates) cout << IM(1) << "0 " << norm << endl;
+
+	double err;
+	if(stop_absolute)
+	  err = prec;
+	else
+	  err = prec * norm;
+
+        int it = 0;
+        while (norm > err && it < maxsteps)
+          {
+            *vi[0] = (1.0/norm) * r;
+            gammai = SCAL(0.0);
+            gammai(0) = norm;
+
+            int j = 0;
+            for ( ; j < m && it < maxsteps; j++)
+              {
+                it++;
+                if (c)
+                  *zi[j] = (*c) * *vi[j];
+                w = (*a) * *zi[j];
+
+                // CGS2
+                RegionTimer rego(tortho);
+                MultiDot (j, hj.Range(0,j+2));
+                MultiSub (j, hj);
+                MultiDot (j, hj2.Range(0,j+2));
+                MultiSub (j, hj2);
+                
+                // |w|^2 after the second sweep by Pythagoras
+                double ww = Abs(hj2(j+1));
+                for (int i = 0; i <= j; i++)
+                  {
+                    ww -= sqr (Abs (hj2(i)));
+                    h(i,j) = hj(i) + hj2(i);
+                  }
+                if (ww < 1e-12 * Abs(hj2(j+1)))
+                  ww = Abs (S_InnerProduct<IPTYPE> (w, w));
+                double hnorm = sqrt (max2 (ww, 0.0));
+                h(j+1,j) = hnorm;
+                if (hnorm > 0)
+                  *vi[j+1] = (1.0/hnorm) * w;
+
+                // Givens rotations
+                for (int i = 0; i < j; i++)
+                  {
+                    SCAL hi = h(i,j), hip = h(i+1,j);
+                    h(i,j)   = Conj(ci(i)) * hi + Conj(si(i)) * hip;
+                    h(i+1,j) = -si(i) * hi + ci(i) * hip;
+                  }
+                double beta = sqrt (sqr(Abs(h(j,j))) + sqr(Abs(h(j+1,j))));
+                ci(j) = h(j,j) / beta;
+                si(j) = h(j+1,j) / beta;
+                h(j,j) = beta;
+                h(j+1,j) = 0.0;
+                gammai(j+1) = -si(j) * gammai(j);
+                gammai(j) = Conj(ci(j)) * gammai(j);
+                
+                norm = Abs (gammai(j+1));
+                if (printrates) cout << IM(1) << it << " " << norm << endl;
+                if (norm <= err || hnorm == 0) { j++; break; }
+              }
+
+            // x += Z y
+            for (int i = j-1; i >= 0; i--)
+              {
+                SCAL sum = gammai(i);
+                for (int k = i+1; k < j; k++)
+                  sum -= h(i,k) * y(k);
+                y(i) = sum / h(i,i);
+              }
+            for (int i = 0; i < j; i++)
+              x += y(i) * *zi[i];
+
+            if (norm > err && it < maxsteps)
+              {
+                // restart with the true residual
+                r = f - (*a) * x;
+                norm = sqrt (Abs (S_InnerProduct<IPTYPE> (r, r)));
+              }
+          }
+        
+	const_cast<int&> (steps) = it;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in FGMRESSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in FGMRESSolver::Mult\n"));
+      }
+  }
+
+
+
+
+
+  /*
+    Eigenvectors to the k smallest eigenvalues of  ga x = lam gm x,
+    ga symmetric, gm s.p.d. The columns of coefs are gm-orthonormal.
+    Returns false if gm is numerically singular.
+  */
+  static bool SmallestEigenVectors (FlatMatrix<double> ga, FlatMatrix<double> gm,
+                                    int k, Matrix<double> & coefs)
+  {
+    int dim = ga.Height();
+
+    // gm = L L^T
+    Matrix<double> l(dim, dim);
+    l = 0.0;
+    double maxdiag = 0;
+    for (int i = 0; i < dim; i++)
+      maxdiag = max2 (maxdiag, gm(i,i));
+    for (int j = 0; j < dim; j++)
+      {
+        double sum = gm(j,j);
+        for (int q = 0; q < j; q++)
+          sum -= sqr (l(j,q));
+        if (sum <= 1e-12 * maxdiag) return false;
+        l(j,j) = sqrt(sum);
+        for (int i = j+1; i < dim; i++)
+          {
+            double hsum = 0.5 * (gm(i,j)+gm(j,i));
+            for (int q = 0; q < j; q++)
+              hsum -= l(i,q) * l(j,q);
+            l(i,j) = hsum / l(j,j);
+          }
+      }
+    auto SolveL = [&] (SliceVector<double> v)
+      {
+        for (int i = 0; i < dim; i++)
+          {
+            double sum = v(i);
+            for (int q = 0; q < i; q++)
+              sum -= l(i,q) * v(q);
+            v(i) = sum / l(i,i);
+          }
+      };
+
+    // L^{-1} ga L^{-T}
+    Matrix<double> hat(dim, dim);
+    for (int i = 0; i < dim; i++)
+      for (int j = 0; j < dim; j++)
+        hat(i,j) = 0.5 * (ga(i,j)+ga(j,i));
+    for (int j = 0; j < dim; j++)
+      SolveL (hat.Col(j));
+    Matrix<double> hatt(dim, dim);
+    hatt = Trans(hat);
+    for (int j = 0; j < dim; j++)
+      SolveL (hatt.Col(j));
+
+    Vector<double> lami(dim);
+    Matrix<double> ev(dim, dim);
+#ifdef LAPACK
+    LapackEigenValuesSymmetric (hatt, lami, ev);
+#else
+    CalcEigenSystem (hatt, lami, ev);
+#endif
+    Array<int> index(dim);
+    for (int i = 0; i < dim; i++) index[i] = i;
+    QuickSort (index, [&] (int i, int j) { return lami(i) < lami(j); });
+
+    // x = L^{-T} y
+    coefs.SetSize (dim, k);
+    Vector<double> y(dim);
+    for (int col = 0; col < k; col++)
+      {
+        y = ev.Row(index[col]);
+        for (int i = dim; i-- > 0; )
+          {
+            double sum = y(i);
+            for (int q = i+1; q < dim; q++)
+              sum -= l(q,i) * y(q);
+            y(i) = sum / l(i,i);
+          }
+        coefs.Col(col) = y;
+      }
+    return true;
+  }
+
+  // y = sum_i coefs(i) x_i
+  template <class TV>
+  static void SetCombination (BaseVector & y, FlatArray<shared_ptr<BaseVector>> x, const TV & coefs)
+  {
+    y = 0.0;
+    for (size_t i = 0; i < x.Size(); i++)
+      y += coefs(i) * *x[i];
+  }
+
+
+  template <class IPTYPE>
+  void MinResSolver<IPTYPE> :: Mult (const BaseVector & f, BaseVector & u) const
+  {
+    static Timer t("MinResSolver::Mult"); RegionTimer reg(t);
+
+    try
+      {
+        // Lanczos vectors v, preconditioned z = C v, search directions w,
+        // old/current/new are rotated by index
+        Array<AutoVector> v(3), w(3), z(2);
+        for (int i = 0; i < 3; i++)
+          {
+            v[i].AssignPointer (f.CreateVector());
+            w[i].AssignPointer (f.CreateVector());
+          }
+        for (int i = 0; i < 2; i++)
+          z[i].AssignPointer (f.CreateVector());
+        auto mz = f.CreateVector();
+        int iold = 0, icur = 1, inew = 2;
+        int zcur = 0, znew = 1;
+
+        if (initialize)
+          {
+            u = 0.0;
+            v[icur] = f;
+          }
+        else
+          v[icur] = f - (*a) * u;
+
+        if (c)
+          z[zcur] = (*c) * v[icur];
+        else
+          z[zcur] = v[icur];
+
+        double gamma = sqrt (Abs (S_InnerProduct<IPTYPE> (z[zcur], v[icur])));
+        double resnorm = gamma;
+        double err = stop_absolute ? prec : prec * resnorm;
+        if (printrates) cout << IM(1) << "0 " << resnorm << endl;
+
+        int it = 0;
+        if (gamma > 0)
+          {
+            z[zcur] *= 1.0/gamma;
+            v[icur] *= 1.0/gamma;
+          }
+        v[iold] = 0.0;
+        w[iold] = 0.0;
+        w[icur] = 0.0;
+
+        double eta = gamma;
+        double cold = 1, ccur = 1, sold = 0, scur = 0;
+
+        while (it < maxsteps && resnorm > err && !(sh && sh->ShouldTerminate()))
+          {
+            it++;
+            mz = (*a) * z[zcur];
+            double delta = S_InnerProduct<IPTYPE> (mz, z[zcur]);
+
+            v[inew] = mz;
+            v[inew].Add2 (-delta, v[icur], -gamma, v[iold]);
+            if (c)
+              z[znew] = (*c) * v[inew];
+            else
+              z[znew] = v[inew];
+
+            double gamma_new = sqrt (Abs (S_InnerProduct<IPTYPE> (z[znew], v[inew])));
+            if (gamma_new > 0)
+              {
+                z[znew] *= 1.0/gamma_new;
+                v[inew] *= 1.0/gamma_new;
+              }
+
+            // QR factorization of the tridiagonal Lanczos matrix by Givens rotations
+            double alpha0 = ccur*delta - cold*scur*gamma;
+            double alpha1 = sqrt (sqr(alpha0) + sqr(gamma_new));
+            double alpha2 = scur*delta + cold*ccur*gamma;
+            double alpha3 = sold*gamma;
+            double cnew = alpha0/alpha1;
+            double snew = gamma_new/alpha1;
+
+            w[inew] = z[zcur];
+            w[inew].Add2 (-alpha3, w[iold], -alpha2, w[icur]);
+            w[inew] *= 1.0/alpha1;
+
+            u.Add (cnew*eta, w[inew]);
+            eta = -snew*eta;
+            resnorm *= fabs(snew);
+
+            if (printrates) cout << IM(1) << it << " " << resnorm << endl;
+
+            int hi = iold; iold = icur; icur = inew; inew = hi;
+            swap (zcur, znew);
+            sold = scur; scur = snew;
+            cold = ccur; ccur = cnew;
+            gamma = gamma_new;
+          }
+
+        const_cast<int&> (steps) = it;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in MinResSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in MinResSolver::Mult\n"));
+      }
+  }
+
+
+
+  template <class IPTYPE>
+  void DeflatedCGSolver<IPTYPE> :: Mult (const BaseVector & f, BaseVector & u) const
+  {
+    static Timer t("DeflatedCGSolver::Mult"); RegionTimer reg(t);
+    static Timer tdefl("DeflatedCGSolver::Mult - update subspace");
+
+    try
+      {
+        auto d = f.CreateVector();
+        auto w = f.CreateVector();
+        auto s = f.CreateVector();
+        auto as = f.CreateVector();
+
+        // A W and E^{-1} = (W^T A W)^{-1} for the current matrix
+        int k = wvecs.Size();
+        Array<shared_ptr<BaseVector>> awvecs(k);
+        for (int j = 0; j < k; j++)
+          {
+            awvecs[j] = f.CreateVector();
+            *awvecs[j] = (*a) * *wvecs[j];
+          }
+        Matrix<SCAL> einv(k, k);
+        for (int i = 0; i < k; i++)
+          for (int j = 0; j < k; j++)
+            einv(i,j) = S_InnerProduct<IPTYPE> (*wvecs[i], *awvecs[j]);
+        if (k) CalcInverse (einv);
+
+        // mu = E^{-1} X^T v
+        Vector<SCAL> hv(k), mu(k);
+        auto Coarse = [&] (FlatArray<shared_ptr<BaseVector>> x, const BaseVector & v)
+          {
+            for (int i = 0; i < k; i++)
+              hv(i) = S_InnerProduct<IPTYPE> (*x[i], v);
+            mu = einv * hv;
+          };
+
+	if (initialize)
+	  {
+	    u = 0.0;
+	    d = f;
+	  }
+	else
+          d = f - (*a) * u;
+
+	SCAL al, be, wd, wdn, kss;
+	if (c)
+	  w = (*c) * d;
+	else
+	  w = d;
+        // the relative criterion refers to the residual before the coarse correction
+	wdn = S_InnerProduct<IPTYPE> (w,d);
+	if (wdn == 0.0) wdn = 1;
+	double err;
+	if(stop_absolute)
+	  err = prec * prec;
+	else
+	  err = prec * prec * Abs (wdn);
+
+        if (k)
+          {
+            // u += W E^{-1} W^T d
+            Coarse (wvecs, d);
+            for (int j = 0; j < k; j++)
+              {
+                u += mu(j) * *wvecs[j];
+                d -= mu(j) * *awvecs[j];
+              }
+            if (c)
+              w = (*c) * d;
+            else
+              w = d;
+            wdn = S_InnerProduct<IPTYPE> (w,d);
+          }
+	if (printrates) cout << IM(1) << "0 " << sqrt(Abs(wdn)) << endl;
+
+        // s = w - W E^{-1} (AW)^T w
+        s = w;
+        if (k)
+          {
+            Coarse (awvecs, w);
+            for (int j = 0; j < k; j++)
+              s -= mu(j) * *wvecs[j];
+          }
+
+        // A-normalized search directions for the Ritz update
+        Array<shared_ptr<BaseVector>> pvecs, apvecs;
+
+	int n = 0;
+	while (n++ < maxsteps && Abs(wdn) > err && !(sh && sh->ShouldTerminate()))
+	  {
+	    as = (*a) * s;
+	    wd = wdn;
+	    kss = S_InnerProduct<IPTYPE> (s, as);
+	    if (kss == 0.0) break;
+
+            if (numdefl > 0 && int(pvecs.Size()) < numdirections)
+              {
+                double scal = 1.0 / sqrt (Abs (kss));
+                shared_ptr<BaseVector> p = f.CreateVector();
+                shared_ptr<BaseVector> ap = f.CreateVector();
+                *p = scal * s;
+                *ap = scal * as;
+                pvecs.Append (p);
+                apvecs.Append (ap);
+              }
+
+	    al = wd / kss;
+	    u += al * s;
+	    d -= al * as;
+
+	    if (c)
+	      w = (*c) * d;
+	    else
+	      w = d;
+	    wdn = S_InnerProduct<IPTYPE> (d, w);
+	    be = wdn / wd;
+
+	    s *= be;
+	    s += w;
+            if (k)
+              {
+                Coarse (awvecs, w);
+                for (int j = 0; j < k; j++)
+                  s -= mu(j) * *wvecs[j];
+              }
+
+	    if (printrates) cout << IM(1) << n << " " << sqrt (Abs (wdn)) << endl;
+	  }
+	const_cast<int&> (steps) = n;
+
+        // Rayleigh-Ritz for C A in Z = [W, P]:  (AZ)^T C (AZ) x = lam Z^T A Z x
+        int dim = k + pvecs.Size();
+        if (numdefl > 0 && dim > 0)
+          {
+            RegionTimer regd(tdefl);
+            Array<shared_ptr<BaseVector>> z, az;
+            for (int i = 0; i < k; i++)
+              {
+                z.Append (wvecs[i]);
+                az.Append (awvecs[i]);
+              }
+            for (size_t i = 0; i < pvecs.Size(); i++)
+              {
+                z.Append (pvecs[i]);
+                az.Append (apvecs[i]);
+              }
+
+            Matrix<SCAL> ga(dim, dim), gm(dim, dim);
+            for (int j = 0; j < dim; j++)
+              {
+                if (c)
+                  w = (*c) * *az[j];
+                else
+                  w = *az[j];
+                for (int i = 0; i < dim; i++)
+                  {
+                    ga(i,j) = S_InnerProduct<IPTYPE> (*az[i], w);
+                    gm(i,j) = S_InnerProduct<IPTYPE> (*z[i], *az[j]);
+                  }
+              }
+
+            int knew = min2 (numdefl, dim);
+            Matrix<double> coefs;
+            if (SmallestEigenVectors (ga, gm, knew, coefs))
+              {
+                Array<shared_ptr<BaseVector>> nw(knew);
+                for (int j = 0; j < knew; j++)
+                  {
+                    nw[j] = f.CreateVector();
+                    SetCombination (*nw[j], z, coefs.Col(j));
+                  }
+                wvecs = std::move(nw);
+              }
+          }
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in DeflatedCGSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in DeflatedCGSolver::Mult\n"));
+      }
+  }
+
+
+
+  template <class IPTYPE>
+  void RecycledGMRESSolver<IPTYPE> :: Mult (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer t("RecycledGMRESSolver::Mult"); RegionTimer reg(t);
+    static Timer trec("RecycledGMRESSolver::Mult - update subspace");
+
+    try
+      {
+        int m = max2 (restart, 1);
+        auto r = f.CreateVector();
+        auto w = f.CreateVector();
+
+        Array<shared_ptr<BaseVector>> vi(m+1), zi(m);
+        for (int i = 0; i <= m; i++)
+          vi[i] = f.CreateVector();
+        for (int i = 0; i < m; i++)
+          zi[i] = c ? shared_ptr<BaseVector>(f.CreateVector()) : vi[i];
+
+        // Q = A C U is made orthonormal, U and C U are transformed along
+        Array<shared_ptr<BaseVector>> cuvecs, qvecs;
+        auto Orthonormalize = [&] ()
+          {
+            Array<shared_ptr<BaseVector>> nu, ncu, nq;
+            for (size_t j = 0; j < qvecs.Size(); j++)
+              {
+                double nrm0 = sqrt (Abs (S_InnerProduct<IPTYPE> (*qvecs[j], *qvecs[j])));
+                for (int sweep = 0; sweep < 2; sweep++)
+                  for (size_t i = 0; i < nq.Size(); i++)
+                    {
+                      SCAL hij = S_InnerProduct<IPTYPE> (*nq[i], *qvecs[j]);
+                      *qvecs[j] -= hij * *nq[i];
+                      *uvecs[j] -= hij * *nu[i];
+                      if (c) *cuvecs[j] -= hij * *ncu[i];
+                    }
+                double nrm = sqrt (Abs (S_InnerProduct<IPTYPE> (*qvecs[j], *qvecs[j])));
+                if (nrm <= 1e-10 * nrm0) continue;   // numerically dependent, dropped
+                *qvecs[j] *= 1.0/nrm;
+                *uvecs[j] *= 1.0/nrm;
+                if (c) *cuvecs[j] *= 1.0/nrm;
+                nq.Append (qvecs[j]);
+                nu.Append (uvecs[j]);
+                ncu.Append (cuvecs[j]);
+              }
+            qvecs = std::move(nq);
+            uvecs = std::move(nu);
+            cuvecs = std::move(ncu);
+          };
+
+        // the matrix may have changed since the last solve
+        for (auto & u : uvecs)
+          {
+            shared_ptr<BaseVector> cu = u;
+            if (c)
+              {
+                cu = f.CreateVector();
+                *cu = (*c) * *u;
+              }
+            shared_ptr<BaseVector> q = f.CreateVector();
+            *q = (*a) * *cu;
+            cuvecs.Append (cu);
+            qvecs.Append (q);
+          }
+        Orthonormalize();
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+          r = f - (*a) * x;
+
+        double norm = sqrt (Abs (S_InnerProduct<IPTYPE> (r, r)));
+	if (printrates) cout << IM(1) << "0 " << norm << endl;
+
+	double err;
+	if(stop_absolute)
+	  err = prec;
+	else
+	  err = prec * norm;
+
+        int it = 0;
+        while (norm > err && it < maxsteps)
+          {
+            // x += C U Q^H r,  r -= Q Q^H r
+            int k = qvecs.Size();
+            for (int i = 0; i < k; i++)
+              {
+                SCAL hi = S_InnerProduct<IPTYPE> (*qvecs[i], r);
+                x += hi * *cuvecs[i];
+                r -= hi * *qvecs[i];
+              }
+            if (k)
+              {
+                norm = sqrt (Abs (S_InnerProduct<IPTYPE> (r, r)));
+                if (norm <= err) break;
+              }
+
+            // Arnoldi for (I - Q Q^H) A C, CGS2
+            int mm = max2 (m - k, 1);
+            Matrix<SCAL> h(mm+1, mm), hbar(mm+1, mm), b(k, mm);
+            hbar = SCAL(0.0);
+            b = SCAL(0.0);
+            Vector<SCAL> hj(mm+1), hq(k), gammai(mm+1), ci(mm), si(mm), y(mm);
+
+            *vi[0] = (1.0/norm) * r;
+            gammai = SCAL(0.0);
+            gammai(0) = norm;
+
+            int j = 0;
+            for ( ; j < mm && it < maxsteps; j++)
+              {
+                it++;
+                if (c)
+                  *zi[j] = (*c) * *vi[j];
+                w = (*a) * *zi[j];
+
+                for (int sweep = 0; sweep < 2; sweep++)
+                  {
+                    for (int i = 0; i < k; i++)
+                      hq(i) = S_InnerProduct<IPTYPE> (*qvecs[i], w);
+                    for (int i = 0; i <= j; i++)
+                      hj(i) = S_InnerProduct<IPTYPE> (*vi[i], w);
+                    for (int i = 0; i < k; i++)
+                      {
+                        w -= hq(i) * *qvecs[i];
+                        b(i,j) += hq(i);
+                      }
+                    for (int i = 0; i <= j; i++)
+                      {
+                        w -= hj(i) * *vi[i];
+                        hbar(i,j) += hj(i);
+                      }
+                  }
+                double hnorm = sqrt (Abs (S_InnerProduct<IPTYPE> (w, w)));
+                hbar(j+1,j) = hnorm;
+                if (hnorm > 0)
+                  *vi[j+1] = (1.0/hnorm) * w;
+                else
+                  *vi[j+1] = 0.0;
+                for (int i = 0; i <= j+1; i++)
+                  h(i,j) = hbar(i,j);
+
+                // Givens rotations
+                for (int i = 0; i < j; i++)
+                  {
+                    SCAL hi = h(i,j), hip = h(i+1,j);
+                    h(i,j)   = Conj(ci(i)) * hi + Conj(si(i)) * hip;
+                    h(i+1,j) = -si(i) * hi + ci(i) * hip;
+                  }
+                double beta = sqrt (sqr(Abs(h(j,j))) + sqr(Abs(h(j+1,j))));
+                ci(j) = h(j,j) / beta;
+                si(j) = h(j+1,j) / beta;
+                h(j,j) = beta;
+                h(j+1,j) = 0.0;
+                gammai(j+1) = -si(j) * gammai(j);
+                gammai(j) = Conj(ci(j)) * gammai(j);
+
+                norm = Abs (gammai(j+1));
+                if (printrates) cout << IM(1) << it << " " << norm << endl;
+                if (norm <= err || hnorm == 0) { j++; break; }
+              }
+
+            // x += Z y - C U B y
+            for (int i = j-1; i >= 0; i--)
+              {
+                SCAL sum = gammai(i);
+                for (int l = i+1; l < j; l++)
+                  sum -= h(i,l) * y(l);
+                y(i) = sum / h(i,i);
+              }
+            for (int i = 0; i < j; i++)
+              x += y(i) * *zi[i];
+            if (k)
+              {
+                Vector<SCAL> by(k);
+                by = b.Cols(0,j) * y.Range(0,j);
+                for (int i = 0; i < k; i++)
+                  x -= by(i) * *cuvecs[i];
+              }
+
+            // new U in span [U, V_j] minimizing |A C u| / |u|, where
+            // A C [U, V_j] = [Q, V_j+1] G,  G = [ I B ; 0 Hbar ]
+            if (numrecycle > 0 && j > 0)
+              {
+                RegionTimer regr(trec);
+                int nw = k+j, nv = k+j+1;
+                Matrix<SCAL> g(nv, nw);
+                g = SCAL(0.0);
+                for (int i = 0; i < k; i++)
+                  g(i,i) = 1.0;
+                g.Rows(0,k).Cols(k,nw) = b.Cols(0,j);
+                g.Rows(k,nv).Cols(k,nw) = hbar.Rows(0,j+1).Cols(0,j);
+
+                Matrix<SCAL> ga(nw, nw), gm(nw, nw);
+                ga = Trans(g) * g;
+                gm = SCAL(0.0);
+                for (int i = 0; i < nw; i++)
+                  gm(i,i) = 1.0;
+                for (int i = 0; i < k; i++)
+                  {
+                    for (int l = 0; l < k; l++)
+                      gm(i,l) = S_InnerProduct<IPTYPE> (*uvecs[i], *uvecs[l]);
+                    for (int l = 0; l < j; l++)
+                      gm(i,k+l) = gm(k+l,i) = S_InnerProduct<IPTYPE> (*uvecs[i], *vi[l]);
+                  }
+
+                int knew = min2 (numrecycle, nw);
+                Matrix<double> coefs;
+                if (SmallestEigenVectors (ga, gm, knew, coefs))
+                  {
+                    Array<shared_ptr<BaseVector>> what, cwhat, vhat;
+                    for (int i = 0; i < k; i++)
+                      {
+                        what.Append (uvecs[i]);
+                        cwhat.Append (cuvecs[i]);
+                        vhat.Append (qvecs[i]);
+                      }
+                    for (int l = 0; l < j; l++)
+                      {
+                        what.Append (vi[l]);
+                        cwhat.Append (zi[l]);
+                      }
+                    for (int l = 0; l <= j; l++)
+                      vhat.Append (vi[l]);
+
+                    Matrix<SCAL> gc(nv, knew);
+                    gc = g * coefs;
+                    Array<shared_ptr<BaseVector>> nu(knew), ncu(knew), nq(knew);
+                    for (int l = 0; l < knew; l++)
+                      {
+                        nu[l] = f.CreateVector();
+                        SetCombination (*nu[l], what, coefs.Col(l));
+                        ncu[l] = nu[l];
+                        if (c)
+                          {
+                            ncu[l] = f.CreateVector();
+                            SetCombination (*ncu[l], cwhat, coefs.Col(l));
+                          }
+                        nq[l] = f.CreateVector();
+                        SetCombination (*nq[l], vhat, gc.Col(l));
+                      }
+                    uvecs = std::move(nu);
+                    cuvecs = std::move(ncu);
+                    qvecs = std::move(nq);
+                    Orthonormalize();
+                  }
+              }
+
+            if (norm > err && it < maxsteps)
+              {
+                // next cycle with the true residual
+                r = f - (*a) * x;
+                norm = sqrt (Abs (S_InnerProduct<IPTYPE> (r, r)));
+              }
+          }
+
+	const_cast<int&> (steps) = it;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in RecycledGMRESSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in RecycledGMRESSolver::Mult\n"));
+      }
+  }
+
+
+
 
 
 
@@ -1090,6 +2156,19 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
 
       double normb = b.L2Norm();
 
+      // |y|, |z| and the next (z,y) with one reduction
+      InnerProductBatch<SCAL> ips;
+      auto ReduceNorms = [&] ()
+        {
+          ips.Reset();
+          ips.AddNorm2 (y);
+          ips.AddNorm2 (z);
+          ips.Add (z, y);
+          ips.Compute();
+          rho = sqrt (Abs (ips[0]));
+          xi = sqrt (Abs (ips[1]));
+        };
+
 
       if (initialize)
 	x = 0;
@@ -1121,8 +2200,6 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
       else
 	y = v_tld;
 
-      rho = y.L2Norm();
-      
       w_tld = r;
 
       if (c2) 
@@ -1131,7 +2208,7 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
       else
 	z = w_tld;
       
-      xi = z.L2Norm();
+      ReduceNorms();
 
       gamma = 1.0;
       eta = -1.0;
@@ -1165,7 +2242,8 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
 	  z /= xi;
 
 
-	  delta = S_InnerProduct<SCAL> (z, y);
+	  // (z,y) of the scaled vectors
+	  delta = ips[2] / (rho * xi);
 	  if (delta == 0.0)
 	    {
 	      (*testout) << "QMR: breakdown in delta" << endl;
@@ -1229,7 +2307,6 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
 
 
 	  rho_1 = rho;
-	  rho = y.L2Norm();
 
 	  w_tld = Transpose(*a) * q;
 	  w_tld -= beta * w;
@@ -1240,7 +2317,7 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
 	  else
 	    z = w_tld;
 	  
-	  xi = z.L2Norm();
+	  ReduceNorms();
 	  
 	  gamma_1 = gamma;
 	  theta_1 = theta;
@@ -1335,5 +2412,13 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
   template class GMRESSolver<ComplexConjugate>;
   template class GMRESSolver<ComplexConjugate2>;
 
+  template class FGMRESSolver<double>;
+  template class FGMRESSolver<Complex>;
+
+  template class MinResSolver<double>;
+
+  template class DeflatedCGSolver<double>;
+  template class RecycledGMRESSolver<double>;
+
 
 }
@@ -107,6 +107,10 @@ namespace ngla
     void MultiMult (const BaseVector & f, BaseVector & u, const int dim) const;
     ///
     void MultiMultSeed (const BaseVector & f, BaseVector & u, const int dim) const;
+    /// Ghysels-Vanroose pipelined CG
+    void MultPipelined (const BaseVector & f, BaseVector & u) const;
+    ///
+    bool pipelined = false;
   public:
     typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
     ///
@@ -120,6 +124,12 @@ namespace ngla
     CGSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac)
       : KrylovSpaceSolver (aa, ac) { ; }
 
+    /**
+       One fused global reduction per iteration, overlapped with
+       preconditioner and matrix-vector product. Numerically less 
+       stable than standard CG, pays off for many MPI ranks.
+    */
+    void SetPipelined (bool p = true) { pipelined = p; }
     ///
     NGS_DLL_HEADER virtual void Mult (const BaseVector & v, BaseVector & prod) const;
   };
@@ -196,7 +206,150 @@ namespace ngla
     ///
     virtual void Mult (const BaseVector & v, BaseVector & prod) const;
   };
-  
+
+
+  /**
+     Flexible GMRES, right preconditioned.
+     The preconditioner may change in every step (e.g. an inner Krylov
+     solver). Orthogonalization by classical Gram-Schmidt with
+     re-orthogonalization (CGS2), every sweep is one multi-dot, i.e.
+     two global reductions per iteration.
+  */
+  template <class IPTYPE>
+  class NGS_DLL_HEADER FGMRESSolver : public KrylovSpaceSolver
+  {
+    /// restart length, 0 means no restart
+    int restart = 0;
+  public:
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    ///
+    FGMRESSolver () 
+      : KrylovSpaceSolver () { ; }
+    ///
+    FGMRESSolver (shared_ptr<BaseMatrix> aa)
+      : KrylovSpaceSolver (aa) { ; }
+    ///
+    FGMRESSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac)
+      : KrylovSpaceSolver (aa, ac) { ; }
+    ///
+    void SetRestart (int arestart) { restart = arestart; }
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
+
+  /**
+     Preconditioned MinRes (Paige-Saunders) for symmetric, indefinite
+     systems like saddle point problems, the preconditioner has to be
+     symmetric and positive definite. Only vector operations of the
+     BaseVector, so it also runs on BlockVectors. The stopping
+     criterion uses the preconditioned residual.
+  */
+  template <class IPTYPE>
+  class NGS_DLL_HEADER MinResSolver : public KrylovSpaceSolver
+  {
+  public:
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    ///
+    MinResSolver () 
+      : KrylovSpaceSolver () { ; }
+    ///
+    MinResSolver (shared_ptr<BaseMatrix> aa)
+      : KrylovSpaceSolver (aa) { ; }
+    ///
+    MinResSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac)
+      : KrylovSpaceSolver (aa, ac) { ; }
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
+
+  /**
+     Deflated CG for sequences of systems with the same or a slowly
+     varying matrix (Saad, Yeung, Erhel, Guyomarc'h).
+     A few approximate eigenvectors W to the smallest eigenvalues of
+     C A are kept from solve to solve. The initial guess is corrected
+     in span W, and W is A-projected out of all search directions.
+     After every solve W is improved by Rayleigh-Ritz on W and the
+     first search directions. A W is recomputed at the beginning of
+     every solve, so the matrix may change in between.
+  */
+  template <class IPTYPE>
+  class NGS_DLL_HEADER DeflatedCGSolver : public KrylovSpaceSolver
+  {
+    /// dimension of the deflation space
+    int numdefl = 5;
+    /// search directions stored for the update of W
+    int numdirections = 10;
+    /// the deflation space
+    mutable Array<shared_ptr<BaseVector>> wvecs;
+  public:
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    ///
+    DeflatedCGSolver ()
+      : KrylovSpaceSolver () { ; }
+    ///
+    DeflatedCGSolver (shared_ptr<BaseMatrix> aa)
+      : KrylovSpaceSolver (aa) { ; }
+    ///
+    DeflatedCGSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac)
+      : KrylovSpaceSolver (aa, ac) { ; }
+    /// number of directions defaults to twice the deflation space
+    void SetDeflation (int anumdefl, int anumdirections = -1)
+    {
+      numdefl = anumdefl;
+      numdirections = (anumdirections >= 0) ? anumdirections : 2*anumdefl;
+    }
+    /// forget the deflation space, e.g. after a big change of the matrix
+    void ResetSubspace () { wvecs.SetSize(0); }
+    ///
+    int GetSubspaceSize () const { return wvecs.Size(); }
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
+
+  /**
+     Restarted, right preconditioned GMRES with subspace recycling
+     (GCRO-DR, Parks, de Sturler, Mackey, Johnson, Maiti).
+     The recycled vectors U satisfy A C U = Q with Q orthonormal, the
+     Arnoldi process runs on (I - Q Q^H) A C. At the end of every
+     cycle U is chosen from span [U, V] as the vectors minimizing
+     |A C u| / |u|, and kept for the next solve. Q is recomputed at the
+     beginning of every solve, so the matrix may change in between.
+  */
+  template <class IPTYPE>
+  class NGS_DLL_HEADER RecycledGMRESSolver : public KrylovSpaceSolver
+  {
+    /// length of a cycle including the recycled vectors
+    int restart = 30;
+    /// dimension of the recycled space
+    int numrecycle = 5;
+    /// the recycled space, in preconditioned coordinates
+    mutable Array<shared_ptr<BaseVector>> uvecs;
+  public:
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    ///
+    RecycledGMRESSolver ()
+      : KrylovSpaceSolver () { ; }
+    ///
+    RecycledGMRESSolver (shared_ptr<BaseMatrix> aa)
+      : KrylovSpaceSolver (aa) { ; }
+    ///
+    RecycledGMRESSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac)
+      : KrylovSpaceSolver (aa, ac) { ; }
+    ///
+    void SetRestart (int arestart) { restart = arestart; }
+    ///
+    void SetRecycle (int anumrecycle) { numrecycle = anumrecycle; }
+    ///
+    void ResetSubspace () { uvecs.SetSize(0); }
+    ///
+    int GetSubspaceSize () const { return uvecs.Size(); }
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
 
 
 
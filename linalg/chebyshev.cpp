@@ -78,4 +78,94 @@ namespace ngla
 	  }
       }
   }
+
+
+  
+  ChebyshevSmoother :: 
+  ChebyshevSmoother (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac,
+                     int aorder, double aratio, int estimation_steps)
+    : a(aa), c(ac), order(aorder), ratio(aratio)
+  {
+    if (!a || !c)
+      throw Exception ("ChebyshevSmoother needs matrix and preconditioner");
+    lmax = EstimateLambdaMax (estimation_steps);
+    lmin = lmax / ratio;
+  }
+
+  double ChebyshevSmoother :: EstimateLambdaMax (int steps) const
+  {
+    static Timer t("ChebyshevSmoother::EstimateLambdaMax"); RegionTimer reg(t);
+
+    auto v = a->CreateColVector();
+    auto av = a->CreateColVector();
+    auto cav = a->CreateColVector();
+
+    auto ip = [this] (const BaseVector & x, const BaseVector & y)
+      {
+        if (IsComplex())
+          return x.InnerProductC (y, true).real();
+        return x.InnerProductD (y);
+      };
+
+    v.SetRandom();
+    double lam = 0;
+    for (int i = 0; i < steps; i++)
+      {
+        av = (*a) * v;
+        cav = (*c) * av;
+        // Rayleigh quotient of C^{-1}A in the A-inner product
+        double vav = ip (v, av);
+        if (vav <= 0) break;
+        lam = ip (cav, av) / vav;
+        v = (1/sqrt(ip(cav, cav))) * cav;
+      }
+    if (lam <= 0)
+      throw Exception ("ChebyshevSmoother: could not estimate lambda_max, matrix not positive definite ?");
+
+    // power iteration under-estimates, add safety margin
+    return 1.1 * lam;
+  }
+
+  void ChebyshevSmoother :: Smooth (BaseVector & x, const BaseVector & b) const
+  {
+    static Timer t("ChebyshevSmoother::Smooth"); RegionTimer reg(t);
+
+    double theta = 0.5 * (lmax + lmin);
+    double delta = 0.5 * (lmax - lmin);
+    double sigma = theta / delta;
+    double rho = 1 / sigma;
+
+    auto r = b.CreateVector();
+    auto d = b.CreateVector();
+    auto w = b.CreateVector();
+
+    r = b - (*a) * x;
+    d = (*c) * r;
+    d *= 1/theta;
+    x += d;
+
+    for (int k = 1; k < order; k++)
+      {
+        r -= (*a) * d;
+        w = (*c) * r;
+        double rho_new = 1 / (2*sigma - rho);
+        d *= rho_new * rho;
+        d += (2*rho_new/delta) * w;
+        x += d;
+        rho = rho_new;
+      }
+  }
+
+  void ChebyshevSmoother :: Mult (const BaseVector & b, BaseVector & x) const
+  {
+    x = 0;
+    Smooth (x, b);
+  }
+
+  void ChebyshevSmoother :: MultAdd (double s, const BaseVector & b, BaseVector & x) const
+  {
+    auto hx = x.CreateVector();
+    Mult (b, hx);
+    x += s * hx;
+  }
 }
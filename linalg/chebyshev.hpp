@@ -36,6 +36,51 @@ namespace ngla
     AutoVector CreateColVector () const override { return a->CreateRowVector(); }
   };
 
+
+  /**
+     Polynomial (Chebyshev) smoother for C^{-1} A, usually with C^{-1} = D^{-1}.
+     The upper bound lambda_max is estimated by a few power iterations,
+     the smoother damps the interval [lambda_max/ratio, lambda_max].
+     Needs only matrix-vector products, thus it is fully parallel.
+  */
+  class NGS_DLL_HEADER ChebyshevSmoother : public BaseMatrix
+  {
+  protected:
+    shared_ptr<BaseMatrix> a, c;
+    /// degree of the smoothing polynomial
+    int order;
+    /// lmin = lmax / ratio
+    double ratio;
+    ///
+    double lmin, lmax;
+  public:
+    ///
+    ChebyshevSmoother (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac,
+                       int aorder = 3, double aratio = 30, int estimation_steps = 10);
+
+    bool IsComplex() const override { return a->IsComplex(); }
+    int VHeight() const override { return a->VHeight(); }
+    int VWidth() const override { return a->VWidth(); }
+    
+    /// power iteration for the largest eigenvalue of C^{-1} A
+    double EstimateLambdaMax (int steps) const;
+    ///
+    void SetBounds (double almin, double almax) { lmin = almin; lmax = almax; }
+    double GetLambdaMin () const { return lmin; }
+    double GetLambdaMax () const { return lmax; }
+    int GetOrder () const { return order; }
+    void SetOrder (int aorder) { order = aorder; }
+    
+    /// one smoothing step x += p(C^{-1}A) C^{-1} (b - A x)
+    void Smooth (BaseVector & x, const BaseVector & b) const;
+    ///
+    void Mult (const BaseVector & b, BaseVector & x) const override;
+    void MultAdd (double s, const BaseVector & b, BaseVector & x) const override;
+    ///
+    AutoVector CreateRowVector () const override { return a->CreateColVector(); }
+    AutoVector CreateColVector () const override { return a->CreateRowVector(); }
+  };
+
 }
 
 #endif
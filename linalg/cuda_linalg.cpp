@@ -8,10 +8,26 @@
 
 
 #include <la.hpp>
+#include "../parallel/parallelngs.hpp"
 #include <cublas_v2.h>
 #include <cusparse.h>
+#if defined(PARALLEL) && __has_include(<mpi-ext.h>)
+#include <mpi-ext.h>   // Open MPI: MPIX_CUDA_AWARE_SUPPORT
+#endif
 
 extern void SetScalar (double val, int n, double * dev_ptr);
+extern void MultDiag (int n, double s, const double * diag, const double * x,
+                      double beta, double * y);
+extern void BlockJacobiMultAdd (int nblocks, const int * firstind, const int * ind,
+                                const size_t * firstval, const double * inv,
+                                double s, const double * x, double * y);
+extern void CGUpdate (int n, const double * rho, const double * pq,
+                      double * x, double * r, const double * p, const double * q);
+extern void CGDirection (int n, const double * rho_new, const double * rho_old,
+                         const double * w, double * p);
+extern void DevGather (int n, const int * ind, const double * x, double * buf);
+extern void DevScatterAdd (int n, const int * ind, const double * buf, double * x);
+extern void DevSetIndirect (int n, const int * ind, double val, double * x);
 
 
 
@@ -103,11 +119,17 @@ namespace ngla
     (*this) = 0.0;
   }
 
+  UnifiedVector :: ~UnifiedVector ()
+  {
+    cudaFree (dev_data);
+    delete [] host_data;
+  }
+
   BaseVector & UnifiedVector :: operator= (double d)
   {
-    for (int i = 0; i < size; i++) host_data[i] = d;
+    // set on the device only, host is updated on demand
     ::SetScalar (d, size, dev_data);
-    host_uptodate = true;
+    host_uptodate = false;
     dev_uptodate = true;
     
     return *this;
@@ -157,7 +179,7 @@ namespace ngla
   
   BaseVector & UnifiedVector :: Scale (double scal)
   {
-    UpdateDevice();
+    RequireDevice();
     cublasDscal (Get_CuBlas_Handle(), size, &scal, dev_data, 1);
     host_uptodate = false;
     return *this;
@@ -171,6 +193,15 @@ namespace ngla
   
   BaseVector & UnifiedVector :: Set (double scal, const BaseVector & v)
   {
+    const UnifiedVector * v2 = dynamic_cast_UnifiedVector (&v);
+    if (v2 && v2->dev_uptodate)
+      {
+        cudaMemcpy (dev_data, v2->dev_data, sizeof(double)*size, cudaMemcpyDeviceToDevice);
+        dev_uptodate = true;
+        host_uptodate = false;
+        if (scal != 1) Scale (scal);
+        return *this;
+      }
     (*this) = 0.0;
     Add (scal, v);
     return *this;
@@ -182,8 +213,8 @@ namespace ngla
     const UnifiedVector * v2 = dynamic_cast_UnifiedVector (&v);
     if (v2)
       {
-	UpdateDevice();
-	v2->UpdateDevice();
+	RequireDevice();
+	v2->RequireDevice();
 	
 	cublasDaxpy (Get_CuBlas_Handle(), 
                      size, &scal, v2->dev_data, 1, dev_data, 1);
@@ -191,7 +222,7 @@ namespace ngla
       }
     else
       {
-	UpdateHost();
+	RequireHost();
 	VFlatVector<> (size, host_data) += scal * v;
 	dev_uptodate = false;
       }
@@ -205,8 +236,8 @@ namespace ngla
     const UnifiedVector * uv2 = dynamic_cast_UnifiedVector (&v2);
     if (uv2)
       {
-	UpdateDevice();
-	uv2->UpdateDevice();
+	RequireDevice();
+	uv2->RequireDevice();
 	
 	double res;
 	cublasDdot (Get_CuBlas_Handle(), 
@@ -230,6 +261,7 @@ namespace ngla
   void UnifiedVector :: UpdateHost () const
   {
     if (host_uptodate) return;
+    static Timer t("UnifiedVector::UpdateHost"); RegionTimer reg(t);
     if (!dev_uptodate) cout << "ERROR UnifiedVector::UpdateHost non is uptodate" << endl;
     cudaMemcpy (host_data, dev_data, sizeof(double)*size, cudaMemcpyDeviceToHost);    
     host_uptodate = true;
@@ -238,16 +270,32 @@ namespace ngla
   void UnifiedVector :: UpdateDevice () const
   {
     if (dev_uptodate) return;
+    static Timer t("UnifiedVector::UpdateDevice"); RegionTimer reg(t);
     if (!host_uptodate) cout << "ERROR UnifiedVector::UpdateDevice non is uptodate" << endl;
-    cout << "Host2Device copy !!!!!!!!!!!!!!" << endl;
     cudaMemcpy (dev_data, host_data, sizeof(double)*size, cudaMemcpyHostToDevice);
     dev_uptodate = true;
   }
 
+  void UnifiedVector :: RequireHost () const
+  {
+    if (host_uptodate) return;
+    if (!auto_migration)
+      throw Exception ("UnifiedVector: host data not up to date, call UpdateHost()");
+    UpdateHost();
+  }
+
+  void UnifiedVector :: RequireDevice () const
+  {
+    if (dev_uptodate) return;
+    if (!auto_migration)
+      throw Exception ("UnifiedVector: device data not up to date, call UpdateDevice()");
+    UpdateDevice();
+  }
+
   
   FlatVector<double> UnifiedVector :: FVDouble () const
   {
-    UpdateHost();
+    RequireHost();
     return FlatVector<> (size, host_data);
   }
   
@@ -258,7 +306,7 @@ namespace ngla
     
   void * UnifiedVector :: Memory() const throw()
   { 
-    UpdateHost(); 
+    RequireHost(); 
     return host_data;
   }
 
@@ -318,9 +366,7 @@ namespace ngla
     const UnifiedVector & ux = dynamic_cast_UnifiedVector (x);
     UnifiedVector & uy = dynamic_cast_UnifiedVector (y);
 
-    ux.UpdateDevice();
-    uy = 0.0;
-    uy.UpdateDevice();
+    ux.RequireDevice();
 
     double alpha= 1;
     double beta = 0;
@@ -330,6 +376,7 @@ namespace ngla
 		    dev_val, dev_ind, dev_col, 
 		    ux.dev_data, &beta, uy.dev_data);
 
+    uy.dev_uptodate = true;
     uy.host_uptodate = false;
     // cout << "mult complete" << endl;
   }
@@ -341,10 +388,10 @@ namespace ngla
     const UnifiedVector & ux = dynamic_cast_UnifiedVector (x);
     UnifiedVector & uy = dynamic_cast_UnifiedVector (y);
 
-    ux.UpdateDevice();
-    uy.UpdateDevice();
+    ux.RequireDevice();
+    uy.RequireDevice();
 
-    double alpha= 1;
+    double alpha= s;
     double beta = 1;
     cusparseDcsrmv (Get_CuSparse_Handle(), 
                     CUSPARSE_OPERATION_NON_TRANSPOSE, height, width, nze, 
@@ -356,6 +403,104 @@ namespace ngla
 
     // cout << "mult complete" << endl;
   }
+
+  void DevSparseMatrix :: MultAddRows (int nrows, double s, const double * dev_x,
+                                       double beta, double * dev_y) const
+  {
+    if (nrows == 0) return;
+    // the leading rows of a CSR matrix are a CSR matrix
+    int nzerows;
+    cudaMemcpy (&nzerows, dev_ind+nrows, sizeof(int), cudaMemcpyDeviceToHost);
+    cusparseDcsrmv (Get_CuSparse_Handle(), 
+                    CUSPARSE_OPERATION_NON_TRANSPOSE, nrows, width, nzerows, 
+		    &s, *descr, 
+		    dev_val, dev_ind, dev_col, 
+		    dev_x, &beta, dev_y);
+  }
+
+
+
+  DevHybridSparseMatrix :: DevHybridSparseMatrix (shared_ptr<SparseMatrix<double>> amat,
+                                                  double devfraction, bool aautotune)
+    : mat(amat), devmat(*amat), height(amat->Height()), width(amat->Width()),
+      autotune(aautotune)
+  {
+    SetSplit (int(devfraction * height));
+    cudaMalloc ((void**)&dev_tmp, max2(height,1) * sizeof(double));
+  }
+
+  DevHybridSparseMatrix :: ~DevHybridSparseMatrix ()
+  {
+    cudaFree (dev_tmp);
+  }
+
+  void DevHybridSparseMatrix :: Mult (const BaseVector & x, BaseVector & y) const
+  {
+    y = 0.0;
+    MultAdd (1, x, y);
+  }
+
+  void DevHybridSparseMatrix :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("DevHybridSparseMatrix::MultAdd"); RegionTimer reg(t);
+    const UnifiedVector & ux = dynamic_cast_UnifiedVector (x);
+    UnifiedVector & uy = dynamic_cast_UnifiedVector (y);
+
+    ux.RequireDevice();
+    ux.RequireHost();
+    uy.RequireHost();
+
+    cudaEvent_t start, stop;
+    cudaEventCreate (&start);
+    cudaEventCreate (&stop);
+
+    // device part is launched asynchronously ...
+    int mysplit = split;
+    cudaEventRecord (start);
+    devmat.MultAddRows (mysplit, 1, ux.DevData(), 0, dev_tmp);
+    cudaEventRecord (stop);
+
+    // ... while the host multiplies the remaining rows
+    double starttime = WallTime();
+    FlatVector<double> fx = ux.FVDouble();
+    FlatVector<double> fy = uy.FVDouble();
+    ParallelForRange (IntRange(mysplit, height), [&] (IntRange r)
+                      {
+                        for (auto i : r)
+                          {
+                            auto cols = mat->GetRowIndices(i);
+                            auto vals = mat->GetRowValues(i);
+                            double sum = 0;
+                            for (size_t j = 0; j < cols.Size(); j++)
+                              sum += vals[j] * fx(cols[j]);
+                            fy(i) += s * sum;
+                          }
+                      });
+    host_time = WallTime()-starttime;
+
+    // synchronizes with the device
+    Array<double> tmp(mysplit);
+    cudaMemcpy (tmp.Data(), dev_tmp, mysplit*sizeof(double), cudaMemcpyDeviceToHost);
+    float ms = 0;
+    cudaEventElapsedTime (&ms, start, stop);
+    dev_time = 1e-3 * ms;
+    cudaEventDestroy (start);
+    cudaEventDestroy (stop);
+
+    ParallelFor (mysplit, [&] (size_t i) { fy(i) += s * tmp[i]; });
+    uy.InvalidateDevice();
+
+    if (autotune && mysplit > 0 && mysplit < height && dev_time > 0 && host_time > 0)
+      {
+        // rows per second on both sides, balance the times, damped
+        double dev_rate = mysplit / dev_time;
+        double host_rate = (height-mysplit) / host_time;
+        int balanced = int(height * dev_rate / (dev_rate+host_rate));
+        // keep both sides busy, to continue measuring
+        balanced = min2(max2(balanced, height/100), height-height/100);
+        SetSplit ((mysplit+balanced)/2);
+      }
+  }
   
 
 
@@ -368,87 +513,309 @@ namespace ngla
 						      const BitArray & freedofs)
   {
     height = mat.Height();
-    width = mat.Height();
-    nze = mat.Height();
-
-    descr = new cusparseMatDescr_t;
-    cusparseCreateMatDescr (descr);
-
-    cusparseSetMatType(*descr, CUSPARSE_MATRIX_TYPE_GENERAL);
-    cusparseSetMatIndexBase(*descr, CUSPARSE_INDEX_BASE_ZERO);
 
     cout << "create Jacobi preconditioner" << endl;
     
-    Array<int> temp_ind (height+1); 
-    Array<int> temp_cols (height);
-    Array<double> temp_vals (height);
-
-    for (int i = 0; i <= height; i++) temp_ind[i] = i; 
-
+    Array<double> temp_diag (height);
     for (int i = 0; i < height; i++)
-      {
-	temp_cols[i] = i;
-	if (freedofs.Test(i))
-	  temp_vals[i] = 1.0 / mat(i,i);
-	else
-	  temp_vals[i] = 0.0;
-      }
-
-    cudaMalloc ((void**)&dev_ind, (height+1) * sizeof(int));
-    cudaMalloc ((void**)&dev_col, (height) * sizeof(int));
-    cudaMalloc ((void**)&dev_val, (height) * sizeof(double));
+      if (freedofs.Test(i))
+        temp_diag[i] = 1.0 / mat(i,i);
+      else
+        temp_diag[i] = 0.0;
 
-    cudaMemcpy (dev_ind, &temp_ind[0], (height+1)*sizeof(int), cudaMemcpyHostToDevice);
-    cudaMemcpy (dev_col, &temp_cols[0], height*sizeof(int), cudaMemcpyHostToDevice);
-    cudaMemcpy (dev_val, &temp_vals[0], height*sizeof(double), cudaMemcpyHostToDevice);
+    cudaMalloc ((void**)&dev_diag, height * sizeof(double));
+    cudaMemcpy (dev_diag, &temp_diag[0], height*sizeof(double), cudaMemcpyHostToDevice);
   }
   
   void DevJacobiPreconditioner :: Mult (const BaseVector & x, BaseVector & y) const
   {
-    // cout << "device mult precond" << endl;
-
     const UnifiedVector & ux = dynamic_cast_UnifiedVector (x);
     UnifiedVector & uy = dynamic_cast_UnifiedVector (y);
 
-    ux.UpdateDevice();
-    uy = 0.0;
-    uy.UpdateDevice();
+    ux.RequireDevice();
+    MultDiag (height, 1, dev_diag, ux.dev_data, 0, uy.dev_data);
 
-    double alpha= 1;
-    double beta = 0;
-    cusparseDcsrmv (Get_CuSparse_Handle (), 
-                    CUSPARSE_OPERATION_NON_TRANSPOSE, height, width, nze, 
-		    &alpha, *descr, 
-		    dev_val, dev_ind, dev_col, 
-		    ux.dev_data, &beta, uy.dev_data);
+    uy.dev_uptodate = true;
+    uy.host_uptodate = false;
+  }
+
+
+  void DevJacobiPreconditioner :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    const UnifiedVector & ux = dynamic_cast_UnifiedVector(x);
+    UnifiedVector & uy = dynamic_cast_UnifiedVector(y);
+
+    ux.RequireDevice();
+    uy.RequireDevice();
+    MultDiag (height, s, dev_diag, ux.dev_data, 1, uy.dev_data);
 
     uy.host_uptodate = false;
+  }
 
-    // cout << "mult complete" << endl;
+
+
+  DevBlockJacobiPreconditioner :: 
+  DevBlockJacobiPreconditioner (const SparseMatrix<double> & mat, const Table<int> & blocks)
+  {
+    static Timer t("DevBlockJacobiPreconditioner - setup"); RegionTimer reg(t);
+    height = mat.Height();
+    nblocks = blocks.Size();
+
+    Array<int> firstind(nblocks+1);
+    Array<size_t> firstval(nblocks+1);
+    firstind[0] = 0;
+    firstval[0] = 0;
+    for (int i = 0; i < nblocks; i++)
+      {
+        firstind[i+1] = firstind[i] + blocks[i].Size();
+        firstval[i+1] = firstval[i] + sqr(blocks[i].Size());
+      }
+
+    Array<int> ind(firstind[nblocks]);
+    Array<double> inv(firstval[nblocks]);
+    ParallelFor (nblocks, [&] (size_t i)
+                 {
+                   FlatArray<int> bl = blocks[i];
+                   int bs = bl.Size();
+                   FlatMatrix<double> binv(bs, bs, &inv[firstval[i]]);
+                   for (int k = 0; k < bs; k++)
+                     {
+                       ind[firstind[i]+k] = bl[k];
+                       for (int l = 0; l < bs; l++)
+                         binv(k,l) = mat(bl[k], bl[l]);
+                     }
+                   if (bs) CalcInverse (binv);
+                 });
+
+    cudaMalloc ((void**)&dev_firstind, (nblocks+1) * sizeof(int));
+    cudaMalloc ((void**)&dev_ind, ind.Size() * sizeof(int));
+    cudaMalloc ((void**)&dev_firstval, (nblocks+1) * sizeof(size_t));
+    cudaMalloc ((void**)&dev_inv, inv.Size() * sizeof(double));
+
+    cudaMemcpy (dev_firstind, &firstind[0], (nblocks+1)*sizeof(int), cudaMemcpyHostToDevice);
+    cudaMemcpy (dev_ind, ind.Data(), ind.Size()*sizeof(int), cudaMemcpyHostToDevice);
+    cudaMemcpy (dev_firstval, &firstval[0], (nblocks+1)*sizeof(size_t), cudaMemcpyHostToDevice);
+    cudaMemcpy (dev_inv, inv.Data(), inv.Size()*sizeof(double), cudaMemcpyHostToDevice);
   }
 
+  DevBlockJacobiPreconditioner :: ~DevBlockJacobiPreconditioner ()
+  {
+    cudaFree (dev_firstind);
+    cudaFree (dev_ind);
+    cudaFree (dev_firstval);
+    cudaFree (dev_inv);
+  }
 
-  void DevJacobiPreconditioner :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  void DevBlockJacobiPreconditioner :: Mult (const BaseVector & x, BaseVector & y) const
   {
-    cout << "device multadd precond" << endl;
+    UnifiedVector & uy = dynamic_cast_UnifiedVector (y);
+    uy = 0.0;
+    MultAdd (1, x, y);
+  }
 
+  void DevBlockJacobiPreconditioner :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
     const UnifiedVector & ux = dynamic_cast_UnifiedVector(x);
     UnifiedVector & uy = dynamic_cast_UnifiedVector(y);
 
-    ux.UpdateDevice();
-    uy.UpdateDevice();
-
-    double alpha= 1;
-    double beta = 1;
-    cusparseDcsrmv (Get_CuSparse_Handle (), 
-                    CUSPARSE_OPERATION_NON_TRANSPOSE, height, width, nze, 
-		    &alpha, *descr, 
-		    dev_val, dev_ind, dev_col, 
-		    ux.dev_data, &beta, uy.dev_data);
+    ux.RequireDevice();
+    uy.RequireDevice();
+    BlockJacobiMultAdd (nblocks, dev_firstind, dev_ind, dev_firstval, dev_inv,
+                        s, ux.dev_data, uy.dev_data);
 
     uy.host_uptodate = false;
-    cout << "mult complete" << endl;
   }
+
+
+
+  DevCGSolver :: DevCGSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac,
+                              int amaxsteps, double aprec, int acheck_every)
+    : a(aa), c(ac), maxsteps(amaxsteps), prec(aprec), check_every(acheck_every), steps(0)
+  { ; }
+
+  void DevCGSolver :: Mult (const BaseVector & b, BaseVector & x) const
+  {
+    static Timer t("DevCGSolver"); RegionTimer reg(t);
+    
+    const UnifiedVector & ub = dynamic_cast_UnifiedVector (b);
+    UnifiedVector & ux = dynamic_cast_UnifiedVector (x);
+    int n = ub.Size();
+    
+    UnifiedVector r(n), w(n), p(n), q(n);
+    
+    // rho_old, pq, rho_new in device memory
+    double * dev_scal;
+    cudaMalloc ((void**)&dev_scal, 3*sizeof(double));
+    double * rho_old = dev_scal;
+    double * pq = dev_scal+1;
+    double * rho_new = dev_scal+2;
+
+    // results of the reductions stay on the device,
+    // a and c must not use host-side cublas reductions
+    cublasHandle_t handle = Get_CuBlas_Handle();
+    auto DevDot = [&] (const UnifiedVector & v1, const UnifiedVector & v2, double * res)
+      {
+        cublasDdot (handle, n, v1.dev_data, 1, v2.dev_data, 1, res);
+      };
+
+    ux = 0.0;
+    ub.RequireDevice();
+    r.Set (1, ub);
+    c->Mult (r, w);
+    p.Set (1, w);
+
+    cublasSetPointerMode (handle, CUBLAS_POINTER_MODE_DEVICE);
+    DevDot (w, r, rho_old);
+    double err0;
+    cudaMemcpy (&err0, rho_old, sizeof(double), cudaMemcpyDeviceToHost);
+
+    steps = 0;
+    if (err0 > 0)
+      for (int it = 1; it <= maxsteps; it++)
+        {
+          a->Mult (p, q);
+          DevDot (p, q, pq);
+          CGUpdate (n, rho_old, pq, ux.dev_data, r.dev_data, p.dev_data, q.dev_data);
+          c->Mult (r, w);
+          DevDot (w, r, rho_new);
+          CGDirection (n, rho_new, rho_old, w.dev_data, p.dev_data);
+          swap (rho_old, rho_new);
+          steps = it;
+          
+          if (it % check_every == 0)
+            {
+              double err;
+              cudaMemcpy (&err, rho_old, sizeof(double), cudaMemcpyDeviceToHost);
+              if (err <= sqr(prec) * err0) break;
+            }
+        }
+    cublasSetPointerMode (handle, CUBLAS_POINTER_MODE_HOST);
+    cudaFree (dev_scal);
+    
+    ux.dev_uptodate = true;
+    ux.host_uptodate = false;
+  }
+
+
+
+  DevGMRESSolver :: DevGMRESSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac,
+                                    int amaxsteps, double aprec, int arestart)
+    : a(aa), c(ac), maxsteps(amaxsteps), prec(aprec), restart(arestart), steps(0)
+  { ; }
+
+  void DevGMRESSolver :: Mult (const BaseVector & b, BaseVector & x) const
+  {
+    static Timer t("DevGMRESSolver"); RegionTimer reg(t);
+
+    const UnifiedVector & ub = dynamic_cast_UnifiedVector (b);
+    UnifiedVector & ux = dynamic_cast_UnifiedVector (x);
+    int n = ub.Size();
+    int m = restart;
+    
+    UnifiedVector r(n), w(n), hv(n);
+    double * dev_basis;
+    double * dev_h;
+    cudaMalloc ((void**)&dev_basis, size_t(n)*(m+1)*sizeof(double));
+    cudaMalloc ((void**)&dev_h, (m+1)*sizeof(double));
+    
+    Matrix<double> H(m+1, m);
+    Vector<double> g(m+1), cs(m), sn(m), h(m+1), h2(m+1), y(m);
+    cublasHandle_t handle = Get_CuBlas_Handle();
+    double one = 1, zero = 0, mone = -1;
+
+    ux = 0.0;
+    ub.RequireDevice();
+    steps = 0;
+    double norm0 = -1;
+    
+    while (steps < maxsteps)
+      {
+        r.Set (1, ub);
+        a->MultAdd (-1, ux, r);
+        double beta;
+        cublasDnrm2 (handle, n, r.dev_data, 1, &beta);
+        if (norm0 < 0) norm0 = beta;
+        if (beta <= prec * norm0 || beta == 0) break;
+
+        double scal = 1/beta;
+        cublasDscal (handle, n, &scal, r.dev_data, 1);
+        cudaMemcpy (dev_basis, r.dev_data, n*sizeof(double), cudaMemcpyDeviceToDevice);
+        g = 0.0;
+        g(0) = beta;
+
+        int j = 0;
+        for ( ; j < m && steps < maxsteps; j++)
+          {
+            steps++;
+            // w = A C v_j
+            cudaMemcpy (r.dev_data, dev_basis+size_t(j)*n, n*sizeof(double), cudaMemcpyDeviceToDevice);
+            r.dev_uptodate = true; r.host_uptodate = false;
+            c->Mult (r, hv);
+            a->Mult (hv, w);
+
+            // CGS2: h = V^T w,  w -= V h, twice
+            h = 0.0;
+            for (int pass = 0; pass < 2; pass++)
+              {
+                cublasDgemv (handle, CUBLAS_OP_T, n, j+1, &one, dev_basis, n,
+                             w.dev_data, 1, &zero, dev_h, 1);
+                cublasDgemv (handle, CUBLAS_OP_N, n, j+1, &mone, dev_basis, n,
+                             dev_h, 1, &one, w.dev_data, 1);
+                cudaMemcpy (&h2(0), dev_h, (j+1)*sizeof(double), cudaMemcpyDeviceToHost);
+                h.Range(0,j+1) += h2.Range(0,j+1);
+              }
+            double hnorm;
+            cublasDnrm2 (handle, n, w.dev_data, 1, &hnorm);
+            h(j+1) = hnorm;
+            if (hnorm > 0)
+              {
+                double scal = 1/hnorm;
+                cublasDscal (handle, n, &scal, w.dev_data, 1);
+              }
+            cudaMemcpy (dev_basis+size_t(j+1)*n, w.dev_data, n*sizeof(double), cudaMemcpyDeviceToDevice);
+
+            // Givens rotations on the host
+            for (int k = 0; k < j; k++)
+              {
+                double tmp = cs(k)*h(k) + sn(k)*h(k+1);
+                h(k+1) = -sn(k)*h(k) + cs(k)*h(k+1);
+                h(k) = tmp;
+              }
+            double den = sqrt(sqr(h(j))+sqr(h(j+1)));
+            cs(j) = h(j) / den;
+            sn(j) = h(j+1) / den;
+            h(j) = den;
+            h(j+1) = 0;
+            g(j+1) = -sn(j)*g(j);
+            g(j) = cs(j)*g(j);
+            H.Col(j) = h;
+            
+            if (fabs(g(j+1)) <= prec * norm0) { j++; break; }
+          }
+
+        // y = H^{-1} g,  x += C V y
+        for (int k = j-1; k >= 0; k--)
+          {
+            double sum = g(k);
+            for (int l = k+1; l < j; l++)
+              sum -= H(k,l) * y(l);
+            y(k) = sum / H(k,k);
+          }
+        cudaMemcpy (dev_h, &y(0), j*sizeof(double), cudaMemcpyHostToDevice);
+        cublasDgemv (handle, CUBLAS_OP_N, n, j, &one, dev_basis, n,
+                     dev_h, 1, &zero, r.dev_data, 1);
+        r.dev_uptodate = true; r.host_uptodate = false;
+        c->MultAdd (1, r, ux);
+        
+        if (fabs(g(j)) <= prec * norm0) break;
+      }
+
+    cudaFree (dev_basis);
+    cudaFree (dev_h);
+    ux.dev_uptodate = true;
+    ux.host_uptodate = false;
+  }
+
   
 
 
@@ -465,6 +832,261 @@ namespace ngla
 
 
 
+  static bool CudaAwareMPI ()
+  {
+    static bool aware = [] ()
+      {
+        if (const char * env = getenv ("NGS_CUDA_AWARE_MPI"))
+          return string(env) != "0";
+#if defined(MPIX_CUDA_AWARE_SUPPORT) && MPIX_CUDA_AWARE_SUPPORT
+        return MPIX_Query_cuda_support() == 1;
+#else
+        return false;
+#endif
+      } ();
+    return aware;
+  }
+
+  static const ParallelUnifiedVector * dynamic_cast_ParallelUnifiedVector (const BaseVector * x)
+  {
+    if (auto ax = dynamic_cast<const AutoVector*> (x))
+      return dynamic_cast<const ParallelUnifiedVector*> (&**ax);
+    return dynamic_cast<const ParallelUnifiedVector*> (x);
+  }
+
+
+  ParallelUnifiedVector :: ParallelUnifiedVector (shared_ptr<ParallelDofs> apd, PARALLEL_STATUS stat)
+    : cuda_aware(CudaAwareMPI())
+  {
+    if (apd->GetEntrySize() != 1)
+      throw Exception ("ParallelUnifiedVector: only for entrysize 1");
+    size = apd->GetNDofLocal();
+    entrysize = 1;
+    uvec = make_shared<UnifiedVector> (size);
+    local_vec = uvec;
+    SetParallelDofs (apd);
+    status = stat;
+  }
+
+  ParallelUnifiedVector :: ~ParallelUnifiedVector ()
+  {
+    FreeExchange();
+  }
+
+  void ParallelUnifiedVector :: FreeExchange ()
+  {
+#ifdef PARALLEL
+    if (persistent_requests)
+      {
+        persistent_requests = false;
+        int finalized;
+        MPI_Finalized (&finalized);
+        if (!finalized)
+          {
+            for (auto & r : sreqs) MPI_Request_free (&r);
+            for (auto & r : rreqs) MPI_Request_free (&r);
+          }
+      }
+#endif
+    cudaFree (dev_exdofs);
+    cudaFree (dev_zerodofs);
+    cudaFree (dev_sendbuf);
+    cudaFree (dev_recvbuf);
+    dev_exdofs = dev_zerodofs = nullptr;
+    dev_sendbuf = dev_recvbuf = nullptr;
+  }
+
+  double * ParallelUnifiedVector :: MPIRecvBuffer (int p)
+  {
+    return (cuda_aware ? dev_recvbuf : host_recvbuf.Data()) + exfirst[p];
+  }
+
+  void ParallelUnifiedVector :: SetParallelDofs (shared_ptr<ParallelDofs> aparalleldofs,
+                                                 const Array<int> * procs)
+  {
+    if (paralleldofs == aparalleldofs) return;
+    FreeExchange();
+    paralleldofs = aparalleldofs;
+    if (!paralleldofs) return;
+
+    int ntasks = paralleldofs->GetNTasks();
+    int rank = paralleldofs->GetCommunicator().Rank();
+    exfirst.SetSize (ntasks+1);
+    exfirst[0] = 0;
+    for (int p = 0; p < ntasks; p++)
+      exfirst[p+1] = exfirst[p] + paralleldofs->GetExchangeDofs(p).Size();
+    int nex = exfirst[ntasks];
+
+    Array<int> exdofs(nex), zerodofs;
+    for (int p = 0; p < ntasks; p++)
+      {
+        auto dofs = paralleldofs->GetExchangeDofs(p);
+        exdofs.Range (exfirst[p], exfirst[p+1]) = dofs;
+        if (p < rank)
+          zerodofs.Append (dofs);
+      }
+    nzerodofs = zerodofs.Size();
+
+    cudaMalloc ((void**)&dev_exdofs, max(nex,1) * sizeof(int));
+    cudaMalloc ((void**)&dev_zerodofs, max(nzerodofs,1) * sizeof(int));
+    cudaMalloc ((void**)&dev_sendbuf, max(nex,1) * sizeof(double));
+    cudaMalloc ((void**)&dev_recvbuf, max(nex,1) * sizeof(double));
+    cudaMemcpy (dev_exdofs, exdofs.Data(), nex*sizeof(int), cudaMemcpyHostToDevice);
+    cudaMemcpy (dev_zerodofs, zerodofs.Data(), nzerodofs*sizeof(int), cudaMemcpyHostToDevice);
+    if (!cuda_aware)
+      {
+        host_sendbuf.SetSize (nex);
+        host_recvbuf.SetSize (nex);
+      }
+
+    // persistent requests on the packed buffers, device memory for a CUDA-aware MPI
+    auto dps = paralleldofs->GetDistantProcs();
+    sreqs.SetSize (dps.Size());
+    rreqs.SetSize (dps.Size());
+#ifdef PARALLEL
+    MPI_Comm comm = paralleldofs->GetCommunicator();
+    double * sendbuf = cuda_aware ? dev_sendbuf : host_sendbuf.Data();
+    for (auto k : Range(dps))
+      {
+        int p = dps[k], n = exfirst[p+1]-exfirst[p];
+        MPI_Send_init (sendbuf+exfirst[p], n, MPI_DOUBLE, p, MPI_TAG_SOLVE, comm, &sreqs[k]);
+        MPI_Recv_init (MPIRecvBuffer(p), n, MPI_DOUBLE, p, MPI_TAG_SOLVE, comm, &rreqs[k]);
+      }
+    persistent_requests = true;
+#endif
+  }
+
+  void ParallelUnifiedVector :: PackSendValues () const
+  {
+    static Timer t("ParallelUnifiedVector::Pack"); RegionTimer reg(t);
+    int nex = exfirst.Last();
+    uvec->RequireDevice();
+    DevGather (nex, dev_exdofs, uvec->DevData(), dev_sendbuf);
+    if (cuda_aware)
+      cudaDeviceSynchronize();   // MPI reads the buffer on its own
+    else
+      cudaMemcpy (const_cast<double*>(host_sendbuf.Data()), dev_sendbuf,
+                  nex*sizeof(double), cudaMemcpyDeviceToHost);
+  }
+
+  void ParallelUnifiedVector :: IRecvVec (int dest, MPI_Request & request)
+  {
+#ifdef PARALLEL
+    MPI_Irecv (MPIRecvBuffer(dest), exfirst[dest+1]-exfirst[dest], MPI_DOUBLE,
+               dest, MPI_TAG_SOLVE, paralleldofs->GetCommunicator(), &request);
+#endif
+  }
+
+  void ParallelUnifiedVector :: AddRecvValues (int sender)
+  {
+    int first = exfirst[sender], n = exfirst[sender+1]-first;
+    if (!cuda_aware)
+      cudaMemcpy (dev_recvbuf+first, host_recvbuf.Data()+first,
+                  n*sizeof(double), cudaMemcpyHostToDevice);
+    DevScatterAdd (n, dev_exdofs+first, dev_recvbuf+first, uvec->DevData());
+    uvec->InvalidateHost();
+  }
+
+  void ParallelUnifiedVector :: Distribute () const
+  {
+    if (status != CUMULATED) return;
+    uvec->RequireDevice();
+    DevSetIndirect (nzerodofs, dev_zerodofs, 0.0, uvec->DevData());
+    uvec->InvalidateHost();
+    SetStatus (DISTRIBUTED);
+  }
+
+  void * ParallelUnifiedVector :: Memory () const
+  {
+    return uvec->Memory();
+  }
+
+  FlatVector<double> ParallelUnifiedVector :: FVDouble () const
+  {
+    return uvec->FVDouble();
+  }
+
+  FlatVector<Complex> ParallelUnifiedVector :: FVComplex () const
+  {
+    throw Exception ("unified complex not yet supported");
+  }
+
+  AutoVector ParallelUnifiedVector :: CreateVector () const
+  {
+    return make_shared<ParallelUnifiedVector> (paralleldofs, status);
+  }
+
+  BaseVector & ParallelUnifiedVector :: Scale (double scal)
+  {
+    uvec->Scale (scal);
+    return *this;
+  }
+
+  BaseVector & ParallelUnifiedVector :: SetScalar (double scal)
+  {
+    (*uvec) = scal;
+    SetStatus (IsParallelVector() ? CUMULATED : NOT_PARALLEL);
+    return *this;
+  }
+
+  BaseVector & ParallelUnifiedVector :: Set (double scal, const BaseVector & v)
+  {
+    auto pv = dynamic_cast_ParallelUnifiedVector (&v);
+    if (!pv)
+      {
+        // on the host
+        ParallelBaseVector::Set (scal, v);
+        uvec->InvalidateDevice();
+        return *this;
+      }
+    uvec->Set (scal, *pv->uvec);
+    SetParallelDofs (pv->GetParallelDofs());
+    SetStatus (pv->Status());
+    return *this;
+  }
+
+  BaseVector & ParallelUnifiedVector :: Add (double scal, const BaseVector & v)
+  {
+    auto pv = dynamic_cast_ParallelUnifiedVector (&v);
+    if (!pv)
+      {
+        ParallelBaseVector::Add (scal, v);
+        uvec->InvalidateDevice();
+        return *this;
+      }
+    if (Status() != pv->Status())
+      {
+        if (Status() == DISTRIBUTED)
+          Cumulate();
+        else
+          pv->Cumulate();
+      }
+    uvec->Add (scal, *pv->uvec);
+    return *this;
+  }
+
+  double ParallelUnifiedVector :: InnerProduct (const BaseVector & v2, bool conjugate) const
+  {
+    auto pv = dynamic_cast_ParallelUnifiedVector (&v2);
+    if (!pv)
+      return S_ParallelBaseVector<double>::InnerProduct (v2, conjugate);
+    if (Status() == pv->Status() && Status() == DISTRIBUTED)
+      Cumulate();
+    else if (Status() == pv->Status() && Status() == CUMULATED)
+      Distribute();
+    double localsum = uvec->InnerProduct (*pv->uvec);
+    if (Status() == NOT_PARALLEL && pv->Status() == NOT_PARALLEL)
+      return localsum;
+    return paralleldofs->GetCommunicator().AllReduce (localsum, MPI_SUM);
+  }
+
+  ostream & ParallelUnifiedVector :: Print (ostream & ost) const
+  {
+    PrintStatus (ost);
+    return uvec->Print (ost);
+  }
+
+
   /*
   class InitCuBlasHandle
   {
@@ -13,9 +13,12 @@ namespace ngla
     double * dev_data;
     mutable bool host_uptodate;
     mutable bool dev_uptodate;
+    /// if false, host <-> device copies happen only by explicit UpdateHost/UpdateDevice
+    bool auto_migration = true;
     
   public:
     UnifiedVector (int asize);
+    ~UnifiedVector ();
     
     BaseVector & operator= (double d);
     BaseVector & operator= (BaseVector & v2);
@@ -36,8 +39,22 @@ namespace ngla
     virtual double InnerProduct (const BaseVector & v2) const;
 
 
+    /// explicit migration
     void UpdateHost () const;
     void UpdateDevice () const;
+    /// data is only valid on the device / host
+    void InvalidateHost () const { host_uptodate = false; }
+    void InvalidateDevice () const { dev_uptodate = false; }
+    bool IsHostUpToDate () const { return host_uptodate; }
+    bool IsDevUpToDate () const { return dev_uptodate; }
+    /// copy implicitly when an operation needs the data (default)
+    void SetAutoMigration (bool b) { auto_migration = b; }
+    bool GetAutoMigration () const { return auto_migration; }
+    /// migrate if allowed, throw otherwise
+    void RequireHost () const;
+    void RequireDevice () const;
+
+    double * DevData () const { return dev_data; }
 
 
     virtual ostream & Print (ostream & ost) const;    
@@ -56,6 +73,7 @@ namespace ngla
     
     friend class DevSparseMatrix;
     friend class DevJacobiPreconditioner;
+    friend class DevBlockJacobiPreconditioner;
   };
 
   class DevSparseMatrix : public BaseMatrix
@@ -69,27 +87,150 @@ namespace ngla
     DevSparseMatrix (const SparseMatrix<double> & mat);
     virtual void Mult (const BaseVector & x, BaseVector & y) const;
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const;
+
+    virtual int VHeight() const { return height; }
+    virtual int VWidth() const { return width; }
+    virtual AutoVector CreateRowVector () const { return make_shared<UnifiedVector> (width); }
+    virtual AutoVector CreateColVector () const { return make_shared<UnifiedVector> (height); }
+
+    /// the CSR arrays on the device, for the assembly on the device
+    int * DevRowStart () const { return dev_ind; }
+    int * DevCol () const { return dev_col; }
+    double * DevVal () const { return dev_val; }
+    int NZE () const { return nze; }
+
+    /// y = s * A x + beta y for the first nrows rows, asynchronous
+    void MultAddRows (int nrows, double s, const double * dev_x, double beta, double * dev_y) const;
   };
 
 
-  class DevJacobiPreconditioner : public BaseMatrix
+  /**
+     Sparse matrix-vector product shared by the device and the host: the
+     first rows are multiplied on the device, the remaining rows by the
+     task manager at the same time. With autotune the split is moved
+     after every product such that both parts need the same time,
+     measured by cuda events and the wall clock.
+
+     The result is valid on the host, the input vector is needed on the
+     device and on the host.
+  */
+  class DevHybridSparseMatrix : public BaseMatrix
   {
-    // should be like this:
-    // double * dev_diag;
-    // int size;
+    shared_ptr<SparseMatrix<double>> mat;
+    DevSparseMatrix devmat;
+    double * dev_tmp;
+    int height, width;
+    /// rows [0, split) on the device
+    mutable int split;
+    bool autotune;
+    mutable double dev_time = 0, host_time = 0;
+  public:
+    DevHybridSparseMatrix (shared_ptr<SparseMatrix<double>> amat,
+                           double devfraction = 0.5, bool aautotune = true);
+    ~DevHybridSparseMatrix ();
+    virtual void Mult (const BaseVector & x, BaseVector & y) const;
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const;
 
-    // stored as sparse matrix ...
-    cusparseMatDescr_t * descr;
-    int * dev_ind;
-    int * dev_col;
-    double * dev_val;
-    int height, width, nze;
-    
+    int GetSplit () const { return split; }
+    void SetSplit (int asplit) { split = min2(max2(asplit, 0), height); }
+    /// time of the device and host part of the last product
+    double GetDeviceTime () const { return dev_time; }
+    double GetHostTime () const { return host_time; }
+
+    virtual int VHeight() const { return height; }
+    virtual int VWidth() const { return width; }
+    virtual AutoVector CreateRowVector () const { return make_shared<UnifiedVector> (width); }
+    virtual AutoVector CreateColVector () const { return make_shared<UnifiedVector> (height); }
+  };
+
+
+  class DevJacobiPreconditioner : public BaseMatrix
+  {
+    // inverse diagonal, zero for non-free dofs
+    double * dev_diag;
+    int height;
 
   public:
     DevJacobiPreconditioner (const SparseMatrix<double> & mat, const BitArray & freedofs);
     virtual void Mult (const BaseVector & x, BaseVector & y) const;
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const;
+
+    virtual int VHeight() const { return height; }
+    virtual int VWidth() const { return height; }
+    virtual AutoVector CreateRowVector () const { return make_shared<UnifiedVector> (height); }
+    virtual AutoVector CreateColVector () const { return make_shared<UnifiedVector> (height); }
+  };
+
+
+  /// block-Jacobi with dense inverses of the blocks on the device
+  class DevBlockJacobiPreconditioner : public BaseMatrix
+  {
+    int height, nblocks;
+    int * dev_firstind;     // nblocks+1
+    int * dev_ind;          // dofs of all blocks
+    size_t * dev_firstval;  // nblocks+1
+    double * dev_inv;       // row-major inverses
+    
+  public:
+    DevBlockJacobiPreconditioner (const SparseMatrix<double> & mat, const Table<int> & blocks);
+    ~DevBlockJacobiPreconditioner ();
+    virtual void Mult (const BaseVector & x, BaseVector & y) const;
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const;
+
+    virtual int VHeight() const { return height; }
+    virtual int VWidth() const { return height; }
+    virtual AutoVector CreateRowVector () const { return make_shared<UnifiedVector> (height); }
+    virtual AutoVector CreateColVector () const { return make_shared<UnifiedVector> (height); }
+  };
+
+
+  /**
+     CG with all vector updates and reductions on the device.
+     Scalars stay in device memory, the residual is copied to the host
+     only every check_every iterations.
+  */
+  class DevCGSolver : public BaseMatrix
+  {
+    shared_ptr<BaseMatrix> a, c;
+    int maxsteps;
+    double prec;
+    int check_every;
+    mutable int steps;
+  public:
+    DevCGSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac,
+                 int amaxsteps = 200, double aprec = 1e-8, int acheck_every = 10);
+    virtual void Mult (const BaseVector & b, BaseVector & x) const;
+    int GetSteps () const { return steps; }
+
+    virtual int VHeight() const { return a->VWidth(); }
+    virtual int VWidth() const { return a->VHeight(); }
+    virtual AutoVector CreateRowVector () const { return a->CreateColVector(); }
+    virtual AutoVector CreateColVector () const { return a->CreateRowVector(); }
+  };
+
+  /**
+     Restarted GMRES(m) with right preconditioning on the device.
+     The Krylov basis is stored contiguously, orthogonalization is
+     classical Gram-Schmidt with re-orthogonalization as two gemv calls.
+     Only the Hessenberg column is copied to the host.
+  */
+  class DevGMRESSolver : public BaseMatrix
+  {
+    shared_ptr<BaseMatrix> a, c;
+    int maxsteps;
+    double prec;
+    int restart;
+    mutable int steps;
+  public:
+    DevGMRESSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac,
+                    int amaxsteps = 200, double aprec = 1e-8, int arestart = 30);
+    virtual void Mult (const BaseVector & b, BaseVector & x) const;
+    int GetSteps () const { return steps; }
+
+    virtual int VHeight() const { return a->VWidth(); }
+    virtual int VWidth() const { return a->VHeight(); }
+    virtual AutoVector CreateRowVector () const { return a->CreateColVector(); }
+    virtual AutoVector CreateColVector () const { return a->CreateRowVector(); }
   };
 
 }
@@ -292,4 +292,277 @@ namespace ngla
       ost << "lam(" << i << ") = " << EigenValue(i) << endl;
   }
 
+
+  // s * Trans(t), reduction over the long dimension
+  static Matrix<double> BlockInnerProduct (FlatMatrix<double> s, FlatMatrix<double> t)
+  {
+    Matrix<double> res(s.Height(), t.Height());
+    res = 0.0;
+    mutex mtx;
+    ParallelForRange (s.Width(), [&] (IntRange r)
+                      {
+                        Matrix<double> hres(s.Height(), t.Height());
+                        hres = s.Cols(r) * Trans(t.Cols(r));
+                        lock_guard<mutex> guard(mtx);
+                        res += hres;
+                      });
+    return res;
+  }
+
+  // out = Trans(c) * s
+  static void BlockCombine (FlatMatrix<double> c, FlatMatrix<double> s, FlatMatrix<double> out)
+  {
+    ParallelForRange (s.Width(), [&] (IntRange r)
+                      {
+                        out.Cols(r) = Trans(c) * s.Cols(r);
+                      });
+  }
+
+  // squared norms of the rows
+  static Vector<double> RowNorms2 (FlatMatrix<double> s)
+  {
+    Vector<double> res(s.Height());
+    res = 0.0;
+    mutex mtx;
+    ParallelForRange (s.Width(), [&] (IntRange r)
+                      {
+                        Vector<double> hres(s.Height());
+                        for (size_t j = 0; j < s.Height(); j++)
+                          hres(j) = L2Norm2 (s.Row(j).Range(r));
+                        lock_guard<mutex> guard(mtx);
+                        res += hres;
+                      });
+    return res;
+  }
+  
+
+  Vector<double> LOBPCG :: Calc (MultiVector & evecs) const
+  {
+    static Timer t("LOBPCG"); RegionTimer reg(t);
+    static Timer tmult("LOBPCG - mult");
+    static Timer tgram("LOBPCG - Rayleigh-Ritz");
+    static Timer tcomb("LOBPCG - combine");
+    
+    size_t n = evecs.Size();
+    size_t k = evecs.NumVectors();
+    if (3*k > n)
+      throw Exception ("LOBPCG: too many eigenvalues requested");
+
+    // S = [X, W, P] and their images under A and M, block j is rows [j*k, (j+1)*k)
+    MultiVector S(n, 3*k), AS(n, 3*k), MS(n, 3*k);
+    MultiVector W(n, k), AW(n, k), MW(n, k), R(n, k);
+    FlatMatrix<double> fs = S.FM(), fas = AS.FM(), fms = MS.FM();
+    FlatMatrix<double> fw = W.FM(), faw = AW.FM(), fmw = MW.FM(), fr = R.FM();
+
+    auto Mask = [&] (FlatMatrix<double> v)
+      {
+        if (freedofs)
+          ParallelFor (n, [&] (size_t i)
+                       {
+                         if (!freedofs->Test(i))
+                           v.Col(i) = 0.0;
+                       });
+      };
+
+    // AW = A W, MW = M W
+    auto ApplyOperators = [&] ()
+      {
+        RegionTimer reg(tmult);
+        a->Mult (W, AW);
+        if (m)
+          m->Mult (W, MW);
+        else
+          MW = W;
+      };
+
+    // scale rows of block j to unit M-norm
+    auto Normalize = [&] (size_t first, size_t num)
+      {
+        Vector<double> nrm(num);
+        for (size_t j = 0; j < num; j++)
+          nrm(j) = InnerProduct (fs.Row(first+j), fms.Row(first+j));
+        for (size_t j = 0; j < num; j++)
+          if (nrm(j) > 0)
+            {
+              double scal = 1/sqrt(nrm(j));
+              fs.Row(first+j) *= scal;
+              fas.Row(first+j) *= scal;
+              fms.Row(first+j) *= scal;
+            }
+      };
+
+    // Rayleigh-Ritz in the first dim rows of S, coefs is dim x k
+    auto RayleighRitz = [&] (size_t dim, Matrix<double> & coefs, FlatVector<double> lam) -> bool
+      {
+        RegionTimer reg(tgram);
+        Matrix<double> ga = BlockInnerProduct (fs.Rows(0,dim), fas.Rows(0,dim));
+        Matrix<double> gm = BlockInnerProduct (fs.Rows(0,dim), fms.Rows(0,dim));
+
+        // gm = L L^T, fails if the basis is numerically dependent
+        Matrix<double> l(dim, dim);
+        l = 0.0;
+        double maxdiag = 0;
+        for (size_t i = 0; i < dim; i++)
+          maxdiag = max2 (maxdiag, gm(i,i));
+        for (size_t j = 0; j < dim; j++)
+          {
+            double sum = gm(j,j);
+            for (size_t q = 0; q < j; q++)
+              sum -= sqr (l(j,q));
+            if (sum <= 1e-12 * maxdiag) return false;
+            l(j,j) = sqrt(sum);
+            for (size_t i = j+1; i < dim; i++)
+              {
+                double hsum = 0.5 * (gm(i,j)+gm(j,i));
+                for (size_t q = 0; q < j; q++)
+                  hsum -= l(i,q) * l(j,q);
+                l(i,j) = hsum / l(j,j);
+              }
+          }
+        auto SolveL = [&] (SliceVector<double> v)
+          {
+            for (size_t i = 0; i < dim; i++)
+              {
+                double sum = v(i);
+                for (size_t q = 0; q < i; q++)
+                  sum -= l(i,q) * v(q);
+                v(i) = sum / l(i,i);
+              }
+          };
+        auto SolveLT = [&] (SliceVector<double> v)
+          {
+            for (size_t i = dim; i-- > 0; )
+              {
+                double sum = v(i);
+                for (size_t q = i+1; q < dim; q++)
+                  sum -= l(q,i) * v(q);
+                v(i) = sum / l(i,i);
+              }
+          };
+
+        // L^{-1} ga L^{-T}
+        Matrix<double> hat(dim, dim);
+        for (size_t i = 0; i < dim; i++)
+          for (size_t j = 0; j < dim; j++)
+            hat(i,j) = 0.5 * (ga(i,j)+ga(j,i));
+        for (size_t j = 0; j < dim; j++)
+          SolveL (hat.Col(j));
+        Matrix<double> hatt(dim, dim);
+        hatt = Trans(hat);
+        for (size_t j = 0; j < dim; j++)
+          SolveL (hatt.Col(j));
+
+        Vector<double> lami(dim);
+        Matrix<double> ev(dim, dim);
+#ifdef LAPACK
+        LapackEigenValuesSymmetric (hatt, lami, ev);
+#else
+        CalcEigenSystem (hatt, lami, ev);
+#endif
+        Array<int> index(dim);
+        for (size_t i = 0; i < dim; i++) index[i] = i;
+        QuickSort (index, [&] (int i, int j) { return lami(i) < lami(j); });
+
+        coefs.SetSize (dim, k);
+        for (size_t i = 0; i < k; i++)
+          {
+            lam(i) = lami(index[i]);
+            coefs.Col(i) = ev.Row(index[i]);
+            SolveLT (coefs.Col(i));
+          }
+        return true;
+      };
+
+    // X = S coefs, P = [W,P] coefs
+    auto Update = [&] (size_t dim, Matrix<double> & coefs, bool newp)
+      {
+        RegionTimer reg(tcomb);
+        for (FlatMatrix<double> f : { fs, fas, fms })
+          {
+            BlockCombine (coefs, f.Rows(0,dim), fw);
+            if (newp)
+              {
+                BlockCombine (coefs.Rows(k,dim), f.Rows(k,dim), fr);
+                f.Rows(2*k, 3*k) = fr;
+              }
+            f.Rows(0,k) = fw;
+          }
+      };
+    
+
+    FlatMatrix<double> x = evecs.FM();
+    if (L2Norm (RowNorms2 (x)) == 0)
+      for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < k; j++)
+          x(j,i) = double (rand()) / RAND_MAX;
+    fw = x;
+    Mask (fw);
+    ApplyOperators();
+    fs.Rows(0,k) = fw;
+    fas.Rows(0,k) = faw;
+    fms.Rows(0,k) = fmw;
+
+    Vector<double> lam(k);
+    Matrix<double> coefs;
+    if (!RayleighRitz (k, coefs, lam))
+      throw Exception ("LOBPCG: start vectors are linearly dependent");
+    Update (k, coefs, false);
+
+    bool havep = false;
+    steps = 0;
+    for (int it = 0; it < maxsteps; it++)
+      {
+        // R = A X - M X lam
+        ParallelForRange (n, [&] (IntRange r)
+                          {
+                            for (size_t j = 0; j < k; j++)
+                              fr.Row(j).Range(r) = fas.Row(j).Range(r) - lam(j) * fms.Row(j).Range(r);
+                          });
+        Vector<double> res2 = RowNorms2 (fr);
+        Vector<double> mx2 = RowNorms2 (fms.Rows(0,k));
+        size_t nconv = 0;
+        double maxres = 0;
+        for (size_t j = 0; j < k; j++)
+          {
+            double relres = sqrt(res2(j)) / max2 (fabs(lam(j)) * sqrt(mx2(j)), 1e-300);
+            maxres = max2 (maxres, relres);
+            if (relres <= prec) nconv++;
+          }
+        if (printrates)
+          cout << IM(1) << "LOBPCG it " << it << ", converged " << nconv << "/" << k
+               << ", max rel. residual " << maxres << ", lam_min = " << lam(0) << endl;
+        if (nconv == k) break;
+        steps = it+1;
+
+        // W = pre R
+        if (pre)
+          pre->Mult (R, W);
+        else
+          W = R;
+        Mask (fw);
+        ApplyOperators();
+        fs.Rows(k,2*k) = fw;
+        fas.Rows(k,2*k) = faw;
+        fms.Rows(k,2*k) = fmw;
+        Normalize (k, k);
+
+        size_t dim = havep ? 3*k : 2*k;
+        if (!RayleighRitz (dim, coefs, lam))
+          {
+            // drop the search directions and try again
+            dim = 2*k;
+            if (!havep || !RayleighRitz (dim, coefs, lam))
+              {
+                cout << IM(3) << "LOBPCG: basis became linearly dependent, stopping" << endl;
+                break;
+              }
+          }
+        Update (dim, coefs, true);
+        Normalize (2*k, k);
+        havep = true;
+      }
+
+    evecs.FM() = fs.Rows(0,k);
+    return lam;
+  }
 }
@@ -52,6 +52,43 @@ namespace ngla
     void PrintEigenValues (ostream & ost) const;
   };
 
+
+
+  /**
+     Locally optimal block preconditioned conjugate gradient (LOBPCG).
+
+     Computes the smallest eigenpairs of A x = lam M x, A and M symmetric,
+     M positive definite. All vectors of a block are stored in
+     MultiVectors, the Rayleigh-Ritz step works with dense Gram matrices.
+  */
+  class NGS_DLL_HEADER LOBPCG
+  {
+    shared_ptr<BaseMatrix> a, m, pre;
+    shared_ptr<BitArray> freedofs;
+    int maxsteps = 200;
+    double prec = 1e-8;
+    bool printrates = false;
+    mutable int steps = 0;
+  public:
+    /// m = nullptr for the standard evp, pre = nullptr for no preconditioner
+    LOBPCG (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> am,
+            shared_ptr<BaseMatrix> apre, shared_ptr<BitArray> afreedofs = nullptr)
+      : a(aa), m(am), pre(apre), freedofs(afreedofs) { ; }
+    
+    void SetMaxSteps (int amaxsteps) { maxsteps = amaxsteps; }
+    /// relative residual |A x - lam M x| <= prec |lam| |M x|
+    void SetPrecision (double aprec) { prec = aprec; }
+    void SetPrintRates (bool pr = true) { printrates = pr; }
+    int GetSteps () const { return steps; }
+
+    /**
+       Eigenpairs for the NumVectors() smallest eigenvalues.
+       evecs contains the start vectors (random if zero),
+       on return the M-orthonormal eigenvectors.
+    */
+    Vector<double> Calc (MultiVector & evecs) const;
+  };
+
 }
 
 #endif
@@ -162,7 +162,8 @@ namespace ngla
     for (int i = 0; i < ne; i++)
       if (!clone.Test(i))
 	{
-	  delete [] &(elmats[i](0,0));
+          if (!compressed)
+            delete [] &(elmats[i](0,0));
 	  if (rowdnums[i].Size() > 0)
 	    delete [] &(rowdnums[i])[0];
 	  if (coldnums[i].Size() > 0)
@@ -170,6 +171,71 @@ namespace ngla
 	}
   }
   
+  template <class SCAL>
+  void ElementByElementMatrix<SCAL> :: BuildBatches () const
+  {
+    if constexpr (is_same<SCAL,double>::value)
+      {
+        static Timer t("EBE-matrix::BuildBatches"); RegionTimer reg(t);
+        constexpr size_t SW = SIMD<double>::Size();
+        
+        Array<int> elnums;
+        for (size_t i = 0; i < rowdnums.Size(); i++)
+          {
+            FlatArray<int> rdi = rowdnums[i];
+            FlatArray<int> cdi = coldnums[i];
+            if (!rdi.Size() || !cdi.Size()) continue;
+            if (rdi[0] == -1 || cdi[0] == -1) continue;  // reserved but not used
+            elnums.Append (i);
+          }
+
+        // equal sizes become consecutive
+        auto key = [&] (int i) { return INT<2> (rowdnums[i].Size(), coldnums[i].Size()); };
+        QuickSort (elnums, [&] (int a, int b)
+                   {
+                     auto ka = key(a), kb = key(b);
+                     if (ka[0] != kb[0]) return ka[0] < kb[0];
+                     if (ka[1] != kb[1]) return ka[1] < kb[1];
+                     return a < b;
+                   });
+
+        batch_elnums.SetSize0();
+        batch_offset.SetSize0();
+        batched.SetSize (rowdnums.Size());
+        batched.Clear();
+        size_t totvals = 0;
+        for (size_t first = 0; first < elnums.Size(); )
+          {
+            size_t next = first;
+            while (next < elnums.Size() && key(elnums[next]) == key(elnums[first])) next++;
+            for (size_t b = first; b+SW <= next; b += SW)
+              {
+                batch_offset.Append (totvals);
+                for (size_t l = 0; l < SW; l++)
+                  {
+                    batch_elnums.Append (elnums[b+l]);
+                    batched.SetBit (elnums[b+l]);
+                  }
+                totvals += rowdnums[elnums[b]].Size() * coldnums[elnums[b]].Size();
+              }
+            first = next;
+          }
+        batch_offset.Append (totvals);
+        
+        batch_values.SetSize (totvals);
+        ParallelFor (batch_offset.Size()-1, [&] (size_t b)
+                     {
+                       FlatArray<int> els = batch_elnums.Range (b*SW, (b+1)*SW);
+                       size_t h = rowdnums[els[0]].Size(), w = coldnums[els[0]].Size();
+                       FlatMatrix<SIMD<double>> bmat(h, w, &batch_values[batch_offset[b]]);
+                       for (size_t i = 0; i < h; i++)
+                         for (size_t j = 0; j < w; j++)
+                           bmat(i,j) = SIMD<double> ([&] (int l) { return elmats[els[l]](i,j); });
+                     });
+      }
+    batches_valid = true;
+  }
+  
   template <class SCAL>
   void ElementByElementMatrix<SCAL> :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
@@ -232,19 +298,390 @@ namespace ngla
       }
   }
 
+  template <class SCAL>
+  void ElementByElementMatrix<SCAL> :: MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if constexpr (is_same<SCAL,double>::value)
+      {
+        if (compressed)
+          {
+            BaseMatrix::MultAdd (s, x, y);
+            return;
+          }
+        static Timer timer("EBE-matrix::MultAdd MultiVector");
+        RegionTimer reg (timer);
+        size_t k = x.NumVectors();
+        
+        FlatMatrix<double> fx = x.FM();
+        FlatMatrix<double> fy = y.FM();
 
+        size_t maxs = 0;
+        for (size_t i = 0; i < coldnums.Size(); i++)
+          maxs = max2 (maxs, coldnums[i].Size());
+        size_t maxr = 0;
+        for (size_t i = 0; i < rowdnums.Size(); i++)
+          maxr = max2 (maxr, rowdnums[i].Size());
 
+        if (!batches_valid) BuildBatches();
+        
+        {
+          // batches of equal-size elements, SIMD over the elements
+          static Timer timerb("EBE-matrix::MultAdd MultiVector batched");
+          RegionTimer regb (timerb);
+          constexpr size_t SW = SIMD<double>::Size();
+          
+          ParallelForRange
+            (batch_offset.Size()-1, [&] (IntRange r)
+             {
+               Array<SIMD<double>> hxmem(maxs*k), hymem(maxr*k);
+               for (size_t b : r)
+                 {
+                   FlatArray<int> els = batch_elnums.Range (b*SW, (b+1)*SW);
+                   size_t h = rowdnums[els[0]].Size(), w = coldnums[els[0]].Size();
+                   FlatMatrix<SIMD<double>> bmat(h, w, &batch_values[batch_offset[b]]);
+                   FlatMatrix<SIMD<double>> hx(w, k, hxmem.Data());
+                   FlatMatrix<SIMD<double>> hy(h, k, hymem.Data());
+                   
+                   for (size_t j = 0; j < w; j++)
+                     for (size_t v = 0; v < k; v++)
+                       hx(j,v) = SIMD<double> ([&] (int l) { return fx(v, coldnums[els[l]][j]); });
+                   hy = SIMD<double>(0.0);
+                   for (size_t i = 0; i < h; i++)
+                     for (size_t j = 0; j < w; j++)
+                       {
+                         SIMD<double> mij = s * bmat(i,j);
+                         for (size_t v = 0; v < k; v++)
+                           hy(i,v) += mij * hx(j,v);
+                       }
+                   for (size_t l = 0; l < SW; l++)
+                     {
+                       FlatArray<int> rdi = rowdnums[els[l]];
+                       for (size_t i = 0; i < h; i++)
+                         for (size_t v = 0; v < k; v++)
+                           if (disjointrows)
+                             fy(v, rdi[i]) += hy(i,v)[l];
+                           else
+                             AtomicAdd (fy(v, rdi[i]), hy(i,v)[l]);
+                     }
+                   timerb.AddFlops (SW*h*w*k);
+                 }
+             });
+        }
+        
+        auto ApplyElements = [&] (IntRange r)
+          {
+            Matrix<double> hxmax(maxs, k), hymax(maxr, k);
+            for (int i : r)
+              {
+                FlatArray<int> rdi = rowdnums[i];
+                FlatArray<int> cdi = coldnums[i];
+                
+                if (!rdi.Size() || !cdi.Size()) continue;
+                if (rdi[0] == -1 || cdi[0] == -1) continue;  // reserved but not used
+                if (batched.Test(i)) continue;
+
+                FlatMatrix<double> hx = hxmax.Rows(0, cdi.Size());
+                FlatMatrix<double> hy = hymax.Rows(0, rdi.Size());
+                for (size_t j = 0; j < cdi.Size(); j++)
+                  hx.Row(j) = fx.Col(cdi[j]);
+                hy = elmats[i] * hx;
+                for (size_t j = 0; j < rdi.Size(); j++)
+                  fy.Col(rdi[j]) += s * hy.Row(j);
+                
+                timer.AddFlops (cdi.Size()*rdi.Size()*k);
+              }
+          };
+
+        if (disjointrows)
+          ParallelForRange (IntRange(rowdnums.Size()), ApplyElements);
+        else
+          ApplyElements (IntRange(rowdnums.Size()));
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
+  }
+
+
+
+
+
+  template <class SCAL> template <typename TSTORE>
+  void ElementByElementMatrix<SCAL> ::
+  MultAddCompressed (double s, FlatVector<double> vx, FlatVector<double> vy,
+                     bool trans, FlatArray<TSTORE> values) const
+  {
+    static Timer timer("EBE-matrix::MultAdd compressed");
+    RegionTimer reg (timer);
+    bool disjoint = trans ? disjointcols : disjointrows;
+
+    ParallelForRange
+      (chunks.Size(), [&] (IntRange r)
+       {
+         Array<double> matmem, hxmem, hymem;
+         for (size_t c : r)
+           {
+             auto chunk = chunks[c];
+             FlatArray<int> els = group_elements[chunk.group].Range (chunk.first, chunk.next);
+             size_t h = rowdnums[els[0]].Size(), w = coldnums[els[0]].Size();
+             size_t nin = trans ? h : w, nout = trans ? w : h;
+             size_t offset = group_offset[chunk.group];
+
+             double * pmat;
+             if constexpr (is_same<TSTORE,double>::value)
+               pmat = &values[offset];
+             else
+               {
+                 matmem.SetSize (h*w);
+                 for (size_t k = 0; k < h*w; k++)
+                   matmem[k] = values[offset+k];
+                 pmat = matmem.Data();
+               }
+             FlatMatrix<double> mat(h, w, pmat);
+
+             hxmem.SetSize (nin*els.Size());
+             hymem.SetSize (nout*els.Size());
+             FlatMatrix<double> hx(nin, els.Size(), hxmem.Data());
+             FlatMatrix<double> hy(nout, els.Size(), hymem.Data());
+             for (size_t l = 0; l < els.Size(); l++)
+               {
+                 FlatArray<int> ind = trans ? rowdnums[els[l]] : coldnums[els[l]];
+                 for (size_t j = 0; j < nin; j++)
+                   hx(j,l) = vx(ind[j]);
+               }
+             if (trans)
+               hy = Trans(mat) * hx;
+             else
+               hy = mat * hx;
+             for (size_t l = 0; l < els.Size(); l++)
+               {
+                 FlatArray<int> ind = trans ? coldnums[els[l]] : rowdnums[els[l]];
+                 for (size_t i = 0; i < nout; i++)
+                   if (disjoint)
+                     vy(ind[i]) += s * hy(i,l);
+                   else
+                     AtomicAdd (vy(ind[i]), s * hy(i,l));
+               }
+             timer.AddFlops (h*w*els.Size());
+           }
+       });
+  }
+
+  template <class SCAL>
+  void ElementByElementMatrix<SCAL> :: Compress (bool use_float, bool share, double tol)
+  {
+    if constexpr (!is_same<SCAL,double>::value)
+      throw Exception ("ElementByElementMatrix::Compress only for real matrices");
+    else
+      {
+        static Timer t("EBE-matrix::Compress"); RegionTimer reg(t);
+        if (compressed)
+          throw Exception ("ElementByElementMatrix::Compress: already compressed");
+
+        Array<int> elnums;
+        for (size_t i = 0; i < rowdnums.Size(); i++)
+          {
+            FlatArray<int> rdi = rowdnums[i];
+            FlatArray<int> cdi = coldnums[i];
+            if (!rdi.Size() || !cdi.Size()) continue;
+            if (rdi[0] == -1 || cdi[0] == -1) continue;  // reserved but not used
+            elnums.Append (i);
+          }
+
+        // hash of the sizes and of the values rounded relative to the largest one,
+        // candidates with equal hash are compared with the tolerance
+        Array<size_t> hash(rowdnums.Size());
+        Array<double> maxval(rowdnums.Size());
+        ParallelFor (elnums.Size(), [&] (size_t k)
+                     {
+                       int i = elnums[k];
+                       FlatMatrix<double> m = elmats[i];
+                       double mv = 0;
+                       for (size_t j = 0; j < m.Height()*m.Width(); j++)
+                         mv = max2 (mv, fabs(m.Data()[j]));
+                       maxval[i] = mv;
+                       size_t hv = m.Height() * 1000003 + m.Width();
+                       if (!share)
+                         hv = i;
+                       else if (mv > 0)
+                         for (size_t j = 0; j < m.Height()*m.Width(); j++)
+                           hv = hv * 31 + size_t(int64_t(round(m.Data()[j] / mv * (1<<20))));
+                       hash[i] = hv;
+                     });
+        QuickSort (elnums, [&] (int a, int b)
+                   { return hash[a] != hash[b] ? hash[a] < hash[b] : a < b; });
+
+        auto equal = [&] (int a, int b)
+          {
+            FlatMatrix<double> ma = elmats[a], mb = elmats[b];
+            if (ma.Height() != mb.Height() || ma.Width() != mb.Width()) return false;
+            double eps = tol * max2 (maxval[a], maxval[b]);
+            for (size_t j = 0; j < ma.Height()*ma.Width(); j++)
+              if (fabs (ma.Data()[j]-mb.Data()[j]) > eps) return false;
+            return true;
+          };
+
+        // representatives of the groups, and the group of every element
+        Array<int> reps, group(elnums.Size());
+        for (size_t first = 0; first < elnums.Size(); )
+          {
+            size_t next = first;
+            while (next < elnums.Size() && hash[elnums[next]] == hash[elnums[first]]) next++;
+            size_t firstrep = reps.Size();
+            for (size_t k = first; k < next; k++)
+              {
+                int g = -1;
+                for (size_t r = firstrep; r < reps.Size(); r++)
+                  if (equal (elnums[k], reps[r])) { g = r; break; }
+                if (g == -1)
+                  {
+                    g = reps.Size();
+                    reps.Append (elnums[k]);
+                  }
+                group[k] = g;
+              }
+            first = next;
+          }
+
+        Array<int> cnt(reps.Size());
+        cnt = 0;
+        for (int g : group) cnt[g]++;
+        group_elements = Table<int> (cnt);
+        cnt = 0;
+        for (size_t k = 0; k < elnums.Size(); k++)
+          group_elements[group[k]][cnt[group[k]]++] = elnums[k];
+
+        group_offset.SetSize (reps.Size()+1);
+        size_t totvals = 0;
+        for (size_t g = 0; g < reps.Size(); g++)
+          {
+            group_offset[g] = totvals;
+            totvals += elmats[reps[g]].Height() * elmats[reps[g]].Width();
+          }
+        group_offset[reps.Size()] = totvals;
+
+        compressed_float = use_float;
+        if (use_float)
+          group_values_float.SetSize (totvals);
+        else
+          group_values.SetSize (totvals);
+        ParallelFor (reps.Size(), [&] (size_t g)
+                     {
+                       FlatMatrix<double> m = elmats[reps[g]];
+                       for (size_t j = 0; j < m.Height()*m.Width(); j++)
+                         if (use_float)
+                           group_values_float[group_offset[g]+j] = m.Data()[j];
+                         else
+                           group_values[group_offset[g]+j] = m.Data()[j];
+                     });
+
+        // pieces of a group are applied as one matrix-matrix product
+        constexpr int chunksize = 32;
+        chunks.SetSize0();
+        for (size_t g = 0; g < reps.Size(); g++)
+          for (int first = 0; first < int(group_elements[g].Size()); first += chunksize)
+            chunks.Append (CompressedChunk { int(g), first,
+                                             min2 (first+chunksize, int(group_elements[g].Size())) });
+
+        size_t oldbytes = GetNZE() * sizeof(double);
+        // release the element matrices, keeping their sizes
+        if (allvalues.Size())
+          allvalues = Array<SCAL>(1);   // keeps the mark as array-version
+        else
+          for (size_t i = 0; i < elmats.Size(); i++)
+            if (!clone.Test(i) && elmats[i].Height()*elmats[i].Width())
+              delete [] &(elmats[i](0,0));
+        for (auto & m : elmats)
+          m.AssignMemory (m.Height(), m.Width(), nullptr);
+        batch_values = Array<SIMD<double>>();
+        batches_valid = true;
+        batch_offset.SetSize0();
+        batch_offset.Append (0);
+        compressed = true;
+
+        cout << IM(3) << "EBE-matrix compressed: " << elnums.Size() << " elements, "
+             << reps.Size() << " different matrices, "
+             << oldbytes << " -> " << totvals * (use_float ? sizeof(float) : sizeof(double))
+             << " bytes" << endl;
+      }
+  }
+
+  template <class SCAL>
+  Array<MemoryUsage> ElementByElementMatrix<SCAL> :: GetMemoryUsage () const
+  {
+    size_t nbytes = compressed
+      ? group_values_float.Size()*sizeof(float) + group_values.Size()*sizeof(double)
+      : GetNZE()*sizeof(SCAL);
+    for (size_t i = 0; i < rowdnums.Size(); i++)
+      nbytes += (rowdnums[i].Size() + coldnums[i].Size()) * sizeof(int);
+    return { { "ElementByElementMatrix", nbytes, 1 } };
+  }
 
   template <>
   void ElementByElementMatrix<double> :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
+    if (compressed)
+      {
+        if (compressed_float)
+          MultAddCompressed (s, x.FV<double>(), y.FV<double>(), false, FlatArray<float>(group_values_float));
+        else
+          MultAddCompressed (s, x.FV<double>(), y.FV<double>(), false, FlatArray<double>(group_values));
+        return;
+      }
+
     static Timer timer("EBE-matrix::MultAdd");
+    static Timer timerb("EBE-matrix::MultAdd batched");
     RegionTimer reg (timer);
 
     size_t maxs = 0;
     for (size_t i = 0; i < coldnums.Size(); i++)
       maxs = max2 (maxs, coldnums[i].Size());
 
+    if (!batches_valid) BuildBatches();
+    
+    {
+      // SIMD over the elements of a batch
+      RegionTimer regb (timerb);
+      constexpr size_t SW = SIMD<double>::Size();
+      FlatVector<> vx = x.FV<double> (); 
+      FlatVector<> vy = y.FV<double> ();
+      size_t maxr = 0;
+      for (size_t i = 0; i < rowdnums.Size(); i++)
+        maxr = max2 (maxr, rowdnums[i].Size());
+      
+      ParallelForRange
+        (batch_offset.Size()-1, [&] (IntRange r)
+         {
+           ArrayMem<SIMD<double>, 100> hx(maxs), hy(maxr);
+           for (size_t b : r)
+             {
+               FlatArray<int> els = batch_elnums.Range (b*SW, (b+1)*SW);
+               size_t h = rowdnums[els[0]].Size(), w = coldnums[els[0]].Size();
+               FlatMatrix<SIMD<double>> bmat(h, w, &batch_values[batch_offset[b]]);
+               
+               for (size_t j = 0; j < w; j++)
+                 hx[j] = SIMD<double> ([&] (int l) { return vx(coldnums[els[l]][j]); });
+               for (size_t i = 0; i < h; i++)
+                 {
+                   SIMD<double> sum(0.0);
+                   for (size_t j = 0; j < w; j++)
+                     sum += bmat(i,j) * hx[j];
+                   hy[i] = s * sum;
+                 }
+               for (size_t l = 0; l < SW; l++)
+                 {
+                   FlatArray<int> rdi = rowdnums[els[l]];
+                   if (disjointrows)
+                     for (size_t i = 0; i < h; i++)
+                       vy(rdi[i]) += hy[i][l];
+                   else
+                     for (size_t i = 0; i < h; i++)
+                       AtomicAdd (vy(rdi[i]), hy[i][l]);
+                 }
+               timerb.AddFlops (SW*h*w);
+             }
+         });
+    }
+    
 
     if (task_manager)
       {
@@ -266,6 +703,7 @@ namespace ngla
                   
                   if (!rdi.Size() || !cdi.Size()) continue;
                   if (rdi[0] == -1 || cdi[0] == -1) continue;  // reserved but not used
+                  if (batched.Test(i)) continue;
                   
                   FlatVector<> hv1(rdi.Size(), &mem1[0]);
                   FlatVector<> hv2(cdi.Size(), &mem2[0]);
@@ -299,6 +737,7 @@ namespace ngla
 	    
 	    if (!rdi.Size() || !cdi.Size()) continue;
             if (rdi[0] == -1 || cdi[0] == -1) continue;  // reserved but not used
+            if (batched.Test(i)) continue;
             
 	    FlatVector<double> hv(cdi.Size(), &mem1[0]);
 	    
@@ -384,6 +823,15 @@ namespace ngla
   template <>
   void ElementByElementMatrix<double> :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
   {
+    if (compressed)
+      {
+        if (compressed_float)
+          MultAddCompressed (s, x.FV<double>(), y.FV<double>(), true, FlatArray<float>(group_values_float));
+        else
+          MultAddCompressed (s, x.FV<double>(), y.FV<double>(), true, FlatArray<double>(group_values));
+        return;
+      }
+
     static Timer timer("EBE-matrix<double>::MultTransAdd");
     RegionTimer reg (timer);
     size_t maxs = 0;
@@ -531,6 +979,8 @@ namespace ngla
   {
     if (elnr > elmats.Size())
       throw Exception ("EBEMatrix::AddElementMatrix, illegal elnr");
+    if (compressed)
+      throw Exception ("EBEMatrix::AddElementMatrix, matrix is compressed");
     
     
     ArrayMem<int,50> usedrows;
@@ -590,6 +1040,7 @@ namespace ngla
     
     max_row_size = max2(max_row_size, sr);
     max_col_size = max2(max_col_size, sc);
+    batches_valid = false;
   }
 
   template <class SCAL>
@@ -600,6 +1051,8 @@ namespace ngla
   {
     if (allvalues.Size())
       throw Exception ("AddClone + allvalues not ready");
+    if (compressed)
+      throw Exception ("EBEMatrix::AddCloneElementMatrix, matrix is compressed");
 
     ArrayMem<int,50> usedrows;
     for (int i = 0; i < rowdnums_in.Size(); i++)
@@ -635,6 +1088,7 @@ namespace ngla
 
         elmats[elnr].AssignMemory (sr, sc, &elmats[refelnr](0,0));
 	clone.SetBitAtomic(elnr);
+        batches_valid = false;
       }
     else
       throw Exception ("EBEMatrix::AddCloneElementMatrix, illegal elnr");
@@ -654,6 +1108,11 @@ namespace ngla
   ostream & ElementByElementMatrix<SCAL> :: Print (ostream & ost) const
   {
       ost << "Element-by-Element Matrix:" << endl;
+      if (compressed)
+        {
+          ost << "compressed, " << group_elements.Size() << " different matrices" << endl;
+          return ost;
+        }
       ost << "num blocks = " << elmats.Size();
       for (int i = 0; i < elmats.Size(); i++)
 	{
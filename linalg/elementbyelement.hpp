@@ -33,6 +33,29 @@ namespace ngla
 
     Array<int> allrow, allcol;
     Array<SCAL> allvalues;
+
+    // elements of equal size, SIMD<double>::Size() of them interleaved in one batch
+    mutable bool batches_valid = false;
+    mutable BitArray batched;
+    mutable Array<int> batch_elnums;
+    mutable Array<size_t> batch_offset;
+    mutable Array<SIMD<double>> batch_values;
+    void BuildBatches () const;
+
+    // after Compress: one matrix per group of elements with equal matrices,
+    // in double or float. The pieces of the groups are the parallel tasks
+    struct CompressedChunk { int group, first, next; };
+    bool compressed = false;
+    bool compressed_float = false;
+    Table<int> group_elements;
+    Array<size_t> group_offset;
+    Array<double> group_values;
+    Array<float> group_values_float;
+    Array<CompressedChunk> chunks;
+    template <typename TSTORE>
+    void MultAddCompressed (double s, FlatVector<double> vx, FlatVector<double> vy,
+                            bool trans, FlatArray<TSTORE> values) const;
+    
   public:
     ElementByElementMatrix (int h, int ane, bool isymmetric=false);
     ElementByElementMatrix (int h, int w, int ane, bool isymmetric=false);
@@ -58,6 +81,8 @@ namespace ngla
 
     void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
     void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    /// element matrices are applied to all vectors at once
+    void MultAdd (double s, const MultiVector & x, MultiVector & y) const override;
 
     void AddElementMatrix (int elnr,
                            FlatArray<int> dnums1,
@@ -77,9 +102,22 @@ namespace ngla
 
     const FlatMatrix<SCAL> GetElementMatrix( int elnum ) const
     {
+      if (compressed)
+        throw Exception ("ElementByElementMatrix::GetElementMatrix: matrix is compressed");
       return elmats[elnum];
     }
 
+    /**
+       Stores element matrices with equal values (up to the relative
+       tolerance tol) once, and optionally in float. The matrix of a group
+       is applied to the vectors of all its elements at once.
+       Element matrices cannot be added afterwards. Only real matrices.
+    */
+    void Compress (bool use_float, bool share, double tol = 1e-10);
+    bool IsCompressed () const { return compressed; }
+
+    Array<MemoryUsage> GetMemoryUsage () const override;
+
     const FlatArray<int> GetElementRowDNums ( int elnum ) const
     {
       return rowdnums[elnum]; 
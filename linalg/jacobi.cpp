@@ -9,10 +9,20 @@
 
 namespace ngla
 {
+  template <typename TM>
+  INLINE void AddToDiagonal (TM & m, double val)
+  {
+    if constexpr (is_same<TM,double>::value || is_same<TM,Complex>::value)
+      m += val;
+    else
+      for (int k = 0; k < mat_traits<TM>::HEIGHT; k++)
+        m(k,k) += val;
+  }
+
   template <class TM, class TV_ROW, class TV_COL>
   JacobiPrecond<TM,TV_ROW,TV_COL> ::
   JacobiPrecond (const SparseMatrix<TM,TV_ROW,TV_COL> & amat, 
-		 shared_ptr<BitArray> ainner, bool use_par)
+		 shared_ptr<BitArray> ainner, bool use_par, bool hybrid)
     : mat(amat), inner(ainner)
   { 
     static Timer t("Jacobiprecond::ctor"); RegionTimer r(t);
@@ -31,11 +41,42 @@ namespace ngla
     
     if (paralleldofs!=nullptr && use_par)
       AllReduceDofData (invdiag, MPI_SUM, paralleldofs);  
+
+    if (hybrid)
+      nblocks = max2 (size_t(1), height / hybrid_blocksize);
+    if (nblocks > 1)
+      {
+        // l1-norms of the couplings to other blocks
+        l1invdiag.SetSize (height);
+        ParallelFor (nblocks, [&](size_t k)
+                     {
+                       size_t first = k*height/nblocks, next = (k+1)*height/nblocks;
+                       for (size_t i = first; i < next; i++)
+                         {
+                           l1invdiag[i] = invdiag[i];
+                           if (inner && !inner->Test(i)) continue;
+                           auto cols = mat.GetRowIndices(i);
+                           auto vals = mat.GetRowValues(i);
+                           double l1 = 0;
+                           for (size_t j = 0; j < cols.Size(); j++)
+                             {
+                               size_t c = cols[j];
+                               if ((c < first || c >= next) && (!inner || inner->Test(c)))
+                                 l1 += sqrt (L2Norm2 (vals[j]));
+                             }
+                           AddToDiagonal (l1invdiag[i], l1);
+                         }
+                     });
+      }
     
     ParallelFor (height, [&](size_t i)
 		 {
 		   if (!inner || inner->Test(i))
-		     CalcInverse (invdiag[i]);
+                     {
+                       CalcInverse (invdiag[i]);
+                       if (nblocks > 1)
+                         CalcInverse (l1invdiag[i]);
+                     }
 		 });
   }
 
@@ -88,6 +129,41 @@ namespace ngla
   }
 
 
+  template <class TM, class TV_ROW, class TV_COL> template <bool BACKWARD>
+  void JacobiPrecond<TM,TV_ROW,TV_COL> ::
+  HybridGSSmooth (FlatVector<TV_ROW> fx, FlatVector<TV_ROW> fb) const
+  {
+    // the values of the other blocks are taken from before the sweep
+    Vector<TV_ROW> xold(height);
+    ParallelForRange (height, [&] (IntRange r)
+                      {
+                        for (auto i : r)
+                          xold(i) = fx(i);
+                      });
+
+    ParallelFor (nblocks, [&] (size_t k)
+                 {
+                   size_t first = k*height/nblocks, next = (k+1)*height/nblocks;
+                   for (size_t ii = first; ii < next; ii++)
+                     {
+                       size_t i = BACKWARD ? next+first-1-ii : ii;
+                       if (this->inner && !this->inner->Test(i)) continue;
+                       auto cols = mat.GetRowIndices(i);
+                       auto vals = mat.GetRowValues(i);
+                       TV_ROW res = fb(i);
+                       for (size_t j = 0; j < cols.Size(); j++)
+                         {
+                           size_t c = cols[j];
+                           if (c >= first && c < next)
+                             res -= vals[j] * fx(c);
+                           else
+                             res -= vals[j] * xold(c);
+                         }
+                       fx(i) += l1invdiag[i] * res;
+                     }
+                 });
+  }
+
   ///
   template <class TM, class TV_ROW, class TV_COL>
   void JacobiPrecond<TM,TV_ROW,TV_COL> ::
@@ -100,6 +176,12 @@ namespace ngla
     FlatVector<TV_ROW> fx = x.FV<TV_ROW> ();
     const FlatVector<TV_ROW> fb = b.FV<TV_ROW> ();
 
+    if (nblocks > 1)
+      {
+        HybridGSSmooth<false> (fx, fb);
+        return;
+      }
+
     for (int i = 0; i < height; i++)
       if (!this->inner || this->inner->Test(i))
 	{
@@ -121,6 +203,12 @@ namespace ngla
     FlatVector<TV_ROW> fx = x.FV<TV_ROW> ();
     const FlatVector<TV_ROW> fb = b.FV<TV_ROW> ();
 
+    if (nblocks > 1)
+      {
+        HybridGSSmooth<true> (fx, fb);
+        return;
+      }
+
     for (int i = height-1; i >= 0; i--)
       if (!this->inner || this->inner->Test(i))
 	{
@@ -146,7 +234,7 @@ namespace ngla
   JacobiPrecondSymmetric<TM,TV> ::
   JacobiPrecondSymmetric (const SparseMatrixSymmetric<TM,TV> & amat, 
 			  shared_ptr<BitArray> ainner, bool use_par)
-    : JacobiPrecond<TM,TV,TV> (amat, ainner, use_par)
+    : JacobiPrecond<TM,TV,TV> (amat, ainner, use_par, false)
   { 
     ;
   }
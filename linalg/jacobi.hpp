@@ -36,13 +36,29 @@ namespace ngla
     int height;
     ///
     Array<TM> invdiag;
+    /**
+       hybrid Gauss-Seidel: Gauss-Seidel within consecutive blocks of
+       rows, in parallel, Jacobi coupling between the blocks. The
+       diagonal is increased by the l1-norms of the couplings to other
+       blocks, which keeps the smoother convergent for spd matrices.
+       The blocks depend on the height only, small matrices are one
+       block and smoothed by exact Gauss-Seidel. Symmetric storage
+       keeps the sequential smoother.
+    */
+    size_t nblocks = 1;
+    static constexpr size_t hybrid_blocksize = 1024;
+    Array<TM> l1invdiag;
+
+    template <bool BACKWARD>
+    void HybridGSSmooth (FlatVector<TV_ROW> fx, FlatVector<TV_ROW> fb) const;
   public:
     // typedef typename mat_traits<TM>::TV_ROW TVX;
     typedef typename mat_traits<TM>::TSCAL TSCAL;
 
     ///
     JacobiPrecond (const SparseMatrix<TM,TV_ROW,TV_COL> & amat, 
-		   shared_ptr<BitArray> ainner = nullptr, bool use_par = true);
+		   shared_ptr<BitArray> ainner = nullptr, bool use_par = true,
+                   bool hybrid = true);
 
     ///
     virtual ~JacobiPrecond ();
@@ -39,13 +39,18 @@ namespace ngla
 // #include "mumpsinverse.hpp"
 #include "jacobi.hpp"
 #include "blockjacobi.hpp"
+#include "schwarz.hpp"
 #include "commutingAMG.hpp"
 #include "special_matrix.hpp"
 #include "elementbyelement.hpp"
 #include "cg.hpp"
 #include "chebyshev.hpp"
+#include "timestepping.hpp"
+#include "reducedorder.hpp"
 #include "eigen.hpp"
 #include "arnoldi.hpp"
+#include "matrixio.hpp"
+#include "snapshotstore.hpp"
 
 #include "cuda_linalg.hpp"
 #endif
@@ -1,14 +1,141 @@
+#include <cstddef>
+
+// grid-stride loops, the launch size is independent of the vector length
+#define DEV_GRID 512
+#define DEV_BLOCK 256
+
 __global__ void SetScalarKernel (double val, int n, double * dev_ptr)
 {
-  int tid = threadIdx.x;
-  for (int i = tid; i < n; i += blockDim.x)
+  int tid = blockIdx.x*blockDim.x+threadIdx.x;
+  for (int i = tid; i < n; i += blockDim.x*gridDim.x)
     dev_ptr[i] = val;
 }
 
 
 void SetScalar (double val, int n, double * dev_ptr)
 {
-  SetScalarKernel<<<1,128>>> (val, n, dev_ptr);
+  SetScalarKernel<<<DEV_GRID,DEV_BLOCK>>> (val, n, dev_ptr);
 } 
 
 
+// y = s * diag * x + beta * y
+__global__ void MultDiagKernel (int n, double s, const double * diag, const double * x,
+                                double beta, double * y)
+{
+  int tid = blockIdx.x*blockDim.x+threadIdx.x;
+  for (int i = tid; i < n; i += blockDim.x*gridDim.x)
+    y[i] = s * diag[i] * x[i] + beta * y[i];
+}
+
+void MultDiag (int n, double s, const double * diag, const double * x,
+               double beta, double * y)
+{
+  MultDiagKernel<<<DEV_GRID,DEV_BLOCK>>> (n, s, diag, x, beta, y);
+}
+
+
+// one cuda-block per smoothing block, blocks may overlap
+__global__ void BlockJacobiKernel (int nblocks, const int * firstind, const int * ind,
+                                   const size_t * firstval, const double * inv,
+                                   double s, const double * x, double * y)
+{
+  for (int b = blockIdx.x; b < nblocks; b += gridDim.x)
+    {
+      int first = firstind[b];
+      int bs = firstind[b+1]-first;
+      const double * binv = inv + firstval[b];
+      for (int i = threadIdx.x; i < bs; i += blockDim.x)
+        {
+          double sum = 0;
+          for (int j = 0; j < bs; j++)
+            sum += binv[i*bs+j] * x[ind[first+j]];
+          atomicAdd (&y[ind[first+i]], s*sum);
+        }
+    }
+}
+
+void BlockJacobiMultAdd (int nblocks, const int * firstind, const int * ind,
+                         const size_t * firstval, const double * inv,
+                         double s, const double * x, double * y)
+{
+  BlockJacobiKernel<<<DEV_GRID,64>>> (nblocks, firstind, ind, firstval, inv, s, x, y);
+}
+
+
+// alpha = rho / pq read from device memory,  x += alpha p,  r -= alpha q
+__global__ void CGUpdateKernel (int n, const double * rho, const double * pq,
+                                double * x, double * r, const double * p, const double * q)
+{
+  double alpha = *rho / *pq;
+  int tid = blockIdx.x*blockDim.x+threadIdx.x;
+  for (int i = tid; i < n; i += blockDim.x*gridDim.x)
+    {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+    }
+}
+
+void CGUpdate (int n, const double * rho, const double * pq,
+               double * x, double * r, const double * p, const double * q)
+{
+  CGUpdateKernel<<<DEV_GRID,DEV_BLOCK>>> (n, rho, pq, x, r, p, q);
+}
+
+
+// beta = rho_new / rho_old,  p = w + beta p
+__global__ void CGDirectionKernel (int n, const double * rho_new, const double * rho_old,
+                                   const double * w, double * p)
+{
+  double beta = *rho_new / *rho_old;
+  int tid = blockIdx.x*blockDim.x+threadIdx.x;
+  for (int i = tid; i < n; i += blockDim.x*gridDim.x)
+    p[i] = w[i] + beta * p[i];
+}
+
+void CGDirection (int n, const double * rho_new, const double * rho_old,
+                  const double * w, double * p)
+{
+  CGDirectionKernel<<<DEV_GRID,DEV_BLOCK>>> (n, rho_new, rho_old, w, p);
+}
+
+
+// packing of the exchange dofs for the parallel cumulation: buf = x[ind]
+__global__ void GatherKernel (int n, const int * ind, const double * x, double * buf)
+{
+  int tid = blockIdx.x*blockDim.x+threadIdx.x;
+  for (int i = tid; i < n; i += blockDim.x*gridDim.x)
+    buf[i] = x[ind[i]];
+}
+
+void DevGather (int n, const int * ind, const double * x, double * buf)
+{
+  if (n) GatherKernel<<<DEV_GRID,DEV_BLOCK>>> (n, ind, x, buf);
+}
+
+
+// x[ind] += buf, the indices are distinct
+__global__ void ScatterAddKernel (int n, const int * ind, const double * buf, double * x)
+{
+  int tid = blockIdx.x*blockDim.x+threadIdx.x;
+  for (int i = tid; i < n; i += blockDim.x*gridDim.x)
+    x[ind[i]] += buf[i];
+}
+
+void DevScatterAdd (int n, const int * ind, const double * buf, double * x)
+{
+  if (n) ScatterAddKernel<<<DEV_GRID,DEV_BLOCK>>> (n, ind, buf, x);
+}
+
+
+// x[ind] = val
+__global__ void SetIndirectKernel (int n, const int * ind, double val, double * x)
+{
+  int tid = blockIdx.x*blockDim.x+threadIdx.x;
+  for (int i = tid; i < n; i += blockDim.x*gridDim.x)
+    x[ind[i]] = val;
+}
+
+void DevSetIndirect (int n, const int * ind, double val, double * x)
+{
+  if (n) SetIndirectKernel<<<DEV_GRID,DEV_BLOCK>>> (n, ind, val, x);
+}
@@ -0,0 +1,664 @@
+/**************************************************************************/
+/* File:   matrixio.cpp                                                   */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+#include <la.hpp>
+#include <chrono>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace ngla
+{
+
+  static size_t AlignOffset (size_t offset) { return (offset+63) / 64 * 64; }
+
+  /// read-only view of a file, mapped copy-on-write where mmap is available
+  class MappedInputFile
+  {
+    char * ptr = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    Array<char> buffer;
+  public:
+    MappedInputFile (const string & filename)
+    {
+#ifndef WIN32
+      int fd = open (filename.c_str(), O_RDONLY);
+      if (fd == -1)
+        throw Exception ("cannot open file "+filename);
+      struct stat st;
+      if (fstat (fd, &st) != 0)
+        {
+          close (fd);
+          throw Exception ("cannot stat file "+filename);
+        }
+      size = st.st_size;
+      if (size > 0)
+        {
+          void * p = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+          if (p == MAP_FAILED)
+            {
+              close (fd);
+              throw Exception ("mmap failed for file "+filename);
+            }
+          ptr = static_cast<char*> (p);
+          mapped = true;
+          madvise (ptr, size, MADV_SEQUENTIAL);
+        }
+      close (fd);
+#else
+      ifstream in(filename, ios::binary | ios::ate);
+      if (!in)
+        throw Exception ("cannot open file "+filename);
+      size = in.tellg();
+      in.seekg (0);
+      buffer.SetSize (size);
+      in.read (buffer.Data(), size);
+      ptr = buffer.Data();
+#endif
+    }
+
+    ~MappedInputFile ()
+    {
+#ifndef WIN32
+      if (mapped) munmap (ptr, size);
+#endif
+    }
+
+    size_t Size() const { return size; }
+    template <typename T> T * Ptr (size_t offset) const { return reinterpret_cast<T*> (ptr+offset); }
+  };
+
+
+  static const BinaryMatrixHeader &
+  CheckHeader (const MappedInputFile & file, const char * magic, const string & filename)
+  {
+    if (file.Size() < sizeof(BinaryMatrixHeader))
+      throw Exception (filename+" is not an NGSolve binary file");
+    auto & header = *file.Ptr<BinaryMatrixHeader>(0);
+    if (strncmp (header.magic, magic, 8) != 0)
+      throw Exception (filename+" is not an NGSolve binary file of type "+magic);
+    return header;
+  }
+
+  static void WritePadding (ofstream & out)
+  {
+    size_t pos = out.tellp();
+    char zeros[64] = { 0 };
+    out.write (zeros, AlignOffset(pos)-pos);
+  }
+
+  static BinaryMatrixHeader MakeHeader (const char * magic)
+  {
+    BinaryMatrixHeader header;
+    memset (&header, 0, sizeof(header));
+    strncpy (header.magic, magic, 8);
+    return header;
+  }
+
+
+
+  /* ******************* dispatch over entry types ******************** */
+
+  template <typename TM, typename FUNC>
+  static bool TryEntryType (const BaseSparseMatrix & mat, FUNC & func)
+  {
+    if (auto smat = dynamic_cast<const SparseMatrixTM<TM>*> (&mat))
+      {
+        func (*smat, dynamic_cast<const SparseMatrixSymmetricTM<TM>*> (&mat) != nullptr);
+        return true;
+      }
+    return false;
+  }
+
+  template <typename FUNC>
+  static void DispatchEntryType (const BaseSparseMatrix & mat, FUNC func)
+  {
+    if (TryEntryType<double> (mat, func) ||
+        TryEntryType<Complex> (mat, func) ||
+        TryEntryType<Mat<2,2,double>> (mat, func) ||
+        TryEntryType<Mat<2,2,Complex>> (mat, func) ||
+        TryEntryType<Mat<3,3,double>> (mat, func) ||
+        TryEntryType<Mat<3,3,Complex>> (mat, func))
+      return;
+    throw Exception (string("matrix export not supported for type ")+typeid(mat).name());
+  }
+
+  INLINE double Entry (double v, int k, int l) { return v; }
+  INLINE Complex Entry (Complex v, int k, int l) { return v; }
+  template <int H, int W, typename T>
+  INLINE T Entry (const Mat<H,W,T> & v, int k, int l) { return v(k,l); }
+
+
+
+  /* ************************** binary files ************************** */
+
+  template <typename TM>
+  static void T_SaveBinary (const SparseMatrixTM<TM> & mat, bool symmetric, const string & filename)
+  {
+    typedef typename mat_traits<TM>::TSCAL TSCAL;
+    ofstream out(filename, ios::binary);
+    if (!out)
+      throw Exception ("cannot open file "+filename);
+
+    auto header = MakeHeader ("NGSMAT1");
+    header.iscomplex = is_same<TSCAL,Complex>::value;
+    header.bh = mat_traits<TM>::HEIGHT;
+    header.bw = mat_traits<TM>::WIDTH;
+    header.symmetric = symmetric;
+    header.height = mat.Height();
+    header.width = mat.Width();
+    header.nze = mat.NZE();
+    out.write (reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadding (out);
+
+    Array<int64_t> firsti(mat.Height()+1);
+    for (size_t i = 0; i < firsti.Size(); i++)
+      firsti[i] = mat.First(i);
+    out.write (reinterpret_cast<const char*>(firsti.Data()), firsti.Size()*sizeof(int64_t));
+    WritePadding (out);
+
+    for (size_t i = 0; i < mat.Height(); i++)
+      {
+        auto ind = mat.GetRowIndices(i);
+        out.write (reinterpret_cast<const char*>(ind.Data()), ind.Size()*sizeof(int));
+      }
+    WritePadding (out);
+
+    auto vals = mat.AsVector().template FV<TM>();
+    out.write (reinterpret_cast<const char*>(vals.Data()), mat.NZE()*sizeof(TM));
+    if (!out)
+      throw Exception ("error writing file "+filename);
+  }
+
+  void SaveBinary (const BaseSparseMatrix & mat, const string & filename)
+  {
+    static Timer t("SaveBinary - matrix"); RegionTimer reg(t);
+    DispatchEntryType (mat, [&] (const auto & smat, bool symmetric)
+                       { T_SaveBinary (smat, symmetric, filename); });
+  }
+
+
+  template <typename TM>
+  static shared_ptr<BaseSparseMatrix>
+  T_LoadBinary (const MappedInputFile & file, const BinaryMatrixHeader & header, const string & filename)
+  {
+    size_t h = header.height, nze = header.nze;
+    size_t off_firsti = AlignOffset (sizeof(BinaryMatrixHeader));
+    size_t off_colnr = AlignOffset (off_firsti + (h+1)*sizeof(int64_t));
+    size_t off_vals = AlignOffset (off_colnr + nze*sizeof(int));
+    if (file.Size() < off_vals + nze*sizeof(TM))
+      throw Exception (filename+" is truncated");
+
+    const int64_t * firsti = file.Ptr<int64_t> (off_firsti);
+    const int * colnr = file.Ptr<int> (off_colnr);
+    const TM * vals = file.Ptr<TM> (off_vals);
+    if (firsti[0] != 0 || size_t(firsti[h]) != nze)
+      throw Exception (filename+" has an inconsistent row pointer array");
+
+    Array<int> cnt(h);
+    for (size_t i = 0; i < h; i++)
+      cnt[i] = firsti[i+1]-firsti[i];
+
+    shared_ptr<SparseMatrixTM<TM>> mat;
+    if (header.symmetric)
+      mat = make_shared<SparseMatrixSymmetric<TM>> (cnt);
+    else
+      mat = make_shared<SparseMatrix<TM>> (cnt, header.width);
+
+    // copy with the rows of the matrix-vector product, pages are local to the threads
+    mat->ParallelForRows ([&] (auto rows)
+                          {
+                            for (auto i : rows)
+                              {
+                                auto ind = mat->GetRowIndices(i);
+                                auto val = mat->GetRowValues(i);
+                                size_t first = firsti[i];
+                                for (size_t j = 0; j < ind.Size(); j++)
+                                  {
+                                    ind[j] = colnr[first+j];
+                                    val(j) = vals[first+j];
+                                  }
+                              }
+                          });
+    return mat;
+  }
+
+  shared_ptr<BaseSparseMatrix> LoadBinarySparseMatrix (const string & filename)
+  {
+    static Timer t("LoadBinary - matrix"); RegionTimer reg(t);
+    MappedInputFile file(filename);
+    auto & header = CheckHeader (file, "NGSMAT1", filename);
+
+    int type = 100*header.iscomplex + 10*header.bh + header.bw;
+    switch (type)
+      {
+      case  11: return T_LoadBinary<double> (file, header, filename);
+      case 111: return T_LoadBinary<Complex> (file, header, filename);
+      case  22: return T_LoadBinary<Mat<2,2,double>> (file, header, filename);
+      case 122: return T_LoadBinary<Mat<2,2,Complex>> (file, header, filename);
+      case  33: return T_LoadBinary<Mat<3,3,double>> (file, header, filename);
+      case 133: return T_LoadBinary<Mat<3,3,Complex>> (file, header, filename);
+      }
+    throw Exception (filename+": block size "+ToString(header.bh)+" x "+ToString(header.bw)+
+                     " not supported");
+  }
+
+
+
+  void SaveBinary (const BaseVector & vec, const string & filename)
+  {
+    static Timer t("SaveBinary - vector"); RegionTimer reg(t);
+    ofstream out(filename, ios::binary);
+    if (!out)
+      throw Exception ("cannot open file "+filename);
+
+    auto header = MakeHeader ("NGSVEC1");
+    header.iscomplex = vec.IsComplex();
+    header.bh = header.bw = vec.EntrySize() / (vec.IsComplex() ? 2 : 1);
+    header.height = vec.Size();
+    header.width = 1;
+    header.nze = vec.Size();
+    out.write (reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadding (out);
+
+    out.write (static_cast<const char*>(vec.Memory()), vec.Size()*vec.EntrySize()*sizeof(double));
+    if (!out)
+      throw Exception ("error writing file "+filename);
+  }
+
+
+  /// vector in the memory of a mapped file
+  template <typename TSCAL>
+  class MappedVector : virtual public S_BaseVectorPtr<TSCAL>
+  {
+    shared_ptr<MappedInputFile> file;
+  public:
+    MappedVector (shared_ptr<MappedInputFile> afile, size_t offset, size_t as, int aes)
+      : S_BaseVectorPtr<TSCAL> (as, aes, afile->Ptr<TSCAL>(offset)), file(afile)
+    { ; }
+  };
+
+  shared_ptr<BaseVector> LoadBinaryVector (const string & filename, bool copy)
+  {
+    static Timer t("LoadBinary - vector"); RegionTimer reg(t);
+    auto file = make_shared<MappedInputFile> (filename);
+    auto & header = CheckHeader (*file, "NGSVEC1", filename);
+
+    size_t offset = AlignOffset (sizeof(BinaryMatrixHeader));
+    size_t n = header.height;
+    int es = header.bh;
+    size_t bytes = n * es * (header.iscomplex ? sizeof(Complex) : sizeof(double));
+    if (file->Size() < offset+bytes)
+      throw Exception (filename+" is truncated");
+
+    if (!copy)
+      {
+        if (header.iscomplex)
+          return make_shared<MappedVector<Complex>> (file, offset, n, es);
+        return make_shared<MappedVector<double>> (file, offset, n, es);
+      }
+
+    shared_ptr<BaseVector> vec = CreateBaseVector (n, header.iscomplex, es);
+    auto fv = vec->FVDouble();
+    const double * src = file->Ptr<double> (offset);
+    ParallelForRange (fv.Size(), [&] (IntRange r)
+                      {
+                        for (size_t i : r)
+                          fv(i) = src[i];
+                      });
+    return vec;
+  }
+
+
+
+  /* ************************** MatrixMarket ************************** */
+
+  template <typename TM>
+  static void T_WriteMatrixMarket (const SparseMatrixTM<TM> & mat, bool symmetric, ofstream & out)
+  {
+    typedef typename mat_traits<TM>::TSCAL TSCAL;
+    constexpr bool iscomplex = is_same<TSCAL,Complex>::value;
+    constexpr int bh = mat_traits<TM>::HEIGHT;
+    constexpr int bw = mat_traits<TM>::WIDTH;
+
+    // for symmetric storage only the lower part of the diagonal blocks is written
+    auto Skip = [symmetric] (size_t row, size_t col, int k, int l)
+      { return symmetric && row == col && l > k; };
+
+    size_t cnt = 0;
+    for (size_t i = 0; i < mat.Height(); i++)
+      for (int col : mat.GetRowIndices(i))
+        for (int k = 0; k < bh; k++)
+          for (int l = 0; l < bw; l++)
+            if (!Skip (i, col, k, l)) cnt++;
+
+    out << "%%MatrixMarket matrix coordinate " << (iscomplex ? "complex" : "real") << " "
+        << (symmetric ? "symmetric" : "general") << "\n";
+    out << "% written by NGSolve\n";
+    out << size_t(mat.Height())*bh << " " << size_t(mat.Width())*bw << " " << cnt << "\n";
+    out.precision (17);
+
+    for (size_t i = 0; i < mat.Height(); i++)
+      {
+        auto ind = mat.GetRowIndices(i);
+        auto vals = mat.GetRowValues(i);
+        for (size_t j = 0; j < ind.Size(); j++)
+          for (int k = 0; k < bh; k++)
+            for (int l = 0; l < bw; l++)
+              {
+                if (Skip (i, ind[j], k, l)) continue;
+                TSCAL v = Entry (vals(j), k, l);
+                out << i*bh+k+1 << " " << size_t(ind[j])*bw+l+1 << " ";
+                if constexpr (iscomplex)
+                  out << v.real() << " " << v.imag() << "\n";
+                else
+                  out << v << "\n";
+              }
+      }
+  }
+
+  void WriteMatrixMarket (const BaseSparseMatrix & mat, const string & filename)
+  {
+    static Timer t("WriteMatrixMarket"); RegionTimer reg(t);
+    ofstream out(filename);
+    if (!out)
+      throw Exception ("cannot open file "+filename);
+    DispatchEntryType (mat, [&] (const auto & smat, bool symmetric)
+                       { T_WriteMatrixMarket (smat, symmetric, out); });
+    if (!out)
+      throw Exception ("error writing file "+filename);
+  }
+
+
+  /// triplets to CSR, entries of a row are sorted and duplicates summed up
+  template <typename TSCAL>
+  static shared_ptr<BaseSparseMatrix>
+  CreateFromTriplets (size_t h, size_t w, FlatArray<int> indi, FlatArray<int> indj,
+                      FlatArray<TSCAL> vals, bool symmetric)
+  {
+    Array<size_t> first(h+1);
+    first = 0;
+    for (int i : indi) first[i+1]++;
+    for (size_t i = 0; i < h; i++)
+      first[i+1] += first[i];
+
+    Array<int> perm(indi.Size());
+    Array<size_t> pos(h);
+    for (size_t i = 0; i < h; i++) pos[i] = first[i];
+    for (size_t k = 0; k < indi.Size(); k++)
+      perm[pos[indi[k]]++] = k;
+
+    Array<int> cnt(h);
+    ParallelFor (h, [&] (size_t i)
+                 {
+                   auto row = perm.Range(first[i], first[i+1]);
+                   QuickSort (row, [&] (int a, int b) { return indj[a] < indj[b]; });
+                   int c = 0;
+                   for (size_t j = 0; j < row.Size(); j++)
+                     if (j == 0 || indj[row[j]] != indj[row[j-1]]) c++;
+                   cnt[i] = c;
+                 });
+
+    shared_ptr<SparseMatrixTM<TSCAL>> mat;
+    if (symmetric)
+      mat = make_shared<SparseMatrixSymmetric<TSCAL>> (cnt);
+    else
+      mat = make_shared<SparseMatrix<TSCAL>> (cnt, w);
+
+    mat->ParallelForRows ([&] (auto rows)
+                          {
+                            for (auto i : rows)
+                              {
+                                auto row = perm.Range(first[i], first[i+1]);
+                                auto ind = mat->GetRowIndices(i);
+                                auto val = mat->GetRowValues(i);
+                                int c = -1;
+                                for (size_t j = 0; j < row.Size(); j++)
+                                  {
+                                    if (j == 0 || indj[row[j]] != indj[row[j-1]])
+                                      {
+                                        c++;
+                                        ind[c] = indj[row[j]];
+                                        val(c) = 0.0;
+                                      }
+                                    val(c) += vals[row[j]];
+                                  }
+                              }
+                          });
+    return mat;
+  }
+
+
+  shared_ptr<BaseSparseMatrix> ReadMatrixMarket (const string & filename)
+  {
+    static Timer t("ReadMatrixMarket"); RegionTimer reg(t);
+    ifstream in(filename, ios::binary | ios::ate);
+    if (!in)
+      throw Exception ("cannot open file "+filename);
+    size_t fsize = in.tellg();
+    in.seekg (0);
+    string text(fsize, '\0');
+    in.read (&text[0], fsize);
+
+    auto Lower = [] (string s)
+      {
+        for (auto & c : s) c = tolower(c);
+        return s;
+      };
+
+    // banner
+    size_t eol = text.find('\n');
+    istringstream banner(text.substr(0, eol));
+    string mm, object, format, field, symmetry;
+    banner >> mm >> object >> format >> field >> symmetry;
+    object = Lower(object); format = Lower(format);
+    field = Lower(field); symmetry = Lower(symmetry);
+    if (mm != "%%MatrixMarket" || object != "matrix")
+      throw Exception (filename+" is not a MatrixMarket matrix file");
+    if (format != "coordinate")
+      throw Exception ("ReadMatrixMarket: only coordinate format supported, got "+format);
+    if (field != "real" && field != "double" && field != "integer" &&
+        field != "pattern" && field != "complex")
+      throw Exception ("ReadMatrixMarket: unknown field "+field);
+    if (symmetry != "general" && symmetry != "symmetric" && symmetry != "hermitian")
+      throw Exception ("ReadMatrixMarket: symmetry "+symmetry+" not supported");
+    bool iscomplex = field == "complex";
+    bool pattern = field == "pattern";
+
+    // skip comments
+    const char * p = text.c_str() + (eol == string::npos ? fsize : eol);
+    const char * end = text.c_str() + fsize;
+    while (p < end)
+      {
+        while (p < end && isspace(*p)) p++;
+        if (p < end && *p == '%')
+          while (p < end && *p != '\n') p++;
+        else
+          break;
+      }
+
+    auto ReadInt = [&] () -> long
+      {
+        char * next;
+        long val = strtol (p, &next, 10);
+        if (next == p) throw Exception (filename+": unexpected end of data");
+        p = next;
+        return val;
+      };
+    auto ReadDouble = [&] () -> double
+      {
+        char * next;
+        double val = strtod (p, &next);
+        if (next == p) throw Exception (filename+": unexpected end of data");
+        p = next;
+        return val;
+      };
+
+    size_t h = ReadInt(), w = ReadInt(), nnz = ReadInt();
+    bool symmetric = symmetry == "symmetric";
+    bool hermitian = symmetry == "hermitian";
+    if (hermitian && !iscomplex)
+      symmetric = true, hermitian = false;
+    size_t nentries = hermitian ? 2*nnz : nnz;
+
+    Array<int> indi, indj;
+    Array<double> rvals;
+    Array<Complex> cvals;
+    indi.SetAllocSize (nentries);
+    indj.SetAllocSize (nentries);
+    if (iscomplex) cvals.SetAllocSize (nentries);
+    else rvals.SetAllocSize (nentries);
+
+    for (size_t k = 0; k < nnz; k++)
+      {
+        int i = ReadInt()-1, j = ReadInt()-1;
+        if (i < 0 || j < 0 || size_t(i) >= h || size_t(j) >= w)
+          throw Exception (filename+": index out of range in entry "+ToString(k+1));
+        double re = pattern ? 1 : ReadDouble();
+        double im = iscomplex ? ReadDouble() : 0;
+
+        // symmetric storage keeps the lower part
+        if (symmetric && j > i) swap (i, j);
+        indi.Append (i);
+        indj.Append (j);
+        if (iscomplex) cvals.Append (Complex(re, im));
+        else rvals.Append (re);
+
+        if (hermitian && i != j)
+          {
+            indi.Append (j);
+            indj.Append (i);
+            cvals.Append (Complex(re, -im));
+          }
+      }
+
+    if (hermitian)
+      return CreateFromTriplets<Complex> (h, w, indi, indj, cvals, false);
+    if (symmetric && h != w)
+      throw Exception (filename+": symmetric matrix is not square");
+    if (iscomplex)
+      return CreateFromTriplets<Complex> (h, w, indi, indj, cvals, symmetric);
+    return CreateFromTriplets<double> (h, w, indi, indj, rvals, symmetric);
+  }
+
+
+
+  // increased when the archived structures change
+  static const string setup_cache_version = "NGSSETUP1";
+
+  string & SetupCacheDirectory ()
+  {
+    static string dir = getenv ("NGS_SETUP_CACHE") ? getenv ("NGS_SETUP_CACHE") : "";
+    return dir;
+  }
+
+  size_t GraphHash (const MatrixGraph & graph, const BitArray * inner)
+  {
+    static Timer t("GraphHash"); RegionTimer reg(t);
+    size_t h = graph.Size();
+    HashCombine (h, graph.NZE());
+    // the sum of the row hashes does not depend on the partitioning
+    size_t sum = ParallelReduce (graph.Size(),
+                                 [&] (size_t i)
+                                 {
+                                   size_t hi = 0;
+                                   HashCombine (hi, i);
+                                   for (auto c : graph.GetRowIndices(i))
+                                     HashCombine (hi, c);
+                                   if (inner && i < inner->Size())
+                                     HashCombine (hi, inner->Test(i));
+                                   return hi;
+                                 },
+                                 [] (size_t a, size_t b) { return a+b; }, size_t(0));
+    HashCombine (h, sum);
+    return h;
+  }
+
+  string SetupCacheFile (const string & dir, const string & prefix, const string & key)
+  {
+    stringstream name;
+    name << dir << "/" << prefix << "-" << hex << std::hash<string>() (key) << ".ngscache";
+    return name.str();
+  }
+
+  bool LoadSetupCache (const string & filename, const string & key,
+                       const function<void(Archive&)> & func)
+  {
+    static Timer t("LoadSetupCache"); RegionTimer reg(t);
+    if (!ifstream(filename).good())
+      return false;
+    try
+      {
+        BinaryInArchive ar(filename);
+        string version, filekey, trailer;
+        ar & version;
+        if (version != setup_cache_version) return false;
+        ar & filekey;
+        if (filekey != key) return false;
+        func (ar);
+        ar & trailer;
+        if (trailer != version)
+          throw Exception ("trailer missing");
+      }
+    catch (const std::exception & e)
+      {
+        cout << IM(3) << "setup cache " << filename << " not used: " << e.what() << endl;
+        return false;
+      }
+    cout << IM(5) << "setup cache " << filename << " loaded" << endl;
+    return true;
+  }
+
+  void StoreSetupCache (const string & filename, const string & key,
+                        const function<void(Archive&)> & func)
+  {
+    static Timer t("StoreSetupCache"); RegionTimer reg(t);
+    // other jobs see the complete file, or none
+    string tmpname = filename + ".tmp" +
+      ToString (std::chrono::steady_clock::now().time_since_epoch().count());
+    try
+      {
+        {
+          BinaryOutArchive ar(tmpname);
+          string version = setup_cache_version, filekey = key;
+          ar & version & filekey;
+          func (ar);
+          ar & version;
+        }
+        if (std::rename (tmpname.c_str(), filename.c_str()) != 0)
+          throw Exception ("cannot rename " + tmpname);
+      }
+    catch (const std::exception & e)
+      {
+        std::remove (tmpname.c_str());
+        cout << IM(3) << "setup cache " << filename << " not written: " << e.what() << endl;
+      }
+  }
+
+  shared_ptr<SparseCholeskySymbolic>
+  CachedSparseCholeskySymbolic (const BaseSparseMatrix & mat, shared_ptr<BitArray> inner,
+                                const string & dir)
+  {
+    string key = "SparseCholeskySymbolic " + ToString(mat.Height()) + " " + ToString(mat.NZE())
+      + " " + ToString(int(mat.GetInverseType())) + " " + ToString(GraphHash (mat, inner.get()));
+    string filename = SetupCacheFile (dir, "symbolic", key);
+
+    auto symbolic = make_shared<SparseCholeskySymbolic> ();
+    if (LoadSetupCache (filename, key, [&] (Archive & ar) { symbolic->DoArchive (ar); }))
+      return symbolic;
+
+    symbolic = make_shared<SparseCholeskySymbolic> (mat, inner);
+    StoreSetupCache (filename, key, [&] (Archive & ar) { symbolic->DoArchive (ar); });
+    return symbolic;
+  }
+
+}
@@ -0,0 +1,88 @@
+#ifndef FILE_MATRIXIO
+#define FILE_MATRIXIO
+
+/**************************************************************************/
+/* File:   matrixio.hpp                                                   */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+namespace ngla
+{
+
+  /*
+    Binary files for sparse matrices and vectors.
+
+    Matrix file: header, firsti (size_t, height+1), colnr (int, nze),
+    values (nze blocks of bh x bw scalars, row-major).
+    Vector file: header, values (size entries of es scalars).
+    The arrays start at 64-byte aligned offsets, the byte order is the native one.
+   */
+  struct BinaryMatrixHeader
+  {
+    char magic[8];      // "NGSMAT1" or "NGSVEC1"
+    int32_t iscomplex;
+    int32_t bh, bw;     // block size of entries, es = bh for vectors
+    int32_t symmetric;  // only lower triangular part stored
+    int64_t height, width, nze;
+    int64_t reserved[2];
+  };
+
+
+  /// binary export of SparseMatrix, SparseMatrixSymmetric
+  NGS_DLL_HEADER void SaveBinary (const BaseSparseMatrix & mat, const string & filename);
+  /// mapped file is copied into the matrix, rows are first touched by their threads
+  NGS_DLL_HEADER shared_ptr<BaseSparseMatrix> LoadBinarySparseMatrix (const string & filename);
+
+  NGS_DLL_HEADER void SaveBinary (const BaseVector & vec, const string & filename);
+  /**
+     The vector uses the mapped file memory (copy on write), no copy is made.
+     If copy is set, the values are read into a VVector.
+   */
+  NGS_DLL_HEADER shared_ptr<BaseVector> LoadBinaryVector (const string & filename, bool copy = false);
+
+  /// coordinate format, blocks are written as scalar entries
+  NGS_DLL_HEADER void WriteMatrixMarket (const BaseSparseMatrix & mat, const string & filename);
+  /// real, integer, pattern or complex coordinate matrices, general or symmetric
+  NGS_DLL_HEADER shared_ptr<BaseSparseMatrix> ReadMatrixMarket (const string & filename);
+
+
+  /*
+    Warm-start cache files for setup structures (colorings, matrix
+    graphs, symbolic factorizations) which depend only on the mesh and
+    the discretization. A file holds a key describing what the data was
+    computed for, and the data archived by DoArchive. It is used only
+    if the key matches, otherwise the data is recomputed and the file
+    rewritten.
+   */
+
+  /// directory of the setup cache files, initially $NGS_SETUP_CACHE, empty for no cache
+  NGS_DLL_HEADER string & SetupCacheDirectory ();
+
+  /// combine val into the hash h
+  inline void HashCombine (size_t & h, size_t val)
+  {
+    h ^= val + size_t(0x9e3779b97f4a7c15ull) + (h << 6) + (h >> 2);
+  }
+
+  /// hash of the sparsity pattern, and of the inner dofs if given
+  NGS_DLL_HEADER size_t GraphHash (const MatrixGraph & graph, const BitArray * inner = nullptr);
+
+  /// name of the cache file for key in directory dir
+  NGS_DLL_HEADER string SetupCacheFile (const string & dir, const string & prefix, const string & key);
+
+  /// calls func to read the data, if the file exists and its key matches
+  NGS_DLL_HEADER bool LoadSetupCache (const string & filename, const string & key,
+                                      const function<void(Archive&)> & func);
+  /// writes key and data, into a temporary file which is renamed at the end
+  NGS_DLL_HEADER void StoreSetupCache (const string & filename, const string & key,
+                                       const function<void(Archive&)> & func);
+
+  /// symbolic factorization from the cache file, or computed and stored there
+  NGS_DLL_HEADER shared_ptr<SparseCholeskySymbolic>
+  CachedSparseCholeskySymbolic (const BaseSparseMatrix & mat, shared_ptr<BitArray> inner,
+                                const string & dir);
+
+}
+
+#endif
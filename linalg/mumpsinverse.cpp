@@ -44,6 +44,7 @@ namespace ngla
     symmetric = asymmetric;
     inner = ainner;
     cluster = acluster;
+    matrix = const_cast<SparseMatrix<TM,TV_ROW,TV_COL>&>(a).template SharedFromThis<BaseSparseMatrix>();
 
     auto pds = a.GetParallelDofs();
     if ( (pds != nullptr) && // if we are on an "only-me comm", take it
@@ -79,169 +80,12 @@ namespace ngla
     iscomplex = mat_traits<TM>::IS_COMPLEX;
 
 
-    int * colstart = 0;
-    int * counter = 0;
-    int * col_indices = 0, * row_indices = 0;
-    TSCAL * matrix = 0;
-
     if (id == 0)
       {
 	height = a.Height() * entrysize;
-	
-	int * colstart = new int[height+1];
-	int * counter = new int[height];
-	
-	for ( int i = 0; i < height; i++ ) 
-	  counter[i] = 0;
-
-	for ( int i = 0; i < height; i++ ) 
-	  colstart[i+1] = 0;
-	
-	if ( symmetric )
-	  {
-	    cout << "copy matrix symmetric" << endl;
-	    
-	    col_indices = new int[a.NZE() * entrysize * entrysize ];
-	    row_indices = new int[a.NZE() * entrysize * entrysize ];
-	    matrix = new TSCAL[a.NZE() * entrysize * entrysize ];      
-	    
-	    int ii = 0;
-	    for (int i = 0; i < a.Height(); i++ )
-	      {
-		FlatArray<int> rowind = a.GetRowIndices(i);
-
-		for (int j = 0; j < rowind.Size(); j++ )
-		  {
-		    int col = rowind[j];
-		    
-		    if (  (!inner && !cluster) ||
-			  (inner && (inner->Test(i) && inner->Test(col) ) ) ||
-			  (!inner && cluster &&
-			   ((*cluster)[i] == (*cluster)[col] 
-			    && (*cluster)[i] ))  )
-		      {
-			TM entry = a(i,col);
-			for (int l = 0; l < entrysize; l++ )
-			  for (int k = 0; k < entrysize; k++)
-			    {
-			      int rowi = i*entrysize+l+1;
-			      int coli = col*entrysize+k+1;
-			      TSCAL val = Access(entry,l,k);
-
-			      if (rowi >= coli)
-				{
-				  col_indices[ii] = coli;
-				  row_indices[ii] = rowi;
-				  matrix[ii] = val;
-				  ii++;
-				}
-			    }
-		      }
-		    else if (i == col)
-		      {
-			// in the case of 'inner' or 'cluster': 1 on the diagonal for
-			// unused dofs.
-			for (int l=0; l<entrysize; l++ )
-			  {
-			    col_indices[ii] = col*entrysize+l+1;
-			    row_indices[ii] = col*entrysize+l+1;
-			    matrix[ii] = 1;
-			    ii++;
-			  }
-		      }
-		  }
-	      }
-	    nze = ii;
-	  }
-	else
-	  {
-	    cout << "copy matrix non-symmetric" << endl;
-	    // --- transform matrix to compressed column storage format ---
-
-	    // 1.) build array 'colstart':
-	    // (a) get nr. of entries for each col
-	    for (int i = 0; i < a.Height(); i++ )
-	      {
-		for (int j = 0; j < a.GetRowIndices(i).Size(); j++ )
-		  {
-		    int col = a.GetRowIndices(i)[j];
-                
-		    if (  (!inner && !cluster) ||
-			  (inner && (inner->Test(i) && inner->Test(col) ) ) ||
-			  (!inner && cluster && 
-			   ((*cluster)[i] == (*cluster)[col] 
-			    && (*cluster)[i] ))  )
-		      {
-			for (int k=0; k<entrysize; k++ )
-			  colstart[col*entrysize+k+1] += entrysize;
-		      }
-		    else if ( i == col )
-		      {
-			for (int k=0; k<entrysize; k++ )
-			  colstart[col*entrysize+k+1] ++;
-		      }
-		  }
-	      }
-
-	    // (b) accumulate
-	    colstart[0] = 0;
-	    for (int i = 1; i <= height; i++ ) colstart[i] += colstart[i-1];
-	    nze = colstart[height];
-
-
-	    // 2.) build whole matrix:
-	    col_indices = new int[a.NZE() * entrysize * entrysize ];
-	    row_indices = new int[a.NZE() * entrysize * entrysize ];
-	    matrix = new TSCAL[a.NZE() * entrysize * entrysize ];      
-
-	    for (int i = 0; i < a.Height(); i++ )
-	      {
-		for (int j = 0; j<a.GetRowIndices(i).Size(); j++ )
-		  {
-		    int col = a.GetRowIndices(i)[j];
-
-		    if (  (!inner && !cluster) ||
-			  (inner && (inner->Test(i) && inner->Test(col) ) ) ||
-			  (!inner && cluster &&
-			   ((*cluster)[i] == (*cluster)[col] 
-			    && (*cluster)[i] ))  )
-		      {
-			TM entry = a(i,col);
-			for (int k = 0; k < entrysize; k++)
-			  for (int l = 0; l < entrysize; l++ )
-			    {
-			      row_indices[ colstart[col*entrysize+k]+
-					   counter[col*entrysize+k] ] = i*entrysize+l + 1;
-			      col_indices[ colstart[col*entrysize+k]+
-					   counter[col*entrysize+k] ] = col*entrysize+k + 1;
-			      matrix[ colstart[col*entrysize+k]+
-				      counter[col*entrysize+k] ] = Access(entry,l,k);
-			      counter[col*entrysize+k]++;
-			    }
-		      }
-		    else if (i == col)
-		      {
-			// in the case of 'inner' or 'cluster': 1 on the diagonal for
-			// unused dofs.
-			for (int l=0; l<entrysize; l++ )
-			  {
-			    col_indices[ colstart[col*entrysize+l]+
-					 counter[col*entrysize+l] ] = col*entrysize+l + 1;
-			    row_indices[ colstart[col*entrysize+l]+
-					 counter[col*entrysize+l] ] = col*entrysize+l + 1;
-			    matrix[ colstart[col*entrysize+l]+
-				    counter[col*entrysize+l] ] = 1;
-			    counter[col*entrysize+l]++;
-			  }
-		      }
-		  }
-	      }
-	  }
+        CopyMatrix (a);
       }
 
-
-
-
     for (int i = 0; i < 40; i++)
       mumps_id.icntl[i] = 0;
 
@@ -259,8 +103,8 @@ namespace ngla
     /* Define the problem on the host */
     mumps_id.n   = height; 
     mumps_id.nz  = nze;
-    mumps_id.irn = row_indices;
-    mumps_id.jcn = col_indices;
+    mumps_id.irn = row_indices.Data();
+    mumps_id.jcn = col_indices.Data();
 
     /*
       if (id == 0)
@@ -302,7 +146,7 @@ namespace ngla
 
 
 
-    mumps_id.a   = (typename mumps_trait<TSCAL>::MUMPS_TSCAL*)matrix; 
+    mumps_id.a   = (typename mumps_trait<TSCAL>::MUMPS_TSCAL*)values.Data(); 
 
     mumps_id.job = JOB_FACTOR;
     
@@ -337,14 +181,189 @@ namespace ngla
     
     if (id == 0)
       cout << " done " << endl;
-    delete [] colstart;
-    delete [] counter;
-    // delete [] rhs;    
+  }
+
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void MumpsInverse<TM,TV_ROW,TV_COL> :: 
+  CopyMatrix (const SparseMatrix<TM,TV_ROW,TV_COL> & a)
+  {
+    // coordinate format with 1-based indices, the pattern is the same for every call
+    Array<int> colstart(height+1), counter(height);
+    counter = 0;
+    colstart = 0;
 
-    delete [] col_indices;
-    delete [] row_indices;
-    delete [] matrix;
+    if ( symmetric )
+      {
+        cout << "copy matrix symmetric" << endl;
+        
+        col_indices.SetSize (a.NZE() * entrysize * entrysize);
+        row_indices.SetSize (a.NZE() * entrysize * entrysize);
+        values.SetSize (a.NZE() * entrysize * entrysize);
+        
+        int ii = 0;
+        for (int i = 0; i < a.Height(); i++ )
+          {
+            FlatArray<int> rowind = a.GetRowIndices(i);
+
+            for (int j = 0; j < rowind.Size(); j++ )
+              {
+                int col = rowind[j];
+                
+                if (  (!inner && !cluster) ||
+                      (inner && (inner->Test(i) && inner->Test(col) ) ) ||
+                      (!inner && cluster &&
+                       ((*cluster)[i] == (*cluster)[col] 
+                        && (*cluster)[i] ))  )
+                  {
+                    TM entry = a(i,col);
+                    for (int l = 0; l < entrysize; l++ )
+                      for (int k = 0; k < entrysize; k++)
+                        {
+                          int rowi = i*entrysize+l+1;
+                          int coli = col*entrysize+k+1;
+                          TSCAL val = Access(entry,l,k);
+
+                          if (rowi >= coli)
+                            {
+                              col_indices[ii] = coli;
+                              row_indices[ii] = rowi;
+                              values[ii] = val;
+                              ii++;
+                            }
+                        }
+                  }
+                else if (i == col)
+                  {
+                    // in the case of 'inner' or 'cluster': 1 on the diagonal for
+                    // unused dofs.
+                    for (int l=0; l<entrysize; l++ )
+                      {
+                        col_indices[ii] = col*entrysize+l+1;
+                        row_indices[ii] = col*entrysize+l+1;
+                        values[ii] = 1;
+                        ii++;
+                      }
+                  }
+              }
+          }
+        nze = ii;
+      }
+    else
+      {
+        cout << "copy matrix non-symmetric" << endl;
+        // --- transform matrix to compressed column storage format ---
+
+        // 1.) build array 'colstart':
+        // (a) get nr. of entries for each col
+        for (int i = 0; i < a.Height(); i++ )
+          {
+            for (int j = 0; j < a.GetRowIndices(i).Size(); j++ )
+              {
+                int col = a.GetRowIndices(i)[j];
+            
+                if (  (!inner && !cluster) ||
+                      (inner && (inner->Test(i) && inner->Test(col) ) ) ||
+                      (!inner && cluster && 
+                       ((*cluster)[i] == (*cluster)[col] 
+                        && (*cluster)[i] ))  )
+                  {
+                    for (int k=0; k<entrysize; k++ )
+                      colstart[col*entrysize+k+1] += entrysize;
+                  }
+                else if ( i == col )
+                  {
+                    for (int k=0; k<entrysize; k++ )
+                      colstart[col*entrysize+k+1] ++;
+                  }
+              }
+          }
+
+        // (b) accumulate
+        colstart[0] = 0;
+        for (int i = 1; i <= height; i++ ) colstart[i] += colstart[i-1];
+        nze = colstart[height];
+
+
+        // 2.) build whole matrix:
+        col_indices.SetSize (a.NZE() * entrysize * entrysize);
+        row_indices.SetSize (a.NZE() * entrysize * entrysize);
+        values.SetSize (a.NZE() * entrysize * entrysize);
+
+        for (int i = 0; i < a.Height(); i++ )
+          {
+            for (int j = 0; j<a.GetRowIndices(i).Size(); j++ )
+              {
+                int col = a.GetRowIndices(i)[j];
+
+                if (  (!inner && !cluster) ||
+                      (inner && (inner->Test(i) && inner->Test(col) ) ) ||
+                      (!inner && cluster &&
+                       ((*cluster)[i] == (*cluster)[col] 
+                        && (*cluster)[i] ))  )
+                  {
+                    TM entry = a(i,col);
+                    for (int k = 0; k < entrysize; k++)
+                      for (int l = 0; l < entrysize; l++ )
+                        {
+                          row_indices[ colstart[col*entrysize+k]+
+                                       counter[col*entrysize+k] ] = i*entrysize+l + 1;
+                          col_indices[ colstart[col*entrysize+k]+
+                                       counter[col*entrysize+k] ] = col*entrysize+k + 1;
+                          values[ colstart[col*entrysize+k]+
+                                  counter[col*entrysize+k] ] = Access(entry,l,k);
+                          counter[col*entrysize+k]++;
+                        }
+                  }
+                else if (i == col)
+                  {
+                    // in the case of 'inner' or 'cluster': 1 on the diagonal for
+                    // unused dofs.
+                    for (int l=0; l<entrysize; l++ )
+                      {
+                        col_indices[ colstart[col*entrysize+l]+
+                                     counter[col*entrysize+l] ] = col*entrysize+l + 1;
+                        row_indices[ colstart[col*entrysize+l]+
+                                     counter[col*entrysize+l] ] = col*entrysize+l + 1;
+                        values[ colstart[col*entrysize+l]+
+                                counter[col*entrysize+l] ] = 1;
+                        counter[col*entrysize+l]++;
+                      }
+                  }
+              }
+          }
+      }
+  }
+
+
+  template <class TM, class TV_ROW, class TV_COL>
+  void MumpsInverse<TM,TV_ROW,TV_COL> :: Update ()
+  {
+    static Timer timer ("Mumps Inverse - update");
+    RegionTimer reg (timer);
+
+    auto castmatrix = dynamic_pointer_cast<SparseMatrix<TM,TV_ROW,TV_COL>> (matrix.lock());
+    if (!castmatrix)
+      throw Exception ("MumpsInverse::Update: matrix is gone");
+
+    if (comm.Rank() == 0)
+      {
+        size_t oldnze = nze;
+        CopyMatrix (*castmatrix);
+        if (nze != oldnze)
+          throw Exception ("MumpsInverse::Update: the non-zero pattern has changed");
+      }
+
+    // the analysis (ordering and symbolic factorization) is kept in mumps_id
+    mumps_id.irn = row_indices.Data();
+    mumps_id.jcn = col_indices.Data();
+    mumps_id.a = (typename mumps_trait<TSCAL>::MUMPS_TSCAL*)values.Data();
+    mumps_id.job = JOB_FACTOR;
+    mumps_trait<TSCAL>::MumpsFunction (&mumps_id);
+
+    if (mumps_id.infog[0] != 0)
+      throw Exception ("MumpsInverse::Update: factorization failed, error-code = "
+                       + ToString(mumps_id.infog[0]));
   }
   
   
@@ -397,6 +416,43 @@ namespace ngla
   }
   
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void MumpsInverse<TM,TV_ROW,TV_COL> :: 
+  MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if constexpr (is_same<TSCAL,double>::value && is_same<TVX,double>::value)
+      {
+        static Timer timer("Mumps mult inverse MultiVector");
+        RegionTimer reg (timer);
+
+        // the k vectors are the columns of a height x k column-major rhs
+        size_t k = x.NumVectors();
+        Matrix<double> hy(k, height);
+        hy = x.FM();
+
+        MUMPS_STRUC_C & ncid = const_cast<MUMPS_STRUC_C&> (mumps_id);
+        ncid.rhs = hy.Data();
+        ncid.nrhs = k;
+        ncid.lrhs = height;
+        ncid.job = JOB_SOLVE;
+        mumps_trait<TSCAL>::MumpsFunction (&ncid);
+        ncid.nrhs = 1;
+
+        if (comm.Rank() == 0)
+          for (int i = 0; i < height; i++)
+            {
+              bool use = true;
+              if (inner) use = inner->Test(i);
+              else if (cluster) use = (*cluster)[i];
+              if (use)
+                y.FM().Col(i) += s * hy.Col(i);
+            }
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
+  }
+
+
   template <class TM, class TV_ROW, class TV_COL>
   MumpsInverse<TM,TV_ROW,TV_COL> :: ~MumpsInverse()
   {
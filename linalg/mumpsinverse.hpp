@@ -70,6 +70,13 @@ namespace ngla
 
     NgMPI_Comm comm;
 
+    /// the matrix for Update
+    weak_ptr<BaseSparseMatrix> matrix;
+    /// input of MUMPS on the host, coordinate format with 1-based indices
+    Array<int> row_indices, col_indices;
+    Array<TSCAL> values;
+    void CopyMatrix (const SparseMatrix<TM,TV_ROW,TV_COL> & a);
+
   public:
     ///
     MumpsInverse (const SparseMatrix<TM,TV_ROW,TV_COL> & a, 
@@ -89,6 +96,10 @@ namespace ngla
     virtual bool IsComplex() const { return iscomplex; }
     ///
     virtual void Mult (const BaseVector & x, BaseVector & y) const;
+    /// one MUMPS solve with all vectors as right hand sides (real scalar matrix)
+    virtual void MultAdd (double s, const MultiVector & x, MultiVector & y) const;
+    /// numerical factorization of the changed matrix entries (JOB=2), keeps the analysis
+    virtual void Update ();
 
     ///
     virtual AutoVector CreateVector () const
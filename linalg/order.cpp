@@ -570,6 +570,11 @@ namespace ngla
 
 
   void MinimumDegreeOrdering :: Order()
+  {
+    Order (FlatArray<int> (0, nullptr));
+  }
+
+  void MinimumDegreeOrdering :: Order (FlatArray<int> sequence)
   {
     static Timer reorder_timer("MinimumDegreeOrdering::Order");
     RegionTimer reg(reorder_timer);
@@ -586,6 +591,7 @@ namespace ngla
 
     int minj = -1;
     int lastel = -1;
+    size_t seqpos = 0;
 
     if (n > 5000)
       cout << IM(4) << "order " << flush;
@@ -621,6 +627,21 @@ namespace ngla
 	    EliminateSlaveVertex (minj);
 	  }
 
+	else if (sequence.Size())
+	  {
+	    // next master vertex in the prescribed sequence
+	    while (seqpos < sequence.Size() &&
+		   (vertices[sequence[seqpos]].Eliminated() || !IsMaster(sequence[seqpos])))
+	      seqpos++;
+	    if (seqpos == sequence.Size())
+	      throw Exception ("MinimumDegreeOrdering::Order: sequence misses used vertices");
+	    minj = sequence[seqpos++];
+	    priqueue.Invalidate(minj);
+
+	    blocknr[i] = i;
+	    EliminateMasterVertex (minj);
+	  }
+
 	else
 	  {
 	    // find new master vertex
@@ -648,6 +669,145 @@ namespace ngla
 
 
 
+  Array<int> NestedDissection (const Table<int> & graph, const BitArray & used, int minsize)
+  {
+    static Timer t("NestedDissection");
+    RegionTimer reg(t);
+
+    int n = graph.Size();
+
+    // the elimination sequence, every subgraph is a range of it
+    Array<int> seq;
+    for (int i = 0; i < n; i++)
+      if (used.Test(i)) seq.Append(i);
+
+    // vertex belongs to subgraph starting at mark[v], level in breadth first search
+    Array<int> mark(n), level(n);
+    mark = -1;
+    level = -1;
+
+    // reorders the subgraph such that sub-ranges are independent subgraphs (and a separator)
+    auto bisect = [&] (IntRange r, Array<IntRange> & subgraphs)
+      {
+        FlatArray<int> verts = seq.Range(r);
+        int id = r.First();
+        if (verts.Size() <= minsize) return;
+
+        // writes vertices into verts, starting at position first
+        auto copy = [verts] (size_t first, FlatArray<int> vs)
+          {
+            for (size_t i = 0; i < vs.Size(); i++)
+              verts[first+i] = vs[i];
+          };
+
+        Array<int> queue(verts.Size()), levelstart;
+        auto bfs = [&] (int start)
+          {
+            for (int v : verts) level[v] = -1;
+            levelstart.SetSize0();
+            queue[0] = start;
+            level[start] = 0;
+            size_t cnt = 1;
+            for (size_t i = 0; i < cnt; i++)
+              {
+                int v = queue[i];
+                if (level[v] == levelstart.Size()) levelstart.Append(i);
+                for (int w : graph[v])
+                  if (mark[w] == id && level[w] == -1)
+                    {
+                      level[w] = level[v]+1;
+                      queue[cnt++] = w;
+                    }
+              }
+            levelstart.Append(cnt);
+            return cnt;
+          };
+        
+        // pseudo-peripheral start vertex
+        size_t cnt = bfs (verts[0]);
+        for (int k = 0; k < 5; k++)
+          {
+            int oldlevels = levelstart.Size();
+            int minv = queue[levelstart[levelstart.Size()-2]];
+            for (int v : queue.Range(levelstart[levelstart.Size()-2], cnt))
+              if (graph[v].Size() < graph[minv].Size()) minv = v;
+            cnt = bfs (minv);
+            if (levelstart.Size() <= oldlevels) break;
+          }
+
+        if (cnt < verts.Size())
+          {
+            // not connected: reached component, and the rest
+            Array<int> rest;
+            for (int v : verts)
+              if (level[v] == -1) rest.Append (v);
+            copy (0, queue.Range(0, cnt));
+            copy (cnt, rest);
+            subgraphs.Append (IntRange(r.First(), r.First()+cnt));
+            subgraphs.Append (IntRange(r.First()+cnt, r.Next()));
+            return;
+          }
+
+        int nlevels = levelstart.Size()-1;
+        if (nlevels < 3) return;
+        
+        // separating level through the median vertex
+        int m = 1;
+        while (m < nlevels-2 && levelstart[m+1] <= cnt/2) m++;
+
+        // vertices of level m without neighbour in level m+1 need not separate
+        Array<int> parta, sep;
+        for (int v : queue.Range(0, levelstart[m]))
+          parta.Append (v);
+        for (int v : queue.Range(levelstart[m], levelstart[m+1]))
+          {
+            bool separates = false;
+            for (int w : graph[v])
+              if (mark[w] == id && level[w] == m+1)
+                separates = true;
+            if (separates)
+              sep.Append (v);
+            else
+              parta.Append (v);
+          }
+        size_t na = parta.Size();
+        size_t nb = cnt-levelstart[m+1];
+        copy (0, parta);
+        copy (na, queue.Range(levelstart[m+1], cnt));
+        copy (na+nb, sep);
+        subgraphs.Append (IntRange(r.First(), r.First()+na));
+        subgraphs.Append (IntRange(r.First()+na, r.First()+na+nb));
+      };
+
+    // all subgraphs of one level of the separator tree in parallel
+    Array<IntRange> subgraphs;
+    if (seq.Size()) subgraphs.Append (IntRange(0, seq.Size()));
+    while (subgraphs.Size())
+      {
+        ParallelFor (subgraphs.Size(), [&] (size_t i)
+                     {
+                       for (int v : seq.Range(subgraphs[i]))
+                         mark[v] = subgraphs[i].First();
+                     });
+        
+        Array<Array<IntRange>> children(subgraphs.Size());
+        ParallelFor (subgraphs.Size(), [&] (size_t i)
+                     {
+                       bisect (subgraphs[i], children[i]);
+                       // ids are unique within a level only
+                       for (int v : seq.Range(subgraphs[i]))
+                         mark[v] = -1;
+                     });
+        subgraphs.SetSize0();
+        for (auto & c : children)
+          for (auto r : c)
+            subgraphs.Append (r);
+      }
+    return seq;
+  }
+
+
+
   MinimumDegreeOrdering:: ~MinimumDegreeOrdering ()
   {
     // cout << "~MDO: all data should be deleted, please double-check" << endl;
@@ -152,6 +152,8 @@ namespace ngla
     void EliminateSlaveVertex (int v);
     ///
     void Order();
+    /// eliminate in the given sequence of vertices, slaves follow their master
+    void Order (FlatArray<int> sequence);
     /// 
     ~MinimumDegreeOrdering();
 
@@ -199,6 +201,16 @@ namespace ngla
   };
 
 
+  /**
+     Nested dissection ordering by recursive level-set bisection.
+     Returns the elimination sequence of the used vertices, 
+     separators come after the subgraphs they separate.
+     Subgraphs of at most minsize vertices are not split further.
+  */
+  extern Array<int> NestedDissection (const Table<int> & graph, const BitArray & used,
+                                      int minsize = 64);
+
+
 }
 
 
@@ -546,6 +546,27 @@ namespace ngla
   }
 
 
+  template<class TM, class TV_ROW, class TV_COL>
+  void PardisoInverse<TM,TV_ROW,TV_COL> ::
+  MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if constexpr (is_same<TVX,double>::value)
+      {
+        static Timer timer("Pardiso Solve MultiVector");
+        RegionTimer reg (timer);
+        // rows of the MultiVector are the right hand sides, as Mult expects them
+        size_t k = x.NumVectors(), n = x.Size();
+        Matrix<double> hy(k, n);
+        VFlatVector<double> vx(k*n, x.FM().Data());
+        VFlatVector<double> vy(k*n, hy.Data());
+        Mult (vx, vy);
+        y.FM() += s * hy;
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
+  }
+
+
 
 
   template<>
@@ -615,6 +636,53 @@ namespace ngla
 
 
 
+  template<class TM>
+  void PardisoInverseTM<TM> :: Update()
+  {
+    static Timer timer("Pardiso Update");
+    RegionTimer reg (timer);
+
+    auto castmatrix = dynamic_pointer_cast<SparseMatrixTM<TM>>(matrix.lock());
+    if (!castmatrix)
+      throw Exception ("PardisoInverse::Update: matrix is gone");
+
+    // same pattern, the analysis of phase 11 stays in pt
+    if (inner)
+      GetPardisoMatrix (*castmatrix, SubsetFree (*inner));
+    else if (cluster)
+      GetPardisoMatrix (*castmatrix, SubsetCluster (*cluster));
+    else
+      GetPardisoMatrix (*castmatrix, SubsetAll());
+
+    if (rowstart[compressed_height] != nze)
+      throw Exception ("PardisoInverse::Update: the non-zero pattern has changed");
+
+    integer maxfct = 1, mnum = 1, phase = 22, nrhs = 1, msglevel = print, error;
+    integer * params = &hparams[0];
+
+    cout << IM(3) << "call pardiso numerical factorization ..." << flush;
+    if (task_manager) task_manager -> StopWorkers();
+#ifdef USE_MKL
+    mkl_set_num_threads(mkl_max_threads);
+#endif // USE_MKL
+
+    F77_FUNC(pardiso) ( pt, &maxfct, &mnum, &matrixtype, &phase, &compressed_height, 
+			reinterpret_cast<double *>(&matrix[0]),
+			&rowstart[0], &indices[0], NULL, &nrhs, params, &msglevel,
+			NULL, NULL, &error );
+
+#ifdef USE_MKL
+    mkl_set_num_threads(1);
+#endif // USE_MKL
+    if (task_manager) task_manager -> StartWorkers();
+    cout << IM(3) << " done" << endl;
+
+    if (error != 0)
+      throw Exception ("PardisoInverse::Update: numerical factorization failed, PARDISO error "
+                       + ToString(error));
+  }
+
+
   template<class TM>
   ostream & PardisoInverseTM<TM> :: Print (ostream & ost) const
   {
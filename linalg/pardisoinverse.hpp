@@ -137,6 +137,10 @@ namespace ngla
     ///
     virtual ostream & Print (ostream & ost) const;
 
+    /// numerical factorization of the changed matrix entries (phase 22), keeps the ordering
+    virtual bool SupportsUpdate() const { return true; }
+    virtual void Update();
+
     virtual Array<MemoryUsage> GetMemoryUsage () const
     {
       return { MemoryUsage ("Pardiso", nze*sizeof(TM), 1) };
@@ -177,6 +181,8 @@ namespace ngla
     ///
     void Mult (const BaseVector & x, BaseVector & y) const override;
     void MultTrans (const BaseVector & x, BaseVector & y) const override;
+    /// one Pardiso solve with all vectors as right hand sides (real vectors)
+    void MultAdd (double s, const MultiVector & x, MultiVector & y) const override;
     ///
 
     AutoVector CreateRowVector() const override
@@ -58,6 +58,74 @@ namespace pybind11::detail {
   struct is_holder_type<BaseMatrix, std::shared_ptr<BaseMatrix>> : std::true_type {};
 }
 
+/// memory of a C++ object exported with the buffer protocol.
+/// the owner is kept alive as long as the buffer (or a numpy array on it) exists
+struct SharedBuffer
+{
+  shared_ptr<void> owner;
+  void * data;
+  size_t size;
+  size_t itemsize;
+  string format;
+};
+
+template <typename T, typename TOWNER>
+SharedBuffer MakeSharedBuffer (shared_ptr<TOWNER> owner, T * data, size_t size)
+{
+  return SharedBuffer { owner, data, size, sizeof(T), py::format_descriptor<T>::format() };
+}
+
+
+/// pickle state of a CSR matrix: the arrays are passed as MemoryViews,
+/// which are sent as out-of-band buffers with pickle protocol 5
+template <typename TSPMAT>
+py::tuple SparseMatrixGetState (const TSPMAT & mat)
+{
+  typedef typename TSPMAT::TENTRY TM;
+  size_t nze = mat.NZE();
+  FlatArray<size_t> first = mat.GetFirstArray();
+  MemoryView mvfirst((void*) first.Addr(0), sizeof(size_t) * first.Size());
+  MemoryView mvcolnr(nze ? (void*) mat.GetRowIndices(0).Addr(0) : nullptr, sizeof(int) * nze);
+  MemoryView mvvals(nze ? (void*) &mat[0] : nullptr, sizeof(TM) * nze);
+  return py::make_tuple(mat.Height(), mat.Width(), mvfirst, mvcolnr, mvvals);
+}
+
+template <typename TSPMAT>
+shared_ptr<TSPMAT> SparseMatrixSetState (py::tuple state)
+{
+  typedef typename TSPMAT::TENTRY TM;
+  if (state.size() != 5)
+    throw Exception("invalid state for unpickling SparseMatrix");
+  size_t h = state[0].cast<size_t>();
+  size_t w = state[1].cast<size_t>();
+  auto mvfirst = state[2].cast<MemoryView>();
+  auto mvcolnr = state[3].cast<MemoryView>();
+  auto mvvals = state[4].cast<MemoryView>();
+
+  FlatArray<size_t> first(h+1, (size_t*) mvfirst.Ptr());
+  Array<int> elsperrow(h);
+  for (size_t i = 0; i < h; i++)
+    elsperrow[i] = first[i+1]-first[i];
+
+  shared_ptr<TSPMAT> mat;
+  if constexpr (is_base_of<SparseMatrixSymmetricTM<TM>,TSPMAT>::value)
+    mat = make_shared<TSPMAT> (elsperrow);
+  else
+    mat = make_shared<TSPMAT> (elsperrow, w);
+
+  size_t nze = mat->NZE();
+  if (nze)
+    {
+      memcpy ((void*) mat->GetRowIndices(0).Addr(0), mvcolnr.Ptr(), sizeof(int) * nze);
+      memcpy ((void*) &(*mat)[0], mvvals.Ptr(), sizeof(TM) * nze);
+    }
+  delete [] (char*) mvfirst.Ptr();
+  delete [] (char*) mvcolnr.Ptr();
+  delete [] (char*) mvvals.Ptr();
+  return mat;
+}
+
+
 template<typename T>
 void ExportSparseMatrix(py::module m)
 {
@@ -116,6 +184,25 @@ void ExportSparseMatrix(py::module m)
            return py::make_tuple (values, colind, first); 
          },
          py::return_value_policy::reference_internal)
+
+    .def_property_readonly("values", [] (shared_ptr<SparseMatrix<T>> sp)
+         {
+           typedef typename mat_traits<T>::TSCAL TSCAL;
+           size_t size = sp->NZE() * sizeof(T) / sizeof(TSCAL);
+           return MakeSharedBuffer (sp, size ? (TSCAL*)&(*sp)[0] : nullptr, size);
+         },
+         "matrix values in CSR ordering as writable buffer, no copy (numpy.asarray(mat.values)).\n"
+         "for block matrices the blocks are stored row-major one after another")
+    
+    .def("ToBlockCSR", [] (shared_ptr<SparseMatrix<T>> sp, int N) -> shared_ptr<BaseSparseMatrix>
+         {
+           if constexpr (is_same<T,double>::value)
+             return ToBlockCSR (*sp, N);
+           else
+             throw Exception ("ToBlockCSR needs a real scalar matrix");
+         }, py::arg("N"),
+         "Convert matrix with interleaved numbering of N components into N x N blocks,\n"
+         "returns None if the pattern is not block-structured")
     
     .def_static("CreateFromCOO",
                 [] (py::list indi, py::list indj, py::list values, size_t h, size_t w)
@@ -152,14 +239,34 @@ void ExportSparseMatrix(py::module m)
          { return MatMult(a,b); }, py::arg("mat"))
     .def("__matmul__", [](shared_ptr<SparseMatrix<double>> a, shared_ptr<BaseMatrix> mb)
          ->shared_ptr<BaseMatrix> { return make_shared<ProductMatrix> (a, mb); }, py::arg("mat"))
+
+    .def(py::pickle([] (const SparseMatrix<T> & mat)
+                    { return SparseMatrixGetState (mat); },
+                    [] (py::tuple state)
+                    { return SparseMatrixSetState<SparseMatrix<T>> (state); }))
     ;
 
   py::class_<SparseMatrixSymmetric<T>, shared_ptr<SparseMatrixSymmetric<T>>, SparseMatrix<T>>
-    (m, (string("SparseMatrixSymmetric") + typeid(T).name()).c_str());
+    (m, (string("SparseMatrixSymmetric") + typeid(T).name()).c_str())
+    .def(py::pickle([] (const SparseMatrixSymmetric<T> & mat)
+                    { return SparseMatrixGetState (mat); },
+                    [] (py::tuple state)
+                    { return SparseMatrixSetState<SparseMatrixSymmetric<T>> (state); }))
+    ;
 }
 
 void NGS_DLL_HEADER ExportNgla(py::module &m) {
 
+  py::class_<SharedBuffer> (m, "SharedBuffer", py::buffer_protocol(),
+                            "zero-copy view on memory owned by an NGSolve object")
+    .def_buffer([] (SharedBuffer & self) -> py::buffer_info
+                {
+                  return py::buffer_info (self.data, self.itemsize, self.format,
+                                          1, { self.size }, { self.itemsize });
+                })
+    .def("__len__", [] (SharedBuffer & self) { return self.size; })
+    ;
+
   py::enum_<PARALLEL_STATUS>(m, "PARALLEL_STATUS", "enum of possible parallel statuses")
     .value("DISTRIBUTED", DISTRIBUTED)
     .value("CUMULATED", CUMULATED)
@@ -207,6 +314,24 @@ void NGS_DLL_HEADER ExportNgla(py::module &m) {
           { return CreateBaseVector(s,is_complex, es); },
           "size"_a, "complex"_a=false, "entrysize"_a=1);
 
+    m.def("VectorView",
+          [] (py::buffer buf, int es) -> shared_ptr<BaseVector>
+          {
+            py::buffer_info info = buf.request(true);
+            if (info.ndim != 1 || info.strides[0] != info.itemsize)
+              throw Exception ("VectorView needs a contiguous one-dimensional array");
+            if (info.size % es != 0)
+              throw Exception ("VectorView: array size is not a multiple of entrysize");
+            if (info.format == py::format_descriptor<double>::format())
+              return make_shared<S_BaseVectorPtr<double>> (info.size/es, es, info.ptr);
+            if (info.format == py::format_descriptor<Complex>::format())
+              return make_shared<S_BaseVectorPtr<Complex>> (info.size/es, es, info.ptr);
+            throw Exception ("VectorView needs an array of float64 or complex128");
+          },
+          "array"_a, "entrysize"_a=1, py::keep_alive<0,1>(),
+          "vector using the memory of the given array, without copy.\n"
+          "the array must not be resized or freed while the vector is in use");
+
     m.def("CreateParallelVector",
           [] (shared_ptr<ParallelDofs> pardofs) -> shared_ptr<BaseVector>
           {
@@ -459,6 +584,24 @@ void NGS_DLL_HEADER ExportNgla(py::module &m) {
                                               return py::cast (InnerProduct (self, other));
                                           }, py::arg("other"), py::arg("conjugate")=py::cast(true), "Computes (complex) InnerProduct"         
          )
+    .def("AddInnerProduct", [](BaseVector & self, double s, BaseVector & v, BaseVector & w)
+         { return self.AddInnerProductD (s, v, w); },
+         py::arg("s"), py::arg("v"), py::arg("w"),
+         "self += s*v and returns InnerProduct(self,w), in one sweep for real vectors")
+    .def("Add2", [](BaseVector & self, double s1, BaseVector & v1, double s2, BaseVector & v2)
+         { self.Add2 (s1, v1, s2, v2); },
+         py::arg("s1"), py::arg("v1"), py::arg("s2"), py::arg("v2"),
+         "self += s1*v1 + s2*v2, in one sweep for real vectors")
+    .def("InnerProducts", [](BaseVector & self, std::vector<shared_ptr<BaseVector>> vecs)
+         {
+           Array<const BaseVector*> pvecs;
+           for (auto & v : vecs) pvecs.Append (v.get());
+           Vector<double> res(pvecs.Size());
+           self.InnerProductsD (pvecs, res);
+           py::list l;
+           for (size_t i = 0; i < res.Size(); i++) l.append (py::cast(res(i)));
+           return l;
+         }, py::arg("vecs"), "list of InnerProduct(self,v) for all real vectors v, with one global reduction")
     .def("Norm",  [](BaseVector & self) { return self.L2Norm(); }, "Calculate Norm")
     .def("Range", [](BaseVector & self, int from, int to) -> shared_ptr<BaseVector>
                                    {
@@ -486,6 +629,38 @@ void NGS_DLL_HEADER ExportNgla(py::module &m) {
          [] (py::object x, py::object y, py::kwargs kw) -> py::object
          { return py::handle(x.attr("InnerProduct")) (y, **kw); }, py::arg("x"), py::arg("y"), "Computes InnerProduct of given objects");
   ;
+
+  m.def ("InnerProducts",
+         [] (std::vector<std::pair<shared_ptr<BaseVector>, shared_ptr<BaseVector>>> pairs,
+             bool conjugate) -> py::list
+         {
+           py::list l;
+           if (pairs.empty()) return l;
+           if (!pairs[0].first->IsComplex())
+             {
+               InnerProductBatch<double> ips;
+               for (auto & ab : pairs)
+                 ips.Add (*ab.first, *ab.second);
+               for (auto ip : ips.Compute()) l.append (py::cast(ip));
+             }
+           else if (conjugate)
+             {
+               // S_InnerProduct<ComplexConjugate> conjugates the second argument
+               InnerProductBatch<ComplexConjugate> ips;
+               for (auto & ab : pairs)
+                 ips.Add (*ab.second, *ab.first);
+               for (auto ip : ips.Compute()) l.append (py::cast(ip));
+             }
+           else
+             {
+               InnerProductBatch<Complex> ips;
+               for (auto & ab : pairs)
+                 ips.Add (*ab.first, *ab.second);
+               for (auto ip : ips.Compute()) l.append (py::cast(ip));
+             }
+           return l;
+         }, py::arg("pairs"), py::arg("conjugate")=false,
+         "list of a.InnerProduct(b, conjugate) for all pairs (a,b), with one global reduction");
   
 
   py::class_<BlockVector, BaseVector, shared_ptr<BlockVector>> (m, "BlockVector")
@@ -666,6 +841,23 @@ void NGS_DLL_HEADER ExportNgla(py::module &m) {
   
 
 
+  py::class_<MultiVector, shared_ptr<MultiVector>>
+    (m, "MultiVector", "k real vectors of the same size in contiguous storage")
+    .def(py::init<size_t,size_t>(), py::arg("size"), py::arg("k"))
+    .def_property_readonly("size", &MultiVector::Size)
+    .def("__len__", &MultiVector::NumVectors)
+    .def("__getitem__", [] (MultiVector & self, size_t j) -> shared_ptr<BaseVector>
+         {
+           if (j >= self.NumVectors()) throw py::index_error();
+           return shared_ptr<BaseVector>(self.GetVector(j));
+         }, py::arg("j"), py::keep_alive<0,1>(), "vector j, refers to the memory of the MultiVector")
+    .def("FM", [] (MultiVector & self) { return self.FM(); }, py::keep_alive<0,1>(),
+         "k x size matrix, row j is vector j")
+    .def("InnerProduct", [] (MultiVector & self, MultiVector & other)
+         { return self.InnerProduct(other); }, py::arg("other"),
+         "matrix of all inner products self[i]*other[j]")
+    ;
+  
   py::class_<BaseMatrix, shared_ptr<BaseMatrix>, BaseMatrixTrampoline>(m, "BaseMatrix")
     /*
     .def("__init__", [](BaseMatrix *instance) { 
@@ -697,6 +889,8 @@ void NGS_DLL_HEADER ExportNgla(py::module &m) {
                                       }, "Interprets the matrix values as a vector")
 
     .def("Mult",         [](BaseMatrix &m, BaseVector &x, BaseVector &y) { m.Mult(x, y); }, py::call_guard<py::gil_scoped_release>(), py::arg("x"), py::arg("y"))
+    .def("Mult",         [](BaseMatrix &m, MultiVector &x, MultiVector &y) { m.Mult(x, y); }, py::call_guard<py::gil_scoped_release>(), py::arg("x"), py::arg("y"))
+    .def("MultAdd",      [](BaseMatrix &m, double s, MultiVector &x, MultiVector &y) { m.MultAdd (s, x, y); }, py::arg("value"), py::arg("x"), py::arg("y"), py::call_guard<py::gil_scoped_release>())
     .def("MultAdd",      [](BaseMatrix &m, double s, BaseVector &x, BaseVector &y) { m.MultAdd (s, x, y); }, py::arg("value"), py::arg("x"), py::arg("y"), py::call_guard<py::gil_scoped_release>())
     .def("MultTrans",    [](BaseMatrix &m, double s, BaseVector &x, BaseVector &y) { y=0; m.MultTransAdd (1.0, x, y); }, py::arg("value"), py::arg("x"), py::arg("y"), py::call_guard<py::gil_scoped_release>())
     .def("MultTransAdd",  [](BaseMatrix &m, double s, BaseVector &x, BaseVector &y) { m.MultTransAdd (s, x, y); }, py::arg("value"), py::arg("x"), py::arg("y"), py::call_guard<py::gil_scoped_release>())
@@ -739,11 +933,24 @@ freedofs : BitArray
 
 inverse : string
   Solver to use, allowed values are:
+    auto           - chosen from size, sparsity and symmetry of the matrix, the available libraries
+                     and the number of threads (print the choice with ngsglobals.msg_level >= 3)
     sparsecholesky - internal solver of NGSolve for symmetric matrices
+    sparsecholesky_nd - sparsecholesky with nested dissection ordering, more parallelism for large 3D problems
+    sparsecholesky_ooc - sparsecholesky_nd with the factor in a memory mapped file (out-of-core),
+                     the file is created in $NGS_OOC_DIR (default $TMPDIR or /tmp)
+    sparsecholesky_mp - sparsecholesky with the factor stored in single precision,
+                     double precision accuracy by iterative refinement
     umfpack        - solver by Suitesparse/UMFPACK (if NGSolve was configured with USE_UMFPACK=ON)
     pardiso        - PARDISO, either provided by libpardiso (USE_PARDISO=ON) or Intel MKL (USE_MKL=ON).
                      If neither Pardiso nor Intel MKL was linked at compile-time, NGSolve will look
                      for libmkl_rt in LD_LIBRARY_PATH (Unix) or PATH (Windows) at run-time.
+  For parallel matrices:
+    mumps          - distributed MUMPS (if NGSolve was configured with USE_MUMPS=ON)
+    masterinverse  - the matrix is gathered and factored on rank 0
+    redundantinverse - the matrix is factored on every node, the solves stay node-local
+    other values   - redundantinverse for up to 200000 dofs, else one factorization on rank 0
+                     with collective communication, the given solver is used for the factorization
 )raw_string"), py::call_guard<py::gil_scoped_release>())
     // .def("Inverse", [](BM &m)  { return m.InverseMatrix(); })
 
@@ -764,16 +971,48 @@ inverse : string
     .def("__mul__", [](shared_ptr<BaseMatrix> m, shared_ptr<BaseVector> v)
          { return DynamicVectorExpression(make_shared<DynamicMatVecExpression>(m,v)); })
     .def("Update", [](BM &m) { m.Update(); }, py::call_guard<py::gil_scoped_release>(), "Update matrix")
+    .def_property_readonly("supports_update", [](BM & m)
+                           {
+                             if (auto fact = dynamic_cast<SparseFactorization*> (&m))
+                               return fact->SupportsUpdate() && fact->GetAMatrix() != nullptr;
+                             return false;
+                           },
+                           "Update() recomputes a factorization numerically for new values of the same matrix")
     ;
 
   py::class_<BaseSparseMatrix, shared_ptr<BaseSparseMatrix>, BaseMatrix>
     (m, "BaseSparseMatrix", "sparse matrix of any type")
+
+    .def_property_readonly("firsti", [] (shared_ptr<BaseSparseMatrix> sp)
+         {
+           FlatArray<size_t> first = sp->GetFirstArray();
+           return MakeSharedBuffer (sp, first.Data(), first.Size());
+         },
+         "CSR row pointers as buffer, no copy")
+    .def_property_readonly("colnr", [] (shared_ptr<BaseSparseMatrix> sp)
+         {
+           size_t nze = sp->NZE();
+           return MakeSharedBuffer (sp, nze ? sp->GetRowIndices(0).Data() : nullptr, nze);
+         },
+         "CSR column indices as buffer, no copy")
     
     .def("CreateSmoother", [](BaseSparseMatrix & m, shared_ptr<BitArray> ba) 
          { return m.CreateJacobiPrecond(ba); }, py::call_guard<py::gil_scoped_release>(),
          py::arg("freedofs") = shared_ptr<BitArray>())
+
+    .def("CreateSubMatrix", [](BaseSparseMatrix & m, shared_ptr<BitArray> freedofs)
+         { return m.CreateSubMatrix(*freedofs); }, py::call_guard<py::gil_scoped_release>(),
+         py::arg("freedofs"),
+         "the rows and columns of the free dofs, numbered in their order.\n"
+         "PermutationMatrix(freedofs) restricts vectors to them")
+
+    .def("DeleteZeroElements", [](BaseSparseMatrix & m, double tol)
+         { return m.DeleteZeroElements(tol); }, py::call_guard<py::gil_scoped_release>(),
+         py::arg("tol") = 0,
+         "a new matrix without the entries of norm up to tol, the diagonal is kept")
     
-    .def("CreateBlockSmoother", [](BaseSparseMatrix & m, py::object blocks, bool parallel)
+    .def("CreateBlockSmoother", [](BaseSparseMatrix & m, py::object blocks, bool parallel,
+                                   bool floatinverses)
          {
            shared_ptr<Table<int>> blocktable;
            {
@@ -795,10 +1034,58 @@ inverse : string
                    row[j++] = val.cast<int>();
                }
            }
-           return m.CreateBlockJacobiPrecond (blocktable, nullptr, parallel);
-         }, py::call_guard<py::gil_scoped_release>(), py::arg("blocks"), py::arg("parallel")=false)
+           auto pre = m.CreateBlockJacobiPrecond (blocktable, nullptr, parallel);
+           if (floatinverses)
+             pre->ConvertInversesToFloat();
+           return pre;
+         }, py::call_guard<py::gil_scoped_release>(), py::arg("blocks"), py::arg("parallel")=false,
+         py::arg("floatinverses")=false,
+         "floatinverses: store the block inverses in single precision (real matrices)")
      ;
 
+  py::class_<SchwarzPrecond, shared_ptr<SchwarzPrecond>, BaseMatrix>
+    (m, "SchwarzPreconditioner",
+     "overlapping Schwarz preconditioner, patches up to densesize dofs are inverted dense,\n"
+     "larger ones factored by SparseCholesky, congruent patches share the symbolic factorization.\n"
+     "type: 'additive', 'restricted' (not symmetric) or 'weighted' (partition of unity)")
+    .def(py::init([] (shared_ptr<SparseMatrix<double>> mat, py::object blocks,
+                      string type, size_t densesize)
+                  {
+                    SCHWARZ_TYPE stype = SCHWARZ_ADDITIVE;
+                    if (type == "restricted")
+                      stype = SCHWARZ_RESTRICTED;
+                    else if (type == "weighted")
+                      stype = SCHWARZ_WEIGHTED;
+                    else if (type != "additive")
+                      throw Exception ("SchwarzPreconditioner: unknown type '" + type +
+                                       "', use additive, restricted or weighted");
+                    size_t size = py::len(blocks);
+                    Array<int> cnt(size);
+                    size_t i = 0;
+                    for (auto block : blocks)
+                      cnt[i++] = py::len(block);
+                    Table<int> patches(cnt);
+                    i = 0;
+                    for (auto block : blocks)
+                      {
+                        auto row = patches[i++];
+                        size_t j = 0;
+                        for (auto val : block)
+                          row[j++] = val.cast<int>();
+                      }
+                    py::gil_scoped_release release;
+                    return make_shared<SchwarzPrecond> (mat, patches, stype, densesize);
+                  }), py::arg("mat"), py::arg("blocks"), py::arg("type") = "additive",
+         py::arg("densesize") = 100)
+    .def("Update", [] (SchwarzPrecond & self) { self.Update(); },
+         py::call_guard<py::gil_scoped_release>(),
+         "factors the new values of the matrix, patterns and symbolic factorizations are kept")
+    .def_property_readonly("numpatches", &SchwarzPrecond::NumPatches)
+    .def_property_readonly("numsparse", &SchwarzPrecond::NumSparsePatches)
+    .def_property_readonly("numsymbolic", &SchwarzPrecond::NumSymbolic,
+                           "number of different symbolic factorizations of the sparse patches")
+    ;
+
   py::class_<S_BaseMatrix<double>, shared_ptr<S_BaseMatrix<double>>, BaseMatrix>
     (m, "S_BaseMatrixD", "base sparse matrix");
   py::class_<S_BaseMatrix<Complex>, shared_ptr<S_BaseMatrix<Complex>>, BaseMatrix>
@@ -848,6 +1135,200 @@ inverse : string
 	  return cheb;
 	}, py::arg("mat") = nullptr, py::arg("pre") = nullptr,
 	py::arg("steps") = 3, py::arg("lam_min") = 1, py::arg("lam_max") = 1);
+
+  py::class_<ChebyshevSmoother, BaseMatrix, shared_ptr<ChebyshevSmoother>> (m, "ChebyshevSmoother",
+    "Polynomial Chebyshev smoother for pre^{-1} mat, lambda_max is estimated by power iteration")
+    .def(py::init<shared_ptr<BaseMatrix>, shared_ptr<BaseMatrix>, int, double, int>(),
+         py::arg("mat"), py::arg("pre"), py::arg("order") = 3, py::arg("ratio") = 30,
+         py::arg("estimation_steps") = 10)
+    .def("Smooth", [](ChebyshevSmoother & self, BaseVector & x, BaseVector & b)
+         { self.Smooth (x, b); }, py::arg("x"), py::arg("b"),
+         py::call_guard<py::gil_scoped_release>(),
+         "performs one smoothing step x += p(pre mat) pre (b - mat x)")
+    .def("SetBounds", &ChebyshevSmoother::SetBounds, py::arg("lam_min"), py::arg("lam_max"))
+    .def_property_readonly("lam_min", &ChebyshevSmoother::GetLambdaMin)
+    .def_property_readonly("lam_max", &ChebyshevSmoother::GetLambdaMax)
+    .def_property("order", &ChebyshevSmoother::GetOrder, &ChebyshevSmoother::SetOrder)
+    ;
+
+  py::class_<LowRankUpdatedInverse, BaseMatrix, shared_ptr<LowRankUpdatedInverse>> (m, "LowRankUpdatedInverse",
+    "Inverse of mat + U V^T from an inverse of mat by the Sherman-Morrison-Woodbury formula")
+    .def(py::init<shared_ptr<BaseMatrix>, shared_ptr<MultiVector>, shared_ptr<MultiVector>>(),
+         py::arg("inverse"), py::arg("U"), py::arg("V")=nullptr,
+         py::call_guard<py::gil_scoped_release>(),
+         "inverse: inverse of mat\nU, V: MultiVectors of the update U V^T, V = U if not given")
+    .def_property_readonly("rank", &LowRankUpdatedInverse::Rank)
+    .def_property_readonly("inverse", &LowRankUpdatedInverse::GetInverse)
+    ;
+
+  m.def("ProjectMatrix", [] (shared_ptr<BaseMatrix> mat, shared_ptr<MultiVector> V, shared_ptr<MultiVector> W)
+        { return ProjectMatrix (*mat, *V, W.get()); },
+        py::arg("mat"), py::arg("V"), py::arg("W")=nullptr, py::call_guard<py::gil_scoped_release>(),
+        "reduced matrix W^T mat V, W = V if not given");
+  m.def("ProjectVector", [] (shared_ptr<BaseVector> vec, shared_ptr<MultiVector> W)
+        { return ProjectVector (*vec, *W); },
+        py::arg("vec"), py::arg("W"), py::call_guard<py::gil_scoped_release>(),
+        "reduced vector W^T vec");
+
+  py::class_<ReducedOperator, shared_ptr<ReducedOperator>> (m, "ReducedOperator",
+    "reduced operator of an affine decomposition A(mu) = sum theta_q A_q, f(mu) = sum phi_q f_q,\n"
+    "the projected terms W^T A_q V and W^T f_q are cached")
+    .def(py::init<shared_ptr<MultiVector>, shared_ptr<MultiVector>>(),
+         py::arg("V"), py::arg("W")=nullptr,
+         "V: trial basis, W: test basis, W = V if not given")
+    .def("AddMatrix", &ReducedOperator::AddMatrix, py::arg("mat"),
+         py::call_guard<py::gil_scoped_release>(), "adds the term A_q, returns q")
+    .def("AddVector", &ReducedOperator::AddVector, py::arg("vec"),
+         py::call_guard<py::gil_scoped_release>(), "adds the term f_q, returns q")
+    .def("SetBasis", &ReducedOperator::SetBasis, py::arg("V"), py::arg("W")=nullptr,
+         py::call_guard<py::gil_scoped_release>(), "new bases, all terms are projected again")
+    .def("Update", &ReducedOperator::Update, py::arg("q")=-1,
+         py::call_guard<py::gil_scoped_release>(), "projects the term q again, all terms for q = -1")
+    .def_property_readonly("dim", &ReducedOperator::Dim)
+    .def_property_readonly("nmatrices", &ReducedOperator::NumMatrices)
+    .def_property_readonly("nvectors", &ReducedOperator::NumVectors)
+    .def("GetMatrix", [] (ReducedOperator & self, int q) -> Matrix<double>
+         {
+           if (q < 0 || q >= int(self.NumMatrices())) throw py::index_error();
+           return self.GetReducedMatrix(q);
+         }, py::arg("q"), "reduced matrix W^T A_q V")
+    .def("GetVector", [] (ReducedOperator & self, int q) -> Vector<double>
+         {
+           if (q < 0 || q >= int(self.NumVectors())) throw py::index_error();
+           return self.GetReducedVector(q);
+         }, py::arg("q"), "reduced vector W^T f_q")
+    .def("Matrix", [] (ReducedOperator & self, std::vector<double> theta)
+         { return self.EvaluateMatrix (FlatVector<double>(theta.size(), theta.data())); },
+         py::arg("theta"), "sum_q theta_q W^T A_q V")
+    .def("Vector", [] (ReducedOperator & self, std::vector<double> phi)
+         { return self.EvaluateVector (FlatVector<double>(phi.size(), phi.data())); },
+         py::arg("phi"), "sum_q phi_q W^T f_q")
+    .def("Solve", [] (ReducedOperator & self, std::vector<double> theta, std::vector<double> phi)
+         { return self.Solve (FlatVector<double>(theta.size(), theta.data()),
+                              FlatVector<double>(phi.size(), phi.data())); },
+         py::arg("theta"), py::arg("phi"), "coefficients of the reduced solution in the basis V")
+    .def("Expand", [] (ReducedOperator & self, std::vector<double> x, BaseVector & u)
+         { self.Expand (FlatVector<double>(x.size(), x.data()), u); },
+         py::arg("x"), py::arg("u"), "u = V x")
+    ;
+
+  py::class_<TimeStepper, shared_ptr<TimeStepper>> (m, "TimeStepper",
+    "time integrator for M du/dt = f - A u with preallocated stage vectors")
+    .def("Step", [](TimeStepper & self, BaseVector & u, double dt)
+         { self.Step (u, dt); }, py::arg("u"), py::arg("dt"), "one time step, u is overwritten")
+    .def("Integrate", [](TimeStepper & self, shared_ptr<BaseVector> u, double t0, double tend,
+                         double dt, py::object callback, int every)
+         {
+           function<void(double,int)> cb;
+           if (!callback.is_none())
+             cb = [callback, u] (double t, int step) { callback (t, u); };
+           return self.Integrate (*u, t0, tend, dt, every, cb);
+         },
+         py::arg("u"), py::arg("t0"), py::arg("tend"), py::arg("dt"),
+         py::arg("callback")=py::none(), py::arg("every")=1,
+         "time steps of size dt from t0 to tend, all in C++.\n"
+         "callback(t, u) is called every 'every' steps and after the last one.\n"
+         "Returns the final time")
+    ;
+
+  py::class_<ExplicitRungeKutta, TimeStepper, shared_ptr<ExplicitRungeKutta>> (m, "ExplicitRungeKutta",
+    "explicit Runge-Kutta method for du/dt = minv * (f - mat * u)")
+    .def(py::init([](shared_ptr<BaseMatrix> mat, shared_ptr<BaseVector> f, shared_ptr<BaseMatrix> minv,
+                     string method, py::object a, py::object b)
+                  {
+                    if (a.is_none())
+                      return make_shared<ExplicitRungeKutta> (mat, f, minv, method);
+                    auto ca = py::cast<vector<vector<double>>> (a);
+                    auto cb = py::cast<vector<double>> (b);
+                    Matrix<> rka(ca.size(), cb.size());
+                    Vector<> rkb(cb.size());
+                    for (size_t i = 0; i < rka.Height(); i++)
+                      {
+                        if (ca[i].size() != cb.size())
+                          throw Exception ("ExplicitRungeKutta: tableau a must be s x s");
+                        for (size_t j = 0; j < rka.Width(); j++)
+                          rka(i,j) = ca[i][j];
+                      }
+                    for (size_t i = 0; i < rkb.Size(); i++)
+                      rkb(i) = cb[i];
+                    return make_shared<ExplicitRungeKutta> (mat, f, minv, rka, rkb);
+                  }),
+         py::arg("mat"), py::arg("f")=nullptr, py::arg("minv")=nullptr, py::arg("method")="rk4",
+         py::arg("a")=py::none(), py::arg("b")=py::none(),
+         "method = euler | heun | rk4 | ssprk3, or a Butcher tableau given by a and b")
+    .def_property_readonly("stages", &ExplicitRungeKutta::NumStages)
+    ;
+
+  py::class_<RungeKuttaChebyshev, TimeStepper, shared_ptr<RungeKuttaChebyshev>> (m, "RungeKuttaChebyshev",
+    "first order damped Runge-Kutta-Chebyshev method for du/dt = minv * (f - mat * u)")
+    .def(py::init<shared_ptr<BaseMatrix>, shared_ptr<BaseVector>, shared_ptr<BaseMatrix>, int, double>(),
+         py::arg("mat"), py::arg("f")=nullptr, py::arg("minv")=nullptr, py::arg("stages")=10,
+         py::arg("damping")=0.05)
+    .def_property_readonly("stages", &RungeKuttaChebyshev::NumStages)
+    .def_property_readonly("stability_bound", &RungeKuttaChebyshev::GetStabilityBound,
+                           "stable for dt * lambda_max(minv * mat) <= stability_bound")
+    ;
+
+  py::class_<IMEXRungeKutta, TimeStepper, shared_ptr<IMEXRungeKutta>> (m, "IMEXRungeKutta",
+    "IMEX Runge-Kutta method for M du/dt = f - mat * u - matim * u, matim is treated implicitly.\n"
+    "inv must be the inverse of M + gamma * dt * matim")
+    .def(py::init<shared_ptr<BaseMatrix>, shared_ptr<BaseMatrix>, shared_ptr<BaseMatrix>,
+         shared_ptr<BaseMatrix>, shared_ptr<BaseVector>, string>(),
+         py::arg("M"), py::arg("mat"), py::arg("matim"), py::arg("inv")=nullptr,
+         py::arg("f")=nullptr, py::arg("method")="ars222",
+         "method = euler | ars222")
+    .def_property_readonly("gamma", &IMEXRungeKutta::GetGamma)
+    .def_property_readonly("stages", &IMEXRungeKutta::NumStages)
+    .def("SetInverse", &IMEXRungeKutta::SetInverse, py::arg("inv"))
+    ;
+
+  py::class_<GeneralizedAlpha, shared_ptr<GeneralizedAlpha>> (m, "GeneralizedAlpha",
+    "generalized-alpha method for M a + C v + K u = sum_i g_i(t) f_i.\n"
+    "The effective matrix is factored once per time step size")
+    .def(py::init<shared_ptr<BaseMatrix>, shared_ptr<BaseMatrix>, shared_ptr<BaseMatrix>,
+         double, shared_ptr<BitArray>>(),
+         py::arg("M"), py::arg("C"), py::arg("K"), py::arg("rho_inf")=1, py::arg("freedofs")=nullptr)
+    .def("SetParameters", &GeneralizedAlpha::SetParameters,
+         py::arg("alpha_m"), py::arg("alpha_f"), py::arg("beta"), py::arg("gamma"))
+    .def("SetNewmark", &GeneralizedAlpha::SetNewmark, "average acceleration Newmark method")
+    .def_property_readonly("alpha_m", &GeneralizedAlpha::GetAlphaM)
+    .def_property_readonly("alpha_f", &GeneralizedAlpha::GetAlphaF)
+    .def_property_readonly("beta", &GeneralizedAlpha::GetBeta)
+    .def_property_readonly("gamma", &GeneralizedAlpha::GetGamma)
+    .def("AddSource", [](GeneralizedAlpha & self, shared_ptr<BaseVector> f, py::object g)
+         {
+           function<double(double)> cg;
+           if (!g.is_none())
+             cg = [g] (double t) { return py::cast<double> (g(t)); };
+           self.AddSource (f, cg);
+         }, py::arg("f"), py::arg("g")=py::none(), "add source g(t) * f, g = None means g = 1")
+    .def("EffectiveCoefficients", [](GeneralizedAlpha & self, double dt)
+         {
+           Vec<3> c = self.GetEffectiveCoefficients (dt);
+           return py::make_tuple (c(0), c(1), c(2));
+         }, py::arg("dt"), "coefficients (cm, cc, ck) of the effective matrix cm M + cc C + ck K")
+    .def("SetInverse", &GeneralizedAlpha::SetInverse, py::arg("inv"), py::arg("dt"),
+         "inverse of the effective matrix, needed if M or C are not sparse matrices")
+    .def("SetTimeStep", &GeneralizedAlpha::SetTimeStep, py::arg("dt"))
+    .def_property_readonly("inverse", &GeneralizedAlpha::GetInverse)
+    .def("Step", [](GeneralizedAlpha & self, BaseVector & u, BaseVector & v, BaseVector & a,
+                    double t, double dt)
+         { self.Step (u, v, a, t, dt); },
+         py::arg("u"), py::arg("v"), py::arg("a"), py::arg("t"), py::arg("dt"))
+    .def("Integrate", [](GeneralizedAlpha & self, shared_ptr<BaseVector> u, shared_ptr<BaseVector> v,
+                         shared_ptr<BaseVector> a, double t0, double tend, double dt,
+                         py::object callback, int every)
+         {
+           function<void(double,int)> cb;
+           if (!callback.is_none())
+             cb = [callback, u, v, a] (double t, int step) { callback (t, u, v, a); };
+           return self.Integrate (*u, *v, *a, t0, tend, dt, every, cb);
+         },
+         py::arg("u"), py::arg("v"), py::arg("a"), py::arg("t0"), py::arg("tend"), py::arg("dt"),
+         py::arg("callback")=py::none(), py::arg("every")=1,
+         "callback(t, u, v, a) is called every 'every' steps and after the last one.\n"
+         "Returns the final time")
+    ;
   
   py::class_<BlockMatrix, BaseMatrix, shared_ptr<BlockMatrix>> (m, "BlockMatrix")
     .def(py::init<> ([] (vector<vector<shared_ptr<BaseMatrix>>> mats)
@@ -873,6 +1354,40 @@ inverse : string
     .def_property_readonly("col_nblocks", [](BlockMatrix & mat) { return mat.BlockCols(); })
     ;
 
+  py::class_<BlockPreconditioner, BaseMatrix, shared_ptr<BlockPreconditioner>> (m, "BlockPreconditioner",
+    docu_string(R"raw_string(
+Block preconditioner for a BlockMatrix from approximate inverses D_i of
+the diagonal blocks, applied on BlockVectors without temporaries.
+
+Parameters:
+
+mat : ngsolve.la.BlockMatrix
+  the block matrix, may be None for type 'diagonal'
+
+inverses : list of ngsolve.la.BaseMatrix
+  approximate inverses of the diagonal blocks
+
+type : string
+  diagonal  - y_i = D_i x_i
+  lower     - block forward substitution
+  upper     - block backward substitution
+  symmetric - approximate block LDU factorization (forward and backward)
+  For the saddle point problem [A B^T; B -C] use D_0 ~ A^{-1} and
+  D_1 ~ -S^{-1} for the triangular types, D_1 ~ S^{-1} with MinRes.
+)raw_string"))
+    .def(py::init<> ([] (shared_ptr<BlockMatrix> mat, vector<shared_ptr<BaseMatrix>> inverses, string type)
+                     {
+                       Array<shared_ptr<BaseMatrix>> invs;
+                       for (auto inv : inverses) invs += inv;
+                       return make_shared<BlockPreconditioner> (mat, invs, BlockPreconditioner::GetType(type));
+                     }), py::arg("mat"), py::arg("inverses"), py::arg("type")="diagonal")
+    ;
+
+  py::class_<SchurComplementMatrix, BaseMatrix, shared_ptr<SchurComplementMatrix>> (m, "SchurComplementMatrix",
+    "Schur complement mat[1,1] - mat[1,0] inverse mat[0,1] of a 2x2 BlockMatrix, applied matrix-free")
+    .def(py::init<shared_ptr<BlockMatrix>, shared_ptr<BaseMatrix>>(), py::arg("mat"), py::arg("inverse"))
+    ;
+
   py::class_<DynamicVectorExpression> (m, "DynamicVectorExpression")
     .def(py::init<shared_ptr<BaseVector>>())
     .def(py::self+py::self)
@@ -880,6 +1395,10 @@ inverse : string
     .def("__neg__", [] (DynamicVectorExpression a) { return (-1.0)*a; })    
     .def(double()*py::self)
     .def("__rmul__", [] (DynamicVectorExpression a, Complex scal) { return scal*a; })    
+    .def("Evaluate", [] (DynamicVectorExpression a) { return shared_ptr<BaseVector>(a.Evaluate()); },
+         "the value of the expression in a new vector")
+    .def("Norm", [] (DynamicVectorExpression a) { return a.Evaluate().L2Norm(); },
+         "Calculate Norm of the evaluated expression")
   ;
 
   // just for testing
@@ -941,6 +1460,90 @@ inverse : string
   ExportSparseMatrix<Mat<3,3,double>>(m);
   ExportSparseMatrix<Mat<3,3,Complex>>(m);
 
+  m.def("SaveBinary", [] (shared_ptr<BaseMatrix> mat, string filename)
+        {
+          auto smat = dynamic_pointer_cast<BaseSparseMatrix> (mat);
+          if (!smat)
+            throw Exception ("SaveBinary needs a sparse matrix");
+          SaveBinary (*smat, filename);
+        }, py::arg("mat"), py::arg("filename"), py::call_guard<py::gil_scoped_release>(),
+        "write sparse matrix in binary CSR format");
+  m.def("SaveBinary", [] (shared_ptr<BaseVector> vec, string filename)
+        { SaveBinary (*vec, filename); },
+        py::arg("vec"), py::arg("filename"), py::call_guard<py::gil_scoped_release>(),
+        "write vector in binary format");
+  m.def("LoadBinaryMatrix", [] (string filename) { return LoadBinarySparseMatrix (filename); },
+        py::arg("filename"), py::call_guard<py::gil_scoped_release>(),
+        "read sparse matrix written by SaveBinary");
+  m.def("LoadBinaryVector", [] (string filename, bool copy) { return LoadBinaryVector (filename, copy); },
+        py::arg("filename"), py::arg("copy")=false, py::call_guard<py::gil_scoped_release>(),
+        "read vector written by SaveBinary, maps the file memory unless copy is set");
+  m.def("WriteMatrixMarket", [] (shared_ptr<BaseMatrix> mat, string filename)
+        {
+          auto smat = dynamic_pointer_cast<BaseSparseMatrix> (mat);
+          if (!smat)
+            throw Exception ("WriteMatrixMarket needs a sparse matrix");
+          WriteMatrixMarket (*smat, filename);
+        }, py::arg("mat"), py::arg("filename"), py::call_guard<py::gil_scoped_release>());
+  m.def("ReadMatrixMarket", [] (string filename) { return ReadMatrixMarket (filename); },
+        py::arg("filename"), py::call_guard<py::gil_scoped_release>());
+  m.def("SetupCacheDirectory", [] (optional<string> dir)
+        {
+          if (dir) SetupCacheDirectory() = *dir;
+          return SetupCacheDirectory();
+        }, py::arg("dir") = py::none(),
+        "directory of the warm-start files for colorings, matrix graphs and symbolic\n"
+        "factorizations (sparsecholesky), initially $NGS_SETUP_CACHE. Sets it if dir is\n"
+        "given, an empty string switches the cache off. Returns the directory.");
+
+  py::class_<SnapshotStore, shared_ptr<SnapshotStore>>
+    (m, "SnapshotStore",
+     "file of compressed vectors, e.g. time histories for adjoint sweeps.\n"
+     "compression: 'quantized' (error bounded by tol, relative to the max-norm\n"
+     "of the snapshot if relative is set), 'float' or 'raw'. Snapshots are written\n"
+     "by a background thread and read in any order. create=False opens a closed file.")
+    .def(py::init([] (string filename, string compression, double tol, bool relative, bool create)
+                  {
+                    SNAPSHOT_COMPRESSION comp = SNAPSHOT_QUANTIZED;
+                    if (compression == "float")
+                      comp = SNAPSHOT_FLOAT;
+                    else if (compression == "raw")
+                      comp = SNAPSHOT_RAW;
+                    else if (compression != "quantized")
+                      throw Exception ("SnapshotStore: unknown compression '" + compression +
+                                       "', use quantized, float or raw");
+                    return make_shared<SnapshotStore> (filename, comp, tol, relative, create);
+                  }), py::arg("filename"), py::arg("compression") = "quantized",
+         py::arg("tol") = 1e-10, py::arg("relative") = false, py::arg("create") = true)
+    .def("Append", &SnapshotStore::Append, py::arg("vec"), py::call_guard<py::gil_scoped_release>(),
+         "compresses and queues the vector, returns the snapshot number")
+    .def("Get", &SnapshotStore::Get, py::arg("nr"), py::arg("vec"),
+         py::call_guard<py::gil_scoped_release>(), "decompresses snapshot nr into vec")
+    .def("Flush", &SnapshotStore::Flush, py::call_guard<py::gil_scoped_release>())
+    .def("Close", &SnapshotStore::Close, py::call_guard<py::gil_scoped_release>(),
+         "writes the index, the file can be opened again with create=False")
+    .def("__len__", &SnapshotStore::Size)
+    .def_property_readonly("compressed_bytes", &SnapshotStore::CompressedBytes)
+    .def_property_readonly("uncompressed_bytes", &SnapshotStore::UncompressedBytes)
+    ;
+
+  m.def("RAP", [] (const SparseMatrix<double> & r, const SparseMatrix<double> & a,
+                   const SparseMatrix<double> & p)
+        { return RAP (r, a, p); },
+        py::arg("R"), py::arg("A"), py::arg("P"), py::call_guard<py::gil_scoped_release>(),
+        "Galerkin product R*A*P of sparse matrices");
+
+  py::class_<SparseRAP, shared_ptr<SparseRAP>>
+    (m, "SparseRAP", "Galerkin product R*A*P, keeps the graph for repeated updates of A")
+    .def(py::init([] (shared_ptr<SparseMatrix<double>> r, const SparseMatrix<double> & a,
+                      shared_ptr<SparseMatrix<double>> p)
+                  { return make_shared<SparseRAP> (r, a, p); }),
+         py::arg("R"), py::arg("A"), py::arg("P"), py::call_guard<py::gil_scoped_release>())
+    .def("Update", &SparseRAP::Update, py::arg("A"), py::call_guard<py::gil_scoped_release>(),
+         "recompute values for A with unchanged graph")
+    .def_property_readonly("mat", &SparseRAP::GetMatrix)
+    ;
+
 
   py::class_<SparseMatrixDynamic<double>, shared_ptr<SparseMatrixDynamic<double>>, BaseMatrix>
     (m, "SparseMatrixDynamic")
@@ -970,14 +1573,80 @@ inverse : string
          ;
 
 
+  py::class_<SparseMatrixFloat, shared_ptr<SparseMatrixFloat>, BaseMatrix>
+    (m, "SparseMatrixFloat", "copy of a real sparse matrix with values in single precision")
+    .def(py::init([] (const BaseMatrix & mat) -> shared_ptr<SparseMatrixFloat>
+                  {
+                    if (auto ptr = dynamic_cast<const SparseMatrixTM<double>*> (&mat); ptr)
+                      return make_shared<SparseMatrixFloat> (*ptr);
+                    if (auto ptr = dynamic_cast<const SparseMatrixTM<Mat<2,2>>*> (&mat); ptr)
+                      return make_shared<SparseMatrixFloat> (*ptr);
+                    if (auto ptr = dynamic_cast<const SparseMatrixTM<Mat<3,3>>*> (&mat); ptr)
+                      return make_shared<SparseMatrixFloat> (*ptr);
+                    throw Exception("SparseMatrixFloat needs a real sparse matrix");
+                  }), py::arg("mat"))
+    ;
+
+  py::class_<SparseMatrixSELL, shared_ptr<SparseMatrixSELL>, BaseMatrix>
+    (m, "SparseMatrixSELL", "SELL-C-sigma copy of a real sparse matrix for fast matrix-vector products")
+    .def(py::init([] (const BaseMatrix & mat, size_t sigma)
+                  {
+                    if (auto ptr = dynamic_cast<const SparseMatrixTM<double>*> (&mat); ptr)
+                      return make_shared<SparseMatrixSELL> (*ptr, sigma);
+                    throw Exception("SparseMatrixSELL needs a real sparse matrix with scalar entries");
+                  }), py::arg("mat"), py::arg("sigma")=256,
+         "sigma ... window size for sorting rows by length")
+    ;
+
+  py::class_<SparseMatrixCompressed, shared_ptr<SparseMatrixCompressed>, BaseMatrix>
+    (m, "SparseMatrixCompressed", "copy of a real sparse matrix with compressed column indices")
+    .def(py::init([] (const BaseMatrix & mat, string compression)
+                  {
+                    SparseMatrixCompressed::COMPRESSION comp;
+                    if (compression == "runs")
+                      comp = SparseMatrixCompressed::RUNS;
+                    else if (compression == "offset16")
+                      comp = SparseMatrixCompressed::OFFSET16;
+                    else
+                      throw Exception("SparseMatrixCompressed: unknown compression '"+compression+"', use 'runs' or 'offset16'");
+                    if (auto ptr = dynamic_cast<const SparseMatrixTM<double>*> (&mat); ptr)
+                      return make_shared<SparseMatrixCompressed> (*ptr, comp);
+                    throw Exception("SparseMatrixCompressed needs a real sparse matrix with scalar entries");
+                  }), py::arg("mat"), py::arg("compression")="runs",
+         "compression ... 'runs' of consecutive columns, or 'offset16' relative to the row base")
+    .def_property_readonly("index_memory", &SparseMatrixCompressed::IndexMemory,
+                           "bytes used for column indices")
+    ;
+
   py::class_<SparseMatrixVariableBlocks<double>, shared_ptr<SparseMatrixVariableBlocks<double>>, BaseMatrix>
-    (m, "SparseMatrixVariableBlocks")
+    (m, "SparseMatrixVariableBlocks",
+     "copy of a real sparse matrix as blocks of consecutive rows with equal column indices")
     .def(py::init([] (const BaseMatrix & mat)
                   {
                     if (auto ptr = dynamic_cast<const SparseMatrixTM<double>*> (&mat); ptr)
                       return make_shared<SparseMatrixVariableBlocks<double>> (*ptr);
                     throw Exception("cannot create SparseMatrixVariableBlocks");
-                  }))
+                  }), py::arg("mat"))
+    .def_property_readonly("nblocks", &SparseMatrixVariableBlocks<double>::NBlocks)
+    .def("GetBlocks", [] (SparseMatrixVariableBlocks<double> & self)
+         {
+           py::list blocks;
+           for (size_t i = 0; i < self.NBlocks(); i++)
+             {
+               py::list block;
+               for (auto r : self.BlockRows(i))
+                 block.append (r);
+               blocks.append (block);
+             }
+           return blocks;
+         }, "rows of the blocks, for CreateBlockSmoother")
+    .def("InvertDiagonalBlocks", &SparseMatrixVariableBlocks<double>::InvertDiagonalBlocks,
+         py::arg("freedofs")=nullptr, py::call_guard<py::gil_scoped_release>(),
+         "inverts the diagonal blocks for Smooth, rows and columns of not free dofs are zero")
+    .def("Smooth", &SparseMatrixVariableBlocks<double>::GSSmooth,
+         py::arg("x"), py::arg("b"), py::arg("steps")=1, py::arg("backward")=false,
+         py::call_guard<py::gil_scoped_release>(),
+         "performs steps block-Gauss-Seidel iterations for the linear system A x = b")
     ;
 
   
@@ -990,6 +1659,9 @@ inverse : string
     .def("SmoothBack", &BaseBlockJacobiPrecond::GSSmoothBack,
          py::arg("x"), py::arg("b"), py::arg("steps")=1, py::call_guard<py::gil_scoped_release>(),
          "performs steps block-Gauss-Seidel iterations for the linear system A x = b in reverse order")
+    .def("SmoothSymmetric", &BaseBlockJacobiPrecond::GSSmoothSymmetric,
+         py::arg("x"), py::arg("b"), py::arg("steps")=1, py::call_guard<py::gil_scoped_release>(),
+         "performs steps symmetric block-Gauss-Seidel iterations (forward and backward sweep),\nblocks of the same color run in parallel")
     ;
 
   py::class_<BaseJacobiPrecond, shared_ptr<BaseJacobiPrecond>, BaseMatrix>
@@ -1013,8 +1685,26 @@ inverse : string
          "perform smoothing step (needs non-symmetric storage so symmetric sparse matrix)")
     ;
 
-  py::class_<SparseCholesky<double>, shared_ptr<SparseCholesky<double>>, SparseFactorization> (m, "SparseCholesky_d");
-  py::class_<SparseCholesky<Complex>, shared_ptr<SparseCholesky<Complex>>, SparseFactorization> (m, "SparseCholesky_c");
+  py::class_<SparseCholesky<double>, shared_ptr<SparseCholesky<double>>, SparseFactorization> (m, "SparseCholesky_d")
+    .def("FactorSamePattern", [](SparseCholesky<double> & self, shared_ptr<SparseMatrix<double>> mat)
+         { return self.FactorSamePattern (*mat); },
+         py::arg("mat"), py::keep_alive<0,2>(), py::call_guard<py::gil_scoped_release>(),
+         "factorization of a matrix with the same sparsity pattern (and freedofs), reuses ordering and symbolic factorization")
+    .def_property("level_scheduling",
+                  [](SparseCholesky<double> & self) { return self.GetLevelScheduling(); },
+                  [](SparseCholesky<double> & self, bool ls) { self.SetLevelScheduling(ls); },
+                  "forward/backward substitution level by level of the task graph instead of the dynamic task queue")
+    ;
+  py::class_<SparseCholesky<Complex>, shared_ptr<SparseCholesky<Complex>>, SparseFactorization> (m, "SparseCholesky_c")
+    .def("FactorSamePattern", [](SparseCholesky<Complex> & self, shared_ptr<SparseMatrix<Complex>> mat)
+         { return self.FactorSamePattern (*mat); },
+         py::arg("mat"), py::keep_alive<0,2>(), py::call_guard<py::gil_scoped_release>(),
+         "factorization of a matrix with the same sparsity pattern (and freedofs), reuses ordering and symbolic factorization")
+    .def_property("level_scheduling",
+                  [](SparseCholesky<Complex> & self) { return self.GetLevelScheduling(); },
+                  [](SparseCholesky<Complex> & self, bool ls) { self.SetLevelScheduling(ls); },
+                  "forward/backward substitution level by level of the task graph instead of the dynamic task queue")
+    ;
   
   py::class_<Projector, shared_ptr<Projector>, BaseMatrix> (m, "Projector")
     .def(py::init<shared_ptr<BitArray>,bool>(),
@@ -1038,6 +1728,10 @@ inverse : string
                     return make_shared<PermutationMatrix> (w, move(inda)); 
                   }),
          py::arg("w"), py::arg("ind"))
+    .def(py::init([](shared_ptr<BitArray> subset)
+                  { return make_shared<PermutationMatrix> (*subset); }),
+         py::arg("subset"),
+         "restriction to the set bits of subset, its transpose is the extension by zero")
     ;
   
   py::class_<Embedding, shared_ptr<Embedding>, BaseMatrix> (m, "Embedding")
@@ -1063,22 +1757,30 @@ inverse : string
 
   m.def("CGSolver", [](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
                                           bool iscomplex, bool printrates, 
-                                          double precision, int maxsteps)
+                                          double precision, int maxsteps, bool pipelined)
                                        {
                                          shared_ptr<KrylovSpaceSolver> solver;
                                          if(mat->IsComplex()) iscomplex = true;
                                          
                                          if (iscomplex)
-                                           solver = make_shared<CGSolver<Complex>> (mat, pre);
+                                           {
+                                             auto cg = make_shared<CGSolver<Complex>> (mat, pre);
+                                             cg->SetPipelined (pipelined);
+                                             solver = cg;
+                                           }
                                          else
-                                           solver = make_shared<CGSolver<double>> (mat, pre);
+                                           {
+                                             auto cg = make_shared<CGSolver<double>> (mat, pre);
+                                             cg->SetPipelined (pipelined);
+                                             solver = cg;
+                                           }
                                          solver->SetPrecision(precision);
                                          solver->SetMaxSteps(maxsteps);
                                          solver->SetPrintRates (printrates);
                                          return solver;
                                        },
            py::arg("mat"), py::arg("pre"), py::arg("complex") = false, py::arg("printrates")=true,
-        py::arg("precision")=1e-8, py::arg("maxsteps")=200, docu_string(R"raw_string(
+        py::arg("precision")=1e-8, py::arg("maxsteps")=200, py::arg("pipelined")=false, docu_string(R"raw_string(
 A CG Solver.
 
 Parameters:
@@ -1101,6 +1803,12 @@ precision : float
 maxsteps : int
   input maximal steps. CGSolver stops after this steps.
 
+pipelined : bool
+  use pipelined CG (Ghysels-Vanroose): one fused, non-blocking global
+  reduction per iteration, overlapped with preconditioner and matrix
+  application. Saves synchronization for many MPI ranks, but is
+  slightly less stable than standard CG.
+
 )raw_string"))
     ;
 
@@ -1142,6 +1850,202 @@ maxsteps : int
 )raw_string"))
     ;
 
+  m.def("MinResSolver", [](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
+                           bool printrates, double precision, int maxsteps)
+        {
+          if (mat->IsComplex())
+            throw Exception ("MinResSolver: only real matrices");
+          shared_ptr<KrylovSpaceSolver> solver = make_shared<MinResSolver<double>> (mat, pre);
+          solver->SetPrecision(precision);
+          solver->SetMaxSteps(maxsteps);
+          solver->SetPrintRates (printrates);
+          return solver;
+        },
+        py::arg("mat"), py::arg("pre")=nullptr, py::arg("printrates")=true,
+        py::arg("precision")=1e-8, py::arg("maxsteps")=200, docu_string(R"raw_string(
+Preconditioned MinRes solver for symmetric, indefinite matrices.
+
+Works on BlockVectors of BlockMatrices, e.g. with a 'diagonal'
+BlockPreconditioner for saddle point problems.
+
+Parameters:
+
+mat : ngsolve.la.BaseMatrix
+  input symmetric matrix 
+
+pre : ngsolve.la.BaseMatrix
+  symmetric positive definite preconditioner
+
+printrates : bool
+  input printrates
+
+precision : float
+  requested reduction of the preconditioned residual.
+
+maxsteps : int
+  input maximal steps. MinResSolver stops after this steps.
+
+)raw_string"))
+    ;
+
+  m.def("FGMRESSolver", [](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
+                           bool printrates, double precision, int maxsteps, int restart)
+        {
+          shared_ptr<KrylovSpaceSolver> solver;
+          if (!mat->IsComplex())
+            {
+              auto fgmres = make_shared<FGMRESSolver<double>> (mat, pre);
+              fgmres->SetRestart (restart);
+              solver = fgmres;
+            }
+          else
+            {
+              auto fgmres = make_shared<FGMRESSolver<Complex>> (mat, pre);
+              fgmres->SetRestart (restart);
+              solver = fgmres;
+            }
+          solver->SetPrecision(precision);
+          solver->SetMaxSteps(maxsteps);
+          solver->SetPrintRates (printrates);
+          return solver;
+        },
+        py::arg("mat"), py::arg("pre"), py::arg("printrates")=true,
+        py::arg("precision")=1e-8, py::arg("maxsteps")=200, py::arg("restart")=0, docu_string(R"raw_string(
+A flexible, right preconditioned GMRES Solver.
+
+The preconditioner may change from step to step. The Krylov basis is
+orthogonalized by classical Gram-Schmidt with re-orthogonalization,
+which needs two global reductions per iteration.
+
+Parameters:
+
+mat : ngsolve.la.BaseMatrix
+  input matrix 
+
+pre : ngsolve.la.BaseMatrix
+  input preconditioner matrix
+
+printrates : bool
+  input printrates
+
+precision : float
+  input requested precision. FGMRESSolver stops if precision is reached.
+
+maxsteps : int
+  input maximal steps. FGMRESSolver stops after this steps.
+
+restart : int
+  restart length, 0 for no restart.
+
+)raw_string"))
+    ;
+
+  py::class_<DeflatedCGSolver<double>, shared_ptr<DeflatedCGSolver<double>>, KrylovSpaceSolver>
+    (m, "DeflatedCGSolver", docu_string(R"raw_string(
+CG with deflation for sequences of linear systems.
+
+A few approximate eigenvectors to the smallest eigenvalues of pre*mat
+are kept from solve to solve and projected out of the search
+directions. They are improved after every solve, the matrix may
+change in between. Real matrices only.
+
+Parameters:
+
+mat : ngsolve.la.BaseMatrix
+  input matrix
+
+pre : ngsolve.la.BaseMatrix
+  input preconditioner matrix
+
+numdefl : int
+  dimension of the deflation space
+
+numdirections : int
+  search directions kept for the update of the deflation space,
+  -1 for 2*numdefl
+
+printrates : bool
+  input printrates
+
+precision : float
+  input requested precision, relative to the initial residual
+
+maxsteps : int
+  input maximal steps
+
+)raw_string"))
+    .def(py::init([](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
+                     int numdefl, int numdirections, bool printrates, double precision, int maxsteps)
+                  {
+                    if (mat->IsComplex())
+                      throw Exception ("DeflatedCGSolver: only real matrices supported");
+                    auto solver = make_shared<DeflatedCGSolver<double>> (mat, pre);
+                    solver->SetDeflation (numdefl, numdirections);
+                    solver->SetPrecision(precision);
+                    solver->SetMaxSteps(maxsteps);
+                    solver->SetPrintRates (printrates);
+                    return solver;
+                  }),
+         py::arg("mat"), py::arg("pre"), py::arg("numdefl")=5, py::arg("numdirections")=-1,
+         py::arg("printrates")=true, py::arg("precision")=1e-8, py::arg("maxsteps")=200)
+    .def("ResetSubspace", &DeflatedCGSolver<double>::ResetSubspace,
+         "forget the deflation space")
+    .def_property_readonly("subspacesize", &DeflatedCGSolver<double>::GetSubspaceSize)
+    ;
+
+  py::class_<RecycledGMRESSolver<double>, shared_ptr<RecycledGMRESSolver<double>>, KrylovSpaceSolver>
+    (m, "RecycledGMRESSolver", docu_string(R"raw_string(
+Restarted, right preconditioned GMRES with subspace recycling (GCRO-DR).
+
+A small subspace is kept from cycle to cycle and from solve to solve,
+the Krylov space is built orthogonal to its image. Pays off for
+sequences of systems with the same or a slowly varying matrix.
+Real matrices only.
+
+Parameters:
+
+mat : ngsolve.la.BaseMatrix
+  input matrix
+
+pre : ngsolve.la.BaseMatrix
+  input preconditioner matrix
+
+restart : int
+  cycle length, including the recycled vectors
+
+recycle : int
+  dimension of the recycled space
+
+printrates : bool
+  input printrates
+
+precision : float
+  input requested precision, relative to the initial residual
+
+maxsteps : int
+  input maximal steps
+
+)raw_string"))
+    .def(py::init([](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
+                     int restart, int recycle, bool printrates, double precision, int maxsteps)
+                  {
+                    if (mat->IsComplex())
+                      throw Exception ("RecycledGMRESSolver: only real matrices supported");
+                    auto solver = make_shared<RecycledGMRESSolver<double>> (mat, pre);
+                    solver->SetRestart (restart);
+                    solver->SetRecycle (recycle);
+                    solver->SetPrecision(precision);
+                    solver->SetMaxSteps(maxsteps);
+                    solver->SetPrintRates (printrates);
+                    return solver;
+                  }),
+         py::arg("mat"), py::arg("pre"), py::arg("restart")=30, py::arg("recycle")=5,
+         py::arg("printrates")=true, py::arg("precision")=1e-8, py::arg("maxsteps")=200)
+    .def("ResetSubspace", &RecycledGMRESSolver<double>::ResetSubspace,
+         "forget the recycled space")
+    .def_property_readonly("subspacesize", &RecycledGMRESSolver<double>::GetSubspaceSize)
+    ;
+
   m.def("EigenValues_Preconditioner", [](const BaseMatrix & mat, const BaseMatrix & pre, double tol) {
       EigenSystem eigen(mat, pre);
       eigen.SetPrecision(tol);
@@ -1200,9 +2104,56 @@ maxsteps : int
 )raw_string"))
     ;
   
+  m.def("LOBPCG", [](shared_ptr<BaseMatrix> mata, shared_ptr<BaseMatrix> matm,
+                     shared_ptr<BaseMatrix> pre, shared_ptr<BitArray> freedofs,
+                     int num, int maxsteps, double precision, bool printrates)
+        {
+          LOBPCG lobpcg(mata, matm, pre, freedofs);
+          lobpcg.SetMaxSteps (maxsteps);
+          lobpcg.SetPrecision (precision);
+          lobpcg.SetPrintRates (printrates);
+          auto evecs = make_shared<MultiVector> (mata->Height(), num);
+          Vector<double> lam;
+          {
+            py::gil_scoped_release release;
+            lam = lobpcg.Calc (*evecs);
+          }
+          return py::make_tuple (lam, evecs);
+        },
+        py::arg("mata"), py::arg("matm") = nullptr, py::arg("pre") = nullptr,
+        py::arg("freedofs") = nullptr, py::arg("num") = 1, py::arg("maxsteps") = 200,
+        py::arg("precision") = 1e-8, py::arg("printrates") = false,
+        docu_string(R"raw_string(
+Block eigenvalue solver LOBPCG
+
+Computes the num smallest eigenpairs of the generalized EVP A*u = lam*M*u,
+A and M symmetric, M positive definite. The whole block is kept in
+MultiVectors and the Rayleigh-Ritz step uses dense Gram matrices.
+
+Parameters:
+
+mata : ngsolve.la.BaseMatrix
+  matrix A
+
+matm : ngsolve.la.BaseMatrix
+  matrix M, identity if not given
+
+pre : ngsolve.la.BaseMatrix
+  preconditioner for A
+
+freedofs : ngsolve.ngstd.BitArray
+  eigenvectors vanish on the other dofs
+
+num : int
+  number of eigenpairs
+
+Returns the tuple (eigenvalues, eigenvectors as MultiVector).
+)raw_string"));
+
   m.def("ArnoldiSolver", [](shared_ptr<BaseMatrix> mata, shared_ptr<BaseMatrix> matm,
                             shared_ptr<BitArray> freedofs,
-                            py::list vecs, Complex shift)
+                            py::list vecs, Complex shift, int maxrestarts, double tol,
+                            bool krylovschur)
         {
           int nev;
           {
@@ -1217,11 +2168,15 @@ maxsteps : int
             {
               Arnoldi<Complex> arnoldi (mata, matm, freedofs);
               arnoldi.SetShift (shift);
+              arnoldi.SetRestarts (maxrestarts, tol);
               
               Array<shared_ptr<BaseVector>> evecs(nev);
                                                   
               Array<Complex> lam(nev);
-              arnoldi.Calc (2*nev+1, lam, nev, evecs, 0);
+              if (krylovschur)
+                arnoldi.CalcKrylovSchur (max2(2*nev+1, nev+3), lam, nev, evecs, 0);
+              else
+                arnoldi.Calc (2*nev+1, lam, nev, evecs, 0);
 
               {
                 py::gil_scoped_acquire acq;
@@ -1240,11 +2195,15 @@ maxsteps : int
               if (shift.imag())
                 throw Exception("Only real shifts allowed for real arnoldi");
               arnoldi.SetShift (shift.real());
+              arnoldi.SetRestarts (maxrestarts, tol);
               
               Array<shared_ptr<BaseVector>> evecs(nev);
               
               Array<Complex> lam(nev);
-              arnoldi.Calc (2*nev+1, lam, nev, evecs, 0);
+              if (krylovschur)
+                arnoldi.CalcKrylovSchur (max2(2*nev+1, nev+3), lam, nev, evecs, 0);
+              else
+                arnoldi.Calc (2*nev+1, lam, nev, evecs, 0);
 
               {
                 py::gil_scoped_acquire acq;
@@ -1259,6 +2218,7 @@ maxsteps : int
             }
         },
           py::arg("mata"), py::arg("matm"), py::arg("freedofs"), py::arg("vecs"), py::arg("shift")=DummyArgument(),
+        py::arg("maxrestarts")=0, py::arg("tol")=1e-8, py::arg("krylovschur")=false,
         py::call_guard<py::gil_scoped_release>(),
         docu_string(R"raw_string(
 Shift-and-invert Arnoldi eigenvalue solver
@@ -1283,6 +2243,75 @@ vecs : list
 
 shift : object
   complex or real shift
+
+maxrestarts : int
+  restarts of the Krylov space by the wanted Ritz vectors
+
+tol : float
+  relative residual of the wanted eigenpairs to stop restarting
+
+krylovschur : bool
+  Krylov-Schur restarts, the basis keeps its dimension max(2*len(vecs)+1, len(vecs)+3)
+)raw_string"));
+
+  m.def("ArnoldiShifts", [](shared_ptr<BaseMatrix> mata, shared_ptr<BaseMatrix> matm,
+                            shared_ptr<BitArray> freedofs, std::vector<Complex> shifts,
+                            int nev, int numval, int maxrestarts, double tol)
+        {
+          Array<Complex> lam;
+          Array<shared_ptr<BaseVector>> evecs;
+          if (numval <= 0) numval = 2*nev+1;
+          if (mata->IsComplex())
+            {
+              Arnoldi<Complex> arnoldi (mata, matm, freedofs);
+              arnoldi.SetRestarts (maxrestarts, tol);
+              Array<Complex> ashifts(shifts.size());
+              for (auto i : Range(ashifts)) ashifts[i] = shifts[i];
+              arnoldi.CalcShifts (ashifts, numval, lam, nev, evecs);
+            }
+          else
+            {
+              Arnoldi<double> arnoldi (mata, matm, freedofs);
+              arnoldi.SetRestarts (maxrestarts, tol);
+              Array<double> ashifts(shifts.size());
+              for (auto i : Range(ashifts))
+                {
+                  if (shifts[i].imag())
+                    throw Exception("Only real shifts allowed for real arnoldi");
+                  ashifts[i] = shifts[i].real();
+                }
+              arnoldi.CalcShifts (ashifts, numval, lam, nev, evecs);
+            }
+          Vector<Complex> vlam(lam.Size());
+          for (auto i : Range(lam)) vlam(i) = lam[i];
+          py::gil_scoped_acquire acq;
+          py::list vecs;
+          for (auto v : evecs) vecs.append (py::cast(v));
+          return py::make_tuple (vlam, vecs);
+        },
+        py::arg("mata"), py::arg("matm"), py::arg("freedofs"), py::arg("shifts"), py::arg("nev"),
+        py::arg("numval")=0, py::arg("maxrestarts")=0, py::arg("tol")=1e-8,
+        py::call_guard<py::gil_scoped_release>(),
+        docu_string(R"raw_string(
+Spectrum slicing by the shift-and-invert Arnoldi solver
+
+For every shift the nev eigenpairs closest to it are computed, an
+eigenpair is kept from the shift closest to its eigenvalue. The
+factorization of A-shift*M is reused from shift to shift, only the
+numerical factorization is repeated.
+
+Returns the tuple (eigenvalues, list of eigenvectors).
+
+Parameters:
+
+shifts : list
+  complex or real shifts
+
+nev : int
+  eigenpairs per shift
+
+numval : int
+  dimension of the Krylov space, 2*nev+1 if not given
 )raw_string"));
   
   
@@ -0,0 +1,122 @@
+/**************************************************************************/
+/* File:   reducedorder.cpp                                               */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+   projection of operators onto reduced bases
+*/
+
+#include <la.hpp>
+
+namespace ngla
+{
+
+  Matrix<double> ProjectMatrix (const BaseMatrix & a, const MultiVector & v, const MultiVector * w)
+  {
+    static Timer t("ProjectMatrix"); RegionTimer reg(t);
+    if (!w) w = &v;
+    if (v.Size() != size_t(a.Width()) || w->Size() != size_t(a.Height()))
+      throw Exception ("ProjectMatrix: matrix is " + ToString(a.Height()) + " x " + ToString(a.Width()) +
+                       ", bases of size " + ToString(w->Size()) + " and " + ToString(v.Size()));
+
+    // A V for all basis vectors at once, then the Gram matrix W^T (A V)
+    MultiVector av(w->Size(), v.NumVectors());
+    a.Mult (v, av);
+    return w->InnerProduct (av);
+  }
+
+  Vector<double> ProjectVector (const BaseVector & f, const MultiVector & w)
+  {
+    static Timer t("ProjectVector"); RegionTimer reg(t);
+    FlatVector<double> ff = f.FVDouble();
+    if (ff.Size() != w.Size())
+      throw Exception ("ProjectVector: vector of size " + ToString(ff.Size()) +
+                       ", basis of size " + ToString(w.Size()));
+    Vector<double> res = w.FM() * ff;
+    return res;
+  }
+
+
+  ReducedOperator :: ReducedOperator (shared_ptr<MultiVector> av, shared_ptr<MultiVector> aw)
+    : v(av), w(aw)
+  {
+    if (w && w->NumVectors() != v->NumVectors())
+      throw Exception ("ReducedOperator: trial and test basis of different dimension");
+  }
+
+  int ReducedOperator :: AddMatrix (shared_ptr<BaseMatrix> a)
+  {
+    mats.Append (a);
+    redmats.Append (make_shared<Matrix<double>> (ProjectMatrix (*a, *v, &TestBasis())));
+    return mats.Size()-1;
+  }
+
+  int ReducedOperator :: AddVector (shared_ptr<BaseVector> f)
+  {
+    vecs.Append (f);
+    redvecs.Append (make_shared<Vector<double>> (ProjectVector (*f, TestBasis())));
+    return vecs.Size()-1;
+  }
+
+  void ReducedOperator :: SetBasis (shared_ptr<MultiVector> av, shared_ptr<MultiVector> aw)
+  {
+    if (aw && aw->NumVectors() != av->NumVectors())
+      throw Exception ("ReducedOperator: trial and test basis of different dimension");
+    v = av;
+    w = aw;
+    Update ();
+    for (auto i : Range(vecs))
+      redvecs[i] = make_shared<Vector<double>> (ProjectVector (*vecs[i], TestBasis()));
+  }
+
+  void ReducedOperator :: Update (int q)
+  {
+    for (auto i : Range(mats))
+      if (q == -1 || q == int(i))
+        redmats[i] = make_shared<Matrix<double>> (ProjectMatrix (*mats[i], *v, &TestBasis()));
+  }
+
+  Matrix<double> ReducedOperator :: EvaluateMatrix (FlatVector<double> theta) const
+  {
+    if (theta.Size() != mats.Size())
+      throw Exception ("ReducedOperator: " + ToString(theta.Size()) + " coefficients for " +
+                       ToString(mats.Size()) + " matrices");
+    Matrix<double> res(Dim(), Dim());
+    res = 0.0;
+    for (auto i : Range(redmats))
+      res += theta(i) * *redmats[i];
+    return res;
+  }
+
+  Vector<double> ReducedOperator :: EvaluateVector (FlatVector<double> phi) const
+  {
+    if (phi.Size() != vecs.Size())
+      throw Exception ("ReducedOperator: " + ToString(phi.Size()) + " coefficients for " +
+                       ToString(vecs.Size()) + " vectors");
+    Vector<double> res(Dim());
+    res = 0.0;
+    for (auto i : Range(redvecs))
+      res += phi(i) * *redvecs[i];
+    return res;
+  }
+
+  Vector<double> ReducedOperator :: Solve (FlatVector<double> theta, FlatVector<double> phi) const
+  {
+    Matrix<double> mat = EvaluateMatrix (theta);
+    Vector<double> rhs = EvaluateVector (phi);
+    CalcInverse (mat);
+    Vector<double> x = mat * rhs;
+    return x;
+  }
+
+  void ReducedOperator :: Expand (FlatVector<double> x, BaseVector & u) const
+  {
+    if (x.Size() != Dim())
+      throw Exception ("ReducedOperator::Expand: " + ToString(x.Size()) + " coefficients, dimension " +
+                       ToString(Dim()));
+    u.FVDouble() = Trans(v->FM()) * x;
+  }
+
+}
@@ -0,0 +1,73 @@
+#ifndef FILE_REDUCEDORDER
+#define FILE_REDUCEDORDER
+
+/**************************************************************************/
+/* File:   reducedorder.hpp                                               */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+namespace ngla
+{
+
+  /// W^T A V by one multi-vector product and one dense product, W = V if not given
+  NGS_DLL_HEADER Matrix<double> ProjectMatrix (const BaseMatrix & a, const MultiVector & v,
+                                               const MultiVector * w = nullptr);
+
+  /// W^T f
+  NGS_DLL_HEADER Vector<double> ProjectVector (const BaseVector & f, const MultiVector & w);
+
+
+  /**
+     Reduced operator of an affine parameter decomposition
+
+         A(mu) = sum_q theta_q(mu) A_q,     f(mu) = sum_q phi_q(mu) f_q
+
+     projected onto the trial basis V and the test basis W (W = V for
+     Galerkin). The reduced terms W^T A_q V and W^T f_q are computed
+     once when the term is added (offline) and cached, the online
+     evaluation is a sum of small dense matrices. SetBasis recomputes
+     all projections, Update the projections of changed matrices.
+  */
+  class NGS_DLL_HEADER ReducedOperator
+  {
+    shared_ptr<MultiVector> v, w;
+    Array<shared_ptr<BaseMatrix>> mats;
+    Array<shared_ptr<BaseVector>> vecs;
+    Array<shared_ptr<Matrix<double>>> redmats;
+    Array<shared_ptr<Vector<double>>> redvecs;
+
+    const MultiVector & TestBasis () const { return w ? *w : *v; }
+  public:
+    ReducedOperator (shared_ptr<MultiVector> av, shared_ptr<MultiVector> aw = nullptr);
+
+    /// adds the term A_q and computes its projection, returns q
+    int AddMatrix (shared_ptr<BaseMatrix> a);
+    /// adds the term f_q and computes its projection, returns q
+    int AddVector (shared_ptr<BaseVector> f);
+
+    /// new bases, all projections are recomputed
+    void SetBasis (shared_ptr<MultiVector> av, shared_ptr<MultiVector> aw = nullptr);
+    /// recomputes the projection of term q after a change of A_q, for q = -1 of all terms
+    void Update (int q = -1);
+
+    /// dimension of the reduced space
+    size_t Dim () const { return v->NumVectors(); }
+    size_t NumMatrices () const { return mats.Size(); }
+    size_t NumVectors () const { return vecs.Size(); }
+    FlatMatrix<double> GetReducedMatrix (int q) const { return *redmats[q]; }
+    FlatVector<double> GetReducedVector (int q) const { return *redvecs[q]; }
+
+    /// sum_q theta_q W^T A_q V
+    Matrix<double> EvaluateMatrix (FlatVector<double> theta) const;
+    /// sum_q phi_q W^T f_q
+    Vector<double> EvaluateVector (FlatVector<double> phi) const;
+    /// coefficients x in V of the reduced solution of A(theta) u = f(phi)
+    Vector<double> Solve (FlatVector<double> theta, FlatVector<double> phi) const;
+    /// u = V x
+    void Expand (FlatVector<double> x, BaseVector & u) const;
+  };
+
+}
+
+#endif
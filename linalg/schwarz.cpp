@@ -0,0 +1,307 @@
+/**************************************************************************/
+/* File:   schwarz.cpp                                                    */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+   overlapping additive Schwarz preconditioner with local factorizations
+*/
+
+#include <la.hpp>
+#include <map>
+#include <set>
+
+namespace ngla
+{
+
+  SchwarzPrecond :: SchwarzPrecond (shared_ptr<SparseMatrix<double>> amat, const Table<int> & apatches,
+                                    SCHWARZ_TYPE atype, size_t adensesize)
+    : mat(amat), patches(apatches), type(atype), densesize(adensesize)
+  {
+    static Timer t("SchwarzPrecond ctor"); RegionTimer reg(t);
+    static Timer tsym("SchwarzPrecond symbolic");
+
+    symmetric_storage = dynamic_pointer_cast<SparseMatrixSymmetric<double>>(mat) != nullptr;
+    size_t ndof = mat->Height();
+    size_t npatches = apatches.Size();
+
+    // sorted patches, for the search of the local numbers
+    ParallelFor (npatches, [&] (size_t i) { QuickSort (patches[i]); });
+    for (auto patch : patches)
+      maxbs = max2 (maxbs, patch.Size());
+
+    // multiplicity of the dofs, owner = first patch containing it
+    Array<int> cnt(ndof);
+    cnt = 0;
+    owner.SetSize (ndof);
+    owner = -1;
+    for (auto i : Range(npatches))
+      for (auto d : patches[i])
+        {
+          if (d < 0 || size_t(d) >= ndof)
+            throw Exception ("SchwarzPrecond: dof " + ToString(d) + " out of range");
+          cnt[d]++;
+          if (owner[d] == -1) owner[d] = i;
+        }
+    if (type == SCHWARZ_WEIGHTED)
+      {
+        weight.SetSize (ndof);
+        for (auto d : Range(ndof))
+          weight[d] = cnt[d] ? 1.0 / sqrt (double(cnt[d])) : 0.0;
+      }
+
+    // dense inverses of the small patches
+    size_t totmem = 0;
+    for (auto patch : patches)
+      if (patch.Size() <= densesize)
+        totmem += sqr (patch.Size());
+    bigmem.SetSize (totmem);
+    inverses.SetSize (npatches);
+    totmem = 0;
+    for (auto i : Range(npatches))
+      {
+        size_t bs = patches[i].Size();
+        if (bs > densesize) bs = 0;
+        new (&inverses[i]) FlatMatrix<double> (bs, bs, bigmem.Data()+totmem);
+        totmem += sqr (bs);
+      }
+
+    // sparse matrices of the large patches
+    localmats.SetSize (npatches);
+    factors.SetSize (npatches);
+    symbolic.SetSize (npatches);
+    ParallelFor (npatches, [&] (size_t i)
+                 {
+                   if (patches[i].Size() > densesize)
+                     localmats[i] = LocalMatrix (i);
+                 });
+
+    // one symbolic factorization per local sparsity pattern
+    {
+      RegionTimer regsym(tsym);
+      std::map<std::vector<int>, int> patterns;
+      Array<int> representative(npatches);
+      representative = -1;
+      Array<int> unique;
+      for (auto i : Range(npatches))
+        {
+          if (!localmats[i]) continue;
+          auto & lmat = *localmats[i];
+          std::vector<int> key;
+          key.reserve (lmat.NZE() + lmat.Height() + 1);
+          for (auto r : Range(lmat.Height()))
+            {
+              key.push_back (lmat.GetRowIndices(r).Size());
+              for (auto c : lmat.GetRowIndices(r))
+                key.push_back (c);
+            }
+          auto [it, isnew] = patterns.emplace (std::move(key), i);
+          representative[i] = it->second;
+          if (isnew) unique.Append (i);
+        }
+      nsparse = 0;
+      for (auto i : Range(npatches))
+        if (localmats[i]) nsparse++;
+      nsymbolic = unique.Size();
+
+      ParallelFor (unique.Size(), [&] (size_t k)
+                   {
+                     int i = unique[k];
+                     symbolic[i] = make_shared<SparseCholeskySymbolic> (*localmats[i]);
+                   });
+      for (auto i : Range(npatches))
+        if (representative[i] != -1)
+          symbolic[i] = symbolic[representative[i]];
+    }
+
+    Factor ();
+
+    cout << IM(3) << "SchwarzPrecond: " << npatches << " patches, " << nsparse
+         << " sparse patches with " << nsymbolic << " different patterns" << endl;
+  }
+
+
+  template <typename TFUNC>
+  void SchwarzPrecond :: IterateLocal (size_t nr, TFUNC func) const
+  {
+    auto dofs = patches[nr];
+    for (size_t i = 0; i < dofs.Size(); i++)
+      {
+        auto cols = mat->GetRowIndices(dofs[i]);
+        auto vals = mat->GetRowValues(dofs[i]);
+        for (size_t k = 0; k < cols.Size(); k++)
+          {
+            auto pos = std::lower_bound (dofs.Data(), dofs.Data()+dofs.Size(), cols[k]);
+            if (pos == dofs.Data()+dofs.Size() || *pos != cols[k]) continue;
+            size_t j = pos - dofs.Data();
+            func (i, j, vals[k]);
+            // the lower triangle is stored
+            if (symmetric_storage && i != j)
+              func (j, i, vals[k]);
+          }
+      }
+  }
+
+  shared_ptr<SparseMatrix<double>> SchwarzPrecond :: LocalMatrix (size_t nr) const
+  {
+    size_t bs = patches[nr].Size();
+    Array<int> elsperrow(bs);
+    elsperrow = 0;
+    IterateLocal (nr, [&] (size_t i, size_t j, double val) { elsperrow[i]++; });
+    auto lmat = make_shared<SparseMatrix<double>> (elsperrow, bs);
+    IterateLocal (nr, [&] (size_t i, size_t j, double val) { (*lmat)(i,j) = val; });
+    return lmat;
+  }
+
+  void SchwarzPrecond :: LocalMatrix (size_t nr, FlatMatrix<double> m) const
+  {
+    m = 0.0;
+    IterateLocal (nr, [&] (size_t i, size_t j, double val) { m(i,j) = val; });
+  }
+
+
+  void SchwarzPrecond :: Factor ()
+  {
+    static Timer t("SchwarzPrecond factor"); RegionTimer reg(t);
+    static Timer tdense("SchwarzPrecond factor dense");
+    static Timer tsparse("SchwarzPrecond factor sparse");
+    size_t npatches = patches.Size();
+
+    {
+      RegionTimer regd(tdense);
+      // dense patches sorted by size, equal sizes are inverted together
+      Array<int> dense;
+      for (auto i : Range(npatches))
+        if (inverses[i].Height())
+          dense.Append (i);
+      QuickSort (dense, [&] (int a, int b)
+                 { return inverses[a].Height() < inverses[b].Height() ||
+                     (inverses[a].Height() == inverses[b].Height() && a < b); });
+
+      ParallelForRange (dense.Size(), [&] (IntRange r)
+                        {
+                          Array<SliceMatrix<double>> mats;
+                          for (auto k : r)
+                            {
+                              LocalMatrix (dense[k], inverses[dense[k]]);
+                              mats.Append (inverses[dense[k]]);
+                            }
+                          BatchedCalcInverse (mats);
+                        });
+    }
+
+    {
+      RegionTimer regs(tsparse);
+      ParallelFor (npatches, [&] (size_t i)
+                   {
+                     if (!localmats[i]) return;
+                     if (factors[i])   // new values, same graph
+                       {
+                         auto & lmat = *localmats[i];
+                         lmat.AsVector() = 0.0;
+                         IterateLocal (i, [&] (size_t r, size_t c, double val)
+                                       { lmat(r,c) = val; });
+                       }
+                     factors[i] = make_shared<SparseCholesky<double>> (*localmats[i], symbolic[i]);
+                   });
+    }
+  }
+
+  void SchwarzPrecond :: Update ()
+  {
+    Factor ();
+  }
+
+
+  template <bool TRANS>
+  void SchwarzPrecond :: Apply (double s, const BaseVector & x, BaseVector & y) const
+  {
+    auto fx = x.FV<double>();
+    auto fy = y.FV<double>();
+
+    // the weights of restriction and prolongation, restricted Schwarz
+    // prolongates the owned dofs only, its transpose restricts them only
+    auto restrict_weight = [&] (size_t nr, int d) -> double
+      {
+        switch (type)
+          {
+          case SCHWARZ_WEIGHTED: return weight[d];
+          case SCHWARZ_RESTRICTED: return (!TRANS || owner[d] == int(nr)) ? 1 : 0;
+          default: return 1;
+          }
+      };
+    auto prolongate_weight = [&] (size_t nr, int d) -> double
+      {
+        switch (type)
+          {
+          case SCHWARZ_WEIGHTED: return weight[d];
+          case SCHWARZ_RESTRICTED: return (TRANS || owner[d] == int(nr)) ? 1 : 0;
+          default: return 1;
+          }
+      };
+
+    ParallelForRange (patches.Size(), [&] (IntRange r)
+                      {
+                        Vector<double> mem(2*maxbs);
+                        for (auto nr : r)
+                          {
+                            auto dofs = patches[nr];
+                            size_t bs = dofs.Size();
+                            if (!bs) continue;
+                            FlatVector<double> hx(bs, mem.Data());
+                            FlatVector<double> hy(bs, mem.Data()+bs);
+                            for (size_t j = 0; j < bs; j++)
+                              hx(j) = restrict_weight (nr, dofs[j]) * fx(dofs[j]);
+
+                            if (factors[nr])
+                              {
+                                VFlatVector<double> vx(hx), vy(hy);
+                                factors[nr]->Mult (vx, vy);
+                              }
+                            else
+                              hy = inverses[nr] * hx;
+
+                            for (size_t j = 0; j < bs; j++)
+                              {
+                                double w = prolongate_weight (nr, dofs[j]);
+                                if (w != 0)
+                                  AtomicAdd (fy(dofs[j]), s * w * hy(j));
+                              }
+                          }
+                      });
+  }
+
+  void SchwarzPrecond :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SchwarzPrecond::MultAdd"); RegionTimer reg(t);
+    Apply<false> (s, x, y);
+  }
+
+  void SchwarzPrecond :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SchwarzPrecond::MultTransAdd"); RegionTimer reg(t);
+    Apply<true> (s, x, y);
+  }
+
+
+  Array<MemoryUsage> SchwarzPrecond :: GetMemoryUsage () const
+  {
+    Array<MemoryUsage> mu;
+    mu += { "Schwarz/dense inverses", bigmem.Size()*sizeof(double), 1 };
+    size_t factorbytes = 0, symbytes = 0;
+    std::set<SparseCholeskySymbolic*> counted;
+    for (auto i : Range(factors))
+      if (factors[i])
+        {
+          factorbytes += factors[i]->NZE() * sizeof(double) + patches[i].Size() * sizeof(double);
+          // the shared symbolic factorizations once
+          if (counted.insert (symbolic[i].get()).second)
+            symbytes += symbolic[i]->SymbolicBytes();
+        }
+    mu += { "Schwarz/sparse factors", factorbytes, nsparse };
+    mu += { "Schwarz/symbolic", symbytes, nsymbolic };
+    return mu;
+  }
+
+}
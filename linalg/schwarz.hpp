@@ -0,0 +1,105 @@
+#ifndef FILE_SCHWARZ
+#define FILE_SCHWARZ
+
+/**************************************************************************/
+/* File:   schwarz.hpp                                                    */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+namespace ngla
+{
+
+  enum SCHWARZ_TYPE
+    {
+      /// C = sum_i R_i^T A_i^{-1} R_i
+      SCHWARZ_ADDITIVE,
+      /// restricted Schwarz, every dof is written by one patch only, not symmetric
+      SCHWARZ_RESTRICTED,
+      /// C = sum_i R_i^T D_i A_i^{-1} D_i R_i, D_i^2 is a partition of unity
+      SCHWARZ_WEIGHTED
+    };
+
+
+  /**
+     Overlapping additive Schwarz preconditioner for a real sparse matrix.
+
+     The patches are given by a table of dofs, they may overlap (vertex
+     patches, patches of elements). Patches up to densesize dofs are
+     inverted dense, many at once by BatchedCalcInverse. The larger ones
+     are factored by SparseCholesky, patches with the same local
+     sparsity pattern (congruent patches of a structured mesh) share
+     one symbolic factorization. Setup and application run in
+     parallel over the patches.
+
+     The patch matrices must be symmetric, the matrix may be stored
+     symmetric or non-symmetric. Update () factors the new values of
+     the matrix, the patterns and symbolic factorizations are kept.
+  */
+  class NGS_DLL_HEADER SchwarzPrecond : public BaseMatrix
+  {
+    shared_ptr<SparseMatrix<double>> mat;
+    /// the dofs of the patches, sorted
+    Table<int> patches;
+    SCHWARZ_TYPE type;
+    size_t densesize;
+    bool symmetric_storage;
+
+    /// dense inverses, empty for the sparse patches
+    Array<FlatMatrix<double>> inverses;
+    Array<double> bigmem;
+
+    /// local matrices and factorizations of the sparse patches, nullptr for dense ones
+    Array<shared_ptr<SparseMatrix<double>>> localmats;
+    Array<shared_ptr<SparseCholesky<double>>> factors;
+    /// shared by the patches of equal local pattern
+    Array<shared_ptr<SparseCholeskySymbolic>> symbolic;
+    /// sparse patches and their different symbolic factorizations
+    size_t nsparse = 0;
+    size_t nsymbolic = 0;
+
+    /// D_i of the weighted variant, per dof
+    Array<double> weight;
+    /// the patch writing the dof in the restricted variant
+    Array<int> owner;
+
+    size_t maxbs = 0;
+
+  public:
+    SchwarzPrecond (shared_ptr<SparseMatrix<double>> amat, const Table<int> & apatches,
+                    SCHWARZ_TYPE atype = SCHWARZ_ADDITIVE, size_t adensesize = 100);
+
+    bool IsComplex() const override { return false; }
+    int VHeight() const override { return mat->Height(); }
+    int VWidth() const override { return mat->Width(); }
+    AutoVector CreateRowVector () const override { return mat->CreateColVector(); }
+    AutoVector CreateColVector () const override { return mat->CreateRowVector(); }
+
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    /// new values of the matrix, same graph
+    void Update () override;
+
+    size_t NumPatches () const { return patches.Size(); }
+    size_t NumSparsePatches () const { return nsparse; }
+    size_t NumSymbolic () const { return nsymbolic; }
+
+    Array<MemoryUsage> GetMemoryUsage () const override;
+
+  private:
+    /// the matrix of patch nr as a sparse matrix
+    shared_ptr<SparseMatrix<double>> LocalMatrix (size_t nr) const;
+    /// the matrix of patch nr into the dense matrix m
+    void LocalMatrix (size_t nr, FlatMatrix<double> m) const;
+    /// calls func (local row, local col, value) for all entries of the patch
+    template <typename TFUNC>
+    void IterateLocal (size_t nr, TFUNC func) const;
+    void Factor ();
+    template <bool TRANS>
+    void Apply (double s, const BaseVector & x, BaseVector & y) const;
+  };
+
+}
+
+#endif
@@ -0,0 +1,403 @@
+/**************************************************************************/
+/* File:   snapshotstore.cpp                                              */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+   compressed snapshot files
+
+   record:  n, nblocks, step, block bytes [nblocks], blocks
+   block:   type byte, payload
+   file:    records, index (nsnap, offset/bytes/size per snapshot),
+            index offset, magic
+*/
+
+#include <la.hpp>
+#include <cstring>
+#include <limits>
+
+namespace ngla
+{
+
+  static constexpr size_t SNAPSHOT_BLOCKSIZE = 8192;
+  static const char snapshot_magic[8] = "NGSSNP1";
+
+  enum { BLOCK_QUANTIZED = 0, BLOCK_RAW = 1, BLOCK_FLOAT = 2 };
+
+  template <typename T>
+  static void PutValue (char *& p, T val)
+  {
+    memcpy (p, &val, sizeof(T));
+    p += sizeof(T);
+  }
+
+  template <typename T>
+  static T GetValue (const char *& p)
+  {
+    T val;
+    memcpy (&val, p, sizeof(T));
+    p += sizeof(T);
+    return val;
+  }
+
+  /// the block into out, returns the number of bytes, out holds 10 bytes per entry + 1
+  static size_t CompressBlock (FlatVector<double> x, SNAPSHOT_COMPRESSION compression,
+                               double step, char * out)
+  {
+    char * p = out;
+    if (compression == SNAPSHOT_FLOAT)
+      {
+        bool ok = true;
+        for (double xi : x)
+          if (fabs(xi) > numeric_limits<float>::max() && fabs(xi) < numeric_limits<double>::infinity())
+            ok = false;
+        if (ok)
+          {
+            *p++ = BLOCK_FLOAT;
+            for (double xi : x)
+              PutValue (p, float(xi));
+            return p-out;
+          }
+      }
+
+    if (compression == SNAPSHOT_QUANTIZED && step > 0)
+      {
+        *p++ = BLOCK_QUANTIZED;
+        bool ok = true;
+        int64_t qprev = 0;
+        double maxq = double(int64_t(1) << 52);
+        for (double xi : x)
+          {
+            double qd = xi / step;
+            if (!(fabs(qd) < maxq)) { ok = false; break; }   // also nan, inf
+            int64_t q = llround (qd);
+            int64_t d = q - qprev;
+            qprev = q;
+            // zig-zag, then 7 bits per byte
+            uint64_t z = (uint64_t(d) << 1) ^ uint64_t(d >> 63);
+            while (z >= 0x80)
+              {
+                *p++ = char(z | 0x80);
+                z >>= 7;
+              }
+            *p++ = char(z);
+          }
+        if (ok && size_t(p-out) <= 1+sizeof(double)*x.Size())
+          return p-out;
+        p = out;
+      }
+
+    *p++ = BLOCK_RAW;
+    memcpy (p, x.Data(), x.Size()*sizeof(double));
+    return 1+x.Size()*sizeof(double);
+  }
+
+  static void DecompressBlock (const char * p, double step, FlatVector<double> x)
+  {
+    switch (*p++)
+      {
+      case BLOCK_RAW:
+        memcpy (x.Data(), p, x.Size()*sizeof(double));
+        break;
+      case BLOCK_FLOAT:
+        for (size_t i = 0; i < x.Size(); i++)
+          x(i) = GetValue<float> (p);
+        break;
+      case BLOCK_QUANTIZED:
+        {
+          int64_t q = 0;
+          for (size_t i = 0; i < x.Size(); i++)
+            {
+              uint64_t z = 0;
+              int shift = 0;
+              unsigned char c;
+              do
+                {
+                  c = *p++;
+                  z |= uint64_t(c & 0x7f) << shift;
+                  shift += 7;
+                }
+              while (c & 0x80);
+              q += int64_t(z >> 1) ^ -int64_t(z & 1);
+              x(i) = q * step;
+            }
+          break;
+        }
+      default:
+        throw Exception ("SnapshotStore: corrupt block");
+      }
+  }
+
+
+  Array<char> SnapshotStore :: Compress (FlatVector<double> x, SNAPSHOT_COMPRESSION compression,
+                                         double tol, bool relative)
+  {
+    static Timer t("SnapshotStore::Compress"); RegionTimer reg(t);
+    size_t n = x.Size();
+    size_t nblocks = (n+SNAPSHOT_BLOCKSIZE-1) / SNAPSHOT_BLOCKSIZE;
+
+    double abstol = tol;
+    if (relative)
+      {
+        double maxval = ParallelReduce (n, [&] (size_t i) { return fabs(x(i)); },
+                                        [] (double a, double b) { return max2(a,b); }, 0.0);
+        abstol = tol * maxval;
+      }
+    double step = 2*abstol;
+
+    Array<size_t> blockbytes(nblocks);
+    Array<char> tmp(nblocks*(10*SNAPSHOT_BLOCKSIZE+1));
+    ParallelFor (nblocks, [&] (size_t b)
+                 {
+                   IntRange r(b*SNAPSHOT_BLOCKSIZE, min2(n, (b+1)*SNAPSHOT_BLOCKSIZE));
+                   blockbytes[b] = CompressBlock (x.Range(r), compression, step,
+                                                  tmp.Data()+b*(10*SNAPSHOT_BLOCKSIZE+1));
+                 });
+
+    size_t headbytes = 2*sizeof(int64_t) + sizeof(double) + nblocks*sizeof(int64_t);
+    Array<size_t> first(nblocks+1);
+    first[0] = headbytes;
+    for (size_t b = 0; b < nblocks; b++)
+      first[b+1] = first[b] + blockbytes[b];
+
+    Array<char> record(first[nblocks]);
+    char * p = record.Data();
+    PutValue (p, int64_t(n));
+    PutValue (p, int64_t(nblocks));
+    PutValue (p, step);
+    for (size_t b = 0; b < nblocks; b++)
+      PutValue (p, int64_t(blockbytes[b]));
+    ParallelFor (nblocks, [&] (size_t b)
+                 {
+                   memcpy (record.Data()+first[b], tmp.Data()+b*(10*SNAPSHOT_BLOCKSIZE+1), blockbytes[b]);
+                 });
+    return record;
+  }
+
+  void SnapshotStore :: Decompress (FlatArray<char> record, FlatVector<double> x)
+  {
+    static Timer t("SnapshotStore::Decompress"); RegionTimer reg(t);
+    const char * p = record.Data();
+    size_t n = GetValue<int64_t> (p);
+    size_t nblocks = GetValue<int64_t> (p);
+    double step = GetValue<double> (p);
+    if (n != x.Size())
+      throw Exception ("SnapshotStore: snapshot has size " + ToString(n) +
+                       ", vector has size " + ToString(x.Size()));
+    Array<size_t> first(nblocks+1);
+    first[0] = p - record.Data() + nblocks*sizeof(int64_t);
+    for (size_t b = 0; b < nblocks; b++)
+      first[b+1] = first[b] + GetValue<int64_t> (p);
+    if (first[nblocks] > record.Size())
+      throw Exception ("SnapshotStore: corrupt record");
+
+    ParallelFor (nblocks, [&] (size_t b)
+                 {
+                   IntRange r(b*SNAPSHOT_BLOCKSIZE, min2(n, (b+1)*SNAPSHOT_BLOCKSIZE));
+                   DecompressBlock (record.Data()+first[b], step, x.Range(r));
+                 });
+  }
+
+
+
+  SnapshotStore :: SnapshotStore (const string & afilename, SNAPSHOT_COMPRESSION acompression,
+                                  double atol, bool arelative, bool create, size_t amax_pending)
+    : filename(afilename), compression(acompression), tol(atol), relative(arelative),
+      readonly(!create), max_pending(amax_pending)
+  {
+    if (readonly)
+      {
+        closed = true;
+        ReadIndex ();
+        return;
+      }
+
+    out.open (filename, ios::binary | ios::trunc);
+    if (!out)
+      throw Exception ("SnapshotStore: cannot create file " + filename);
+    writer = std::thread([this] () { WriterLoop(); });
+  }
+
+  SnapshotStore :: ~SnapshotStore ()
+  {
+    try
+      {
+        Close ();
+      }
+    catch (Exception & e)
+      {
+        cerr << "SnapshotStore: " << e.What() << endl;
+      }
+  }
+
+  void SnapshotStore :: WriterLoop ()
+  {
+    BackgroundPriority::Lower ();
+    while (true)
+      {
+        Array<char> * record;
+        {
+          unique_lock<mutex> guard(queue_mutex);
+          queue_cv.wait (guard, [&] { return stop || nwritten < entries.Size(); });
+          if (nwritten == entries.Size()) return;    // stop, and all written
+          record = &queue.front().second;
+        }
+
+        BackgroundPriority::WaitForCritical ();
+        // only the writer removes from the queue, the front stays valid
+        out.write (record->Data(), record->Size());
+        out.flush ();
+        if (!out) write_error = true;
+
+        {
+          lock_guard<mutex> guard(queue_mutex);
+          pending_bytes -= queue.front().second.Size();
+          queue.pop_front ();
+          nwritten++;
+        }
+        queue_cv.notify_all ();
+      }
+  }
+
+  size_t SnapshotStore :: Append (const BaseVector & vec)
+  {
+    static Timer t("SnapshotStore::Append"); RegionTimer reg(t);
+    if (readonly || closed)
+      throw Exception ("SnapshotStore: cannot append to a closed store");
+    if (write_error)
+      throw Exception ("SnapshotStore: write error on file " + filename);
+
+    FlatVector<double> fv = vec.FVDouble();
+    Array<char> record = Compress (fv, compression, tol, relative);
+
+    unique_lock<mutex> guard(queue_mutex);
+    // back-pressure, at least one snapshot is queued
+    queue_cv.wait (guard, [&] { return queue.empty() || pending_bytes + record.Size() <= max_pending; });
+
+    size_t nr = entries.Size();
+    entries.Append (Entry { file_end, record.Size(), fv.Size() });
+    file_end += record.Size();
+    uncompressed_bytes += fv.Size()*sizeof(double);
+    pending_bytes += record.Size();
+    queue.emplace_back (nr, std::move(record));
+    guard.unlock();
+    queue_cv.notify_all ();
+    return nr;
+  }
+
+  void SnapshotStore :: Get (size_t nr, BaseVector & vec)
+  {
+    static Timer t("SnapshotStore::Get"); RegionTimer reg(t);
+    FlatVector<double> fv = vec.FVDouble();
+
+    Entry entry;
+    {
+      lock_guard<mutex> guard(queue_mutex);
+      if (nr >= entries.Size())
+        throw Exception ("SnapshotStore: snapshot " + ToString(nr) + " out of range, have " +
+                         ToString(entries.Size()));
+      entry = entries[nr];
+      // still in the queue
+      for (auto & [qnr, record] : queue)
+        if (qnr == nr)
+          {
+            Decompress (record, fv);
+            return;
+          }
+    }
+
+    Array<char> record(entry.bytes);
+    {
+      lock_guard<mutex> guard(in_mutex);
+      if (!in.is_open())
+        {
+          in.open (filename, ios::binary);
+          if (!in)
+            throw Exception ("SnapshotStore: cannot open file " + filename);
+        }
+      in.clear ();
+      in.seekg (entry.offset);
+      in.read (record.Data(), entry.bytes);
+      if (!in)
+        throw Exception ("SnapshotStore: read error on file " + filename);
+    }
+    Decompress (record, fv);
+  }
+
+  void SnapshotStore :: Flush ()
+  {
+    unique_lock<mutex> guard(queue_mutex);
+    queue_cv.wait (guard, [&] { return nwritten == entries.Size(); });
+  }
+
+  void SnapshotStore :: Close ()
+  {
+    if (closed) return;
+    {
+      lock_guard<mutex> guard(queue_mutex);
+      stop = true;
+    }
+    queue_cv.notify_all ();
+    writer.join ();
+    closed = true;
+
+    Array<char> index((1+3*entries.Size())*sizeof(int64_t) + sizeof(int64_t) + 8);
+    char * p = index.Data();
+    PutValue (p, int64_t(entries.Size()));
+    for (auto & e : entries)
+      {
+        PutValue (p, int64_t(e.offset));
+        PutValue (p, int64_t(e.bytes));
+        PutValue (p, int64_t(e.size));
+      }
+    PutValue (p, int64_t(file_end));
+    memcpy (p, snapshot_magic, 8);
+    out.write (index.Data(), index.Size());
+    out.close ();
+    if (!out)
+      throw Exception ("SnapshotStore: write error on file " + filename);
+  }
+
+  void SnapshotStore :: ReadIndex ()
+  {
+    in.open (filename, ios::binary | ios::ate);
+    if (!in)
+      throw Exception ("SnapshotStore: cannot open file " + filename);
+    size_t filesize = in.tellg();
+    char tail[sizeof(int64_t)+8];
+    if (filesize < sizeof(tail))
+      throw Exception ("SnapshotStore: " + filename + " is not a snapshot file");
+    in.seekg (filesize-sizeof(tail));
+    in.read (tail, sizeof(tail));
+    if (memcmp (tail+sizeof(int64_t), snapshot_magic, 8) != 0)
+      throw Exception ("SnapshotStore: " + filename + " is not a closed snapshot file");
+    const char * p = tail;
+    file_end = GetValue<int64_t> (p);
+
+    Array<char> index(filesize-sizeof(tail)-file_end);
+    in.seekg (file_end);
+    in.read (index.Data(), index.Size());
+    if (!in || index.Size() < sizeof(int64_t))
+      throw Exception ("SnapshotStore: corrupt index in " + filename);
+    p = index.Data();
+    size_t nsnap = GetValue<int64_t> (p);
+    if (index.Size() != (1+3*nsnap)*sizeof(int64_t))
+      throw Exception ("SnapshotStore: corrupt index in " + filename);
+    entries.SetSize (nsnap);
+    for (auto & e : entries)
+      {
+        e.offset = GetValue<int64_t> (p);
+        e.bytes = GetValue<int64_t> (p);
+        e.size = GetValue<int64_t> (p);
+        uncompressed_bytes += e.size*sizeof(double);
+      }
+    nwritten = nsnap;
+  }
+
+  size_t SnapshotStore :: CompressedBytes () const
+  {
+    return file_end;
+  }
+
+}
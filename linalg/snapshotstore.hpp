@@ -0,0 +1,115 @@
+#ifndef FILE_SNAPSHOTSTORE
+#define FILE_SNAPSHOTSTORE
+
+/**************************************************************************/
+/* File:   snapshotstore.hpp                                              */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+#include <thread>
+#include <condition_variable>
+#include <deque>
+
+namespace ngla
+{
+
+  enum SNAPSHOT_COMPRESSION
+    {
+      /// full double precision
+      SNAPSHOT_RAW,
+      /// single precision, relative error 6e-8
+      SNAPSHOT_FLOAT,
+      /// quantized to multiples of 2 tol, differences of neighbours as variable length integers
+      SNAPSHOT_QUANTIZED
+    };
+
+
+  /**
+     A file of compressed vectors, such as the time history of a
+     solution for a reverse time adjoint sweep, or snapshots for a
+     reduced order model.
+
+     Append compresses the vector in parallel blocks and queues it, a
+     background thread writes the file. Get (nr, vec) reads any snapshot,
+     a snapshot not yet written is taken from the queue.
+
+     The quantized compression is error bounded, |x_i - x~_i| <= tol,
+     tol is relative to max |x_i| of the snapshot if relative is set.
+     Blocks where quantization does not pay (or non-finite values) are
+     stored in double precision. Complex vectors are stored as pairs of
+     doubles.
+
+     Close writes the index, a file written before is opened read-only
+     with create = false.
+  */
+  class NGS_DLL_HEADER SnapshotStore
+  {
+  public:
+    struct Entry
+    {
+      size_t offset;   // in the file
+      size_t bytes;    // compressed record
+      size_t size;     // number of doubles
+    };
+
+  private:
+    string filename;
+    SNAPSHOT_COMPRESSION compression;
+    double tol;
+    bool relative;
+    bool readonly;
+    bool closed = false;
+    /// bound of the queued bytes, Append waits for the writer
+    size_t max_pending;
+
+    Array<Entry> entries;
+    size_t file_end = 0;
+    size_t uncompressed_bytes = 0;
+
+    ofstream out;
+    ifstream in;
+    mutex in_mutex;
+
+    /// the queued records, written in order by the writer thread
+    std::deque<std::pair<size_t, Array<char>>> queue;
+    size_t pending_bytes = 0;
+    size_t nwritten = 0;
+    mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool stop = false;
+    std::atomic<bool> write_error{false};
+    std::thread writer;
+
+    void WriterLoop ();
+    void ReadIndex ();
+
+  public:
+    SnapshotStore (const string & afilename, SNAPSHOT_COMPRESSION acompression = SNAPSHOT_QUANTIZED,
+                   double atol = 1e-10, bool arelative = false, bool create = true,
+                   size_t amax_pending = size_t(1) << 30);
+    ~SnapshotStore ();
+
+    /// compresses and queues the snapshot, returns its number
+    size_t Append (const BaseVector & vec);
+    /// decompresses snapshot nr into vec, which has its size
+    void Get (size_t nr, BaseVector & vec);
+
+    /// waits until all snapshots are written
+    void Flush ();
+    /// writes the index, no more snapshots can be appended
+    void Close ();
+
+    size_t Size () const { return entries.Size(); }
+    size_t CompressedBytes () const;
+    size_t UncompressedBytes () const { return uncompressed_bytes; }
+
+    /// the compressed record of x
+    static Array<char> Compress (FlatVector<double> x, SNAPSHOT_COMPRESSION compression,
+                                 double tol, bool relative);
+    static void Decompress (FlatArray<char> record, FlatVector<double> x);
+  };
+
+}
+
+#endif
@@ -11,6 +11,12 @@
 #include <core/concurrentqueue.h>
 #include <core/taskmanager.hpp>
 
+#ifndef WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 typedef moodycamel::ConcurrentQueue<int> TQueue; 
 typedef moodycamel::ProducerToken TPToken; 
@@ -105,6 +111,67 @@ namespace ngla
 
 
 
+  string OutOfCoreDirectory ()
+  {
+    if (const char * dir = getenv ("NGS_OOC_DIR")) return dir;
+    if (const char * dir = getenv ("TMPDIR")) return dir;
+    return "/tmp";
+  }
+
+  MappedFileMemory :: MappedFileMemory (size_t asize, string dir)
+    : size(asize)
+  {
+#ifndef WIN32
+    if (size == 0) return;
+    string filename = dir + "/ngs_cholesky_XXXXXX";
+    Array<char> name(filename.size()+1);
+    for (size_t i = 0; i < filename.size(); i++)
+      name[i] = filename[i];
+    name[filename.size()] = 0;
+
+    int fd = mkstemp (name.Addr(0));
+    if (fd == -1)
+      throw Exception ("SparseCholesky out-of-core: cannot create file in "+dir);
+    unlink (name.Addr(0));   // file is removed when unmapped
+    
+    if (ftruncate (fd, size) != 0)
+      {
+        close (fd);
+        throw Exception ("SparseCholesky out-of-core: cannot reserve "+ToString(size)+
+                         " bytes in "+dir);
+      }
+    ptr = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);
+    if (ptr == MAP_FAILED)
+      {
+        ptr = nullptr;
+        throw Exception ("SparseCholesky out-of-core: mmap failed");
+      }
+#else
+    throw Exception ("SparseCholesky out-of-core storage not available on Windows");
+#endif
+  }
+
+  MappedFileMemory :: ~MappedFileMemory ()
+  {
+#ifndef WIN32
+    if (ptr) munmap (ptr, size);
+#endif
+  }
+
+  void MappedFileMemory :: Prefetch (const void * first, size_t bytes) const
+  {
+#ifndef WIN32
+    if (bytes == 0) return;
+    static size_t pagesize = sysconf (_SC_PAGESIZE);
+    size_t begin = size_t(first) / pagesize * pagesize;
+    size_t end = size_t(first) + bytes;
+    madvise ((void*)begin, end-begin, MADV_WILLNEED);
+#endif
+  }
+
+
+
   template <class TM>
   void SetIdentity( TM &identity )
   {
@@ -116,20 +183,14 @@ namespace ngla
 
 
 
-  template <class TM>
-  SparseCholeskyTM<TM> :: 
-  SparseCholeskyTM (const SparseMatrixTM<TM> & a, 
-                    shared_ptr<BitArray> ainner,
-                    shared_ptr<const Array<int>> acluster,
-                    bool allow_refactor)
-    : SparseFactorization (a, ainner, acluster), mat(a)
+  SparseCholeskySymbolic :: 
+  SparseCholeskySymbolic (const BaseSparseMatrix & a, 
+                          shared_ptr<BitArray> inner,
+                          shared_ptr<const Array<int>> cluster)
   { 
-    static Timer t("SparseCholesky - total");
+    static Timer t("SparseCholesky - symbolic");
     static Timer ta("SparseCholesky - allocate");
     RegionTimer reg(t);
-    // (*testout) << "matrix = " << a << endl;
-    // (*testout) << "diag a = ";
-    // for ( int i=0; i<a.Height(); i++ ) (*testout) << i << ", " << a(i,i) << endl;
 
     int n = a.Height();
     height = n;
@@ -142,7 +203,7 @@ namespace ngla
     clock_t starttime, endtime;
     starttime = clock();
     
-    mdo = new MinimumDegreeOrdering (n);
+    MinimumDegreeOrdering * mdo = new MinimumDegreeOrdering (n);
 
     if (inner)
       ParallelFor (n, [&] (size_t i)
@@ -156,48 +217,53 @@ namespace ngla
           mdo->SetUnusedVertex(i);
     
 
-    
-    if (!inner && !cluster)
-      for (int i = 0; i < n; i++)
-	for (int j = 0; j < a.GetRowIndices(i).Size(); j++)
-	  {
-	    int col = a.GetRowIndices(i)[j];
-	    if (col <= i)
-	      mdo->AddEdge (i, col);
-	  }
 
-    else if (inner)
+    auto iterate_edges = [&] (auto func)
       {
-        for (int i = 0; i < n; i++)
-          if (inner->Test(i))
-            for (auto col : a.GetRowIndices(i))
-              if (col <= i)
-                if (inner->Test(col)) //  || i==col)
-                  mdo->AddEdge (i, col);
-            /*
+        if (!inner && !cluster)
+          for (int i = 0; i < n; i++)
             for (int j = 0; j < a.GetRowIndices(i).Size(); j++)
               {
                 int col = a.GetRowIndices(i)[j];
                 if (col <= i)
-                if (inner->Test(col)) //  || i==col)
-                mdo->AddEdge (i, col);
-                }
+                  func (i, col);
+              }
+        
+        else if (inner)
+          {
+            for (int i = 0; i < n; i++)
+              if (inner->Test(i))
+                for (auto col : a.GetRowIndices(i))
+                  if (col <= i)
+                    if (inner->Test(col)) //  || i==col)
+                      func (i, col);
+            /*
+              for (int j = 0; j < a.GetRowIndices(i).Size(); j++)
+              {
+              int col = a.GetRowIndices(i)[j];
+              if (col <= i)
+              if (inner->Test(col)) //  || i==col)
+              mdo->AddEdge (i, col);
+              }
             */
-      }
+          }
+        
+        else 
+          for (int i = 0; i < n; i++)
+            {
+              FlatArray<int> row = a.GetRowIndices(i);
+              for (int j = 0; j < row.Size(); j++)
+                {
+                  int col = row[j];
+                  if (col <= i)
+                    if ( ( ((*cluster)[i] == (*cluster)[col]) && (*cluster)[i]) )
+                      // || i == col )
+                      func (i, col);
+                }
+            }
+      };
 
-    else 
-      for (int i = 0; i < n; i++)
-	{
-	  FlatArray<int> row = a.GetRowIndices(i);
-	  for (int j = 0; j < row.Size(); j++)
-	    {
-	      int col = row[j];
-	      if (col <= i)
-		if ( ( ((*cluster)[i] == (*cluster)[col]) && (*cluster)[i]) )
-                  // || i == col )
-		  mdo->AddEdge (i, col);
-	    }
-	}
+    iterate_edges ([&] (int i, int col) { mdo->AddEdge (i, col); });
     
     /*
     for (int i = 0; i < n; i++)
@@ -212,7 +278,30 @@ namespace ngla
       cout << IM(4) << "start ordering" << endl;
     
     // mdo -> PrintCliques ();
-    mdo->Order();
+    if (a.GetInverseType() == SPARSECHOLESKY_ND ||
+        a.GetInverseType() == SPARSECHOLESKY_OOC)
+      {
+        // eliminate along a nested dissection sequence,
+        // the symbolic elimination of the mdo still finds fill and supernodes
+        TableCreator<int> creator(n);
+        for ( ; !creator.Done(); creator++)
+          iterate_edges ([&] (int i, int col)
+                         {
+                           if (i == col) return;
+                           creator.Add (i, col);
+                           creator.Add (col, i);
+                         });
+        Table<int> graph = creator.MoveTable();
+        BitArray used(n);
+        used.Clear();
+        for (int i = 0; i < n; i++)
+          if (!mdo->vertices[i].Eliminated())
+            used.SetBit(i);
+        Array<int> sequence = NestedDissection (graph, used);
+        mdo->Order (sequence);
+      }
+    else
+      mdo->Order();
     nused = mdo->nused;
     endtime = clock();
     if (printstat)
@@ -229,11 +318,75 @@ namespace ngla
     ta.Stop();
 
     delete mdo;
-    mdo = 0;
+  }
+
+
+
+  void SparseCholeskySymbolic :: DoArchive (Archive & ar)
+  {
+    ar & height & nused & nze & maxrow;
+    ar & order & inv_order & firstinrow & rowindex2 & firstinrow_ri;
+    ar & blocknrs & blocks & block_dependency;
+    ar & microtasks & micro_dependency & micro_dependency_trans & micro_levels;
+  }
+
+
+
+  template <class TM>
+  SparseCholeskyTM<TM> :: 
+  SparseCholeskyTM (const SparseMatrixTM<TM> & a, 
+                    shared_ptr<BitArray> ainner,
+                    shared_ptr<const Array<int>> acluster,
+                    bool allow_refactor)
+    : SparseCholeskyTM (a, make_shared<SparseCholeskySymbolic> (a, ainner, acluster),
+                        ainner, acluster)
+  { ; }
+
+
+  template <class TM>
+  SparseCholeskyTM<TM> :: 
+  SparseCholeskyTM (const SparseMatrixTM<TM> & a, 
+                    shared_ptr<SparseCholeskySymbolic> asymbolic,
+                    shared_ptr<BitArray> ainner,
+                    shared_ptr<const Array<int>> acluster)
+    : SparseFactorization (a, ainner, acluster), symbolic(asymbolic),
+      height(symbolic->height), nused(symbolic->nused), nze(symbolic->nze),
+      order(symbolic->order), inv_order(symbolic->inv_order),
+      firstinrow(symbolic->firstinrow), rowindex2(symbolic->rowindex2),
+      firstinrow_ri(symbolic->firstinrow_ri), blocknrs(symbolic->blocknrs),
+      blocks(symbolic->blocks), block_dependency(symbolic->block_dependency),
+      microtasks(symbolic->microtasks), micro_dependency(symbolic->micro_dependency),
+      micro_dependency_trans(symbolic->micro_dependency_trans),
+      micro_levels(symbolic->micro_levels),
+      maxrow(symbolic->maxrow), mat(a)
+  { 
+    static Timer t("SparseCholesky - total");
+    RegionTimer reg(t);
+
+    if (a.Height() != height)
+      throw Exception (string("SparseCholesky: symbolic factorization has height ") +
+                       ToString(height) + ", matrix has height " + ToString(a.Height()));
+
+    int printstat = 0;
+    clock_t starttime, endtime;
+    starttime = clock();
+
+    if (height > 2000)
+      cout << IM(4) << " " << nze*sizeof(TM)+rowindex2.Size()*sizeof(int) << " Bytes " << flush;
 
     diag.SetSize(nused);
+    float_factor = is_same<TM,double>::value && a.GetInverseType() == SPARSECHOLESKY_MP;
     // lfact.SetSize (nze);
-    lfact = NumaInterleavedArray<TM> (nze);
+    if (a.GetInverseType() == SPARSECHOLESKY_OOC)
+      {
+        lfact_file = make_unique<MappedFileMemory> (nze*sizeof(TM), OutOfCoreDirectory());
+        lfact = Array<TM> (nze, (TM*)lfact_file->Ptr());
+      }
+    else
+      {
+        lfact_mem = NumaInterleavedArray<TM> (nze);
+        lfact = Array<TM> (nze, lfact_mem.Addr(0));
+      }
 
     // lfact = TM(0.0);     // first touch
     ParallelForRange (nze, [&] (IntRange r)
@@ -288,8 +441,7 @@ namespace ngla
   
 
   
-  template <class TM>
-  void SparseCholeskyTM<TM> :: 
+  void SparseCholeskySymbolic :: 
   Allocate (const Array<int> & aorder, 
 	    // const Array<CliqueEl*> & cliques,
 	    const Array<MDOVertex> & vertices,
@@ -325,9 +477,6 @@ namespace ngla
       }
 
     nze = cnt;
-
-    if (n > 2000)
-      cout << IM(4) << " " << cnt*sizeof(TM)+cnt_master*sizeof(int) << " Bytes " << flush;
     //cout << IM(4) <<"(cnt="<<cnt<<", sizeof(TM)="<<sizeof(TM)<< ", cnt_master=" << cnt_master << ", sizeof(int)=" << sizeof(int) <<") " << flush;
 
 
@@ -508,6 +657,27 @@ namespace ngla
       micro_dependency = creator.MoveTable();
       micro_dependency_trans = creator_trans.MoveTable();
     }
+
+    // levels for the level-scheduled substitution,
+    // dependencies always point to micro-tasks with higher number
+    {
+      Array<int> level(microtasks.Size());
+      int nlevels = 0;
+      for (int i : Range(microtasks))
+        {
+          int l = 0;
+          for (int j : micro_dependency_trans[i])
+            l = max2(l, level[j]+1);
+          level[i] = l;
+          nlevels = max2(nlevels, l+1);
+        }
+
+      TableCreator<int> creator(nlevels);
+      for ( ; !creator.Done(); creator++)
+        for (int i : Range(microtasks))
+          creator.Add (level[i], i);
+      micro_levels = creator.MoveTable();
+    }
   }
   
 
@@ -525,6 +695,12 @@ namespace ngla
 	cout << IM(4) << "SparseCholesky::FactorNew called with matrix of different size." << endl;
 	return;
       }
+    if (lfact_float.Size())
+      { // refactor, the double precision factor was released
+        lfact_mem = NumaInterleavedArray<TM> (nze);
+        lfact = Array<TM> (nze, lfact_mem.Addr(0));
+        lfact_float = Array<float>();
+      }
     lfact = TM(0.0);
 
     if (!inner && !cluster)
@@ -567,6 +743,20 @@ namespace ngla
 	}
     tf.Stop();
     FactorSPD(); 
+
+    if constexpr (is_same<TM,double>::value)
+      if (float_factor)
+        {
+          // keep L in single precision only, diag stays double
+          lfact_float.SetSize (nze);
+          ParallelForRange (nze, [&] (IntRange r)
+                            {
+                              for (auto i : r)
+                                lfact_float[i] = lfact[i];
+                            });
+          lfact = Array<TM>();
+          lfact_mem = NumaInterleavedArray<TM>();
+        }
   }
  
 
@@ -1637,9 +1827,76 @@ namespace ngla
 
 
 
+  template <class TM, class TV_ROW, class TV_COL> template <typename TFUNC>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  RunMicroTasks (bool forward, TFUNC func) const
+  {
+    // out-of-core: read ahead the factor for the tasks coming next
+    auto prefetch = [&] (int nr)
+      {
+        auto & task = microtasks[nr];
+        if (task.type != MicroTask::B_BLOCK || task.bblock == 0)
+          PrefetchBlock (task.blocknr);
+      };
+    
+    if (!level_scheduling)
+      {
+        auto & dag = forward ? micro_dependency : micro_dependency_trans;
+        auto & trans_dag = forward ? micro_dependency_trans : micro_dependency;
+        if (!IsOutOfCore())
+          RunParallelDependency (dag, trans_dag, func);
+        else
+          {
+            for (int nr : Range(dag))
+              if (trans_dag[nr].Size() == 0)
+                prefetch (nr);
+            RunParallelDependency (dag, trans_dag, [&] (int nr)
+                                   {
+                                     for (int next : dag[nr])
+                                       prefetch (next);
+                                     func (nr);
+                                   });
+          }
+        return;
+      }
+
+    // all tasks of one level are independent, the backward
+    // substitution runs the levels in reverse order
+    size_t nlevels = micro_levels.Size();
+    for (size_t l : Range(nlevels))
+      {
+        FlatArray<int> tasks = micro_levels[forward ? l : nlevels-1-l];
+        if (IsOutOfCore() && l+1 < nlevels)
+          for (int nr : micro_levels[forward ? l+1 : nlevels-2-l])
+            prefetch (nr);
+        if (tasks.Size() == 1)
+          func (tasks[0]);
+        else
+          ParallelFor (tasks.Size(), [&] (size_t i)
+                       {
+                         func (tasks[i]);
+                       });
+      }
+  }
+
+
   template <class TM, class TV_ROW, class TV_COL>
   void SparseCholesky<TM, TV_ROW, TV_COL> :: 
   SolveReordered (FlatVector<TVX> hy) const
+  {
+    if constexpr (is_same<TM,double>::value && is_same<TVX,double>::value)
+      if (lfact_float.Size())
+        {
+          SolveReorderedT (hy, lfact_float.Addr(0));
+          return;
+        }
+    SolveReorderedT (hy, lfact.Addr(0));
+  }
+
+
+  template <class TM, class TV_ROW, class TV_COL> template <typename TF>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  SolveReorderedT (FlatVector<TVX> hy, TF * plfact) const
   {
     static Timer timer1("SparseCholesky<d,d,d>::MultAdd fac1");
     static Timer timer2("SparseCholesky<d,d,d>::MultAdd fac2");
@@ -1715,7 +1972,7 @@ namespace ngla
     */
     timer1.Start();
 
-    RunParallelDependency (micro_dependency, micro_dependency_trans,
+    RunMicroTasks (true, 
                            [&,hy] (int nr) 
                            {
                              auto task = microtasks[nr];
@@ -1738,7 +1995,7 @@ namespace ngla
                                      size_t size = range.end()-i-1;
                                      if (size > 0)
                                        {
-                                         FlatVector<TM> vlfact(size, &lfact[firstinrow[i]]);
+                                         FlatVector<TF> vlfact(size, plfact+firstinrow[i]);
                                          
                                          auto hyr = hy.Range(i+1, range.end());
                                          for (size_t j = 0; j < size; j++)
@@ -1750,7 +2007,7 @@ namespace ngla
                                          continue;
                                        }
                                      size_t first = firstinrow[i] + range.end()-i-1;
-                                     FlatVector<TM> ext_lfact (extdofs.Size(), &lfact[first]);
+                                     FlatVector<TF> ext_lfact (extdofs.Size(), plfact+first);
                                      for (size_t j = 0; j < temp.Size(); j++)
                                        temp(j) += Trans(ext_lfact(j)) * hyi;
                                    }
@@ -1766,7 +2023,7 @@ namespace ngla
                                    {
                                      size_t size = range.end()-i-1;
                                      if (size == 0) continue;
-                                     FlatVector<TM> vlfact(size, &lfact[firstinrow[i]]);
+                                     FlatVector<TF> vlfact(size, plfact+firstinrow[i]);
 
                                      TVX hyi = hy(i);
                                      auto hyr = hy.Range(i+1, range.end());
@@ -1792,7 +2049,7 @@ namespace ngla
                                        {
                                          size_t first = firstinrow[i] + range.end()-i-1;
                                          
-                                         FlatVector<TM> ext_lfact (all_extdofs.Size(), &lfact[first]);
+                                         FlatVector<TF> ext_lfact (all_extdofs.Size(), plfact+first);
  
                                          TVX hyi = hy(i);
                                          for (size_t j = 0; j < temp.Size(); j++)
@@ -1827,7 +2084,7 @@ namespace ngla
     */
 
     // advanced parallel version 
-    RunParallelDependency (micro_dependency_trans, micro_dependency,
+    RunMicroTasks (false, 
                            [&,hy] (int nr) 
                            {
                              auto task = microtasks[nr];
@@ -1848,7 +2105,7 @@ namespace ngla
                                    for (auto i : range)
                                      {
                                        size_t first = firstinrow[i] + range.end()-i-1;
-                                       FlatVector<TM> ext_lfact (extdofs.Size(), &lfact[first]);
+                                       FlatVector<TF> ext_lfact (extdofs.Size(), plfact+first);
                                        
                                        TVX val(0.0);
                                        for (auto j : Range(extdofs))
@@ -1859,7 +2116,7 @@ namespace ngla
                                    {
                                      size_t size = range.end()-i-1;
                                      if (size == 0) continue;
-                                     FlatVector<TM> vlfact(size, &lfact[firstinrow[i]]);
+                                     FlatVector<TF> vlfact(size, plfact+firstinrow[i]);
                                      auto hyr = hy.Range(i+1, range.end());
 
                                      TVX hyi = hy(i);
@@ -1877,7 +2134,7 @@ namespace ngla
                                    {
                                      size_t size = range.end()-i-1;
                                      if (size == 0) continue;
-                                     FlatVector<TM> vlfact(size, &lfact[firstinrow[i]]);
+                                     FlatVector<TF> vlfact(size, plfact+firstinrow[i]);
                                      auto hyr = hy.Range(i+1, range.end());
 
                                      TVX hyi = hy(i);
@@ -1904,7 +2161,7 @@ namespace ngla
                                      for (auto i : range)
                                        {
                                          size_t first = firstinrow[i] + range.end()-i-1;
-                                         FlatVector<TM> ext_lfact (all_extdofs.Size(), &lfact[first]);
+                                         FlatVector<TF> ext_lfact (all_extdofs.Size(), plfact+first);
     
                                          TVX val(0.0);
                                          for (auto j : Range(extdofs))
@@ -1961,9 +2218,11 @@ namespace ngla
       }
     else if (cluster)
       {
-	for (int i = 0; i < height; i++)
-	  if ((*cluster)[i])
-	    fy(i) += s * hy(order[i]);
+        ParallelFor (Range(height), [&] (int i)
+                     {
+                       if ((*cluster)[i])
+                         fy(i) += s * hy(order[i]);
+                     });
       }
     else
       {
@@ -1981,6 +2240,177 @@ namespace ngla
   
 
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  SolveReorderedMulti (FlatMatrix<double> hy) const
+  {
+    throw Exception ("SparseCholesky::SolveReorderedMulti only for real scalar matrices");
+  }
+
+  template <class TM, class TV_ROW, class TV_COL> template <typename TF>
+  Matrix<double> SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  ExtFactor (IntRange range, size_t next, IntRange myr, TF * plfact) const
+  {
+    // rows of the block in L, the external columns of a row are contiguous
+    Matrix<double> lext(range.Size(), myr.Size());
+    for (auto i : range)
+      {
+        size_t first = firstinrow[i] + range.end()-i-1;
+        FlatVector<TF> ext_lfact (next, plfact+first);
+        for (size_t j = 0; j < myr.Size(); j++)
+          lext(i-range.begin(), j) = ext_lfact(myr.begin()+j);
+      }
+    return lext;
+  }
+
+  template <class TM, class TV_ROW, class TV_COL> template <typename TF>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  SolveReorderedMultiT (FlatMatrix<double> hy, TF * plfact) const
+  {
+    static Timer timer1("SparseCholesky::MultAdd MultiVector fac1");
+    static Timer timer2("SparseCholesky::MultAdd MultiVector fac2");
+    size_t k = hy.Width();
+
+    // same micro-tasks as SolveReordered, every entry of L serves all vectors
+    timer1.Start();
+    RunMicroTasks (true, 
+                           [&,hy] (int nr) 
+                           {
+                             auto task = microtasks[nr];
+                             size_t blocknr = task.blocknr;
+                             auto range = BlockDofs (blocknr);
+                             if (range.Size()==0) return;
+
+                             if (task.type != MicroTask::B_BLOCK)
+                               for (auto i : range)
+                                 {
+                                   size_t size = range.end()-i-1;
+                                   if (size == 0) continue;
+                                   FlatVector<TF> vlfact(size, plfact+firstinrow[i]);
+                                   for (size_t j = 0; j < size; j++)
+                                     hy.Row(i+1+j) -= vlfact(j) * hy.Row(i);
+                                 }
+                             if (task.type == MicroTask::L_BLOCK) return;
+
+                             auto all_extdofs = BlockExtDofs (blocknr);
+                             if (all_extdofs.Size() == 0) return;
+                             auto myr = Range(all_extdofs);
+                             if (task.type == MicroTask::B_BLOCK)
+                               myr = myr.Split (task.bblock, task.nbblocks);
+                             auto extdofs = all_extdofs.Range(myr);
+
+                             // temp = L_ext^T * hy(range), one BLAS-3 product for all vectors
+                             Matrix<> lext = ExtFactor (range, all_extdofs.Size(), myr, plfact);
+                             Matrix<> temp(extdofs.Size(), k);
+                             MultAtB (lext, hy.Rows(range), temp);
+                             for (size_t j : Range(extdofs))
+                               for (size_t l = 0; l < k; l++)
+                                 AtomicAdd (hy(extdofs[j], l), -temp(j,l));
+                           });
+    timer1.Stop();
+
+    ParallelFor (hy.Height(), [&] (size_t i)
+                 {
+                   hy.Row(i) *= diag[i];
+                 });
+
+    timer2.Start();
+    RunMicroTasks (false, 
+                           [&,hy] (int nr) 
+                           {
+                             auto task = microtasks[nr];
+                             size_t blocknr = task.blocknr;
+                             auto range = BlockDofs (blocknr);
+                             if (range.Size()==0) return;
+
+                             auto all_extdofs = BlockExtDofs (blocknr);
+                             if (task.type != MicroTask::L_BLOCK && all_extdofs.Size())
+                               {
+                                 auto myr = Range(all_extdofs);
+                                 if (task.type == MicroTask::B_BLOCK)
+                                   myr = myr.Split (task.bblock, task.nbblocks);
+                                 auto extdofs = all_extdofs.Range(myr);
+                                 
+                                 Matrix<> temp(extdofs.Size(), k);
+                                 for (auto j : Range(extdofs))
+                                   temp.Row(j) = hy.Row(extdofs[j]);
+
+                                 // vals = L_ext * hy(extdofs)
+                                 Matrix<> lext = ExtFactor (range, all_extdofs.Size(), myr, plfact);
+                                 Matrix<> vals(range.Size(), k);
+                                 MultMatMat (lext, temp, vals);
+                                 if (task.type == MicroTask::LB_BLOCK)
+                                   hy.Rows(range) -= vals;
+                                 else
+                                   for (auto i : Range(range))
+                                     for (size_t l = 0; l < k; l++)
+                                       AtomicAdd (hy(range.begin()+i,l), -vals(i,l));
+                               }
+                             if (task.type == MicroTask::B_BLOCK) return;
+                             
+                             for (size_t i = range.end()-1; i-- > range.begin(); )
+                               {
+                                 size_t size = range.end()-i-1;
+                                 if (size == 0) continue;
+                                 FlatVector<TF> vlfact(size, plfact+firstinrow[i]);
+                                 for (size_t j = 0; j < size; j++)
+                                   hy.Row(i) -= vlfact(j) * hy.Row(i+1+j);
+                               }
+                           });
+    timer2.Stop();
+  }
+
+
+  template <>
+  void SparseCholesky<double,double,double> :: 
+  SolveReorderedMulti (FlatMatrix<double> hy) const
+  {
+    if (lfact_float.Size())
+      SolveReorderedMultiT (hy, lfact_float.Addr(0));
+    else
+      SolveReorderedMultiT (hy, lfact.Addr(0));
+  }
+
+
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if constexpr (is_same<TM,double>::value && is_same<TV_ROW,double>::value)
+      {
+        static Timer timer("SparseCholesky::MultAdd MultiVector");
+        RegionTimer reg (timer);
+        size_t k = x.NumVectors();
+        timer.AddFlops (2.0*lfact.Size()*k);
+
+        FlatMatrix<double> fx = x.FM();
+        FlatMatrix<double> fy = y.FM();
+        
+        Matrix<double> hy(this->nused, k);
+        ParallelFor (Range(height), [&] (int i)
+                     {
+                       if (order[i] != -1)
+                         for (size_t l = 0; l < k; l++)
+                           hy(order[i], l) = fx(l, i);
+                     });
+
+        SolveReorderedMulti (hy);
+
+        ParallelFor (Range(height), [&] (int i)
+                     {
+                       bool use = order[i] != -1;
+                       if (inner) use = inner->Test(i);
+                       else if (cluster) use = (*cluster)[i];
+                       if (use)
+                         for (size_t l = 0; l < k; l++)
+                           fy(l, i) += s * hy(order[i], l);
+                     });
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
+  }
+
+
   template <class TM, class TV_ROW, class TV_COL>
   void SparseCholesky<TM, TV_ROW, TV_COL> :: 
   Smooth (BaseVector & u, const BaseVector & f, BaseVector & y) const
@@ -2174,9 +2604,12 @@ namespace ngla
 	ost << i << ": ";
 	for ( ; j < firstinrow[i]; j++, j_ri++)
 	  {
-	    ost << rowindex2[j_ri] << "("
-		<< lfact[j] 
-		<< ")  ";
+	    ost << rowindex2[j_ri] << "(";
+            if (lfact_float.Size())
+              ost << lfact_float[j];
+            else
+              ost << lfact[j];
+            ost << ")  ";
 	  }
 	ost << endl;
       }
@@ -2188,13 +2621,45 @@ namespace ngla
   template <class TM>
   SparseCholeskyTM<TM> :: ~SparseCholeskyTM()
   {
-    delete mdo;
+    ;
   }
 
 
 
 
 
+  void IterativeRefinement :: Mult (const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("IterativeRefinement::Mult"); RegionTimer reg(t);
+    inv -> Mult (x, y);
+
+    auto r = CreateColVector();
+    auto w = CreateRowVector();
+    for (steps = 0; steps < maxsteps; steps++)
+      {
+        r = x;
+        mat.MultAdd (-1.0, y, r);
+        inv -> Mult (r, w);
+        y.Add (1.0, w);
+        if (w.L2Norm() <= tol * y.L2Norm()) break;
+      }
+  }
+
+  void IterativeRefinement :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    auto hy = CreateRowVector();
+    Mult (x, hy);
+    y.Add (s, hy);
+  }
+
+  void IterativeRefinement :: MultAdd (Complex s, const BaseVector & x, BaseVector & y) const
+  {
+    auto hy = CreateRowVector();
+    Mult (x, hy);
+    y.Add (s, hy);
+  }
+
+
   template class SparseCholesky<double>;
   template class SparseCholesky<Complex>;
   template class SparseCholesky<double, Complex, Complex>;
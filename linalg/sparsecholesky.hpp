@@ -48,20 +48,16 @@ namespace ngla
 
 
   /**
-     A sparse cholesky factorization.
-     The unknowns are reordered by the minimum degree
-     ordering algorithm
-
-     computs A = L D L^t
-     L is stored column-wise
+     Ordering and symbolic factorization for the sparse cholesky
+     factorization: elimination order, supernodes, non-zero pattern
+     of L and the micro-task graph.
+     It depends only on the matrix graph (and inner/cluster), so
+     numerical factorizations of matrices with the same pattern can
+     share one symbolic factorization.
   */
-
-  template<class TM>
-	   // class TV_ROW = typename mat_traits<TM>::TV_ROW, 
-	   // class TV_COL = typename mat_traits<TM>::TV_COL>
-  class NGS_DLL_HEADER SparseCholeskyTM : public SparseFactorization
+  class NGS_DLL_HEADER SparseCholeskySymbolic
   {
-  protected:
+  public:
     // height of the matrix
     int height;
     // number of real unknowns
@@ -73,17 +69,9 @@ namespace ngla
     Array<int> order;
     Array<int> inv_order;
     
-    // L-factor in compressed storage
-    // Array<TM, size_t> lfact;
-    NumaInterleavedArray<TM> lfact;
-
     // index-array to lfact
     Array<size_t> firstinrow;
 
-    // diagonal 
-    Array<TM> diag;
-
-
     // row-indices of non-zero entries
     // all row-indices within one block are identic, and stored just once
     Array<int> rowindex2;
@@ -99,7 +87,6 @@ namespace ngla
     // dependency graph for elimination
     Table<int> block_dependency; 
 
-  public:      // needed for gcc 4.9, why  ??? 
     class MicroTask
     {
     public:
@@ -108,20 +95,147 @@ namespace ngla
       BT type;
       int bblock;
       int nbblocks;
+
+      void DoArchive (Archive & ar)
+      {
+        int itype = type;
+        ar & blocknr & itype & bblock & nbblocks;
+        type = BT(itype);
+      }
     };
-  protected:
     
     Array<MicroTask> microtasks;
     Table<int> micro_dependency;     
     Table<int> micro_dependency_trans;     
-
-
-    //
-    MinimumDegreeOrdering * mdo;
+    // micro-tasks sorted by level of micro_dependency,
+    // tasks of one level are independent
+    Table<int> micro_levels;
 
     // maximal non-zero entries in a column
     int maxrow;
 
+    /// ordering, index arrays and task graph, without the factor
+    size_t SymbolicBytes () const
+    {
+      return MemoryBytes (order) + MemoryBytes (inv_order) + MemoryBytes (firstinrow)
+        + MemoryBytes (rowindex2) + MemoryBytes (firstinrow_ri) + MemoryBytes (blocknrs)
+        + MemoryBytes (blocks) + MemoryBytes (block_dependency) + MemoryBytes (microtasks)
+        + MemoryBytes (micro_dependency) + MemoryBytes (micro_dependency_trans)
+        + MemoryBytes (micro_levels);
+    }
+
+    /// minimum degree, or nested dissection for inverse type sparsecholesky_nd
+    SparseCholeskySymbolic (const BaseSparseMatrix & a, 
+                            shared_ptr<BitArray> inner = nullptr,
+                            shared_ptr<const Array<int>> cluster = nullptr);
+    /// empty, filled by DoArchive
+    SparseCholeskySymbolic () = default;
+
+    /// ordering, index arrays and task graph, for the setup cache files
+    void DoArchive (Archive & ar);
+
+    // the dofs of block bnr
+    IntRange BlockDofs (int bnr) const { return Range(blocks[bnr], blocks[bnr+1]); }
+
+    // the external dofs of block bnr
+    FlatArray<int> BlockExtDofs (int bnr) const
+    {
+      auto range = BlockDofs (bnr);
+      auto base = firstinrow_ri[range.First()] + range.Size()-1;
+      auto ext_size =  firstinrow[range.First()+1]-firstinrow[range.First()] - range.Size()+1;
+      return rowindex2.Range(base, base+ext_size);
+    }
+
+  private:
+    void Allocate (const Array<int> & aorder, 
+		   const Array<MDOVertex> & vertices,
+		   const int * blocknr);
+  };
+
+
+
+  /**
+     Memory in a shared mapping of an (unlinked) temporary file.
+     Used for the out-of-core factorization: the operating system 
+     writes pages back to the file instead of keeping the whole 
+     factor in RAM.
+  */
+  class NGS_DLL_HEADER MappedFileMemory
+  {
+    void * ptr = nullptr;
+    size_t size = 0;
+  public:
+    /// creates the file in directory dir
+    MappedFileMemory (size_t asize, string dir);
+    ~MappedFileMemory ();
+    void * Ptr () const { return ptr; }
+    size_t Size () const { return size; }
+    /// asynchronous read-ahead of the given range
+    void Prefetch (const void * first, size_t bytes) const;
+  };
+
+  /// directory for out-of-core factors: $NGS_OOC_DIR, $TMPDIR, or /tmp
+  NGS_DLL_HEADER string OutOfCoreDirectory ();
+
+
+  /**
+     A sparse cholesky factorization.
+     The unknowns are reordered by the minimum degree
+     ordering algorithm
+
+     computs A = L D L^t
+     L is stored column-wise
+  */
+
+  template<class TM>
+	   // class TV_ROW = typename mat_traits<TM>::TV_ROW, 
+	   // class TV_COL = typename mat_traits<TM>::TV_COL>
+  class NGS_DLL_HEADER SparseCholeskyTM : public SparseFactorization
+  {
+  protected:
+    // ordering and symbolic factorization, maybe shared with other factorizations
+    shared_ptr<SparseCholeskySymbolic> symbolic;
+
+    // the symbolic data, as references into symbolic
+    int & height;
+    int & nused;
+    size_t & nze;
+
+    Array<int> & order;
+    Array<int> & inv_order;
+    Array<size_t> & firstinrow;
+    Array<int> & rowindex2;
+    Array<size_t> & firstinrow_ri;
+    Array<int> & blocknrs;
+    Array<int> & blocks; 
+    Table<int> & block_dependency; 
+
+  public:      // needed for gcc 4.9, why  ??? 
+    typedef SparseCholeskySymbolic::MicroTask MicroTask;
+  protected:
+    
+    Array<MicroTask> & microtasks;
+    Table<int> & micro_dependency;     
+    Table<int> & micro_dependency_trans;     
+    Table<int> & micro_levels;
+
+    int & maxrow;
+
+    // memory for the L-factor, in RAM or in a mapped file
+    NumaInterleavedArray<TM> lfact_mem;
+    unique_ptr<MappedFileMemory> lfact_file;
+
+    // L-factor in compressed storage
+    // Array<TM, size_t> lfact;
+    Array<TM> lfact;
+    // L-factor rounded to single precision, replaces lfact
+    // (inverse type sparsecholesky_mp, real scalar matrices)
+    Array<float> lfact_float;
+    bool float_factor = false;
+
+    // diagonal 
+    Array<TM> diag;
+
     // the original matrix
     const SparseMatrixTM<TM> & mat;
 
@@ -133,16 +247,23 @@ namespace ngla
                                      shared_ptr<BitArray> ainner = nullptr,
                                      shared_ptr<const Array<int>> acluster = nullptr,
                                      bool allow_refactor = 0);
+    /**
+       Numerical factorization only, the ordering and symbolic factorization 
+       is taken from asymbolic. a must have the pattern asymbolic was computed
+       for, inner and cluster must be the same.
+    */
+    SparseCholeskyTM (const SparseMatrixTM<TM> & a, 
+                      shared_ptr<SparseCholeskySymbolic> asymbolic,
+                      shared_ptr<BitArray> ainner = nullptr,
+                      shared_ptr<const Array<int>> acluster = nullptr);
     ///
     virtual ~SparseCholeskyTM ();
     ///
     int VHeight() const { return height; }
     ///
     int VWidth() const { return height; }
-    ///
-    void Allocate (const Array<int> & aorder, 
-		   const Array<MDOVertex> & vertices,
-		   const int * blocknr);
+    /// the ordering and symbolic factorization, to be reused for matrices of the same pattern
+    shared_ptr<SparseCholeskySymbolic> GetSymbolic () const { return symbolic; }
     ///
     void Factor (); 
 #ifdef LAPACK
@@ -174,7 +295,31 @@ namespace ngla
 
     virtual Array<MemoryUsage> GetMemoryUsage () const
     {
-      return { MemoryUsage ("SparseChol", nze*sizeof(TM), 1) };
+      Array<MemoryUsage> mu;
+      if (lfact_float.Size())
+        mu += { "SparseChol/factor (float)", nze*sizeof(float), 1 };
+      else if (lfact_file)
+        mu += { "SparseChol/factor (file)", nze*sizeof(TM), 1 };
+      else
+        mu += { "SparseChol/factor", nze*sizeof(TM), 1 };
+      mu += { "SparseChol/diagonal", diag.Size()*sizeof(TM), 1 };
+      if (symbolic)
+        mu += { "SparseChol/symbolic", symbolic->SymbolicBytes(), 1 };
+      return mu;
+    }
+
+    /// factor is stored in a file
+    bool IsOutOfCore () const { return lfact_file != nullptr; }
+
+    /// read-ahead the columns of block bnr of an out-of-core factor
+    void PrefetchBlock (int bnr) const
+    {
+      if (!lfact_file) return;
+      auto range = BlockDofs (bnr);
+      if (range.Size() == 0) return;
+      size_t first = firstinrow[range.First()];
+      size_t next = firstinrow[range.Next()];
+      lfact_file->Prefetch (lfact.Addr(first), (next-first)*sizeof(TM));
     }
 
     virtual size_t NZE () const { return nze; }
@@ -216,6 +361,7 @@ namespace ngla
     using BASE::cluster;
 
     using BASE::lfact;
+    using BASE::lfact_float;
     using BASE::diag;
     using BASE::order;
     using BASE::inv_order;
@@ -226,9 +372,12 @@ namespace ngla
     using BASE::microtasks;
     using BASE::micro_dependency;
     using BASE::micro_dependency_trans;
+    using BASE::micro_levels;
     using BASE::block_dependency;
     using BASE::BlockDofs;
     using BASE::BlockExtDofs;
+    using BASE::PrefetchBlock;
+    using BASE::IsOutOfCore;
   public:
     typedef TV_COL TV;
     typedef TV_ROW TVX;
@@ -241,6 +390,19 @@ namespace ngla
 		    bool allow_refactor = 0)
       : SparseCholeskyTM<TM> (a, ainner, acluster, allow_refactor) { ; }
 
+    /// numerical factorization with given symbolic factorization
+    SparseCholesky (const SparseMatrixTM<TM> & a, 
+                    shared_ptr<SparseCholeskySymbolic> asymbolic,
+		    shared_ptr<BitArray> ainner = nullptr,
+		    shared_ptr<const Array<int>> acluster = nullptr)
+      : SparseCholeskyTM<TM> (a, asymbolic, ainner, acluster) { ; }
+
+    /// factorization of a matrix with the same pattern, skips the ordering
+    shared_ptr<SparseCholesky> FactorSamePattern (const SparseMatrixTM<TM> & a) const
+    {
+      return make_shared<SparseCholesky> (a, this->symbolic, inner, cluster);
+    }
+
     ///
     virtual ~SparseCholesky () { ; }
     
@@ -251,6 +413,8 @@ namespace ngla
     {
       MultAdd (s, x, y);
     }
+    /// forward/backward substitution for all vectors at once (real scalar case)
+    void MultAdd (double s, const MultiVector & x, MultiVector & y) const override;
 
     AutoVector CreateRowVector () const override { return make_shared<VVector<TV>> (height); }
     AutoVector CreateColVector () const override { return make_shared<VVector<TV>> (height); }
@@ -259,11 +423,77 @@ namespace ngla
 
     void SolveBlock (int i, FlatVector<TV> hy) const;
     void SolveBlockT (int i, FlatVector<TV> hy) const;
+
+    /**
+       forward/backward substitution level by level of the micro-task
+       graph (a parallel loop per level) instead of the dynamic
+       dependency queue. Less overhead per task, better for many
+       repeated solves with small supernodes.
+    */
+    void SetLevelScheduling (bool ls = true) { level_scheduling = ls; }
+    bool GetLevelScheduling () const { return level_scheduling; }
   private:
+    bool level_scheduling = false;
+
+    /// forward: micro-tasks in dependency order, backward: reverse order
+    template <typename TFUNC>
+    void RunMicroTasks (bool forward, TFUNC func) const;
+
     void SolveReordered(FlatVector<TVX> hy) const;
+    /// hy is nused x k, row i holds dof i of all vectors
+    void SolveReorderedMulti (FlatMatrix<double> hy) const;
+    /// the substitutions with factor entries of type TF (TM or float)
+    template <typename TF>
+    void SolveReorderedT (FlatVector<TVX> hy, TF * plfact) const;
+    template <typename TF>
+    void SolveReorderedMultiT (FlatMatrix<double> hy, TF * plfact) const;
+    /// columns myr of the external part of block rows range of L, as a dense matrix
+    template <typename TF>
+    Matrix<double> ExtFactor (IntRange range, size_t next, IntRange myr, TF * plfact) const;
   };
 
 
+
+  /**
+     Iterative refinement with an approximate inverse:
+       x += inv (b - A x)
+     until the correction is below tol*|x|.
+     Used for the mixed-precision factorization (inverse type
+     sparsecholesky_mp), the factor is stored in single precision.
+  */
+  class NGS_DLL_HEADER IterativeRefinement : public BaseMatrix
+  {
+    const BaseMatrix & mat;
+    shared_ptr<BaseMatrix> inv;
+    int maxsteps;
+    double tol;
+    mutable int steps = 0;
+  public:
+    IterativeRefinement (const BaseMatrix & amat, shared_ptr<BaseMatrix> ainv,
+                         int amaxsteps = 10, double atol = 1e-14)
+      : mat(amat), inv(ainv), maxsteps(amaxsteps), tol(atol) { ; }
+
+    bool IsComplex() const override { return inv->IsComplex(); }
+    int VHeight() const override { return inv->Height(); }
+    int VWidth() const override { return inv->Width(); }
+    AutoVector CreateRowVector () const override { return inv->CreateRowVector(); }
+    AutoVector CreateColVector () const override { return inv->CreateColVector(); }
+
+    void Mult (const BaseVector & x, BaseVector & y) const override;
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    void MultAdd (Complex s, const BaseVector & x, BaseVector & y) const override;
+    void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override
+    { MultAdd (s, x, y); }
+
+    void Update () override { inv->Update(); }
+
+    shared_ptr<BaseMatrix> GetInverse () const { return inv; }
+    /// refinement steps of the last application
+    int GetSteps () const { return steps; }
+  };
+
+
+
 }
 
 #endif
@@ -62,16 +62,15 @@ namespace ngla
       colnr[i] = -1;
     */
     
-    FlatArray<int> hcolnr = colnr;
-    ParallelForRange (nze,
-		      [hcolnr] (auto myrange)
-		      {
-			hcolnr.Range(myrange) = -1;
-		      });
-
     colnr[nze] = 0;
 
+    // first touch memory (numa!) with the rows of the matrix-vector product
     CalcBalancing ();
+    ParallelForRows ([&] (auto rows)
+                     {
+                       if (rows.Size())
+                         colnr.Range(firsti[rows.First()], firsti[rows.Next()]) = -1;
+                     });
   }
                                                                                                                                                                                                                   
   MatrixGraph :: MatrixGraph (int as, int max_elsperrow) 
@@ -118,11 +117,15 @@ namespace ngla
         
 	for (int i = 0; i < size+1; i++)
 	  firsti[i] = graph.firsti[i];
-	for (size_t i = 0; i < nze; i++)
-	  colnr[i] = graph.colnr[i];
       }
     // inversetype = agraph.GetInverseType();
     CalcBalancing ();
+    if (!stealgraph)
+      ParallelForRows ([&] (auto rows)
+                       {
+                         for (size_t i = firsti[rows.First()]; i < firsti[rows.Next()]; i++)
+                           colnr[i] = graph.colnr[i];
+                       });
   }
 
   MatrixGraph :: MatrixGraph (MatrixGraph && graph)
@@ -884,10 +887,11 @@ namespace ngla
 	    CalcBalancing ();
 
             // first touch memory (numa!)
-            ParallelFor (balance, [&](int row) 
-                         {
-                           colnr.Range(firsti[row], firsti[row+1]) = 0;
-                         });
+            ParallelForRows ([&] (auto rows)
+                             {
+                               if (rows.Size())
+                                 colnr.Range(firsti[rows.First()], firsti[rows.Next()]) = 0;
+                             });
           }
         else
           {
@@ -1100,6 +1104,7 @@ namespace ngla
 	if (colnr[k] == -1)
 	  {
 	    colnr[k] = j;
+            transposed = nullptr;
 	    return k;
 	  }
 	
@@ -1114,6 +1119,7 @@ namespace ngla
 	      colnr[l] = colnr[l-1];
 
 	    colnr[k] = j;
+            transposed = nullptr;
 	    return k;
 	  }
       }
@@ -1204,6 +1210,60 @@ namespace ngla
     balance.Calc (size, [&] (int row) { return 1 + GetRowIndices(row).Size(); });
   }
   
+  const MatrixGraph::TransposedGraph * MatrixGraph :: GetTransposedGraph () const
+  {
+    static mutex build_mutex;
+    lock_guard<mutex> guard(build_mutex);
+    if (transposed) return transposed.get();
+    // a single product with the transpose does not pay for the setup
+    if (++transposed_requests < 2) return nullptr;
+
+    static Timer timer ("MatrixGraph - GetTransposedGraph");
+    RegionTimer reg (timer);
+
+    auto tg = make_shared<TransposedGraph>();
+    Array<size_t> cnt(width);
+    cnt = 0;
+    ParallelFor (size, [&] (size_t i)
+                 {
+                   for (int c : GetRowIndices(i))
+                     if (c >= 0) AsAtomic(cnt[c])++;
+                 });
+
+    tg->firsti.SetSize (width+1);
+    size_t sum = 0;
+    for (int c = 0; c < width; c++)
+      {
+        tg->firsti[c] = sum;
+        sum += cnt[c];
+      }
+    tg->firsti[width] = sum;
+
+    tg->pos.SetSize (sum);
+    tg->rownr.SetSize (sum);
+    cnt = 0;
+    ParallelFor (size, [&] (size_t i)
+                 {
+                   for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+                     if (int c = colnr[j]; c >= 0)
+                       tg->pos[tg->firsti[c] + AsAtomic(cnt[c])++] = j;
+                 });
+
+    // positions increase with the rows, sorted the products are deterministic
+    ParallelFor (width, [&] (size_t c)
+                 {
+                   auto cpos = tg->pos.Range (tg->firsti[c], tg->firsti[c+1]);
+                   QuickSort (cpos);
+                   for (size_t k = tg->firsti[c]; k < tg->firsti[c+1]; k++)
+                     tg->rownr[k] = std::upper_bound (firsti.Data(), firsti.Data()+firsti.Size(),
+                                                      tg->pos[k]) - firsti.Data() - 1;
+                 });
+    tg->balance.Calc (width, [&] (int c) { return 1 + tg->firsti[c+1]-tg->firsti[c]; });
+
+    transposed = tg;
+    return transposed.get();
+  }
+
   void MatrixGraph :: FindSameNZE()
   {
     return;
@@ -1241,7 +1301,7 @@ namespace ngla
 
   Array<MemoryUsage> MatrixGraph :: GetMemoryUsage () const
   {
-    return { { "MatrixGraph", (nze+size)*sizeof(int), 1 } };
+    return { { "MatrixGraph", nze*sizeof(int) + (size+1)*sizeof(size_t), 1 } };
   }
 
 
@@ -1268,15 +1328,68 @@ namespace ngla
     else if (ainversetype == "superlu_dist")  SetInverseType ( SUPERLU_DIST );
     else if (ainversetype == "mumps")         SetInverseType ( MUMPS );
     else if (ainversetype == "masterinverse") SetInverseType ( MASTERINVERSE );
+    else if (ainversetype == "redundantinverse") SetInverseType ( REDUNDANTINVERSE );
     else if (ainversetype == "sparsecholesky") SetInverseType ( SPARSECHOLESKY );
     else if (ainversetype == "umfpack")       SetInverseType ( UMFPACK );
+    else if (ainversetype == "sparsecholesky_nd") SetInverseType ( SPARSECHOLESKY_ND );
+    else if (ainversetype == "sparsecholesky_ooc") SetInverseType ( SPARSECHOLESKY_OOC );
+    else if (ainversetype == "sparsecholesky_mp") SetInverseType ( SPARSECHOLESKY_MP );
+    else if (ainversetype == "auto")          SetInverseType ( AUTOINVERSE );
     else
       {
         throw Exception (ToString("undefined inverse ")+ainversetype+
-                         "\nallowed is: 'sparsecholesky', 'pardiso', 'pardisospd', 'mumps', 'masterinverse', 'umfpack'");
+                         "\nallowed is: 'auto', 'sparsecholesky', 'sparsecholesky_nd', 'sparsecholesky_ooc', 'sparsecholesky_mp', 'pardiso', 'pardisospd', 'mumps', 'masterinverse', 'redundantinverse', 'umfpack'");
       }
     return old_invtype;
   }
+
+  INVERSETYPE BaseSparseMatrix ::
+  ChooseInverseType (shared_ptr<BitArray> subset, bool symmetric) const
+  {
+    size_t n = subset ? subset->NumSet() : Height();
+    // symmetric matrices store the lower triangle only
+    double nze_per_row = Height() ? double(NZE()) / Height() : 0;
+    if (symmetric) nze_per_row = 2*nze_per_row-1;
+
+    // estimated flops of the factorization with a fill-reducing ordering:
+    // separators of size n^(2/3) for 3D-like coupling, n^(1/2) for 2D-like
+    bool threed = nze_per_row > 20;
+    double flops = threed ? double(n)*n : pow(double(n), 1.5);
+    // the setup of the external solvers dominates small factorizations
+    bool small = flops < 1e8;
+    int nthreads = TaskManager::GetNumThreads();
+
+    INVERSETYPE type = SPARSECHOLESKY;
+    if (symmetric)
+      {
+        if (small)
+          type = SPARSECHOLESKY;
+        else if (is_pardiso_available)
+          type = IsSPD() ? PARDISOSPD : PARDISO;
+        else if (threed || nthreads > 1)
+          // less fill-in, and independent subtrees for the threads
+          type = SPARSECHOLESKY_ND;
+      }
+    else
+      {
+        // non-symmetric storage needs an LU factorization
+#ifdef USE_UMFPACK
+        if (small || !is_pardiso_available)
+          type = UMFPACK;
+        else
+#endif
+        if (is_pardiso_available)
+          type = PARDISO;
+#ifdef USE_MUMPS
+        else
+          type = MUMPS;
+#endif
+      }
+
+    cout << IM(3) << "inverse 'auto': " << GetInverseName(type) << " for " << n << " dofs, "
+         << nze_per_row << " nze per row, " << nthreads << " threads" << endl;
+    return type;
+  }
 }
 
 
@@ -1531,6 +1644,164 @@ namespace ngla
     return MatMult<double, double, double>(mata, matb);
   }
 
+
+
+  SparseRAP :: SparseRAP (shared_ptr<SparseMatrixTM<double>> ar,
+                          const SparseMatrixTM<double> & a,
+                          shared_ptr<SparseMatrixTM<double>> ap)
+    : r(ar), p(ap)
+  {
+    static Timer t ("sparse RAP - symbolic");
+    RegionTimer reg(t);
+
+    if (r->Width() != a.Height() || a.Width() != p->Height())
+      throw Exception ("SparseRAP: matrix dimensions do not match");
+    
+    height_a = a.Height();
+    nze_a = a.NZE();
+
+    // graph of row i is the union of P-rows k for all k in A-rows j, j in R-row i
+    auto FindCols = [&] (size_t i, Array<int> & acols, Array<int*> & ptrs,
+                         Array<int> & sizes, auto func)
+      {
+        auto r_ci = r->GetRowIndices(i);
+        ptrs.SetSize(r_ci.Size());
+        sizes.SetSize(r_ci.Size());
+        for (int j : Range(r_ci))
+          {
+            ptrs[j] = a.GetRowIndices(r_ci[j]).Addr(0);
+            sizes[j] = a.GetRowIndices(r_ci[j]).Size();
+          }
+        acols.SetSize0();
+        MergeArrays(ptrs, sizes, [&acols] (int col) { acols.Append(col); } );
+
+        ptrs.SetSize(acols.Size());
+        sizes.SetSize(acols.Size());
+        for (int j : Range(acols))
+          {
+            ptrs[j] = p->GetRowIndices(acols[j]).Addr(0);
+            sizes[j] = p->GetRowIndices(acols[j]).Size();
+          }
+        MergeArrays(ptrs, sizes, func);
+      };
+    
+    Array<int> cnt(r->Height());
+    ParallelForRange
+      (r->Height(), [&] (IntRange range)
+       {
+         Array<int> acols;
+         Array<int*> ptrs;
+         Array<int> sizes;
+         for (auto i : range)
+           {
+             int cnti = 0;
+             FindCols (i, acols, ptrs, sizes, [&cnti] (int col) { cnti++; });
+             cnt[i] = cnti;
+           }
+       },
+       TasksPerThread(10));
+
+    prod = make_shared<SparseMatrix<double>>(cnt, p->Width());
+
+    ParallelForRange
+      (r->Height(), [&] (IntRange range)
+       {
+         Array<int> acols;
+         Array<int*> ptrs;
+         Array<int> sizes;
+         for (auto i : range)
+           {
+             int * ptr = prod->GetRowIndices(i).Addr(0);
+             FindCols (i, acols, ptrs, sizes, [&ptr] (int col) { *ptr = col; ptr++; });
+           }
+       },
+       TasksPerThread(10));
+
+    Update (a);
+  }
+
+
+  void SparseRAP :: Update (const SparseMatrixTM<double> & a)
+  {
+    static Timer t ("sparse RAP - numeric");
+    RegionTimer reg(t);
+
+    if (a.Height() != height_a || a.NZE() != nze_a)
+      throw Exception ("SparseRAP::Update: matrix graph has changed");
+
+    ParallelForRange
+      (r->Height(), [&] (IntRange range)
+       {
+         // open addressing, col -> position in row
+         struct thash { int idx; int pos; };
+         
+         size_t maxci = 0;
+         for (auto i : range)
+           maxci = max2(maxci, size_t (prod->GetRowIndices(i).Size()));
+         size_t nhash = 256;
+         while (nhash < 2*maxci) nhash *= 2;
+         ArrayMem<thash,256> hash(nhash);
+         size_t nhashm1 = nhash-1;
+         for (auto & h : hash) h.idx = -1;
+         Array<size_t> used;
+
+         for (auto i : range)
+           {
+             auto c_ci = prod->GetRowIndices(i);
+             auto c_vals = prod->GetRowValues(i);
+             c_vals = 0.0;
+             
+             for (size_t hv : used) hash[hv].idx = -1;
+             used.SetSize0();
+             for (int k : Range(c_ci))
+               {
+                 size_t hv = size_t(c_ci[k]) & nhashm1;
+                 while (hash[hv].idx != -1) hv = (hv+1) & nhashm1;
+                 hash[hv].idx = c_ci[k];
+                 hash[hv].pos = k;
+                 used.Append(hv);
+               }
+
+             auto r_ci = r->GetRowIndices(i);
+             auto r_vals = r->GetRowValues(i);
+             for (int j : Range(r_ci))
+               {
+                 int rowa = r_ci[j];
+                 auto a_ci = a.GetRowIndices(rowa);
+                 auto a_vals = a.GetRowValues(rowa);
+                 for (int k : Range(a_ci))
+                   {
+                     double ra = r_vals[j] * a_vals[k];
+                     int rowp = a_ci[k];
+                     auto p_ci = p->GetRowIndices(rowp);
+                     auto p_vals = p->GetRowValues(rowp);
+                     for (int l : Range(p_ci))
+                       {
+                         size_t hv = size_t(p_ci[l]) & nhashm1;
+                         while (hash[hv].idx != p_ci[l]) hv = (hv+1) & nhashm1;
+                         c_vals[hash[hv].pos] += ra * p_vals[l];
+                       }
+                   }
+               }
+           }
+       },
+       TasksPerThread(10));
+  }
+
+  
+  shared_ptr<SparseMatrixTM<double>> RAP (const SparseMatrixTM<double> & r,
+                                          const SparseMatrixTM<double> & a,
+                                          const SparseMatrixTM<double> & p)
+  {
+    static Timer t ("sparse RAP");
+    RegionTimer reg(t);
+    // non-owning, the matrices only have to live during the call
+    SparseRAP rap (shared_ptr<SparseMatrixTM<double>> (const_cast<SparseMatrixTM<double>*>(&r), NOOP_Deleter),
+                   a,
+                   shared_ptr<SparseMatrixTM<double>> (const_cast<SparseMatrixTM<double>*>(&p), NOOP_Deleter));
+    return rap.GetMatrix();
+  }
+
   template <class TM, class TV>
   shared_ptr<BaseSparseMatrix>
   SparseMatrixSymmetric<TM,TV> :: Restrict (const SparseMatrixTM<double> & prol,
@@ -1676,10 +1947,7 @@ namespace ngla
     RegionTimer reg(t);
 
     auto prolT = TransposeMatrix(prol);
-
-    auto prod1 = MatMult<double, double, double>(*this, prol);
-    auto prod = MatMult<double, double, double>(*prolT, *prod1);
-    return prod;
+    return RAP (*prolT, *this, prol);
   }
 
   template <> shared_ptr<BaseSparseMatrix>
@@ -1700,6 +1968,79 @@ namespace ngla
 
 
 
+  bool SameGraphSparseMatrices (FlatArray<const BaseMatrix*> mats)
+  {
+    if (mats.Size() < 2) return false;
+    for (auto m : mats)
+      if (typeid(*m) != typeid(SparseMatrix<double>))
+        return false;
+
+    auto & mat0 = static_cast<const SparseMatrix<double>&> (*mats[0]);
+    FlatArray<size_t> first0 = mat0.GetFirstArray();
+    for (auto m : mats.Range(1, mats.Size()))
+      {
+        auto & mat = static_cast<const SparseMatrix<double>&> (*m);
+        if (mat.Height() != mat0.Height() || mat.Width() != mat0.Width() ||
+            mat.NZE() != mat0.NZE())
+          return false;
+        if (mat0.Height() == 0) continue;
+        FlatArray<size_t> first = mat.GetFirstArray();
+        const int * col0 = mat0.GetRowIndices(0).Data();
+        const int * col = mat.GetRowIndices(0).Data();
+        // matrices assembled on the same graph have equal, but separate arrays
+        if (first.Data() != first0.Data() &&
+            memcmp (first.Data(), first0.Data(), first0.Size()*sizeof(size_t)) != 0)
+          return false;
+        if (col != col0 &&
+            memcmp (col, col0, mat0.NZE()*sizeof(int)) != 0)
+          return false;
+      }
+    return true;
+  }
+
+  void SameGraphSparseMultAdd (FlatArray<const BaseMatrix*> mats, FlatArray<double> coefs,
+                               double s, const BaseVector & x, BaseVector & y, bool add)
+  {
+    static Timer t("SparseMatrix sum - MultAdd one pass"); RegionTimer reg(t);
+    auto & mat0 = static_cast<const SparseMatrix<double>&> (*mats[0]);
+    size_t h = mat0.Height();
+    if (h == 0) return;
+
+    size_t nmats = mats.Size();
+    FlatArray<size_t> first = mat0.GetFirstArray();
+    const int * colnr = mat0.GetRowIndices(0).Data();
+    Array<const double*> vals(nmats);
+    for (size_t k = 0; k < nmats; k++)
+      vals[k] = static_cast<const SparseMatrix<double>&> (*mats[k]).GetRowValues(0).Data();
+
+    FlatVector<double> fx = x.FVDouble();
+    FlatVector<double> fy = y.FVDouble();
+
+    // the combined matrix entries are formed on the fly, the graph and x
+    // are read once instead of once per term
+    ParallelForRange (h, [&] (IntRange myrange)
+      {
+        for (size_t row : myrange)
+          {
+            double sum = 0;
+            for (size_t j = first[row]; j < first[row+1]; j++)
+              {
+                double val = 0;
+                for (size_t k = 0; k < nmats; k++)
+                  val += coefs[k] * vals[k][j];
+                sum += val * fx(colnr[j]);
+              }
+            if (add)
+              fy(row) += s * sum;
+            else
+              fy(row) = s * sum;
+          }
+      });
+    t.AddFlops (nmats * mat0.NZE());
+  }
+
+
+
   template <> shared_ptr<BaseSparseMatrix>
   SparseMatrixSymmetric<double,double> :: Restrict (const SparseMatrixTM<double> & prol,
                                                     shared_ptr<BaseSparseMatrix> acmat ) const
@@ -1710,8 +2051,7 @@ namespace ngla
     auto prolT = TransposeMatrix(prol);
     auto full = MakeFullMatrix(*this);
 
-    auto prod1 = MatMult<double, double, double>(*full, prol);
-    auto prod = MatMult<double, double, double>(*prolT, *prod1);
+    auto prod = RAP (*prolT, *full, prol);
 
     auto prodhalf = GetSymmetricMatrix (*prod);
     return prodhalf;
@@ -1877,6 +2217,12 @@ namespace ngla
   template <class TM, class TV>
   shared_ptr<BaseMatrix> SparseMatrixSymmetric<TM,TV> :: InverseMatrix (shared_ptr<BitArray> subset) const
   {
+    if ( this->GetInverseType() == AUTOINVERSE )
+      {
+        AutoInverseType autotype(*this, subset, true);
+        return InverseMatrix (subset);
+      }
+
     if ( this->GetInverseType() == SUPERLU_DIST )
       throw Exception ("SparseMatrix::InverseMatrix:  SuperLU_DIST_Inverse not available");
 
@@ -1911,6 +2257,12 @@ namespace ngla
 	throw Exception ("SparseMatrix::InverseMatrix:  MumpsInverse not available");
 #endif
       }
+    else if (  BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_MP)
+      return make_shared<IterativeRefinement>
+        (*this, make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset));
+    else if (SetupCacheDirectory().length())
+      return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>>
+        (*this, CachedSparseCholeskySymbolic (*this, subset, SetupCacheDirectory()), subset);
     else
       return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset);
   }
@@ -1918,6 +2270,12 @@ namespace ngla
   template <class TM, class TV>
   shared_ptr<BaseMatrix> SparseMatrixSymmetric<TM,TV> :: InverseMatrix (shared_ptr<const Array<int>> clusters) const
   {
+    if ( this->GetInverseType() == AUTOINVERSE )
+      {
+        AutoInverseType autotype(*this, nullptr, true);
+        return InverseMatrix (clusters);
+      }
+
     if ( this->GetInverseType() == SUPERLU_DIST )
       throw Exception ("SparseMatrix::InverseMatrix:  SuperLU_DIST_Inverse not available");
 
@@ -1952,6 +2310,9 @@ namespace ngla
 	throw Exception ("SparseMatrix::InverseMatrix:  MumpsInverse not available");
 #endif
       }
+    else if (  BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_MP)
+      return make_shared<IterativeRefinement>
+        (*this, make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters));
     else
       return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters);
   }
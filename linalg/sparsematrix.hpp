@@ -99,6 +99,24 @@ namespace ngla
     /// owner of arrays ?
     bool owner;
 
+  public:
+    /// the graph sorted by columns, for products with the transpose
+    struct TransposedGraph
+    {
+      /// first entry of every column
+      Array<size_t> firsti;
+      /// row of the entry, increasing within a column
+      Array<int> rownr;
+      /// position of the entry in the row-wise storage, the values are not copied
+      Array<size_t> pos;
+      /// balancing of the columns for multi-threading
+      Partitioning balance;
+    };
+
+  protected:
+    mutable shared_ptr<TransposedGraph> transposed;
+    mutable int transposed_requests = 0;
+
   public:
     /// arbitrary number of els/row
     MatrixGraph (const Array<int> & elsperrow, int awidth);
@@ -147,6 +165,31 @@ namespace ngla
     void CalcBalancing ();
     const Partitioning & GetBalancing() const { return balance; } 
 
+    /// the transposed graph, built in parallel at the second request, before nullptr.
+    /// it is cleared when CreatePosition changes the graph
+    const TransposedGraph * GetTransposedGraph () const;
+
+    /// calls func(rows) with the row ranges and task mapping of the matrix-vector product.
+    /// memory first touched in these ranges lives on the numa node of the thread using it
+    template <typename FUNC>
+    void ParallelForRows (FUNC func) const
+    {
+      if (!task_manager || balance.Size() == 0)
+        {
+          func (T_Range<size_t> (0, size));
+          return;
+        }
+      
+      task_manager -> CreateJob 
+        ([&] (TaskInfo & ti) 
+         {
+           int tasks_per_part = ti.ntasks / balance.Size();
+           int mypart = ti.task_nr / tasks_per_part;
+           int num_in_part = ti.task_nr % tasks_per_part;
+           func (balance[mypart].Split (num_in_part, tasks_per_part));
+         });
+    }
+
     ostream & Print (ostream & ost) const;
 
     virtual Array<MemoryUsage> GetMemoryUsage () const;    
@@ -241,6 +284,18 @@ namespace ngla
       throw Exception ("BaseSparseMatrix::Restrict");
     }
 
+    /// the rows and columns of the set bits, numbered in their order
+    virtual shared_ptr<BaseSparseMatrix> CreateSubMatrix (const BitArray & rowscols) const
+    {
+      throw Exception ("BaseSparseMatrix::CreateSubMatrix");
+    }
+
+    /// a copy without the entries of norm up to tol, the diagonal is kept
+    virtual shared_ptr<BaseSparseMatrix> DeleteZeroElements (double tol) const
+    {
+      throw Exception ("BaseSparseMatrix::DeleteZeroElements");
+    }
+
     virtual INVERSETYPE SetInverseType ( INVERSETYPE ainversetype ) const override
     {
 
@@ -251,6 +306,9 @@ namespace ngla
 
     virtual INVERSETYPE SetInverseType ( string ainversetype ) const override;
 
+    /// the solver for inverse "auto", from size, pattern and symmetry of the matrix and the available libraries
+    INVERSETYPE ChooseInverseType (shared_ptr<BitArray> subset, bool symmetric) const;
+
     virtual INVERSETYPE  GetInverseType () const override
     { return inversetype; }
 
@@ -259,6 +317,18 @@ namespace ngla
     virtual size_t NZE () const override { return nze; }
   };
 
+
+  /// inverse type "auto" resolved while the inverse is constructed
+  class AutoInverseType
+  {
+    const BaseSparseMatrix & mat;
+  public:
+    AutoInverseType (const BaseSparseMatrix & amat, shared_ptr<BitArray> subset, bool symmetric)
+      : mat(amat)
+    { mat.SetInverseType (mat.ChooseInverseType (subset, symmetric)); }
+    ~AutoInverseType () { mat.SetInverseType (AUTOINVERSE); }
+  };
+
   /// A general, sparse matrix
   template<class TM>
   class  NGS_DLL_HEADER SparseMatrixTM : public BaseSparseMatrix, 
@@ -278,14 +348,14 @@ namespace ngla
       : BaseSparseMatrix (as, max_elsperrow),
 	data(nze), nul(TSCAL(0))
     {
-      ; 
+      FirstTouch();
     }
 
     SparseMatrixTM (const Array<int> & elsperrow, int awidth)
       : BaseSparseMatrix (elsperrow, awidth), 
 	data(nze), nul(TSCAL(0))
     {
-      ; 
+      FirstTouch();
     }
 
     SparseMatrixTM (int size, int width, const Table<int> & rowelements, 
@@ -293,13 +363,14 @@ namespace ngla
       : BaseSparseMatrix (size, width, rowelements, colelements, symmetric), 
 	data(nze), nul(TSCAL(0))
     { 
-      ; 
+      FirstTouch();
     }
 
     SparseMatrixTM (const MatrixGraph & agraph, bool stealgraph)
       : BaseSparseMatrix (agraph, stealgraph), 
 	data(nze), nul(TSCAL(0))
     { 
+      FirstTouch();
       FindSameNZE();
     }
 
@@ -307,7 +378,11 @@ namespace ngla
     : BaseSparseMatrix (amat), 
       data(nze), nul(TSCAL(0))
     { 
-      AsVector() = amat.AsVector(); 
+      ParallelForRows ([&] (auto rows)
+                       {
+                         for (size_t i = firsti[rows.First()]; i < firsti[rows.Next()]; i++)
+                           data[i] = amat.data[i];
+                       });
     }
 
     SparseMatrixTM (SparseMatrixTM && amat)
@@ -316,6 +391,16 @@ namespace ngla
       data.Swap(amat.data);
     }
 
+    /// zero the values with the row partitioning, see MatrixGraph::ParallelForRows
+    void FirstTouch ()
+    {
+      ParallelForRows ([&] (auto rows)
+                       {
+                         if (rows.Size())
+                           data.Range(firsti[rows.First()], firsti[rows.Next()]) = TM(0.0);
+                       });
+    }
+    
     static shared_ptr<SparseMatrixTM> CreateFromCOO (FlatArray<int> i, FlatArray<int> j,
                                                      FlatArray<TSCAL> val, size_t h, size_t w);
       
@@ -467,15 +552,78 @@ namespace ngla
 
     virtual shared_ptr<BaseSparseMatrix> Restrict (const SparseMatrixTM<double> & prol,
 					 shared_ptr<BaseSparseMatrix> cmat = nullptr) const override;
+
+    virtual shared_ptr<BaseSparseMatrix> CreateSubMatrix (const BitArray & rowscols) const override;
+    virtual shared_ptr<BaseSparseMatrix> DeleteZeroElements (double tol) const override;
   
     ///
     inline TVY RowTimesVector (int row, const FlatVector<TVX> vec) const
     {
-      typedef typename mat_traits<TVY>::TSCAL TTSCAL;
-      TVY sum = TTSCAL(0);
-      for (size_t j = firsti[row]; j < firsti[row+1]; j++)
-	sum += data[j] * vec(colnr[j]);
-      return sum;
+      if constexpr (is_same<TVX,Complex>::value && is_same<TVY,Complex>::value &&
+                    (is_same<TM,double>::value || is_same<TM,Complex>::value))
+        return RowTimesComplexVector (row, vec);
+      else
+        {
+          typedef typename mat_traits<TVY>::TSCAL TTSCAL;
+          TVY sum = TTSCAL(0);
+          for (size_t j = firsti[row]; j < firsti[row+1]; j++)
+            sum += data[j] * vec(colnr[j]);
+          return sum;
+        }
+    }
+
+    /// scalar entries times complex vector in real arithmetic, without the
+    /// inf/nan checks of the complex product. A real entry is loaded once for
+    /// both parts, two independent sums keep the pipelines busy
+    TVY RowTimesComplexVector (int row, const FlatVector<TVX> vec) const
+    {
+      const double * px = reinterpret_cast<const double*> (vec.Data());
+      const int * pcol = colnr.Addr(0);
+      const TM * pdata = data.Addr(0);
+      auto add = [&] (size_t j, double & re, double & im)
+        {
+          const double * xj = px + 2*size_t(pcol[j]);
+          if constexpr (is_same<TM,double>::value)
+            {
+              re += pdata[j] * xj[0];
+              im += pdata[j] * xj[1];
+            }
+          else
+            {
+              double are = pdata[j].real(), aim = pdata[j].imag();
+              re += are * xj[0] - aim * xj[1];
+              im += are * xj[1] + aim * xj[0];
+            }
+        };
+
+      double re0 = 0, im0 = 0, re1 = 0, im1 = 0;
+      size_t j = firsti[row], last = firsti[row+1];
+      for ( ; j+2 <= last; j += 2)
+        {
+          add (j, re0, im0);
+          add (j+1, re1, im1);
+        }
+      if (j < last)
+        add (j, re0, im0);
+      return Complex (re0+re1, im0+im1);
+    }
+
+    /// y += s * Trans(mat) * x by columns, every column is a gather without conflicts
+    template <typename TS>
+    void MultTransAddColumns (const MatrixGraph::TransposedGraph & tg, TS s,
+                              FlatVector<TVY> x, FlatVector<TVX> y) const
+    {
+      typedef typename mat_traits<TVX>::TSCAL TTSCAL;
+      ParallelForRange (tg.balance, [&] (IntRange r)
+                        {
+                          for (auto col : r)
+                            {
+                              TVX sum = TTSCAL(0);
+                              for (size_t j = tg.firsti[col]; j < tg.firsti[col+1]; j++)
+                                sum += Trans(data[tg.pos[j]]) * x(tg.rownr[j]);
+                              y(col) += s * sum;
+                            }
+                        });
     }
 
     ///
@@ -508,6 +656,8 @@ namespace ngla
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
     virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
     virtual void MultAdd (Complex s, const BaseVector & x, BaseVector & y) const override;
+    /// streams the matrix once for all vectors (real scalar matrices)
+    virtual void MultAdd (double s, const MultiVector & x, MultiVector & y) const override;
     virtual void MultTransAdd (Complex s, const BaseVector & x, BaseVector & y) const override;
     virtual void MultConjTransAdd (Complex s, const BaseVector & x, BaseVector & y) const override;
 
@@ -629,6 +779,10 @@ namespace ngla
       return make_shared<SparseMatrixSymmetric> (*this);
     }
 
+    /// the lower triangle of the submatrix is the submatrix of the lower triangle
+    virtual shared_ptr<BaseSparseMatrix> CreateSubMatrix (const BitArray & rowscols) const override;
+    virtual shared_ptr<BaseSparseMatrix> DeleteZeroElements (double tol) const override;
+
     /*
     virtual BaseMatrix * CreateMatrix (const Array<int> & elsperrow) const
     {
@@ -664,6 +818,8 @@ namespace ngla
 
     ///
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    ///
+    virtual void MultAdd (double s, const MultiVector & x, MultiVector & y) const override;
 
     virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override
     {
@@ -732,6 +888,30 @@ namespace ngla
   NGS_DLL_HEADER shared_ptr<SparseMatrixTM<double>>
   MatMult (const SparseMatrix<double, double, double> & mata, const SparseMatrix<double, double, double> & matb);
 
+  /*
+    Galerkin product R A P, computed without the intermediate A P.
+    The constructor does the symbolic pass, Update recomputes the values 
+    for a matrix A with the same graph.
+   */
+  class NGS_DLL_HEADER SparseRAP
+  {
+    shared_ptr<SparseMatrixTM<double>> r, p;
+    shared_ptr<SparseMatrix<double>> prod;
+    size_t height_a, nze_a;
+  public:
+    SparseRAP (shared_ptr<SparseMatrixTM<double>> ar,
+               const SparseMatrixTM<double> & a,
+               shared_ptr<SparseMatrixTM<double>> ap);
+    void Update (const SparseMatrixTM<double> & a);
+    /// Update is possible for a
+    bool SameGraph (const SparseMatrixTM<double> & a) const
+    { return size_t(a.Height()) == height_a && a.NZE() == nze_a; }
+    shared_ptr<SparseMatrix<double>> GetMatrix() const { return prod; }
+  };
+  
+  NGS_DLL_HEADER shared_ptr<SparseMatrixTM<double>>
+  RAP (const SparseMatrixTM<double> & r, const SparseMatrixTM<double> & a, const SparseMatrixTM<double> & p);
+
 #ifdef GOLD
 #include <sparsematrix_spec.hpp>
 #endif
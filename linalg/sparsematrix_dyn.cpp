@@ -86,94 +86,734 @@ namespace ngla
 
   template class SparseMatrixDynamic<double>;
 
+
+  void SparseMatrixFloat :: Mult (const BaseVector & x, BaseVector & y) const 
+  {
+    y = 0.0;
+    MultAdd (1, x, y);
+  }
+
+  void SparseMatrixFloat :: MultAdd (double s, const BaseVector & x, BaseVector & y) const 
+  {
+    static Timer t("SparseMatrixFloat::MultAdd"); RegionTimer reg(t);
+    t.AddFlops (2*nze*bs);
+    
+    if (symmetric)
+      {
+        // lower part plus transposed strict lower part
+        MultTransAdd (s, x, y);
+        return;
+      }
+
+    auto fx = x.FV<double>();
+    auto fy = y.FV<double>();
+    
+    if (bs == 1)
+      {
+        ParallelFor (balance, [&] (int i)
+                     {
+                       double sum = 0;
+                       for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+                         sum += data[j] * fx(colnr[j]);
+                       fy(i) += s * sum;
+                     });
+        return;
+      }
+    
+    ParallelFor (balance, [&] (int i)
+                 {
+                   for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+                     {
+                       const float * pmat = &data[j*bs];
+                       size_t col = colnr[j];
+                       for (size_t k = 0; k < bh; k++)
+                         {
+                           double sum = 0;
+                           for (size_t l = 0; l < bw; l++)
+                             sum += pmat[k*bw+l] * fx(col*bw+l);
+                           fy(i*bh+k) += s * sum;
+                         }
+                     }
+                 });
+  }
+
+  void SparseMatrixFloat :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const 
+  {
+    static Timer t("SparseMatrixFloat::MultTransAdd"); RegionTimer reg(t);
+    t.AddFlops (2*nze*bs);
+    
+    auto fx = x.FV<double>();
+    auto fy = y.FV<double>();
+
+    for (size_t i = 0; i < size; i++)
+      for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+        {
+          const float * pmat = &data[j*bs];
+          size_t col = colnr[j];
+          for (size_t k = 0; k < bh; k++)
+            for (size_t l = 0; l < bw; l++)
+              fy(col*bw+l) += s * pmat[k*bw+l] * fx(i*bh+k);
+          
+          if (symmetric && col != i)  // the upper part
+            for (size_t k = 0; k < bh; k++)
+              for (size_t l = 0; l < bw; l++)
+                fy(i*bh+k) += s * pmat[k*bw+l] * fx(col*bw+l);
+        }
+  }
+  
+  AutoVector SparseMatrixFloat :: CreateRowVector () const
+  {
+    return CreateBaseVector(width, false, bw);    
+  }
+
+  AutoVector SparseMatrixFloat :: CreateColVector () const
+  {
+    return CreateBaseVector(size, false, bh);        
+  }
+
+  Array<MemoryUsage> SparseMatrixFloat :: GetMemoryUsage () const
+  {
+    return { { "SparseMatrixFloat", nze*bs*sizeof(float) + (nze+size)*sizeof(int), 1 } };
+  }
+
+
+  SparseMatrixSELL :: SparseMatrixSELL (const SparseMatrixTM<double> & mat, size_t sigma)
+    : height(mat.Height()), width(mat.Width())
+  {
+    static Timer t("SparseMatrixSELL - ctor"); RegionTimer reg(t);
+    
+    // symmetric storage is expanded to the full matrix
+    bool symmetric = dynamic_cast<const SparseMatrixSymmetricTM<double>*> (&mat) != nullptr;
+    auto IterateEntries = [&] (auto func)
+      {
+        for (size_t i = 0; i < height; i++)
+          {
+            auto cols = mat.GetRowIndices(i);
+            auto vals = mat.GetRowValues(i);
+            for (size_t j = 0; j < cols.Size(); j++)
+              {
+                func (i, cols[j], vals[j]);
+                if (symmetric && size_t(cols[j]) != i)
+                  func (cols[j], i, vals[j]);
+              }
+          }
+      };
+
+    Array<int> rowlen(height);
+    rowlen = 0;
+    IterateEntries ([&] (size_t i, size_t j, double val) { rowlen[i]++; });
+
+    // sort rows by decreasing length within windows of sigma rows
+    sigma = max2 (sigma, C);
+    rownr.SetSize (height);
+    for (size_t i = 0; i < height; i++)
+      rownr[i] = i;
+    for (size_t first = 0; first < height; first += sigma)
+      QuickSort (rownr.Range(first, min2(first+sigma, height)),
+                 [&] (int a, int b) { return rowlen[a] > rowlen[b]; });
+
+    Array<int> sorted_pos(height);
+    for (size_t i = 0; i < height; i++)
+      sorted_pos[rownr[i]] = i;
+    
+    nchunks = (height+C-1) / C;
+    firsti.SetSize (nchunks+1);
+    firsti[0] = 0;
+    for (size_t c = 0; c < nchunks; c++)
+      {
+        size_t w = 0;
+        for (size_t i = c*C; i < min2((c+1)*C, height); i++)
+          w = max2 (w, size_t(rowlen[rownr[i]]));
+        firsti[c+1] = firsti[c] + C*w;
+      }
+
+    // padding entries get value 0 and a valid column
+    colnr.SetSize (firsti[nchunks]);
+    data.SetSize (firsti[nchunks]);
+    colnr = 0;
+    data = 0.0;
+    nze = 0;
+
+    Array<int> cnt(height);
+    cnt = 0;
+    IterateEntries ([&] (size_t i, size_t j, double val)
+                    {
+                      size_t pos = sorted_pos[i];
+                      size_t index = firsti[pos/C] + C*cnt[i] + pos%C;
+                      cnt[i]++;
+                      colnr[index] = j;
+                      data[index] = val;
+                      nze++;
+                    });
+
+    balance.Calc (nchunks, [&] (size_t c) { return 1 + firsti[c+1]-firsti[c]; });
+  }
+
+  void SparseMatrixSELL :: Mult (const BaseVector & x, BaseVector & y) const 
+  {
+    y = 0.0;
+    MultAdd (1, x, y);
+  }
+
+  void SparseMatrixSELL :: MultAdd (double s, const BaseVector & x, BaseVector & y) const 
+  {
+    static Timer t("SparseMatrixSELL::MultAdd"); RegionTimer reg(t);
+    t.AddFlops (2*nze);
+    
+    auto fx = x.FV<double>();
+    auto fy = y.FV<double>();
+
+    ParallelFor (balance, [&] (int c)
+                 {
+                   size_t w = (firsti[c+1]-firsti[c]) / C;
+                   const double * pval = &data[firsti[c]];
+                   const int * pcol = &colnr[firsti[c]];
+                   
+                   SIMD<double> sum = 0.0;
+                   for (size_t k = 0; k < w; k++, pval += C, pcol += C)
+                     sum += SIMD<double>(pval) * SIMD<double>([pcol,fx] (int l) { return fx(pcol[l]); });
+
+                   for (size_t l = 0; l < C && c*C+l < height; l++)
+                     fy(rownr[c*C+l]) += s * sum[l];
+                 });
+  }
+
+  AutoVector SparseMatrixSELL :: CreateRowVector () const
+  {
+    return CreateBaseVector(width, false, 1);
+  }
+
+  AutoVector SparseMatrixSELL :: CreateColVector () const
+  {
+    return CreateBaseVector(height, false, 1);
+  }
+
+  Array<MemoryUsage> SparseMatrixSELL :: GetMemoryUsage () const
+  {
+    return { { "SparseMatrixSELL", data.Size()*(sizeof(double)+sizeof(int)), 1 } };
+  }
+
+
+
+  SparseMatrixCompressed :: SparseMatrixCompressed (const SparseMatrixTM<double> & mat,
+                                                    COMPRESSION acompression)
+    : compression(acompression), height(mat.Height()), width(mat.Width())
+  {
+    static Timer t("SparseMatrixCompressed - ctor"); RegionTimer reg(t);
+
+    // symmetric storage is expanded to the full matrix,
+    // rows stay sorted since the transposed entries of row c come from rows i > c
+    bool symmetric = dynamic_cast<const SparseMatrixSymmetricTM<double>*> (&mat) != nullptr;
+    auto IterateEntries = [&] (auto func)
+      {
+        for (size_t i = 0; i < height; i++)
+          {
+            auto cols = mat.GetRowIndices(i);
+            auto vals = mat.GetRowValues(i);
+            for (size_t j = 0; j < cols.Size(); j++)
+              {
+                func (i, cols[j], vals[j]);
+                if (symmetric && size_t(cols[j]) != i)
+                  func (cols[j], i, vals[j]);
+              }
+          }
+      };
+
+    firsti.SetSize (height+1);
+    firsti = 0;
+    IterateEntries ([&] (size_t i, size_t j, double val) { firsti[i+1]++; });
+    for (size_t i = 0; i < height; i++)
+      firsti[i+1] += firsti[i];
+    nze = firsti[height];
+
+    Array<int> colnr(nze);
+    data.SetSize (nze);
+    Array<size_t> cnt(height);
+    for (size_t i = 0; i < height; i++)
+      cnt[i] = firsti[i];
+    IterateEntries ([&] (size_t i, size_t j, double val)
+                    {
+                      colnr[cnt[i]] = j;
+                      data[cnt[i]] = val;
+                      cnt[i]++;
+                    });
+
+    auto RowCols = [&] (size_t i) { return colnr.Range(firsti[i], firsti[i+1]); };
+    
+    if (compression == RUNS)
+      {
+        auto IsNewRun = [&] (FlatArray<int> cols, size_t j, size_t len)
+          {
+            return j == 0 || cols[j] != cols[j-1]+1 || len == 65535;
+          };
+        
+        firstrun.SetSize (height+1);
+        firstrun[0] = 0;
+        for (size_t i = 0; i < height; i++)
+          {
+            auto cols = RowCols(i);
+            size_t nruns = 0, len = 0;
+            for (size_t j = 0; j < cols.Size(); j++)
+              {
+                if (IsNewRun (cols, j, len)) { nruns++; len = 0; }
+                len++;
+              }
+            firstrun[i+1] = firstrun[i] + nruns;
+          }
+
+        runstart.SetSize (firstrun[height]);
+        runlength.SetSize (firstrun[height]);
+        ParallelFor (height, [&] (size_t i)
+                     {
+                       auto cols = RowCols(i);
+                       size_t r = firstrun[i];
+                       size_t len = 0;
+                       for (size_t j = 0; j < cols.Size(); j++)
+                         {
+                           if (IsNewRun (cols, j, len))
+                             {
+                               if (j > 0) runlength[r++] = len;
+                               runstart[r] = cols[j];
+                               len = 0;
+                             }
+                           len++;
+                         }
+                       if (cols.Size()) runlength[r] = len;
+                     });
+      }
+    else
+      {
+        rowbase.SetSize (height);
+        offset.SetSize (nze);
+        longfirst.SetSize (height);
+        size_t nlong = 0;
+        for (size_t i = 0; i < height; i++)
+          {
+            auto cols = RowCols(i);
+            longfirst[i] = nlong;
+            if (cols.Size() && cols.Last()-cols[0] > 65535)
+              {
+                rowbase[i] = -1;
+                nlong += cols.Size();
+              }
+            else
+              rowbase[i] = cols.Size() ? cols[0] : 0;
+          }
+        longcolnr.SetSize (nlong);
+        
+        ParallelFor (height, [&] (size_t i)
+                     {
+                       auto cols = RowCols(i);
+                       for (size_t j = 0; j < cols.Size(); j++)
+                         if (rowbase[i] >= 0)
+                           offset[firsti[i]+j] = cols[j]-rowbase[i];
+                         else
+                           {
+                             offset[firsti[i]+j] = 0;
+                             longcolnr[longfirst[i]+j] = cols[j];
+                           }
+                     });
+      }
+
+    balance.Calc (height, [&] (size_t i) { return 5 + firsti[i+1]-firsti[i]; });
+  }
+
+  void SparseMatrixCompressed :: Mult (const BaseVector & x, BaseVector & y) const 
+  {
+    y = 0.0;
+    MultAdd (1, x, y);
+  }
+
+  void SparseMatrixCompressed :: MultAdd (double s, const BaseVector & x, BaseVector & y) const 
+  {
+    static Timer t("SparseMatrixCompressed::MultAdd"); RegionTimer reg(t);
+    t.AddFlops (2*nze);
+    
+    auto fx = x.FV<double>();
+    auto fy = y.FV<double>();
+
+    if (compression == RUNS)
+      ParallelFor (balance, [&] (int i)
+                   {
+                     const double * pval = &data[firsti[i]];
+                     double sum = 0;
+                     for (size_t r = firstrun[i]; r < firstrun[i+1]; r++)
+                       {
+                         const double * px = &fx(runstart[r]);
+                         size_t len = runlength[r];
+                         for (size_t k = 0; k < len; k++)
+                           sum += pval[k] * px[k];
+                         pval += len;
+                       }
+                     fy(i) += s * sum;
+                   });
+    else
+      ParallelFor (balance, [&] (int i)
+                   {
+                     double sum = 0;
+                     int base = rowbase[i];
+                     if (base >= 0)
+                       {
+                         const double * px = fx.Data()+base;
+                         for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+                           sum += data[j] * px[offset[j]];
+                       }
+                     else
+                       {
+                         const int * pcol = &longcolnr[longfirst[i]];
+                         const double * pval = &data[firsti[i]];
+                         for (size_t j = 0; j < firsti[i+1]-firsti[i]; j++)
+                           sum += pval[j] * fx(pcol[j]);
+                       }
+                     fy(i) += s * sum;
+                   });
+  }
+
+  AutoVector SparseMatrixCompressed :: CreateRowVector () const
+  {
+    return CreateBaseVector(width, false, 1);
+  }
+
+  AutoVector SparseMatrixCompressed :: CreateColVector () const
+  {
+    return CreateBaseVector(height, false, 1);
+  }
+
+  size_t SparseMatrixCompressed :: IndexMemory () const
+  {
+    if (compression == RUNS)
+      return runstart.Size()*(sizeof(int)+sizeof(uint16_t)) + firstrun.Size()*sizeof(size_t);
+    return offset.Size()*sizeof(uint16_t) + rowbase.Size()*sizeof(int) + longcolnr.Size()*sizeof(int);
+  }
+  
+  Array<MemoryUsage> SparseMatrixCompressed :: GetMemoryUsage () const
+  {
+    return { { "SparseMatrixCompressed", data.Size()*sizeof(double) + IndexMemory(), 1 } };
+  }
+  
+  template <int N>
+  shared_ptr<BaseSparseMatrix> T_ToBlockCSR (const SparseMatrixTM<double> & mat)
+  {
+    static Timer t("ToBlockCSR"); RegionTimer reg(t);
+    
+    bool symmetric = dynamic_cast<const SparseMatrixSymmetricTM<double>*> (&mat) != nullptr;
+    size_t h = mat.Height() / N;
+
+    // block column indices of block row
+    auto BlockCols = [&] (size_t bi, Array<int> & cols)
+      {
+        cols.SetSize0();
+        for (int k = 0; k < N; k++)
+          for (int c : mat.GetRowIndices(bi*N+k))
+            cols.Append (c/N);
+        QuickSort (cols);
+        size_t cnt = 0;
+        for (size_t j = 0; j < cols.Size(); j++)
+          if (cnt == 0 || cols[j] != cols[cnt-1])
+            cols[cnt++] = cols[j];
+        cols.SetSize (cnt);
+      };
+
+    Array<int> elsperrow(h);
+    Array<int> cols;
+    size_t nzeb = 0;
+    for (size_t bi = 0; bi < h; bi++)
+      {
+        BlockCols (bi, cols);
+        elsperrow[bi] = cols.Size();
+        nzeb += cols.Size();
+      }
+
+    // too much fill-in: components are not interleaved
+    if (nzeb*N*N > 1.5 * mat.NZE())
+      return nullptr;
+
+    shared_ptr<SparseMatrixTM<Mat<N,N,double>>> bmat;
+    if (symmetric)
+      bmat = make_shared<SparseMatrixSymmetric<Mat<N,N,double>>> (elsperrow);
+    else
+      bmat = make_shared<SparseMatrix<Mat<N,N,double>>> (elsperrow, mat.Width()/N);
+
+    for (size_t bi = 0; bi < h; bi++)
+      {
+        BlockCols (bi, cols);
+        for (int bj : cols)
+          bmat->CreatePosition (bi, bj);
+      }
+    bmat->AsVector() = 0.0;
+    
+    for (size_t i = 0; i < mat.Height(); i++)
+      {
+        auto rowind = mat.GetRowIndices(i);
+        auto rowvals = mat.GetRowValues(i);
+        for (size_t j = 0; j < rowind.Size(); j++)
+          {
+            size_t c = rowind[j];
+            Mat<N,N,double> & block = (*bmat)(i/N, c/N);
+            block(i%N, c%N) = rowvals[j];
+            // diagonal blocks are stored full
+            if (symmetric && i/N == c/N)
+              block(c%N, i%N) = rowvals[j];
+          }
+      }
+    return bmat;
+  }
+
+  shared_ptr<BaseSparseMatrix> ToBlockCSR (const SparseMatrixTM<double> & mat, int N)
+  {
+    if (mat.Height() % N != 0 || mat.Width() % N != 0)
+      return nullptr;
+    
+    switch (N)
+      {
+      case 1: return nullptr;
+#if MAX_SYS_DIM >= 2
+      case 2: return T_ToBlockCSR<2> (mat);
+#endif
+#if MAX_SYS_DIM >= 3
+      case 3: return T_ToBlockCSR<3> (mat);
+#endif
+#if MAX_SYS_DIM >= 4
+      case 4: return T_ToBlockCSR<4> (mat);
+#endif
+#if MAX_SYS_DIM >= 5
+      case 5: return T_ToBlockCSR<5> (mat);
+#endif
+#if MAX_SYS_DIM >= 6
+      case 6: return T_ToBlockCSR<6> (mat);
+#endif
+      default:
+        throw Exception ("ToBlockCSR: block size "+ToString(N)+" not supported, MAX_SYS_DIM = "
+                         +ToString(MAX_SYS_DIM));
+      }
+  }
+
+  
   template <typename TSCAL>
   SparseMatrixVariableBlocks<TSCAL> ::
   SparseMatrixVariableBlocks (const SparseMatrixTM<TSCAL> & mat)
     : height(mat.Height()), width(mat.Width())
   {
-    size_t row = 0;
-    nblocks = 0;
-    firsti_colnr.Append(0);
-    firsti_data.Append(0);
-    cum_block_size.Append(0);
-    while (row < mat.Height())
-      {
-        auto rowind = mat.GetRowIndices(row);
-        colnr.Append (rowind);
-        firsti_colnr.Append(colnr.Size());
-        for (auto val : mat.GetRowValues(row))
-          data.Append (val);
-        nblocks++;
-        row++;
-        while (row < mat.Height() && 
-               colnr.Range(firsti_colnr[nblocks-1], firsti_colnr[nblocks]) ==
-               mat.GetRowIndices(row))
+    static Timer t("SparseMatrixVariableBlocks - ctor"); RegionTimer reg(t);
+
+    // symmetric storage is expanded to the full matrix,
+    // rows stay sorted since the transposed entries of row c come from rows i > c
+    bool symmetric = dynamic_cast<const SparseMatrixSymmetricTM<TSCAL>*> (&mat) != nullptr;
+    auto IterateEntries = [&] (auto func)
+      {
+        for (size_t i = 0; i < height; i++)
           {
-            for (auto val : mat.GetRowValues(row))
-              data.Append (val);
-            row++;
+            auto cols = mat.GetRowIndices(i);
+            auto vals = mat.GetRowValues(i);
+            for (size_t j = 0; j < cols.Size(); j++)
+              {
+                func (i, cols[j], vals[j]);
+                if (symmetric && size_t(cols[j]) != i)
+                  func (cols[j], i, vals[j]);
+              }
           }
+      };
 
-        firsti_data.Append(data.Size());
-        cum_block_size.Append(row);
+    Array<size_t> firsti(height+1);
+    firsti = 0;
+    IterateEntries ([&] (size_t i, size_t j, TSCAL val) { firsti[i+1]++; });
+    for (size_t i = 0; i < height; i++)
+      firsti[i+1] += firsti[i];
+    Array<int> cols(firsti[height]);
+    Array<TSCAL> vals(firsti[height]);
+    Array<size_t> pos(height);
+    for (size_t i = 0; i < height; i++)
+      pos[i] = firsti[i];
+    IterateEntries ([&] (size_t i, size_t j, TSCAL val)
+                    {
+                      cols[pos[i]] = j;
+                      vals[pos[i]] = val;
+                      pos[i]++;
+                    });
+    auto RowCols = [&] (size_t i) { return cols.Range(firsti[i], firsti[i+1]); };
 
-        size_t bw = rowind.Size();
-        size_t bh = cum_block_size[nblocks]-cum_block_size[nblocks-1];
-        TSCAL * pdata = &data[firsti_data[nblocks-1]];
-        Matrix<TSCAL> tmp = FlatMatrix<TSCAL> (bh, bw, pdata);
-        FlatMatrix<TSCAL> (bw, bh, pdata) = Trans(tmp);
+    // blocks of consecutive rows with equal columns
+    cum_block_size.SetSize0();
+    cum_block_size.Append (0);
+    for (size_t row = 0; row < height; )
+      {
+        size_t next = row+1;
+        while (next < height && RowCols(next) == RowCols(row))
+          next++;
+        cum_block_size.Append (next);
+        maxbs = max2 (maxbs, next-row);
+        row = next;
       }
+    nblocks = cum_block_size.Size()-1;
+
+    firsti_colnr.SetSize (nblocks+1);
+    firsti_data.SetSize (nblocks+1);
+    firsti_colnr[0] = 0;
+    firsti_data[0] = 0;
+    for (size_t i = 0; i < nblocks; i++)
+      {
+        size_t bw = RowCols(cum_block_size[i]).Size();
+        firsti_colnr[i+1] = firsti_colnr[i] + bw;
+        firsti_data[i+1] = firsti_data[i] + bw * BlockRows(i).Size();
+      }
+    colnr.SetSize (firsti_colnr[nblocks]);
+    data.SetSize (firsti_data[nblocks]);
+
+    ParallelFor (nblocks, [&] (size_t i)
+                 {
+                   auto rows = BlockRows(i);
+                   auto bcols = RowCols(rows.First());
+                   colnr.Range(firsti_colnr[i], firsti_colnr[i+1]) = bcols;
+                   FlatMatrix<TSCAL> block = Block(i);
+                   for (size_t k = 0; k < rows.Size(); k++)
+                     block.Col(k) = FlatVector<TSCAL> (bcols.Size(), vals.Data()+firsti[rows[k]]);
+                 });
 
-    int maxbs = 0;
-    for (int i = 0; i < nblocks; i++)
-      maxbs = cum_block_size[i+1]-cum_block_size[i];
     Array<int> nbs(maxbs+1);
     nbs = 0;
-    for (int i = 0; i < nblocks; i++)
-      nbs[cum_block_size[i+1]-cum_block_size[i]]++;
-    for (int i = 0; i < nbs.Size(); i++)
+    for (size_t i = 0; i < nblocks; i++)
+      nbs[BlockRows(i).Size()]++;
+    cout << IM(3) << "SparseMatrixVariableBlocks: " << nblocks << " blocks, "
+         << colnr.Size() << " column indices for " << data.Size() << " entries" << endl;
+    for (size_t i = 0; i < nbs.Size(); i++)
       if (nbs[i])
-        cout << "bs=" << i << ": " << nbs[i] << endl;
+        cout << IM(5) << "bs = " << i << ": " << nbs[i] << endl;
   }
 
+  template <typename TSCAL>
+  Table<int> SparseMatrixVariableBlocks<TSCAL> :: GetBlocks () const
+  {
+    TableCreator<int> creator(nblocks);
+    for ( ; !creator.Done(); creator++)
+      for (size_t i = 0; i < nblocks; i++)
+        for (auto r : BlockRows(i))
+          creator.Add (i, r);
+    return creator.MoveTable();
+  }
+  
 
   template <typename TSCAL>
   void SparseMatrixVariableBlocks<TSCAL> ::
   MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
+    static Timer t("SparseMatrixVariableBlocks::MultAdd"); RegionTimer reg(t);
+    t.AddFlops (data.Size());
+    
     auto fx = x.FV<TSCAL>();
     auto fy = y.FV<TSCAL>();
-    // for (size_t i = 0; i < nblocks; i++)
     ParallelForRange
       (nblocks, [&] (IntRange myrange)
        {
          for (size_t i : myrange)
            {
-             TSCAL * pdata = &data[firsti_data[i]];
-             int firsti = firsti_colnr[i];
-             int nexti = firsti_colnr[i+1];
-             //int * pcol = &colnr[firsti];
-             TSCAL * py = &fy(cum_block_size[i]);
-             int bs = cum_block_size[i+1]-cum_block_size[i];
-             FlatMatrix<TSCAL> mat(nexti-firsti, bs, pdata);
-             auto ind = colnr.Range(firsti, nexti);
-             MultAddMatTransVecIndirect (s, mat, fx, FlatVector(bs, py), ind);
+             auto rows = BlockRows(i);
+             MultAddMatTransVecIndirect (s, Block(i), fx, fy.Range(rows), BlockCols(i));
+           }
+       }, TasksPerThread(4));
+  }
+
+  template <typename TSCAL>
+  void SparseMatrixVariableBlocks<TSCAL> ::
+  MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SparseMatrixVariableBlocks::MultTransAdd"); RegionTimer reg(t);
+    t.AddFlops (data.Size());
+    
+    auto fx = x.FV<TSCAL>();
+    auto fy = y.FV<TSCAL>();
+    ParallelForRange
+      (nblocks, [&] (IntRange myrange)
+       {
+         for (size_t i : myrange)
+           {
+             FlatVector<TSCAL> hx = fx.Range(BlockRows(i));
+             FlatMatrix<TSCAL> block = Block(i);
+             auto ind = BlockCols(i);
+             for (size_t j = 0; j < ind.Size(); j++)
+               AtomicAdd (fy(ind[j]), s * InnerProduct (block.Row(j), hx));
            }
        }, TasksPerThread(4));
-        /*
-        for (size_t j = 0; j < nexti-firsti; j++, pcol++)
-          {
-            TSCAL hx = fx[*pcol];
-            for (size_t k = 0; k < bs; k++, pdata++)
-              py[k] += s * *pdata * hx; 
-          }
-        */
   }
 
+
+  template <typename TSCAL>
+  void SparseMatrixVariableBlocks<TSCAL> ::
+  InvertDiagonalBlocks (shared_ptr<BitArray> freedofs)
+  {
+    static Timer t("SparseMatrixVariableBlocks::InvertDiagonalBlocks"); RegionTimer reg(t);
+    if (height != width)
+      throw Exception ("SparseMatrixVariableBlocks::InvertDiagonalBlocks: matrix is not square");
+
+    firsti_inv.SetSize (nblocks+1);
+    firsti_inv[0] = 0;
+    for (size_t i = 0; i < nblocks; i++)
+      firsti_inv[i+1] = firsti_inv[i] + sqr (BlockRows(i).Size());
+    invdiag.SetSize (firsti_inv[nblocks]);
+
+    ParallelFor (nblocks, [&] (size_t i)
+                 {
+                   auto rows = BlockRows(i);
+                   size_t bh = rows.Size();
+                   FlatMatrix<TSCAL> inv(bh, bh, invdiag.Data()+firsti_inv[i]);
+                   FlatMatrix<TSCAL> block = Block(i);
+                   auto ind = BlockCols(i);
+                   
+                   // the columns of the block rows are consecutive in ind
+                   inv = TSCAL(0.0);
+                   size_t first = std::lower_bound (ind.Data(), ind.Data()+ind.Size(), int(rows.First())) - ind.Data();
+                   for (size_t j = first; j < ind.Size() && size_t(ind[j]) < rows.Next(); j++)
+                     inv.Col(ind[j]-rows.First()) = block.Row(j);
+
+                   // not free and empty rows are not touched by the smoother
+                   Array<bool> active(bh);
+                   for (size_t k = 0; k < bh; k++)
+                     {
+                       active[k] = (!freedofs || freedofs->Test(rows[k])) && inv(k,k) != TSCAL(0.0);
+                       if (active[k]) continue;
+                       inv.Row(k) = TSCAL(0.0);
+                       inv.Col(k) = TSCAL(0.0);
+                       inv(k,k) = 1.0;
+                     }
+                   CalcInverse (inv);
+                   for (size_t k = 0; k < bh; k++)
+                     if (!active[k])
+                       inv(k,k) = 0.0;
+                 });
+  }
+
+  template <typename TSCAL>
+  void SparseMatrixVariableBlocks<TSCAL> ::
+  GSSmooth (BaseVector & x, const BaseVector & b, int steps, bool backward) const
+  {
+    static Timer t("SparseMatrixVariableBlocks::GSSmooth"); RegionTimer reg(t);
+    if (firsti_inv.Size() != nblocks+1)
+      throw Exception ("SparseMatrixVariableBlocks::GSSmooth: call InvertDiagonalBlocks first");
+    t.AddFlops (steps * (data.Size()+invdiag.Size()));
+
+    auto fx = x.FV<TSCAL>();
+    auto fb = b.FV<TSCAL>();
+    Vector<TSCAL> mem(2*maxbs);
+    for (int step = 0; step < steps; step++)
+      for (size_t ii = 0; ii < nblocks; ii++)
+        {
+          size_t i = backward ? nblocks-1-ii : ii;
+          auto rows = BlockRows(i);
+          size_t bh = rows.Size();
+          FlatVector<TSCAL> r(bh, mem.Data());
+          FlatVector<TSCAL> w(bh, mem.Data()+bh);
+          FlatMatrix<TSCAL> inv(bh, bh, const_cast<TSCAL*>(invdiag.Data())+firsti_inv[i]);
+
+          r = fb.Range(rows);
+          MultAddMatTransVecIndirect (-1, Block(i), fx, r, BlockCols(i));
+          w = inv * r;
+          fx.Range(rows) += w;
+        }
+  }
+  
+
   template <typename TSCAL>  
   AutoVector SparseMatrixVariableBlocks<TSCAL> :: CreateRowVector () const
   {
-    cout << "CreateRowVector, w = " << width << endl;
     return CreateBaseVector(width, false, 1);    
   }
 
@@ -183,6 +823,17 @@ namespace ngla
     return CreateBaseVector(height, false, 1);        
   }
 
+  template <typename TSCAL>  
+  Array<MemoryUsage> SparseMatrixVariableBlocks<TSCAL> :: GetMemoryUsage () const
+  {
+    Array<MemoryUsage> mu;
+    mu += { "SparseMatrixVariableBlocks", data.Size()*sizeof(TSCAL) + colnr.Size()*sizeof(int)
+           + nblocks*(2*sizeof(size_t)+sizeof(int)), 1 };
+    if (invdiag.Size())
+      mu += { "SparseMatrixVariableBlocks/inverse diagonal blocks", invdiag.Size()*sizeof(TSCAL), 1 };
+    return mu;
+  }
+
   template class SparseMatrixVariableBlocks<double>;  
 
 }
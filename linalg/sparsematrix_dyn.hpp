@@ -54,16 +54,186 @@ namespace ngla
 
 
 
+  /**
+     Copy of a real sparse matrix with values stored in single precision.
+     Vectors stay double, only the matrix values are rounded. 
+     Halves memory traffic for bandwidth bound operations as smoothing.
+   */
+  class NGS_DLL_HEADER SparseMatrixFloat : public BaseSparseMatrix,
+                                           public S_BaseMatrix<double>
+  {
+  protected:
+    size_t bh, bw, bs;
+    Array<float> data;
+    /// only lower triangular part stored
+    bool symmetric;
+    
+  public:
+    template <typename TM>
+      SparseMatrixFloat (const SparseMatrixTM<TM> & mat)
+      : BaseSparseMatrix (mat, false)
+    {
+      width = mat.Width();
+      bh = mat_traits<TM>::HEIGHT;
+      bw = mat_traits<TM>::WIDTH;
+      bs = bh*bw;
+      nze = mat.NZE();
+      symmetric = dynamic_cast<const SparseMatrixSymmetricTM<TM>*> (&mat) != nullptr;
+      data.SetSize(nze*bs);
+      auto matvec = mat.AsVector().template FV<TM>();
+      ParallelForRange
+        (nze, [&] (IntRange r)
+         {
+           for (size_t i : r)
+             {
+               Mat<mat_traits<TM>::HEIGHT, mat_traits<TM>::WIDTH, double> hm = matvec(i);
+               for (size_t j = 0; j < bs; j++)
+                 data[i*bs+j] = hm(j);
+             }
+         });
+    }
+
+    virtual int VHeight() const override { return size*bh; }
+    virtual int VWidth() const override { return width*bw; }
+
+    virtual void Mult (const BaseVector & x, BaseVector & y) const override;
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    virtual AutoVector CreateRowVector() const override;
+    virtual AutoVector CreateColVector() const override;
+
+    virtual Array<MemoryUsage> GetMemoryUsage () const override;
+  };
+
+
+  /**
+     SELL-C-sigma (sliced ELLPACK) copy of a real sparse matrix.
+     Rows are sorted by length within windows of sigma rows, and packed
+     into chunks of C = SIMD-width rows, stored column-major per chunk.
+     MultAdd vectorizes over the rows of a chunk, which pays off for
+     the short rows of FEM matrices.
+   */
+  class NGS_DLL_HEADER SparseMatrixSELL : public S_BaseMatrix<double>
+  {
+  protected:
+    static constexpr size_t C = SIMD<double>::Size();
+    size_t height, width, nchunks, nze;
+    /// original row number of sorted row
+    Array<int> rownr;
+    /// first entry of chunk, chunk width is (firsti[c+1]-firsti[c])/C
+    Array<size_t> firsti;
+    Array<int> colnr;
+    Array<double> data;
+    Partitioning balance;
+    
+  public:
+    SparseMatrixSELL (const SparseMatrixTM<double> & mat, size_t sigma = 256);
+
+    int VHeight() const override { return height; }
+    int VWidth() const override { return width; }
+
+    void Mult (const BaseVector & x, BaseVector & y) const override;
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    AutoVector CreateRowVector () const override;
+    AutoVector CreateColVector () const override;
+
+    Array<MemoryUsage> GetMemoryUsage () const override;
+  };
+
+
+  /**
+     Copy of a real scalar sparse matrix with compressed column indices.
+     RUNS stores every row as runs of consecutive columns (start, length),
+     which needs only few runs for the dense row blocks of high order matrices. 
+     OFFSET16 stores 16-bit offsets relative to the first column of the row,
+     rows with a larger span keep int indices.
+     Symmetric storage is expanded to the full matrix.
+   */
+  class NGS_DLL_HEADER SparseMatrixCompressed : public S_BaseMatrix<double>
+  {
+  public:
+    enum COMPRESSION { RUNS, OFFSET16 };
+  protected:
+    COMPRESSION compression;
+    size_t height, width, nze;
+    /// first value of row
+    Array<size_t> firsti;
+    Array<double> data;
+
+    /// RUNS: runs of row i are [firstrun[i], firstrun[i+1])
+    Array<size_t> firstrun;
+    Array<int> runstart;
+    Array<uint16_t> runlength;
+
+    /// OFFSET16: column is rowbase[i]+offset[j], or longcolnr[longfirst[i]+j-firsti[i]] if rowbase[i] < 0
+    Array<int> rowbase;
+    Array<uint16_t> offset;
+    Array<size_t> longfirst;
+    Array<int> longcolnr;
+    
+    Partitioning balance;
+    
+  public:
+    SparseMatrixCompressed (const SparseMatrixTM<double> & mat, COMPRESSION acompression = RUNS);
+
+    int VHeight() const override { return height; }
+    int VWidth() const override { return width; }
+
+    void Mult (const BaseVector & x, BaseVector & y) const override;
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    AutoVector CreateRowVector () const override;
+    AutoVector CreateColVector () const override;
+
+    /// bytes used for column indices, compare with nze*sizeof(int)
+    size_t IndexMemory () const;
+    Array<MemoryUsage> GetMemoryUsage () const override;
+  };
+
+  
+  /**
+     Converts a real scalar matrix with interleaved numbering of N
+     components (dof = N*node+comp) into a matrix of N x N blocks.
+     Symmetric storage is preserved. Returns nullptr if the pattern is
+     not block-structured (e.g. numbering is not interleaved).
+   */
+  NGS_DLL_HEADER shared_ptr<BaseSparseMatrix>
+  ToBlockCSR (const SparseMatrixTM<double> & mat, int N);
+  
+
+  /**
+     Copy of a scalar sparse matrix as blocks of consecutive rows with
+     equal column indices, such as the dofs of one edge, face or cell of
+     high order elements. The column indices are stored once per block,
+     the values of a block as dense bw x bh matrix (transposed).
+     Symmetric storage is expanded to the full matrix.
+
+     After InvertDiagonalBlocks the blocks serve as block Gauss-Seidel
+     smoother.
+   */
   template <class TSCAL>
   class  NGS_DLL_HEADER SparseMatrixVariableBlocks : public S_BaseMatrix<TSCAL>
   {
   protected:
     size_t height, width, nblocks;
+    size_t maxbs = 0;
     Array<int> colnr;
     Array<TSCAL> data;
     Array<size_t> firsti_colnr, firsti_data;
     Array<int> cum_block_size;
-    TSCAL nul;
+    /// inverses of the diagonal blocks, block i starts at firsti_inv[i]
+    Array<TSCAL> invdiag;
+    Array<size_t> firsti_inv;
+
+    FlatMatrix<TSCAL> Block (size_t i) const
+    {
+      return FlatMatrix<TSCAL> (firsti_colnr[i+1]-firsti_colnr[i], BlockRows(i).Size(),
+                                const_cast<TSCAL*> (data.Data())+firsti_data[i]);
+    }
+    FlatArray<int> BlockCols (size_t i) const
+    { return colnr.Range(firsti_colnr[i], firsti_colnr[i+1]); }
     
   public:
     SparseMatrixVariableBlocks (const SparseMatrixTM<TSCAL> & mat);
@@ -71,10 +241,24 @@ namespace ngla
     int VHeight() const override { return height; }
     int VWidth() const override { return width; }
 
+    size_t NBlocks () const { return nblocks; }
+    /// rows of block i
+    IntRange BlockRows (size_t i) const { return IntRange (cum_block_size[i], cum_block_size[i+1]); }
+    /// the rows of all blocks, e.g. for CreateBlockSmoother of the original matrix
+    Table<int> GetBlocks () const;
+
     void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    /// inverses of the diagonal blocks, rows and columns of dofs not in freedofs are zero
+    void InvertDiagonalBlocks (shared_ptr<BitArray> freedofs = nullptr);
+    /// steps of block Gauss-Seidel for A x = b, forward or backward through the blocks
+    void GSSmooth (BaseVector & x, const BaseVector & b, int steps = 1, bool backward = false) const;
 
     AutoVector CreateRowVector () const override;
     AutoVector CreateColVector () const override;
+
+    Array<MemoryUsage> GetMemoryUsage () const override;
   };
 
 
@@ -46,13 +46,50 @@ namespace ngla
   CreateFromCOO (FlatArray<int> indi, FlatArray<int> indj,
                  FlatArray<TSCAL> val, size_t h, size_t w)
   {
+    static Timer t("SparseMatrix::CreateFromCOO"); RegionTimer reg(t);
+    size_t nze = indi.Size();
+    if (indj.Size() != nze || val.Size() != nze)
+      throw Exception ("CreateFromCOO: indi, indj and val of different sizes");
+
+    // entries sorted by (row, col), stable: of duplicate entries the last one counts
+    Array<size_t> keys(nze), index(nze);
+    ParallelFor (nze, [&] (size_t k)
+                 {
+                   keys[k] = size_t(indi[k]) * w + size_t(indj[k]);
+                   index[k] = k;
+                 });
+    ParallelRadixSort (keys, index);
+    auto is_last = [&] (size_t k) { return k+1 == nze || keys[k+1] != keys[k]; };
+
+    Array<size_t> rowfirst(h+1);
+    ParallelFor (h+1, [&] (size_t i)
+                 {
+                   rowfirst[i] = std::lower_bound (keys.Data(), keys.Data()+nze, i*w) - keys.Data();
+                 });
+    
     Array<int> cnt(h);
-    cnt = 0;
-    for (auto i : indi) cnt[i]++;
+    ParallelFor (h, [&] (size_t i)
+                 {
+                   int c = 0;
+                   for (size_t k = rowfirst[i]; k < rowfirst[i+1]; k++)
+                     if (is_last(k)) c++;
+                   cnt[i] = c;
+                 });
 
     auto matrix = make_shared<SparseMatrix<TM>> (cnt, w);
-    for (auto k : ngstd::Range(indi))
-      (*matrix)(indi[k], indj[k]) = val[k];
+    ParallelFor (h, [&] (size_t i)
+                 {
+                   auto rowind = matrix->GetRowIndices(i);
+                   auto rowvals = matrix->GetRowValues(i);
+                   size_t pos = 0;
+                   for (size_t k = rowfirst[i]; k < rowfirst[i+1]; k++)
+                     if (is_last(k))
+                       {
+                         rowind[pos] = keys[k] - i*w;
+                         rowvals(pos) = val[index[k]];
+                         pos++;
+                       }
+                 });
     return matrix;
   }
   
@@ -68,6 +105,9 @@ namespace ngla
     static Timer timer_addelmat_nonsym("SparseMatrix::AddElementMatrix");
     ThreadRegionTimer reg (timer_addelmat_nonsym, TaskManager::GetThreadId());
     NgProfiler::AddThreadFlops (timer_addelmat_nonsym, TaskManager::GetThreadId(), dnums1.Size()*dnums2.Size());
+    // element matrix read, matrix entries read and written, column indices searched
+    Roofline::AddThreadBytes (timer_addelmat_nonsym, TaskManager::GetThreadId(),
+                              dnums1.Size()*dnums2.Size() * (3*sizeof(TM) + sizeof(int)));
     
     ArrayMem<int, 50> map(dnums2.Size());
     for (int i = 0; i < map.Size(); i++) map[i] = i;
@@ -131,28 +171,26 @@ namespace ngla
   MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
     static Timer t("SparseMatrix::MultAdd"); RegionTimer reg(t);
+    CriticalWork critical;
     t.AddFlops (this->NZE());
+    // matrix entries and column indices, row pointers, x once and y read and written
+    Roofline::AddBytes (t, this->NZE() * (sizeof(TM)+sizeof(int)) + this->Height() * (sizeof(size_t) + 2*sizeof(TVY))
+                        + this->Width() * sizeof(TVX));
 
     if (task_manager)
       {
 	FlatVector<TVX> fx = x.FV<TVX>(); 
 	FlatVector<TVY> fy = y.FV<TVY>(); 
 
-        // int ntasks = task_manager->GetNumThreads();
-
-        task_manager -> CreateJob 
-          ([&] (TaskInfo & ti) 
-           {
-             int tasks_per_part = ti.ntasks / balance.Size();
-             int mypart = ti.task_nr / tasks_per_part;
-             int num_in_part = ti.task_nr % tasks_per_part;
-             
-             auto myrange = balance[mypart].Split (num_in_part, tasks_per_part);
-
-             for (auto row : myrange) 
-               fy(row) += s * RowTimesVector (row, fx);
-
-           });
+        static auto stats = ParallelStats::GetSite ("SparseMatrix::MultAdd");
+        ParallelStatsRegion preg(stats);
+        // same rows per task as first touch of the matrix
+        this->ParallelForRows ([&] (auto myrange)
+                               {
+                                 ParallelStatsTask ptask(stats);
+                                 for (auto row : myrange) 
+                                   fy(row) += s * RowTimesVector (row, fx);
+                               });
 	return;
       }
     
@@ -166,6 +204,45 @@ namespace ngla
 
   }
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseMatrix<TM,TV_ROW,TV_COL> ::
+  MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if constexpr (is_same<TM,double>::value && is_same<TV_ROW,double>::value &&
+                  is_same<TV_COL,double>::value)
+      {
+        static Timer t("SparseMatrix::MultAdd MultiVector"); RegionTimer reg(t);
+        size_t k = x.NumVectors();
+        t.AddFlops (this->NZE()*k);
+        Roofline::AddBytes (t, this->NZE() * (sizeof(double)+sizeof(int)) + this->Height() * (sizeof(size_t) + 2*k*sizeof(double))
+                            + this->Width() * k*sizeof(double));
+        
+        FlatMatrix<double> fx = x.FM();
+        FlatMatrix<double> fy = y.FM();
+        
+        ParallelForRange
+          (balance, [&] (IntRange r)
+           {
+             VectorMem<16> sum(k);
+             for (auto row : r)
+               {
+                 sum = 0.0;
+                 for (size_t j = firsti[row]; j < firsti[row+1]; j++)
+                   {
+                     double val = data[j];
+                     size_t col = colnr[j];
+                     for (size_t l = 0; l < k; l++)
+                       sum(l) += val * fx(l, col);
+                   }
+                 for (size_t l = 0; l < k; l++)
+                   fy(l, row) += s * sum(l);
+               }
+           });
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
+  }
+
   template <class TM, class TV_ROW, class TV_COL>
   void SparseMatrix<TM,TV_ROW,TV_COL> ::
   MultAdd1 (double s, const BaseVector & x, BaseVector & y,
@@ -202,9 +279,12 @@ namespace ngla
 
     FlatVector<TVY> fx = x.FV<TVY>();
     FlatVector<TVX> fy = y.FV<TVX>();
-    
-    for (int i = 0; i < this->Height(); i++)
-      AddRowTransToVector (i, s*fx(i), fy);
+
+    if (auto tg = this->GetTransposedGraph())
+      MultTransAddColumns (*tg, s, fx, fy);
+    else
+      for (int i = 0; i < this->Height(); i++)
+        AddRowTransToVector (i, s*fx(i), fy);
 
     timer.AddFlops (this->NZE());
   }
@@ -220,9 +300,11 @@ namespace ngla
     FlatVector<TVX> fx = x.FV<TVX> (); //  (x.Size(), x.Memory());
     FlatVector<TVY> fy = y.FV<TVY> (); // (y.Size(), y.Memory());
 
-    int h = this->Height();
-    for (int i = 0; i < h; i++)
-      fy(i) += ConvertTo<TSCAL> (s) * RowTimesVector (i, fx);
+    this->ParallelForRows ([&] (auto myrange)
+                           {
+                             for (auto row : myrange)
+                               fy(row) += ConvertTo<TSCAL> (s) * RowTimesVector (row, fx);
+                           });
   }
   
 
@@ -236,8 +318,11 @@ namespace ngla
     FlatVector<TVY> fx = x.FV<TVY>(); //  (x.Size(), x.Memory());
     FlatVector<TVX> fy = y.FV<TVX>(); // (y.Size(), y.Memory());
     
-    for (int i = 0; i < this->Height(); i++)
-      AddRowTransToVector (i, ConvertTo<TSCAL> (s)*fx(i), fy);
+    if (auto tg = this->GetTransposedGraph())
+      MultTransAddColumns (*tg, ConvertTo<TSCAL> (s), fx, fy);
+    else
+      for (int i = 0; i < this->Height(); i++)
+        AddRowTransToVector (i, ConvertTo<TSCAL> (s)*fx(i), fy);
   }
 
   template <class TM, class TV_ROW, class TV_COL>
@@ -284,6 +369,12 @@ namespace ngla
 	throw Exception(string("MAX_SYS_DIM = ")+to_string(MAX_SYS_DIM)+string(", need at least ")+to_string(mat_traits<TM>::HEIGHT));
       }
     else {
+      if ( this->GetInverseType() == AUTOINVERSE )
+        {
+          AutoInverseType autotype(*this, subset, false);
+          return InverseMatrix (subset);
+        }
+
       if ( this->GetInverseType() == SUPERLU_DIST )
 	throw Exception ("SparseMatrix::InverseMatrix:  SuperLU_DIST_Inverse not available");
 
@@ -319,6 +410,12 @@ namespace ngla
 	  throw Exception ("SparseMatrix::InverseMatrix: MumpsInverse not available");
 #endif
 	}
+      else if (  BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_MP)
+	return make_shared<IterativeRefinement>
+          (*this, make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset));
+      else if (SetupCacheDirectory().length())
+	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>>
+          (*this, CachedSparseCholeskySymbolic (*this, subset, SetupCacheDirectory()), subset);
       else
 	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset);
       //#endif
@@ -354,6 +451,12 @@ namespace ngla
 
       // #ifdef ASTRID
 
+      if ( this->GetInverseType() == AUTOINVERSE )
+        {
+          AutoInverseType autotype(*this, nullptr, false);
+          return InverseMatrix (clusters);
+        }
+
       if ( this->GetInverseType() == SUPERLU_DIST )
 	throw Exception ("SparseMatrix::InverseMatrix:  SuperLU_DIST_Inverse not available");
 
@@ -388,6 +491,9 @@ namespace ngla
 	  throw Exception ("SparseMatrix::InverseMatrix:  MumpsInverse not available");
 #endif
 	}
+      else if (  BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_MP)
+	return make_shared<IterativeRefinement>
+          (*this, make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters));
       else
 	{
 	  return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters);
@@ -418,8 +524,8 @@ namespace ngla
   GetMemoryUsage () const
   {
     Array<MemoryUsage> mu;
-    mu += { "SparseMatrix", nze*sizeof(TM), 1 };
-    if (owner) mu += MatrixGraph::GetMemoryUsage ();
+    mu += { "SparseMatrix/values", nze*sizeof(TM), 1 };
+    if (owner) mu += MemoryUsageChildren ("SparseMatrix", MatrixGraph::GetMemoryUsage ());
     return mu;
   }
 
@@ -465,6 +571,125 @@ namespace ngla
   }
 
 
+  // rows and columns of the set bits of a square matrix, the renumbering
+  // keeps the order, so a lower triangle stays a lower triangle
+  template <class TMAT>
+  shared_ptr<TMAT> CreateSubMatrixOf (const TMAT & mat, const BitArray & rowscols)
+  {
+    static Timer t("SparseMatrix::CreateSubMatrix"); RegionTimer reg(t);
+    size_t n = mat.Height();
+    if (size_t(mat.Width()) != n || rowscols.Size() != n)
+      throw Exception ("CreateSubMatrix: needs a square matrix and a BitArray of its height, "
+                       + ToString(mat.Height()) + " x " + ToString(mat.Width())
+                       + ", BitArray " + ToString(rowscols.Size()));
+
+    Array<int> compress(n);
+    Array<int> rows;
+    rows.SetAllocSize (rowscols.NumSet());
+    for (size_t i = 0; i < n; i++)
+      if (rowscols.Test(i))
+        {
+          compress[i] = rows.Size();
+          rows.Append (i);
+        }
+      else
+        compress[i] = -1;
+
+    Array<int> elsperrow(rows.Size());
+    ParallelFor (rows.Size(), [&] (size_t i)
+                 {
+                   int cnt = 0;
+                   for (int c : mat.GetRowIndices(rows[i]))
+                     if (compress[c] != -1) cnt++;
+                   elsperrow[i] = cnt;
+                 });
+
+    auto sub = make_shared<TMAT> (elsperrow);
+    sub->ParallelForRows ([&] (auto myrows)
+                          {
+                            for (size_t i : myrows)
+                              {
+                                auto cols = mat.GetRowIndices(rows[i]);
+                                auto vals = mat.GetRowValues(rows[i]);
+                                auto subcols = sub->GetRowIndices(i);
+                                auto subvals = sub->GetRowValues(i);
+                                size_t k = 0;
+                                for (size_t j = 0; j < cols.Size(); j++)
+                                  if (int c = compress[cols[j]]; c != -1)
+                                    {
+                                      subcols[k] = c;
+                                      subvals(k) = vals(j);
+                                      k++;
+                                    }
+                              }
+                          });
+    sub->SetSPD (mat.IsSPD());
+    return sub;
+  }
+
+  template <class TM, class TV_ROW, class TV_COL>
+  shared_ptr<BaseSparseMatrix> SparseMatrix<TM,TV_ROW,TV_COL> ::
+  CreateSubMatrix (const BitArray & rowscols) const
+  {
+    return CreateSubMatrixOf (*this, rowscols);
+  }
+
+
+  // the entries of norm above tol and the diagonal, in a new matrix from create(elsperrow)
+  template <class TMAT, class TCREATE>
+  shared_ptr<TMAT> DeleteZeroElementsOf (const TMAT & mat, double tol, TCREATE create)
+  {
+    static Timer t("SparseMatrix::DeleteZeroElements"); RegionTimer reg(t);
+    size_t n = mat.Height();
+    double tol2 = tol*tol;
+    auto keep = [&] (size_t row, int col, auto & val)
+      { return size_t(col) == row || L2Norm2(val) > tol2; };
+
+    Array<int> elsperrow(n);
+    ParallelFor (n, [&] (size_t i)
+                 {
+                   auto cols = mat.GetRowIndices(i);
+                   auto vals = mat.GetRowValues(i);
+                   int cnt = 0;
+                   for (size_t j = 0; j < cols.Size(); j++)
+                     if (keep (i, cols[j], vals(j))) cnt++;
+                   elsperrow[i] = cnt;
+                 });
+
+    shared_ptr<TMAT> comp = create (elsperrow);
+    comp->ParallelForRows ([&] (auto myrows)
+                           {
+                             for (size_t i : myrows)
+                               {
+                                 auto cols = mat.GetRowIndices(i);
+                                 auto vals = mat.GetRowValues(i);
+                                 auto compcols = comp->GetRowIndices(i);
+                                 auto compvals = comp->GetRowValues(i);
+                                 size_t k = 0;
+                                 for (size_t j = 0; j < cols.Size(); j++)
+                                   if (keep (i, cols[j], vals(j)))
+                                     {
+                                       compcols[k] = cols[j];
+                                       compvals(k) = vals(j);
+                                       k++;
+                                     }
+                               }
+                           });
+    comp->SetSPD (mat.IsSPD());
+    cout << IM(5) << "DeleteZeroElements: " << mat.NZE()-comp->NZE() << " of "
+         << mat.NZE() << " entries deleted" << endl;
+    return comp;
+  }
+
+  template <class TM, class TV_ROW, class TV_COL>
+  shared_ptr<BaseSparseMatrix> SparseMatrix<TM,TV_ROW,TV_COL> ::
+  DeleteZeroElements (double tol) const
+  {
+    return DeleteZeroElementsOf (*this, tol, [&] (const Array<int> & elsperrow)
+                                 { return make_shared<SparseMatrix> (elsperrow, this->Width()); });
+  }
+
+
   template<class TM, class TV_ROW, class TV_COL>
   shared_ptr<BaseSparseMatrix>
   SparseMatrix<TM,TV_ROW,TV_COL> :: Restrict (const SparseMatrixTM<double> & prol,
@@ -611,6 +836,8 @@ namespace ngla
     // RegionTimer reg (timer);
     ThreadRegionTimer reg (timer_addelmat, TaskManager::GetThreadId());
     NgProfiler::AddThreadFlops (timer_addelmat, TaskManager::GetThreadId(), dnums.Size()*(dnums.Size()+1)/2);    
+    Roofline::AddThreadBytes (timer_addelmat, TaskManager::GetThreadId(),
+                              dnums.Size()*(dnums.Size()+1)/2 * (3*sizeof(TM) + sizeof(int)));
 
     // ArrayMem<int, 50> map(dnums.Size());
     STACK_ARRAY(int, hmap, dnums.Size());
@@ -705,17 +932,100 @@ namespace ngla
     ; 
   }
 
+  template <class TM, class TV>
+  shared_ptr<BaseSparseMatrix> SparseMatrixSymmetric<TM,TV> ::
+  CreateSubMatrix (const BitArray & rowscols) const
+  {
+    return CreateSubMatrixOf (*this, rowscols);
+  }
+
+  template <class TM, class TV>
+  shared_ptr<BaseSparseMatrix> SparseMatrixSymmetric<TM,TV> ::
+  DeleteZeroElements (double tol) const
+  {
+    return DeleteZeroElementsOf (*this, tol, [] (const Array<int> & elsperrow)
+                                 { return make_shared<SparseMatrixSymmetric> (elsperrow); });
+  }
+
   template <class TM, class TV>
   void SparseMatrixSymmetric<TM,TV> :: 
   MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
     static Timer timer("SparseMatrixSymmetric::MultAdd");
     RegionTimer reg (timer);
+    CriticalWork critical;
     timer.AddFlops (2*this->nze);
+    // the lower triangle once, x and y by rows and by columns
+    Roofline::AddBytes (timer, this->nze * (sizeof(TM)+sizeof(int)) + this->Height() * (sizeof(size_t) + 2*sizeof(TV_COL) + sizeof(TV_ROW)));
 
     const FlatVector<TV_ROW> fx = x.FV<TV_ROW>();
     FlatVector<TV_COL> fy = y.FV<TV_COL>();
 
+    auto & balance = this->GetBalancing();
+    if (task_manager && balance.Size() > 1)
+      {
+        /*
+          Every task takes the rows of one block of the balancing. The
+          transposed entries of the block hit the columns of its own rows,
+          and columns before the block, from the first column of the block on.
+          These go to a buffer of the block, added up after all blocks.
+        */
+        typedef typename mat_traits<TV_COL>::TSCAL TTSCAL;
+        static auto stats = ParallelStats::GetSite ("SparseMatrixSymmetric::MultAdd");
+        ParallelStatsRegion preg(stats);
+
+        size_t nblocks = balance.Size();
+        Array<size_t> first_col(nblocks);
+        Array<Array<TV_COL>> buffers(nblocks);
+        
+        ParallelFor (nblocks, [&] (size_t k)
+                     {
+                       ParallelStatsTask ptask(stats);
+                       auto rows = balance[k];
+                       size_t first = rows.First();
+                       size_t minc = first;
+                       for (auto i : rows)
+                         if (firsti[i] < firsti[i+1])
+                           minc = min2 (minc, size_t(colnr[firsti[i]]));
+                       first_col[k] = minc;
+
+                       auto & buffer = buffers[k];
+                       buffer.SetSize (first-minc);
+                       for (auto & b : buffer)
+                         b = TTSCAL(0);
+
+                       for (size_t i : rows)
+                         {
+                           TV_COL sum = TTSCAL(0);
+                           TV_COL sxi = s * fx(i);
+                           for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+                             {
+                               size_t col = colnr[j];
+                               sum += data[j] * fx(col);
+                               if (col == i) continue;
+                               if (col >= first)
+                                 fy(col) += Trans(data[j]) * sxi;
+                               else
+                                 buffer[col-minc] += Trans(data[j]) * sxi;
+                             }
+                           fy(i) += s * sum;
+                         }
+                     });
+
+        // the buffers in a fixed order, the result does not depend on the threads
+        ParallelForRange (this->Height(), [&] (IntRange r)
+                          {
+                            for (size_t k = 0; k < nblocks; k++)
+                              {
+                                size_t first = max2 (first_col[k], r.First());
+                                size_t next = min2 (size_t(balance[k].First()), r.Next());
+                                for (size_t c = first; c < next; c++)
+                                  fy(c) += buffers[k][c-first_col[k]];
+                              }
+                          });
+        return;
+      }
+    
     for (int i = 0; i < this->Height(); i++)
       {
 	fy(i) += s * RowTimesVector (i, fx);
@@ -723,6 +1033,43 @@ namespace ngla
       }
   }
 
+  template <class TM, class TV>
+  void SparseMatrixSymmetric<TM,TV> :: 
+  MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if constexpr (is_same<TM,double>::value && is_same<TV,double>::value)
+      {
+        static Timer timer("SparseMatrixSymmetric::MultAdd MultiVector");
+        RegionTimer reg (timer);
+        size_t k = x.NumVectors();
+        timer.AddFlops (2*this->nze*k);
+        Roofline::AddBytes (timer, this->nze * (sizeof(double)+sizeof(int)) + this->Height() * (sizeof(size_t) + 3*k*sizeof(double)));
+
+        FlatMatrix<double> fx = x.FM();
+        FlatMatrix<double> fy = y.FM();
+        VectorMem<16> sum(k);
+        
+        for (size_t i = 0; i < this->Height(); i++)
+          {
+            sum = 0.0;
+            for (size_t j = this->firsti[i]; j < this->firsti[i+1]; j++)
+              {
+                double val = this->data[j];
+                size_t col = this->colnr[j];
+                for (size_t l = 0; l < k; l++)
+                  sum(l) += val * fx(l, col);
+                if (col != i)
+                  for (size_t l = 0; l < k; l++)
+                    fy(l, col) += s * val * fx(l, i);
+              }
+            for (size_t l = 0; l < k; l++)
+              fy(l, i) += s * sum(l);
+          }
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
+  }
+
   template <class TM, class TV>
   void SparseMatrixSymmetric<TM,TV> :: 
   MultAdd1 (double s, const BaseVector & x, BaseVector & y,
@@ -137,6 +137,64 @@ namespace ngla
 
 
 
+  LowRankUpdatedInverse ::
+  LowRankUpdatedInverse (shared_ptr<BaseMatrix> ainv, shared_ptr<MultiVector> au,
+                         shared_ptr<MultiVector> av)
+    : inv(ainv), u(au), v(av ? av : au), invu(au->Size(), au->NumVectors())
+  {
+    if (inv->IsComplex())
+      throw Exception ("LowRankUpdatedInverse: only real matrices");
+    if (u->Size() != size_t(inv->Width()) || v->Size() != size_t(inv->Height()))
+      throw Exception ("LowRankUpdatedInverse: vectors of size " + ToString(u->Size()) +
+                       ", matrix of size " + ToString(inv->Height()));
+    if (u->NumVectors() != v->NumVectors())
+      throw Exception ("LowRankUpdatedInverse: different number of vectors in U and V");
+    Setup();
+  }
+
+  void LowRankUpdatedInverse :: Setup ()
+  {
+    static Timer t("LowRankUpdatedInverse::Setup"); RegionTimer reg(t);
+    size_t k = u->NumVectors();
+    inv -> Mult (*u, invu);
+
+    // capacitance matrix I + V^T A^{-1} U
+    Matrix<double> cap = v->InnerProduct (invu);
+    for (size_t i = 0; i < k; i++)
+      cap(i,i) += 1;
+    CalcInverse (cap);
+    capinv.SetSize (k, k);
+    capinv = cap;
+  }
+
+  void LowRankUpdatedInverse :: Update ()
+  {
+    inv -> Update();
+    Setup();
+  }
+
+  void LowRankUpdatedInverse :: Mult (const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("LowRankUpdatedInverse::Mult"); RegionTimer reg(t);
+    size_t k = u->NumVectors();
+    t.AddFlops (4 * k * u->Size());
+
+    inv -> Mult (x, y);
+    FlatVector<double> fy = y.FVDouble();
+    Vector<double> vy = v->FM() * fy;
+    Vector<double> coefs = capinv * vy;
+    fy -= Trans(invu.FM()) * coefs;
+  }
+
+  void LowRankUpdatedInverse :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    auto hy = CreateRowVector();
+    Mult (x, hy);
+    y.Add (s, hy);
+  }
+
+
+
   template <typename TM>
   void DiagonalMatrix<TM> :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
@@ -256,12 +314,24 @@ namespace ngla
   
 
   
+  PermutationMatrix :: PermutationMatrix (const BitArray & subset)
+    : width(subset.Size())
+  {
+    ind.SetAllocSize (subset.NumSet());
+    for (size_t i = 0; i < subset.Size(); i++)
+      if (subset.Test(i))
+        ind.Append (i);
+  }
+  
   void PermutationMatrix :: Mult (const BaseVector & x, BaseVector & y) const
   {
     auto fvx = x.FV<double>();
     auto fvy = y.FV<double>();
-    for (size_t i = 0; i < ind.Size(); i++)
-      fvy(i) = fvx(ind[i]);
+    ParallelForRange (ind.Size(), [&] (IntRange r)
+                      {
+                        for (size_t i : r)
+                          fvy(i) = fvx(ind[i]);
+                      });
   }
   
   void PermutationMatrix :: MultTrans (const BaseVector & x, BaseVector & y) const
@@ -277,8 +347,11 @@ namespace ngla
   {
     auto fvx = x.FV<double>();
     auto fvy = y.FV<double>();
-    for (size_t i = 0; i < ind.Size(); i++)
-      fvy(i) += s * fvx(ind[i]);
+    ParallelForRange (ind.Size(), [&] (IntRange r)
+                      {
+                        for (size_t i : r)
+                          fvy(i) += s * fvx(ind[i]);
+                      });
   }
   
   void PermutationMatrix :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
@@ -807,5 +880,143 @@ namespace ngla
   }
 
 
+
+  BlockPreconditioner ::
+  BlockPreconditioner (shared_ptr<BlockMatrix> amat, const Array<shared_ptr<BaseMatrix>> & ainvs,
+                       TYPE atype)
+    : mat(amat), invs(ainvs), type(atype)
+  {
+    size_t n = invs.Size();
+    for (auto & inv : invs)
+      if (!inv)
+        throw Exception ("BlockPreconditioner: need an inverse for every diagonal block");
+    if (type != DIAGONAL)
+      {
+        if (!mat)
+          throw Exception ("BlockPreconditioner: triangular preconditioners need the block matrix");
+        if (mat->BlockRows() != n || mat->BlockCols() != n)
+          throw Exception ("BlockPreconditioner: " + ToString(n) + " inverses for a " +
+                           ToString(mat->BlockRows()) + "x" + ToString(mat->BlockCols()) + " block matrix");
+      }
+    res.SetSize (n);
+    for (size_t i = 0; i < n; i++)
+      res[i].AssignPointer (invs[i]->CreateColVector());
+  }
+
+  BlockPreconditioner::TYPE BlockPreconditioner :: GetType (const string & name)
+  {
+    if (name == "diagonal") return DIAGONAL;
+    if (name == "lower") return LOWER;
+    if (name == "upper") return UPPER;
+    if (name == "symmetric") return SYMMETRIC;
+    throw Exception ("BlockPreconditioner: unknown type '" + name +
+                     "', allowed are 'diagonal', 'lower', 'upper', 'symmetric'");
+  }
+
+  void BlockPreconditioner :: Mult (const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("BlockPreconditioner::Mult"); RegionTimer reg(t);
+    auto & bx = dynamic_cast_BlockVector(x);
+    auto & by = dynamic_cast_BlockVector(y);
+    int n = invs.Size();
+
+    switch (type)
+      {
+      case DIAGONAL:
+        for (int i = 0; i < n; i++)
+          invs[i] -> Mult (*bx[i], *by[i]);
+        break;
+
+      case LOWER: case SYMMETRIC:
+        for (int i = 0; i < n; i++)
+          {
+            res[i] = *bx[i];
+            for (int j = 0; j < i; j++)
+              if (auto & mij = (*mat)(i,j))
+                mij -> MultAdd (-1, *by[j], res[i]);
+            invs[i] -> Mult (res[i], *by[i]);
+          }
+        if (type == LOWER) break;
+
+        for (int i = n-2; i >= 0; i--)
+          {
+            res[i] = 0.0;
+            for (int j = i+1; j < n; j++)
+              if (auto & mij = (*mat)(i,j))
+                mij -> MultAdd (1, *by[j], res[i]);
+            invs[i] -> MultAdd (-1, res[i], *by[i]);
+          }
+        break;
+
+      case UPPER:
+        for (int i = n-1; i >= 0; i--)
+          {
+            res[i] = *bx[i];
+            for (int j = i+1; j < n; j++)
+              if (auto & mij = (*mat)(i,j))
+                mij -> MultAdd (-1, *by[j], res[i]);
+            invs[i] -> Mult (res[i], *by[i]);
+          }
+        break;
+      }
+  }
+
+  void BlockPreconditioner :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    auto hy = CreateRowVector();
+    Mult (x, hy);
+    y.Add (s, hy);
+  }
+
+  AutoVector BlockPreconditioner :: CreateRowVector () const
+  {
+    Array<shared_ptr<BaseVector>> vecs(invs.Size());
+    for (auto i : Range(invs))
+      vecs[i] = invs[i]->CreateRowVector();
+    return make_shared<BlockVector>(vecs);
+  }
+
+  AutoVector BlockPreconditioner :: CreateColVector () const
+  {
+    Array<shared_ptr<BaseVector>> vecs(invs.Size());
+    for (auto i : Range(invs))
+      vecs[i] = invs[i]->CreateColVector();
+    return make_shared<BlockVector>(vecs);
+  }
+
+
+
+  SchurComplementMatrix ::
+  SchurComplementMatrix (shared_ptr<BlockMatrix> amat, shared_ptr<BaseMatrix> ainv)
+    : mat(amat), inv(ainv)
+  {
+    if (mat->BlockRows() != 2 || mat->BlockCols() != 2)
+      throw Exception ("SchurComplementMatrix: needs a 2x2 block matrix");
+    if (!(*mat)(0,1) || !(*mat)(1,0))
+      throw Exception ("SchurComplementMatrix: needs the off-diagonal blocks");
+    hv0.AssignPointer ((*mat)(0,1)->CreateColVector());
+    hv1.AssignPointer (inv->CreateRowVector());
+  }
+
+  void SchurComplementMatrix :: Mult (const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SchurComplementMatrix::Mult"); RegionTimer reg(t);
+    (*mat)(0,1) -> Mult (x, hv0);
+    inv -> Mult (hv0, hv1);
+    (*mat)(1,0) -> Mult (hv1, y);
+    y *= -1;
+    if (auto & m11 = (*mat)(1,1))
+      m11 -> MultAdd (1, x, y);
+  }
+
+  void SchurComplementMatrix :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    (*mat)(0,1) -> Mult (x, hv0);
+    inv -> Mult (hv0, hv1);
+    (*mat)(1,0) -> MultAdd (-s, hv1, y);
+    if (auto & m11 = (*mat)(1,1))
+      m11 -> MultAdd (s, x, y);
+  }
+
   
 }
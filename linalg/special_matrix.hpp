@@ -39,6 +39,47 @@ namespace ngla
   };
 
 
+  /**
+     Inverse of the low-rank update A + U V^T from an inverse of A,
+     by the Sherman-Morrison-Woodbury formula
+       (A + U V^T)^{-1} = A^{-1} - A^{-1} U (I + V^T A^{-1} U)^{-1} V^T A^{-1}
+     A^{-1} U (one multi-rhs solve) and the inverse of the k x k
+     capacitance matrix are computed at construction, an application
+     costs one solve with A and 4kn flops.
+     Real, not distributed vectors.
+  */
+  class NGS_DLL_HEADER LowRankUpdatedInverse : public BaseMatrix
+  {
+    shared_ptr<BaseMatrix> inv;
+    shared_ptr<MultiVector> u, v;
+    /// A^{-1} U
+    MultiVector invu;
+    /// (I + V^T A^{-1} U)^{-1}
+    Matrix<double> capinv;
+
+    void Setup ();
+  public:
+    /// V = U if not given
+    LowRankUpdatedInverse (shared_ptr<BaseMatrix> ainv, shared_ptr<MultiVector> au,
+                           shared_ptr<MultiVector> av = nullptr);
+
+    bool IsComplex() const override { return false; }
+    int VHeight() const override { return inv->Height(); }
+    int VWidth() const override { return inv->Width(); }
+    AutoVector CreateRowVector () const override { return inv->CreateRowVector(); }
+    AutoVector CreateColVector () const override { return inv->CreateColVector(); }
+
+    void Mult (const BaseVector & x, BaseVector & y) const override;
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    /// updates the inverse of A, and the capacitance matrix
+    void Update () override;
+
+    shared_ptr<BaseMatrix> GetInverse () const { return inv; }
+    size_t Rank () const { return u->NumVectors(); }
+  };
+
+
   template <typename TM=double>
   class DiagonalMatrix : public BaseMatrix
   {
@@ -80,6 +121,8 @@ namespace ngla
   public:
     PermutationMatrix (size_t awidth, Array<size_t> aind)
       : width(awidth), ind(aind) { ; } 
+    /// restriction to the set bits, the transpose is the extension by zero
+    PermutationMatrix (const BitArray & subset);
 
     virtual bool IsComplex() const override { return false; } 
 
@@ -314,7 +357,7 @@ namespace ngla
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
     virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
 
-    const shared_ptr<BaseMatrix> & operator()(size_t i, size_t j)
+    const shared_ptr<BaseMatrix> & operator()(size_t i, size_t j) const
     {
       if (i >= h) throw Exception("Tried to access BlockMatrix row that is out of range");
       if (j >= w) throw Exception("Tried to access BlockMatrix col that is out of range");
@@ -330,6 +373,73 @@ namespace ngla
     virtual AutoVector CreateRowVector () const override;
     virtual AutoVector CreateColVector () const override;
   };
+
+
+  /**
+     Block preconditioners for a BlockMatrix (A_ij) from approximate
+     inverses D_i of the diagonal blocks:
+       DIAGONAL:   y_i = D_i x_i
+       LOWER:      forward substitution   y_i = D_i (x_i - sum_{j<i} A_ij y_j)
+       UPPER:      backward substitution  y_i = D_i (x_i - sum_{j>i} A_ij y_j)
+       SYMMETRIC:  approximate block LDU, forward substitution followed by
+                   y_i -= D_i sum_{j>i} A_ij y_j
+     For the saddle point problem [A B^T; B -C] with D_0 ~ A^{-1} and
+     D_1 ~ -S^{-1}, S = C + B A^{-1} B^T the Schur complement, SYMMETRIC
+     is the exact inverse for exact D_i. MinRes needs a positive
+     definite preconditioner: DIAGONAL with D_1 ~ S^{-1}.
+     The block temporaries are allocated once, the preconditioner must
+     not be applied by several threads at the same time.
+  */
+  class NGS_DLL_HEADER BlockPreconditioner : public BaseMatrix
+  {
+  public:
+    enum TYPE { DIAGONAL, LOWER, UPPER, SYMMETRIC };
+  private:
+    shared_ptr<BlockMatrix> mat;
+    Array<shared_ptr<BaseMatrix>> invs;
+    TYPE type;
+    /// one residual per block
+    Array<AutoVector> res;
+  public:
+    /// mat may be nullptr for DIAGONAL
+    BlockPreconditioner (shared_ptr<BlockMatrix> amat, const Array<shared_ptr<BaseMatrix>> & ainvs,
+                         TYPE atype = DIAGONAL);
+
+    static TYPE GetType (const string & name);
+
+    void Mult (const BaseVector & x, BaseVector & y) const override;
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    virtual int VHeight() const override { throw Exception("VHeight does not make sense for BlockPreconditioner");}
+    virtual int VWidth() const override { throw Exception("VWidth does not make sense for BlockPreconditioner");}
+    AutoVector CreateRowVector () const override;
+    AutoVector CreateColVector () const override;
+  };
+
+
+  /**
+     The Schur complement S = A_11 - A_10 D_0 A_01 of a 2x2 BlockMatrix
+     with an (approximate) inverse D_0 of A_00, applied matrix-free,
+     e.g. as the matrix of an inner Krylov solver for the Schur
+     complement. A missing block A_11 is zero.
+  */
+  class NGS_DLL_HEADER SchurComplementMatrix : public BaseMatrix
+  {
+    shared_ptr<BlockMatrix> mat;
+    shared_ptr<BaseMatrix> inv;
+    mutable AutoVector hv0, hv1;
+  public:
+    SchurComplementMatrix (shared_ptr<BlockMatrix> amat, shared_ptr<BaseMatrix> ainv);
+
+    bool IsComplex() const override { return inv->IsComplex(); }
+    int VHeight() const override { return (*mat)(1,0)->Height(); }
+    int VWidth() const override { return (*mat)(0,1)->Width(); }
+    AutoVector CreateRowVector () const override { return (*mat)(0,1)->CreateRowVector(); }
+    AutoVector CreateColVector () const override { return (*mat)(1,0)->CreateColVector(); }
+
+    void Mult (const BaseVector & x, BaseVector & y) const override;
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+  };
 }
 
 
@@ -0,0 +1,526 @@
+/**************************************************************************/
+/* File:   timestepping.cpp                                               */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+
+   Runge-Kutta type time integrators for M du/dt = f - A u
+
+*/
+
+#include <la.hpp>
+
+namespace ngla
+{
+
+  void TimeStepper :: AllocateStages (const BaseVector & u, int n)
+  {
+    if (tmp && tmp->Size() == u.Size() && tmp->EntrySize() == u.EntrySize()
+        && stages.Size() == n)
+      return;
+
+    tmp = u.CreateVector();
+    stages.SetSize (n);
+    for (auto & s : stages)
+      s = u.CreateVector();
+  }
+
+  void TimeStepper :: EvalRHS (const shared_ptr<BaseMatrix> & minv,
+                               const BaseVector & u, BaseVector & k) const
+  {
+    BaseVector & r = minv ? *tmp : k;
+    a -> Mult (u, r);
+    r.Scale (-1);
+    if (f) r.Add (1, *f);
+    if (minv) minv -> Mult (r, k);
+  }
+
+  double TimeStepper :: Integrate (BaseVector & u, double t0, double tend, double dt, int every,
+                                   const function<void(double,int)> & callback)
+  {
+    static Timer t("TimeStepper::Integrate"); RegionTimer reg(t);
+    if (dt <= 0)
+      throw Exception ("TimeStepper::Integrate: dt must be positive");
+    if (every < 1) every = 1;
+
+    int nsteps = max2 (0, int (ceil ((tend-t0)/dt - 1e-8)));
+    for (int step = 1; step <= nsteps; step++)
+      {
+        Step (u, dt);
+        if (callback && (step % every == 0 || step == nsteps))
+          callback (t0 + step * dt, step);
+      }
+    return t0 + nsteps * dt;
+  }
+
+  void TimeStepper :: LinearCombination (BaseVector & res, FlatArray<double> coefs,
+                                         FlatArray<const BaseVector*> vecs)
+  {
+    static Timer t("TimeStepper::LinearCombination"); RegionTimer reg(t);
+    size_t n = vecs.Size();
+
+    bool fused = res.GetParallelStatus() == NOT_PARALLEL;
+    for (auto v : vecs)
+      if (v->GetParallelStatus() != NOT_PARALLEL || v->FVDouble().Size() != res.FVDouble().Size())
+        fused = false;
+
+    if (!fused)
+      {
+        // start with res itself, if it is one of the vecs
+        size_t first = 0;
+        for (size_t k = 0; k < n; k++)
+          if (vecs[k] == &res) first = k;
+        if (vecs[first] == &res)
+          res.Scale (coefs[first]);
+        else
+          res.Set (coefs[first], *vecs[first]);
+        for (size_t k = 0; k < n; k++)
+          if (k != first)
+            res.Add (coefs[k], *vecs[k]);
+        return;
+      }
+
+    // coefficients are real, complex vectors are combined as double arrays
+    FlatVector<double> fres = res.FVDouble();
+    Array<double*> pvecs(n);
+    for (size_t k = 0; k < n; k++)
+      pvecs[k] = vecs[k]->FVDouble().Data();
+    double * pres = fres.Data();
+
+    ParallelForRange (fres.Size(), [&] (IntRange r)
+                      {
+                        for (auto i : r)
+                          {
+                            double sum = 0;
+                            for (size_t k = 0; k < n; k++)
+                              sum += coefs[k] * pvecs[k][i];
+                            pres[i] = sum;
+                          }
+                      });
+    t.AddFlops (2 * n * fres.Size());
+  }
+
+
+
+  ExplicitRungeKutta :: ExplicitRungeKutta (shared_ptr<BaseMatrix> aa, shared_ptr<BaseVector> af,
+                                            shared_ptr<BaseMatrix> aminv, string method)
+    : TimeStepper (aa, af), minv(aminv)
+  {
+    if (method == "euler")
+      {
+        rk_a.SetSize (1,1); rk_a = 0.0;
+        rk_b.SetSize (1); rk_b = 1.0;
+      }
+    else if (method == "heun")
+      {
+        rk_a.SetSize (2,2); rk_a = 0.0;
+        rk_a(1,0) = 1;
+        rk_b.SetSize (2); rk_b = 0.5;
+      }
+    else if (method == "rk4")
+      {
+        rk_a.SetSize (4,4); rk_a = 0.0;
+        rk_a(1,0) = 0.5;
+        rk_a(2,1) = 0.5;
+        rk_a(3,2) = 1;
+        rk_b.SetSize (4);
+        rk_b(0) = rk_b(3) = 1.0/6;
+        rk_b(1) = rk_b(2) = 1.0/3;
+      }
+    else if (method == "ssprk3")
+      {
+        rk_a.SetSize (3,3); rk_a = 0.0;
+        rk_a(1,0) = 1;
+        rk_a(2,0) = rk_a(2,1) = 0.25;
+        rk_b.SetSize (3);
+        rk_b(0) = rk_b(1) = 1.0/6;
+        rk_b(2) = 2.0/3;
+      }
+    else
+      throw Exception ("ExplicitRungeKutta: unknown method '" + method
+                       + "', available are euler, heun, rk4, ssprk3");
+  }
+
+  ExplicitRungeKutta :: ExplicitRungeKutta (shared_ptr<BaseMatrix> aa, shared_ptr<BaseVector> af,
+                                            shared_ptr<BaseMatrix> aminv,
+                                            const Matrix<> & ara, const Vector<> & arb)
+    : TimeStepper (aa, af), minv(aminv), rk_a(ara), rk_b(arb)
+  {
+    if (rk_a.Height() != rk_b.Size() || rk_a.Width() != rk_b.Size())
+      throw Exception ("ExplicitRungeKutta: tableau a must be s x s, b of size s");
+    for (size_t i = 0; i < rk_a.Height(); i++)
+      for (size_t j = i; j < rk_a.Width(); j++)
+        if (rk_a(i,j) != 0)
+          throw Exception ("ExplicitRungeKutta: tableau must be strictly lower triangular");
+  }
+
+  void ExplicitRungeKutta :: Step (BaseVector & u, double dt)
+  {
+    static Timer t("ExplicitRungeKutta::Step"); RegionTimer reg(t);
+    int ns = NumStages();
+    // k_0 ... k_{s-1}, and the stage value
+    AllocateStages (u, ns+1);
+    BaseVector & ui = *stages[ns];
+
+    Array<double> coefs(ns+1);
+    Array<const BaseVector*> vecs(ns+1);
+    for (int i = 0; i < ns; i++)
+      {
+        coefs[0] = 1; vecs[0] = &u;
+        int cnt = 1;
+        for (int j = 0; j < i; j++)
+          if (rk_a(i,j) != 0)
+            {
+              coefs[cnt] = dt * rk_a(i,j);
+              vecs[cnt] = stages[j].get();
+              cnt++;
+            }
+        if (cnt == 1)
+          EvalRHS (minv, u, *stages[i]);
+        else
+          {
+            LinearCombination (ui, coefs.Range(0,cnt), vecs.Range(0,cnt));
+            EvalRHS (minv, ui, *stages[i]);
+          }
+      }
+
+    coefs[0] = 1; vecs[0] = &u;
+    int cnt = 1;
+    for (int i = 0; i < ns; i++)
+      if (rk_b(i) != 0)
+        {
+          coefs[cnt] = dt * rk_b(i);
+          vecs[cnt] = stages[i].get();
+          cnt++;
+        }
+    LinearCombination (u, coefs.Range(0,cnt), vecs.Range(0,cnt));
+  }
+
+
+
+  RungeKuttaChebyshev :: RungeKuttaChebyshev (shared_ptr<BaseMatrix> aa, shared_ptr<BaseVector> af,
+                                              shared_ptr<BaseMatrix> aminv, int as, double adamping)
+    : TimeStepper (aa, af), minv(aminv), s(as), damping(adamping)
+  {
+    if (s < 1)
+      throw Exception ("RungeKuttaChebyshev: need at least one stage");
+
+    // Chebyshev polynomials T_j and derivatives at w0
+    w0 = 1 + damping / (s*s);
+    Array<double> T(s+1), dT(s+1);
+    T[0] = 1; dT[0] = 0;
+    T[1] = w0; dT[1] = 1;
+    for (int j = 2; j <= s; j++)
+      {
+        T[j] = 2*w0*T[j-1] - T[j-2];
+        dT[j] = 2*T[j-1] + 2*w0*dT[j-1] - dT[j-2];
+      }
+    w1 = T[s] / dT[s];
+
+    // Y_j = mu_j Y_{j-1} + nu_j Y_{j-2} + mut_j dt F(Y_{j-1}),  Y_s = T_s(w0 + w1 z) / T_s(w0) u
+    mu.SetSize (s+1); nu.SetSize (s+1); mut.SetSize (s+1);
+    mu = 0; nu = 0; mut = 0;
+    mut[1] = w1 / w0;
+    for (int j = 2; j <= s; j++)
+      {
+        mu[j] = 2 * w0 * T[j-1] / T[j];
+        nu[j] = -T[j-2] / T[j];
+        mut[j] = 2 * w1 * T[j-1] / T[j];
+      }
+  }
+
+  double RungeKuttaChebyshev :: GetStabilityBound () const
+  {
+    // w0 + w1 z = -1
+    return (1 + w0) / w1;
+  }
+
+  void RungeKuttaChebyshev :: Step (BaseVector & u, double dt)
+  {
+    static Timer t("RungeKuttaChebyshev::Step"); RegionTimer reg(t);
+    // two stage values and the right hand side, independent of s
+    AllocateStages (u, 3);
+    BaseVector & k = *stages[2];
+
+    EvalRHS (minv, u, k);
+    Array<double> coefs { 1, mut[1]*dt };
+    Array<const BaseVector*> vecs { &u, &k };
+    LinearCombination (*stages[0], coefs, vecs);
+
+    const BaseVector * yjm2 = &u;
+    BaseVector * yjm1 = stages[0].get();
+    for (int j = 2; j <= s; j++)
+      {
+        EvalRHS (minv, *yjm1, k);
+        // Y_{j-2} is not needed anymore and is overwritten, but u is kept
+        BaseVector * yj = (yjm2 == &u) ? stages[1].get() : const_cast<BaseVector*> (yjm2);
+        Array<double> cj { mu[j], nu[j], mut[j]*dt };
+        Array<const BaseVector*> vj { yjm1, yjm2, &k };
+        LinearCombination (*yj, cj, vj);
+        yjm2 = yjm1;
+        yjm1 = yj;
+      }
+    u.Set (1, *yjm1);
+  }
+
+
+
+  IMEXRungeKutta :: IMEXRungeKutta (shared_ptr<BaseMatrix> am, shared_ptr<BaseMatrix> aa,
+                                    shared_ptr<BaseMatrix> aaim, shared_ptr<BaseMatrix> ainv,
+                                    shared_ptr<BaseVector> af, string method)
+    : TimeStepper (aa, af), m(am), aim(aaim), inv(ainv)
+  {
+    // stage 0 is u_n, the last stage is u_{n+1}
+    if (method == "euler")
+      {
+        gamma = 1;
+        a_ex.SetSize (2,2); a_ex = 0.0;
+        a_im.SetSize (2,2); a_im = 0.0;
+        a_ex(1,0) = 1;
+        a_im(1,1) = 1;
+      }
+    else if (method == "ars222")
+      {
+        // Ascher, Ruuth, Spiteri, 1997
+        gamma = 1 - 1/sqrt(2.0);
+        double delta = 1 - 1/(2*gamma);
+        a_ex.SetSize (3,3); a_ex = 0.0;
+        a_im.SetSize (3,3); a_im = 0.0;
+        a_ex(1,0) = gamma;
+        a_ex(2,0) = delta;
+        a_ex(2,1) = 1-delta;
+        a_im(1,1) = gamma;
+        a_im(2,1) = 1-gamma;
+        a_im(2,2) = gamma;
+      }
+    else
+      throw Exception ("IMEXRungeKutta: unknown method '" + method
+                       + "', available are euler, ars222");
+  }
+
+  void IMEXRungeKutta :: Step (BaseVector & u, double dt)
+  {
+    static Timer t("IMEXRungeKutta::Step"); RegionTimer reg(t);
+    if (!inv)
+      throw Exception ("IMEXRungeKutta: no inverse of M + gamma dt Aim provided");
+
+    int ns = NumStages();
+    bool realloc = !mu || mu->Size() != u.Size() || mu->EntrySize() != u.EntrySize();
+    AllocateStages (u, ns);
+    if (realloc)
+      {
+        mu = u.CreateVector();
+        kex.SetSize (ns);
+        kim.SetSize (ns);
+        for (int i = 0; i < ns; i++)
+          {
+            kex[i] = u.CreateVector();
+            kim[i] = u.CreateVector();
+          }
+      }
+
+    m -> Mult (u, *mu);
+
+    Array<const BaseVector*> U(ns);
+    Array<double> coefs(2*ns+1);
+    Array<const BaseVector*> vecs(2*ns+1);
+    U[0] = &u;
+    for (int i = 0; i < ns; i++)
+      {
+        if (i > 0)
+          {
+            // (M + gamma dt Aim) U_i = M u + dt sum_j<i  a_ex(i,j) Kex_j + a_im(i,j) Kim_j
+            coefs[0] = 1; vecs[0] = mu.get();
+            int cnt = 1;
+            for (int j = 0; j < i; j++)
+              {
+                if (a_ex(i,j) != 0)
+                  {
+                    coefs[cnt] = dt * a_ex(i,j);
+                    vecs[cnt++] = kex[j].get();
+                  }
+                if (a_im(i,j) != 0)
+                  {
+                    coefs[cnt] = dt * a_im(i,j);
+                    vecs[cnt++] = kim[j].get();
+                  }
+              }
+            LinearCombination (*tmp, coefs.Range(0,cnt), vecs.Range(0,cnt));
+            inv -> Mult (*tmp, *stages[i]);
+            U[i] = stages[i].get();
+          }
+
+        bool needex = false, needim = false;
+        for (int l = i+1; l < ns; l++)
+          {
+            if (a_ex(l,i) != 0) needex = true;
+            if (a_im(l,i) != 0) needim = true;
+          }
+        if (needex)
+          {
+            a -> Mult (*U[i], *kex[i]);
+            kex[i] -> Scale (-1);
+            if (f) kex[i] -> Add (1, *f);
+          }
+        if (needim)
+          {
+            aim -> Mult (*U[i], *kim[i]);
+            kim[i] -> Scale (-1);
+          }
+      }
+    u.Set (1, *U[ns-1]);
+  }
+
+
+
+
+  GeneralizedAlpha :: GeneralizedAlpha (shared_ptr<BaseMatrix> am, shared_ptr<BaseMatrix> ac,
+                                        shared_ptr<BaseMatrix> ak,
+                                        double rho_inf, shared_ptr<BitArray> afreedofs)
+    : m(am), c(ac), k(ak), freedofs(afreedofs)
+  {
+    if (rho_inf < 0 || rho_inf > 1)
+      throw Exception ("GeneralizedAlpha: rho_inf must be in [0,1]");
+    double am_ = (2*rho_inf-1) / (rho_inf+1);
+    double af_ = rho_inf / (rho_inf+1);
+    SetParameters (am_, af_, 0.25 * sqr(1-am_+af_), 0.5-am_+af_);
+  }
+
+  void GeneralizedAlpha :: SetParameters (double aalpha_m, double aalpha_f, double abeta, double agamma)
+  {
+    alpha_m = aalpha_m;
+    alpha_f = aalpha_f;
+    beta = abeta;
+    gamma = agamma;
+    dt = -1;   // effective matrix has to be rebuilt
+  }
+
+  void GeneralizedAlpha :: AddSource (shared_ptr<BaseVector> f, function<double(double)> g)
+  {
+    sources.Append (f);
+    source_coefs.Append (g);
+  }
+
+  Vec<3> GeneralizedAlpha :: GetEffectiveCoefficients (double adt) const
+  {
+    return Vec<3> (1-alpha_m, (1-alpha_f) * gamma * adt, (1-alpha_f) * beta * adt * adt);
+  }
+
+  void GeneralizedAlpha :: SetInverse (shared_ptr<BaseMatrix> ainv, double adt)
+  {
+    inv = ainv;
+    dt = adt;
+    user_inverse = true;
+  }
+
+  void GeneralizedAlpha :: SetTimeStep (double adt)
+  {
+    if (adt == dt && inv) return;
+    if (user_inverse)
+      throw Exception ("GeneralizedAlpha: the inverse was set for dt = " + ToString(dt)
+                       + ", call SetInverse for dt = " + ToString(adt));
+
+    static Timer t("GeneralizedAlpha::Factor"); RegionTimer reg(t);
+    auto spk = dynamic_pointer_cast<BaseSparseMatrix> (k);
+    auto spm = dynamic_pointer_cast<BaseSparseMatrix> (m);
+    auto spc = dynamic_pointer_cast<BaseSparseMatrix> (c);
+    if (!spk || !spm || (c && !spc)
+        || spm->NZE() != spk->NZE() || (spc && spc->NZE() != spk->NZE()))
+      throw Exception ("GeneralizedAlpha: M, C and K need to be sparse matrices of the same pattern, "
+                       "otherwise provide the inverse of the effective matrix by SetInverse");
+
+    Vec<3> coefs = GetEffectiveCoefficients (adt);
+    if (!summat)
+      summat = k->CreateMatrix();
+    auto & sv = summat->AsVector();
+    sv.Set (coefs(2), k->AsVector());
+    sv.Add (coefs(0), m->AsVector());
+    if (c) sv.Add (coefs(1), c->AsVector());
+
+    auto fact = dynamic_pointer_cast<SparseFactorization> (inv);
+    if (fact && fact->SupportsUpdate())
+      fact -> Update();   // same pattern, keeps the ordering
+    else
+      inv = summat->InverseMatrix (freedofs);
+    dt = adt;
+  }
+
+  void GeneralizedAlpha :: Step (BaseVector & u, BaseVector & v, BaseVector & a, double t, double adt)
+  {
+    static Timer tstep("GeneralizedAlpha::Step"); RegionTimer reg(tstep);
+    static Timer tres("GeneralizedAlpha::Residual");
+    static Timer tsolve("GeneralizedAlpha::Solve");
+    static Timer tupdate("GeneralizedAlpha::Update");
+
+    SetTimeStep (adt);
+    if (!wu || wu->Size() != u.Size())
+      {
+        wu = u.CreateVector();
+        wv = u.CreateVector();
+        rhs = u.CreateVector();
+        anew = u.CreateVector();
+      }
+
+    double af = alpha_f, am = alpha_m;
+    double dt2 = adt*adt;
+
+    // displacement and velocity at t_{n+1-alpha_f}, using the predictors
+    tres.Start();
+    Array<double> cu { 1, (1-af)*adt, (1-af)*dt2*(0.5-beta) };
+    Array<const BaseVector*> vu { &u, &v, &a };
+    TimeStepper::LinearCombination (*wu, cu, vu);
+
+    // rhs = f - alpha_m M a - C wv - K wu
+    k -> Mult (*wu, *rhs);
+    rhs -> Scale (-1);
+    if (am != 0)
+      m -> MultAdd (-am, a, *rhs);
+    if (c)
+      {
+        Array<double> cv { 1, (1-af)*adt*(1-gamma) };
+        Array<const BaseVector*> vv { &v, &a };
+        TimeStepper::LinearCombination (*wv, cv, vv);
+        c -> MultAdd (-1, *wv, *rhs);
+      }
+    double tf = t + (1-af) * adt;
+    for (size_t i = 0; i < sources.Size(); i++)
+      rhs -> Add (source_coefs[i] ? source_coefs[i](tf) : 1.0, *sources[i]);
+    tres.Stop();
+
+    tsolve.Start();
+    inv -> Mult (*rhs, *anew);
+    tsolve.Stop();
+
+    tupdate.Start();
+    Array<double> cu1 { 1, adt, dt2*(0.5-beta), dt2*beta };
+    Array<const BaseVector*> vu1 { &u, &v, &a, anew.get() };
+    TimeStepper::LinearCombination (u, cu1, vu1);
+    Array<double> cv1 { 1, adt*(1-gamma), adt*gamma };
+    Array<const BaseVector*> vv1 { &v, &a, anew.get() };
+    TimeStepper::LinearCombination (v, cv1, vv1);
+    a.Set (1, *anew);
+    tupdate.Stop();
+  }
+
+  double GeneralizedAlpha :: Integrate (BaseVector & u, BaseVector & v, BaseVector & a,
+                                        double t0, double tend, double adt, int every,
+                                        const function<void(double,int)> & callback)
+  {
+    static Timer t("GeneralizedAlpha::Integrate"); RegionTimer reg(t);
+    if (adt <= 0)
+      throw Exception ("GeneralizedAlpha::Integrate: dt must be positive");
+    if (every < 1) every = 1;
+
+    int nsteps = max2 (0, int (ceil ((tend-t0)/adt - 1e-8)));
+    for (int step = 1; step <= nsteps; step++)
+      {
+        Step (u, v, a, t0 + (step-1) * adt, adt);
+        if (callback && (step % every == 0 || step == nsteps))
+          callback (t0 + step * adt, step);
+      }
+    return t0 + nsteps * adt;
+  }
+
+}
@@ -0,0 +1,198 @@
+#ifndef FILE_TIMESTEPPING
+#define FILE_TIMESTEPPING
+
+/**************************************************************************/
+/* File:   timestepping.hpp                                               */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+namespace ngla
+{
+
+  /**
+     Time integrator for the semi-discrete system
+
+         M du/dt = f - A u
+
+     The stage vectors are allocated at the first step and reused,
+     linear combinations of stage vectors are done in one pass.
+     The right hand side f is constant in time.
+  */
+  class NGS_DLL_HEADER TimeStepper
+  {
+  protected:
+    shared_ptr<BaseMatrix> a;
+    shared_ptr<BaseVector> f;
+    /// stage vectors, allocated by AllocateStages
+    Array<shared_ptr<BaseVector>> stages;
+    shared_ptr<BaseVector> tmp;
+
+    void AllocateStages (const BaseVector & u, int n);
+    /// k = M^{-1} (f - A u), minv == nullptr means identity
+    void EvalRHS (const shared_ptr<BaseMatrix> & minv, const BaseVector & u, BaseVector & k) const;
+  public:
+    TimeStepper (shared_ptr<BaseMatrix> aa, shared_ptr<BaseVector> af)
+      : a(aa), f(af) { ; }
+    virtual ~TimeStepper () { ; }
+
+    /// one time step of size dt, u is overwritten
+    virtual void Step (BaseVector & u, double dt) = 0;
+
+    /**
+       fixed time steps of size dt from t0 until tend is reached,
+       the callback gets time and step number, it is called
+       every 'every' steps and after the last step. Returns the final time.
+    */
+    double Integrate (BaseVector & u, double t0, double tend, double dt, int every = 1,
+                      const function<void(double,int)> & callback = nullptr);
+
+    /// res = sum_i coefs[i] * vecs[i], res may be one of the vecs
+    static void LinearCombination (BaseVector & res, FlatArray<double> coefs,
+                                   FlatArray<const BaseVector*> vecs);
+  };
+
+
+  /**
+     Explicit Runge-Kutta method given by its Butcher tableau.
+     du/dt = M^{-1} (f - A u), minv is the inverse mass matrix (or nullptr)
+  */
+  class NGS_DLL_HEADER ExplicitRungeKutta : public TimeStepper
+  {
+  protected:
+    shared_ptr<BaseMatrix> minv;
+    Matrix<> rk_a;
+    Vector<> rk_b;
+  public:
+    /// method = euler, heun, rk4, ssprk3
+    ExplicitRungeKutta (shared_ptr<BaseMatrix> aa, shared_ptr<BaseVector> af,
+                        shared_ptr<BaseMatrix> aminv, string method = "rk4");
+    ExplicitRungeKutta (shared_ptr<BaseMatrix> aa, shared_ptr<BaseVector> af,
+                        shared_ptr<BaseMatrix> aminv, const Matrix<> & ara, const Vector<> & arb);
+
+    int NumStages () const { return rk_b.Size(); }
+    void Step (BaseVector & u, double dt) override;
+  };
+
+
+  /**
+     First order damped Runge-Kutta-Chebyshev method with s stages.
+     Stable for dt * lambda_max(M^{-1}A) <= GetStabilityBound(),
+     which grows with s^2. Needs 3 vectors independent of s.
+  */
+  class NGS_DLL_HEADER RungeKuttaChebyshev : public TimeStepper
+  {
+  protected:
+    shared_ptr<BaseMatrix> minv;
+    int s;
+    double damping;
+    /// stability polynomial T_s(w0 + w1 z) / T_s(w0)
+    double w0, w1;
+    /// recurrence coefficients mu_j, nu_j, mut_j (j = 1...s)
+    Array<double> mu, nu, mut;
+  public:
+    RungeKuttaChebyshev (shared_ptr<BaseMatrix> aa, shared_ptr<BaseVector> af,
+                         shared_ptr<BaseMatrix> aminv, int as, double adamping = 0.05);
+
+    int NumStages () const { return s; }
+    /// length of the real stability interval
+    double GetStabilityBound () const;
+    void Step (BaseVector & u, double dt) override;
+  };
+
+
+  /**
+     IMEX Runge-Kutta method for
+
+         M du/dt = f - A u - Aim u
+
+     A is treated explicitly, Aim implicitly. Every stage solves with
+     M + gamma dt Aim, its inverse inv has to be provided for the dt used.
+     The implemented schemes are stiffly accurate, u_new is the last stage.
+  */
+  class NGS_DLL_HEADER IMEXRungeKutta : public TimeStepper
+  {
+  protected:
+    shared_ptr<BaseMatrix> m, aim, inv;
+    Matrix<> a_ex, a_im;
+    double gamma;
+    /// explicit and implicit stage right hand sides
+    Array<shared_ptr<BaseVector>> kex, kim;
+    shared_ptr<BaseVector> mu;
+  public:
+    /// method = euler (gamma = 1), ars222 (gamma = 1-1/sqrt(2))
+    IMEXRungeKutta (shared_ptr<BaseMatrix> am, shared_ptr<BaseMatrix> aa,
+                    shared_ptr<BaseMatrix> aaim, shared_ptr<BaseMatrix> ainv,
+                    shared_ptr<BaseVector> af, string method = "ars222");
+
+    double GetGamma () const { return gamma; }
+    int NumStages () const { return a_ex.Height(); }
+    void SetInverse (shared_ptr<BaseMatrix> ainv) { inv = ainv; }
+    void Step (BaseVector & u, double dt) override;
+  };
+
+
+  /**
+     Generalized-alpha method (Chung-Hulbert) for
+
+         M a + C v + K u = sum_i g_i(t) f_i
+
+     Every step solves with the effective matrix
+          S = cm M + cc C + ck K,  (cm,cc,ck) = GetEffectiveCoefficients(dt).
+     For sparse M, C, K of the same pattern S is assembled and factored
+     by the integrator, a change of dt refactors numerically with the
+     same ordering if the factorization supports it. For matrix-free M, C
+     the inverse of S is given by SetInverse.
+  */
+  class NGS_DLL_HEADER GeneralizedAlpha
+  {
+  protected:
+    shared_ptr<BaseMatrix> m, c, k;
+    shared_ptr<BitArray> freedofs;
+    double alpha_m, alpha_f, beta, gamma;
+
+    /// time step of the current factorization
+    double dt = -1;
+    shared_ptr<BaseMatrix> summat, inv;
+    bool user_inverse = false;
+
+    Array<shared_ptr<BaseVector>> sources;
+    Array<function<double(double)>> source_coefs;
+
+    shared_ptr<BaseVector> wu, wv, rhs, anew;
+  public:
+    /// rho_inf in [0,1] is the spectral radius at infinity, 1 means no numerical damping
+    GeneralizedAlpha (shared_ptr<BaseMatrix> am, shared_ptr<BaseMatrix> ac, shared_ptr<BaseMatrix> ak,
+                      double rho_inf = 1, shared_ptr<BitArray> afreedofs = nullptr);
+
+    void SetParameters (double aalpha_m, double aalpha_f, double abeta, double agamma);
+    /// Newmark average acceleration: alpha_m = alpha_f = 0, beta = 1/4, gamma = 1/2
+    void SetNewmark () { SetParameters (0, 0, 0.25, 0.5); }
+    double GetAlphaM () const { return alpha_m; }
+    double GetAlphaF () const { return alpha_f; }
+    double GetBeta () const { return beta; }
+    double GetGamma () const { return gamma; }
+
+    /// source g(t) f, g == nullptr means g = 1
+    void AddSource (shared_ptr<BaseVector> f, function<double(double)> g = nullptr);
+
+    /// (cm, cc, ck) of the effective matrix
+    Vec<3> GetEffectiveCoefficients (double adt) const;
+    /// inverse of the effective matrix for time step adt
+    void SetInverse (shared_ptr<BaseMatrix> ainv, double adt);
+    /// assembles and factors the effective matrix if dt changed
+    void SetTimeStep (double adt);
+    shared_ptr<BaseMatrix> GetInverse () const { return inv; }
+
+    /// one step from t to t+dt, (u, v, a) are overwritten
+    void Step (BaseVector & u, BaseVector & v, BaseVector & a, double t, double adt);
+
+    /// fixed steps as TimeStepper::Integrate, returns the final time
+    double Integrate (BaseVector & u, BaseVector & v, BaseVector & a,
+                      double t0, double tend, double adt, int every = 1,
+                      const function<void(double,int)> & callback = nullptr);
+  };
+
+}
+
+#endif
@@ -403,6 +403,47 @@ namespace ngla
 
 
 
+  template<class TM, class TV_ROW, class TV_COL>
+  void UmfpackInverse<TM,TV_ROW,TV_COL> ::
+  MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if constexpr (is_same<TVX,double>::value)
+      {
+        static Timer timer("Umfpack Solve MultiVector");
+        RegionTimer reg (timer);
+        if (x.NumVectors() != y.NumVectors())
+          throw Exception ("UmfpackInverse::MultAdd (MultiVector): different number of vectors");
+
+        FlatMatrix<double> fx = x.FM();
+        FlatMatrix<double> fy = y.FM();
+        double *data = reinterpret_cast<double *>(&this->values[0]);
+
+        // the numeric factorization is read only in the solve, every task has its own work arrays
+        ParallelForRange
+          (x.NumVectors(), [&] (IntRange r)
+           {
+             Vector<double> hx(compressed_height), hy(compressed_height);
+             Array<SuiteSparse_long> wi(compressed_height);
+             // with iterative refinement
+             Vector<double> w(5*compressed_height);
+             for (auto l : r)
+               {
+                 for (int i : Range(compress.Size()))
+                   hx(i) = fx(l, compress[i]);
+                 int status = umfpack_dl_wsolve (UMFPACK_Aat, &rowstart[0], &indices[0], data, &hy(0), &hx(0),
+                                                 this->Numeric, nullptr, nullptr, &wi[0], &w(0));
+                 if (status != UMFPACK_OK)
+                   throw Exception("UmfpackInverse: Solve failed.");
+                 for (int i : Range(compress.Size()))
+                   fy(l, compress[i]) += s * hy(i);
+               }
+           });
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
+  }
+
+
   template<class TM, class TV_ROW, class TV_COL>
   void UmfpackInverse<TM,TV_ROW,TV_COL> ::
   MultTrans (const BaseVector & x, BaseVector & y) const
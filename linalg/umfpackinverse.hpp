@@ -109,6 +109,8 @@ namespace ngla
     ///
     void Mult (const BaseVector & x, BaseVector & y) const override;
     void MultTrans (const BaseVector & x, BaseVector & y) const override;
+    /// the vectors are solved in parallel, with preallocated work arrays (real matrix and vectors)
+    void MultAdd (double s, const MultiVector & x, MultiVector & y) const override;
     ///
     AutoVector CreateRowVector () const override { return make_shared<VVector<TV>> (height/entrysize); }
     AutoVector CreateColVector () const override { return make_shared<VVector<TV>> (height/entrysize); }
@@ -33,6 +33,7 @@ namespace ngla
       pdata = new TSCAL[as*aes];
       ownmem = true;
       this->entrysize = es * sizeof(TSCAL) / sizeof(double);
+      FirstTouch();
     }
 
     void SetSize (size_t as)
@@ -41,8 +42,12 @@ namespace ngla
       this->size = as;
       pdata = new TSCAL[as*es];
       ownmem = true;
+      FirstTouch();
     }
 
+    /// zero large vectors with the splitting of the vector kernels (numa first touch)
+    void FirstTouch ();
+
     void AssignMemory (size_t as, void * adata)
     {
       this->size = as; 
@@ -70,6 +75,11 @@ namespace ngla
 
     virtual AutoVector CreateVector () const override;
 
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w) override;
+    virtual BaseVector & Add2 (double scal1, const BaseVector & v1,
+                               double scal2, const BaseVector & v2) override;
+    virtual void InnerProductsD (FlatArray<const BaseVector*> v, FlatVector<double> res) const override;
+
     virtual ostream & Print (ostream & ost) const override;
   };
 
@@ -83,7 +83,7 @@ namespace ngmg
 
   void MultigridPreconditioner :: Update ()
   {
-    bool haveall;
+    bool haveall = true;
     for (int i = 0; i < biform.GetNLevels(); i++)
       if (!biform.GetMatrixPtr(i)) haveall = false;
     if (!haveall && biform.GetNLevels() > 1 && biform.GetMatrixPtr())
@@ -169,6 +169,38 @@ namespace ngmg
 #endif
    }
 
+  void MultigridPreconditioner :: SetStatistics (bool stat)
+  {
+    collect_statistics = stat;
+    if (stat) PrepareStatistics();
+  }
+
+  void MultigridPreconditioner :: ResetStatistics ()
+  {
+    statistics.SetSize0();
+    if (collect_statistics) PrepareStatistics();
+  }
+
+  void MultigridPreconditioner :: PrepareStatistics () const
+  {
+    static const char * phase_names[MG_NPHASES] =
+      { "smoothing", "residual", "restriction", "prolongation", "coarse solve" };
+
+    size_t nlevels = ma.GetNLevels();
+    size_t oldsize = statistics.Size();
+    statistics.SetSize (nlevels);
+    for (size_t l = oldsize; l < nlevels; l++)
+      statistics[l] = MGLevelStatistics();
+    for (size_t l = 0; l < nlevels; l++)
+      statistics[l].ndof = fespace.GetNDofLevel(l);
+
+    for (size_t l = statistics_timers.Size()/MG_NPHASES; l < nlevels; l++)
+      for (int ph = 0; ph < MG_NPHASES; ph++)
+        statistics_timers.Append
+          (NgProfiler::CreateTimer ("MG level " + ToString(l) + " " + phase_names[ph]));
+  }
+  
+  
   void MultigridPreconditioner ::
   Mult (const BaseVector & x, BaseVector & y) const
   {
@@ -177,6 +209,8 @@ namespace ngmg
 
     try
       {
+        if (collect_statistics && statistics.Size() != size_t(ma.GetNLevels()))
+          PrepareStatistics();
 	y = 0;
 	MGM (ma.GetNLevels()-1, y, x);
       }
@@ -196,8 +230,59 @@ namespace ngmg
   MGM (int level, BaseVector & u, 
        const BaseVector & f, int incsm) const
   {
+    MGLevelStatistics * stat = collect_statistics ? &statistics[level] : nullptr;
+
+    // timing of one phase, to NgProfiler and the level statistics
+    auto phase = [&] (MG_PHASE ph, auto func)
+      {
+        if (!stat)
+          {
+            func();
+            return;
+          }
+        int nr = statistics_timers[MG_NPHASES*level+ph];
+        NgProfiler::StartTimer (nr);
+        double starttime = WallTime();
+        func();
+        stat->time[ph] += WallTime()-starttime;
+        NgProfiler::StopTimer (nr);
+      };
+
+    // a smoothing step or residual costs about one pass over the matrix
+    auto sweep_work = [&] (MG_PHASE ph, int sweeps)
+      {
+        if (!stat) return;
+        size_t es = f.EntrySize();
+        double nze = stat->ndof * es;
+        if (auto spmat = dynamic_cast<const BaseSparseMatrix*> (&biform.GetMatrix(level)))
+          nze = spmat->NZE() * es * es;
+        double flops = 2 * sweeps * nze;
+        stat->flops += flops;
+        stat->bytes += sweeps * (nze * (sizeof(double)+sizeof(int)) + 3 * stat->ndof * es * sizeof(double));
+        NgProfiler::AddFlops (statistics_timers[MG_NPHASES*level+ph], flops);
+      };
+
+    // per fine node two values, two parents and two weights are read, one value written
+    auto transfer_work = [&] (MG_PHASE ph)
+      {
+        if (!stat) return;
+        size_t es = f.EntrySize();
+        double nfine = (stat->ndof - statistics[level-1].ndof) * es;
+        stat->flops += 3 * nfine;
+        stat->bytes += nfine * (3*sizeof(double) + 2*sizeof(int) + 2*sizeof(double));
+        NgProfiler::AddFlops (statistics_timers[MG_NPHASES*level+ph], 3 * nfine);
+      };
+
+    if (stat)
+      {
+        stat->visits++;
+        stat->res_in = L2Norm (f);
+      }
+    
     if (level <= 0 )
       {
+        phase (MG_COARSE, [&] ()
+          {
 	switch (coarsetype)
 	  {
 	  case EXACT_COARSE:
@@ -231,14 +316,25 @@ namespace ngmg
 	      break;
 	    }
 	  }
+          });
+        if (stat)
+          {
+            auto d = smoother->CreateVector(0);
+            smoother->Residuum (level, u, f, d);
+            stat->res_presmooth = stat->res_out = L2Norm (d);
+          }
       }
     else 
       {
 
 	if (cycle == 0)
 	  {
-	    smoother->PreSmooth (level, u, f, smoothingsteps * incsm);
-	    smoother->PostSmooth (level, u, f, smoothingsteps * incsm);
+            phase (MG_SMOOTH, [&] ()
+              {
+                smoother->PreSmooth (level, u, f, smoothingsteps * incsm);
+                smoother->PostSmooth (level, u, f, smoothingsteps * incsm);
+              });
+            sweep_work (MG_SMOOTH, 2 * smoothingsteps * incsm);
 	  }
 
 	else
@@ -249,7 +345,17 @@ namespace ngmg
 	    //       << " w.Size() " << w.Size() << endl;
 
 	    // smoother->PreSmooth (level, u, f, smoothingsteps * incsm);
-	    smoother->PreSmoothResiduum (level, u, f, *d, smoothingsteps * incsm);
+            if (!stat)
+              smoother->PreSmoothResiduum (level, u, f, *d, smoothingsteps * incsm);
+            else
+              {
+                // separately, to see the costs of both
+                phase (MG_SMOOTH, [&] () { smoother->PreSmooth (level, u, f, smoothingsteps * incsm); });
+                sweep_work (MG_SMOOTH, smoothingsteps * incsm);
+                phase (MG_RESIDUAL, [&] () { smoother->Residuum (level, u, f, *d); });
+                sweep_work (MG_RESIDUAL, 1);
+                stat->res_presmooth = L2Norm (*d);
+              }
 	    
 	    auto dt = d.Range (0, fespace.GetNDofLevel(level-1));
 	    auto wt = w.Range (0, fespace.GetNDofLevel(level-1));
@@ -262,13 +368,18 @@ namespace ngmg
 	    u.Range (0,w.Size()) += w;
 	    smoother->Residuum (level, u, f, d);
 	    */
-	    prolongation->RestrictInline (level, d);
+            phase (MG_RESTRICT, [&] () { prolongation->RestrictInline (level, d); });
+            transfer_work (MG_RESTRICT);
 	    w = 0;
 	    for (int j = 1; j <= cycle; j++)
 	      MGM (level-1, wt, dt, incsm * incsmooth);
 	    
-	    prolongation->ProlongateInline (level, w);
-	    u += w;
+            phase (MG_PROLONGATE, [&] ()
+              {
+                prolongation->ProlongateInline (level, w);
+                u += w;
+              });
+            transfer_work (MG_PROLONGATE);
 
 	    /*
 	    smoother->Residuum (level, u, f, d);
@@ -276,9 +387,16 @@ namespace ngmg
 	    u.Range (0,w.Size()) += w;
 	    */
 
-	    smoother->PostSmooth (level, u, f, smoothingsteps * incsm);
+            phase (MG_SMOOTH, [&] () { smoother->PostSmooth (level, u, f, smoothingsteps * incsm); });
+            sweep_work (MG_SMOOTH, smoothingsteps * incsm);
 	  }
 
+        if (stat)
+          {
+            auto d = smoother->CreateVector(level);
+            smoother->Residuum (level, u, f, d);
+            stat->res_out = L2Norm (d);
+          }
       }
   }
 
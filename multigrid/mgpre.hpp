@@ -20,6 +20,27 @@ namespace ngmg
   class Prolongation;
 
 
+  /// phases of the multigrid cycle
+  enum MG_PHASE { MG_SMOOTH, MG_RESIDUAL, MG_RESTRICT, MG_PROLONGATE, MG_COARSE, MG_NPHASES };
+
+  /**
+     Per level data of the multigrid cycles, collected if
+     statistics are enabled. Times and work are summed up over all
+     visits, the residual norms are from the last visit.
+  */
+  struct MGLevelStatistics
+  {
+    size_t ndof = 0;
+    /// number of visits of the level
+    int visits = 0;
+    /// wall clock time per MG_PHASE
+    double time[MG_NPHASES] = { 0 };
+    /// estimated work of smoother, residual and transfer
+    double flops = 0, bytes = 0;
+    /// |f| at entry, |f-Au| after pre-smoothing and after the cycle on this level
+    double res_in = 0, res_presmooth = 0, res_out = 0;
+  };
+
   ///
   class NGS_DLL_HEADER MultigridPreconditioner : public BaseMatrix
   {
@@ -56,6 +77,13 @@ namespace ngmg
     bool update_always; 
     /// for robust prolongation
     // Array<BaseMatrix*> prol_projection;
+
+    bool collect_statistics = false;
+    mutable Array<MGLevelStatistics> statistics;
+    /// NgProfiler timers, MG_NPHASES per level
+    mutable Array<int> statistics_timers;
+    /// sizes the statistics for the current number of levels
+    void PrepareStatistics () const;
   public:
     ///
     MultigridPreconditioner (const MeshAccess & ama,
@@ -87,6 +115,13 @@ namespace ngmg
     ///
     virtual void Update () override;
 
+    /// per level timings, work estimates and residuals, costs one extra residual per level
+    void SetStatistics (bool stat = true);
+    bool GetStatistics () const { return collect_statistics; }
+    void ResetStatistics ();
+    /// per level data since the last reset, level 0 is the coarsest
+    FlatArray<MGLevelStatistics> GetLevelStatistics () const { return statistics; }
+
     ///
     virtual void Mult (const BaseVector & x, BaseVector & y) const override;
 
@@ -23,6 +23,157 @@ namespace ngmg
     ;
   }
 
+  void ParentTable :: Build (size_t anc, size_t anf,
+                             FlatArray<int> p0, FlatArray<int> p1,
+                             FlatArray<double> w0, FlatArray<double> w1)
+  {
+    static Timer t("ParentTable::Build"); RegionTimer reg(t);
+    nc = anc;
+    nf = anf;
+    size_t n = nf-nc;
+
+    auto in_level = [this] (int p, double w) { return w != 0 && size_t(p) >= nc; };
+
+    // if we have a transitive dependency within one level
+    // the nodes are sorted by the length of the path to the coarse nodes
+    bool has_dependency = false;
+    ParallelFor (n, [&] (size_t i)
+                 {
+                   if (in_level (p0[i], w0[i]) || in_level (p1[i], w1[i]))
+                     has_dependency = true;
+                 });
+
+    Array<int> wave(n);
+    wave = 0;
+    int nwaves = 1;
+    if (has_dependency)
+      {
+        // parents usually come before their children, then two sweeps are enough
+        for (bool changed = true; changed; )
+          {
+            changed = false;
+            for (size_t i = 0; i < n; i++)
+              {
+                int w = wave[i];
+                if (in_level (p0[i], w0[i])) w = max2 (w, wave[p0[i]-nc]+1);
+                if (in_level (p1[i], w1[i])) w = max2 (w, wave[p1[i]-nc]+1);
+                if (w != wave[i])
+                  {
+                    if (size_t(w) > n)
+                      throw Exception ("ParentTable: cyclic parent dependency");
+                    wave[i] = w;
+                    changed = true;
+                  }
+              }
+          }
+        for (auto w : wave)
+          nwaves = max2 (nwaves, w+1);
+      }
+
+    first_in_wave.SetSize (nwaves+1);
+    first_in_wave = 0;
+    for (auto w : wave)
+      first_in_wave[w+1]++;
+    for (int k = 0; k < nwaves; k++)
+      first_in_wave[k+1] += first_in_wave[k];
+
+    node.SetSize (n);
+    parent0.SetSize (n);
+    parent1.SetSize (n);
+    weight0.SetSize (n);
+    weight1.SetSize (n);
+
+    // a missing parent (weight 0) is replaced by the other one, no dummy entries
+    auto set = [&] (size_t j, size_t i)
+      {
+        int pa0 = p0[i], pa1 = p1[i];
+        if (w0[i] == 0) pa0 = (w1[i] == 0) ? 0 : pa1;
+        if (w1[i] == 0) pa1 = pa0;
+        node[j] = nc+i;
+        parent0[j] = pa0;
+        parent1[j] = pa1;
+        weight0[j] = w0[i];
+        weight1[j] = w1[i];
+      };
+
+    if (nwaves == 1)
+      ParallelFor (n, [&] (size_t i) { set (i, i); });
+    else
+      {
+        Array<size_t> pos(nwaves);
+        for (int k = 0; k < nwaves; k++)
+          pos[k] = first_in_wave[k];
+        for (size_t i = 0; i < n; i++)
+          set (pos[wave[i]]++, i);
+      }
+  }
+
+
+  void ParentTable :: Prolongate (BaseVector & v) const
+  {
+    if (v.EntrySize() == 1)
+      {
+        FlatVector<> fv = v.FV<double>();
+        for (size_t k = 0; k < NWaves(); k++)
+          ParallelForRange (Wave(k), [&] (IntRange r)
+                            {
+                              for (auto j : r)
+                                fv(node[j]) = weight0[j] * fv(parent0[j]) + weight1[j] * fv(parent1[j]);
+                            });
+      }
+    else
+      {
+        FlatSysVector<> sv = v.SV<double>();
+        for (size_t k = 0; k < NWaves(); k++)
+          ParallelForRange (Wave(k), [&] (IntRange r)
+                            {
+                              for (auto j : r)
+                                sv(node[j]) = weight0[j] * sv(parent0[j]) + weight1[j] * sv(parent1[j]);
+                            });
+      }
+  }
+
+
+  void ParentTable :: Restrict (BaseVector & v) const
+  {
+    // nodes of one wave share parents, so the updates are atomic
+    if (v.EntrySize() == 1)
+      {
+        FlatVector<> fv = v.FV<double>();
+        for (size_t k = NWaves(); k-- > 0; )
+          ParallelForRange (Wave(k), [&] (IntRange r)
+                            {
+                              for (auto j : r)
+                                {
+                                  double val = fv(node[j]);
+                                  AtomicAdd (fv(parent0[j]), weight0[j] * val);
+                                  AtomicAdd (fv(parent1[j]), weight1[j] * val);
+                                }
+                            });
+      }
+    else
+      {
+        FlatSysVector<> sv = v.SV<double>();
+        for (size_t k = NWaves(); k-- > 0; )
+          ParallelForRange (Wave(k), [&] (IntRange r)
+                            {
+                              for (auto j : r)
+                                {
+                                  auto val = sv(node[j]);
+                                  auto v0 = sv(parent0[j]);
+                                  auto v1 = sv(parent1[j]);
+                                  for (size_t l = 0; l < val.Size(); l++)
+                                    {
+                                      AtomicAdd (v0(l), weight0[j] * val(l));
+                                      AtomicAdd (v1(l), weight1[j] * val(l));
+                                    }
+                                }
+                            });
+      }
+  }
+
+  
+
   LinearProlongation :: ~LinearProlongation() { ; }
 
   
@@ -35,22 +186,26 @@ namespace ngmg
     nvlevel.SetSize(ma->GetNLevels());
     for (auto i : Range(nvlevel))
       nvlevel[i] = ma->GetNVLevel(i);
-    
-    if (nvlevel.Size() > 1)
-      {
-        // if we have a transitive dependency within one level
-        // we cannot trivially prolongate in parallel
-        int finelevel = nvlevel.Size()-1;
-        size_t nc = nvlevel[finelevel-1];
-        size_t nf = nvlevel[finelevel];
-        auto & mesh = *ma;        
-        ParallelFor (IntRange(nc, nf), [&mesh, nc, this] (size_t i)
+
+    // the parents of old levels do not change, new levels are added
+    parents.SetSize (nvlevel.Size());
+    for (size_t level = 1; level < nvlevel.Size(); level++)
+      {
+        size_t nc = nvlevel[level-1];
+        size_t nf = nvlevel[level];
+        if (parents[level].nc == nc && parents[level].nf == nf) continue;
+
+        auto & mesh = *ma;
+        Array<int> p0(nf-nc), p1(nf-nc);
+        Array<double> w(nf-nc);
+        w = 0.5;
+        ParallelFor (IntRange(nc, nf), [&] (size_t i)
                      {
-                       auto parents = mesh.GetParentNodes (i);
-                       if (parents[0] >= nc || parents[1] >= nc)
-                         this->allow_parallel = false;
+                       auto par = mesh.GetParentNodes (i);
+                       p0[i-nc] = par[0];
+                       p1[i-nc] = par[1];
                      });
-        
+        parents[level].Build (nc, nf, p0, p1, w, w);
       }
   }
 
@@ -58,39 +213,19 @@ namespace ngmg
   void LinearProlongation :: ProlongateInline (int finelevel, BaseVector & v) const
   {
     static Timer t("Prolongate"); RegionTimer r(t);
-    size_t nc = nvlevel[finelevel-1];
     size_t nf = nvlevel[finelevel];
     
     if (v.EntrySize() == 1)
       {
-        FlatVector<> fv = v.FV<double>();        
+        FlatVector<> fv = v.FV<double>();
         fv.Range (nf, fv.Size()) = 0;
-        if (allow_parallel)
-          {
-            auto & mesh = *ma;
-            ParallelFor (IntRange(nc, nf), [fv, &mesh] (size_t i)
-                         {
-                           auto parents = mesh.GetParentNodes (i);
-                           fv(i) = 0.5 * (fv(parents[0]) + fv(parents[1]));
-                         });
-          }
-        else
-          for (size_t i = nc; i < nf; i++)
-            {
-              auto parents = ma->GetParentNodes (i);
-              fv(i) = 0.5 * (fv(parents[0]) + fv(parents[1]));
-            }
       }
     else
       {
         FlatSysVector<> sv = v.SV<double>();
         sv.Range (nf, sv.Size()) = 0;
-        for (size_t i = nc; i < nf; i++)
-          {
-            auto parents = ma->GetParentNodes (i);
-            sv(i) = 0.5 * (sv(parents[0]) + sv(parents[1]));
-          }
       }
+    parents[finelevel].Prolongate (v);
   }
 
 
@@ -99,100 +234,62 @@ namespace ngmg
       static Timer t("Restrict"); RegionTimer r(t);
       
       size_t nc = nvlevel[finelevel-1];
-      size_t nf = nvlevel[finelevel];
-
 
+      parents[finelevel].Restrict (v);
       if (v.EntrySize() == 1)
         {
           FlatVector<> fv = v.FV<double>();
-          for (size_t i = nf; i-- > nc; )
-            {
-              auto parents = ma->GetParentNodes (i);
-              fv(parents[0]) += 0.5 * fv(i);
-              fv(parents[1]) += 0.5 * fv(i);
-            }
           fv.Range(nc, fv.Size()) = 0;          
         }
       else
         {
           FlatSysVector<> fv = v.SV<double>();
-          for (size_t i = nf; i-- > nc; )
-            {
-              auto parents = ma->GetParentNodes (i);
-              fv(parents[0]) += 0.5 * fv(i);
-              fv(parents[1]) += 0.5 * fv(i);
-            }
           fv.Range(nc, fv.Size()) = 0;
         }
-      /*
-      for (size_t i = nf; i < fv.Size(); i++)
-	fv(i) = 0;  
-      */
     }
 
 
   SparseMatrix< double >* LinearProlongation :: CreateProlongationMatrix( int finelevel ) const
   {
-    int i;
-    int parents[2];
-
-    int nc = nvlevel[finelevel-1];
-    int nf = nvlevel[finelevel];
-
-    Array< int > indicesPerRow(nf);
-
-    /*
-    if (space.LowOrderFESpacePtr())
-      {
-        nf = space.LowOrderFESpacePtr()->GetNDofLevel( finelevel );
-        nc = space.LowOrderFESpacePtr()->GetNDofLevel( finelevel-1 );
-      }
-    else
-      {
-        nf = space.GetNDofLevel( finelevel );
-        nc = space.GetNDofLevel( finelevel-1 );
-      }
-    */
-    
-    // count entries per row
-    indicesPerRow = 0;
-    for( i=0; i<nc; i++ )
-      indicesPerRow[ i ]++;
-    for( i=nc; i<nf; i++ )
-      {
-        ma->GetParentNodes( i, parents );
-        if ( parents[ 0 ] != -1 )
-          indicesPerRow[ i ]++;
-        if ( parents[ 1 ] != -1 )
-          indicesPerRow[ i ]++;
-      }
-
-    // create matrix graph
-    MatrixGraph mg( indicesPerRow, nc );
-    for( i=0; i<nc; i++ )
-      mg.CreatePosition( i, i );
-    for( i=nc; i<nf; i++ )
-      {
-        ma->GetParentNodes( i, parents );
-        if ( parents[ 0 ] != -1 )
-          mg.CreatePosition( i, parents[ 0 ] ); 
-        if ( parents[ 1 ] != -1 )
-          mg.CreatePosition( i, parents[ 1 ] ); 
-      }
-
-    // write prolongation matrix
-    SparseMatrix< double >* prol = new SparseMatrix< double >( mg, 1 );
-    for( i=0; i<nc; i++ )
-      (*prol)( i, i ) = 1;
-    for( i=nc; i<nf; i++ )
-      {
-        ma->GetParentNodes( i, parents );
-        if ( parents[ 0 ] != -1 )
-          (*prol)( i, parents[ 0 ] ) = 0.5; 
-        if ( parents[ 1 ] != -1 )
-          (*prol)( i, parents[ 1 ] ) = 0.5; 
-      }
-
+    static Timer t("LinearProlongation::CreateProlongationMatrix"); RegionTimer reg(t);
+    size_t nc = nvlevel[finelevel-1];
+    size_t nf = nvlevel[finelevel];
+    auto & table = parents[finelevel];
+
+    // coarse nodes are copied, fine nodes have two parents, columns sorted
+    Array<int> indicesPerRow(nf);
+    ParallelFor (nc, [&] (size_t i) { indicesPerRow[i] = 1; });
+    ParallelFor (table.node.Size(), [&] (size_t j)
+                 {
+                   indicesPerRow[table.node[j]] = (table.parent0[j] == table.parent1[j]) ? 1 : 2;
+                 });
+
+    SparseMatrix< double >* prol = new SparseMatrix< double >( indicesPerRow, nc );
+    ParallelFor (nc, [&] (size_t i)
+                 {
+                   prol->GetRowIndices(i)[0] = i;
+                   prol->GetRowValues(i)[0] = 1;
+                 });
+    ParallelFor (table.node.Size(), [&] (size_t j)
+                 {
+                   auto ind = prol->GetRowIndices(table.node[j]);
+                   auto val = prol->GetRowValues(table.node[j]);
+                   int p0 = table.parent0[j], p1 = table.parent1[j];
+                   double w0 = table.weight0[j], w1 = table.weight1[j];
+                   if (p0 == p1)
+                     {
+                       ind[0] = p0;
+                       val[0] = w0+w1;
+                       return;
+                     }
+                   if (p0 > p1)
+                     {
+                       swap (p0, p1);
+                       swap (w0, w1);
+                     }
+                   ind[0] = p0; ind[1] = p1;
+                   val[0] = w0; val[1] = w1;
+                 });
     return prol;
   }
 
@@ -595,6 +692,78 @@ namespace ngmg
 
 
 
+  void EdgeProlongation :: Update (const FESpace & fes)
+  {
+    lock_guard<mutex> guard(parents_mutex);
+    parents.SetSize0();
+  }
+
+  
+  const ParentTable & EdgeProlongation :: GetParents (int finelevel) const
+  {
+    lock_guard<mutex> guard(parents_mutex);
+    if (parents.Size() <= size_t(finelevel))
+      parents.SetSize (finelevel+1);
+
+    size_t nc = space.GetNDofLevel (finelevel-1);
+    size_t nf = space.GetNDofLevel (finelevel);
+    auto & table = parents[finelevel];
+    if (table.nc == nc && table.nf == nf && table.first_in_wave.Size())
+      return table;
+
+    // parent edge = 2*nr + (1 if same orientation)
+    Array<int> p0(nf-nc), p1(nf-nc);
+    Array<double> w0(nf-nc), w1(nf-nc);
+    ParallelFor (IntRange(nc, nf), [&] (size_t i)
+                 {
+                   int pa1 = space.ParentEdge1 (i);
+                   int pa2 = space.ParentEdge2 (i);
+                   p0[i-nc] = (pa1 != -1) ? pa1/2 : -1;
+                   p1[i-nc] = (pa2 != -1) ? pa2/2 : -1;
+                   w0[i-nc] = (pa1 == -1) ? 0 : ( (pa1 & 1) ? 0.5 : -0.5 );
+                   w1[i-nc] = (pa2 == -1) ? 0 : ( (pa2 & 1) ? 0.5 : -0.5 );
+                 });
+    table.Build (nc, nf, p0, p1, w0, w1);
+    return table;
+  }
+
+  
+  void EdgeProlongation :: ProlongateInline (int finelevel, BaseVector & v) const
+  {
+    static Timer t("EdgeProlongation::Prolongate"); RegionTimer r(t);
+    size_t nf = space.GetNDofLevel (finelevel);
+    FlatSysVector<> fv (v.Size(), v.EntrySize(), static_cast<double*>(v.Memory()));
+
+    fv.Range (nf, fv.Size()) = 0;
+    GetParents(finelevel).Prolongate (v);
+
+    ParallelFor (nf, [&] (size_t i)
+                 {
+                   if (space.FineLevelOfEdge(i) < finelevel)
+                     fv(i) = 0;
+                 });
+  }
+
+
+  void EdgeProlongation :: RestrictInline (int finelevel, BaseVector & v) const
+  {
+    static Timer t("EdgeProlongation::Restrict"); RegionTimer r(t);
+    size_t nc = space.GetNDofLevel (finelevel-1);
+    size_t nf = space.GetNDofLevel (finelevel);
+    FlatSysVector<> fv (v.Size(), v.EntrySize(), static_cast<double*>(v.Memory()));
+
+    ParallelFor (nf, [&] (size_t i)
+                 {
+                   if (space.FineLevelOfEdge(i) < finelevel)
+                     fv(i) = 0;
+                 });
+    GetParents(finelevel).Restrict (v);
+    fv.Range (nc, fv.Size()) = 0;
+  }
+
+
+
+
   L2HoProlongation::
   L2HoProlongation(shared_ptr<MeshAccess> ama, const Array<int> & afirst_dofs)
     : ma(ama), first_dofs(afirst_dofs) 
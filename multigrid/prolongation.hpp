@@ -35,6 +35,38 @@ namespace ngmg
   };
 
 
+  /**
+     Parents of the nodes nc <= i < nf of one refinement level,
+     stored as structure of arrays:
+       v(node[j]) = weight0[j] * v(parent0[j]) + weight1[j] * v(parent1[j])
+     The entries are sorted into waves. The parents of a node are coarse
+     nodes or nodes of previous waves, so one wave can be prolongated in
+     parallel. Usually there is only one wave, and node[j] = nc+j.
+  */
+  class NGS_DLL_HEADER ParentTable
+  {
+  public:
+    size_t nc = 0, nf = 0;
+    Array<int> node, parent0, parent1;
+    Array<double> weight0, weight1;
+    /// entries of wave k are first_in_wave[k] <= j < first_in_wave[k+1]
+    Array<size_t> first_in_wave;
+
+    /// parents with weight 0 are ignored, p0, p1, w0, w1 are indexed by i-nc
+    void Build (size_t anc, size_t anf,
+                FlatArray<int> p0, FlatArray<int> p1,
+                FlatArray<double> w0, FlatArray<double> w1);
+
+    size_t NWaves () const { return first_in_wave.Size()-1; }
+    IntRange Wave (size_t k) const { return IntRange (first_in_wave[k], first_in_wave[k+1]); }
+
+    /// v(i) for nc <= i < nf from its parents
+    void Prolongate (BaseVector & v) const;
+    /// transpose, the values v(i), nc <= i < nf, are added to the parents (not cleared)
+    void Restrict (BaseVector & v) const;
+  };
+
+
   /**
      Standard Prolongation.
      Child nodes between 2 parent nodes.
@@ -43,7 +75,8 @@ namespace ngmg
   {
     shared_ptr<MeshAccess> ma;
     Array<size_t> nvlevel;
-    bool allow_parallel = true;
+    /// parents[l] for the nodes of level l
+    Array<ParentTable> parents;
   public:
     LinearProlongation(shared_ptr<MeshAccess> ama)
       : ma(ama) { ; }
@@ -186,6 +219,11 @@ namespace ngmg
     shared_ptr<MeshAccess> ma;
     ///
     const NedelecFESpace & space;
+    /// parent edges per level, built on demand
+    mutable Array<ParentTable> parents;
+    mutable mutex parents_mutex;
+
+    const ParentTable & GetParents (int finelevel) const;
   public:
     ///
     EdgeProlongation(const NedelecFESpace & aspace)
@@ -194,100 +232,17 @@ namespace ngmg
     virtual ~EdgeProlongation() { ; }
   
     ///
-    virtual void Update (const FESpace & fes) { ; }
+    virtual void Update (const FESpace & fes);
 
     ///
     virtual SparseMatrix< double >* CreateProlongationMatrix( int finelevel ) const
     { return NULL; }
 
     ///
-    virtual void ProlongateInline (int finelevel, BaseVector & v) const
-    {
-      int nc = space.GetNDofLevel (finelevel-1);
-      int nf = space.GetNDofLevel (finelevel);
-      /*    
-	    FlatVector<TV> & fv = 
-	    dynamic_cast<VFlatVector<TV> &> (v).FV();
-      */
-      //    FlatVector<TV> fv = dynamic_cast<T_BaseVector<TV> &> (v).FV();
-      FlatSysVector<> fv (v.Size(), v.EntrySize(), static_cast<double*>(v.Memory()));
-
-      int i, k;
-
-      for (i = nf; i < fv.Size(); i++)
-	fv(i) = 0;
-
-      for (k = 1; k <= 10; k++)
-	for (i = nc; i < nf; i++)
-	  {
-	    int pa1 = space.ParentEdge1 (i);
-	    int pa2 = space.ParentEdge2 (i);
-	  
-	    fv(i) = 0;
-	    if (pa1 != -1)
-	      {
-		if (pa1 & 1)
-		  fv(i) += 0.5 * fv(pa1/2);
-		else
-		  fv(i) -= 0.5 * fv(pa1/2);
-	      }
-	    if (pa2 != -1)
-	      {
-		if (pa2 & 1)
-		  fv(i) += 0.5 * fv(pa2/2);
-		else
-		  fv(i) -= 0.5 * fv(pa2/2);
-	      }
-	  }
-
-      for (i = 0; i < nf; i++)
-	if (space.FineLevelOfEdge(i) < finelevel)
-	  fv(i) = 0;
-    }
-
+    virtual void ProlongateInline (int finelevel, BaseVector & v) const;
 
     ///
-    virtual void RestrictInline (int finelevel, BaseVector & v) const
-    {
-      int nc = space.GetNDofLevel (finelevel-1);
-      int nf = space.GetNDofLevel (finelevel);
-
-      //    FlatVector<TV> & fv = 
-      //      dynamic_cast<VFlatVector<TV> &> (v).FV();
-      //    FlatVector<TV> fv = dynamic_cast<T_BaseVector<TV> &> (v).FV();
-
-      FlatSysVector<> fv (v.Size(), v.EntrySize(), static_cast<double*>(v.Memory()));
-
-      for (int i = 0; i < nf; i++)
-	if (space.FineLevelOfEdge(i) < finelevel)
-	  fv(i) = 0;
-	
-      for (int k = 1; k <= 10; k++)
-	for (int i = nf-1; i >= nc; i--)
-	  {
-	    int pa1 = space.ParentEdge1 (i);
-	    int pa2 = space.ParentEdge2 (i);
-	  
-	    if (pa1 != -1)
-	      {
-		if (pa1 & 1)
-		  fv(pa1/2) += 0.5 * fv(i);
-		else
-		  fv(pa1/2) -= 0.5 * fv(i);
-	      }
-	    if (pa2 != -1)
-	      {
-		if (pa2 & 1)
-		  fv(pa2/2) += 0.5 * fv(i);
-		else
-		  fv(pa2/2) -= 0.5 * fv(i);
-	      }
-	    fv(i) = 0;
-	  }
-
-      for (int i = nf; i < fv.Size(); i++)
-	fv(i) = 0;  
-    }
+    virtual void RestrictInline (int finelevel, BaseVector & v) const;
 
     ///
     void ApplyGradient (int level, const BaseVector & pot, BaseVector & grad) const
@@ -297,7 +252,6 @@ namespace ngmg
   };
 
 
-
     /// L2Ho prolongaton
   class L2HoProlongation : public Prolongation
   {
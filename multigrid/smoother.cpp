@@ -151,6 +151,73 @@ namespace ngmg
 
 
 
+  PolynomialSmoother :: 
+  PolynomialSmoother  (const MeshAccess & ama,
+                       const BilinearForm & abiform, const Flags & aflags)
+    : Smoother(aflags), biform(abiform)
+  {
+    Update();
+  }
+
+  PolynomialSmoother :: ~PolynomialSmoother()
+  {
+    ;
+  }
+
+  void PolynomialSmoother :: Update (bool force_update)
+  {
+    int order = int(flags.GetNumFlag ("chebyshevorder", 3));
+    double ratio = flags.GetNumFlag ("chebyshevratio", 30);
+    int eststeps = int(flags.GetNumFlag ("chebyshevestimationsteps", 10));
+
+    int oldsize = cheb.Size();
+    cheb.SetSize (biform.GetNLevels());
+    for (int i = 0; i < biform.GetNLevels(); i++)
+      {
+        // lambda_max estimation is not for free, keep the coarse levels
+        if (i < oldsize && cheb[i] && !force_update && i < biform.GetNLevels()-1) continue;
+	if (biform.GetMatrixPtr(i))
+          {
+            auto mat = biform.GetMatrixPtr(i);
+            shared_ptr<BaseMatrix> jac = dynamic_cast<const BaseSparseMatrix&> (*mat)
+              .CreateJacobiPrecond(biform.GetFESpace()->GetFreeDofs());
+            cheb[i] = make_shared<ChebyshevSmoother> (mat, jac, order, ratio, eststeps);
+          }
+	else
+	  cheb[i] = nullptr;
+      }
+  }
+
+  void PolynomialSmoother :: PreSmooth (int level, BaseVector & u, 
+                                        const BaseVector & f, int steps) const
+  {
+    for (int i = 0; i < steps; i++)
+      cheb[level]->Smooth (u, f);
+  }
+
+  void PolynomialSmoother :: PostSmooth (int level, BaseVector & u, 
+                                         const BaseVector & f, int steps) const
+  {
+    // the polynomial is symmetric, post-smoothing is the same
+    for (int i = 0; i < steps; i++)
+      cheb[level]->Smooth (u, f);
+  }
+
+  void PolynomialSmoother :: 
+  Residuum (int level, BaseVector & u, 
+	    const BaseVector & f, BaseVector & d) const
+  {
+    d = f - biform.GetMatrix(level) * u;
+  }
+  
+  AutoVector PolynomialSmoother :: CreateVector(int level) const
+  {
+    return biform.GetMatrix(level).CreateColVector();
+  }
+
+
+
+
   AnisotropicSmoother :: 
   AnisotropicSmoother  (const MeshAccess & ama,
 			const BilinearForm & abiform)
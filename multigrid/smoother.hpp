@@ -119,6 +119,40 @@ namespace ngmg
   };
 
 
+  /**
+     Jacobi-Chebyshev smoother.
+     Polynomial smoother in D^{-1} A, needs only matrix-vector products.
+  */
+  class PolynomialSmoother : public Smoother
+  {
+    ///
+    const BilinearForm & biform;
+    ///
+    Array<shared_ptr<ChebyshevSmoother>> cheb;
+  
+  public:
+    ///
+    PolynomialSmoother (const MeshAccess & ama,
+                        const BilinearForm & abiform, const Flags & aflags);
+    ///
+    virtual ~PolynomialSmoother();
+  
+    ///
+    virtual void Update (bool force_update = 0);
+    ///
+    virtual void PreSmooth (int level, ngla::BaseVector & u, 
+			    const ngla::BaseVector & f, int steps) const;
+    ///
+    virtual void PostSmooth (int level, ngla::BaseVector & u, 
+			     const ngla::BaseVector & f, int steps) const;
+    ///
+    virtual void Residuum (int level, ngla::BaseVector & u, 
+			   const ngla::BaseVector & f, ngla::BaseVector & d) const;
+    ///
+    virtual AutoVector CreateVector(int level) const;
+  };
+
+
   /**
      Anisotropic smoother.
      Common relaxation of vertically aligned nodes.
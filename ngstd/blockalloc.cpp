@@ -96,5 +96,183 @@ namespace ngstd
       }
   }
 
-}
 
+
+  // tagged pointers of the global stack
+  static constexpr uint64_t ptr_mask = (uint64_t(1) << 48) - 1;
+  static INLINE void * TaggedPtr (uint64_t t) { return (void*)(t & ptr_mask); }
+  static INLINE uint64_t NextTag (uint64_t t, void * p)
+  { return (((t >> 48) + 1) << 48) | (uint64_t(p) & ptr_mask); }
+
+  /// the batch links of an element: next element in the batch, next batch
+  static INLINE void *& NextInBatch (void * p) { return ((void**)p)[0]; }
+  static INLINE void *& NextBatch (void * p) { return ((void**)p)[1]; }
+
+
+  ConcurrentBlockAllocator ::
+  ConcurrentBlockAllocator (size_t asize, size_t abatchsize, size_t ablocks)
+    : batchsize(max(abatchsize, size_t(1))), blocks(max(ablocks, size_t(1)))
+  {
+    static_assert (sizeof(void*) == 8, "ConcurrentBlockAllocator needs 64-bit pointers");
+    size = max (asize, 2*sizeof(void*));
+    size = ((size-1)/sizeof(void*) + 1)*sizeof(void*);
+    ncaches = max (TaskManager::GetMaxThreads(), TaskManager::GetNumThreads());
+    caches = make_unique<ThreadCache[]> (ncaches);
+  }
+
+  ConcurrentBlockAllocator :: ~ConcurrentBlockAllocator ()
+  {
+    char * block = memory.load();
+    while (block)
+      {
+        char * next = *(char**)block;
+        delete [] block;
+        block = next;
+      }
+  }
+
+  void ConcurrentBlockAllocator :: PushBatch (void * batch)
+  {
+    uint64_t old = batches.load (memory_order_relaxed);
+    do
+      NextBatch(batch) = TaggedPtr(old);
+    while (!batches.compare_exchange_weak (old, NextTag(old, batch),
+                                           memory_order_release, memory_order_relaxed));
+  }
+
+  void * ConcurrentBlockAllocator :: PopBatch ()
+  {
+    uint64_t old = batches.load (memory_order_acquire);
+    while (void * head = TaggedPtr(old))
+      {
+        // memory is never returned before destruction, the read is safe
+        // also if the batch was taken meanwhile, then the tag changed
+        void * next = NextBatch(head);
+        if (batches.compare_exchange_weak (old, NextTag(old, next),
+                                           memory_order_acquire, memory_order_acquire))
+          return head;
+      }
+    return nullptr;
+  }
+
+  void * ConcurrentBlockAllocator :: GetBatch ()
+  {
+    if (void * batch = PopBatch())
+      return batch;
+
+    // new memory, the first word links the blocks
+    size_t header = 2*sizeof(void*);
+    char * block = new char[header + blocks*batchsize*size];
+    if (uint64_t(block+header+blocks*batchsize*size) & ~ptr_mask)
+      throw Exception ("ConcurrentBlockAllocator: pointer does not fit into 48 bits");
+    char * old = memory.load (memory_order_relaxed);
+    do
+      *(char**)block = old;
+    while (!memory.compare_exchange_weak (old, block, memory_order_release, memory_order_relaxed));
+    memory_blocks++;
+
+    char * els = block + header;
+    for (size_t b = 0; b < blocks; b++)
+      {
+        char * first = els + b*batchsize*size;
+        for (size_t i = 0; i+1 < batchsize; i++)
+          NextInBatch(first+i*size) = first+(i+1)*size;
+        NextInBatch(first+(batchsize-1)*size) = nullptr;
+        if (b > 0) PushBatch (first);
+      }
+    return els;
+  }
+
+  ConcurrentBlockAllocator::ThreadCache * ConcurrentBlockAllocator :: MyCache ()
+  {
+    // outside of a parallel region only the thread with id 0 may run
+    size_t tid = TaskManager::GetThreadId();
+    return tid < ncaches ? &caches[tid] : nullptr;
+  }
+
+  void * ConcurrentBlockAllocator :: Alloc ()
+  {
+    ThreadCache * cache = MyCache();
+    if (!cache)
+      {
+        other_allocs++;
+        void * batch = GetBatch();
+        if (void * rest = NextInBatch(batch))
+          PushBatch (rest);
+        return batch;
+      }
+
+    cache->allocs++;
+    if (!cache->freelist)
+      {
+        cache->freelist = GetBatch();
+        cache->refills++;
+        cache->nfree = 0;
+        for (void * p = cache->freelist; p; p = NextInBatch(p))
+          cache->nfree++;
+      }
+    void * p = cache->freelist;
+    cache->freelist = NextInBatch(p);
+    cache->nfree--;
+    return p;
+  }
+
+  void ConcurrentBlockAllocator :: Free (void * p)
+  {
+    ThreadCache * cache = MyCache();
+    if (!cache)
+      {
+        other_frees++;
+        NextInBatch(p) = nullptr;
+        PushBatch (p);
+        return;
+      }
+
+    cache->frees++;
+    NextInBatch(p) = cache->freelist;
+    cache->freelist = p;
+    cache->nfree++;
+    if (cache->nfree >= 2*batchsize)
+      {
+        // return the first batchsize elements, keep the others
+        void * last = p;
+        for (size_t i = 1; i < batchsize; i++)
+          last = NextInBatch(last);
+        cache->freelist = NextInBatch(last);
+        NextInBatch(last) = nullptr;
+        cache->nfree -= batchsize;
+        PushBatch (p);
+        cache->returns++;
+      }
+  }
+
+  ConcurrentBlockAllocator::Statistics ConcurrentBlockAllocator :: GetStatistics () const
+  {
+    Statistics stat;
+    stat.element_size = size;
+    stat.allocs = other_allocs;
+    stat.frees = other_frees;
+    for (size_t i = 0; i < ncaches; i++)
+      {
+        stat.allocs += caches[i].allocs;
+        stat.frees += caches[i].frees;
+        stat.refills += caches[i].refills;
+        stat.returns += caches[i].returns;
+      }
+    stat.live = stat.allocs - stat.frees;
+    stat.memory_blocks = memory_blocks;
+    stat.bytes = stat.memory_blocks * (2*sizeof(void*) + blocks*batchsize*size);
+    return stat;
+  }
+
+  void ConcurrentBlockAllocator :: Print (ostream & ost) const
+  {
+    auto stat = GetStatistics();
+    ost << "ConcurrentBlockAllocator, element size = " << stat.element_size << endl
+        << "live elements = " << stat.live
+        << ", allocs = " << stat.allocs << ", frees = " << stat.frees << endl
+        << "batches taken = " << stat.refills << ", returned = " << stat.returns << endl
+        << "memory blocks = " << stat.memory_blocks << ", bytes = " << stat.bytes << endl;
+  }
+
+}
@@ -69,6 +69,83 @@ private:
 };
 
 
+
+/**
+   Thread-safe variant of the BlockAllocator.
+   Every thread of the TaskManager allocates from and frees to its own
+   cache. A cache exchanges batches of elements with a global lock-free
+   stack (tagged pointer against ABA), new memory is pushed to it as
+   batches. An element may be freed by another thread than the one
+   which allocated it. Threads outside the TaskManager go to the global
+   stack directly.
+ */
+class ConcurrentBlockAllocator
+{
+public:
+  struct Statistics
+  {
+    size_t element_size = 0;
+    /// elements currently allocated
+    size_t live = 0;
+    /// allocations and frees since construction
+    size_t allocs = 0, frees = 0;
+    /// batches taken from and returned to the global stack
+    size_t refills = 0, returns = 0;
+    /// blocks of new memory, and their total size in bytes
+    size_t memory_blocks = 0, bytes = 0;
+  };
+
+private:
+  struct alignas(64) ThreadCache
+  {
+    void * freelist = nullptr;
+    size_t nfree = 0;
+    size_t allocs = 0, frees = 0;
+    size_t refills = 0, returns = 0;
+  };
+
+  /// size of elements, at least two pointers (next in batch, next batch)
+  size_t size;
+  /// elements moved between a cache and the global stack at once
+  size_t batchsize;
+  /// batches per block of new memory
+  size_t blocks;
+
+  unique_ptr<ThreadCache[]> caches;
+  size_t ncaches;
+  /// statistics of threads without a cache
+  atomic<size_t> other_allocs{0}, other_frees{0};
+
+  /// global stack of batches: pointer in the low 48 bits, tag in the high 16 bits
+  atomic<uint64_t> batches{0};
+  /// blocks of new memory, linked through their first word
+  atomic<char*> memory{nullptr};
+  atomic<size_t> memory_blocks{0};
+
+  void PushBatch (void * batch);
+  void * PopBatch ();
+  /// a batch from the global stack or from new memory
+  void * GetBatch ();
+  ThreadCache * MyCache ();
+
+public:
+  NGS_DLL_HEADER ConcurrentBlockAllocator (size_t asize, size_t abatchsize = 64, size_t ablocks = 16);
+  NGS_DLL_HEADER ~ConcurrentBlockAllocator ();
+
+  ConcurrentBlockAllocator (const ConcurrentBlockAllocator &) = delete;
+  ConcurrentBlockAllocator & operator= (const ConcurrentBlockAllocator &) = delete;
+
+  /// Return pointer to new element, thread-safe
+  NGS_DLL_HEADER void * Alloc ();
+  /// Send memory to the free-list, thread-safe
+  NGS_DLL_HEADER void Free (void * p);
+
+  /// number of allocated elements, exact if no other thread allocates
+  size_t NumElements () const { return GetStatistics().live; }
+  NGS_DLL_HEADER Statistics GetStatistics () const;
+  NGS_DLL_HEADER void Print (ostream & ost) const;
+};
+
 }
 
 INLINE void * operator new (size_t size, ngstd::BlockAllocator & ball)  
@@ -81,6 +158,16 @@ INLINE void operator delete (void * p, ngstd::BlockAllocator & ball)
   ball.Free (p);
 }
 
+INLINE void * operator new (size_t size, ngstd::ConcurrentBlockAllocator & ball)
+{
+  return ball.Alloc();
+}
+
+INLINE void operator delete (void * p, ngstd::ConcurrentBlockAllocator & ball)
+{
+  ball.Free (p);
+}
+
 
 
 #endif
@@ -10,7 +10,82 @@ namespace ngstd
                       Array<double> at,
                       Array<double> ac)
     : order(aorder), t(at), c(ac) 
-  { ; }
+  {
+    Prepare();
+  }
+
+  void BSpline :: Prepare ()
+  {
+    // distinct knots bound the polynomial pieces
+    breaks.SetSize0();
+    for (double tk : t)
+      if (breaks.Size() == 0 || tk > breaks.Last())
+        breaks.Append (tk);
+    if (breaks.Size() == 0) breaks.Append (0);
+    size_t nint = breaks.Size()-1;
+
+    invh.SetSize (nint+1);
+    pcoefs.SetSize ((nint+1)*order);
+    pcoefs = 0;
+    invh[nint] = 0;
+
+    // interpolate each piece at interior points, solve the small Vandermonde system
+    ArrayMem<double,64> mat(order*order);
+    ArrayMem<double,8> rhs(order);
+    for (size_t k = 0; k < nint; k++)
+      {
+        double h = breaks[k+1]-breaks[k];
+        invh[k] = 1/h;
+        for (int i = 0; i < order; i++)
+          {
+            double si = (i+0.5) / order;
+            rhs[i] = EvaluateDeBoor (breaks[k] + si*h);
+            double pot = 1;
+            for (int p = 0; p < order; p++, pot *= si)
+              mat[i*order+p] = pot;
+          }
+        for (int i = 0; i < order; i++)
+          {
+            int piv = i;
+            for (int j = i+1; j < order; j++)
+              if (fabs(mat[j*order+i]) > fabs(mat[piv*order+i])) piv = j;
+            if (piv != i)
+              {
+                for (int p = 0; p < order; p++)
+                  Swap (mat[i*order+p], mat[piv*order+p]);
+                Swap (rhs[i], rhs[piv]);
+              }
+            for (int j = i+1; j < order; j++)
+              {
+                double f = mat[j*order+i] / mat[i*order+i];
+                for (int p = i; p < order; p++)
+                  mat[j*order+p] -= f * mat[i*order+p];
+                rhs[j] -= f * rhs[i];
+              }
+          }
+        for (int i = order-1; i >= 0; i--)
+          {
+            double sum = rhs[i];
+            for (int p = i+1; p < order; p++)
+              sum -= mat[i*order+p] * pcoefs[k*order+p];
+            pcoefs[k*order+i] = sum / mat[i*order+i];
+          }
+      }
+
+    lookup.SetSize0();
+    if (nint == 0) return;
+    size_t ncells = 4*nint;
+    double range = breaks[nint]-breaks[0];
+    lookup_invh = ncells / range;
+    lookup.SetSize (ncells);
+    size_t k = 0;
+    for (size_t cell = 0; cell < ncells; cell++)
+      {
+        double x = breaks[0] + cell * (range / ncells);
+        while (k+1 < nint && breaks[k+1] <= x) k++;
+        lookup[cell] = k;
+      }
+  }
   
   
   BSpline BSpline :: Differentiate () const
@@ -76,6 +151,65 @@ namespace ngstd
 
   
   double BSpline :: Evaluate (double x) const
+  {
+    double s;
+    int k = FindInterval (x, s);
+    const double * a = &pcoefs[k*order];
+    double val = a[order-1];
+    for (int p = order-2; p >= 0; p--)
+      val = val*s + a[p];
+    return val;
+  }
+
+  void BSpline :: Evaluate (double x, double & val, double & dval, double & ddval) const
+  {
+    double s;
+    int k = FindInterval (x, s);
+    const double * a = &pcoefs[k*order];
+    double v = a[order-1], d = 0, dd = 0;
+    for (int p = order-2; p >= 0; p--)
+      {
+        dd = dd*s + d;
+        d = d*s + v;
+        v = v*s + a[p];
+      }
+    val = v;
+    dval = d * invh[k];
+    ddval = 2 * dd * sqr(invh[k]);
+  }
+
+  SIMD<double> BSpline :: Evaluate (SIMD<double> x) const
+  {
+    SIMD<double> val, dval, ddval;
+    Evaluate (x, val, dval, ddval);
+    return val;
+  }
+
+  void BSpline :: Evaluate (SIMD<double> x, SIMD<double> & val,
+                            SIMD<double> & dval, SIMD<double> & ddval) const
+  {
+    constexpr int SW = SIMD<double>::Size();
+    int k[SW];
+    double hs[SW];
+    for (int l = 0; l < SW; l++)
+      k[l] = FindInterval (x[l], hs[l]);
+    SIMD<double> s([&](int l) { return hs[l]; });
+    SIMD<double> ih([&](int l) { return invh[k[l]]; });
+    auto coef = [&](int p) { return SIMD<double>([&](int l) { return pcoefs[k[l]*order+p]; }); };
+
+    SIMD<double> v = coef(order-1), d = 0.0, dd = 0.0;
+    for (int p = order-2; p >= 0; p--)
+      {
+        dd = dd*s + d;
+        d = d*s + v;
+        v = v*s + coef(p);
+      }
+    val = v;
+    dval = d * ih;
+    ddval = 2.0 * dd * ih * ih;
+  }
+  
+  double BSpline :: EvaluateDeBoor (double x) const
   {
     // for (int m = order-1; m < t.Size()-order+1; m++)
     // for (int m = 0; m < t.Size()-order+1; m++)
@@ -103,41 +237,40 @@ namespace ngstd
 
   AutoDiff<1> BSpline :: operator() (AutoDiff<1> x) const
   {
-    // double eps = 1e-5;
-    double val = (*this)(x.Value());
-    // double valr = (*this)(x.Value()+eps);
-    // double vall = (*this)(x.Value()-eps);
-    // double dval = (valr-vall) / (2*eps);
-
-    double dval2 = Differentiate()(x.Value());
-    // cout << "dval = " << dval << " =?= " << dval2 << endl;
-
+    double val, dval, ddval;
+    Evaluate (x.Value(), val, dval, ddval);
     AutoDiff<1> res(val);
-    res.DValue(0) = dval2 * x.DValue(0);
+    res.DValue(0) = dval * x.DValue(0);
     return res;
   }
+  
   AutoDiffDiff<1> BSpline :: operator() (AutoDiffDiff<1> x) const
   {
-    /*
-    double eps = 1e-5;
-    double val = (*this)(x.Value());
-    double valr = (*this)(x.Value()+eps);
-    double vall = (*this)(x.Value()-eps);
-
-    double dval = (valr-vall) / (2*eps);
-    double ddval = (valr+vall-2*val) / (eps*eps);
-    */
-    auto diff = Differentiate();
-    auto ddiff = diff.Differentiate();
-    double val = (*this)(x.Value());
-    double dval = diff(x.Value());
-    double ddval = ddiff(x.Value());
-
+    double val, dval, ddval;
+    Evaluate (x.Value(), val, dval, ddval);
     AutoDiffDiff<1> res(val);
     res.DValue(0) = dval * x.DValue(0);
     res.DDValue(0) = ddval * x.DValue(0)*x.DValue(0) + dval*x.DDValue(0);
     return res;
+  }
 
+  AutoDiff<1,SIMD<double>> BSpline :: operator() (AutoDiff<1,SIMD<double>> x) const
+  {
+    SIMD<double> val, dval, ddval;
+    Evaluate (x.Value(), val, dval, ddval);
+    AutoDiff<1,SIMD<double>> res(val);
+    res.DValue(0) = dval * x.DValue(0);
+    return res;
+  }
+  
+  AutoDiffDiff<1,SIMD<double>> BSpline :: operator() (AutoDiffDiff<1,SIMD<double>> x) const
+  {
+    SIMD<double> val, dval, ddval;
+    Evaluate (x.Value(), val, dval, ddval);
+    AutoDiffDiff<1,SIMD<double>> res(val);
+    res.DValue(0) = dval * x.DValue(0);
+    res.DDValue(0) = ddval * x.DValue(0)*x.DValue(0) + dval*x.DDValue(0);
+    return res;
   }
  
   ostream & operator<< (ostream & ost, const BSpline & sp)
@@ -16,6 +16,14 @@ namespace ngstd
     int order;
     Array<double> t;
     Array<double> c;
+
+    // cached piecewise polynomials: on interval k the spline is
+    // sum_p pcoefs[k*order+p] s^p, s = (x-breaks[k])*invh[k].
+    // the extra last interval has zero coefficients, used outside the knots
+    Array<double> breaks, invh, pcoefs;
+    // uniform grid over the knot range -> first candidate interval
+    Array<int> lookup;
+    double lookup_invh = 0;
     
   public:
     BSpline() = default;
@@ -28,17 +36,45 @@ namespace ngstd
     void DoArchive(Archive& ar)
     {
       ar & order & t & c;
+      if (ar.Input()) Prepare();
     }
 
     BSpline Differentiate () const;
     BSpline Integrate () const;
 
     double Evaluate (double x) const;
+    SIMD<double> Evaluate (SIMD<double> x) const;
+    /// value, first and second derivative from the cached polynomials
+    void Evaluate (double x, double & val, double & dval, double & ddval) const;
+    void Evaluate (SIMD<double> x, SIMD<double> & val, SIMD<double> & dval, SIMD<double> & ddval) const;
+    
     double operator() (double x) const { return Evaluate(x); }
+    SIMD<double> operator() (SIMD<double> x) const { return Evaluate(x); }
     AutoDiff<1> operator() (AutoDiff<1> x) const;
     AutoDiffDiff<1> operator() (AutoDiffDiff<1> x) const;
+    AutoDiff<1,SIMD<double>> operator() (AutoDiff<1,SIMD<double>> x) const;
+    AutoDiffDiff<1,SIMD<double>> operator() (AutoDiffDiff<1,SIMD<double>> x) const;
     
     friend ostream & operator<< (ostream & ost, const BSpline & sp);
+  private:
+    double EvaluateDeBoor (double x) const;
+    void Prepare ();
+    /// interval number and local coordinate, returns the zero interval outside
+    int FindInterval (double x, double & s) const
+    {
+      size_t nint = breaks.Size()-1;
+      if (lookup.Size() == 0 || !(x >= breaks[0] && x < breaks[nint]))
+        {
+          s = 0;
+          return nint;
+        }
+      size_t cell = min2(size_t((x-breaks[0])*lookup_invh), lookup.Size()-1);
+      int k = lookup[cell];
+      while (breaks[k] > x) k--;       // rounding in the cell index
+      while (breaks[k+1] <= x) k++;
+      s = (x-breaks[k]) * invh[k];
+      return k;
+    }
   };
 
   extern ostream & operator<< (ostream & ost, const BSpline & sp);
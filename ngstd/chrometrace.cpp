@@ -0,0 +1,283 @@
+/**************************************************************************/
+/* File:   chrometrace.cpp                                                */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+   trace writer in the Chrome trace event format
+*/
+
+
+#include <ngstd.hpp>
+#include "chrometrace.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace ngstd
+{
+  ChromeTrace * ChromeTrace :: active = nullptr;
+  Array<string> ChromeTrace :: names;
+  std::map<string,int> ChromeTrace :: name_ids;
+  mutex ChromeTrace :: names_mutex;
+
+  static const char * category_names[] = { "timer", "task", "mpi" };
+  static const char * counter_names[] = { "cycles", "instructions", "cache-references", "cache-misses" };
+
+
+#ifdef __linux__
+  static int OpenCounter (int counter, int group_fd)
+  {
+    static const uint64_t configs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                        PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES };
+    perf_event_attr attr;
+    memset (&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = configs[counter];
+    attr.disabled = (group_fd == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // this thread, any cpu
+    return syscall (__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+  }
+#endif
+
+  bool ChromeTrace :: HaveCounters ()
+  {
+#ifdef __linux__
+    int fd = OpenCounter (CYCLES, -1);
+    if (fd < 0) return false;
+    close (fd);
+    return true;
+#else
+    return false;
+#endif
+  }
+
+
+  ChromeTrace :: ChromeTrace (string afilename, bool ause_counters, size_t amax_events)
+    : threads(TaskManager::GetMaxThreads()), start_time(std::chrono::steady_clock::now()),
+      use_counters(ause_counters), max_events(amax_events), filename(afilename)
+  {
+    if (active)
+      throw Exception ("ChromeTrace: there is already an active trace");
+    if (use_counters && !HaveCounters())
+      {
+        cerr << "ChromeTrace: no hardware counters (check /proc/sys/kernel/perf_event_paranoid), "
+             << "tracing without counters" << endl;
+        use_counters = false;
+      }
+    for (auto & td : threads)
+      td.fds.fill (-1);
+
+#ifdef PARALLEL
+    // one file per rank, the rank is the process id in the trace
+    int initialized;
+    MPI_Initialized (&initialized);
+    if (initialized)
+      {
+        int size;
+        MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+        MPI_Comm_size (MPI_COMM_WORLD, &size);
+        if (size > 1 && filename.length())
+          {
+            auto dot = filename.rfind('.');
+            if (dot == string::npos) dot = filename.length();
+            filename = filename.substr(0, dot) + "_rank" + ToString(rank) + filename.substr(dot);
+          }
+      }
+#endif
+    active = this;
+  }
+
+  ChromeTrace :: ~ChromeTrace ()
+  {
+    Stop();
+#ifdef __linux__
+    for (auto & td : threads)
+      for (int fd : td.fds)
+        if (fd >= 0) close (fd);
+#endif
+  }
+
+  void ChromeTrace :: Stop ()
+  {
+    if (active != this) return;
+    active = nullptr;
+    if (filename.length())
+      Write (filename);
+  }
+
+
+  int ChromeTrace :: GetNameId (const string & name)
+  {
+    lock_guard<mutex> guard(names_mutex);
+    auto pos = name_ids.find(name);
+    if (pos != name_ids.end())
+      return pos->second;
+    int id = names.Size();
+    names.Append (name);
+    name_ids[name] = id;
+    return id;
+  }
+
+
+  ChromeTrace::ThreadData & ChromeTrace :: MyData ()
+  {
+    return threads[TaskManager::GetThreadId()];
+  }
+
+
+  std::array<int64_t,ChromeTrace::NCOUNTERS> ChromeTrace :: ReadCounters (ThreadData & td)
+  {
+    std::array<int64_t,NCOUNTERS> values;
+    values.fill (0);
+#ifdef __linux__
+    // counters measure the thread which opens them, worker threads may be new
+    int tid = syscall (SYS_gettid);
+    if (!td.counters_opened || td.tid != tid)
+      {
+        for (int & fd : td.fds)
+          if (fd >= 0) { close (fd); fd = -1; }
+        for (int i = 0; i < NCOUNTERS; i++)
+          td.fds[i] = OpenCounter (i, td.fds[0]);
+        if (td.fds[0] >= 0)
+          {
+            ioctl (td.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl (td.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+          }
+        td.counters_opened = true;
+        td.tid = tid;
+      }
+    if (td.fds[0] < 0) return values;
+
+    // values of the opened counters, in the order of opening
+    uint64_t buffer[1+NCOUNTERS];
+    if (read (td.fds[0], buffer, sizeof(buffer)) <= 0) return values;
+    for (int i = 0, j = 0; i < NCOUNTERS; i++)
+      if (td.fds[i] >= 0 && j < int(buffer[0]))
+        values[i] = buffer[1+j++];
+#endif
+    return values;
+  }
+
+
+  void ChromeTrace :: StartRegion (int name, CATEGORY cat)
+  {
+    auto & td = MyData();
+    if (td.events.Size() >= max_events)
+      {
+        // no record, but StopRegion has to know
+        td.open.Append (size_t(-1));
+        td.dropped++;
+        return;
+      }
+    td.open.Append (td.events.Size());
+    Event ev;
+    ev.name = name;
+    ev.cat = cat;
+    ev.stop = -1;
+    if (use_counters)
+      ev.counters = ReadCounters (td);
+    ev.start = Now();
+    td.events.Append (ev);
+  }
+
+  void ChromeTrace :: StopRegion ()
+  {
+    int64_t now = Now();
+    auto & td = MyData();
+    // region started before the trace
+    if (td.open.Size() == 0) return;
+    size_t nr = td.open.Last();
+    td.open.DeleteLast();
+    if (nr == size_t(-1)) return;
+
+    auto & ev = td.events[nr];
+    ev.stop = now;
+    if (use_counters)
+      {
+        auto values = ReadCounters (td);
+        for (int i = 0; i < NCOUNTERS; i++)
+          ev.counters[i] = values[i] - ev.counters[i];
+      }
+  }
+
+
+  static string JsonString (const string & str)
+  {
+    string res = "\"";
+    for (char c : str)
+      {
+        if (c == '"' || c == '\\')
+          res += '\\';
+        if (c == '\n')
+          res += "\\n";
+        else if (c == '\t')
+          res += "\\t";
+        else if (c < 0x20 && c >= 0)
+          continue;
+        else
+          res += c;
+      }
+    return res + "\"";
+  }
+
+  void ChromeTrace :: Write (const string & afilename)
+  {
+    static Timer t("ChromeTrace::Write"); RegionTimer reg(t);
+    ofstream out(afilename);
+    if (!out)
+      throw Exception ("ChromeTrace: cannot open file " + afilename);
+    out.precision (15);
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << endl;
+    out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << rank
+        << ",\"args\":{\"name\":\"rank " << rank << "\"}}";
+
+    size_t dropped = 0;
+    Array<string> mynames;
+    {
+      lock_guard<mutex> guard(names_mutex);
+      mynames = names;
+    }
+    for (auto tnr : Range(threads))
+      {
+        auto & td = threads[tnr];
+        dropped += td.dropped;
+        if (td.events.Size() == 0) continue;
+        out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << rank << ",\"tid\":" << tnr
+            << ",\"args\":{\"name\":\"thread " << tnr << "\"}}";
+        for (auto & ev : td.events)
+          {
+            // still open regions end now
+            int64_t stop = ev.stop >= 0 ? ev.stop : Now();
+            out << ",\n{\"ph\":\"X\",\"name\":" << JsonString(mynames[ev.name])
+                << ",\"cat\":\"" << category_names[ev.cat] << "\""
+                << ",\"pid\":" << rank << ",\"tid\":" << tnr
+                << ",\"ts\":" << 1e-3*ev.start << ",\"dur\":" << 1e-3*(stop-ev.start);
+            if (use_counters && ev.stop >= 0)
+              {
+                out << ",\"args\":{";
+                for (int i = 0; i < NCOUNTERS; i++)
+                  out << (i ? "," : "") << "\"" << counter_names[i] << "\":" << ev.counters[i];
+                out << "}";
+              }
+            out << "}";
+          }
+      }
+    out << "\n]}" << endl;
+
+    if (dropped)
+      cerr << "ChromeTrace: " << dropped << " regions not recorded, "
+           << "more than " << max_events << " events per thread" << endl;
+  }
+}
@@ -0,0 +1,124 @@
+#ifndef FILE_CHROMETRACE
+#define FILE_CHROMETRACE
+
+#include <chrono>
+#include <map>
+
+/**************************************************************************/
+/* File:   chrometrace.hpp                                                */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+namespace ngstd
+{
+
+  /**
+     Trace of regions in the Chrome trace event format (JSON), to be
+     viewed by ui.perfetto.dev or chrome://tracing.
+
+     Every thread records its regions (timers, tasks, MPI calls) in its
+     own event list. With hardware counters (Linux perf events), the
+     counters of the thread are read at begin and end of every region,
+     the differences are written as arguments of the region. Reading
+     the counters is a system call, so counted regions should not be
+     too fine grained.
+  */
+  class NGS_DLL_HEADER ChromeTrace
+  {
+  public:
+    enum CATEGORY { CAT_TIMER, CAT_TASK, CAT_MPI, NCATEGORIES };
+    enum COUNTER { CYCLES, INSTRUCTIONS, CACHE_REFERENCES, CACHE_MISSES, NCOUNTERS };
+
+    struct Event
+    {
+      int name;
+      CATEGORY cat;
+      int64_t start, stop;     // in ns since the start of the trace
+      std::array<int64_t,NCOUNTERS> counters;
+    };
+
+  private:
+    struct alignas(64) ThreadData
+    {
+      Array<Event> events;
+      /// events of the open regions
+      Array<size_t> open;
+      /// perf event file descriptors, the first is the group leader
+      std::array<int,NCOUNTERS> fds;
+      bool counters_opened = false;
+      /// the thread which opened the counters
+      int tid = -1;
+      size_t dropped = 0;
+    };
+
+    Array<ThreadData> threads;
+    /// region names are shared by all traces
+    static Array<string> names;
+    static std::map<string,int> name_ids;
+    static mutex names_mutex;
+    std::chrono::steady_clock::time_point start_time;
+    bool use_counters;
+    size_t max_events;
+    string filename;
+    int rank = 0;
+
+    static ChromeTrace * active;
+
+    ThreadData & MyData();
+    int64_t Now() const
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now() - start_time).count();
+    }
+    std::array<int64_t,NCOUNTERS> ReadCounters (ThreadData & td);
+
+  public:
+    /// the trace is written to filename by Stop, in MPI runs with the rank appended
+    ChromeTrace (string afilename, bool ause_counters = false,
+                 size_t amax_events = 10000000);
+    ~ChromeTrace ();
+    /// stops recording and writes the trace
+    void Stop ();
+
+    /// the trace which records regions, or nullptr
+    static ChromeTrace * Active () { return active; }
+    /// hardware counters are available (Linux perf events, and allowed by perf_event_paranoid)
+    static bool HaveCounters ();
+
+    /// id of a region name, thread-safe
+    static int GetNameId (const string & name);
+
+    void StartRegion (int name, CATEGORY cat);
+    void StopRegion ();
+
+    const string & GetFileName () const { return filename; }
+    void Write (const string & afilename);
+  };
+
+
+  /// records a region in the active Chrome trace
+  class ChromeTraceRegion
+  {
+    ChromeTrace * trace;
+  public:
+    ChromeTraceRegion (const string & name, ChromeTrace::CATEGORY cat = ChromeTrace::CAT_TIMER)
+      : trace(ChromeTrace::Active())
+    {
+      if (trace) trace->StartRegion (ChromeTrace::GetNameId(name), cat);
+    }
+    /// with a name id from GetNameId, saves the lookup of the name
+    ChromeTraceRegion (int name, ChromeTrace::CATEGORY cat)
+      : trace(ChromeTrace::Active())
+    {
+      if (trace) trace->StartRegion (name, cat);
+    }
+    ~ChromeTraceRegion ()
+    {
+      if (trace) trace->StopRegion();
+    }
+    ChromeTraceRegion (const ChromeTraceRegion &) = delete;
+  };
+}
+
+#endif
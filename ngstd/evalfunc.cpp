@@ -445,6 +445,297 @@ namespace ngstd
   }
 
 
+  void EvalFunction :: Eval (const SIMD<double> * x, size_t xdist,
+                             SIMD<double> * y, size_t ydist, size_t npts) const
+  {
+    if (IsComplex())
+      throw Exception ("SIMD Eval called for complex EvalFunction");
+
+    // interpret in chunks of blocks, such that the stack stays in cache
+    constexpr size_t chunk = 16;
+    ArrayMem<SIMD<double>, 16*chunk> stack(program.Size()*chunk);
+    for (size_t first = 0; first < npts; first += chunk)
+      {
+        size_t n = min2(chunk, npts-first);
+        EvalChunk (x+first, xdist, stack.Data(), n);
+        for (int k = 0; k < res_type.vecdim; k++)
+          for (size_t i = 0; i < n; i++)
+            y[k*ydist+first+i] = stack[k*n+i];
+      }
+  }
+
+  void EvalFunction :: EvalChunk (const SIMD<double> * x, size_t xdist,
+                                  SIMD<double> * stack, size_t n) const
+  {
+    typedef SIMD<double> TS;
+    auto st = [stack,n] (int s) { return stack+s*n; };
+    // apply a scalar function lane by lane
+    auto lanewise = [] (TS a, auto func)
+      { return TS([a,func](int l) { return func(a[l]); }); };
+
+    int stacksize = -1;
+    for (int i = 0; i < program.Size(); i++)
+      {
+        TS * a = (stacksize >= 1) ? st(stacksize-1) : nullptr;
+        TS * b = (stacksize >= 0) ? st(stacksize) : nullptr;
+	switch (program[i].op)
+	  {
+	  case ADD:
+            for (size_t j = 0; j < n; j++) a[j] += b[j];
+	    stacksize--;
+	    break;
+
+	  case SUB:
+            for (size_t j = 0; j < n; j++) a[j] -= b[j];
+	    stacksize--;
+	    break;
+
+	  case MULT:
+            for (size_t j = 0; j < n; j++) a[j] *= b[j];
+	    stacksize--;
+	    break;
+
+	  case DIV:
+            for (size_t j = 0; j < n; j++) a[j] /= b[j];
+	    stacksize--;
+	    break;
+
+	  case VEC_ADD:
+	    {
+	      int dim = program[i].vecdim;
+	      for (int k = 0; k < dim; k++)
+                {
+                  TS * u = st(stacksize-2*dim+k+1), * v = st(stacksize-dim+k+1);
+                  for (size_t j = 0; j < n; j++) u[j] += v[j];
+                }
+	      stacksize -= dim;
+	      break;
+	    }
+
+	  case VEC_SUB:
+	    {
+	      int dim = program[i].vecdim;
+	      for (int k = 0; k < dim; k++)
+                {
+                  TS * u = st(stacksize-2*dim+k+1), * v = st(stacksize-dim+k+1);
+                  for (size_t j = 0; j < n; j++) u[j] -= v[j];
+                }
+	      stacksize -= dim;
+	      break;
+	    }
+
+	  case SCAL_VEC_MULT:
+	    {
+	      int dim = program[i].vecdim;
+              for (size_t j = 0; j < n; j++)
+                {
+                  TS scal = st(stacksize-dim)[j];
+                  for (int k = 0; k < dim; k++)
+                    st(stacksize-dim+k)[j] = scal * st(stacksize-dim+k+1)[j];
+                }
+	      stacksize--;
+	      break;
+	    }
+
+	  case VEC_VEC_MULT:
+	    {
+	      int dim = program[i].vecdim;
+              for (size_t j = 0; j < n; j++)
+                {
+                  TS scal = 0.0;
+                  for (int k = 0; k < dim; k++)
+                    scal += st(stacksize-2*dim+k+1)[j] * st(stacksize-dim+k+1)[j];
+                  st(stacksize-2*dim+1)[j] = scal;
+                }
+	      stacksize-=2*dim-1;
+	      break;
+	    }
+
+	  case VEC_ELEM:
+	    {
+	      int dim = program[i-1].vecdim;
+              for (size_t j = 0; j < n; j++)
+                {
+                  TS index = b[j];
+                  st(stacksize-dim)[j] = TS([&](int l)
+                                            { return st(stacksize-dim+int(index[l])-1)[j][l]; });
+                }
+	      stacksize -= dim;
+	      break;
+	    }
+
+	  case VEC_DIM:
+	    {
+	      int dim = program[i-1].vecdim;
+	      stacksize -= dim-1;
+              for (size_t j = 0; j < n; j++) st(stacksize)[j] = double(dim);
+	      break;
+	    }
+
+	  case NEG:
+            for (size_t j = 0; j < n; j++) b[j] = -b[j];
+	    break;
+
+	  case AND:
+            for (size_t j = 0; j < n; j++)
+              a[j] = IfPos(a[j]-eps, IfPos(b[j]-eps, TS(1.0), TS(0.0)), TS(0.0));
+	    stacksize--;
+	    break;
+
+	  case OR:
+            for (size_t j = 0; j < n; j++)
+              a[j] = IfPos(a[j]-eps, TS(1.0), IfPos(b[j]-eps, TS(1.0), TS(0.0)));
+	    stacksize--;
+	    break;
+
+	  case NOT:
+            for (size_t j = 0; j < n; j++)
+              b[j] = IfPos(b[j]-eps, TS(0.0), TS(1.0));
+	    break;
+
+	  case GREATER:
+            for (size_t j = 0; j < n; j++)
+              a[j] = IfPos(a[j]-b[j], TS(1.0), TS(0.0));
+	    stacksize--;
+	    break;
+
+	  case GREATEREQUAL:
+            for (size_t j = 0; j < n; j++)
+              a[j] = IfPos(b[j]-a[j], TS(0.0), TS(1.0));
+	    stacksize--;
+	    break;
+
+	  case EQUAL:
+            for (size_t j = 0; j < n; j++)
+              {
+                TS diff = a[j]-b[j];
+                a[j] = IfPos(diff-eps, TS(0.0), IfPos(-diff-eps, TS(0.0), TS(1.0)));
+              }
+	    stacksize--;
+	    break;
+
+	  case LESSEQUAL:
+            for (size_t j = 0; j < n; j++)
+              a[j] = IfPos(a[j]-b[j], TS(0.0), TS(1.0));
+	    stacksize--;
+	    break;
+
+	  case LESS:
+            for (size_t j = 0; j < n; j++)
+              a[j] = IfPos(b[j]-a[j], TS(1.0), TS(0.0));
+	    stacksize--;
+	    break;
+
+	  case CONSTANT:
+	    stacksize++;
+            for (size_t j = 0; j < n; j++)
+              st(stacksize)[j] = program[i].operand.val;
+	    break;
+
+	  case VARIABLE:
+	    for (int k = 0; k < program[i].vecdim; k++)
+	      {
+		stacksize++;
+                const TS * xk = x + (program[i].operand.varnum+k)*xdist;
+                for (size_t j = 0; j < n; j++)
+                  st(stacksize)[j] = xk[j];
+	      }
+	    break;
+
+	  case GLOBVAR:
+	    stacksize++;
+            for (size_t j = 0; j < n; j++)
+              st(stacksize)[j] = *program[i].operand.globvar;
+	    break;
+
+	  case GLOBGENVAR:
+            for (int k = 0; k < program[i].operand.globgenvar->Dimension(); k++)
+              {
+                stacksize++;
+                double val = program[i].operand.globgenvar->Value<double>(k);
+                for (size_t j = 0; j < n; j++)
+                  st(stacksize)[j] = val;
+              }
+	    break;
+
+	  case FUNCTION:
+            {
+              auto fun = program[i].operand.fun;
+              for (size_t j = 0; j < n; j++)
+                b[j] = lanewise (b[j], fun);
+              break;
+            }
+
+	  case SIN:
+            for (size_t j = 0; j < n; j++) b[j] = sin(b[j]);
+	    break;
+	  case COS:
+            for (size_t j = 0; j < n; j++) b[j] = cos(b[j]);
+	    break;
+	  case TAN:
+            for (size_t j = 0; j < n; j++) b[j] = tan(b[j]);
+	    break;
+	  case ATAN:
+            for (size_t j = 0; j < n; j++) b[j] = atan(b[j]);
+	    break;
+	  case ATAN2:
+            for (size_t j = 0; j < n; j++) a[j] = atan2(a[j], b[j]);
+	    stacksize--;
+	    break;
+	  case EXP:
+            for (size_t j = 0; j < n; j++) b[j] = exp(b[j]);
+	    break;
+	  case LOG:
+            for (size_t j = 0; j < n; j++) b[j] = log(b[j]);
+	    break;
+	  case ABS:
+	    {
+	      int dim = program[i].vecdim;
+              for (size_t j = 0; j < n; j++)
+                {
+                  TS sum = 0.0;
+                  for (int k = 0; k < dim; k++)
+                    sum += sqr (st(stacksize-k)[j]);
+                  st(stacksize-dim+1)[j] = sqrt(sum);
+                }
+              stacksize -= dim-1;
+	      break;
+	    }
+	  case SIGN:
+            for (size_t j = 0; j < n; j++)
+              b[j] = IfPos(b[j], TS(1.0), IfPos(-b[j], TS(-1.0), TS(0.0)));
+	    break;
+	  case SQRT:
+            for (size_t j = 0; j < n; j++) b[j] = sqrt(b[j]);
+	    break;
+	  case STEP:
+            for (size_t j = 0; j < n; j++)
+              b[j] = IfPos(-b[j], TS(0.0), TS(1.0));
+	    break;
+
+	  case COMMA:
+	    break;
+
+	  case BESSELJ0:
+            for (size_t j = 0; j < n; j++) b[j] = lanewise (b[j], bessj0);
+	    break;
+	  case BESSELJ1:
+            for (size_t j = 0; j < n; j++) b[j] = lanewise (b[j], bessj1);
+	    break;
+	  case BESSELY0:
+            for (size_t j = 0; j < n; j++) b[j] = lanewise (b[j], bessy0);
+	    break;
+	  case BESSELY1:
+            for (size_t j = 0; j < n; j++) b[j] = lanewise (b[j], bessy1);
+	    break;
+
+	  default:
+	    cerr << "undefined operation for EvalFunction" << endl;
+	  }
+      }
+  }
+
+
 
 
   bool EvalFunction :: IsConstant () const
@@ -168,6 +168,11 @@ public:
   /// evaluate multi-value complex function with real result
   void Eval (const complex<double> * x, double * y, int ydim) const;
 
+  /// evaluate multi-value real function for npts SIMD-blocks of points.
+  /// argument j of block i is x[j*xdist+i], result k is y[k*ydist+i]
+  void Eval (const SIMD<double> * x, size_t xdist,
+             SIMD<double> * y, size_t ydist, size_t npts) const;
+
   /*
   /// evaluate multi-value function
   template <typename TIN>
@@ -176,6 +181,10 @@ public:
   template <typename TIN, typename TCALC>
   void Eval (const TIN * x, TCALC * stack) const;
 
+protected:
+  /// interpret the program once for a chunk of n blocks, stack entry s is stack[s*n,...]
+  void EvalChunk (const SIMD<double> * x, size_t xdist, SIMD<double> * stack, size_t n) const;
+public:
 
   /// is expression complex valued ?
   bool IsComplex () const;
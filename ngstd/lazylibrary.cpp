@@ -0,0 +1,102 @@
+/**************************************************************************/
+/* File:   lazylibrary.cpp                                                */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+   plugin libraries loaded on first use
+*/
+
+
+#include <ngstd.hpp>
+#include "lazylibrary.hpp"
+
+#ifdef HAVE_DLFCN_H 
+#include <dlfcn.h>
+#else
+#include <windows.h>
+#endif
+
+
+namespace ngstd
+{
+  std::map<string,string> LazyLibraries :: providers;
+  std::map<string,bool> LazyLibraries :: loaded;
+  mutex LazyLibraries :: lazy_mutex;
+
+
+  void LoadSharedLibrary (string name)
+  {
+    static Timer t("LoadSharedLibrary"); RegionTimer reg(t);
+#ifdef HAVE_DLFCN_H
+#ifdef __APPLE__
+    name += ".dylib";
+#else
+    name += ".so";
+#endif
+    cout << IM(1) << "load shared library '" << name << "'" << endl;
+
+    void * handle = dlopen (name.c_str(), RTLD_LAZY | RTLD_GLOBAL);
+    if (!handle)
+      {
+        stringstream err;
+        err << "Cannot load shared library '" << name << "' \nerrmsg: "  << dlerror();
+        throw Exception (err.str());
+      }
+#else
+    name += ".dll";
+    cout << IM(1) << "load shared library '" << name << "'" << endl;
+
+    HINSTANCE handle = LoadLibrary (name.c_str());
+    if (!handle)
+      {
+        stringstream err;
+        err << "Cannot load shared library '" << name << "' \nerrmsg: "; //   << dlerror();
+        throw Exception (err.str());
+      }
+#endif
+  }
+
+
+  void LazyLibraries :: Add (const string & name, const string & library)
+  {
+    lock_guard<mutex> guard(lazy_mutex);
+    providers[name] = library;
+    if (!loaded.count(library))
+      loaded[library] = false;
+  }
+
+  bool LazyLibraries :: Pending (const string & name)
+  {
+    lock_guard<mutex> guard(lazy_mutex);
+    auto pos = providers.find(name);
+    return pos != providers.end() && !loaded[pos->second];
+  }
+
+  bool LazyLibraries :: Load (const string & name)
+  {
+    string library;
+    {
+      lock_guard<mutex> guard(lazy_mutex);
+      auto pos = providers.find(name);
+      if (pos == providers.end() || loaded[pos->second]) return false;
+      library = pos->second;
+      // marked before loading, the static objects of the library register
+      // their classes and may look up names again
+      loaded[library] = true;
+    }
+    cout << IM(3) << "'" << name << "' requested, load plugin " << library << endl;
+    LoadSharedLibrary (library);
+    return true;
+  }
+
+  void LazyLibraries :: Print (ostream & ost)
+  {
+    lock_guard<mutex> guard(lazy_mutex);
+    ost << "Lazy plugins:" << endl;
+    for (auto & p : providers)
+      ost << setw(20) << p.first << " " << p.second
+          << (loaded[p.second] ? " (loaded)" : "") << endl;
+  }
+}
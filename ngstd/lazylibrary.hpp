@@ -0,0 +1,44 @@
+#ifndef FILE_LAZYLIBRARY
+#define FILE_LAZYLIBRARY
+
+/**************************************************************************/
+/* File:   lazylibrary.hpp                                                */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+#include <map>
+
+namespace ngstd
+{
+
+  /// loads a shared library, the extension (.so, .dylib or .dll) is appended
+  NGS_DLL_HEADER void LoadSharedLibrary (string name);
+
+
+  /**
+     Plugin libraries loaded at the first lookup of one of their classes.
+
+     A plugin library registers its FESpaces, integrators and numprocs
+     by static Register-objects when it is loaded. Instead of loading it
+     at startup, the names it provides are announced by Add, and the
+     registries (FESpaceClasses, Integrators, NumProcs) call Load for a
+     name they do not know.
+  */
+  class NGS_DLL_HEADER LazyLibraries
+  {
+    static std::map<string,string> providers;
+    static std::map<string,bool> loaded;
+    static mutex lazy_mutex;
+  public:
+    /// the class name is provided by library
+    static void Add (const string & name, const string & library);
+    /// loads the library providing name if not yet done, returns whether it was loaded now
+    static bool Load (const string & name);
+    /// name is provided by a library not yet loaded
+    static bool Pending (const string & name);
+    static void Print (ostream & ost);
+  };
+}
+
+#endif
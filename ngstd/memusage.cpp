@@ -0,0 +1,87 @@
+/**************************************************************************/
+/* File:   memusage.cpp                                                   */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+   memory usage tree, and memory of the process
+*/
+
+
+#include <ngstd.hpp>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+
+namespace ngstd
+{
+
+  MemoryUsageTree :: MemoryUsageTree (FlatArray<MemoryUsage> mu, const string & aname)
+    : name(aname)
+  {
+    for (auto & m : mu)
+      Add (m.Name(), m.NBytes(), m.NBlocks());
+  }
+
+  void MemoryUsageTree :: Add (const string & path, size_t bytes, size_t blocks)
+  {
+    nbytes += bytes;
+    nblocks += blocks;
+    if (path.empty()) return;
+
+    auto pos = path.find('/');
+    string first = path.substr (0, pos);
+    string rest = (pos == string::npos) ? string("") : path.substr (pos+1);
+
+    for (auto & c : children)
+      if (c.name == first)
+        {
+          c.Add (rest, bytes, blocks);
+          return;
+        }
+    children.push_back (MemoryUsageTree(first));
+    children.back().Add (rest, bytes, blocks);
+  }
+
+  void MemoryUsageTree :: Print (ostream & ost, int level) const
+  {
+    ost << string(2*level, ' ') << setw(std::max(1, 50-2*level)) << left << name << right
+        << setw(12) << nbytes/1e6 << " MB" << setw(10) << nblocks << " blocks" << endl;
+
+    // largest first
+    Array<int> order(children.size());
+    for (size_t i = 0; i < children.size(); i++) order[i] = i;
+    QuickSort (order, [&] (int a, int b) { return children[a].nbytes > children[b].nbytes; });
+    for (int i : order)
+      children[i].Print (ost, level+1);
+  }
+
+
+  size_t GetProcessMemory ()
+  {
+#ifdef __linux__
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (statm >> pages >> resident)
+      return resident * sysconf(_SC_PAGESIZE);
+#endif
+    return 0;
+  }
+
+  size_t GetProcessPeakMemory ()
+  {
+#ifndef WIN32
+    rusage usage;
+    if (getrusage (RUSAGE_SELF, &usage) == 0)
+#ifdef __APPLE__
+      return usage.ru_maxrss;        // bytes
+#else
+      return usage.ru_maxrss * 1024; // kilobytes
+#endif
+#endif
+    return 0;
+  }
+}
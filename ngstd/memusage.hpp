@@ -1,6 +1,8 @@
 #ifndef FILE_MEMUSAGE
 #define FILE_MEMUSAGE
 
+#include <vector>
+
 /**************************************************************************/
 /* File:   memusage.hpp                                                   */
 /* Author: Joachim Schoeberl                                              */
@@ -31,11 +33,63 @@ public:
   MemoryUsage & operator= (MemoryUsage &&) = default;
   
   void AddName (const string & aname) { name += aname; }
+  /// the entry becomes a child of parent, '/' separates the levels
+  void AddParent (const string & parent) { name = parent + "/" + name; }
   const string & Name() const { return name; }
   size_t NBytes () const { return nbytes; }
   size_t NBlocks () const { return nblocks; }
 };
 
+
+/// the entries of mu become children of parent
+inline Array<MemoryUsage> MemoryUsageChildren (const string & parent, Array<MemoryUsage> mu)
+{
+  for (auto & m : mu)
+    m.AddParent (parent);
+  return mu;
+}
+
+/// bytes of an array
+template <typename T>
+inline size_t MemoryBytes (FlatArray<T> a) { return a.Size()*sizeof(T); }
+
+/// bytes of a table, entries and index
+template <typename T>
+inline size_t MemoryBytes (const Table<T> & t)
+{
+  return t.AsArray().Size()*sizeof(T) + (t.Size()+1)*sizeof(size_t);
+}
+
+
+/**
+   Memory usage shown as a tree: the levels of the names are the nodes,
+   the bytes of a node are the sum over its children.
+ */
+class NGS_DLL_HEADER MemoryUsageTree
+{
+public:
+  string name;
+  size_t nbytes = 0;
+  size_t nblocks = 0;
+  std::vector<MemoryUsageTree> children;
+
+  MemoryUsageTree (const string & aname = "total") : name(aname) { ; }
+  MemoryUsageTree (FlatArray<MemoryUsage> mu, const string & aname = "total");
+
+  void Add (const string & path, size_t bytes, size_t blocks);
+  void Print (ostream & ost, int level = 0) const;
+};
+
+inline ostream & operator<< (ostream & ost, const MemoryUsageTree & tree)
+{
+  tree.Print (ost);
+  return ost;
+}
+
+/// resident memory of the process, current and peak, in bytes
+NGS_DLL_HEADER size_t GetProcessMemory ();
+NGS_DLL_HEADER size_t GetProcessPeakMemory ();
+
 }
 
 #endif
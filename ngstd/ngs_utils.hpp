@@ -23,7 +23,39 @@ namespace ngstd
   {
     return x;
   }
-  
+
+
+  /// replaces a[i] by start + a[0] + ... + a[i-1], returns the total.
+  /// local sums of blocks are computed in parallel, then scanned
+  template <typename T>
+  T ParallelExclusiveScan (FlatArray<T> a, T start = T(0))
+  {
+    size_t n = a.Size();
+    size_t nblocks = min2 (n/4096+1, size_t(4*TaskManager::GetNumThreads()));
+    Array<T> offsets(nblocks+1);
+    ParallelFor (nblocks, [&] (size_t b)
+                 {
+                   T sum = 0;
+                   for (auto i : Range(n).Split(b, nblocks))
+                     sum += a[i];
+                   offsets[b+1] = sum;
+                 });
+    offsets[0] = start;
+    for (size_t b = 0; b < nblocks; b++)
+      offsets[b+1] += offsets[b];
+    ParallelFor (nblocks, [&] (size_t b)
+                 {
+                   T sum = offsets[b];
+                   for (auto i : Range(n).Split(b, nblocks))
+                     {
+                       T ai = a[i];
+                       a[i] = sum;
+                       sum += ai;
+                     }
+                 });
+    return offsets[nblocks];
+  }
+
 
   // ////////////////    integral constants
 
@@ -140,6 +140,7 @@ namespace ngstd
 
 #include "simd.hpp"
 #include "simd_complex.hpp"
+#include "simd_float.hpp"
 
 #include "blockalloc.hpp"
 #include "autoptr.hpp"
@@ -155,6 +156,11 @@ namespace ngstd
 #include "statushandler.hpp"
 
 #include "mpiwrapper.hpp"
+#include "chrometrace.hpp"
+#include "roofline.hpp"
+#include "parallelstats.hpp"
+#include "lazylibrary.hpp"
+#include "outputqueue.hpp"
 #ifndef WIN32
 #include "sockets.hpp"
 #endif
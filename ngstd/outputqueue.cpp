@@ -0,0 +1,142 @@
+/**************************************************************************/
+/* File:   outputqueue.cpp                                                */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+#include <ngstd.hpp>
+#include <chrono>
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ngstd
+{
+  atomic<int> BackgroundPriority :: critical{0};
+
+  void BackgroundPriority :: Lower ()
+  {
+#ifdef __linux__
+    // the nice value is per thread on Linux
+    pid_t tid = syscall (SYS_gettid);
+    setpriority (PRIO_PROCESS, tid, min (getpriority (PRIO_PROCESS, tid) + 10, 19));
+#endif
+  }
+
+  void BackgroundPriority :: WaitForCritical (double max_delay)
+  {
+    if (!CriticalActive()) return;
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(max_delay);
+    while (CriticalActive() && std::chrono::steady_clock::now() < end)
+      std::this_thread::sleep_for (std::chrono::milliseconds(1));
+  }
+
+
+  OutputQueue :: ~OutputQueue ()
+  {
+    Wait (false);
+    {
+      lock_guard<mutex> guard(queue_mutex);
+      stop = true;
+    }
+    queue_cv.notify_all ();
+    if (worker.joinable())
+      worker.join ();
+  }
+
+  void OutputQueue :: WorkerLoop ()
+  {
+    BackgroundPriority::Lower ();
+    while (true)
+      {
+        function<void()> job;
+        size_t bytes;
+        {
+          unique_lock<mutex> guard(queue_mutex);
+          queue_cv.wait (guard, [&] { return stop || !jobs.empty(); });
+          if (jobs.empty()) return;
+          job = std::move(jobs.front().first);
+          bytes = jobs.front().second;
+          jobs.pop_front ();
+          busy = true;
+        }
+
+        BackgroundPriority::WaitForCritical ();
+        string msg;
+        try
+          {
+            job ();
+          }
+        catch (Exception & e)
+          {
+            msg = e.What();
+          }
+        catch (std::exception & e)
+          {
+            msg = e.what();
+          }
+        job = nullptr;   // releases the snapshot
+
+        {
+          lock_guard<mutex> guard(queue_mutex);
+          pending_bytes -= bytes;
+          busy = false;
+          if (msg.length() && !error.length())
+            error = msg;
+        }
+        queue_cv.notify_all ();
+      }
+  }
+
+  void OutputQueue :: Add (function<void()> job, size_t bytes)
+  {
+    unique_lock<mutex> guard(queue_mutex);
+    if (!worker.joinable())
+      worker = std::thread([this] () { WorkerLoop(); });
+    // bounded memory, but one job can always be queued
+    queue_cv.wait (guard, [&] { return (jobs.empty() && !busy) || pending_bytes + bytes <= max_bytes; });
+    jobs.emplace_back (std::move(job), bytes);
+    pending_bytes += bytes;
+    guard.unlock();
+    queue_cv.notify_all ();
+  }
+
+  void OutputQueue :: Wait (bool rethrow)
+  {
+    static Timer t("OutputQueue::Wait"); RegionTimer reg(t);
+    unique_lock<mutex> guard(queue_mutex);
+    queue_cv.wait (guard, [&] { return jobs.empty() && !busy; });
+    if (error.length())
+      {
+        string msg = error;
+        error = "";
+        if (rethrow)
+          throw Exception ("background output failed: " + msg);
+        cerr << "background output failed: " << msg << endl;
+      }
+  }
+
+  size_t OutputQueue :: NumPending ()
+  {
+    lock_guard<mutex> guard(queue_mutex);
+    return jobs.size() + (busy ? 1 : 0);
+  }
+
+  void OutputQueue :: SetMaxBytes (size_t amax_bytes)
+  {
+    {
+      lock_guard<mutex> guard(queue_mutex);
+      max_bytes = amax_bytes;
+    }
+    queue_cv.notify_all ();
+  }
+
+  OutputQueue & OutputQueue :: Global ()
+  {
+    static OutputQueue queue;
+    return queue;
+  }
+
+}
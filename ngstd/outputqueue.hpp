@@ -0,0 +1,90 @@
+#ifndef FILE_OUTPUTQUEUE
+#define FILE_OUTPUTQUEUE
+
+/**************************************************************************/
+/* File:   outputqueue.hpp                                                */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+#include <thread>
+#include <condition_variable>
+#include <deque>
+
+namespace ngstd
+{
+
+  /**
+     Background output. Jobs (formatting and writing files) are run in
+     order by one output thread while the computation goes on. A job
+     works on a snapshot of the data it owns, bytes is its size. The
+     queued bytes are bounded, Add waits for the output thread if the
+     bound is exceeded.
+
+     Jobs run outside the task manager, they must not use ParallelFor.
+     The first exception thrown by a job is rethrown by Wait.
+  */
+  class NGS_DLL_HEADER OutputQueue
+  {
+    std::deque<std::pair<function<void()>, size_t>> jobs;
+    size_t pending_bytes = 0;
+    size_t max_bytes;
+    /// a job is running
+    bool busy = false;
+    bool stop = false;
+    string error;
+    mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::thread worker;
+
+    void WorkerLoop ();
+  public:
+    OutputQueue (size_t amax_bytes = size_t(1) << 30) : max_bytes(amax_bytes) { ; }
+    /// waits for the queued jobs
+    ~OutputQueue ();
+
+    void Add (function<void()> job, size_t bytes);
+    /// waits until all jobs are done, rethrows the error of a job if rethrow is set
+    void Wait (bool rethrow = true);
+
+    size_t NumPending ();
+    void SetMaxBytes (size_t amax_bytes);
+
+    /// the queue of VTK outputs and GridFunction saves
+    static OutputQueue & Global ();
+  };
+
+
+  /**
+     Priorities of the background threads (output queue, snapshot
+     writer, compilation of CoefficientFunctions) against the task
+     manager. Background threads run with lower OS priority, such that
+     the workers of the task manager preempt them.
+
+     Solver-critical work (matrix-vector products) is marked by a
+     CriticalWork region. A background thread does not start a new job
+     while a critical region is active, but waits at most max_delay
+     seconds, such that background work is never starved.
+  */
+  class NGS_DLL_HEADER BackgroundPriority
+  {
+    static atomic<int> critical;
+    friend class CriticalWork;
+  public:
+    /// lowers the OS priority of the calling thread
+    static void Lower ();
+    /// waits while critical work is running, at most max_delay seconds
+    static void WaitForCritical (double max_delay = 0.05);
+    static bool CriticalActive () { return critical.load(std::memory_order_relaxed) > 0; }
+  };
+
+  class CriticalWork
+  {
+  public:
+    CriticalWork () { BackgroundPriority::critical++; }
+    ~CriticalWork () { BackgroundPriority::critical--; }
+  };
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+/**************************************************************************/
+/* File:   parallelstats.cpp                                              */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+   thread-scaling statistics of parallel regions
+*/
+
+
+#include <ngstd.hpp>
+#include "parallelstats.hpp"
+#include <thread>
+
+
+namespace ngstd
+{
+  bool ParallelStats :: active = getenv ("NGS_PARALLEL_STATS") != nullptr;
+  Array<ParallelStats::Site*> ParallelStats :: sites;
+  mutex ParallelStats :: sites_mutex;
+  int ParallelStats :: depth = 0;
+  double ParallelStats :: last_stop = -1;
+
+  // summary at the end of the program, if switched on by the environment
+  static struct ParallelStatsAtExit
+  {
+    ~ParallelStatsAtExit ()
+    {
+      if (getenv ("NGS_PARALLEL_STATS"))
+        ParallelStats::Print (cout);
+    }
+  } parallel_stats_at_exit;
+
+
+  void ParallelStats :: Enable (bool enable)
+  {
+    active = enable;
+    depth = 0;
+    last_stop = -1;
+  }
+
+  ParallelStats::Site * ParallelStats :: GetSite (const string & name)
+  {
+    lock_guard<mutex> guard(sites_mutex);
+    for (auto site : sites)
+      if (site->name == name)
+        return site;
+    // never freed, the sites are held in static variables of the call-sites
+    auto site = new Site;
+    site->name = name;
+    site->threads.SetSize (max2 (size_t(TaskManager::GetMaxThreads()),
+                                 size_t(std::thread::hardware_concurrency())));
+    sites.Append (site);
+    return site;
+  }
+
+  void ParallelStats :: Reset ()
+  {
+    lock_guard<mutex> guard(sites_mutex);
+    for (auto site : sites)
+      {
+        site->calls = 0;
+        site->wall = site->serial = site->thread_wall = 0;
+        for (auto & ts : site->threads)
+          ts = ThreadStat();
+      }
+    depth = 0;
+    last_stop = -1;
+  }
+
+
+  // only the outermost regions of the master thread are counted,
+  // regions started inside tasks contribute their tasks
+
+  void ParallelStats :: StartRegion (Site * site, double time)
+  {
+    if (TaskManager::GetThreadId() != 0) return;
+    if (depth++ > 0) return;
+    if (last_stop >= 0)
+      site->serial += time-last_stop;
+  }
+
+  void ParallelStats :: StopRegion (Site * site, double start, double time)
+  {
+    if (TaskManager::GetThreadId() != 0) return;
+    if (--depth > 0) return;
+    depth = 0;
+    site->calls++;
+    site->wall += time-start;
+    site->thread_wall += (time-start) * TaskManager::GetNumThreads();
+    last_stop = time;
+  }
+
+
+  void ParallelStats :: Print (ostream & ost)
+  {
+    Array<Site*> mysites;
+    {
+      lock_guard<mutex> guard(sites_mutex);
+      for (auto site : sites)
+        if (site->calls)
+          mysites.Append (site);
+    }
+    QuickSort (mysites, [] (Site * a, Site * b)
+               { return a->wall+a->serial > b->wall+b->serial; });
+
+    double total_wall = 0, total_serial = 0;
+    for (auto site : mysites)
+      {
+        total_wall += site->wall;
+        total_serial += site->serial;
+      }
+
+    ost << "Parallel regions, " << TaskManager::GetNumThreads() << " threads" << endl;
+    ost << setw(40) << left << "region" << right
+        << setw(8) << "calls" << setw(10) << "tasks" << setw(12) << "task [us]"
+        << setw(12) << "wall" << setw(12) << "serial"
+        << setw(10) << "% busy" << setw(10) << "imbal" << endl;
+    for (auto site : mysites)
+      {
+        double busy = 0, maxbusy = 0;
+        size_t tasks = 0;
+        int active_threads = 0;
+        for (auto & ts : site->threads)
+          {
+            busy += ts.busy;
+            maxbusy = max2 (maxbusy, ts.busy);
+            tasks += ts.tasks;
+            if (ts.tasks) active_threads++;
+          }
+        // busiest thread against the average of the threads
+        double imbalance = busy > 0 ? maxbusy * active_threads / busy : 1;
+        ost << setw(40) << left << site->name.substr(0,39) << right
+            << setw(8) << site->calls << setw(10) << tasks
+            << setw(12) << (tasks ? 1e6 * busy / tasks : 0.0)
+            << setw(12) << site->wall << setw(12) << site->serial
+            << setw(10) << (site->thread_wall > 0 ? 100 * busy / site->thread_wall : 0.0)
+            << setw(10) << imbalance << endl;
+      }
+    ost << "parallel regions " << total_wall << " s, serial between them " << total_serial << " s";
+    if (total_wall+total_serial > 0)
+      ost << " (" << 100 * total_serial / (total_wall+total_serial) << "% serial)";
+    ost << endl;
+  }
+}
@@ -0,0 +1,120 @@
+#ifndef FILE_PARALLELSTATS
+#define FILE_PARALLELSTATS
+
+/**************************************************************************/
+/* File:   parallelstats.hpp                                              */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+namespace ngstd
+{
+
+  /**
+     Thread-scaling statistics of parallel regions, per call-site.
+
+     A parallel region (one ParallelFor, one IterateElements, ...) is
+     recorded by a ParallelStatsRegion in the calling thread, every task
+     of the region by a ParallelStatsTask in the executing thread.
+     For every call-site the statistics collect the calls, tasks, wall
+     time, the busy time of every thread and the idle time
+     nthreads*wall - busy (waiting at the end of a region or at the
+     barrier between colors). The time spent by the master thread
+     between outermost parallel regions is the serial time, it is
+     attributed to the region which follows.
+
+     Recording is off by default, it is switched on by Enable, or by
+     the environment variable NGS_PARALLEL_STATS, then the summary is
+     printed at the end of the program.
+  */
+  class NGS_DLL_HEADER ParallelStats
+  {
+  public:
+    struct alignas(64) ThreadStat
+    {
+      double busy = 0;
+      size_t tasks = 0;
+    };
+
+    struct Site
+    {
+      string name;
+      size_t calls = 0;
+      double wall = 0;
+      /// master thread time since the end of the previous parallel region
+      double serial = 0;
+      /// nthreads of the calls summed up, for the idle time
+      double thread_wall = 0;
+      Array<ThreadStat> threads;
+    };
+
+  private:
+    static bool active;
+    static Array<Site*> sites;
+    static mutex sites_mutex;
+    /// depth of parallel regions in the master thread
+    static int depth;
+    static double last_stop;
+
+  public:
+    static bool Active () { return active; }
+    static void Enable (bool enable = true);
+    /// statistics of the call-site, created at the first call, thread-safe
+    static Site * GetSite (const string & name);
+    static void Reset ();
+
+    static void StartRegion (Site * site, double time);
+    static void StopRegion (Site * site, double start, double time);
+
+    /// the sites sorted by wall plus serial time
+    static void Print (ostream & ost);
+  };
+
+
+  /// records a parallel region, in the thread which starts it
+  class ParallelStatsRegion
+  {
+    ParallelStats::Site * site = nullptr;
+    double start;
+  public:
+    ParallelStatsRegion (ParallelStats::Site * asite)
+    {
+      if (!ParallelStats::Active()) return;
+      site = asite;
+      start = WallTime();
+      ParallelStats::StartRegion (site, start);
+    }
+    ~ParallelStatsRegion ()
+    {
+      if (site) ParallelStats::StopRegion (site, start, WallTime());
+    }
+    ParallelStatsRegion (const ParallelStatsRegion &) = delete;
+  };
+
+
+  /// records a task of a parallel region, in the executing thread
+  class ParallelStatsTask
+  {
+    ParallelStats::Site * site = nullptr;
+    double start;
+  public:
+    ParallelStatsTask (ParallelStats::Site * asite)
+    {
+      if (!ParallelStats::Active()) return;
+      site = asite;
+      start = WallTime();
+    }
+    ~ParallelStatsTask ()
+    {
+      if (!site) return;
+      size_t tid = TaskManager::GetThreadId();
+      if (tid >= site->threads.Size()) return;
+      auto & ts = site->threads[tid];
+      ts.busy += WallTime()-start;
+      ts.tasks++;
+    }
+    ParallelStatsTask (const ParallelStatsTask &) = delete;
+  };
+}
+
+#endif
@@ -61,6 +61,9 @@ void PyDefVecBuffer( TCLASS & c )
 
 
 
+/// a region of the ChromeTrace, started and stopped by a Python with-block
+struct PyTraceRegion { int name; };
+
 void NGS_DLL_HEADER  ExportNgstd(py::module & m) {
   try {
       auto numpy = py::module::import("numpy");
@@ -82,6 +85,58 @@ void NGS_DLL_HEADER  ExportNgstd(py::module & m) {
     .def("SetMaxTracefileSize", &PajeTrace::SetMaxTracefileSize)
     ;
 
+  py::class_<ChromeTrace> (m, "ChromeTrace", docu_string(R"raw_string(
+Records regions of all threads in the Chrome trace event format (JSON),
+to be viewed by ui.perfetto.dev or chrome://tracing. Regions are
+element assembly tasks, MPI reductions and waits, and user regions.
+In MPI runs every rank writes its own file, with the rank appended to
+the filename and as process id.
+
+Use as context manager:
+
+  with ChromeTrace("trace.json", counters=True):
+      a.Assemble()
+
+Parameters:
+
+filename : string
+  output file, written when the trace is stopped
+
+counters : bool
+  record hardware counters (cycles, instructions, cache references and
+  misses) per region, needs Linux perf events
+
+maxevents : int
+  maximal number of regions per thread
+
+)raw_string"))
+    .def(py::init<string,bool,size_t>(), py::arg("filename")="trace.json",
+         py::arg("counters")=false, py::arg("maxevents")=10000000)
+    .def("__enter__", [](ChromeTrace & self) -> ChromeTrace & { return self; },
+         py::return_value_policy::reference)
+    .def("__exit__", [](ChromeTrace & self, py::object, py::object, py::object)
+         { self.Stop(); })
+    .def("Stop", &ChromeTrace::Stop, "stop recording and write the file")
+    .def_property_readonly("filename", &ChromeTrace::GetFileName)
+    .def_static("HaveCounters", &ChromeTrace::HaveCounters,
+                "hardware counters are available")
+    ;
+
+  py::class_<PyTraceRegion> (m, "TraceRegion", "region in the active ChromeTrace, use as context manager")
+    .def(py::init([](string name) { return PyTraceRegion { ChromeTrace::GetNameId(name) }; }),
+         py::arg("name"))
+    .def("__enter__", [](PyTraceRegion & self)
+         {
+           if (auto trace = ChromeTrace::Active())
+             trace->StartRegion (self.name, ChromeTrace::CAT_TIMER);
+         })
+    .def("__exit__", [](PyTraceRegion & self, py::object, py::object, py::object)
+         {
+           if (auto trace = ChromeTrace::Active())
+             trace->StopRegion ();
+         })
+    ;
+
 
   py::class_<ngstd::LocalHeap> (m, "LocalHeap", "A heap for fast memory allocation")
      .def(py::init<size_t,const char*>(), "size"_a=1000000, "name"_a="PyLocalHeap")
@@ -130,12 +185,63 @@ void NGS_DLL_HEADER  ExportNgstd(py::module & m) {
                  timer["counts"] = py::int_(NgProfiler::GetCounts(i));
                  timer["flops"] = py::float_(NgProfiler::GetFlops(i));
                  timer["Gflop/s"] = py::float_(NgProfiler::GetFlops(i)/NgProfiler::GetTime(i)*1e-9);
+                 timer["bytes"] = py::float_(Roofline::GetBytes(i));
+                 timer["GB/s"] = py::float_(Roofline::GetBytes(i)/NgProfiler::GetTime(i)*1e-9);
                  timers.append(timer);
                }
 	     return timers;
 	   }, "Returns list of timers"
 	   );
 
+  m.def("ProcessMemory", [] () { return py::make_tuple (GetProcessMemory(), GetProcessPeakMemory()); },
+        "resident memory of the process in bytes, (current, peak)");
+
+  m.def("SetMachinePeaks", &Roofline::SetMachinePeaks, py::arg("gflops"), py::arg("gbs"),
+        "peak floating point performance (GFlop/s) and memory bandwidth (GB/s) for RooflineReport");
+  m.def("RooflineReport", [](double min_time)
+        {
+          ostringstream ost;
+          Roofline::Print (ost, min_time);
+          return ost.str();
+        }, py::arg("min_time")=0,
+        "achieved GFlop/s and GB/s of the timers with byte counters, and their bound against the machine peaks");
+
+  m.def("EnableParallelStats", [](bool enable)
+        {
+          ParallelStats::Reset();
+          ParallelStats::Enable (enable);
+        }, py::arg("enable")=true,
+        "records calls, tasks, busy, idle and serial time of the parallel regions, and resets the statistics");
+  m.def("ParallelStatsReport", []()
+        {
+          ostringstream ost;
+          ParallelStats::Print (ost);
+          return ost.str();
+        },
+        "thread-scaling statistics of the parallel regions, sorted by their time");
+
+  m.def("WaitOutput", [] () { OutputQueue::Global().Wait(); },
+        py::call_guard<py::gil_scoped_release>(),
+        "waits for the background output (VTKOutput, GridFunction.Save with background=True)");
+  m.def("SetOutputMemory", [] (size_t bytes) { OutputQueue::Global().SetMaxBytes(bytes); },
+        py::arg("bytes"),
+        "bound of the snapshot memory queued for background output, default 1 GB");
+
+  m.def("AddLazyPlugin", [](string library, std::vector<string> names)
+        {
+          for (auto & name : names)
+            LazyLibraries::Add (name, library);
+        }, py::arg("library"), py::arg("names"),
+        "the shared library (without extension) provides the FESpaces, integrators or numprocs names,\n"
+        "it is loaded at the first lookup of one of them");
+  m.def("LazyPlugins", []()
+        {
+          ostringstream ost;
+          LazyLibraries::Print (ost);
+          return ost.str();
+        }, "plugins announced by AddLazyPlugin, and whether they are loaded");
+
+
   py::class_<Archive, shared_ptr<Archive>> (m, "Archive")
       /*
     .def("__init__", [](const string & filename, bool write,
@@ -201,7 +307,31 @@ void NGS_DLL_HEADER  ExportNgstd(py::module & m) {
           unpickler.attr("append")(MemoryView(mem,size));
         }, py::arg("unpickler"));
 
+  m.def("_MemoryViewFromBuffer", [] (py::buffer buf)
+        {
+          py::buffer_info info = buf.request();
+          size_t size = info.size * info.itemsize;
+          char* mem = new char[size];
+          memcpy(mem, info.ptr, size);
+          return MemoryView(mem, size);
+        }, py::arg("buffer"), "internal, rebuild a MemoryView from a (possibly out-of-band) pickle buffer");
+
   py::class_<MemoryView>(m, "_MemoryView")
+    // with pickle protocol 5 the memory is passed as PickleBuffer without copy,
+    // so it can be sent out-of-band (buffer_callback of the pickler)
+    .def("__reduce_ex__", [m] (MemoryView& mv, int protocol)
+         {
+           py::object frombuffer = m.attr("_MemoryViewFromBuffer");
+           if (protocol >= 5)
+             {
+               auto view = py::memoryview(py::buffer_info((char*) mv.Ptr(), mv.Size()));
+               auto pbuf = py::module::import("pickle").attr("PickleBuffer")(view);
+               return py::make_tuple(frombuffer, py::make_tuple(pbuf));
+             }
+           return py::make_tuple(frombuffer,
+                                 py::make_tuple(py::bytes((char*) mv.Ptr(), mv.Size())));
+         }, py::arg("protocol"))
+    // kept for unpickling data written by older versions
     .def(py::pickle([](MemoryView& mv)
                     {
                       if(have_numpy)
@@ -0,0 +1,99 @@
+/**************************************************************************/
+/* File:   roofline.cpp                                                   */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+   byte counters of timers, and roofline report
+*/
+
+
+#include <ngstd.hpp>
+#include "roofline.hpp"
+
+
+namespace ngstd
+{
+  std::array<std::atomic<double*>,Roofline::MAX_THREADS> Roofline :: thread_bytes { };
+
+  static double EnvPeak (const char * name)
+  {
+    const char * val = getenv (name);
+    return val ? atof (val) : 0;
+  }
+  double Roofline :: peak_gflops = EnvPeak ("NGS_PEAK_GFLOPS");
+  double Roofline :: peak_gbs = EnvPeak ("NGS_PEAK_GBS");
+
+
+  double * Roofline :: NewRow (size_t tid)
+  {
+    static mutex row_mutex;
+    if (tid >= MAX_THREADS)
+      throw Exception ("Roofline: thread id " + ToString(tid) + " too large");
+    lock_guard<mutex> guard(row_mutex);
+    double * row = thread_bytes[tid].load();
+    if (!row)
+      {
+        // never freed, as the timers themselves
+        row = new double[NgProfiler::SIZE]();
+        thread_bytes[tid].store (row, std::memory_order_release);
+      }
+    return row;
+  }
+
+  double Roofline :: GetBytes (int timer)
+  {
+    double sum = 0;
+    for (auto & row : thread_bytes)
+      if (double * r = row.load(std::memory_order_acquire))
+        sum += r[timer];
+    return sum;
+  }
+
+
+  void Roofline :: Print (ostream & ost, double min_time)
+  {
+    bool have_peaks = peak_gflops > 0 && peak_gbs > 0;
+    ost << "Roofline";
+    if (have_peaks)
+      ost << ", peaks " << peak_gflops << " GFlop/s, " << peak_gbs << " GB/s, ridge "
+          << peak_gflops/peak_gbs << " flop/byte";
+    else
+      ost << " (no machine peaks, set NGS_PEAK_GFLOPS and NGS_PEAK_GBS)";
+    ost << endl;
+    
+    ost << setw(50) << left << "timer" << right
+        << setw(12) << "time" << setw(12) << "GFlop/s" << setw(12) << "GB/s"
+        << setw(12) << "flop/byte";
+    if (have_peaks)
+      ost << setw(10) << "bound" << setw(10) << "% roof";
+    ost << endl;
+    
+    for (int i = 0; i < NgProfiler::SIZE; i++)
+      {
+        if (NgProfiler::timers[i].name.empty()) continue;
+        double bytes = GetBytes(i);
+        double time = NgProfiler::GetTime(i);
+        if (bytes == 0 || time <= min_time) continue;
+        double flops = NgProfiler::GetFlops(i);
+        double intensity = flops / bytes;
+        double gflops = 1e-9 * flops / time;
+        double gbs = 1e-9 * bytes / time;
+
+        ost << setw(50) << left << NgProfiler::timers[i].name.substr(0,49) << right
+            << setw(12) << time << setw(12) << gflops << setw(12) << gbs
+            << setw(12) << intensity;
+        if (have_peaks)
+          {
+            // attainable performance at this arithmetic intensity
+            bool memory_bound = intensity < peak_gflops / peak_gbs;
+            double roof = memory_bound ? intensity * peak_gbs : peak_gflops;
+            double achieved = flops > 0 ? gflops / roof : gbs / peak_gbs;
+            ost << setw(10) << (memory_bound ? "memory" : "compute")
+                << setw(10) << 100 * achieved;
+          }
+        ost << endl;
+      }
+  }
+}
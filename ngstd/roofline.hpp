@@ -0,0 +1,53 @@
+#ifndef FILE_ROOFLINE
+#define FILE_ROOFLINE
+
+/**************************************************************************/
+/* File:   roofline.hpp                                                   */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+namespace ngstd
+{
+
+  /**
+     Bytes moved per timer, the counterpart of the flop counters of the
+     NgProfiler, and a roofline report of the timers.
+     Every thread counts into its own row, as AddThreadFlops.
+     The machine peaks are set by SetMachinePeaks, or by the environment
+     variables NGS_PEAK_GFLOPS and NGS_PEAK_GBS.
+  */
+  class NGS_DLL_HEADER Roofline
+  {
+    enum { MAX_THREADS = 1024 };
+    static std::array<std::atomic<double*>,MAX_THREADS> thread_bytes;
+    static double peak_gflops, peak_gbs;
+    static double * NewRow (size_t tid);
+  public:
+    static void AddThreadBytes (int timer, size_t tid, double bytes)
+    {
+      double * row = thread_bytes[tid].load(std::memory_order_acquire);
+      if (!row) row = NewRow (tid);
+      row[timer] += bytes;
+    }
+    static void AddBytes (int timer, double bytes)
+    {
+      AddThreadBytes (timer, TaskManager::GetThreadId(), bytes);
+    }
+    /// bytes of the timer, summed over the threads
+    static double GetBytes (int timer);
+
+    static void SetMachinePeaks (double gflops, double gbs)
+    {
+      peak_gflops = gflops;
+      peak_gbs = gbs;
+    }
+    static double GetPeakGFlops () { return peak_gflops; }
+    static double GetPeakGBs () { return peak_gbs; }
+
+    /// achieved GFlop/s and GB/s of the timers with bytes, against the peaks
+    static void Print (ostream & ost, double min_time = 0);
+  };
+}
+
+#endif
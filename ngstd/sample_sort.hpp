@@ -7,98 +7,231 @@
 /* Date:   Nov 2017                                                       */
 /**************************************************************************/
 
-#include <random>
+#include <algorithm>
 
 namespace ngstd
 {
 
-  template <typename T, typename TI>
-void SampleSortI(FlatArray<T> data, FlatArray<TI> index)
-{
-  static Timer Tsample_sort("Sample Sort");
-  RegionTimer Rsample_sort(Tsample_sort);
-
-  size_t n = index.Size();
-  int nr_buckets = ngstd::TaskManager::GetNumThreads();
-  int sample_size = nr_buckets-1;
-  int over_sample = 10;
-  int over_sample_size = over_sample * sample_size;
-
-  Array<TI> over_sampled_ind(over_sample_size);
-
-  std::random_device rd;
-  std::mt19937 engine(rd());
-  std::uniform_int_distribution<int> dist(0, index.Size()-1);
-  for (auto i : Range(over_sample_size))
-    over_sampled_ind[i] = index[dist(engine)];
+  /// number of blocks for a parallel sort of n items
+  INLINE size_t SortBlocks (size_t n, size_t grain)
+  {
+    return max2 (size_t(1), min2 (n / grain, size_t(TaskManager::GetNumThreads())));
+  }
+
+
+  /**
+     Parallel sample sort by comparison.
+     Every block distributes its items to the buckets given by the
+     splitters, the buckets are sorted in parallel. Equal items go to
+     the same bucket in input order, with stable = true the buckets are
+     sorted by std::stable_sort and the sort is stable.
+  */
+  template <typename T, typename TLESS>
+  void ParallelSort (FlatArray<T> data, TLESS less, bool stable = false)
+  {
+    static Timer t("ParallelSort"); RegionTimer reg(t);
+    size_t n = data.Size();
+    size_t nblocks = SortBlocks (n, 16384);
+    if (nblocks == 1)
+      {
+        if (stable)
+          std::stable_sort (data.Data(), data.Data()+n, less);
+        else
+          std::sort (data.Data(), data.Data()+n, less);
+        return;
+      }
+    
+    // splitters from a regular over-sample, deterministic
+    size_t nbuckets = nblocks;
+    constexpr size_t over_sample = 16;
+    Array<T> samples(over_sample*nbuckets);
+    for (size_t i = 0; i < samples.Size(); i++)
+      samples[i] = data[(2*i+1) * n / (2*samples.Size())];
+    std::sort (samples.Data(), samples.Data()+samples.Size(), less);
+    Array<T> splitters(nbuckets-1);
+    for (size_t i = 0; i < splitters.Size(); i++)
+      splitters[i] = samples[(i+1)*over_sample];
+
+    Array<int> bucket(n);
+    Array<size_t> pos(nblocks*nbuckets);
+    pos = 0;
+    ParallelFor (nblocks, [&] (size_t b)
+      {
+        for (auto i : Range(n).Split (b, nblocks))
+          {
+            bucket[i] = std::upper_bound (splitters.Data(), splitters.Data()+splitters.Size(),
+                                          data[i], less) - splitters.Data();
+            pos[b*nbuckets+bucket[i]]++;
+          }
+      });
+
+    // bucket-major, block-minor offsets keep the input order of equal items
+    Array<size_t> first(nbuckets+1);
+    size_t sum = 0;
+    for (size_t bk = 0; bk < nbuckets; bk++)
+      {
+        first[bk] = sum;
+        for (size_t b = 0; b < nblocks; b++)
+          {
+            size_t cnt = pos[b*nbuckets+bk];
+            pos[b*nbuckets+bk] = sum;
+            sum += cnt;
+          }
+      }
+    first[nbuckets] = n;
+
+    Array<T> tmp(n);
+    ParallelFor (nblocks, [&] (size_t b)
+      {
+        size_t * mypos = &pos[b*nbuckets];
+        for (auto i : Range(n).Split (b, nblocks))
+          tmp[mypos[bucket[i]]++] = std::move(data[i]);
+      });
+
+    ParallelFor (nbuckets, [&] (size_t bk)
+      {
+        T * pb = tmp.Data()+first[bk], * pe = tmp.Data()+first[bk+1];
+        if (stable)
+          std::stable_sort (pb, pe, less);
+        else
+          std::sort (pb, pe, less);
+        std::move (pb, pe, data.Data()+first[bk]);
+      });
+  }
+
+  template <typename T>
+  void ParallelSort (FlatArray<T> data, bool stable = false)
+  {
+    ParallelSort (data, [] (const T & a, const T & b) { return a < b; }, stable);
+  }
+
   
-  QuickSortI(data, over_sampled_ind);
 
-  Array<TI> sample_ind(sample_size);
-  for (auto i : Range(sample_size)) {
-    sample_ind[i] = over_sampled_ind[i * over_sample];
+  /// order preserving map of integer keys to unsigned integers
+  template <typename TKEY>
+  INLINE auto RadixKey (TKEY key)
+  {
+    static_assert (std::is_integral<TKEY>::value, "radix sort needs integer keys");
+    typedef typename std::make_unsigned<TKEY>::type TU;
+    TU u = TU(key);
+    if (std::is_signed<TKEY>::value)
+      u ^= TU(1) << (8*sizeof(TKEY)-1);
+    return u;
   }
 
-  Array<int> bucket_of_ind(n);
-  ParallelFor(n, [&] (auto i) {
-      int start = 0;
-      int end = sample_size-1;
-      int mid = (start+end)/2;
-      while (start <= end) {
-        mid = (start+end)/2;
-        if (data[sample_ind[mid]] < data[i]) {
-          start = mid + 1;
-          continue;
-        }
-        else if (data[sample_ind[mid]] > data[i]) {
-          end = mid - 1;
-          continue;
-        }
-        else { break; }
-      }
-      if (start > end) {
-        bucket_of_ind[i] = start;
+  template <bool VALUES, typename TKEY, typename TVAL>
+  void ParallelRadixSortImpl (FlatArray<TKEY> keys, FlatArray<TVAL> values)
+  {
+    static Timer t("ParallelRadixSort"); RegionTimer reg(t);
+    typedef decltype(RadixKey(TKEY())) TU;
+    size_t n = keys.Size();
+    if (VALUES && values.Size() != n)
+      throw Exception ("ParallelRadixSort: keys and values of different sizes");
+    if (n < 2) return;
+
+    size_t nblocks = SortBlocks (n, 65536);
+    
+    // digits which are the same for all keys are skipped
+    Array<TU> kor(nblocks), kand(nblocks);
+    ParallelFor (nblocks, [&] (size_t b)
+      {
+        TU o = 0, a = ~TU(0);
+        for (auto i : Range(n).Split (b, nblocks))
+          {
+            o |= RadixKey(keys[i]);
+            a &= RadixKey(keys[i]);
+          }
+        kor[b] = o;
+        kand[b] = a;
+      });
+    TU diff = 0, all = ~TU(0);
+    for (size_t b = 0; b < nblocks; b++)
+      {
+        diff |= kor[b];
+        all &= kand[b];
       }
-      else {
-        bucket_of_ind[i] = mid;
+    diff ^= all;
+
+    Array<TKEY> tmpkeys(n);
+    Array<TVAL> tmpvalues(VALUES ? n : 0);
+    TKEY * src = keys.Data(), * dst = tmpkeys.Data();
+    TVAL * srcv = values.Data(), * dstv = tmpvalues.Data();
+    
+    constexpr int bits = 8, ndigits = 1 << bits;
+    Array<size_t> pos(nblocks*ndigits);
+    for (int shift = 0; shift < int(8*sizeof(TU)); shift += bits)
+      {
+        if (((diff >> shift) & (ndigits-1)) == 0) continue;
+        auto digit = [shift] (TKEY key) { return (RadixKey(key) >> shift) & (ndigits-1); };
+
+        pos = 0;
+        ParallelFor (nblocks, [&] (size_t b)
+          {
+            size_t * mypos = &pos[b*ndigits];
+            for (auto i : Range(n).Split (b, nblocks))
+              mypos[digit(src[i])]++;
+          });
+
+        // digit-major, block-minor offsets: stable
+        size_t sum = 0;
+        for (int d = 0; d < ndigits; d++)
+          for (size_t b = 0; b < nblocks; b++)
+            {
+              size_t cnt = pos[b*ndigits+d];
+              pos[b*ndigits+d] = sum;
+              sum += cnt;
+            }
+
+        ParallelFor (nblocks, [&] (size_t b)
+          {
+            size_t * mypos = &pos[b*ndigits];
+            for (auto i : Range(n).Split (b, nblocks))
+              {
+                size_t p = mypos[digit(src[i])]++;
+                dst[p] = src[i];
+                if (VALUES) dstv[p] = std::move(srcv[i]);
+              }
+          });
+        swap (src, dst);
+        swap (srcv, dstv);
       }
-    });
-
-  static Timer T3_2("Sample Sort - inverse index bucket map");
-  T3_2.Start();
-  ngstd::TableCreator<int> buckets_creator(nr_buckets);
-  for (; !buckets_creator.Done(); buckets_creator++) {
-    ParallelForRange (n, [&] (IntRange r)
-                      {
-                        ngstd::TableCreator<int> mycreator(nr_buckets);
-                        for (; !mycreator.Done(); mycreator++)                      
-                          for (auto i : r)
-                            mycreator.Add (bucket_of_ind[i], i);
-
-                        auto mytab = mycreator.MoveTable();
-                        for (auto i : Range(nr_buckets))
-                          buckets_creator.Add (i, mytab[i]);
-                      });
+
+    if (src != keys.Data())
+      ParallelForRange (n, [&] (IntRange r)
+        {
+          for (auto i : r)
+            {
+              keys[i] = src[i];
+              if (VALUES) values[i] = std::move(srcv[i]);
+            }
+        });
   }
-  
-  auto table = buckets_creator.MoveTable();
-  T3_2.Stop();
-
-  static Timer T4("Sample Sort - sort buckets");
-  T4.Start();
-  ParallelFor(nr_buckets, [&] (auto bucket) {
-    QuickSortI(data, table[bucket]);
-  });
-  T4.Stop();
-
-  size_t start = 0;
-  for (int bucket = 0; bucket < table.Size(); ++bucket) {
-    size_t end = start+table[bucket].Size();
-    index.Range(start, end) = table[bucket];
-    start = end;
+
+  /**
+     Stable parallel LSD radix sort of integer keys, 8 bit digits.
+     The values are permuted with the keys.
+  */
+  template <typename TKEY, typename TVAL>
+  void ParallelRadixSort (FlatArray<TKEY> keys, FlatArray<TVAL> values)
+  {
+    ParallelRadixSortImpl<true> (keys, values);
   }
-}
 
+  template <typename TKEY>
+  void ParallelRadixSort (FlatArray<TKEY> keys)
+  {
+    ParallelRadixSortImpl<false> (keys, FlatArray<char>(0, nullptr));
+  }
+
+  
+  /// sorts the index by data[index[i]]
+  template <typename T, typename TI>
+  void SampleSortI(FlatArray<T> data, FlatArray<TI> index)
+  {
+    static Timer Tsample_sort("Sample Sort");
+    RegionTimer Rsample_sort(Tsample_sort);
+    ParallelSort (index, [&] (TI a, TI b) { return data[a] < data[b]; });
+  }
 
 } 
 
@@ -57,6 +57,14 @@ namespace ngstd
 
 
   
+  // SVE is used only for a fixed vector length of 512 bits (-msve-vector-bits=512)
+  // the generic operators need the GNU vector operators on fixed length sve-types
+#if defined(__ARM_FEATURE_SVE_BITS) && defined(__ARM_FEATURE_SVE_VECTOR_OPERATORS)
+#if __ARM_FEATURE_SVE_BITS == 512
+#define NGS_SVE512
+#endif
+#endif
+  
   constexpr int GetDefaultSIMDSize() {
 #if defined __AVX512F__
     return 8;
@@ -64,6 +72,10 @@ namespace ngstd
     return 4;
 #elif defined __SSE__
     return 2;
+#elif defined NGS_SVE512
+    return 8;
+#elif defined __ARM_NEON
+    return 2;
 #else
     return 1;
 #endif
@@ -78,6 +90,13 @@ namespace ngstd
 #elif defined __SSE__
     typedef __m128 tAVX;
     typedef __m128d tAVXd; 
+#elif defined NGS_SVE512
+    typedef svfloat32_t tAVX __attribute__((arm_sve_vector_bits(512)));
+    typedef svfloat64_t tAVXd __attribute__((arm_sve_vector_bits(512)));
+    typedef svbool_t tSVEbool __attribute__((arm_sve_vector_bits(512)));
+#elif defined __ARM_NEON
+    typedef float32x4_t tAVX;
+    typedef float64x2_t tAVXd;
 #endif
 
   template <typename T, int N=GetDefaultSIMDSize()> class SIMD;
@@ -178,6 +197,21 @@ namespace ngstd
     static constexpr int Size() { return 2; }    
     mask64 operator[] (int i) const { return ((mask64*)(&mask))[i]; }    
   };
+#elif defined __ARM_NEON
+  template <> 
+  class SIMD<mask64,2>
+  {
+    int64x2_t mask;
+  public:
+    SIMD (int i)
+      : mask(vreinterpretq_s64_u64(vcgtq_s64(vdupq_n_s64(i),
+                                             vcombine_s64(vcreate_s64(0), vcreate_s64(1)))))
+    { ; }
+    SIMD (int64x2_t _mask) : mask(_mask) { ; }
+    int64x2_t Data() const { return mask; }
+    static constexpr int Size() { return 2; }    
+    mask64 operator[] (int i) const { return ((mask64*)(&mask))[i]; }    
+  };
 #endif
   
   
@@ -231,6 +265,18 @@ namespace ngstd
     static constexpr int Size() { return 8; }    
     // mask64 operator[] (int i) const { return ((mask64*)(&mask))[i]; }    
   };
+#elif defined NGS_SVE512
+  template <> 
+  class SIMD<mask64,8>
+  {
+    tSVEbool mask;
+  public:
+    SIMD (size_t i) : mask(svwhilelt_b64(uint64_t(0), uint64_t(i))) { ; }
+    SIMD (int i) : mask(svwhilelt_b64(int64_t(0), int64_t(i))) { ; }
+    SIMD (svbool_t _mask) : mask(_mask) { ; }        
+    svbool_t Data() const { return mask; }
+    static constexpr int Size() { return 8; }    
+  };
 #endif
 
   
@@ -339,6 +385,57 @@ namespace ngstd
                       SIMD<double,2>(_mm_unpackhi_pd(a.Data(),b.Data())));
   }
   
+#elif defined __ARM_NEON
+
+  template<>
+  class alignas(16) SIMD<double,2> : public AlignedAlloc<SIMD<double,2>>
+  {
+    float64x2_t data;
+    
+  public:
+    static constexpr int Size() { return 2; }
+    SIMD () {}
+    SIMD (const SIMD &) = default;
+    SIMD (double v0, double v1) { data = vcombine_f64(vdup_n_f64(v0), vdup_n_f64(v1)); }
+    
+    SIMD & operator= (const SIMD &) = default;
+
+    SIMD (double val) { data = vdupq_n_f64(val); }
+    SIMD (int val)    { data = vdupq_n_f64(val); }
+    SIMD (size_t val) { data = vdupq_n_f64(val); }
+
+    SIMD (double const * p) { data = vld1q_f64(p); }
+    // no masked load instruction, don't touch the masked out entries
+    SIMD (double const * p, SIMD<mask64,2> mask)
+      : SIMD (mask[0] ? p[0] : 0.0, mask[1] ? p[1] : 0.0) { ; }
+    SIMD (float64x2_t _data) { data = _data; }
+
+    void Store (double * p) { vst1q_f64(p, data); }
+    void Store (double * p, SIMD<mask64,2> mask)
+    {
+      if (mask[0]) p[0] = (*this)[0];
+      if (mask[1]) p[1] = (*this)[1];
+    }    
+    
+    template<typename T, typename std::enable_if<std::is_convertible<T, std::function<double(int)>>::value, int>::type = 0>
+    SIMD (const T & func)
+      : SIMD (double(func(0)), double(func(1))) { ; }
+    
+    INLINE double operator[] (int i) const { return ((double*)(&data))[i]; }
+    INLINE double & operator[] (int i) { return ((double*)(&data))[i]; }
+    INLINE float64x2_t Data() const { return data; }
+    INLINE float64x2_t & Data() { return data; }
+
+    operator tuple<double&,double&> ()
+    { return tuple<double&,double&>((*this)[0], (*this)[1]); }
+  };
+
+  INLINE auto Unpack (SIMD<double,2> a, SIMD<double,2> b)
+  {
+    return make_tuple(SIMD<double,2>(vzip1q_f64(a.Data(),b.Data())),
+                      SIMD<double,2>(vzip2q_f64(a.Data(),b.Data())));
+  }
+  
 #endif
 
   
@@ -546,6 +643,44 @@ namespace ngstd
     INLINE __m512d & Data() { return data; }
   };
 
+#elif defined NGS_SVE512
+
+  template<>
+  class SIMD<double,8> : public AlignedAlloc<SIMD<double,8>>
+  {
+    tAVXd data;
+  public:
+    static constexpr int Size() { return 8; }
+    SIMD () {}
+    SIMD (const SIMD &) = default;
+    SIMD & operator= (const SIMD &) = default;
+
+    SIMD (double val) { data = svdup_f64(val); }
+    SIMD (int val)    { data = svdup_f64(val); }
+    SIMD (size_t val) { data = svdup_f64(val); }
+    SIMD (double const * p) { data = svld1_f64(svptrue_b64(), p); }
+    // masked out lanes are zero and not accessed
+    SIMD (double const * p, SIMD<mask64,8> mask) { data = svld1_f64(mask.Data(), p); }
+    SIMD (svfloat64_t _data) { data = _data; }
+    
+    template<typename T, typename std::enable_if<std::is_convertible<T, std::function<double(int)>>::value, int>::type = 0>
+      SIMD (const T & func)
+    {
+      double hv[8];
+      for (int i = 0; i < 8; i++)
+        hv[i] = func(i);
+      data = svld1_f64(svptrue_b64(), hv);
+    }
+
+    void Store (double * p) { svst1_f64(svptrue_b64(), p, data); }
+    void Store (double * p, SIMD<mask64,8> mask) { svst1_f64(mask.Data(), p, data); }    
+    
+    INLINE double operator[] (int i) const { return ((double*)(&data))[i]; }
+    INLINE double & operator[] (int i) { return ((double*)(&data))[i]; }
+    INLINE tAVXd Data() const { return data; }
+    INLINE tAVXd & Data() { return data; }
+  };
+
 #endif
   
 
@@ -661,6 +796,36 @@ namespace ngstd
     SIMD<double,2> hsum2 = my_mm_hadd_pd (v3.Data(), v4.Data());
     return SIMD<double,4> (hsum1, hsum2);
   }
+
+#elif defined __ARM_NEON
+
+  INLINE SIMD<double,2> sqrt (SIMD<double,2> a) { return vsqrtq_f64(a.Data()); }
+  INLINE SIMD<double,2> fabs (SIMD<double,2> a) { return vabsq_f64(a.Data()); }
+  using std::floor;
+  INLINE SIMD<double,2> floor (SIMD<double,2> a) { return vrndmq_f64(a.Data()); }
+  using std::ceil;  
+  INLINE SIMD<double,2> ceil (SIMD<double,2> a) { return vrndpq_f64(a.Data()); }
+  INLINE SIMD<double,2> IfPos (SIMD<double,2> a, SIMD<double,2> b, SIMD<double,2> c)
+  { return vbslq_f64(vcgtzq_f64(a.Data()), b.Data(), c.Data()); }
+  INLINE SIMD<double,2> IfZero (SIMD<double,2> a, SIMD<double,2> b, SIMD<double,2> c)
+  { return vbslq_f64(vceqzq_f64(a.Data()), b.Data(), c.Data()); }
+
+  INLINE double HSum (SIMD<double,2> sd)
+  {
+    return vaddvq_f64 (sd.Data());
+  }
+
+  INLINE auto HSum (SIMD<double,2> sd1, SIMD<double,2> sd2)
+  {
+    return SIMD<double,2> (vpaddq_f64(sd1.Data(), sd2.Data()));
+  }
+
+  INLINE auto HSum (SIMD<double,2> v1, SIMD<double,2> v2, SIMD<double,2> v3, SIMD<double,2> v4)
+  {
+    SIMD<double,2> hsum1 = vpaddq_f64 (v1.Data(), v2.Data());
+    SIMD<double,2> hsum2 = vpaddq_f64 (v3.Data(), v4.Data());
+    return SIMD<double,4> (hsum1, hsum2);
+  }
 #endif
 
   
@@ -771,6 +936,43 @@ namespace ngstd
     return _mm256_add_pd (_mm256_permute2f128_pd (ab, cd, 1+2*16), _mm256_blend_pd (ab, cd, 12));
   }
   
+#elif defined NGS_SVE512
+  INLINE SIMD<double,8> sqrt (SIMD<double,8> a) { return svsqrt_f64_x(svptrue_b64(), a.Data()); }
+  INLINE SIMD<double,8> floor (SIMD<double,8> a) { return svrintm_f64_x(svptrue_b64(), a.Data()); }
+  INLINE SIMD<double,8> ceil (SIMD<double,8> a) { return svrintp_f64_x(svptrue_b64(), a.Data()); }
+  INLINE SIMD<double,8> fabs (SIMD<double,8> a) { return svabs_f64_x(svptrue_b64(), a.Data()); }
+  INLINE SIMD<double,8> IfPos (SIMD<double,8> a, SIMD<double,8> b, SIMD<double,8> c)
+  {
+    auto k = svcmpgt_n_f64(svptrue_b64(), a.Data(), 0.0);
+    return svsel_f64(k, b.Data(), c.Data());
+  }
+  INLINE SIMD<double,8> IfZero (SIMD<double,8> a, SIMD<double,8> b, SIMD<double,8> c)
+  {
+    auto k = svcmpeq_n_f64(svptrue_b64(), a.Data(), 0.0);
+    return svsel_f64(k, b.Data(), c.Data());
+  }
+
+  // trn1/trn2 on 64-bit elements are the per 128-bit lane unpacklo/hi of x86
+  INLINE auto Unpack (SIMD<double,8> a, SIMD<double,8> b)
+  {
+    return make_tuple(SIMD<double,8>(svtrn1_f64(a.Data(),b.Data())),
+                      SIMD<double,8>(svtrn2_f64(a.Data(),b.Data())));
+  }
+
+  INLINE double HSum (SIMD<double,8> sd)
+  {
+    return svaddv_f64(svptrue_b64(), sd.Data());
+  }
+
+  INLINE auto HSum (SIMD<double,8> sd1, SIMD<double,8> sd2)
+  {
+    return SIMD<double,2>(HSum(sd1), HSum(sd2));
+  }
+
+  INLINE SIMD<double,4> HSum (SIMD<double,8> v1, SIMD<double,8> v2, SIMD<double,8> v3, SIMD<double,8> v4)
+  {
+    return SIMD<double,4>(HSum(v1), HSum(v2), HSum(v3), HSum(v4));
+  }
 #endif
 
 
@@ -1054,6 +1256,26 @@ namespace ngstd
     return _mm256_fmadd_pd (_mm256_set1_pd(a), b.Data(), c.Data());
   }
 #endif
+#ifdef NGS_SVE512
+  INLINE SIMD<double,8> FMA (SIMD<double,8> a, SIMD<double,8> b, SIMD<double,8> c)
+  {
+    return svmla_f64_x (svptrue_b64(), c.Data(), a.Data(), b.Data());
+  }
+  INLINE SIMD<double,8> FMA (const double & a, SIMD<double,8> b, SIMD<double,8> c)
+  {
+    return svmla_n_f64_x (svptrue_b64(), c.Data(), b.Data(), a);
+  }
+#endif
+#ifdef __ARM_NEON
+  INLINE SIMD<double,2> FMA (SIMD<double,2> a, SIMD<double,2> b, SIMD<double,2> c)
+  {
+    return vfmaq_f64 (c.Data(), a.Data(), b.Data());
+  }
+  INLINE SIMD<double,2> FMA (const double & a, SIMD<double,2> b, SIMD<double,2> c)
+  {
+    return vfmaq_n_f64 (c.Data(), b.Data(), a);
+  }
+#endif
 
   // update form of fma
   template <int N>
@@ -1103,6 +1325,36 @@ namespace ngstd
 
   template <int i, typename T, int N>
   T get(SIMD<T,N> a) { return a[i]; }
+
+
+  // indexed load p[ind[0]], ..., p[ind[N-1]]
+  template <int N = GetDefaultSIMDSize()>
+  INLINE SIMD<double,N> Gather (double const * p, int const * ind)
+  {
+    return SIMD<double,N> ([p,ind] (int i) -> double { return p[ind[i]]; });
+  }
+
+#ifdef __AVX2__
+  template <>
+  INLINE SIMD<double,4> Gather<4> (double const * p, int const * ind)
+  {
+    return _mm256_i32gather_pd (p, _mm_loadu_si128((__m128i const*)ind), 8);
+  }
+#endif
+#ifdef __AVX512F__
+  template <>
+  INLINE SIMD<double,8> Gather<8> (double const * p, int const * ind)
+  {
+    return _mm512_i32gather_pd (_mm256_loadu_si256((__m256i const*)ind), p, 8);
+  }
+#elif defined NGS_SVE512
+  template <>
+  INLINE SIMD<double,8> Gather<8> (double const * p, int const * ind)
+  {
+    auto pg = svptrue_b64();
+    return svld1_gather_s64index_f64 (pg, p, svld1sw_s64 (pg, ind));
+  }
+#endif
   
 }
 
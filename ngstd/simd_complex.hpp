@@ -26,6 +26,10 @@ namespace ngstd
 #elif defined(__SSE__)
     return _mm_cmpgt_epi32(_mm_set1_epi32(nr),
                            _mm_set_epi32(0, 0, 0, 0));
+#elif defined(NGS_SVE512)
+    return svwhilelt_b64(int64_t(0), 2*int64_t(nr));
+#elif defined(__ARM_NEON)
+    return SIMD<mask64,2> (int64_t(nr) > 0 ? 2 : 0);
 #else
     return false;
 #endif
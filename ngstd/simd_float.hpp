@@ -0,0 +1,338 @@
+#ifndef FILE_SIMD_FLOAT
+#define FILE_SIMD_FLOAT
+
+/**************************************************************************/
+/* File:   simd_float.hpp                                                 */
+/* Author: Joachim Schoeberl                                              */
+/* Date:   Oct. 2026                                                      */
+/**************************************************************************/
+
+/*
+  single precision SIMD, same register width as SIMD<double>,
+  i.e. twice the number of lanes
+*/
+
+namespace ngstd
+{
+
+  constexpr int GetDefaultFloatSIMDSize() {
+#if defined __AVX512F__
+    return 16;
+#elif defined __AVX__
+    return 8;
+#elif defined __SSE__
+    return 4;
+#elif defined __ARM_NEON
+    return 4;
+#else
+    return 1;
+#endif
+  }
+
+
+  template<>
+  class SIMD<float,1>
+  {
+    float data;
+
+  public:
+    static constexpr int Size() { return 1; }
+    SIMD () {}
+    SIMD (const SIMD &) = default;
+    SIMD & operator= (const SIMD &) = default;
+    SIMD (float val) { data = val; }
+    SIMD (float const * p) { data = *p; }
+    SIMD (float const * p, int nr) { data = (nr > 0) ? *p : 0.0f; }
+
+    template <typename T, typename std::enable_if<std::is_convertible<T,std::function<float(int)>>::value,int>::type = 0>
+    SIMD (const T & func)
+    {
+      data = func(0);
+    }
+
+    void Store (float * p) { *p = data; }
+    void Store (float * p, int nr) { if (nr > 0) *p = data; }
+
+    float operator[] (int i) const { return ((float*)(&data))[i]; }
+    float Data() const { return data; }
+    float & Data() { return data; }
+  };
+
+
+
+#ifdef __SSE__
+  template<>
+  class alignas(16) SIMD<float,4> : public AlignedAlloc<SIMD<float,4>>
+  {
+    __m128 data;
+
+  public:
+    static constexpr int Size() { return 4; }
+    SIMD () {}
+    SIMD (const SIMD &) = default;
+    SIMD & operator= (const SIMD &) = default;
+
+    SIMD (float val) { data = _mm_set1_ps(val); }
+    SIMD (float const * p) { data = _mm_loadu_ps(p); }
+    // first nr lanes from p, others are zero
+    SIMD (float const * p, int nr)
+    {
+      data = _mm_set_ps (nr > 3 ? p[3] : 0.0f, nr > 2 ? p[2] : 0.0f,
+                         nr > 1 ? p[1] : 0.0f, nr > 0 ? p[0] : 0.0f);
+    }
+    SIMD (__m128 _data) { data = _data; }
+
+    template<typename T, typename std::enable_if<std::is_convertible<T, std::function<float(int)>>::value, int>::type = 0>
+    SIMD (const T & func)
+    {
+      data = _mm_set_ps(func(3), func(2), func(1), func(0));
+    }
+
+    void Store (float * p) { _mm_storeu_ps(p, data); }
+    void Store (float * p, int nr)
+    {
+      for (int i = 0; i < nr && i < 4; i++)
+        p[i] = (*this)[i];
+    }
+
+    INLINE float operator[] (int i) const { return ((float*)(&data))[i]; }
+    INLINE float & operator[] (int i) { return ((float*)(&data))[i]; }
+    INLINE __m128 Data() const { return data; }
+    INLINE __m128 & Data() { return data; }
+  };
+#elif defined __ARM_NEON
+  template<>
+  class alignas(16) SIMD<float,4> : public AlignedAlloc<SIMD<float,4>>
+  {
+    float32x4_t data;
+
+  public:
+    static constexpr int Size() { return 4; }
+    SIMD () {}
+    SIMD (const SIMD &) = default;
+    SIMD & operator= (const SIMD &) = default;
+
+    SIMD (float val) { data = vdupq_n_f32(val); }
+    SIMD (float const * p) { data = vld1q_f32(p); }
+    // first nr lanes from p, others are zero
+    SIMD (float const * p, int nr)
+    {
+      float hv[4] = { nr > 0 ? p[0] : 0.0f, nr > 1 ? p[1] : 0.0f,
+                      nr > 2 ? p[2] : 0.0f, nr > 3 ? p[3] : 0.0f };
+      data = vld1q_f32(hv);
+    }
+    SIMD (float32x4_t _data) { data = _data; }
+
+    template<typename T, typename std::enable_if<std::is_convertible<T, std::function<float(int)>>::value, int>::type = 0>
+    SIMD (const T & func)
+    {
+      float hv[4] = { func(0), func(1), func(2), func(3) };
+      data = vld1q_f32(hv);
+    }
+
+    void Store (float * p) { vst1q_f32(p, data); }
+    void Store (float * p, int nr)
+    {
+      for (int i = 0; i < nr && i < 4; i++)
+        p[i] = (*this)[i];
+    }
+
+    INLINE float operator[] (int i) const { return ((float*)(&data))[i]; }
+    INLINE float & operator[] (int i) { return ((float*)(&data))[i]; }
+    INLINE float32x4_t Data() const { return data; }
+    INLINE float32x4_t & Data() { return data; }
+  };
+#endif
+
+
+
+#ifdef __AVX__
+  INLINE __m256i FloatMask256 (int nr)
+  {
+    return _mm256_castps_si256 (_mm256_cmp_ps (_mm256_set1_ps(nr),
+                                               _mm256_set_ps(7,6,5,4,3,2,1,0),
+                                               _CMP_GT_OQ));
+  }
+
+  template<>
+  class SIMD<float,8> : public AlignedAlloc<SIMD<float,8>>
+  {
+    __m256 data;
+
+  public:
+    static constexpr int Size() { return 8; }
+    SIMD () {}
+    SIMD (const SIMD &) = default;
+    SIMD & operator= (const SIMD &) = default;
+
+    SIMD (float val) { data = _mm256_set1_ps(val); }
+    SIMD (float const * p) { data = _mm256_loadu_ps(p); }
+    SIMD (float const * p, int nr) { data = _mm256_maskload_ps(p, FloatMask256(nr)); }
+    SIMD (__m256 _data) { data = _data; }
+
+    template<typename T, typename std::enable_if<std::is_convertible<T, std::function<float(int)>>::value, int>::type = 0>
+    SIMD (const T & func)
+    {
+      data = _mm256_set_ps(func(7), func(6), func(5), func(4), func(3), func(2), func(1), func(0));
+    }
+
+    void Store (float * p) { _mm256_storeu_ps(p, data); }
+    void Store (float * p, int nr) { _mm256_maskstore_ps(p, FloatMask256(nr), data); }
+
+    INLINE float operator[] (int i) const { return ((float*)(&data))[i]; }
+    INLINE float & operator[] (int i) { return ((float*)(&data))[i]; }
+    INLINE __m256 Data() const { return data; }
+    INLINE __m256 & Data() { return data; }
+
+    SIMD<float,4> Lo() const { return _mm256_extractf128_ps(data, 0); }
+    SIMD<float,4> Hi() const { return _mm256_extractf128_ps(data, 1); }
+  };
+#endif
+
+
+
+#ifdef __AVX512F__
+  template<>
+  class SIMD<float,16> : public AlignedAlloc<SIMD<float,16>>
+  {
+    __m512 data;
+
+  public:
+    static constexpr int Size() { return 16; }
+    SIMD () {}
+    SIMD (const SIMD &) = default;
+    SIMD & operator= (const SIMD &) = default;
+
+    SIMD (float val) { data = _mm512_set1_ps(val); }
+    SIMD (float const * p) { data = _mm512_loadu_ps(p); }
+    SIMD (float const * p, int nr)
+    { data = _mm512_maskz_loadu_ps(__mmask16((1u << (nr < 16 ? nr : 16)) - 1), p); }
+    SIMD (__m512 _data) { data = _data; }
+
+    template<typename T, typename std::enable_if<std::is_convertible<T, std::function<float(int)>>::value, int>::type = 0>
+    SIMD (const T & func)
+    {
+      data = _mm512_set_ps(func(15), func(14), func(13), func(12), func(11), func(10), func(9), func(8),
+                           func(7), func(6), func(5), func(4), func(3), func(2), func(1), func(0));
+    }
+
+    void Store (float * p) { _mm512_storeu_ps(p, data); }
+    void Store (float * p, int nr)
+    { _mm512_mask_storeu_ps(p, __mmask16((1u << (nr < 16 ? nr : 16)) - 1), data); }
+
+    INLINE float operator[] (int i) const { return ((float*)(&data))[i]; }
+    INLINE float & operator[] (int i) { return ((float*)(&data))[i]; }
+    INLINE __m512 Data() const { return data; }
+    INLINE __m512 & Data() { return data; }
+  };
+#endif
+
+
+
+  template <int N>
+  INLINE SIMD<float,N> operator+ (SIMD<float,N> a, SIMD<float,N> b) { return a.Data()+b.Data(); }
+  template <int N>
+  INLINE SIMD<float,N> operator- (SIMD<float,N> a, SIMD<float,N> b) { return a.Data()-b.Data(); }
+  template <int N>
+  INLINE SIMD<float,N> operator- (SIMD<float,N> a) { return -a.Data(); }
+  template <int N>
+  INLINE SIMD<float,N> operator* (SIMD<float,N> a, SIMD<float,N> b) { return a.Data()*b.Data(); }
+  template <int N>
+  INLINE SIMD<float,N> operator/ (SIMD<float,N> a, SIMD<float,N> b) { return a.Data()/b.Data(); }
+  template <int N>
+  INLINE SIMD<float,N> operator* (float a, SIMD<float,N> b) { return SIMD<float,N>(a)*b; }
+  template <int N>
+  INLINE SIMD<float,N> operator* (SIMD<float,N> b, float a) { return SIMD<float,N>(a)*b; }
+  template <int N>
+  INLINE SIMD<float,N> operator+ (SIMD<float,N> a, float b) { return a+SIMD<float,N>(b); }
+  template <int N>
+  INLINE SIMD<float,N> operator+ (float a, SIMD<float,N> b) { return SIMD<float,N>(a)+b; }
+  template <int N>
+  INLINE SIMD<float,N> operator- (SIMD<float,N> a, float b) { return a-SIMD<float,N>(b); }
+  template <int N>
+  INLINE SIMD<float,N> operator- (float a, SIMD<float,N> b) { return SIMD<float,N>(a)-b; }
+  template <int N>
+  INLINE SIMD<float,N> & operator+= (SIMD<float,N> & a, SIMD<float,N> b) { a=a+b; return a; }
+  template <int N>
+  INLINE SIMD<float,N> & operator-= (SIMD<float,N> & a, SIMD<float,N> b) { a=a-b; return a; }
+  template <int N>
+  INLINE SIMD<float,N> & operator*= (SIMD<float,N> & a, SIMD<float,N> b) { a=a*b; return a; }
+  template <int N>
+  INLINE SIMD<float,N> & operator*= (SIMD<float,N> & a, float b) { a=a*SIMD<float,N>(b); return a; }
+
+
+  INLINE float HSum (SIMD<float,1> a) { return a.Data(); }
+
+#ifdef __SSE__
+  INLINE float HSum (SIMD<float,4> a)
+  {
+    __m128 sh = _mm_movehl_ps (a.Data(), a.Data());
+    __m128 s2 = _mm_add_ps (a.Data(), sh);
+    __m128 s1 = _mm_add_ss (s2, _mm_shuffle_ps (s2, s2, 1));
+    return _mm_cvtss_f32 (s1);
+  }
+#elif defined __ARM_NEON
+  INLINE float HSum (SIMD<float,4> a) { return vaddvq_f32 (a.Data()); }
+#endif
+
+#ifdef __AVX__
+  INLINE float HSum (SIMD<float,8> a) { return HSum (a.Lo()+a.Hi()); }
+#endif
+
+#ifdef __AVX512F__
+  INLINE float HSum (SIMD<float,16> a) { return _mm512_reduce_add_ps (a.Data()); }
+#endif
+
+
+#ifdef __AVX512F__
+  INLINE SIMD<float,16> FMA (SIMD<float,16> a, SIMD<float,16> b, SIMD<float,16> c)
+  {
+    return _mm512_fmadd_ps (a.Data(), b.Data(), c.Data());
+  }
+#endif
+#ifdef __FMA__
+  INLINE SIMD<float,8> FMA (SIMD<float,8> a, SIMD<float,8> b, SIMD<float,8> c)
+  {
+    return _mm256_fmadd_ps (a.Data(), b.Data(), c.Data());
+  }
+#endif
+#ifdef __ARM_NEON
+  INLINE SIMD<float,4> FMA (SIMD<float,4> a, SIMD<float,4> b, SIMD<float,4> c)
+  {
+    return vfmaq_f32 (c.Data(), a.Data(), b.Data());
+  }
+#endif
+
+
+
+  // conversion, the float vector holds the lanes of lo followed by the lanes of hi
+  template <int N>
+  INLINE SIMD<float,2*N> ConvertToFloat (SIMD<double,N> lo, SIMD<double,N> hi)
+  {
+    return SIMD<float,2*N> ([lo,hi] (int i) -> float { return i < N ? lo[i] : hi[i-N]; });
+  }
+
+  template <int N>
+  INLINE tuple<SIMD<double,N/2>,SIMD<double,N/2>> ConvertToDouble (SIMD<float,N> a)
+  {
+    return make_tuple (SIMD<double,N/2> ([a] (int i) -> double { return a[i]; }),
+                       SIMD<double,N/2> ([a] (int i) -> double { return a[N/2+i]; }));
+  }
+
+#ifdef __AVX__
+  INLINE SIMD<float,8> ConvertToFloat (SIMD<double,4> lo, SIMD<double,4> hi)
+  {
+    return _mm256_insertf128_ps (_mm256_castps128_ps256 (_mm256_cvtpd_ps (lo.Data())),
+                                 _mm256_cvtpd_ps (hi.Data()), 1);
+  }
+
+  INLINE tuple<SIMD<double,4>,SIMD<double,4>> ConvertToDouble (SIMD<float,8> a)
+  {
+    return make_tuple (SIMD<double,4> (_mm256_cvtps_pd (a.Lo().Data())),
+                       SIMD<double,4> (_mm256_cvtps_pd (a.Hi().Data())));
+  }
+#endif
+
+}
+
+#endif
@@ -18,6 +18,10 @@
 #include <errno.h>
 #include <fcntl.h>
 
+#ifdef NGS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 namespace ngstd
 {
 
@@ -176,6 +180,41 @@ namespace ngstd
   }
 
 
+  void Socket::SendAll (const void * data, size_t n) const
+  {
+    auto ptr = static_cast<const char*> (data);
+    while (n > 0)
+      {
+        auto status = ::send (m_sock, ptr, n, MSG_NOSIGNAL);
+        if (status <= 0)
+          {
+            if (status < 0 && errno == EINTR) continue;
+            throw SocketException (GetLatestError());
+          }
+        ptr += status;
+        n -= status;
+      }
+  }
+
+  void Socket::RecvAll (void * data, size_t n) const
+  {
+    auto ptr = static_cast<char*> (data);
+    while (n > 0)
+      {
+        auto status = ::recv (m_sock, ptr, n, MSG_WAITALL);
+        if (status == 0)
+          throw SocketException ("connection closed by peer");
+        if (status < 0)
+          {
+            if (errno == EINTR) continue;
+            throw SocketException (GetLatestError());
+          }
+        ptr += status;
+        n -= status;
+      }
+  }
+
+
 
   void Socket::connect ( const string & host, int port )
   {
@@ -403,7 +442,190 @@ namespace ngstd
     Socket::recv (s);
     return *this;
   }
-}
 
 
 
+  // frame header: length on the wire, length before compression
+  struct BinaryFrameHeader
+  {
+    uint64_t size, rawsize;
+  };
+
+
+  BinarySocketOutArchive :: BinarySocketOutArchive (Socket & asock, bool acompress, size_t achunksize)
+    : Archive(true), sock(asock), buffer(achunksize), chunksize(achunksize), compress(acompress)
+  {
+#ifndef NGS_HAVE_ZLIB
+    if (compress)
+      {
+        cout << IM(3) << "BinarySocketOutArchive: built without zlib, sending uncompressed" << endl;
+        compress = false;
+      }
+#endif
+    (*this) & GetLibraryVersions();
+  }
+
+  BinarySocketOutArchive :: ~BinarySocketOutArchive ()
+  {
+    try
+      {
+        Flush();
+      }
+    catch (SocketException & e)
+      {
+        cerr << "BinarySocketOutArchive: " << e.What() << endl;
+      }
+  }
+
+  void BinarySocketOutArchive :: SendFrame (const char * data, size_t n)
+  {
+    BinaryFrameHeader header { n, n };
+    const char * payload = data;
+#ifdef NGS_HAVE_ZLIB
+    if (compress)
+      {
+        static Timer t("BinarySocketOutArchive::Compress"); RegionTimer reg(t);
+        uLongf csize = compressBound (n);
+        cbuffer.SetSize (csize);
+        // a frame which does not shrink is sent as it is
+        if (compress2 ((Bytef*)cbuffer.Data(), &csize, (const Bytef*)data, n, 1) == Z_OK
+            && csize < n)
+          {
+            header.size = csize;
+            payload = cbuffer.Data();
+          }
+      }
+#endif
+    sock.SendAll (&header, sizeof(header));
+    sock.SendAll (payload, header.size);
+    bytes_sent += sizeof(header) + header.size;
+    bytes_raw += n;
+  }
+
+  void BinarySocketOutArchive :: Flush ()
+  {
+    if (fill == 0) return;
+    SendFrame (buffer.Data(), fill);
+    fill = 0;
+  }
+
+  void BinarySocketOutArchive :: Write (const void * data, size_t n)
+  {
+    auto ptr = static_cast<const char*> (data);
+    if (fill + n <= chunksize)
+      {
+        memcpy (buffer.Data()+fill, ptr, n);
+        fill += n;
+        return;
+      }
+    Flush();
+    if (n < chunksize/2)
+      {
+        memcpy (buffer.Data(), ptr, n);
+        fill = n;
+        return;
+      }
+    // large arrays are sent from their own memory
+    static Timer t("BinarySocketOutArchive::SendArray"); RegionTimer reg(t);
+    for (size_t first = 0; first < n; first += chunksize)
+      SendFrame (ptr+first, min2 (chunksize, n-first));
+  }
+
+  Archive & BinarySocketOutArchive :: operator & (string & str)
+  {
+    size_t len = str.length();
+    (*this) & len;
+    Write (str.data(), len);
+    return *this;
+  }
+
+  Archive & BinarySocketOutArchive :: operator & (char *& str)
+  {
+    long len = str ? strlen (str) : -1;
+    (*this) & len;
+    if (len > 0)
+      Write (str, len);
+    return *this;
+  }
+
+
+
+  BinarySocketInArchive :: BinarySocketInArchive (Socket & asock)
+    : Archive(false), sock(asock)
+  {
+    (*this) & vinfo;
+  }
+
+  void BinarySocketInArchive :: Read (void * data, size_t n)
+  {
+    auto dst = static_cast<char*> (data);
+    while (n > 0)
+      {
+        if (pos < fill)
+          {
+            size_t k = min2 (n, fill-pos);
+            memcpy (dst, buffer.Data()+pos, k);
+            pos += k;
+            dst += k;
+            n -= k;
+            continue;
+          }
+
+        BinaryFrameHeader header;
+        sock.RecvAll (&header, sizeof(header));
+        if (header.size == header.rawsize && header.rawsize <= n)
+          {
+            // uncompressed frame, directly into the destination
+            sock.RecvAll (dst, header.size);
+            dst += header.size;
+            n -= header.size;
+            continue;
+          }
+
+        buffer.SetSize (header.rawsize);
+        if (header.size == header.rawsize)
+          sock.RecvAll (buffer.Data(), header.size);
+        else
+          {
+#ifdef NGS_HAVE_ZLIB
+            cbuffer.SetSize (header.size);
+            sock.RecvAll (cbuffer.Data(), header.size);
+            uLongf rawsize = header.rawsize;
+            if (uncompress ((Bytef*)buffer.Data(), &rawsize, (const Bytef*)cbuffer.Data(),
+                            header.size) != Z_OK || rawsize != header.rawsize)
+              throw Exception ("BinarySocketInArchive: corrupt compressed frame");
+#else
+            throw Exception ("BinarySocketInArchive: received compressed data, but built without zlib");
+#endif
+          }
+        pos = 0;
+        fill = header.rawsize;
+      }
+  }
+
+  Archive & BinarySocketInArchive :: operator & (string & str)
+  {
+    size_t len;
+    (*this) & len;
+    str.resize (len);
+    if (len > 0)
+      Read (&str[0], len);
+    return *this;
+  }
+
+  Archive & BinarySocketInArchive :: operator & (char *& str)
+  {
+    long len;
+    (*this) & len;
+    if (len == -1)
+      {
+        str = nullptr;
+        return *this;
+      }
+    str = new char[len+1];
+    if (len > 0)
+      Read (str, len);
+    str[len] = '\0';
+    return *this;
+  }
+}
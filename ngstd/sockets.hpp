@@ -95,6 +95,11 @@ namespace ngstd
 
     void recv (std::string & str) const;
 
+    /// sends all n bytes, the kernel may take them in pieces
+    void SendAll (const void * data, size_t n) const;
+    /// receives exactly n bytes
+    void RecvAll (void * data, size_t n) const;
+
     template <typename T>
     void Tsend (const T & data) const
     {
@@ -156,6 +161,90 @@ namespace ngstd
 
 
 
+  /**
+     Binary archive streamed over a socket.
+
+     The output is collected in a buffer and sent in frames of at most
+     chunksize bytes. Each frame starts with its length on the wire and
+     its length before compression. Large arrays skip the buffer and are
+     sent directly in chunks, and the receiver reads uncompressed frames
+     directly into the array. With compression (if built with zlib),
+     every frame is compressed by itself, and frames which do not shrink
+     are sent as they are. Both ends need the same byte order.
+  */
+  class NGS_DLL_HEADER BinarySocketOutArchive : public Archive
+  {
+    Socket & sock;
+    Array<char> buffer, cbuffer;
+    size_t fill = 0;
+    size_t chunksize;
+    bool compress;
+    size_t bytes_sent = 0, bytes_raw = 0;
+
+    void SendFrame (const char * data, size_t n);
+    void Write (const void * data, size_t n);
+  public:
+    BinarySocketOutArchive (Socket & asock, bool acompress = false, size_t achunksize = 1<<20);
+    virtual ~BinarySocketOutArchive ();
+    const VersionInfo& GetVersion(const std::string& library)
+    { return GetLibraryVersions()[library]; }
+
+    /// sends the buffered data
+    void Flush ();
+    virtual void FlushBuffer() { Flush(); }
+    /// bytes on the wire, and before compression
+    size_t BytesSent () const { return bytes_sent; }
+    size_t BytesRaw () const { return bytes_raw; }
+
+    using Archive::operator&;
+    using Archive::Do;
+    virtual Archive & operator & (double & d) { Write (&d, sizeof(d)); return *this; }
+    virtual Archive & operator & (int & i) { Write (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (short int & i) { Write (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (long & i) { Write (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (size_t & i) { Write (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (unsigned char & i) { Write (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (bool & b) { char c = b; Write (&c, 1); return *this; }
+    virtual Archive & operator & (string & str);
+    virtual Archive & operator & (char *& str);
+    virtual Archive & Do (double * d, size_t n) { Write (d, n*sizeof(double)); return *this; }
+    virtual Archive & Do (int * i, size_t n) { Write (i, n*sizeof(int)); return *this; }
+    virtual Archive & Do (size_t * i, size_t n) { Write (i, n*sizeof(size_t)); return *this; }
+  };
+
+
+  /// receives from a BinarySocketOutArchive
+  class NGS_DLL_HEADER BinarySocketInArchive : public Archive
+  {
+    std::map<std::string, VersionInfo> vinfo{};
+    Socket & sock;
+    Array<char> buffer, cbuffer;
+    size_t pos = 0, fill = 0;
+
+    void Read (void * data, size_t n);
+  public:
+    BinarySocketInArchive (Socket & asock);
+    const VersionInfo& GetVersion(const std::string& library)
+    { return vinfo[library]; }
+
+    using Archive::operator&;
+    using Archive::Do;
+    virtual Archive & operator & (double & d) { Read (&d, sizeof(d)); return *this; }
+    virtual Archive & operator & (int & i) { Read (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (short int & i) { Read (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (long & i) { Read (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (size_t & i) { Read (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (unsigned char & i) { Read (&i, sizeof(i)); return *this; }
+    virtual Archive & operator & (bool & b) { char c; Read (&c, 1); b = c; return *this; }
+    virtual Archive & operator & (string & str);
+    virtual Archive & operator & (char *& str);
+    virtual Archive & Do (double * d, size_t n) { Read (d, n*sizeof(double)); return *this; }
+    virtual Archive & Do (int * i, size_t n) { Read (i, n*sizeof(int)); return *this; }
+    virtual Archive & Do (size_t * i, size_t n) { Read (i, n*sizeof(size_t)); return *this; }
+  };
+
+
+
 
   
 
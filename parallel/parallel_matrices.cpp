@@ -14,42 +14,30 @@ namespace ngla
 {
 
 #ifdef PARALLEL
-  
-  template <typename TM> AutoVector MasterInverse<TM> :: CreateRowVector () const
-  { return make_shared<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
-  template <typename TM> AutoVector MasterInverse<TM> :: CreateColVector () const
-  { return make_shared<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
-  
-  template <typename TM>
-  MasterInverse<TM> :: MasterInverse (const SparseMatrixTM<TM> & mat, 
-				      shared_ptr<BitArray> subset, 
-				      shared_ptr<ParallelDofs> hpardofs)
-    
-    : BaseMatrix(hpardofs), loc2glob(hpardofs -> GetCommunicator().Size())
+
+  /*
+    Consistent numbering of the coarse problem: the master dofs in
+    subset are numbered consecutively over the ranks, the copies get
+    the number of their master. Returns the global number of dofs.
+  */
+  static int CoarseNumbering (const ParallelDofs & pardofs, shared_ptr<BitArray> subset,
+                              Array<int> & global_nums)
   {
-    inv = nullptr;
-    
-    auto & comm = paralleldofs->GetCommunicator();
-    int id = comm.Rank();
+    auto & comm = pardofs.GetCommunicator();
     int ntasks = comm.Size();
+    int ndof = pardofs.GetNDofLocal();
 
-    // consistent enumeration
-    
-    int ndof = paralleldofs->GetNDofLocal();
-
-    Array<int> global_nums(ndof);
+    global_nums.SetSize(ndof);
     global_nums = -1;
     int num_master_dofs = 0;
     for (int i = 0; i < ndof; i++)
-      if (paralleldofs -> IsMasterDof (i) && (!subset || (subset && subset->Test(i))))
+      if (pardofs.IsMasterDof (i) && (!subset || subset->Test(i)))
 	global_nums[i] = num_master_dofs++;
-    
 
     Array<int> first_master_dof(ntasks);
     MPI_Allgather (&num_master_dofs, 1, MPI_INT, 
 		   &first_master_dof[0], 1, MPI_INT, 
 		   comm);
-
     
     int num_glob_dofs = 0;
     for (int i = 0; i < ntasks; i++)
@@ -61,9 +49,71 @@ namespace ngla
     
     for (int i = 0; i < ndof; i++)
       if (global_nums[i] != -1)
-	global_nums[i] += first_master_dof[id];
+	global_nums[i] += first_master_dof[comm.Rank()];
+
+    pardofs.ScatterDofData (global_nums);
+    return num_glob_dofs;
+  }
+
+  /// sums the triplets (rows[i], cols[i], vals[i]) into an n x n sparse matrix
+  template <typename TM>
+  static shared_ptr<SparseMatrix<TM>> AssembleCoarseMatrix (int n, FlatArray<int> rows, FlatArray<int> cols,
+                                                            FlatArray<TM> vals, bool symmetric)
+  {
+    DynamicTable<int> graph(n);
+    for (size_t i = 0; i < rows.Size(); i++)
+      {
+	int r = rows[i], c = cols[i];
+	if (symmetric && (r < c)) swap (r, c);
+	graph.AddUnique (r, c);
+      }
+
+    Array<int> els_per_row(n);
+    for (int i = 0; i < n; i++)
+      els_per_row[i] = graph[i].Size();
+
+    auto matrix = symmetric ? make_shared<SparseMatrixSymmetric<TM>> (els_per_row)
+      : make_shared<SparseMatrix<TM>> (els_per_row);
+
+    for (size_t i = 0; i < rows.Size(); i++)
+      {
+	int r = rows[i], c = cols[i];
+	if (symmetric && (r < c) ) swap (r, c);
+	matrix->CreatePosition(r, c);
+      }
+    matrix->AsVector() = 0.0;
+
+    for (size_t i = 0; i < rows.Size(); i++)
+      {
+	int r = rows[i], c = cols[i];
+	if (symmetric && (r < c)) swap (r, c);
+	(*matrix)(r,c) += vals[i];
+      }
+    return matrix;
+  }
+
+  
+  template <typename TM> AutoVector MasterInverse<TM> :: CreateRowVector () const
+  { return make_shared<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
+  template <typename TM> AutoVector MasterInverse<TM> :: CreateColVector () const
+  { return make_shared<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
+  
+  template <typename TM>
+  MasterInverse<TM> :: MasterInverse (const SparseMatrixTM<TM> & mat, 
+				      shared_ptr<BitArray> subset, 
+				      shared_ptr<ParallelDofs> hpardofs)
+    
+    : BaseMatrix(hpardofs), loc2glob(hpardofs -> GetCommunicator().Size())
+  {
+    inv = nullptr;
+    
+    auto & comm = paralleldofs->GetCommunicator();
+    int id = comm.Rank();
+    int ntasks = comm.Size();
 
-    paralleldofs -> ScatterDofData (global_nums);
+    // consistent enumeration
+    Array<int> global_nums;
+    int num_glob_dofs = CoarseNumbering (*paralleldofs, subset, global_nums);
 
 
     /*
@@ -219,44 +269,8 @@ namespace ngla
 	cout << IM(5) << endl;
 
 
-	cout << IM(4) << "now build graph" << endl;
-
-	// build matrix
-	DynamicTable<int> graph(num_glob_dofs);
-	cout << IM(3) << "n = " << num_glob_dofs << endl;
-	for (int i = 0; i < rows.Size(); i++)
-	  {
-	    int r = rows[i], c = cols[i];
-	    if (symmetric && (r < c)) swap (r, c);
-	    graph.AddUnique (r, c);
-	  }
-
-	// *testout << "graphi = " << endl << graph << endl;
-
-	Array<int> els_per_row(num_glob_dofs);
-	for (int i = 0; i < num_glob_dofs; i++)
-	  els_per_row[i] = graph[i].Size();
-
-	cout << IM(4) << "now build matrix" << endl;
-
-	// SparseMatrixSymmetric<TM> matrix(els_per_row);
-        auto matrix = symmetric ? make_shared<SparseMatrixSymmetric<TM>> (els_per_row)
-	  : make_shared<SparseMatrix<TM>> (els_per_row);
-
-	for (int i = 0; i < rows.Size(); i++)
-	  {
-	    int r = rows[i], c = cols[i];
-	    if (symmetric && (r < c) ) swap (r, c);
-	    matrix->CreatePosition(r, c);
-	  }
-	matrix->AsVector() = 0.0;
-
-	for (int i = 0; i < rows.Size(); i++)
-	  {
-	    int r = rows[i], c = cols[i];
-	    if (symmetric && (r < c)) swap (r, c);
-	    (*matrix)(r,c) += vals[i];
-	  }
+	cout << IM(4) << "now build matrix, n = " << num_glob_dofs << endl;
+	auto matrix = AssembleCoarseMatrix<TM> (num_glob_dofs, rows, cols, vals, symmetric);
 
 	cout << IM(4) << "have matrix, now invert" << endl;
 
@@ -399,6 +413,242 @@ namespace ngla
 
 
 
+  // concatenation of the arrays of the ranks, on root, or on all ranks for root = -1
+  template <typename T>
+  static Array<T> GatherArrays (FlatArray<T> local, int root, MPI_Comm comm,
+                                Array<int> * pcounts = nullptr)
+  {
+    int rank, size;
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    int n = local.Size();
+    Array<int> counts(size), offsets(size);
+    if (root < 0)
+      MPI_Allgather (&n, 1, MPI_INT, counts.Data(), 1, MPI_INT, comm);
+    else
+      MPI_Gather (&n, 1, MPI_INT, counts.Data(), 1, MPI_INT, root, comm);
+
+    Array<T> all;
+    if (root < 0 || rank == root)
+      {
+        int sum = 0;
+        for (int i = 0; i < size; i++)
+          {
+            offsets[i] = sum;
+            sum += counts[i];
+          }
+        all.SetSize (sum);
+      }
+
+    if (root < 0)
+      MPI_Allgatherv (local.Data(), n, MyGetMPIType<T>(),
+                      all.Data(), counts.Data(), offsets.Data(), MyGetMPIType<T>(), comm);
+    else
+      MPI_Gatherv (local.Data(), n, MyGetMPIType<T>(),
+                   all.Data(), counts.Data(), offsets.Data(), MyGetMPIType<T>(), root, comm);
+
+    if (pcounts) *pcounts = move(counts);
+    return all;
+  }
+
+
+  template <typename TM> AutoVector RedundantInverse<TM> :: CreateRowVector () const
+  { return make_shared<ParallelVVector<TV>> (paralleldofs->GetNDofLocal(), paralleldofs); }
+  template <typename TM> AutoVector RedundantInverse<TM> :: CreateColVector () const
+  { return make_shared<ParallelVVector<TV>> (paralleldofs->GetNDofLocal(), paralleldofs); }
+
+  template <typename TM>
+  RedundantInverse<TM> :: RedundantInverse (const SparseMatrixTM<TM> & mat,
+                                            shared_ptr<BitArray> subset,
+                                            shared_ptr<ParallelDofs> hpardofs,
+                                            int groupsize)
+    : BaseMatrix(hpardofs)
+  {
+    static Timer t("RedundantInverse - setup"); RegionTimer reg(t);
+    static Timer tgather("RedundantInverse - gather");
+    static Timer tfactor("RedundantInverse - factor");
+
+    auto & comm = paralleldofs->GetCommunicator();
+    int id = comm.Rank();
+
+    Array<int> global_nums;
+    int num_glob_dofs = CoarseNumbering (*paralleldofs, subset, global_nums);
+
+    for (int i = 0; i < paralleldofs->GetNDofLocal(); i++)
+      if (!subset || subset->Test(i))
+        {
+          select.Append (i);
+          select_glob.Append (global_nums[i]);
+        }
+
+    // the sum of the local entries over all ranks is the coarse matrix
+    Array<int> rows, cols;
+    Array<TM> vals;
+    for (int row = 0; row < mat.Height(); row++)
+      if (!subset || subset->Test(row))
+        {
+          FlatArray<int> rcols = mat.GetRowIndices(row);
+          FlatVector<TM> rvals = mat.GetRowValues(row);
+          for (size_t j = 0; j < rcols.Size(); j++)
+            if (!subset || subset->Test(rcols[j]))
+              {
+                rows.Append (global_nums[row]);
+                cols.Append (global_nums[rcols[j]]);
+                vals.Append (rvals[j]);
+              }
+        }
+
+    if (groupsize <= 0)
+      MPI_Comm_split_type (comm, MPI_COMM_TYPE_SHARED, id, MPI_INFO_NULL, &group_comm);
+    else
+      MPI_Comm_split (comm, id / groupsize, id, &group_comm);
+    int group_rank;
+    MPI_Comm_rank (group_comm, &group_rank);
+    leader = (group_rank == 0);
+    MPI_Comm_split (comm, leader ? 0 : MPI_UNDEFINED, id, &leader_comm);
+
+    // entries to the group leaders, then between the leaders
+    tgather.Start();
+    FlatArray<TSCAL> svals (vals.Size() * sizeof(TM)/sizeof(TSCAL), (TSCAL*)vals.Data());
+    Array<int> grows = GatherArrays<int> (rows, 0, group_comm);
+    Array<int> gcols = GatherArrays<int> (cols, 0, group_comm);
+    Array<TSCAL> gvals = GatherArrays<TSCAL> (svals, 0, group_comm);
+    group_dofs = GatherArrays<int> (select_glob, 0, group_comm, &group_counts);
+
+    if (!leader)
+      {
+        group_counts.SetSize0();
+        tgather.Stop();
+        return;
+      }
+
+    Array<int> arows = GatherArrays<int> (grows, -1, leader_comm);
+    Array<int> acols = GatherArrays<int> (gcols, -1, leader_comm);
+    Array<TSCAL> avals = GatherArrays<TSCAL> (gvals, -1, leader_comm);
+    all_dofs = GatherArrays<int> (group_dofs, -1, leader_comm, &leader_counts);
+    tgather.Stop();
+
+    // the vectors are exchanged as scalars
+    auto ScaleCounts = [] (Array<int> & counts, Array<int> & offsets)
+      {
+        offsets.SetSize (counts.Size());
+        int sum = 0;
+        for (size_t i = 0; i < counts.Size(); i++)
+          {
+            counts[i] *= ES;
+            offsets[i] = sum;
+            sum += counts[i];
+          }
+      };
+    ScaleCounts (group_counts, group_offsets);
+    ScaleCounts (leader_counts, leader_offsets);
+
+    RegionTimer regf(tfactor);
+    bool symmetric = (dynamic_cast<const SparseMatrixSymmetric<TM>*>(&mat) != NULL);
+    FlatArray<TM> tvals (avals.Size() * sizeof(TSCAL)/sizeof(TM), (TM*)avals.Data());
+    auto matrix = AssembleCoarseMatrix<TM> (num_glob_dofs, arows, acols, tvals, symmetric);
+    matrix->SetInverseType (mat.GetInverseType());
+    inv = matrix->InverseMatrix ();
+  }
+
+  template <typename TM>
+  RedundantInverse<TM> :: ~RedundantInverse ()
+  {
+    int finalized;
+    MPI_Finalized (&finalized);
+    if (finalized) return;
+    MPI_Comm_free (&group_comm);
+    if (leader_comm != MPI_COMM_NULL)
+      MPI_Comm_free (&leader_comm);
+  }
+
+  template <typename TM>
+  void RedundantInverse<TM> :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("RedundantInverse::MultAdd"); RegionTimer reg(t);
+    static Timer tsolve("RedundantInverse::MultAdd - solve");
+
+    MPI_Datatype type = MyGetMPIType<TSCAL>();
+    bool is_x_cum = (dynamic_cast_ParallelBaseVector(x) . Status() == CUMULATED);
+    y.Cumulate();
+
+    FlatVector<TV> fx = x.FV<TV> ();
+    FlatVector<TV> fy = y.FV<TV> ();
+
+    // a cumulated x contributes on the master dofs only
+    Array<TV> lx(select.Size());
+    for (size_t i = 0; i < select.Size(); i++)
+      lx[i] = (!is_x_cum || paralleldofs->IsMasterDof(select[i])) ? TV(fx(select[i])) : TV(0.0);
+
+    Array<TV> gx(group_dofs.Size()), gy(group_dofs.Size());
+    MPI_Gatherv (lx.Data(), ES*lx.Size(), type,
+                 gx.Data(), group_counts.Data(), group_offsets.Data(), type, 0, group_comm);
+
+    if (leader)
+      {
+        Array<TV> ax(all_dofs.Size());
+        MPI_Allgatherv (gx.Data(), ES*gx.Size(), type,
+                        ax.Data(), leader_counts.Data(), leader_offsets.Data(), type, leader_comm);
+
+        RegionTimer regs(tsolve);
+        VVector<TV> hx(inv->Height());
+        VVector<TV> hy(inv->Height());
+        hx = 0.0;
+        for (size_t i = 0; i < all_dofs.Size(); i++)
+          hx(all_dofs[i]) += ax[i];
+        hy = (*inv) * hx;
+        for (size_t i = 0; i < group_dofs.Size(); i++)
+          gy[i] = hy(group_dofs[i]);
+      }
+
+    Array<TV> ly(select.Size());
+    MPI_Scatterv (gy.Data(), group_counts.Data(), group_offsets.Data(), type,
+                  ly.Data(), ES*ly.Size(), type, 0, group_comm);
+
+    for (size_t i = 0; i < select.Size(); i++)
+      fy(select[i]) += s * ly[i];
+  }
+
+
+  template class RedundantInverse<double>;
+  template class RedundantInverse<Complex>;
+
+#if MAX_SYS_DIM >= 1
+  template class RedundantInverse<Mat<1,1,double> >;
+  template class RedundantInverse<Mat<1,1,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 2
+  template class RedundantInverse<Mat<2,2,double> >;
+  template class RedundantInverse<Mat<2,2,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 3
+  template class RedundantInverse<Mat<3,3,double> >;
+  template class RedundantInverse<Mat<3,3,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 4
+  template class RedundantInverse<Mat<4,4,double> >;
+  template class RedundantInverse<Mat<4,4,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 5
+  template class RedundantInverse<Mat<5,5,double> >;
+  template class RedundantInverse<Mat<5,5,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 6
+  template class RedundantInverse<Mat<6,6,double> >;
+  template class RedundantInverse<Mat<6,6,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 7
+  template class RedundantInverse<Mat<7,7,double> >;
+  template class RedundantInverse<Mat<7,7,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 8
+  template class RedundantInverse<Mat<8,8,double> >;
+  template class RedundantInverse<Mat<8,8,Complex> >;
+#endif
+
+
+
 
 
   
@@ -419,7 +669,7 @@ namespace ngla
 #ifdef USE_MUMPS
       spmat->SetInverseType(MUMPS);
 #else
-      spmat->SetInverseType(MASTERINVERSE);
+      spmat->SetInverseType(REDUNDANTINVERSE);
 #endif
     }
   }
@@ -442,6 +692,11 @@ namespace ngla
 	  (mat->Width(), row_paralleldofs->GetEntrySize(), row_paralleldofs, DISTRIBUTED);
     }
     else {
+#ifdef CUDA
+      // a device matrix gets device vectors, the cumulation stays on the device
+      if (dynamic_pointer_cast<DevSparseMatrix> (mat))
+        return make_shared<ParallelUnifiedVector> (row_paralleldofs ? row_paralleldofs : paralleldofs, DISTRIBUTED);
+#endif
       if (row_paralleldofs == nullptr)
 	return make_shared<S_ParallelBaseVectorPtr<double>>
 	  (mat->Width(), paralleldofs->GetEntrySize(), paralleldofs, DISTRIBUTED);
@@ -462,6 +717,11 @@ namespace ngla
 	  (mat->Height(), col_paralleldofs->GetEntrySize(), col_paralleldofs, DISTRIBUTED);
     }
     else {
+#ifdef CUDA
+      // as in CreateRowVector
+      if (dynamic_pointer_cast<DevSparseMatrix> (mat))
+        return make_shared<ParallelUnifiedVector> (col_paralleldofs ? col_paralleldofs : paralleldofs, DISTRIBUTED);
+#endif
       if (col_paralleldofs==nullptr)
 	return make_shared<S_ParallelBaseVectorPtr<double>>
 	  (mat->Height(), paralleldofs->GetEntrySize(), paralleldofs, DISTRIBUTED);
@@ -477,18 +737,83 @@ namespace ngla
     ; // delete &mat;
   }
 
+  void ParallelMatrix :: SetupInterfaceRows (const BaseSparseMatrix & spmat) const
+  {
+    if (interior_rows && interface_nze == spmat.NZE()) return;
+
+    static Timer t("ParallelMatrix::SetupInterfaceRows"); RegionTimer reg(t);
+    auto xpardofs = row_paralleldofs ? row_paralleldofs : paralleldofs;
+    size_t h = spmat.Height();
+    // diagonal is read by the transposed part of symmetric storage
+    bool square = spmat.Height() == spmat.Width();
+
+    interior_rows = make_shared<BitArray> (h);
+    interface_rows = make_shared<BitArray> (h);
+    interior_rows->Clear();
+    interface_rows->Clear();
+    auto is_ex = [&] (int dof) { return xpardofs->GetDistantProcs(dof).Size() > 0; };
+
+    ParallelForRange (h, [&] (IntRange r)
+                      {
+                        for (auto i : r)
+                          {
+                            bool interface = square && is_ex(i);
+                            for (auto col : spmat.GetRowIndices(i))
+                              if (is_ex(col))
+                                {
+                                  interface = true;
+                                  break;
+                                }
+                            if (interface)
+                              interface_rows->SetBitAtomic(i);
+                            else
+                              interior_rows->SetBitAtomic(i);
+                          }
+                      });
+    interface_nze = spmat.NZE();
+  }
+
+  
   void ParallelMatrix :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
     const auto & xpar = dynamic_cast_ParallelBaseVector(x);
     auto & ypar = dynamic_cast_ParallelBaseVector(y);
-    if (op & char(2))
-      x.Cumulate();
-    else
-      x.Distribute();
     if (op & char(1))
       y.Cumulate();
     else
       y.Distribute();
+
+    auto spmat = dynamic_pointer_cast<BaseSparseMatrix> (mat);
+    if ( (op & char(2)) && spmat && x.GetParallelStatus() == DISTRIBUTED)
+      {
+        // communication/computation overlap:
+        // rows not touching exchange dofs are computed while x is cumulated.
+        // MultAdd1 + MultAdd2 restricted to rows give exactly these rows,
+        // also for symmetric storage
+        static Timer t("ParallelMatrix::MultAdd - overlapped"); RegionTimer reg(t);
+        static Timer tint("ParallelMatrix::MultAdd - interior");
+        static Timer tex("ParallelMatrix::MultAdd - interface");
+        SetupInterfaceRows (*spmat);
+        auto & xloc = *xpar.GetLocalVector();
+        auto & yloc = *ypar.GetLocalVector();
+
+        xpar.StartCumulate();
+        tint.Start();
+        mat->MultAdd1 (s, xloc, yloc, interior_rows.get());
+        mat->MultAdd2 (s, xloc, yloc, interior_rows.get());
+        tint.Stop();
+        xpar.FinishCumulate();
+
+        RegionTimer regex(tex);
+        mat->MultAdd1 (s, xloc, yloc, interface_rows.get());
+        mat->MultAdd2 (s, xloc, yloc, interface_rows.get());
+        return;
+      }
+    
+    if (op & char(2))
+      x.Cumulate();
+    else
+      x.Distribute();
     mat->MultAdd (s, *xpar.GetLocalVector(), *ypar.GetLocalVector());
   }
 
@@ -569,6 +894,21 @@ namespace ngla
 
 
   
+  /// up to this size the coarse problem is factored on every node
+  static constexpr int redundant_inverse_limit = 200000;
+  
+#ifdef PARALLEL
+  /// global number of dofs in subset
+  static int GlobalNDof (const ParallelDofs & pardofs, shared_ptr<BitArray> subset)
+  {
+    int nlocal = 0;
+    for (size_t i = 0; i < pardofs.GetNDofLocal(); i++)
+      if (pardofs.IsMasterDof(i) && (!subset || subset->Test(i)))
+        nlocal++;
+    return pardofs.GetCommunicator().AllReduce (nlocal, MPI_SUM);
+  }
+#endif
+
   template <typename TM>
   shared_ptr<BaseMatrix> ParallelMatrix::InverseMatrixTM (shared_ptr<BitArray> subset) const
   {
@@ -577,13 +917,29 @@ namespace ngla
 
 #ifdef USE_MUMPS
     bool symmetric = dynamic_cast<const SparseMatrixSymmetric<TM>*> (mat.get()) != NULL;
-    if (mat->GetInverseType() == MUMPS)
+    // inverse 'auto': distributed MUMPS for problems too large to gather
+    if (mat->GetInverseType() == MUMPS ||
+        (mat->GetInverseType() == AUTOINVERSE &&
+         GlobalNDof (*paralleldofs, subset) > redundant_inverse_limit))
       return make_shared<ParallelMumpsInverse<TM>> (*dmat, subset, nullptr, paralleldofs, symmetric);
     else 
 #endif
 
 #ifdef PARALLEL
+    if (mat->GetInverseType() == MASTERINVERSE)
       return make_shared<MasterInverse<TM>> (*dmat, subset, paralleldofs);
+    else if (mat->GetInverseType() == REDUNDANTINVERSE)
+      return make_shared<RedundantInverse<TM>> (*dmat, subset, paralleldofs);
+    else
+      {
+        // every node factors small coarse problems, larger ones are
+        // factored once, the leader of the single group is rank 0.
+        // The gathered matrices keep the inverse type, 'auto' is resolved there
+        auto comm = paralleldofs->GetCommunicator();
+        int nglobal = GlobalNDof (*paralleldofs, subset);
+        int groupsize = (nglobal <= redundant_inverse_limit) ? 0 : comm.Size();
+        return make_shared<RedundantInverse<TM>> (*dmat, subset, paralleldofs, groupsize);
+      }
 #endif
     throw Exception ("ParallelMatrix: don't know how to invert");
   }
@@ -25,6 +25,12 @@ namespace ngla
     shared_ptr<ParallelDofs> row_paralleldofs, col_paralleldofs;
 
     PARALLEL_OP op;
+
+    /// rows of a sparse mat not coupling to exchange dofs of x, and the rest
+    mutable shared_ptr<BitArray> interior_rows, interface_rows;
+    mutable size_t interface_nze = 0;
+    /// splits the rows of a sparse mat, the interior product overlaps the cumulation of x
+    void SetupInterfaceRows (const BaseSparseMatrix & spmat) const;
     
   public:
     ParallelMatrix (shared_ptr<BaseMatrix> amat, shared_ptr<ParallelDofs> apardofs,
@@ -44,6 +50,7 @@ namespace ngla
     virtual const BaseVector & AsVector() const override { return mat->AsVector(); }
 
     shared_ptr<BaseMatrix> GetMatrix() const { return mat; }
+    virtual Array<MemoryUsage> GetMemoryUsage () const override { return mat->GetMemoryUsage(); }
     virtual shared_ptr<BaseMatrix> CreateMatrix () const override;
     virtual AutoVector CreateVector () const override;
     virtual AutoVector CreateRowVector () const override;
@@ -100,7 +107,51 @@ namespace ngla
   };
 
 
-  
+  /*
+    Direct solver for the coarse problem with redundant factorizations:
+    the ranks are split into groups (node-local groups for groupsize = 0),
+    the leader of every group holds and factors the full matrix.
+    A solve gathers the right hand side within the groups, exchanges it
+    between the leaders in one collective and scatters the solution
+    within the groups, there is no point-to-point traffic to rank 0.
+  */
+  template <typename TM>
+  class RedundantInverse : public BaseMatrix
+  {
+    typedef typename mat_traits<TM>::TV_ROW TV;
+    typedef typename mat_traits<TM>::TSCAL TSCAL;
+    enum { ES = sizeof(TV) / sizeof(TSCAL) };
+
+    /// on the leaders only
+    shared_ptr<BaseMatrix> inv;
+    MPI_Comm group_comm = MPI_COMM_NULL, leader_comm = MPI_COMM_NULL;
+    bool leader;
+
+    /// local dofs of the coarse problem, and their global numbers
+    Array<int> select, select_glob;
+    /// leader: global numbers of the dofs of the group ranks, in gather order
+    Array<int> group_dofs;
+    /// leader: counts and offsets (in scalars) of the group ranks
+    Array<int> group_counts, group_offsets;
+    /// leader: global numbers of the dofs of all groups, in leader order
+    Array<int> all_dofs;
+    Array<int> leader_counts, leader_offsets;
+  public:
+    RedundantInverse (const SparseMatrixTM<TM> & mat, shared_ptr<BitArray> asubset,
+                      shared_ptr<ParallelDofs> apardofs, int groupsize = 0);
+    virtual ~RedundantInverse () override;
+    virtual bool IsComplex() const override { return is_same<TSCAL,Complex>::value; }
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    virtual int VHeight() const override { return paralleldofs->GetNDofLocal(); }
+    virtual int VWidth() const override { return paralleldofs->GetNDofLocal(); }
+
+    AutoVector CreateRowVector() const override;
+    AutoVector CreateColVector() const override;
+  };
+
+
+
   class FETI_Jump_Matrix : public BaseMatrix
   {
   public:
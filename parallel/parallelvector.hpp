@@ -26,6 +26,11 @@ namespace ngla
     
     Array<MPI_Request> sreqs;
     Array<MPI_Request> rreqs;
+    /// sreqs/rreqs are persistent requests on packed buffers
+    bool persistent_requests = false;
+
+    /// copies the exchange dofs into the send buffers of the persistent requests
+    virtual void PackSendValues () const { ; }
 
   public:
     ParallelBaseVector ()
@@ -69,12 +74,21 @@ namespace ngla
     virtual BaseVector & Add (double scal, const BaseVector & v);
     virtual BaseVector & Add (Complex scal, const BaseVector & v);
 
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w);
+    virtual BaseVector & Add2 (double scal1, const BaseVector & v1,
+                               double scal2, const BaseVector & v2);
+    virtual void InnerProductsD (FlatArray<const BaseVector*> v, FlatVector<double> res) const;
+
     void PrintStatus ( ostream & ost ) const;
 
     virtual shared_ptr<BaseVector> GetLocalVector () const
     { return local_vec; }
     
     virtual void Cumulate () const; 
+    /// Cumulate in two phases: posts the exchange, the vector may be read until FinishCumulate
+    void StartCumulate () const;
+    /// waits for the exchange and adds the received values
+    void FinishCumulate () const;
     
     virtual void Distribute() const = 0;
     // { cerr << "ERROR -- Distribute called for BaseVector, is not parallel" << endl; }
@@ -145,6 +159,123 @@ namespace ngla
 
 
 
+  /**
+     Several inner products with one global reduction.
+     Add computes the local product at once (the vectors may be
+     changed afterwards), Start posts the reduction of all collected
+     products, for parallel vectors it is non-blocking. Wait completes
+     it and returns the global values in the order of Add.
+  */
+  template <class IPTYPE>
+  class InnerProductBatch
+  {
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    ArrayMem<SCAL,8> local, global;
+    shared_ptr<ParallelDofs> pardofs;
+#ifdef PARALLEL
+    MPI_Request request;
+#endif
+    bool pending = false;
+
+    template <class T>
+    typename SCAL_TRAIT<T>::SCAL LocalProduct (const BaseVector & a, const BaseVector & b)
+    {
+      auto pa = dynamic_cast_ParallelBaseVector (&a);
+      auto pb = dynamic_cast_ParallelBaseVector (&b);
+      if (!pa || !pb || (!pa->IsParallelVector() && !pb->IsParallelVector()))
+        return S_InnerProduct<T> (a, b);
+
+      // one cumulated and one distributed vector, as in S_ParallelBaseVector::InnerProduct
+      if (pa->Status() == pb->Status() && pa->Status() == DISTRIBUTED)
+        pa->Cumulate();
+      else if (pa->Status() == pb->Status() && pa->Status() == CUMULATED)
+        pa->Distribute();
+      pardofs = pa->IsParallelVector() ? pa->GetParallelDofs() : pb->GetParallelDofs();
+      return S_InnerProduct<T> (*pa->GetLocalVector(), *pb->GetLocalVector());
+    }
+  public:
+    InnerProductBatch () { ; }
+    InnerProductBatch (const InnerProductBatch &) = delete;
+    ~InnerProductBatch () { Wait(); }
+
+    /// removes the products, a pending reduction is completed
+    void Reset ()
+    {
+      Wait();
+      local.SetSize0();
+      global.SetSize0();
+    }
+
+    size_t Size () const { return local.Size(); }
+
+    /// local part of (a,b), returns its index
+    size_t Add (const BaseVector & a, const BaseVector & b)
+    {
+      Wait();
+      local.Append (LocalProduct<IPTYPE> (a, b));
+      return local.Size()-1;
+    }
+
+    /// local part of the squared norm (a,a), conjugated for complex vectors
+    size_t AddNorm2 (const BaseVector & a)
+    {
+      Wait();
+      if constexpr (is_same<SCAL,double>::value)
+        local.Append (LocalProduct<double> (a, a));
+      else
+        local.Append (LocalProduct<ComplexConjugate> (a, a));
+      return local.Size()-1;
+    }
+
+    /// posts the reduction of all products added since the last Reset
+    void Start ()
+    {
+      Wait();
+      global.SetSize (local.Size());
+      global = local;
+#ifdef PARALLEL
+      if (pardofs && local.Size())
+        {
+          MPI_Comm comm = pardofs->GetCommunicator();
+          MPI_Iallreduce (local.Data(), global.Data(), local.Size(), MyGetMPIType<SCAL>(),
+                          MPI_SUM, comm, &request);
+          pending = true;
+        }
+#endif
+    }
+
+    /// Reset, Add all pairs, Start
+    void Start (std::initializer_list<pair<const BaseVector*, const BaseVector*>> pairs)
+    {
+      Reset();
+      for (auto ab : pairs)
+        Add (*ab.first, *ab.second);
+      Start();
+    }
+
+    /// completes the reduction, the global products in the order of Add
+    FlatArray<SCAL> Wait ()
+    {
+#ifdef PARALLEL
+      if (pending)
+        MPI_Wait (&request, MPI_STATUS_IGNORE);
+#endif
+      pending = false;
+      return global;
+    }
+
+    /// blocking reduction: Start and Wait
+    FlatArray<SCAL> Compute ()
+    {
+      Start();
+      return Wait();
+    }
+
+    /// global value of product i, after Wait
+    SCAL operator[] (size_t i) const { return global[i]; }
+  };
+
+
 
 
 
@@ -175,6 +306,10 @@ namespace ngla
     using ParallelBaseVector :: rreqs;
 
     Table<SCAL> * recvvalues;
+    Table<SCAL> * sendvalues = nullptr;
+
+    virtual void PackSendValues () const;
+    void FreeRequests ();
 
     using S_BaseVectorPtr<TSCAL> :: pdata;
     using ParallelBaseVector :: local_vec;
@@ -195,6 +330,15 @@ namespace ngla
     virtual AutoVector CreateVector () const;
 
     virtual double L2Norm () const;
+
+    // fused operations need the status handling of ParallelBaseVector
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+    { return ParallelBaseVector::AddInnerProductD (scal, v, w); }
+    virtual BaseVector & Add2 (double scal1, const BaseVector & v1,
+                               double scal2, const BaseVector & v2)
+    { return ParallelBaseVector::Add2 (scal1, v1, scal2, v2); }
+    virtual void InnerProductsD (FlatArray<const BaseVector*> v, FlatVector<double> res) const
+    { ParallelBaseVector::InnerProductsD (v, res); }
   };
  
 
@@ -257,6 +401,65 @@ namespace ngla
     virtual ~ParallelVFlatVector() throw()
     { ; }
   };
+
+
+
+#ifdef CUDA
+  /**
+     Distributed vector with the values in device memory, the local
+     vector is a UnifiedVector. Cumulate and Distribute run on the
+     device: the exchange dofs are packed and unpacked by kernels.
+     With a CUDA-aware MPI the packed device buffers are passed to MPI,
+     otherwise only the packed buffers are staged through host memory.
+     Detection: MPIX_Query_cuda_support, or NGS_CUDA_AWARE_MPI=0/1.
+  */
+  class NGS_DLL_HEADER ParallelUnifiedVector : public S_ParallelBaseVector<double>
+  {
+    shared_ptr<UnifiedVector> uvec;
+
+    /// exchange dofs of all procs, the dofs of proc p start at exfirst[p]
+    Array<int> exfirst;
+    int * dev_exdofs = nullptr;
+    /// dofs zeroed by Distribute, shared with a lower rank
+    int * dev_zerodofs = nullptr;
+    int nzerodofs = 0;
+    double * dev_sendbuf = nullptr;
+    double * dev_recvbuf = nullptr;
+    Array<double> host_sendbuf, host_recvbuf;
+    bool cuda_aware;
+
+    virtual void PackSendValues () const override;
+    void FreeExchange ();
+    /// buffer used by MPI for the values of proc p
+    double * MPIRecvBuffer (int p);
+
+  public:
+    ParallelUnifiedVector (shared_ptr<ParallelDofs> apd, PARALLEL_STATUS stat = CUMULATED);
+    virtual ~ParallelUnifiedVector ();
+
+    shared_ptr<UnifiedVector> GetUnifiedVector () const { return uvec; }
+    bool IsCudaAware () const { return cuda_aware; }
+
+    virtual void * Memory () const override;
+    virtual FlatVector<double> FVDouble () const override;
+    virtual FlatVector<Complex> FVComplex () const override;
+    virtual AutoVector CreateVector () const override;
+
+    virtual BaseVector & Scale (double scal) override;
+    virtual BaseVector & SetScalar (double scal) override;
+    virtual BaseVector & Set (double scal, const BaseVector & v) override;
+    virtual BaseVector & Add (double scal, const BaseVector & v) override;
+    virtual double InnerProduct (const BaseVector & v2, bool conjugate = false) const override;
+
+    virtual void SetParallelDofs (shared_ptr<ParallelDofs> aparalleldofs,
+                                  const Array<int> * procs = 0) override;
+    virtual void Distribute () const override;
+    virtual void IRecvVec (int dest, MPI_Request & request) override;
+    virtual void AddRecvValues (int sender) override;
+
+    virtual ostream & Print (ostream & ost) const override;
+  };
+#endif
 }
 
 // #endif
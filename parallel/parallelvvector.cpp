@@ -95,6 +95,99 @@ namespace ngla
   }
 
 
+  double ParallelBaseVector :: AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+  {
+    const ParallelBaseVector * parv = dynamic_cast_ParallelBaseVector (&v);
+    const ParallelBaseVector * parw = dynamic_cast_ParallelBaseVector (&w);
+    if (IsComplex() || !parv || !parw)
+      return BaseVector::AddInnerProductD (scal, v, w);
+
+    // as in Add
+    if ( (*this).Status() != parv->Status() )
+      {
+        if ( (*this).Status() == DISTRIBUTED )
+	  Cumulate();
+        else 
+	  parv -> Cumulate();
+      }
+
+    // one cumulated, one distributed vector for the inner product;
+    // change w, since this is modified in the sweep
+    if ( this->Status() == parw->Status() && this->Status() == DISTRIBUTED )
+      parw->Cumulate();
+    else if ( this->Status() == parw->Status() && this->Status() == CUMULATED )
+      parw->Distribute();
+
+    double localsum = VecAddInnerProduct (FVDouble(), scal, parv->FVDouble(), parw->FVDouble());
+
+    if ( this->Status() == NOT_PARALLEL && parw->Status() == NOT_PARALLEL )
+      return localsum;
+
+    auto pd = IsParallelVector() ? paralleldofs : parw->GetParallelDofs();
+    return pd->GetCommunicator().AllReduce (localsum, MPI_SUM);
+  }
+
+  BaseVector & ParallelBaseVector :: Add2 (double scal1, const BaseVector & v1,
+                                           double scal2, const BaseVector & v2)
+  {
+    const ParallelBaseVector * parv1 = dynamic_cast_ParallelBaseVector (&v1);
+    const ParallelBaseVector * parv2 = dynamic_cast_ParallelBaseVector (&v2);
+    if (IsComplex() || !parv1 || !parv2 || parv1->IsComplex() || parv2->IsComplex())
+      return BaseVector::Add2 (scal1, v1, scal2, v2);
+
+    if ( this->Status() != parv1->Status() || this->Status() != parv2->Status() )
+      {
+        Cumulate();
+        parv1->Cumulate();
+        parv2->Cumulate();
+      }
+
+    VecAdd2 (FVDouble(), scal1, parv1->FVDouble(), scal2, parv2->FVDouble());
+    return *this;
+  }
+
+  void ParallelBaseVector :: InnerProductsD (FlatArray<const BaseVector*> v, FlatVector<double> res) const
+  {
+    if (IsComplex())
+      {
+        BaseVector::InnerProductsD (v, res);
+        return;
+      }
+
+    ArrayMem<FlatVector<double>,16> fv(v.Size());
+    shared_ptr<ParallelDofs> pd = IsParallelVector() ? paralleldofs : nullptr;
+    for (size_t i = 0; i < v.Size(); i++)
+      {
+        const ParallelBaseVector * parv = dynamic_cast_ParallelBaseVector (v[i]);
+        if (!parv)
+          {
+            BaseVector::InnerProductsD (v, res);
+            return;
+          }
+        if ( this->Status() == parv->Status() && this->Status() == DISTRIBUTED )
+          parv->Cumulate();
+        else if ( this->Status() == parv->Status() && this->Status() == CUMULATED )
+          parv->Distribute();
+        if (parv->IsParallelVector())
+          pd = parv->GetParallelDofs();
+        fv[i].AssignMemory (parv->FVDouble().Size(), parv->FVDouble().Data());
+      }
+
+    VecInnerProducts (FVDouble(), fv, res);
+
+#ifdef PARALLEL
+    // one reduction for all inner products
+    if (pd)
+      {
+        static int trace_id = ChromeTrace::GetNameId ("MPI_Allreduce InnerProducts");
+        ChromeTraceRegion treg(trace_id, ChromeTrace::CAT_MPI);
+        MPI_Allreduce (MPI_IN_PLACE, res.Data(), res.Size(), MPI_DOUBLE, MPI_SUM,
+                       pd->GetCommunicator());
+      }
+#endif
+  }
+
+
   void ParallelBaseVector :: PrintStatus ( ostream & ost ) const
   {
     if ( this->status == NOT_PARALLEL )
@@ -107,27 +200,57 @@ namespace ngla
   
 
   void ParallelBaseVector :: Cumulate () const
+  {
+    if (status != DISTRIBUTED) return;
+    StartCumulate();
+    FinishCumulate();
+  }
+
+  
+  void ParallelBaseVector :: StartCumulate () const
   {
 #ifdef PARALLEL
     if (status != DISTRIBUTED) return;
     
-    // int ntasks = paralleldofs->GetNTasks();
     auto exprocs = paralleldofs->GetDistantProcs();
-    
     int nexprocs = exprocs.Size();
     
     ParallelBaseVector * constvec = const_cast<ParallelBaseVector * > (this);
+
+    if (persistent_requests)
+      {
+        PackSendValues();
+        // Startall with 0 requests fails for some MPI versions
+        if (nexprocs)
+          {
+            MPI_Startall (nexprocs, &constvec->rreqs[0]);
+            MPI_Startall (nexprocs, &constvec->sreqs[0]);
+          }
+        return;
+      }
     
     for (int idest = 0; idest < nexprocs; idest ++ ) 
       constvec->ISend (exprocs[idest], sreqs[idest] );
     for (int isender=0; isender < nexprocs; isender++)
       constvec -> IRecvVec (exprocs[isender], rreqs[isender] );
-    
-    // if (rreqs.Size()) { // apparently Startall with 0 requests fails b/c invalid request ??
-    //   MPI_Startall(rreqs.Size(), &rreqs[0]);
-    //   MPI_Startall(sreqs.Size(), &sreqs[0]);
-    // }
+#endif
+  }
+
+  
+  void ParallelBaseVector :: FinishCumulate () const
+  {
+#ifdef PARALLEL
+    if (status != DISTRIBUTED) return;
 
+    auto exprocs = paralleldofs->GetDistantProcs();
+    int nexprocs = exprocs.Size();
+    ParallelBaseVector * constvec = const_cast<ParallelBaseVector * > (this);
+
+    static int trace_id = ChromeTrace::GetNameId ("MPI_Wait Cumulate");
+    ChromeTraceRegion treg(trace_id, ChromeTrace::CAT_MPI);
+
+    // without persistent requests the values are sent from the vector memory,
+    // only then it can be changed
     MyMPI_WaitAll (sreqs);
     
     // cumulate
@@ -182,6 +305,8 @@ namespace ngla
     if ( this->Status() == NOT_PARALLEL && parv2->Status() == NOT_PARALLEL )
       return localsum;
 
+    static int trace_id = ChromeTrace::GetNameId ("MPI_Allreduce InnerProduct");
+    ChromeTraceRegion treg(trace_id, ChromeTrace::CAT_MPI);
     return paralleldofs->GetCommunicator().AllReduce (localsum, MPI_SUM);
   }
 
@@ -209,6 +334,8 @@ namespace ngla
     if ( this->Status() == NOT_PARALLEL && parv2->Status() == NOT_PARALLEL )
       return localsum;
 
+    static int trace_id = ChromeTrace::GetNameId ("MPI_Allreduce InnerProduct");
+    ChromeTraceRegion treg(trace_id, ChromeTrace::CAT_MPI);
     return paralleldofs->GetCommunicator().AllReduce (localsum, MPI_SUM);
   }
 
@@ -252,7 +379,60 @@ namespace ngla
   template <class SCAL>
   S_ParallelBaseVectorPtr<SCAL> :: ~S_ParallelBaseVectorPtr ()
   {
+    FreeRequests();
     delete recvvalues;
+    delete sendvalues;
+  }
+
+
+  template <class SCAL>
+  void S_ParallelBaseVectorPtr<SCAL> :: FreeRequests ()
+  {
+#ifdef PARALLEL
+    if (!this->persistent_requests) return;
+    this->persistent_requests = false;
+    int finalized;
+    MPI_Finalized (&finalized);
+    if (finalized) return;
+    for (auto & r : sreqs) MPI_Request_free (&r);
+    for (auto & r : rreqs) MPI_Request_free (&r);
+#endif
+  }
+
+
+  /// gathers, threaded for long exchange lists
+  template <typename FUNC>
+  inline void ExchangeLoop (size_t n, FUNC func)
+  {
+    if (n > 4096)
+      ParallelForRange (n, func);
+    else
+      func (IntRange(n));
+  }
+  
+  template <class SCAL>
+  void S_ParallelBaseVectorPtr<SCAL> :: PackSendValues () const
+  {
+    const SCAL * vals = pdata;
+    size_t es = this->es;
+    for (auto p : paralleldofs->GetDistantProcs())
+      {
+        FlatArray<int> exdofs = paralleldofs->GetExchangeDofs(p);
+        SCAL * snd = &(*sendvalues)[p][0];
+        if (es == 1)
+          ExchangeLoop (exdofs.Size(), [&] (IntRange r)
+                        {
+                          for (auto i : r)
+                            snd[i] = vals[exdofs[i]];
+                        });
+        else
+          ExchangeLoop (exdofs.Size(), [&] (IntRange r)
+                        {
+                          for (auto i : r)
+                            for (size_t j = 0; j < es; j++)
+                              snd[i*es+j] = vals[exdofs[i]*es+j];
+                        });
+      }
   }
 
 
@@ -269,20 +449,30 @@ namespace ngla
     Array<int> exdofs(ntasks);
     for (int i = 0; i < ntasks; i++)
       exdofs[i] = this->es * this->paralleldofs->GetExchangeDofs(i).Size();
+    FreeRequests();
     delete this->recvvalues;
+    delete this->sendvalues;
     this -> recvvalues = new Table<TSCAL> (exdofs);
+    this -> sendvalues = new Table<TSCAL> (exdofs);
 
-    // Initiate persistent send/recv requests for vector cumulate operation
+    // Initiate persistent send/recv requests for vector cumulate operation,
+    // the exchange dofs are packed into sendvalues
     auto dps = paralleldofs->GetDistantProcs();
     this->sreqs.SetSize(dps.Size());
     this->rreqs.SetSize(dps.Size());
-    // for (auto k : Range(dps)) {
-    //   auto p = dps[k];
-    //   MPI_Datatype mpi_t = this->paralleldofs->MyGetMPI_Type(p);
-    //   MPI_Send_init( this->Memory(), 1, mpi_t, p, MPI_TAG_SOLVE, this->paralleldofs->GetCommunicator(), &sreqs[k]);
-    //   MPI_Recv_init( &( (*recvvalues)[p][0]), (*recvvalues)[p].Size(), MyGetMPIType<TSCAL> (),
-    // 		     p, MPI_TAG_SOLVE, this->paralleldofs->GetCommunicator(), &rreqs[k]);
-    // }
+#ifdef PARALLEL
+    MPI_Datatype MPI_TS = MyGetMPIType<TSCAL> ();
+    MPI_Comm comm = this->paralleldofs->GetCommunicator();
+    for (auto k : Range(dps))
+      {
+        auto p = dps[k];
+        MPI_Send_init (&(*sendvalues)[p][0], (*sendvalues)[p].Size(), MPI_TS,
+                       p, MPI_TAG_SOLVE, comm, &sreqs[k]);
+        MPI_Recv_init (&(*recvvalues)[p][0], (*recvvalues)[p].Size(), MPI_TS,
+                       p, MPI_TAG_SOLVE, comm, &rreqs[k]);
+      }
+    this->persistent_requests = true;
+#endif
   }
 
 
@@ -352,9 +542,23 @@ namespace ngla
   void S_ParallelBaseVectorPtr<SCAL> :: AddRecvValues( int sender )
   {
     FlatArray<int> exdofs = paralleldofs->GetExchangeDofs(sender);
-    FlatMatrix<SCAL> rec (exdofs.Size(), this->es, &(*this->recvvalues)[sender][0]);
-    for (int i = 0; i < exdofs.Size(); i++)
-      (*this) (exdofs[i]) += rec.Row(i);
+    const SCAL * rec = &(*this->recvvalues)[sender][0];
+    SCAL * vals = pdata;
+    size_t es = this->es;
+    // the exchange dofs of one sender are distinct
+    if (es == 1)
+      ExchangeLoop (exdofs.Size(), [&] (IntRange r)
+                    {
+                      for (auto i : r)
+                        vals[exdofs[i]] += rec[i];
+                    });
+    else
+      ExchangeLoop (exdofs.Size(), [&] (IntRange r)
+                    {
+                      for (auto i : r)
+                        for (size_t j = 0; j < es; j++)
+                          vals[exdofs[i]*es+j] += rec[i*es+j];
+                    });
   }
 
 
@@ -15,16 +15,18 @@ from .ngslib import __version__, ngstd, bla, la, fem, comp, solve
 from netgen import Redraw
 
 from pyngcore import BitArray, TaskManager, SetNumThreads
-from .ngstd import Timers, Timer, IntRange
+from .ngstd import Timers, Timer, IntRange, ChromeTrace, TraceRegion, SetMachinePeaks, RooflineReport, ProcessMemory, \
+    EnableParallelStats, ParallelStatsReport, WaitOutput
 from .bla import Matrix, Vector, InnerProduct, Norm
 from .la import BaseMatrix, BaseVector, BlockVector, BlockMatrix, \
-    CreateVVector, CGSolver, QMRSolver, GMRESSolver, ArnoldiSolver, \
+    CreateVVector, CGSolver, QMRSolver, GMRESSolver, ArnoldiSolver, ArnoldiShifts, \
     Projector, IdentityMatrix, Embedding, PermutationMatrix, \
     ConstEBEMatrix, ParallelMatrix, PARALLEL_STATUS
 from .fem import BFI, LFI, CoefficientFunction, Parameter, ET, \
     POINT, SEGM, TRIG, QUAD, TET, PRISM, PYRAMID, HEX, CELL, FACE, EDGE, \
     VERTEX, FACET, ELEMENT, sin, cos, tan, atan, acos, asin, sinh, cosh, \
     exp, log, sqrt, floor, ceil, Conj, atan2, pow, Sym, Skew, Id, Trace, Inv, Det, Cof, Cross, \
+    besselj0, besselj1, bessely0, bessely1, \
     specialcf, BlockBFI, BlockLFI, CompoundBFI, CompoundLFI, BSpline, \
     IntegrationRule, IfPos, VoxelCoefficient
 from .comp import VOL, BND, BBND, BBBND, COUPLING_TYPE, ElementId, \
@@ -42,7 +44,8 @@ from .comp import VOL, BND, BBND, BBBND, COUPLING_TYPE, ElementId, \
 from .solve import BVP, CalcFlux, Draw, DrawFlux, \
     SetVisualization
 from .utils import x, y, z, dx, ds, grad, Grad, curl, div, PyId, PyTrace, \
-    PyDet, PyCross, PyCof, PyInv, PySym, PySkew, OuterProduct, TimeFunction, Normalize
+    PyDet, PyCross, PyCof, PyInv, PySym, PySkew, OuterProduct, TimeFunction, Normalize, \
+    RunAsync
 from . import solvers
 
 
@@ -0,0 +1,117 @@
+"""
+Auxiliary space preconditioners built from NGSolve matrices only.
+
+HiptmairXu for H(curl) problems curl-curl plus mass: a Gauss-Seidel
+smoother in the H(curl) space, and AMG solves of the Galerkin products in
+the lowest order H1 space of the gradients (discrete gradient G) and in
+the lowest order vector valued H1 space (Nedelec interpolation P):
+
+  x = S b,  x += (G (G^T A G)^-1 G^T + P (P^T A P)^-1 P^T) (b - A x),  x = S^T (b, x)
+
+All operators are sparse matrices, products and AMG run with the task manager.
+"""
+
+from ngsolve import BaseMatrix, BitArray, H1, VectorH1, ConvertOperator, Projector, grad
+from ngsolve.la import SparseMatrixd, SparseRAP, PermutationMatrix
+from ngsolve.comp import H1AMGMatrix
+import numpy as np
+
+
+def AuxiliaryFreeDofs(transfer, freedofs):
+    """ mask of the auxiliary dofs which the transfer maps into free dofs only """
+    ri, ci, vals = transfer.COO()
+    ri, ci, vals = np.asarray(ri), np.asarray(ci), np.asarray(vals)
+    ones = transfer.CreateColVector()
+    ones[:] = 1
+    dirichlet = transfer.CreateColVector()
+    dirichlet.data = Projector(freedofs, False) * ones
+    nonzero = vals != 0
+    free = np.zeros(transfer.width, dtype=bool)
+    free[ci[nonzero]] = True
+    free[ci[nonzero & (dirichlet.FV().NumPy()[ri] != 0)]] = False
+    return free
+
+
+class AuxiliarySpaceCorrection:
+    """ T (T^T A T)^-1 T^T on the free auxiliary dofs, AMG for the inverse """
+    def __init__(self, mat, transfer, freedofs, components=1, **amgflags):
+        self.transfer = transfer
+        self.rap = SparseRAP(transfer.CreateTranspose(), mat, transfer)
+        auxfree = AuxiliaryFreeDofs(transfer, freedofs)
+        # one AMG per component, the components are numbered blockwise
+        n = transfer.width // components
+        self.subsets = []
+        for k in range(components):
+            mask = np.zeros(transfer.width, dtype=bool)
+            mask[k*n:(k+1)*n] = auxfree[k*n:(k+1)*n]
+            self.subsets.append(BitArray(mask.tolist()))
+        self.restrictions = [PermutationMatrix(subset) for subset in self.subsets]
+        self.amgs = [H1AMGMatrix(self.rap.mat.CreateSubMatrix(subset), **amgflags)
+                     for subset in self.subsets]
+        self.UpdateOperator()
+
+    def UpdateOperator(self):
+        op = None
+        for r, amg in zip(self.restrictions, self.amgs):
+            term = r.T @ amg @ r
+            op = term if op is None else op + term
+        self.op = self.transfer @ op @ self.transfer.T
+
+    def Update(self, mat):
+        """ new values of A, the graphs and AMG hierarchies are kept """
+        self.rap.Update(mat)
+        for subset, amg in zip(self.subsets, self.amgs):
+            amg.Update(self.rap.mat.CreateSubMatrix(subset))
+
+
+class HiptmairXu(BaseMatrix):
+    """
+    Hiptmair-Xu preconditioner for the matrix of curl-curl plus mass in
+    the H(curl) space fes, free dofs freedofs (default fes.FreeDofs()).
+    The matrix must be stored non-symmetric (SparseMatrixd). Update(mat)
+    reuses transfer operators, Galerkin product graphs and AMG hierarchies
+    for new matrix values, e.g. in time steps.
+    """
+    def __init__(self, mat, fes, freedofs=None, **amgflags):
+        super().__init__()
+        if not isinstance(mat, SparseMatrixd):
+            raise TypeError("HiptmairXu needs an assembled SparseMatrixd")
+        self.mat = mat
+        self.freedofs = freedofs if freedofs is not None else fes.FreeDofs()
+        mesh = fes.mesh
+        fesh1 = H1(mesh, order=1)
+        fesvh1 = VectorH1(mesh, order=1)
+        self.gradient = ConvertOperator(fesh1, fes, trial_proxy=grad(fesh1.TrialFunction()))
+        self.interpolation = ConvertOperator(fesvh1, fes)
+        self.corrections = [AuxiliarySpaceCorrection(mat, self.gradient, self.freedofs, **amgflags),
+                            AuxiliarySpaceCorrection(mat, self.interpolation, self.freedofs,
+                                                     components=mesh.dim, **amgflags)]
+        self.smoother = mat.CreateSmoother(self.freedofs)
+        self._res = mat.CreateColVector()
+
+    def Update(self, mat=None):
+        if mat is not None:
+            self.mat = mat
+        for c in self.corrections:
+            c.Update(self.mat)
+        self.smoother = self.mat.CreateSmoother(self.freedofs)
+
+    def Height(self):
+        return self.mat.height
+
+    def Width(self):
+        return self.mat.width
+
+    def CreateColVector(self):
+        return self.mat.CreateColVector()
+
+    def CreateRowVector(self):
+        return self.mat.CreateRowVector()
+
+    def Mult(self, b, x):
+        x[:] = 0
+        self.smoother.Smooth(x, b)
+        self._res.data = b - self.mat * x
+        for c in self.corrections:
+            x.data += c.op * self._res
+        self.smoother.SmoothBack(x, b)
@@ -1,6 +1,7 @@
 
 from ngsolve import Projector, Norm, TimeFunction, BaseMatrix, Preconditioner, InnerProduct, \
     Norm, sqrt, Vector, Matrix, BaseVector, BitArray
+from ngsolve.la import InnerProducts, SparseMatrixd, PermutationMatrix
 from typing import Optional, Callable
 import logging
 from netgen.libngpy._meshing import _PushStatus, _GetStatus, _SetThreadPercentage
@@ -11,17 +12,30 @@ class CGSolver(BaseMatrix):
                  freedofs : Optional[BitArray] = None,
                  conjugate : bool = False, tol : float = 1e-12, maxsteps : int = 100,
                  callback : Optional[Callable[[int, float], None]] = None,
-                 printing=False, abstol=None):
+                 printing=False, abstol=None, pipelined=False, compress=True):
         super().__init__()
         self.mat = mat
         assert (freedofs is None) != (pre is None) # either pre or freedofs must be given
         self.pre = pre if pre else Projector(freedofs, True)
+        # without preconditioner CG iterates on the free-dof submatrix, instead of
+        # projecting and multiplying the constrained rows in every iteration
+        self.restriction = None
+        if compress and pre is None and not pipelined and isinstance(mat, SparseMatrixd) \
+           and len(freedofs) == mat.height == mat.width:
+            self.restriction = PermutationMatrix(freedofs)
+            self.freedofs = freedofs
+            self.submat = mat.CreateSubMatrix(freedofs)
+            self.pre = None
+            self._full_vec = mat.CreateColVector()
+            self._sub_vecs = [self.submat.CreateColVector() for i in range(2)]
         self.conjugate = conjugate
         self.tol = tol
         self.abstol = abstol
         self.maxsteps = maxsteps
         self.callback = callback
-        self._tmp_vecs = [self.mat.CreateRowVector() for i in range(3)]
+        self.pipelined = pipelined
+        solvemat = self.submat if self.restriction is not None else self.mat
+        self._tmp_vecs = [solvemat.CreateRowVector() for i in range(8 if pipelined else 3)]
         self.logger = logging.getLogger("CGSolver")
 
         self.printing = printing
@@ -60,9 +74,25 @@ class CGSolver(BaseMatrix):
         _PushStatus("CG Solve")
         _SetThreadPercentage(0)
         self.sol = sol if sol is not None else self.mat.CreateRowVector()
-        d, w, s = self._tmp_vecs
+        if self.pipelined:
+            self._SolvePipelined(rhs, initialize)
+            if old_status[0] != "idle":
+                _PushStatus(old_status[0])
+                _SetThreadPercentage(old_status[1])
+            return
+        d, w, s = self._tmp_vecs[:3]
         u, mat, pre, conjugate, tol, maxsteps, callback = self.sol, self.mat, self.pre, self.conjugate, \
             self.tol, self.maxsteps, self.callback
+        if self.restriction is not None:
+            # the correction on the free dofs solves the compressed system,
+            # extracted again as the matrix may have been changed since the last solve
+            if initialize:
+                u[:] = 0
+            self._full_vec.data = rhs - mat * u
+            rhs, u = self._sub_vecs
+            rhs.data = self.restriction * self._full_vec
+            mat = self.submat = self.mat.CreateSubMatrix(self.freedofs)
+            initialize = True
         if initialize:
             u[:] = 0
         d.data = rhs - mat * u
@@ -106,14 +136,79 @@ class CGSolver(BaseMatrix):
             if err < errstop: break
         else:
             self.logger.warning("CG did not converge to tol")
+        if self.restriction is not None:
+            self.sol.data += self.restriction.T * u
         if old_status[0] != "idle":
             _PushStatus(old_status[0])
             _SetThreadPercentage(old_status[1])
-            
-        
 
+    def _SolvePipelined(self, rhs : BaseVector, initialize : bool) -> None:
+        # Ghysels-Vanroose: both inner products of an iteration are computed
+        # together from r, u, w, the preconditioner and matrix do not depend on them
+        r, u, w, m, n, z, q, s = self._tmp_vecs
+        p = self.mat.CreateRowVector()
+        x, mat, pre, conjugate, tol, maxsteps, callback = self.sol, self.mat, self.pre, self.conjugate, \
+            self.tol, self.maxsteps, self.callback
+        if initialize:
+            x[:] = 0
+        r.data = rhs - mat * x
+        u.data = pre * r
+        w.data = mat * u
+        self.errors = []
+        gamma_old = alpha_old = 1
+        errstop = None
+        for it in range(maxsteps+1):
+            gamma, delta = InnerProducts([(u, r), (u, w)], conjugate=conjugate)
+            m.data = pre * w
+            n.data = mat * m
+
+            err = sqrt(abs(gamma))
+            self.errors.append(err)
+            if errstop is None:
+                if err == 0:
+                    return
+                errstop = err * tol
+                if self.abstol is not None:
+                    errstop = max(errstop, self.abstol)
+                lwstart, logerrstop = log(err), log(errstop)
+            else:
+                self.logger.info("iteration " + str(it) + " error = " + str(err))
+                if callback is not None:
+                    callback(it,err)
+                _SetThreadPercentage(100.*max(it/maxsteps, (log(err)-lwstart)/(logerrstop - lwstart)))
+            if err < errstop: break
+            if it == maxsteps:
+                self.logger.warning("CG did not converge to tol")
+                break
+            self.iterations = it+1
 
-def CG(mat, rhs, pre=None, sol=None, tol=1e-12, maxsteps = 100, printrates = True, initialize = True, conjugate=False, callback=None):
+            if it == 0:
+                beta = 0
+                alpha = gamma / delta
+                z.data = n
+                q.data = m
+                s.data = w
+                p.data = u
+            else:
+                beta = gamma / gamma_old
+                alpha = gamma / (delta - beta * gamma / alpha_old)
+                z *= beta
+                z.data += n
+                q *= beta
+                q.data += m
+                s *= beta
+                s.data += w
+                p *= beta
+                p.data += u
+
+            x.data += alpha * p
+            r.data -= alpha * s
+            u.data -= alpha * q
+            w.data -= alpha * z
+            gamma_old, alpha_old = gamma, alpha
+
+
+def CG(mat, rhs, pre=None, sol=None, tol=1e-12, maxsteps = 100, printrates = True, initialize = True, conjugate=False, callback=None, pipelined=False):
     """preconditioned conjugate gradient method
 
 
@@ -147,6 +242,10 @@ def CG(mat, rhs, pre=None, sol=None, tol=1e-12, maxsteps = 100, printrates = Tru
     conjugate : bool
       If set to True, then the complex inner product is used.
 
+    pipelined : bool
+      If set to True, the pipelined variant (Ghysels-Vanroose) is used. It needs one global
+      reduction per iteration instead of two.
+
 
     Returns
     -------
@@ -155,7 +254,7 @@ def CG(mat, rhs, pre=None, sol=None, tol=1e-12, maxsteps = 100, printrates = Tru
 
     """
     solver = CGSolver(mat=mat, pre=pre, conjugate=conjugate, tol=tol, maxsteps=maxsteps,
-                      callback=callback)
+                      callback=callback, pipelined=pipelined)
     if printrates:
         handler = logging.StreamHandler()
         solver.logger.addHandler(handler)
@@ -405,6 +504,8 @@ def MinRes(mat, rhs, pre=None, sol=None, maxsteps = 100, printrates = True, init
     z_new = rhs.CreateVector()
     z = rhs.CreateVector()
     mz = rhs.CreateVector()
+    # fused vector updates for real systems
+    fused = not rhs.is_complex
 
 
     if (initialize):
@@ -442,7 +543,11 @@ def MinRes(mat, rhs, pre=None, sol=None, maxsteps = 100, printrates = True, init
     while (k < maxsteps+1 and ResNorm > tol):
         mz.data = mat*z
         delta = InnerProduct(mz,z)
-        v_new.data = mz - delta*v - gamma * v_old
+        if fused:
+            v_new.data = mz
+            v_new.Add2(-delta, v, -gamma, v_old)
+        else:
+            v_new.data = mz - delta*v - gamma * v_old
         
         z_new.data = pre * v_new if pre else v_new
 
@@ -458,7 +563,11 @@ def MinRes(mat, rhs, pre=None, sol=None, maxsteps = 100, printrates = True, init
         c_new = alpha0/alpha1
         s_new = gamma_new/alpha1
 
-        w_new.data = z - alpha3*w_old - alpha2*w
+        if fused:
+            w_new.data = z
+            w_new.Add2(-alpha3, w_old, -alpha2, w)
+        else:
+            w_new.data = z - alpha3*w_old - alpha2*w
         w_new.data = 1/alpha1 * w_new   
 
         u.data += c_new*eta_old * w_new
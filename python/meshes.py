@@ -648,3 +648,90 @@ def MakeStructuredSurfaceMesh(quads=True, nx=10, ny=10, mapping = None, secondor
     mesh.Compress()       
     ngsmesh = ngsolve.Mesh(mesh)
     return ngsmesh
+
+
+def MeshFromArrays(points, elements, regions=None, bnd_elements=None, bnd_regions=None,
+                   materials=None, bcs=None, base=0):
+    """
+    Generate a 2D or 3D mesh from arrays of points and elements
+
+    The arrays are added to the Netgen mesh in bulk, one call per
+    region, there is no Python loop over points or elements. The
+    topology is built by the constructor of the NGSolve mesh.
+
+    Parameters
+    ----------
+    points : array (np, dim)
+      Vertex coordinates, dim = 2 or 3 is the dimension of the mesh.
+
+    elements : array (ne, nv)
+      Vertex numbers of the volume elements, ordered as in Netgen.
+      nv = 3, 4 (trigs, quads) in 2D, and nv = 4, 5, 6, 8 (tets,
+      pyramids, prisms, hexes) in 3D.
+
+    regions : array (ne)
+      Region number of the elements, starting from 0. Default: all 0.
+
+    bnd_elements : array (nse, nv)
+      Vertex numbers of the boundary elements, segments in 2D,
+      trigs or quads in 3D.
+
+    bnd_regions : array (nse)
+      Boundary region number of the boundary elements, starting from 0.
+
+    materials : list of str
+      Names of the regions. Default: "dom0", "dom1", ...
+
+    bcs : list of str
+      Names of the boundary regions. Default: "bnd0", "bnd1", ...
+
+    base : int
+      Number of the first point in the element arrays, 0 or 1.
+
+    Returns
+    -------
+    (ngsolve.mesh)
+      Returns generated NGSolve mesh
+
+    """
+    import numpy as np
+
+    points = np.ascontiguousarray(points, dtype=np.double)
+    if points.ndim != 2 or points.shape[1] not in (2,3):
+        raise Exception("MeshFromArrays: points must be of shape (np,2) or (np,3)")
+    dim = points.shape[1]
+
+    def grouped(els, regs, names, default):
+        els = np.ascontiguousarray(els, dtype=np.int32)
+        if els.ndim != 2:
+            raise Exception("MeshFromArrays: elements must be of shape (ne,nv)")
+        if regs is None:
+            regs = np.zeros(len(els), dtype=np.int32)
+        regs = np.asarray(regs)
+        if len(regs) != len(els):
+            raise Exception("MeshFromArrays: one region number per element needed")
+        nregs = int(regs.max())+1 if len(regs) else 0
+        if names is None:
+            names = [default+str(k) for k in range(nregs)]
+        if len(names) < nregs:
+            raise Exception("MeshFromArrays: " + str(nregs) + " region names needed")
+        order = np.argsort(regs, kind="stable")
+        first = np.searchsorted(regs[order], np.arange(len(names)+1))
+        return [(names[k], np.ascontiguousarray(els[order[first[k]:first[k+1]]]))
+                for k in range(len(names))]
+
+    if dim == 2:
+        points = np.hstack([points, np.zeros((len(points),1))])
+
+    mesh = Mesh(dim=dim)
+    mesh.AddPoints(points)
+    for name, els in grouped(elements, regions, materials, "dom"):
+        index = mesh.AddRegion(name, dim=dim)
+        if len(els):
+            mesh.AddElements(dim=dim, index=index, data=els, base=base)
+    if bnd_elements is not None:
+        for name, els in grouped(bnd_elements, bnd_regions, bcs, "bnd"):
+            index = mesh.AddRegion(name, dim=dim-1)
+            if len(els):
+                mesh.AddElements(dim=dim-1, index=index, data=els, base=base)
+    return ngsolve.Mesh(mesh)
@@ -86,7 +86,9 @@ class NewtonSolver:
         u.vec.data += w
 
     def _UpdateInverse(self):
-        if self.inverse in ("sparsecholesky", "given") and self.inv:
+        # matrix structure is kept by AssembleLinearization, so a factorization
+        # of the same matrix is only refactored numerically
+        if self.inv and (self.inverse == "given" or self.inv.supports_update):
             self.inv.Update()
         else:
             self.inv = self.a.mat.Inverse(self.freedofs,
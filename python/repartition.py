@@ -0,0 +1,213 @@
+"""
+Repartitioning of MPI-distributed meshes, e.g. between the steps of an
+adaptive loop when local refinement has unbalanced the distribution.
+
+The distributed mesh is collected on rank 0 and distributed again by
+Netgen, GridFunctions are carried over element by element. Element
+costs decide whether the repartitioning pays off, Netgen's partitioner
+balances the number of elements.
+
+Limitations: the new mesh has no refinement hierarchy (no multigrid
+prolongation to older levels), straight elements and no geometry, and
+codimension 2 regions (BBND) are not transferred.
+"""
+
+import netgen.meshing as ngm
+from ngsolve import Mesh, GridFunction, L2, CoefficientFunction, VOL, BND
+
+
+def _ElementWeights(mesh, weights, space):
+    if weights is not None:
+        if len(weights) != mesh.ne:
+            raise Exception("Repartition: need one weight per local volume element")
+        return weights
+    if space is not None:
+        return [len(space.GetDofNrs(el)) for el in mesh.Elements(VOL)]
+    return [1] * mesh.ne
+
+
+def LoadImbalance(mesh, weights=None, space=None):
+    """
+Load imbalance of a distributed mesh: maximal cost of a rank divided by
+the average cost, 1 is perfectly balanced.
+
+Parameters
+----------
+
+mesh (ngsolve.Mesh): the distributed mesh
+weights (list=None): cost of every local volume element
+space (ngsolve.FESpace=None): if no weights are given, the cost of an element
+    is its number of dofs in this space, otherwise 1
+
+"""
+    comm = mesh.comm
+    if comm.size == 1:
+        return 1.0
+    load = float(sum(_ElementWeights(mesh, weights, space)))
+    # rank 0 holds no elements of a distributed Netgen mesh
+    loads = comm.mpi4py.allgather(load)[1:]
+    average = sum(loads) / len(loads)
+    return max(loads) / average if average > 0 else 1.0
+
+
+def _Leaves(gf):
+    if len(gf.components) == 0:
+        return [gf]
+    return [leaf for comp in gf.components for leaf in _Leaves(comp)]
+
+
+def _OrderSignature(vertices):
+    """ relative order of the (local or global) vertex numbers, it fixes the orientation of the element """
+    return tuple(sorted(range(len(vertices)), key=lambda j: vertices[j]))
+
+
+def _ElementDofs(l2spaces, mesh):
+    """ dofs of every volume element in the discontinuous transfer spaces """
+    return [[l2.GetDofNrs(el) for l2 in l2spaces] for el in mesh.Elements(VOL)]
+
+
+def _TransferSpaces(mesh, gfs):
+    """ one scalar L2 space per leaf function and component, it represents the leaf exactly """
+    spaces = []
+    for gf in gfs:
+        for leaf in _Leaves(gf):
+            order = leaf.space.globalorder
+            # Nedelec and Raviart-Thomas spaces of order p contain polynomials of degree p+1
+            if leaf.space.type.lower().startswith(("hcurl", "hdiv")):
+                order += 1
+            l2 = L2(mesh, order=order, complex=leaf.space.is_complex)
+            spaces += [l2] * leaf.dim
+    return spaces
+
+
+def _CollectLocalData(mesh, gfs):
+    globnums = mesh.GetGlobalVertexNumbers()
+    points = [(globnums[v.nr], v.point) for v in mesh.vertices]
+
+    l2spaces = _TransferSpaces(mesh, gfs)
+    l2funcs = []
+    k = 0
+    for gf in gfs:
+        for leaf in _Leaves(gf):
+            for comp in range(leaf.dim):
+                gl2 = GridFunction(l2spaces[k])
+                gl2.Set(leaf if leaf.dim == 1 else leaf[comp])
+                l2funcs.append(gl2.vec.FV().NumPy())
+                k += 1
+
+    volume = []
+    for el, eldofs in zip(mesh.Elements(VOL), _ElementDofs(l2spaces, mesh)):
+        locverts = [v.nr for v in el.vertices]
+        verts = tuple(globnums[v] for v in locverts)
+        coefs = [vals[list(dofs)].copy() for vals, dofs in zip(l2funcs, eldofs)]
+        volume.append((el.index, verts, _OrderSignature(locverts), coefs))
+    boundary = [(el.index, tuple(globnums[v.nr] for v in el.vertices))
+                for el in mesh.Elements(BND)]
+    return points, volume, boundary
+
+
+def _BuildNetgenMesh(dim, materials, bcnames, gathered):
+    ngmesh = ngm.Mesh(dim=dim)
+    coords = {}
+    for points, _, _ in gathered:
+        for nr, p in points:
+            coords[nr] = tuple(p) + (0,) * (3 - len(p))
+    # points in the order of the old global numbers, this keeps the orientation of the elements
+    pids = { nr : ngmesh.Add(ngm.MeshPoint(ngm.Pnt(*coords[nr]))) for nr in sorted(coords) }
+
+    matidx = [ngmesh.AddRegion(name, dim=dim) for name in materials]
+    bcidx = [ngmesh.AddRegion(name, dim=dim-1) for name in bcnames]
+
+    VolumeElement = ngm.Element3D if dim == 3 else ngm.Element2D
+    elements = {}
+    for _, volume, _ in gathered:
+        for index, verts, signature, coefs in volume:
+            ngmesh.Add(VolumeElement(matidx[index], [pids[v] for v in verts]))
+            elements[tuple(sorted(verts))] = (verts, signature, coefs)
+
+    # boundary elements at interfaces of ranks may be present twice
+    bndelements = set()
+    for _, _, boundary in gathered:
+        for index, verts in boundary:
+            key = (index, tuple(sorted(verts)))
+            if key in bndelements:
+                continue
+            bndelements.add(key)
+            if dim == 3:
+                ngmesh.Add(ngm.Element2D(bcidx[index], [pids[v] for v in verts]))
+            else:
+                ngmesh.Add(ngm.Element1D([pids[v] for v in verts], index=bcidx[index]))
+    return ngmesh, elements
+
+
+def Repartition(mesh, gfs=[], weights=None, tolerance=1.1):
+    """
+Distributes a mesh anew if its load imbalance exceeds the tolerance, and
+transfers GridFunctions to the new distribution. Call it between two
+steps of an adaptive loop, after refinement. All ranks have to call it.
+
+Parameters
+----------
+
+mesh (ngsolve.Mesh): the distributed mesh
+gfs (list of ngsolve.GridFunction): functions on the mesh to migrate
+weights (list=None): cost of every local volume element, default is the
+    number of dofs of the first GridFunction's space on the element
+tolerance (float=1.1): repartition only if LoadImbalance exceeds it,
+    use 1 to repartition in any case
+
+Returns
+-------
+
+(mesh, gfs): the new mesh and the GridFunctions on new spaces of the same
+    type and flags, or the input if the mesh is balanced
+
+"""
+    comm = mesh.comm
+    if comm.size == 1:
+        return mesh, gfs
+    if mesh.dim not in (2, 3):
+        raise Exception("Repartition: only for 2D and 3D meshes")
+    space = gfs[0].space if len(gfs) else None
+    if LoadImbalance(mesh, weights, space) <= tolerance:
+        return mesh, gfs
+
+    mpicomm = comm.mpi4py
+    gathered = mpicomm.gather(_CollectLocalData(mesh, gfs), root=0)
+
+    if comm.rank == 0:
+        ngmesh, elements = _BuildNetgenMesh(mesh.dim, mesh.GetMaterials(),
+                                            mesh.GetBoundaries(), gathered)
+        del gathered
+        ngmesh.Distribute(comm)
+    else:
+        ngmesh = ngm.Mesh.Receive(comm)
+    newmesh = Mesh(ngmesh)
+    newgfs = [GridFunction(gf.space.CopyOnMesh(newmesh), name=gf.name) for gf in gfs]
+
+    # the new owners look up the coefficients of their elements on rank 0
+    globnums = newmesh.GetGlobalVertexNumbers()
+    locverts = [[v.nr for v in el.vertices] for el in newmesh.Elements(VOL)]
+    keys = [tuple(sorted(globnums[v] for v in verts)) for verts in locverts]
+    requests = mpicomm.gather(keys, root=0)
+    answers = [[elements[key] for key in keys] for keys in requests] if comm.rank == 0 else None
+    received = mpicomm.scatter(answers, root=0)
+    if comm.rank == 0:
+        del elements
+
+    l2spaces = _TransferSpaces(newmesh, newgfs)
+    l2funcs = [GridFunction(l2) for l2 in l2spaces]
+    l2vals = [gl2.vec.FV().NumPy() for gl2 in l2funcs]
+    for verts, eldofs, (oldverts, signature, coefs) in zip(locverts, _ElementDofs(l2spaces, newmesh), received):
+        if tuple(globnums[v] for v in verts) != oldverts or _OrderSignature(verts) != signature:
+            raise Exception("Repartition: element orientation changed, cannot transfer the coefficients")
+        for vals, dofs, c in zip(l2vals, eldofs, coefs):
+            vals[list(dofs)] = c
+
+    k = 0
+    for gf in newgfs:
+        for leaf in _Leaves(gf):
+            comps = l2funcs[k:k+leaf.dim]
+            leaf.Set(comps[0] if leaf.dim == 1 else CoefficientFunction(tuple(comps)))
+            k += leaf.dim
+    return newmesh, newgfs
@@ -0,0 +1,61 @@
+"""
+Reduced-order models of affinely parametrized problems
+
+    A(mu) = sum_q theta_q(mu) A_q,     f(mu) = sum_q phi_q(mu) f_q
+
+The terms are assembled once, their projections onto the reduced basis
+are cached by the C++ ReducedOperator, the online solve only sums and
+solves small dense systems.
+"""
+
+from ngsolve.la import MultiVector, ReducedOperator
+from ngsolve.comp import BilinearForm, LinearForm, SumOfIntegrals
+
+
+def Basis(vecs):
+    """ MultiVector of a list of vectors or GridFunctions """
+    vecs = [getattr(v, "vec", v) for v in vecs]
+    basis = MultiVector(len(vecs[0]), len(vecs))
+    for i, v in enumerate(vecs):
+        basis[i].data = v
+    return basis
+
+
+def AffineTerms(form):
+    """ a list of SumOfIntegrals is one term per entry, a SumOfIntegrals one term per integral """
+    if isinstance(form, SumOfIntegrals):
+        return [SumOfIntegrals(igl) for igl in form]
+    return list(form)
+
+
+def AffineReducedOperator(fes, forms, V, W=None, rhs=[], **flags):
+    """
+Assembles the terms A_q of the bilinear forms and f_q of the linear
+forms on fes and returns their ReducedOperator.
+
+Parameters
+----------
+
+fes (FESpace): space of the full problem
+forms (SumOfIntegrals, or list of SumOfIntegrals): the terms A_q
+V (MultiVector, or list of vectors/GridFunctions): trial basis
+W (MultiVector, or list of vectors/GridFunctions): test basis, W = V if not given
+rhs (SumOfIntegrals, or list of SumOfIntegrals): the terms f_q
+flags: flags of the bilinear forms
+
+"""
+    V = V if isinstance(V, MultiVector) else Basis(V)
+    if W is not None and not isinstance(W, MultiVector):
+        W = Basis(W)
+    rom = ReducedOperator(V, W)
+    for term in AffineTerms(forms):
+        a = BilinearForm(fes, **flags)
+        a += term
+        a.Assemble()
+        rom.AddMatrix(a.mat)
+    for term in AffineTerms(rhs):
+        f = LinearForm(fes)
+        f += term
+        f.Assemble()
+        rom.AddVector(f.vec)
+    return rom
@@ -144,3 +144,28 @@ def TimeFunction(func, name=None):
 
 def Normalize (v):
     return 1/Norm(v) * v
+
+
+_async_executor = None
+
+def RunAsync (func, *args, **kwargs):
+    """Call func(*args, **kwargs) in a background thread.
+Returns a concurrent.futures.Future, use .result() to wait for it.
+
+Assembling, inverses, Krylov solvers and VTK output release the GIL,
+so Python threads (e.g. output, monitoring) continue meanwhile. Tasks
+run one after the other in a single worker thread. If the main thread
+runs a parallel job at the same time, the TaskManager executes the
+second one sequentially."""
+    global _async_executor
+    if _async_executor is None:
+        from concurrent.futures import ThreadPoolExecutor
+        _async_executor = ThreadPoolExecutor(max_workers=1)
+    return _async_executor.submit(func, *args, **kwargs)
+
+BilinearForm.AssembleAsync = lambda self, *args, **kwargs: RunAsync(self.Assemble, *args, **kwargs)
+BilinearForm.AssembleAsync.__doc__ = "Assemble in the background, returns a Future"
+LinearForm.AssembleAsync = lambda self, *args, **kwargs: RunAsync(self.Assemble, *args, **kwargs)
+LinearForm.AssembleAsync.__doc__ = "Assemble in the background, returns a Future"
+VTKOutput.DoAsync = lambda self, *args, **kwargs: RunAsync(self.Do, *args, **kwargs)
+VTKOutput.DoAsync.__doc__ = "write output in the background, returns a Future"
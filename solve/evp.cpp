@@ -21,6 +21,11 @@ namespace ngsolve
     int num;
 
     double prec, shift, shifti;
+    /// spectrum slicing by several shifts, the factorization is reused
+    Array<double> shifts;
+    int maxrestarts;
+    double tol;
+    bool krylovschur;
     bool print;
 
     string filename;
@@ -60,6 +65,10 @@ namespace ngsolve
     num = int(flags.GetNumFlag ("num", 500));
     shift = flags.GetNumFlag ("shift",1); 
     shifti = flags.GetNumFlag ("shifti",0); 
+    shifts = flags.GetNumListFlag ("shifts");
+    maxrestarts = int(flags.GetNumFlag ("maxrestarts", 0));
+    tol = flags.GetNumFlag ("tol", 1e-8);
+    krylovschur = flags.GetDefineFlag ("krylovschur");
 
     filename = flags.GetStringFlag ("filename","eigen.out"); 
 
@@ -82,15 +91,24 @@ namespace ngsolve
             Arnoldi<Complex> arnoldi (bfa->GetMatrixPtr(), bfm->GetMatrixPtr(), 
                                       bfa->GetFESpace()->GetFreeDofs() );
             arnoldi.SetShift (Complex(shift,shifti));
+            arnoldi.SetRestarts (maxrestarts, tol);
             
             int nev = gfu->GetMultiDim();
             Array<shared_ptr<BaseVector>> evecs(nev);
 
             Array<Complex> lam(nev);
-            if (pre)
-              arnoldi.Calc (num, lam, nev, evecs, pre->GetMatrixPtr());
+            auto premat = pre ? pre->GetMatrixPtr() : nullptr;
+            if (shifts.Size())
+              {
+                Array<Complex> cshifts(shifts.Size());
+                for (auto i : Range(shifts)) cshifts[i] = Complex(shifts[i], shifti);
+                arnoldi.CalcShifts (cshifts, num, lam, nev, evecs, premat);
+                nev = min2 (nev, int(evecs.Size()));
+              }
+            else if (krylovschur)
+              arnoldi.CalcKrylovSchur (num, lam, nev, evecs, premat);
             else
-              arnoldi.Calc (num, lam, nev, evecs, 0);
+              arnoldi.Calc (num, lam, nev, evecs, premat);
             
             ofstream eigenout(filename.c_str());
             eigenout.precision(16);
@@ -110,16 +128,23 @@ namespace ngsolve
             Arnoldi<double> arnoldi (bfa->GetMatrixPtr(), bfm->GetMatrixPtr(), 
                                      bfa->GetFESpace()->GetFreeDofs() );
             arnoldi.SetShift (shift);
+            arnoldi.SetRestarts (maxrestarts, tol);
             
             int nev = gfu->GetMultiDim();
             Array<shared_ptr<BaseVector>> evecs(nev);
             // for (int i = 0; i  < nev; i++)
             // evecs[i] = &gfu->GetVector(i);
             Array<Complex> lam(nev);
-            if (pre)
-              arnoldi.Calc (num, lam, nev, evecs, pre->GetMatrixPtr());
+            auto premat = pre ? pre->GetMatrixPtr() : nullptr;
+            if (shifts.Size())
+              {
+                arnoldi.CalcShifts (shifts, num, lam, nev, evecs, premat);
+                nev = min2 (nev, int(evecs.Size()));
+              }
+            else if (krylovschur)
+              arnoldi.CalcKrylovSchur (num, lam, nev, evecs, premat);
             else
-              arnoldi.Calc (num, lam, nev, evecs, 0);
+              arnoldi.Calc (num, lam, nev, evecs, premat);
             
             ofstream eigenout(filename.c_str());
             eigenout.precision(16);
@@ -4,9 +4,9 @@ Solver for a hyperbolic pde
 
 Solves
 
-M d^2u/dt^2  +  A u = f
+M d^2u/dt^2  +  C du/dt  +  A u = f
 
-by the Newmark method
+by the Newmark or the generalized-alpha method
 
 
 Please include this file to the src files given in netgen/ngsolve/Makefile
@@ -32,6 +32,8 @@ protected:
   shared_ptr<BilinearForm> bfa;
   // bilinear-form for the mass-matrix
   shared_ptr<BilinearForm> bfm;
+  // optional bilinear-form for damping
+  shared_ptr<BilinearForm> bfc;
   // linear-form providing the right hand side
   shared_ptr<LinearForm> lff;
   // solution vector
@@ -41,6 +43,9 @@ protected:
   double dt;
   // total time
   double tend;
+  // generalized-alpha with spectral radius rho_inf, Newmark otherwise
+  bool use_alpha;
+  double rho_inf;
 
 public:
     
@@ -56,11 +61,15 @@ public:
 
     bfa = apde->GetBilinearForm (flags.GetStringFlag ("bilinearforma", "a"));
     bfm = apde->GetBilinearForm (flags.GetStringFlag ("bilinearformm", "m"));
+    if (flags.StringFlagDefined ("bilinearformc"))
+      bfc = apde->GetBilinearForm (flags.GetStringFlag ("bilinearformc", "c"));
     lff = apde->GetLinearForm (flags.GetStringFlag ("linearform", "f"));
     gfu = apde->GetGridFunction (flags.GetStringFlag ("gridfunction", "u"));
 
     dt = flags.GetNumFlag ("dt", 0.001);
     tend = flags.GetNumFlag ("tend", 1);
+    use_alpha = flags.NumFlagDefined ("rhoinf");
+    rho_inf = flags.GetNumFlag ("rhoinf", 1);
   }
 
   virtual ~NumProcHyperbolic() 
@@ -72,58 +81,32 @@ public:
   {
     cout << "solve hyperbolic pde" << endl;
       
-    // reference to the matrices provided by the bi-forms.
-    // will be of type SparseSymmetricMatrix<double> for scalar problems
+    // the integrator assembles and factors M + (dt*dt/4) A once,
+    // and refactors (numerically only) if dt changes
+    GeneralizedAlpha integrator (bfm->GetMatrixPtr(), bfc ? bfc->GetMatrixPtr() : nullptr,
+                                 bfa->GetMatrixPtr(), rho_inf,
+                                 bfa->GetFESpace()->GetFreeDofs());
+    if (!use_alpha)
+      integrator.SetNewmark();
 
-    const BaseMatrix & mata = bfa->GetMatrix();
-    const BaseMatrix & matm = bfm->GetMatrix();
-    const BaseVector & vecf = lff->GetVector();
-    BaseVector & vecu = gfu->GetVector();
-
-    // creates a matrix of same type:
-    auto summat = matm.CreateMatrix();
+    // load is switched off at t = 1
+    integrator.AddSource (lff->GetVectorPtr(), [] (double t) { return (t < 1) ? 1.0 : 0.0; });
 
-    // create additional vectors:
-    auto d = vecu.CreateVector();
-    auto w = vecu.CreateVector();
+    BaseVector & vecu = gfu->GetVector();
     auto v = vecu.CreateVector();
     auto a = vecu.CreateVector();
-    auto anew = vecu.CreateVector();
-
-
-    // matrices matm and mata have the same memory layout. The arrays of values 
-    // can be accessed and manipulated as vectors:
-
-    summat->AsVector() = matm.AsVector() + (dt*dt/4) * mata.AsVector();
 
-    // A sparse matrix can compute a sparse factorization. One has to cast to a sparse matrix:
-    // auto invmat = * dynamic_cast<BaseSparseMatrix&> (*summat) . InverseMatrix();
-    auto & invmat = * summat -> InverseMatrix();
-
-
-    // Newmark method
     vecu = 0;
     v = 0;
     a = 0;
 
-    for (double t = 0; t <= tend; t += dt)
-      {
-	cout << "t = " << t << endl;
-
-	*w = vecu + dt * *v + (dt*dt/4) * *a;
-
-	double fac = (t < 1) ? 1 : 0;
-	*d = fac * vecf - mata * *w;
-	*anew = invmat * *d;
-	
-	vecu += dt * *v + (dt*dt/4) * *a + (dt*dt/4) * *anew;
-	*v += (dt/2) * *a + (dt/2) * *anew;
-
-	*a = *anew;
-
-	// update visualization
-	Ng_Redraw ();	  
-      }
+    integrator.Integrate (vecu, v, a, 0, tend, dt, 1,
+                          [] (double t, int step)
+                          {
+                            cout << "t = " << t << endl;
+                            // update visualization
+                            Ng_Redraw ();
+                          });
   }
 
 
@@ -141,10 +124,12 @@ public:
     ost << GetClassName() << endl
 	<< "Bilinear-form A = " << bfa->GetName() << endl
 	<< "Bilinear-form M = " << bfm->GetName() << endl
+	<< "Bilinear-form C = " << (bfc ? bfc->GetName() : string("none")) << endl
 	<< "Linear-form     = " << lff->GetName() << endl
 	<< "Gridfunction    = " << gfu->GetName() << endl
 	<< "dt              = " << dt << endl
-	<< "tend            = " << tend << endl;
+	<< "tend            = " << tend << endl
+	<< "method          = " << (use_alpha ? "generalized-alpha, rho_inf = " + ToString(rho_inf) : string("Newmark")) << endl;
   }
 
   ///
@@ -153,7 +138,7 @@ public:
     ost << 
       "\n\nNumproc Hyperbolic:\n" \
       "------------------\n" \
-      "Solves a hyperbolic partial differential equation by an implicite Euler method\n\n" \
+      "Solves M u'' + C u' + A u = f by the Newmark or the generalized-alpha method\n\n" \
       "Required flags:\n" 
       "-bilinearforma=<bfname>\n" 
       "    bilinear-form providing the stiffness matrix\n" \
@@ -167,6 +152,11 @@ public:
       "    time step\n"
       "-tend=<value>\n"
       "    total time\n"
+      "Optional flags:\n"
+      "-bilinearformc=<bfname>\n"
+      "    bilinear-form providing the damping matrix\n"
+      "-rhoinf=<value>\n"
+      "    generalized-alpha with spectral radius rho_inf in [0,1], Newmark otherwise\n"
 	<< endl;
   }
 };
@@ -424,6 +424,15 @@ void * SocketThread (void * data)
                   pde -> DoArchive (archive);
                   cout << "PDE completely sent" << endl;
                 }
+              else if (str == "pdebinary" || str == "pdebinary_compressed")
+                {
+		  cout << "socket: got command '" << str << "'" << endl;
+                  BinarySocketOutArchive archive(new_sock, str == "pdebinary_compressed");
+                  pde -> DoArchive (archive);
+                  archive.Flush();
+                  cout << "PDE completely sent, " << archive.BytesSent() << " bytes ("
+                       << archive.BytesRaw() << " uncompressed)" << endl;
+                }
               else
                 {
                   cout << "got string '" << str << "'" << endl;
@@ -809,12 +818,24 @@ int NGS_SocketLoad (ClientData clientData,
           string hostname = "localhost";
           if (argc >= 3) hostname = argv[2];
               
+          // optional third argument: binary or compressed
+          string mode = "";
+          if (argc >= 4) mode = argv[3];
+              
           ClientSocket socket (portnum, hostname);
-          socket << "pde";
-          
-          SocketInArchive archive (socket);
           pde = make_shared<PDE>();
-          pde->DoArchive (archive);
+          if (mode == "binary" || mode == "compressed")
+            {
+              socket << (mode == "binary" ? "pdebinary" : "pdebinary_compressed");
+              BinarySocketInArchive archive (socket);
+              pde->DoArchive (archive);
+            }
+          else
+            {
+              socket << "pde";
+              SocketInArchive archive (socket);
+              pde->DoArchive (archive);
+            }
 
 #ifdef NGS_PYTHON
           if(netgen::netgen_executable_started)
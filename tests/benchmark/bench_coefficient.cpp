@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+#include <fem.hpp>
+using namespace ngfem;
+
+// SIMD evaluation of coefficient function trees, as in the element loops
+
+static shared_ptr<CoefficientFunction> BenchmarkCF (int depth)
+{
+  auto x = MakeCoordinateCoefficientFunction(0);
+  auto y = MakeCoordinateCoefficientFunction(1);
+  auto z = MakeCoordinateCoefficientFunction(2);
+  shared_ptr<CoefficientFunction> cf = x;
+  for (int i = 0; i < depth; i++)
+    cf = cf*y + z*x + make_shared<ConstantCoefficientFunction> (i);
+  return cf;
+}
+
+static void BM_CoefficientEvaluate (benchmark::State & state)
+{
+  LocalHeap lh(1000000, "benchmark");
+  SIMD_IntegrationRule simdir(ET_TET, state.range(1));
+  FE_ElementTransformation<3,3> trafo(ET_TET);
+  SIMD_MappedIntegrationRule<3,3> mir(simdir, trafo, lh);
+
+  auto cf = BenchmarkCF (state.range(0));
+  bool compiled = state.range(2);
+  if (compiled)
+    cf = Compile (cf, false);
+  Matrix<SIMD<double>> values(1, simdir.Size());
+  for (auto _ : state)
+    {
+      cf->Evaluate (mir, values);
+      benchmark::DoNotOptimize (values.Data());
+    }
+  state.counters["nip"] = simdir.GetNIP();
+}
+BENCHMARK(BM_CoefficientEvaluate)
+->ArgNames({"depth", "order", "compiled"})
+->Args({1,4,0})->Args({10,4,0})->Args({10,4,1})->Args({10,10,0})->Args({10,10,1});
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include <fem.hpp>
+using namespace ngfem;
+
+// shape functions and sum-factorized evaluation of H1 high order elements
+
+template <ELEMENT_TYPE ET>
+static void BM_H1CalcShape (benchmark::State & state)
+{
+  H1HighOrderFE<ET> fel(state.range(0));
+  IntegrationRule ir(ET, 2*fel.Order());
+  Vector<> shape(fel.GetNDof());
+  for (auto _ : state)
+    for (auto & ip : ir)
+      {
+        fel.CalcShape (ip, shape);
+        benchmark::DoNotOptimize (shape.Data());
+      }
+  state.counters["ndof"] = fel.GetNDof();
+  state.counters["nip"] = ir.Size();
+}
+BENCHMARK_TEMPLATE(BM_H1CalcShape, ET_TRIG)->DenseRange(1,7,2);
+BENCHMARK_TEMPLATE(BM_H1CalcShape, ET_TET)->DenseRange(1,7,2);
+BENCHMARK_TEMPLATE(BM_H1CalcShape, ET_HEX)->DenseRange(1,5,2);
+
+
+template <ELEMENT_TYPE ET>
+static void BM_H1Evaluate (benchmark::State & state)
+{
+  H1HighOrderFE<ET> fel(state.range(0));
+  SIMD_IntegrationRule simdir(ET, 2*fel.Order());
+  Vector<> coefs(fel.GetNDof());
+  Vector<SIMD<double>> values(simdir.Size());
+  for (size_t i = 0; i < coefs.Size(); i++)
+    coefs(i) = 1.0/(i+1);
+  for (auto _ : state)
+    {
+      fel.Evaluate (simdir, coefs, values);
+      benchmark::DoNotOptimize (values.Data());
+    }
+  state.counters["ndof"] = fel.GetNDof();
+  state.counters["nip"] = simdir.GetNIP();
+}
+BENCHMARK_TEMPLATE(BM_H1Evaluate, ET_TRIG)->DenseRange(1,7,2);
+BENCHMARK_TEMPLATE(BM_H1Evaluate, ET_TET)->DenseRange(1,7,2);
+BENCHMARK_TEMPLATE(BM_H1Evaluate, ET_HEX)->DenseRange(1,5,2);
+
+
+template <ELEMENT_TYPE ET>
+static void BM_H1AddTrans (benchmark::State & state)
+{
+  H1HighOrderFE<ET> fel(state.range(0));
+  SIMD_IntegrationRule simdir(ET, 2*fel.Order());
+  Vector<> coefs(fel.GetNDof());
+  Vector<SIMD<double>> values(simdir.Size());
+  values = SIMD<double>(1.0);
+  coefs = 0.0;
+  for (auto _ : state)
+    {
+      fel.AddTrans (simdir, values, coefs);
+      benchmark::DoNotOptimize (coefs.Data());
+    }
+  state.counters["ndof"] = fel.GetNDof();
+  state.counters["nip"] = simdir.GetNIP();
+}
+BENCHMARK_TEMPLATE(BM_H1AddTrans, ET_TRIG)->DenseRange(1,7,2);
+BENCHMARK_TEMPLATE(BM_H1AddTrans, ET_TET)->DenseRange(1,7,2);
+BENCHMARK_TEMPLATE(BM_H1AddTrans, ET_HEX)->DenseRange(1,5,2);
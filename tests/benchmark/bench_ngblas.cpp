@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+#include <bla.hpp>
+using namespace ngbla;
+
+// dense kernels at element matrix sizes
+
+static void SetValues (SliceMatrix<> mat)
+{
+  for (size_t i = 0; i < mat.Height(); i++)
+    for (size_t j = 0; j < mat.Width(); j++)
+      mat(i,j) = sin(2+3*i+5*j);
+}
+
+static benchmark::Counter Flops (double flops)
+{
+  return benchmark::Counter (flops, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+static void BM_MatVec (benchmark::State & state)
+{
+  size_t n = state.range(0);
+  Matrix<> a(n,n);
+  Vector<> x(n), y(n);
+  SetValues (a);
+  x = 1;
+  for (auto _ : state)
+    {
+      MultMatVec (a, x, y);
+      benchmark::DoNotOptimize (y.Data());
+    }
+  state.counters["flops"] = Flops (2.0*n*n);
+}
+BENCHMARK(BM_MatVec)->Arg(10)->Arg(20)->Arg(35)->Arg(56)->Arg(120);
+
+static void BM_MatTransVec (benchmark::State & state)
+{
+  size_t n = state.range(0);
+  Matrix<> a(n,n);
+  Vector<> x(n), y(n);
+  SetValues (a);
+  x = 1;
+  for (auto _ : state)
+    {
+      MultMatTransVec (a, x, y);
+      benchmark::DoNotOptimize (y.Data());
+    }
+  state.counters["flops"] = Flops (2.0*n*n);
+}
+BENCHMARK(BM_MatTransVec)->Arg(10)->Arg(20)->Arg(35)->Arg(56)->Arg(120);
+
+/// C = A B with A of size n x k, B of size k x m
+static void BM_MultMatMat (benchmark::State & state)
+{
+  size_t n = state.range(0), k = state.range(1), m = state.range(2);
+  Matrix<> a(n,k), b(k,m), c(n,m);
+  SetValues (a);
+  SetValues (b);
+  for (auto _ : state)
+    {
+      MultMatMat (a, b, c);
+      benchmark::DoNotOptimize (c.Data());
+    }
+  state.counters["flops"] = Flops (2.0*n*k*m);
+}
+BENCHMARK(BM_MultMatMat)
+->Args({10,10,10})->Args({35,35,35})->Args({56,12,56})->Args({120,120,120})->Args({200,40,200});
+
+/// C = A B^T, element matrix from B-matrices at the integration points
+static void BM_MultABt (benchmark::State & state)
+{
+  size_t n = state.range(0), k = state.range(1);
+  Matrix<> a(n,k), b(n,k), c(n,n);
+  SetValues (a);
+  SetValues (b);
+  for (auto _ : state)
+    {
+      MultABt (a, b, c);
+      benchmark::DoNotOptimize (c.Data());
+    }
+  state.counters["flops"] = Flops (2.0*n*n*k);
+}
+BENCHMARK(BM_MultABt)->Args({10,12})->Args({35,48})->Args({56,96})->Args({120,243});
+
+static void BM_MultAtB (benchmark::State & state)
+{
+  size_t n = state.range(0), k = state.range(1);
+  Matrix<> a(k,n), b(k,n), c(n,n);
+  SetValues (a);
+  SetValues (b);
+  for (auto _ : state)
+    {
+      MultAtB (a, b, c);
+      benchmark::DoNotOptimize (c.Data());
+    }
+  state.counters["flops"] = Flops (2.0*n*n*k);
+}
+BENCHMARK(BM_MultAtB)->Args({10,12})->Args({35,48})->Args({56,96})->Args({120,243});
+
+/// static condensation update  C -= A D B^T
+static void BM_SubADBt (benchmark::State & state)
+{
+  size_t n = state.range(0), k = state.range(1);
+  Matrix<> a(n,k), b(n,k), c(n,n);
+  Vector<> d(k);
+  SetValues (a);
+  SetValues (b);
+  d = 1;
+  for (auto _ : state)
+    {
+      SubADBt (a, d, b, c);
+      benchmark::DoNotOptimize (c.Data());
+    }
+  state.counters["flops"] = Flops (2.0*n*n*k);
+}
+BENCHMARK(BM_SubADBt)->Args({20,35})->Args({56,84})->Args({120,220});
+
+static void BM_CalcInverse (benchmark::State & state)
+{
+  size_t n = state.range(0);
+  Matrix<> a(n,n), inv(n,n);
+  SetValues (a);
+  for (size_t i = 0; i < n; i++)
+    a(i,i) += n;
+  for (auto _ : state)
+    {
+      inv = a;
+      CalcInverse (inv);
+      benchmark::DoNotOptimize (inv.Data());
+    }
+  state.counters["flops"] = Flops (2.0*n*n*n);
+}
+BENCHMARK(BM_CalcInverse)->Arg(10)->Arg(35)->Arg(84)->Arg(220);
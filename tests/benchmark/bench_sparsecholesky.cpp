@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+#include <la.hpp>
+using namespace ngla;
+
+template <typename TM>
+shared_ptr<SparseMatrixTM<TM>> BenchmarkLaplace2D (int n);
+
+// factorization (ordering, symbolic and numeric) and forward/backward solve
+
+static void BM_SparseCholeskyFactor (benchmark::State & state)
+{
+  auto mat = BenchmarkLaplace2D<double> (state.range(0));
+  mat->SetInverseType (SPARSECHOLESKY);
+  for (auto _ : state)
+    {
+      auto inv = mat->InverseMatrix();
+      benchmark::DoNotOptimize (inv.get());
+    }
+  state.counters["n"] = mat->Height();
+}
+BENCHMARK(BM_SparseCholeskyFactor)->Arg(50)->Arg(200)->Unit(benchmark::kMillisecond);
+
+static void BM_SparseCholeskySolve (benchmark::State & state)
+{
+  auto mat = BenchmarkLaplace2D<double> (state.range(0));
+  mat->SetInverseType (SPARSECHOLESKY);
+  auto inv = mat->InverseMatrix();
+  auto x = mat->CreateColVector();
+  auto y = mat->CreateColVector();
+  x = 1.0;
+  for (auto _ : state)
+    {
+      inv->Mult (x, y);
+      benchmark::ClobberMemory();
+    }
+  state.counters["n"] = mat->Height();
+}
+BENCHMARK(BM_SparseCholeskySolve)->Arg(50)->Arg(200)->Unit(benchmark::kMillisecond);
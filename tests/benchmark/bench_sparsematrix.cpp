@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+#include <la.hpp>
+using namespace ngla;
+
+/// 5-point stencil on an n x n grid, shifted to be positive definite
+template <typename TM>
+shared_ptr<SparseMatrixTM<TM>> BenchmarkLaplace2D (int n)
+{
+  Array<int> rows, cols;
+  Array<typename mat_traits<TM>::TSCAL> vals;
+  auto add = [&] (int i, int j, double v)
+    {
+      rows.Append (i);
+      cols.Append (j);
+      vals.Append (v);
+    };
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      {
+        int row = i*n+j;
+        add (row, row, 4.1);
+        if (i > 0) add (row, row-n, -1);
+        if (i < n-1) add (row, row+n, -1);
+        if (j > 0) add (row, row-1, -1);
+        if (j < n-1) add (row, row+1, -1);
+      }
+  return SparseMatrixTM<TM>::CreateFromCOO (rows, cols, vals, n*n, n*n);
+}
+
+// used by the sparse Cholesky benchmarks
+template shared_ptr<SparseMatrixTM<double>> BenchmarkLaplace2D<double> (int n);
+
+
+template <typename TM>
+static void BM_SparseMatrixMultAdd (benchmark::State & state)
+{
+  auto mat = BenchmarkLaplace2D<TM> (state.range(0));
+  auto x = mat->CreateColVector();
+  auto y = mat->CreateColVector();
+  x = 1.0;
+  y = 0.0;
+  for (auto _ : state)
+    {
+      mat->MultAdd (1, x, y);
+      benchmark::ClobberMemory();
+    }
+  state.counters["nze"] = mat->NZE();
+  // matrix entries and column indices, the vectors are not counted
+  state.counters["bytes"] = benchmark::Counter (mat->NZE() * (sizeof(TM)+sizeof(int)),
+                                                benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK_TEMPLATE(BM_SparseMatrixMultAdd, double)->Arg(100)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_SparseMatrixMultAdd, Complex)->Arg(100)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_SparseMatrixMultAdd, Mat<2,2>)->Arg(100)->Arg(700);
+BENCHMARK_TEMPLATE(BM_SparseMatrixMultAdd, Mat<3,3>)->Arg(100)->Arg(600);
+
+template <typename TM>
+static void BM_SparseMatrixMultTransAdd (benchmark::State & state)
+{
+  auto mat = BenchmarkLaplace2D<TM> (state.range(0));
+  auto x = mat->CreateColVector();
+  auto y = mat->CreateColVector();
+  x = 1.0;
+  y = 0.0;
+  for (auto _ : state)
+    {
+      mat->MultTransAdd (1, x, y);
+      benchmark::ClobberMemory();
+    }
+  state.counters["nze"] = mat->NZE();
+}
+BENCHMARK_TEMPLATE(BM_SparseMatrixMultTransAdd, double)->Arg(100)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_SparseMatrixMultTransAdd, Mat<3,3>)->Arg(100)->Arg(600);
+
+/// multi-vector product, k right hand sides
+static void BM_SparseMatrixMultiVector (benchmark::State & state)
+{
+  auto mat = BenchmarkLaplace2D<double> (state.range(0));
+  size_t k = state.range(1);
+  MultiVector x(mat->Height(), k), y(mat->Height(), k);
+  x = 1.0;
+  for (auto _ : state)
+    {
+      mat->MultAdd (1, x, y);
+      benchmark::ClobberMemory();
+    }
+  state.counters["nze"] = mat->NZE();
+}
+BENCHMARK(BM_SparseMatrixMultiVector)->Args({300,4})->Args({300,16});
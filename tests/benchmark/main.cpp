@@ -0,0 +1,11 @@
+#include <benchmark/benchmark.h>
+#include <comp.hpp>
+
+#ifdef PARALLEL
+const char * progname = "ngslib";
+const char* ptrs[2] = { progname, nullptr };
+const char** pptr = &ptrs[0];
+static ngstd::MyMPI mympi(1, (char**)pptr);
+#endif
+
+BENCHMARK_MAIN();
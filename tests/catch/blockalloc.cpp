@@ -0,0 +1,49 @@
+#include "catch.hpp"
+#include <ngstd.hpp>
+
+using namespace ngstd;
+
+TEST_CASE ("ConcurrentBlockAllocator", "[blockalloc]")
+{
+  // small batches, so that the caches exchange often with the global stack
+  ConcurrentBlockAllocator ball(3*sizeof(size_t), 8, 4);
+  constexpr size_t n = 100000;
+  Array<size_t*> ptrs(n);
+
+  SECTION ("parallel alloc and free")
+    {
+      RunWithTaskManager ([&] ()
+        {
+          ParallelFor (n, [&] (size_t i)
+                       {
+                         ptrs[i] = (size_t*) ball.Alloc();
+                         ptrs[i][0] = i;
+                         ptrs[i][2] = i;
+                       });
+        });
+      // the elements are distinct, no value is overwritten
+      bool ok = true;
+      for (size_t i = 0; i < n; i++)
+        ok = ok && ptrs[i][0] == i && ptrs[i][2] == i;
+      REQUIRE (ok);
+      REQUIRE (ball.NumElements() == n);
+
+      // freed by other threads and in another order than allocated
+      RunWithTaskManager ([&] ()
+        {
+          ParallelFor (n, [&] (size_t i) { ball.Free (ptrs[n-1-i]); });
+        });
+      auto stat = ball.GetStatistics();
+      REQUIRE (stat.live == 0);
+      REQUIRE (stat.allocs == n);
+      REQUIRE (stat.frees == n);
+
+      // free elements are reused, also the ones returned by other threads
+      for (size_t i = 0; i < n/2; i++)
+        ptrs[i] = (size_t*) ball.Alloc();
+      REQUIRE (ball.GetStatistics().bytes == stat.bytes);
+      for (size_t i = 0; i < n/2; i++)
+        ball.Free (ptrs[i]);
+      REQUIRE (ball.NumElements() == 0);
+    }
+}
@@ -220,6 +220,288 @@ TEST_CASE ("SubAtDB", "[ngblas]") {
     }
 }
 
+TEST_CASE ("ComplexAB", "[ngblas]") {
+    for (int n : { 1, 2, 5, 13 }) {
+        SECTION ("n = "+to_string(n)) {
+            for (int m : { 1, 3, 8, 17 }) {
+                SECTION ("m = "+to_string(m)) {
+                    for (int k : { 1, 4, 9, 140 }) {
+                        SECTION ("k = "+to_string(k)) {
+                            Matrix<Complex> a(n,k), b(k,m), bt(m,k), c(n,m), c2(n,m), c3(n,m);
+                            SetRandom(a);
+                            SetRandom(b);
+                            bt = Trans(b);
+                            SetRandom(c);
+                            c2 = c;
+                            c3 = c;
+
+                            for (int i = 0; i < n; i++)
+                                for (int j = 0; j < m; j++) {
+                                    Complex sum = 0.0;
+                                    for (int l = 0; l < k; l++)
+                                        sum += a(i,l) * b(l,j);
+                                    c2(i,j) += sum;
+                                    c3(i,j) -= sum;
+                                }
+
+                            AddAB (a, b, c);
+                            CHECK(L2Norm(c-c2) < 1e-10);
+                            SubAB (a, b, c);
+                            SubAB (a, b, c);
+                            CHECK(L2Norm(c-c3) < 1e-10);
+                            c = a * b;
+                            c2 -= c3;
+                            c2 *= 0.5;
+                            CHECK(L2Norm(c-c2) < 1e-10);
+                            c = a * Trans(bt);
+                            CHECK(L2Norm(c-c2) < 1e-10);
+                            c -= a * Trans(bt);
+                            CHECK(L2Norm(c) < 1e-10);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE ("BatchedCalcInverse", "[ngblas]") {
+    // mixed sizes, some above the SIMD batch limit
+    Array<int> sizes = { 1, 3, 3, 5, 3, 7, 7, 3, 16, 5, 40, 3, 7 };
+    Array<Matrix<>> a, inv;
+    Array<SliceMatrix<>> mats;
+    for (int n : sizes) {
+        Matrix<> m(n,n);
+        SetRandom(m);
+        for (int j = 0; j < n; j++)
+            m(j,j) += n;
+        a.Append (m);
+        inv.Append (m);
+    }
+    for (auto & m : inv)
+        mats.Append (m);
+    BatchedCalcInverse (mats);
+
+    for (auto i : Range(sizes)) {
+        Matrix<> id(sizes[i], sizes[i]);
+        id = Identity(sizes[i]);
+        double err = L2Norm (a[i]*inv[i]-id);
+        CHECK(err < 1e-10);
+    }
+}
+
+TEST_CASE ("BatchedCholesky", "[ngblas]") {
+    Array<int> sizes = { 2, 4, 4, 4, 9, 4, 9, 35, 2 };
+    Array<Matrix<>> a, fac, x;
+    Array<SliceMatrix<>> mats, rhs;
+    for (int n : sizes) {
+        Matrix<> b(n,n), m(n,n), f(n,3);
+        SetRandom(b);
+        m = b * Trans(b);
+        for (int j = 0; j < n; j++)
+            m(j,j) += 1;
+        SetRandom(f);
+        a.Append (m);
+        fac.Append (m);
+        x.Append (f);
+    }
+    for (auto i : Range(sizes)) {
+        mats.Append (fac[i]);
+        rhs.Append (x[i]);
+    }
+    BatchedCholeskyFactor (mats);
+    
+    for (auto i : Range(sizes)) {
+        int n = sizes[i];
+        Matrix<> l(n,n);
+        l = 0.0;
+        for (int j = 0; j < n; j++)
+            for (int k = 0; k <= j; k++)
+                l(j,k) = fac[i](j,k);
+        double err = L2Norm (l*Trans(l)-a[i]);
+        CHECK(err < 1e-10);
+    }
+
+    Array<Matrix<>> f;
+    for (auto & m : x)
+        f.Append (m);
+    BatchedCholeskySolve (mats, rhs);
+    for (auto i : Range(sizes)) {
+        double err = L2Norm (a[i]*x[i]-f[i]);
+        CHECK(err < 1e-8);
+    }
+}
+
+TEST_CASE ("TriangularSolve", "[ngblas]") {
+    for (int n : { 5, 40, 150 }) {
+        Matrix<> t(n,n), x(n,200), y(n,200), l(n,n), u(n,n);
+        SetRandom(t);
+        for (int i = 0; i < n; i++)
+            t(i,i) += n;
+        SetRandom(x);
+        l = 0.0; u = 0.0;
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                if (j <= i) l(i,j) = t(i,j); else u(i,j) = t(i,j);
+        for (int i = 0; i < n; i++)
+            u(i,i) = t(i,i);
+        
+        y = x;
+        TriangularSolve<LowerLeft> (t, y);
+        CHECK(L2Norm (l*y-x) < 1e-10);
+        y = x;
+        TriangularSolve<UpperRight> (t, y);
+        CHECK(L2Norm (u*y-x) < 1e-10);
+        
+        for (int i = 0; i < n; i++)
+            l(i,i) = 1;
+        y = x;
+        TriangularSolve<LowerLeft,Normalized> (t, y);
+        CHECK(L2Norm (l*y-x) < 1e-10);
+    }
+}
+
+TEST_CASE ("CholeskyFactor", "[ngblas]") {
+    for (int n : { 7, 100, 250 }) {
+        Matrix<> b(n,n), a(n,n), f(n,n), l(n,n);
+        SetRandom(b);
+        a = b * Trans(b);
+        for (int j = 0; j < n; j++)
+            a(j,j) += 1;
+        f = a;
+        CholeskyFactor (f);
+        l = 0.0;
+        for (int j = 0; j < n; j++)
+            for (int k = 0; k <= j; k++)
+                l(j,k) = f(j,k);
+        CHECK(L2Norm (l*Trans(l)-a) < 1e-8 * L2Norm(a));
+        for (int j = 0; j < n; j++)
+            for (int k = j+1; k < n; k++)
+                CHECK(f(j,k) == a(j,k));
+    }
+}
+
+TEST_CASE ("CalcLU", "[ngblas]") {
+    for (int n : { 10, 60, 300 }) {
+        Matrix<> a(n,n), inv(n,n), id(n,n);
+        SetRandom(a);
+        id = Identity(n);
+        inv = a;
+        Array<int> p(n);
+        CalcLU (inv, p);
+        InverseFromLU (inv, p);
+        CHECK(L2Norm (a*inv-id) < 1e-8);
+
+        inv = a;
+        CalcInverse (inv, INVERSE_LIB::INV_NGBLA);
+        CHECK(L2Norm (a*inv-id) < 1e-8);
+    }
+}
+
+TEST_CASE ("FloatKernels", "[ngblas]") {
+    for (int n : { 1, 7, 33, 100 }) {
+        int k = n+3, m = 2*n+1;
+        Matrix<> a(m,k), b(k,n), c(m,n);
+        Vector<> x(k), y(m);
+        SetRandom(a);
+        SetRandom(b);
+        SetRandom(x);
+        c = a*b;
+        y = a*x;
+
+        Matrix<float> fa(m,k), fb(k,n), fbt(n,k), fc(m,n);
+        Vector<float> fx(k), fy(m);
+        ConvertMatrix (a, fa);
+        ConvertMatrix (b, fb);
+        fbt = Trans(fb);
+        for (int i = 0; i < k; i++)
+            fx(i) = x(i);
+
+        Matrix<> hc(m,n);
+        fc = fa*fb;
+        ConvertMatrix (fc, hc);
+        CHECK(L2Norm(hc-c) < 1e-4*L2Norm(c));
+
+        fc = fa * Trans(fbt);
+        ConvertMatrix (fc, hc);
+        CHECK(L2Norm(hc-c) < 1e-4*L2Norm(c));
+
+        fc -= fa*fb;
+        ConvertMatrix (fc, hc);
+        CHECK(L2Norm(hc) < 1e-4*L2Norm(c));
+
+        fy = fa*fx;
+        double err = 0;
+        for (int i = 0; i < m; i++)
+            err += sqr(fy(i)-y(i));
+        CHECK(sqrt(err) < 1e-4*L2Norm(y));
+    }
+}
+
+TEST_CASE ("TensorContraction", "[ngblas]") {
+    LocalHeap lh(1000000, "lh");
+    size_t n0 = 3, n1 = 7, n2 = 20;
+    Tensor<3> a(n0, n1, n2);
+    for (size_t i = 0; i < n0; i++)
+        for (size_t j = 0; j < n1; j++)
+            for (size_t k = 0; k < n2; k++)
+                a(i,j,k) = sin(1+i+3*j+7*k);
+
+    SECTION ("Permute") {
+        Tensor<3> c(n2, n0, n1);
+        Array<int> perm = { 2, 0, 1 };
+        Permute (a, perm, c);
+        Tensor<3> b(n0, n1, n2);
+        for (size_t i = 0; i < a.GetTotalSize(); i++)
+            b.Data()[i] = a.Data()[i];
+        auto bp = PermuteInPlace (b, perm);
+        double err = 0;
+        for (size_t i = 0; i < n0; i++)
+            for (size_t j = 0; j < n1; j++)
+                for (size_t k = 0; k < n2; k++)
+                    err += fabs(double(c(k,i,j))-double(a(i,j,k))) + fabs(double(bp(k,i,j))-double(a(i,j,k)));
+        CHECK(err == 0);
+    }
+
+    SECTION ("ModeProduct") {
+        Matrix<> m(5, n1);
+        SetRandom(m);
+        Tensor<3> c(n0, 5, n2);
+        ModeProduct (a, m, 1, c);
+        double err = 0;
+        for (size_t i = 0; i < n0; i++)
+            for (size_t j = 0; j < 5; j++)
+                for (size_t k = 0; k < n2; k++) {
+                    double sum = 0;
+                    for (size_t l = 0; l < n1; l++)
+                        sum += m(j,l) * a(i,l,k);
+                    err += fabs(sum-c(i,j,k));
+                }
+        CHECK(err < 1e-12);
+    }
+
+    SECTION ("Contract") {
+        Matrix<> m(n1, 4);
+        SetRandom(m);
+        Tensor<2> b(n1, 4);
+        for (size_t i = 0; i < n1; i++)
+            for (size_t j = 0; j < 4; j++)
+                b(i,j) = m(i,j);
+        Tensor<3> c(n0, n2, 4);
+        Contract (a, 1, b, 0, c, lh);
+        double err = 0;
+        for (size_t i = 0; i < n0; i++)
+            for (size_t k = 0; k < n2; k++)
+                for (size_t q = 0; q < 4; q++) {
+                    double sum = 0;
+                    for (size_t l = 0; l < n1; l++)
+                        sum += a(i,l,k) * m(l,q);
+                    err += fabs(sum-c(i,k,q));
+                }
+        CHECK(err < 1e-12);
+    }
+}
+
 template <int N=SIMD<double>::Size()>
 void TestSIMD()
 {
@@ -0,0 +1,74 @@
+#include "catch.hpp"
+#include <ngstd.hpp>
+#include <thread>
+
+using namespace ngstd;
+
+static void RoundTrip (int port, bool compress, size_t chunksize)
+{
+  constexpr size_t n = 300000;
+  ServerSocket server(port);
+
+  // the client sends, the server receives
+  std::thread client([&] ()
+    {
+      ClientSocket sock(port);
+      BinarySocketOutArchive ar(sock, compress, chunksize);
+      double d = 3.5;
+      int i = -7;
+      string str = "hello worker";
+      char * cstr = nullptr;
+      bool b = true;
+      ar & d & i & str & cstr & b;
+      Array<double> vec(n);
+      for (size_t j = 0; j < n; j++)
+        vec[j] = j % 17;
+      size_t size = n;
+      ar & size;
+      ar.Do (vec.Data(), n);
+      ar & i;
+    });
+
+  ServerSocket conn;
+  server.accept (conn);
+  {
+    BinarySocketInArchive ar(conn);
+    double d;
+    int i;
+    string str;
+    char * cstr = (char*) "not null";
+    bool b = false;
+    ar & d & i & str & cstr & b;
+    CHECK (d == 3.5);
+    CHECK (i == -7);
+    CHECK (str == "hello worker");
+    CHECK (cstr == nullptr);
+    CHECK (b);
+    size_t size;
+    ar & size;
+    REQUIRE (size == n);
+    Array<double> vec(size);
+    ar.Do (vec.Data(), size);
+    bool ok = true;
+    for (size_t j = 0; j < n; j++)
+      ok = ok && vec[j] == j % 17;
+    CHECK (ok);
+    int last = 0;
+    ar & last;
+    CHECK (last == -7);
+  }
+  client.join();
+}
+
+TEST_CASE ("BinarySocketArchive", "[sockets]")
+{
+  SECTION ("buffered and chunked arrays")
+    {
+      RoundTrip (52417, false, 1<<16);
+    }
+  SECTION ("compressed frames")
+    {
+      // without zlib the archive falls back to uncompressed frames
+      RoundTrip (52418, true, 1<<16);
+    }
+}
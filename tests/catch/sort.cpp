@@ -0,0 +1,69 @@
+#include "catch.hpp"
+#include <ngstd.hpp>
+
+using namespace ngstd;
+
+// large enough for several blocks
+constexpr size_t n = 300000;
+
+TEST_CASE ("ParallelRadixSort", "[sort]")
+{
+  SECTION ("signed keys with values, stable")
+    {
+      Array<int> keys(n), vals(n);
+      for (size_t i = 0; i < n; i++)
+        {
+          keys[i] = int((i * 7919) % 1013) - 500;
+          vals[i] = i;
+        }
+      Array<int> orig(keys);
+      RunWithTaskManager ([&] () { ParallelRadixSort (keys, vals); });
+      bool ok = true;
+      for (size_t i = 0; i < n; i++)
+        {
+          ok = ok && keys[i] == orig[vals[i]];
+          if (i > 0)
+            ok = ok && (keys[i-1] < keys[i] || (keys[i-1] == keys[i] && vals[i-1] < vals[i]));
+        }
+      REQUIRE (ok);
+    }
+
+  SECTION ("64 bit keys")
+    {
+      Array<uint64_t> keys(n);
+      for (size_t i = 0; i < n; i++)
+        keys[i] = (uint64_t(i) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(i) << 40);
+      Array<uint64_t> expected(keys);
+      std::sort (expected.Data(), expected.Data()+n);
+      RunWithTaskManager ([&] () { ParallelRadixSort (keys); });
+      bool ok = true;
+      for (size_t i = 0; i < n; i++)
+        ok = ok && keys[i] == expected[i];
+      REQUIRE (ok);
+    }
+}
+
+TEST_CASE ("ParallelSort", "[sort]")
+{
+  Array<std::pair<double,int>> data(n);
+  for (size_t i = 0; i < n; i++)
+    data[i] = { double((i * 104729) % 997), int(i) };
+  auto less = [] (const std::pair<double,int> & a, const std::pair<double,int> & b)
+    { return a.first < b.first; };
+
+  RunWithTaskManager ([&] () { ParallelSort (data, less, true); });
+  bool ok = true;
+  for (size_t i = 1; i < n; i++)
+    ok = ok && (data[i-1].first < data[i].first ||
+                (data[i-1].first == data[i].first && data[i-1].second < data[i].second));
+  REQUIRE (ok);
+
+  Array<double> values(n), sorted(n);
+  for (size_t i = 0; i < n; i++)
+    values[i] = sin(double(i));
+  Array<int> index(n);
+  for (size_t i = 0; i < n; i++) index[i] = i;
+  RunWithTaskManager ([&] () { SampleSortI (values, index); });
+  for (size_t i = 0; i < n; i++) sorted[i] = values[index[i]];
+  REQUIRE (std::is_sorted (sorted.Data(), sorted.Data()+n));
+}
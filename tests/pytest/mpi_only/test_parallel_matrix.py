@@ -0,0 +1,67 @@
+from ngsolve import *
+
+def make_mesh(comm):
+    import netgen.meshing
+    if comm.rank==0:
+        from netgen.geom2d import unit_square
+        ngmesh = unit_square.GenerateMesh(maxh=0.1)
+        ngmesh.Distribute(comm)
+    else:
+        ngmesh = netgen.meshing.Mesh.Receive(comm)
+    return Mesh(ngmesh)
+
+# the product with a distributed input overlaps the cumulation with the interior rows
+def test_overlapped_multadd():
+    comm = MPI_Init()
+    mesh = make_mesh(comm)
+    for sym in [False, True]:
+        V = H1(mesh, order=2)
+        u,v = V.TnT()
+        a = BilinearForm(V, symmetric=sym)
+        a += (grad(u)*grad(v) + u*v) * dx
+        a.Assemble()
+        gfu = GridFunction(V)
+        gfu.Set (x*y)
+
+        w = a.mat.CreateColVector()
+        w.data = a.mat * gfu.vec
+        # distributed input
+        y1 = a.mat.CreateColVector()
+        y1.data = a.mat * w
+        # cumulated input, no overlap
+        wc = w.CreateVector()
+        wc.data = w
+        wc.Cumulate()
+        y2 = a.mat.CreateColVector()
+        y2.data = a.mat * wc
+        y1.data -= y2
+        assert Norm(y1) < 1e-12 * Norm(y2)
+    comm.Barrier()
+
+
+# the redundant coarse solver agrees with the gather to rank 0
+def test_redundant_inverse():
+    comm = MPI_Init()
+    mesh = make_mesh(comm)
+    for sym in [False, True]:
+        V = H1(mesh, order=2, dirichlet=".*")
+        u,v = V.TnT()
+        a = BilinearForm(V, symmetric=sym)
+        a += (grad(u)*grad(v) + u*v) * dx
+        a.Assemble()
+        f = LinearForm(V)
+        f += x * v * dx
+        f.Assemble()
+        gfm = GridFunction(V)
+        gfm.vec.data = a.mat.Inverse(V.FreeDofs(), inverse="masterinverse") * f.vec
+        for inverse in ["redundantinverse", "sparsecholesky"]:
+            gfu = GridFunction(V)
+            gfu.vec.data = a.mat.Inverse(V.FreeDofs(), inverse=inverse) * f.vec
+            gfu.vec.data -= gfm.vec
+            assert Norm(gfu.vec) < 1e-10 * Norm(gfm.vec)
+    comm.Barrier()
+
+
+if __name__ == "__main__":
+    test_overlapped_multadd()
+    test_redundant_inverse()
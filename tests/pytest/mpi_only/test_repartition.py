@@ -0,0 +1,45 @@
+from ngsolve import *
+from ngsolve.repartition import Repartition, LoadImbalance
+
+def make_mesh(comm):
+    import netgen.meshing
+    if comm.rank==0:
+        from netgen.geom2d import unit_square
+        ngmesh = unit_square.GenerateMesh(maxh=0.1)
+        ngmesh.Distribute(comm)
+    else:
+        ngmesh = netgen.meshing.Mesh.Receive(comm)
+    return Mesh(ngmesh)
+
+# coefficients are carried over exactly, a compound space is rebuilt from its components
+def test_repartition():
+    comm = MPI_Init()
+    mesh = make_mesh(comm)
+    ne = comm.mpi4py.allreduce(mesh.ne)
+    V = H1(mesh, order=2, dirichlet="left")
+    W = HCurl(mesh, order=1)
+    gfu = GridFunction(V)
+    gfu.Set(x*y)
+    gfw = GridFunction(FESpace([V, W]))
+    gfw.components[0].Set(x*x-y)
+    gfw.components[1].Set(CoefficientFunction((y, x)))
+
+    newmesh, (newu, neww) = Repartition(mesh, [gfu, gfw], tolerance=0)
+    assert newmesh != mesh
+    assert comm.mpi4py.allreduce(newmesh.ne) == ne
+    assert LoadImbalance(newmesh) >= 1
+    assert newu.space.ndofglobal == V.ndofglobal
+    assert sqrt(Integrate((newu-x*y)**2, newmesh)) < 1e-10
+    assert sqrt(Integrate((neww.components[0]-(x*x-y))**2, newmesh)) < 1e-10
+    dw = neww.components[1]-CoefficientFunction((y, x))
+    assert sqrt(Integrate(InnerProduct(dw, dw), newmesh)) < 1e-10
+    comm.Barrier()
+
+# a balanced mesh is returned unchanged
+def test_repartition_balanced():
+    comm = MPI_Init()
+    mesh = make_mesh(comm)
+    gfu = GridFunction(H1(mesh, order=1))
+    newmesh, newgfs = Repartition(mesh, [gfu], tolerance=1e10)
+    assert newmesh == mesh and newgfs[0] is gfu
+    comm.Barrier()
@@ -68,3 +68,32 @@ def test_derive_basematrix_lifetime():
 
 
 
+
+def test_fused_vector_expression():
+    import numpy as np
+    from netgen.geom2d import unit_square
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u, v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    a.Assemble()
+
+    f, x, w, r = [a.mat.CreateColVector() for i in range(4)]
+    f.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    w.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    r.data = a.mat * x
+    nAx = r.FV().NumPy().copy()
+    nf, nw = f.FV().NumPy().copy(), w.FV().NumPy().copy()
+
+    r.data = f - a.mat * x + 3*w
+    assert np.linalg.norm(r.FV().NumPy() - (nf - nAx + 3*nw)) < 1e-12 * np.linalg.norm(nf)
+
+    # the target is one of the terms
+    r.data = 2*r - w + f + f
+    assert np.linalg.norm(r.FV().NumPy() - (2*(nf - nAx + 3*nw) - nw + 2*nf)) < 1e-10 * np.linalg.norm(nf)
+
+    r.data = f
+    r += 0.5 * (w - a.mat * x)
+    assert np.linalg.norm(r.FV().NumPy() - (nf + 0.5*(nw - nAx))) < 1e-12 * np.linalg.norm(nf)
@@ -0,0 +1,31 @@
+from netgen.geom2d import unit_square
+from ngsolve import *
+import json
+
+
+def test_chrometrace(tmpdir):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+
+    filename = str(tmpdir.join("trace.json"))
+    with TaskManager():
+        with ChromeTrace(filename, counters=ChromeTrace.HaveCounters()):
+            with TraceRegion("assemble"):
+                a.Assemble()
+
+    with open(filename) as f:
+        events = json.load(f)["traceEvents"]
+    regions = [ev for ev in events if ev["ph"] == "X"]
+    assert any(ev["name"] == "assemble" and ev["cat"] == "timer" for ev in regions)
+    tasks = [ev for ev in regions if ev["cat"] == "task"]
+    assert len(tasks) > 0
+    assemble = next(ev for ev in regions if ev["name"] == "assemble")
+    # tasks of the main thread are nested into the user region
+    for ev in tasks:
+        if ev["tid"] == assemble["tid"]:
+            assert assemble["ts"] <= ev["ts"] and ev["ts"] + ev["dur"] <= assemble["ts"] + assemble["dur"] + 1e-3
+    if ChromeTrace.HaveCounters():
+        assert assemble["args"]["instructions"] > 0
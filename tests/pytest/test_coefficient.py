@@ -69,6 +69,111 @@ def test_evaluate(unit_mesh_2d):
     assert vals2 == approx(np.array(list(zip([0.5 + 0J] * 10, pnts*1J))))
     assert x(unit_mesh_2d(0.5,0.5)) == approx(0.5)
 
+def test_common_subexpressions(unit_mesh_2d):
+    a = sin(x*y) + exp(x)
+    b = sin(x*y) + exp(x)
+    cf = CoefficientFunction((a*b, a+b, cos(x*y)*a))
+    for realcompile in [False, True]:
+        cfc = cf.Compile(realcompile, wait=True)
+        err = Integrate(InnerProduct(cf-cfc, cf-cfc), unit_mesh_2d)
+        assert err == approx(0)
+    assert (CoefficientFunction(2)*CoefficientFunction(3))(unit_mesh_2d(0.2,0.3)) == approx(6)
+    assert (sqrt(CoefficientFunction(4))+1)(unit_mesh_2d(0.2,0.3)) == approx(3)
+
+def test_batched_evaluation(unit_mesh_3d):
+    # functions of x,y,z are evaluated for blocks of elements,
+    # multiplying with a GridFunction forces the element loop
+    from math import cos as mcos
+    exact = 1/8 + (1-mcos(1))/2
+    one = GridFunction(L2(unit_mesh_3d, order=0))
+    one.Set(1)
+    cf = x*y*z + sin(x)*y
+    for f in [cf, cf.Compile(), cf*one]:
+        assert Integrate(f, unit_mesh_3d, order=10) == approx(exact, rel=1e-10)
+
+def test_voxel_storage(unit_mesh_3d, tmpdir):
+    import numpy as np
+    vals = np.arange(4*5*6, dtype=np.uint8).reshape((4,5,6))
+    fname = str(tmpdir.join("voxels.raw"))
+    vals.tofile(fname)
+    ref = VoxelCoefficient((0,0,0), (1,1,1), 0.5*vals.astype(np.float64)+1)
+    cfs = [VoxelCoefficient((0,0,0), (1,1,1), vals, scale=0.5, offset=1),
+           VoxelCoefficient((0,0,0), (1,1,1), vals.astype(np.float32), scale=0.5, offset=1),
+           VoxelCoefficient((0,0,0), (1,1,1), fname, shape=vals.shape, dtype="uint8",
+                            scale=0.5, offset=1)]
+    # Integrate uses SIMD evaluation, point evaluation the scalar path
+    intref = Integrate(ref, unit_mesh_3d)
+    for cf in cfs:
+        assert Integrate(cf, unit_mesh_3d) == approx(intref)
+        for p in [(0.1,0.2,0.3), (0.5,0.9,0.7), (1,1,1)]:
+            assert cf(unit_mesh_3d(*p)) == approx(ref(unit_mesh_3d(*p)))
+    nearest = VoxelCoefficient((0,0,0), (1,1,1), fname, shape=vals.shape, dtype="uint8", linear=False)
+    assert nearest(unit_mesh_3d(0.05,0.05,0.05)) == approx(0)
+    assert Integrate(nearest, unit_mesh_3d) == \
+        approx(Integrate(VoxelCoefficient((0,0,0), (1,1,1), vals.astype(np.float64), linear=False), unit_mesh_3d))
+
+def test_bspline():
+    from ngsolve.meshes import Make1DMesh
+    mesh = Make1DMesh(8)
+    sp = BSpline(3, [0,0,0,0.25,0.5,1.5,2,2,2], [0.1,0.5,1,0.4,0.2,0.8,0.6,0,0])
+    # knots are mesh nodes, Integrate (SIMD evaluation) is exact
+    n = 20000
+    ref = sum(sp((i+0.5)/n) for i in range(n)) / n
+    assert Integrate(sp(x), mesh, order=10) == approx(ref, rel=1e-8)
+    for p in [0.1, 0.25, 0.6, 0.99]:
+        assert sp(x)(mesh(p)) == approx(sp(p))
+    dsp = sp.Differentiate()
+    assert dsp(0.3) == approx((sp(0.3+1e-6)-sp(0.3-1e-6))/2e-6, rel=1e-6)
+    assert Integrate(sp(x).Diff(x), mesh, order=10) == approx(sp(1)-sp(0), rel=1e-10)
+    assert sp(-0.1) == 0 and sp(2) == 0
+
+def test_bessel_functions(unit_mesh_2d):
+    assert besselj0(1) == approx(0.7651976865579666, rel=1e-14)
+    assert besselj1(1) == approx(0.44005058574493355, rel=1e-14)
+    assert bessely0(1) == approx(0.08825696421567697, rel=1e-13)
+    assert bessely1(1) == approx(-0.7812128213002887, rel=1e-14)
+    assert besselj0(10) == approx(-0.2459357644513483, rel=1e-13)
+    assert bessely1(10) == approx(0.24901542420695388, rel=1e-13)
+    assert besselj1(-10) == approx(-besselj1(10), rel=1e-15)
+    # both intervals of the approximation, SIMD evaluation in Integrate
+    r = 1+20*x
+    for f, df, func in [ (besselj0(r), -20*besselj1(r), besselj0),
+                         (bessely0(r), -20*bessely1(r), bessely0),
+                         (besselj1(r), 20*(besselj0(r)-besselj1(r)/r), besselj1) ]:
+        for px in [0.1, 0.7]:
+            assert f(unit_mesh_2d(px,0.5)) == approx(func(1+20*px), rel=1e-14)
+        err = Integrate((f.Diff(x)-df)**2, unit_mesh_2d, order=10)
+        assert err == approx(0, abs=1e-20)
+
+def test_gridfunction_gather_cache(unit_mesh_2d):
+    fes = H1(unit_mesh_2d, order=3)
+    u,v = fes.TnT()
+    gf1 = GridFunction(fes)
+    gf2 = GridFunction(fes)
+    gf1.Set(x*y)
+    gf2.Set(sin(x)+y)
+    # several coefficient functions of two GridFunctions in one integrator
+    f = LinearForm(fes)
+    f += (gf1*v + grad(gf1)*grad(v) + 3*gf2*v + gf1*gf2*v) * dx
+    f.Assemble()
+    a = BilinearForm(fes)
+    a += (u*v + grad(u)*grad(v)) * dx
+    a.Assemble()
+    m = BilinearForm(fes)
+    m += (3+gf1)*u*v * dx
+    m.Assemble()
+    ref = f.vec.CreateVector()
+    ref.data = a.mat * gf1.vec + m.mat * gf2.vec
+    ref.data -= f.vec
+    assert Norm(ref) < 1e-12 * Norm(f.vec)
+    # the gathered values must not survive a change of the vector
+    gf1.vec[:] = 0
+    f.Assemble()
+    m.Assemble()
+    ref.data = m.mat * gf2.vec
+    ref.data -= f.vec
+    assert Norm(ref) < 1e-12 * Norm(f.vec)
+
 if __name__ == "__main__":
     test_pow()
     test_ParameterCF()
@@ -76,3 +181,6 @@ if __name__ == "__main__":
     test_real()
     test_domainwise_cf()
     test_evaluate()
+    test_common_subexpressions()
+    test_batched_evaluation()
+    test_bspline()
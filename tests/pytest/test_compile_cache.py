@@ -0,0 +1,29 @@
+import os
+from ngsolve import *
+from ngsolve.fem import SetCompileCacheDirectory, GetCompileCacheDirectory
+from netgen.geom2d import unit_square
+
+def test_compile_cache(tmpdir):
+    if os.name == "nt":
+        return
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    mp = mesh(0.3, 0.4)
+    olddir = GetCompileCacheDirectory()
+    cachedir = str(tmpdir.join("cache"))
+    SetCompileCacheDirectory(cachedir)
+    try:
+        cf = sin(x)*y + CoefficientFunction((x, y)).Norm()
+        c1 = cf.Compile(realcompile=True, wait=True)
+        files = sorted(os.listdir(cachedir))
+        assert len([f for f in files if f.endswith(".so")]) == 1
+        # identical code is taken from the cache
+        c2 = cf.Compile(realcompile=True, wait=True)
+        assert sorted(os.listdir(cachedir)) == files
+        assert abs(c1(mp)-cf(mp)) < 1e-14
+        assert abs(c2(mp)-cf(mp)) < 1e-14
+    finally:
+        SetCompileCacheDirectory(olddir)
+
+if __name__ == "__main__":
+    import py
+    test_compile_cache(py.path.local.mkdtemp())
@@ -99,9 +99,410 @@ def test_SurfaceGetFE(quads=False):
                         assert space.GetFE(el).ndof == len(space.GetDofNrs(el)), [spacename,vb,order]
     return
 
+def test_reorder():
+    from ngsolve.comp import Reorder
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes0 = H1(mesh, order=3, dirichlet=".*")
+    u,v = fes0.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx).Assemble()
+    f = LinearForm(v*dx).Assemble()
+    gfu0 = GridFunction(fes0)
+    gfu0.vec.data = a.mat.Inverse(fes0.FreeDofs()) * f.vec
+
+    for method in ["nodes", "rcm", "hilbert"]:
+        fes = Reorder(H1(mesh, order=3, dirichlet=".*"), reorder=method)
+        assert sorted(fes.dofmap) == list(range(fes.ndof))
+        assert sum(fes.FreeDofs()) == sum(fes0.FreeDofs())
+        u,v = fes.TnT()
+        a = BilinearForm(grad(u)*grad(v)*dx).Assemble()
+        f = LinearForm(v*dx).Assemble()
+        gfu = GridFunction(fes)
+        gfu.vec.data = a.mat.Inverse(fes.FreeDofs()) * f.vec
+        assert Integrate((gfu-gfu0)**2, mesh) < 1e-20
+
+    fes = FESpace("h1ho", mesh, order=2, reorder="rcm")
+    assert type(fes) is Reorder
+
+def test_precomputed_shapes():
+    # Apply uses shared precomputed shapes, assembly computes shapes per element
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.4))
+    for order in [1,4]:
+        fes = H1(mesh, order=order)
+        u,v = fes.TnT()
+        gfu = GridFunction(fes)
+        gfu.Set(x*y*z+x*x)
+        a = BilinearForm(grad(u)*grad(v)*dx+u*v*dx).Assemble()
+        res0 = gfu.vec.CreateVector()
+        res0.data = a.mat * gfu.vec
+        res1 = gfu.vec.CreateVector()
+        for i in range(2):
+            a.Apply(gfu.vec, res1)
+            res1 -= res0
+            assert Norm(res1) < 1e-10 * Norm(res0)
+
+def test_tet_highorder_shapes():
+    # cell shapes of order >= 5 use the fused Jacobi evaluation
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.6))
+    p = x**3*y*z**2 + y**5 - x*y*z
+    for order in [6,8]:
+        fes = H1(mesh, order=order)
+        gfu = GridFunction(fes)
+        gfu.Set(p)
+        assert Integrate((gfu-p)**2, mesh, order=2*order+2) < 1e-20
+        fes = HCurl(mesh, order=order)
+        gfu = GridFunction(fes)
+        gfu.Set(CF((p, x*y*z, y*z)))
+        assert Integrate(InnerProduct(gfu-CF((p, x*y*z, y*z)), gfu-CF((p, x*y*z, y*z))), mesh, order=2*order+2) < 1e-20
+
+def test_reference_element_matrices():
+    from ngsolve.fem import SetReferenceElementMatrices
+    for mesh in [Mesh(unit_square.GenerateMesh(maxh=0.3)), Mesh(unit_cube.GenerateMesh(maxh=0.5))]:
+        fes = H1(mesh, order=4)
+        u,v = fes.TnT()
+        dim = mesh.dim
+        mat = CF(tuple(1+i+(i==j) for i in range(dim) for j in range(dim)), dims=(dim,dim))
+        beta = CF(tuple(range(1,dim+1)))
+        forms = [grad(u)*grad(v)*dx + 3*u*v*dx,
+                 (mat*grad(u))*grad(v)*dx + (beta*grad(u))*v*dx + u*(beta*grad(v))*dx,
+                 x*u*v*dx]
+        for form in forms:
+            mats = []
+            for enable in [False, True]:
+                SetReferenceElementMatrices(enable)
+                mats.append(BilinearForm(form).Assemble().mat)
+            x0 = mats[0].CreateColVector()
+            x0.SetRandom()
+            y0 = x0.CreateVector()
+            y0.data = mats[0] * x0
+            y1 = x0.CreateVector()
+            y1.data = mats[1] * x0 - y0
+            assert Norm(y1) < 1e-10 * Norm(y0)
+    SetReferenceElementMatrices(True)
+
+def test_dg_operator():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = L2(mesh, order=3, dgjumps=True)
+    u,v = fes.TnT()
+    b = CF((1,0.5))
+    n = specialcf.normal(2)
+    uup = IfPos(b*n, u, u.Other())
+    a = BilinearForm(fes, nonassemble=True)
+    a += 2*u*v*dx - b*grad(v)*u*dx
+    a += b*n*uup*(v-v.Other())*dx(skeleton=True)
+    a += IfPos(b*n, b*n*u*v, 0)*ds(skeleton=True)
+    gfu = GridFunction(fes)
+    gfu.Set(x*y*y+x)
+    res0 = gfu.vec.CreateVector()
+    a.Apply(gfu.vec, res0)
+    op = a.DGOperator()
+    res1 = gfu.vec.CreateVector()
+    res1.data = op * gfu.vec
+    res1 -= res0
+    assert Norm(res1) < 1e-10 * Norm(res0)
+    res1.data = -2 * op * gfu.vec
+    res1 += 2 * res0
+    assert Norm(res1) < 1e-10 * Norm(res0)
+
+def test_cached_inverse_mass():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    rho = CF(2)
+    for fes in [L2(mesh, order=3), VectorL2(mesh, order=2), Discontinuous(H1(mesh, order=3))]:
+        u,v = fes.TnT()
+        mass = BilinearForm(rho*InnerProduct(u,v)*dx).Assemble().mat
+        x0 = mass.CreateColVector()
+        x0.SetRandom()
+        y = x0.CreateVector()
+        y.data = mass * x0
+        for single, tol in [(False, 1e-10), (True, 1e-4)]:
+            invm = fes.InvM(rho, cached=True, single_precision=single)
+            x1 = x0.CreateVector()
+            x1.data = invm * y - x0
+            assert Norm(x1) < tol * Norm(x0)
+
+def test_cache_dofnrs():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    results = []
+    for cache in [False, True]:
+        fes = H1(mesh, order=3, dirichlet=".*", cache_dofnrs=cache)
+        u,v = fes.TnT()
+        a = BilinearForm(grad(u)*grad(v)*dx+u*v*ds).Assemble()
+        f = LinearForm(x*v*dx).Assemble()
+        gfu = GridFunction(fes)
+        gfu.vec.data = a.mat.Inverse(fes.FreeDofs()) * f.vec
+        results.append(gfu)
+    assert Integrate((results[0]-results[1])**2, mesh) < 1e-20
+    mesh.Refine()
+    fes.Update()
+    gfu = GridFunction(fes)
+    gfu.Set(x*y)
+    assert Integrate((gfu-x*y)**2, mesh) < 1e-20
+
+def test_shared_coloring():
+    # later spaces reuse and check the coloring of the first one
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.3))
+    for fes in [H1(mesh, order=1), H1(mesh, order=3), VectorH1(mesh, order=2), HCurl(mesh, order=2)]:
+        u,v = fes.TnT()
+        a = BilinearForm(InnerProduct(u,v)*dx).Assemble()
+        gfu = GridFunction(fes)
+        gfu.vec.SetRandom()
+        res = gfu.vec.CreateVector()
+        res.data = a.mat * gfu.vec
+        assert abs(InnerProduct(res, gfu.vec) - Integrate(InnerProduct(gfu,gfu), mesh, order=6)) < 1e-10 * InnerProduct(res, gfu.vec)
+
+def test_set_reference_mass():
+    # affine simplices project with the inverse reference mass matrix
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.4))
+    p = x*x*y + z*z*z - x*y*z
+    for fes in [H1(mesh, order=3), L2(mesh, order=3), H1(mesh, order=3, dim=2)]:
+        gfu = GridFunction(fes)
+        f = p if fes.dim == 1 else CF((p, x*y))
+        gfu.Set(f)
+        assert Integrate(InnerProduct(gfu-f, gfu-f), mesh, order=8) < 1e-20
+    fes = H1(mesh, order=3, dirichlet=".*")
+    gfu = GridFunction(fes)
+    gfu.Set(p, BND)
+    assert Integrate((gfu-p)**2, mesh, BND, order=8) < 1e-20
+
 if __name__ == "__main__":
     test_2DGetFE(quads=False)
     test_2DGetFE(quads=True)
     test_3DGetFE()
     test_SurfaceGetFE(quads=False)
     test_SurfaceGetFE(quads=True)
+    test_reorder()
+    test_precomputed_shapes()
+    test_tet_highorder_shapes()
+    test_reference_element_matrices()
+    test_dg_operator()
+    test_cached_inverse_mass()
+    test_cache_dofnrs()
+    test_shared_coloring()
+    test_set_reference_mass()
+
+def test_lazy_plugin():
+    from ngsolve.ngstd import AddLazyPlugin, LazyPlugins
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    AddLazyPlugin("libngs_missing_plugin", ["lazyspace_test"])
+    assert "lazyspace_test" in LazyPlugins()
+    assert "(loaded)" not in LazyPlugins()
+    # the first lookup loads the library
+    with pytest.raises(Exception, match="libngs_missing_plugin"):
+        FESpace("lazyspace_test", mesh)
+    assert "(loaded)" in LazyPlugins()
+    # other spaces do not touch the plugin
+    fes = FESpace("h1ho", mesh, order=2)
+    assert fes.ndof > 0
+
+def test_convert_operator_reuse_and_cache():
+    from ngsolve.meshes import MakeStructured2DMesh
+    # congruent elements share the local conversion matrices
+    mesh = MakeStructured2DMesh(nx=5, ny=5)
+    cf = x + 2*y
+    cfvec = CF((x-y, 3*x+y))
+    for spacea, spaceb, func in [ (H1(mesh, order=3), H1(mesh, order=1), cf),
+                                  (H1(mesh, order=1), H1(mesh, order=3), cf),
+                                  (HDiv(mesh, order=2), VectorL2(mesh, order=1), cfvec) ]:
+        gfa = GridFunction(spacea)
+        gfa.Set(func)
+        gfb = GridFunction(spaceb)
+        op = ConvertOperator(spacea, spaceb)
+        gfb.vec.data = op * gfa.vec
+        assert Integrate(InnerProduct(gfb-func, gfb-func), mesh) < 1e-20
+
+    fesa = H1(mesh, order=2)
+    fesb = H1(mesh, order=1)
+    op1 = ConvertOperator(fesa, fesb, cache=True)
+    op2 = ConvertOperator(fesa, fesb, cache=True)
+    assert op1 is op2
+    assert ConvertOperator(fesb, fesa, cache=True) is not op1
+    # updated spaces invalidate the cached operator
+    mesh.ngmesh.Refine()
+    mesh = Mesh(mesh.ngmesh)
+    fesa = H1(mesh, order=2)
+    fesb = H1(mesh, order=1)
+    op3 = ConvertOperator(fesa, fesb, cache=True)
+    assert op3.height == fesb.ndof and op3.width == fesa.ndof
+
+def test_mesh_transfer_operator():
+    mesha = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    meshb = Mesh(unit_square.GenerateMesh(maxh=0.17))
+    for fesa, fesb, func in [ (H1(mesha, order=2), H1(meshb, order=2), x*x+y),
+                              (L2(mesha, order=1), L2(meshb, order=1), 2*x-y),
+                              (HDiv(mesha, order=1), HDiv(meshb, order=1), CF((y, x))) ]:
+        gfa = GridFunction(fesa)
+        gfa.Set(func)
+        op = MeshTransferOperator(fesa, fesb)
+        assert op.height == fesb.ndof and op.width == fesa.ndof
+        gfb = GridFunction(fesb)
+        gfb.vec.data = op * gfa.vec
+        # polynomials of the target space are transferred exactly
+        assert Integrate(InnerProduct(gfb-func, gfb-func), meshb) < 1e-16
+        ref = GridFunction(fesb)
+        ref.Set(gfa)
+        assert Integrate(InnerProduct(gfb-ref, gfb-ref), meshb) < 1e-12
+
+
+def test_setup_cache(tmpdir):
+    import os
+    from ngsolve.la import SetupCacheDirectory
+    cache = str(tmpdir)
+
+    def solve(mesh):
+        fes = H1(mesh, order=3, dirichlet=".*", setupcache=cache)
+        u,v = fes.TnT()
+        a = BilinearForm(grad(u)*grad(v)*dx, setupcache=cache).Assemble()
+        f = LinearForm(v*dx).Assemble()
+        gfu = GridFunction(fes)
+        gfu.vec.data = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky") * f.vec
+        return a.mat, gfu
+
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    SetupCacheDirectory(cache)       # the symbolic factorization of the inverse
+    try:
+        mat1, gfu1 = solve(mesh)
+        files = sorted(os.listdir(cache))
+        for prefix in ["fespace-", "graph-", "symbolic-"]:
+            assert any(name.startswith(prefix) for name in files)
+
+        # warm start: the same structures from the files
+        mat2, gfu2 = solve(mesh)
+        assert sorted(os.listdir(cache)) == files
+        r1, c1, v1 = mat1.COO()
+        r2, c2, v2 = mat2.COO()
+        assert list(r1) == list(r2) and list(c1) == list(c2)
+        assert Norm(v1-v2) < 1e-14
+        diff = gfu1.vec.CreateVector()
+        diff.data = gfu1.vec - gfu2.vec
+        assert Norm(diff) < 1e-12 * Norm(gfu1.vec)
+
+        # another mesh does not use the files
+        solve(Mesh(unit_square.GenerateMesh(maxh=0.25)))
+        assert len(os.listdir(cache)) == 2*len(files)
+    finally:
+        SetupCacheDirectory("")
+
+
+def test_automatic_heapsize():
+    # the element matrices of order 10 in 3D need more than the default heap
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=1))
+    fes = H1(mesh, order=10)
+    u, v = fes.TnT()
+    with TaskManager():
+        a = BilinearForm(grad(u)*grad(v)*dx).Assemble()
+        f = LinearForm(v*dx).Assemble()
+    # constants are in the kernel, they are represented by the vertex dofs
+    x = a.mat.CreateColVector()
+    x[:] = 0
+    for i in range(mesh.nv):
+        x[i] = 1
+    y = (a.mat * x).Evaluate()
+    assert Norm(y) < 1e-8 * a.mat.AsVector().Norm()
+    assert abs(Integrate(1, mesh) - 1) < 1e-12
+    assert f.vec.Norm() > 0
+
+def test_hdivdiv_curved_div():
+    import math
+    from netgen.geom2d import SplineGeometry
+    geo = SplineGeometry()
+    geo.AddCircle((0,0), 1)
+    mesh = Mesh(geo.GenerateMesh(maxh=0.4))
+    mesh.Curve(3)
+    S = HDivDiv(mesh, order=2)
+    V = VectorL2(mesh, order=1)
+    sigma, tau = S.TnT()
+    u, v = V.TnT()
+    b = BilinearForm(trial_space=S, test_space=V)
+    dxi = dx(intrules={TRIG : IntegrationRule(TRIG, 6)})
+    b += div(sigma)*v * dxi
+    b.Assemble()
+    gfs = GridFunction(S)
+    for i in range(len(gfs.vec)):
+        gfs.vec[i] = math.sin(i)
+    gfv = GridFunction(V)
+    for i in range(len(gfv.vec)):
+        gfv.vec[i] = math.cos(i)
+    # SIMD evaluation of div on curved elements against the matrix
+    f = LinearForm(V)
+    f += div(gfs)*v * dxi
+    f.Assemble()
+    r = f.vec.CreateVector()
+    r.data = b.mat * gfs.vec - f.vec
+    assert Norm(r) < 1e-10 * Norm(f.vec)
+    g = LinearForm(S)
+    g += div(tau)*gfv * dxi
+    g.Assemble()
+    r2 = g.vec.CreateVector()
+    r2.data = b.mat.T * gfv.vec - g.vec
+    assert Norm(r2) < 1e-10 * Norm(g.vec)
+
+def test_compressed_restriction():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    fes = H1(mesh, order=3, dirichlet=".*")
+    cfes = Compress(fes, active_dofs=fes.FreeDofs())
+    assert cfes.ndof == fes.FreeDofs().NumSet()
+    gf = GridFunction(fes)
+    gf.Set(x*(1-x)*y*(1-y))
+    R = cfes.GetRestriction()
+    gfc = GridFunction(cfes)
+    gfc.vec.data = R * gf.vec
+    assert gfc(mesh(0.3,0.4)) == pytest.approx(gf(mesh(0.3,0.4)))
+    # element dofs from the cached table
+    for el in mesh.Elements():
+        free = fes.FreeDofs()
+        assert len([d for d in cfes.GetDofNrs(el) if d >= 0]) == \
+            len([d for d in fes.GetDofNrs(el) if free[d]])
+    ext = gf.vec.CreateVector()
+    ext.data = R.T * gfc.vec
+    ext.data -= gf.vec
+    assert Norm(ext) < 1e-14
+
+def test_prism_sum_factorization():
+    # Apply evaluates H1 prisms by sum factorization, assembly by the shape functions
+    import numpy as np
+    from ngsolve.meshes import MeshFromArrays
+    n, nz = 3, 2
+    points = np.array([[i/n, j/n, k/nz] for k in range(nz+1) for j in range(n+1) for i in range(n+1)])
+    points[:,2] += 0.05 * points[:,0] * points[:,1]    # non-affine prisms
+    trigs = []
+    for j in range(n):
+        for i in range(n):
+            v = i + j*(n+1)
+            trigs += [[v, v+1, v+n+2], [v, v+n+2, v+n+1]]
+    layer = (n+1)*(n+1)
+    prisms = np.array([[vi+k*layer for vi in t] + [vi+(k+1)*layer for vi in t]
+                       for k in range(nz) for t in trigs])
+    mesh = MeshFromArrays(points, prisms)
+
+    for order in [1,2,4]:
+        fes = H1(mesh, order=order)
+        u,v = fes.TnT()
+        gfu = GridFunction(fes)
+        gfu.vec.FV().NumPy()[:] = np.random.rand(fes.ndof)
+        a = BilinearForm(grad(u)*grad(v)*dx+u*v*dx).Assemble()
+        res0 = gfu.vec.CreateVector()
+        res0.data = a.mat * gfu.vec
+        res1 = gfu.vec.CreateVector()
+        a.Apply(gfu.vec, res1)
+        res1 -= res0
+        assert Norm(res1) < 1e-10 * Norm(res0)
+
+
+def test_region_interpolator():
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.3))
+    fes = H1(mesh, order=3, dim=2)
+    region = mesh.Boundaries("left|bottom")
+    cf = CF((sin(x+2*y)*z, x*y))
+    gfref = GridFunction(fes)
+    gfref.Set(cf, BND, definedon=region)
+
+    ip = RegionInterpolator(fes, region)
+    gfu = GridFunction(fes)
+    gfu.vec[:] = 7
+    ip.Set(cf, gfu)
+    assert len(ip.dofs) > 0
+    for d in ip.dofs:
+        for j in range(2):
+            assert gfu.vec[2*d+j] == pytest.approx(gfref.vec[2*d+j], abs=1e-12)
+    # the other dofs are kept
+    regiondofs = set(ip.dofs)
+    assert all(gfu.vec[2*d] == 7 for d in range(fes.ndof) if d not in regiondofs)
@@ -25,3 +25,119 @@ def test_integrate_xy():
     intC = Integrate(1j*x*y,mesh)
     assert abs(intR-1./4) < 1e-14
     assert abs(intC- 1j*1./4) < 1e-14
+
+def test_integrate_symmetric_rules():
+    from ngsolve.fem import SetSymmetricSimplexRules
+    from netgen.csg import unit_cube
+    mesh2 = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    mesh3 = Mesh(unit_cube.GenerateMesh(maxh=0.5))
+    for mesh,p in [(mesh2,12), (mesh3,8)]:
+        for sym in [True, False]:
+            SetSymmetricSimplexRules(sym)
+            for k in range(p+1):
+                cf = x**k * y**(p-k)
+                exact = 1/((k+1)*(p-k+1))
+                assert abs(Integrate(cf, mesh, order=p) - exact) < 1e-12
+    SetSymmetricSimplexRules(True)
+
+def test_integrate_list():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    cfs = [x, x*y, CF((1, y)), 1j*x]
+    res = Integrate(cfs, mesh, order=4)
+    assert abs(res[0] - 1/2) < 1e-12
+    assert abs(res[1] - 1/4) < 1e-12
+    assert abs(res[2][0] - 1) < 1e-12 and abs(res[2][1] - 1/2) < 1e-12
+    assert abs(res[3] - 0.5j) < 1e-12
+    bnd = Integrate([1, x], mesh, BND, region_wise=True)
+    assert abs(sum(bnd[0]) - 4) < 1e-12
+    assert abs(sum(bnd[1]) - 2) < 1e-12
+
+def test_integrate_deterministic():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.05))
+    cf = sin(10*x)*exp(y)
+    vals = []
+    for nthreads in [1, 3, 4]:
+        SetNumThreads(nthreads)
+        with TaskManager():
+            vals.append(Integrate(cf, mesh, deterministic=True))
+    assert vals[0] == vals[1] == vals[2]
+    assert abs(vals[0] - Integrate(cf, mesh)) < 1e-12
+
+def test_linearform_element_boundary_and_facets():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=1)
+    u,v = V.TnT()
+    g = GridFunction(V)
+    g.Set(x)
+    with TaskManager():
+        f = LinearForm(V)
+        f += x * v * dx(element_boundary=True)
+        f.Assemble()
+        a = BilinearForm(V)
+        a += u * v * dx(element_boundary=True)
+        a.Assemble()
+        w = f.vec.CreateVector()
+        w.data = a.mat * g.vec - f.vec
+        assert Norm(w) < 1e-12 * Norm(f.vec)
+
+        fs = LinearForm(V)
+        fs += x * v * ds(skeleton=True)
+        fs.Assemble()
+        fb = LinearForm(V)
+        fb += x * v * ds
+        fb.Assemble()
+        fs.vec.data -= fb.vec
+        assert Norm(fs.vec) < 1e-12 * Norm(fb.vec)
+
+
+def test_element_boundary_cached_rules():
+    from netgen.csg import unit_cube
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.4))
+    V = H1(mesh, order=2)
+    u,v = V.TnT()
+    for vb, et in [(BND, TRIG), (BBND, SEGM)]:
+        with TaskManager():
+            a = BilinearForm(u*v*dx(element_vb=vb)).Assemble()
+            # user-defined rules are mapped per element, not cached
+            auser = BilinearForm(u*v*dx(element_vb=vb, intrules={et : IntegrationRule(et, 4)})).Assemble()
+        w = a.mat.CreateColVector()
+        g = GridFunction(V)
+        g.Set(x*y+z)
+        w.data = a.mat * g.vec - auser.mat * g.vec
+        assert Norm(w) < 1e-12 * Norm(g.vec)
+
+
+def test_hesse_simd():
+    from ngsolve.fem import GetNoSIMDFallbacks, ResetNoSIMDFallbacks
+    from netgen.csg import unit_cube
+    for mesh in [Mesh(unit_square.GenerateMesh(maxh=0.3)), Mesh(unit_cube.GenerateMesh(maxh=0.5))]:
+        ResetNoSIMDFallbacks()
+        fes = H1(mesh, order=3)
+        u, v = fes.TnT()
+        gf = GridFunction(fes)
+        gf.Set(x*x*y)
+        # hesse = ((2y,2x),(2x,0)), integral of |hesse|^2 = 4
+        assert abs(Integrate(InnerProduct(gf.Operator("hesse"), gf.Operator("hesse")), mesh) - 4) < 1e-6
+        a = BilinearForm(InnerProduct(u.Operator("hesse"), v.Operator("hesse"))*dx).Assemble()
+        assert abs(InnerProduct(a.mat * gf.vec, gf.vec) - 4) < 1e-6
+        f = LinearForm(InnerProduct(gf.Operator("hesse"), v.Operator("hesse"))*dx).Assemble()
+        assert abs(InnerProduct(f.vec, gf.vec) - 4) < 1e-6
+        assert not any("DiffOpHesse" in msg for msg in GetNoSIMDFallbacks())
+
+def test_facet_assembly_colored():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = L2(mesh, order=2, dgjumps=True)
+    u,v = fes.TnT()
+    n = specialcf.normal(2)
+    def Form():
+        a = BilinearForm(fes)
+        a += grad(u)*grad(v)*dx
+        a += -n*grad(u)*v*dx(skeleton=True) + 10*(u-u.Other())*v*dx(skeleton=True)
+        a += 10*u*v*ds(skeleton=True) + x*u*v*ds(skeleton=True, definedon=mesh.Boundaries("left|top"))
+        return a.Assemble()
+    aseq = Form()
+    with TaskManager():
+        apar = Form()
+    diff = aseq.mat.AsVector().CreateVector()
+    diff.data = aseq.mat.AsVector() - apar.mat.AsVector()
+    assert Norm(diff) < 1e-12 * Norm(aseq.mat.AsVector())
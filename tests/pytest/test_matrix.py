@@ -99,7 +99,967 @@ def test_sparsematrix_access():
     a.Assemble()
     assert abs(a.mat[1,1][0,0] - (reference_values[3])) < 1e-8
 
+def test_sumfactorization_apply():
+    from ngsolve.meshes import MakeStructured3DMesh
+    mesh = MakeStructured3DMesh(hexes=True, nx=2, ny=2, nz=2)
+    fes = L2(mesh, order=4, tp=True)
+    u,v = fes.TnT()
+    form = grad(u)*grad(v)*dx + u*v*dx
+    a = BilinearForm(fes, nonassemble=True)
+    a += form
+    a.Assemble()
+    b = BilinearForm(fes)
+    b += form
+    b.Assemble()
+
+    x = b.mat.CreateColVector()
+    ya = b.mat.CreateColVector()
+    yb = b.mat.CreateColVector()
+    x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    ya.data = a.mat * x
+    yb.data = b.mat * x
+    yb -= ya
+    assert Norm(yb) < 1e-10 * Norm(ya)
+
+def test_assemble_elements():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    c = Parameter(1)
+    region = IfPos(x-0.5, c, 1)
+    a = BilinearForm(fes, store_elmats=True)
+    a += region*grad(u)*grad(v)*dx
+    a.Assemble()
+
+    dirty = BitArray(mesh.ne)
+    dirty.Clear()
+    for el in mesh.Elements(VOL):
+        if any(mesh[vert].point[0] > 0.5-1e-10 for vert in el.vertices):
+            dirty.Set(el.nr)
+    c.Set(5)
+    a.AssembleElements(dirty)
+
+    b = BilinearForm(fes)
+    b += region*grad(u)*grad(v)*dx
+    b.Assemble()
+    vala = a.mat.AsVector().FV().NumPy()
+    valb = b.mat.AsVector().FV().NumPy()
+    assert np.linalg.norm(vala-valb) < 1e-10 * np.linalg.norm(valb)
+
+def test_atomic_assembly():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    vals = []
+    for atomic in [False, True]:
+        a = BilinearForm(fes, symmetric=True, atomic_assembly=atomic)
+        a += grad(u)*grad(v)*dx + u*v*ds
+        with TaskManager():
+            a.Assemble()
+        vals.append(a.mat.AsVector().FV().NumPy().copy())
+    assert np.linalg.norm(vals[0]-vals[1]) < 1e-12 * np.linalg.norm(vals[0])
+
+def test_reuse_graph():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    a1 = BilinearForm(fes, reuse_graph=True)
+    a1 += grad(u)*grad(v)*dx
+    a1.Assemble()
+    a2 = BilinearForm(fes, reuse_graph=True)
+    a2 += u*v*dx
+    a2.Assemble()
+    a3 = BilinearForm(fes)
+    a3 += u*v*dx
+    a3.Assemble()
+    assert a2.mat.nze == a3.mat.nze
+    vals2 = a2.mat.AsVector().FV().NumPy()
+    vals3 = a3.mat.AsVector().FV().NumPy()
+    assert np.linalg.norm(vals2-vals3) < 1e-14 * np.linalg.norm(vals3)
+
+    # updated space must not use the outdated graph
+    mesh.Refine()
+    fes.Update()
+    a2.Assemble()
+    a3.Assemble()
+    assert a2.mat.height == fes.ndof
+    assert a2.mat.nze == a3.mat.nze
+
+def test_batch_assembly():
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.3))
+    for fes in [H1(mesh, order=1), VectorH1(mesh, order=2)]:
+        u,v = fes.TnT()
+        vals = []
+        for flags in [{}, { "batch_assembly" : True },
+                      { "assembly_buffer" : 50, "sort_scatter" : True },
+                      { "batch_assembly" : True, "assembly_buffer" : 50 }]:
+            a = BilinearForm(fes, **flags)
+            a += (1+x*y)*InnerProduct(grad(u),grad(v))*dx + u*v*dx
+            a.Assemble()
+            vals.append(a.mat.AsVector().FV().NumPy().copy())
+        for val in vals[1:]:
+            assert np.linalg.norm(vals[0]-val) < 1e-12 * np.linalg.norm(vals[0])
+
+def test_batch_condensation():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    order = 3
+    fes = L2(mesh, order=order) * FacetFESpace(mesh, order=order, dirichlet=".*")
+    (u,uhat),(v,vhat) = fes.TnT()
+    n = specialcf.normal(2)
+    h = specialcf.mesh_size
+    dS = dx(element_boundary=True)
+    sols = []
+    for flags in [{}, { "assembly_buffer" : 20 }, { "batch_assembly" : True, "assembly_buffer" : 20 }]:
+        for sym in [False, True]:
+            a = BilinearForm(fes, condense=True, symmetric=sym, **flags)
+            a += grad(u)*grad(v)*dx + (1+x)*u*v*dx
+            a += (-grad(u)*n*(v-vhat) - grad(v)*n*(u-uhat) + 10*order**2/h*(u-uhat)*(v-vhat))*dS
+            a.Assemble()
+            f = LinearForm(x*v*dx).Assemble()
+            gfu = GridFunction(fes)
+            f.vec.data += a.harmonic_extension_trans * f.vec
+            gfu.vec.data = a.mat.Inverse(fes.FreeDofs(True)) * f.vec
+            gfu.vec.data += a.harmonic_extension * gfu.vec
+            gfu.vec.data += a.inner_solve * f.vec
+            sols.append(gfu.vec.CreateVector())
+            sols[-1].data = gfu.vec
+    for sol in sols[1:]:
+        sol -= sols[0]
+        assert Norm(sol) < 1e-10 * Norm(sols[0])
+
+def test_sparsematrix_float():
+    from ngsolve.la import SparseMatrixFloat
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym)
+        a += grad(u)*grad(v)*dx + u*v*dx
+        a.Assemble()
+        af = SparseMatrixFloat(a.mat)
+        x = a.mat.CreateColVector()
+        x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+        y = a.mat.CreateColVector()
+        yf = af.CreateColVector()
+        y.data = a.mat * x
+        yf.data = af * x
+        assert Norm(y-yf) < 1e-6 * Norm(y)
+
+def test_cost_balancing():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    vals = []
+    for balance in [False, True]:
+        fes = H1(mesh, order=3, cost_balancing=balance)
+        u,v = fes.TnT()
+        a = BilinearForm(fes, symmetric=True)
+        a += grad(u)*grad(v)*dx + u*v*ds
+        with TaskManager():
+            # second assembly uses the measured element timings
+            for i in range(2):
+                a.Assemble()
+        vals.append(a.mat.AsVector().FV().NumPy().copy())
+    assert np.linalg.norm(vals[0]-vals[1]) < 1e-12 * np.linalg.norm(vals[0])
+
+def test_sparsematrix_sell():
+    from ngsolve.la import SparseMatrixSELL
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2, dirichlet=".*")
+    u,v = fes.TnT()
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym)
+        a += grad(u)*grad(v)*dx
+        a.Assemble()
+        asell = SparseMatrixSELL(a.mat, sigma=32)
+        x = a.mat.CreateColVector()
+        x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+        y = a.mat.CreateColVector()
+        ysell = a.mat.CreateColVector()
+        y.data = a.mat * x
+        ysell.data = asell * x
+        assert Norm(y-ysell) < 1e-12 * Norm(y)
+
+    f = LinearForm(fes)
+    f += v*dx
+    f.Assemble()
+    gfu = GridFunction(fes)
+    pre = Projector(fes.FreeDofs(), True)
+    gfu.vec.data = solvers.CG(mat=asell, pre=pre, rhs=f.vec, tol=1e-10, maxsteps=1000, printrates=False)
+    res = f.vec.CreateVector()
+    res.data = f.vec - a.mat * gfu.vec
+    res.data = pre * res
+    assert Norm(res) < 1e-6 * Norm(f.vec)
+
+def test_to_block_csr():
+    from ngsolve.la import SparseMatrixd
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=1)
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    a.Assemble()
+    # interleaved numbering of 3 coupled components
+    ri, ci, vals = a.mat.COO()
+    indi, indj, values = [], [], []
+    for i,j,val in zip(ri, ci, vals):
+        for k in range(3):
+            for l in range(3):
+                indi.append(int(3*i+k))
+                indj.append(int(3*j+l))
+                values.append(val*(1+k+2*l))
+    n = 3*fes.ndof
+    mat = SparseMatrixd.CreateFromCOO(indi, indj, values, n, n)
+    bmat = mat.ToBlockCSR(3)
+    assert bmat is not None
+    x = mat.CreateColVector()
+    x.FV().NumPy()[:] = np.random.rand(n)
+    y = mat.CreateColVector()
+    y.data = mat * x
+    xb = bmat.CreateColVector()
+    yb = bmat.CreateColVector()
+    xb.FV().NumPy()[:] = x.FV().NumPy()
+    yb.data = bmat * xb
+    diff = y.FV().NumPy() - yb.FV().NumPy()
+    assert np.linalg.norm(diff) < 1e-12 * Norm(y)
+
+def test_multivector():
+    from ngsolve.la import MultiVector
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2, dirichlet=".*")
+    u,v = fes.TnT()
+    k = 3
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym)
+        a += grad(u)*grad(v)*dx + u*v*dx
+        a.Assemble()
+        blocks = [ [d] for d in range(fes.ndof) ]
+        ops = [a.mat, a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky"),
+               a.mat.CreateBlockSmoother(blocks)]
+        for op in ops:
+            x = MultiVector(fes.ndof, k)
+            y = MultiVector(fes.ndof, k)
+            for j in range(k):
+                x[j].FV().NumPy()[:] = np.random.rand(fes.ndof)
+            op.Mult(x, y)
+            for j in range(k):
+                yj = x[j].CreateVector()
+                yj.data = op * x[j]
+                assert Norm(y[j]-yj) < 1e-10 * Norm(yj)
+
+def test_blockjacobi_batched_inverse():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=4)
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx + u*v*dx
+    a.Assemble()
+    ri, ci, vals = a.mat.COO()
+    dense = np.zeros((fes.ndof, fes.ndof))
+    dense[np.array(ri), np.array(ci)] = np.array(vals)
+    # edge and element blocks, several block sizes
+    blocks = [ fes.GetDofNrs(e) for e in mesh.edges ] + [ fes.GetDofNrs(el) for el in fes.Elements() ]
+    x = a.mat.CreateColVector()
+    x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    for floatinverses in [False, True]:
+        pre = a.mat.CreateBlockSmoother(blocks, floatinverses=floatinverses)
+        y = x.CreateVector()
+        y.data = pre * x
+        yex = np.zeros(fes.ndof)
+        xnp = x.FV().NumPy()
+        for b in blocks:
+            b = list(b)
+            yex[b] += np.linalg.solve(dense[np.ix_(b,b)], xnp[b])
+        tol = 1e-5 if floatinverses else 1e-10
+        assert np.linalg.norm(y.FV().NumPy()-yex) < tol * np.linalg.norm(yex)
+
+def test_blockjacobi_symmetric_gs():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=3, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    a.Assemble()
+    f = LinearForm(fes)
+    f += v*dx
+    f.Assemble()
+    freedofs = fes.FreeDofs()
+    blocks = [ [d for d in fes.GetDofNrs(el) if freedofs[d]] for el in fes.Elements() ]
+    blocks = [ b for b in blocks if len(b) ]
+    pre = a.mat.CreateBlockSmoother(blocks)
+    exact = f.vec.CreateVector()
+    exact.data = a.mat.Inverse(freedofs) * f.vec
+    x = f.vec.CreateVector()
+    x[:] = 0
+    err = []
+    for it in range(20):
+        pre.SmoothSymmetric(x, f.vec)
+        x.data -= exact
+        err.append(Norm(x))
+        x.data += exact
+    assert err[-1] < 0.1 * err[0]
+
+def test_schwarz_preconditioner():
+    from ngsolve.la import SchwarzPreconditioner
+    from ngsolve.meshes import MakeStructured2DMesh
+    mesh = MakeStructured2DMesh(nx=6, ny=6)
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    freedofs = fes.FreeDofs()
+    # vertex patches, the dofs of the elements around a vertex
+    blocks = []
+    for vertex in mesh.vertices:
+        dofs = set()
+        for el in mesh[vertex].elements:
+            dofs |= set(fes.GetDofNrs(el))
+        blocks.append(sorted(dofs))
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym)
+        a += grad(u)*grad(v)*dx + u*v*dx
+        a.Assemble()
+        ri, ci, vals = a.mat.COO()
+        dense = np.zeros((fes.ndof, fes.ndof))
+        dense[np.array(ri), np.array(ci)] = np.array(vals)
+        if sym:
+            dense += np.tril(dense, -1).T
+        x = a.mat.CreateColVector()
+        x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+        xnp = x.FV().NumPy()
+        mult = np.zeros(fes.ndof)
+        for b in blocks:
+            mult[b] += 1
+        for schwarztype in ["additive", "weighted", "restricted"]:
+            yex = np.zeros(fes.ndof)
+            owner = -np.ones(fes.ndof, dtype=int)
+            for nr, b in enumerate(blocks):
+                w = 1/np.sqrt(mult[b]) if schwarztype == "weighted" else np.ones(len(b))
+                z = w * np.linalg.solve(dense[np.ix_(b,b)], w * xnp[b])
+                if schwarztype == "restricted":
+                    for d, zd in zip(b, z):
+                        if owner[d] == -1:
+                            owner[d] = nr
+                            yex[d] += zd
+                else:
+                    yex[b] += z
+            # densesize 0 factors all patches sparse
+            for densesize in [0, 1000]:
+                pre = SchwarzPreconditioner(a.mat, blocks, type=schwarztype, densesize=densesize)
+                y = x.CreateVector()
+                y.data = pre * x
+                assert np.linalg.norm(y.FV().NumPy()-yex) < 1e-10 * np.linalg.norm(yex)
+                if densesize == 0:
+                    assert pre.numsparse == len(blocks)
+                    # congruent interior patches share the symbolic factorization
+                    assert pre.numsymbolic < pre.numsparse
+        # new values, same graph
+        vec = a.mat.AsVector()
+        vec.data = 2 * vec
+        pre.Update()
+        y2 = x.CreateVector()
+        y2.data = pre * x
+        assert Norm(2*y2 - y) < 1e-10 * Norm(y)
+
+
+def test_ebe_batched():
+    from ngsolve.la import MultiVector
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=4, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes, condense=True)
+    a += grad(u)*grad(v)*dx + u*v*dx
+    f = LinearForm(fes)
+    f += v*dx
+    a.Assemble()
+    f.Assemble()
+    # static condensation applies the element-by-element matrices
+    gfu = GridFunction(fes)
+    r = f.vec.CreateVector()
+    r.data = f.vec
+    r.data += a.harmonic_extension_trans * r
+    gfu.vec.data = a.mat.Inverse(fes.FreeDofs(True)) * r
+    gfu.vec.data += a.harmonic_extension * gfu.vec
+    gfu.vec.data += a.inner_solve * f.vec
+
+    afull = BilinearForm(fes)
+    afull += grad(u)*grad(v)*dx + u*v*dx
+    afull.Assemble()
+    x = f.vec.CreateVector()
+    x.data = afull.mat.Inverse(fes.FreeDofs()) * f.vec
+    x.data -= gfu.vec
+    assert Norm(x) < 1e-10 * Norm(gfu.vec)
+
+    k = 3
+    for op in [a.harmonic_extension, a.inner_solve]:
+        x = MultiVector(fes.ndof, k)
+        y = MultiVector(fes.ndof, k)
+        for j in range(k):
+            x[j].FV().NumPy()[:] = np.random.rand(fes.ndof)
+        op.Mult(x, y)
+        for j in range(k):
+            yj = x[j].CreateVector()
+            yj.data = op * x[j]
+            assert Norm(y[j]-yj) < 1e-10 * Norm(yj)
+
+def test_sparse_rap():
+    from ngsolve.la import RAP, SparseRAP
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx+u*v*dx).Assemble()
+    n = fes.ndof
+    nc = n // 4
+    # aggregation-type prolongation
+    indi = list(range(n))
+    indj = [i % nc for i in range(n)]
+    vals = [1.0+0.1*(i%3) for i in range(n)]
+    P = SparseMatrixd.CreateFromCOO(indi, indj, vals, n, nc)
+    R = P.CreateTranspose()
+
+    x = P.CreateRowVector()
+    x.SetRandom()
+    y1 = x.CreateVector()
+    y2 = x.CreateVector()
+
+    Ac = RAP(R, a.mat, P)
+    assert Ac.height == nc and Ac.width == nc
+    y1.data = Ac * x
+    y2.data = R @ a.mat @ P * x
+    assert Norm(y1-y2) < 1e-12 * Norm(y2)
+
+    rap = SparseRAP(R, a.mat, P)
+    a.mat.AsVector().data = 3 * a.mat.AsVector()
+    rap.Update(a.mat)
+    y1.data = rap.mat * x
+    y2.data = R @ a.mat @ P * x
+    assert Norm(y1-y2) < 1e-12 * Norm(y2)
+
+def test_sparsematrix_compressed():
+    from ngsolve.la import SparseMatrixCompressed
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=4)
+    u,v = fes.TnT()
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym)
+        a += grad(u)*grad(v)*dx
+        a.Assemble()
+        nze = a.mat.nze if not sym else None
+        x = a.mat.CreateColVector()
+        x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+        y = a.mat.CreateColVector()
+        yc = a.mat.CreateColVector()
+        y.data = a.mat * x
+        for compression in ["runs", "offset16"]:
+            ac = SparseMatrixCompressed(a.mat, compression=compression)
+            yc.data = ac * x
+            assert Norm(y-yc) < 1e-12 * Norm(y)
+            if compression == "offset16" and nze:
+                assert ac.index_memory < 4*nze
+
+def test_sparsematrix_variableblocks():
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.5))
+    fes = H1(mesh, order=4, dirichlet=".*") * HCurl(mesh, order=3)
+    (u,E),(v,F) = fes.TnT()
+    x = GridFunction(fes).vec.CreateVector()
+    x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    y = x.CreateVector()
+    yb = x.CreateVector()
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym, variable_blocks=True)
+        a += (grad(u)*grad(v) + u*v + curl(E)*curl(F) + E*F + grad(u)*F)*dx
+        a.Assemble()
+        ab = a.vbmat
+        assert ab.nblocks < fes.ndof
+        y.data = a.mat * x
+        yb.data = ab * x
+        assert Norm(y-yb) < 1e-12 * Norm(y)
+        y.data = a.mat.T * x
+        yb.data = ab.T * x
+        assert Norm(y-yb) < 1e-12 * Norm(y)
+
+    # block Gauss-Seidel on the variable blocks as the block smoother on the same blocks
+    f = x.CreateVector()
+    f.data = a.mat * x
+    ab.InvertDiagonalBlocks(fes.FreeDofs())
+    pre = a.mat.CreateBlockSmoother([b for b in ab.GetBlocks() if all(fes.FreeDofs()[d] for d in b)])
+    for backward in [False, True]:
+        y[:] = 0
+        yb[:] = 0
+        ab.Smooth(yb, f, steps=2, backward=backward)
+        if backward:
+            pre.SmoothBack(y, f, steps=2)
+        else:
+            pre.Smooth(y, f, steps=2)
+        assert Norm(y-yb) < 1e-10 * Norm(y)
+
+def test_hybrid_gauss_seidel():
+    # large matrices are smoothed by parallel Gauss-Seidel on blocks of rows with l1-Jacobi coupling
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.05))
+    fes = H1(mesh, order=3, dirichlet=".*")
+    assert fes.ndof > 3000
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx, symmetric=False).Assemble()
+    pre = a.mat.CreateSmoother(fes.FreeDofs())
+    x = GridFunction(fes).vec.CreateVector()
+    x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    for i in range(fes.ndof):
+        if not fes.FreeDofs()[i]:
+            x[i] = 0
+    f = x.CreateVector()
+    f.data = a.mat * x
+    y = x.CreateVector()
+    y[:] = 0
+    e = x.CreateVector()
+    ae = x.CreateVector()
+    def energy():
+        e.data = x - y
+        ae.data = a.mat * e
+        return InnerProduct(e, ae)
+    errold = energy()
+    for it in range(5):
+        pre.Smooth(y, f)
+        pre.SmoothBack(y, f)
+        err = energy()
+        assert err < errold
+        errold = err
+
+def test_parameter_splitting():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    dt = Parameter(0.1)
+    nu = Parameter(2)
+    form = u*v*dx + dt*grad(u)*grad(v)*dx + nu*x*u*v*ds
+    a = BilinearForm(form, parameter_splitting=True).Assemble()
+    assert len(a.split_parameters) == 2
+    w = a.mat.CreateColVector()
+    w.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    y = w.CreateVector()
+    yref = w.CreateVector()
+    for dtval, nuval in [(0.1, 2), (0.02, 2), (0.3, -1)]:
+        dt.Set(dtval)
+        nu.Set(nuval)
+        a.Assemble()
+        aref = BilinearForm(form).Assemble()
+        y.data = a.mat * w
+        yref.data = aref.mat * w
+        assert Norm(y-yref) < 1e-12 * Norm(yref)
+
+    # not affine, assembled as usual
+    b = BilinearForm(u*v*dx + dt*dt*grad(u)*grad(v)*dx, parameter_splitting=True).Assemble()
+    assert len(b.split_parameters) == 0
+    dt.Set(0.5)
+    b.Assemble()
+    bref = BilinearForm(u*v*dx + dt*dt*grad(u)*grad(v)*dx).Assemble()
+    y.data = b.mat * w
+    yref.data = bref.mat * w
+    assert Norm(y-yref) < 1e-12 * Norm(yref)
+
+def test_matrix_io(tmpdir):
+    from ngsolve.la import SaveBinary, LoadBinaryMatrix, LoadBinaryVector, WriteMatrixMarket, ReadMatrixMarket
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    x = GridFunction(fes).vec.CreateVector()
+    x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    y = x.CreateVector()
+    y2 = x.CreateVector()
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym)
+        a += grad(u)*grad(v)*dx + 0.5*u*v*dx
+        a.Assemble()
+        y.data = a.mat * x
+
+        SaveBinary(a.mat, str(tmpdir.join("mat.bin")))
+        b = LoadBinaryMatrix(str(tmpdir.join("mat.bin")))
+        y2.data = b * x
+        assert Norm(y-y2) < 1e-14 * Norm(y)
+
+        WriteMatrixMarket(a.mat, str(tmpdir.join("mat.mtx")))
+        c = ReadMatrixMarket(str(tmpdir.join("mat.mtx")))
+        y2.data = c * x
+        assert Norm(y-y2) < 1e-12 * Norm(y)
+
+    SaveBinary(x, str(tmpdir.join("vec.bin")))
+    for copy in [False, True]:
+        x2 = LoadBinaryVector(str(tmpdir.join("vec.bin")), copy=copy)
+        assert len(x2) == len(x)
+        y2.data = x2 - x
+        assert Norm(y2) == 0
+
+def test_snapshot_store(tmpdir):
+    from ngsolve.la import SnapshotStore
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.05))
+    fes = H1(mesh, order=2)
+    gf = GridFunction(fes)
+    filename = str(tmpdir.join("history.snp"))
+    times = [0.1*k for k in range(20)]
+    tol = 1e-8
+    func = lambda t: sin(2*x+t)*cos(y-t)
+    w = gf.vec.CreateVector()
+
+    def MaxError(k):
+        gf.Set(func(times[k]))
+        w.data -= gf.vec
+        return max(abs(v) for v in w)
+
+    store = SnapshotStore(filename, tol=tol)
+    for t in times:
+        gf.Set(func(t))
+        assert store.Append(gf.vec) == len(store)-1
+    # reverse order, the last ones may still be queued
+    for k in reversed(range(len(times))):
+        store.Get(k, w)
+        assert MaxError(k) <= tol*(1+1e-6)
+    store.Close()
+    assert store.compressed_bytes < store.uncompressed_bytes / 2
+
+    reader = SnapshotStore(filename, create=False)
+    assert len(reader) == len(times)
+    for k in [5, 17, 0]:
+        reader.Get(k, w)
+        assert MaxError(k) <= tol*(1+1e-6)
+
+    for compression, relerr in [("float", 1e-6), ("raw", 0)]:
+        store = SnapshotStore(filename, compression=compression)
+        store.Append(gf.vec)
+        store.Flush()
+        store.Get(0, w)
+        w.data -= gf.vec
+        assert Norm(w) <= relerr * Norm(gf.vec)
+        store.Close()
+
+def test_blas_tuning(tmpdir, monkeypatch):
+    import ngsolve.bla
+    cachefile = str(tmpdir.join("blas_blocking.txt"))
+    monkeypatch.setenv("NGS_BLAS_TUNING_FILE", cachefile)
+    res = ngsolve.bla.TuneBlasBlocking(n=100)
+    assert res["cachefile"] == cachefile
+    with open(cachefile) as f:
+        assert f.read().startswith(res["cpu"])
+
+    # kernels with the tuned blocking
+    a = Matrix(300,200)
+    b = Matrix(200,250)
+    for i in range(a.h):
+        for j in range(a.w):
+            a[i,j] = i+2*j
+    for i in range(b.h):
+        for j in range(b.w):
+            b[i,j] = 1/(i+j+1)
+    c = a*b
+    anp, bnp = a.NumPy(), b.NumPy()
+    assert np.linalg.norm(c.NumPy()-anp@bnp) < 1e-10 * np.linalg.norm(c.NumPy())
+
 if __name__ == "__main__":
     test_matrix()
     test_matrix_numpy()
     test_sparsematrix_access()
+    test_sumfactorization_apply()
+    test_assemble_elements()
+    test_atomic_assembly()
+    test_reuse_graph()
+    test_batch_assembly()
+    test_batch_condensation()
+    test_sparsematrix_float()
+    test_cost_balancing()
+    test_sparsematrix_sell()
+    test_to_block_csr()
+    test_multivector()
+    test_blockjacobi_batched_inverse()
+    test_blockjacobi_symmetric_gs()
+    test_ebe_batched()
+    test_sparse_rap()
+    test_sparsematrix_compressed()
+
+def test_sparsematrix_buffers():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += u*v*dx
+    a.Assemble()
+    firsti = np.asarray(a.mat.firsti)
+    colnr = np.asarray(a.mat.colnr)
+    values = np.asarray(a.mat.values)
+    assert len(firsti) == a.mat.height+1
+    assert len(colnr) == firsti[-1] == len(values)
+    i = 3
+    j = colnr[firsti[i]]
+    assert values[firsti[i]] == a.mat[i,j]
+    values[firsti[i]] = 42
+    assert a.mat[i,j] == 42
+
+    x = np.arange(fes.ndof, dtype=float)
+    vx = VectorView(x)
+    y = a.mat.CreateColVector()
+    y.data = a.mat * vx
+    ref = a.mat.CreateColVector()
+    ref.FV().NumPy()[:] = x
+    y.data -= a.mat * ref
+    assert Norm(y) == 0
+    vx.data = 2*vx
+    assert x[5] == 10
+
+def test_assemble_async():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    f = LinearForm(fes)
+    f += v*dx
+    futures = [a.AssembleAsync(), f.AssembleAsync()]
+    for fut in futures:
+        fut.result()
+    w = f.vec.CreateVector()
+    w.data = a.mat * f.vec
+    b = BilinearForm(fes)
+    b += grad(u)*grad(v)*dx
+    b.Assemble()
+    w.data -= b.mat * f.vec
+    assert Norm(w) < 1e-12 * Norm(f.vec)
+
+def test_fixed_dim_proxy_contraction():
+    # vector-valued proxies (dims 2 and 4) against the scalar components (dims 1 and 2)
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    A = CoefficientFunction((2, 1+x, -y, 3), dims=(2,2))
+    V = VectorH1(mesh, order=2)
+    u,v = V.TnT()
+    a = BilinearForm(V)
+    a += (InnerProduct(A*u, v) + InnerProduct(A*grad(u)*A, grad(v))) * dx
+    a.Assemble()
+
+    W = H1(mesh, order=2)**2
+    (u0,u1), (v0,v1) = W.TnT()
+    us, vs = [u0,u1], [v0,v1]
+    gu, gv = [grad(u0),grad(u1)], [grad(v0),grad(v1)]
+    b = BilinearForm(W)
+    b += sum(A[j,k] * us[k] * vs[j] for j in range(2) for k in range(2)) * dx
+    b += sum(A[j,l] * A[m,i] * gu[l][m] * gv[j][i] for j in range(2) for l in range(2)
+             for m in range(2) for i in range(2)) * dx
+    b.Assemble()
+
+    diff = a.mat.AsVector().CreateVector()
+    diff.data = a.mat.AsVector() - b.mat.AsVector()
+    assert Norm(diff) < 1e-12 * Norm(a.mat.AsVector())
+
+def test_fuse_integrals():
+    from netgen.geom2d import SplineGeometry
+    geo = SplineGeometry()
+    geo.AddRectangle((0,0), (2,1), leftdomain=1, rightdomain=0)
+    geo.AddRectangle((0.5,0.25), (1,0.75), leftdomain=2, rightdomain=1)
+    geo.SetMaterial(1, "outer")
+    geo.SetMaterial(2, "inner")
+    mesh = Mesh(geo.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    integrals = u*v*dx + x*u*v*dx + grad(u)*grad(v)*dx(definedon=mesh.Materials("inner")) \
+        + y*grad(u)*grad(v)*dx(definedon=mesh.Materials("inner")) + u*v*ds
+    vals = []
+    for fuse, nintegrators in [(True, 3), (False, 5)]:
+        a = BilinearForm(fes, fuse_integrals=fuse)
+        a += integrals
+        assert len(a.integrators) == nintegrators
+        a.Assemble()
+        vals.append(a.mat.AsVector().FV().NumPy().copy())
+    assert np.linalg.norm(vals[0]-vals[1]) < 1e-12 * np.linalg.norm(vals[1])
+
+def test_sum_matrix_same_graph():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u, v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    a.Assemble()
+    m = BilinearForm(fes)
+    m += u*v*dx
+    m.Assemble()
+
+    x = a.mat.CreateColVector()
+    x.FV().NumPy()[:] = np.random.rand(fes.ndof)
+    y1 = x.CreateVector()
+    y2 = x.CreateVector()
+    tmp = x.CreateVector()
+
+    # nested sum and scaling, evaluated in one pass over the common graph
+    s = a.mat + 2 * m.mat - 0.5 * a.mat
+    y1.data = s * x
+    y2.data = a.mat * x
+    tmp.data = m.mat * x
+    y2.data += 2 * tmp
+    tmp.data = a.mat * x
+    y2.data -= 0.5 * tmp
+    assert Norm(y1-y2) < 1e-12 * Norm(y2)
+
+    y1.data += 3 * s * x
+    y2.data *= 4
+    assert Norm(y1-y2) < 1e-12 * Norm(y2)
+
+    # products with sums use the temporary vectors
+    p = s @ m.mat
+    y1.data = p * x
+    tmp.data = m.mat * x
+    y2.data = s * tmp
+    assert Norm(y1-y2) < 1e-12 * Norm(y2)
+
+def test_transpose_by_columns():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    V = VectorH1(mesh, order=2, dirichlet="left")
+    Q = L2(mesh, order=1)
+    u = V.TrialFunction()
+    q = Q.TestFunction()
+    c = Parameter(1)
+    b = BilinearForm(trialspace=V, testspace=Q)
+    b += c * div(u) * q * dx
+    b.Assemble()
+
+    x = b.mat.CreateColVector()
+    x.FV().NumPy()[:] = np.random.rand(len(x))
+    y = b.mat.CreateRowVector()
+    yref = b.mat.CreateRowVector()
+    for i in range(3):
+        # the transposed graph is set up at the second product, values change in between
+        c.Set(i+1)
+        b.Assemble()
+        y.data = b.mat.T * x
+        yref.data = b.mat.CreateTranspose() * x
+        assert Norm(y-yref) < 1e-12 * Norm(yref)
+        y.data = 2 * yref
+        y.data += b.mat.T * x
+        assert Norm(y-3*yref) < 1e-12 * Norm(yref)
+
+
+def test_symmetric_multadd_parallel():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    for fes in [H1(mesh, order=3), VectorH1(mesh, order=2)]:
+        u, v = fes.TnT()
+        forms = []
+        for symmetric in [True, False]:
+            a = BilinearForm(fes, symmetric=symmetric)
+            a += (InnerProduct(grad(u), grad(v)) + InnerProduct(u, v)) * dx
+            forms.append(a)
+        with TaskManager():
+            for a in forms:
+                a.Assemble()
+            x = forms[1].mat.CreateColVector()
+            x.FV().NumPy()[:] = np.random.rand(len(x))
+            y = x.CreateVector()
+            yref = x.CreateVector()
+            # lower triangle only, the transposed part is added by blocks of rows
+            y.data = forms[0].mat * x
+            yref.data = forms[1].mat * x
+            assert Norm(y-yref) < 1e-12 * Norm(yref)
+            y.data = 2 * yref
+            y -= forms[0].mat * x
+            assert Norm(y-yref) < 1e-12 * Norm(yref)
+
+
+def test_delete_zero_elements():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2) * H1(mesh, order=2)
+    (u1, u2), (v1, v2) = fes.TnT()
+    for symmetric in [False, True]:
+        # the graph couples the components, the matrix does not
+        a = BilinearForm(fes, symmetric=symmetric)
+        a += (grad(u1) * grad(v1) + u2 * v2) * dx
+        a.Assemble()
+        comp = a.mat.DeleteZeroElements(1e-14)
+        assert comp.nze < a.mat.nze
+        assert comp.nze >= fes.ndof
+        x = a.mat.CreateColVector()
+        x.FV().NumPy()[:] = np.random.rand(len(x))
+        y = x.CreateVector()
+        yref = x.CreateVector()
+        y.data = comp * x
+        yref.data = a.mat * x
+        assert Norm(y-yref) < 1e-12 * Norm(yref)
+
+
+def test_complex_multadd():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=3, complex=True)
+    u, v = fes.TnT()
+    for symmetric in [False, True]:
+        a = BilinearForm(fes, symmetric=symmetric)
+        a += (grad(u) * grad(v) + (2+1j) * u * v) * dx
+        a.Assemble()
+        ri, ci, vals = a.mat.COO()
+        dense = np.zeros((fes.ndof, fes.ndof), dtype=complex)
+        for i, j, val in zip(ri, ci, vals):
+            dense[i, j] = val
+            if symmetric:
+                dense[j, i] = val
+        x = a.mat.CreateColVector()
+        xnp = np.random.rand(fes.ndof) + 1j * np.random.rand(fes.ndof)
+        x.FV().NumPy()[:] = xnp
+        y = a.mat.CreateColVector()
+        for s in [1, 1j]:
+            y.data = s * (a.mat * x)
+            yref = s * (dense @ xnp)
+            assert np.linalg.norm(y.FV().NumPy() - yref) < 1e-12 * np.linalg.norm(yref)
+
+
+def test_condense_compressed():
+    from ngsolve.meshes import MakeStructured2DMesh
+    mesh = MakeStructured2DMesh(quads=True, nx=8, ny=8)
+    fes = H1(mesh, order=4, dirichlet="left|bottom")
+    u, v = fes.TnT()
+    f = LinearForm(fes)
+    f += v * dx
+    f.Assemble()
+    sols = []
+    for flags in [{}, { "condense_share" : True }, { "condense_float" : True },
+                  { "condense_share" : True, "condense_float" : True }]:
+        for sym in [False, True]:
+            # equal elements of the structured mesh share their matrices
+            a = BilinearForm(fes, condense=True, symmetric=sym, **flags)
+            a += (grad(u)*grad(v) + u*v) * dx
+            a.Assemble()
+            r = f.vec.CreateVector()
+            r.data = f.vec
+            r.data += a.harmonic_extension_trans * r
+            gfu = GridFunction(fes)
+            gfu.vec.data = a.mat.Inverse(fes.FreeDofs(True)) * r
+            gfu.vec.data += a.harmonic_extension * gfu.vec
+            gfu.vec.data += a.inner_solve * f.vec
+            sols.append((flags, gfu.vec.CreateVector()))
+            sols[-1][1].data = gfu.vec
+    ref = sols[0][1]
+    for flags, sol in sols[1:]:
+        sol -= ref
+        tol = 1e-5 if flags.get("condense_float") else 1e-10
+        assert Norm(sol) < tol * Norm(ref)
+
+def BandMatrixToDense(band):
+    n, bw = band.shape
+    dense = np.zeros((n,n))
+    for i in range(n):
+        for j in range(max(0,i-bw+1), i+1):
+            dense[i,j] = dense[j,i] = band[i,j-i+bw-1]
+    return dense
+
+def RandomSPDBand(n, bw):
+    band = np.random.rand(n, bw) - 0.5
+    band[:,bw-1] = 2*bw
+    for i in range(bw-1):
+        band[i,:bw-1-i] = 0
+    return band
+
+def test_band_solvers():
+    import ngsolve.bla
+    n, bw, nmats = 37, 4, 11
+    bands = Matrix(n*nmats, bw)
+    rhs = Matrix(n, nmats)
+    bands.NumPy()[:] = np.vstack([ RandomSPDBand(n, bw) for m in range(nmats) ])
+    rhs.NumPy()[:] = np.random.rand(n, nmats)
+    x = ngsolve.bla.BatchedBandSolve(bands, rhs).NumPy()
+    for m in range(nmats):
+        dense = BandMatrixToDense(bands.NumPy()[m*n:(m+1)*n])
+        assert np.linalg.norm(dense @ x[:,m] - rhs.NumPy()[:,m]) < 1e-10 * np.linalg.norm(rhs.NumPy()[:,m])
+
+    for n, bw in [ (1000, 3), (513, 5), (10, 2), (3, 4) ]:
+        band = Matrix(n, bw)
+        band.NumPy()[:] = RandomSPDBand(n, bw)
+        f = Vector(n)
+        f.NumPy()[:] = np.random.rand(n)
+        x = ngsolve.bla.CyclicReductionBandSolve(band, f).NumPy()
+        dense = BandMatrixToDense(band.NumPy())
+        assert np.linalg.norm(dense @ x - f.NumPy()) < 1e-10 * np.linalg.norm(f.NumPy())
@@ -0,0 +1,40 @@
+from netgen.geom2d import unit_square
+from ngsolve import *
+
+
+def _find(node, name):
+    if node["name"] == name:
+        return node
+    for c in node["children"]:
+        found = _find(c, name)
+        if found:
+            return found
+    return None
+
+
+def test_memoryusage_tree():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    a = BilinearForm(fes, name="a")
+    a += grad(u)*grad(v)*dx
+    a.Assemble()
+
+    mem = a.MemoryUsage()
+    assert mem["current"] > 0
+    assert mem["peak"] >= mem["current"]
+    spmat = _find(mem["tree"], "SparseMatrix")
+    assert spmat is not None
+    children = { c["name"] : c["bytes"] for c in spmat["children"] }
+    assert children["values"] >= 8 * a.mat.nze
+    assert "MatrixGraph" in children
+    # a node counts the bytes of its children
+    assert spmat["bytes"] == sum(children.values())
+    assert "SparseMatrix" in a.PrintMemoryUsage()
+
+    inv = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky")
+    fesmem = fes.MemoryUsage()
+    assert _find(fesmem["tree"], "element coloring") is not None
+
+    current, peak = ProcessMemory()
+    assert peak >= current > 0
@@ -18,3 +18,184 @@ def test_call_operator_with_vectorization():
     mesh = Mesh(unit_cube.GenerateMesh(maxh=1))
     p = mesh(0.5,0.5,0.5)
     p2 = mesh([0.5, 0.1],0.5,0.5)
+
+def test_geometry_cache():
+    geo = CSGeometry()
+    geo.Add(Sphere(Pnt(0,0,0), 1))
+    mesh = Mesh(geo.GenerateMesh(maxh=0.5))
+    mesh.Curve(3)
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    gfu = GridFunction(fes)
+    gfu.Set(x*y+z)
+    a = BilinearForm(grad(u)*grad(v)*dx)
+    res0 = gfu.vec.CreateVector()
+    res1 = gfu.vec.CreateVector()
+    a.Apply(gfu.vec, res0)
+    mesh.SetGeometryCache()
+    for i in range(2):
+        a.Apply(gfu.vec, res1)
+        res1 -= res0
+        assert Norm(res1) < 1e-12 * Norm(res0)
+    mesh.SetGeometryCache(False)
+
+def test_batched_point_search():
+    import numpy as np
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.3))
+    np.random.seed(0)
+    px, py, pz = np.random.rand(3, 200)
+    pts = mesh(px, py, pz)
+    assert pts.shape == (200,)
+    assert all(pts["nr"] >= 0)
+    for i in range(0, 200, 20):
+        assert mesh(px[i], py[i], pz[i]).nr >= 0
+    outside = mesh(np.array([1.5, -0.5]), 0.5, 0.5)
+    assert all(outside["nr"] == -1)
+
+    fes = H1(mesh, order=2)
+    gfu = GridFunction(fes)
+    gfu.Set(x*y+z*z)
+    vals = gfu(pts).flatten()
+    assert np.allclose(vals, px*py+pz*pz)
+    assert np.allclose(CoefficientFunction((x,y))(pts), np.stack([px,py],axis=1))
+
+def test_vtk_output():
+    import os, re, struct, tempfile
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.5))
+    base = os.path.join(tempfile.mkdtemp(), "out")
+    for fmt in ["vtk", "vtu"]:
+        VTKOutput(mesh, coefs=[x, CF((x,y,z))], names=["x", "p"], filename=base+fmt,
+                  subdivision=1, format=fmt).Do()
+    text = open(base+"vtk.vtk").read()
+    npts = int(re.search(r"POINTS (\d+)", text).group(1))
+    ncells = int(re.search(r"CELLS (\d+)", text).group(1))
+    data = open(base+"vtu.vtu", "rb").read()
+    assert ('NumberOfPoints="%d" NumberOfCells="%d"' % (npts, ncells)).encode() in data
+    # first appended array is the scalar field x
+    start = data.index(b"\n_") + 2
+    nbytes = struct.unpack("<Q", data[start:start+8])[0]
+    assert nbytes == 4*npts
+    vals = struct.unpack("<%df" % npts, data[start+8:start+8+nbytes])
+    assert min(vals) >= -1e-6 and max(vals) <= 1+1e-6
+
+def test_vtk_time_series():
+    import os, tempfile
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.5))
+    t = Parameter(0)
+    base = os.path.join(tempfile.mkdtemp(), "series")
+    vtk = VTKOutput(mesh, coefs=[t*x], names=["u"], filename=base, format="vtu")
+    sizes = []
+    for step in range(3):
+        t.Set(0.1*step)
+        vtk.Do(time=0.1*step)
+        sizes.append(os.path.getsize(base + ("_%d" % step if step else "") + ".vtu"))
+    assert sizes[0] == sizes[1] == sizes[2]
+    pvd = open(base + ".pvd").read()
+    assert pvd.count("<DataSet") == 3 and "series_2.vtu" in pvd
+
+def test_background_output():
+    import os, tempfile
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.5))
+    t = Parameter(0)
+    tmp = tempfile.mkdtemp()
+    fes = H1(mesh, order=2)
+    gfu = GridFunction(fes)
+    files = {}
+    for background in [False, True]:
+        base = os.path.join(tmp, "bg" if background else "fg")
+        vtk = VTKOutput(mesh, coefs=[t*x], names=["u"], filename=base, format="vtu", background=background)
+        for step in range(3):
+            t.Set(0.1*step)
+            vtk.Do(time=0.1*step)
+            gfu.Set(t*x*y)
+            gfu.Save(base + "_%d.sol" % step, background=background)
+        WaitOutput()
+        files[background] = [open(base + ("_%d" % step if step else "") + ".vtu", "rb").read()
+                             for step in range(3)]
+        files[background] += [open(base + "_%d.sol" % step, "rb").read() for step in range(3)]
+    # the snapshots are taken at Do and Save
+    assert files[True] == files[False]
+    assert files[True][1] != files[True][2]
+
+def test_deformation_geometry_cache():
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.4))
+    fesdef = VectorH1(mesh, order=2)
+    deform = GridFunction(fesdef)
+    deform.Set((0.1*x*y, 0.1*z*z, 0.1*x))
+    mesh.SetDeformation(deform)
+    vol0 = Integrate(1, mesh)
+    area0 = Integrate(1, mesh, BND)
+    mesh.SetGeometryCache()
+    for i in range(2):
+        assert abs(Integrate(1, mesh) - vol0) < 1e-12
+        assert abs(Integrate(1, mesh, BND) - area0) < 1e-12
+    # new values need a new SetDeformation call to refresh the cache
+    deform.Set((0.2*x*y, 0.1*z*z, 0.1*x))
+    mesh.SetDeformation(deform)
+    vol1 = Integrate(1, mesh)
+    mesh.SetGeometryCache(False)
+    assert abs(Integrate(1, mesh) - vol1) < 1e-12
+    assert abs(vol1 - vol0) > 1e-3
+    mesh.UnsetDeformation()
+    assert abs(Integrate(1, mesh) - 1) < 1e-12
+
+def test_mesh_from_arrays():
+    import numpy as np
+    from ngsolve.meshes import MakeStructured2DMesh, MeshFromArrays
+    ref = MakeStructured2DMesh(quads=False, nx=6, ny=4)
+    points = np.array([v.point[:2] for v in ref.vertices])
+    elements = np.array([[v.nr for v in el.vertices] for el in ref.Elements(VOL)])
+    bnd = np.array([[v.nr for v in el.vertices] for el in ref.Elements(BND)])
+    bcs = list(ref.GetBoundaries())
+    names = sorted(set(bcs))
+    bndregions = np.array([names.index(bcs[el.index]) for el in ref.Elements(BND)])
+
+    # the lower half of the elements in another region
+    regions = np.array([int(sum(ref[v].point[1] for v in el.vertices) > 1.5) for el in ref.Elements(VOL)])
+    mesh = MeshFromArrays(points, elements, regions, bnd, bndregions,
+                          materials=["lower", "upper"], bcs=names)
+
+    assert (mesh.nv, mesh.ne, mesh.nedge) == (ref.nv, ref.ne, ref.nedge)
+    assert len(mesh.Elements(BND)) == len(ref.Elements(BND))
+    assert abs(Integrate(1, mesh) - 1) < 1e-12
+    assert abs(Integrate(1, mesh.Materials("lower")) - 0.5) < 1e-12
+    for name in names:
+        assert abs(Integrate(1, mesh.Boundaries(name), BND) - Integrate(1, ref.Boundaries(name), BND)) < 1e-12
+
+    fes = H1(mesh, order=2, dirichlet="left")
+    assert fes.ndof == H1(ref, order=2).ndof
+
+def test_parallel_curve():
+    geo = CSGeometry()
+    geo.Add(Sphere(Pnt(0,0,0), 1))
+    ngmesh = geo.GenerateMesh(maxh=0.5)
+    mesh = Mesh(ngmesh)
+    mesh.Curve(4)
+    vol = Integrate(1, mesh)
+    with TaskManager():
+        mesh.Curve(4)
+        vol_tm = Integrate(1, mesh)
+    assert abs(vol - vol_tm) < 1e-12
+    assert abs(vol - 4/3*pi) < 1e-3
+
+def test_nested_multidim_update():
+    from netgen.geom2d import unit_square
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    fes = H1(mesh, order=1)
+    gf = GridFunction(fes, nested=True, multidim=2)
+    gf.Set(x)
+    gf.vecs[1].data = 2 * gf.vecs[0]
+    for l in range(3):
+        for el in mesh.Elements():
+            mesh.SetRefinementFlag(el, el.nr % 3 == l % 3)
+        mesh.Refine()
+        fes.Update()
+        gf.Update()
+    gfx = GridFunction(fes)
+    gfx.Set(x)
+    assert len(gf.vecs[1]) == fes.ndof
+    gfx.vec.data -= gf.vecs[0]
+    assert Norm(gfx.vec) < 1e-12
+    gfx.Set(2*x)
+    gfx.vec.data -= gf.vecs[1]
+    assert Norm(gfx.vec) < 1e-12
@@ -0,0 +1,26 @@
+from netgen.geom2d import unit_square
+from ngsolve import *
+
+
+def test_parallelstats():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    EnableParallelStats()
+    with TaskManager():
+        a = BilinearForm(fes)
+        a += grad(u)*grad(v)*dx
+        a.Assemble()
+        x = a.mat.CreateColVector()
+        y = a.mat.CreateColVector()
+        x[:] = 1
+        for i in range(10):
+            y.data = a.mat * x
+    report = ParallelStatsReport()
+    EnableParallelStats(False)
+
+    lines = { l.split()[0] : l.split() for l in report.splitlines()[2:-1] }
+    assert "SparseMatrix::MultAdd" in lines
+    # calls of the region
+    assert int(lines["SparseMatrix::MultAdd"][1]) == 10
+    assert "serial between them" in report
@@ -103,3 +103,32 @@ def test_quasiperiodic():
 
     u_true = exp(1J * k * (d[0] * x + d[1] * y + d[2] * z))
     assert sqrt(Integrate(Conj(u_true-u)*(u_true-u),mesh).real) < 1e-8
+
+def test_quasiperiodic_dof_tables():
+    geo = CSGeometry()
+    left = Plane(Pnt(0,0,0),Vec(-1,0,0))
+    right = Plane(Pnt(1,0,0),Vec(1,0,0))
+    cube = left * right * OrthoBrick(Pnt(-1,0,0),Pnt(2,1,1))
+    geo.Add(cube)
+    geo.PeriodicSurfaces(left,right)
+    mesh = Mesh(geo.GenerateMesh(maxh=0.4))
+    # precomputed element dofs and phases (default) against the remapping per element
+    for phase in [0.3, 1.7]:
+        mats = []
+        for cache in [True, False]:
+            fes = Periodic(H1(mesh, order=3, complex=True, cache_dofnrs=cache), phase=[exp(1J*phase)])
+            u,v = fes.TnT()
+            a = BilinearForm(fes)
+            a += grad(u)*grad(v)*dx + u*v*ds
+            a.Assemble()
+            f = LinearForm(fes)
+            f += (x+1J*y)*v*dx
+            f.Assemble()
+            mats.append((a.mat, f.vec))
+        diff = mats[0][0].CreateColVector()
+        diff.data = mats[0][1] - mats[1][1]
+        assert Norm(diff) < 1e-12 * Norm(mats[0][1])
+        y = diff.CreateVector()
+        y.data = mats[0][0] * mats[0][1]
+        diff.data = y - mats[1][0] * mats[0][1]
+        assert Norm(diff) < 1e-12 * Norm(y)
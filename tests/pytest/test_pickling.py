@@ -240,6 +240,29 @@ def test_pickle_CoefficientFunctions():
     np.allclose(lcfs[29](mp), compiled_vals)
     np.allclose(lcfs[30](mp), compiled_vals)
 
+def test_checkpoint():
+    import os, tempfile
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    fes = HCurl(mesh,order=3,complex=True)
+    u = GridFunction(fes,"u",multidim=2)
+    u.vec.SetRandom()
+    u.vecs[1].data = 2*u.vec
+    filename = os.path.join(tempfile.mkdtemp(), "u.ckpt")
+    u.SaveCheckpoint(filename)
+    u2 = GridFunction(fes,"u2",multidim=2)
+    u2.LoadCheckpoint(filename)
+    for i in range(2):
+        difvec = u.vecs[i].CreateVector()
+        difvec.data = u.vecs[i] - u2.vecs[i]
+        assert Norm(difvec) == 0
+    u3 = GridFunction(HCurl(mesh,order=2,complex=True))
+    try:
+        u3.LoadCheckpoint(filename)
+        assert False
+    except Exception as e:
+        assert "LoadCheckpoint" in str(e)
+    os.remove(filename)
+
 if __name__ == "__main__":
     test_pickle_volume_fespaces()
     test_pickle_surface_fespaces()
@@ -251,3 +274,28 @@ if __name__ == "__main__":
     test_pickle_CoefficientFunctions()
     test_pickle_multidim()
     test_pickle_secondorder_mesh()
+    test_checkpoint()
+
+def test_pickle_outofband_buffers():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh,order=3)
+    u = GridFunction(fes)
+    u.Set(x*y)
+    a = BilinearForm(fes)
+    a += grad(fes.TrialFunction())*grad(fes.TestFunction())*dx
+    a.Assemble()
+
+    buffers = []
+    data = pickle.dumps((u, a.mat), protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) >= 4
+    u2, mat2 = pickle.loads(data, buffers=buffers)
+    assert numpy.linalg.norm(u.vec.FV().NumPy() - u2.vec.FV().NumPy()) < 1e-14
+    w = u.vec.CreateVector()
+    w.data = a.mat * u.vec - mat2 * u2.vec
+    assert Norm(w) < 1e-12
+
+    # in-band with protocol 5 and old protocols still work
+    for protocol in [2, 5]:
+        u3, mat3 = pickle.loads(pickle.dumps((u, a.mat), protocol=protocol))
+        w.data = a.mat * u.vec - mat3 * u3.vec
+        assert Norm(w) < 1e-12
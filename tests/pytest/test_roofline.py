@@ -0,0 +1,26 @@
+from netgen.geom2d import unit_square
+from ngsolve import *
+
+
+def test_roofline():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    a.Assemble()
+    x = a.mat.CreateColVector()
+    y = a.mat.CreateColVector()
+    x[:] = 1
+    for i in range(10):
+        y.data = a.mat * x
+
+    timers = { t["name"] : t for t in Timers() }
+    spmv = timers["SparseMatrix::MultAdd"]
+    # at least the matrix entries and column indices
+    assert spmv["bytes"] >= 10 * a.mat.nze * 12
+
+    SetMachinePeaks(gflops=100, gbs=10)
+    report = RooflineReport()
+    assert "SparseMatrix::MultAdd" in report
+    assert "memory" in report
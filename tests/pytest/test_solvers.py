@@ -56,3 +56,1154 @@ def test_newton_with_dirichlet():
 
 if __name__ == "__main__":
     test_arnoldi()
+
+def test_inverse_update():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.3))
+    V = H1(mesh, order=3, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V)
+    a += (grad(u) * grad(v) + 3*u**3*v- 1 * v)*dx
+    gfu = GridFunction(V)
+    gfu.Set(x*(1-x)*y*(1-y))
+    a.AssembleLinearization(gfu.vec)
+    inv = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky")
+    assert inv.supports_update
+    gfu.vec.data *= 2
+    a.AssembleLinearization(gfu.vec)
+    inv.Update()
+    inv2 = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky")
+    r = gfu.vec.CreateVector()
+    r[:] = 1
+    w1 = r.CreateVector()
+    w2 = r.CreateVector()
+    w1.data = inv * r
+    w2.data = inv2 * r
+    assert Norm(w1-w2) < 1e-10 * Norm(w2)
+
+@pytest.mark.parametrize("inverse", ["pardiso", "umfpack", "mumps"])
+def test_inverse_update_external(inverse):
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.3))
+    V = H1(mesh, order=3, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V)
+    a += (grad(u) * grad(v) + 3*u**3*v- 1 * v)*dx
+    gfu = GridFunction(V)
+    gfu.Set(x*(1-x)*y*(1-y))
+    a.AssembleLinearization(gfu.vec)
+    try:
+        inv = a.mat.Inverse(V.FreeDofs(), inverse=inverse)
+    except Exception:
+        pytest.skip(inverse + " not available")
+    gfu.vec.data *= 2
+    a.AssembleLinearization(gfu.vec)
+    # numerical factorization only, the analysis is reused
+    inv.Update()
+    inv2 = a.mat.Inverse(V.FreeDofs(), inverse=inverse)
+    r = gfu.vec.CreateVector()
+    r[:] = 1
+    w1 = r.CreateVector()
+    w2 = r.CreateVector()
+    w1.data = inv * r
+    w2.data = inv2 * r
+    assert Norm(w1-w2) < 1e-10 * Norm(w2)
+
+def test_pipelined_cg():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=3, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    pre = Projector(V.FreeDofs(), True)
+    inv = a.mat.Inverse(V.FreeDofs())
+    gfu = GridFunction(V)
+    gfu.vec.data = inv * f.vec
+
+    x = gfu.vec.CreateVector()
+    for pipelined in [False, True]:
+        solver = CGSolver(a.mat, pre, printrates=False, precision=1e-12, maxsteps=1000, pipelined=pipelined)
+        x.data = solver * f.vec
+        x.data -= gfu.vec
+        assert Norm(x) < 1e-8 * Norm(gfu.vec)
+
+        x.data = solvers.CG(a.mat, f.vec, pre, tol=1e-12, maxsteps=1000, printrates=False, pipelined=pipelined)
+        x.data -= gfu.vec
+        assert Norm(x) < 1e-8 * Norm(gfu.vec)
+
+def test_fused_vector_ops():
+    import numpy as np
+    from ngsolve.la import CreateVVector
+    n = 1003
+    x, v, w = [CreateVVector(n) for i in range(3)]
+    for vec in [x, v, w]:
+        vec.FV().NumPy()[:] = np.random.rand(n)
+    xn, vn, wn = [vec.FV().NumPy().copy() for vec in [x, v, w]]
+
+    ip = x.AddInnerProduct(0.5, v, w)
+    assert abs(ip - np.dot(xn + 0.5*vn, wn)) < 1e-10 * n
+    assert np.allclose(x.FV().NumPy(), xn + 0.5*vn)
+
+    xn = x.FV().NumPy().copy()
+    x.Add2(2, v, -3, w)
+    assert np.allclose(x.FV().NumPy(), xn + 2*vn - 3*wn)
+
+    xn = x.FV().NumPy().copy()
+    ips = x.InnerProducts([v, w, x])
+    assert np.allclose(ips, [np.dot(xn, vn), np.dot(xn, wn), np.dot(xn, xn)])
+
+    # fused kernels inside the Krylov solvers
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=2)
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += (grad(u) * grad(v) + u * v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    gfu = GridFunction(V)
+    gfu.vec.data = a.mat.Inverse() * f.vec
+
+    r = gfu.vec.CreateVector()
+    for solver in [CGSolver(a.mat, None, printrates=False, precision=1e-12, maxsteps=1000),
+                   GMRESSolver(a.mat, None, printrates=False, precision=1e-12, maxsteps=400)]:
+        r.data = solver * f.vec
+        r.data -= gfu.vec
+        assert Norm(r) < 1e-6 * Norm(gfu.vec)
+
+    r.data = solvers.MinRes(a.mat, f.vec, tol=1e-12, maxsteps=1000, printrates=False)
+    r.data -= gfu.vec
+    assert Norm(r) < 1e-6 * Norm(gfu.vec)
+
+def test_sparsecholesky_nested_dissection():
+    from netgen.csg import unit_cube
+    mesh = Mesh (unit_cube.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=2, dirichlet=".*")
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    x1 = f.vec.CreateVector()
+    x2 = f.vec.CreateVector()
+    x1.data = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky") * f.vec
+    inv = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky_nd")
+    assert a.mat.GetInverseType() == "sparsecholesky_nd"
+    x2.data = inv * f.vec
+    x2.data -= x1
+    assert Norm(x2) < 1e-10 * Norm(x1)
+
+def test_sparsecholesky_same_pattern():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=3, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    x1 = f.vec.CreateVector()
+    x2 = f.vec.CreateVector()
+    inv = None
+    for dt in [1, 0.1, 0.01]:
+        a = BilinearForm(V, symmetric=True)
+        a += (u * v + dt * grad(u) * grad(v)) * dx
+        a.Assemble()
+        if inv is None:
+            inv = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky")
+            x1.data = inv * f.vec
+            continue
+        inv2 = inv.FactorSamePattern(a.mat)
+        x1.data = inv2 * f.vec
+        x2.data = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky") * f.vec
+        x2.data -= x1
+        assert Norm(x2) < 1e-10 * Norm(x1)
+
+def test_sparsecholesky_level_scheduling():
+    import numpy as np
+    from ngsolve.la import MultiVector
+    from netgen.csg import unit_cube
+    mesh = Mesh (unit_cube.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=2, dirichlet=".*")
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    inv = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky")
+    k = 3
+    x = MultiVector(V.ndof, k)
+    y1 = MultiVector(V.ndof, k)
+    y2 = MultiVector(V.ndof, k)
+    for j in range(k):
+        x[j].FV().NumPy()[:] = np.random.rand(V.ndof)
+    assert not inv.level_scheduling
+    inv.Mult(x, y1)
+    inv.level_scheduling = True
+    inv.Mult(x, y2)
+    for j in range(k):
+        yj = x[j].CreateVector()
+        yj.data = inv * x[j]
+        assert Norm(y1[j]-yj) < 1e-10 * Norm(yj)
+        assert Norm(y2[j]-yj) < 1e-10 * Norm(yj)
+
+def test_sparsecholesky_out_of_core():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=3, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    x1 = f.vec.CreateVector()
+    x2 = f.vec.CreateVector()
+    x1.data = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky") * f.vec
+    inv = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky_ooc")
+    for ls in [False, True]:
+        inv.level_scheduling = ls
+        x2.data = inv * f.vec
+        x2.data -= x1
+        assert Norm(x2) < 1e-10 * Norm(x1)
+
+def test_sparsecholesky_mixed_precision():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=3, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    x1 = f.vec.CreateVector()
+    x2 = f.vec.CreateVector()
+    x1.data = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky") * f.vec
+    inv = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky_mp")
+    assert a.mat.GetInverseType() == "sparsecholesky_mp"
+    x2.data = inv * f.vec
+    x2.data -= x1
+    assert Norm(x2) < 1e-10 * Norm(x1)
+
+def test_chebyshev_smoother():
+    from ngsolve.krylovspace import CG
+    from ngsolve.la import ChebyshevSmoother
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=1, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    jac = a.mat.CreateSmoother(V.FreeDofs())
+    cheb = ChebyshevSmoother(a.mat, jac, order=3)
+    assert 0.5 < cheb.lam_max < 2.5
+    assert abs(cheb.lam_min - cheb.lam_max/30) < 1e-12
+    x1 = f.vec.CreateVector()
+    x2 = f.vec.CreateVector()
+    x1.data = a.mat.Inverse(V.FreeDofs()) * f.vec
+    CG(a.mat, f.vec, pre=cheb, sol=x2, tol=1e-12, maxsteps=200, printrates=False)
+    x2.data -= x1
+    assert Norm(x2) < 1e-8 * Norm(x1)
+
+def test_multigrid_chebyshev():
+    from ngsolve.krylovspace import CG
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.3))
+    V = H1(mesh, order=1, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    pre = Preconditioner(a, "multigrid", smoother="chebyshev")
+    f = LinearForm(V)
+    f += v * dx
+    a.Assemble()
+    for l in range(3):
+        mesh.Refine()
+        V.Update()
+        a.Assemble()
+    f.Assemble()
+    x = f.vec.CreateVector()
+    CG(a.mat, f.vec, pre=pre, sol=x, tol=1e-10, maxsteps=50, printrates=False)
+    r = f.vec.CreateVector()
+    r.data = f.vec - a.mat * x
+    assert Norm(r) < 1e-8 * Norm(f.vec)
+
+def test_multigrid_galerkin():
+    from ngsolve.krylovspace import CG
+    for sym in [False, True]:
+        mesh = Mesh (unit_square.GenerateMesh(maxh=0.3))
+        V = H1(mesh, order=1, dirichlet=[1,2,3,4])
+        u,v = V.TnT()
+        a = BilinearForm(V, symmetric=sym)
+        a += (grad(u) * grad(v) + u * v) * dx
+        pre = Preconditioner(a, "multigrid", galerkin=True)
+        a.Assemble()
+        for l in range(3):
+            mesh.Refine()
+            V.Update()
+            a.Assemble()
+        # reassembly on the same mesh reuses the sparse products
+        a.Assemble()
+        f = LinearForm(V)
+        f += v * dx
+        f.Assemble()
+        x = f.vec.CreateVector()
+        CG(a.mat, f.vec, pre=pre, sol=x, tol=1e-10, maxsteps=30, printrates=False)
+        r = f.vec.CreateVector()
+        r.data = f.vec - a.mat * x
+        assert Norm(r) < 1e-8 * Norm(f.vec)
+
+def test_multigrid_statistics():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.3))
+    V = H1(mesh, order=1, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    pre = Preconditioner(a, "multigrid", statistics=True)
+    a.Assemble()
+    for l in range(2):
+        mesh.Refine()
+        V.Update()
+        a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    gfu = GridFunction(V)
+    gfu.vec.data = pre * f.vec
+    stats = pre.GetStatistics()
+    assert len(stats) == 3
+    assert stats[-1]["ndof"] == V.ndof
+    for st in stats:
+        assert st["visits"] == 1
+        assert st["reduction"] >= 0
+    assert abs(stats[-1]["res_in"] - Norm(f.vec)) < 1e-12 * Norm(f.vec)
+    assert stats[-1]["totaltime"] > 0
+    assert stats[-1]["flops"] > 0
+    pre.ResetStatistics()
+    assert pre.GetStatistics()[-1]["visits"] == 0
+
+def test_prolongation_restriction():
+    from random import random
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.3))
+    V = H1(mesh, order=1)
+    nc = V.ndof
+    mesh.Refine()
+    V.Update()
+    prol = V.Prolongation()
+    level = 1
+
+    # linear functions are prolongated exactly
+    gf = GridFunction(V)
+    gf.Set (1+x+2*y)
+    u = gf.vec.CreateVector()
+    u[:] = 0
+    for i in range(nc):
+        u[i] = gf.vec[i]
+    prol.Prolongate(level, u)
+    u.data -= gf.vec
+    assert Norm(u) < 1e-12 * Norm(gf.vec)
+
+    # restriction is the transpose of the prolongation
+    u[:] = 0
+    for i in range(nc):
+        u[i] = random()
+    w = u.CreateVector()
+    for i in range(V.ndof):
+        w[i] = random()
+    pu = u.CreateVector()
+    pu.data = u
+    prol.Prolongate(level, pu)
+    rw = w.CreateVector()
+    rw.data = w
+    prol.Restrict(level, rw)
+    assert abs (InnerProduct(pu, w) - InnerProduct(u, rw)) < 1e-12 * abs(InnerProduct(pu, w))
+
+def test_fgmres():
+    from ngsolve.la import FGMRESSolver
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=2, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V)
+    a += (grad(u) * grad(v) + CoefficientFunction((5,2)) * grad(u) * v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    x1 = f.vec.CreateVector()
+    x2 = f.vec.CreateVector()
+    x1.data = a.mat.Inverse(V.FreeDofs()) * f.vec
+    jac = a.mat.CreateSmoother(V.FreeDofs())
+    for restart in [0, 20]:
+        solver = FGMRESSolver(a.mat, jac, printrates=False, precision=1e-12, maxsteps=500, restart=restart)
+        x2.data = solver * f.vec
+        x2.data -= x1
+        assert Norm(x2) < 1e-8 * Norm(x1)
+
+    # inexact inner solver as a changing preconditioner
+    inner = GMRESSolver(a.mat, jac, printrates=False, precision=1e-2, maxsteps=10)
+    solver = FGMRESSolver(a.mat, inner, printrates=False, precision=1e-12, maxsteps=200)
+    x2.data = solver * f.vec
+    x2.data -= x1
+    assert Norm(x2) < 1e-8 * Norm(x1)
+
+def test_lobpcg():
+    from ngsolve.la import LOBPCG
+    from math import pi
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=3, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    m = BilinearForm(V, symmetric=True)
+    m += u * v * dx
+    a.Assemble()
+    m.Assemble()
+    pre = a.mat.Inverse(V.FreeDofs())
+    lam, evecs = LOBPCG(a.mat, m.mat, pre, V.FreeDofs(), num=4, precision=1e-8)
+    exact = [2*pi**2, 5*pi**2, 5*pi**2, 8*pi**2]
+    for l, e in zip(lam, exact):
+        assert abs(l-e) < 1e-3 * e
+    # M-orthonormal eigenvectors
+    r = a.mat.CreateColVector()
+    for j in range(4):
+        r.data = a.mat * evecs[j] - lam[j] * m.mat * evecs[j]
+        assert Norm(r) < 1e-6 * lam[j]
+        r.data = m.mat * evecs[j]
+        assert abs(InnerProduct(r, evecs[j]) - 1) < 1e-8
+
+def test_deflated_cg():
+    from ngsolve.la import DeflatedCGSolver
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.05))
+    V = H1(mesh, order=2, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    jac = a.mat.CreateSmoother(V.FreeDofs())
+    inv = a.mat.Inverse(V.FreeDofs())
+    solver = DeflatedCGSolver(a.mat, jac, numdefl=8, printrates=False, precision=1e-10, maxsteps=1000)
+    sol = a.mat.CreateColVector()
+    r = a.mat.CreateColVector()
+    steps = []
+    for k in range(1,5):
+        f = LinearForm(V)
+        f += sin(k*x) * (1+y) * v * dx
+        f.Assemble()
+        sol.data = solver * f.vec
+        r.data = inv * f.vec - sol
+        assert Norm(r) < 1e-7 * Norm(sol)
+        steps.append(solver.GetSteps())
+    assert solver.subspacesize == 8
+    assert steps[-1] < 0.8 * steps[0]
+
+def test_recycled_gmres():
+    from ngsolve.la import RecycledGMRESSolver
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.05))
+    V = H1(mesh, order=2, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    a = BilinearForm(V)
+    a += (grad(u) * grad(v) + CoefficientFunction((5,2)) * grad(u) * v) * dx
+    a.Assemble()
+    jac = a.mat.CreateSmoother(V.FreeDofs())
+    inv = a.mat.Inverse(V.FreeDofs())
+    solver = RecycledGMRESSolver(a.mat, jac, restart=30, recycle=8, printrates=False, precision=1e-10, maxsteps=2000)
+    sol = a.mat.CreateColVector()
+    r = a.mat.CreateColVector()
+    steps = []
+    for k in range(1,5):
+        f = LinearForm(V)
+        f += sin(k*x) * (1+y) * v * dx
+        f.Assemble()
+        sol.data = solver * f.vec
+        r.data = inv * f.vec - sol
+        assert Norm(r) < 1e-7 * Norm(sol)
+        steps.append(solver.GetSteps())
+    assert solver.subspacesize == 8
+    assert steps[-1] < steps[0]
+
+def test_energy_linearization():
+    # Hessian from SymbolicEnergy against central differences of its gradient
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.3))
+    V = H1(mesh, order=4, dim=2)
+    u = V.TrialFunction()
+    F = Id(2) + Grad(u)
+    C = F.trans * F
+    a = BilinearForm(V, symmetric=False)
+    a += Variation((0.5*Trace(C) - log(Det(F)) + 0.5*(Det(F)-1)**2 + (1+x)*InnerProduct(u,u)*u[0]**2) * dx)
+    gfu = GridFunction(V)
+    gfu.Set((0.05*x*y, 0.02*sin(x)))
+    a.AssembleLinearization(gfu.vec)
+    w = gfu.vec.CreateVector()
+    w.SetRandom()
+    hw = gfu.vec.CreateVector()
+    hw.data = a.mat * w
+    eps = 1e-6
+    xp = gfu.vec.CreateVector()
+    rp = gfu.vec.CreateVector()
+    rm = gfu.vec.CreateVector()
+    xp.data = gfu.vec + eps * w
+    a.Apply(xp, rp)
+    xp.data = gfu.vec - eps * w
+    a.Apply(xp, rm)
+    rp.data = 1/(2*eps) * (rp - rm)
+    hw.data -= rp
+    assert Norm(hw) < 1e-5 * Norm(rp)
+
+def test_bddc_symmetric_storage():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=4, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    results = []
+    for symmetric in [True, False]:
+        a = BilinearForm(V, symmetric=symmetric)
+        a += grad(u) * grad(v) * dx
+        pre = Preconditioner(a, "bddc")
+        a.Assemble()
+        w = f.vec.CreateVector()
+        w.data = pre.mat * f.vec
+        results.append(w)
+        gfu = GridFunction(V)
+        gfu.vec.data = solvers.CG(a.mat, f.vec, pre, tol=1e-12, maxsteps=50, printrates=False)
+        gfu.vec.data -= a.mat.Inverse(V.FreeDofs()) * f.vec
+        assert Norm(gfu.vec) < 1e-8
+    results[0].data -= results[1]
+    assert Norm(results[0]) < 1e-10 * Norm(results[1])
+
+def test_h1amg_reuse():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.05))
+    V = H1(mesh, order=1, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    c = Parameter(1)
+    a = BilinearForm(V, symmetric=False)
+    a += c * grad(u) * grad(v) * dx
+    pre = Preconditioner(a, "h1amg", reuse=True)
+    a.Assemble()
+    c.Set(3)
+    a.Assemble()
+    w = f.vec.CreateVector()
+    w.data = pre.mat * f.vec
+    b = BilinearForm(V, symmetric=False)
+    b += c * grad(u) * grad(v) * dx
+    pre2 = Preconditioner(b, "h1amg")
+    b.Assemble()
+    w2 = f.vec.CreateVector()
+    w2.data = pre2.mat * f.vec
+    w.data -= w2
+    assert Norm(w) < 1e-10 * Norm(w2)
+
+def test_h1amg_smoothers():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.05))
+    V = H1(mesh, order=1, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    for smoother in ["block", "chebyshev", "l1jacobi"]:
+        pre = Preconditioner(a, "h1amg", smoother=smoother, coarsesize=20)
+        a.Assemble()
+        gfu = GridFunction(V)
+        gfu.vec.data = solvers.CG(a.mat, f.vec, pre, tol=1e-10, maxsteps=200, printrates=False)
+        gfu.vec.data -= a.mat.Inverse(V.FreeDofs()) * f.vec
+        assert Norm(gfu.vec) < 1e-6
+
+def test_timestepping():
+    from ngsolve.la import ExplicitRungeKutta, RungeKuttaChebyshev, IMEXRungeKutta
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=2, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    m = BilinearForm(V)
+    m += u * v * dx
+    m.Assemble()
+    a = BilinearForm(V)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    minv = m.mat.Inverse(V.FreeDofs())
+    dt, tend = 1e-4, 0.01
+
+    gfu = GridFunction(V)
+    gfu.Set (sin(pi*x)*sin(pi*y))
+    u0 = gfu.vec.CreateVector()
+    u0.data = gfu.vec
+
+    # reference: python loop for rk4
+    uref = u0.CreateVector()
+    uref.data = u0
+    ui = u0.CreateVector()
+    k = [u0.CreateVector() for i in range(4)]
+    def F(w, res):
+        res.data = minv * (f.vec - a.mat * w)
+    for n in range(int(round(tend/dt))):
+        F(uref, k[0])
+        ui.data = uref + 0.5*dt*k[0]
+        F(ui, k[1])
+        ui.data = uref + 0.5*dt*k[1]
+        F(ui, k[2])
+        ui.data = uref + dt*k[2]
+        F(ui, k[3])
+        uref.data += dt/6 * (k[0]+2*k[1]+2*k[2]+k[3])
+
+    times = []
+    w = u0.CreateVector()
+    w.data = u0
+    rk = ExplicitRungeKutta(a.mat, f=f.vec, minv=minv, method="rk4")
+    tfinal = rk.Integrate(w, 0, tend, dt, callback=lambda t,u: times.append(t), every=25)
+    assert abs(tfinal-tend) < 1e-12
+    assert len(times) == 4
+    w.data -= uref
+    assert Norm(w) < 1e-10 * Norm(uref)
+
+    for stepper in [ ExplicitRungeKutta(a.mat, f=f.vec, minv=minv, method="ssprk3"),
+                     ExplicitRungeKutta(a.mat, f=f.vec, minv=minv, a=[[0,0],[1,0]], b=[0.5,0.5]),
+                     RungeKuttaChebyshev(a.mat, f=f.vec, minv=minv, stages=10) ]:
+        w.data = u0
+        stepper.Integrate(w, 0, tend, dt)
+        w.data -= uref
+        assert Norm(w) < 1e-2 * Norm(uref)
+
+    # the stabilized method allows much larger steps
+    rkc = RungeKuttaChebyshev(a.mat, f=f.vec, minv=minv, stages=20)
+    assert rkc.stability_bound > 700
+
+    # half of the operator implicit
+    imex = IMEXRungeKutta(m.mat, 0.5*a.mat, 0.5*a.mat, f=f.vec, method="ars222")
+    mstar = BilinearForm(V)
+    mstar += u * v * dx + imex.gamma * dt * 0.5 * grad(u) * grad(v) * dx
+    mstar.Assemble()
+    imex.SetInverse (mstar.mat.Inverse(V.FreeDofs()))
+    w.data = u0
+    imex.Integrate(w, 0, tend, dt)
+    w.data -= uref
+    assert Norm(w) < 1e-2 * Norm(uref)
+
+def test_generalized_alpha():
+    from ngsolve.la import GeneralizedAlpha
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=2, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    m = BilinearForm(V)
+    m += u * v * dx
+    m.Assemble()
+    k = BilinearForm(V)
+    k += grad(u) * grad(v) * dx
+    k.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    dt, tend = 0.01, 0.2
+
+    # reference: Newmark loop in python
+    uref, vref, aref = [f.vec.CreateVector() for i in range(3)]
+    w, anew = f.vec.CreateVector(), f.vec.CreateVector()
+    for vec in (uref, vref, aref):
+        vec[:] = 0
+    summat = m.mat.CreateMatrix()
+    summat.AsVector().data = m.mat.AsVector() + dt*dt/4 * k.mat.AsVector()
+    inv = summat.Inverse(V.FreeDofs())
+    for n in range(int(round(tend/dt))):
+        w.data = uref + dt * vref + dt*dt/4 * aref
+        anew.data = inv * (f.vec - k.mat * w)
+        uref.data += dt * vref + dt*dt/4 * aref + dt*dt/4 * anew
+        vref.data += dt/2 * aref + dt/2 * anew
+        aref.data = anew
+
+    gu, gv, ga = [f.vec.CreateVector() for i in range(3)]
+    def reset():
+        for vec in (gu, gv, ga):
+            vec[:] = 0
+    integrator = GeneralizedAlpha(m.mat, None, k.mat, freedofs=V.FreeDofs())
+    integrator.SetNewmark()
+    integrator.AddSource(f.vec)
+    reset()
+    calls = []
+    integrator.Integrate(gu, gv, ga, 0, tend, dt, callback=lambda t,u,v,a: calls.append(t), every=5)
+    assert len(calls) == 4
+    gu.data -= uref
+    assert Norm(gu) < 1e-10 * Norm(uref)
+
+    # change of dt refactors, back to dt gives the same result
+    reset()
+    integrator.Integrate(gu, gv, ga, 0, 0.05, dt/2)
+    reset()
+    integrator.Integrate(gu, gv, ga, 0, tend, dt)
+    gu.data -= uref
+    assert Norm(gu) < 1e-10 * Norm(uref)
+
+    # damped generalized-alpha, matrix-free M and C with a given inverse
+    alpha = GeneralizedAlpha(m.mat, 0.1*m.mat, k.mat, rho_inf=0.5)
+    cm, cc, ck = alpha.EffectiveCoefficients(dt)
+    seff = BilinearForm(V)
+    seff += ((cm+0.1*cc) * u * v + ck * grad(u) * grad(v)) * dx
+    seff.Assemble()
+    alpha.SetInverse(seff.mat.Inverse(V.FreeDofs()), dt)
+    alpha.AddSource(f.vec, lambda t: 1 if t < 0.1 else 0)
+    reset()
+    alpha.Integrate(gu, gv, ga, 0, tend, dt)
+    assert Norm(gu) < 10 * Norm(uref)
+    with pytest.raises(Exception):
+        alpha.Integrate(gu, gv, ga, 0, tend, dt/2)
+
+def test_pmultigrid():
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=6, dirichlet=[1,2,3,4])
+    u,v = V.TnT()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    for flags in [ { "smoother" : "chebyshev" },
+                   { "smoother" : "block" },
+                   { "smoother" : "chebyshev", "coarsetype" : "h1amg" } ]:
+        a = BilinearForm(V, symmetric=True)
+        a += grad(u) * grad(v) * dx
+        pre = Preconditioner(a, "pmultigrid", **flags)
+        a.Assemble()
+        gfu = GridFunction(V)
+        inv = CGSolver(a.mat, pre, precision=1e-10, maxsteps=100)
+        gfu.vec.data = inv * f.vec
+        assert inv.GetSteps() < 60
+        gfu.vec.data -= a.mat.Inverse(V.FreeDofs()) * f.vec
+        assert Norm(gfu.vec) < 1e-6
+
+    # matrix-free fine level
+    a = BilinearForm(V, nonassemble=True)
+    a += grad(u) * grad(v) * dx
+    pre = Preconditioner(a, "pmultigrid")
+    a.Assemble()
+    pre.Update()
+    inv = CGSolver(a.mat, pre, precision=1e-10, maxsteps=100)
+    gfu = GridFunction(V)
+    gfu.vec.data = inv * f.vec
+    assert inv.GetSteps() < 60
+
+
+def test_fused_innerproducts():
+    from ngsolve.la import InnerProducts
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    for cplx in [False, True]:
+        V = H1(mesh, order=3, complex=cplx)
+        u,v,w = [GridFunction(V) for i in range(3)]
+        u.Set(x+1j*y if cplx else x)
+        v.Set(y*y)
+        w.Set(1+x*y)
+        for conj in [False, True]:
+            ips = InnerProducts([(u.vec, v.vec), (v.vec, w.vec), (u.vec, u.vec)], conjugate=conj)
+            ref = [a.InnerProduct(b, conjugate=conj) for a,b in [(u.vec, v.vec), (v.vec, w.vec), (u.vec, u.vec)]]
+            for ip, r in zip(ips, ref):
+                assert abs(ip-r) < 1e-12 * (1+abs(r))
+
+    # solvers using the fused reductions
+    V = H1(mesh, order=3, dirichlet=".*")
+    u,v = V.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx+u*v*dx).Assemble()
+    f = LinearForm(v*dx).Assemble()
+    exact = a.mat.Inverse(V.FreeDofs()) * f.vec
+    pre = a.mat.CreateSmoother(V.FreeDofs())
+    for solver in [GMRESSolver, QMRSolver]:
+        inv = solver(mat=a.mat, pre=pre, printrates=False, precision=1e-12, maxsteps=400)
+        gfu = GridFunction(V)
+        gfu.vec.data = inv * f.vec
+        gfu.vec.data -= exact
+        assert Norm(gfu.vec) < 1e-6
+
+def test_direct_solvers_many_rhs():
+    import numpy as np
+    from ngsolve.la import MultiVector
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=3, dirichlet=[1,2])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=True)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    k = 20
+    x = MultiVector(V.ndof, k)
+    y = MultiVector(V.ndof, k)
+    for j in range(k):
+        x[j].FV().NumPy()[:] = np.random.rand(V.ndof)
+    for inverse in ["sparsecholesky", "pardiso", "umfpack", "mumps"]:
+        try:
+            inv = a.mat.Inverse(V.FreeDofs(), inverse=inverse)
+        except Exception:
+            continue   # solver not available in this build
+        inv.Mult(x, y)
+        for j in range(k):
+            yj = x[j].CreateVector()
+            yj.data = inv * x[j]
+            assert Norm(y[j]-yj) < 1e-10 * Norm(yj)
+
+@pytest.mark.parametrize("symmetric", [True, False])
+def test_inverse_auto(symmetric):
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=3, dirichlet=[1,2])
+    u,v = V.TnT()
+    a = BilinearForm(V, symmetric=symmetric)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    f = LinearForm(V)
+    f += v * dx
+    f.Assemble()
+    x1 = f.vec.CreateVector()
+    x2 = f.vec.CreateVector()
+    x1.data = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky") * f.vec
+    x2.data = a.mat.Inverse(V.FreeDofs(), inverse="auto") * f.vec
+    # the choice is made for every factorization
+    assert a.mat.GetInverseType() == "auto"
+    x2.data -= x1
+    assert Norm(x2) < 1e-10 * Norm(x1)
+
+def test_arnoldi_shifts():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, complex=True, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    m = BilinearForm(fes)
+    m += u*v*dx
+    a.Assemble()
+    m.Assemble()
+
+    # lowest eigenvalues pi^2 (i^2+j^2): 2, 5, 5, 8, 10, 10 times pi^2
+    shifts = [20, 80]
+    lam, vecs = ArnoldiShifts(a.mat, m.mat, fes.FreeDofs(), shifts, nev=4, maxrestarts=10)
+    assert len(lam) == len(vecs)
+    # every eigenvalue is kept by the closest shift, so each pair once:
+    # 2,5,5 from shift 20, 8,10,10 from shift 80
+    exact = [pi**2 * k for k in [2, 5, 5, 8, 10, 10]]
+    assert len(lam) == len(exact)
+    for l, e in zip(sorted(l.real for l in lam), exact):
+        assert abs(l - e) < 1e-3 * e
+    for l, vec in zip(lam, vecs):
+        av, mv = vec.CreateVector(), vec.CreateVector()
+        av.data = a.mat * vec
+        mv.data = m.mat * vec
+        assert Norm(av - l * mv) < 1e-3 * Norm(av)
+
+    # the same pairs as a fresh solve at the single shift
+    gfu = GridFunction(fes, multidim=4)
+    lam80 = ArnoldiSolver(a.mat, m.mat, fes.FreeDofs(), list(gfu.vecs), shift=80, maxrestarts=10)
+    for l in lam:
+        if abs(l-80) < abs(l-20):
+            assert min(abs(l - l2) for l2 in lam80) < 1e-6 * abs(l)
+
+@pytest.mark.parametrize("complex", [False, True])
+def test_krylov_schur(complex):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, complex=complex, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    m = BilinearForm(fes)
+    m += u*v*dx
+    a.Assemble()
+    m.Assemble()
+
+    # basis of 2*4+1 vectors, the restarts converge the 4 lowest pairs
+    fesc = H1(mesh, order=3, complex=True, dirichlet=".*")
+    gfu = GridFunction(fesc, multidim=4)
+    lam = ArnoldiSolver(a.mat, m.mat, fes.FreeDofs(), list(gfu.vecs), shift=0,
+                        maxrestarts=100, tol=1e-10, krylovschur=True)
+    exact = [pi**2 * k for k in [2, 5, 5, 8]]
+    for l, e in zip(sorted(l.real for l in lam), exact):
+        assert abs(l - e) < 1e-3 * e
+    for l in lam:
+        assert abs(l.imag) < 1e-8 * abs(l)
+
+def test_low_rank_updated_inverse():
+    import numpy as np
+    from ngsolve.la import MultiVector, LowRankUpdatedInverse
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=2, dirichlet=[1,2])
+    u,v = V.TnT()
+    a = BilinearForm(V)
+    a += grad(u) * grad(v) * dx
+    a.Assemble()
+    inv = a.mat.Inverse(V.FreeDofs())
+    free = np.array([V.FreeDofs()[i] for i in range(V.ndof)])
+
+    k = 3
+    U = MultiVector(V.ndof, k)
+    W = MultiVector(V.ndof, k)
+    for j in range(k):
+        U[j].FV().NumPy()[:] = np.random.rand(V.ndof) * free
+        W[j].FV().NumPy()[:] = np.random.rand(V.ndof) * free
+    upd = LowRankUpdatedInverse(inv, U, W)
+    assert upd.rank == k
+
+    f = a.mat.CreateColVector()
+    f.FV().NumPy()[:] = np.random.rand(V.ndof) * free
+    x = f.CreateVector()
+    x.data = upd * f
+    # (A + U W^T) x = f on the free dofs
+    r = f.CreateVector()
+    r.data = a.mat * x
+    Uf, Wf = U.FM().NumPy(), W.FM().NumPy()
+    r.FV().NumPy()[:] += Uf.T @ (Wf @ x.FV().NumPy())
+    r.data -= f
+    assert np.linalg.norm(r.FV().NumPy() * free) < 1e-8 * Norm(f)
+
+def test_block_saddle_point_solvers():
+    import numpy as np
+    from ngsolve.la import BlockMatrix, BlockVector, BlockPreconditioner, \
+        SchurComplementMatrix, MinResSolver, FGMRESSolver
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = VectorH1(mesh, order=2, dirichlet=".*")
+    Q = H1(mesh, order=1)
+    u,v = V.TnT()
+    p,q = Q.TnT()
+    a = BilinearForm(InnerProduct(grad(u),grad(v))*dx).Assemble()
+    b = BilinearForm(div(u)*q*dx).Assemble()
+    mp = BilinearForm(p*q*dx).Assemble()
+    f = LinearForm(CF((x*(1-y), y*y)) * v * dx).Assemble()
+    g = LinearForm(Q)
+    g.Assemble()
+
+    K = BlockMatrix([[a.mat, b.mat.T], [b.mat, None]])
+    ainv = a.mat.Inverse(V.FreeDofs())
+    mpinv = mp.mat.Inverse()
+    rhs = BlockVector([f.vec, g.vec])
+    free = np.array([V.FreeDofs()[i] for i in range(V.ndof)])
+
+    def Residual(sol):
+        r = rhs.CreateVector()
+        r.data = rhs - K * sol
+        return np.linalg.norm(r[0].FV().NumPy() * free) + np.linalg.norm(r[1].FV().NumPy())
+
+    sols = []
+    sol = rhs.CreateVector()
+    pre = BlockPreconditioner(None, [ainv, mpinv], type="diagonal")
+    solver = MinResSolver(K, pre, printrates=False, precision=1e-10, maxsteps=200)
+    sol.data = solver * rhs
+    assert Residual(sol) < 1e-8 * Norm(f.vec)
+    sols.append(sol[0].FV().NumPy().copy())
+
+    for t in ["lower", "upper", "symmetric"]:
+        sol = rhs.CreateVector()
+        pre = BlockPreconditioner(K, [ainv, -1.0 * mpinv], type=t)
+        solver = FGMRESSolver(K, pre, printrates=False, precision=1e-10, maxsteps=200)
+        sol.data = solver * rhs
+        assert Residual(sol) < 1e-8 * Norm(f.vec)
+        sols.append(sol[0].FV().NumPy().copy())
+
+    for s in sols[1:]:
+        assert np.linalg.norm(s - sols[0]) < 1e-6 * np.linalg.norm(sols[0])
+
+    # the Schur complement is negative semi-definite
+    S = SchurComplementMatrix(K, ainv)
+    hp = g.vec.CreateVector()
+    hp.FV().NumPy()[:] = np.random.rand(Q.ndof)
+    Shp = hp.CreateVector()
+    Shp.data = S * hp
+    assert InnerProduct(Shp, hp) < 0
+
+def test_reduced_operator():
+    import numpy as np
+    from ngsolve.la import ProjectMatrix
+    from ngsolve.rom import Basis, AffineReducedOperator
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.1))
+    V = H1(mesh, order=2, dirichlet=[1,2])
+    u,v = V.TnT()
+    forms = grad(u) * grad(v) * dx + u * v * dx
+    rhs = [v * dx, x * v * dx]
+
+    # snapshots of -mu0 Delta u + mu1 u = 1 + 2x
+    snapshots = []
+    for mu in [(1, 0.1), (1, 10), (0.1, 1), (5, 3)]:
+        a = BilinearForm(V)
+        a += mu[0] * grad(u) * grad(v) * dx + mu[1] * u * v * dx
+        a.Assemble()
+        f = LinearForm(V)
+        f += (1 + 2*x) * v * dx
+        f.Assemble()
+        gfu = GridFunction(V)
+        gfu.vec.data = a.mat.Inverse(V.FreeDofs()) * f.vec
+        snapshots.append(gfu)
+
+    basis = Basis(snapshots)
+    rom = AffineReducedOperator(V, forms, basis, rhs=rhs)
+    assert rom.dim == 4 and rom.nmatrices == 2 and rom.nvectors == 2
+
+    # cached terms are the projections of the assembled terms
+    a0 = BilinearForm(V)
+    a0 += grad(u) * grad(v) * dx
+    a0.Assemble()
+    Vf = basis.FM().NumPy()
+    av = basis[0].CreateVector()
+    red = np.zeros((4,4))
+    for j in range(4):
+        av.data = a0.mat * basis[j]
+        red[:,j] = Vf @ av.FV().NumPy()
+    assert np.allclose(rom.GetMatrix(0).NumPy(), red)
+    assert np.allclose(ProjectMatrix(a0.mat, basis).NumPy(), red)
+
+    # the snapshot parameters are reproduced exactly
+    xred = rom.Solve([5, 3], [1, 2])
+    uh = snapshots[0].vec.CreateVector()
+    rom.Expand(list(xred), uh)
+    uh.data -= snapshots[3].vec
+    assert Norm(uh) < 1e-8 * Norm(snapshots[3].vec)
+
+def test_parameter_sweep():
+    import numpy as np
+    from ngsolve.la import MultiVector
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=2, dirichlet=".*")
+    u,v = V.TnT()
+    k = Parameter(1)
+    s = Parameter(0)
+    a = BilinearForm(V, symmetric=True)
+    a += k * grad(u) * grad(v) * dx + u * v * dx
+    f = LinearForm(V)
+    f += (1 + s * x) * v * dx
+    out = LinearForm(V)
+    out += v * dx
+    out.Assemble()
+
+    values = np.array([[1, 0], [2, 1], [0.5, 3], [4, -1], [1, 2]])
+    sols = MultiVector(V.ndof, len(values))
+    with TaskManager():
+        res = ParameterSweep(a, f, [k, s], values, outputs=[out], solutions=sols,
+                             inverse="sparsecholesky")
+    assert res.shape == (len(values), 1)
+    # thread values are switched off again
+    assert k.Get() == 1 and s.Get() == 0
+
+    gfu = GridFunction(V)
+    for i, (kval, sval) in enumerate(values):
+        k.Set(kval)
+        s.Set(sval)
+        a.Assemble()
+        f.Assemble()
+        gfu.vec.data = a.mat.Inverse(V.FreeDofs(), inverse="sparsecholesky") * f.vec
+        assert abs(res[i,0] - InnerProduct(out.vec, gfu.vec)) < 1e-10 * abs(res[i,0])
+        gfu.vec.data -= sols[i]
+        assert Norm(gfu.vec) < 1e-10
+
+def test_cg_free_dof_submatrix():
+    from ngsolve.krylovspace import CGSolver as KrylovCG
+    from ngsolve.la import PermutationMatrix
+    import numpy
+    mesh = Mesh (unit_square.GenerateMesh(maxh=0.2))
+    V = H1(mesh, order=3, dirichlet="left|bottom")
+    u,v = V.TnT()
+    free = V.FreeDofs()
+    for symmetric in [False, True]:
+        a = BilinearForm(V, symmetric=symmetric)
+        a += grad(u) * grad(v) * dx + u * v * dx
+        a.Assemble()
+        f = LinearForm(V)
+        f += v * dx
+        f.Assemble()
+
+        sub = a.mat.CreateSubMatrix(free)
+        assert sub.height == free.NumSet() and sub.width == free.NumSet()
+        R = PermutationMatrix(free)
+        r = a.mat.CreateColVector()
+        r.FV().NumPy()[:] = numpy.random.rand(len(r))
+        rsub = sub.CreateColVector()
+        rsub.data = R * r
+        y1 = sub.CreateColVector()
+        y2 = sub.CreateColVector()
+        y1.data = sub * rsub
+        # the submatrix does not see the constrained values of r
+        r.data = R.T * rsub
+        ar = a.mat.CreateColVector()
+        ar.data = a.mat * r
+        y2.data = R * ar
+        assert Norm(y1 - y2) < 1e-12 * Norm(y2)
+
+        # Dirichlet values in the initial guess, as after SetBoundaryCFValues
+        gfu = GridFunction(V)
+        gfu.Set(x*y, BND)
+        ref = gfu.vec.CreateVector()
+        ref.data = gfu.vec
+        res = f.vec.CreateVector()
+        res.data = f.vec - a.mat * gfu.vec
+        ref.data += a.mat.Inverse(free) * res
+
+        for compress in [True, False]:
+            sol = gfu.vec.CreateVector()
+            sol.data = gfu.vec
+            solver = KrylovCG(a.mat, freedofs=free, tol=1e-14, maxsteps=1000, compress=compress)
+            assert (solver.restriction is not None) == compress
+            solver.Solve(f.vec, sol, initialize=False)
+            sol.data -= ref
+            assert Norm(sol) < 1e-8 * Norm(ref)
+
+def test_hiptmair_xu():
+    from netgen.csg import unit_cube
+    from ngsolve.krylovspace import CGSolver as KrylovCG
+    from ngsolve.auxiliaryspace import HiptmairXu
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.3))
+    fes = HCurl(mesh, order=0, dirichlet=".*")
+    u,v = fes.TnT()
+    sigma = Parameter(1)
+    a = BilinearForm(fes)
+    a += curl(u)*curl(v)*dx + sigma*u*v*dx
+    a.Assemble()
+    f = LinearForm(fes)
+    f += CF((1,x,y))*v*dx
+    f.Assemble()
+
+    pre = HiptmairXu(a.mat, fes)
+    gfu = GridFunction(fes)
+    for s in [1, 1e-3]:
+        sigma.Set(s)
+        a.Assemble()
+        pre.Update(a.mat)
+        inv = KrylovCG(a.mat, pre, tol=1e-10, maxsteps=100)
+        gfu.vec.data = inv * f.vec
+        assert inv.iterations < 50
+        res = f.vec.CreateVector()
+        res.data = f.vec - a.mat * gfu.vec
+        res.data = Projector(fes.FreeDofs(), True) * res
+        assert Norm(res) < 1e-8 * Norm(f.vec)
+
+def test_vanka_blocks():
+    from ngsolve.krylovspace import GMRes
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    V = VectorH1(mesh, order=2, dirichlet="left|top|bottom")
+    Q = H1(mesh, order=1)
+    X = V*Q
+    (u,p), (v,q) = X.TnT()
+    a = BilinearForm(X)
+    a += (InnerProduct(grad(u),grad(v)) - div(u)*q - div(v)*p)*dx
+    a.Assemble()
+    f = LinearForm(X)
+    f += CF((1,y)) * v * dx
+    f.Assemble()
+    free = X.FreeDofs()
+    npv = V.ndof
+
+    for patch in ["vertex", "element"]:
+        blocks = X.CreateSmoothingBlocks(vanka=patch)
+        assert len(blocks) == (mesh.nv if patch == "vertex" else mesh.ne)
+        for b in blocks:
+            assert all(free[d] for d in b)
+        # the patches couple velocity and pressure
+        assert all(any(d >= npv for d in b) and any(d < npv for d in b)
+                   for b in blocks if len(b) > 1)
+        pre = a.mat.CreateBlockSmoother(blocks, parallel=True)
+        gfu = GridFunction(X)
+        GMRes(a.mat, f.vec, pre=pre, x=gfu.vec, freedofs=free, tol=1e-10, maxsteps=300, printrates=False)
+        res = f.vec.CreateVector()
+        res.data = f.vec - a.mat * gfu.vec
+        res.data = Projector(free, True) * res
+        assert Norm(res) < 1e-6 * Norm(f.vec)
+
+    # without the flag the blocks of FESpace
+    assert len(X.CreateSmoothingBlocks()) > 0
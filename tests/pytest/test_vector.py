@@ -40,3 +40,31 @@ def test_vector_numpy():
     assert d[0] == c[0]
     d[1] = 1+3j
     assert d[1] == c[1]
+
+def test_multidim_multivector():
+    import numpy as np
+    from netgen.geom2d import unit_square
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    fes = H1(mesh, order=2)
+    gf = GridFunction(fes, multidim=3)
+    for i, vec in enumerate(gf.vecs):
+        vec[:] = i
+    mv = gf.multivector
+    assert len(mv) == 3 and mv.size == fes.ndof
+    assert np.allclose(mv.FM().NumPy(), np.arange(3)[:,None])
+
+    # the components are views into the MultiVector
+    mv[1][:] = 5
+    assert np.allclose(gf.vecs[1].FV().NumPy(), 5)
+
+    # growing keeps the components connected
+    v0 = gf.vecs[0]
+    for i in range(3, 10):
+        gfi = GridFunction(fes)
+        gfi.vec[:] = i
+        gf.AddMultiDimComponent(gfi.vec)
+    v0[:] = -1
+    mv = gf.multivector
+    assert len(mv) == 10
+    assert np.allclose(mv.FM().NumPy()[0], -1)
+    assert np.allclose(mv.FM().NumPy()[9], 9)
@@ -0,0 +1,80 @@
+"""
+Import time of ngsolve, and the slowest modules by -X importtime.
+
+Every run starts a fresh interpreter, the minimum over the repetitions
+counts. The result is appended to a JSON history file and compared
+against a baseline file, as in scaling.py:
+
+  python3 import_time.py --repeat 10 --baseline release.json
+"""
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import time
+
+parser = argparse.ArgumentParser(description='Import time of ngsolve')
+parser.add_argument('--module', type=str, default='ngsolve', help='module to import')
+parser.add_argument('--repeat', type=int, default=5, help='fresh interpreters, the minimum counts')
+parser.add_argument('--top', type=int, default=15, help='print the slowest modules')
+parser.add_argument('-o', '--output', type=str, default='import_time.json', help='history file, runs are appended')
+parser.add_argument('-b', '--baseline', type=str, default=None, help='history file to compare with')
+parser.add_argument('--tolerance', type=float, default=1.2,
+                    help='report an import slower than the baseline by this factor')
+
+
+def ImportOnce(module):
+    """ wall time of a fresh interpreter importing module, and the self times of the modules in us """
+    start = time.perf_counter()
+    res = subprocess.run([sys.executable, "-X", "importtime", "-c", "import " + module],
+                         stderr=subprocess.PIPE, universal_newlines=True, check=True)
+    wall = time.perf_counter() - start
+    modules = {}
+    for line in res.stderr.splitlines():
+        # import time: self [us] | cumulative | imported package
+        m = re.match(r"import time:\s+(\d+)\s+\|\s+(\d+)\s+\|\s+(.*)", line)
+        if m:
+            modules[m.group(3).strip()] = int(m.group(1))
+    return wall, modules
+
+
+def Interpreter():
+    """ start of the interpreter without import, subtracted from the wall time """
+    start = time.perf_counter()
+    subprocess.run([sys.executable, "-c", "pass"], check=True)
+    return time.perf_counter() - start
+
+
+if __name__ == "__main__":
+    args = parser.parse_args()
+    best, best_modules = None, None
+    for i in range(args.repeat):
+        wall, modules = ImportOnce(args.module)
+        if best is None or wall < best:
+            best, best_modules = wall, modules
+    empty = min(Interpreter() for i in range(args.repeat))
+
+    run = { "module" : args.module, "wall" : best, "interpreter" : empty,
+            "import" : best - empty,
+            "modules" : dict(sorted(best_modules.items(), key=lambda m: -m[1])[:args.top]) }
+    print("import {}: {:.3f}s ({:.3f}s without interpreter start)".format(args.module, best, best-empty))
+    for name, us in run["modules"].items():
+        print("{:>50} {:10.4f}s".format(name, 1e-6*us))
+
+    history = json.load(open(args.output)) if os.path.exists(args.output) else []
+    history.append({ "date" : datetime.datetime.now().isoformat(),
+                     "machine" : { "platform" : platform.platform(), "python" : platform.python_version() },
+                     "run" : run })
+    json.dump(history, open(args.output, 'w'), indent=1)
+
+    if args.baseline:
+        base = [h["run"] for h in json.load(open(args.baseline)) if h["run"]["module"] == args.module]
+        if base:
+            ratio = run["import"] / base[-1]["import"]
+            print("baseline {:.3f}s, ratio {:.2f}{}".format(base[-1]["import"], ratio,
+                                                           " <--" if ratio > args.tolerance else ""))
@@ -0,0 +1,218 @@
+"""
+Scaling benchmarks of the main steps of a simulation: assembly with and
+without static condensation, the matrix graph, preconditioner setup, CG
+iterations, VTK output and saving a GridFunction.
+
+Every combination of mesh size, order and thread count is one run, with
+mpirun all ranks take part. The runs are appended to a JSON history
+file together with the machine and build, and compared against a
+baseline (e.g. the history of the last release):
+
+  python3 scaling.py --maxh 0.2 0.1 --order 1 3 --threads 1 2 4 --baseline release.json
+  mpirun -np 4 python3 scaling.py --dim 3 --maxh 0.1 --threads 1
+"""
+
+from ngsolve import *
+from ngsolve.krylovspace import CGSolver
+import netgen.meshing
+import argparse
+import datetime
+import json
+import multiprocessing
+import os
+import platform
+import socket
+import time
+ngsglobals.msg_level = 0
+
+parser = argparse.ArgumentParser(description='Scaling benchmarks of assembly and solvers')
+parser.add_argument('--dim', type=int, default=2, choices=[2, 3], help='unit square or unit cube')
+parser.add_argument('--maxh', type=float, nargs='+', default=[0.05, 0.02], help='mesh sizes')
+parser.add_argument('--order', type=int, nargs='+', default=[1, 3], help='polynomial orders')
+parser.add_argument('--threads', type=int, nargs='+', default=[1, multiprocessing.cpu_count()],
+                    help='numbers of threads of the task manager')
+parser.add_argument('--steps', type=str, nargs='+', default=None,
+                    help='only these steps (default all)')
+parser.add_argument('-o', '--output', type=str, default='scaling.json', help='history file, runs are appended')
+parser.add_argument('-b', '--baseline', type=str, default=None, help='history file to compare with')
+parser.add_argument('--tolerance', type=float, default=1.2,
+                    help='report steps slower than the baseline by this factor')
+parser.add_argument('--repeat', type=int, default=3, help='repetitions of a step, the minimum time counts')
+
+all_steps = ["mesh", "graph", "assemble", "assemble_condense", "preconditioner", "cg", "vtk", "save"]
+
+
+def MakeMesh(comm, dim, maxh):
+    from netgen.csg import unit_cube
+    from netgen.geom2d import unit_square
+    geo = unit_square if dim == 2 else unit_cube
+    if comm.size == 1:
+        return Mesh(geo.GenerateMesh(maxh=maxh))
+    if comm.rank == 0:
+        ngmesh = geo.GenerateMesh(maxh=maxh)
+        ngmesh.Distribute(comm)
+    else:
+        ngmesh = netgen.meshing.Mesh.Receive(comm)
+    return Mesh(ngmesh)
+
+
+class Stopwatch:
+    """ minimum over the repetitions of the maximal time of all ranks """
+    def __init__(self, comm, repeat):
+        self.comm = comm
+        self.repeat = repeat
+        self.times = {}
+
+    def __call__(self, name, func, repeat=None):
+        best = None
+        for i in range(repeat or self.repeat):
+            self.comm.Barrier()
+            start = time.perf_counter()
+            result = func()
+            self.comm.Barrier()
+            t = self.comm.Max(time.perf_counter() - start)
+            best = t if best is None else min(best, t)
+        self.times[name] = best
+        return result
+
+
+def TimerTime(name):
+    return sum(t["time"] for t in Timers() if t["name"] == name)
+
+
+def Run(comm, args, maxh, order, nthreads, steps):
+    watch = Stopwatch(comm, args.repeat)
+    run = {}
+    SetNumThreads(nthreads)
+    with TaskManager():
+        mesh = watch("mesh", lambda: MakeMesh(comm, args.dim, maxh), repeat=1)
+        fes = H1(mesh, order=order, dirichlet=".*")
+        u, v = fes.TnT()
+        run["ndof"] = int(comm.Sum(fes.ndof)) if comm.size > 1 else fes.ndof
+        run["ne"] = int(comm.Sum(mesh.ne)) if comm.size > 1 else mesh.ne
+
+        def Form(condense):
+            a = BilinearForm(fes, symmetric=True, condense=condense)
+            a += grad(u) * grad(v) * dx
+            return a
+
+        if "graph" in steps:
+            # first assembly of a new form builds the graph, its own timer measures it
+            def Graph():
+                before = TimerTime("BilinearForm::GetGraph")
+                Form(False).Assemble()
+                return TimerTime("BilinearForm::GetGraph") - before
+            times = [Graph() for i in range(args.repeat)]
+            watch.times["graph"] = comm.Max(min(times)) if comm.size > 1 else min(times)
+
+        a = Form(False)
+        if "assemble" in steps:
+            watch("assemble", a.Assemble)
+        else:
+            a.Assemble()
+        if "assemble_condense" in steps:
+            acond = Form(True)
+            watch("assemble_condense", acond.Assemble)
+
+        f = LinearForm(fes)
+        f += v * dx
+        f.Assemble()
+        gfu = GridFunction(fes)
+
+        pretype = "bddc" if comm.size > 1 else "multigrid"
+        run["preconditioner"] = pretype
+        def Setup():
+            pre = Preconditioner(a, pretype)
+            pre.Update()
+            return pre
+        pre = watch("preconditioner", Setup) if "preconditioner" in steps else Setup()
+
+        if "cg" in steps:
+            inv = CGSolver(a.mat, pre.mat, tol=1e-8, maxsteps=1000)
+            def Solve():
+                gfu.vec.data = inv * f.vec
+            watch("cg", Solve)
+            run["iterations"] = inv.iterations
+        if "vtk" in steps:
+            vtk = VTKOutput(mesh, coefs=[gfu], names=["u"], filename="scaling_vtk",
+                            subdivision=0, format="vtu")
+            watch("vtk", vtk.Do)
+        if "save" in steps:
+            watch("save", lambda: gfu.Save("scaling_gf_" + str(comm.rank), parallel=comm.size > 1))
+    run["times"] = watch.times
+    return run
+
+
+def Machine(comm):
+    return { "hostname" : socket.gethostname(),
+             "platform" : platform.platform(),
+             "processor" : platform.processor(),
+             "ncpus" : multiprocessing.cpu_count(),
+             "python" : platform.python_version(),
+             "ngsolve" : __version__,
+             "compiler" : "@CMAKE_CXX_COMPILER_ID@-@CMAKE_CXX_COMPILER_VERSION@",
+             "cxx_flags" : "@CMAKE_CXX_FLAGS@ @NGSOLVE_COMPILE_OPTIONS@".strip(),
+             "commit" : os.environ.get("CI_BUILD_REF", ""),
+             "mpi_ranks" : comm.size }
+
+
+def Key(run):
+    return (run["dim"], run["maxh"], run["order"], run["nthreads"], run["mpi_ranks"])
+
+
+def Compare(runs, baseline_file, tolerance):
+    """ prints the ratio to the latest baseline run of the same parameters, returns the slower steps """
+    history = json.load(open(baseline_file))
+    baseline = {}
+    for entry in history:
+        for run in entry["runs"]:
+            baseline[Key(run)] = run
+    slower = []
+    print("{:>40} {:>18} {:>10} {:>10} {:>7}".format("run", "step", "time", "baseline", "ratio"))
+    for run in runs:
+        base = baseline.get(Key(run))
+        if base is None:
+            continue
+        for step, t in run["times"].items():
+            tb = base["times"].get(step)
+            if not tb:
+                continue
+            ratio = t / tb
+            name = "dim={} maxh={} p={} threads={} ranks={}".format(*Key(run))
+            mark = " <--" if ratio > tolerance else ""
+            print("{:>40} {:>18} {:10.4f} {:10.4f} {:7.2f}{}".format(name, step, t, tb, ratio, mark))
+            if ratio > tolerance:
+                slower.append((name, step, ratio))
+    return slower
+
+
+if __name__ == "__main__":
+    args = parser.parse_args()
+    steps = args.steps or all_steps
+    for s in steps:
+        if s not in all_steps:
+            parser.error("unknown step " + s + ", choose from " + ", ".join(all_steps))
+    comm = MPI_Init()
+
+    runs = []
+    for maxh in args.maxh:
+        for order in args.order:
+            for nthreads in args.threads:
+                run = { "dim" : args.dim, "maxh" : maxh, "order" : order,
+                        "nthreads" : nthreads, "mpi_ranks" : comm.size }
+                run.update(Run(comm, args, maxh, order, nthreads, steps))
+                runs.append(run)
+                if comm.rank == 0:
+                    print("maxh={} order={} threads={} ndof={}: ".format(maxh, order, nthreads, run["ndof"])
+                          + ", ".join("{} {:.4f}s".format(k, t) for k, t in run["times"].items()))
+
+    if comm.rank == 0:
+        history = json.load(open(args.output)) if os.path.exists(args.output) else []
+        history.append({ "date" : datetime.datetime.now().isoformat(),
+                         "machine" : Machine(comm),
+                         "runs" : runs })
+        json.dump(history, open(args.output, 'w'), indent=1)
+        if args.baseline:
+            slower = Compare(runs, args.baseline, args.tolerance)
+            if slower:
+                print(len(slower), "steps slower than the baseline by more than", args.tolerance)